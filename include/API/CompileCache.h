@@ -0,0 +1,170 @@
+//===- CompileCache.h - Content-addressed output cache ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  A content-addressed cache of compiler outputs. Compilations are keyed on
+///  a hash of everything that determines their output; a repeated submission
+///  of the same program against the same configuration and calibrations is
+///  served from the cache instead of being recompiled.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_COMPILE_CACHE_H
+#define QSS_COMPILER_COMPILE_CACHE_H
+
+#include "API/CompileSingleFlight.h"
+#include "Config/QSSConfig.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace qssc::cache {
+
+/// @brief Interface of a compilation cache backend. Implementations must be
+/// safe to use from several threads at once.
+class CompileCache {
+public:
+  virtual ~CompileCache() = default;
+
+  /// @brief Look up the output stored for key.
+  /// @param key Cache key as returned by computeCompileCacheKey.
+  /// @return The stored output or std::nullopt on a miss.
+  virtual std::optional<std::string> lookup(llvm::StringRef key) = 0;
+
+  /// @brief Store the output of the compilation identified by key.
+  virtual llvm::Error store(llvm::StringRef key, llvm::StringRef output) = 0;
+};
+
+/// @brief In-process cache holding the most recently used outputs.
+class InMemoryCompileCache : public CompileCache {
+public:
+  /// @param capacity Maximum number of outputs kept in the cache.
+  explicit InMemoryCompileCache(size_t capacity) : capacity(capacity) {}
+
+  std::optional<std::string> lookup(llvm::StringRef key) override;
+  llvm::Error store(llvm::StringRef key, llvm::StringRef output) override;
+
+  size_t getCapacity() const { return capacity; }
+  void setCapacity(size_t newCapacity);
+
+private:
+  using Entry = std::pair<std::string, std::string>;
+
+  void evict_();
+
+  size_t capacity;
+  /// Entries ordered from most to least recently used.
+  std::list<Entry> entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  std::mutex mutex;
+};
+
+/// @brief Cache storing one file per output in a directory. The directory
+/// may be shared by several processes; entries are written to a temporary
+/// file and atomically renamed into place.
+class DirectoryCompileCache : public CompileCache {
+public:
+  explicit DirectoryCompileCache(std::string directory)
+      : directory(std::move(directory)) {}
+
+  std::optional<std::string> lookup(llvm::StringRef key) override;
+  llvm::Error store(llvm::StringRef key, llvm::StringRef output) override;
+
+  llvm::StringRef getDirectory() const { return directory; }
+
+private:
+  std::string getEntryPath_(llvm::StringRef key) const;
+
+  std::string directory;
+};
+
+/// @brief Cache consulting several backends in order. A hit in a later
+/// backend is stored in the earlier ones; stores go to all backends.
+class TieredCompileCache : public CompileCache {
+public:
+  explicit TieredCompileCache(std::vector<std::shared_ptr<CompileCache>> tiers)
+      : tiers(std::move(tiers)) {}
+
+  std::optional<std::string> lookup(llvm::StringRef key) override;
+  llvm::Error store(llvm::StringRef key, llvm::StringRef output) override;
+
+private:
+  std::vector<std::shared_ptr<CompileCache>> tiers;
+};
+
+/// @brief Compute the cache key of a compilation.
+///
+/// The key is a SHA-256 digest over the compiler version, the configuration,
+/// the textual command line pass pipeline, the input source, the files it
+/// depends on and the contents of the target configuration (a file, or every
+/// file below a directory, so that calibration files referenced by the target
+/// are covered).
+///
+/// @param config The compilation configuration.
+/// @param passPipeline Textual form of the command line pass pipeline.
+/// @param source The input source text or bytecode.
+/// @param sourceDependencies A digest of the frontend options and the files
+/// included by source, if any.
+/// @return The hex encoded key or an error if the target configuration could
+/// not be read.
+llvm::Expected<std::string>
+computeCompileCacheKey(const qssc::config::QSSConfig &config,
+                       llvm::StringRef passPipeline, llvm::StringRef source,
+                       llvm::StringRef sourceDependencies = "");
+
+/// @brief Encode the output of a successful compilation together with the
+/// diagnostics it emitted into a compile cache entry, such that a hit
+/// replays them.
+std::string encodeCompileCacheEntry(const CompileOutcome &outcome);
+
+/// @brief Decode a compile cache entry written by encodeCompileCacheEntry.
+/// @return std::nullopt if the entry is malformed, e.g. written by an earlier
+/// version of the compiler.
+std::optional<CompileOutcome> decodeCompileCacheEntry(llvm::StringRef entry);
+
+/// @brief Compute the cache key of the module emitted by a frontend.
+///
+/// The key is a SHA-256 digest over the compiler version, the frontend
+/// options, the identifier of the input buffer, which locations refer to, and
+/// the source text. Frontend keys never collide with compilation keys.
+///
+/// @param frontendOptions Values of the options that affect the frontend.
+/// @param bufferIdentifier Identifier of the input buffer.
+/// @param source The input source text.
+/// @return The hex encoded key.
+std::string computeFrontendCacheKey(llvm::StringRef frontendOptions,
+                                    llvm::StringRef bufferIdentifier,
+                                    llvm::StringRef source);
+
+/// @brief Get the cache configured by config. The in-memory backend is shared
+/// by all compilations of the process; its capacity follows the most recent
+/// configuration.
+/// @return The cache or nullptr if no backend is configured.
+std::shared_ptr<CompileCache>
+getCompileCache(const qssc::config::QSSConfig &config);
+
+} // namespace qssc::cache
+
+#endif // QSS_COMPILER_COMPILE_CACHE_H
@@ -0,0 +1,97 @@
+//===- CompileSingleFlight.h - Single-flight compiles -----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  A single-flight layer beside the compile cache. Identical compile
+///  requests arriving at the same time, e.g. from the workers of a parameter
+///  sweep, wait on the one compilation in flight for their cache key and
+///  share its output and diagnostics rather than compiling independently.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_COMPILE_SINGLE_FLIGHT_H
+#define QSS_COMPILER_COMPILE_SINGLE_FLIGHT_H
+
+#include "API/errors.h"
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace qssc::cache {
+
+/// @brief Outcome of a compilation, shared with the requests deduplicated
+/// onto it.
+struct CompileOutcome {
+  /// The message of the error failing the compilation, if any.
+  std::optional<std::string> error;
+  /// The emitted output of a successful compilation.
+  std::string output;
+  /// Diagnostics emitted by the compilation.
+  DiagList diagnostics;
+  /// The diagnostics the compilation printed to the error stream.
+  std::string diagnosticOutput;
+};
+
+/// @brief Runs at most one compilation per key at a time. Requests for a key
+/// which is in flight wait for its compilation and share its outcome.
+class CompileSingleFlight {
+public:
+  using Recheck = llvm::function_ref<std::optional<CompileOutcome>()>;
+  using Compile = llvm::function_ref<CompileOutcome()>;
+
+  /// @brief Run compile for key unless a compilation of key is in flight, in
+  /// which case wait for it and return its outcome instead.
+  /// @param key Cache key of the compilation.
+  /// @param lockDirectory If set, the compilation also holds a lock on key in
+  /// this directory, such that processes sharing it do not compile the same
+  /// key at once either.
+  /// @param recheck Called once the compilation of key is claimed, returning
+  /// the outcome if it became available meanwhile, e.g. from a cache shared
+  /// with the compilation which finished just before. compile is not called
+  /// then.
+  /// @param compile Performs the compilation.
+  CompileOutcome run(llvm::StringRef key,
+                     std::optional<llvm::StringRef> lockDirectory,
+                     Recheck recheck, Compile compile);
+
+  /// @brief The number of keys currently in flight.
+  size_t getNumInFlight() const;
+
+private:
+  struct Flight {
+    bool done = false;
+    CompileOutcome outcome;
+  };
+
+  mutable std::mutex mutex;
+  std::condition_variable flightDone;
+  std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+};
+
+/// @brief Get the single-flight layer shared by all compilations of the
+/// process.
+CompileSingleFlight &getCompileSingleFlight();
+
+} // namespace qssc::cache
+
+#endif // QSS_COMPILER_COMPILE_SINGLE_FLIGHT_H
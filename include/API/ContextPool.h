@@ -0,0 +1,119 @@
+//===- ContextPool.h - Pool of warmed-up MLIR contexts ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares a pool of MLIR contexts with their dialects loaded and
+///  translations registered, for processes compiling many inputs. Attributes
+///  and types are uniqued in a context for its whole lifetime, hence a pooled
+///  context is recycled once its storage grew beyond a threshold, rather than
+///  growing without bound.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_CONTEXT_POOL_H
+#define QSS_COMPILER_CONTEXT_POOL_H
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace qssc {
+
+class ContextPool {
+public:
+  struct Options {
+    /// The number of idle contexts kept for reuse.
+    unsigned maxIdleContexts = 4;
+    /// The heap growth in bytes retained by a context over its compilations
+    /// after which it is recycled.
+    uint64_t maxStorageGrowthBytes = uint64_t{512} << 20;
+    /// The number of compilations after which a context is recycled, or 0
+    /// for no limit.
+    unsigned maxUses = 0;
+  };
+
+  struct Statistics {
+    unsigned created = 0;
+    unsigned reused = 0;
+    unsigned recycled = 0;
+  };
+
+private:
+  struct PooledContext {
+    std::unique_ptr<mlir::MLIRContext> context;
+    uint64_t storageGrowth = 0;
+    unsigned uses = 0;
+    bool multithreaded = false;
+  };
+
+public:
+  /// @brief A context leased from the pool, which is returned to the pool
+  /// when the lease is destroyed.
+  class Lease {
+  public:
+    Lease(Lease &&other) noexcept
+        : pool(other.pool), pooled(std::move(other.pooled)),
+          startHeap(other.startHeap) {
+      other.pool = nullptr;
+    }
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+    Lease &operator=(Lease &&) = delete;
+    ~Lease();
+
+    mlir::MLIRContext &getContext() { return *pooled.context; }
+
+  private:
+    friend class ContextPool;
+    Lease(ContextPool &pool, PooledContext pooled);
+
+    ContextPool *pool;
+    PooledContext pooled;
+    uint64_t startHeap;
+  };
+
+  /// @brief Create a pool of contexts holding the dialects of registry.
+  explicit ContextPool(const mlir::DialectRegistry &registry,
+                       Options options = {});
+  ContextPool(const ContextPool &) = delete;
+  ContextPool &operator=(const ContextPool &) = delete;
+
+  /// @brief Lease an idle context or create a new one if none is idle.
+  Lease acquire();
+
+  /// @brief The registry of the dialects loaded in the contexts.
+  mlir::DialectRegistry &getRegistry() { return registry; }
+
+  Statistics getStatistics();
+
+private:
+  mlir::DialectRegistry registry;
+  Options options;
+
+  std::mutex mutex;
+  std::vector<PooledContext> idle;
+  Statistics statistics;
+
+  PooledContext create();
+  void release(PooledContext pooled, uint64_t growth);
+};
+
+} // namespace qssc
+
+#endif // QSS_COMPILER_CONTEXT_POOL_H
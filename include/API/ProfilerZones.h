@@ -0,0 +1,56 @@
+//===- ProfilerZones.h - Compile phase markers for profilers ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the markers annotating the compile phases, i.e. the
+///  compilation timers, as zones in the timeline of a sampling profiler, such
+///  that the samples of a long compilation are attributed to the pass,
+///  target or code generation stage they were taken in.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_PROFILER_ZONES_H
+#define QSS_COMPILER_PROFILER_ZONES_H
+
+#include "Config/QSSConfig.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <memory>
+
+namespace qssc {
+
+/// @brief Profiler markers of the compile phases. A zone may be ended on
+/// another thread than the one it began on, as the timers of targets are
+/// when the last of their children completes on a thread of its own.
+class ProfilerZones {
+public:
+  virtual ~ProfilerZones() = default;
+
+  /// @brief Begin the zone name, keyed by zone until it ends. A zone key is
+  /// only in use once at a time.
+  virtual void beginZone(const void *zone, llvm::StringRef name) = 0;
+  virtual void endZone(const void *zone) = 0;
+};
+
+/// @brief Create the profiler markers of the kind, fails if the markers are
+/// not supported by this build.
+llvm::Expected<std::unique_ptr<ProfilerZones>>
+createProfilerZones(config::ProfilerMarkers markers);
+
+} // namespace qssc
+
+#endif // QSS_COMPILER_PROFILER_ZONES_H
@@ -0,0 +1,74 @@
+//===- SharedThreadPool.h - Thread pool shared by compilations --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the thread pool shared by all compilations of the
+///  process. Installing it in the context of every compilation, instead of
+///  letting each context create its own pool, bounds the threads of
+///  concurrent compilations such that they do not oversubscribe the cores.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_SHARED_THREAD_POOL_H
+#define QSS_COMPILER_SHARED_THREAD_POOL_H
+
+#include "Config/QSSConfig.h"
+
+#include "llvm/Support/ThreadPool.h"
+
+#include <optional>
+
+namespace mlir {
+class MLIRContext;
+} // namespace mlir
+
+namespace qssc {
+
+/// @brief Get the thread pool shared by the compilations of the process. It
+/// is created on first use with maxThreads threads, or as many as the
+/// hardware supports if unset, which bounds the threads of all compilations
+/// of the process. Later values of maxThreads are ignored.
+llvm::ThreadPool &getSharedThreadPool(std::optional<unsigned> maxThreads);
+
+/// @brief Installs the shared thread pool in a multithreaded context while
+/// in scope. Compilations are granted the pool by their priority: high
+/// priority ones always, normal ones while fewer compilations than the pool
+/// has threads hold it and low priority ones only while no other compilation
+/// does. Compilations which are not granted the pool run single-threaded,
+/// rather than queue work behind the others.
+class ScopedSharedThreadPool {
+public:
+  ScopedSharedThreadPool(
+      mlir::MLIRContext &context, std::optional<unsigned> maxThreads,
+      config::CompilePriority priority = config::CompilePriority::Normal);
+  ScopedSharedThreadPool(mlir::MLIRContext &context,
+                         const config::QSSConfig &config)
+      : ScopedSharedThreadPool(context, config.getMaxThreads(),
+                               config.getCompilePriority()) {}
+  ScopedSharedThreadPool(const ScopedSharedThreadPool &) = delete;
+  ScopedSharedThreadPool &operator=(const ScopedSharedThreadPool &) = delete;
+  ~ScopedSharedThreadPool();
+
+  /// @brief Whether the context runs on the shared pool, else it is single
+  /// threaded.
+  bool isGranted() const { return granted; }
+
+private:
+  bool granted = false;
+};
+
+} // namespace qssc
+
+#endif // QSS_COMPILER_SHARED_THREAD_POOL_H
@@ -0,0 +1,138 @@
+//===- TimingTrace.h - Structured compilation timers ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  A timing manager which records each run of each timer, with its thread
+///  and its place in the timer and target hierarchy, and writes them in the
+///  Chrome trace event format, such that compile time breakdowns can be
+///  aggregated by tools instead of read from the -mlir-timing report. The
+///  counters passes record, e.g. the size of the IR, are written as counter
+///  events alongside. The time of each timer is also summed up for the
+///  compile report, and the timers may be marked as zones for a profiler.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_TIMING_TRACE_H
+#define QSS_COMPILER_TIMING_TRACE_H
+
+#include "API/ProfilerZones.h"
+#include "Utils/CounterSink.h"
+
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qssc {
+
+/// @brief A timing manager recording the timers nested in its root scope as
+/// trace events. Each event carries the thread it ran on, the path of timer
+/// names from the root and the path of the targets enclosing it, e.g.
+/// MockSystem/MockController for the optimize-llvm stage of the controller.
+/// Timers may be nested, started and stopped from several threads. As a
+/// counter sink, it records each set of counters as a counter event.
+class TimingTraceManager : public mlir::TimingManager,
+                           public qssc::utils::CounterSink {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TimingTraceManager();
+
+  void recordCounters(
+      llvm::StringRef name,
+      llvm::ArrayRef<std::pair<llvm::StringRef, int64_t>> counters) override;
+
+  /// @brief Attach the caller's trace context ID to the trace.
+  void setTraceContext(std::optional<std::string> id);
+
+  /// @brief Also mark each run of a timer as a zone of the profiler. The
+  /// zones are named after the timers and the targets enclosing them, e.g.
+  /// "optimize-llvm [MockSystem/MockController]". Must be set before the
+  /// root scope is taken.
+  void setProfilerZones(std::unique_ptr<ProfilerZones> zones);
+
+  /// @brief The total time of all runs of the timers at path, the names of
+  /// the timers nested from the root joined by '/', e.g.
+  /// build-qem/write-payload.
+  Clock::duration getTotalTime(llvm::StringRef path) const;
+
+  /// @brief Print the recorded events as a Chrome trace event JSON object.
+  void print(llvm::raw_ostream &os) const;
+  /// @brief Write the recorded events to the file, as by print.
+  llvm::Error write(llvm::StringRef filename) const;
+
+protected:
+  std::optional<void *> rootTimer() override;
+  void startTimer(void *handle) override;
+  void stopTimer(void *handle) override;
+  void *nestTimer(void *handle, const void *id,
+                  function_ref<std::string()> nameBuilder) override;
+  void hideTimer(void *handle) override;
+
+private:
+  struct TimerInfo {
+    std::string name;
+    TimerInfo *parent = nullptr;
+    bool hidden = false;
+    // the names of the enclosing timers and targets, joined by '/'
+    std::string path;
+    std::string targets;
+    // the name of the profiler zone
+    std::string zoneName;
+    // of the current run
+    Clock::time_point start;
+    uint64_t threadId = 0;
+  };
+
+  struct Event {
+    const TimerInfo *timer;
+    Clock::time_point start;
+    Clock::duration duration;
+    uint64_t threadId;
+  };
+
+  struct CounterEvent {
+    std::string name;
+    Clock::time_point time;
+    uint64_t threadId;
+    std::vector<std::pair<std::string, int64_t>> counters;
+  };
+
+  // a deque such that the handles remain valid
+  std::deque<TimerInfo> timers;
+  std::vector<Event> events;
+  std::vector<CounterEvent> counterEvents;
+  Clock::time_point epoch;
+  std::optional<std::string> traceContext;
+  std::unique_ptr<ProfilerZones> profilerZones;
+  mutable std::mutex mutex;
+};
+
+} // namespace qssc
+
+#endif // QSS_COMPILER_TIMING_TRACE_H
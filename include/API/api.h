@@ -1,6 +1,6 @@
 //===- api.h ----------------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -17,24 +17,31 @@
 #ifndef QSS_COMPILER_LIB_H
 #define QSS_COMPILER_LIB_H
 
+#include "API/ContextPool.h"
 #include "API/errors.h"
 #include "Config/QSSConfig.h"
 
 #include "Config/QSSConfig.h"
 
+#include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace qssc {
 
@@ -48,9 +55,13 @@ namespace qssc {
 /// @param toolName for the header displayed by `--help`.
 /// @param registry should contain all the dialects that can be parsed in the
 /// source.
-void registerAndParseCLIOptions(int argc, const char **argv,
+/// @param errs if given, receives the parse errors, which otherwise exit the
+/// process.
+/// @return false if the options could not be parsed.
+bool registerAndParseCLIOptions(int argc, const char **argv,
                                 llvm::StringRef toolName,
-                                mlir::DialectRegistry &registry);
+                                mlir::DialectRegistry &registry,
+                                llvm::raw_ostream *errs = nullptr);
 
 /// Register and parse command line tool options.
 /// @param argc Commandline argc to parse.
@@ -64,6 +75,24 @@ registerAndParseCLIToolOptions(int argc, const char **argv,
                                llvm::StringRef toolName,
                                mlir::DialectRegistry &registry);
 
+/// @brief Timing and resource usage of a compilation or of a parameter
+/// binding, for callers tracking their latency.
+struct CompileReport {
+  /// The trace context ID of the caller, see QSSConfig::getTraceContext.
+  std::optional<std::string> traceContext;
+  /// The wall time in seconds of each stage in the order the stages ran,
+  /// e.g. parse, passes, emit and total for a compilation. Stages which did
+  /// not run, e.g. on a compile cache hit, take no time.
+  std::vector<std::pair<std::string, double>> stages;
+  /// The CPU time in seconds the process spent over the stages, on all
+  /// threads.
+  double userCPUSeconds = 0.;
+  double systemCPUSeconds = 0.;
+  /// The peak resident set size of the process in bytes, which includes
+  /// earlier work of the process.
+  uint64_t peakRSSBytes = 0;
+};
+
 /// Perform the core processing behind `qss-compiler`
 /// @param outputStream to emit to.
 /// @param buffer to parse and process.
@@ -71,13 +100,267 @@ registerAndParseCLIToolOptions(int argc, const char **argv,
 /// source.
 /// @param config compilation configuration.
 /// @param diagnosticCb callback for error diagnostic processsing.
-/// @param timing scope for time tracking
+/// @param timing scope for time tracking, which is replaced by the root scope
+/// of a timing trace if a trace file is configured or a report is requested.
+/// @param report if given, receives the timing and resource report of the
+/// compilation, also if it fails.
 llvm::Error compileMain(llvm::raw_ostream &outputStream,
                         std::unique_ptr<llvm::MemoryBuffer> buffer,
                         mlir::DialectRegistry &registry,
                         const qssc::config::QSSConfig &config,
                         OptDiagnosticCallback diagnosticCb,
-                        mlir::TimingScope &timing);
+                        mlir::TimingScope &timing,
+                        CompileReport *report = nullptr);
+
+/// Perform the core processing behind `qss-compiler` in a context leased from
+/// pool, whose dialects are loaded already. The context is returned to the
+/// pool afterwards, or recycled once it retained too much storage.
+/// @param outputStream to emit to.
+/// @param buffer to parse and process.
+/// @param pool of contexts, whose registry should contain all the dialects
+/// that can be parsed in the source.
+/// @param config compilation configuration.
+/// @param diagnosticCb callback for error diagnostic processsing.
+/// @param timing scope for time tracking
+/// @param report if given, receives the timing and resource report of the
+/// compilation, also if it fails.
+llvm::Error compileMain(llvm::raw_ostream &outputStream,
+                        std::unique_ptr<llvm::MemoryBuffer> buffer,
+                        ContextPool &pool,
+                        const qssc::config::QSSConfig &config,
+                        OptDiagnosticCallback diagnosticCb,
+                        mlir::TimingScope &timing,
+                        CompileReport *report = nullptr);
+
+/// Compile a module which is built in memory, e.g., through the Python
+/// bindings, without printing and parsing it. The module is compiled in place
+/// in its own context, which receives the dialects of registry, and must
+/// verify. The compile cache is not consulted.
+/// @param outputStream to emit to.
+/// @param moduleOp the module to compile.
+/// @param registry should contain all the dialects the compilation loads.
+/// @param config compilation configuration. The emit action must be MLIR or
+/// later and no source may be included in the payload as there is none.
+/// @param diagnosticCb callback for error diagnostic processsing.
+/// @param timing scope for time tracking
+/// @param report if given, receives the timing and resource report of the
+/// compilation, also if it fails.
+llvm::Error compileModule(llvm::raw_ostream &outputStream,
+                          mlir::ModuleOp moduleOp,
+                          mlir::DialectRegistry &registry,
+                          const qssc::config::QSSConfig &config,
+                          OptDiagnosticCallback diagnosticCb,
+                          mlir::TimingScope &timing,
+                          CompileReport *report = nullptr);
+
+/// Run the first stage of a compilation split into separately schedulable
+/// stages: lower the input through the command line passes and the MLIR
+/// compilation of every target of the target tree, and emit the lowered
+/// module, holding the module of each target, as bytecode. Its payload may be
+/// emitted later with emitPayloadFromLoweredModule, possibly in another
+/// process or on another machine with the same target configuration.
+/// @param outputStream the stream the lowered module is written to.
+/// @param buffer the input to lower.
+/// @param registry should contain all the dialects that can be parsed in the
+/// source.
+/// @param config compilation configuration. Its emit action is ignored.
+/// @param diagnosticCb callback for error diagnostic processsing.
+/// @param timing scope for time tracking
+llvm::Error compileLoweredModule(llvm::raw_ostream &outputStream,
+                                 std::unique_ptr<llvm::MemoryBuffer> buffer,
+                                 mlir::DialectRegistry &registry,
+                                 const qssc::config::QSSConfig &config,
+                                 OptDiagnosticCallback diagnosticCb,
+                                 mlir::TimingScope &timing);
+
+/// Run the second stage of a compilation split by compileLoweredModule: emit
+/// the payload of a lowered module without lowering it again. Neither the
+/// command line passes nor the MLIR compilation of the targets are run.
+/// @param outputStream the stream the payload is written to.
+/// @param loweredModule the bytecode emitted by compileLoweredModule.
+/// @param registry should contain all the dialects of the lowered module.
+/// @param config compilation configuration, which must name the target of
+/// the first stage. The emit action must produce a payload. An included
+/// source is the lowered module.
+/// @param diagnosticCb callback for error diagnostic processsing.
+/// @param timing scope for time tracking
+llvm::Error
+emitPayloadFromLoweredModule(llvm::raw_ostream &outputStream,
+                             std::unique_ptr<llvm::MemoryBuffer> loweredModule,
+                             mlir::DialectRegistry &registry,
+                             const qssc::config::QSSConfig &config,
+                             OptDiagnosticCallback diagnosticCb,
+                             mlir::TimingScope &timing);
+
+/// @brief Result of compiling a single input with compileBatch.
+struct BatchCompileResult {
+  /// Whether the input compiled without errors.
+  bool success = false;
+  /// The emitted output (payload or IR) of the input.
+  std::string output;
+  /// Diagnostics emitted while compiling the input.
+  DiagList diagnostics;
+};
+
+/// Compile many inputs with a single MLIRContext, target system and target
+/// compilation manager. Inputs are parsed and run through the command line
+/// pass pipeline concurrently on the context's thread pool. Target
+/// compilation and payload emission of each input are then performed in turn.
+/// @param buffers the inputs to compile. All inputs must be of the input type
+/// of the configuration.
+/// @param registry should contain all the dialects that can be parsed in the
+/// inputs.
+/// @param config compilation configuration shared by all inputs. The emit
+/// action must be MLIR or later.
+/// @param timing scope for time tracking
+/// @return one result per input in the order of the inputs, or an error if
+/// the shared compilation state could not be set up.
+llvm::Expected<std::vector<BatchCompileResult>>
+compileBatch(std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers,
+             mlir::DialectRegistry &registry,
+             const qssc::config::QSSConfig &config, mlir::TimingScope &timing);
+
+/// Compile one input for several target configurations, e.g., different
+/// calibrations of a target or different targets. The input is parsed and run
+/// through the command line passes once; each target configuration then reads
+/// the resulting module from bytecode into a context of its own and runs its
+/// target compilation and payload emission, all targets in parallel on the
+/// shared thread pool.
+/// @param buffer the input to compile.
+/// @param registry should contain all the dialects that can be parsed in the
+/// input.
+/// @param config configuration of the frontend and the command line passes.
+/// Its emit action is ignored.
+/// @param targetConfigs the configuration of each target. Their emit action
+/// must be MLIR or later, their input type and command line passes are
+/// ignored. An included source is the module after the command line passes.
+/// @param diagnosticCb callback for the diagnostics of the frontend.
+/// @param timing scope for time tracking
+/// @return one result per target configuration in the order of the
+/// configurations, or an error if the frontend failed.
+llvm::Expected<std::vector<BatchCompileResult>>
+compileForTargets(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                  mlir::DialectRegistry &registry,
+                  const qssc::config::QSSConfig &config,
+                  const std::vector<qssc::config::QSSConfig> &targetConfigs,
+                  OptDiagnosticCallback diagnosticCb,
+                  mlir::TimingScope &timing);
+
+/// @brief An input file of a pipelined compilation and the file its output is
+/// written to.
+struct PipelineCompileJob {
+  std::string inputFilename;
+  std::string outputFilename;
+};
+
+/// Compile many input files as a pipeline sharing a single MLIRContext,
+/// target system and target compilation manager. While the passes and the
+/// target compilation run for one input, the next input is parsed and the
+/// output of the previous input is written, such that the throughput is bound
+/// by the slowest of these stages rather than by their sum. The compile cache
+/// is not consulted.
+/// @param jobs the inputs to compile and their outputs. All inputs must be of
+/// the input type of the configuration.
+/// @param registry should contain all the dialects that can be parsed in the
+/// inputs.
+/// @param config compilation configuration shared by all inputs. The emit
+/// action must be MLIR or later. Payloads are named after their output file.
+/// @param diagnosticCb callback for the diagnostics of the inputs, invoked for
+/// one input at a time once its output is written, but not necessarily on the
+/// calling thread.
+/// @param timing scope for time tracking
+/// @return an error if the shared compilation state could not be set up or
+/// any input failed to compile.
+llvm::Error compilePipeline(const std::vector<PipelineCompileJob> &jobs,
+                            mlir::DialectRegistry &registry,
+                            const qssc::config::QSSConfig &config,
+                            OptDiagnosticCallback diagnosticCb,
+                            mlir::TimingScope &timing);
+
+/// Read the jobs of a pipelined compilation from a manifest file listing an
+/// input and optionally its output per line, separated by whitespace, or from
+/// a directory, whose files with an input file extension are compiled in the
+/// order of their names. Empty lines and lines starting with '#' in a manifest
+/// are ignored.
+/// @param path the manifest file or directory
+/// @return the jobs, whose output is empty when not given by the manifest.
+llvm::Expected<std::vector<PipelineCompileJob>>
+readPipelineJobs(llvm::StringRef path);
+
+/// @brief The cost of each counted unit of a module, from which the resources
+/// of compiling it are estimated. The defaults are order of magnitude figures;
+/// callers scheduling compilations should fit the costs to the CompileReports
+/// of the compilations of their targets.
+struct CompileResourceModel {
+  /// The compile time in seconds which does not depend on the module, and
+  /// per unrolled operation and subroutine call.
+  double baseSeconds = 0.05;
+  double secondsPerUnrolledOp = 2e-5;
+  double secondsPerSubroutineCall = 1e-4;
+  /// The peak memory in bytes which does not depend on the module, per
+  /// unrolled operation and per byte of the elements attributes, e.g.
+  /// waveform samples, which are held by the context and copied to the
+  /// payload.
+  uint64_t baseMemoryBytes = 64ULL << 20;
+  uint64_t memoryBytesPerUnrolledOp = 1024;
+  uint64_t memoryBytesPerElementsByte = 3;
+  /// The payload size in bytes which does not depend on the module and per
+  /// unrolled operation on qubits, to which the elements bytes are added.
+  uint64_t basePayloadBytes = 4096;
+  uint64_t payloadBytesPerQuantumOp = 64;
+};
+
+/// @brief The counts of a module after the frontend, see
+/// mlir::quir::IRResourceCounts, and the resources of compiling it estimated
+/// from them.
+struct CompileResourceEstimate {
+  int64_t ops = 0;
+  int64_t qubits = 0;
+  int64_t unrolledOps = 0;
+  int64_t unrolledQuantumOps = 0;
+  int64_t unrolledSubroutineCalls = 0;
+  int64_t maxSubroutineFanOut = 0;
+  int64_t elementsBytes = 0;
+
+  double compileSeconds = 0.;
+  uint64_t peakMemoryBytes = 0;
+  uint64_t payloadBytes = 0;
+};
+
+/// Estimate the resources of compiling an input, e.g. to route large
+/// compilations to nodes with more memory. Only the input is parsed, through
+/// the frontend cache if enabled; neither the target nor any pass is run.
+/// @param buffer the input to estimate.
+/// @param registry should contain all the dialects that can be parsed in the
+/// input.
+/// @param config compilation configuration, of which the input type and the
+/// frontend options are used.
+/// @param diagnosticCb callback for the diagnostics of the frontend.
+/// @param model the costs the estimate is computed with.
+llvm::Expected<CompileResourceEstimate>
+estimateCompileResources(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                         mlir::DialectRegistry &registry,
+                         const qssc::config::QSSConfig &config,
+                         OptDiagnosticCallback diagnosticCb,
+                         const CompileResourceModel &model = {});
+
+/// Find the target selected on the command line ahead of its parsing, such
+/// that only the passes of the selected target need to be registered.
+/// @param argc Commandline argc to scan.
+/// @param argv Commandline argv to scan.
+/// @return the name of the target given by --target or QSSC_TARGET_NAME, ""
+/// if there is none, or std::nullopt if all targets must be registered as
+/// the command line requests help or is read from a response file.
+std::optional<std::string> findCommandLineTarget(int argc, const char **argv);
+
+/// Register the qss-compiler passes with those of the target selected on the
+/// command line, see findCommandLineTarget, and the dialects to parse. Must
+/// precede the parsing of the command line.
+/// @param argc Commandline argc to scan.
+/// @param argv Commandline argv to scan.
+/// @param registry The registry to add the dialects to.
+llvm::Error registerCommandLineTarget(int argc, const char **argv,
+                                      mlir::DialectRegistry &registry);
 
 /// Implementation for tools like `qss-compiler`.
 /// @param argc Commandline argc to parse.
@@ -125,6 +408,8 @@ inline int asMainReturnCode(llvm::Error err) {
 /// @param treatWarningsAsErrors return errors in place of warnings
 /// @param diagnosticCb an optional callback that will receive emitted
 /// diagnostics
+/// @param report if given, receives the timing and resource report of the
+/// binding, with a bind and a total stage
 /// @return 0 on success
 int bindArguments(std::string_view target, qssc::config::EmitAction action,
                   std::string_view configPath, std::string_view moduleInput,
@@ -132,7 +417,138 @@ int bindArguments(std::string_view target, qssc::config::EmitAction action,
                   std::unordered_map<std::string, double> const &arguments,
                   bool treatWarningsAsErrors, bool enableInMemoryInput,
                   std::string *inMemoryOutput,
-                  const OptDiagnosticCallback &onDiagnostic);
+                  const OptDiagnosticCallback &onDiagnostic,
+                  CompileReport *report = nullptr);
+
+/// @brief Call the parameter binder for several sets of arguments at once
+/// @param target name of the target to employ
+/// @param action name of the emit action of input and output
+/// @param moduleInput the module to use as input, or its path
+/// @param argumentSets bindings for the parameters in the module, one set per
+/// payload to generate
+/// @param treatWarningsAsErrors return errors in place of warnings
+/// @param enableInMemoryInput whether moduleInput holds the module or a path
+/// @param outputs receives one payload per argument set, in the same order
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics
+/// @return 0 on success
+int bindArgumentsBatch(
+    std::string_view target, qssc::config::EmitAction action,
+    std::string_view configPath, std::string_view moduleInput,
+    std::vector<std::unordered_map<std::string, double>> const &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *outputs,
+    const OptDiagnosticCallback &onDiagnostic);
+
+/// @brief Call the parameter binder for several sets of arguments given as a
+/// matrix of values
+/// @param target name of the target to employ
+/// @param action name of the emit action of input and output
+/// @param moduleInput the module to use as input, or its path
+/// @param parameterNames the names of the parameters, one per column of values
+/// @param values the argument values in row major order, one row of
+/// parameterNames.size() values per payload to generate
+/// @param treatWarningsAsErrors return errors in place of warnings
+/// @param enableInMemoryInput whether moduleInput holds the module or a path
+/// @param outputs receives one payload per row of values, in the same order
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics
+/// @return 0 on success
+int bindArgumentsBatch(
+    std::string_view target, qssc::config::EmitAction action,
+    std::string_view configPath, std::string_view moduleInput,
+    std::vector<std::string> const &parameterNames,
+    llvm::ArrayRef<double> values, bool treatWarningsAsErrors,
+    bool enableInMemoryInput, std::vector<std::string> *outputs,
+    const OptDiagnosticCallback &onDiagnostic);
+
+/// @brief Binds successive sets of arguments to a module which is kept open
+/// in between. Each bind only patches the parameters whose values changed
+/// since the previous bind.
+class ArgumentBinder {
+public:
+  /// @brief Open a module for binding
+  /// @param target name of the target to employ
+  /// @param action name of the emit action of input and output
+  /// @param configPath path of the target configuration
+  /// @param moduleInput the module to use as input, or its path
+  /// @param treatWarningsAsErrors return errors in place of warnings
+  /// @param enableInMemoryInput whether moduleInput holds the module or a path
+  /// @param diagnosticCb an optional callback that will receive emitted
+  /// diagnostics, for as long as the binder lives
+  /// @return The binder, or an error if the target or module can not be
+  /// loaded
+  static llvm::Expected<std::unique_ptr<ArgumentBinder>>
+  create(std::string_view target, qssc::config::EmitAction action,
+         std::string_view configPath, std::string_view moduleInput,
+         bool treatWarningsAsErrors, bool enableInMemoryInput,
+         const OptDiagnosticCallback &onDiagnostic);
+  ~ArgumentBinder();
+
+  /// @brief Bind arguments to the module
+  /// @param arguments bindings for the parameters in the module to apply.
+  /// Parameters that are not given keep their previous values.
+  /// @param output receives the payload
+  llvm::Error bind(std::unordered_map<std::string, double> const &arguments,
+                   std::string *output);
+
+  /// @brief The number of patch points patched by the last bind
+  size_t getNumPatched() const;
+
+private:
+  struct Impl;
+
+  ArgumentBinder();
+
+  std::unique_ptr<Impl> impl;
+}; // class ArgumentBinder
+
+/// @brief Links many sets of arguments to a module which is kept open. The
+/// payload is opened and its signature parsed once, and the argument sets of
+/// a call to linkMany are bound concurrently on the shared thread pool.
+class Linker {
+public:
+  /// @brief Open a module for linking
+  /// @param target name of the target to employ
+  /// @param action name of the emit action of input and output
+  /// @param configPath path of the target configuration
+  /// @param moduleInput the module to use as input, or its path
+  /// @param treatWarningsAsErrors return errors in place of warnings
+  /// @param enableInMemoryInput whether moduleInput holds the module or a path
+  /// @param diagnosticCb an optional callback that will receive the
+  /// diagnostics emitted while opening the module
+  /// @return The linker, or an error if the target or module can not be
+  /// loaded
+  static llvm::Expected<std::unique_ptr<Linker>>
+  create(std::string_view target, qssc::config::EmitAction action,
+         std::string_view configPath, std::string_view moduleInput,
+         bool treatWarningsAsErrors, bool enableInMemoryInput,
+         const OptDiagnosticCallback &onDiagnostic);
+  ~Linker();
+
+  /// @brief Bind each set of arguments to the module
+  /// @param argumentSets bindings for the parameters in the module, one set
+  /// per payload to generate
+  /// @param outputs receives one payload per argument set, in the same order
+  /// @param diagnosticCb an optional callback that will receive the
+  /// diagnostics of all argument sets, on the calling thread and in the
+  /// order of the argument sets
+  llvm::Error
+  linkMany(std::vector<std::unordered_map<std::string, double>> const
+               &argumentSets,
+           std::vector<std::string> *outputs,
+           const OptDiagnosticCallback &onDiagnostic);
+
+  /// @brief The number of binaries patched per argument set
+  size_t getNumBinaries() const;
+
+private:
+  struct Impl;
+
+  Linker();
+
+  std::unique_ptr<Impl> impl;
+}; // class Linker
 
 } // namespace qssc
 #endif // QSS_COMPILER_LIB_H
@@ -1,6 +1,6 @@
 //===- errors.h - Error Reporting API ---------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,12 +24,19 @@
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/MLIRContext.h"
 
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <cstdint>
 #include <functional>
 #include <list>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <tuple>
 
 namespace qssc {
 
@@ -88,6 +95,66 @@ llvm::Error emitDiagnostic(const OptDiagnosticCallback &onDiagnostic,
                            std::string message,
                            std::error_code ec = llvm::inconvertibleErrorCode());
 
+/// Aggregates the diagnostics of a compilation by their severity, category
+/// and message template, i.e., their message without the source location.
+/// Only the first repeatLimit diagnostics of each template and the first
+/// maxDiagnostics diagnostics overall are delivered. The others are counted
+/// and summarized by flush, along with sample locations, such that a warning
+/// repeated on many operations is not formatted and delivered each time.
+/// Errors are never dropped by maxDiagnostics. Either limit may be unset.
+/// The aggregator is thread safe.
+class DiagnosticAggregator {
+public:
+  DiagnosticAggregator(OptDiagnosticCallback onDiagnostic,
+                       std::optional<unsigned int> repeatLimit,
+                       std::optional<unsigned int> maxDiagnostics);
+
+  /// Whether diagnostics are aggregated at all
+  bool isLimited() const { return repeatLimit || maxDiagnostics; }
+
+  /// Count a diagnostic, returns whether it should be delivered. The
+  /// location of a suppressed diagnostic is recorded as a sample of its
+  /// template, and only computed if needed.
+  bool admit(Severity severity, ErrorCategory category,
+             llvm::StringRef messageTemplate,
+             llvm::function_ref<std::string()> getLocation = nullptr);
+
+  /// Deliver an admitted diagnostic to the callback
+  void deliver(const Diagnostic &diag);
+
+  /// Admit and deliver a diagnostic, using its message as the template
+  void emit(const Diagnostic &diag);
+
+  /// A callback emitting diagnostics through the aggregator, valid as long
+  /// as the aggregator
+  OptDiagnosticCallback getCallback();
+
+  /// Deliver a summary of the suppressed diagnostics of each template, and
+  /// of the diagnostics suppressed by maxDiagnostics.
+  void flush();
+
+private:
+  struct Template {
+    // order of the first occurrence
+    size_t index;
+    uint64_t numDelivered = 0;
+    uint64_t numSuppressed = 0;
+    llvm::SmallVector<std::string, 3> sampleLocations;
+  };
+  using TemplateKey = std::tuple<Severity, ErrorCategory, std::string>;
+
+  OptDiagnosticCallback onDiagnostic;
+  std::optional<unsigned int> repeatLimit;
+  std::optional<unsigned int> maxDiagnostics;
+
+  std::mutex mutex;
+  std::map<TemplateKey, Template> templates;
+  uint64_t numDelivered = 0;
+  // diagnostics suppressed by maxDiagnostics before reaching repeatLimit
+  uint64_t numCapped = 0;
+  Severity cappedSeverity = Severity::Info;
+};
+
 /// Encode QSSC diagnostic information within the notes of an
 /// MLIR diagnostic. This enables the usage of MLIR's diagnostic
 /// mechanisms to return QSSC diagnostics. This information
@@ -137,16 +204,25 @@ mlir::InFlightDiagnostic emitWarning(mlir::Operation *op,
 
 /// Diagnostic handler for the QSSC compiler which will emit MLIR diagnostics
 /// through the compiler's diagnostic interface as well as through MLIR's
-/// source manager handler.
+/// source manager handler. If an aggregator is given, the diagnostics it
+/// suppresses are neither formatted nor emitted, and the admitted ones are
+/// delivered through it rather than through diagnosticCb.
 class QSSCMLIRDiagnosticHandler : mlir::SourceMgrDiagnosticHandler {
 public:
   QSSCMLIRDiagnosticHandler(llvm::SourceMgr &mgr, mlir::MLIRContext *ctx,
-                            const OptDiagnosticCallback &diagnosticCb);
+                            const OptDiagnosticCallback &diagnosticCb,
+                            DiagnosticAggregator *aggregator = nullptr);
 
   /// Emit a diagnostic through the source manager dianostic handler
   /// removing any fields that are related to the qscc error category.
   void emitDiagnostic(mlir::Diagnostic &diagnostic);
 
+  /// Also append the diagnostics printed to the error stream to transcript,
+  /// e.g. to replay them when the compilation is served from the cache.
+  void setTranscript(std::string *newTranscript) {
+    transcript = newTranscript;
+  }
+
   /// Decode the MLIR diagnostic into a QSSC Diagnostic (if necessary). If the
   /// diagnostic has a QSSC diagnostic encoded through encodeQSSCError the
   /// emitted diagnostic will contain this information. If std::nullopt is
@@ -159,6 +235,8 @@ private:
   mlir::Diagnostic filterQSSCDiagnostic(mlir::Diagnostic &diagnostic);
 
   const OptDiagnosticCallback &diagnosticCb;
+  DiagnosticAggregator *aggregator;
+  std::string *transcript = nullptr;
   // Store captured output
   std::string capturedString;
   // Output stream for source manager
@@ -1,6 +1,6 @@
 //===- Arguments.h ---------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -29,20 +29,113 @@
 #include "Arguments/Signature.h"
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
 
 namespace qssc::arguments {
 
 using ArgumentType = std::variant<std::optional<double>>;
 
+class ColumnarArgumentSource;
+
+// ArgumentSource - the values to bind. Binaries may be patched concurrently,
+// hence getArgumentValue must be safe to call from multiple threads.
 class ArgumentSource {
 public:
   virtual ArgumentType getArgumentValue(llvm::StringRef name) const = 0;
+  // the source as columns indexed by pre-resolved slots, or nullptr if the
+  // arguments can only be looked up by name
+  virtual const ColumnarArgumentSource *getColumns() const { return nullptr; }
 
   virtual ~ArgumentSource() = default;
 };
 
+// the kinds of values held by the columns of a ColumnarArgumentSource
+enum class ArgumentKind : uint8_t { Double, Int, Angle };
+
+// a parameter resolved to the column holding its value and its index in it
+struct ArgumentSlot {
+  ArgumentKind kind;
+  uint32_t index;
+};
+
+// ArgumentLayout - assigns the parameters of a module to slots. A layout is
+// shared by all columnar sources binding the same parameters, such that
+// names are resolved to slots once rather than for every patch point and
+// argument set.
+class ArgumentLayout {
+public:
+  // add the parameter name with values of the given kind and return its
+  // slot. Adding a name again returns its existing slot.
+  ArgumentSlot addParameter(llvm::StringRef name,
+                            ArgumentKind kind = ArgumentKind::Double);
+  std::optional<ArgumentSlot> lookup(llvm::StringRef name) const;
+  uint32_t getNumSlots(ArgumentKind kind) const {
+    return numSlots[static_cast<size_t>(kind)];
+  }
+  size_t getNumParameters() const { return slots.size(); }
+
+private:
+  llvm::StringMap<ArgumentSlot> slots;
+  std::array<uint32_t, 3> numSlots{};
+};
+
+// ColumnarArgumentSource - argument values held in typed arrays indexed by
+// the slots of an ArgumentLayout. The arrays are referenced rather than
+// copied, so that they may be filled in place, e.g., by numpy. Angles are
+// unsigned fixed point fractions of a full turn, that is, an angle of width
+// 64 as in OpenQASM 3, such that value * 2 * pi / 2^64 is the angle in
+// radians.
+class ColumnarArgumentSource : public ArgumentSource {
+public:
+  // returns an error if the size of a column does not match the layout
+  static llvm::Expected<ColumnarArgumentSource>
+  create(const ArgumentLayout &layout, llvm::ArrayRef<double> doubles,
+         llvm::ArrayRef<int64_t> ints = {},
+         llvm::ArrayRef<uint64_t> angles = {});
+
+  ArgumentType getArgumentValue(llvm::StringRef name) const override;
+  const ColumnarArgumentSource *getColumns() const override { return this; }
+
+  const ArgumentLayout &getLayout() const { return *layout; }
+  double getDouble(uint32_t index) const { return doubles[index]; }
+  int64_t getInt(uint32_t index) const { return ints[index]; }
+  uint64_t getAngle(uint32_t index) const { return angles[index]; }
+  // the value in slot as a double, with angles in radians
+  double getValue(ArgumentSlot slot) const;
+
+private:
+  ColumnarArgumentSource(const ArgumentLayout &layout,
+                         llvm::ArrayRef<double> doubles,
+                         llvm::ArrayRef<int64_t> ints,
+                         llvm::ArrayRef<uint64_t> angles)
+      : layout(&layout), doubles(doubles), ints(ints), angles(angles) {}
+
+  const ArgumentLayout *layout;
+  llvm::ArrayRef<double> doubles;
+  llvm::ArrayRef<int64_t> ints;
+  llvm::ArrayRef<uint64_t> angles;
+};
+
+// resolve the expression of each of patchPoints to its slot in layout, or
+// std::nullopt if it is not a parameter of the layout. The expression is
+// looked up once per parameter slot of the patch points.
+std::vector<std::optional<ArgumentSlot>>
+resolveArgumentSlots(llvm::ArrayRef<PatchPoint> patchPoints,
+                     const ArgumentLayout &layout);
+
 // BindArgumentsImplementation - abstract class to be subclassed by targets to
 // define and implement methods for binding arguments to compiled payloads
 class BindArgumentsImplementation {
@@ -59,6 +152,19 @@ public:
   virtual llvm::Expected<Signature>
   parseSignature(qssc::payload::PatchablePayload *payload) = 0;
   void setTreatWarningsAsErrors(bool val) { treatWarningsAsErrors_ = val; }
+  // the number of bytes at patchPoint.offset() that patch may change, or 0 if
+  // unknown. Binaries are only patched in place if the size of all of their
+  // patch points is known.
+  virtual size_t getPatchSize(PatchPoint const &patchPoint) const { return 0; }
+  // patch with the value in slot of arguments, resolved from the expression
+  // of patchPoint ahead of time, or std::nullopt if arguments has no value
+  // for it. Targets override this to avoid looking up arguments by name for
+  // every patch point; by default the argument is looked up by name.
+  virtual llvm::Error patchSlot(PatchPoint const &patchPoint,
+                                std::optional<ArgumentSlot> slot,
+                                ColumnarArgumentSource const &arguments) {
+    return patch(patchPoint, arguments);
+  }
 
 protected:
   bool treatWarningsAsErrors_{false};
@@ -67,6 +173,12 @@ protected:
 // BindArgumentsImplementationFactory - abstract class to be subclassed by
 // targets that define and implement a factory for creating
 // BindArgumentsImplementation objects
+//
+// When binding with a thread pool the binaries of a payload are patched
+// concurrently: create may be called from multiple threads at once and the
+// implementations it returns for distinct binaries must not share mutable
+// state. Each implementation is only used by the thread that created it and
+// its onDiagnostic callback is safe to call from that thread.
 class BindArgumentsImplementationFactory {
 public:
   virtual ~BindArgumentsImplementationFactory() = default;
@@ -76,16 +188,162 @@ public:
   create(std::vector<char> &buf, OptDiagnosticCallback onDiagnostic) = 0;
   virtual BindArgumentsImplementation *
   create(std::string &str, OptDiagnosticCallback onDiagnostic) = 0;
+  // create an implementation patching data in place, e.g., a member mapped
+  // from the payload. Returns nullptr if the target does not support patching
+  // in place.
+  virtual BindArgumentsImplementation *
+  create(llvm::MutableArrayRef<char> data,
+         OptDiagnosticCallback onDiagnostic) {
+    return nullptr;
+  }
 };
 
 // TODO generalize type of arguments
+// If threadPool is given, binaries which can not be patched in place are
+// patched concurrently on it. Diagnostics are still reported through
+// onDiagnostic on the calling thread, in the order of the binaries.
 llvm::Error bindArguments(llvm::StringRef moduleInput,
                           llvm::StringRef payloadOutputPath,
                           ArgumentSource const &arguments,
                           bool treatWarningsAsErrors, bool enableInMemoryInput,
                           std::string *inMemoryOutput,
                           BindArgumentsImplementationFactory &factory,
-                          const OptDiagnosticCallback &onDiagnostic);
+                          const OptDiagnosticCallback &onDiagnostic,
+                          llvm::ThreadPool *threadPool = nullptr);
+
+// Bind each of argumentSets to the module and return the resulting payloads
+// in outputs, in the same order. The module and its signature are read and
+// parsed once; only the members with patch points are patched and written
+// per argument set.
+llvm::Error bindArgumentsBatch(
+    llvm::StringRef moduleInput, bool enableInMemoryInput,
+    llvm::ArrayRef<const ArgumentSource *> argumentSets,
+    bool treatWarningsAsErrors, std::vector<std::string> &outputs,
+    BindArgumentsImplementationFactory &factory,
+    const OptDiagnosticCallback &onDiagnostic,
+    llvm::ThreadPool *threadPool = nullptr);
+
+// Bind each of points to the point of the same index of a payload compiled
+// for a parameter sweep, e.g., with add-shot-loop{sweep-points=N}, and write
+// the bound payload to output, or back to the module on disk if output is
+// nullptr. Only the parameter table of the payload is patched, such that the
+// payload runs all of the points at once; the parameters without a value in
+// a point keep their initial values. Fails if the payload has no parameter
+// table or a number of points other than the number of points given.
+llvm::Error bindSweepArguments(llvm::StringRef moduleInput,
+                               bool enableInMemoryInput,
+                               llvm::ArrayRef<const ArgumentSource *> points,
+                               std::string *output,
+                               BindArgumentsImplementationFactory &factory,
+                               const OptDiagnosticCallback &onDiagnostic);
+
+// IncrementalBinder - binds successive sets of arguments to a module which is
+// kept open in between. Each bind only patches the patch points whose
+// argument changed since the previous bind, as in optimization loops where
+// few of many parameters change per iteration.
+class IncrementalBinder {
+public:
+  // the bytes of a binary changed by a bind
+  struct PatchedRange {
+    llvm::StringRef binary;
+    uint64_t offset;
+    std::vector<char> bytes;
+  };
+
+  // open moduleInput and read the binaries with patch points. The module is
+  // never modified, payloads are only ever written to the outputs of bind.
+  static llvm::Expected<std::unique_ptr<IncrementalBinder>>
+  create(llvm::StringRef moduleInput, bool enableInMemoryInput,
+         bool treatWarningsAsErrors,
+         BindArgumentsImplementationFactory &factory,
+         const OptDiagnosticCallback &onDiagnostic);
+
+  // bind arguments. If output is given it receives the patched payload. If
+  // changes is given it receives the byte ranges patched by this bind, which
+  // requires the target to report the size of its patches. If the bind
+  // fails, the next one patches all patch points again.
+  llvm::Error bind(ArgumentSource const &arguments, std::string *output,
+                   std::vector<PatchedRange> *changes = nullptr);
+
+  // the number of patch points patched by the last bind
+  size_t getNumPatched() const { return numPatched; }
+
+private:
+  struct Binary {
+    llvm::StringRef name;
+    qssc::payload::PatchablePayload::ContentBuffer *data;
+    std::unique_ptr<BindArgumentsImplementation> impl;
+    std::vector<PatchPoint> const *patchPoints;
+    std::vector<std::optional<ArgumentSlot>> slots;
+    const ArgumentLayout *slotsLayout = nullptr;
+  };
+
+  IncrementalBinder() = default;
+
+  llvm::Error bind_(ArgumentSource const &arguments,
+                    llvm::StringMap<ArgumentType> &current,
+                    std::vector<PatchedRange> *changes);
+
+  std::string input;
+  std::unique_ptr<BindArgumentsImplementation> payloadImpl;
+  std::unique_ptr<qssc::payload::PatchablePayload> payload;
+  Signature sig;
+  std::vector<Binary> binaries;
+  // the argument of every expression as of the last successful bind
+  llvm::StringMap<ArgumentType> previous;
+  size_t numPatched = 0;
+};
+
+// BatchBinder - binds many sets of arguments to a module which is kept open,
+// concurrently. The module and its signature are read and parsed once; every
+// argument set patches its own copies of the binaries with patch points and
+// is written to its own payload, such that argument sets are independent of
+// each other and of the order they are bound in.
+class BatchBinder {
+public:
+  // open moduleInput and read the binaries with patch points. The module is
+  // never modified. The factory must outlive the binder.
+  static llvm::Expected<std::unique_ptr<BatchBinder>>
+  create(llvm::StringRef moduleInput, bool enableInMemoryInput,
+         bool treatWarningsAsErrors,
+         BindArgumentsImplementationFactory &factory,
+         const OptDiagnosticCallback &onDiagnostic);
+
+  // bind each of argumentSets and return the payloads in outputs, in the same
+  // order. If threadPool is given the argument sets are bound concurrently
+  // on it and their diagnostics are passed to onDiagnostic on the calling
+  // thread, in the order of the argument sets. Fails with the errors of all
+  // argument sets which could not be bound.
+  llvm::Error bind(llvm::ArrayRef<const ArgumentSource *> argumentSets,
+                   std::vector<std::string> &outputs,
+                   const OptDiagnosticCallback &onDiagnostic,
+                   llvm::ThreadPool *threadPool = nullptr) const;
+
+  // the number of binaries patched per argument set
+  size_t getNumBinaries() const { return binaries.size(); }
+
+private:
+  struct Binary {
+    // the unpatched contents, as read from the payload
+    qssc::payload::PatchablePayload::ContentBuffer const *data;
+    std::vector<PatchPoint> const *patchPoints;
+  };
+
+  BatchBinder(BindArgumentsImplementationFactory &factory,
+              bool treatWarningsAsErrors)
+      : factory(factory), treatWarningsAsErrors(treatWarningsAsErrors) {}
+
+  llvm::Error bind_(ArgumentSource const &arguments, std::string &output,
+                    const OptDiagnosticCallback &onDiagnostic) const;
+
+  BindArgumentsImplementationFactory &factory;
+  bool treatWarningsAsErrors;
+  std::string input;
+  std::unique_ptr<BindArgumentsImplementation> payloadImpl;
+  std::unique_ptr<qssc::payload::PatchablePayload> payload;
+  Signature sig;
+  std::vector<Binary> binaries;
+};
 
 } // namespace qssc::arguments
 
@@ -1,6 +1,6 @@
 //===- Signature.h ----------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -25,28 +25,49 @@
 
 #include "API/errors.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/StringSaver.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
 
 namespace qssc::arguments {
 
+// A patch point refers to its expression and patch type strings rather than
+// owning them. The strings of patch points added to a Signature are interned
+// in the signature.
+//
+// A patch point of a single parameter may also carry the slot the compiler
+// assigned to the parameter, e.g., by ParameterInitialValueAnalysis. Patch
+// points with the same slot refer to the same parameter, such that binding
+// resolves the expression of each slot once rather than once per patch point.
 class PatchPoint {
-  std::string expression_;
-  std::string patchType_;
+  llvm::StringRef expression_;
+  llvm::StringRef patchType_;
   // TODO we will have more types of patch points, need more flexible structure
   // for parameters
   uint64_t offset_;
+  uint32_t parameterSlot_;
 
 public:
+  static constexpr uint32_t noParameterSlot = UINT32_MAX;
+
   PatchPoint(llvm::StringRef expression, llvm::StringRef patchType,
-             uint64_t offset)
-      : expression_(expression), patchType_(patchType), offset_(offset) {}
+             uint64_t offset, uint32_t parameterSlot = noParameterSlot)
+      : expression_(expression), patchType_(patchType), offset_(offset),
+        parameterSlot_(parameterSlot) {}
 
   friend struct Signature;
 
@@ -54,30 +75,153 @@ public:
   llvm::StringRef expression() const { return expression_; }
   llvm::StringRef patchType() const { return patchType_; }
   uint64_t offset() const { return offset_; }
+  // the slot of the parameter patched, or std::nullopt if there is none
+  std::optional<uint32_t> parameterSlot() const {
+    if (parameterSlot_ == noParameterSlot)
+      return std::nullopt;
+    return parameterSlot_;
+  }
 };
 
 using PatchPointVector = std::vector<PatchPoint>;
 
 struct Signature {
-  // TODO consider deduplicating strings by using UniqueStringSaver
-  // Use std::map instead of StringMap to preserve order
-  std::map<std::string, std::vector<PatchPoint>> patchPointsByBinary;
+  // Use std::map instead of StringMap to preserve order. The transparent
+  // comparator allows looking up binaries by StringRef without allocating.
+  using PatchPointsByBinary =
+      std::map<std::string, std::vector<PatchPoint>, std::less<>>;
+  PatchPointsByBinary patchPointsByBinary;
 
 public:
-  void addParameterPatchPoint(llvm::StringRef expression,
-                              llvm::StringRef patchType,
-                              llvm::StringRef binaryComponent, uint64_t offset);
+  Signature() = default;
+  Signature(const Signature &) = default;
+  Signature &operator=(const Signature &) = default;
+  // Moving transfers the patch points together with the strings they refer
+  // to and leaves other empty, such that none of its patch points dangle.
+  Signature(Signature &&other) noexcept;
+  Signature &operator=(Signature &&other) noexcept;
+
+  // Adding patch points only allocates for the first patch point of a binary,
+  // for strings not seen before, and when the patch points of a binary grow
+  // beyond their reserved capacity.
+  void addParameterPatchPoint(
+      llvm::StringRef expression, llvm::StringRef patchType,
+      llvm::StringRef binaryComponent, uint64_t offset,
+      uint32_t parameterSlot = PatchPoint::noParameterSlot);
   void addParameterPatchPoint(llvm::StringRef binaryComponent,
                               const PatchPoint &p);
+  // reserve room for numPatchPoints patch points of binaryComponent
+  void reservePatchPoints(llvm::StringRef binaryComponent,
+                          size_t numPatchPoints);
   void dump();
 
+  // serialize to the human readable text format
   std::string serialize() const;
+  // serialize to the binary format read by SignatureView
+  std::string serializeBinary() const;
 
+  // deserialize from either the text or the binary format
   static llvm::Expected<Signature>
   deserialize(llvm::StringRef, const qssc::OptDiagnosticCallback &onDiagnostic,
               bool treatWarningsAsError = false);
 
   bool isEmpty() const { return patchPointsByBinary.size() == 0; }
+
+private:
+  static llvm::Expected<Signature>
+  deserializeText_(llvm::StringRef buffer,
+                   const qssc::OptDiagnosticCallback &onDiagnostic,
+                   bool treatWarningsAsErrors);
+
+  // Expressions and patch types repeat across many patch points. They are
+  // stored once and shared by copies of the signature. A moved-from
+  // signature has no storage until a patch point is added to it.
+  struct StringStorage {
+    llvm::BumpPtrAllocator allocator;
+    llvm::UniqueStringSaver saver{allocator};
+  };
+  std::shared_ptr<StringStorage> strings = std::make_shared<StringStorage>();
+
+  StringStorage &getStrings_();
+
+  std::vector<PatchPoint> &getPatchPoints_(llvm::StringRef binaryComponent);
+};
+
+// A read-only view of a signature in the binary format that requires no
+// parsing and no allocations, e.g., directly on a signature read from (or
+// mapped out of) a payload. The buffer must outlive the view.
+//
+// The format, with all integers little endian:
+//   header:       magic "QSSCSIG\0", version, number of binaries, number of
+//                 patch points, string table size (each 32 bit)
+//   binaries:     one BinaryRecord per binary, ordered by name
+//   patch points: one PatchPointRecord per patch point, grouped by binary,
+//                 with a parameter slot of 0xffffffff if there is none
+//   strings:      the null terminated strings, referred to by their offset
+class SignatureView {
+public:
+  using ulittle32_t = llvm::support::ulittle32_t;
+  using ulittle64_t = llvm::support::ulittle64_t;
+
+  struct Header {
+    char magic[8];
+    ulittle32_t version;
+    ulittle32_t numBinaries;
+    ulittle32_t numPatchPoints;
+    ulittle32_t stringTableSize;
+  };
+
+  struct BinaryRecord {
+    ulittle32_t nameId;
+    ulittle32_t firstPatchPoint;
+    ulittle32_t numPatchPoints;
+    ulittle32_t reserved;
+  };
+
+  struct PatchPointRecord {
+    ulittle32_t expressionId;
+    ulittle32_t patchTypeId;
+    ulittle64_t offset;
+    ulittle32_t parameterSlot;
+    ulittle32_t reserved;
+  };
+
+  static constexpr char binaryMagic[8] = {'Q', 'S', 'S', 'C',
+                                          'S', 'I', 'G', '\0'};
+  static constexpr uint32_t binaryVersion = 2;
+
+  // whether buffer holds a signature in the binary format
+  static bool isBinarySignature(llvm::StringRef buffer);
+
+  // Create a view of buffer. Only the bounds of the tables and the string
+  // references are validated, no patch point is copied.
+  static llvm::Expected<SignatureView>
+  create(llvm::StringRef buffer,
+         const qssc::OptDiagnosticCallback &onDiagnostic);
+
+  size_t getNumBinaries() const { return binaries.size(); }
+  size_t getNumPatchPoints() const { return patchPoints.size(); }
+  llvm::StringRef getBinaryName(size_t binary) const {
+    return getString(binaries[binary].nameId);
+  }
+  llvm::ArrayRef<PatchPointRecord> getPatchPoints(size_t binary) const {
+    return patchPoints.slice(binaries[binary].firstPatchPoint,
+                             binaries[binary].numPatchPoints);
+  }
+  llvm::StringRef getString(uint32_t id) const {
+    return {stringTable.data() + id};
+  }
+  PatchPoint getPatchPoint(const PatchPointRecord &record) const {
+    return {getString(record.expressionId), getString(record.patchTypeId),
+            record.offset, record.parameterSlot};
+  }
+
+private:
+  SignatureView() = default;
+
+  llvm::ArrayRef<BinaryRecord> binaries;
+  llvm::ArrayRef<PatchPointRecord> patchPoints;
+  llvm::StringRef stringTable;
 };
 
 } // namespace qssc::arguments
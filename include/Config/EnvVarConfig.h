@@ -33,6 +33,11 @@ namespace qssc::config {
 /// "ERROR/WARN/INFO/DEBUG".
 /// - `QSSC_MAX_THREADS`: Sets the maximum number of compiler threads when
 /// initializing the MLIR context's threadpool.
+/// - `QSSC_COMPILE_CACHE_DIR`: Sets QSSConfig::compileCacheDir.
+/// - `QSSC_PROFILER_MARKERS`: Sets QSSConfig::profilerMarkers. One of
+/// "none/itt".
+/// - `QSSC_COMPILE_PRIORITY`: Sets QSSConfig::compilePriority. One of
+/// "low/normal/high".
 ///
 class EnvVarConfigBuilder : public QSSConfigBuilder {
 public:
@@ -43,6 +48,9 @@ private:
   llvm::Error populateTarget_(QSSConfig &config);
   llvm::Error populateVerbosity_(QSSConfig &config);
   llvm::Error populateMaxThreads_(QSSConfig &config);
+  llvm::Error populateCompileCacheDir_(QSSConfig &config);
+  llvm::Error populateProfilerMarkers_(QSSConfig &config);
+  llvm::Error populateCompilePriority_(QSSConfig &config);
 };
 
 } // namespace qssc::config
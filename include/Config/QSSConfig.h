@@ -14,6 +14,8 @@
 #ifndef QSSC_QSSCONFIG_H
 #define QSSC_QSSCONFIG_H
 
+#include "Utils/CompileControl.h"
+
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -21,6 +23,7 @@
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -61,12 +64,31 @@ enum class FileExtension {
 
 enum class InputType { Undetected, QASM, MLIR, Bytecode };
 
+/// @brief Which artifacts targets write into the payload. Debug payloads also
+/// hold textual artifacts such as the IR of each target, production payloads
+/// only what is required to run the program.
+enum class PayloadProfile { Debug, Production };
+
+/// @brief Which sampling profiler the compile phases are annotated for, as
+/// zones in its timeline. ITT markers are read by VTune.
+enum class ProfilerMarkers { None, ITT };
+
+/// @brief Priority of a compilation for the thread pool shared by the
+/// compilations of the process.
+enum class CompilePriority { Low, Normal, High };
+
 std::string to_string(const EmitAction &inExt);
 
 std::string to_string(const FileExtension &inExt);
 
 std::string to_string(const InputType &inType);
 
+std::string to_string(const PayloadProfile &profile);
+
+std::string to_string(const ProfilerMarkers &markers);
+
+std::string to_string(const CompilePriority &priority);
+
 FileExtension inputTypeToFileExtension(const InputType &inputType);
 
 InputType fileExtensionToInputType(const FileExtension &inExt);
@@ -165,6 +187,39 @@ public:
   }
   bool shouldEmitPlaintextPayload() const { return emitPlaintextPayloadFlag; }
 
+  QSSConfig &setPayloadProfile(PayloadProfile profile) {
+    payloadProfile = profile;
+    return *this;
+  }
+  PayloadProfile getPayloadProfile() const { return payloadProfile; }
+
+  QSSConfig &setPayloadFormat(std::string format) {
+    payloadFormat = std::move(format);
+    return *this;
+  }
+  /// @brief The registered payload written for the qem emit action
+  llvm::StringRef getPayloadFormat() const { return payloadFormat; }
+
+  QSSConfig &setPayloadDeltaBase(std::string manifestPath) {
+    payloadDeltaBase = std::move(manifestPath);
+    return *this;
+  }
+  /// @brief The manifest of the previous payload the payload is written as a
+  /// delta against, if any
+  std::optional<llvm::StringRef> getPayloadDeltaBase() const {
+    if (payloadDeltaBase.has_value())
+      return payloadDeltaBase.value();
+    return std::nullopt;
+  }
+
+  QSSConfig &setDtTimestep(std::optional<double> seconds) {
+    dtTimestep = seconds;
+    return *this;
+  }
+  /// @brief The duration in seconds of a sample of the scheduled program,
+  /// with which the runtime estimate of the payload is computed, if known
+  std::optional<double> getDtTimestep() const { return dtTimestep; }
+
   QSSConfig &includeSource(bool flag) {
     includeSourceFlag = flag;
     return *this;
@@ -186,16 +241,20 @@ public:
   }
 
   QSSConfig &setPassPlugins(std::vector<std::string> plugins) {
-    dialectPlugins = std::move(plugins);
+    passPlugins = std::move(plugins);
     return *this;
   }
-  const std::vector<std::string> &getPassPlugins() { return dialectPlugins; }
+  const std::vector<std::string> &getPassPlugins() const {
+    return passPlugins;
+  }
 
   QSSConfig &setDialectPlugins(std::vector<std::string> plugins) {
     dialectPlugins = std::move(plugins);
     return *this;
   }
-  const std::vector<std::string> &getDialectPlugins() { return dialectPlugins; }
+  const std::vector<std::string> &getDialectPlugins() const {
+    return dialectPlugins;
+  }
 
   QSSConfig &setMaxThreads(unsigned int maxThreads_) {
     maxThreads = maxThreads_;
@@ -203,6 +262,155 @@ public:
   }
   std::optional<unsigned int> getMaxThreads() const { return maxThreads; }
 
+  QSSConfig &setCompileCacheDir(std::optional<std::string> dir) {
+    compileCacheDir = std::move(dir);
+    return *this;
+  }
+  std::optional<llvm::StringRef> getCompileCacheDir() const {
+    if (compileCacheDir.has_value())
+      return compileCacheDir.value();
+    return std::nullopt;
+  }
+
+  QSSConfig &setCompileCacheEntries(unsigned int entries) {
+    compileCacheEntries = entries;
+    return *this;
+  }
+  unsigned int getCompileCacheEntries() const { return compileCacheEntries; }
+
+  /// @brief Is a compilation cache backend configured.
+  bool shouldUseCompileCache() const {
+    return compileCacheDir.has_value() || compileCacheEntries > 0;
+  }
+
+  QSSConfig &setCompileCacheFrontend(bool flag) {
+    compileCacheFrontend = flag;
+    return *this;
+  }
+  bool getCompileCacheFrontend() const { return compileCacheFrontend; }
+
+  /// @brief Should the modules emitted by the OpenQASM 3 frontend be cached.
+  bool shouldCacheFrontend() const {
+    return compileCacheFrontend && shouldUseCompileCache();
+  }
+
+  QSSConfig &setVerifyStages(bool flag) {
+    verifyStagesFlag = flag;
+    return *this;
+  }
+  /// @brief Should the module be verified only between the compilation stages,
+  /// with cheap structural checks after each pass, instead of after each pass.
+  bool shouldVerifyStages() const { return verifyStagesFlag; }
+
+  QSSConfig &setReportPassMemory(bool flag) {
+    reportPassMemoryFlag = flag;
+    return *this;
+  }
+  /// @brief Should the growth of the peak resident set size and of the heap
+  /// be reported for each pass and target.
+  bool shouldReportPassMemory() const { return reportPassMemoryFlag; }
+
+  QSSConfig &setTimingTraceFile(std::optional<std::string> file) {
+    timingTraceFile = std::move(file);
+    return *this;
+  }
+  /// @brief The file to write a trace of the compilation timers to, in the
+  /// Chrome trace event format.
+  std::optional<llvm::StringRef> getTimingTraceFile() const {
+    if (timingTraceFile.has_value())
+      return timingTraceFile.value();
+    return std::nullopt;
+  }
+
+  QSSConfig &setCompileDeadline(std::optional<unsigned int> milliseconds) {
+    compileDeadline = milliseconds;
+    return *this;
+  }
+  /// @brief The time in milliseconds after which optional work, e.g.
+  /// optimizations, is skipped such that the compilation finishes on time.
+  std::optional<unsigned int> getCompileDeadline() const {
+    return compileDeadline;
+  }
+
+  QSSConfig &setMemoryBudget(std::optional<unsigned int> mebibytes) {
+    memoryBudget = mebibytes;
+    return *this;
+  }
+  /// @brief The peak resident set size in MiB above which optional work is
+  /// skipped.
+  std::optional<unsigned int> getMemoryBudget() const { return memoryBudget; }
+
+  QSSConfig &setDiagnosticRepeatLimit(std::optional<unsigned int> limit) {
+    diagnosticRepeatLimit = limit;
+    return *this;
+  }
+  /// @brief The number of diagnostics with the same severity, category and
+  /// message delivered per compilation, the others are summarized.
+  std::optional<unsigned int> getDiagnosticRepeatLimit() const {
+    return diagnosticRepeatLimit;
+  }
+
+  QSSConfig &setMaxDiagnostics(std::optional<unsigned int> limit) {
+    maxDiagnostics = limit;
+    return *this;
+  }
+  /// @brief The number of non-error diagnostics delivered per compilation,
+  /// the others are summarized.
+  std::optional<unsigned int> getMaxDiagnostics() const {
+    return maxDiagnostics;
+  }
+
+  QSSConfig &setTraceContext(std::optional<std::string> id) {
+    traceContext = std::move(id);
+    return *this;
+  }
+  /// @brief The trace context ID of the caller, which is attached to the
+  /// timing trace and the compile report for correlation with the caller's
+  /// distributed tracing.
+  std::optional<llvm::StringRef> getTraceContext() const {
+    if (traceContext.has_value())
+      return traceContext.value();
+    return std::nullopt;
+  }
+
+  QSSConfig &setProfilerMarkers(ProfilerMarkers markers) {
+    profilerMarkers = markers;
+    return *this;
+  }
+  /// @brief The profiler the compile phases, i.e. the timers of targets,
+  /// passes and code generation stages, are annotated for.
+  ProfilerMarkers getProfilerMarkers() const { return profilerMarkers; }
+
+  QSSConfig &setCompilePriority(CompilePriority priority) {
+    compilePriority = priority;
+    return *this;
+  }
+  /// @brief The priority by which the compilation is granted the thread
+  /// pool shared by the compilations of the process.
+  CompilePriority getCompilePriority() const { return compilePriority; }
+
+  QSSConfig &
+  setCancellationToken(std::shared_ptr<utils::CancellationToken> token) {
+    cancellationToken = std::move(token);
+    return *this;
+  }
+  /// @brief The token through which the caller may cancel the compilation,
+  /// which then stops at its next check with an error.
+  const std::shared_ptr<utils::CancellationToken> &
+  getCancellationToken() const {
+    return cancellationToken;
+  }
+
+  QSSConfig &setProgressCallback(utils::ProgressCallback callback) {
+    progressCallback = std::move(callback);
+    return *this;
+  }
+  /// @brief The callback receiving the stages of the compilation as they
+  /// start.
+  const utils::ProgressCallback &getProgressCallback() const {
+    return progressCallback;
+  }
+
 public:
   /// @brief Emit the configuration to stdout.
   void emit(llvm::raw_ostream &out) const;
@@ -230,6 +438,15 @@ protected:
   std::string payloadName = "-";
   /// @brief Should the plaintext payload be emitted
   bool emitPlaintextPayloadFlag = false;
+  /// @brief Which artifacts targets write into the payload
+  PayloadProfile payloadProfile = PayloadProfile::Debug;
+  /// @brief Registered payload written for the qem emit action
+  std::string payloadFormat = "ZIP";
+  /// @brief Manifest of the previous payload delta payloads are written
+  /// against
+  std::optional<std::string> payloadDeltaBase = std::nullopt;
+  /// @brief Duration in seconds of a scheduling sample
+  std::optional<double> dtTimestep = std::nullopt;
   /// @brief Should the input source be included in the payload
   bool includeSourceFlag = false;
   /// @brief Should the IR be compiled for the target
@@ -242,6 +459,39 @@ protected:
   std::vector<std::string> dialectPlugins;
   /// @brief If set, enforces the maximum number of MLIR context threads
   std::optional<unsigned int> maxThreads;
+  /// @brief If set, directory of the on-disk compilation cache
+  std::optional<std::string> compileCacheDir = std::nullopt;
+  /// @brief Capacity of the in-process compilation cache, 0 disables it
+  unsigned int compileCacheEntries = 0;
+  /// @brief Also cache the modules emitted by the OpenQASM 3 frontend, keyed
+  /// on the source without the initial values of its input parameters
+  bool compileCacheFrontend = false;
+  /// @brief Verify the module fully only after the frontend, the command line
+  /// pass pipeline and the target pass pipelines
+  bool verifyStagesFlag = false;
+  /// @brief Report the memory growth of each pass
+  bool reportPassMemoryFlag = false;
+  /// @brief If set, file to write the compilation timers to as a trace
+  std::optional<std::string> timingTraceFile = std::nullopt;
+  /// @brief If set, milliseconds after which optional work is skipped
+  std::optional<unsigned int> compileDeadline = std::nullopt;
+  /// @brief If set, peak resident set size in MiB above which optional work
+  /// is skipped
+  std::optional<unsigned int> memoryBudget = std::nullopt;
+  /// @brief If set, number of repeats of a diagnostic delivered
+  std::optional<unsigned int> diagnosticRepeatLimit = std::nullopt;
+  /// @brief If set, number of non-error diagnostics delivered
+  std::optional<unsigned int> maxDiagnostics = std::nullopt;
+  /// @brief If set, trace context ID of the caller to correlate with
+  std::optional<std::string> traceContext = std::nullopt;
+  /// @brief Profiler the compile phases are annotated for
+  ProfilerMarkers profilerMarkers = ProfilerMarkers::None;
+  /// @brief Priority of the compilation for the shared thread pool
+  CompilePriority compilePriority = CompilePriority::Normal;
+  /// @brief If set, token through which the caller cancels the compilation
+  std::shared_ptr<utils::CancellationToken> cancellationToken;
+  /// @brief If set, callback receiving the progress of the compilation
+  utils::ProgressCallback progressCallback;
 };
 
 llvm::raw_ostream &operator<<(llvm::raw_ostream &os, const QSSConfig &config);
@@ -268,6 +518,14 @@ mlir::LogicalResult loadDialectPlugin(const std::string &pluginPath,
 /// @param pluginPath Path to the plugin
 mlir::LogicalResult loadPassPlugin(const std::string &pluginPath);
 
+/// @brief Load the pass and dialect plugins of the configuration and register
+/// the plugin dialects with the context. Plugins are loaded once per process,
+/// later calls for the same plugins only register them with new contexts.
+/// @param config The configuration naming the plugins
+/// @param context The context to register the plugin dialects with
+mlir::LogicalResult loadPlugins(const QSSConfig &config,
+                                mlir::MLIRContext *context);
+
 /// @brief A builder class for the QSSConfig. All standard configuration
 /// population should be completed through builders.
 class QSSConfigBuilder {
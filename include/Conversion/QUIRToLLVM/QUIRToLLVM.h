@@ -33,14 +33,35 @@
 #include "mlir/Conversion/LLVMCommon/TypeConverter.h"
 #include "mlir/Conversion/MemRefToLLVM/MemRefToLLVM.h"
 #include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/BuiltinDialect.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
+#include "mlir/Target/LLVMIR/LLVMTranslationInterface.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 #include "llvm/Support/Error.h"
 
 namespace mlir::quir {
+/// Register the translations of the builtin and LLVM dialects to LLVM IR with
+/// the context unless they are already present. Appending to the context's
+/// dialect registry is not thread-safe; skipping it when the translations were
+/// registered up front allows translating the modules of several targets
+/// concurrently.
+static void registerLLVMTranslations(mlir::MLIRContext &context) {
+  auto hasTranslation = [](mlir::Dialect *dialect) {
+    using TranslationInterface = mlir::LLVMTranslationDialectInterface;
+    return dialect && dialect->getRegisteredInterface<TranslationInterface>();
+  };
+  if (hasTranslation(context.getLoadedDialect<mlir::BuiltinDialect>()) &&
+      hasTranslation(context.getLoadedDialect<mlir::LLVM::LLVMDialect>()))
+    return;
+
+  mlir::registerBuiltinDialectTranslation(context);
+  mlir::registerLLVMDialectTranslation(context);
+}
+
 static auto translateModuleToLLVMDialect(mlir::ModuleOp op,
                                          llvm::DataLayout &dataLayout)
     -> llvm::Error {
@@ -57,8 +78,7 @@ static auto translateModuleToLLVMDialect(mlir::ModuleOp op,
 
   // Register LLVM dialect and all infrastructure required for translation to
   // LLVM IR
-  mlir::registerBuiltinDialectTranslation(*context);
-  mlir::registerLLVMDialectTranslation(*context);
+  registerLLVMTranslations(*context);
 
   mlir::LLVMConversionTarget target(*context);
   target.addLegalDialect<mlir::LLVM::LLVMDialect>();
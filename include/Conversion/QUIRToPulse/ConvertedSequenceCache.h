@@ -0,0 +1,94 @@
+//===- ConvertedSequenceCache.h - Cache of converted circuits ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares a process-wide cache of the pulse sequences the
+///  QUIRToPulsePass converts circuits to, used by its incremental mode.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef CONVERTED_SEQUENCE_CACHE_H
+#define CONVERTED_SEQUENCE_CACHE_H
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace mlir::pulse {
+
+// Process-wide cache of converted pulse sequences, keyed on a digest the
+// caller computes over everything the conversion read. Sequences are kept in
+// bytecode, which does not depend on the context it was written from, such
+// that later compilations in other contexts reuse them. Entries may also be
+// kept in a directory shared between processes; they are written to a
+// temporary file and renamed into place. Once the cache holds maxEntries
+// sequences, the oldest are dropped. The cache is safe to use from several
+// threads at once.
+class ConvertedSequenceCache {
+public:
+  struct Statistics {
+    // lookups served from the process or the directory
+    uint64_t hits{0};
+    // lookups of sequences which were not cached
+    uint64_t misses{0};
+  };
+
+  static constexpr size_t maxEntries = 4096;
+
+  static ConvertedSequenceCache &get();
+
+  /// Read the sequence stored for key into context, looking in directory
+  /// unless it is empty and the process does not hold the sequence. The
+  /// sequence is detached and owned by the caller, it is null on a miss.
+  mlir::OwningOpRef<SequenceOp> lookup(llvm::StringRef key,
+                                       mlir::MLIRContext *context,
+                                       llvm::StringRef directory = {});
+
+  /// Store the detached sequence for key, and in directory unless it is
+  /// empty. Sequences which can not be stored are not cached.
+  void store(llvm::StringRef key, SequenceOp sequence,
+             llvm::StringRef directory = {});
+
+  /// Drop all sequences cached in the process
+  void clear();
+
+  Statistics getStatistics();
+
+private:
+  using Bytecode = std::shared_ptr<const std::string>;
+
+  void insert_(llvm::StringRef key, Bytecode bytecode);
+
+  std::mutex mutex;
+  llvm::StringMap<Bytecode> entries;
+  // the keys of entries from the oldest to the most recently stored
+  std::deque<std::string> order;
+  Statistics statistics;
+};
+
+} // namespace mlir::pulse
+
+#endif // CONVERTED_SEQUENCE_CACHE_H
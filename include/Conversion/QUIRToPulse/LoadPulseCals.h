@@ -1,6 +1,6 @@
 //===- LoadPulseCals.h ------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -21,11 +21,17 @@
 #ifndef LOAD_PULSE_CALS_H
 #define LOAD_PULSE_CALS_H
 
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+
 #include <unordered_set>
 #include <vector>
 
@@ -93,15 +99,39 @@ struct LoadPulseCalsPass
                      mlir::quir::CallCircuitOp callCircuitOp,
                      mlir::func::FuncOp funcOp);
 
+  // return the pulse cal of gateName on qubits, merging the pulse cals of the
+  // individual qubits if there is none for the qubit tuple. postMerge is
+  // applied to newly merged pulse cals only.
+  mlir::pulse::SequenceOp getOrMergePulseCal(
+      mlir::Operation *op, std::string &gateName,
+      const std::string &gateMangledName, std::vector<uint32_t> &qubits,
+      llvm::function_ref<void(mlir::pulse::SequenceOp)> postMerge = {});
+  // return the pulse cal named gateMangledName, or report it missing at op
+  // and return nullptr. Each missing pulse cal is reported once.
+  mlir::pulse::SequenceOp lookupPulseCal(mlir::Operation *op,
+                                         llvm::StringRef gateMangledName);
+  // names of the pulse cals built by merging in this run
+  llvm::StringSet<> mergedPulseCals;
+
+  Statistic numMergedPulseCals{
+      this, "num-merged-pulse-cals",
+      "Number of pulse cals built by merging the pulse cals of single qubits"};
+  Statistic numReusedMergedPulseCals{
+      this, "num-reused-merged-pulse-cals",
+      "Number of gates using a merged pulse cal built for an earlier gate"};
+
   void addPulseCalToModule(mlir::func::FuncOp funcOp,
                            mlir::pulse::SequenceOp sequenceOp);
 
   // parse the pulse cals and return the parsed module
   llvm::Error parsePulseCalsModuleOp(std::string &pulseCalsPath,
-                                     mlir::OwningOpRef<ModuleOp> &owningOpRef);
-  mlir::OwningOpRef<ModuleOp> defaultPulseCalsModule;
-  mlir::OwningOpRef<ModuleOp> additionalPulseCalsModule;
-  std::map<std::string, SequenceOp> pulseCalsNameToSequenceMap;
+                                     PulseCalsCache::LazyModule &lazyModule);
+  PulseCalsCache::LazyModule defaultPulseCalsModule;
+  PulseCalsCache::LazyModule additionalPulseCalsModule;
+  // read the body of a lazily loaded pulse cal before it is used
+  mlir::LogicalResult materializePulseCal(mlir::pulse::SequenceOp sequenceOp);
+  // pulse cals by name; missing pulse cals are cached as nullptr
+  llvm::StringMap<SequenceOp> pulseCalsNameToSequenceMap;
 
   mlir::pulse::SequenceOp
   mergePulseSequenceOps(std::vector<mlir::pulse::SequenceOp> &sequenceOps,
@@ -0,0 +1,134 @@
+//===- PulseCalsCache.h - Cache of parsed pulse calibrations ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares a process-wide cache of the pulse calibration and
+///  waveform container files loaded by the LoadPulseCalsPass and the
+///  QUIRToPulsePass.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_CALS_CACHE_H
+#define PULSE_CALS_CACHE_H
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace mlir::pulse {
+
+// Process-wide cache of pulse calibration and waveform container files,
+// keyed on their path. Textual files are parsed once and kept in bytecode,
+// which does not depend on the context it was parsed in, such that every
+// load only deserializes the bytecode into the requested context. Bytecode
+// files are kept as they are. A file is reloaded when its modification time
+// or size change and its contents hash differently. Files modified so
+// recently that their modification time may not tell edits apart have their
+// contents hashed on every load.
+//
+// Loads served from bytecode may be lazy, reading the bodies of isolated
+// operations, e.g. pulse sequences, only once they are materialized. Every
+// load returns a new module owned by the caller, so passes may modify the
+// loaded module freely. The cache is safe to use from several threads at
+// once.
+class PulseCalsCache {
+public:
+  struct Statistics {
+    // loads served from the cached bytecode
+    uint64_t hits{0};
+    // loads that read a file which was not cached or has changed
+    uint64_t misses{0};
+  };
+
+  // A loaded module whose isolated operations may have to be materialized
+  // before their bodies are accessed. Operations not materialized when the
+  // module is destroyed are never read.
+  class LazyModule {
+  public:
+    LazyModule() = default;
+    LazyModule(LazyModule &&other) = default;
+    LazyModule &operator=(LazyModule &&other);
+    ~LazyModule();
+
+    mlir::ModuleOp get() const { return module.get(); }
+    explicit operator bool() const { return static_cast<bool>(module); }
+
+    /// Read the body of op if it has not been read yet
+    mlir::LogicalResult materialize(mlir::Operation *op);
+
+  private:
+    friend class PulseCalsCache;
+
+    void finalize_();
+
+    // the buffer and parser configuration must outlive the reader, and
+    // resources of the module may reference the buffer
+    std::shared_ptr<llvm::SourceMgr> buffer;
+    std::unique_ptr<mlir::ParserConfig> config;
+    std::unique_ptr<mlir::BytecodeReader> reader;
+    mlir::OwningOpRef<mlir::ModuleOp> module;
+  };
+
+  static PulseCalsCache &get();
+
+  /// Load the module at path into context, with lazy set only reading the
+  /// bodies of isolated operations on LazyModule::materialize
+  llvm::Expected<LazyModule> load(llvm::StringRef path,
+                                  mlir::MLIRContext *context,
+                                  bool lazy = false);
+
+  /// Drop all cached files
+  void clear();
+
+  Statistics getStatistics();
+
+private:
+  // read a module from the bytecode in buffer, a failure is treated as a
+  // cache miss
+  static mlir::FailureOr<LazyModule>
+  readModule_(std::shared_ptr<llvm::SourceMgr> buffer,
+              mlir::MLIRContext *context, bool lazy);
+
+  struct Entry {
+    llvm::sys::TimePoint<> modificationTime;
+    uint64_t size{0};
+    uint64_t contentHash{0};
+    // when the entry was last validated, used to detect modifications within
+    // the granularity of the modification time
+    llvm::sys::TimePoint<> validatedAt;
+    std::shared_ptr<llvm::SourceMgr> bytecode;
+  };
+
+  std::mutex mutex;
+  llvm::StringMap<Entry> entries;
+  Statistics statistics;
+};
+
+} // namespace mlir::pulse
+
+#endif // PULSE_CALS_CACHE_H
@@ -1,6 +1,6 @@
 //===- QUIRToPulse.h - Convert QUIR to Pulse Dialect ------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -21,16 +21,29 @@
 #ifndef QUIRTOPULSE_CONVERSION_H
 #define QUIRTOPULSE_CONVERSION_H
 
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
+#include "Conversion/QUIRToPulse/WaveformLibrary.h"
 #include "Dialect/OQ3/IR/OQ3Ops.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 #include "Dialect/QCS/IR/QCSOps.h"
 #include "Utils/SymbolCacheAnalysis.h"
 
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Location.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <queue>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace mlir::pulse {
 
@@ -61,99 +74,183 @@ struct QUIRToPulsePass
       llvm::cl::desc("an MLIR file containing waveform container operations"),
       llvm::cl::value_desc("filename"), llvm::cl::init("")};
 
+  // lower angle<N> to an iN fixed-point phase in units of 2pi / 2^N, such that
+  // controllers can accumulate phases with wrapping integer arithmetic, rather
+  // than to an f64 in radians
+  Option<bool> fixedPointAngles{
+      *this, "fixed-point-angles",
+      llvm::cl::desc("Lower angles to fixed-point phases of the angle width "
+                     "instead of f64"),
+      llvm::cl::init(false)};
+
+  // in incremental mode, circuits converted by an earlier run, in this
+  // process or, with incremental-cache-dir, in any process sharing the
+  // directory, reuse their sequence if neither the circuit, the calibrations
+  // it calls, the constant durations of its call nor the options changed
+  Option<bool> incremental{
+      *this, "incremental",
+      llvm::cl::desc("Reuse the sequences of unchanged circuits converted by "
+                     "earlier runs"),
+      llvm::cl::init(false)};
+  Option<std::string> incrementalCacheDir{
+      *this, "incremental-cache-dir",
+      llvm::cl::desc("Directory sharing the sequences of the incremental mode "
+                     "between processes"),
+      llvm::cl::value_desc("directory"), llvm::cl::init("")};
+
   mlir::Operation *mainFuncFirstOp;
 
-  // convert quir circuit to pulse sequence
-  mlir::pulse::CallSequenceOp
-  convertCircuitToSequence(mlir::quir::CallCircuitOp &callCircuitOp,
-                           mlir::func::FuncOp &mainFunc, ModuleOp &moduleOp);
-  // helper datastructure for converting quir circuit to pulse sequence; these
-  // will be reset every time convertCircuitToSequence is called and will be
-  // used by several functions that are called within that function
-  uint convertedSequenceOpArgIndex;
-  std::unordered_map<uint, uint> circuitArgToConvertedSequenceArgMap;
-  SmallVector<Value> convertedPulseSequenceOpArgs;
-  std::unordered_map<std::string, uint> operandNameToIndexMap;
+  // a quir circuit converted to a pulse sequence. The sequence is built
+  // detached from the module, and records what its call has to pass for each
+  // of its arguments, such that circuits are converted in parallel and the
+  // operands are added to main afterwards.
+  struct ConvertedCircuit {
+    struct Operand {
+      enum class Kind { Angle, Duration, Port, MixFrame, Waveform };
+      Kind kind;
+      // the index of the circuit argument for angles and durations
+      uint circuitArgIndex{0};
+      // the port, mixframe or waveform name
+      mlir::StringAttr name;
+      // the port of a mixframe
+      mlir::StringAttr portName;
+    };
+
+    // the first call of the circuit, which the conversion reads the constant
+    // durations of delays from
+    mlir::quir::CallCircuitOp callCircuitOp;
+    mlir::quir::CircuitOp circuitOp;
+    mlir::pulse::SequenceOp sequenceOp;
+    // the operands of the call, one per argument of sequenceOp
+    llvm::SmallVector<Operand> operands;
+
+    // helper datastructures used while building the sequence
+    std::unordered_map<uint, uint> circuitArgToConvertedSequenceArgMap;
+    llvm::DenseMap<mlir::StringAttr, uint> operandNameToIndexMap;
+    // map of the quir angle/duration ops to the constants created for them in
+    // the sequence
+    llvm::DenseMap<mlir::Operation *, mlir::Value> opToConstantMap;
+  };
+
+  // convert quir circuit to a detached pulse sequence; this only reads the
+  // module and is run for several circuits in parallel
+  void convertCircuitToSequence(ConvertedCircuit &circuit);
+  // add the converted sequence, unless an earlier call added it, and the
+  // operands of callCircuitOp to the module, and replace callCircuitOp
+  void materializeSequence(ConvertedCircuit &circuit,
+                           mlir::quir::CallCircuitOp callCircuitOp,
+                           mlir::func::FuncOp &mainFunc);
+  // the constant durations passed to a circuit call; calls passing different
+  // durations get different sequences
+  std::vector<uint64_t>
+  getConstantDurationOperands(mlir::quir::CallCircuitOp callCircuitOp);
+
+  Statistic numConvertedCircuits{
+      this, "num-converted-circuits",
+      "Number of circuits converted to pulse sequences"};
+  Statistic numReusedSequences{
+      this, "num-reused-sequences",
+      "Number of circuit calls reusing the sequence of an earlier call"};
+  Statistic numCachedSequences{
+      this, "num-cached-sequences",
+      "Number of circuits reusing the sequence of an earlier run"};
+
+  // the digest of a pulse cal sequence and the sequences it calls, which the
+  // cache keys of the incremental mode are computed from
+  struct CalSequenceDigest {
+    std::string hash;
+    llvm::SmallVector<mlir::StringAttr> callees;
+  };
+  llvm::DenseMap<mlir::StringAttr, CalSequenceDigest> calSequenceDigests;
+  // digest the pulse cal sequences of the module
+  void digestCalSequences(mlir::ModuleOp moduleOp);
+  // the cache key of circuit over the circuit, the pulse cal sequences it
+  // calls, including their transitive callees, the constant durations of its
+  // call and the options
+  std::string getCacheKey(ConvertedCircuit &circuit);
+  // read the sequence and the operands of circuit from the cache, returns
+  // whether it was cached
+  bool readCachedSequence(ConvertedCircuit &circuit, llvm::StringRef key);
+  void storeCachedSequence(ConvertedCircuit &circuit, llvm::StringRef key);
 
   // process the args of the circuit op, and add corresponding args to the
   // converted pulse sequence op
-  void processCircuitArgs(mlir::quir::CallCircuitOp &callCircuitOp,
-                          mlir::quir::CircuitOp &circuitOp,
-                          SequenceOp &convertedPulseSequenceOp,
-                          mlir::func::FuncOp &mainFunc,
-                          mlir::OpBuilder &builder);
+  void processCircuitArgs(ConvertedCircuit &circuit, mlir::OpBuilder &builder);
 
   // process the args of the pulse cal sequence op corresponding to quirOp
   void processPulseCalArgs(mlir::Operation *quirOp,
                            SequenceOp &pulseCalSequenceOp,
                            SmallVector<Value> &pulseCalSeqArgs,
-                           SequenceOp &convertedPulseSequenceOp,
-                           mlir::func::FuncOp &mainFunc,
+                           ConvertedCircuit &circuit,
                            mlir::OpBuilder &builder);
   void getQUIROpClassicalOperands(mlir::Operation *quirOp,
                                   std::queue<Value> &angleOperands,
                                   std::queue<Value> &durationOperands);
-  void processMixFrameOpArg(std::string const &mixFrameName,
-                            std::string const &portName,
-                            SequenceOp &convertedPulseSequenceOp,
-                            SmallVector<Value> &quirOpPulseCalSeqArgs,
-                            Value argumentValue, mlir::func::FuncOp &mainFunc,
-                            mlir::OpBuilder &builder);
-  void processPortOpArg(std::string const &portName,
-                        SequenceOp &convertedPulseSequenceOp,
-                        SmallVector<Value> &quirOpPulseCalSeqArgs,
-                        Value argumentValue, mlir::func::FuncOp &mainFunc,
-                        mlir::OpBuilder &builder);
-  void processWfrOpArg(std::string const &wfrName,
-                       SequenceOp &convertedPulseSequenceOp,
+  // add an argument of the given kind to the converted pulse sequence, unless
+  // there is one for name already, and pass it to the pulse cal
+  void processNamedArg(ConvertedCircuit::Operand::Kind kind,
+                       mlir::StringAttr name, mlir::StringAttr portName,
+                       mlir::Type argumentType, ConvertedCircuit &circuit,
                        SmallVector<Value> &quirOpPulseCalSeqArgs,
-                       Value argumentValue, mlir::func::FuncOp &mainFunc,
-                       mlir::OpBuilder &builder);
-  void processAngleArg(Value nextAngleOperand,
-                       SequenceOp &convertedPulseSequenceOp,
+                       Value argumentValue);
+  void processAngleArg(Value nextAngleOperand, mlir::Type phaseType,
+                       ConvertedCircuit &circuit,
                        SmallVector<Value> &quirOpPulseCalSeqArgs,
                        mlir::OpBuilder &builder);
-  void processDurationArg(Value frontDurOperand,
-                          SequenceOp &convertedPulseSequenceOp,
+  void processDurationArg(Value frontDurOperand, ConvertedCircuit &circuit,
                           SmallVector<Value> &quirOpPulseCalSeqArgs,
                           mlir::OpBuilder &builder);
 
-  // convert angle to F64
-  mlir::Value convertAngleToF64(Operation *angleOp, mlir::OpBuilder &builder);
+  // the pulse phase type an angle of angleType is lowered to, f64 or, with
+  // fixed-point-angles, iN for angle<N> and i64 for angles without width
+  mlir::Type getPhaseType(mlir::Type angleType, mlir::OpBuilder &builder);
+  // convert angle to a phase of phaseType
+  mlir::Value convertAngle(Operation *angleOp, mlir::Type phaseType,
+                           mlir::OpBuilder &builder);
   // convert duration to I64
   mlir::Value convertDurationToI64(mlir::quir::CallCircuitOp &callCircuitOp,
                                    Operation *durOp, uint &cnt,
                                    mlir::OpBuilder &builder,
                                    mlir::func::FuncOp &mainFunc);
-  // map of the hashed location of quir angle/duration ops to their converted
-  // pulse ops
-  std::unordered_map<std::string, mlir::Value>
-      classicalQUIROpLocToConvertedPulseOpMap;
+  // map of the quir angle/duration ops in main to their converted pulse ops
+  llvm::DenseMap<mlir::Operation *, mlir::Value>
+      classicalQUIROpToConvertedPulseOpMap;
 
+  // the names of ports, mixframes and waveforms are the StringAttrs of the
+  // pulse cal arguments, which are uniqued by the context, such that lookups
+  // compare pointers and do not allocate
   // port name to Port_CreateOp map
-  std::unordered_map<std::string, mlir::pulse::Port_CreateOp> openedPorts;
+  llvm::DenseMap<mlir::StringAttr, mlir::pulse::Port_CreateOp> openedPorts;
   // mixframe name to MixFrameOp map
-  std::unordered_map<std::string, mlir::pulse::MixFrameOp> openedMixFrames;
+  llvm::DenseMap<mlir::StringAttr, mlir::pulse::MixFrameOp> openedMixFrames;
   // waveform name to Waveform_CreateOp map
-  std::unordered_map<std::string, mlir::pulse::Waveform_CreateOp> openedWfrs;
+  llvm::DenseMap<mlir::StringAttr, mlir::pulse::Waveform_CreateOp> openedWfrs;
   // add a port to IR if it's not already added and return the Port_CreateOp
-  mlir::pulse::Port_CreateOp addPortOpToIR(std::string const &portName,
+  mlir::pulse::Port_CreateOp addPortOpToIR(mlir::StringAttr portName,
                                            mlir::func::FuncOp &mainFunc,
                                            mlir::OpBuilder &builder);
   // add a mixframe to IR if it's not already added and return the MixFrameOp
-  mlir::pulse::MixFrameOp addMixFrameOpToIR(std::string const &mixFrameName,
-                                            std::string const &portName,
+  mlir::pulse::MixFrameOp addMixFrameOpToIR(mlir::StringAttr mixFrameName,
+                                            mlir::StringAttr portName,
                                             mlir::func::FuncOp &mainFunc,
                                             mlir::OpBuilder &builder);
   // add a waveform to IR if it's not already added and return the
   // Waveform_CreateOp
-  mlir::pulse::Waveform_CreateOp addWfrOpToIR(std::string const &wfrName,
+  mlir::pulse::Waveform_CreateOp addWfrOpToIR(mlir::StringAttr wfrName,
                                               mlir::func::FuncOp &mainFunc,
                                               mlir::OpBuilder &builder);
 
   // parse the waveform containers and add them to pulseNameToWaveformMap
-  void parsePulseWaveformContainerOps(std::string &waveformContainerPath);
-  std::unordered_map<std::string, Waveform_CreateOp> pulseNameToWaveformMap;
+  mlir::LogicalResult
+  parsePulseWaveformContainerOps(std::string &waveformContainerPath);
+  PulseCalsCache::LazyModule waveformContainerModule;
+  llvm::DenseMap<mlir::StringAttr, Waveform_CreateOp> pulseNameToWaveformMap;
+  // a waveform container given as a waveform library is mapped rather than
+  // parsed, and only the waveforms used are added to IR
+  std::shared_ptr<llvm::MemoryBuffer> waveformLibraryBuffer;
+  std::optional<WaveformLibraryView> waveformLibrary;
+  mlir::pulse::Waveform_CreateOp createLibraryWfrOp(mlir::StringAttr wfrName,
+                                                    mlir::OpBuilder &builder);
 
   qssc::utils::SymbolCacheAnalysis *symbolCache{nullptr};
 };
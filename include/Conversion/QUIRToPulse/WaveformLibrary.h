@@ -0,0 +1,201 @@
+//===- WaveformLibrary.h - Indexed waveform sample files --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file declares a binary format for waveform containers, which is
+/// indexed without parsing, and the pass writing it.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef WAVEFORM_LIBRARY_H
+#define WAVEFORM_LIBRARY_H
+
+#include "Dialect/Pulse/Utils/WaveformSampling.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace mlir::pulse {
+
+// A read-only view of a waveform library, e.g. mapped from a file. Only the
+// index is validated when the view is created; the samples of a waveform are
+// not touched until they are requested, so the pages of unused waveforms are
+// never read. The buffer must outlive the view.
+//
+// The format, with all integers and samples little endian:
+//   header:   magic "QSSCWFL\0", version, number of waveforms, string table
+//             size, reserved (each 32 bit)
+//   index:    one WaveformRecord per waveform, ordered by name
+//   strings:  the null terminated names, referred to by their offset
+//   samples:  for each waveform, 8 byte aligned, the real and the imaginary
+//             part of each sample as 64 bit floats
+//
+// Since version 2, waveforms flagged as compact store a CompactWaveform
+// instead of their samples: the number of segments (64 bit), one
+// SegmentRecord per segment, and the samples of the sampled segments. The
+// segment tables are validated along with the index. Libraries without
+// compact waveforms are written as version 1.
+class WaveformLibraryView {
+public:
+  using ulittle32_t = llvm::support::ulittle32_t;
+  using ulittle64_t = llvm::support::ulittle64_t;
+
+  struct Header {
+    char magic[8];
+    ulittle32_t version;
+    ulittle32_t numWaveforms;
+    ulittle32_t stringTableSize;
+    ulittle32_t reserved;
+  };
+
+  struct WaveformRecord {
+    ulittle32_t nameId;
+    ulittle32_t flags;
+    // from the start of the library
+    ulittle64_t samplesOffset;
+    // the number of samples once expanded
+    ulittle64_t numSamples;
+  };
+
+  struct SegmentRecord {
+    ulittle64_t numSamples;
+    // 1 if the segment repeats value, 0 if it is sampled
+    ulittle64_t constant;
+    // the bits of the real and the imaginary part of the repeated sample
+    ulittle64_t value[2];
+  };
+
+  static constexpr char magic[8] = {'Q', 'S', 'S', 'C', 'W', 'F', 'L', '\0'};
+  static constexpr uint32_t version = 2;
+  static constexpr uint32_t expandedVersion = 1;
+  static constexpr uint32_t compactFlag = 1;
+
+  // whether buffer holds a waveform library
+  static bool isWaveformLibrary(llvm::StringRef buffer);
+
+  // Create a view of buffer, validating the bounds of the index, the names
+  // and the sample blocks
+  static llvm::Expected<WaveformLibraryView> create(llvm::StringRef buffer);
+
+  size_t size() const { return waveforms.size(); }
+  // the index of the waveform named name, found by binary search
+  std::optional<size_t> find(llvm::StringRef name) const;
+  llvm::StringRef getName(size_t waveform) const {
+    return {stringTable.data() + waveforms[waveform].nameId};
+  }
+  uint64_t getNumSamples(size_t waveform) const {
+    return waveforms[waveform].numSamples;
+  }
+  bool isCompact(size_t waveform) const {
+    return waveforms[waveform].flags & compactFlag;
+  }
+  // the samples as stored, e.g. to copy them into a payload as they are
+  llvm::ArrayRef<char> getSampleBytes(size_t waveform) const;
+  // the interleaved samples without a copy, if the waveform is not compact,
+  // the host is little endian and the buffer is suitably aligned
+  std::optional<llvm::ArrayRef<double>> getSamples(size_t waveform) const;
+  // the interleaved samples, copied or expanded if necessary
+  void getSamples(size_t waveform,
+                  llvm::SmallVectorImpl<double> &samples) const;
+  // the waveform as stored if compact, otherwise as a single sampled segment
+  void getCompactWaveform(size_t waveform, CompactWaveform &compact) const;
+
+private:
+  WaveformLibraryView() = default;
+
+  llvm::StringRef buffer;
+  llvm::ArrayRef<WaveformRecord> waveforms;
+  llvm::StringRef stringTable;
+
+  llvm::ArrayRef<SegmentRecord> getSegments_(size_t waveform) const;
+};
+
+// How waveforms are stored in a waveform library. Compact waveforms store
+// their runs of at least a minimum length of identical samples as a single
+// sample, if that is smaller than storing all of their samples.
+enum class WaveformEncoding { Expanded, Compact };
+constexpr int64_t defaultCompactMinRunLength = 8;
+
+// Write the named waveforms, each given by its interleaved real and
+// imaginary samples, as a waveform library. Waveform names must be unique.
+void writeWaveformLibrary(
+    llvm::ArrayRef<std::pair<llvm::StringRef, llvm::ArrayRef<double>>>
+        waveforms,
+    llvm::raw_ostream &os,
+    WaveformEncoding encoding = WaveformEncoding::Expanded,
+    int64_t minRunLength = defaultCompactMinRunLength);
+
+// Write the named compact waveforms, e.g. those of compactGaussianSquare, as
+// a waveform library. Waveforms without constant segments are expanded.
+void writeCompactWaveformLibrary(
+    llvm::ArrayRef<std::pair<llvm::StringRef, const CompactWaveform *>>
+        waveforms,
+    llvm::raw_ostream &os);
+
+// Write the waveforms of the waveform containers nested in op as a waveform
+// library, keyed by their pulse.waveformName
+llvm::Error
+writeWaveformLibrary(mlir::Operation *op, llvm::raw_ostream &os,
+                     WaveformEncoding encoding = WaveformEncoding::Expanded,
+                     int64_t minRunLength = defaultCompactMinRunLength);
+
+// Writes the waveform containers of the module to a waveform library file,
+// which QUIRToPulsePass accepts as its waveform container
+class WriteWaveformLibraryPass
+    : public PassWrapper<WriteWaveformLibraryPass, OperationPass<ModuleOp>> {
+public:
+  WriteWaveformLibraryPass() = default;
+  WriteWaveformLibraryPass(const WriteWaveformLibraryPass &pass)
+      : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<std::string> outputFile{
+      *this, "output-file",
+      llvm::cl::desc("the waveform library file to write"),
+      llvm::cl::value_desc("filename"), llvm::cl::init("")};
+  Option<bool> compact{
+      *this, "compact",
+      llvm::cl::desc("store runs of identical samples, e.g. flat tops, as "
+                     "constant segments"),
+      llvm::cl::init(false)};
+  Option<int64_t> minRunLength{
+      *this, "min-run-length",
+      llvm::cl::desc("the minimum number of identical samples stored as a "
+                     "constant segment"),
+      llvm::cl::init(defaultCompactMinRunLength)};
+};
+
+} // namespace mlir::pulse
+
+#endif // WAVEFORM_LIBRARY_H
@@ -1,6 +1,6 @@
 //===- SwitchOpLowering.h ---------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -22,10 +22,31 @@
 #ifndef QUIRTOSTD_SWITCHOPLOWERING_H
 #define QUIRTOSTD_SWITCHOPLOWERING_H
 
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
 namespace mlir::quir {
 
 void populateSwitchOpLoweringPatterns(RewritePatternSet &patterns);
 
+/// Lower quir.switch operations with the patterns above on their own, which
+/// otherwise only run as part of the conversion to the LLVM dialect.
+struct TestSwitchOpLoweringPass
+    : public PassWrapper<TestSwitchOpLoweringPass, OperationPass<>> {
+  void runOnOperation() override;
+  void getDependentDialects(DialectRegistry &registry) const override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+};
+
+/// Register the test passes of the QUIR to standard conversion
+void registerQUIRToStdTestPasses();
+
 }; // namespace mlir::quir
 
 #endif // QUIRTOSTD_SWITCHOPLOWERING_H
@@ -1,6 +1,6 @@
 //===- PulseAttributes.h - Pulse dialect attributes -------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,8 +24,21 @@
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/DialectImplementation.h"
 
+#include "llvm/ADT/StringRef.h"
+
 namespace mlir::quir {} // namespace mlir::quir
 
+namespace mlir::pulse {
+
+// marks a sequence that was scheduled ahead of time, e.g. in a precompiled
+// pulse calibration library; its pulse.duration and the timepoints of its
+// operations are final
+static inline llvm::StringRef getPrecompiledAttrName() {
+  return "pulse.precompiled";
+}
+
+} // namespace mlir::pulse
+
 #define GET_ATTRDEF_CLASSES
 #include "Dialect/Pulse/IR/PulseAttributes.h.inc"
 
@@ -1,6 +1,6 @@
 //===- PulseInterfaces.h - Pulse dialect Interfaces -*- C++ -*-===============//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -22,6 +22,7 @@
 #define PULSE_INTERFACES_H
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/OpDefinition.h"
 
 #include "llvm/Support/Error.h"
@@ -36,6 +37,11 @@ namespace mlir::pulse::interfaces_impl {
 // PulseOpSchedulingInterface
 //===----------------------------------------------------------------------===//
 
+/// Names of the scheduling attributes of op. Looking attributes up by these
+/// names compares pointers instead of strings.
+mlir::StringAttr getTimepointAttrName(mlir::Operation *op);
+mlir::StringAttr getDurationAttrName(mlir::Operation *op);
+
 std::optional<int64_t> getTimepoint(mlir::Operation *op);
 void setTimepoint(mlir::Operation *op, int64_t timepoint);
 std::optional<uint64_t> getSetupLatency(mlir::Operation *op);
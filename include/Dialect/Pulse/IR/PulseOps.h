@@ -1,6 +1,6 @@
 //===- PulseOps.h - Pulse dialect ops ---------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -36,6 +36,9 @@
 #include "mlir/Interfaces/SideEffectInterfaces.h"
 
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <cmath>
 
 #define GET_OP_CLASSES
 #include "Dialect/Pulse/IR/Pulse.h.inc"
@@ -0,0 +1,44 @@
+//===- DeadCodeElimination.h - Remove dead pulse ops ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for removing dead pulse operations. Frames are
+///  tracked through pulse.call_sequence into the called pulse.sequence and a
+///  frame is live if any of its aliases is played or captured on. Frame
+///  updates of frames that are not live are erased, followed by the sequence
+///  arguments and the ports, frames and waveforms that are no longer used.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_DEAD_CODE_ELIMINATION_H
+#define PULSE_DEAD_CODE_ELIMINATION_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::pulse {
+
+class DeadCodeEliminationPass
+    : public PassWrapper<DeadCodeEliminationPass, OperationPass<ModuleOp>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_DEAD_CODE_ELIMINATION_H
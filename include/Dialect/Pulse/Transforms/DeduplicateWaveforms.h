@@ -0,0 +1,44 @@
+//===- DeduplicateWaveforms.h - Intern waveforms by content -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for deduplicating pulse.create_waveform
+///  operations by the content of their samples. Each unique waveform is
+///  interned in a module level pulse.waveform_container and every
+///  pulse.create_waveform is labeled with the pulse.waveformName of its
+///  interned copy, so that targets only need to emit each waveform once.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_DEDUPLICATE_WAVEFORMS_H
+#define PULSE_DEDUPLICATE_WAVEFORMS_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::pulse {
+
+class DeduplicateWaveformsPass
+    : public PassWrapper<DeduplicateWaveformsPass, OperationPass<ModuleOp>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_DEDUPLICATE_WAVEFORMS_H
@@ -0,0 +1,62 @@
+//===- ExposeCalibrationParameters.h - Patchable cal constants --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for exposing the amplitudes and frequencies
+///  of pulse sequences as input parameters, so they can be updated after
+///  compilation.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_EXPOSE_CALIBRATION_PARAMETERS_H
+#define PULSE_EXPOSE_CALIBRATION_PARAMETERS_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::pulse {
+
+class ExposeCalibrationParametersPass
+    : public PassWrapper<ExposeCalibrationParametersPass,
+                         OperationPass<ModuleOp>> {
+public:
+  ExposeCalibrationParametersPass() = default;
+  ExposeCalibrationParametersPass(const ExposeCalibrationParametersPass &pass)
+      : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  void getDependentDialects(mlir::DialectRegistry &registry) const override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<bool> exposeAmplitudes{
+      *this, "amplitudes",
+      llvm::cl::desc("expose the amplitudes of parametric waveforms"),
+      llvm::cl::init(true)};
+
+  Option<bool> exposeFrequencies{
+      *this, "frequencies",
+      llvm::cl::desc("expose the frequencies of pulse.set_frequency"),
+      llvm::cl::init(true)};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_EXPOSE_CALIBRATION_PARAMETERS_H
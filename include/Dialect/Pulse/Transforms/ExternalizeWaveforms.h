@@ -0,0 +1,53 @@
+//===- ExternalizeWaveforms.h - Move samples to resources -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for moving the samples of large
+///  pulse.create_waveform operations into dialect resource blobs.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_EXTERNALIZE_WAVEFORMS_H
+#define PULSE_EXTERNALIZE_WAVEFORMS_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include <cstdint>
+
+namespace mlir::pulse {
+
+class ExternalizeWaveformsPass
+    : public PassWrapper<ExternalizeWaveformsPass, OperationPass<ModuleOp>> {
+public:
+  ExternalizeWaveformsPass() = default;
+  ExternalizeWaveformsPass(const ExternalizeWaveformsPass &pass)
+      : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<int64_t> minSamples{
+      *this, "min-samples",
+      llvm::cl::desc("the minimum number of samples of a waveform to move it "
+                     "to a resource blob"),
+      llvm::cl::value_desc("num"), llvm::cl::init(1024)};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_EXTERNALIZE_WAVEFORMS_H
@@ -0,0 +1,45 @@
+//===- FuseFrameUpdates.h - Fuse adjacent frame updates ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for fusing the phase and frequency updates of
+///  a frame which are not separated by an operation on the same frame. Phase
+///  shifts such as virtual-Z gates commute with operations on other frames,
+///  hence each frame is left with at most one phase and one frequency update
+///  between consecutive operations on it.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_FUSE_FRAME_UPDATES_H
+#define PULSE_FUSE_FRAME_UPDATES_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::pulse {
+
+class FuseFrameUpdatesPass
+    : public PassWrapper<FuseFrameUpdatesPass, OperationPass<ModuleOp>> {
+public:
+  void runOnOperation() override;
+  void getDependentDialects(DialectRegistry &registry) const override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_FUSE_FRAME_UPDATES_H
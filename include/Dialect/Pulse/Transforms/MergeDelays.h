@@ -1,6 +1,6 @@
 //===- MergeDelays.h - Merge back to back pulse.delays  ---------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -18,6 +18,11 @@
 ///  The current implementation defaults to ignoring the target, there
 ///  is an option to override this.
 ///
+///  It also declares the pass for moving the delays at the start and the
+///  end of a sequence to its calls, where the delays around consecutive
+///  calls are merged into one, or folded into the timepoint of a scheduled
+///  call.
+///
 //===----------------------------------------------------------------------===//
 
 #ifndef PULSE_MERGE_DELAYS_H
@@ -25,10 +30,14 @@
 
 #include "Dialect/Pulse/IR/PulseOps.h"
 
+#include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/Pass.h"
 
 namespace mlir::pulse {
 
+/// Merges the delays on the same target which no op in between uses into
+/// the first of them, unless the later delay is scheduled at a timepoint.
+
 class MergeDelayPass
     : public PassWrapper<MergeDelayPass, OperationPass<SequenceOp>> {
 public:
@@ -38,6 +47,33 @@ public:
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
 };
+
+/// The same delay at the start of all frame arguments of a sequence delays
+/// its start, and the same delay at their end extends its end. If all the
+/// calls of a sequence are scheduled at a timepoint, the delay at the start
+/// is folded into their timepoints. Otherwise, if the sequence is called
+/// once, the delays at its start and end are moved before and after the
+/// call, where they are merged with the delays of the caller and of the
+/// neighbouring calls. Sequences whose ops are scheduled at timepoints are
+/// left as is.
+class FoldCallDelaysPass
+    : public PassWrapper<FoldCallDelaysPass, OperationPass<ModuleOp>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+private:
+  Statistic numHoistedDelays{this, "hoisted-delays",
+                             "Number of delays moved to the calls"};
+  Statistic numFoldedTimepoints{
+      this, "folded-timepoints",
+      "Number of delays folded into the timepoints of the calls"};
+  Statistic numMergedDelays{this, "merged-delays",
+                            "Number of delays merged into another"};
+};
 } // namespace mlir::pulse
 
 #endif // PULSE_MERGE_DELAY_H
@@ -0,0 +1,68 @@
+//===- SampleWaveforms.h - Sample constant parametric waveforms -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for replacing parametric waveforms with
+///  constant parameters by pulse.create_waveform operations holding their
+///  samples.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_SAMPLE_WAVEFORMS_H
+#define PULSE_SAMPLE_WAVEFORMS_H
+
+#include "mlir/IR/BuiltinAttributeInterfaces.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+
+namespace mlir::pulse {
+
+class SampleWaveformsPass
+    : public PassWrapper<SampleWaveformsPass, OperationPass<ModuleOp>> {
+public:
+  SampleWaveformsPass() = default;
+  SampleWaveformsPass(const SampleWaveformsPass &pass) : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<int64_t> resourceMinSamples{
+      *this, "resource-min-samples",
+      llvm::cl::desc("store the samples of waveforms with at least this many "
+                     "samples in a dialect resource blob, 0 to disable"),
+      llvm::cl::value_desc("num"), llvm::cl::init(0)};
+
+  // the kind of waveform, its duration, the real and imaginary part of its
+  // amplitude, sigma and the width or beta
+  using WaveformParameters =
+      std::tuple<unsigned int, int64_t, double, double, double, double>;
+
+private:
+  // samples by parameters, waveforms with the same parameters are only
+  // sampled once
+  std::map<WaveformParameters, mlir::ElementsAttr> samplesCache;
+
+  mlir::ElementsAttr getSamples(const WaveformParameters &parameters);
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_SAMPLE_WAVEFORMS_H
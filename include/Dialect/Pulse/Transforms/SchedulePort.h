@@ -1,6 +1,6 @@
 //===- SchedulePort.h  - Schedule Pulse on single port ----------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -33,9 +33,12 @@
 #include "Utils/SymbolCacheAnalysis.h"
 
 #include "mlir/Pass/Pass.h"
+#include "mlir/Support/LogicalResult.h"
 
-#include <map>
-#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <cstdint>
 
 namespace mlir::pulse {
 
@@ -43,26 +46,41 @@ class SchedulePortPass
     : public PassWrapper<SchedulePortPass, OperationPass<ModuleOp>>,
       protected qssc::utils::DebugIndent {
 public:
+  SchedulePortPass() = default;
+  SchedulePortPass(const SchedulePortPass &pass) : PassWrapper(pass) {}
+
   void runOnOperation() override;
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
 
-private:
-  using mixedFrameMap_t = std::map<uint32_t, std::vector<Operation *>>;
+  // schedule the sequences of a pulse calibration library once, instead of in
+  // every program using them; e.g.,
+  // --pulse-schedule-port=precompile=true
+  Option<bool> precompile{
+      *this, "precompile",
+      llvm::cl::desc("schedule all sequences of the module ahead of time and "
+                     "mark them as precompiled"),
+      llvm::cl::init(false)};
 
+private:
+  void precompileSequences(Operation *module);
   uint64_t processCall(CallSequenceOp &callSequenceOp,
                        bool updateNestedSequences);
-  uint64_t processSequence(SequenceOp sequenceOp);
+  // only modifies the body of sequenceOp, so that distinct sequences can be
+  // processed in parallel
+  mlir::FailureOr<uint64_t> processSequence(SequenceOp sequenceOp);
   uint64_t updateSequence(SequenceOp sequenceOp);
 
-  mixedFrameMap_t buildMixedFrameMap(SequenceOp &sequenceOp,
-                                     uint32_t &numMixedFrames);
-
-  void addTimepoints(mlir::OpBuilder &builder,
-                     mixedFrameMap_t &mixedFrameSequences, int64_t &maxTime);
+  mlir::LogicalResult addTimepoints(SequenceOp sequenceOp, int64_t &maxTime,
+                                    SmallVectorImpl<DelayOp> &delayOps);
   qssc::utils::SymbolCacheAnalysis *symbolCache{nullptr};
+
+  // durations of the sequences processed and updated so far, keyed by the
+  // sequence
+  llvm::DenseMap<Operation *, uint64_t> scheduledDurations;
+  llvm::DenseMap<Operation *, uint64_t> updatedDurations;
 };
 } // namespace mlir::pulse
 
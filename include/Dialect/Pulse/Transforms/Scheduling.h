@@ -23,13 +23,18 @@
 #define SCHEDULING_PULSE_SEQUENCES_H
 
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Transforms/SequenceDurationAnalysis.h"
 #include "Utils/SymbolCacheAnalysis.h"
 
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Support/LogicalResult.h"
 
-#include <unordered_map>
-#include <unordered_set>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <cstdint>
+#include <memory>
 
 namespace mlir::pulse {
 
@@ -37,20 +42,29 @@ struct QuantumCircuitPulseSchedulingPass
     : public PassWrapper<QuantumCircuitPulseSchedulingPass,
                          OperationPass<ModuleOp>> {
 public:
-  enum SchedulingMethod { ALAP, ASAP };
+  // ALAP and ASAP only serialize gates sharing mix frames, LIST additionally
+  // limits the number of concurrent measurement windows
+  enum SchedulingMethod { ALAP, ASAP, LIST };
   SchedulingMethod SCHEDULING_METHOD = ALAP;
   uint64_t PRE_MEASURE_BUFFER_DELAY = 0;
+  // maximum number of gates including a capture that may overlap in time; 0
+  // means unlimited
+  uint64_t MAX_CONCURRENT_CAPTURES = 0;
 
   // this pass can optionally receive an string specifying the scheduling
   // method; default method is alap scheduling
   QuantumCircuitPulseSchedulingPass() = default;
   QuantumCircuitPulseSchedulingPass(
       const QuantumCircuitPulseSchedulingPass &pass)
-      : PassWrapper(pass) {}
+      : PassWrapper(pass), SCHEDULING_METHOD(pass.SCHEDULING_METHOD),
+        PRE_MEASURE_BUFFER_DELAY(pass.PRE_MEASURE_BUFFER_DELAY),
+        MAX_CONCURRENT_CAPTURES(pass.MAX_CONCURRENT_CAPTURES) {}
   QuantumCircuitPulseSchedulingPass(SchedulingMethod inSchedulingMethod,
-                                    uint64_t inPreMeasureBufferDelay) {
+                                    uint64_t inPreMeasureBufferDelay,
+                                    uint64_t inMaxConcurrentCaptures = 0) {
     SCHEDULING_METHOD = inSchedulingMethod;
     PRE_MEASURE_BUFFER_DELAY = inPreMeasureBufferDelay;
+    MAX_CONCURRENT_CAPTURES = inMaxConcurrentCaptures;
   }
 
   void runOnOperation() override;
@@ -62,7 +76,8 @@ public:
   // optionally, one can override the scheduling method with this option
   Option<std::string> schedulingMethod{
       *this, "scheduling-method",
-      llvm::cl::desc("an string to specify scheduling method"),
+      llvm::cl::desc("an string to specify scheduling method: alap, asap or "
+                     "list"),
       llvm::cl::value_desc("scheduling method"), llvm::cl::init("alap")};
 
   // optionally, one can override the pre measure delay value with this option
@@ -71,23 +86,95 @@ public:
       llvm::cl::desc("an optional delay before measurements"),
       llvm::cl::value_desc("delay"), llvm::cl::init(0)};
 
+  // optionally, one can override the measurement window limit of the list
+  // scheduler with this option
+  Option<uint64_t> maxConcurrentCaptures{
+      *this, "max-concurrent-captures",
+      llvm::cl::desc("the maximum number of overlapping measurement windows "
+                     "for list scheduling, 0 for unlimited"),
+      llvm::cl::value_desc("num"), llvm::cl::init(0)};
+
 private:
-  // map to keep track of next availability of mix frames
-  std::unordered_map<unsigned int, int64_t> mixFrameToNextAvailabilityMap;
-
-  void scheduleAlap(mlir::pulse::CallSequenceOp quantumCircuitCallSequenceOp);
-  // returns an unordered set of block argument numbers of the mix frames of a
-  // quantum gate; here block refers to the current block that includes the call
-  // op
-  std::unordered_set<unsigned int> getMixFramesBlockArgNums(
-      mlir::pulse::CallSequenceOp quantumGateCallSequenceOp);
+  // information about a quantum gate sequence, computed once per sequence and
+  // reused for all of its calls
+  struct GateSequenceInfo {
+    // operand numbers of the mix frame arguments
+    llvm::SmallVector<unsigned int> mixFrameOperandNums;
+    bool includesCapture{false};
+  };
+  llvm::DenseMap<mlir::Operation *, std::unique_ptr<GateSequenceInfo>>
+      gateSequenceInfos;
+
+  // a quantum gate call of the quantum circuit being scheduled
+  struct GateCall {
+    mlir::pulse::CallSequenceOp callSequenceOp;
+    const GateSequenceInfo *gateSequenceInfo;
+    uint64_t duration;
+  };
+
+  // state of scheduling one quantum circuit; each circuit scheduled in
+  // parallel has its own
+  struct CircuitSchedulingState {
+    // next availability of the mix frames, indexed by block argument number
+    // of the quantum circuit sequence being scheduled
+    llvm::SmallVector<int64_t> mixFrameNextAvailability;
+    llvm::SmallVector<GateCall> gateCalls;
+  };
+
+  // the duration and timepoint to set on all the calls of a scheduled quantum
+  // circuit
+  struct CircuitSchedule {
+    int64_t duration;
+    int64_t timepoint;
+  };
+
+  // a quantum circuit sequence together with its root calls; each circuit is
+  // scheduled once and the result is written back to all of its calls
+  struct CircuitCalls {
+    mlir::pulse::SequenceOp circuitOp;
+    llvm::SmallVector<mlir::pulse::CallSequenceOp, 1> callSequenceOps;
+    CircuitSchedule schedule{0, 0};
+  };
+
+  // the schedule functions only modify the body of circuitOp, so that they
+  // can run in parallel for distinct circuits
+  mlir::FailureOr<CircuitSchedule>
+  scheduleCircuit(mlir::pulse::SequenceOp circuitOp,
+                  CircuitSchedulingState &state);
+  CircuitSchedule scheduleAlap(CircuitSchedulingState &state);
+  CircuitSchedule scheduleAsap(CircuitSchedulingState &state);
+  CircuitSchedule scheduleList(mlir::pulse::SequenceOp circuitOp,
+                               CircuitSchedulingState &state);
+  // collect the quantum gate calls of a quantum circuit into state in program
+  // order and reset the mix frame availability; returns failure if the
+  // duration of a gate is unknown
+  mlir::LogicalResult collectGateCalls(mlir::pulse::SequenceOp circuitOp,
+                                       CircuitSchedulingState &state);
+  // compute the info of all the quantum gates called by circuitOp ahead of
+  // scheduling, so that the cache is only read by the parallel schedulers
+  void cacheGateSequenceInfos(mlir::pulse::SequenceOp circuitOp);
+  const GateSequenceInfo &
+  getGateSequenceInfo(mlir::pulse::SequenceOp quantumGateSequenceOp);
+  // returns the earliest next availability of the mix frames passed to a
+  // quantum gate; the mix frames are block arguments of the current block
+  // that includes the call op
   int64_t getNextAvailableTimeOfMixFrames(
-      std::unordered_set<unsigned int> &mixFramesBlockArgNums);
-  void updateMixFrameAvailabilityMap(
-      std::unordered_set<unsigned int> &mixFramesBlockArgNums,
-      int64_t updatedAvailableTime);
+      mlir::pulse::CallSequenceOp quantumGateCallSequenceOp,
+      const GateSequenceInfo &gateSequenceInfo,
+      const CircuitSchedulingState &state);
+  // returns the time at which all the mix frames passed to a quantum gate
+  // become available
+  int64_t getEarliestStartTimeOfMixFrames(
+      mlir::pulse::CallSequenceOp quantumGateCallSequenceOp,
+      const GateSequenceInfo &gateSequenceInfo,
+      const CircuitSchedulingState &state);
+  void updateMixFrameAvailability(
+      mlir::pulse::CallSequenceOp quantumGateCallSequenceOp,
+      const GateSequenceInfo &gateSequenceInfo, int64_t updatedAvailableTime,
+      CircuitSchedulingState &state);
   bool sequenceOpIncludeCapture(mlir::pulse::SequenceOp quantumGateSequenceOp);
   qssc::utils::SymbolCacheAnalysis *symbolCache{nullptr};
+  SequenceDurationAnalysis *sequenceDurations{nullptr};
 };
 } // namespace mlir::pulse
 
@@ -0,0 +1,109 @@
+//===- SequenceDurationAnalysis.h - Sequence durations ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the analysis computing the durations of pulse
+///  sequences from their bodies, such that the durations need not be labeled
+///  by a separate pass before scheduling.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_SEQUENCE_DURATION_ANALYSIS_H
+#define PULSE_SEQUENCE_DURATION_ANALYSIS_H
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/ValueRange.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace mlir::pulse {
+
+// The duration of a sequence is the latest end of the plays, delays and
+// sequence calls on any of its frames, where each frame keeps its own
+// timeline and a call starts once all of the frames passed to it are
+// available. Durations labeled with pulse.duration take precedence, and
+// pulse.timepoint labels of already scheduled operations are respected.
+//
+// The durations computed from the bodies are memoized per sequence and
+// signature of the arguments it is called with, so that the sequences called
+// repeatedly are analyzed once. Queries are thread safe.
+class SequenceDurationAnalysis {
+public:
+  // The values of the arguments of a sequence which its duration may depend
+  // on: the constant value of integer arguments and the duration of waveform
+  // arguments, if known
+  using ArgumentSignature = llvm::SmallVector<std::optional<int64_t>, 4>;
+
+  explicit SequenceDurationAnalysis(mlir::Operation *op);
+
+  // The duration of callOp: the pulse.duration of its callee or of itself, if
+  // labeled, or the duration of its callee computed for its operands
+  llvm::Expected<uint64_t> getDuration(CallSequenceOp callOp);
+  // The duration of sequenceOp called with arguments
+  llvm::Expected<uint64_t> getDuration(SequenceOp sequenceOp,
+                                       const ArgumentSignature &arguments);
+
+  // The duration of playOp: its pulse.duration, if labeled, or the duration
+  // of its waveform, which is either created in the sequence of playOp or
+  // one of its arguments
+  static llvm::Expected<uint64_t>
+  getPlayDuration(PlayOp playOp, const ArgumentSignature &arguments = {});
+
+  // The signature of operands passed by a sequence called with arguments
+  static ArgumentSignature
+  getSignature(mlir::ValueRange operands,
+               const ArgumentSignature &arguments = {});
+
+private:
+  llvm::Expected<uint64_t>
+  computeDuration_(SequenceOp sequenceOp, const ArgumentSignature &arguments);
+
+  // the sequences by name, read only once constructed
+  llvm::StringMap<SequenceOp> sequences;
+
+  std::mutex durationsMutex;
+  std::map<std::pair<mlir::Operation *, ArgumentSignature>, uint64_t>
+      durations;
+};
+
+// Remark the duration of each sequence call outside of sequences, as
+// computed by the analysis
+struct TestSequenceDurationAnalysisPass
+    : public PassWrapper<TestSequenceDurationAnalysisPass,
+                         OperationPass<ModuleOp>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+};
+
+} // namespace mlir::pulse
+
+#endif // PULSE_SEQUENCE_DURATION_ANALYSIS_H
@@ -0,0 +1,56 @@
+//===- TimelineReport.h - Report pulse schedule occupancy -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for reporting the occupancy of ports and
+///  mixed frames in a scheduled pulse program.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_TIMELINE_REPORT_H
+#define PULSE_TIMELINE_REPORT_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include <string>
+
+namespace mlir::pulse {
+
+class TimelineReportPass
+    : public PassWrapper<TimelineReportPass, OperationPass<ModuleOp>> {
+public:
+  TimelineReportPass() = default;
+  TimelineReportPass(const TimelineReportPass &pass) : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<std::string> outputFile{
+      *this, "output-file",
+      llvm::cl::desc("the file to write the report to, - for stdout"),
+      llvm::cl::value_desc("filename"), llvm::cl::init("-")};
+
+  Option<std::string> format{
+      *this, "format",
+      llvm::cl::desc("the format of the report: json or chrome-trace"),
+      llvm::cl::value_desc("format"), llvm::cl::init("json")};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_TIMELINE_REPORT_H
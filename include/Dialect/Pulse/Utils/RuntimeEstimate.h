@@ -0,0 +1,63 @@
+//===- RuntimeEstimate.h - Estimate the runtime of programs -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the estimation of the execution time of a scheduled
+///  program on the hardware.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_RUNTIME_ESTIMATE_H
+#define PULSE_RUNTIME_ESTIMATE_H
+
+#include "mlir/IR/Operation.h"
+
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <optional>
+
+namespace mlir::pulse {
+
+/// @brief The estimated execution time of a program
+struct RuntimeEstimate {
+  uint64_t numShots = 1;
+  /// The duration of the body of the shot loop, including the shot delay
+  double shotSeconds = 0.;
+  /// The duration of all shots and of the operations outside the shot loop
+  double jobSeconds = 0.;
+};
+
+/// @brief Estimate the execution time of the main functions of moduleOp and
+/// of its nested modules, which run in parallel, once the program is
+/// scheduled.
+/// @details The operations of a block run one after another: the operations
+/// labeled with a pulse.duration for that duration, delays for their constant
+/// duration and other classical operations in no time. Loops run for their
+/// constant trip count, the shot loop for the number of shots, and the
+/// conditional branches of other operations with regions are bounded by the
+/// longest of them.
+/// @param moduleOp the module of the program
+/// @param dtTimestep the duration of a scheduling sample in seconds, which
+/// pulse.duration labels and dt durations are counted in
+/// @return the estimate, or an error if an operation on qubits is not
+/// scheduled, the trip count of a loop is not known or a duration in samples
+/// requires an unknown dtTimestep
+llvm::Expected<RuntimeEstimate>
+estimateRuntime(mlir::Operation *moduleOp, std::optional<double> dtTimestep);
+
+} // namespace mlir::pulse
+
+#endif // PULSE_RUNTIME_ESTIMATE_H
@@ -1,6 +1,6 @@
 //===- Utils.h - Pulse Utilities --------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -19,12 +19,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributeInterfaces.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
+#include <cstdint>
 #include <deque>
 #include <vector>
 
@@ -49,6 +55,33 @@ mlir::Value getPhaseValue(ShiftPhaseOp shiftPhaseOp,
 /// timepoints.
 void sortOpsByTimepoint(SequenceOp &sequenceOp);
 
+/// Creates the samples attribute of a pulse.create_waveform from samples
+/// interleaved as [re0, im0, re1, im1, ...]. Waveforms of at least
+/// minResourceSamples samples are stored in a dialect resource blob named
+/// after resourceName, which unlike a dense attribute can be released again;
+/// 0 disables resources.
+mlir::ElementsAttr getWaveformSamplesAttr(mlir::MLIRContext *context,
+                                          llvm::ArrayRef<double> samples,
+                                          int64_t minResourceSamples = 0,
+                                          llvm::StringRef resourceName =
+                                              "waveform");
+
+/// Releases the data of all the resource backed waveforms nested in op,
+/// e.g. once the payload has been written, so that long lived contexts do not
+/// hold on to it. The waveforms must not be read afterwards.
+void releaseWaveformResources(mlir::Operation *op);
+
+/// Creates a constant phase of phaseType for an angle in radians, i.e. an f64
+/// or an iN fixed-point phase in units of 2pi / 2^N, see
+/// mlir::quir::getFixedPointAngle.
+mlir::Value createPhaseConstant(mlir::OpBuilder &builder, mlir::Location loc,
+                                double angle, mlir::Type phaseType);
+
+/// Converts phase to phaseType, rescaling between radians and fixed-point
+/// phases of any width. Returns phase if it is of phaseType already.
+mlir::Value convertPhase(mlir::OpBuilder &builder, mlir::Location loc,
+                         mlir::Value phase, mlir::Type phaseType);
+
 template <typename PulseOpTy>
 MixFrameOp getMixFrameOp(PulseOpTy pulseOp, CallSequenceOp callSequenceOp) {
 
@@ -0,0 +1,103 @@
+//===- WaveformSampling.h - Sample parametric waveforms ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares functions for sampling the parametric pulse waveforms
+///  pulse.const_waveform, pulse.gaussian, pulse.gaussian_square and
+///  pulse.drag. The envelopes follow the definitions of Qiskit pulse: samples
+///  are taken at the midpoints t = i + 1/2 of the duration, and Gaussian
+///  edges are lifted such that they reach zero one sample outside of the
+///  waveform.
+///
+///  Samples are written interleaved as [re0, im0, re1, im1, ...], which is
+///  the layout of the tensor<Nx2xf64> samples of pulse.create_waveform.
+///
+///  Waveforms which are mostly constant, e.g., the flat top of a
+///  pulse.gaussian_square, can also be encoded compactly as runs of one
+///  repeated sample and runs of sampled values, see CompactWaveform.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_WAVEFORM_SAMPLING_H
+#define PULSE_WAVEFORM_SAMPLING_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <complex>
+#include <cstdint>
+
+namespace mlir::pulse {
+
+void sampleConstWaveform(int64_t duration, std::complex<double> amp,
+                         llvm::SmallVectorImpl<double> &samples);
+
+void sampleGaussian(int64_t duration, std::complex<double> amp, double sigma,
+                    llvm::SmallVectorImpl<double> &samples);
+
+/// A Gaussian rise and fall around a flat top of the given width
+void sampleGaussianSquare(int64_t duration, std::complex<double> amp,
+                          double sigma, double width,
+                          llvm::SmallVectorImpl<double> &samples);
+
+/// A Gaussian with beta times its derivative as imaginary part
+void sampleDrag(int64_t duration, std::complex<double> amp, double sigma,
+                double beta, llvm::SmallVectorImpl<double> &samples);
+
+/// A waveform encoded as a sequence of segments, each either a run of one
+/// repeated sample or a run of sampled values, such that constant regions
+/// take constant space. Expanding it yields bit identical samples.
+struct CompactWaveform {
+  struct Segment {
+    int64_t numSamples;
+    /// Whether the segment repeats value rather than holding samples
+    bool constant;
+    std::complex<double> value;
+  };
+
+  llvm::SmallVector<Segment> segments;
+  /// The interleaved samples of the sampled segments, in segment order
+  llvm::SmallVector<double> samples;
+
+  void clear() {
+    segments.clear();
+    samples.clear();
+  }
+  int64_t getNumSamples() const;
+  /// Append numSamples repetitions of value, extending the last segment if it
+  /// repeats the same value
+  void appendConstant(int64_t numSamples, std::complex<double> value);
+  /// Append interleaved samples, extending the last segment if it is sampled
+  void appendSamples(llvm::ArrayRef<double> interleaved);
+  /// Write the interleaved samples of the waveform into expanded
+  void expand(llvm::SmallVectorImpl<double> &expanded) const;
+};
+
+/// Run-length encode interleaved samples into compact, with each run of at
+/// least minRunLength bit identical samples as a constant segment
+void compactWaveformSamples(llvm::ArrayRef<double> samples,
+                            int64_t minRunLength, CompactWaveform &compact);
+
+/// The compact encodings of the parametric waveforms with constant regions,
+/// which are computed without sampling those regions
+void compactConstWaveform(int64_t duration, std::complex<double> amp,
+                          CompactWaveform &compact);
+void compactGaussianSquare(int64_t duration, std::complex<double> amp,
+                           double sigma, double width,
+                           CompactWaveform &compact);
+
+} // namespace mlir::pulse
+
+#endif // PULSE_WAVEFORM_SAMPLING_H
@@ -1,6 +1,6 @@
 //===- QCSAttributes.h - QCS dialect attributes -----------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -26,6 +26,18 @@
 namespace mlir::qcs {
 static inline llvm::StringRef getShotLoopAttrName() { return "qcs.shot_loop"; }
 static inline llvm::StringRef getNumShotsAttrName() { return "qcs.num_shots"; }
+static inline llvm::StringRef getShotBatchLoopAttrName() {
+  return "qcs.shot_batch_loop";
+}
+static inline llvm::StringRef getShotsPerBatchAttrName() {
+  return "qcs.shots_per_batch";
+}
+static inline llvm::StringRef getSweepLoopAttrName() {
+  return "qcs.sweep_loop";
+}
+static inline llvm::StringRef getNumSweepPointsAttrName() {
+  return "qcs.num_sweep_points";
+}
 } // namespace mlir::qcs
 
 #endif // DIALECT_QCS_QCSATTRIBUTES_H_
@@ -1,6 +1,6 @@
 //===- ParameterInitialValueAnalysis.h - initial_value cache ------ C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -9,7 +9,9 @@
 //===----------------------------------------------------------------------===//
 ///
 /// This file defines a MLIR Analysis for parameter inputs which
-/// caches the initial_value of the input parameter
+/// caches the initial_value of the input parameter. Each declared parameter
+/// is assigned a dense integer slot, such that parameter loads are resolved
+/// to their initial value by index rather than by name.
 ///
 /// Note: by default this analysis is always treated as valid unless
 /// the invalidate() method is called.
@@ -25,12 +27,16 @@
 #include "mlir/Pass/AnalysisManager.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace mlir::qcs {
 
@@ -38,14 +44,38 @@ using namespace mlir;
 
 using InitialValueType = llvm::StringMap<ParameterType>;
 
+// the dense index of a declared parameter, in order of declaration
+using ParameterSlot = uint32_t;
+
 class ParameterInitialValueAnalysis {
 private:
   InitialValueType initial_values_;
+  // the parameter table, indexed by slot
+  llvm::StringMap<ParameterSlot> slots_;
+  std::vector<ParameterType> slotValues_;
+  // owned, such that copies of the analysis do not refer to the original
+  std::vector<std::string> slotNames_;
+  // the slot of each parameter load resolved so far
+  llvm::DenseMap<mlir::Operation *, ParameterSlot> loadSlots_;
   bool invalid_{true};
 
 public:
   ParameterInitialValueAnalysis(mlir::Operation *op);
   InitialValueType &getNames() { return initial_values_; }
+
+  size_t getNumSlots() const { return slotValues_.size(); }
+  // the slot of the parameter declared as name, if any
+  std::optional<ParameterSlot> getSlot(llvm::StringRef name) const;
+  // the slot of the parameter loaded by loadOp, if it is declared. The slot
+  // is looked up by name once per load.
+  std::optional<ParameterSlot> getSlot(ParameterLoadOp loadOp);
+  const ParameterType &getValue(ParameterSlot slot) const {
+    return slotValues_[slot];
+  }
+  llvm::StringRef getParameterName(ParameterSlot slot) const {
+    return slotNames_[slot];
+  }
+
   void invalidate() { invalid_ = true; }
   bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
     return invalid_;
@@ -47,6 +47,11 @@ static inline llvm::StringRef getNoReportRuntimeAttrName() {
 static inline llvm::StringRef getNoReportUserResultAttrName() {
   return "quir.noReportUserResult";
 }
+// marks a subroutine or circuit that was left generic over its qubit
+// arguments, the target has to address its qubits at runtime
+static inline llvm::StringRef getDynamicQubitsAttrName() {
+  return "quir.dynamicQubits";
+}
 
 static inline llvm::StringRef getAngleAttrName() { return "quir.angleValue"; }
 
@@ -0,0 +1,185 @@
+//===- QubitSet.h - Set of physical qubit ids -------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  Declares the set of qubit ids operated on by a QubitOpInterface operation
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_QUBITSET_H
+#define QUIR_QUBITSET_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/bit.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+
+namespace mlir::quir {
+
+/// A set of qubit ids stored as a bitset. Sets of up to 128 qubits are held
+/// inline, larger sets spill to the heap. Unions and overlap checks work on a
+/// word at a time. Iteration visits the ids in ascending order.
+class QubitSet {
+  using Word = uint64_t;
+  static constexpr unsigned wordBits = 64;
+
+public:
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = uint32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const uint32_t *;
+    using reference = uint32_t;
+
+    iterator(llvm::ArrayRef<Word> words, size_t bit) : words(words), bit(bit) {
+      advanceToSetBit_();
+    }
+
+    uint32_t operator*() const { return static_cast<uint32_t>(bit); }
+    iterator &operator++() {
+      ++bit;
+      advanceToSetBit_();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator prev = *this;
+      ++*this;
+      return prev;
+    }
+    bool operator==(const iterator &other) const { return bit == other.bit; }
+    bool operator!=(const iterator &other) const { return bit != other.bit; }
+
+  private:
+    void advanceToSetBit_() {
+      size_t word = bit / wordBits;
+      if (word >= words.size()) {
+        bit = words.size() * wordBits;
+        return;
+      }
+      // mask off the bits below the current position
+      Word remaining = words[word] & (~Word(0) << (bit % wordBits));
+      while (remaining == 0) {
+        if (++word == words.size()) {
+          bit = words.size() * wordBits;
+          return;
+        }
+        remaining = words[word];
+      }
+      bit = word * wordBits + llvm::countr_zero(remaining);
+    }
+
+    llvm::ArrayRef<Word> words;
+    size_t bit;
+  }; // class iterator
+
+  QubitSet() = default;
+  QubitSet(std::initializer_list<uint32_t> ids) {
+    for (uint32_t const id : ids)
+      insert(id);
+  }
+
+  void insert(uint32_t id) {
+    size_t const word = id / wordBits;
+    if (word >= words.size())
+      words.resize(word + 1, 0);
+    words[word] |= Word(1) << (id % wordBits);
+  }
+
+  void erase(uint32_t id) {
+    size_t const word = id / wordBits;
+    if (word >= words.size())
+      return;
+    words[word] &= ~(Word(1) << (id % wordBits));
+    trim_();
+  }
+
+  bool contains(uint32_t id) const {
+    size_t const word = id / wordBits;
+    return word < words.size() && (words[word] >> (id % wordBits)) & 1;
+  }
+  size_t count(uint32_t id) const { return contains(id) ? 1 : 0; }
+
+  bool empty() const { return words.empty(); }
+  size_t size() const {
+    size_t result = 0;
+    for (Word const word : words)
+      result += llvm::popcount(word);
+    return result;
+  }
+  void clear() { words.clear(); }
+
+  /// Returns true if this set and other share at least one qubit
+  bool overlaps(const QubitSet &other) const {
+    size_t const common = std::min(words.size(), other.words.size());
+    for (size_t i = 0; i < common; ++i)
+      if (words[i] & other.words[i])
+        return true;
+    return false;
+  }
+
+  /// Adds all qubits of other to this set
+  QubitSet &operator|=(const QubitSet &other) {
+    if (other.words.size() > words.size())
+      words.resize(other.words.size(), 0);
+    for (size_t i = 0, e = other.words.size(); i < e; ++i)
+      words[i] |= other.words[i];
+    return *this;
+  }
+
+  /// Removes all qubits that are not in other from this set
+  QubitSet &operator&=(const QubitSet &other) {
+    if (words.size() > other.words.size())
+      words.resize(other.words.size());
+    for (size_t i = 0, e = words.size(); i < e; ++i)
+      words[i] &= other.words[i];
+    trim_();
+    return *this;
+  }
+
+  friend QubitSet operator|(QubitSet lhs, const QubitSet &rhs) {
+    lhs |= rhs;
+    return lhs;
+  }
+  friend QubitSet operator&(QubitSet lhs, const QubitSet &rhs) {
+    lhs &= rhs;
+    return lhs;
+  }
+
+  bool operator==(const QubitSet &other) const { return words == other.words; }
+  bool operator!=(const QubitSet &other) const { return words != other.words; }
+
+  iterator begin() const { return {words, 0}; }
+  iterator end() const { return {words, words.size() * wordBits}; }
+
+private:
+  // drop trailing zero words such that equal sets have equal storage and
+  // empty() does not have to scan
+  void trim_() {
+    while (!words.empty() && words.back() == 0)
+      words.pop_back();
+  }
+
+  llvm::SmallVector<Word, 2> words;
+}; // class QubitSet
+
+} // namespace mlir::quir
+
+#endif // QUIR_QUBITSET_H
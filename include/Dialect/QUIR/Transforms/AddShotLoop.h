@@ -1,6 +1,6 @@
 //===- AddShotLoop.h - Add shot loop ----------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -15,7 +15,8 @@
 //===----------------------------------------------------------------------===//
 //
 //  This file declares the pass for adding a for shot loop around the entire
-//  main function body
+//  main function body, optionally split into batches of shots and repeated
+//  for the points of a parameter sweep
 //
 //===----------------------------------------------------------------------===//
 
@@ -24,6 +25,7 @@
 
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Pass/Pass.h"
 
 namespace mlir {
@@ -35,9 +37,12 @@ struct AddShotLoopPass
     : public PassWrapper<AddShotLoopPass, OperationPass<ModuleOp>> {
   AddShotLoopPass() = default;
   AddShotLoopPass(const AddShotLoopPass &pass) : PassWrapper(pass) {}
-  AddShotLoopPass(uint inNumShots, uint inShotDelayCycles) {
+  AddShotLoopPass(uint inNumShots, uint inShotDelayCycles,
+                  uint inShotsPerBatch = 0, uint inSweepPoints = 0) {
     numShots = inNumShots;
     shotDelayCycles = inShotDelayCycles;
+    shotsPerBatch = inShotsPerBatch;
+    sweepPoints = inSweepPoints;
   }
 
   void runOnOperation() override;
@@ -50,13 +55,28 @@ struct AddShotLoopPass
       llvm::cl::desc("Cycles of delay (dt) to insert between shots, default is "
                      "4499200(1ms repetition delay at 4.5GS/s)"),
       llvm::cl::value_desc("num"), llvm::cl::init(4499200)};
+  Option<uint> shotsPerBatch{
+      *this, "shots-per-batch",
+      llvm::cl::desc("Number of shots per batch. If nonzero, the shots run in "
+                     "an outer loop over batches and the measurement results "
+                     "of each batch are streamed at its end by "
+                     "qcs.shot_batch_end, default is 0 (unbatched)"),
+      llvm::cl::value_desc("num"), llvm::cl::init(0)};
+  Option<uint> sweepPoints{
+      *this, "sweep-points",
+      llvm::cl::desc("Number of parameter points of a sweep. If nonzero, the "
+                     "shots run once per point in an outer qcs.sweep_loop, "
+                     "whose parameter loads read the values of the point "
+                     "from the parameter table of the payload, default is 0 "
+                     "(no sweep)"),
+      llvm::cl::value_desc("num"), llvm::cl::init(0)};
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
 
   void getDependentDialects(mlir::DialectRegistry &registry) const override {
-    registry.insert<mlir::quir::QUIRDialect>();
+    registry.insert<mlir::quir::QUIRDialect, mlir::memref::MemRefDialect>();
   }
 }; // struct AddShotLoopPass
 } // namespace mlir::quir
@@ -1,6 +1,6 @@
 //===- AngleConversion.h - Convert CallGateOp Angles  ----------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -21,14 +21,10 @@
 #ifndef QUIR_ANGLE_CONVERSION_H
 #define QUIR_ANGLE_CONVERSION_H
 
-#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Pass/Pass.h"
 
 #include "llvm/ADT/StringRef.h"
 
-#include <string>
-#include <unordered_map>
-
 namespace mlir::quir {
 struct QUIRAngleConversionPass
     : public PassWrapper<QUIRAngleConversionPass, OperationPass<>> {
@@ -37,9 +33,6 @@ struct QUIRAngleConversionPass
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
-
-private:
-  std::unordered_map<std::string, mlir::func::FuncOp> functionOps;
 }; // struct QUIRAngleConversionPass
 
 } // end namespace mlir::quir
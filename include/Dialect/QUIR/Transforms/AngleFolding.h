@@ -0,0 +1,56 @@
+//===- AngleFolding.h - Fold constant angle arithmetic ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for evaluating the angle arithmetic which
+///  does not depend on runtime values at compile time.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_ANGLE_FOLDING_H
+#define QUIR_ANGLE_FOLDING_H
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::quir {
+
+struct AngleFoldingPass
+    : public PassWrapper<AngleFoldingPass, OperationPass<ModuleOp>> {
+  AngleFoldingPass() = default;
+  AngleFoldingPass(const AngleFoldingPass &pass) : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  Option<bool> foldParameters{
+      *this, "parameters",
+      llvm::cl::desc("Replace parameter loads by the initial values of their "
+                     "parameters before folding. Only for programs whose "
+                     "parameters are not bound after compilation, default is "
+                     "false"),
+      llvm::cl::init(false)};
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  void getDependentDialects(mlir::DialectRegistry &registry) const override {
+    registry.insert<mlir::arith::ArithDialect>();
+  }
+}; // struct AngleFoldingPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_ANGLE_FOLDING_H
@@ -0,0 +1,49 @@
+//===- BranchHoisting.h - Hoist common ops out of branches ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file declares a utility moving operations that are common to all
+/// branches of a scf.if or quir.switch into the enclosing block, where the
+/// topological merge passes can combine them with their neighbours.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_BRANCH_HOISTING_H
+#define QUIR_BRANCH_HOISTING_H
+
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
+
+#include "mlir/IR/Operation.h"
+
+#include "llvm/ADT/STLExtras.h"
+
+namespace mlir::quir {
+
+/// For every scf.if and quir.switch nested in op, innermost first, move the
+/// operations accepted by canHoist that every branch contains:
+///  - before the branch op if, in each branch, no earlier operation acts on
+///    their qubits and their operands are defined above the branch op,
+///  - after the branch op if, in each branch, no later operation acts on
+///    their qubits and their results are unused.
+/// Operations are equivalent if they only differ in their locations. One
+/// copy is moved, the copies in the other branches are erased. Returns true
+/// if any operation was moved.
+bool hoistCommonBranchOps(
+    mlir::Operation *op, QubitDependencyAnalysis &deps,
+    llvm::function_ref<bool(mlir::Operation *)> canHoist);
+
+} // namespace mlir::quir
+
+#endif // QUIR_BRANCH_HOISTING_H
@@ -1,6 +1,6 @@
 //===- BreakReset.h - Breset reset ops --------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,11 +24,17 @@
 #include "Utils/SymbolCacheAnalysis.h"
 
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
 #include "mlir/Pass/Pass.h"
 
 #include "Dialect/QUIR/IR/QUIROps.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <cstddef>
 #include <deque>
+#include <vector>
 
 namespace mlir::quir {
 
@@ -50,6 +56,7 @@ struct BreakResetPass
   }
 
   void runOnOperation() override;
+  void getDependentDialects(mlir::DialectRegistry &registry) const override;
   Option<uint> numIterations{
       *this, "numIterations",
       llvm::cl::desc(
@@ -65,6 +72,18 @@ struct BreakResetPass
       llvm::cl::desc(
           "an option to insert call gates and measures into circuit"),
       llvm::cl::value_desc("bool"), llvm::cl::init(false)};
+  Option<bool> vectorize{
+      *this, "vectorize",
+      llvm::cl::desc("Conditionally flip the qubits of a reset of several "
+                     "qubits with a single quir.switch over the measured bits "
+                     "rather than with one scf.if per qubit"),
+      llvm::cl::value_desc("bool"), llvm::cl::init(false)};
+  Option<uint> vectorizeMaxQubits{
+      *this, "vectorize-max-qubits",
+      llvm::cl::desc("Largest number of qubits of a reset to vectorize, the "
+                     "quir.switch has a case for each nonzero outcome, "
+                     "default is 4"),
+      llvm::cl::value_desc("num"), llvm::cl::init(4)};
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
@@ -72,6 +91,8 @@ struct BreakResetPass
 
   std::deque<Operation *> measureList;
   std::deque<Operation *> callGateList;
+  // the call gates of each case of a vectorized reset
+  std::deque<std::vector<Operation *>> callGateGroupList;
 
 private:
   // keep track of all circuits
@@ -81,11 +102,15 @@ private:
                               mlir::quir::MeasureOp measureOp);
   void insertCallGateInCircuit(mlir::func::FuncOp &mainFunc,
                                mlir::quir::CallGateOp callGateOp);
+  void insertCallGatesInCircuit(mlir::func::FuncOp &mainFunc,
+                                llvm::ArrayRef<Operation *> callGateOps);
   template <class measureOrCallGate>
   mlir::quir::CircuitOp startCircuit(mlir::func::FuncOp &mainFunc,
                                      measureOrCallGate quantumGate);
   void finishCircuit(mlir::quir::CircuitOp circOp, Operation *quantumGate);
   uint circuitCounter = 0;
+  // the circuits flipping a number of qubits, shared by the vectorized resets
+  llvm::DenseMap<size_t, mlir::quir::CircuitOp> xCircuits;
   std::string getMangledName();
 }; // struct BreakResetPass
 } // namespace mlir::quir
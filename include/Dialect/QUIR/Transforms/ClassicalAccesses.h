@@ -0,0 +1,59 @@
+//===- ClassicalAccesses.h - Classical state accessed by ops ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file declares the collection of the classical state accessed by
+/// operations, for passes that move classical operations relative to the
+/// quantum ones.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_CLASSICAL_ACCESSES_H
+#define QUIR_CLASSICAL_ACCESSES_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/DenseSet.h"
+
+namespace mlir::quir {
+
+/// The classical state accessed by operations, identified by variable
+/// symbols as well as by the values and resources of memory effects.
+struct ClassicalAccesses {
+  llvm::DenseSet<const void *> reads;
+  llvm::DenseSet<const void *> writes;
+
+  bool writesAny(const llvm::DenseSet<const void *> &keys) const;
+  bool isIndependentOf(const ClassicalAccesses &other) const;
+  void merge(const ClassicalAccesses &other);
+}; // struct ClassicalAccesses
+
+/// Whether op acts on the qubits or synchronizes with the system, as
+/// determined by ClassicalOnlyDetectionPass, the quir.classicalOnly attribute
+/// and the qubit operands and results. Parameter loads only read the
+/// parameters of the execution and are classical.
+bool isQuantumOrSystemOp(mlir::Operation *op);
+
+/// Collect the classical accesses of op and its nested ops into accesses.
+/// Quantum ops are skipped if allowQuantum is set, as they act on the qubits
+/// only, and fail otherwise. Fails if the accesses cannot be determined.
+mlir::LogicalResult collectClassicalAccesses(mlir::Operation *op,
+                                             bool allowQuantum,
+                                             ClassicalAccesses &accesses);
+
+} // namespace mlir::quir
+
+#endif // QUIR_CLASSICAL_ACCESSES_H
@@ -0,0 +1,46 @@
+//===- DeduplicateCircuits.h - Merge identical circuits ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for merging structurally identical circuits.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_DEDUPLICATE_CIRCUITS_H
+#define QUIR_DEDUPLICATE_CIRCUITS_H
+
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::quir {
+
+/// @brief Replace circuits that are identical to an earlier circuit in the
+/// module apart from their name with that circuit.
+/// @details Circuits are bucketed by a structural hash of their attributes
+/// and bodies, and compared with OperationEquivalence within a bucket. The
+/// call_circuits of a duplicate are redirected to the first circuit of its
+/// kind and the duplicate is erased. Circuits differing only in the operand
+/// values they are called with are identical, as the values are arguments.
+struct DeduplicateCircuitsPass
+    : public PassWrapper<DeduplicateCircuitsPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct DeduplicateCircuitsPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_DEDUPLICATE_CIRCUITS_H
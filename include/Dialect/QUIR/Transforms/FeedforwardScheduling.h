@@ -0,0 +1,62 @@
+//===- FeedforwardScheduling.h - Shorten feedforward paths ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for moving the classical operations off the
+///  path from a measurement to the branch conditioned on its result.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_FEEDFORWARD_SCHEDULING_H
+#define QUIR_FEEDFORWARD_SCHEDULING_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// This pass shortens the feedforward path of each scf.if and quir.switch
+/// conditioned on the result of a measurement or circuit call in the same
+/// block. Classical operations between the measurement and the branch which
+/// the branch does not depend on are moved after the branch, and the ones it
+/// depends on that do not depend on the measurement are moved before the
+/// measurement. Quantum operations and the operations they depend on stay in
+/// place, and operations whose accesses cannot be determined end the search
+/// for the measurement.
+///
+/// The remaining classical operations between the measurement and the branch
+/// estimate the feedforward latency, which is reported in the
+/// quir.feedforwardOps attribute of the branch.
+struct FeedforwardSchedulingPass
+    : public PassWrapper<FeedforwardSchedulingPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numBranches{this, "feedforward-branches",
+                        "Number of branches conditioned on a measurement"};
+  Statistic numMovedOps{this, "moved-ops",
+                        "Number of classical ops moved off feedforward paths"};
+  Statistic numFeedforwardOps{
+      this, "feedforward-ops",
+      "Number of classical ops remaining on feedforward paths"};
+}; // struct FeedforwardSchedulingPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_FEEDFORWARD_SCHEDULING_H
@@ -1,6 +1,6 @@
 //===- FunctionArgumentSpecialization.h - Resolve funcs ----------*- C++-*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,11 +24,19 @@
 #define QUIR_FUNCTION_ARGUMENT_SPECIALIZATION_H
 
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Utils/SymbolCacheAnalysis.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Types.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+
 #include <deque>
+#include <utility>
 
 namespace mlir::quir {
 struct FunctionArgumentSpecializationPass
@@ -49,6 +57,18 @@ struct FunctionArgumentSpecializationPass
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
+
+private:
+  // add the calls within funcOp to the work list, once per function
+  void addCallsToWorkList(mlir::func::FuncOp funcOp,
+                          std::deque<Operation *> &callWorkList);
+
+  qssc::utils::SymbolCacheAnalysis *symbolCache{nullptr};
+  // the specialization of each function for each call signature
+  llvm::DenseMap<std::pair<Operation *, Type>, mlir::func::FuncOp>
+      specializations;
+  // the functions whose calls have been added to the work list
+  llvm::DenseSet<Operation *> visitedFuncs;
 }; // struct FunctionArgumentSpecializationPass
 } // namespace mlir::quir
 
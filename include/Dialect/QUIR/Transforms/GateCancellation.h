@@ -0,0 +1,54 @@
+//===- GateCancellation.h - Cancel and fuse gates ---------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for cancelling inverse pairs of gates and
+///  fusing consecutive single qubit gates
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_GATE_CANCELLATION_H
+#define QUIR_GATE_CANCELLATION_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// @brief Cancel pairs of quir.builtin_CX on the same control and target
+/// qubits and fuse consecutive quir.builtin_U on the same qubit with constant
+/// angles into one, dropping it if the product is the identity. Gates on
+/// a qubit are consecutive if no other operation in between acts on the
+/// qubit, that is, the gates commute through the operations on other qubits.
+/// Gates are kept if an operation in between takes qubits without reporting
+/// them through QubitOpInterface, e.g., a subroutine call.
+struct GateCancellationPass
+    : public PassWrapper<GateCancellationPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numCancelledGates{this, "cancelled-gates",
+                              "Number of gates cancelled in inverse pairs"};
+  Statistic numFusedGates{this, "fused-gates",
+                          "Number of single qubit gates fused into the next"};
+}; // struct GateCancellationPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_GATE_CANCELLATION_H
@@ -0,0 +1,119 @@
+//===- IRStatistics.h - Count the size of the IR ----------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for counting the operations, regions, blocks,
+///  symbols and elements attribute bytes of the IR at a point of the
+///  pipeline, and the counts of the IR which the resources of compiling it
+///  are estimated from.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_IR_STATISTICS_H
+#define QUIR_IR_STATISTICS_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/MapVector.h"
+
+#include <cstdint>
+#include <string>
+
+namespace mlir::quir {
+
+/// @brief The size of the IR and the size it expands to during compilation
+struct IRResourceCounts {
+  int64_t ops = 0;
+  int64_t regions = 0;
+  int64_t blocks = 0;
+  int64_t symbols = 0;
+  /// The bytes held by dense and resource elements attributes, each unique
+  /// attribute counted once
+  int64_t elementsBytes = 0;
+  /// The number of quir.declare_qubit operations
+  int64_t qubits = 0;
+  /// The operations once the constant-bound loops are unrolled and every
+  /// subroutine call is replaced by a copy of its callee, as the subroutine
+  /// cloning does.
+  int64_t unrolledOps = 0;
+  /// The unrolled operations on qubits other than subroutine calls, e.g.
+  /// gate and circuit calls and measurements
+  int64_t unrolledQuantumOps = 0;
+  /// The subroutine calls once unrolled
+  int64_t unrolledSubroutineCalls = 0;
+  /// The most calls of a single subroutine, counting the iterations of the
+  /// constant-bound loops the calls are in
+  int64_t maxSubroutineFanOut = 0;
+};
+
+/// @brief Count the resources of the IR nested in op in a single walk
+/// @param opCounts if given, receives the number of operations by name in the
+/// order of the first operation of each name
+/// @details The unrolled counts saturate rather than overflow. Recursive
+/// subroutine calls are not expanded.
+IRResourceCounts
+countIRResources(Operation *op,
+                 llvm::MapVector<OperationName, int64_t> *opCounts = nullptr);
+
+/// @brief Count the size of the IR without changing it
+/// @details The counts are reported as pass statistics and, with the op
+/// counts by name, recorded in the counter sink of the context, e.g. the
+/// timing trace, under the label of the pass. Inserting the pass with
+/// different labels at several points of a pipeline shows how the IR grows,
+/// e.g. by subroutine cloning.
+struct IRStatisticsPass
+    : public PassWrapper<IRStatisticsPass, OperationPass<>> {
+  IRStatisticsPass() = default;
+  IRStatisticsPass(const IRStatisticsPass &pass) : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<std::string> label{
+      *this, "label",
+      llvm::cl::desc("the name of the pipeline point the counts are "
+                     "recorded for"),
+      llvm::cl::value_desc("name"), llvm::cl::init("ir-statistics")};
+
+  Statistic numOps{this, "num-ops", "Number of operations"};
+  Statistic numRegions{this, "num-regions", "Number of regions"};
+  Statistic numBlocks{this, "num-blocks", "Number of blocks"};
+  Statistic numSymbols{this, "num-symbols", "Number of symbol operations"};
+  Statistic numElementsBytes{
+      this, "elements-bytes",
+      "Number of bytes held by dense and resource elements attributes, "
+      "e.g. waveform samples"};
+  Statistic numQubits{this, "num-qubits", "Number of declared qubits"};
+  Statistic numUnrolledOps{
+      this, "unrolled-ops",
+      "Number of operations with loops unrolled and subroutines cloned"};
+  Statistic numUnrolledQuantumOps{
+      this, "unrolled-quantum-ops",
+      "Number of operations on qubits with loops unrolled and subroutines "
+      "cloned"};
+  Statistic numUnrolledSubroutineCalls{
+      this, "unrolled-subroutine-calls",
+      "Number of subroutine calls with loops unrolled and subroutines cloned"};
+  Statistic maxSubroutineFanOut{this, "max-subroutine-fan-out",
+                                "Most calls of a single subroutine"};
+}; // struct IRStatisticsPass
+} // namespace mlir::quir
+
+#endif // QUIR_IR_STATISTICS_H
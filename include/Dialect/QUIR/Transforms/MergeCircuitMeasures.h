@@ -24,12 +24,27 @@
 
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+
 namespace mlir::quir {
 
 /// @brief Merge together measures in a circuit that are topologically
 /// adjacent into a single variadic measurement.
 struct MergeCircuitMeasuresTopologicalPass
     : public PassWrapper<MergeCircuitMeasuresTopologicalPass, OperationPass<>> {
+  MergeCircuitMeasuresTopologicalPass() = default;
+  MergeCircuitMeasuresTopologicalPass(
+      const MergeCircuitMeasuresTopologicalPass &pass)
+      : PassWrapper(pass) {}
+
+  Option<bool> hoistFromBranches{
+      *this, "hoist-from-branches",
+      llvm::cl::desc("Hoist circuit calls common to the start or end of all "
+                     "branches of scf.if and quir.switch ops into the "
+                     "enclosing block before merging"),
+      llvm::cl::init(false)};
+
   void runOnOperation() override;
 
   llvm::StringRef getArgument() const override;
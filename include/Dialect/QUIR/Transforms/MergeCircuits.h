@@ -31,8 +31,15 @@
 namespace mlir::quir {
 
 /// @brief Merge together back to back circuits into a single circuit
+/// @details With the sweep option each block is first scanned once for runs
+/// of call_circuits that are only separated by barriers and classical
+/// operations, and every run is merged into one new circuit by cloning each
+/// of its circuits once. The merge patterns then handle the remaining cases.
 struct MergeCircuitsPass
     : public PassWrapper<MergeCircuitsPass, OperationPass<>> {
+  MergeCircuitsPass() = default;
+  MergeCircuitsPass(const MergeCircuitsPass &pass) : PassWrapper(pass) {}
+
   void runOnOperation() override;
 
   static LogicalResult mergeCallCircuits(
@@ -41,6 +48,13 @@ struct MergeCircuitsPass
       qssc::utils::SymbolCacheAnalysis *symbolCache,
       std::optional<llvm::SmallVector<Operation *>> barriers = std::nullopt);
 
+  Option<bool> sweep{
+      *this, "sweep",
+      llvm::cl::desc("Merge each run of adjacent call_circuits in a single "
+                     "step before applying the merge patterns, default is "
+                     "false"),
+      llvm::cl::init(false)};
+
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
@@ -0,0 +1,52 @@
+//===- MergeDelays.h - Merge quir.delays on the same qubits -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for merging quir.delay ops on the same
+///  qubits
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_MERGE_DELAYS_H
+#define QUIR_MERGE_DELAYS_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// This pass merges the quir.delay ops of constant durations on the same
+/// qubits within each block into the first of them, provided no op in between
+/// acts on these qubits, e.g. the delays between the quir.call_circuit ops of
+/// other qubits. A delay without qubits delays all qubits. Delays of a
+/// stretch or of a circuit argument, ops with regions, ops on unresolved
+/// qubits and ops that may have other side effects end the delays before
+/// them, the latter three on all qubits.
+struct MergeDelaysPass
+    : public mlir::PassWrapper<MergeDelaysPass, mlir::OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numMergedDelays{this, "merged-delays",
+                            "Number of delays merged into another"};
+}; // struct MergeDelaysPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_MERGE_DELAYS_H
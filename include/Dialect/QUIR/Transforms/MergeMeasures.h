@@ -24,6 +24,9 @@
 
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+
 namespace mlir::quir {
 
 /// @brief Merge together measures in a circuit that are lexicographically
@@ -41,6 +44,17 @@ struct MergeMeasuresLexographicalPass
 /// adjacent into a single variadic measurement.
 struct MergeMeasuresTopologicalPass
     : public PassWrapper<MergeMeasuresTopologicalPass, OperationPass<>> {
+  MergeMeasuresTopologicalPass() = default;
+  MergeMeasuresTopologicalPass(const MergeMeasuresTopologicalPass &pass)
+      : PassWrapper(pass) {}
+
+  Option<bool> hoistFromBranches{
+      *this, "hoist-from-branches",
+      llvm::cl::desc("Hoist measures common to the start or end of all "
+                     "branches of scf.if and quir.switch ops into the "
+                     "enclosing block before merging"),
+      llvm::cl::init(false)};
+
   void runOnOperation() override;
 
   llvm::StringRef getArgument() const override;
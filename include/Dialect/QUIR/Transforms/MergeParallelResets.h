@@ -24,6 +24,9 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+
 namespace mlir::quir {
 /// This pass merges qubit reset operations that can be parallelized into a
 /// single reset op lexicographically.
@@ -47,7 +50,15 @@ struct MergeResetsTopologicalPass
     : public mlir::PassWrapper<MergeResetsTopologicalPass,
                                mlir::OperationPass<mlir::ModuleOp>> {
   MergeResetsTopologicalPass() = default;
-  MergeResetsTopologicalPass(const MergeResetsTopologicalPass &pass) = default;
+  MergeResetsTopologicalPass(const MergeResetsTopologicalPass &pass)
+      : PassWrapper(pass) {}
+
+  Option<bool> hoistFromBranches{
+      *this, "hoist-from-branches",
+      llvm::cl::desc("Hoist resets common to the start or end of all "
+                     "branches of scf.if and quir.switch ops into the "
+                     "enclosing block before merging"),
+      llvm::cl::init(false)};
 
   void runOnOperation() override;
 
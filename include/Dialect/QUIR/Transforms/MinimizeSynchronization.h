@@ -0,0 +1,51 @@
+//===- MinimizeSynchronization.h - Remove redundant syncs -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for removing redundant qcs.synchronize ops
+///  and merging qcs.delay_cycles ops
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_MINIMIZE_SYNCHRONIZATION_H
+#define QUIR_MINIMIZE_SYNCHRONIZATION_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// This pass tracks, within each block, which qubits were synchronized
+/// together and have not been acted on since. A qcs.synchronize is removed if
+/// its qubits are still synchronized by an earlier one, or if a later one
+/// synchronizes a superset of its qubits before any op acts on them.
+/// qcs.delay_cycles ops on the same qubits that no op acts on in between are
+/// merged into one, and delays of zero cycles are removed. Ops with regions,
+/// ops on unresolved qubits and ops that may have other side effects are
+/// assumed to act on all qubits.
+struct MinimizeSynchronizationPass
+    : public mlir::PassWrapper<MinimizeSynchronizationPass,
+                               mlir::OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct MinimizeSynchronizationPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_MINIMIZE_SYNCHRONIZATION_H
@@ -0,0 +1,51 @@
+//===- ParallelControlFlow.h - Group independent branches -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for grouping independent branch ops into a
+///  qcs.parallel_control_flow op
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_PARALLEL_CONTROL_FLOW_H
+#define QUIR_PARALLEL_CONTROL_FLOW_H
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// This pass wraps runs of adjacent scf.if and quir.switch ops that act on
+/// disjoint qubits and disjoint classical state in a
+/// qcs.parallel_control_flow op, such that targets may execute them
+/// concurrently. Side effect free ops between the branch ops are moved before
+/// the group. Branch ops with results or accesses that cannot be determined,
+/// e.g. subroutine calls, are left in place.
+struct ParallelControlFlowPass
+    : public mlir::PassWrapper<ParallelControlFlowPass,
+                               mlir::OperationPass<>> {
+  void runOnOperation() override;
+  void getDependentDialects(mlir::DialectRegistry &registry) const override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct ParallelControlFlowPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_PARALLEL_CONTROL_FLOW_H
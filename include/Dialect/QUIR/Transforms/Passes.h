@@ -19,26 +19,38 @@
 
 #include "AddShotLoop.h"
 #include "AngleConversion.h"
+#include "AngleFolding.h"
 #include "BreakReset.h"
 #include "ConvertDurationUnits.h"
+#include "DeduplicateCircuits.h"
 #include "ExtractCircuits.h"
+#include "FeedforwardScheduling.h"
 #include "FunctionArgumentSpecialization.h"
+#include "GateCancellation.h"
+#include "IRStatistics.h"
 #include "LoadElimination.h"
 #include "MergeCircuitMeasures.h"
 #include "MergeCircuits.h"
+#include "MergeDelays.h"
 #include "MergeMeasures.h"
 #include "MergeParallelResets.h"
+#include "MinimizeSynchronization.h"
+#include "ParallelControlFlow.h"
+#include "PipelineShotLoop.h"
 #include "QuantumDecoration.h"
 #include "RemoveQubitOperands.h"
 #include "RemoveUnusedCircuits.h"
 #include "ReorderCircuits.h"
 #include "ReorderMeasurements.h"
+#include "ShotLoopInvariantCodeMotion.h"
 #include "SubroutineCloning.h"
+#include "UnrollLoops.h"
 #include "UnusedVariable.h"
 #include "VariableElimination.h"
 
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassOptions.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/Passes.h"
 
@@ -46,12 +58,42 @@ namespace mlir::quir {
 void registerQuirPasses();
 void registerQuirPassPipeline();
 
+/// Options of the QUIR pipelines, enabling the optimizations that are not
+/// part of them by default
+struct QUIRPipelineOptions : public PassPipelineOptions<QUIRPipelineOptions> {
+  Option<bool> cancelGates{
+      *this, "cancel-gates",
+      llvm::cl::desc("Cancel and fuse gates with GateCancellationPass"),
+      llvm::cl::init(false)};
+  Option<bool> minimizeSynchronization{
+      *this, "minimize-synchronization",
+      llvm::cl::desc("Remove redundant synchronizations and merge delays "
+                     "with MinimizeSynchronizationPass"),
+      llvm::cl::init(false)};
+};
+
+/// Add the QUIR optimizations to a module level pass manager
+void quirPassPipelineBuilder(OpPassManager &pm,
+                             const QUIRPipelineOptions &options = {});
+/// Add the QUIR optimizations that only change the operation they run on to
+/// a pass manager nested on func.func or quir.circuit operations. Besides the
+/// ones added here, the MergeResets passes may also be nested. BreakResetPass
+/// may not, as it adds circuits to the module.
+void quirNestedPassPipelineBuilder(OpPassManager &pm,
+                                   const QUIRPipelineOptions &options = {});
+/// Add the QUIR optimizations to a module level pass manager, nesting the
+/// ones that allow it on every function and circuit such that MLIR runs them
+/// in parallel
+void quirParallelPassPipelineBuilder(OpPassManager &pm,
+                                     const QUIRPipelineOptions &options = {});
+
 // This pass recurses through the IR and detects when scf
 // ops use only classical operations. It then applies the classicalOnly
 // attribute to all of the scf ops with a value of either true or false
 struct ClassicalOnlyDetectionPass
     : public PassWrapper<ClassicalOnlyDetectionPass, OperationPass<>> {
-  auto hasQuantumSubOps(Operation *inOp) -> bool;
+  static auto isQuantumOp(Operation *op) -> bool;
+  static auto hasQuantumSubOps(Operation *inOp) -> bool;
   void runOnOperation() override;
 
   llvm::StringRef getArgument() const override;
@@ -0,0 +1,55 @@
+//===- PipelineShotLoop.h - Overlap shot post-processing --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for overlapping the classical handling of the
+///  results of a shot with the next shot.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_PIPELINE_SHOT_LOOP_H
+#define QUIR_PIPELINE_SHOT_LOOP_H
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// This pass wraps the classical operations at the end of the body of each
+/// shot loop, which handle the results of the shot, in a
+/// qcs.shot_post_process op, such that targets may run them concurrently with
+/// the next shot. The operations must be classical only, as determined by
+/// ClassicalOnlyDetectionPass, and their memory effects and variable accesses
+/// must be known and disjoint from those of the rest of the body, such that
+/// no shot depends on the post-processing of the previous one. Shot loops
+/// carrying values across shots are left in place.
+struct PipelineShotLoopPass
+    : public PassWrapper<PipelineShotLoopPass, OperationPass<>> {
+  void runOnOperation() override;
+  void getDependentDialects(mlir::DialectRegistry &registry) const override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numPipelinedLoops{this, "pipelined-shot-loops",
+                              "Number of shot loops pipelined"};
+}; // struct PipelineShotLoopPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_PIPELINE_SHOT_LOOP_H
@@ -1,6 +1,6 @@
 //===- QUIRCircuitAnalysis.h - Cache circuit argument values ---*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -24,38 +24,85 @@
 #include "mlir/Pass/AnalysisManager.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <optional>
 #include <tuple>
+#include <utility>
 
 namespace mlir::quir {
 
-enum QUIRCircuitAnalysisEntry { ANGLE = 0, PARAMETER_NAME, DURATION };
+enum QUIRCircuitAnalysisEntry {
+  ANGLE = 0,
+  PARAMETER_NAME,
+  DURATION,
+  PARAMETER_SLOT
+};
 
+/// The parameter slot is that of the ParameterInitialValueAnalysis, if the
+/// operand is loaded from a declared parameter
 using OperandAttributes =
-    std::tuple<double, llvm::StringRef, mlir::quir::DurationAttr>;
-
-using CircuitAnalysisMap = std::unordered_map<
-    mlir::Operation *,
-    std::unordered_map<mlir::Operation *,
-                       std::unordered_map<int, OperandAttributes>>>;
-
+    std::tuple<double, llvm::StringRef, mlir::quir::DurationAttr,
+               std::optional<mlir::qcs::ParameterSlot>>;
+
+/// The attributes of the operands passed to a circuit by argument number
+using CircuitOperandMap = llvm::DenseMap<unsigned, OperandAttributes>;
+
+/// The operand attributes of each circuit by parent module
+using CircuitAnalysisMap = llvm::DenseMap<
+    mlir::Operation *, llvm::DenseMap<mlir::Operation *, CircuitOperandMap>>;
+
+// The entries are kept per circuit. A pass which changes the calls of some
+// circuits may invalidate just those with invalidateCircuit(), which are
+// recomputed on the next query, and mark the analysis preserved. Passes which
+// do not touch circuits and their calls at all should also mark it preserved
+// with markAnalysesPreserved<QUIRCircuitAnalysis>(), any other pass
+// invalidates it.
 class QUIRCircuitAnalysis {
 private:
   CircuitAnalysisMap circuitOperands;
+  // circuits by parent module and symbol name
+  llvm::DenseMap<std::pair<mlir::Operation *, mlir::StringAttr>,
+                 mlir::Operation *>
+      circuitsByName;
+  // parent module of each known circuit
+  llvm::DenseMap<mlir::Operation *, mlir::Operation *> circuitModules;
+  // circuits whose calls changed since their entry was computed
+  llvm::SmallPtrSet<mlir::Operation *, 4> dirtyCircuits;
+  // copied such that dirty circuits can be recomputed after the pass which
+  // created this analysis has finished
+  mlir::qcs::ParameterInitialValueAnalysis nameAnalysis;
+  mlir::Operation *rootOp;
   bool invalid_{true};
 
 public:
   QUIRCircuitAnalysis(mlir::Operation *op, AnalysisManager &am);
-  CircuitAnalysisMap &getAnalysisMap() { return circuitOperands; }
+  CircuitAnalysisMap &getAnalysisMap();
+
+  /// Get the attributes of the operands passed to circuitOp by argument
+  /// number, recomputing the entry first if its calls changed
+  const CircuitOperandMap &getCircuitOperands(mlir::Operation *circuitOp);
+
+  /// Recompute the entry of circuitOp on the next query
+  void invalidateCircuit(mlir::Operation *circuitOp);
 
   void invalidate() { invalid_ = true; }
   bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &pa) {
-    return invalid_;
+    return invalid_ || !pa.isPreserved<QUIRCircuitAnalysis>();
   }
 
 private:
+  static mlir::qcs::ParameterInitialValueAnalysis &
+  lookupNameAnalysis_(mlir::Operation *op, AnalysisManager &am);
+  void addCircuit_(mlir::Operation *circuitOp);
+  mlir::Operation *lookupCallee_(CallCircuitOp callOp);
+  void collectOperands_(CallCircuitOp callOp, mlir::Operation *circuitOp);
+  void refreshDirtyCircuits_();
   double getAngleValue(mlir::Value operand,
                        mlir::qcs::ParameterInitialValueAnalysis *nameAnalysis);
   llvm::StringRef getParameterName(mlir::Value operand);
+  std::optional<mlir::qcs::ParameterSlot> getParameterSlot(mlir::Value operand);
   quir::DurationAttr getDuration(mlir::Value operand);
 };
 
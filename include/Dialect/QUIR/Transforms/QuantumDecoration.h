@@ -1,6 +1,6 @@
 //===- QuantumDecoration.h - Add quantum attributes -------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,9 +23,12 @@
 #define QUIR_QUANTUM_DECORATION_H
 
 #include "Dialect/QUIR/IR/QUIROps.h"
-#include "mlir/Pass/Pass.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 
-#include <unordered_set>
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"
 
 namespace mlir {
 class ModuleOp;
@@ -34,19 +37,34 @@ class ModuleOp;
 namespace mlir::quir {
 struct QuantumDecorationPass
     : public PassWrapper<QuantumDecorationPass, OperationPass<ModuleOp>> {
+  /// The qubits operated on within an operation, the qubits whose id is not
+  /// known are decorated as -1
+  struct QubitIds {
+    QubitSet ids;
+    bool hasUnknown = false;
+
+    void insert(Value qubit);
+    QubitIds &operator|=(const QubitIds &other);
+    /// the sorted ids as an array of i32 attributes
+    ArrayAttr getAttr(Builder &builder) const;
+  };
+
   // TODO: Add a mechanism to get the qubit arguments for any qubit-using op
   // using a standard interface, so this can be simplified to a single function
-  void processOp(Operation *op, std::unordered_set<int> &retSet);
-  void processOp(BuiltinCXOp op, std::unordered_set<int> &retSet);
-  void processOp(Builtin_UOp op, std::unordered_set<int> &retSet);
-  void processOp(CallDefCalGateOp op, std::unordered_set<int> &retSet);
-  void processOp(CallDefcalMeasureOp op, std::unordered_set<int> &retSet);
-  void processOp(DelayOp op, std::unordered_set<int> &retSet);
-  void processOp(CallGateOp op, std::unordered_set<int> &retSet);
-  void processOp(BarrierOp op, std::unordered_set<int> &retSet);
-  void processOp(MeasureOp op, std::unordered_set<int> &retSet);
-  void processOp(ResetQubitOp op, std::unordered_set<int> &retSet);
-  void processOp(CallCircuitOp op, std::unordered_set<int> &retSet);
+  void processOp(Operation *op, QubitIds &retSet);
+  void processOp(BuiltinCXOp op, QubitIds &retSet);
+  void processOp(Builtin_UOp op, QubitIds &retSet);
+  void processOp(CallDefCalGateOp op, QubitIds &retSet);
+  void processOp(CallDefcalMeasureOp op, QubitIds &retSet);
+  void processOp(DelayOp op, QubitIds &retSet);
+  void processOp(CallGateOp op, QubitIds &retSet);
+  void processOp(BarrierOp op, QubitIds &retSet);
+  void processOp(MeasureOp op, QubitIds &retSet);
+  void processOp(ResetQubitOp op, QubitIds &retSet);
+  void processOp(CallCircuitOp op, QubitIds &retSet);
+  /// Decorate the ops with regions nested in op, including op, and add the
+  /// qubits operated on within op to retSet
+  void decorate(Operation *op, QubitIds &retSet);
   void runOnOperation() override;
 
   llvm::StringRef getArgument() const override;
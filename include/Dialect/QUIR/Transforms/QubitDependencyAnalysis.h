@@ -0,0 +1,119 @@
+//===- QubitDependencyAnalysis.h - Per-qubit operation chains ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file declares an analysis that tracks, per block, which operations
+/// act on which qubits, for passes that reorder and merge quantum operations.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_QUBIT_DEPENDENCY_ANALYSIS_H
+#define QUIR_QUBIT_DEPENDENCY_ANALYSIS_H
+
+#include "Dialect/QUIR/IR/QubitSet.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace mlir::quir {
+
+// This analysis maintains for each block, built lazily on first query:
+//  - an order of all operations which, unlike Operation::isBeforeInBlock,
+//    survives operations being moved within the block,
+//  - the list of qubit operations, i.e. quantum operations, control flow, and
+//    any other operation reporting operated qubits through QubitOpInterface,
+//  - for every qubit, the chain of qubit operations acting on it.
+//
+// Passes which move operations must do so through moveBefore/moveAfter. The
+// analysis is a rewrite listener; passing it as the listener of the greedy
+// rewrite driver keeps it up to date as patterns create and erase
+// operations:
+//
+//   auto &deps = getAnalysis<QubitDependencyAnalysis>();
+//   mlir::GreedyRewriteConfig config;
+//   config.listener = &deps;
+//
+// Blocks that are changed in other ways are detected where possible and
+// rebuilt on the next query.
+class QubitDependencyAnalysis : public mlir::RewriterBase::Listener {
+public:
+  explicit QubitDependencyAnalysis(mlir::Operation *op);
+  ~QubitDependencyAnalysis() override;
+
+  /// Returns true if op is before other, both must be in the same block
+  bool isBeforeInBlock(mlir::Operation *op, mlir::Operation *other);
+
+  /// Returns the qubits operated on by op, including the ones of nested
+  /// operations. The set is computed once per operation.
+  const QubitSet &getOperatedQubits(mlir::Operation *op);
+
+  /// Get the next (previous) qubit operation in the block of op, or nullptr
+  mlir::Operation *getNextQubitOp(mlir::Operation *op);
+  mlir::Operation *getPrevQubitOp(mlir::Operation *op);
+
+  /// Get the next (previous) operation in the block of op that operates on
+  /// qubit, or nullptr. This is constant time if op operates on qubit.
+  mlir::Operation *getNextQubitUser(mlir::Operation *op, uint32_t qubit);
+  mlir::Operation *getPrevQubitUser(mlir::Operation *op, uint32_t qubit);
+
+  /// Move op and update the analysis. Moving an operation past others that
+  /// do not share its qubits does not change any of the qubit chains and only
+  /// costs time proportional to the number of its qubits.
+  void moveBefore(mlir::Operation *op, mlir::Operation *existingOp);
+  void moveAfter(mlir::Operation *op, mlir::Operation *existingOp);
+
+  // RewriterBase::Listener
+  void notifyOperationInserted(mlir::Operation *op) override;
+  void notifyOperationRemoved(mlir::Operation *op) override;
+
+  /// Drop all cached blocks
+  void invalidate();
+
+private:
+  struct Node;
+  struct BlockInfo;
+
+  BlockInfo &getBlockInfo_(mlir::Block *block);
+  BlockInfo *lookupBlockInfo_(mlir::Block *block);
+  BlockInfo &getTrackedInfo_(mlir::Operation *op);
+  Node *findNode_(BlockInfo &info, mlir::Operation *op);
+  bool assignLabel_(BlockInfo &info, mlir::Operation *op);
+  bool relabelAround_(BlockInfo &info, mlir::Operation *op);
+  void linkNode_(BlockInfo &info, Node *node);
+  void unlinkNode_(Node *node);
+  void linkQubits_(Node *node);
+  void unlinkQubits_(Node *node);
+  void updateMovedOp_(mlir::Operation *op, mlir::Block *oldBlock);
+  void markEnclosingOpsDirty_(mlir::Operation *op);
+  void refreshDirtyOps_();
+
+  llvm::DenseMap<mlir::Block *, std::unique_ptr<BlockInfo>> blocks;
+  // tracked operations whose nested operations changed since their qubits
+  // were last collected
+  llvm::SmallPtrSet<mlir::Operation *, 4> dirtyOps;
+  // returned for operations which do not act on qubits
+  QubitSet noQubits;
+}; // class QubitDependencyAnalysis
+
+} // namespace mlir::quir
+
+#endif // QUIR_QUBIT_DEPENDENCY_ANALYSIS_H
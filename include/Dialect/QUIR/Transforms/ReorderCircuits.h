@@ -1,6 +1,6 @@
 //===- ReorderCircuits.h - Move call_circuits ops later ---------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,13 +23,29 @@
 
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/Support/CommandLine.h"
+
 namespace mlir::quir {
 
 /// @brief Move call_circuits when possible
+/// @details By default, affine stores are moved before the call_circuits they
+/// follow if they are independent. With the schedule option, the operations of
+/// each block of main are list scheduled over their value, qubit and memory
+/// dependencies instead, such that call_circuits which may be merged are
+/// adjacent.
 struct ReorderCircuitsPass
     : public PassWrapper<ReorderCircuitsPass, OperationPass<>> {
+  ReorderCircuitsPass() = default;
+  ReorderCircuitsPass(const ReorderCircuitsPass &pass) : PassWrapper(pass) {}
+
   void runOnOperation() override;
 
+  Option<bool> schedule{
+      *this, "schedule",
+      llvm::cl::desc("Reorder the operations of each block with a "
+                     "dependency-aware list scheduler grouping call_circuits"),
+      llvm::cl::init(false)};
+
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
@@ -0,0 +1,40 @@
+//===- ShotLoopInvariantCodeMotion.h - Hoist out of shots -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for hoisting the classical setup which does
+///  not depend on shot results out of the shot loop.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_SHOT_LOOP_INVARIANT_CODE_MOTION_H
+#define QUIR_SHOT_LOOP_INVARIANT_CODE_MOTION_H
+
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::quir {
+
+struct ShotLoopInvariantCodeMotionPass
+    : public PassWrapper<ShotLoopInvariantCodeMotionPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct ShotLoopInvariantCodeMotionPass
+
+} // namespace mlir::quir
+
+#endif // QUIR_SHOT_LOOP_INVARIANT_CODE_MOTION_H
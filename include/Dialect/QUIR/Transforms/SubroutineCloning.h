@@ -27,11 +27,18 @@
 
 #include "Utils/SymbolCacheAnalysis.h"
 
+#include <cstdint>
 #include <deque>
+#include <map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/DenseMap.h"
+
 namespace mlir {
 class Operation;
 } // namespace mlir
@@ -42,18 +49,63 @@ using SymbolCache = qssc::utils::SymbolCacheAnalysis;
 
 struct SubroutineCloningPass
     : public PassWrapper<SubroutineCloningPass, OperationPass<>> {
+  SubroutineCloningPass() = default;
+  SubroutineCloningPass(const SubroutineCloningPass &pass)
+      : PassWrapper(pass) {}
+  SubroutineCloningPass(uint inMaxClonesPerCallee, uint64_t inMaxClonedOps) {
+    maxClonesPerCallee = inMaxClonesPerCallee;
+    maxClonedOps = inMaxClonedOps;
+  }
+
   auto lookupQubitId(const Value val) -> int;
 
   template <class CallLikeOp>
-  auto getMangledName(Operation *op) -> std::string;
+  auto getQubitIds(Operation *op) -> std::vector<int>;
+  auto getMangledName(llvm::StringRef callee, llvm::ArrayRef<int> qubitIds)
+      -> std::string;
   template <class CallLikeOp, class FuncLikeOp>
   void processCallOp(Operation *op, SymbolCache &symbolOpMap);
+  auto reserveClone(Operation *funcOp) -> bool;
+  template <class CallLikeOp>
+  void keepGeneric(Operation *funcOp, SymbolCache &symbolCache);
 
   void runOnOperation() override;
 
   std::deque<Operation *> callWorkList;
   std::unordered_set<Operation *> clonedFuncs;
+  // the specialization of each callee for the qubit ids of its qubit
+  // operands, calls with the same binding, including nested ones, are
+  // redirected without mangling and looking up the name again
+  std::map<std::pair<Operation *, std::vector<int>>, FlatSymbolRefAttr>
+      specializations;
   Operation *moduleOperation;
+  // the number of clones of each callee and the number of operations in it
+  llvm::DenseMap<Operation *, std::pair<uint, uint64_t>> cloneCounts;
+  uint64_t clonedOps = 0;
+  // callees that are kept generic over their qubit arguments
+  std::unordered_set<Operation *> genericFuncs;
+
+  Option<uint> maxClonesPerCallee{
+      *this, "max-clones-per-callee",
+      llvm::cl::desc("Maximum number of specializations of a subroutine or "
+                     "circuit, further calls use a generic version taking "
+                     "the qubits at runtime. 0 means no limit, the default"),
+      llvm::cl::value_desc("num"), llvm::cl::init(0)};
+  Option<uint64_t> maxClonedOps{
+      *this, "max-cloned-ops",
+      llvm::cl::desc("Maximum number of operations added by specializations, "
+                     "further calls use a generic version taking the qubits "
+                     "at runtime. 0 means no limit, the default"),
+      llvm::cl::value_desc("num"), llvm::cl::init(0)};
+
+  Statistic numClones{this, "num-clones",
+                      "Number of specialized subroutines and circuits cloned"};
+  Statistic numReusedClones{
+      this, "num-reused-clones",
+      "Number of calls redirected to an existing specialization"};
+  Statistic numGenericFuncs{
+      this, "num-generic-funcs",
+      "Number of subroutines and circuits kept generic over their qubits"};
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
@@ -0,0 +1,60 @@
+//===- UnrollLoops.h - Budgeted unrolling of for loops ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for fully unrolling constant-bound for loops
+///  within an operation budget.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_UNROLL_LOOPS_H
+#define QUIR_UNROLL_LOOPS_H
+
+#include "mlir/Pass/Pass.h"
+
+#include <cstdint>
+
+namespace mlir::quir {
+
+///
+/// \brief Fully unroll constant-bound scf.for loops within a budget
+/// \details The OpenQASM 3 frontend always emits for loops rolled such that
+/// the size of the IR does not grow with the trip count. Targets which have to
+/// materialize every iteration can schedule this pass late in their pipeline.
+/// A loop is only unrolled if its trip count times the number of operations
+/// in its body does not exceed the budget. Nested loops are considered
+/// innermost first, so an outer loop is sized with its inner loops unrolled.
+struct UnrollLoopsPass : public PassWrapper<UnrollLoopsPass, OperationPass<>> {
+  UnrollLoopsPass() = default;
+  UnrollLoopsPass(const UnrollLoopsPass &pass) : PassWrapper(pass) {}
+  UnrollLoopsPass(uint64_t inMaxUnrolledOps) {
+    maxUnrolledOps = inMaxUnrolledOps;
+  }
+
+  void runOnOperation() override;
+
+  Option<uint64_t> maxUnrolledOps{
+      *this, "max-unrolled-ops",
+      llvm::cl::desc("Maximum number of operations a loop may expand to when "
+                     "unrolled, default is 1000"),
+      llvm::cl::value_desc("num"), llvm::cl::init(1000)};
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct UnrollLoopsPass
+} // namespace mlir::quir
+
+#endif // QUIR_UNROLL_LOOPS_H
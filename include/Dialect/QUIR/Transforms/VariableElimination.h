@@ -1,6 +1,6 @@
 //===- VariableElimination.h - Lower and eliminate variables ----*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -37,6 +37,13 @@ struct VariableEliminationPass
   VariableEliminationPass(bool externalizeOutputVariables = false)
       : PassWrapper(), externalizeOutputVariables(externalizeOutputVariables) {}
 
+  Statistic numGlobalsToAllocas{
+      this, "globals-to-allocas",
+      "Number of variables lowered from memref globals to allocas"};
+  Statistic numDroppedVariables{
+      this, "dropped-variables",
+      "Number of variables dropped before forwarding as they are never read"};
+
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
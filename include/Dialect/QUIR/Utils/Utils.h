@@ -1,6 +1,6 @@
 //===- Utils.h - QUIR Utilities ---------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,15 +23,20 @@
 
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/APInt.h"
 #include "llvm/ADT/BitVector.h"
 
-#include <set>
+#include <cstdint>
+#include <optional>
+
 
 namespace mlir {
 class Operation;
@@ -63,7 +68,7 @@ llvm::Expected<uint32_t> getNodeId(Operation *moduleOperation);
 
 // adds the qubit Ids on the physicalId or physicalIds attributes to theseIds
 void addQubitIdsFromAttr(Operation *operation, std::vector<uint> &theseIds);
-void addQubitIdsFromAttr(Operation *operation, std::set<uint> &theseIds);
+void addQubitIdsFromAttr(Operation *operation, QubitSet &theseIds);
 
 // appends all of the qubit arguments for a callOp to vec
 template <class CallOpTy>
@@ -145,6 +150,14 @@ getDuration(mlir::quir::ConstantOp &duration);
 llvm::Expected<mlir::quir::DurationAttr>
 getDuration(mlir::quir::DelayOp &delayOp);
 
+/// \brief Returns the number of iterations of forOp if its bounds and step
+/// are constants
+std::optional<uint64_t> getConstantTripCount(scf::ForOp forOp);
+
+/// Encode an angle in radians as a width bit fixed-point fraction of a full
+/// turn, i.e. round(angle / 2pi * 2^width) modulo 2^width
+llvm::APInt getFixedPointAngle(double angle, unsigned width);
+
 // get qubit id from the result of a measurement
 std::tuple<Value, MeasureOp> qubitFromMeasResult(MeasureOp measureOp,
                                                  Value result);
@@ -1,6 +1,6 @@
 //===- OperationUtils.h -----------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -21,6 +21,7 @@
 #ifndef REGISTER_PASSES_H
 #define REGISTER_PASSES_H
 
+#include "Conversion/QUIRToStandard/SwitchOpLowering.h"
 #include "Dialect/OQ3/IR/OQ3Dialect.h"
 #include "Dialect/OQ3/Transforms/Passes.h"
 #include "Dialect/Pulse/IR/PulseDialect.h"
@@ -33,10 +34,16 @@
 
 #include "mlir/InitAllPasses.h"
 
+#include "llvm/ADT/StringRef.h"
+
+#include <optional>
+
 namespace qssc::dialect {
 
-/// Register all qss-compiler passes
-inline llvm::Error registerPasses() {
+/// Register the qss-compiler passes along with the passes of the named target
+/// only, or of all targets if no target is given. A name which is not a
+/// registered target, e.g. "", registers no target passes.
+inline llvm::Error registerPasses(std::optional<llvm::StringRef> targetName) {
   // TODO: Register standalone passes here.
   llvm::Error err = llvm::Error::success();
   mlir::oq3::registerOQ3Passes();
@@ -46,15 +53,27 @@ inline llvm::Error registerPasses() {
   mlir::quir::registerQuirPassPipeline();
   mlir::pulse::registerPulsePasses();
   mlir::pulse::registerPulsePassPipeline();
+  mlir::quir::registerQUIRToStdTestPasses();
   mlir::registerConversionPasses();
 
-  err = llvm::joinErrors(std::move(err), qssc::hal::registerTargetPasses());
-  err = llvm::joinErrors(std::move(err), qssc::hal::registerTargetPipelines());
+  if (targetName.has_value()) {
+    err = llvm::joinErrors(std::move(err),
+                           qssc::hal::registerTargetPasses(*targetName));
+    err = llvm::joinErrors(std::move(err),
+                           qssc::hal::registerTargetPipelines(*targetName));
+  } else {
+    err = llvm::joinErrors(std::move(err), qssc::hal::registerTargetPasses());
+    err =
+        llvm::joinErrors(std::move(err), qssc::hal::registerTargetPipelines());
+  }
 
   mlir::registerAllPasses();
   return err;
 }
 
+/// Register all qss-compiler passes
+inline llvm::Error registerPasses() { return registerPasses(std::nullopt); }
+
 } // namespace qssc::dialect
 
 #endif // REGISTER_PASSES_H
@@ -0,0 +1,89 @@
+//===- ASTStatistics.h ------------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declares the collection of per AST node kind statistics of the OpenQASM 3
+/// frontend
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef VISITOR_AST_STATISTICS_H
+#define VISITOR_AST_STATISTICS_H
+
+#include <qasm/AST/ASTBase.h>
+#include <qasm/AST/ASTTypeEnums.h>
+
+#include "mlir/IR/Operation.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+namespace qssc::frontend::openqasm3 {
+
+// Records how often each kind of AST node is visited, the time spent visiting
+// nodes of that kind excluding the nested nodes they visit, and the number of
+// operations generated for them.
+class ASTStatistics {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Measures the visit of a single node for as long as it is alive. Does
+  // nothing if statistics is null.
+  class Scope {
+  public:
+    Scope(ASTStatistics *statistics, const QASM::ASTBase *node);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    ASTStatistics *statistics;
+    QASM::ASTType kind;
+    Scope *parent = nullptr;
+    Clock::time_point start;
+    Clock::duration nestedTime{};
+  }; // class Scope
+
+  // Attribute the operations nested in root to the kind of the innermost
+  // visited node at their location. lineOffset is the number of lines the
+  // locations of the operations are shifted from the lines of the nodes.
+  void countOperations(mlir::Operation *root, int lineOffset = 0);
+
+  // print the statistics as a JSON object, sorted by time
+  void printJSON(llvm::raw_ostream &os) const;
+
+private:
+  struct Entry {
+    uint64_t count = 0;
+    Clock::duration time{};
+    uint64_t operations = 0;
+  };
+
+  std::map<QASM::ASTType, Entry> entries;
+  // the kind of the innermost node visited at each (line, column)
+  llvm::DenseMap<std::pair<unsigned, unsigned>, QASM::ASTType> locations;
+  uint64_t unattributedOperations = 0;
+  Scope *current = nullptr;
+}; // class ASTStatistics
+
+} // namespace qssc::frontend::openqasm3
+
+#endif // VISITOR_AST_STATISTICS_H
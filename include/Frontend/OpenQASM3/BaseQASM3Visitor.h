@@ -30,6 +30,8 @@
 #include <qasm/AST/ASTSymbolTable.h>
 #include <qasm/AST/ASTValue.h>
 
+#include "Frontend/OpenQASM3/ASTStatistics.h"
+
 #include "mlir/Support/LogicalResult.h"
 
 #include <string>
@@ -40,6 +42,8 @@ class BaseQASM3Visitor {
 
 protected:
   QASM::ASTStatementList *statementList;
+  // per node kind statistics of the walk, if enabled
+  ASTStatistics *statistics = nullptr;
 
 public:
   BaseQASM3Visitor(QASM::ASTStatementList *sList) : statementList(sList) {}
@@ -50,6 +54,10 @@ public:
 
   void setStatementList(QASM::ASTStatementList *);
 
+  // record statistics of the statements, declarations and expressions
+  // visited into the given object, which must outlive the walk
+  void setStatistics(ASTStatistics *);
+
   void walkAST();
 
   template <typename T>
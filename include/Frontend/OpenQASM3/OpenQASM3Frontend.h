@@ -1,6 +1,6 @@
 //===- OpenQASM3Frontend.h --------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -25,15 +25,87 @@
 #include "API/errors.h"
 
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/SourceMgr.h"
 
+#include <cstddef>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace qssc::frontend::openqasm3 {
 
+/// @brief State of a single invocation of the OpenQASM 3 frontend.
+///
+/// A session owns everything the frontend needs to translate one program:
+/// the MLIR context the program is emitted into, the name of the source file
+/// used for locations, and the routing of qe-qasm parser diagnostics to that
+/// context. Sessions on different threads and contexts do not share any
+/// frontend state. The qe-qasm library keeps its preprocessor and statement
+/// list in process-wide singletons, so the section of parse() that builds and
+/// walks the AST is still serialized between sessions. Verification of the
+/// emitted module and all setup work run outside of that section.
+///
+/// Diagnostics reported by the parser are collected by the session, up to a
+/// bounded number, and only emitted to the context's diagnostic engine once
+/// the serialized section has been left. Diagnostic handlers of the context
+/// thus never run while other sessions wait for the parser.
+class ParserSession {
+public:
+  explicit ParserSession(mlir::MLIRContext *context) : context(context) {}
+  ParserSession(mlir::MLIRContext *context, unsigned maxParserDiagnostics)
+      : context(context), maxParserDiagnostics(maxParserDiagnostics) {}
+
+  /// @brief Parse an OpenQASM 3 source and emit high-level IR or dump the AST.
+  /// See qssc::frontend::openqasm3::parse for a description of the arguments.
+  llvm::Error parse(llvm::SourceMgr &sourceMgr, bool emitRawAST,
+                    bool emitPrettyAST, bool emitMLIR, mlir::ModuleOp newModule,
+                    mlir::TimingScope &timing);
+
+  mlir::MLIRContext *getContext() const { return context; }
+  llvm::StringRef getSourceFile() const { return sourceFile; }
+  /// @brief Whether the source was parsed from a string, for which qe-qasm
+  /// reports locations one line early.
+  /// Workaround for https://github.com/openqasm/qe-qasm/issues/35
+  /// TODO: Remove once this bug is fixed
+  bool requiresParserLocationFix() const { return parserLocationFix; }
+
+  /// @brief Return the session parsing on the calling thread, if any. Used to
+  /// route qe-qasm parser diagnostics back to their originating session.
+  static ParserSession *getActiveSession();
+
+  /// @brief Collect a diagnostic reported by the parser, or count it as
+  /// dropped once the bound on collected diagnostics has been reached.
+  /// Returns whether the parser should be aborted, which is the case after
+  /// an error.
+  bool addParserDiagnostic(mlir::DiagnosticSeverity severity, unsigned line,
+                           unsigned column, llvm::StringRef message);
+
+private:
+  struct ParserDiagnostic {
+    mlir::DiagnosticSeverity severity;
+    unsigned line;
+    unsigned column;
+    std::string message;
+  };
+
+  /// Emit and clear the collected parser diagnostics.
+  void flushParserDiagnostics_();
+
+  mlir::MLIRContext *context;
+  std::string sourceFile;
+  bool parserLocationFix = false;
+  unsigned maxParserDiagnostics = 100;
+  std::vector<ParserDiagnostic> parserDiagnostics;
+  size_t droppedParserDiagnostics = 0;
+};
+
 /// @brief Parse an OpenQASM 3 source file and emit high-level IR in the
 /// OpenQASM 3 dialect or dump the AST
 /// @param context The context to parse the module into
@@ -42,12 +114,53 @@ namespace qssc::frontend::openqasm3 {
 /// @param emitPrettyAST whether a pretty-printed AST should be dumped
 /// @param emitMLIR whether high-level IR should be emitted
 /// @param newModule ModuleOp container for emitting MLIR into
+/// @param timing Timing scope to nest the frontend timers in
 /// @return an llvm::Error in case of failure, or llvm::Error::success()
 /// otherwise
 llvm::Error parse(mlir::MLIRContext *context, llvm::SourceMgr &sourceMgr,
                   bool emitRawAST, bool emitPrettyAST, bool emitMLIR,
                   mlir::ModuleOp newModule, mlir::TimingScope &timing);
 
+/// @brief An OpenQASM 3 source with the literal initial values of its input
+/// parameters taken out.
+struct ParameterizedSource {
+  /// The source with the initializers of the input declarations removed
+  std::string text;
+  /// The initial values of the input declarations in source order
+  std::vector<double> parameterValues;
+};
+
+/// @brief Split the initial values of the input parameters off an OpenQASM 3
+/// source such that programs which only differ in them share the same text.
+/// @return std::nullopt if the emitted module may depend on more than the
+/// text, i.e. if the source may include other files, or if an input
+/// parameter is not initialized with a numeric literal.
+std::optional<ParameterizedSource> parameterizeSource(llvm::StringRef source);
+
+/// @brief Return the values of the frontend options that affect the emitted
+/// module.
+std::string getOptionsKey();
+
+/// @brief Return a digest of the files an OpenQASM 3 source may include:
+/// every file below the include directories, and the files its include
+/// statements name relative to the directory of the source, transitively.
+/// @param source The OpenQASM 3 source text.
+/// @param sourceFile The path of the source, e.g. the identifier of its
+/// buffer.
+/// @return The hex encoded digest.
+std::string getIncludesKey(llvm::StringRef source, llvm::StringRef sourceFile);
+
+/// @brief Return the initial values of the input parameters declared in
+/// moduleOp, in declaration order.
+std::vector<double> getInputParameterValues(mlir::ModuleOp moduleOp);
+
+/// @brief Replace the initial values of the input parameters declared in
+/// moduleOp, in declaration order.
+/// @return an llvm::Error if the number of values does not match the number
+/// of parameters, or llvm::Error::success() otherwise
+llvm::Error setInputParameterValues(mlir::ModuleOp moduleOp,
+                                    llvm::ArrayRef<double> values);
+
 }; // namespace qssc::frontend::openqasm3
 
 #endif // OPENQASM3_FRONTEND_H
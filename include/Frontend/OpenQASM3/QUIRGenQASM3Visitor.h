@@ -1,6 +1,6 @@
 //===- QUIRGenQASM3Visitor.h ------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -28,9 +28,14 @@
 #include "Frontend/OpenQASM3/QUIRVariableBuilder.h"
 
 #include "mlir/Dialect/Complex/IR/Complex.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace qssc::frontend::openqasm3 {
 
@@ -53,7 +58,12 @@ private:
   std::string fileName;
   bool requiresParserLocationFix;
 
+  /// The location of the operations generated for an AST node, as selected
+  /// by --qasm3-locations.
   mlir::Location getLocation(const QASM::ASTBase *);
+  /// The source location of an AST node, for diagnostics.
+  mlir::Location getSourceLocation(const QASM::ASTBase *,
+                                   bool withColumn = true);
   bool assign(mlir::Value &, const std::string &);
   mlir::Value getCurrentValue(const std::string &valueName);
   llvm::Expected<std::string>
@@ -78,6 +88,14 @@ private:
 
   QUIRVariableBuilder varHandler;
 
+  /// gate declarations which have not been referenced yet, by gate name, and
+  /// those which have been referenced but not generated yet
+  llvm::StringMap<const QASM::ASTGateDeclarationNode *>
+      deferredGateDeclarations;
+  std::vector<const QASM::ASTGateDeclarationNode *> referencedGateDeclarations;
+  void referenceGateDeclaration(llvm::StringRef name);
+  void generateGateDeclaration(const QASM::ASTGateDeclarationNode *node);
+
   mlir::Value createVoidValue(mlir::Location);
   mlir::Value createVoidValue(QASM::ASTBase const *node);
 
@@ -150,6 +168,9 @@ public:
 
   mlir::LogicalResult walkAST();
 
+  /// Return the values of the options that affect the generated module.
+  static std::string getOptionsKey();
+
 protected:
   void visit(const QASM::ASTForStatementNode *) override;
 
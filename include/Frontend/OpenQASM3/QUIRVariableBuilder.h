@@ -23,15 +23,17 @@
 #define OPENQASM3_QUIR_VARIABLE_BUILDER_H
 
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 
 #include <qasm/AST/ASTSymbolTable.h>
 #include <qasm/AST/ASTTypes.h>
 
-#include <unordered_map>
 
 namespace qssc::frontend::openqasm3 {
 
@@ -203,7 +205,7 @@ public:
   /// variable handling.
   bool tracksVariable(llvm::StringRef variableName) {
 
-    return variables.find(variableName.str()) != variables.end();
+    return variables.find(variableName) != variables.end();
   }
 
   /// Resolve the mlir::Type for representing a given symbol table entry.
@@ -242,9 +244,19 @@ private:
     return (useClassicalBuilder) ? classicalBuilder : builder;
   }
 
-  std::unordered_map<std::string, mlir::Type> variables;
+  // variables by their name, with the symbol referring to the declaration
+  // such that uses and assignments do not have to intern the name again
+  struct Variable {
+    mlir::Type type;
+    mlir::FlatSymbolRefAttr symbol;
+  };
+  llvm::StringMap<Variable> variables;
 
-  std::unordered_map<mlir::Operation *, mlir::Operation *> lastDeclaration;
+  mlir::FlatSymbolRefAttr getVariableSymbol(llvm::StringRef variableName);
+
+  // the last declaration in each module, after which the next declaration is
+  // inserted
+  llvm::DenseMap<mlir::Operation *, mlir::Operation *> lastDeclaration;
 
   mlir::Type resolveQUIRVariableType(QASM::ASTType astType,
                                      const unsigned bits) const;
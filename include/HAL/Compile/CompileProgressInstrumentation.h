@@ -0,0 +1,52 @@
+//===- CompileProgressInstrumentation.h - Pass progress ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares a pass instrumentation which reports the passes of a
+///  compilation to its progress callback.
+///
+//===----------------------------------------------------------------------===//
+#ifndef COMPILEPROGRESSINSTRUMENTATION_H
+#define COMPILEPROGRESSINSTRUMENTATION_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+
+#include <string>
+#include <utility>
+
+namespace qssc::hal::compile {
+
+/// @brief Reports each pass running on a module to the progress callback of
+/// the compilation in the module's context, see
+/// qssc::utils::reportCompileProgress, as "<prefix>pass <argument>". The
+/// passes nested on the operations of the module are not reported. The
+/// control of the context is looked up on every report, such that pass
+/// managers may be reused across compilations.
+class CompileProgressInstrumentation : public mlir::PassInstrumentation {
+public:
+  explicit CompileProgressInstrumentation(std::string prefix = "")
+      : prefix(std::move(prefix)) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override;
+
+private:
+  std::string prefix;
+};
+
+} // namespace qssc::hal::compile
+
+#endif // COMPILEPROGRESSINSTRUMENTATION_H
@@ -0,0 +1,78 @@
+//===- IRDumpWriter.h - Background writer of IR dumps -----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  Writes the IR dumps of the target compilation on a background thread.
+///  The compilation threads serialize their modules into buffers and hand
+///  them off, such that they never wait on terminal or file I/O.
+///
+//===----------------------------------------------------------------------===//
+#ifndef IRDUMPWRITER_H
+#define IRDUMPWRITER_H
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace qssc::hal::compile {
+
+/// @brief Writes buffered dumps in the order they were queued on a single
+/// background thread, which is started by the first dump.
+class IRDumpWriter {
+public:
+  IRDumpWriter() = default;
+  /// Writes the queued dumps before returning.
+  ~IRDumpWriter();
+
+  IRDumpWriter(const IRDumpWriter &) = delete;
+  IRDumpWriter &operator=(const IRDumpWriter &) = delete;
+
+  /// @brief Queue contents to be written to out, which must outlive the
+  /// writer or the next call to flush.
+  void write(std::string contents, llvm::raw_ostream &out);
+  /// @brief Queue contents to be written to the file at path, replacing it.
+  /// Failures to write the file are reported on llvm::errs().
+  void write(std::string contents, std::string path);
+
+  /// @brief Wait until all dumps queued so far are written.
+  void flush();
+
+private:
+  struct Dump {
+    std::string contents;
+    // the stream to write to, or nullptr to write to path
+    llvm::raw_ostream *out;
+    std::string path;
+  };
+
+  void enqueue_(Dump dump);
+  void run_();
+
+  std::mutex mutex;
+  std::condition_variable dumpQueued;
+  std::condition_variable dumpsWritten;
+  std::deque<Dump> dumps;
+  // whether the writer is writing a dump it took off the queue
+  bool writing = false;
+  bool stopping = false;
+  std::thread writerThread;
+};
+
+} // namespace qssc::hal::compile
+#endif // IRDUMPWRITER_H
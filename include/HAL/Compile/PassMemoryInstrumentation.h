@@ -0,0 +1,103 @@
+//===- PassMemoryInstrumentation.h - Memory growth per pass -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares a pass instrumentation which attributes the growth of
+///  the memory of the compiler to the passes and targets running them.
+///
+//===----------------------------------------------------------------------===//
+#ifndef PASSMEMORYINSTRUMENTATION_H
+#define PASSMEMORYINSTRUMENTATION_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace qssc::hal::compile {
+
+/// @brief The memory growth of each pass of each target, collected by
+/// PassMemoryInstrumentation. Thread-safe.
+class PassMemoryReport {
+public:
+  struct Entry {
+    unsigned runs = 0;
+    unsigned failures = 0;
+    /// Growth of the peak resident set size of the process, summed over the
+    /// runs. As the peak only grows, the passes raising it are the ones an
+    /// out of memory condition is attributed to.
+    int64_t peakRSSGrowth = 0;
+    /// Growth of the allocated heap, which holds the IR and the attributes
+    /// and types uniqued in the MLIRContext, summed and at most per run
+    int64_t heapGrowth = 0;
+    int64_t maxHeapGrowth = 0;
+  };
+
+  void record(llvm::StringRef target, llvm::StringRef pass,
+              int64_t peakRSSGrowth, int64_t heapGrowth, bool failed);
+
+  /// @brief Print the entries ordered by their peak resident set size
+  /// growth, then by their heap growth.
+  void print(llvm::raw_ostream &os) const;
+
+private:
+  mutable std::mutex mutex;
+  llvm::MapVector<std::pair<std::string, std::string>, Entry> entries;
+};
+
+/// @brief Records the peak resident set size and the heap usage of the
+/// process before and after each pass and attributes the growth to the pass
+/// and the target the pass manager belongs to. The process wide measures
+/// overlap when passes run in parallel, which --mlir-disable-threading
+/// avoids. Adaptor passes report the growth of the passes nested in them.
+class PassMemoryInstrumentation : public mlir::PassInstrumentation {
+public:
+  PassMemoryInstrumentation(std::shared_ptr<PassMemoryReport> report,
+                            std::string target)
+      : report(std::move(report)), target(std::move(target)) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override;
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override;
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override;
+
+private:
+  struct Sample {
+    int64_t peakRSS;
+    int64_t heap;
+  };
+
+  static Sample sample();
+  void recordRun(mlir::Pass *pass, mlir::Operation *op, bool failed);
+
+  std::shared_ptr<PassMemoryReport> report;
+  std::string target;
+  // the samples taken before the passes running, by pass and operation
+  std::mutex mutex;
+  llvm::DenseMap<std::pair<mlir::Pass *, mlir::Operation *>, Sample> before;
+};
+
+} // namespace qssc::hal::compile
+
+#endif // PASSMEMORYINSTRUMENTATION_H
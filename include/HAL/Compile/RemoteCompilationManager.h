@@ -0,0 +1,189 @@
+//===- RemoteCompilationManager.h - Remote subtrees -------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the compilation manager offloading the compilation of
+///  target subtrees to workers.
+///
+//===----------------------------------------------------------------------===//
+#ifndef REMOTECOMPILATIONMANAGER_H
+#define REMOTECOMPILATIONMANAGER_H
+
+#include "API/errors.h"
+#include "Config/QSSConfig.h"
+#include "HAL/Compile/ThreadedCompilationManager.h"
+#include "HAL/TargetSystem.h"
+#include "Payload/Payload.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Error.h"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qssc::hal::compile {
+
+/// @brief A request to compile the subtree of a target system rooted at one
+/// of its targets on a worker.
+struct RemoteCompileRequest {
+  /// The names of the targets from the root of the target system down to
+  /// the root of the subtree.
+  std::vector<std::string> targetPath;
+  /// The module of the subtree root serialized to MLIR bytecode.
+  std::string moduleBytecode;
+  /// Whether to run the target passes prior to emitting the payload.
+  bool doCompileMLIR = true;
+  /// Whether to return the module of the subtree root after its compilation.
+  bool returnLoweredModule = true;
+  /// The profile of the payload to emit.
+  qssc::config::PayloadProfile payloadProfile =
+      qssc::config::PayloadProfile::Debug;
+};
+
+/// @brief The result of compiling a subtree on a worker.
+struct RemoteCompileResult {
+  /// The payload files emitted by the targets of the subtree.
+  std::vector<std::pair<std::string, std::string>> payloadFiles;
+  /// The module of the subtree root after its compilation serialized to MLIR
+  /// bytecode, empty if it was not requested.
+  std::string loweredModuleBytecode;
+  /// The diagnostics of the targets of the subtree.
+  qssc::DiagList diagnostics;
+};
+
+/// @brief The transport between a RemoteCompilationManager and its workers.
+/// Implementations hand a request to a worker, which compiles it with a
+/// RemoteCompilationWorker, and return the worker's result. compileSubtree is
+/// called concurrently for disjoint subtrees and blocks until the result is
+/// available.
+class RemoteTargetExecutor {
+public:
+  virtual ~RemoteTargetExecutor() = default;
+
+  virtual llvm::Expected<RemoteCompileResult>
+  compileSubtree(const RemoteCompileRequest &request) = 0;
+};
+
+/// @brief Compiles the requests of a RemoteCompilationManager on a worker.
+/// The worker's target system must have been created with the configuration
+/// of the manager's target system.
+class RemoteCompilationWorker {
+public:
+  RemoteCompilationWorker(hal::TargetSystem &target,
+                          mlir::MLIRContext *context,
+                          ThreadedCompilationManager::PMBuilder pmBuilder);
+
+  /// @brief Compile the subtree of request into payload and take the emitted
+  /// files into the result. The payload should be configured like the one of
+  /// the manager, in particular with the same prefix. Requests are compiled
+  /// one at a time, run several workers to compile them concurrently.
+  llvm::Expected<RemoteCompileResult>
+  compile(const RemoteCompileRequest &request,
+          qssc::payload::Payload &payload);
+
+private:
+  hal::TargetSystem &target;
+  mlir::MLIRContext *context;
+  ThreadedCompilationManager manager;
+  std::mutex mutex;
+}; // class RemoteCompilationWorker
+
+/// @brief Executes the requests with a worker of the same process, e.g., to
+/// test a remote compilation or to compile on a separate context.
+class InProcessTargetExecutor : public RemoteTargetExecutor {
+public:
+  using PayloadFactory =
+      std::function<std::unique_ptr<qssc::payload::Payload>()>;
+
+  InProcessTargetExecutor(RemoteCompilationWorker &worker,
+                          PayloadFactory createPayload)
+      : worker(worker), createPayload(std::move(createPayload)) {}
+
+  llvm::Expected<RemoteCompileResult>
+  compileSubtree(const RemoteCompileRequest &request) override;
+
+  /// The number of requests executed so far.
+  size_t getNumRequests() const { return numRequests; }
+
+private:
+  RemoteCompilationWorker &worker;
+  PayloadFactory createPayload;
+  std::atomic<size_t> numRequests = 0;
+}; // class InProcessTargetExecutor
+
+/// @brief A ThreadedCompilationManager offloading the compilation of the
+/// payload of target subtrees to workers through a RemoteTargetExecutor.
+///
+/// The targets at offloadDepth below the root of the target system are
+/// offloaded together with their subtrees, the targets above them are
+/// compiled locally. The module of an offloaded target is serialized to MLIR
+/// bytecode once the passes of its parent created it, and the payload files
+/// emitted by the worker are merged into the payload of the compilation. The
+/// local module of the target is replaced by the one lowered by the worker,
+/// such that the post-children payload emission of its parent observes the
+/// compiled module, unless disabled with setReturnLoweredModules.
+///
+/// compileMLIR does not emit a payload and runs locally.
+class RemoteCompilationManager : public ThreadedCompilationManager {
+public:
+  RemoteCompilationManager(qssc::hal::TargetSystem &target,
+                           mlir::MLIRContext *context, PMBuilder pmBuilder,
+                           std::shared_ptr<RemoteTargetExecutor> executor,
+                           unsigned offloadDepth = 1);
+  virtual ~RemoteCompilationManager() = default;
+  virtual const std::string getName() const override;
+
+  virtual llvm::Error compilePayload(mlir::ModuleOp moduleOp,
+                                     qssc::payload::Payload &payload,
+                                     bool doCompileMLIR = true) override;
+
+  /// @brief Have the workers return the lowered modules of the offloaded
+  /// targets. May be disabled if no target inspects the modules of its
+  /// children after their compilation.
+  void setReturnLoweredModules(bool flag) { returnLoweredModules = flag; }
+
+private:
+  /// The depth of target below the root of the target system.
+  unsigned getDepth_(Target *target);
+  /// Compile the subtree of target on a worker.
+  llvm::Error offloadSubtree_(Target &target, mlir::ModuleOp targetModuleOp,
+                              qssc::payload::Payload &payload,
+                              mlir::TimingScope &timing, bool doCompileMLIR);
+
+  std::shared_ptr<RemoteTargetExecutor> executor;
+  unsigned offloadDepth;
+  bool returnLoweredModules = true;
+}; // class RemoteCompilationManager
+
+/// @brief The names of the targets from the root of the target system down
+/// to target.
+std::vector<std::string> getTargetPath(hal::Target &target);
+
+/// @brief Find the target with the path of target names, starting with the
+/// name of root, below root.
+llvm::Expected<hal::Target *> lookupTargetPath(hal::Target &root,
+                                              llvm::ArrayRef<std::string> path);
+
+} // namespace qssc::hal::compile
+#endif // REMOTECOMPILATIONMANAGER_H
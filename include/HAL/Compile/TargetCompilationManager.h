@@ -1,6 +1,6 @@
 //===- TargetCompilationManager.h - Compilation Scheduler -----*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,13 +23,16 @@
 
 #include "API/errors.h"
 #include "Config/QSSConfig.h"
+#include "HAL/Compile/PassMemoryInstrumentation.h"
 #include "HAL/TargetSystem.h"
 
 #include "mlir/IR/BuiltinOps.h"
 
 #include "llvm/Support/Error.h"
 
+#include <memory>
 #include <string>
+#include <utility>
 
 using namespace qssc;
 
@@ -96,6 +99,28 @@ public:
                         bool printBeforeAllTargetPayload,
                         bool printAfterTargetCompileFailure);
 
+  /// @brief Write the IR dumps enabled by enableIRPrinting to a file per
+  /// target and stage, named <target>.<stage>.mlir, in directory rather than
+  /// to stdout. An empty directory restores printing to stdout.
+  /// @param bytecode Write the dumps as MLIR bytecode, with the extension
+  /// .mlirbc, instead of as text.
+  void enableIRDumpDirectory(std::string directory, bool bytecode = false) {
+    irDumpDirectory = std::move(directory);
+    irDumpBytecode = bytecode;
+  }
+
+  /// @brief Fully verify the module of each target after its pass pipeline,
+  /// e.g., when the passes themselves are not followed by verification.
+  void enableTargetModuleVerification(bool flag = true) {
+    verifyTargetModules = flag;
+  }
+
+  /// @brief Record the memory growth of each target pass in report. Must be
+  /// enabled before the first compilation.
+  void enablePassMemoryReport(std::shared_ptr<PassMemoryReport> report) {
+    passMemoryReport = std::move(report);
+  }
+
   /// @brief Take the diagnostics capatured in the Target
   qssc::DiagList takeTargetDiagnostics() { return target.takeDiagnostics(); }
 
@@ -109,6 +134,12 @@ protected:
   bool getPrintAfterTargetCompileFailure() {
     return printAfterTargetCompileFailure;
   }
+  bool getVerifyTargetModules() { return verifyTargetModules; }
+  const std::string &getIRDumpDirectory() { return irDumpDirectory; }
+  bool getIRDumpBytecode() { return irDumpBytecode; }
+  const std::shared_ptr<PassMemoryReport> &getPassMemoryReport() {
+    return passMemoryReport;
+  }
 
   /// Thread-safe implementation
   virtual void printIR(llvm::Twine msg, mlir::Operation *op,
@@ -126,6 +157,10 @@ private:
   bool printAfterAllTargetPasses = false;
   bool printBeforeAllTargetPayload = false;
   bool printAfterTargetCompileFailure = false;
+  bool verifyTargetModules = false;
+  std::string irDumpDirectory;
+  bool irDumpBytecode = false;
+  std::shared_ptr<PassMemoryReport> passMemoryReport;
 
   mlir::TimingScope rootTimer;
 
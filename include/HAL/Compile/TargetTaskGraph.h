@@ -0,0 +1,140 @@
+//===- TargetTaskGraph.h - Target tree dependency graph ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the dependency graph scheduler used to walk a target
+///  system tree in parallel.
+///
+//===----------------------------------------------------------------------===//
+#ifndef TARGETTASKGRAPH_H
+#define TARGETTASKGRAPH_H
+
+#include "HAL/TargetSystem.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/Support/Error.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace qssc::hal::compile {
+
+/// @brief Schedules a walk of a target tree as a dependency graph.
+///
+/// Every target contributes two tasks: a pre-children task which must
+/// complete before the target's children may start, and a post-children task
+/// which runs once the subtrees of all of its children completed. There are
+/// no other dependencies, so a target's subtree proceeds as soon as its parent
+/// finished its pre-children task, independently of how long its siblings or
+/// their subtrees take.
+///
+/// Ready tasks are submitted to the thread pool of the MLIRContext, shared
+/// with MLIR's own parallel pass execution, so that target tasks and nested
+/// passes do not oversubscribe the host. The post-children task of a target
+/// runs on the thread which completed its last child, avoiding a thread
+/// blocking on its children. If multithreading is disabled on the context the
+/// tasks run sequentially in depth first order.
+///
+/// Each target is timed by a scope nested in its parent's "children" scope
+/// which spans from the start of its pre-children task to the end of its
+/// post-children task, i.e., the latency of its subtree.
+class TargetTaskGraph {
+public:
+  using TaskFunction = std::function<llvm::Error(
+      hal::Target *, mlir::ModuleOp, mlir::TimingScope &timing)>;
+  using SkipChildrenFunction = std::function<bool(hal::Target *)>;
+
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief A target on the critical path of the last run along with the
+  /// time spent in its own tasks.
+  struct CriticalPathEntry {
+    hal::Target *target;
+    Clock::duration duration;
+  };
+
+  TargetTaskGraph(mlir::MLIRContext *context, hal::Target *root);
+  ~TargetTaskGraph();
+
+  /// @brief Run the graph.
+  /// @param rootModuleOp The module of the root target. If null, targets are
+  /// walked without looking up their modules and the task functions receive
+  /// a null module.
+  /// @param timing The timing scope to nest target timing scopes in.
+  /// @param preChildrenFunc Task run on a target before its children.
+  /// @param postChildrenFunc Task run on a target after all of its children.
+  /// @return The errors of all failed tasks. Children of a target whose task
+  /// failed are not run.
+  ///
+  /// Diagnostics emitted by the tasks are reported once all of them
+  /// completed, in the depth-first order of their targets, such that they do
+  /// not depend on the scheduling of the tasks.
+  llvm::Error run(mlir::ModuleOp rootModuleOp, mlir::TimingScope &timing,
+                  const TaskFunction &preChildrenFunc,
+                  const TaskFunction &postChildrenFunc);
+
+  /// @brief Do not walk the children of the targets for which func returns
+  /// true after their pre-children task, e.g., as their subtrees were
+  /// compiled elsewhere. Their post-children task follows immediately.
+  void setSkipChildrenFunction(SkipChildrenFunction func) {
+    skipChildrenFunc = std::move(func);
+  }
+
+  /// @brief The chain of targets which determined the latency of the last
+  /// successful run, ordered from the root to a leaf.
+  const std::vector<CriticalPathEntry> &getCriticalPath() const {
+    return criticalPath;
+  }
+
+private:
+  struct Node;
+
+  Node *buildNodes_(hal::Target *target, Node *parent);
+  void schedule_(Node *node);
+  void runPreChildren_(Node *node);
+  void runPostChildren_(Node *node);
+  void setDiagnosticOrder_(Node *node);
+  void recordError_(llvm::Error err);
+  void computeCriticalPath_();
+
+  mlir::MLIRContext *context;
+  std::vector<std::unique_ptr<Node>> nodes;
+  Node *rootNode = nullptr;
+
+  // State of the current run
+  mlir::TimingScope *rootTiming = nullptr;
+  const TaskFunction *preChildrenFunc = nullptr;
+  const TaskFunction *postChildrenFunc = nullptr;
+  SkipChildrenFunction skipChildrenFunc;
+  std::function<void(Node *)> submit;
+  mlir::ParallelDiagnosticHandler *diagnosticHandler = nullptr;
+  std::atomic<bool> failed = false;
+  std::mutex errorMutex;
+  llvm::Error *errors = nullptr;
+
+  std::vector<CriticalPathEntry> criticalPath;
+}; // class TargetTaskGraph
+
+} // namespace qssc::hal::compile
+#endif // TARGETTASKGRAPH_H
@@ -1,6 +1,6 @@
 //===- ThreadedCompilationManager.h - Threaded Scheduler ------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -22,9 +22,16 @@
 #define THREADEDCOMPILATIONMANAGER_H
 
 #include "Config/QSSConfig.h"
+#include "HAL/Compile/IRDumpWriter.h"
 #include "HAL/Compile/TargetCompilationManager.h"
+#include "HAL/Compile/TargetTaskGraph.h"
 
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/Timing.h"
+
+#include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 
 namespace qssc::hal::compile {
@@ -44,21 +51,46 @@ namespace qssc::hal::compile {
 /// cores.
 class ThreadedCompilationManager : public TargetCompilationManager {
 protected:
-  /// Threaded depth first walker for a target system using the current
-  /// MLIRContext's threadpool.
+  /// Threaded walker for a target system scheduling the target tree as a
+  /// TargetTaskGraph on the current MLIRContext's threadpool.
   llvm::Error walkTargetThreaded(
       Target *target, mlir::TimingScope &timing,
       const TargetCompilationManager::WalkTargetFunction &walkFunc);
-  /// Threaded depth first walker for a target system modules using the current
-  /// MLIRContext's threadpool.
+  /// Threaded walker for a target system modules scheduling the target tree as
+  /// a TargetTaskGraph on the current MLIRContext's threadpool. A target's
+  /// children start as soon as walkFunc completed for it and its
+  /// postChildrenCallbackFunc runs once all of its children's subtrees
+  /// completed. The children of the targets for which skipChildren returns
+  /// true are not walked.
   llvm::Error walkTargetModulesThreaded(
       Target *target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing,
       const TargetCompilationManager::WalkTargetModulesFunction &walkFunc,
       const TargetCompilationManager::WalkTargetModulesFunction
-          &postChildrenCallbackFunc);
+          &postChildrenCallbackFunc,
+      TargetTaskGraph::SkipChildrenFunction skipChildren = nullptr);
 
   virtual void printIR(llvm::Twine msg, mlir::Operation *op,
                        llvm::raw_ostream &out) override;
+  /// Dump the IR of a target at a compilation stage to stdout or to the IR
+  /// dump directory. The module is serialized on the calling thread and
+  /// written by the IR dump writer, which the compilations flush before
+  /// returning.
+  void dumpIR(Target &target, llvm::StringRef stage, llvm::Twine msg,
+              mlir::Operation *op);
+
+  /// Prepare pass managers in a threaded way
+  /// initializing them with the mlir context safely.
+  llvm::Error buildTargetPassManagers_(Target &target,
+                                       mlir::TimingScope &timing);
+  /// Compiles the input module for a single target.
+  llvm::Error compileMLIRTarget_(Target &target, mlir::ModuleOp targetModuleOp,
+                                 mlir::TimingScope &timing);
+  /// Compiles the input payload for a single target.
+  llvm::Error compilePayloadTarget_(Target &target,
+                                    mlir::ModuleOp targetModuleOp,
+                                    qssc::payload::Payload &payload,
+                                    mlir::TimingScope &timing,
+                                    bool doCompileMLIR);
 
 public:
   using PMBuilder = std::function<llvm::Error(mlir::PassManager &)>;
@@ -73,9 +105,23 @@ public:
                                      qssc::payload::Payload &payload,
                                      bool doCompileMLIR = true) override;
 
+  /// @brief Compile the payload of the subtree of the target system rooted
+  /// at subtreeRoot only, e.g., on a worker of a RemoteCompilationManager.
+  /// @param subtreeRoot A target of the target system of this manager.
+  /// @param subtreeModuleOp The module of subtreeRoot.
+  /// @param payload The payload to populate.
+  /// @param doCompileMLIR Whether to run the target passes prior to emitting
+  /// the payload.
+  llvm::Error compileSubtreePayload(Target &subtreeRoot,
+                                    mlir::ModuleOp subtreeModuleOp,
+                                    qssc::payload::Payload &payload,
+                                    bool doCompileMLIR = true);
+
   bool isMultithreadingEnabled() {
     return getContext()->isMultithreadingEnabled();
   }
+  /// The thread pool of the context, which compilations through the API
+  /// share with the other compilations of the process.
   llvm::ThreadPool &getThreadPool() { return getContext()->getThreadPool(); }
 
 private:
@@ -91,11 +137,9 @@ private:
 
   // ensures we print in order when threading
   std::mutex printIRMutex_;
+  // writes the IR dumps of the target compilations in the background
+  IRDumpWriter irDumpWriter_;
 
-  /// Prepare pass managers in a threaded way
-  /// initializing them with the mlir context safely.
-  llvm::Error buildTargetPassManagers_(Target &target,
-                                       mlir::TimingScope &timing);
   /// Threadsafe initialization of PM to work around
   /// non-threadsafe registration of dependent dialects.
   /// I (Thomas) believe this is related to the conversation here
@@ -107,16 +151,6 @@ private:
   /// Thread safely set the passmanager for a target.
   mlir::PassManager &createTargetPassManager_(Target *target);
 
-  /// Compiles the input module for a single target.
-  llvm::Error compileMLIRTarget_(Target &target, mlir::ModuleOp targetModuleOp,
-                                 mlir::TimingScope &timing);
-  /// Compiles the input payload for a single target.
-  llvm::Error compilePayloadTarget_(Target &target,
-                                    mlir::ModuleOp targetModuleOp,
-                                    qssc::payload::Payload &payload,
-                                    mlir::TimingScope &timing,
-                                    bool doCompileMLIR);
-
   PMBuilder pmBuilder;
 
 }; // class THREADEDCOMPILATIONMANAGER
@@ -1,6 +1,6 @@
 //===- PassRegistration.h - Top-level pass registration ---------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -21,6 +21,7 @@
 #ifndef PASSREGISTRATION_H
 #define PASSREGISTRATION_H
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
 namespace qssc::hal {
@@ -32,6 +33,11 @@ llvm::Error registerTargetPasses();
 /// for the registered Targets with the
 /// QSSC system.
 llvm::Error registerTargetPipelines();
+/// Register the MLIR passes of the named Target only, if it is registered.
+llvm::Error registerTargetPasses(llvm::StringRef targetName);
+/// Register the MLIR pass pipelines of the named Target only, if it is
+/// registered.
+llvm::Error registerTargetPipelines(llvm::StringRef targetName);
 } // namespace qssc::hal
 
 #endif // PASSREGISTRATION_H
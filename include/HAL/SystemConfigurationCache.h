@@ -0,0 +1,118 @@
+//===- SystemConfigurationCache.h - Config caches ---------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the caches of parsed system configurations, an
+//  in-process cache keyed on the hash of the configuration file and binary
+//  snapshots of parsed configurations, which are mapped on load rather than
+//  parsed again.
+//
+//  A snapshot is a header followed by a payload defined by its target:
+//
+//    char     magic[8]       "QSSCSNAP"
+//    uint32_t version        version of the container
+//    uint32_t kindSize       size of the kind following the header
+//    uint32_t formatVersion  version of the payload of this kind
+//    uint32_t reserved
+//    uint64_t configHash     xxh3 hash of the configuration file
+//    uint64_t payloadSize
+//    char     kind[kindSize]
+//    char     payload[payloadSize]
+//
+//  All integers are little endian.
+//
+//===----------------------------------------------------------------------===//
+#ifndef QSSC_SYSTEMCONFIGURATIONCACHE_H
+#define QSSC_SYSTEMCONFIGURATIONCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace qssc::hal {
+
+/// The contents of a configuration file and their hash, which keys the
+/// caches of the configurations parsed from it.
+struct ConfigurationFile {
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  uint64_t hash;
+};
+
+llvm::Expected<ConfigurationFile>
+readConfigurationFile(llvm::StringRef configurationPath);
+
+/// A snapshot mapped into memory, its payload refers to the mapping.
+struct ConfigurationSnapshot {
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  llvm::StringRef payload;
+};
+
+/// The path of the snapshot of the configuration of kind with hash in
+/// directory.
+std::string getConfigurationSnapshotPath(llvm::StringRef directory,
+                                         llvm::StringRef kind, uint64_t hash);
+
+/// Write a snapshot atomically, such that concurrent readers never observe a
+/// partial snapshot.
+llvm::Error writeConfigurationSnapshot(llvm::StringRef path,
+                                       llvm::StringRef kind,
+                                       uint32_t formatVersion,
+                                       uint64_t configHash,
+                                       llvm::StringRef payload);
+
+/// Map a snapshot. Returns std::nullopt if there is no snapshot at path or it
+/// does not match kind, formatVersion and configHash, and an error if it is
+/// malformed.
+llvm::Expected<std::optional<ConfigurationSnapshot>>
+readConfigurationSnapshot(llvm::StringRef path, llvm::StringRef kind,
+                          uint32_t formatVersion, uint64_t configHash);
+
+/// A thread-safe cache of the configurations parsed in this process, which
+/// are immutable once inserted.
+template <typename ConfigT>
+class ConfigurationCache {
+public:
+  std::shared_ptr<const ConfigT> lookup(uint64_t configHash) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto pos = configs.find(configHash);
+    if (pos == configs.end())
+      return nullptr;
+    return pos->second;
+  }
+
+  void insert(uint64_t configHash, std::shared_ptr<const ConfigT> config) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    configs.try_emplace(configHash, std::move(config));
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> const lock(mutex);
+    configs.clear();
+  }
+
+private:
+  std::mutex mutex;
+  llvm::DenseMap<uint64_t, std::shared_ptr<const ConfigT>> configs;
+};
+
+} // namespace qssc::hal
+#endif // QSSC_SYSTEMCONFIGURATIONCACHE_H
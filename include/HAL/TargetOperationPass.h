@@ -1,6 +1,6 @@
 //===- TargetOperationPass.h - Common target pass class  --------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,24 +23,88 @@
 
 #include "HAL/TargetSystemRegistry.h"
 #include "QSSC.h"
+#include "Utils/CompileControl.h"
 
 #include "Dialect/QUIR/IR/QUIROps.h"
 
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <utility>
 
 namespace qssc::hal {
 
+/// Non-templated base of the target passes through which the target of a
+/// compilation may be injected, such that it is not looked up in the
+/// TargetSystemRegistry.
+class TargetPass {
+public:
+  virtual ~TargetPass() = default;
+
+  /// Use target, or the ancestor of target of the type expected by the pass,
+  /// rather than the registered target of the pass's context.
+  void setTarget(Target *target) { injectedTarget = target; }
+  Target *getInjectedTarget() const { return injectedTarget; }
+
+private:
+  Target *injectedTarget = nullptr;
+};
+
+/// Pass instrumentation injecting a target into every TargetPass before it
+/// runs, including the passes of nested pass managers and their clones.
+class TargetInjectionInstrumentation : public mlir::PassInstrumentation {
+public:
+  explicit TargetInjectionInstrumentation(Target *target) : target(target) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override {
+    if (auto *targetPass = dynamic_cast<TargetPass *>(pass))
+      if (targetPass->getInjectedTarget() != target)
+        targetPass->setTarget(target);
+  }
+
+private:
+  Target *target;
+};
+
 /// Baseclass inheriting from OperationPass containing common code-generation
-/// helpers for QSSC targets.
+/// helpers for QSSC targets. The target is resolved once when the pass is
+/// initialized rather than on every run.
 template <typename TargetT, typename OpT = void>
-class TargetOperationPass : public mlir::OperationPass<OpT> {
+class TargetOperationPass : public mlir::OperationPass<OpT>, public TargetPass {
 
 protected:
   explicit TargetOperationPass(mlir::TypeID passID)
       : mlir::OperationPass<OpT>(passID) {}
 
+  mlir::LogicalResult initialize(mlir::MLIRContext *context) override {
+    // Errors are reported when the pass runs, it may never run at all
+    if (!getInjectedTarget() && resolvedContext != context) {
+      resolvedContext = context;
+      resolvedTarget = nullptr;
+      auto target = lookupTarget_(context);
+      if (target)
+        resolvedTarget = *target;
+      else
+        llvm::consumeError(target.takeError());
+    }
+    return mlir::success();
+  }
+
   void runOnOperation() override final {
+    // the target passes of a cancelled compilation fail right away, which
+    // stops the pass manager running them
+    if (qssc::utils::isCompileCancelled(
+            &mlir::OperationPass<OpT>::getContext())) {
+      mlir::OperationPass<OpT>::signalPassFailure();
+      return;
+    }
     if (auto *target = getTargetSystemOrFail())
       runOnOperation(*target);
   }
@@ -52,46 +116,80 @@ protected:
    * @return A non-owning pointer to the target system.
    */
   TargetT *getTargetSystemOrFail() {
-    auto targetInfo =
-        registry::TargetSystemRegistry::lookupPluginInfo(TargetT::name);
-    if (!targetInfo) {
-      llvm::errs() << "Error: target '" << TargetT::name
-                   << "' is not registered.\n";
+    if (auto *injected = getInjectedTarget()) {
+      for (auto *target = injected; target; target = target->getParent())
+        if (auto *castedTarget = dynamic_cast<TargetT *>(target))
+          return castedTarget;
+      llvm::errs() << "Error: the injected target " << injected->getName()
+                   << " is not a target '" << TargetT::name << "'.\n";
+      mlir::OperationPass<OpT>::signalPassFailure();
+      return nullptr;
+    }
+
+    auto *context = &mlir::OperationPass<OpT>::getContext();
+    if (resolvedContext == context && resolvedTarget)
+      return resolvedTarget;
+
+    auto target = lookupTarget_(context);
+    if (auto err = target.takeError()) {
+      llvm::errs() << llvm::toString(std::move(err));
       mlir::OperationPass<OpT>::signalPassFailure();
       return nullptr;
     }
+    resolvedContext = context;
+    resolvedTarget = *target;
+    return resolvedTarget;
+  }
 
-    auto target =
-        targetInfo.value()->getTarget(&mlir::OperationPass<OpT>::getContext());
+private:
+  llvm::Expected<TargetT *> lookupTarget_(mlir::MLIRContext *context) {
+    auto targetInfo =
+        registry::TargetSystemRegistry::lookupPluginInfo(TargetT::name);
+    if (!targetInfo)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Error: target '" +
+                                         std::string(TargetT::name) +
+                                         "' is not registered.\n");
+
+    auto target = targetInfo.value()->getTarget(context);
     if (!target) {
       // look for a child target that matches
       for (const auto &childName : TargetT::childNames) {
-        targetInfo =
+        auto childInfo =
             registry::TargetSystemRegistry::lookupPluginInfo(childName);
-        target = targetInfo.value()->getTarget(
-            &mlir::OperationPass<OpT>::getContext());
-        if (targetInfo && target)
-          break;
-      }
-      if (!target) {
-        llvm::errs() << "Error: failed to get target '" << TargetT::name
-                     << "':\n";
-        llvm::errs() << target.takeError();
-        mlir::OperationPass<OpT>::signalPassFailure();
-        return nullptr;
+        if (!childInfo)
+          continue;
+        auto childTarget = childInfo.value()->getTarget(context);
+        if (!childTarget) {
+          llvm::consumeError(childTarget.takeError());
+          continue;
+        }
+        llvm::consumeError(target.takeError());
+        target = std::move(childTarget);
+        break;
       }
+      if (!target)
+        return llvm::createStringError(
+            llvm::inconvertibleErrorCode(),
+            "Error: failed to get target '" + std::string(TargetT::name) +
+                "':\n" + llvm::toString(target.takeError()) + "\n");
     }
 
     auto *castedTarget = dynamic_cast<TargetT *>(target.get());
-    if (!castedTarget) {
-      llvm::errs() << "Error: target registered as '" << TargetT::name
-                   << "' does not have the expected type.\n";
-      mlir::OperationPass<OpT>::signalPassFailure();
-      return nullptr;
-    }
+    if (!castedTarget)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Error: target registered as '" +
+                                         std::string(TargetT::name) +
+                                         "' does not have the expected "
+                                         "type.\n");
 
     return castedTarget;
   }
+
+  // The target resolved for resolvedContext, copied into the clones of the
+  // pass made for multithreaded pass execution
+  mlir::MLIRContext *resolvedContext = nullptr;
+  TargetT *resolvedTarget = nullptr;
 };
 
 } // namespace qssc::hal
@@ -1,6 +1,6 @@
 //===- TargetSystem.h - Top-level target info -------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,6 +23,7 @@
 #include "API/api.h"
 #include "API/errors.h"
 #include "Arguments/Arguments.h"
+#include "Utils/ConcurrentList.h"
 
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/iterator_range.h"
@@ -143,24 +144,19 @@ public:
   void disableTiming();
 
   // Diagnostic creation and access
-  /// @brief Add a diagnostic to this target
-  void addDiagnostic(const qssc::Diagnostic &diag) {
-    const std::lock_guard<std::mutex> lock(diagnosticsMutex_);
-    diagnostics_.emplace_back(diag);
-  }
+  /// @brief Add a diagnostic to this target. Diagnostics may be added from
+  ///        several threads at once without locking.
+  void addDiagnostic(const qssc::Diagnostic &diag) { diagnostics_.push(diag); }
   /// @brief Construct a diagnostic and add to this target
   void addDiagnostic(Severity severity, ErrorCategory category,
                      const std::string &message) {
-    const std::lock_guard<std::mutex> lock(diagnosticsMutex_);
-    diagnostics_.emplace_back(severity, category, message);
+    diagnostics_.emplace(severity, category, message);
   }
   /// @brief Return the diagnostics from this target and its sub-targets.
   ///        Take and clear the diagnostic lists of the targets.
   qssc::DiagList takeDiagnostics() {
-    const std::lock_guard<std::mutex> lock(diagnosticsMutex_);
-    qssc::DiagList retDiagList;
-    // Take the elements of the given list and move them to the calling list
-    retDiagList.splice(retDiagList.end(), diagnostics_);
+    // Take the elements pushed so far in the order they were added
+    qssc::DiagList retDiagList = diagnostics_.take();
 
     for (auto &child : getChildren_())
       retDiagList.splice(retDiagList.end(), child->takeDiagnostics());
@@ -168,6 +164,12 @@ public:
     return retDiagList;
   }
 
+  /// @brief Reset the state of a run of the compiler, such as the timers and
+  ///        diagnostics, of this target and its sub-targets, such that the
+  ///        target may be reused for another compilation. Targets which keep
+  ///        further per-run state must override this to reset it.
+  virtual void resetRunState();
+
 protected:
   /// @brief Get a nested timer instance from the root timer
   /// @param name The name of the timing span
@@ -187,10 +189,7 @@ private:
   mlir::TimingScope rootTimer;
 
   /// @brief List of diagnostics generated for this target
-  qssc::DiagList diagnostics_;
-
-  /// @brief Mutex for adding diagnostics to the diagnostic list
-  std::mutex diagnosticsMutex_;
+  qssc::utils::ConcurrentList<qssc::Diagnostic> diagnostics_;
 };
 
 class TargetSystem : public Target {
@@ -1,6 +1,6 @@
 //===- TargetSystemInfo.h - System Target Registry --------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -51,12 +51,27 @@ public:
   llvm::Expected<qssc::hal::TargetSystem *>
   getTarget(mlir::MLIRContext *context) const;
 
+  /// Register a target system under the given context, reusing an idle
+  /// target of the pool built from the same configuration file contents if
+  /// there is one. The target is returned to the pool by releaseTarget.
+  /// Configurations which are not regular files are never pooled, a new
+  /// target is created for them as by createTarget.
+  llvm::Expected<qssc::hal::TargetSystem *>
+  acquireTarget(mlir::MLIRContext *context,
+                std::optional<PluginInfo::PluginConfiguration> configuration);
+
+  /// Unregister the target acquired for the given context and return it to
+  /// the pool after resetting its per-run state. Does nothing if no target
+  /// was acquired for the context.
+  void releaseTarget(mlir::MLIRContext *context);
+
   /// Register this target's MLIR passes with the QSSC system.
-  /// Should only be called once on initialization.
+  /// Only the first call registers them, later calls do nothing such that
+  /// the target may be registered on demand.
   llvm::Error registerTargetPasses() const;
 
   /// Register this target's MLIR passe pipelines with the QSSC system.
-  /// Should only be called once on initialization.
+  /// Only the first call registers them, see registerTargetPasses.
   llvm::Error registerTargetPassPipelines() const;
 
 private:
@@ -0,0 +1,96 @@
+//===- FlatArchive.h - Flat payload container -------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the layout of flat payload containers and the
+///  functions for writing and indexing them.
+///
+///  A flat container holds its members uncompressed at page aligned offsets,
+///  such that a loader may map the container and use each member in place.
+///  All integers are little endian:
+///
+///    header   magic "QSSFLAT\0", version (u32), alignment (u32), number of
+///             members (u64), size of the index and names (u64)
+///    index    one entry per member, sorted by name: offset of the data
+///             (u64), size (u64), offset of the name relative to the names
+///             (u32), size of the name (u32), CRC-32 of the data (u32) and
+///             unix file mode (u32)
+///    names    the names of the members, not terminated
+///    data     the data of the members in the order of the index, each
+///             starting at a multiple of the alignment
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_FLATARCHIVE_H
+#define PAYLOAD_FLATARCHIVE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qssc::payload {
+
+constexpr char flatArchiveMagic[8] = {'Q', 'S', 'S', 'F', 'L', 'A', 'T', '\0'};
+constexpr uint32_t flatArchiveVersion = 1;
+// the page size of the hosts the payloads are loaded on
+constexpr uint32_t flatArchiveAlignment = 4096;
+constexpr size_t flatArchiveHeaderSize = 32;
+constexpr size_t flatArchiveEntrySize = 32;
+// offset of the CRC-32 within an index entry
+constexpr size_t flatArchiveEntryCRCOffset = 24;
+
+// a member to write to a flat container
+struct FlatArchiveInput {
+  llvm::StringRef name;
+  llvm::StringRef contents;
+  uint32_t mode = 0100644;
+};
+
+// a member of a flat container
+struct FlatArchiveMember {
+  // name of the member within the container
+  llvm::StringRef name;
+  uint64_t dataOffset;
+  uint64_t size;
+  // offset of the member's CRC-32 in its index entry
+  uint64_t crcOffset;
+  uint32_t crc;
+  uint32_t mode;
+};
+
+// write a flat container of members, which must be sorted by name, to stream.
+// The CRC-32s of the members are computed in parallel.
+llvm::Error writeFlatArchive(llvm::raw_ostream &stream,
+                             llvm::ArrayRef<FlatArchiveInput> members,
+                             uint32_t alignment = flatArchiveAlignment);
+
+// read the index of the flat container held by archive, fails if archive is
+// not a flat container or a member exceeds it
+llvm::Expected<std::vector<FlatArchiveMember>>
+readFlatArchiveIndex(llvm::StringRef archive);
+
+// locate the member name in index sorted by name, nullptr if there is none
+const FlatArchiveMember *
+findFlatArchiveMember(llvm::ArrayRef<FlatArchiveMember> index,
+                      llvm::StringRef name);
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_FLATARCHIVE_H
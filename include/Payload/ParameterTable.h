@@ -0,0 +1,92 @@
+//===- ParameterTable.h - Parameter table of sweep payloads -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the layout of the parameter table of sweep payloads
+///  and the functions for writing and patching it.
+///
+///  The table holds the value of every parameter for every point of a sweep,
+///  which the program reads the values of the current point from. Its
+///  columns are the parameters in the order of their slots and all integers
+///  are little endian:
+///
+///    header   magic "QSSCPTB\0", version (u32), number of points (u32),
+///             number of parameters (u32), size of the names (u32)
+///    names    the names of the parameters, each null terminated
+///    values   the values as doubles, one row of all parameters per point,
+///             starting at a multiple of 8 bytes
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_PARAMETERTABLE_H
+#define PAYLOAD_PARAMETERTABLE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace qssc::payload {
+
+constexpr char parameterTableMagic[8] = {'Q', 'S', 'S', 'C',
+                                         'P', 'T', 'B', '\0'};
+constexpr uint32_t parameterTableVersion = 1;
+constexpr size_t parameterTableHeaderSize = 24;
+// the payload member holding the parameter table of a sweep
+constexpr const char *parameterTableFileName =
+    "parameters/parameter_table.bin";
+
+// the table of numPoints points, each holding initialValues for the
+// parameters names
+std::string createParameterTable(llvm::ArrayRef<llvm::StringRef> names,
+                                 llvm::ArrayRef<double> initialValues,
+                                 uint32_t numPoints);
+
+// A view of a parameter table through which its values are read and patched
+// in place, e.g., in the member read from a payload. The table must outlive
+// the view and must not be resized.
+class ParameterTableView {
+public:
+  // fails if table is not a parameter table or its values exceed it
+  static llvm::Expected<ParameterTableView>
+  create(llvm::MutableArrayRef<char> table);
+
+  uint32_t getNumPoints() const { return numPoints; }
+  uint32_t getNumParameters() const { return names.size(); }
+  llvm::StringRef getParameterName(uint32_t parameter) const {
+    return names[parameter];
+  }
+  // the column of the parameter name, if it is in the table
+  std::optional<uint32_t> lookup(llvm::StringRef name) const;
+
+  double getValue(uint32_t point, uint32_t parameter) const;
+  void setValue(uint32_t point, uint32_t parameter, double value);
+
+private:
+  ParameterTableView() = default;
+
+  uint32_t numPoints = 0;
+  std::vector<llvm::StringRef> names;
+  char *values = nullptr;
+};
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_PARAMETERTABLE_H
@@ -0,0 +1,129 @@
+//===- PatchableFlatPayload.h -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file defines the interface for patching flat payloads
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_PATCHABLE_FLAT_PAYLOAD_H
+#define PAYLOAD_PATCHABLE_FLAT_PAYLOAD_H
+
+#include "Payload/FlatArchive.h"
+#include "Payload/Payload.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace qssc::payload {
+
+// Patches the members of a flat container, see FlatArchive.h. As the members
+// are uncompressed and located by a fixed index, patching a member only
+// changes its data and its CRC-32, the container is rewritten only if a member
+// read with readMember changed its size.
+class PatchableFlatPayload : public PatchablePayload {
+public:
+  // path names the payload file or, if enableInMemory, holds the payload
+  PatchableFlatPayload(std::string path, bool enableInMemory)
+      : path(std::move(path)), enableInMemory(enableInMemory) {}
+  PatchableFlatPayload(llvm::StringRef path, bool enableInMemory)
+      : path(path), enableInMemory(enableInMemory) {}
+
+  // deny copying and moving, the index refers to the mapped payload
+  PatchableFlatPayload(const PatchableFlatPayload &) = delete;
+  PatchableFlatPayload &operator=(const PatchableFlatPayload &) = delete;
+  PatchableFlatPayload(PatchableFlatPayload &&) = delete;
+  PatchableFlatPayload &operator=(PatchableFlatPayload &&) = delete;
+
+  ~PatchableFlatPayload() = default;
+
+  llvm::Error writeBack() override;
+  llvm::Error writeString(std::string *outputString) override;
+  llvm::Error writeCopy(std::string *outputString) override;
+  llvm::Error prepareCopies() override;
+  llvm::Error writeReplacedCopy(
+      std::string *outputString,
+      llvm::ArrayRef<MemberReplacement> replacements) const override;
+
+  // Members are patched in the mapped payload file or in a copy of the in
+  // memory payload. Members must not be patched both in place and through
+  // readMember.
+  llvm::Expected<llvm::MutableArrayRef<char>>
+  mapMember(llvm::StringRef path) override;
+  llvm::Error updateMappedMember(llvm::StringRef path, uint64_t offset,
+                                 llvm::ArrayRef<char> previous) override;
+
+  // Write the patched payload to outputPath on writeBack. The input file is
+  // mapped copy-on-write such that it remains unchanged.
+  llvm::Error setOutputPath(llvm::StringRef outputPath) override;
+
+  using ContentBuffer = std::vector<char>;
+
+  llvm::Expected<ContentBuffer &>
+  readMember(llvm::StringRef path, bool markForWriteBack = true) override;
+
+private:
+  struct TrackedFile {
+    bool writeBack;
+    ContentBuffer buf;
+  };
+
+  std::string const path;
+  bool enableInMemory;
+
+  std::unordered_map<std::string, TrackedFile> files;
+
+  // the payload, mapped from the payload file or copied from the in memory
+  // payload, and its index
+  std::optional<llvm::sys::fs::mapped_file_region> mappedFile;
+  std::optional<std::string> inMemoryData;
+  llvm::MutableArrayRef<char> archive;
+  std::vector<FlatArchiveMember> index;
+  // whether changes to archive are written to the payload file
+  bool sharedMapping = false;
+  bool patchedInPlace = false;
+  // the members written by writeReplacedCopy, see prepareCopies, and the
+  // buffers they were read into, if any
+  std::vector<FlatArchiveInput> copyMembers;
+  std::vector<const ContentBuffer *> copyBuffers;
+
+  // separate output of writeBack, if any
+  std::string outputPath;
+
+  llvm::Error ensureMapped();
+  llvm::Expected<FlatArchiveMember *> findMember_(llvm::StringRef path);
+  // write the buffers marked for write back into the archive, returns
+  // whether the archive must be rewritten as a buffer changed its size
+  bool commitBuffers_();
+  llvm::Error writeCopy_(llvm::raw_ostream &ostream);
+  void collectMembers_(std::vector<FlatArchiveInput> &members,
+                       std::vector<const ContentBuffer *> *buffers) const;
+  llvm::Error replaceInput_();
+  void reset_();
+};
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_PATCHABLE_FLAT_PAYLOAD_H
@@ -1,6 +1,6 @@
 //===- PatchableZipPayload.h ------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,11 +24,18 @@
 #include "Arguments/Arguments.h"
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <zip.h>
 
 namespace qssc::payload {
@@ -50,8 +57,29 @@ public:
 
   llvm::Error writeBack() override;
   llvm::Error writeString(std::string *outputString) override;
+  llvm::Error writeCopy(std::string *outputString) override;
+  llvm::Error prepareCopies() override;
+  llvm::Error writeReplacedCopy(
+      std::string *outputString,
+      llvm::ArrayRef<MemberReplacement> replacements) const override;
   void discardChanges();
 
+  // Members that are stored uncompressed can be patched in place, in the
+  // mapped payload file or in a copy of the in memory payload. Only their
+  // CRC-32 is updated, the archive is neither recompressed nor rewritten.
+  // Members must not be patched both in place and through readMember.
+  llvm::Expected<llvm::MutableArrayRef<char>>
+  mapMember(llvm::StringRef path) override;
+  llvm::Error updateMappedMember(llvm::StringRef path, uint64_t offset,
+                                 llvm::ArrayRef<char> previous) override;
+
+  // Write the patched payload to outputPath on writeBack. An input file is
+  // mapped copy-on-write for patching members in place, such that every byte
+  // of the output is written once. Where the filesystem supports reflinks
+  // the output shares the data of the input and only patched bytes are
+  // written.
+  llvm::Error setOutputPath(llvm::StringRef outputPath) override;
+
   using ContentBuffer = std::vector<char>;
 
   llvm::Expected<ContentBuffer &>
@@ -79,7 +107,44 @@ private:
 
   std::unordered_map<std::string, TrackedFile> files;
 
+  // state of patching members in place
+  struct MappedMember {
+    uint64_t dataOffset;
+    uint64_t size;
+    uint64_t localCRCOffset;
+    uint64_t centralCRCOffset;
+    uint32_t crc;
+  };
+  // read-only mapping of the payload file backing the libzip archive
+  std::optional<llvm::sys::fs::mapped_file_region> inputFile;
+  std::optional<llvm::sys::fs::mapped_file_region> mappedFile;
+  std::string inPlaceData;
+  llvm::MutableArrayRef<char> inPlaceArchive;
+  std::unordered_map<std::string, MappedMember> mappedMembers;
+  // offset and size of every range of the archive changed in place
+  std::vector<std::pair<uint64_t, uint64_t>> patchedRanges;
+  bool patchedInPlace = false;
+
+  // separate output of writeBack, if any
+  std::string outputPath;
+
+  // the members written by writeReplacedCopy, see prepareCopies, with their
+  // buffer in files and its CRC-32
+  struct CopyMember {
+    std::string name;
+    const ContentBuffer *buf;
+    uint32_t mode;
+    uint32_t crc;
+  };
+  std::vector<CopyMember> copyMembers;
+  bool copiesPrepared = false;
+
   llvm::Error ensureOpen();
+  llvm::Error ensureMapped();
+  zip_source_t *mapInput_(zip_error_t &zipError);
+  llvm::Error replaceInput_();
+  llvm::Error writeCopy_(llvm::raw_ostream &ostream);
+  llvm::Error writeOutput_();
   llvm::Error addFileToZip(zip_t *zip, const std::string &path,
                            ContentBuffer &buf, zip_error_t &err);
 };
@@ -23,13 +23,24 @@
 
 #include <Config/QSSConfig.h>
 
-#include <filesystem>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -41,6 +52,7 @@ struct PayloadConfig {
   std::string prefix;
   std::string name;
   qssc::config::QSSVerbosity verbosity;
+  qssc::config::PayloadProfile profile = qssc::config::PayloadProfile::Debug;
 };
 
 // Payload class will wrap the QSS Payload and interface with the qss-compiler
@@ -48,20 +60,42 @@ class Payload {
 public:
   using PluginConfiguration = PayloadConfig;
 
+  // A stable handle to a file of the payload, which remains valid until the
+  // file is replaced by a buffer or taken. Worker threads may write through
+  // handles concurrently, the writes to each file are serialized.
+  class FileHandle {
+  public:
+    void append(llvm::StringRef data);
+    void assign(std::string &&contents);
+    void reserve(std::size_t size);
+    // run func with exclusive access to the contents of the file, e.g., to
+    // stream into it with a raw_string_ostream
+    void withContents(llvm::function_ref<void(std::string &)> func);
+
+  private:
+    friend class Payload;
+    FileHandle(std::string *contents, std::mutex *mutex)
+        : contents(contents), mutex(mutex) {}
+
+    std::string *contents;
+    std::mutex *mutex;
+  };
+
 public:
   Payload()
       : prefix(""), name("exp"), verbosity(qssc::config::QSSVerbosity::Warn) {}
   explicit Payload(PayloadConfig config)
       : prefix(std::move(config.prefix) + "/"), name(std::move(config.name)),
-        verbosity(config.verbosity) {
-    files.clear();
-  }
+        verbosity(config.verbosity), profile(config.profile) {}
   virtual ~Payload() = default;
 
   // get/add the file fName and return a pointer to its data
   std::string *getFile(const std::string &fName);
   // get/add the file fName and return a pointer to its data
   std::string *getFile(const char *fName);
+  // get/add the file fName, reserve sizeHint bytes for its contents and
+  // return a handle for writing it
+  FileHandle reserveFile(llvm::StringRef fName, std::size_t sizeHint);
   // write all files to the stream
   virtual void write(llvm::raw_ostream &stream) = 0;
   // write all files to the stream
@@ -70,29 +104,149 @@ public:
   virtual void writePlain(std::ostream &stream) = 0;
   virtual void writePlain(llvm::raw_ostream &stream) = 0;
   virtual void addFile(llvm::StringRef filename, llvm::StringRef str) = 0;
+  // add the file filename taking ownership of contents instead of copying it
+  void addFile(llvm::StringRef filename, std::string &&contents) {
+    storeFile(filename, std::move(contents));
+  }
+  void addFile(llvm::StringRef filename,
+               std::unique_ptr<llvm::MemoryBuffer> buffer) {
+    storeFile(filename, std::move(buffer));
+  }
+  // get/add the file fName taking ownership of contents instead of copying
+  // it, fName is relative to the prefix like for getFile
+  void adoptFile(llvm::StringRef fName, std::string &&contents);
+  // get/add the file fName taking ownership of buffer instead of copying it,
+  // e.g., to add an object file emitted into a SmallVectorMemoryBuffer or a
+  // memory mapped file, fName is relative to the prefix like for getFile
+  void adoptFile(llvm::StringRef fName,
+                 std::unique_ptr<llvm::MemoryBuffer> buffer);
+  // take all files ordered by name, leaving the payload empty, e.g., to merge
+  // them into another payload with adoptFile
+  auto takeFiles() -> std::vector<std::pair<std::string, std::string>>;
   virtual void writeArgumentSignature(qssc::arguments::Signature &&sig){};
 
+  // The content hashes of files by name, as listed in the manifests of
+  // payloads
+  using FileHashes = std::map<std::string, std::string>;
+  // the hex encoded SHA-256 of the contents of every file, computed in
+  // parallel
+  auto computeFileHashes() -> FileHashes;
+  // Write a delta payload against a previous payload with the file hashes
+  // base, e.g., parsed from its manifest with parseManifestHashes. Files with
+  // unchanged contents are left out of the payload and listed as unchanged in
+  // its manifest, such that only the changed files need to be uploaded.
+  void setDeltaBase(FileHashes base) { deltaBase = std::move(base); }
+  // the file hashes listed in the manifest of a payload
+  static auto parseManifestHashes(llvm::StringRef manifest)
+      -> llvm::Expected<FileHashes>;
+  static constexpr const char *manifestFileName = "manifest/manifest.json";
+
+  // The estimated execution time of the program on the hardware, listed in
+  // the manifest, e.g. for the queueing of jobs
+  struct RuntimeEstimate {
+    uint64_t numShots = 1;
+    double shotSeconds = 0.;
+    double jobSeconds = 0.;
+  };
+  void setRuntimeEstimate(std::optional<RuntimeEstimate> estimate) {
+    runtimeEstimate = estimate;
+  }
+
   const std::string &getName() const { return name; }
   const std::string &getPrefix() const { return prefix; }
 
+  void setProfile(qssc::config::PayloadProfile newProfile) {
+    profile = newProfile;
+  }
+  qssc::config::PayloadProfile getProfile() const { return profile; }
+  // whether targets should write textual debug artifacts, such as the IR of
+  // each target, which are not required to run the program
+  bool shouldWriteDebugArtifacts() const {
+    return profile == qssc::config::PayloadProfile::Debug;
+  }
+
 protected:
-  // Class mutex
+  // Class mutex guarding the state of subclasses, the files are guarded by
+  // the mutexes of their shards
   std::mutex _mtx;
 
-  // return an ordered list of filenames
-  auto orderedFileNames() -> std::vector<std::filesystem::path>;
-
-  // A hash function object to work with unordered_* containers:
-  struct PathHash {
-    std::size_t operator()(std::filesystem::path const &p) const noexcept {
-      return std::filesystem::hash_value(p);
-    }
+  // A file of the payload, the name and contents remain valid until the file
+  // is replaced, removed or taken
+  struct FileRef {
+    llvm::StringRef name;
+    llvm::StringRef contents;
   };
+  // return all files ordered by name
+  auto orderedFiles() -> std::vector<FileRef>;
+  // return the contents of the file fName which must exist
+  auto getFileContents(llvm::StringRef fName) -> llvm::StringRef;
+  // add the manifest listing the compiler version, the contents path, the
+  // size and hash of each file and the runtime estimate, if any. Drops the
+  // unchanged files of delta payloads.
+  void addManifest();
+  // add the file named key, which includes the prefix if any, taking
+  // ownership of contents or buffer
+  void storeFile(llvm::StringRef key, std::string &&contents);
+  void storeFile(llvm::StringRef key,
+                 std::unique_ptr<llvm::MemoryBuffer> buffer);
 
   std::string prefix;
   std::string name;
   qssc::config::QSSVerbosity verbosity;
-  std::unordered_map<std::filesystem::path, std::string, PathHash> files;
+  qssc::config::PayloadProfile profile = qssc::config::PayloadProfile::Debug;
+
+private:
+  // The files are sharded by the hash of their names such that targets
+  // emitting to the payload in parallel rarely contend on the same mutex.
+  // Each name is interned once as the key of its entry, which is stable
+  // until the entry is erased.
+  struct FileEntry {
+    std::string contents;
+    // the contents if the file was adopted as a buffer
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    // serializes the writes through the handles of the file
+    std::mutex mutex;
+    // removed files are kept as tombstones until the next ordering, such
+    // that the ordered entries never dangle
+    bool removed = false;
+
+    llvm::StringRef getContents() const {
+      return buffer ? buffer->getBuffer() : llvm::StringRef(contents);
+    }
+  };
+  using FileMapEntry = llvm::StringMapEntry<FileEntry>;
+  struct FileShard {
+    std::mutex mutex;
+    llvm::StringMap<FileEntry> files;
+    // entries added since the last ordering, in insertion order
+    std::vector<FileMapEntry *> added;
+  };
+  static constexpr std::size_t numFileShards = 16;
+
+  FileShard &getShard(llvm::StringRef fName) {
+    return fileShards[llvm::hash_value(fName) % numFileShards];
+  }
+  // get/add the file key of shard, which must be locked
+  FileEntry &insertEntry(FileShard &shard, llvm::StringRef key);
+  // get/add the file key of shard for modifying its contents in place
+  FileEntry &getEntry(FileShard &shard, llvm::StringRef key);
+  void removeFile(llvm::StringRef fName);
+  auto lockShards()
+      -> std::array<std::unique_lock<std::mutex>, numFileShards>;
+  // merge the added entries into orderedEntries and erase the removed ones,
+  // requires orderMutex and the mutexes of all shards
+  void updateOrderedEntries();
+
+  std::array<FileShard, numFileShards> fileShards;
+  // The entries ordered by name as of the last ordering. The entries added
+  // since are sorted and merged in by the next ordering, such that repeated
+  // orderings only sort the new files. Guarded by orderMutex, which is
+  // acquired before the mutexes of the shards.
+  std::vector<FileMapEntry *> orderedEntries;
+  std::size_t numRemovedEntries = 0;
+  std::mutex orderMutex;
+  std::optional<FileHashes> deltaBase;
+  std::optional<RuntimeEstimate> runtimeEstimate;
 }; // class Payload
 
 // PatchablePayload for payloads that support patching after compilation
@@ -104,6 +258,41 @@ public:
   readMember(llvm::StringRef path, bool markForWriteBack = true) = 0;
   virtual llvm::Error writeBack() = 0;
   virtual llvm::Error writeString(std::string *outputString) = 0;
+  // write the payload with the current contents of all members read so far
+  // to outputString. Unlike writeBack and writeString, the payload remains
+  // open such that it may be patched and written again.
+  virtual llvm::Error writeCopy(std::string *outputString);
+  // prepare writing copies with writeReplacedCopy, which refer to the
+  // contents of the members as of this call. Members must not change size
+  // afterwards.
+  virtual llvm::Error prepareCopies();
+  // the contents replacing a member, identified by the buffer readMember
+  // returned for it, in a copy
+  struct MemberReplacement {
+    const ContentBuffer *member;
+    llvm::StringRef contents;
+  };
+  // write the payload like writeCopy, with the members in replacements
+  // replaced. The payload is left unchanged, hence once prepareCopies
+  // succeeded this may be called from several threads at once, e.g., to
+  // write one payload per set of arguments.
+  virtual llvm::Error
+  writeReplacedCopy(std::string *outputString,
+                    llvm::ArrayRef<MemberReplacement> replacements) const;
+  // map the member path for patching it in place rather than reading it into
+  // a buffer and writing it back. Every change made through the returned
+  // bytes must be reported with updateMappedMember. Fails if the payload does
+  // not support patching the member in place.
+  virtual llvm::Expected<llvm::MutableArrayRef<char>>
+  mapMember(llvm::StringRef path);
+  // report that the bytes at offset of the mapped member path were changed
+  // from previous
+  virtual llvm::Error updateMappedMember(llvm::StringRef path, uint64_t offset,
+                                         llvm::ArrayRef<char> previous);
+  // make writeBack write the patched payload to outputPath, leaving its input
+  // unchanged, rather than updating the input. Must be called before any
+  // member is read or mapped. Fails if the payload does not support it.
+  virtual llvm::Error setOutputPath(llvm::StringRef outputPath);
 }; // class PatchablePayload
 
 } // namespace qssc::payload
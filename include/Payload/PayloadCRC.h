@@ -0,0 +1,45 @@
+//===- PayloadCRC.h - CRC-32 of payload members -----------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the CRC-32 utilities shared by the payload containers
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_PAYLOADCRC_H
+#define PAYLOAD_PAYLOADCRC_H
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <cstdint>
+
+namespace qssc::payload {
+
+// CRC-32 of the concatenation of two messages with the CRC-32s crcA and crcB,
+// where the second message is sizeB bytes long
+uint32_t combineCRC32(uint32_t crcA, uint32_t crcB, uint64_t sizeB);
+
+// CRC-32 of data, computed in chunks in parallel for large data
+uint32_t parallelCRC32(llvm::ArrayRef<uint8_t> data);
+
+// update the CRC-32 crc of a message of size bytes after the bytes at offset
+// changed from oldBytes to newBytes, in time logarithmic in size
+uint32_t updateCRC32(uint32_t crc, uint64_t size, uint64_t offset,
+                     llvm::ArrayRef<uint8_t> oldBytes,
+                     llvm::ArrayRef<uint8_t> newBytes);
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_PAYLOADCRC_H
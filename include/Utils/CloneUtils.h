@@ -0,0 +1,95 @@
+//===- CloneUtils.h - Bulk cloning of operations ----------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  Utility functions cloning many operations at once.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef UTILS_CLONEUTILS_H
+#define UTILS_CLONEUTILS_H
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/ValueRange.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <cassert>
+
+namespace qssc::utils {
+
+/// Clone the operations in [begin, end) before pos in dest, mapping their
+/// operands with mapper. The clones are inserted into the operation list of
+/// dest directly rather than through an OpBuilder, such that no listener is
+/// notified per operation. Do not use this from rewrite patterns, whose
+/// rewriter has to observe every new operation.
+///
+/// @param begin the first operation to clone
+/// @param end the operation following the last one to clone
+/// @param dest the block to insert the clones into
+/// @param pos the operation of dest to insert the clones before
+/// @param mapper the mapping of operands, which is extended with the results
+/// of the clones
+inline void cloneOpsInto(mlir::Block::iterator begin, mlir::Block::iterator end,
+                         mlir::Block *dest, mlir::Block::iterator pos,
+                         mlir::IRMapping &mapper) {
+  auto &destOps = dest->getOperations();
+  for (auto it = begin; it != end; ++it)
+    destOps.insert(pos, it->clone(mapper));
+}
+
+/// Clone the body of source, but for its terminator, before pos in dest once
+/// for each entry of operandLists, with the arguments of source mapped to the
+/// entry. A single IRMapping is used for all copies: each copy remaps every
+/// value of source, hence the mapping is neither cleared nor regrown.
+///
+/// @param source the block to clone, e.g., the body of a sequence
+/// @param operandLists the values replacing the arguments of source, one
+/// entry per copy
+/// @param dest the block to insert the copies into
+/// @param pos the operation of dest to insert the copies before
+/// @param results if given, the values returned by the terminator of source
+/// are appended for each copy
+inline void
+cloneBlockRepeatedly(mlir::Block &source,
+                     llvm::ArrayRef<mlir::ValueRange> operandLists,
+                     mlir::Block *dest, mlir::Block::iterator pos,
+                     llvm::SmallVectorImpl<mlir::Value> *results = nullptr) {
+  mlir::Operation *terminator =
+      source.mightHaveTerminator() ? source.getTerminator() : nullptr;
+  auto end = terminator ? terminator->getIterator() : source.end();
+  if (results && terminator)
+    results->reserve(results->size() +
+                     operandLists.size() * terminator->getNumOperands());
+
+  mlir::IRMapping mapper;
+  for (mlir::ValueRange const operands : operandLists) {
+    assert(operands.size() == source.getNumArguments() &&
+           "expect an operand for each argument of the block");
+    mapper.map(source.getArguments(), operands);
+    cloneOpsInto(source.begin(), end, dest, pos, mapper);
+    if (results && terminator)
+      for (mlir::Value const value : terminator->getOperands())
+        results->push_back(mapper.lookupOrDefault(value));
+  }
+}
+
+} // namespace qssc::utils
+
+#endif // UTILS_CLONEUTILS_H
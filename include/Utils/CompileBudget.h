@@ -0,0 +1,82 @@
+//===- CompileBudget.h - Compile time and memory budget ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the compile time and memory budget of a compilation
+///  and the registry of the budget of each MLIRContext. Once the budget is
+///  exceeded, optional work such as optimizations is skipped or downgraded,
+///  such that the compilation finishes on time with a slightly worse output.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef UTILS_COMPILE_BUDGET_H
+#define UTILS_COMPILE_BUDGET_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace mlir {
+class MLIRContext;
+class Operation;
+} // namespace mlir
+
+namespace qssc::utils {
+
+/// @brief A deadline, measured from the construction of the budget, and a
+/// limit of the peak resident set size of the process. Either may be unset.
+/// The budget may be checked from several threads.
+class CompileBudget {
+public:
+  CompileBudget(std::optional<std::chrono::milliseconds> deadline,
+                std::optional<uint64_t> memoryBudgetMiB);
+
+  /// @brief Describe how the budget is exceeded, or nullopt while it is not.
+  std::optional<std::string> getExceededReason() const;
+
+  /// @brief Should the optional work be skipped as the budget is exceeded.
+  /// Each skipped work is recorded with a warning at op, once.
+  bool shouldSkip(mlir::Operation *op, llvm::StringRef work);
+
+private:
+  std::chrono::steady_clock::time_point start;
+  std::optional<std::chrono::milliseconds> deadline;
+  std::optional<uint64_t> memoryBudgetMiB;
+
+  std::mutex mutex;
+  llvm::StringSet<> skippedWork;
+};
+
+/// @brief Register the budget of the compilations in context, nullptr
+/// unregisters it. The budget must outlive its registration.
+void setContextCompileBudget(mlir::MLIRContext *context,
+                             CompileBudget *budget);
+
+/// @brief Get the budget registered for context or nullptr if there is none.
+CompileBudget *getContextCompileBudget(mlir::MLIRContext *context);
+
+/// @brief Should the optional work at op be skipped as the budget registered
+/// for its context is exceeded, see CompileBudget::shouldSkip, or as the
+/// compilation is cancelled.
+bool shouldSkipOverBudget(mlir::Operation *op, llvm::StringRef work);
+
+} // namespace qssc::utils
+
+#endif // UTILS_COMPILE_BUDGET_H
@@ -0,0 +1,105 @@
+//===- CompileControl.h - Compile cancellation and progress -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the cooperative cancellation and the progress
+///  reporting of a compilation and the registry of the control of each
+///  MLIRContext. The compilation checks for cancellation between its stages,
+///  before each target and in the target passes, and stops with an error
+///  once it is cancelled, such that its resources are released right away.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef UTILS_COMPILE_CONTROL_H
+#define UTILS_COMPILE_CONTROL_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace mlir {
+class MLIRContext;
+} // namespace mlir
+
+namespace qssc::utils {
+
+/// @brief A flag through which the caller of a compilation requests it to
+/// stop. The token may be cancelled from any thread, and shared by several
+/// compilations which are then cancelled together.
+class CancellationToken {
+public:
+  void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+  bool isCancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<bool> cancelled{false};
+};
+
+/// @brief Receives the name of each stage of a compilation as it starts,
+/// e.g. parse, command-line-passes, a pass or the passes of a target. May be
+/// invoked from several threads, one at a time.
+using ProgressCallback = std::function<void(llvm::StringRef stage)>;
+
+/// @brief The cancellation token and the progress callback of a compilation,
+/// either of which may be unset.
+class CompileControl {
+public:
+  CompileControl(std::shared_ptr<CancellationToken> token,
+                 ProgressCallback onProgress);
+
+  bool isCancelled() const { return token && token->isCancelled(); }
+
+  /// @brief Return an error if the compilation is cancelled, which names the
+  /// stage that was about to start.
+  llvm::Error checkCancelled(llvm::StringRef stage) const;
+
+  /// @brief Report the start of stage to the progress callback.
+  void reportProgress(llvm::StringRef stage);
+
+private:
+  std::shared_ptr<CancellationToken> token;
+  ProgressCallback onProgress;
+  std::mutex progressMutex;
+};
+
+/// @brief Register the control of the compilations in context, nullptr
+/// unregisters it. The control must outlive its registration.
+void setContextCompileControl(mlir::MLIRContext *context,
+                              CompileControl *control);
+
+/// @brief Get the control registered for context or nullptr if there is none.
+CompileControl *getContextCompileControl(mlir::MLIRContext *context);
+
+/// @brief Is the compilation in context cancelled.
+bool isCompileCancelled(mlir::MLIRContext *context);
+
+/// @brief Return an error if the compilation in context is cancelled, see
+/// CompileControl::checkCancelled.
+llvm::Error checkCompileCancelled(mlir::MLIRContext *context,
+                                  llvm::StringRef stage);
+
+/// @brief Report the start of stage of the compilation in context, if it has
+/// a progress callback.
+void reportCompileProgress(mlir::MLIRContext *context, llvm::StringRef stage);
+
+} // namespace qssc::utils
+
+#endif // UTILS_COMPILE_CONTROL_H
@@ -0,0 +1,96 @@
+//===- ConcurrentList.h - Lock-free append list -----------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares a list which many threads append to without locking
+///  and which is taken as a whole, e.g., for collecting the diagnostics of
+///  targets compiled in parallel.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef UTILS_CONCURRENT_LIST_H
+#define UTILS_CONCURRENT_LIST_H
+
+#include <atomic>
+#include <list>
+#include <utility>
+
+namespace qssc::utils {
+
+/// @brief A multiple producer list. push may be called concurrently from any
+/// number of threads without locking, and take removes all elements pushed so
+/// far at once, in the order in which they were pushed.
+template <typename T>
+class ConcurrentList {
+public:
+  ConcurrentList() = default;
+  ConcurrentList(const ConcurrentList &) = delete;
+  ConcurrentList &operator=(const ConcurrentList &) = delete;
+  ~ConcurrentList() { deleteNodes(head.exchange(nullptr)); }
+
+  void push(T value) {
+    auto *node =
+        new Node{std::move(value), head.load(std::memory_order_relaxed)};
+    while (!head.compare_exchange_weak(node->next, node,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed))
+      ;
+  }
+
+  template <typename... Args>
+  void emplace(Args &&...args) {
+    push(T(std::forward<Args>(args)...));
+  }
+
+  /// Remove and return all elements, oldest first.
+  std::list<T> take() {
+    std::list<T> ret;
+    Node *node = head.exchange(nullptr, std::memory_order_acquire);
+    // The nodes are linked from the newest to the oldest
+    while (node) {
+      ret.push_front(std::move(node->value));
+      Node *next = node->next;
+      delete node;
+      node = next;
+    }
+    return ret;
+  }
+
+  void clear() { deleteNodes(head.exchange(nullptr)); }
+
+  bool empty() const {
+    return head.load(std::memory_order_acquire) == nullptr;
+  }
+
+private:
+  struct Node {
+    T value;
+    Node *next;
+  };
+
+  static void deleteNodes(Node *node) {
+    while (node) {
+      Node *next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+  std::atomic<Node *> head = nullptr;
+}; // class ConcurrentList
+
+} // namespace qssc::utils
+
+#endif // UTILS_CONCURRENT_LIST_H
@@ -0,0 +1,61 @@
+//===- CounterSink.h - Sink for compilation counters ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares a sink for the counters passes record during a
+///  compilation, e.g. the size of the IR at a point of the pipeline, and the
+///  registry of the sink of each MLIRContext. Passes do not depend on where
+///  the counters end up, e.g. in the timing trace of the compilation.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef UTILS_COUNTER_SINK_H
+#define UTILS_COUNTER_SINK_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace mlir {
+class MLIRContext;
+} // namespace mlir
+
+namespace qssc::utils {
+
+/// @brief A receiver of named sets of counter values. Counters may be
+/// recorded from several threads.
+class CounterSink {
+public:
+  virtual ~CounterSink() = default;
+
+  /// @brief Record the values of the counters of the set name at this point
+  /// of the compilation.
+  virtual void recordCounters(
+      llvm::StringRef name,
+      llvm::ArrayRef<std::pair<llvm::StringRef, int64_t>> counters) = 0;
+};
+
+/// @brief Register the sink for the counters recorded in context, nullptr
+/// unregisters it. The sink must outlive its registration.
+void setContextCounterSink(mlir::MLIRContext *context, CounterSink *sink);
+
+/// @brief Get the sink registered for context or nullptr if there is none.
+CounterSink *getContextCounterSink(mlir::MLIRContext *context);
+
+} // namespace qssc::utils
+
+#endif // UTILS_COUNTER_SINK_H
@@ -0,0 +1,43 @@
+//===- HashField.h - Length prefixed hashing of fields ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the hashing of the fields of the cache keys, e.g. of
+///  the compile cache, the frontend cache and the object cache of targets.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef UTILS_HASH_FIELD_H
+#define UTILS_HASH_FIELD_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/SHA256.h"
+
+#include <cstdint>
+
+namespace qssc::utils {
+
+/// Hash a length prefixed field so that adjacent fields can not alias.
+inline void hashField(llvm::SHA256 &hasher, llvm::StringRef field) {
+  const uint64_t size = field.size();
+  hasher.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(&size), sizeof(size)));
+  hasher.update(field);
+}
+
+} // namespace qssc::utils
+
+#endif // UTILS_HASH_FIELD_H
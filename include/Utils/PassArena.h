@@ -0,0 +1,123 @@
+//===- PassArena.h - Bump allocation of transient pass data -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares an arena for the short-lived data structures a pass
+///  builds while it runs, e.g., work lists and builders, which are released
+///  all at once instead of one node at a time.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef UTILS_PASS_ARENA_H
+#define UTILS_PASS_ARENA_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
+
+#include <cstddef>
+#include <deque>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qssc::utils {
+
+/// @brief A bump allocator for the transient data structures of a pass.
+/// Memory is only released when the arena is reset or destroyed; containers
+/// using the arena never return memory to it, hence an arena suits data
+/// which lives for one run of a pass or one pattern application. Objects
+/// made with create are destroyed on reset, in reverse order of creation.
+/// The arena is not thread safe. Work running in parallel uses one arena per
+/// task. A copy of an arena is empty, such that passes holding an arena may
+/// still be cloned.
+class PassArena {
+public:
+  /// @brief An STL allocator drawing from an arena, e.g., for the nodes of a
+  /// std::deque or std::unordered_map.
+  template <typename T>
+  class Allocator {
+  public:
+    using value_type = T;
+
+    explicit Allocator(PassArena &arena) : arena(&arena) {}
+    template <typename U>
+    Allocator(const Allocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+      return static_cast<T *>(
+          arena->allocator.Allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *, size_t) {}
+
+    template <typename U>
+    bool operator==(const Allocator<U> &other) const {
+      return arena == other.arena;
+    }
+    template <typename U>
+    bool operator!=(const Allocator<U> &other) const {
+      return arena != other.arena;
+    }
+
+  private:
+    template <typename U>
+    friend class Allocator;
+
+    PassArena *arena;
+  };
+
+  PassArena() = default;
+  PassArena(const PassArena &) {}
+  PassArena &operator=(const PassArena &) = delete;
+  ~PassArena() { reset(); }
+
+  template <typename T>
+  Allocator<T> getAllocator() {
+    return Allocator<T>(*this);
+  }
+
+  /// Construct an object in the arena, which owns it until reset
+  template <typename T, typename... Args>
+  T *create(Args &&...args) {
+    T *object = new (allocator.Allocate<T>()) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>)
+      destructors.emplace_back(
+          object, [](void *pointer) { static_cast<T *>(pointer)->~T(); });
+    return object;
+  }
+
+  /// Destroy the objects made with create and release all memory
+  void reset() {
+    for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+      it->second(it->first);
+    destructors.clear();
+    allocator.Reset();
+  }
+
+  size_t getBytesAllocated() const { return allocator.getBytesAllocated(); }
+
+private:
+  llvm::BumpPtrAllocator allocator;
+  llvm::SmallVector<std::pair<void *, void (*)(void *)>, 0> destructors;
+};
+
+template <typename T>
+using ArenaDeque = std::deque<T, PassArena::Allocator<T>>;
+template <typename T>
+using ArenaVector = std::vector<T, PassArena::Allocator<T>>;
+
+} // namespace qssc::utils
+
+#endif // UTILS_PASS_ARENA_H
@@ -9,8 +9,10 @@
 //===----------------------------------------------------------------------===//
 ///
 /// This file implements an analysis for caching symbols that match a
-/// call -> callee pattern. This currently includes circuit / call_circuit
-/// and sequence / call_sequence.
+/// call -> callee pattern. This currently includes circuit / call_circuit,
+/// sequence / call_sequence and func / call_subroutine. It also serves as the
+/// shared index of the module for finding these symbols and the main function
+/// by name.
 ///
 ///
 //===----------------------------------------------------------------------===//
@@ -20,17 +22,20 @@
 
 #include "HAL/SystemConfiguration.h"
 
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Pass/AnalysisManager.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Support/TypeID.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
 
-#include <string>
-#include <typeinfo>
-#include <unordered_map>
-#include <unordered_set>
-
 namespace qssc::utils {
 
 // This analysis maintains a mapping of symbol name to operation in
@@ -54,9 +59,24 @@ namespace qssc::utils {
 // If a pass manipulates the symbols that are cached with this
 // analysis then it should use the addCallee method to update the
 // map or call invalidate after appying updates.
+// The analysis keeps the cached callers of every callee, replacing or
+// erasing a callee only drops the cached calls to that callee. Passes
+// erasing call operations should use eraseCall so that a new call
+// allocated at the same address does not pick up a stale callee.
 // Note this analysis should always be used by reference or
 // via a pointer to ensure that updates are applied to the maps
-// stored by the MLIR analysis framework.
+// stored by the MLIR analysis framework. Each instance only holds the
+// symbols of the operation it was created for, such that passes running on
+// several modules in parallel do not share any state.
+//
+// The analysis is also a rewriter listener: passes rewriting the cached
+// symbols with a rewriter may set it as the listener of the rewriter (or of
+// the GreedyRewriteConfig) to have inserted callees added and erased callees
+// and calls dropped without further bookkeeping:
+//
+// GreedyRewriteConfig config;
+// config.listener = &symbolCache;
+// applyPatternsAndFoldGreedily(op, std::move(patterns), config);
 //
 // Passes may force the maps to be re-loaded by calling invalidate
 // before calling addToCache:
@@ -65,19 +85,12 @@ namespace qssc::utils {
 //                .invalidate()
 //                .addToCache<CircuitOp>();
 
-class SymbolCacheAnalysis {
+class SymbolCacheAnalysis : public mlir::RewriterBase::Listener {
 public:
-  SymbolCacheAnalysis(mlir::Operation *op) {
-    if (topOp && topOp != op)
-      invalidate();
-    topOp = op;
-  }
+  SymbolCacheAnalysis(mlir::Operation *op) : topOp(op) {}
   SymbolCacheAnalysis(mlir::Operation *op,
-                      qssc::hal::SystemConfiguration *config) {
-    if (topOp && topOp != op)
-      invalidate();
-    topOp = op;
-  }
+                      qssc::hal::SystemConfiguration *config)
+      : topOp(op) {}
 
   template <class CalleeOp>
   SymbolCacheAnalysis &addToCache() {
@@ -86,9 +99,7 @@ public:
 
   template <class CalleeOp>
   SymbolCacheAnalysis &addToCache(mlir::Operation *op) {
-    std::string typeName = typeid(CalleeOp).name();
-
-    if (!invalid && (cachedTypes.find(typeName) != cachedTypes.end())) {
+    if (!invalid && cachedTypes.contains(mlir::TypeID::get<CalleeOp>())) {
       // already cached skipping
       return *this;
     }
@@ -96,7 +107,7 @@ public:
     op->walk([&](CalleeOp op) {
       symbolOpsMap[op.getSymName()] = op.getOperation();
     });
-    cachedTypes.insert(typeName);
+    cachedTypes.insert(mlir::TypeID::get<CalleeOp>());
     invalid = false;
     return *this;
   }
@@ -108,14 +119,13 @@ public:
 
   template <class CallOp>
   SymbolCacheAnalysis &cacheCallMap(mlir::Operation *op) {
-    std::string typeName = typeid(CallOp).name();
-    if ((cachedTypes.find(typeName) != cachedTypes.end()))
+    if (!cachedCallTypes.insert(mlir::TypeID::get<CallOp>()).second)
       return *this;
 
     op->walk([&](CallOp callOp) {
       auto search = symbolOpsMap.find(callOp.getCallee());
       if (search != symbolOpsMap.end())
-        callMap[callOp.getOperation()] = search->second;
+        cacheCall_(callOp.getOperation(), search->second);
     });
     return *this;
   }
@@ -129,12 +139,36 @@ public:
     return calleeOp;
   }
 
+  // the cached callee named callee, or null if there is none of type
+  // CalleeOp
+  template <class CalleeOp>
+  CalleeOp lookup(llvm::StringRef callee) {
+    auto search = symbolOpsMap.find(callee);
+    if (search == symbolOpsMap.end())
+      return nullptr;
+    return llvm::dyn_cast<CalleeOp>(search->second);
+  }
+
+  // the func.func named main below topOp, found by a walk on first use only,
+  // or null if there is none
+  mlir::func::FuncOp getMainFunction() {
+    if (mainFunc)
+      return mainFunc;
+    topOp->walk([&](mlir::func::FuncOp funcOp) {
+      if (funcOp.getSymName() != "main")
+        return mlir::WalkResult::advance();
+      mainFunc = funcOp;
+      return mlir::WalkResult::interrupt();
+    });
+    return mainFunc;
+  }
+
   template <class CalleeOp, class CallOp>
   CalleeOp getOpByCall(CallOp callOp) {
     auto search = callMap.find(callOp.getOperation());
     if (search == callMap.end()) {
       auto calleeOp = getOpByName<CalleeOp>(callOp.getCallee());
-      callMap[callOp.getOperation()] = calleeOp.getOperation();
+      cacheCall_(callOp.getOperation(), calleeOp.getOperation());
       return calleeOp;
     }
     auto calleeOp = llvm::dyn_cast<CalleeOp>(search->second);
@@ -153,30 +187,37 @@ public:
   }
 
   void addCallee(llvm::StringRef name, mlir::Operation *op) {
-    // if this is an update to existing symbol clear callMap cache
-    if (symbolOpsMap.contains(name))
-      callMap.clear();
+    // if this is an update to existing symbol drop the calls cached for
+    // the previous callee
+    auto search = symbolOpsMap.find(name);
+    if (search != symbolOpsMap.end() && search->second != op)
+      eraseCallers_(search->second);
     symbolOpsMap[name] = op;
   }
 
   template <class CallOp, class CalleeOp>
   void cacheCall(CallOp callOp, CalleeOp calleeOp) {
-    callMap[callOp.getOperation()] = calleeOp.getOperation();
+    cacheCall_(callOp.getOperation(), calleeOp.getOperation());
   }
 
+  // drop the cached callee of a call which is about to be erased
+  void eraseCall(mlir::Operation *callOp) { callMap.erase(callOp); }
+
   bool contains(llvm::StringRef name) { return symbolOpsMap.contains(name); }
 
   template <class CalleeOp>
   void erase(CalleeOp calleeOp) {
     symbolOpsMap.erase(calleeOp.getSymName());
-    // TODO: determine if it is worth just clearing the callers of calleeOp
-    callMap.clear();
+    eraseCallers_(calleeOp.getOperation());
   }
 
   SymbolCacheAnalysis &invalidate() {
     symbolOpsMap.clear();
     callMap.clear();
+    callersMap.clear();
     cachedTypes.clear();
+    cachedCallTypes.clear();
+    mainFunc = nullptr;
     invalid = true;
     return *this;
   }
@@ -185,6 +226,33 @@ public:
     return invalid;
   }
 
+  // add the cached callees created by a rewriter. A callee taking the name
+  // of a cached one, e.g. a clone which is renamed next, is not added; a
+  // renamed callee must be added with addCallee.
+  void notifyOperationInserted(mlir::Operation *op) override {
+    op->walk([&](mlir::Operation *nestedOp) {
+      if (isCachedCallee_(nestedOp))
+        symbolOpsMap.try_emplace(
+            mlir::SymbolTable::getSymbolName(nestedOp).getValue(), nestedOp);
+    });
+  }
+
+  // drop the cached callees and calls erased by a rewriter
+  void notifyOperationRemoved(mlir::Operation *op) override {
+    op->walk([&](mlir::Operation *nestedOp) {
+      callMap.erase(nestedOp);
+      if (nestedOp == mainFunc.getOperation())
+        mainFunc = nullptr;
+      if (!isCachedCallee_(nestedOp))
+        return;
+      auto search = symbolOpsMap.find(
+          mlir::SymbolTable::getSymbolName(nestedOp).getValue());
+      if (search != symbolOpsMap.end() && search->second == nestedOp)
+        symbolOpsMap.erase(search);
+      eraseCallers_(nestedOp);
+    });
+  }
+
   // for debugging purposes
   void listSymbols() {
     for (auto &[key, value] : symbolOpsMap)
@@ -192,9 +260,43 @@ public:
   }
 
 private:
+  bool isCachedCallee_(mlir::Operation *op) const {
+    return cachedTypes.contains(op->getName().getTypeID()) &&
+           op->hasAttr(mlir::SymbolTable::getSymbolAttrName());
+  }
+
+  void cacheCall_(mlir::Operation *callOp, mlir::Operation *calleeOp) {
+    auto [search, inserted] = callMap.try_emplace(callOp, calleeOp);
+    if (!inserted) {
+      if (search->second == calleeOp)
+        return;
+      search->second = calleeOp;
+    }
+    callersMap[calleeOp].push_back(callOp);
+  }
+
+  void eraseCallers_(mlir::Operation *calleeOp) {
+    auto callers = callersMap.find(calleeOp);
+    if (callers == callersMap.end())
+      return;
+    // calls may have been re-cached with another callee since
+    for (auto *callOp : callers->second) {
+      auto search = callMap.find(callOp);
+      if (search != callMap.end() && search->second == calleeOp)
+        callMap.erase(search);
+    }
+    callersMap.erase(callers);
+  }
+
   llvm::StringMap<mlir::Operation *> symbolOpsMap;
-  std::unordered_map<mlir::Operation *, mlir::Operation *> callMap;
-  std::unordered_set<std::string> cachedTypes;
+  llvm::DenseMap<mlir::Operation *, mlir::Operation *> callMap;
+  // the calls cached in callMap for every callee
+  llvm::DenseMap<mlir::Operation *, llvm::SmallVector<mlir::Operation *, 4>>
+      callersMap;
+  // the callee and call operations cached from topOp
+  llvm::DenseSet<mlir::TypeID> cachedTypes;
+  llvm::DenseSet<mlir::TypeID> cachedCallTypes;
+  mlir::func::FuncOp mainFunc;
   mlir::Operation *topOp{nullptr};
   bool invalid{true};
 };
@@ -0,0 +1,53 @@
+//===- Compile.h - Compile modules from C -----------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the c interface for compiling modules built in memory
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef C_COMPILE_H
+#define C_COMPILE_H
+
+#include "mlir-c/IR.h"
+#include "mlir-c/Support.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Receives a diagnostic of a compilation, whose severity and category are
+/// the values of qssc::Severity and qssc::ErrorCategory.
+typedef void (*QsscDiagnosticCallback)(int32_t severity, int32_t category,
+                                       MlirStringRef message, void *userData);
+
+/// Compile the module in place, without printing and parsing it, as
+/// configured by the qss-compiler command line options args, e.g.,
+/// "--target=mock" and "--emit=qem". The module's context receives the
+/// compiler's dialects. The output is passed to outputCallback in pieces and
+/// the diagnostics, including the reason of a failure, to diagnosticCallback
+/// if not null.
+MLIR_CAPI_EXPORTED MlirLogicalResult qsscCompileModule(
+    MlirModule module, intptr_t numArgs, MlirStringRef const *args,
+    MlirStringCallback outputCallback, void *outputUserData,
+    QsscDiagnosticCallback diagnosticCallback, void *diagnosticUserData);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C_COMPILE_H
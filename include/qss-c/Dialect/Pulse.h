@@ -24,6 +24,8 @@
 #include "mlir-c/IR.h"
 #include "mlir-c/Support.h"
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -78,6 +80,32 @@ MLIR_CAPI_EXPORTED bool pulseTypeIsAWaveformType(MlirType type);
 
 MLIR_CAPI_EXPORTED MlirType pulseWaveformTypeGet(MlirContext ctx);
 
+//===---------------------------------------------------------------------===//
+// Bulk op builders
+//===---------------------------------------------------------------------===//
+
+/// Insert numOps pulse.play ops, the i-th of which plays
+/// waveforms[waveformIndices[i]] on frames[frameIndices[i]]. If timepoints is
+/// not null, the pulse.timepoint of the i-th op is set to timepoints[i]. The
+/// ops are inserted at the end of block or, if it is not null, before
+/// insertBefore. Fails without inserting any op if an index is out of range.
+MLIR_CAPI_EXPORTED MlirLogicalResult pulseInsertPlayOps(
+    MlirBlock block, MlirOperation insertBefore, MlirLocation location,
+    intptr_t numFrames, MlirValue const *frames, intptr_t numWaveforms,
+    MlirValue const *waveforms, intptr_t numOps, int64_t const *frameIndices,
+    int64_t const *waveformIndices, int64_t const *timepoints);
+
+/// Insert numOps pulse.delay ops, the i-th of which delays
+/// frames[frameIndices[i]] by durations[i]. The durations are materialized
+/// as i32 constants, one per distinct duration, ahead of the first delay.
+/// Timepoints and insertion are as for pulseInsertPlayOps. Fails without
+/// inserting any op if an index is out of range.
+MLIR_CAPI_EXPORTED MlirLogicalResult pulseInsertDelayOps(
+    MlirBlock block, MlirOperation insertBefore, MlirLocation location,
+    intptr_t numFrames, MlirValue const *frames, intptr_t numOps,
+    int64_t const *frameIndices, int64_t const *durations,
+    int64_t const *timepoints);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,386 @@
+//===- CompileCache.cpp - Content-addressed output cache --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the compilation cache backends and the computation
+///  of compilation cache keys.
+///
+//===----------------------------------------------------------------------===//
+
+#include "API/CompileCache.h"
+
+#include "API/CompileSingleFlight.h"
+#include "API/errors.h"
+#include "Config/QSSConfig.h"
+#include "QSSC.h"
+#include "Utils/HashField.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+using namespace qssc::cache;
+using qssc::utils::hashField;
+
+std::optional<std::string>
+InMemoryCompileCache::lookup(llvm::StringRef key) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto it = index.find(key.str());
+  if (it == index.end())
+    return std::nullopt;
+  // Mark the entry as most recently used.
+  entries.splice(entries.begin(), entries, it->second);
+  return it->second->second;
+}
+
+llvm::Error InMemoryCompileCache::store(llvm::StringRef key,
+                                        llvm::StringRef output) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (capacity == 0)
+    return llvm::Error::success();
+
+  auto it = index.find(key.str());
+  if (it != index.end()) {
+    it->second->second = output.str();
+    entries.splice(entries.begin(), entries, it->second);
+    return llvm::Error::success();
+  }
+
+  entries.emplace_front(key.str(), output.str());
+  index.emplace(key.str(), entries.begin());
+  evict_();
+  return llvm::Error::success();
+}
+
+void InMemoryCompileCache::setCapacity(size_t newCapacity) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  capacity = newCapacity;
+  evict_();
+}
+
+void InMemoryCompileCache::evict_() {
+  while (entries.size() > capacity) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+  }
+}
+
+std::string DirectoryCompileCache::getEntryPath_(llvm::StringRef key) const {
+  llvm::SmallString<256> path(directory);
+  llvm::sys::path::append(path, key + ".bin");
+  return std::string(path);
+}
+
+std::optional<std::string>
+DirectoryCompileCache::lookup(llvm::StringRef key) {
+  auto buffer = llvm::MemoryBuffer::getFile(getEntryPath_(key),
+                                            /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return std::nullopt;
+  return (*buffer)->getBuffer().str();
+}
+
+llvm::Error DirectoryCompileCache::store(llvm::StringRef key,
+                                         llvm::StringRef output) {
+  if (auto ec = llvm::sys::fs::create_directories(directory))
+    return llvm::createStringError(ec, "Unable to create compile cache "
+                                       "directory " +
+                                           directory + ": " + ec.message());
+
+  // Write to a unique temporary file first so that concurrent readers never
+  // observe a partially written entry.
+  llvm::SmallString<256> tmpModel(directory);
+  llvm::sys::path::append(tmpModel, key + "-%%%%%%%%.tmp");
+  int fd;
+  llvm::SmallString<256> tmpPath;
+  if (auto ec = llvm::sys::fs::createUniqueFile(tmpModel, fd, tmpPath))
+    return llvm::createStringError(ec, "Unable to create compile cache "
+                                       "entry: " +
+                                           ec.message());
+
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << output;
+    os.close();
+    if (os.has_error()) {
+      auto ec = os.error();
+      os.clear_error();
+      llvm::sys::fs::remove(tmpPath);
+      return llvm::createStringError(ec, "Unable to write compile cache "
+                                         "entry: " +
+                                             ec.message());
+    }
+  }
+
+  if (auto ec = llvm::sys::fs::rename(tmpPath, getEntryPath_(key))) {
+    llvm::sys::fs::remove(tmpPath);
+    return llvm::createStringError(ec, "Unable to store compile cache "
+                                       "entry: " +
+                                           ec.message());
+  }
+
+  return llvm::Error::success();
+}
+
+std::optional<std::string> TieredCompileCache::lookup(llvm::StringRef key) {
+  for (auto tier = tiers.begin(); tier != tiers.end(); ++tier) {
+    auto output = (*tier)->lookup(key);
+    if (!output.has_value())
+      continue;
+
+    // Promote the entry into the faster tiers. A failure to do so only
+    // costs a future lookup.
+    for (auto fasterTier = tiers.begin(); fasterTier != tier; ++fasterTier)
+      llvm::consumeError((*fasterTier)->store(key, *output));
+    return output;
+  }
+  return std::nullopt;
+}
+
+llvm::Error TieredCompileCache::store(llvm::StringRef key,
+                                      llvm::StringRef output) {
+  llvm::Error result = llvm::Error::success();
+  for (auto &tier : tiers)
+    result = llvm::joinErrors(std::move(result), tier->store(key, output));
+  return result;
+}
+
+namespace {
+
+llvm::Error hashFile(llvm::SHA256 &hasher, llvm::StringRef path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (auto ec = buffer.getError())
+    return llvm::createStringError(ec, "Unable to read " + path +
+                                           " for the compile cache key: " +
+                                           ec.message());
+  hashField(hasher, (*buffer)->getBuffer());
+  return llvm::Error::success();
+}
+
+/// Hash the target configuration. Targets may either take a single file or a
+/// directory holding their configuration and calibration data.
+llvm::Error hashTargetConfig(llvm::SHA256 &hasher,
+                             const qssc::config::QSSConfig &config) {
+  auto configPath = config.getTargetConfigPath();
+  if (!configPath.has_value())
+    return llvm::Error::success();
+
+  if (*configPath == "-")
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Target configurations from the config service can not be cached.");
+
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(*configPath, status))
+    // The target will report the missing configuration.
+    return llvm::Error::success();
+
+  if (!llvm::sys::fs::is_directory(status))
+    return hashFile(hasher, *configPath);
+
+  std::vector<std::string> files;
+  std::error_code ec;
+  for (llvm::sys::fs::recursive_directory_iterator it(*configPath, ec), end;
+       it != end && !ec; it.increment(ec))
+    if (it->type() == llvm::sys::fs::file_type::regular_file)
+      files.push_back(it->path());
+  if (ec)
+    return llvm::createStringError(ec, "Unable to list " + *configPath +
+                                           " for the compile cache key: " +
+                                           ec.message());
+
+  // Directory iteration order is unspecified.
+  std::sort(files.begin(), files.end());
+  for (const auto &file : files) {
+    hashField(hasher, llvm::StringRef(file).drop_front(configPath->size()));
+    if (auto err = hashFile(hasher, file))
+      return err;
+  }
+  return llvm::Error::success();
+}
+
+} // anonymous namespace
+
+llvm::Expected<std::string>
+qssc::cache::computeCompileCacheKey(const qssc::config::QSSConfig &config,
+                                    llvm::StringRef passPipeline,
+                                    llvm::StringRef source,
+                                    llvm::StringRef sourceDependencies) {
+  llvm::SHA256 hasher;
+  hashField(hasher, qssc::getQSSCVersion());
+
+  // The cache settings themselves do not affect the output.
+  qssc::config::QSSConfig keyConfig = config;
+  keyConfig.setCompileCacheDir(std::nullopt)
+      .setCompileCacheEntries(0)
+      .setCompileCacheFrontend(false);
+  std::string configStr;
+  llvm::raw_string_ostream configOS(configStr);
+  keyConfig.emit(configOS);
+  hashField(hasher, configOS.str());
+
+  for (const auto &plugin : keyConfig.getPassPlugins())
+    hashField(hasher, plugin);
+  for (const auto &plugin : keyConfig.getDialectPlugins())
+    hashField(hasher, plugin);
+
+  hashField(hasher, passPipeline);
+  hashField(hasher, source);
+  hashField(hasher, sourceDependencies);
+
+  if (auto err = hashTargetConfig(hasher, config))
+    return std::move(err);
+
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+namespace {
+// Identifies compile cache entries of the current layout
+constexpr llvm::StringLiteral entryMagic("QSSCCE01");
+
+void writeSizedField(llvm::raw_ostream &os, llvm::StringRef field) {
+  llvm::support::endian::write<uint64_t>(os, field.size(),
+                                         llvm::support::little);
+  os << field;
+}
+
+bool readInteger(llvm::StringRef &entry, uint64_t &value) {
+  if (entry.size() < sizeof(uint64_t))
+    return false;
+  value = llvm::support::endian::read<uint64_t, llvm::support::little,
+                                      llvm::support::unaligned>(entry.data());
+  entry = entry.drop_front(sizeof(uint64_t));
+  return true;
+}
+
+bool readSizedField(llvm::StringRef &entry, std::string &field) {
+  uint64_t size = 0;
+  if (!readInteger(entry, size) || size > entry.size())
+    return false;
+  field = entry.take_front(size).str();
+  entry = entry.drop_front(size);
+  return true;
+}
+} // anonymous namespace
+
+/// An entry holds the diagnostics, each as its severity, category and
+/// message, then the diagnostic output and finally the compiler output.
+std::string
+qssc::cache::encodeCompileCacheEntry(const CompileOutcome &outcome) {
+  std::string entry;
+  llvm::raw_string_ostream entryOS(entry);
+  entryOS << entryMagic;
+  llvm::support::endian::write<uint64_t>(
+      entryOS, outcome.diagnostics.size(), llvm::support::little);
+  for (const auto &diag : outcome.diagnostics) {
+    llvm::support::endian::write<uint64_t>(
+        entryOS, static_cast<uint64_t>(diag.severity), llvm::support::little);
+    llvm::support::endian::write<uint64_t>(
+        entryOS, static_cast<uint64_t>(diag.category), llvm::support::little);
+    writeSizedField(entryOS, diag.message);
+  }
+  writeSizedField(entryOS, outcome.diagnosticOutput);
+  entryOS << outcome.output;
+  return entryOS.str();
+}
+
+std::optional<CompileOutcome>
+qssc::cache::decodeCompileCacheEntry(llvm::StringRef entry) {
+  if (!entry.consume_front(entryMagic))
+    return std::nullopt;
+
+  CompileOutcome outcome;
+  uint64_t numDiagnostics = 0;
+  if (!readInteger(entry, numDiagnostics))
+    return std::nullopt;
+  for (uint64_t i = 0; i < numDiagnostics; ++i) {
+    uint64_t severity = 0;
+    uint64_t category = 0;
+    std::string message;
+    if (!readInteger(entry, severity) || !readInteger(entry, category) ||
+        !readSizedField(entry, message))
+      return std::nullopt;
+    if (severity > static_cast<uint64_t>(qssc::Severity::Fatal) ||
+        category >
+            static_cast<uint64_t>(qssc::ErrorCategory::UncategorizedError))
+      return std::nullopt;
+    outcome.diagnostics.emplace_back(static_cast<qssc::Severity>(severity),
+                                     static_cast<qssc::ErrorCategory>(category),
+                                     std::move(message));
+  }
+  if (!readSizedField(entry, outcome.diagnosticOutput))
+    return std::nullopt;
+  outcome.output = entry.str();
+  return outcome;
+}
+
+std::string
+qssc::cache::computeFrontendCacheKey(llvm::StringRef frontendOptions,
+                                     llvm::StringRef bufferIdentifier,
+                                     llvm::StringRef source) {
+  llvm::SHA256 hasher;
+  hashField(hasher, qssc::getQSSCVersion());
+  hashField(hasher, "frontend");
+  hashField(hasher, frontendOptions);
+  hashField(hasher, bufferIdentifier);
+  hashField(hasher, source);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::shared_ptr<CompileCache>
+qssc::cache::getCompileCache(const qssc::config::QSSConfig &config) {
+  static std::mutex memoryCacheMutex;
+  static std::shared_ptr<InMemoryCompileCache> memoryCache;
+
+  std::vector<std::shared_ptr<CompileCache>> tiers;
+  if (config.getCompileCacheEntries() > 0) {
+    const std::lock_guard<std::mutex> lock(memoryCacheMutex);
+    if (!memoryCache)
+      memoryCache = std::make_shared<InMemoryCompileCache>(
+          config.getCompileCacheEntries());
+    else
+      memoryCache->setCapacity(config.getCompileCacheEntries());
+    tiers.push_back(memoryCache);
+  }
+
+  if (auto dir = config.getCompileCacheDir())
+    tiers.push_back(std::make_shared<DirectoryCompileCache>(dir->str()));
+
+  if (tiers.empty())
+    return nullptr;
+  if (tiers.size() == 1)
+    return tiers.front();
+  return std::make_shared<TieredCompileCache>(std::move(tiers));
+}
@@ -0,0 +1,122 @@
+//===- CompileSingleFlight.cpp - Single-flight compiles ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the single-flight layer deduplicating concurrent
+///  compilations of the same cache key.
+///
+//===----------------------------------------------------------------------===//
+
+#include "API/CompileSingleFlight.h"
+
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace qssc::cache;
+
+namespace {
+
+/// @brief Holds an exclusive lock on the lock file of a key in a directory
+/// shared by several processes while in scope. Failing to take the lock only
+/// forgoes the deduplication across processes.
+class KeyFileLock {
+public:
+  KeyFileLock(llvm::StringRef directory, llvm::StringRef key) {
+    if (llvm::sys::fs::create_directories(directory))
+      return;
+    llvm::SmallString<256> path(directory);
+    llvm::sys::path::append(path, key + ".lock");
+    if (llvm::sys::fs::openFileForReadWrite(path, fd,
+                                            llvm::sys::fs::CD_OpenAlways,
+                                            llvm::sys::fs::OF_None)) {
+      fd = -1;
+      return;
+    }
+    if (llvm::sys::fs::lockFile(fd)) {
+      llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+      fd = -1;
+    }
+  }
+  KeyFileLock(const KeyFileLock &) = delete;
+  KeyFileLock &operator=(const KeyFileLock &) = delete;
+  ~KeyFileLock() {
+    if (fd < 0)
+      return;
+    // The lock file is kept as removing it races with processes waiting on it
+    (void)llvm::sys::fs::unlockFile(fd);
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+  }
+
+private:
+  int fd = -1;
+};
+
+} // anonymous namespace
+
+CompileOutcome CompileSingleFlight::run(
+    llvm::StringRef key, std::optional<llvm::StringRef> lockDirectory,
+    Recheck recheck, Compile compile) {
+  std::shared_ptr<Flight> flight;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto [it, inserted] =
+        flights.try_emplace(key.str(), std::make_shared<Flight>());
+    flight = it->second;
+    if (!inserted) {
+      flightDone.wait(lock, [&] { return flight->done; });
+      return flight->outcome;
+    }
+  }
+
+  // The requests waiting on this flight are released however it ends.
+  CompileOutcome outcome;
+  auto land = llvm::make_scope_exit([&] {
+    const std::lock_guard<std::mutex> lock(mutex);
+    flight->outcome = outcome;
+    flight->done = true;
+    flights.erase(key.str());
+    flightDone.notify_all();
+  });
+
+  std::optional<KeyFileLock> fileLock;
+  if (lockDirectory.has_value())
+    fileLock.emplace(*lockDirectory, key);
+
+  if (auto available = recheck())
+    outcome = std::move(*available);
+  else
+    outcome = compile();
+  return outcome;
+}
+
+size_t CompileSingleFlight::getNumInFlight() const {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return flights.size();
+}
+
+CompileSingleFlight &qssc::cache::getCompileSingleFlight() {
+  static CompileSingleFlight singleFlight;
+  return singleFlight;
+}
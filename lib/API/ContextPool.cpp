@@ -0,0 +1,116 @@
+//===- ContextPool.cpp - Pool of warmed-up MLIR contexts --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pool of warmed-up MLIR contexts.
+///
+//===----------------------------------------------------------------------===//
+
+#include "API/ContextPool.h"
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h"
+#include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
+
+#include "llvm/Support/Process.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+using namespace qssc;
+
+namespace {
+uint64_t heapUsage() {
+  return static_cast<uint64_t>(llvm::sys::Process::GetMallocUsage());
+}
+} // anonymous namespace
+
+ContextPool::Lease::Lease(ContextPool &pool, PooledContext pooled)
+    : pool(&pool), pooled(std::move(pooled)), startHeap(heapUsage()) {}
+
+ContextPool::Lease::~Lease() {
+  if (!pool)
+    return;
+  // The heap the compilation retained is attributed to the storage of the
+  // context. Allocations of concurrent compilations may be attributed as
+  // well, which recycles contexts early rather than late.
+  uint64_t const endHeap = heapUsage();
+  pool->release(std::move(pooled),
+                endHeap > startHeap ? endHeap - startHeap : 0);
+}
+
+ContextPool::ContextPool(const mlir::DialectRegistry &registry,
+                         Options options)
+    : options(options) {
+  registry.appendTo(this->registry);
+}
+
+ContextPool::PooledContext ContextPool::create() {
+  PooledContext pooled;
+  pooled.context = std::make_unique<mlir::MLIRContext>(registry);
+  pooled.context->loadAllAvailableDialects();
+  mlir::registerBuiltinDialectTranslation(*pooled.context);
+  mlir::registerLLVMDialectTranslation(*pooled.context);
+  pooled.multithreaded = pooled.context->isMultithreadingEnabled();
+  return pooled;
+}
+
+ContextPool::Lease ContextPool::acquire() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (!idle.empty()) {
+      PooledContext pooled = std::move(idle.back());
+      idle.pop_back();
+      ++statistics.reused;
+      return Lease(*this, std::move(pooled));
+    }
+    ++statistics.created;
+  }
+  // contexts are created outside of the lock as loading the dialects is slow
+  return Lease(*this, create());
+}
+
+void ContextPool::release(PooledContext pooled, uint64_t growth) {
+  pooled.storageGrowth += growth;
+  ++pooled.uses;
+
+  // compilations which were not granted the shared thread pool leave their
+  // context single threaded
+  if (pooled.multithreaded && !pooled.context->isMultithreadingEnabled())
+    pooled.context->enableMultithreading();
+
+  bool const exhausted =
+      pooled.storageGrowth > options.maxStorageGrowthBytes ||
+      (options.maxUses != 0 && pooled.uses >= options.maxUses);
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (exhausted)
+      ++statistics.recycled;
+    if (!exhausted && idle.size() < options.maxIdleContexts) {
+      idle.push_back(std::move(pooled));
+      return;
+    }
+  }
+  // the context, and with it the storage of its attributes and types, is
+  // destroyed outside of the lock
+}
+
+ContextPool::Statistics ContextPool::getStatistics() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return statistics;
+}
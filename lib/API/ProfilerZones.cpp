@@ -0,0 +1,98 @@
+//===- ProfilerZones.cpp - Compile phase markers for profilers --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the profiler markers of the compile phases. The
+///  markers of the Intel ITT API are read by VTune and other collectors
+///  loaded through INTEL_LIBITTNOTIFY64, they are only available when the
+///  compiler is built with the ittapi package.
+///
+//===----------------------------------------------------------------------===//
+
+#include "API/ProfilerZones.h"
+
+#include "Config/QSSConfig.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#ifdef QSSC_HAVE_ITT
+#include <ittnotify.h>
+#endif
+
+using namespace qssc;
+
+namespace {
+#ifdef QSSC_HAVE_ITT
+/// Zones as overlapped ITT tasks, which may end on any thread
+class ITTProfilerZones : public ProfilerZones {
+public:
+  ITTProfilerZones() : domain(__itt_domain_create("qss-compiler")) {}
+
+  void beginZone(const void *zone, llvm::StringRef name) override {
+    __itt_string_handle *handle = nullptr;
+    {
+      // the string handles are interned for the lifetime of the process
+      std::lock_guard<std::mutex> const lock(mutex);
+      auto &entry = names[name];
+      if (!entry)
+        entry = __itt_string_handle_create(name.str().c_str());
+      handle = entry;
+    }
+    __itt_id const id = getId(zone);
+    __itt_id_create(domain, id);
+    __itt_task_begin_overlapped(domain, id, __itt_null, handle);
+  }
+
+  void endZone(const void *zone) override {
+    __itt_id const id = getId(zone);
+    __itt_task_end_overlapped(domain, id);
+    __itt_id_destroy(domain, id);
+  }
+
+private:
+  static __itt_id getId(const void *zone) {
+    return __itt_id_make(const_cast<void *>(zone), 0);
+  }
+
+  __itt_domain *domain;
+  std::mutex mutex;
+  llvm::StringMap<__itt_string_handle *> names;
+};
+#endif // QSSC_HAVE_ITT
+} // anonymous namespace
+
+llvm::Expected<std::unique_ptr<ProfilerZones>>
+qssc::createProfilerZones(config::ProfilerMarkers markers) {
+  switch (markers) {
+  case config::ProfilerMarkers::None:
+    return nullptr;
+  case config::ProfilerMarkers::ITT:
+#ifdef QSSC_HAVE_ITT
+    return std::make_unique<ITTProfilerZones>();
+#else
+    break;
+#endif
+  }
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Profiler markers " + to_string(markers) +
+                                     " are not supported by this build of "
+                                     "the compiler");
+}
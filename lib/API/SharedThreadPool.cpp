@@ -0,0 +1,110 @@
+//===- SharedThreadPool.cpp - Shared compile thread pool --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the thread pool shared by all compilations of the
+///  process and the admission of compilations to it by priority.
+///
+//===----------------------------------------------------------------------===//
+
+#include "API/SharedThreadPool.h"
+
+#include "Config/QSSConfig.h"
+
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+
+using namespace qssc;
+
+namespace {
+
+std::mutex &getPoolMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+/// The shared pool, guarded by getPoolMutex. It lives for the whole process
+/// as contexts may refer to it until they are destroyed.
+std::unique_ptr<llvm::ThreadPool> &getPool() {
+  static std::unique_ptr<llvm::ThreadPool> pool;
+  return pool;
+}
+
+/// Number of compilations granted the shared pool, guarded by getPoolMutex
+unsigned numGranted = 0;
+
+llvm::ThreadPool &getPoolLocked(std::optional<unsigned> maxThreads) {
+  auto &pool = getPool();
+  if (!pool) {
+    llvm::ThreadPoolStrategy strategy = llvm::hardware_concurrency();
+    if (maxThreads.has_value())
+      strategy.ThreadsRequested = *maxThreads;
+    pool = std::make_unique<llvm::ThreadPool>(strategy);
+  }
+  return *pool;
+}
+
+} // anonymous namespace
+
+llvm::ThreadPool &
+qssc::getSharedThreadPool(std::optional<unsigned> maxThreads) {
+  const std::lock_guard<std::mutex> lock(getPoolMutex());
+  return getPoolLocked(maxThreads);
+}
+
+ScopedSharedThreadPool::ScopedSharedThreadPool(
+    mlir::MLIRContext &context, std::optional<unsigned> maxThreads,
+    config::CompilePriority priority) {
+  if (!context.isMultithreadingEnabled())
+    return;
+
+  llvm::ThreadPool *pool = nullptr;
+  {
+    const std::lock_guard<std::mutex> lock(getPoolMutex());
+    pool = &getPoolLocked(maxThreads);
+    switch (priority) {
+    case config::CompilePriority::High:
+      granted = true;
+      break;
+    case config::CompilePriority::Normal:
+      granted = numGranted < pool->getThreadCount();
+      break;
+    case config::CompilePriority::Low:
+      granted = numGranted == 0;
+      break;
+    }
+    if (granted)
+      ++numGranted;
+  }
+
+  // Drop the pool the context created for itself, a thread pool may only be
+  // set while multithreading is disabled
+  context.disableMultithreading();
+  if (granted)
+    context.setThreadPool(*pool);
+}
+
+ScopedSharedThreadPool::~ScopedSharedThreadPool() {
+  if (!granted)
+    return;
+  const std::lock_guard<std::mutex> lock(getPoolMutex());
+  --numGranted;
+}
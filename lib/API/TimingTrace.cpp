@@ -0,0 +1,190 @@
+//===- TimingTrace.cpp - Structured compilation timers ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the timing manager writing the compilation timers
+///  as Chrome trace events, and the counters as counter events.
+///
+//===----------------------------------------------------------------------===//
+
+#include "API/TimingTrace.h"
+
+#include "mlir/Support/FileUtilities.h"
+
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+using namespace qssc;
+
+namespace {
+// The scopes the target compilation nests the timers of targets in, see
+// TargetTaskGraph
+bool isTargetScope(llvm::StringRef name) {
+  return name == "compile-system" || name == "children";
+}
+
+double toMicroseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+} // anonymous namespace
+
+TimingTraceManager::TimingTraceManager() : epoch(Clock::now()) {
+  timers.emplace_back().name = "root";
+}
+
+std::optional<void *> TimingTraceManager::rootTimer() {
+  return &timers.front();
+}
+
+void TimingTraceManager::startTimer(void *handle) {
+  auto *timer = static_cast<TimerInfo *>(handle);
+  timer->start = Clock::now();
+  timer->threadId = llvm::get_threadid();
+  if (profilerZones)
+    profilerZones->beginZone(timer, timer->zoneName);
+}
+
+void TimingTraceManager::stopTimer(void *handle) {
+  auto *timer = static_cast<TimerInfo *>(handle);
+  auto const duration = Clock::now() - timer->start;
+  if (profilerZones)
+    profilerZones->endZone(timer);
+  std::lock_guard<std::mutex> const lock(mutex);
+  events.push_back({timer, timer->start, duration, timer->threadId});
+}
+
+void *TimingTraceManager::nestTimer(void *handle, const void * /*id*/,
+                                    function_ref<std::string()> nameBuilder) {
+  auto *parent = static_cast<TimerInfo *>(handle);
+  std::string name = nameBuilder();
+  std::lock_guard<std::mutex> const lock(mutex);
+  TimerInfo &timer = timers.emplace_back();
+  timer.name = std::move(name);
+  timer.parent = parent;
+  // the root is left out of the paths
+  if (parent->parent)
+    timer.path = parent->path + "/";
+  timer.path += timer.name;
+  timer.targets = parent->targets;
+  if (isTargetScope(parent->name)) {
+    if (!timer.targets.empty())
+      timer.targets += "/";
+    timer.targets += timer.name;
+  }
+  if (profilerZones)
+    timer.zoneName = timer.targets.empty()
+                         ? timer.name
+                         : timer.name + " [" + timer.targets + "]";
+  return &timer;
+}
+
+void TimingTraceManager::recordCounters(
+    llvm::StringRef name,
+    llvm::ArrayRef<std::pair<llvm::StringRef, int64_t>> counters) {
+  CounterEvent event{name.str(), Clock::now(), llvm::get_threadid(), {}};
+  for (const auto &[counter, value] : counters)
+    event.counters.emplace_back(counter.str(), value);
+  std::lock_guard<std::mutex> const lock(mutex);
+  counterEvents.push_back(std::move(event));
+}
+
+void TimingTraceManager::hideTimer(void *handle) {
+  static_cast<TimerInfo *>(handle)->hidden = true;
+}
+
+void TimingTraceManager::setTraceContext(std::optional<std::string> id) {
+  std::lock_guard<std::mutex> const lock(mutex);
+  traceContext = std::move(id);
+}
+
+void TimingTraceManager::setProfilerZones(
+    std::unique_ptr<ProfilerZones> zones) {
+  profilerZones = std::move(zones);
+  timers.front().zoneName = "qss-compiler";
+}
+
+TimingTraceManager::Clock::duration
+TimingTraceManager::getTotalTime(llvm::StringRef path) const {
+  std::lock_guard<std::mutex> const lock(mutex);
+  Clock::duration total{};
+  for (const Event &event : events)
+    if (event.timer->parent && event.timer->path == path)
+      total += event.duration;
+  return total;
+}
+
+void TimingTraceManager::print(llvm::raw_ostream &os) const {
+  std::lock_guard<std::mutex> const lock(mutex);
+  auto const processId =
+      static_cast<int64_t>(llvm::sys::Process::getProcessId());
+
+  llvm::json::OStream json(os, 2);
+  json.object([&] {
+    json.attributeArray("traceEvents", [&] {
+      for (const Event &event : events) {
+        if (event.timer->hidden)
+          continue;
+        json.object([&] {
+          json.attribute("name", event.timer->name);
+          json.attribute("cat", event.timer->parent ? "qssc" : "root");
+          json.attribute("ph", "X");
+          json.attribute("ts", toMicroseconds(event.start - epoch));
+          json.attribute("dur", toMicroseconds(event.duration));
+          json.attribute("pid", processId);
+          json.attribute("tid", static_cast<int64_t>(event.threadId));
+          json.attributeObject("args", [&] {
+            json.attribute("path", event.timer->path);
+            json.attribute("targets", event.timer->targets);
+          });
+        });
+      }
+      for (const CounterEvent &event : counterEvents) {
+        json.object([&] {
+          json.attribute("name", event.name);
+          json.attribute("cat", "counters");
+          json.attribute("ph", "C");
+          json.attribute("ts", toMicroseconds(event.time - epoch));
+          json.attribute("pid", processId);
+          json.attribute("tid", static_cast<int64_t>(event.threadId));
+          json.attributeObject("args", [&] {
+            for (const auto &[counter, value] : event.counters)
+              json.attribute(counter, value);
+          });
+        });
+      }
+    });
+    json.attribute("displayTimeUnit", "ms");
+    if (traceContext.has_value())
+      json.attributeObject("otherData", [&] {
+        // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+        json.attribute("traceContext", *traceContext);
+      });
+  });
+  os << "\n";
+}
+
+llvm::Error TimingTraceManager::write(llvm::StringRef filename) const {
+  std::string errorMessage;
+  auto output = mlir::openOutputFile(filename, &errorMessage);
+  if (!output)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to open timing trace file: " +
+                                       errorMessage);
+  print(output->os());
+  output->keep();
+  return llvm::Error::success();
+}
@@ -16,33 +16,55 @@
 
 #include "API/api.h"
 
+#include "API/CompileCache.h"
+#include "API/CompileSingleFlight.h"
+#include "API/ContextPool.h"
+#include "API/ProfilerZones.h"
+#include "API/SharedThreadPool.h"
+#include "API/TimingTrace.h"
 #include "API/errors.h"
 #include "Arguments/Arguments.h"
 #include "Config/CLIConfig.h"
 #include "Config/QSSConfig.h"
+#include "Dialect/Pulse/Utils/RuntimeEstimate.h"
+#include "Dialect/QCS/IR/QCSAttributes.h"
+#include "Dialect/QCS/Utils/ParameterInitialValueAnalysis.h"
 #include "Dialect/RegisterDialects.h"
+#include "Dialect/QUIR/Transforms/IRStatistics.h"
 #include "Dialect/RegisterPasses.h"
 #include "Frontend/OpenQASM3/OpenQASM3Frontend.h"
+#include "HAL/Compile/CompileProgressInstrumentation.h"
+#include "HAL/Compile/PassMemoryInstrumentation.h"
 #include "HAL/Compile/TargetCompilationManager.h"
 #include "HAL/Compile/ThreadedCompilationManager.h"
 #include "HAL/TargetSystem.h"
 #include "HAL/TargetSystemInfo.h"
 #include "HAL/TargetSystemRegistry.h"
+#include "Payload/ParameterTable.h"
 #include "Payload/Payload.h"
 #include "Payload/PayloadRegistry.h"
 #include "Plugin/PluginInfo.h"
 #include "QSSC.h"
+#include "Utils/CompileBudget.h"
+#include "Utils/CompileControl.h"
+#include "Utils/CounterSink.h"
 
+#include "mlir/Bytecode/BytecodeReader.h"
 #include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/IR/AsmState.h"
+#include "mlir/IR/Block.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/Location.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/IR/Verifier.h"
 #include "mlir/InitAllExtensions.h"
 #include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassInstrumentation.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Pass/PassRegistry.h"
 #include "mlir/Support/FileUtilities.h"
@@ -53,11 +75,22 @@
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Tools/ParseUtilities.h"
 
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MemoryBufferRef.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ThreadPool.h"
@@ -65,15 +98,25 @@
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <memory>
 #include <optional>
 #include <stdio.h> // NOLINT: fileno is not in cstdio as suggested
 #include <string>
 #include <string_view>
+#include <sys/resource.h>
+#include <system_error>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <variant>
+#include <vector>
 
 using namespace mlir;
 using namespace qssc::config;
@@ -124,6 +167,17 @@ void showPayloads() {
   }
 }
 
+/// @brief Look up the info of the target of the supplied config.
+/// @param config The configuration naming the target.
+/// @return The info of the target, or of the null target if none is named.
+qssc::hal::registry::TargetSystemInfo &
+getTargetInfo(const qssc::config::QSSConfig &config) {
+  return *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(
+              config.getTargetName().value_or(""))
+              .value_or(qssc::hal::registry::TargetSystemRegistry::
+                            nullTargetSystemInfo());
+}
+
 /// @brief Build the target for this MLIRContext based on the supplied config.
 /// @param context The supplied context to build the target for.
 /// @param config The configuration defining the context to build.
@@ -149,17 +203,15 @@ buildTarget(MLIRContext *context, const qssc::config::QSSConfig &config,
           llvm::inconvertibleErrorCode(),
           "Error: A target configuration path was not specified.");
   }
-  qssc::hal::registry::TargetSystemInfo &targetInfo =
-      *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(
-           targetName.value_or(""))
-           .value_or(qssc::hal::registry::TargetSystemRegistry::
-                         nullTargetSystemInfo());
+  qssc::hal::registry::TargetSystemInfo &targetInfo = getTargetInfo(config);
 
   std::optional<llvm::StringRef> conf{};
   if (targetConfigPath.has_value())
     conf.emplace(*targetConfigPath);
 
-  auto created = targetInfo.createTarget(context, conf);
+  // Reuse a prepared target of the pool, it is returned to the pool once the
+  // compilations in the context are done.
+  auto created = targetInfo.acquireTarget(context, conf);
   if (auto err = created.takeError()) {
     return llvm::joinErrors(
         llvm::createStringError(llvm::inconvertibleErrorCode(),
@@ -170,6 +222,38 @@ buildTarget(MLIRContext *context, const qssc::config::QSSConfig &config,
   return *created.get();
 }
 
+/// @brief Add the parameter table of a sweep to the payload, if moduleOp
+/// runs a sweep loop. The points start at the initial values of the
+/// parameters, in the order of their slots.
+/// @param moduleOp The module to build for
+/// @param payload The payload to populate
+void addSweepParameterTable(mlir::ModuleOp moduleOp,
+                            qssc::payload::Payload &payload) {
+  std::optional<uint32_t> numPoints;
+  moduleOp->walk([&](mlir::Operation *op) {
+    auto attr = op->getAttrOfType<mlir::IntegerAttr>(
+        mlir::qcs::getNumSweepPointsAttrName());
+    if (!attr)
+      return mlir::WalkResult::advance();
+    numPoints = attr.getInt();
+    return mlir::WalkResult::interrupt();
+  });
+  if (!numPoints)
+    return;
+
+  mlir::qcs::ParameterInitialValueAnalysis const parameters(moduleOp);
+  std::vector<llvm::StringRef> names;
+  std::vector<double> initialValues;
+  for (mlir::qcs::ParameterSlot slot = 0; slot < parameters.getNumSlots();
+       ++slot) {
+    names.push_back(parameters.getParameterName(slot));
+    initialValues.push_back(std::get<double>(parameters.getValue(slot)));
+  }
+  payload.addFile(
+      qssc::payload::parameterTableFileName,
+      qssc::payload::createParameterTable(names, initialValues, *numPoints));
+}
+
 /// @brief Generate the final QEM.
 /// @param targetCompilationManager Target compilation to build the QEM with.
 /// @param payload The payload to populate
@@ -190,6 +274,16 @@ llvm::Error generateQEM(
     return err;
   targetCompilationManager->disableTiming();
 
+  // the runtime estimate is recorded for scheduled programs only
+  auto estimate =
+      mlir::pulse::estimateRuntime(moduleOp, config.getDtTimestep());
+  if (estimate)
+    payload->setRuntimeEstimate(qssc::payload::Payload::RuntimeEstimate{
+        estimate->numShots, estimate->shotSeconds, estimate->jobSeconds});
+  else
+    llvm::consumeError(estimate.takeError());
+  addSweepParameterTable(moduleOp, *payload);
+
   mlir::TimingScope const writePayloadTiming =
       buildQEMTiming.nest("write-payload");
   if (config.shouldEmitPlaintextPayload())
@@ -224,25 +318,96 @@ llvm::Error dumpBytecode(const QSSConfig &config, llvm::raw_ostream &os,
 
 using ErrorHandler = function_ref<LogicalResult(const Twine &)>;
 
-llvm::Error buildPassManager_(mlir::PassManager &pm, bool verifyPasses) {
+namespace {
+/// Checks the structural invariants of the IR after each pass, which cost a
+/// single walk rather than the op verifiers: operands are defined in a region
+/// enclosing their user and blocks end in a terminator where one is required.
+/// A violation is reported for the first pass causing one, while the full
+/// verification at the end of the stage fails the compilation.
+class StructuralVerifierInstrumentation : public mlir::PassInstrumentation {
+public:
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override {
+    if (reported.load(std::memory_order_relaxed))
+      return;
+
+    mlir::Operation *invalidOp = nullptr;
+    llvm::StringRef violation;
+    op->walk([&](mlir::Operation *nestedOp) {
+      if (auto *region = nestedOp->getParentRegion()) {
+        for (mlir::Value const operand : nestedOp->getOperands()) {
+          auto *definingRegion = operand.getParentRegion();
+          if (!definingRegion || !definingRegion->isAncestor(region)) {
+            invalidOp = nestedOp;
+            violation = "uses an operand which is not in scope";
+            return mlir::WalkResult::interrupt();
+          }
+        }
+      }
+      if (!nestedOp->isRegistered() ||
+          nestedOp->hasTrait<mlir::OpTrait::NoTerminator>())
+        return mlir::WalkResult::advance();
+      for (auto &region : nestedOp->getRegions()) {
+        for (auto &block : region) {
+          if (block.empty() ||
+              !block.back().mightHaveTrait<mlir::OpTrait::IsTerminator>()) {
+            invalidOp = nestedOp;
+            violation = "has a block without a terminator";
+            return mlir::WalkResult::interrupt();
+          }
+        }
+      }
+      return mlir::WalkResult::advance();
+    });
+
+    if (invalidOp && !reported.exchange(true))
+      invalidOp->emitError() << "operation " << violation << " after pass '"
+                             << pass->getName() << "'";
+  }
+
+private:
+  std::atomic<bool> reported{false};
+};
+} // anonymous namespace
+
+/// @brief Fully verify the module at the end of a compilation stage.
+llvm::Error verifyStage(mlir::ModuleOp moduleOp, llvm::StringRef stage) {
+  if (mlir::failed(mlir::verify(moduleOp)))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Verification failed after " + stage);
+  return llvm::Error::success();
+}
+
+llvm::Error buildPassManager_(mlir::PassManager &pm, bool verifyPasses,
+                              bool verifyStages) {
   if (mlir::failed(mlir::applyPassManagerCLOptions(pm)))
     return llvm::createStringError(
         llvm::inconvertibleErrorCode(),
         "Unable to apply pass manager command line options");
 
-  // Configure verifier
-  pm.enableVerifier(verifyPasses);
+  // Configure verifier. Verifying the stages replaces the verification after
+  // each pass by structural checks.
+  pm.enableVerifier(verifyPasses && !verifyStages);
+  if (verifyStages)
+    pm.addInstrumentation(
+        std::make_unique<StructuralVerifierInstrumentation>());
 
   return llvm::Error::success();
 }
 
-llvm::Error buildPassManager(const QSSConfig &config, mlir::PassManager &pm,
-                             ErrorHandler errorHandler, bool verifyPasses,
-                             mlir::TimingScope &timing) {
-  if (auto err = buildPassManager_(pm, verifyPasses))
+llvm::Error buildPassManager(
+    const QSSConfig &config, mlir::PassManager &pm, ErrorHandler errorHandler,
+    bool verifyPasses, mlir::TimingScope &timing,
+    std::shared_ptr<qssc::hal::compile::PassMemoryReport> memoryReport =
+        nullptr) {
+  if (auto err =
+          buildPassManager_(pm, verifyPasses, config.shouldVerifyStages()))
     return err;
 
   pm.enableTiming(timing);
+  if (memoryReport)
+    pm.addInstrumentation(
+        std::make_unique<qssc::hal::compile::PassMemoryInstrumentation>(
+            std::move(memoryReport), ""));
 
   // Build the provided pipeline.
   if (failed(config.setupPassPipeline(pm)))
@@ -282,6 +447,7 @@ llvm::Error emitMLIR(
   }
 
   // Print the output.
+  mlir::TimingScope const printMlirTiming = emitMlirTiming.nest("print-mlir");
   if (config.getEmitAction() == EmitAction::MLIR)
     dumpMLIR(ostream, moduleOp);
   else if (config.getEmitAction() == EmitAction::Bytecode)
@@ -303,10 +469,18 @@ llvm::Error emitQEM(
     qssc::hal::compile::ThreadedCompilationManager &targetCompilationManager,
     const llvm::MemoryBuffer *sourceBuffer, mlir::TimingScope &timing) {
   if (config.shouldIncludeSource()) {
+    if (!sourceBuffer)
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "The input module has no source to embed in the payload");
     if (config.getInputType() != InputType::Undetected)
+      // The source outlives the payload, which references it rather than
+      // copying it
       payload->addFile("manifest/input." + to_string(inputTypeToFileExtension(
                                                config.getInputType())),
-                       sourceBuffer->getBuffer());
+                       llvm::MemoryBuffer::getMemBuffer(
+                           sourceBuffer->getMemBufferRef(),
+                           /*RequiresNullTerminator=*/false));
     else
       return llvm::createStringError(
           llvm::inconvertibleErrorCode(),
@@ -327,6 +501,10 @@ llvm::Error applyEmitAction(
     mlir::FallbackAsmResourceMap &fallbackResourceMap,
     qssc::hal::compile::ThreadedCompilationManager &targetCompilationManager,
     ErrorHandler errorHandler, mlir::TimingScope &timing) {
+  if (auto err = qssc::utils::checkCompileCancelled(&context, "emit"))
+    return err;
+  qssc::utils::reportCompileProgress(&context, "emit");
+
   // Prepare outputs
   if (config.getEmitAction() == EmitAction::MLIR ||
       config.getEmitAction() == EmitAction::Bytecode) {
@@ -418,16 +596,13 @@ bool emitDiagnosticsAndCheckForErrors(
   return foundError;
 }
 
-llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
-                                  std::unique_ptr<llvm::MemoryBuffer> buffer,
-                                  DialectRegistry &registry,
-                                  mlir::MLIRContext &context,
-                                  const qssc::config::QSSConfig &config,
-                                  mlir::TimingScope &timing,
-                                  qssc::OptDiagnosticCallback diagnosticCb) {
-
-  // Populate the context
+/// @brief Populate the context with the dialects and translations required
+/// for compilation.
+void prepareContext(mlir::MLIRContext &context, DialectRegistry &registry,
+                    const qssc::config::QSSConfig &config) {
   context.appendDialectRegistry(registry);
+  if (mlir::failed(qssc::config::loadPlugins(config, &context)))
+    llvm::errs() << "Failed to load plugins. Request ignored.\n";
   context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
   context.printOpOnDiagnostic(!config.shouldVerifyDiagnostics());
 
@@ -435,23 +610,12 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
   // LLVM IR
   mlir::registerBuiltinDialectTranslation(context);
   mlir::registerLLVMDialectTranslation(context);
-  // Build the target for compilation
-  auto targetResult = buildTarget(&context, config, timing);
-  if (auto err = targetResult.takeError())
-    return err;
-  auto &target = targetResult.get();
-
-  // Set up the input, which is loaded from a file by name or stdin
-  auto sourceMgr = std::make_shared<llvm::SourceMgr>();
-  auto sourceBufferID =
-      sourceMgr->AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
-
-  const llvm::MemoryBuffer *sourceBuffer =
-      sourceMgr->getMemoryBuffer(sourceBufferID);
-
-  auto mlirDiagHandler =
-      qssc::QSSCMLIRDiagnosticHandler(*sourceMgr.get(), &context, diagnosticCb);
+}
 
+/// @brief Create the payload to emit for the configured emit action.
+/// @return The payload or nullptr if the emit action does not produce one.
+llvm::Expected<std::unique_ptr<qssc::payload::Payload>>
+createPayload(const qssc::config::QSSConfig &config) {
   std::unique_ptr<qssc::payload::Payload> payload = nullptr;
 
   if (config.getEmitAction() == EmitAction::QEQEM &&
@@ -462,7 +626,7 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
   if (config.getEmitAction() == EmitAction::QEM ||
       config.getEmitAction() == EmitAction::QEQEM) {
     const auto payloadType = (config.getEmitAction() == EmitAction::QEM)
-                                 ? "ZIP"
+                                 ? config.getPayloadFormat().str()
                                  : config.getTargetName().value();
     auto payloadInfo =
         qssc::payload::registry::PayloadRegistry::lookupPluginInfo(payloadType);
@@ -480,10 +644,223 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
 
     payload = std::move(
         payloadInfo.value()->createPluginInstance(payloadConfig).get());
+    payload->setProfile(config.getPayloadProfile());
+
+    if (auto deltaBase = config.getPayloadDeltaBase()) {
+      auto manifestOrErr = llvm::MemoryBuffer::getFile(*deltaBase);
+      if (std::error_code ec = manifestOrErr.getError())
+        return llvm::createStringError(
+            ec, "Unable to read the payload manifest " + *deltaBase + ": " +
+                    ec.message());
+      auto hashes = qssc::payload::Payload::parseManifestHashes(
+          (*manifestOrErr)->getBuffer());
+      if (!hashes)
+        return hashes.takeError();
+      payload->setDeltaBase(std::move(*hashes));
+    }
   }
 
-  mlir::ModuleOp moduleOp;
-  mlir::FallbackAsmResourceMap fallbackResourceMap;
+  return std::move(payload);
+}
+
+/// @brief Populate moduleOp with the module stored in the frontend cache for
+/// the parameterized source, with its input parameter values replaced.
+/// @return Whether moduleOp was populated. Unreadable entries are treated as
+/// misses.
+bool loadCachedFrontendModule(
+    qssc::cache::CompileCache &cache, llvm::StringRef key,
+    const qssc::frontend::openqasm3::ParameterizedSource &parameterized,
+    mlir::MLIRContext &context, mlir::ModuleOp moduleOp) {
+  auto bytecode = cache.lookup(key);
+  if (!bytecode)
+    return false;
+
+  // A stale or corrupt entry is recompiled rather than reported
+  mlir::ScopedDiagnosticHandler const silenceHandler(
+      &context, [](mlir::Diagnostic &) { return mlir::success(); });
+  mlir::Block block;
+  mlir::ParserConfig parseConfig(&context);
+  if (mlir::failed(mlir::readBytecodeFile(
+          llvm::MemoryBufferRef(*bytecode, key), &block, parseConfig)))
+    return false;
+  mlir::ModuleOp cachedModuleOp;
+  if (!block.empty())
+    cachedModuleOp = llvm::dyn_cast<mlir::ModuleOp>(block.front());
+  if (!cachedModuleOp)
+    return false;
+  if (auto err = qssc::frontend::openqasm3::setInputParameterValues(
+          cachedModuleOp, parameterized.parameterValues)) {
+    llvm::consumeError(std::move(err));
+    return false;
+  }
+
+  moduleOp.getBody()->getOperations().splice(
+      moduleOp.getBody()->end(), cachedModuleOp.getBody()->getOperations());
+  return true;
+}
+
+/// @brief Store the module emitted by the frontend for the parameterized
+/// source in the frontend cache. Modules whose input parameters can not be
+/// matched to the initial values taken out of the source are not stored.
+llvm::Error storeFrontendModule(
+    qssc::cache::CompileCache &cache, llvm::StringRef key,
+    const qssc::frontend::openqasm3::ParameterizedSource &parameterized,
+    mlir::ModuleOp moduleOp) {
+  if (qssc::frontend::openqasm3::getInputParameterValues(moduleOp) !=
+      parameterized.parameterValues)
+    return llvm::Error::success();
+
+  std::string bytecode;
+  llvm::raw_string_ostream bytecodeOS(bytecode);
+  if (mlir::failed(mlir::writeBytecodeToFile(moduleOp, bytecodeOS)))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to emit module bytecode");
+  return cache.store(key, bytecodeOS.str());
+}
+
+/// @brief Open an input file. Bytecode does not require a null terminated
+/// buffer, so large bytecode inputs are always memory mapped rather than read
+/// to the heap. Textual inputs are memory mapped by openInputFile where their
+/// size permits a null terminator.
+std::unique_ptr<llvm::MemoryBuffer>
+openInput(llvm::StringRef filename, const qssc::config::QSSConfig &config,
+          std::string *errorMessage) {
+  if (filename == "-" || config.getInputType() != InputType::Bytecode)
+    return mlir::openInputFile(filename, errorMessage);
+
+  auto file = llvm::MemoryBuffer::getFile(filename, /*IsText=*/false,
+                                          /*RequiresNullTerminator=*/false);
+  if (std::error_code const error = file.getError()) {
+    if (errorMessage)
+      *errorMessage = "cannot open input file '" + filename.str() +
+                      "': " + error.message();
+    return nullptr;
+  }
+  // Inputs named as bytecode may still be textual
+  if (!mlir::isBytecode((*file)->getMemBufferRef()))
+    return mlir::openInputFile(filename, errorMessage);
+  return std::move(*file);
+}
+
+/// @brief Read a bytecode input lazily. The bodies of private symbols are
+/// only materialized once they are referenced from materialized IR, such that
+/// the unused functions of e.g. a subroutine library are never materialized.
+/// Private symbols which remain unreferenced are erased, as symbol-dce would.
+/// @return the top-level operation, wrapped in a module if
+/// insertImplicitModule is set, or nullptr if the input is invalid.
+mlir::OwningOpRef<Operation *>
+readBytecodeLazily(const std::shared_ptr<llvm::SourceMgr> &sourceMgr,
+                   const mlir::ParserConfig &parseConfig,
+                   bool insertImplicitModule) {
+  mlir::MLIRContext *context = parseConfig.getContext();
+  const llvm::MemoryBuffer *buffer =
+      sourceMgr->getMemoryBuffer(sourceMgr->getMainFileID());
+  auto const sourceLoc =
+      mlir::FileLineColLoc::get(context, buffer->getBufferIdentifier(), 0, 0);
+
+  // The lazily loaded private symbols by name and the names referenced from
+  // materialized IR
+  llvm::StringMap<llvm::SmallVector<Operation *, 1>> lazySymbols;
+  llvm::StringSet<> referenced;
+  llvm::SmallVector<Operation *> toMaterialize;
+  auto isLazy = [&](Operation *op) {
+    auto symbol = dyn_cast<mlir::SymbolOpInterface>(op);
+    if (!symbol || !symbol.isPrivate() ||
+        referenced.contains(symbol.getName()))
+      return false;
+    lazySymbols[symbol.getName()].push_back(op);
+    return true;
+  };
+
+  mlir::BytecodeReader reader(buffer->getMemBufferRef(), parseConfig,
+                              /*lazyLoad=*/true, sourceMgr);
+  auto reference = [&](llvm::StringRef name) {
+    if (!referenced.insert(name).second)
+      return;
+    auto it = lazySymbols.find(name);
+    if (it == lazySymbols.end())
+      return;
+    toMaterialize.append(it->second.begin(), it->second.end());
+    lazySymbols.erase(it);
+  };
+  auto collectReferences = [&](Operation *root) {
+    root->walk<mlir::WalkOrder::PreOrder>([&](Operation *op) {
+      if (reader.isMaterializable(op))
+        return mlir::WalkResult::skip();
+      for (auto namedAttr : op->getAttrs())
+        namedAttr.getValue().walk([&](mlir::SymbolRefAttr ref) {
+          reference(ref.getRootReference().getValue());
+          for (auto nested : ref.getNestedReferences())
+            reference(nested.getValue());
+        });
+      return mlir::WalkResult::advance();
+    });
+  };
+
+  mlir::Block block;
+  if (mlir::failed(reader.readTopLevel(&block, isLazy)))
+    return nullptr;
+  for (Operation &op : block)
+    collectReferences(&op);
+  while (!toMaterialize.empty()) {
+    Operation *op = toMaterialize.pop_back_val();
+    if (!reader.isMaterializable(op))
+      continue;
+    if (mlir::failed(reader.materialize(op, isLazy)))
+      return nullptr;
+    collectReferences(op);
+  }
+  // Erase the private symbols which were never referenced
+  if (mlir::failed(reader.finalize([](Operation *) { return false; })))
+    return nullptr;
+
+  mlir::OwningOpRef<Operation *> result;
+  auto &ops = block.getOperations();
+  if (insertImplicitModule &&
+      !(llvm::hasSingleElement(ops) && isa<mlir::ModuleOp>(ops.front()))) {
+    auto module = mlir::ModuleOp::create(sourceLoc);
+    module.getBody()->getOperations().splice(module.getBody()->end(), ops);
+    result = module.getOperation();
+  } else if (llvm::hasSingleElement(ops)) {
+    Operation *op = &ops.front();
+    op->remove();
+    result = op;
+  } else {
+    mlir::emitError(sourceLoc)
+        << "source must contain a single top-level operation, found: "
+        << ops.size();
+    return nullptr;
+  }
+
+  if (parseConfig.shouldVerifyAfterParse() &&
+      mlir::failed(mlir::verify(result.get())))
+    return nullptr;
+  return result;
+}
+
+/// @brief Parse the main buffer of the source manager into a module.
+/// @param sourceMgr Source manager holding the input buffer.
+/// @param context The context to parse into.
+/// @param config Compilation configuration options.
+/// @param fallbackResourceMap Resource map to populate when parsing MLIR.
+/// @param moduleOp Populated with the parsed module. Left unset if the emit
+/// action does not require MLIR (e.g., when dumping the AST).
+/// @param timing Timing scope to nest parse timers in.
+/// @param toggleMultithreading Whether multithreading may be disabled on the
+/// context while parsing MLIR. This must be false if the context is shared
+/// with other concurrent compilations.
+llvm::Error parseInput(std::shared_ptr<llvm::SourceMgr> sourceMgr,
+                       mlir::MLIRContext &context,
+                       const qssc::config::QSSConfig &config,
+                       mlir::FallbackAsmResourceMap &fallbackResourceMap,
+                       mlir::ModuleOp &moduleOp, mlir::TimingScope &timing,
+                       bool toggleMultithreading = true) {
+  if (auto err = qssc::utils::checkCompileCancelled(&context, "parse"))
+    return err;
+  qssc::utils::reportCompileProgress(&context, "parse");
+
+  const llvm::MemoryBuffer *sourceBuffer =
+      sourceMgr->getMemoryBuffer(sourceMgr->getMainFileID());
 
   if (config.getInputType() == InputType::QASM) {
 
@@ -496,14 +873,49 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
 
       moduleOp = mlir::ModuleOp::create(sourceLoc);
     }
+
+    // Programs which only differ in the initial values of their input
+    // parameters share the module emitted by the frontend
+    std::shared_ptr<qssc::cache::CompileCache> frontendCache;
+    std::optional<qssc::frontend::openqasm3::ParameterizedSource>
+        parameterized;
+    std::string frontendCacheKey;
+    if (config.shouldCacheFrontend() &&
+        config.getEmitAction() >= EmitAction::MLIR) {
+      parameterized = qssc::frontend::openqasm3::parameterizeSource(
+          sourceBuffer->getBuffer());
+      if (parameterized)
+        frontendCache = qssc::cache::getCompileCache(config);
+    }
+    if (frontendCache) {
+      mlir::TimingScope cacheLookupTiming =
+          loadQASM3Timing.nest("frontend-cache-lookup");
+      frontendCacheKey = qssc::cache::computeFrontendCacheKey(
+          qssc::frontend::openqasm3::getOptionsKey(),
+          sourceBuffer->getBufferIdentifier(), parameterized->text);
+      if (loadCachedFrontendModule(*frontendCache, frontendCacheKey,
+                                   *parameterized, context, moduleOp))
+        return llvm::Error::success();
+    }
+
     if (auto frontendError = qssc::frontend::openqasm3::parse(
             &context, *sourceMgr, config.getEmitAction() == EmitAction::AST,
             config.getEmitAction() == EmitAction::ASTPretty,
             config.getEmitAction() >= EmitAction::MLIR, moduleOp,
             loadQASM3Timing))
       return frontendError;
-    if (config.getEmitAction() < EmitAction::MLIR)
-      return llvm::Error::success();
+
+    if (frontendCache) {
+      mlir::TimingScope cacheStoreTiming =
+          loadQASM3Timing.nest("frontend-cache-store");
+      if (auto err = storeFrontendModule(*frontendCache, frontendCacheKey,
+                                         *parameterized, moduleOp))
+        // Failing to populate the cache does not invalidate the compilation.
+        mlir::emitWarning(moduleOp.getLoc())
+            << "Unable to store the frontend output in the compile cache: "
+            << llvm::toString(std::move(err));
+    }
+    return llvm::Error::success();
   } // if input == QASM
 
   // Parse mlir::parseSourceFile automatically differentiates between MLIR and
@@ -519,7 +931,8 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
     // Disable multi-threading when parsing the input file. This removes the
     // unnecessary/costly context synchronization when parsing.
     const bool wasThreadingEnabled = context.isMultithreadingEnabled();
-    context.disableMultithreading();
+    if (toggleMultithreading)
+      context.disableMultithreading();
 
     // Prepare the parser config, and attach any useful/necessary resource
     // handlers. Unhandled external resources are treated as passthrough, i.e.
@@ -530,9 +943,14 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
                                    &fallbackResourceMap);
     if (config.shouldRunReproducer())
       reproOptions.attachResourceParser(parseConfig);
-    // Parse the input file and reset the context threading state.
-    mlir::OwningOpRef<Operation *> op = mlir::parseSourceFileForTool(
-        sourceMgr, parseConfig, !config.shouldUseExplicitModule());
+    // Parse the input file and reset the context threading state. Bytecode
+    // is read lazily, skipping the private symbols which are never referenced.
+    mlir::OwningOpRef<Operation *> op =
+        mlir::isBytecode(sourceBuffer->getMemBufferRef())
+            ? readBytecodeLazily(sourceMgr, parseConfig,
+                                 !config.shouldUseExplicitModule())
+            : mlir::parseSourceFileForTool(sourceMgr, parseConfig,
+                                           !config.shouldUseExplicitModule());
 
     mlirParserTiming.stop();
 
@@ -550,10 +968,69 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
           "The qss-compiler does not currently support roundtrip verification. "
           "Please use the qss-opt tool instead.");
 
-    context.enableMultithreading(wasThreadingEnabled);
+    if (toggleMultithreading)
+      context.enableMultithreading(wasThreadingEnabled);
 
     moduleOp = mlir::dyn_cast<mlir::ModuleOp>(op.release());
   } // if input == MLIR
+
+  return llvm::Error::success();
+}
+
+/// @brief Create the report of the memory growth per pass, if configured.
+std::shared_ptr<qssc::hal::compile::PassMemoryReport>
+createPassMemoryReport(const qssc::config::QSSConfig &config) {
+  if (!config.shouldReportPassMemory())
+    return nullptr;
+  return std::make_shared<qssc::hal::compile::PassMemoryReport>();
+}
+
+/// @brief Run the passes specified on the command line on the module.
+llvm::Error runCommandLinePasses(
+    const qssc::config::QSSConfig &config, mlir::MLIRContext &context,
+    mlir::ModuleOp moduleOp, ErrorHandler errorHandler, bool verifyPasses,
+    mlir::TimingScope &timing,
+    std::shared_ptr<qssc::hal::compile::PassMemoryReport> memoryReport) {
+  if (auto err = qssc::utils::checkCompileCancelled(&context,
+                                                    "command-line-passes"))
+    return err;
+  qssc::utils::reportCompileProgress(&context, "command-line-passes");
+
+  mlir::TimingScope commandLinePassesTiming =
+      timing.nest("command-line-passes");
+  mlir::PassManager pm(&context);
+  if (auto err = buildPassManager(config, pm, errorHandler, verifyPasses,
+                                  commandLinePassesTiming,
+                                  std::move(memoryReport)))
+    return err;
+  if (qssc::utils::getContextCompileControl(&context))
+    pm.addInstrumentation(
+        std::make_unique<qssc::hal::compile::CompileProgressInstrumentation>());
+  if (pm.size() && failed(pm.run(moduleOp))) {
+    // the target passes fail once the compilation is cancelled
+    if (auto err = qssc::utils::checkCompileCancelled(
+            &context, "the end of the command-line-passes"))
+      return err;
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Problems running the compiler pipeline!");
+  }
+  if (pm.size() && config.shouldVerifyStages())
+    if (auto err = verifyStage(moduleOp, "the pass pipeline"))
+      return err;
+  commandLinePassesTiming.stop();
+  return llvm::Error::success();
+}
+
+/// @brief Run the command line passes on a parsed or built module and apply
+/// the emit action to it.
+llvm::Error compileParsedModule(
+    llvm::raw_ostream &outputStream,
+    std::unique_ptr<qssc::payload::Payload> payload, mlir::MLIRContext &context,
+    qssc::hal::TargetSystem &target, mlir::ModuleOp moduleOp,
+    const llvm::MemoryBuffer *sourceBuffer,
+    mlir::FallbackAsmResourceMap &fallbackResourceMap,
+    const qssc::config::QSSConfig &config, mlir::TimingScope &timing,
+    const qssc::OptDiagnosticCallback &diagnosticCb) {
   auto errorHandler = [&](const Twine &msg) {
     // format msg to python handler as a compilation failure
     (void)qssc::emitDiagnostic(diagnosticCb, qssc::Severity::Error,
@@ -567,10 +1044,17 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
   // QASM/AST or MLIR file
   bool verifyPasses = config.shouldVerifyPasses();
 
+  auto memoryReport = createPassMemoryReport(config);
+  auto printMemoryReport = llvm::make_scope_exit([&] {
+    if (memoryReport)
+      memoryReport->print(llvm::errs());
+  });
+
   auto targetCompilationManager =
       qssc::hal::compile::ThreadedCompilationManager(
           target, &context, [&](mlir::PassManager &pm) -> llvm::Error {
-            if (auto err = buildPassManager_(pm, verifyPasses))
+            if (auto err = buildPassManager_(pm, verifyPasses,
+                                             config.shouldVerifyStages()))
               return err;
             return llvm::Error::success();
           });
@@ -579,18 +1063,14 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
     return llvm::createStringError(
         llvm::inconvertibleErrorCode(),
         "Unable to apply target compilation options.");
+  targetCompilationManager.enableTargetModuleVerification(
+      config.shouldVerifyStages());
+  targetCompilationManager.enablePassMemoryReport(memoryReport);
 
   // Run additional passes specified on the command line
-  mlir::TimingScope commandLinePassesTiming =
-      timing.nest("command-line-passes");
-  mlir::PassManager pm(&context);
-  if (auto err = buildPassManager(config, pm, errorHandler, verifyPasses,
-                                  commandLinePassesTiming))
+  if (auto err = runCommandLinePasses(config, context, moduleOp, errorHandler,
+                                      verifyPasses, timing, memoryReport))
     return err;
-  if (pm.size() && failed(pm.run(moduleOp)))
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Problems running the compiler pipeline!");
-  commandLinePassesTiming.stop();
 
   if (auto err =
           applyEmitAction(config, outputStream, std::move(payload), context,
@@ -611,133 +1091,1386 @@ llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
   return llvm::Error::success();
 }
 
-} // anonymous namespace
-
-// The following implementation is based on that of MLIROptMain in the core
-// MLIR project with the aim of standardizing CLI tooling and making forwards
-// compatiability more straightforward
+/// @brief Perform the compile actions of config on buffer.
+/// @param diagnosticOutput If set, the diagnostics printed to the error stream
+/// are also appended to it.
+llvm::Error performCompileActions(llvm::raw_ostream &outputStream,
+                                  std::unique_ptr<llvm::MemoryBuffer> buffer,
+                                  DialectRegistry &registry,
+                                  mlir::MLIRContext &context,
+                                  const qssc::config::QSSConfig &config,
+                                  mlir::TimingScope &timing,
+                                  qssc::OptDiagnosticCallback diagnosticCb,
+                                  std::string *diagnosticOutput = nullptr) {
 
-void qssc::registerAndParseCLIOptions(int argc, const char **argv,
-                                      llvm::StringRef toolName,
-                                      mlir::DialectRegistry &registry) {
-  // Register all extensions
-  mlir::registerAllExtensions(registry);
+  // Populate the context
+  prepareContext(context, registry, config);
+  // Build the target for compilation
+  auto targetResult = buildTarget(&context, config, timing);
+  if (auto err = targetResult.takeError())
+    return err;
+  auto &target = targetResult.get();
 
-  registerCLOpts();
-  // Register CL config builder prior to parsing
-  CLIConfigBuilder::registerCLOptions(registry);
-  llvm::cl::SetVersionPrinter(&printVersion);
-  llvm::cl::ParseCommandLineOptions(argc, argv, toolName);
-}
+  // Set up the input, which is loaded from a file by name or stdin
+  auto sourceMgr = std::make_shared<llvm::SourceMgr>();
+  auto sourceBufferID =
+      sourceMgr->AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
 
-std::pair<std::string, std::string>
-qssc::registerAndParseCLIToolOptions(int argc, const char **argv,
-                                     llvm::StringRef toolName,
-                                     mlir::DialectRegistry &registry) {
+  const llvm::MemoryBuffer *sourceBuffer =
+      sourceMgr->getMemoryBuffer(sourceBufferID);
 
-  static llvm::cl::opt<std::string> inputFilename(
-      llvm::cl::Positional, llvm::cl::desc("<input file>"),
-      llvm::cl::init("-"));
+  qssc::DiagnosticAggregator diagAggregator(diagnosticCb,
+                                            config.getDiagnosticRepeatLimit(),
+                                            config.getMaxDiagnostics());
+  diagnosticCb = diagAggregator.getCallback();
+  auto flushDiagnostics =
+      llvm::make_scope_exit([&] { diagAggregator.flush(); });
+  auto mlirDiagHandler = qssc::QSSCMLIRDiagnosticHandler(
+      *sourceMgr.get(), &context, diagnosticCb, &diagAggregator);
+  mlirDiagHandler.setTranscript(diagnosticOutput);
+
+  auto payloadResult = createPayload(config);
+  if (auto err = payloadResult.takeError())
+    return err;
+  std::unique_ptr<qssc::payload::Payload> payload =
+      std::move(payloadResult.get());
 
-  static llvm::cl::opt<std::string> outputFilename(
-      "o", llvm::cl::desc("Output filename"), llvm::cl::value_desc("filename"),
-      llvm::cl::init("-"));
+  mlir::ModuleOp moduleOp;
+  mlir::FallbackAsmResourceMap fallbackResourceMap;
 
-  registerAndParseCLIOptions(argc, argv, toolName, registry);
+  if (auto err = parseInput(sourceMgr, context, config, fallbackResourceMap,
+                            moduleOp, timing))
+    return err;
+  if (config.getInputType() == InputType::QASM &&
+      config.getEmitAction() < EmitAction::MLIR)
+    return llvm::Error::success();
+  // parsed MLIR is verified by the parser
+  if (config.getInputType() == InputType::QASM && config.shouldVerifyStages())
+    if (auto err = verifyStage(moduleOp, "the frontend"))
+      return err;
 
-  return std::make_pair(inputFilename.getValue(), outputFilename.getValue());
+  return compileParsedModule(outputStream, std::move(payload), context, target,
+                             moduleOp, sourceBuffer, fallbackResourceMap,
+                             config, timing, diagnosticCb);
 }
 
-llvm::Error qssc::compileMain(llvm::raw_ostream &outputStream,
-                              std::unique_ptr<llvm::MemoryBuffer> buffer,
-                              DialectRegistry &registry,
-                              const qssc::config::QSSConfig &config,
-                              OptDiagnosticCallback diagnosticCb,
-                              mlir::TimingScope &timing) {
+/// @brief Compile a module which is built in memory rather than parsed, in
+/// place and in its own context.
+llvm::Error performModuleCompileActions(
+    llvm::raw_ostream &outputStream, mlir::ModuleOp moduleOp,
+    DialectRegistry &registry, const qssc::config::QSSConfig &config,
+    mlir::TimingScope &timing, qssc::OptDiagnosticCallback diagnosticCb) {
+  if (config.getEmitAction() < EmitAction::MLIR)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Compiling a module requires an emit action of MLIR or later");
 
-  // The MLIR context for this compilation event.
-  // Instantiate after parsing command line options.
-  MLIRContext context{};
+  mlir::MLIRContext &context = *moduleOp->getContext();
+  prepareContext(context, registry, config);
+  auto targetResult = buildTarget(&context, config, timing);
+  if (auto err = targetResult.takeError())
+    return err;
+  auto &target = targetResult.get();
 
-  std::unique_ptr<llvm::ThreadPool> threadPool;
-  // Override default threadpool threads
-  if (context.isMultithreadingEnabled() && config.getMaxThreads().has_value()) {
-    llvm::ThreadPoolStrategy strategy;
-    // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
-    strategy.ThreadsRequested = config.getMaxThreads().value();
-    threadPool = std::make_unique<llvm::ThreadPool>(strategy);
-    context.setThreadPool(*threadPool.get());
-  }
+  // The module has no source, diagnostics refer to its locations only
+  llvm::SourceMgr sourceMgr;
+  qssc::DiagnosticAggregator diagAggregator(diagnosticCb,
+                                            config.getDiagnosticRepeatLimit(),
+                                            config.getMaxDiagnostics());
+  diagnosticCb = diagAggregator.getCallback();
+  auto flushDiagnostics =
+      llvm::make_scope_exit([&] { diagAggregator.flush(); });
+  auto mlirDiagHandler = qssc::QSSCMLIRDiagnosticHandler(
+      sourceMgr, &context, diagnosticCb, &diagAggregator);
+
+  auto payloadResult = createPayload(config);
+  if (auto err = payloadResult.takeError())
+    return err;
 
-  qssc::config::setContextConfig(&context, config);
+  // The module is verified like a parsed one, which the parser verifies
+  if (auto err = verifyStage(moduleOp, "building the input module"))
+    return err;
 
-  return performCompileActions(outputStream, std::move(buffer), registry,
-                               context, config, timing,
-                               std::move(diagnosticCb));
+  mlir::FallbackAsmResourceMap fallbackResourceMap;
+  return compileParsedModule(outputStream, std::move(payloadResult.get()),
+                             context, target, moduleOp,
+                             /*sourceBuffer=*/nullptr, fallbackResourceMap,
+                             config, timing, diagnosticCb);
 }
 
-llvm::Error qssc::compileMain(int argc, const char **argv,
-                              llvm::StringRef inputFilename,
-                              llvm::StringRef outputFilename,
-                              mlir::DialectRegistry &registry,
-                              OptDiagnosticCallback diagnosticCb) {
+/// @brief Compute the compile cache key of buffer compiled with config.
+llvm::Expected<std::string>
+computeCompileCacheKey(mlir::MLIRContext &context,
+                       const qssc::config::QSSConfig &config,
+                       const llvm::MemoryBuffer &buffer) {
+  // Key on the textual form of the command line pipeline as the pipeline
+  // setup callback itself is opaque.
+  mlir::PassManager pm(&context);
+  if (mlir::failed(config.setupPassPipeline(pm)))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to set up the pass pipeline.");
+  std::string pipeline;
+  llvm::raw_string_ostream pipelineOS(pipeline);
+  pm.printAsTextualPipeline(pipelineOS);
+
+  // The module emitted for OpenQASM 3 sources also depends on the frontend
+  // options and the files the source includes
+  std::string sourceDependencies;
+  if (config.getInputType() == InputType::QASM)
+    sourceDependencies =
+        qssc::frontend::openqasm3::getOptionsKey() +
+        qssc::frontend::openqasm3::getIncludesKey(
+            buffer.getBuffer(), buffer.getBufferIdentifier());
+
+  return qssc::cache::computeCompileCacheKey(
+      config, pipelineOS.str(), buffer.getBuffer(), sourceDependencies);
+}
 
-  llvm::InitLLVM const y(argc, argv);
+/// @brief Replay the diagnostics of a compilation this one was served from,
+/// either from the cache or by deduplication onto it.
+void replayDiagnostics(const qssc::cache::CompileOutcome &outcome,
+                       const qssc::OptDiagnosticCallback &diagnosticCb) {
+  llvm::errs() << outcome.diagnosticOutput;
+  if (diagnosticCb)
+    for (const auto &diag : outcome.diagnostics)
+      (*diagnosticCb)(diag);
+}
 
-  mlir::DefaultTimingManager tm;
-  mlir::applyDefaultTimingManagerCLOptions(tm);
-  // NOLINTNEXTLINE(misc-const-correctness)
-  mlir::TimingScope timing = tm.getRootScope();
+/// @brief Perform the compile actions, serving repeated compilations from
+/// the compile cache configured in config. Only successful compilations are
+/// stored, together with their diagnostics, which are replayed on a hit.
+/// Concurrent compilations of the same key are deduplicated onto one, whose
+/// diagnostics are replayed to the others.
+llvm::Error performCachedCompileActions(
+    llvm::raw_ostream &outputStream, std::unique_ptr<llvm::MemoryBuffer> buffer,
+    DialectRegistry &registry, mlir::MLIRContext &context,
+    const qssc::config::QSSConfig &config, mlir::TimingScope &timing,
+    qssc::OptDiagnosticCallback diagnosticCb) {
+  auto cache = qssc::cache::getCompileCache(config);
+
+  mlir::TimingScope cacheLookupTiming = timing.nest("compile-cache-lookup");
+  auto keyResult = computeCompileCacheKey(context, config, *buffer);
+  if (auto err = keyResult.takeError()) {
+    cacheLookupTiming.stop();
+    llvm::consumeError(qssc::emitDiagnostic(
+        diagnosticCb, qssc::Severity::Info,
+        qssc::ErrorCategory::UncategorizedError,
+        "Bypassing the compile cache: " + llvm::toString(std::move(err))));
+    return performCompileActions(outputStream, std::move(buffer), registry,
+                                 context, config, timing,
+                                 std::move(diagnosticCb));
+  }
+  const std::string &key = keyResult.get();
 
-  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
-  auto configResult =
-      qssc::config::buildToolConfig(inputFilename, outputFilename);
-  if (auto err = configResult.takeError())
-    return err;
-  qssc::config::QSSConfig const config = configResult.get();
-  buildConfigTiming.stop();
+  // Malformed entries, e.g. of other compiler versions, are treated as misses
+  auto lookup = [&]() -> std::optional<qssc::cache::CompileOutcome> {
+    auto entry = cache->lookup(key);
+    if (!entry)
+      return std::nullopt;
+    return qssc::cache::decodeCompileCacheEntry(*entry);
+  };
 
-  if (config.shouldShowDialects()) {
-    showDialects(registry);
+  if (auto cached = lookup()) {
+    cacheLookupTiming.stop();
+    replayDiagnostics(*cached, diagnosticCb);
+    outputStream << cached->output;
     return llvm::Error::success();
   }
+  cacheLookupTiming.stop();
 
-  if (config.shouldShowTargets()) {
-    showTargets();
-    return llvm::Error::success();
-  }
+  // A compilation of the key which finished while this one waited for the
+  // single-flight layer has populated the cache.
+  auto recheck = [&]() -> std::optional<qssc::cache::CompileOutcome> {
+    return lookup();
+  };
 
-  if (config.shouldShowPayloads()) {
-    showPayloads();
-    return llvm::Error::success();
-  }
+  bool compiled = false;
+  auto compile = [&]() {
+    compiled = true;
+    qssc::cache::CompileOutcome outcome;
+    qssc::OptDiagnosticCallback const recordDiagnostic =
+        [&](const qssc::Diagnostic &diag) {
+          outcome.diagnostics.push_back(diag);
+          if (diagnosticCb)
+            (*diagnosticCb)(diag);
+        };
+
+    llvm::raw_string_ostream outputOS(outcome.output);
+    if (auto err = performCompileActions(
+            outputOS, std::move(buffer), registry, context, config, timing,
+            recordDiagnostic, &outcome.diagnosticOutput)) {
+      outcome.error = llvm::toString(std::move(err));
+      return outcome;
+    }
+    outputOS.flush();
 
-  if (config.shouldShowConfig()) {
-    config.emit(llvm::outs());
-    return llvm::Error::success();
-  }
+    mlir::TimingScope cacheStoreTiming = timing.nest("compile-cache-store");
+    if (auto err =
+            cache->store(key, qssc::cache::encodeCompileCacheEntry(outcome)))
+      // Failing to populate the cache does not invalidate the compilation.
+      llvm::consumeError(qssc::emitDiagnostic(
+          diagnosticCb, qssc::Severity::Warning,
+          qssc::ErrorCategory::UncategorizedError,
+          "Unable to store the output in the compile cache: " +
+              llvm::toString(std::move(err))));
+    cacheStoreTiming.stop();
+    return outcome;
+  };
 
-  // When reading from stdin and the input is a tty, it is often a user mistake
-  // and the process "appears to be stuck". Print a message to let the user know
-  // about it!
-  if (inputFilename == "-" &&
-      llvm::sys::Process::FileDescriptorIsDisplayed(fileno(stdin)))
-    llvm::errs() << "(processing input from stdin now, hit ctrl-c/ctrl-d to "
-                    "interrupt)\n";
+  auto outcome = qssc::cache::getCompileSingleFlight().run(
+      key, config.getCompileCacheDir(), recheck, compile);
 
-  // Set up the input file.
-  std::string errorMessage;
-  auto file = mlir::openInputFile(inputFilename, &errorMessage);
-  if (!file)
+  // Replay the diagnostics of the compilation this one was deduplicated onto
+  if (!compiled)
+    replayDiagnostics(outcome, diagnosticCb);
+  if (outcome.error)
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Failed to open input file: " +
-                                       errorMessage);
+                                   *outcome.error);
 
-  auto output = mlir::openOutputFile(outputFilename, &errorMessage);
-  if (!output)
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Failed to open output file: " +
-                                       errorMessage);
+  outputStream << outcome.output;
+  return llvm::Error::success();
+}
+
+/// @brief State of a single input of a batch compilation.
+struct BatchInput {
+  std::shared_ptr<llvm::SourceMgr> sourceMgr;
+  std::unique_ptr<qssc::DiagnosticAggregator> diagAggregator;
+  qssc::OptDiagnosticCallback diagnosticCb;
+  std::unique_ptr<qssc::QSSCMLIRDiagnosticHandler> diagHandler;
+  mlir::FallbackAsmResourceMap fallbackResourceMap;
+  mlir::OwningOpRef<mlir::ModuleOp> moduleOp;
+  qssc::BatchCompileResult result;
+  // Set if the input failed before reaching the target compilation stage.
+  bool failed = false;
+
+  void addError(llvm::Error err) {
+    result.diagnostics.emplace_back(qssc::Severity::Error,
+                                    qssc::ErrorCategory::QSSCompilationFailure,
+                                    llvm::toString(std::move(err)));
+    failed = true;
+  }
+};
+
+// The batch input compiling on the current thread (if any).
+thread_local BatchInput *activeBatchInput = nullptr;
+
+/// Routes MLIR diagnostics emitted while compiling a batch to the diagnostic
+/// handler of the input being compiled on the emitting thread. Nested parallel
+/// pass execution re-emits its diagnostics on the thread which started the
+/// pass manager, so diagnostics are attributed to the right input.
+class BatchDiagnosticRouter {
+public:
+  explicit BatchDiagnosticRouter(mlir::MLIRContext &context)
+      : context(context) {
+    handlerID = context.getDiagEngine().registerHandler(
+        [&](mlir::Diagnostic &diag) -> mlir::LogicalResult {
+          BatchInput *input =
+              activeBatchInput ? activeBatchInput : fallback.load();
+          if (!input)
+            return mlir::failure();
+          input->diagHandler->emitDiagnostic(diag);
+          return mlir::success();
+        });
+  }
+  ~BatchDiagnosticRouter() { context.getDiagEngine().eraseHandler(handlerID); }
+
+  /// Set the input to route diagnostics emitted on threads which are not
+  /// compiling a specific input to. Only valid while a single input runs on
+  /// the context's thread pool.
+  void setFallback(BatchInput *input) { fallback = input; }
+
+private:
+  mlir::MLIRContext &context;
+  mlir::DiagnosticEngine::HandlerID handlerID;
+  std::atomic<BatchInput *> fallback = nullptr;
+};
+
+/// RAII helper marking a batch input as compiling on the calling thread.
+class ActiveBatchInputGuard {
+public:
+  explicit ActiveBatchInputGuard(BatchInput *input) {
+    activeBatchInput = input;
+  }
+  ~ActiveBatchInputGuard() { activeBatchInput = nullptr; }
+
+  ActiveBatchInputGuard(const ActiveBatchInputGuard &) = delete;
+  ActiveBatchInputGuard &operator=(const ActiveBatchInputGuard &) = delete;
+};
+
+/// @brief Apply the command line options to the target compilation manager
+/// shared by the inputs of a batch or pipelined compilation. Dialects may not
+/// be loaded while the context is executing in parallel, so everything the
+/// inputs could require is loaded up front.
+llvm::Error prepareSharedCompilation(
+    mlir::MLIRContext &context, const qssc::config::QSSConfig &config,
+    qssc::hal::compile::ThreadedCompilationManager &targetCompilationManager,
+    std::shared_ptr<qssc::hal::compile::PassMemoryReport> memoryReport,
+    mlir::TimingScope &timing) {
+  if (mlir::failed(qssc::hal::compile::applyTargetCompilationManagerCLOptions(
+          targetCompilationManager)))
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Unable to apply target compilation options.");
+  targetCompilationManager.enableTargetModuleVerification(
+      config.shouldVerifyStages());
+  targetCompilationManager.enablePassMemoryReport(std::move(memoryReport));
+
+  mlir::PassManager pm(&context);
+  auto errorHandler = [](const Twine &) { return mlir::failure(); };
+  if (auto err = buildPassManager(config, pm, errorHandler,
+                                  config.shouldVerifyPasses(), timing))
+    return err;
+  mlir::DialectRegistry dependentDialects;
+  pm.getDependentDialects(dependentDialects);
+  context.appendDialectRegistry(dependentDialects);
+  context.loadAllAvailableDialects();
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::vector<qssc::BatchCompileResult>>
+performBatchCompileActions(
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers,
+    DialectRegistry &registry, mlir::MLIRContext &context,
+    const qssc::config::QSSConfig &config, mlir::TimingScope &timing) {
+
+  if (config.getEmitAction() < EmitAction::MLIR)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Batch compilation requires an emit action of MLIR or later");
+
+  // Populate the context and build the target once for the whole batch.
+  prepareContext(context, registry, config);
+  auto targetResult = buildTarget(&context, config, timing);
+  if (auto err = targetResult.takeError())
+    return std::move(err);
+  auto &target = targetResult.get();
+
+  bool verifyPasses = config.shouldVerifyPasses();
+
+  auto memoryReport = createPassMemoryReport(config);
+  auto printMemoryReport = llvm::make_scope_exit([&] {
+    if (memoryReport)
+      memoryReport->print(llvm::errs());
+  });
+
+  auto targetCompilationManager =
+      qssc::hal::compile::ThreadedCompilationManager(
+          target, &context, [&](mlir::PassManager &pm) -> llvm::Error {
+            if (auto err = buildPassManager_(pm, verifyPasses,
+                                             config.shouldVerifyStages()))
+              return err;
+            return llvm::Error::success();
+          });
+  if (auto err = prepareSharedCompilation(
+          context, config, targetCompilationManager, memoryReport, timing))
+    return std::move(err);
+
+  std::vector<std::unique_ptr<BatchInput>> inputs;
+  inputs.reserve(buffers.size());
+  for (auto &buffer : buffers) {
+    auto input = std::make_unique<BatchInput>();
+    input->sourceMgr = std::make_shared<llvm::SourceMgr>();
+    input->sourceMgr->AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+    auto *diagnostics = &input->result.diagnostics;
+    input->diagAggregator = std::make_unique<qssc::DiagnosticAggregator>(
+        [diagnostics](const qssc::Diagnostic &diag) {
+          diagnostics->push_back(diag);
+        },
+        config.getDiagnosticRepeatLimit(), config.getMaxDiagnostics());
+    input->diagnosticCb = input->diagAggregator->getCallback();
+    input->diagHandler = std::make_unique<qssc::QSSCMLIRDiagnosticHandler>(
+        *input->sourceMgr, &context, input->diagnosticCb,
+        input->diagAggregator.get());
+    inputs.push_back(std::move(input));
+  }
+
+  // Must be registered after the per-input handlers so that it is invoked
+  // first.
+  BatchDiagnosticRouter diagRouter(context);
+
+  // Parse and run command line passes on all inputs in parallel. Each input
+  // is processed within its own module so this obeys MLIR's threading rules.
+  mlir::TimingScope parseTiming = timing.nest("parse-and-prepare-inputs");
+  mlir::parallelFor(&context, 0, inputs.size(), [&](size_t idx) {
+    auto &input = *inputs[idx];
+    ActiveBatchInputGuard const guard(&input);
+    auto inputTiming = parseTiming.nest("input-" + std::to_string(idx));
+
+    auto errorHandler = [&](const Twine &msg) {
+      emitError(UnknownLoc::get(&context)) << msg;
+      return mlir::failure();
+    };
+
+    mlir::ModuleOp moduleOp;
+    auto parseErr = parseInput(input.sourceMgr, context, config,
+                               input.fallbackResourceMap, moduleOp,
+                               inputTiming, /*toggleMultithreading=*/false);
+    input.moduleOp = moduleOp;
+    if (parseErr) {
+      input.addError(std::move(parseErr));
+      return;
+    }
+    if (config.getInputType() == InputType::QASM &&
+        config.shouldVerifyStages()) {
+      if (auto err = verifyStage(moduleOp, "the frontend")) {
+        input.addError(std::move(err));
+        return;
+      }
+    }
+
+    if (auto err = runCommandLinePasses(config, context, moduleOp,
+                                        errorHandler, verifyPasses,
+                                        inputTiming, memoryReport))
+      input.addError(std::move(err));
+  });
+  parseTiming.stop();
+
+  // Targets carry per-compilation state (timers and diagnostics), so the
+  // target stage is run for one input at a time. Each compilation still walks
+  // the target tree in parallel.
+  mlir::TimingScope emitTiming = timing.nest("emit-inputs");
+  std::vector<qssc::BatchCompileResult> results;
+  results.reserve(inputs.size());
+  for (auto &inputPtr : inputs) {
+    auto &input = *inputPtr;
+    diagRouter.setFallback(&input);
+    ActiveBatchInputGuard const guard(&input);
+
+    if (!input.failed) {
+      auto errorHandler = [&](const Twine &msg) {
+        emitError(UnknownLoc::get(&context)) << msg;
+        return mlir::failure();
+      };
+
+      auto payloadResult = createPayload(config);
+      if (auto err = payloadResult.takeError()) {
+        input.addError(std::move(err));
+      } else {
+        llvm::raw_string_ostream outputStream(input.result.output);
+        const llvm::MemoryBuffer *sourceBuffer =
+            input.sourceMgr->getMemoryBuffer(input.sourceMgr->getMainFileID());
+        if (auto err = applyEmitAction(
+                config, outputStream, std::move(payloadResult.get()), context,
+                *input.moduleOp, sourceBuffer, input.fallbackResourceMap,
+                targetCompilationManager, errorHandler, emitTiming))
+          input.addError(std::move(err));
+        outputStream.flush();
+      }
+    }
+
+    if (emitDiagnosticsAndCheckForErrors(
+            targetCompilationManager.takeTargetDiagnostics(),
+            input.diagnosticCb, config))
+      input.failed = true;
+    input.diagAggregator->flush();
+
+    input.result.success = !input.failed;
+    // Release the IR of this input as soon as it has been emitted.
+    input.moduleOp = nullptr;
+    results.push_back(std::move(input.result));
+  }
+  diagRouter.setFallback(nullptr);
+
+  return std::move(results);
+}
+
+/// @brief State of a single input of a pipelined compilation.
+struct PipelineInput : BatchInput {
+  // The errors failing the input, reported once its output is written.
+  llvm::Error error = llvm::Error::success();
+
+  void fail(llvm::Error err) {
+    error = llvm::joinErrors(std::move(error), std::move(err));
+    failed = true;
+  }
+};
+
+llvm::Error performPipelinedCompileActions(
+    const std::vector<qssc::PipelineCompileJob> &jobs,
+    DialectRegistry &registry, mlir::MLIRContext &context,
+    const qssc::config::QSSConfig &config,
+    const qssc::OptDiagnosticCallback &diagnosticCb,
+    mlir::TimingScope &timing) {
+
+  if (config.getEmitAction() < EmitAction::MLIR)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Pipelined compilation requires an emit action of MLIR or later");
+
+  // Populate the context and build the target once for all inputs.
+  prepareContext(context, registry, config);
+  auto targetResult = buildTarget(&context, config, timing);
+  if (auto err = targetResult.takeError())
+    return err;
+  auto &target = targetResult.get();
+
+  bool verifyPasses = config.shouldVerifyPasses();
+
+  auto memoryReport = createPassMemoryReport(config);
+  auto printMemoryReport = llvm::make_scope_exit([&] {
+    if (memoryReport)
+      memoryReport->print(llvm::errs());
+  });
+
+  auto targetCompilationManager =
+      qssc::hal::compile::ThreadedCompilationManager(
+          target, &context, [&](mlir::PassManager &pm) -> llvm::Error {
+            if (auto err = buildPassManager_(pm, verifyPasses,
+                                             config.shouldVerifyStages()))
+              return err;
+            return llvm::Error::success();
+          });
+  if (auto err = prepareSharedCompilation(
+          context, config, targetCompilationManager, memoryReport, timing))
+    return err;
+
+  // The inputs are read in their frontend stage, their diagnostic handlers
+  // must nevertheless be registered ahead of the router.
+  std::vector<std::unique_ptr<PipelineInput>> inputs;
+  inputs.reserve(jobs.size());
+  for (size_t idx = 0; idx < jobs.size(); ++idx) {
+    auto input = std::make_unique<PipelineInput>();
+    input->sourceMgr = std::make_shared<llvm::SourceMgr>();
+    auto *diagnostics = &input->result.diagnostics;
+    input->diagAggregator = std::make_unique<qssc::DiagnosticAggregator>(
+        [diagnostics](const qssc::Diagnostic &diag) {
+          diagnostics->push_back(diag);
+        },
+        config.getDiagnosticRepeatLimit(), config.getMaxDiagnostics());
+    input->diagnosticCb = input->diagAggregator->getCallback();
+    input->diagHandler = std::make_unique<qssc::QSSCMLIRDiagnosticHandler>(
+        *input->sourceMgr, &context, input->diagnosticCb,
+        input->diagAggregator.get());
+    inputs.push_back(std::move(input));
+  }
+
+  BatchDiagnosticRouter diagRouter(context);
+
+  auto errorHandler = [&](const Twine &msg) {
+    emitError(UnknownLoc::get(&context)) << msg;
+    return mlir::failure();
+  };
+
+  // Read and parse an input. Runs alongside the passes of the previous input
+  // and thus never toggles the multithreading of the context.
+  mlir::TimingScope frontendTiming = timing.nest("pipeline-frontend");
+  auto runFrontend = [&](size_t idx) {
+    auto &input = *inputs[idx];
+    ActiveBatchInputGuard const guard(&input);
+    auto inputTiming = frontendTiming.nest("input-" + std::to_string(idx));
+
+    std::string errorMessage;
+    auto file = openInput(jobs[idx].inputFilename, config, &errorMessage);
+    if (!file) {
+      input.fail(llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                         "Failed to open input file: " +
+                                             errorMessage));
+      return;
+    }
+    input.sourceMgr->AddNewSourceBuffer(std::move(file), llvm::SMLoc());
+
+    mlir::ModuleOp moduleOp;
+    auto parseErr = parseInput(input.sourceMgr, context, config,
+                               input.fallbackResourceMap, moduleOp,
+                               inputTiming, /*toggleMultithreading=*/false);
+    input.moduleOp = moduleOp;
+    if (parseErr) {
+      input.fail(std::move(parseErr));
+      return;
+    }
+    if (config.getInputType() == InputType::QASM &&
+        config.shouldVerifyStages())
+      if (auto err = verifyStage(moduleOp, "the frontend"))
+        input.fail(std::move(err));
+  };
+
+  // Run the command line passes and the target compilation of an input and
+  // emit its output to memory. Targets carry per-compilation state, so this
+  // stage runs for one input at a time on the calling thread.
+  mlir::TimingScope passesTiming = timing.nest("pipeline-passes");
+  auto runPasses = [&](size_t idx) {
+    auto &input = *inputs[idx];
+    diagRouter.setFallback(&input);
+    ActiveBatchInputGuard const guard(&input);
+    auto inputTiming = passesTiming.nest("input-" + std::to_string(idx));
+
+    if (!input.failed) {
+      // Each payload is named after its output
+      qssc::config::QSSConfig inputConfig = config;
+      if (jobs[idx].outputFilename != "-")
+        inputConfig.setPayloadName(
+            llvm::sys::path::stem(jobs[idx].outputFilename).str());
+
+      auto payloadResult = createPayload(inputConfig);
+      if (auto err = payloadResult.takeError()) {
+        input.fail(std::move(err));
+      } else if (auto err = runCommandLinePasses(
+                     inputConfig, context, *input.moduleOp, errorHandler,
+                     verifyPasses, inputTiming, memoryReport)) {
+        input.fail(std::move(err));
+      } else {
+        llvm::raw_string_ostream outputStream(input.result.output);
+        const llvm::MemoryBuffer *sourceBuffer =
+            input.sourceMgr->getMemoryBuffer(input.sourceMgr->getMainFileID());
+        if (auto err = applyEmitAction(
+                inputConfig, outputStream, std::move(payloadResult.get()),
+                context, *input.moduleOp, sourceBuffer,
+                input.fallbackResourceMap, targetCompilationManager,
+                errorHandler, inputTiming))
+          input.fail(std::move(err));
+        outputStream.flush();
+      }
+    }
+
+    if (emitDiagnosticsAndCheckForErrors(
+            targetCompilationManager.takeTargetDiagnostics(),
+            input.diagnosticCb, config))
+      input.failed = true;
+    input.diagAggregator->flush();
+    diagRouter.setFallback(nullptr);
+
+    // Release the IR of this input as soon as it has been emitted.
+    input.moduleOp = nullptr;
+  };
+
+  // Write the output of an input and report its diagnostics.
+  size_t numFailed = 0;
+  mlir::TimingScope writeTiming = timing.nest("pipeline-write");
+  auto runWrite = [&](size_t idx) {
+    auto &input = *inputs[idx];
+    auto inputTiming = writeTiming.nest("input-" + std::to_string(idx));
+
+    if (!input.failed) {
+      std::string errorMessage;
+      auto output =
+          mlir::openOutputFile(jobs[idx].outputFilename, &errorMessage);
+      if (output) {
+        output->os() << input.result.output;
+        output->keep();
+      } else {
+        input.fail(llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                           "Failed to open output file: " +
+                                               errorMessage));
+      }
+    }
+    input.result.output.clear();
+
+    if (input.error) {
+      std::string const message = llvm::toString(std::move(input.error));
+      input.result.diagnostics.emplace_back(
+          qssc::Severity::Error, qssc::ErrorCategory::QSSCompilationFailure,
+          message);
+      llvm::errs() << "Error: " << jobs[idx].inputFilename << ": " << message
+                   << "\n";
+    }
+    if (diagnosticCb)
+      for (const auto &diag : input.result.diagnostics)
+        (*diagnosticCb)(diag);
+    if (input.failed)
+      ++numFailed;
+    input.sourceMgr.reset();
+  };
+
+  // In step s the frontend of input s, the passes of input s - 1 and the
+  // writing of input s - 2 run concurrently, such that the throughput is
+  // bound by the slowest stage rather than by the sum of the stages.
+  for (size_t step = 0; step < jobs.size() + 2; ++step) {
+    std::thread frontendThread;
+    std::thread writeThread;
+    if (step < jobs.size())
+      frontendThread = std::thread(runFrontend, step);
+    if (step >= 2)
+      writeThread = std::thread(runWrite, step - 2);
+    if (step >= 1 && step <= jobs.size())
+      runPasses(step - 1);
+    if (frontendThread.joinable())
+      frontendThread.join();
+    if (writeThread.joinable())
+      writeThread.join();
+  }
+
+  if (numFailed)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   std::to_string(numFailed) + " of " +
+                                       std::to_string(jobs.size()) +
+                                       " inputs failed to compile");
+  return llvm::Error::success();
+}
+
+} // anonymous namespace
+
+// The following implementation is based on that of MLIROptMain in the core
+// MLIR project with the aim of standardizing CLI tooling and making forwards
+// compatiability more straightforward
+
+bool qssc::registerAndParseCLIOptions(int argc, const char **argv,
+                                      llvm::StringRef toolName,
+                                      mlir::DialectRegistry &registry,
+                                      llvm::raw_ostream *errs) {
+  // Register all extensions
+  mlir::registerAllExtensions(registry);
+
+  registerCLOpts();
+  // Register CL config builder prior to parsing
+  CLIConfigBuilder::registerCLOptions(registry);
+  llvm::cl::SetVersionPrinter(&printVersion);
+  return llvm::cl::ParseCommandLineOptions(argc, argv, toolName, errs);
+}
+
+namespace {
+/// The manifest or directory of the inputs to compile as a pipeline, if any.
+llvm::cl::opt<std::string> &getPipelineInputsOption() {
+  static llvm::cl::opt<std::string> pipelineInputs(
+      "pipeline-inputs",
+      llvm::cl::desc("Compile the inputs listed in a manifest file, one "
+                     "'<input> [<output>]' per line, or the inputs in a "
+                     "directory as a pipeline sharing one context and "
+                     "target. Outputs which are not listed are written to "
+                     "the directory given by -o"),
+      llvm::cl::value_desc("manifest or directory"));
+  return pipelineInputs;
+}
+} // anonymous namespace
+
+std::pair<std::string, std::string>
+qssc::registerAndParseCLIToolOptions(int argc, const char **argv,
+                                     llvm::StringRef toolName,
+                                     mlir::DialectRegistry &registry) {
+
+  static llvm::cl::opt<std::string> inputFilename(
+      llvm::cl::Positional, llvm::cl::desc("<input file>"),
+      llvm::cl::init("-"));
+
+  static llvm::cl::opt<std::string> outputFilename(
+      "o", llvm::cl::desc("Output filename"), llvm::cl::value_desc("filename"),
+      llvm::cl::init("-"));
+
+  getPipelineInputsOption();
+
+  registerAndParseCLIOptions(argc, argv, toolName, registry);
+
+  return std::make_pair(inputFilename.getValue(), outputFilename.getValue());
+}
+
+namespace {
+/// @brief Registers the compile budget configured, if any, for the
+/// compilations in a context while it is in scope. The deadline is measured
+/// from its construction.
+class ScopedCompileBudget {
+public:
+  ScopedCompileBudget(MLIRContext &context,
+                      const qssc::config::QSSConfig &config)
+      : context(context) {
+    if (!config.getCompileDeadline() && !config.getMemoryBudget())
+      return;
+    std::optional<std::chrono::milliseconds> deadline;
+    if (auto milliseconds = config.getCompileDeadline())
+      deadline = std::chrono::milliseconds(*milliseconds);
+    budget.emplace(deadline, config.getMemoryBudget());
+    qssc::utils::setContextCompileBudget(&context, &*budget);
+  }
+  ScopedCompileBudget(const ScopedCompileBudget &) = delete;
+  ScopedCompileBudget &operator=(const ScopedCompileBudget &) = delete;
+  ~ScopedCompileBudget() {
+    if (budget)
+      qssc::utils::setContextCompileBudget(&context, nullptr);
+  }
+
+private:
+  MLIRContext &context;
+  std::optional<qssc::utils::CompileBudget> budget;
+};
+
+/// @brief Registers the cancellation token and the progress callback
+/// configured, if any, for the compilations in a context while it is in
+/// scope.
+class ScopedCompileControl {
+public:
+  ScopedCompileControl(MLIRContext &context,
+                       const qssc::config::QSSConfig &config)
+      : context(context) {
+    if (!config.getCancellationToken() && !config.getProgressCallback())
+      return;
+    control.emplace(config.getCancellationToken(),
+                    config.getProgressCallback());
+    qssc::utils::setContextCompileControl(&context, &*control);
+  }
+  ScopedCompileControl(const ScopedCompileControl &) = delete;
+  ScopedCompileControl &operator=(const ScopedCompileControl &) = delete;
+  ~ScopedCompileControl() {
+    if (control)
+      qssc::utils::setContextCompileControl(&context, nullptr);
+  }
+
+private:
+  MLIRContext &context;
+  std::optional<qssc::utils::CompileControl> control;
+};
+
+/// @brief Records the stages, the CPU time and the peak resident set size of
+/// a compilation or binding into a report, if one is requested.
+class ReportRecorder {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  ReportRecorder(qssc::CompileReport *report,
+                 std::optional<llvm::StringRef> traceContext)
+      : report(report), start(Clock::now()), startUsage(sampleUsage()) {
+    if (report && traceContext.has_value())
+      report->traceContext = traceContext->str();
+  }
+
+  void addStage(llvm::StringRef name, Clock::duration duration) {
+    if (report)
+      report->stages.emplace_back(name.str(), toSeconds(duration));
+  }
+
+  /// @brief Add the total stage and the resource usage since construction.
+  void finish() {
+    if (!report)
+      return;
+    addStage("total", Clock::now() - start);
+    Usage const usage = sampleUsage();
+    report->userCPUSeconds = usage.userCPUSeconds - startUsage.userCPUSeconds;
+    report->systemCPUSeconds =
+        usage.systemCPUSeconds - startUsage.systemCPUSeconds;
+    report->peakRSSBytes = usage.peakRSSBytes;
+  }
+
+private:
+  struct Usage {
+    double userCPUSeconds = 0.;
+    double systemCPUSeconds = 0.;
+    uint64_t peakRSSBytes = 0;
+  };
+
+  static double toSeconds(Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+  }
+
+  static double toSeconds(const struct timeval &time) {
+    return static_cast<double>(time.tv_sec) +
+           static_cast<double>(time.tv_usec) * 1e-6;
+  }
+
+  static Usage sampleUsage() {
+    Usage sample;
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+      return sample;
+    sample.userCPUSeconds = toSeconds(usage.ru_utime);
+    sample.systemCPUSeconds = toSeconds(usage.ru_stime);
+#ifdef __APPLE__
+    sample.peakRSSBytes = static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    sample.peakRSSBytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+    return sample;
+  }
+
+  qssc::CompileReport *report;
+  Clock::time_point start;
+  Usage startUsage;
+};
+
+/// @brief Add the parse, passes and emit stages of a compilation to the
+/// report from the timers of the trace. The target compilation, which is
+/// timed within the emit timers, counts as passes.
+void recordCompileStages(const qssc::TimingTraceManager &traceManager,
+                         ReportRecorder &recorder) {
+  auto time = [&](llvm::StringRef path) {
+    return traceManager.getTotalTime(path);
+  };
+  auto const emit =
+      time("emit-mlir/print-mlir") + time("build-qem/write-payload");
+  recorder.addStage("parse", time("load-qasm3") + time("parse-mlir"));
+  recorder.addStage("passes", time("command-line-passes") +
+                                  time("emit-mlir") + time("build-qem") -
+                                  emit);
+  recorder.addStage("emit", emit);
+}
+
+/// @brief Run compile with the timing scope or, if the configuration selects
+/// a timing trace or a report is requested, with the root scope of a trace.
+/// The trace is written to the trace file and the report is filled in
+/// afterwards, also for failed compilations.
+llvm::Error
+runWithTiming(MLIRContext &context, const qssc::config::QSSConfig &config,
+              mlir::TimingScope &timing,
+              llvm::function_ref<llvm::Error(mlir::TimingScope &)> compile,
+              qssc::CompileReport *report = nullptr) {
+  auto traceFile = config.getTimingTraceFile();
+  auto const markers = config.getProfilerMarkers();
+  if (!traceFile.has_value() && !report &&
+      markers == qssc::config::ProfilerMarkers::None)
+    return compile(timing);
+
+  ReportRecorder recorder(report, config.getTraceContext());
+  // the counters passes record in the context are traced alongside
+  qssc::TimingTraceManager traceManager;
+  if (auto traceContext = config.getTraceContext())
+    traceManager.setTraceContext(traceContext->str());
+  auto zones = qssc::createProfilerZones(markers);
+  if (auto err = zones.takeError())
+    return err;
+  traceManager.setProfilerZones(std::move(*zones));
+  qssc::utils::setContextCounterSink(&context, &traceManager);
+  auto unregisterSink = llvm::make_scope_exit(
+      [&] { qssc::utils::setContextCounterSink(&context, nullptr); });
+  llvm::Error err = llvm::Error::success();
+  {
+    mlir::TimingScope traceTiming = traceManager.getRootScope();
+    err = compile(traceTiming);
+  }
+  recordCompileStages(traceManager, recorder);
+  recorder.finish();
+  if (!traceFile.has_value())
+    return err;
+  if (auto writeErr = traceManager.write(*traceFile))
+    return llvm::joinErrors(std::move(err), std::move(writeErr));
+  return err;
+}
+
+llvm::Error compileMain_(llvm::raw_ostream &outputStream,
+                         std::unique_ptr<llvm::MemoryBuffer> buffer,
+                         DialectRegistry &registry, MLIRContext &context,
+                         const qssc::config::QSSConfig &config,
+                         OptDiagnosticCallback diagnosticCb,
+                         mlir::TimingScope &timing) {
+  // Only MLIR and payload outputs are written to outputStream and may be
+  // served from the cache.
+  if (config.shouldUseCompileCache() &&
+      config.getEmitAction() >= EmitAction::MLIR)
+    return performCachedCompileActions(outputStream, std::move(buffer),
+                                       registry, context, config, timing,
+                                       std::move(diagnosticCb));
+
+  return performCompileActions(outputStream, std::move(buffer), registry,
+                               context, config, timing,
+                               std::move(diagnosticCb));
+}
+
+/// @brief Compile an input in a context which is exclusive to the
+/// compilation, either a new one or one leased from a context pool.
+llvm::Error compileInContext(llvm::raw_ostream &outputStream,
+                             std::unique_ptr<llvm::MemoryBuffer> buffer,
+                             DialectRegistry &registry, MLIRContext &context,
+                             const qssc::config::QSSConfig &config,
+                             OptDiagnosticCallback diagnosticCb,
+                             mlir::TimingScope &timing,
+                             qssc::CompileReport *report) {
+  // Run on the thread pool shared by the compilations of the process rather
+  // than on a pool of the context's own
+  qssc::ScopedSharedThreadPool const threadPool(context, config);
+
+  qssc::config::setContextConfig(&context, config);
+
+  ScopedCompileBudget const budget(context, config);
+  ScopedCompileControl const control(context, config);
+  auto releaseTarget = llvm::make_scope_exit(
+      [&]() { getTargetInfo(config).releaseTarget(&context); });
+
+  return runWithTiming(
+      context, config, timing, [&](mlir::TimingScope &compileTiming) {
+        return compileMain_(outputStream, std::move(buffer), registry, context,
+                            config, std::move(diagnosticCb), compileTiming);
+      },
+      report);
+}
+} // anonymous namespace
+
+llvm::Error qssc::compileMain(llvm::raw_ostream &outputStream,
+                              std::unique_ptr<llvm::MemoryBuffer> buffer,
+                              DialectRegistry &registry,
+                              const qssc::config::QSSConfig &config,
+                              OptDiagnosticCallback diagnosticCb,
+                              mlir::TimingScope &timing,
+                              qssc::CompileReport *report) {
+
+  // The MLIR context for this compilation event.
+  // Instantiate after parsing command line options.
+  MLIRContext context{};
+
+  return compileInContext(outputStream, std::move(buffer), registry, context,
+                          config, std::move(diagnosticCb), timing, report);
+}
+
+llvm::Error qssc::compileMain(llvm::raw_ostream &outputStream,
+                              std::unique_ptr<llvm::MemoryBuffer> buffer,
+                              ContextPool &pool,
+                              const qssc::config::QSSConfig &config,
+                              OptDiagnosticCallback diagnosticCb,
+                              mlir::TimingScope &timing,
+                              qssc::CompileReport *report) {
+  // The context is returned to the pool once the compilation completed
+  ContextPool::Lease lease = pool.acquire();
+  return compileInContext(outputStream, std::move(buffer), pool.getRegistry(),
+                          lease.getContext(), config, std::move(diagnosticCb),
+                          timing, report);
+}
+
+llvm::Error qssc::compileModule(llvm::raw_ostream &outputStream,
+                                mlir::ModuleOp moduleOp,
+                                mlir::DialectRegistry &registry,
+                                const qssc::config::QSSConfig &config,
+                                OptDiagnosticCallback diagnosticCb,
+                                mlir::TimingScope &timing,
+                                qssc::CompileReport *report) {
+  // The context is owned by the caller, hence it keeps its thread pool
+  MLIRContext &context = *moduleOp->getContext();
+
+  qssc::config::setContextConfig(&context, config);
+
+  ScopedCompileBudget const budget(context, config);
+  ScopedCompileControl const control(context, config);
+  auto releaseTarget = llvm::make_scope_exit(
+      [&]() { getTargetInfo(config).releaseTarget(&context); });
+
+  return runWithTiming(
+      context, config, timing,
+      [&](mlir::TimingScope &compileTiming) {
+        return performModuleCompileActions(outputStream, moduleOp, registry,
+                                           config, compileTiming,
+                                           std::move(diagnosticCb));
+      },
+      report);
+}
+
+llvm::Error qssc::compileLoweredModule(
+    llvm::raw_ostream &outputStream, std::unique_ptr<llvm::MemoryBuffer> buffer,
+    mlir::DialectRegistry &registry, const qssc::config::QSSConfig &config,
+    OptDiagnosticCallback diagnosticCb, mlir::TimingScope &timing) {
+  qssc::config::QSSConfig lowerConfig = config;
+  lowerConfig.setEmitAction(EmitAction::Bytecode).compileTargetIR(true);
+  if (!lowerConfig.shouldAddTargetPasses())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Lowering a module requires the target passes to be added");
+
+  mlir::TimingScope lowerTiming = timing.nest("lower-module");
+  return compileMain(outputStream, std::move(buffer), registry, lowerConfig,
+                     std::move(diagnosticCb), lowerTiming);
+}
+
+llvm::Error qssc::emitPayloadFromLoweredModule(
+    llvm::raw_ostream &outputStream,
+    std::unique_ptr<llvm::MemoryBuffer> loweredModule,
+    mlir::DialectRegistry &registry, const qssc::config::QSSConfig &config,
+    OptDiagnosticCallback diagnosticCb, mlir::TimingScope &timing) {
+  if (config.getEmitAction() != EmitAction::QEM &&
+      config.getEmitAction() != EmitAction::QEQEM)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Only payloads may be emitted from a lowered module");
+  if (!mlir::isBytecode(loweredModule->getMemBufferRef()))
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "The lowered module must be bytecode emitted by compileLoweredModule");
+
+  // The module is lowered already, so the payload is emitted directly
+  qssc::config::QSSConfig emitConfig = config;
+  emitConfig.setInputType(InputType::Bytecode)
+      .bypassPayloadTargetCompilation(true)
+      .setPassPipelineSetupFn(
+          [](mlir::PassManager &) { return mlir::success(); });
+
+  mlir::TimingScope emitTiming = timing.nest("emit-lowered-module");
+  return compileMain(outputStream, std::move(loweredModule), registry,
+                     emitConfig, std::move(diagnosticCb), emitTiming);
+}
+
+llvm::Expected<std::vector<qssc::BatchCompileResult>>
+qssc::compileBatch(std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers,
+                   mlir::DialectRegistry &registry,
+                   const qssc::config::QSSConfig &config,
+                   mlir::TimingScope &timing) {
+
+  // The MLIR context shared by all compilations of the batch.
+  MLIRContext context{};
+
+  // Run on the thread pool shared by the compilations of the process rather
+  // than on a pool of the context's own
+  qssc::ScopedSharedThreadPool const threadPool(context, config);
+
+  qssc::config::setContextConfig(&context, config);
+
+  ScopedCompileBudget const budget(context, config);
+  ScopedCompileControl const control(context, config);
+  auto releaseTarget = llvm::make_scope_exit(
+      [&]() { getTargetInfo(config).releaseTarget(&context); });
+
+  std::vector<qssc::BatchCompileResult> results;
+  auto compileInputs = [&](mlir::TimingScope &compileTiming) -> llvm::Error {
+    auto batchResults = performBatchCompileActions(
+        std::move(buffers), registry, context, config, compileTiming);
+    if (!batchResults)
+      return batchResults.takeError();
+    results = std::move(*batchResults);
+    return llvm::Error::success();
+  };
+  if (auto err = runWithTiming(context, config, timing, compileInputs))
+    return std::move(err);
+  return results;
+}
+
+llvm::Expected<std::vector<qssc::BatchCompileResult>>
+qssc::compileForTargets(
+    std::unique_ptr<llvm::MemoryBuffer> buffer, mlir::DialectRegistry &registry,
+    const qssc::config::QSSConfig &config,
+    const std::vector<qssc::config::QSSConfig> &targetConfigs,
+    OptDiagnosticCallback diagnosticCb, mlir::TimingScope &timing) {
+  for (const auto &targetConfig : targetConfigs)
+    if (targetConfig.getEmitAction() < EmitAction::MLIR)
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Compiling for several targets requires emit actions of MLIR or "
+          "later");
+
+  // Run the frontend and the command line passes once and keep their module
+  // as bytecode, which each target reads into a context of its own as the
+  // targets may not share one
+  qssc::config::QSSConfig frontendConfig = config;
+  frontendConfig.setEmitAction(EmitAction::Bytecode).compileTargetIR(false);
+  std::string frontendModule;
+  llvm::raw_string_ostream frontendOS(frontendModule);
+  mlir::TimingScope frontendTiming = timing.nest("frontend");
+  std::string const bufferIdentifier = buffer->getBufferIdentifier().str();
+  if (auto err = compileMain(frontendOS, std::move(buffer), registry,
+                             frontendConfig, diagnosticCb, frontendTiming))
+    return std::move(err);
+  frontendOS.flush();
+  frontendTiming.stop();
+
+  // The targets are compiled in parallel on the shared thread pool, each
+  // collecting its own diagnostics
+  std::vector<qssc::BatchCompileResult> results(targetConfigs.size());
+  mlir::TimingScope targetsTiming = timing.nest("targets");
+  llvm::ThreadPoolTaskGroup targetTasks(
+      qssc::getSharedThreadPool(config.getMaxThreads()));
+  for (size_t index = 0; index < targetConfigs.size(); ++index)
+    targetTasks.async([&, index]() {
+      auto &result = results[index];
+      qssc::config::QSSConfig targetConfig = targetConfigs[index];
+      targetConfig.setInputType(InputType::Bytecode)
+          .setPassPipelineSetupFn(
+              [](mlir::PassManager &) { return mlir::success(); });
+
+      auto *diagnostics = &result.diagnostics;
+      OptDiagnosticCallback targetDiagnosticCb =
+          [diagnostics](const qssc::Diagnostic &diag) {
+            diagnostics->push_back(diag);
+          };
+      llvm::raw_string_ostream outputOS(result.output);
+      mlir::TimingScope targetTiming =
+          targetsTiming.nest("target-" + std::to_string(index));
+      auto err = compileMain(
+          outputOS,
+          llvm::MemoryBuffer::getMemBuffer(frontendModule, bufferIdentifier,
+                                           /*RequiresNullTerminator=*/false),
+          registry, targetConfig, targetDiagnosticCb, targetTiming);
+      outputOS.flush();
+      result.success = !err;
+      if (err)
+        diagnostics->emplace_back(qssc::Severity::Error,
+                                  qssc::ErrorCategory::QSSCompilationFailure,
+                                  llvm::toString(std::move(err)));
+    });
+  targetTasks.wait();
+  targetsTiming.stop();
+
+  return std::move(results);
+}
+
+llvm::Error qssc::compilePipeline(const std::vector<PipelineCompileJob> &jobs,
+                                  mlir::DialectRegistry &registry,
+                                  const qssc::config::QSSConfig &config,
+                                  OptDiagnosticCallback diagnosticCb,
+                                  mlir::TimingScope &timing) {
+
+  // The MLIR context shared by all stages of the pipeline.
+  MLIRContext context{};
+
+  // Run on the thread pool shared by the compilations of the process rather
+  // than on a pool of the context's own
+  qssc::ScopedSharedThreadPool const threadPool(context, config);
+
+  qssc::config::setContextConfig(&context, config);
+
+  ScopedCompileBudget const budget(context, config);
+  ScopedCompileControl const control(context, config);
+  auto releaseTarget = llvm::make_scope_exit(
+      [&]() { getTargetInfo(config).releaseTarget(&context); });
+
+  return runWithTiming(
+      context, config, timing, [&](mlir::TimingScope &compileTiming) {
+        return performPipelinedCompileActions(jobs, registry, context, config,
+                                              diagnosticCb, compileTiming);
+      });
+}
+
+llvm::Expected<qssc::CompileResourceEstimate> qssc::estimateCompileResources(
+    std::unique_ptr<llvm::MemoryBuffer> buffer, mlir::DialectRegistry &registry,
+    const qssc::config::QSSConfig &config, OptDiagnosticCallback diagnosticCb,
+    const CompileResourceModel &model) {
+  // The frontend emits the module only for emit actions of MLIR or later
+  qssc::config::QSSConfig parseConfig = config;
+  if (parseConfig.getEmitAction() < EmitAction::MLIR)
+    parseConfig.setEmitAction(EmitAction::MLIR);
+
+  MLIRContext context;
+  prepareContext(context, registry, parseConfig);
+  qssc::config::setContextConfig(&context, parseConfig);
+
+  auto sourceMgr = std::make_shared<llvm::SourceMgr>();
+  sourceMgr->AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+  auto mlirDiagHandler =
+      qssc::QSSCMLIRDiagnosticHandler(*sourceMgr, &context, diagnosticCb);
+
+  mlir::ModuleOp moduleOp;
+  mlir::FallbackAsmResourceMap fallbackResourceMap;
+  mlir::TimingScope timing;
+  if (auto err = parseInput(sourceMgr, context, parseConfig,
+                            fallbackResourceMap, moduleOp, timing))
+    return std::move(err);
+  mlir::OwningOpRef<mlir::ModuleOp> const ownedModuleOp(moduleOp);
+
+  auto const counts = mlir::quir::countIRResources(moduleOp);
+  CompileResourceEstimate estimate;
+  estimate.ops = counts.ops;
+  estimate.qubits = counts.qubits;
+  estimate.unrolledOps = counts.unrolledOps;
+  estimate.unrolledQuantumOps = counts.unrolledQuantumOps;
+  estimate.unrolledSubroutineCalls = counts.unrolledSubroutineCalls;
+  estimate.maxSubroutineFanOut = counts.maxSubroutineFanOut;
+  estimate.elementsBytes = counts.elementsBytes;
+
+  // The unrolled counts saturate, and so do the estimates
+  auto bytes = [](uint64_t base, uint64_t perUnit, int64_t units) {
+    return llvm::SaturatingMultiplyAdd(perUnit, static_cast<uint64_t>(units),
+                                       base);
+  };
+  estimate.compileSeconds =
+      model.baseSeconds +
+      model.secondsPerUnrolledOp * static_cast<double>(counts.unrolledOps) +
+      model.secondsPerSubroutineCall *
+          static_cast<double>(counts.unrolledSubroutineCalls);
+  estimate.peakMemoryBytes = bytes(
+      bytes(model.baseMemoryBytes, model.memoryBytesPerUnrolledOp,
+            counts.unrolledOps),
+      model.memoryBytesPerElementsByte, counts.elementsBytes);
+  estimate.payloadBytes =
+      bytes(bytes(model.basePayloadBytes, model.payloadBytesPerQuantumOp,
+                  counts.unrolledQuantumOps),
+            1, counts.elementsBytes);
+  return estimate;
+}
+
+llvm::Expected<std::vector<qssc::PipelineCompileJob>>
+qssc::readPipelineJobs(llvm::StringRef path) {
+  std::vector<PipelineCompileJob> jobs;
+
+  if (llvm::sys::fs::is_directory(path)) {
+    std::error_code ec;
+    for (llvm::sys::fs::directory_iterator it(path, ec), end;
+         it != end && !ec; it.increment(ec)) {
+      if (it->type() != llvm::sys::fs::file_type::regular_file)
+        continue;
+      auto const inputType = qssc::config::fileExtensionToInputType(
+          qssc::config::getExtension(it->path()));
+      if (inputType != InputType::Undetected)
+        jobs.push_back({it->path(), ""});
+    }
+    if (ec)
+      return llvm::createStringError(ec, "Failed to read the directory " +
+                                             path + ": " + ec.message());
+    std::sort(jobs.begin(), jobs.end(), [](const auto &a, const auto &b) {
+      return a.inputFilename < b.inputFilename;
+    });
+    return std::move(jobs);
+  }
+
+  auto manifest = llvm::MemoryBuffer::getFile(path);
+  if (auto ec = manifest.getError())
+    return llvm::createStringError(ec, "Failed to open the manifest " + path +
+                                           ": " + ec.message());
+  llvm::SmallVector<llvm::StringRef> lines;
+  (*manifest)->getBuffer().split(lines, '\n');
+  for (auto line : lines) {
+    line = line.trim();
+    if (line.empty() || line.startswith("#"))
+      continue;
+    auto [input, output] = llvm::getToken(line);
+    output = output.trim();
+    if (output.find_first_of(" \t") != llvm::StringRef::npos)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Invalid manifest line: " + line);
+    jobs.push_back({input.str(), output.str()});
+  }
+  return std::move(jobs);
+}
+
+llvm::Error qssc::compileMain(int argc, const char **argv,
+                              llvm::StringRef inputFilename,
+                              llvm::StringRef outputFilename,
+                              mlir::DialectRegistry &registry,
+                              OptDiagnosticCallback diagnosticCb) {
+
+  llvm::InitLLVM const y(argc, argv);
+
+  mlir::DefaultTimingManager tm;
+  mlir::applyDefaultTimingManagerCLOptions(tm);
+  // NOLINTNEXTLINE(misc-const-correctness)
+  mlir::TimingScope timing = tm.getRootScope();
+
+  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
+  auto configResult =
+      qssc::config::buildToolConfig(inputFilename, outputFilename);
+  if (auto err = configResult.takeError())
+    return err;
+  qssc::config::QSSConfig const config = configResult.get();
+  buildConfigTiming.stop();
+
+  if (config.shouldShowDialects()) {
+    showDialects(registry);
+    return llvm::Error::success();
+  }
+
+  if (config.shouldShowTargets()) {
+    showTargets();
+    return llvm::Error::success();
+  }
+
+  if (config.shouldShowPayloads()) {
+    showPayloads();
+    return llvm::Error::success();
+  }
+
+  if (config.shouldShowConfig()) {
+    config.emit(llvm::outs());
+    return llvm::Error::success();
+  }
+
+  // When reading from stdin and the input is a tty, it is often a user mistake
+  // and the process "appears to be stuck". Print a message to let the user know
+  // about it!
+  if (inputFilename == "-" &&
+      llvm::sys::Process::FileDescriptorIsDisplayed(fileno(stdin)))
+    llvm::errs() << "(processing input from stdin now, hit ctrl-c/ctrl-d to "
+                    "interrupt)\n";
+
+  // Set up the input file.
+  std::string errorMessage;
+  auto file = openInput(inputFilename, config, &errorMessage);
+  if (!file)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to open input file: " +
+                                       errorMessage);
+
+  auto output = mlir::openOutputFile(outputFilename, &errorMessage);
+  if (!output)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to open output file: " +
+                                       errorMessage);
 
   if (auto err = compileMain(output->os(), std::move(file), registry, config,
                              std::move(diagnosticCb), timing))
@@ -748,6 +2481,72 @@ llvm::Error qssc::compileMain(int argc, const char **argv,
   return llvm::Error::success();
 }
 
+namespace {
+/// Implementation of the pipelined compilation of the inputs in the manifest
+/// or directory pipelineInputs for tools like `qss-compiler`.
+llvm::Error compilePipelineMain(int argc, const char **argv,
+                                llvm::StringRef pipelineInputs,
+                                llvm::StringRef outputDirectory,
+                                mlir::DialectRegistry &registry,
+                                OptDiagnosticCallback diagnosticCb) {
+
+  llvm::InitLLVM const y(argc, argv);
+
+  mlir::DefaultTimingManager tm;
+  mlir::applyDefaultTimingManagerCLOptions(tm);
+  // NOLINTNEXTLINE(misc-const-correctness)
+  mlir::TimingScope timing = tm.getRootScope();
+
+  auto jobs = qssc::readPipelineJobs(pipelineInputs);
+  if (auto err = jobs.takeError())
+    return err;
+  if (jobs->empty())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "No inputs to compile in " +
+                                       pipelineInputs);
+
+  // The input type and the emit action are detected from the first input and
+  // its output, if listed.
+  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
+  auto const &firstJob = jobs->front();
+  auto configResult = qssc::config::buildToolConfig(
+      firstJob.inputFilename,
+      firstJob.outputFilename.empty() ? "-" : firstJob.outputFilename);
+  if (auto err = configResult.takeError())
+    return err;
+  qssc::config::QSSConfig const config = configResult.get();
+  buildConfigTiming.stop();
+
+  // Outputs which are not listed are named after their input in the output
+  // directory
+  bool createdOutputDirectory = false;
+  for (auto &job : *jobs) {
+    if (!job.outputFilename.empty())
+      continue;
+    if (outputDirectory == "-")
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "An output directory must be given with -o for the input " +
+              job.inputFilename);
+    if (!createdOutputDirectory) {
+      if (auto ec = llvm::sys::fs::create_directories(outputDirectory))
+        return llvm::createStringError(
+            ec, "Failed to create the output directory " + outputDirectory +
+                    ": " + ec.message());
+      createdOutputDirectory = true;
+    }
+    llvm::SmallString<128> outputPath(outputDirectory);
+    llvm::sys::path::append(outputPath,
+                            llvm::sys::path::stem(job.inputFilename) + "." +
+                                to_string(config.getEmitAction()));
+    job.outputFilename = outputPath.str().str();
+  }
+
+  return qssc::compilePipeline(*jobs, registry, config,
+                               std::move(diagnosticCb), timing);
+}
+} // anonymous namespace
+
 llvm::Error qssc::compileMain(int argc, const char **argv,
                               llvm::StringRef toolName,
                               mlir::DialectRegistry &registry,
@@ -758,24 +2557,63 @@ llvm::Error qssc::compileMain(int argc, const char **argv,
   std::tie(inputFilename, outputFilename) =
       registerAndParseCLIToolOptions(argc, argv, toolName, registry);
 
+  if (!getPipelineInputsOption().empty())
+    return compilePipelineMain(argc, argv, getPipelineInputsOption(),
+                               outputFilename, registry,
+                               std::move(diagnosticCb));
+
   return compileMain(argc, argv, inputFilename, outputFilename, registry,
                      std::move(diagnosticCb));
 }
 
-llvm::Error qssc::compileMain(int argc, const char **argv,
-                              llvm::StringRef toolName,
-                              OptDiagnosticCallback diagnosticCb) {
-  // Register the standard passes with MLIR.
-  // Must precede the command line parsing.
-  if (auto err = qssc::dialect::registerPasses())
-    return err;
+std::optional<std::string> qssc::findCommandLineTarget(int argc,
+                                                       const char **argv) {
+  std::optional<std::string> targetName;
+  for (int i = 1; i < argc; ++i) {
+    llvm::StringRef arg(argv[i]);
+    // The options of all targets must be known to print them or to expand
+    // response files
+    if (arg == "-h" || arg.startswith("-help") || arg.startswith("--help") ||
+        arg.startswith("@"))
+      return std::nullopt;
+    if (arg == "--")
+      break;
+    if (!arg.consume_front("--") && !arg.consume_front("-"))
+      continue;
+    if (arg == "target" && i + 1 < argc)
+      targetName = argv[++i];
+    else if (arg.consume_front("target="))
+      targetName = arg.str();
+  }
+  if (targetName)
+    return targetName;
+  if (const char *targetStr = std::getenv("QSSC_TARGET_NAME"))
+    return std::string(targetStr);
+  return std::string();
+}
 
-  mlir::DialectRegistry registry;
+llvm::Error qssc::registerCommandLineTarget(int argc, const char **argv,
+                                            mlir::DialectRegistry &registry) {
+  // Register the standard passes with MLIR and those of the selected target
+  auto targetName = findCommandLineTarget(argc, argv);
+  if (auto err = qssc::dialect::registerPasses(
+          targetName ? std::optional<llvm::StringRef>(*targetName)
+                     : std::nullopt))
+    return err;
 
   // Add the following to include *all* QSS core dialects, or selectively
   // include what you need like above. You only need to register dialects that
   // will be *parsed* by the tool, not the one generated
   qssc::dialect::registerDialects(registry);
+  return llvm::Error::success();
+}
+
+llvm::Error qssc::compileMain(int argc, const char **argv,
+                              llvm::StringRef toolName,
+                              OptDiagnosticCallback diagnosticCb) {
+  mlir::DialectRegistry registry;
+  if (auto err = registerCommandLineTarget(argc, argv, registry))
+    return err;
 
   return compileMain(argc, argv, toolName, registry, std::move(diagnosticCb));
 }
@@ -804,16 +2642,11 @@ private:
   const std::unordered_map<std::string, double> &parameterMap;
 };
 
-llvm::Error
-bindArguments_(std::string_view target, qssc::config::EmitAction action,
-               std::string_view configPath, std::string_view moduleInput,
-               std::string_view payloadOutputPath,
-               std::unordered_map<std::string, double> const &arguments,
-               bool treatWarningsAsErrors, bool enableInMemoryInput,
-               std::string *inMemoryOutput,
-               const qssc::OptDiagnosticCallback &onDiagnostic) {
-
-  MLIRContext context{};
+llvm::Expected<qssc::arguments::BindArgumentsImplementationFactory *>
+getBindArgumentsFactory_(MLIRContext &context, std::string_view target,
+                         qssc::config::EmitAction action,
+                         std::string_view configPath,
+                         const qssc::OptDiagnosticCallback &onDiagnostic) {
 
   qssc::hal::registry::TargetSystemInfo &targetInfo =
       *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(target)
@@ -836,8 +2669,6 @@ bindArguments_(std::string_view target, qssc::config::EmitAction action,
         std::move(err));
   }
 
-  MapAngleArgumentSource const source(arguments);
-
   auto factory =
       targetInst.get()->getBindArgumentsImplementationFactory(action);
   if ((!factory.has_value()) || (factory.value() == nullptr)) {
@@ -846,11 +2677,130 @@ bindArguments_(std::string_view target, qssc::config::EmitAction action,
         qssc::ErrorCategory::QSSLinkerNotImplemented,
         "Unable to load bind arguments implementation for target.");
   }
-  qssc::arguments::BindArgumentsImplementationFactory &factoryRef =
-      *factory.value();
-  return qssc::arguments::bindArguments(
+  return factory.value();
+}
+
+// Binaries are patched on the context's thread pool, such that binding
+// follows the same multithreading settings as compilation.
+llvm::ThreadPool *getBindThreadPool_(MLIRContext &context) {
+  if (!context.isMultithreadingEnabled())
+    return nullptr;
+  return &context.getThreadPool();
+}
+
+llvm::Error
+bindArguments_(std::string_view target, qssc::config::EmitAction action,
+               std::string_view configPath, std::string_view moduleInput,
+               std::string_view payloadOutputPath,
+               std::unordered_map<std::string, double> const &arguments,
+               bool treatWarningsAsErrors, bool enableInMemoryInput,
+               std::string *inMemoryOutput,
+               const qssc::OptDiagnosticCallback &onDiagnostic,
+               ReportRecorder &recorder) {
+
+  MLIRContext context{};
+  qssc::ScopedSharedThreadPool const threadPool(context, std::nullopt);
+
+  auto factory = getBindArgumentsFactory_(context, target, action, configPath,
+                                          onDiagnostic);
+  if (auto err = factory.takeError())
+    return err;
+
+  MapAngleArgumentSource const source(arguments);
+
+  auto const bindStart = ReportRecorder::Clock::now();
+  auto err = qssc::arguments::bindArguments(
       moduleInput, payloadOutputPath, source, treatWarningsAsErrors,
-      enableInMemoryInput, inMemoryOutput, factoryRef, onDiagnostic);
+      enableInMemoryInput, inMemoryOutput, **factory, onDiagnostic,
+      getBindThreadPool_(context));
+  recorder.addStage("bind", ReportRecorder::Clock::now() - bindStart);
+  return err;
+}
+
+llvm::Error bindArgumentsBatch_(
+    std::string_view target, qssc::config::EmitAction action,
+    std::string_view configPath, std::string_view moduleInput,
+    std::vector<std::unordered_map<std::string, double>> const &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *outputs,
+    const qssc::OptDiagnosticCallback &onDiagnostic) {
+
+  if (outputs == nullptr)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "outputs must not be null");
+
+  MLIRContext context{};
+  qssc::ScopedSharedThreadPool const threadPool(context, std::nullopt);
+
+  auto factory = getBindArgumentsFactory_(context, target, action, configPath,
+                                          onDiagnostic);
+  if (auto err = factory.takeError())
+    return err;
+
+  std::vector<MapAngleArgumentSource> sources;
+  sources.reserve(argumentSets.size());
+  std::vector<const qssc::arguments::ArgumentSource *> sourcePtrs;
+  sourcePtrs.reserve(argumentSets.size());
+  for (const auto &arguments : argumentSets)
+    sourcePtrs.push_back(&sources.emplace_back(arguments));
+
+  return qssc::arguments::bindArgumentsBatch(
+      moduleInput, enableInMemoryInput, sourcePtrs, treatWarningsAsErrors,
+      *outputs, **factory, onDiagnostic, getBindThreadPool_(context));
+}
+
+llvm::Error bindArgumentColumns_(
+    std::string_view target, qssc::config::EmitAction action,
+    std::string_view configPath, std::string_view moduleInput,
+    std::vector<std::string> const &parameterNames,
+    llvm::ArrayRef<double> values, bool treatWarningsAsErrors,
+    bool enableInMemoryInput, std::vector<std::string> *outputs,
+    const qssc::OptDiagnosticCallback &onDiagnostic) {
+
+  if (outputs == nullptr)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "outputs must not be null");
+
+  // every row of values holds one argument per parameter, hence the names
+  // are resolved to slots once for all rows
+  qssc::arguments::ArgumentLayout layout;
+  for (const auto &name : parameterNames)
+    layout.addParameter(name);
+  if (layout.getNumParameters() != parameterNames.size())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Parameter names must be unique");
+
+  size_t const numParameters = parameterNames.size();
+  if (numParameters == 0 || values.size() % numParameters != 0)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Expected a multiple of %zu argument values but got %zu",
+        numParameters, values.size());
+
+  MLIRContext context{};
+  qssc::ScopedSharedThreadPool const threadPool(context, std::nullopt);
+
+  auto factory = getBindArgumentsFactory_(context, target, action, configPath,
+                                          onDiagnostic);
+  if (auto err = factory.takeError())
+    return err;
+
+  size_t const numSets = values.size() / numParameters;
+  std::vector<qssc::arguments::ColumnarArgumentSource> sources;
+  sources.reserve(numSets);
+  std::vector<const qssc::arguments::ArgumentSource *> sourcePtrs;
+  sourcePtrs.reserve(numSets);
+  for (size_t i = 0; i < numSets; ++i) {
+    auto source = qssc::arguments::ColumnarArgumentSource::create(
+        layout, values.slice(i * numParameters, numParameters));
+    if (auto err = source.takeError())
+      return err;
+    sourcePtrs.push_back(&sources.emplace_back(std::move(*source)));
+  }
+
+  return qssc::arguments::bindArgumentsBatch(
+      moduleInput, enableInMemoryInput, sourcePtrs, treatWarningsAsErrors,
+      *outputs, **factory, onDiagnostic, getBindThreadPool_(context));
 }
 
 } // anonymous namespace
@@ -862,14 +2812,165 @@ int qssc::bindArguments(
     std::unordered_map<std::string, double> const &arguments,
     bool treatWarningsAsErrors, bool enableInMemoryInput,
     std::string *inMemoryOutput,
+    const qssc::OptDiagnosticCallback &onDiagnostic,
+    qssc::CompileReport *report) {
+
+  ReportRecorder recorder(report, std::nullopt);
+  auto err = bindArguments_(target, action, configPath, moduleInput,
+                            payloadOutputPath, arguments, treatWarningsAsErrors,
+                            enableInMemoryInput, inMemoryOutput, onDiagnostic,
+                            recorder);
+  recorder.finish();
+  if (err) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  return 0;
+}
+
+int qssc::bindArgumentsBatch(
+    std::string_view target, qssc::config::EmitAction action,
+    std::string_view configPath, std::string_view moduleInput,
+    std::vector<std::unordered_map<std::string, double>> const &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *outputs,
     const qssc::OptDiagnosticCallback &onDiagnostic) {
 
-  if (auto err =
-          bindArguments_(target, action, configPath, moduleInput,
-                         payloadOutputPath, arguments, treatWarningsAsErrors,
-                         enableInMemoryInput, inMemoryOutput, onDiagnostic)) {
+  if (auto err = bindArgumentsBatch_(target, action, configPath, moduleInput,
+                                     argumentSets, treatWarningsAsErrors,
+                                     enableInMemoryInput, outputs,
+                                     onDiagnostic)) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  return 0;
+}
+
+int qssc::bindArgumentsBatch(
+    std::string_view target, qssc::config::EmitAction action,
+    std::string_view configPath, std::string_view moduleInput,
+    std::vector<std::string> const &parameterNames,
+    llvm::ArrayRef<double> values, bool treatWarningsAsErrors,
+    bool enableInMemoryInput, std::vector<std::string> *outputs,
+    const qssc::OptDiagnosticCallback &onDiagnostic) {
+
+  if (auto err = bindArgumentColumns_(target, action, configPath, moduleInput,
+                                      parameterNames, values,
+                                      treatWarningsAsErrors,
+                                      enableInMemoryInput, outputs,
+                                      onDiagnostic)) {
     llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
     return 1;
   }
   return 0;
 }
+
+struct qssc::ArgumentBinder::Impl {
+  // the context owns the target, which owns the bind implementation factory
+  mlir::MLIRContext context{};
+  std::unique_ptr<qssc::arguments::IncrementalBinder> binder;
+  // the arguments of all binds so far, such that parameters not given to a
+  // bind keep their values
+  std::unordered_map<std::string, double> arguments;
+};
+
+qssc::ArgumentBinder::ArgumentBinder() : impl(std::make_unique<Impl>()) {}
+
+qssc::ArgumentBinder::~ArgumentBinder() = default;
+
+llvm::Expected<std::unique_ptr<qssc::ArgumentBinder>>
+qssc::ArgumentBinder::create(std::string_view target,
+                             qssc::config::EmitAction action,
+                             std::string_view configPath,
+                             std::string_view moduleInput,
+                             bool treatWarningsAsErrors,
+                             bool enableInMemoryInput,
+                             const qssc::OptDiagnosticCallback &onDiagnostic) {
+  auto binder = std::unique_ptr<ArgumentBinder>(new ArgumentBinder());
+
+  auto factory = getBindArgumentsFactory_(binder->impl->context, target,
+                                          action, configPath, onDiagnostic);
+  if (auto err = factory.takeError())
+    return std::move(err);
+
+  auto incrementalBinder = qssc::arguments::IncrementalBinder::create(
+      moduleInput, enableInMemoryInput, treatWarningsAsErrors, **factory,
+      onDiagnostic);
+  if (auto err = incrementalBinder.takeError())
+    return std::move(err);
+  binder->impl->binder = std::move(*incrementalBinder);
+
+  return std::move(binder);
+}
+
+llvm::Error qssc::ArgumentBinder::bind(
+    std::unordered_map<std::string, double> const &arguments,
+    std::string *output) {
+  for (const auto &[name, value] : arguments)
+    impl->arguments.insert_or_assign(name, value);
+
+  MapAngleArgumentSource const source(impl->arguments);
+  return impl->binder->bind(source, output);
+}
+
+size_t qssc::ArgumentBinder::getNumPatched() const {
+  return impl->binder->getNumPatched();
+}
+
+struct qssc::Linker::Impl {
+  // the context owns the target, which owns the bind implementation factory
+  mlir::MLIRContext context{};
+  std::unique_ptr<qssc::arguments::BatchBinder> binder;
+};
+
+qssc::Linker::Linker() : impl(std::make_unique<Impl>()) {}
+
+qssc::Linker::~Linker() = default;
+
+llvm::Expected<std::unique_ptr<qssc::Linker>>
+qssc::Linker::create(std::string_view target, qssc::config::EmitAction action,
+                     std::string_view configPath, std::string_view moduleInput,
+                     bool treatWarningsAsErrors, bool enableInMemoryInput,
+                     const qssc::OptDiagnosticCallback &onDiagnostic) {
+  auto linker = std::unique_ptr<Linker>(new Linker());
+
+  auto factory = getBindArgumentsFactory_(linker->impl->context, target,
+                                          action, configPath, onDiagnostic);
+  if (auto err = factory.takeError())
+    return std::move(err);
+
+  auto binder = qssc::arguments::BatchBinder::create(
+      moduleInput, enableInMemoryInput, treatWarningsAsErrors, **factory,
+      onDiagnostic);
+  if (auto err = binder.takeError())
+    return std::move(err);
+  linker->impl->binder = std::move(*binder);
+
+  return std::move(linker);
+}
+
+llvm::Error qssc::Linker::linkMany(
+    std::vector<std::unordered_map<std::string, double>> const &argumentSets,
+    std::vector<std::string> *outputs,
+    const qssc::OptDiagnosticCallback &onDiagnostic) {
+  if (outputs == nullptr)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "outputs must not be null");
+
+  std::vector<MapAngleArgumentSource> sources;
+  sources.reserve(argumentSets.size());
+  std::vector<const qssc::arguments::ArgumentSource *> sourcePtrs;
+  sourcePtrs.reserve(argumentSets.size());
+  for (const auto &arguments : argumentSets)
+    sourcePtrs.push_back(&sources.emplace_back(arguments));
+
+  // the pool is held for the call only, such that linkers which are kept
+  // open do not take it from compilations
+  qssc::ScopedSharedThreadPool const threadPool(impl->context, std::nullopt);
+  return impl->binder->bind(sourcePtrs, *outputs, onDiagnostic,
+                            getBindThreadPool_(impl->context));
+}
+
+size_t qssc::Linker::getNumBinaries() const {
+  return impl->binder->getNumBinaries();
+}
@@ -1,6 +1,6 @@
 //===- errors.cpp  - Error reporting API ------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -27,16 +27,20 @@
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Operation.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <utility>
+#include <vector>
 
 namespace {
 
@@ -119,6 +123,20 @@ llvm::StringRef getSeverityAsString(qssc::Severity sev) {
   llvm_unreachable("unhandled severity");
 }
 
+qssc::Severity getQSSCSeverity(mlir::DiagnosticSeverity severity) {
+  switch (severity) {
+  case mlir::DiagnosticSeverity::Error:
+    return qssc::Severity::Error;
+  case mlir::DiagnosticSeverity::Warning:
+    return qssc::Severity::Warning;
+  case mlir::DiagnosticSeverity::Note:
+  case mlir::DiagnosticSeverity::Remark:
+    return qssc::Severity::Info;
+  }
+
+  llvm_unreachable("unhandled severity");
+}
+
 } // anonymous namespace
 
 namespace qssc {
@@ -150,6 +168,109 @@ llvm::Error emitDiagnostic(const OptDiagnosticCallback &onDiagnostic,
   return emitDiagnostic(onDiagnostic, diag, ec);
 }
 
+DiagnosticAggregator::DiagnosticAggregator(
+    OptDiagnosticCallback onDiagnostic,
+    std::optional<unsigned int> repeatLimit,
+    std::optional<unsigned int> maxDiagnostics)
+    : onDiagnostic(std::move(onDiagnostic)), repeatLimit(repeatLimit),
+      maxDiagnostics(maxDiagnostics) {}
+
+bool DiagnosticAggregator::admit(
+    Severity severity, ErrorCategory category, llvm::StringRef messageTemplate,
+    llvm::function_ref<std::string()> getLocation) {
+  if (!isLimited())
+    return true;
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto [it, inserted] = templates.try_emplace(
+      TemplateKey{severity, category, messageTemplate.str()},
+      Template{templates.size()});
+  Template &tmpl = it->second;
+
+  bool const repeated = repeatLimit && tmpl.numDelivered >= *repeatLimit;
+  // errors are never dropped by the cap, as they explain the failure
+  bool const capped = maxDiagnostics && numDelivered >= *maxDiagnostics &&
+                      severity < Severity::Error;
+  if (!repeated && !capped) {
+    ++tmpl.numDelivered;
+    ++numDelivered;
+    return true;
+  }
+
+  if (repeated) {
+    ++tmpl.numSuppressed;
+    if (getLocation && tmpl.sampleLocations.size() < 3)
+      tmpl.sampleLocations.push_back(getLocation());
+  } else {
+    ++numCapped;
+    cappedSeverity = std::max(cappedSeverity, severity);
+  }
+  return false;
+}
+
+void DiagnosticAggregator::deliver(const Diagnostic &diag) {
+  if (!onDiagnostic.has_value())
+    return;
+  const std::lock_guard<std::mutex> lock(mutex);
+  onDiagnostic.value()(diag);
+}
+
+void DiagnosticAggregator::emit(const Diagnostic &diag) {
+  if (admit(diag.severity, diag.category, diag.message))
+    deliver(diag);
+}
+
+OptDiagnosticCallback DiagnosticAggregator::getCallback() {
+  if (!isLimited())
+    return onDiagnostic;
+  return DiagnosticCallback([this](const Diagnostic &diag) { emit(diag); });
+}
+
+void DiagnosticAggregator::flush() {
+  std::vector<Diagnostic> summaries;
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<const TemplateKey *, Template *>> suppressed;
+    for (auto &[key, tmpl] : templates)
+      if (tmpl.numSuppressed != 0)
+        suppressed.emplace_back(&key, &tmpl);
+    // summarize in order of the first occurrences
+    llvm::sort(suppressed, [](const auto &a, const auto &b) {
+      return a.second->index < b.second->index;
+    });
+
+    for (auto &[key, tmpl] : suppressed) {
+      auto &[severity, category, messageTemplate] = *key;
+      std::string message;
+      llvm::raw_string_ostream ostream(message);
+      ostream << "\"" << llvm::StringRef(messageTemplate).rtrim() << "\" "
+              << "occurred " << tmpl->numSuppressed << " more time"
+              << (tmpl->numSuppressed == 1 ? "" : "s");
+      if (!tmpl->sampleLocations.empty()) {
+        ostream << ", e.g. at ";
+        llvm::interleaveComma(tmpl->sampleLocations, ostream);
+      }
+      ostream << "\n";
+      summaries.emplace_back(severity, category, std::move(message));
+      tmpl->numSuppressed = 0;
+      tmpl->sampleLocations.clear();
+    }
+
+    if (numCapped != 0) {
+      summaries.emplace_back(cappedSeverity, ErrorCategory::UncategorizedError,
+                             std::to_string(numCapped) +
+                                 " more diagnostics were suppressed after " +
+                                 std::to_string(numDelivered) +
+                                 " were emitted\n");
+      numCapped = 0;
+      cappedSeverity = Severity::Info;
+    }
+  }
+
+  for (auto &summary : summaries)
+    deliver(summary);
+}
+
 std::string ErrorCategoryAttrName = "QSSCErrorCategory";
 
 static std::optional<ErrorCategory>
@@ -263,9 +384,10 @@ mlir::InFlightDiagnostic emitWarning(mlir::Operation *op,
 
 QSSCMLIRDiagnosticHandler::QSSCMLIRDiagnosticHandler(
     llvm::SourceMgr &mgr, mlir::MLIRContext *ctx,
-    const OptDiagnosticCallback &diagnosticCb)
+    const OptDiagnosticCallback &diagnosticCb,
+    DiagnosticAggregator *aggregator)
     : mlir::SourceMgrDiagnosticHandler(mgr, ctx, capturedOutputStream),
-      diagnosticCb(diagnosticCb) {
+      diagnosticCb(diagnosticCb), aggregator(aggregator) {
 
   // Replace the source manager handler set through inheritance
   // with our own implementation. This will eventually call the
@@ -274,11 +396,32 @@ QSSCMLIRDiagnosticHandler::QSSCMLIRDiagnosticHandler(
 }
 
 void QSSCMLIRDiagnosticHandler::emitDiagnostic(mlir::Diagnostic &diagnostic) {
+  // Count the diagnostic by its unformatted message before formatting it,
+  // such that suppressed repeats cost little
+  if (aggregator && aggregator->isLimited()) {
+    auto category = lookupErrorCategory(diagnostic).value_or(
+        ErrorCategory::UncategorizedError);
+    auto getLocation = [&]() {
+      std::string location;
+      llvm::raw_string_ostream ostream(location);
+      ostream << diagnostic.getLocation();
+      return location;
+    };
+    if (!aggregator->admit(getQSSCSeverity(diagnostic.getSeverity()), category,
+                           diagnostic.str(), getLocation))
+      return;
+  }
+
   // emit diagnostic cast to void to discard result as it is not needed here
   // Extract message from output stream
   if (auto decoded = decodeQSSCDiagnostic(diagnostic)) {
-    (void)qssc::emitDiagnostic(diagnosticCb, decoded.value());
+    if (aggregator)
+      aggregator->deliver(decoded.value());
+    else
+      (void)qssc::emitDiagnostic(diagnosticCb, decoded.value());
     llvm::errs() << decoded.value().message;
+    if (transcript)
+      transcript->append(decoded.value().message);
     return;
   }
 
@@ -288,25 +431,16 @@ void QSSCMLIRDiagnosticHandler::emitDiagnostic(mlir::Diagnostic &diagnostic) {
   auto filteredDiagnostic = filterQSSCDiagnostic(diagnostic);
   mlir::SourceMgrDiagnosticHandler::emitDiagnostic(filteredDiagnostic);
   llvm::errs() << capturedString;
+  if (transcript)
+    transcript->append(capturedString);
   capturedString.clear();
 }
 
 std::optional<Diagnostic>
 QSSCMLIRDiagnosticHandler::decodeQSSCDiagnostic(mlir::Diagnostic &diagnostic) {
   // map diagnostic severity to qssc severity
-  auto severity = diagnostic.getSeverity();
-  qssc::Severity qsscSeverity = qssc::Severity::Error;
-  switch (severity) {
-  case mlir::DiagnosticSeverity::Error:
-    qsscSeverity = qssc::Severity::Error;
-    break;
-  case mlir::DiagnosticSeverity::Warning:
-    qsscSeverity = qssc::Severity::Warning;
-    break;
-  case mlir::DiagnosticSeverity::Note:
-  case mlir::DiagnosticSeverity::Remark:
-    qsscSeverity = qssc::Severity::Info;
-  }
+  qssc::Severity const qsscSeverity =
+      getQSSCSeverity(diagnostic.getSeverity());
 
   auto errorCategory = lookupErrorCategory(diagnostic);
 
@@ -1,6 +1,6 @@
 //===- Arguments.cpp -------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -21,31 +21,309 @@
 #include "Arguments/Arguments.h"
 #include "API/errors.h"
 #include "Arguments/Signature.h"
+#include "Payload/ParameterTable.h"
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <system_error>
 #include <utility>
+#include <vector>
 
 namespace qssc::arguments {
 
 using namespace payload;
 
+namespace {
+
+// Patch all binaries in place in the payload if both the payload and the
+// target support it. Returns false, without having changed the payload, if
+// not.
+llvm::Expected<bool>
+patchInPlace(qssc::payload::PatchablePayload *payload, Signature &sig,
+             ArgumentSource const &arguments, bool treatWarningsAsErrors,
+             BindArgumentsImplementationFactory &factory,
+             const OptDiagnosticCallback &onDiagnostic) {
+
+  struct InPlaceBinary {
+    llvm::StringRef name;
+    llvm::MutableArrayRef<char> data;
+    std::unique_ptr<BindArgumentsImplementation> impl;
+    std::vector<PatchPoint> const *patchPoints;
+    std::vector<std::optional<ArgumentSlot>> slots;
+  };
+
+  auto const *columns = arguments.getColumns();
+
+  // map every binary before patching any, such that nothing has changed if
+  // one of them can not be patched in place
+  std::vector<InPlaceBinary> binaries;
+  for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
+
+    if (patchPoints.size() == 0) // no patch points
+      continue;
+
+    auto dataOrErr = payload->mapMember(binaryName);
+    if (!dataOrErr) {
+      llvm::consumeError(dataOrErr.takeError());
+      return false;
+    }
+
+    auto impl = std::unique_ptr<BindArgumentsImplementation>(
+        factory.create(*dataOrErr, onDiagnostic));
+    if (!impl)
+      return false;
+    impl->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+    for (auto const &patchPoint : patchPoints) {
+      size_t const size = impl->getPatchSize(patchPoint);
+      if (size == 0 || patchPoint.offset() + size > dataOrErr->size())
+        return false;
+    }
+
+    std::vector<std::optional<ArgumentSlot>> slots;
+    if (columns)
+      slots = resolveArgumentSlots(patchPoints, columns->getLayout());
+
+    binaries.push_back({binaryName, *dataOrErr, std::move(impl), &patchPoints,
+                        std::move(slots)});
+  }
+
+  if (binaries.empty())
+    return false;
+
+  for (auto &binary : binaries) {
+    for (size_t i = 0; i < binary.patchPoints->size(); ++i) {
+      auto const &patchPoint = (*binary.patchPoints)[i];
+      auto const patched = binary.data.slice(
+          patchPoint.offset(), binary.impl->getPatchSize(patchPoint));
+      llvm::SmallVector<char, 16> const previous(patched.begin(),
+                                                 patched.end());
+
+      if (auto err = columns ? binary.impl->patchSlot(patchPoint,
+                                                      binary.slots[i], *columns)
+                             : binary.impl->patch(patchPoint, arguments))
+        return std::move(err);
+
+      if (auto err = payload->updateMappedMember(
+              binary.name, patchPoint.offset(), previous))
+        return std::move(err);
+    }
+  }
+
+  return true;
+}
+
+// a binary read from the payload along with its patch points
+struct BinaryToPatch {
+  PatchablePayload::ContentBuffer *data;
+  std::vector<PatchPoint> const *patchPoints;
+  // the slots of the patch points in slotsLayout, kept across argument sets
+  // with the same layout
+  std::vector<std::optional<ArgumentSlot>> slots;
+  const ArgumentLayout *slotsLayout = nullptr;
+};
+
+llvm::Error patchBinary(BinaryToPatch &binary, ArgumentSource const &arguments,
+                        bool treatWarningsAsErrors,
+                        BindArgumentsImplementationFactory &factory,
+                        const OptDiagnosticCallback &onDiagnostic) {
+  auto impl = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(*binary.data, onDiagnostic));
+  impl->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+  auto const *columns = arguments.getColumns();
+  if (!columns) {
+    for (auto const &patchPoint : *binary.patchPoints)
+      if (auto err = impl->patch(patchPoint, arguments))
+        return err;
+    return llvm::Error::success();
+  }
+
+  if (binary.slotsLayout != &columns->getLayout()) {
+    binary.slots =
+        resolveArgumentSlots(*binary.patchPoints, columns->getLayout());
+    binary.slotsLayout = &columns->getLayout();
+  }
+
+  for (size_t i = 0; i < binary.patchPoints->size(); ++i)
+    if (auto err = impl->patchSlot((*binary.patchPoints)[i], binary.slots[i],
+                                   *columns))
+      return err;
+  return llvm::Error::success();
+}
+
+// Patch the binaries, concurrently on threadPool if given. The binaries are
+// independent of each other, hence only the diagnostics need to be
+// serialized: they are gathered and passed to onDiagnostic on the calling
+// thread in the order of the binaries, as callbacks may not be thread safe.
+llvm::Error patchBinaries(llvm::MutableArrayRef<BinaryToPatch> binaries,
+                          ArgumentSource const &arguments,
+                          bool treatWarningsAsErrors,
+                          BindArgumentsImplementationFactory &factory,
+                          const OptDiagnosticCallback &onDiagnostic,
+                          llvm::ThreadPool *threadPool) {
+  if (threadPool == nullptr || binaries.size() < 2) {
+    for (auto &binary : binaries)
+      if (auto err = patchBinary(binary, arguments, treatWarningsAsErrors,
+                                 factory, onDiagnostic))
+        return err;
+    return llvm::Error::success();
+  }
+
+  std::vector<std::vector<Diagnostic>> diagnostics(binaries.size());
+  // each slot is set once by its task, from the result of patchBinary
+  std::vector<std::optional<llvm::Error>> errors(binaries.size());
+
+  llvm::ThreadPoolTaskGroup tasks(*threadPool);
+  for (size_t i = 0; i < binaries.size(); ++i) {
+    tasks.async([&, i] {
+      OptDiagnosticCallback gatherDiagnostics;
+      if (onDiagnostic.has_value())
+        gatherDiagnostics = [&diagnostics, i](const Diagnostic &diag) {
+          diagnostics[i].push_back(diag);
+        };
+      errors[i].emplace(patchBinary(binaries[i], arguments,
+                                    treatWarningsAsErrors, factory,
+                                    gatherDiagnostics));
+    });
+  }
+  tasks.wait();
+
+  llvm::Error result = llvm::Error::success();
+  for (size_t i = 0; i < binaries.size(); ++i) {
+    if (onDiagnostic.has_value())
+      for (auto const &diag : diagnostics[i])
+        (*onDiagnostic)(diag);
+    if (errors[i])
+      result = llvm::joinErrors(std::move(result), std::move(*errors[i]));
+  }
+  return result;
+}
+
+} // anonymous namespace
+
+ArgumentSlot ArgumentLayout::addParameter(llvm::StringRef name,
+                                          ArgumentKind kind) {
+  auto &count = numSlots[static_cast<size_t>(kind)];
+  auto [pos, inserted] = slots.try_emplace(name, ArgumentSlot{kind, count});
+  if (inserted)
+    ++count;
+  return pos->second;
+}
+
+std::optional<ArgumentSlot>
+ArgumentLayout::lookup(llvm::StringRef name) const {
+  auto pos = slots.find(name);
+  if (pos == slots.end())
+    return std::nullopt;
+  return pos->second;
+}
+
+llvm::Expected<ColumnarArgumentSource>
+ColumnarArgumentSource::create(const ArgumentLayout &layout,
+                               llvm::ArrayRef<double> doubles,
+                               llvm::ArrayRef<int64_t> ints,
+                               llvm::ArrayRef<uint64_t> angles) {
+  auto checkSize = [&](size_t size, ArgumentKind kind,
+                       llvm::StringRef column) -> llvm::Error {
+    if (size == layout.getNumSlots(kind))
+      return llvm::Error::success();
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Expected %u %s arguments but got %zu", layout.getNumSlots(kind),
+        column.str().c_str(), size);
+  };
+
+  if (auto err = checkSize(doubles.size(), ArgumentKind::Double, "double"))
+    return std::move(err);
+  if (auto err = checkSize(ints.size(), ArgumentKind::Int, "int"))
+    return std::move(err);
+  if (auto err = checkSize(angles.size(), ArgumentKind::Angle, "angle"))
+    return std::move(err);
+
+  return ColumnarArgumentSource(layout, doubles, ints, angles);
+}
+
+ArgumentType
+ColumnarArgumentSource::getArgumentValue(llvm::StringRef name) const {
+  auto slot = layout->lookup(name);
+  if (!slot)
+    return std::nullopt;
+  return getValue(*slot);
+}
+
+double ColumnarArgumentSource::getValue(ArgumentSlot slot) const {
+  switch (slot.kind) {
+  case ArgumentKind::Double:
+    return doubles[slot.index];
+  case ArgumentKind::Int:
+    return static_cast<double>(ints[slot.index]);
+  case ArgumentKind::Angle:
+    return std::ldexp(static_cast<double>(angles[slot.index]), -64) * 2 *
+           llvm::numbers::pi;
+  }
+  llvm_unreachable("unknown argument kind");
+}
+
+std::vector<std::optional<ArgumentSlot>>
+resolveArgumentSlots(llvm::ArrayRef<PatchPoint> patchPoints,
+                     const ArgumentLayout &layout) {
+  std::vector<std::optional<ArgumentSlot>> slots;
+  slots.reserve(patchPoints.size());
+  // patch points with the same parameter slot share one lookup by name
+  llvm::DenseMap<uint32_t, std::optional<ArgumentSlot>> byParameterSlot;
+  for (auto const &patchPoint : patchPoints) {
+    auto parameterSlot = patchPoint.parameterSlot();
+    if (!parameterSlot) {
+      slots.push_back(layout.lookup(patchPoint.expression()));
+      continue;
+    }
+    auto [it, inserted] = byParameterSlot.try_emplace(*parameterSlot);
+    if (inserted)
+      it->second = layout.lookup(patchPoint.expression());
+    slots.push_back(it->second);
+  }
+  return slots;
+}
+
 llvm::Error updateParameters(qssc::payload::PatchablePayload *payload,
                              Signature &sig, ArgumentSource const &arguments,
                              bool treatWarningsAsErrors,
                              BindArgumentsImplementationFactory &factory,
-                             const OptDiagnosticCallback &onDiagnostic) {
+                             const OptDiagnosticCallback &onDiagnostic,
+                             llvm::ThreadPool *threadPool) {
 
+  // Patching in place only touches the patched bytes and the checksums of
+  // their members, rather than reading, patching and rewriting the members
+  auto patchedInPlace = patchInPlace(payload, sig, arguments,
+                                     treatWarningsAsErrors, factory,
+                                     onDiagnostic);
+  if (auto err = patchedInPlace.takeError())
+    return err;
+  if (*patchedInPlace)
+    return llvm::Error::success();
+
+  // reading members from the payload is not thread safe
+  std::vector<BinaryToPatch> binaries;
   for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
 
     if (patchPoints.size() == 0) // no patch points
@@ -61,18 +339,11 @@ llvm::Error updateParameters(qssc::payload::PatchablePayload *payload,
                                 toString(std::move(error)));
     }
 
-    auto &binaryData = binaryDataOrErr.get();
-
-    auto binary = std::shared_ptr<BindArgumentsImplementation>(
-        factory.create(binaryData, onDiagnostic));
-    binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
-
-    for (auto const &patchPoint : patchPoints)
-      if (auto err = binary->patch(patchPoint, arguments))
-        return err;
+    binaries.push_back({&binaryDataOrErr.get(), &patchPoints, {}});
   }
 
-  return llvm::Error::success();
+  return patchBinaries(binaries, arguments, treatWarningsAsErrors, factory,
+                       onDiagnostic, threadPool);
 }
 
 llvm::Error bindArguments(llvm::StringRef moduleInput,
@@ -81,63 +352,82 @@ llvm::Error bindArguments(llvm::StringRef moduleInput,
                           bool treatWarningsAsErrors, bool enableInMemoryInput,
                           std::string *inMemoryOutput,
                           BindArgumentsImplementationFactory &factory,
-                          const OptDiagnosticCallback &onDiagnostic) {
+                          const OptDiagnosticCallback &onDiagnostic,
+                          llvm::ThreadPool *threadPool) {
 
   bool const enableInMemoryOutput = payloadOutputPath == "";
 
+  auto binary = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(onDiagnostic));
+  binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
   // placeholder string for data on disk if required
   std::string inputFromDisk;
 
-  if (!enableInMemoryInput) {
-    // compile payload on disk
-    // copy to link payload if not returning in memory
-    // load from disk into string if returning in memory
-    if (!enableInMemoryOutput) {
-      std::error_code const copyError =
-          llvm::sys::fs::copy_file(moduleInput, payloadOutputPath);
-      if (copyError)
-        return llvm::make_error<llvm::StringError>(
-            "Failed to copy circuit module to payload", copyError);
-    } else {
-      // read from disk to process in memory
-      std::ostringstream buf;
-      std::ifstream const input(moduleInput.str().c_str());
-      buf << input.rdbuf();
-      inputFromDisk = buf.str();
-      moduleInput = inputFromDisk;
-      enableInMemoryInput = true;
+  std::unique_ptr<PatchablePayload> payload;
+  if (!enableInMemoryOutput) {
+    // Payloads that support it are patched from the input and write the
+    // linked payload once, rather than copying the input to the output
+    // first and patching the copy
+    payload.reset(binary->getPayload(moduleInput, enableInMemoryInput));
+    if (auto err = payload->setOutputPath(payloadOutputPath)) {
+      llvm::consumeError(std::move(err));
+      payload.reset();
     }
   }
 
-  if (!enableInMemoryOutput && enableInMemoryInput) {
-    // if payload in memory but returning on disk
-    // copy to disk and process from there
-    std::ofstream payload;
-    payload.open(payloadOutputPath.str(), std::ios::binary);
-    payload.write(moduleInput.str().c_str(), moduleInput.str().length());
-    payload.close();
-    enableInMemoryInput = false;
-  }
+  bool const writeToOutputPath = payload != nullptr;
+  if (!writeToOutputPath) {
+    if (!enableInMemoryInput) {
+      // compile payload on disk
+      // copy to link payload if not returning in memory
+      // load from disk into string if returning in memory
+      if (!enableInMemoryOutput) {
+        std::error_code const copyError =
+            llvm::sys::fs::copy_file(moduleInput, payloadOutputPath);
+        if (copyError)
+          return llvm::make_error<llvm::StringError>(
+              "Failed to copy circuit module to payload", copyError);
+      } else {
+        // read from disk to process in memory
+        std::ostringstream buf;
+        std::ifstream const input(moduleInput.str().c_str());
+        buf << input.rdbuf();
+        inputFromDisk = buf.str();
+        moduleInput = inputFromDisk;
+        enableInMemoryInput = true;
+      }
+    }
 
-  llvm::StringRef const payloadData =
-      (enableInMemoryInput) ? moduleInput : payloadOutputPath;
+    if (!enableInMemoryOutput && enableInMemoryInput) {
+      // if payload in memory but returning on disk
+      // copy to disk and process from there
+      std::ofstream payloadFile;
+      payloadFile.open(payloadOutputPath.str(), std::ios::binary);
+      payloadFile.write(moduleInput.str().c_str(), moduleInput.str().length());
+      payloadFile.close();
+      enableInMemoryInput = false;
+    }
 
-  auto binary = std::unique_ptr<BindArgumentsImplementation>(
-      factory.create(onDiagnostic));
-  binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+    llvm::StringRef const payloadData =
+        (enableInMemoryInput) ? moduleInput : payloadOutputPath;
 
-  auto payload = std::unique_ptr<PatchablePayload>(
-      binary->getPayload(payloadData, enableInMemoryInput));
+    payload.reset(binary->getPayload(payloadData, enableInMemoryInput));
+  }
 
   auto sigOrError = binary->parseSignature(payload.get());
   if (auto err = sigOrError.takeError())
     return err;
 
-  if (auto err = updateParameters(payload.get(), sigOrError.get(), arguments,
-                                  treatWarningsAsErrors, factory, onDiagnostic))
+  if (auto err =
+          updateParameters(payload.get(), sigOrError.get(), arguments,
+                           treatWarningsAsErrors, factory, onDiagnostic,
+                           threadPool))
     return err;
 
   // setup linked payload I/O
+  // if writeToOutputPath is true:
+  //    writeBack writes the linked payload to payloadOutputPath
   // if enableInMemoryOutput is true:
   //    write to string
   // if enableInMemoryInput is true:
@@ -148,6 +438,8 @@ llvm::Error bindArguments(llvm::StringRef moduleInput,
   //    payload was on disk originally use writeBack
   if (auto err = payload->writeBack())
     return err;
+  if (writeToOutputPath)
+    return llvm::Error::success();
   if (enableInMemoryOutput || enableInMemoryInput) {
     if (auto err = payload->writeString(inMemoryOutput))
       return err;
@@ -164,4 +456,376 @@ llvm::Error bindArguments(llvm::StringRef moduleInput,
   return llvm::Error::success();
 }
 
+llvm::Error bindArgumentsBatch(
+    llvm::StringRef moduleInput, bool enableInMemoryInput,
+    llvm::ArrayRef<const ArgumentSource *> argumentSets,
+    bool treatWarningsAsErrors, std::vector<std::string> &outputs,
+    BindArgumentsImplementationFactory &factory,
+    const OptDiagnosticCallback &onDiagnostic, llvm::ThreadPool *threadPool) {
+
+  outputs.clear();
+  outputs.resize(argumentSets.size());
+
+  auto binary = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(onDiagnostic));
+  binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+  // the input is only ever read, so it can be used in place regardless of
+  // whether it is in memory or on disk
+  auto payload = std::unique_ptr<PatchablePayload>(
+      binary->getPayload(moduleInput, enableInMemoryInput));
+
+  auto sigOrError = binary->parseSignature(payload.get());
+  if (auto err = sigOrError.takeError())
+    return err;
+  auto &sig = sigOrError.get();
+
+  // read every binary with patch points once and keep its unpatched contents
+  // to restore it before binding the next argument set
+  std::vector<BinaryToPatch> binaries;
+  std::vector<PatchablePayload::ContentBuffer> originals;
+  for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
+
+    if (patchPoints.size() == 0) // no patch points
+      continue;
+
+    auto binaryDataOrErr = payload->readMember(binaryName);
+
+    if (!binaryDataOrErr) {
+      auto error = binaryDataOrErr.takeError();
+      return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                            qssc::ErrorCategory::QSSLinkSignatureError,
+                            "Error reading " + binaryName + " " +
+                                toString(std::move(error)));
+    }
+
+    auto &binaryData = binaryDataOrErr.get();
+    binaries.push_back({&binaryData, &patchPoints, {}});
+    originals.push_back(binaryData);
+  }
+
+  for (size_t i = 0; i < argumentSets.size(); ++i) {
+    // assignment reuses the storage of the previously patched contents
+    for (size_t b = 0; b < binaries.size(); ++b)
+      *binaries[b].data = originals[b];
+
+    if (auto err = patchBinaries(binaries, *argumentSets[i],
+                                 treatWarningsAsErrors, factory, onDiagnostic,
+                                 threadPool))
+      return err;
+
+    if (auto err = payload->writeCopy(&outputs[i]))
+      return err;
+  }
+
+  return llvm::Error::success();
+}
+
+llvm::Error bindSweepArguments(llvm::StringRef moduleInput,
+                               bool enableInMemoryInput,
+                               llvm::ArrayRef<const ArgumentSource *> points,
+                               std::string *output,
+                               BindArgumentsImplementationFactory &factory,
+                               const OptDiagnosticCallback &onDiagnostic) {
+
+  auto binary = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(onDiagnostic));
+  auto payload = std::unique_ptr<PatchablePayload>(
+      binary->getPayload(moduleInput, enableInMemoryInput));
+
+  auto tableDataOrErr =
+      payload->readMember(qssc::payload::parameterTableFileName);
+  if (!tableDataOrErr)
+    return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                          qssc::ErrorCategory::QSSLinkSignatureError,
+                          "Payload has no parameter table, it was not "
+                          "compiled for a sweep: " +
+                              toString(tableDataOrErr.takeError()));
+  auto tableOrErr =
+      qssc::payload::ParameterTableView::create(tableDataOrErr.get());
+  if (!tableOrErr)
+    return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                          qssc::ErrorCategory::QSSLinkSignatureError,
+                          toString(tableOrErr.takeError()));
+  auto &table = tableOrErr.get();
+
+  if (points.size() != table.getNumPoints())
+    return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                          qssc::ErrorCategory::QSSLinkSignatureError,
+                          "The sweep has " +
+                              std::to_string(table.getNumPoints()) +
+                              " points but " + std::to_string(points.size()) +
+                              " argument sets were given");
+
+  // the parameters without an argument keep their initial values
+  for (uint32_t parameter = 0; parameter < table.getNumParameters();
+       ++parameter) {
+    auto name = table.getParameterName(parameter);
+    for (uint32_t point = 0; point < table.getNumPoints(); ++point) {
+      auto argument = points[point]->getArgumentValue(name);
+      auto value = std::get<std::optional<double>>(argument);
+      if (value)
+        table.setValue(point, parameter, *value);
+    }
+  }
+
+  if (auto err = payload->writeBack())
+    return err;
+  if (output)
+    return payload->writeString(output);
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::unique_ptr<IncrementalBinder>>
+IncrementalBinder::create(llvm::StringRef moduleInput, bool enableInMemoryInput,
+                          bool treatWarningsAsErrors,
+                          BindArgumentsImplementationFactory &factory,
+                          const OptDiagnosticCallback &onDiagnostic) {
+  auto binder = std::unique_ptr<IncrementalBinder>(new IncrementalBinder());
+
+  // the payload refers to its input, which has to outlive the binder
+  binder->input = moduleInput.str();
+
+  binder->payloadImpl = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(onDiagnostic));
+  binder->payloadImpl->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+  binder->payload = std::unique_ptr<PatchablePayload>(
+      binder->payloadImpl->getPayload(binder->input, enableInMemoryInput));
+
+  auto sigOrError = binder->payloadImpl->parseSignature(binder->payload.get());
+  if (auto err = sigOrError.takeError())
+    return std::move(err);
+  binder->sig = std::move(sigOrError.get());
+
+  // the members are read once and patched in memory by every bind, each by
+  // an implementation which lives as long as the binder
+  auto const &sig = binder->sig;
+  for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
+
+    if (patchPoints.size() == 0) // no patch points
+      continue;
+
+    auto binaryDataOrErr = binder->payload->readMember(binaryName);
+
+    if (!binaryDataOrErr) {
+      auto error = binaryDataOrErr.takeError();
+      return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                            qssc::ErrorCategory::QSSLinkSignatureError,
+                            "Error reading " + binaryName + " " +
+                                toString(std::move(error)));
+    }
+
+    auto impl = std::unique_ptr<BindArgumentsImplementation>(
+        factory.create(binaryDataOrErr.get(), onDiagnostic));
+    impl->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+    binder->binaries.push_back({binaryName,
+                                &binaryDataOrErr.get(),
+                                std::move(impl),
+                                &patchPoints,
+                                {},
+                                nullptr});
+  }
+
+  return std::move(binder);
+}
+
+llvm::Error IncrementalBinder::bind(ArgumentSource const &arguments,
+                                    std::string *output,
+                                    std::vector<PatchedRange> *changes) {
+  numPatched = 0;
+  if (changes)
+    changes->clear();
+
+  // the arguments of the expressions patched by this bind
+  llvm::StringMap<ArgumentType> current;
+  if (auto err = bind_(arguments, current, changes)) {
+    // some patch points may have been patched, hence none of the previous
+    // arguments is known to be in the binaries anymore
+    previous.clear();
+    return err;
+  }
+
+  for (auto &entry : current)
+    previous.insert_or_assign(entry.getKey(), std::move(entry.getValue()));
+
+  if (output) {
+    output->clear();
+    if (auto err = payload->writeCopy(output))
+      return err;
+  }
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::unique_ptr<BatchBinder>>
+BatchBinder::create(llvm::StringRef moduleInput, bool enableInMemoryInput,
+                    bool treatWarningsAsErrors,
+                    BindArgumentsImplementationFactory &factory,
+                    const OptDiagnosticCallback &onDiagnostic) {
+  auto binder = std::unique_ptr<BatchBinder>(
+      new BatchBinder(factory, treatWarningsAsErrors));
+
+  // the payload refers to its input, which has to outlive the binder
+  binder->input = moduleInput.str();
+
+  binder->payloadImpl = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(onDiagnostic));
+  binder->payloadImpl->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+  binder->payload = std::unique_ptr<PatchablePayload>(
+      binder->payloadImpl->getPayload(binder->input, enableInMemoryInput));
+
+  auto sigOrError = binder->payloadImpl->parseSignature(binder->payload.get());
+  if (auto err = sigOrError.takeError())
+    return std::move(err);
+  binder->sig = std::move(sigOrError.get());
+
+  auto const &sig = binder->sig;
+  for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
+
+    if (patchPoints.size() == 0) // no patch points
+      continue;
+
+    auto binaryDataOrErr = binder->payload->readMember(binaryName);
+
+    if (!binaryDataOrErr) {
+      auto error = binaryDataOrErr.takeError();
+      return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                            qssc::ErrorCategory::QSSLinkSignatureError,
+                            "Error reading " + binaryName + " " +
+                                toString(std::move(error)));
+    }
+
+    binder->binaries.push_back({&binaryDataOrErr.get(), &patchPoints});
+  }
+
+  // every other member is written to the outputs as it is
+  if (auto err = binder->payload->prepareCopies())
+    return std::move(err);
+
+  return std::move(binder);
+}
+
+llvm::Error
+BatchBinder::bind(llvm::ArrayRef<const ArgumentSource *> argumentSets,
+                  std::vector<std::string> &outputs,
+                  const OptDiagnosticCallback &onDiagnostic,
+                  llvm::ThreadPool *threadPool) const {
+  outputs.clear();
+  outputs.resize(argumentSets.size());
+
+  if (threadPool == nullptr || argumentSets.size() < 2) {
+    for (size_t i = 0; i < argumentSets.size(); ++i)
+      if (auto err = bind_(*argumentSets[i], outputs[i], onDiagnostic))
+        return err;
+    return llvm::Error::success();
+  }
+
+  // as in patchBinaries, the diagnostics are gathered per argument set and
+  // passed on once all argument sets are bound
+  std::vector<std::vector<Diagnostic>> diagnostics(argumentSets.size());
+  std::vector<llvm::Error> errors;
+  errors.reserve(argumentSets.size());
+  for (size_t i = 0; i < argumentSets.size(); ++i)
+    errors.push_back(llvm::Error::success());
+
+  llvm::ThreadPoolTaskGroup tasks(*threadPool);
+  for (size_t i = 0; i < argumentSets.size(); ++i) {
+    tasks.async([&, i] {
+      OptDiagnosticCallback gatherDiagnostics;
+      if (onDiagnostic.has_value())
+        gatherDiagnostics = [&diagnostics, i](const Diagnostic &diag) {
+          diagnostics[i].push_back(diag);
+        };
+      errors[i] = llvm::joinErrors(
+          std::move(errors[i]),
+          bind_(*argumentSets[i], outputs[i], gatherDiagnostics));
+    });
+  }
+  tasks.wait();
+
+  llvm::Error result = llvm::Error::success();
+  for (size_t i = 0; i < argumentSets.size(); ++i) {
+    if (onDiagnostic.has_value())
+      for (auto const &diag : diagnostics[i])
+        (*onDiagnostic)(diag);
+    result = llvm::joinErrors(std::move(result), std::move(errors[i]));
+  }
+  return result;
+}
+
+llvm::Error
+BatchBinder::bind_(ArgumentSource const &arguments, std::string &output,
+                   const OptDiagnosticCallback &onDiagnostic) const {
+  // the patched copies of the binaries, which replace them in the output
+  std::vector<PatchablePayload::ContentBuffer> patched;
+  patched.reserve(binaries.size());
+  llvm::SmallVector<PatchablePayload::MemberReplacement> replacements;
+  replacements.reserve(binaries.size());
+  for (auto const &binary : binaries) {
+    auto &data = patched.emplace_back(*binary.data);
+    BinaryToPatch toPatch{&data, binary.patchPoints, {}};
+    if (auto err = patchBinary(toPatch, arguments, treatWarningsAsErrors,
+                               factory, onDiagnostic))
+      return err;
+    replacements.push_back(
+        {binary.data, llvm::StringRef(data.data(), data.size())});
+  }
+
+  return payload->writeReplacedCopy(&output, replacements);
+}
+
+llvm::Error IncrementalBinder::bind_(ArgumentSource const &arguments,
+                                     llvm::StringMap<ArgumentType> &current,
+                                     std::vector<PatchedRange> *changes) {
+  // the expressions looked up so far and whether their argument changed
+  llvm::StringMap<bool> changed;
+  auto const *columns = arguments.getColumns();
+
+  for (auto &binary : binaries) {
+    if (columns && binary.slotsLayout != &columns->getLayout()) {
+      binary.slots =
+          resolveArgumentSlots(*binary.patchPoints, columns->getLayout());
+      binary.slotsLayout = &columns->getLayout();
+    }
+
+    for (size_t i = 0; i < binary.patchPoints->size(); ++i) {
+      auto const &patchPoint = (*binary.patchPoints)[i];
+
+      auto [pos, inserted] =
+          changed.try_emplace(patchPoint.expression(), false);
+      if (inserted) {
+        auto value = arguments.getArgumentValue(patchPoint.expression());
+        auto last = previous.find(patchPoint.expression());
+        pos->second = last == previous.end() || last->second != value;
+        if (pos->second)
+          current.try_emplace(patchPoint.expression(), std::move(value));
+      }
+      if (!pos->second)
+        continue;
+
+      if (auto err = columns ? binary.impl->patchSlot(patchPoint,
+                                                      binary.slots[i], *columns)
+                             : binary.impl->patch(patchPoint, arguments))
+        return err;
+      ++numPatched;
+
+      if (!changes)
+        continue;
+      size_t const size = binary.impl->getPatchSize(patchPoint);
+      if (size == 0 || patchPoint.offset() + size > binary.data->size())
+        return llvm::createStringError(
+            llvm::inconvertibleErrorCode(),
+            "The size of the patch at offset %llu of %s is unknown",
+            static_cast<unsigned long long>(patchPoint.offset()),
+            binary.name.str().c_str());
+      auto const begin = binary.data->begin() + patchPoint.offset();
+      changes->push_back(
+          {binary.name, patchPoint.offset(), {begin, begin + size}});
+    }
+  }
+  return llvm::Error::success();
+}
+
 } // namespace qssc::arguments
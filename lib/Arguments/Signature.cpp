@@ -1,6 +1,6 @@
 //===- Signature.cpp --------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,34 +23,82 @@
 
 #include "API/errors.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <sys/types.h>
 #include <tuple>
+#include <vector>
 
 namespace qssc::arguments {
 
+Signature::Signature(Signature &&other) noexcept
+    : patchPointsByBinary(std::move(other.patchPointsByBinary)),
+      strings(std::move(other.strings)) {
+  other.patchPointsByBinary.clear();
+}
+
+Signature &Signature::operator=(Signature &&other) noexcept {
+  if (this == &other)
+    return *this;
+  patchPointsByBinary = std::move(other.patchPointsByBinary);
+  strings = std::move(other.strings);
+  other.patchPointsByBinary.clear();
+  return *this;
+}
+
+Signature::StringStorage &Signature::getStrings_() {
+  if (!strings)
+    strings = std::make_shared<StringStorage>();
+  return *strings;
+}
+
 void Signature::addParameterPatchPoint(llvm::StringRef expression,
                                        llvm::StringRef patchType,
                                        llvm::StringRef binaryComponent,
-                                       uint64_t offset) {
+                                       uint64_t offset,
+                                       uint32_t parameterSlot) {
 
-  auto &patchPoints = patchPointsByBinary[binaryComponent.str()];
+  auto &patchPoints = getPatchPoints_(binaryComponent);
 
-  patchPoints.emplace_back(expression, patchType, offset);
+  auto &saver = getStrings_().saver;
+  patchPoints.emplace_back(saver.save(expression), saver.save(patchType),
+                           offset, parameterSlot);
+}
+
+void Signature::reservePatchPoints(llvm::StringRef binaryComponent,
+                                   size_t numPatchPoints) {
+  auto &patchPoints = getPatchPoints_(binaryComponent);
+  patchPoints.reserve(patchPoints.size() + numPatchPoints);
+}
+
+std::vector<PatchPoint> &
+Signature::getPatchPoints_(llvm::StringRef binaryComponent) {
+  auto pos = patchPointsByBinary.find(binaryComponent);
+  if (pos == patchPointsByBinary.end())
+    pos = patchPointsByBinary.emplace(binaryComponent.str(),
+                                      std::vector<PatchPoint>{})
+              .first;
+  return pos->second;
 }
 
 void Signature::addParameterPatchPoint(llvm::StringRef binaryComponent,
                                        const PatchPoint &p) {
 
-  auto &patchPoints = patchPointsByBinary[binaryComponent.str()];
-  patchPoints.push_back(p);
+  addParameterPatchPoint(p.expression(), p.patchType(), binaryComponent,
+                         p.offset(), p.parameterSlot_);
 }
 
 void Signature::dump() {
@@ -63,7 +111,10 @@ void Signature::dump() {
     for (auto const &patchPoint : patchPoints) {
       llvm::errs() << "  param expression " << patchPoint.expression()
                    << " to be patched as " << patchPoint.patchType()
-                   << " at offset " << patchPoint.offset() << "\n";
+                   << " at offset " << patchPoint.offset();
+      if (auto slot = patchPoint.parameterSlot())
+        llvm::errs() << " from parameter slot " << *slot;
+      llvm::errs() << "\n";
     }
   }
 }
@@ -71,25 +122,213 @@ void Signature::dump() {
 std::string Signature::serialize() const {
   std::stringstream s;
   s << "circuit_signature\n";
-  s << "version 1\n";
+  s << "version 2\n";
   s << "num_binaries: " << patchPointsByBinary.size() << "\n";
 
   for (auto const &[binaryName, patchPoints] : patchPointsByBinary) {
     s << "binary: " << binaryName << "\n";
     s << "num_patchpoints: " << patchPoints.size() << "\n";
     for (auto const &patchPoint : patchPoints) {
-      s << patchPoint.patchType().str() << " " << patchPoint.offset() << " "
-        << patchPoint.expression().str() << "\n";
+      s << patchPoint.patchType().str() << " " << patchPoint.offset() << " ";
+      if (auto slot = patchPoint.parameterSlot())
+        s << *slot;
+      else
+        s << "-";
+      s << " " << patchPoint.expression().str() << "\n";
     }
   }
   return s.str();
 }
 
+namespace {
+using SV = SignatureView;
+
+static_assert(sizeof(SV::Header) == 24, "unexpected padding in Header");
+static_assert(sizeof(SV::BinaryRecord) == 16,
+              "unexpected padding in BinaryRecord");
+static_assert(sizeof(SV::PatchPointRecord) == 24,
+              "unexpected padding in PatchPointRecord");
+
+template <typename T>
+void appendRecord(std::string &buffer, const T &record) {
+  buffer.append(reinterpret_cast<const char *>(&record), sizeof(T));
+}
+
+SV::BinaryRecord makeBinaryRecord(uint32_t nameId, uint32_t firstPatchPoint,
+                                  uint32_t numPatchPoints) {
+  SV::BinaryRecord record;
+  record.nameId = nameId;
+  record.firstPatchPoint = firstPatchPoint;
+  record.numPatchPoints = numPatchPoints;
+  record.reserved = 0;
+  return record;
+}
+
+SV::PatchPointRecord makePatchPointRecord(uint32_t expressionId,
+                                          uint32_t patchTypeId, uint64_t offset,
+                                          uint32_t parameterSlot) {
+  SV::PatchPointRecord record;
+  record.expressionId = expressionId;
+  record.patchTypeId = patchTypeId;
+  record.offset = offset;
+  record.parameterSlot = parameterSlot;
+  record.reserved = 0;
+  return record;
+}
+} // anonymous namespace
+
+std::string Signature::serializeBinary() const {
+  // assign each distinct string its offset in the string table
+  std::string stringTable;
+  llvm::StringMap<uint32_t> stringIds;
+  auto getStringId = [&](llvm::StringRef str) -> uint32_t {
+    auto [it, inserted] =
+        stringIds.try_emplace(str, static_cast<uint32_t>(stringTable.size()));
+    if (inserted) {
+      stringTable.append(str.data(), str.size());
+      stringTable.push_back('\0');
+    }
+    return it->second;
+  };
+
+  std::vector<SV::BinaryRecord> binaries;
+  std::vector<SV::PatchPointRecord> patchPoints;
+  binaries.reserve(patchPointsByBinary.size());
+  for (auto const &[binaryName, binaryPatchPoints] : patchPointsByBinary) {
+    binaries.push_back(makeBinaryRecord(
+        getStringId(binaryName), static_cast<uint32_t>(patchPoints.size()),
+        static_cast<uint32_t>(binaryPatchPoints.size())));
+    for (auto const &patchPoint : binaryPatchPoints)
+      patchPoints.push_back(makePatchPointRecord(
+          getStringId(patchPoint.expression()),
+          getStringId(patchPoint.patchType()), patchPoint.offset(),
+          patchPoint.parameterSlot_));
+  }
+
+  SV::Header header;
+  std::memcpy(header.magic, SV::binaryMagic, sizeof(header.magic));
+  header.version = SV::binaryVersion;
+  header.numBinaries = static_cast<uint32_t>(binaries.size());
+  header.numPatchPoints = static_cast<uint32_t>(patchPoints.size());
+  header.stringTableSize = static_cast<uint32_t>(stringTable.size());
+
+  std::string buffer;
+  buffer.reserve(sizeof(SV::Header) +
+                 binaries.size() * sizeof(SV::BinaryRecord) +
+                 patchPoints.size() * sizeof(SV::PatchPointRecord) +
+                 stringTable.size());
+  appendRecord(buffer, header);
+  for (auto const &binary : binaries)
+    appendRecord(buffer, binary);
+  for (auto const &patchPoint : patchPoints)
+    appendRecord(buffer, patchPoint);
+  buffer.append(stringTable);
+  return buffer;
+}
+
+bool SignatureView::isBinarySignature(llvm::StringRef buffer) {
+  return buffer.starts_with(llvm::StringRef(binaryMagic, sizeof(binaryMagic)));
+}
+
+llvm::Expected<SignatureView>
+SignatureView::create(llvm::StringRef buffer,
+                      const qssc::OptDiagnosticCallback &onDiagnostic) {
+  auto invalid = [&](const llvm::Twine &msg) {
+    return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                          qssc::ErrorCategory::QSSLinkSignatureError,
+                          "Invalid binary signature: " + msg.str());
+  };
+
+  if (buffer.size() < sizeof(Header) || !isBinarySignature(buffer))
+    return invalid("missing header");
+
+  const auto *header = reinterpret_cast<const Header *>(buffer.data());
+  if (header->version != binaryVersion)
+    return invalid("unsupported version " +
+                   llvm::Twine(static_cast<uint32_t>(header->version)));
+
+  uint64_t const binariesSize =
+      uint64_t{header->numBinaries} * sizeof(BinaryRecord);
+  uint64_t const patchPointsSize =
+      uint64_t{header->numPatchPoints} * sizeof(PatchPointRecord);
+  uint64_t const expectedSize = sizeof(Header) + binariesSize +
+                                patchPointsSize + header->stringTableSize;
+  if (buffer.size() != expectedSize)
+    return invalid("size " + llvm::Twine(buffer.size()) +
+                   " does not match the expected size " +
+                   llvm::Twine(expectedSize));
+
+  SignatureView view;
+  const char *data = buffer.data() + sizeof(Header);
+  view.binaries = {reinterpret_cast<const BinaryRecord *>(data),
+                   header->numBinaries};
+  data += binariesSize;
+  view.patchPoints = {reinterpret_cast<const PatchPointRecord *>(data),
+                      header->numPatchPoints};
+  data += patchPointsSize;
+  view.stringTable = {data, header->stringTableSize};
+
+  // every string reference must point into the table and the table must be
+  // terminated, hence any reference yields a terminated string
+  if (!view.stringTable.empty() && view.stringTable.back() != '\0')
+    return invalid("unterminated string table");
+  auto const numStrings = view.stringTable.size();
+  for (auto const &binary : view.binaries) {
+    if (binary.nameId >= numStrings)
+      return invalid("binary name out of bounds");
+    if (uint64_t{binary.firstPatchPoint} + binary.numPatchPoints >
+        view.patchPoints.size())
+      return invalid("patch points of " + view.getString(binary.nameId) +
+                     " out of bounds");
+  }
+  for (auto const &patchPoint : view.patchPoints)
+    if (patchPoint.expressionId >= numStrings ||
+        patchPoint.patchTypeId >= numStrings)
+      return invalid("patch point string out of bounds");
+
+  return view;
+}
+
 llvm::Expected<Signature>
 Signature::deserialize(llvm::StringRef buffer,
                        const qssc::OptDiagnosticCallback &onDiagnostic,
                        bool treatWarningsAsErrors) {
 
+  if (!SignatureView::isBinarySignature(buffer))
+    return deserializeText_(buffer, onDiagnostic, treatWarningsAsErrors);
+
+  auto viewOrErr = SignatureView::create(buffer, onDiagnostic);
+  if (auto err = viewOrErr.takeError())
+    return std::move(err);
+  auto &view = viewOrErr.get();
+
+  // intern each distinct string once rather than once per patch point
+  Signature sig;
+  llvm::DenseMap<uint32_t, llvm::StringRef> interned;
+  auto intern = [&](uint32_t id) {
+    auto [it, inserted] = interned.try_emplace(id);
+    if (inserted)
+      it->second = sig.getStrings_().saver.save(view.getString(id));
+    return it->second;
+  };
+
+  for (size_t binary = 0; binary < view.getNumBinaries(); ++binary) {
+    auto records = view.getPatchPoints(binary);
+    auto &patchPoints = sig.getPatchPoints_(view.getBinaryName(binary));
+    patchPoints.reserve(records.size());
+    for (auto const &record : records)
+      patchPoints.emplace_back(intern(record.expressionId),
+                               intern(record.patchTypeId), record.offset,
+                               record.parameterSlot);
+  }
+  return sig;
+}
+
+llvm::Expected<Signature>
+Signature::deserializeText_(llvm::StringRef buffer,
+                            const qssc::OptDiagnosticCallback &onDiagnostic,
+                            bool treatWarningsAsErrors) {
+
   Signature sig;
 
   llvm::StringRef line;
@@ -101,8 +340,10 @@ Signature::deserialize(llvm::StringRef buffer,
                           "Invalid Signature header");
   }
 
+  // version 2 adds the parameter slot to each patch point
   std::tie(line, buffer) = buffer.split("\n");
-  if (line != "version 1") {
+  bool const hasParameterSlots = line == "version 2";
+  if (line != "version 1" && !hasParameterSlots) {
     return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
                           qssc::ErrorCategory::QSSLinkSignatureError,
                           "Invalid Signature version: " + line.str());
@@ -151,11 +392,16 @@ Signature::deserialize(llvm::StringRef buffer,
                             "Failed to parse number of entries to integer: " +
                                 value.str());
     }
+    // every entry takes at least 6 bytes ("t 0 e\n"), which bounds the
+    // reservation for a corrupt count
+    sig.reservePatchPoints(binaryName,
+                           std::min<size_t>(numEntries, buffer.size() / 6));
     for (uint nEntry = 0; nEntry < numEntries; nEntry++) {
       std::tie(line, buffer) = buffer.split("\n");
-      llvm::SmallVector<llvm::StringRef, 3> components;
-      line.split(components, ' ', 2, false);
-      if (components.size() != 3) {
+      unsigned const numComponents = hasParameterSlots ? 4 : 3;
+      llvm::SmallVector<llvm::StringRef, 4> components;
+      line.split(components, ' ', numComponents - 1, false);
+      if (components.size() != numComponents) {
         return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
                               qssc::ErrorCategory::QSSLinkSignatureError,
                               "Invalid argument entry line: " + line.str());
@@ -168,10 +414,21 @@ Signature::deserialize(llvm::StringRef buffer,
                                   components[1].str());
       }
 
+      uint32_t parameterSlot = PatchPoint::noParameterSlot;
+      if (hasParameterSlots && components[2] != "-" &&
+          (components[2].getAsInteger(10, parameterSlot) ||
+           parameterSlot == PatchPoint::noParameterSlot)) {
+        return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                              qssc::ErrorCategory::QSSLinkSignatureError,
+                              "Failed to interpret parameter slot " +
+                                  components[2].str());
+      }
+
       auto paramPatchType = components[0];
-      auto expression = components[2];
+      auto expression = components.back();
 
-      sig.addParameterPatchPoint(expression, paramPatchType, binaryName, addr);
+      sig.addParameterPatchPoint(expression, paramPatchType, binaryName, addr,
+                                 parameterSlot);
     }
   }
 
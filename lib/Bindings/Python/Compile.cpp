@@ -0,0 +1,95 @@
+//===- Compile.cpp - Module compilation python bindings ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the python bindings for compiling modules built with
+///  the MLIR python bindings in memory
+///
+//===----------------------------------------------------------------------===//
+
+#include "qss-c/Compile.h"
+
+#include "mlir-c/IR.h"
+#include "mlir-c/Support.h"
+// NOLINTNEXTLINE(misc-include-cleaner)
+#include "mlir/Bindings/Python/PybindAdaptors.h"
+
+#include "pybind11/cast.h"
+#include "pybind11/detail/common.h"
+#include "pybind11/pybind11.h"
+#include "pybind11/pytypes.h"
+#include "pybind11/stl.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+PYBIND11_MODULE(_qeCompile, m) {
+  m.doc() = "Compile modules built in memory with the qss-compiler.";
+
+  m.def(
+      "_compile_module",
+      [](MlirModule module, const std::vector<std::string> &args,
+         std::optional<py::function> onDiagnostic) {
+        std::vector<MlirStringRef> argRefs;
+        argRefs.reserve(args.size());
+        for (const auto &arg : args)
+          argRefs.push_back(mlirStringRefCreate(arg.data(), arg.size()));
+
+        std::string output;
+        auto appendOutput = [](MlirStringRef piece, void *userData) {
+          static_cast<std::string *>(userData)->append(piece.data,
+                                                       piece.length);
+        };
+        // diagnostics are passed to Python as they are emitted, exceptions
+        // of the callback are deferred until the compilation returns
+        struct DiagnosticState {
+          std::optional<py::function> &callback;
+          std::optional<py::error_already_set> error;
+        } diagnosticState{onDiagnostic, std::nullopt};
+        auto emitDiagnostic = [](int32_t severity, int32_t category,
+                                 MlirStringRef message, void *userData) {
+          auto &state = *static_cast<DiagnosticState *>(userData);
+          if (state.error.has_value())
+            return;
+          try {
+            (*state.callback)(severity, category,
+                              py::str(message.data, message.length));
+          } catch (py::error_already_set &error) {
+            state.error = std::move(error);
+          }
+        };
+
+        QsscDiagnosticCallback diagnosticCallback = nullptr;
+        if (onDiagnostic.has_value())
+          diagnosticCallback = emitDiagnostic;
+
+        MlirLogicalResult const result = qsscCompileModule(
+            module, static_cast<intptr_t>(argRefs.size()), argRefs.data(),
+            appendOutput, &output, diagnosticCallback, &diagnosticState);
+        if (diagnosticState.error.has_value())
+          throw std::move(*diagnosticState.error);
+        return py::make_tuple(mlirLogicalResultIsSuccess(result),
+                              py::bytes(output));
+      },
+      "Compile the module in place as configured by the command line options "
+      "args. Returns a (success, output) tuple and passes each diagnostic as "
+      "(severity, category, message) to on_diagnostic.",
+      py::arg("module"), py::arg("args"),
+      py::arg("on_diagnostic") = py::none());
+}
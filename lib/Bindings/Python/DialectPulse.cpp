@@ -21,13 +21,21 @@
 #include "qss-c/Dialect/Pulse.h"
 
 #include "mlir-c/IR.h"
+#include "mlir-c/Support.h"
 // NOLINTNEXTLINE(misc-include-cleaner)
 #include "mlir/Bindings/Python/PybindAdaptors.h"
 
 #include "pybind11/cast.h"
 #include "pybind11/detail/common.h"
+#include "pybind11/numpy.h"
 #include "pybind11/pybind11.h"
 #include "pybind11/pytypes.h"
+#include "pybind11/stl.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace py = pybind11;
 using namespace llvm;
@@ -35,6 +43,38 @@ using namespace mlir;
 using namespace mlir::python;
 using namespace mlir::python::adaptors;
 
+namespace {
+// indices, durations and timepoints are accepted from any array like object
+// and converted at most once, never element by element
+using Int64Array =
+    py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
+
+// the blockIndex-th block of the regionIndex-th region of owner
+MlirBlock getBlock(MlirOperation owner, intptr_t regionIndex,
+                   intptr_t blockIndex) {
+  if (regionIndex < 0 || regionIndex >= mlirOperationGetNumRegions(owner))
+    throw py::index_error("region index out of range");
+  MlirBlock block =
+      mlirRegionGetFirstBlock(mlirOperationGetRegion(owner, regionIndex));
+  for (; blockIndex > 0 && !mlirBlockIsNull(block); --blockIndex)
+    block = mlirBlockGetNextInRegion(block);
+  if (blockIndex < 0 || mlirBlockIsNull(block))
+    throw py::index_error("block index out of range");
+  return block;
+}
+
+void checkSize(const Int64Array &array, py::ssize_t size, const char *name) {
+  if (array.ndim() != 1 || array.size() != size)
+    throw py::value_error(std::string(name) +
+                          " must be one dimensional and of the size of "
+                          "frame_indices");
+}
+
+MlirOperation getInsertBefore(const std::optional<MlirOperation> &op) {
+  return op.has_value() ? *op : MlirOperation{nullptr};
+}
+} // anonymous namespace
+
 void populateDialectPulseSubmodule(const pybind11::module &m) {
   //===-------------------------------------------------------------------===//
   // CaptureType
@@ -116,6 +156,65 @@ void populateDialectPulseSubmodule(const pybind11::module &m) {
       },
       "Get an instance of WaveformType in given context.", py::arg("cls"),
       py::arg("context") = py::none());
+
+  //===-------------------------------------------------------------------===//
+  // Bulk op builders
+  //===-------------------------------------------------------------------===//
+
+  m.def(
+      "_insert_play_ops",
+      [](MlirOperation owner, intptr_t regionIndex, intptr_t blockIndex,
+         std::optional<MlirOperation> insertBefore,
+         const std::vector<MlirValue> &frames,
+         const std::vector<MlirValue> &waveforms,
+         const Int64Array &frameIndices, const Int64Array &waveformIndices,
+         const std::optional<Int64Array> &timepoints, MlirLocation loc) {
+        checkSize(frameIndices, frameIndices.size(), "frame_indices");
+        checkSize(waveformIndices, frameIndices.size(), "waveform_indices");
+        if (timepoints.has_value())
+          checkSize(*timepoints, frameIndices.size(), "timepoints");
+        MlirBlock const block = getBlock(owner, regionIndex, blockIndex);
+        if (mlirLogicalResultIsFailure(pulseInsertPlayOps(
+                block, getInsertBefore(insertBefore), loc,
+                static_cast<intptr_t>(frames.size()), frames.data(),
+                static_cast<intptr_t>(waveforms.size()), waveforms.data(),
+                frameIndices.size(), frameIndices.data(),
+                waveformIndices.data(),
+                timepoints.has_value() ? timepoints->data() : nullptr)))
+          throw py::index_error("frame or waveform index out of range");
+      },
+      "Insert a pulse.play op for every element of frame_indices into the "
+      "given block.",
+      py::arg("owner"), py::arg("region_index"), py::arg("block_index"),
+      py::arg("insert_before"), py::arg("frames"), py::arg("waveforms"),
+      py::arg("frame_indices"), py::arg("waveform_indices"),
+      py::arg("timepoints") = py::none(), py::arg("loc") = py::none());
+
+  m.def(
+      "_insert_delay_ops",
+      [](MlirOperation owner, intptr_t regionIndex, intptr_t blockIndex,
+         std::optional<MlirOperation> insertBefore,
+         const std::vector<MlirValue> &frames, const Int64Array &frameIndices,
+         const Int64Array &durations,
+         const std::optional<Int64Array> &timepoints, MlirLocation loc) {
+        checkSize(frameIndices, frameIndices.size(), "frame_indices");
+        checkSize(durations, frameIndices.size(), "durations");
+        if (timepoints.has_value())
+          checkSize(*timepoints, frameIndices.size(), "timepoints");
+        MlirBlock const block = getBlock(owner, regionIndex, blockIndex);
+        if (mlirLogicalResultIsFailure(pulseInsertDelayOps(
+                block, getInsertBefore(insertBefore), loc,
+                static_cast<intptr_t>(frames.size()), frames.data(),
+                frameIndices.size(), frameIndices.data(), durations.data(),
+                timepoints.has_value() ? timepoints->data() : nullptr)))
+          throw py::index_error("frame index out of range");
+      },
+      "Insert a pulse.delay op for every element of frame_indices into the "
+      "given block.",
+      py::arg("owner"), py::arg("region_index"), py::arg("block_index"),
+      py::arg("insert_before"), py::arg("frames"), py::arg("frame_indices"),
+      py::arg("durations"), py::arg("timepoints") = py::none(),
+      py::arg("loc") = py::none());
 }
 
 PYBIND11_MODULE(_qeDialectsPulse, m) {
@@ -0,0 +1,123 @@
+//===- Compile.cpp - Compile modules from C ---------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the c interface for compiling modules built in memory
+///
+//===----------------------------------------------------------------------===//
+
+#include "qss-c/Compile.h"
+
+#include "API/api.h"
+#include "API/errors.h"
+#include "Config/QSSConfig.h"
+
+#include "mlir-c/IR.h"
+#include "mlir-c/Support.h"
+#include "mlir/CAPI/IR.h"
+#include "mlir/CAPI/Support.h"
+#include "mlir/CAPI/Utils.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+// The command line options configuring a compilation are global
+std::mutex compileMutex;
+
+llvm::Error compileModule(mlir::ModuleOp moduleOp,
+                          std::vector<const char *> &argv,
+                          llvm::raw_ostream &outputStream,
+                          qssc::OptDiagnosticCallback diagnosticCb) {
+  mlir::DialectRegistry registry;
+  if (auto err =
+          qssc::registerCommandLineTarget(argv.size(), argv.data(), registry))
+    return err;
+
+  // Restore all options to their defaults such that the values of a previous
+  // compilation do not leak into this one
+  llvm::cl::ResetAllOptionOccurrences();
+  qssc::registerAndParseCLIOptions(argv.size(), argv.data(), "qssc-capi\n",
+                                   registry);
+
+  mlir::DefaultTimingManager tm;
+  mlir::applyDefaultTimingManagerCLOptions(tm);
+  mlir::TimingScope timing = tm.getRootScope();
+
+  auto configResult = qssc::config::buildToolConfig("-", "-");
+  if (auto err = configResult.takeError())
+    return err;
+
+  return qssc::compileModule(outputStream, moduleOp, registry, *configResult,
+                             std::move(diagnosticCb), timing);
+}
+} // anonymous namespace
+
+MlirLogicalResult qsscCompileModule(MlirModule module, intptr_t numArgs,
+                                    MlirStringRef const *args,
+                                    MlirStringCallback outputCallback,
+                                    void *outputUserData,
+                                    QsscDiagnosticCallback diagnosticCallback,
+                                    void *diagnosticUserData) {
+  // argv must be null terminated strings, the first of which is the tool
+  std::vector<std::string> argStorage;
+  argStorage.reserve(numArgs + 1);
+  argStorage.emplace_back("qssc-capi");
+  for (intptr_t i = 0; i < numArgs; ++i)
+    argStorage.push_back(unwrap(args[i]).str());
+  std::vector<const char *> argv;
+  argv.reserve(argStorage.size());
+  for (const auto &arg : argStorage)
+    argv.push_back(arg.c_str());
+
+  auto emit = [&](qssc::Severity severity, qssc::ErrorCategory category,
+                  llvm::StringRef message) {
+    if (diagnosticCallback)
+      diagnosticCallback(static_cast<int32_t>(severity),
+                         static_cast<int32_t>(category), wrap(message),
+                         diagnosticUserData);
+  };
+  qssc::OptDiagnosticCallback diagnosticCb;
+  if (diagnosticCallback)
+    diagnosticCb = [&](const qssc::Diagnostic &diagnostic) {
+      emit(diagnostic.severity, diagnostic.category, diagnostic.message);
+    };
+
+  mlir::detail::CallbackOstream outputStream(outputCallback, outputUserData);
+  llvm::Error err = [&]() {
+    std::lock_guard<std::mutex> const lock(compileMutex);
+    return compileModule(unwrap(module), argv, outputStream,
+                         std::move(diagnosticCb));
+  }();
+  outputStream.flush();
+  if (!err)
+    return mlirLogicalResultSuccess();
+
+  llvm::handleAllErrors(std::move(err), [&](const llvm::ErrorInfoBase &info) {
+    emit(qssc::Severity::Error, qssc::ErrorCategory::QSSCompilerError,
+         info.message());
+  });
+  return mlirLogicalResultFailure();
+}
@@ -21,11 +21,26 @@
 #include "qss-c/Dialect/Pulse.h"
 
 #include "Dialect/Pulse/IR/PulseDialect.h"
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
 #include "Dialect/Pulse/IR/PulseTypes.h"
 
 #include "mlir-c/IR.h"
+#include "mlir-c/Support.h"
 #include "mlir/CAPI/IR.h"
 #include "mlir/CAPI/Registration.h"
+#include "mlir/CAPI/Support.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Value.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+
+#include <cstdint>
 
 using namespace mlir;
 
@@ -102,3 +117,70 @@ bool pulseTypeIsAWaveformType(MlirType type) {
 MlirType pulseWaveformTypeGet(MlirContext ctx) {
   return wrap(pulse::WaveformType::get(unwrap(ctx)));
 }
+
+//===---------------------------------------------------------------------===//
+// Bulk op builders
+//===---------------------------------------------------------------------===//
+
+namespace {
+OpBuilder getInsertionBuilder(MlirBlock block, MlirOperation insertBefore) {
+  if (!mlirOperationIsNull(insertBefore))
+    return OpBuilder(unwrap(insertBefore));
+  return OpBuilder::atBlockEnd(unwrap(block));
+}
+
+bool indicesInRange(intptr_t numOps, int64_t const *indices, intptr_t size) {
+  return llvm::all_of(
+      llvm::ArrayRef<int64_t>(indices, numOps),
+      [&](int64_t index) { return index >= 0 && index < size; });
+}
+} // anonymous namespace
+
+MlirLogicalResult pulseInsertPlayOps(
+    MlirBlock block, MlirOperation insertBefore, MlirLocation location,
+    intptr_t numFrames, MlirValue const *frames, intptr_t numWaveforms,
+    MlirValue const *waveforms, intptr_t numOps, int64_t const *frameIndices,
+    int64_t const *waveformIndices, int64_t const *timepoints) {
+  if (!indicesInRange(numOps, frameIndices, numFrames) ||
+      !indicesInRange(numOps, waveformIndices, numWaveforms))
+    return mlirLogicalResultFailure();
+
+  OpBuilder builder = getInsertionBuilder(block, insertBefore);
+  Location const loc = unwrap(location);
+  for (intptr_t i = 0; i < numOps; ++i) {
+    auto playOp = builder.create<pulse::PlayOp>(
+        loc, unwrap(frames[frameIndices[i]]),
+        unwrap(waveforms[waveformIndices[i]]), FloatAttr(), FloatAttr(),
+        FloatAttr());
+    if (timepoints)
+      pulse::PulseOpSchedulingInterface::setTimepoint(playOp, timepoints[i]);
+  }
+  return mlirLogicalResultSuccess();
+}
+
+MlirLogicalResult pulseInsertDelayOps(
+    MlirBlock block, MlirOperation insertBefore, MlirLocation location,
+    intptr_t numFrames, MlirValue const *frames, intptr_t numOps,
+    int64_t const *frameIndices, int64_t const *durations,
+    int64_t const *timepoints) {
+  if (!indicesInRange(numOps, frameIndices, numFrames))
+    return mlirLogicalResultFailure();
+
+  OpBuilder builder = getInsertionBuilder(block, insertBefore);
+  Location const loc = unwrap(location);
+  // schedules repeat few distinct durations, which are shared by the delays
+  llvm::DenseMap<int64_t, Value> durationConstants;
+  for (intptr_t i = 0; i < numOps; ++i) {
+    auto [it, inserted] = durationConstants.try_emplace(durations[i]);
+    if (inserted)
+      it->second = builder.create<arith::ConstantIntOp>(
+          loc, durations[i], builder.getI32Type());
+  }
+  for (intptr_t i = 0; i < numOps; ++i) {
+    auto delayOp = builder.create<pulse::DelayOp>(
+        loc, unwrap(frames[frameIndices[i]]), durationConstants[durations[i]]);
+    if (timepoints)
+      pulse::PulseOpSchedulingInterface::setTimepoint(delayOp, timepoints[i]);
+  }
+  return mlirLogicalResultSuccess();
+}
@@ -160,6 +160,55 @@ struct QSSConfigCLOptions : public QSSConfig {
         llvm::cl::location(emitPlaintextPayloadFlag), llvm::cl::init(false),
         llvm::cl::cat(qssc::config::getQSSCCLCategory()));
 
+    static llvm::cl::opt<PayloadProfile, /*ExternalStorage=*/true> const
+        payloadProfile_(
+            "payload-profile",
+            llvm::cl::desc("Select the artifacts written into the payload"),
+            llvm::cl::location(payloadProfile),
+            llvm::cl::init(PayloadProfile::Debug),
+            llvm::cl::values(
+                clEnumValN(PayloadProfile::Debug, "debug",
+                           "Also write textual debug artifacts such as the IR "
+                           "of each target (default)"),
+                clEnumValN(PayloadProfile::Production, "production",
+                           "Only write the artifacts required to run the "
+                           "program")),
+            llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<std::string, /*ExternalStorage=*/true> const
+        payloadFormat_(
+            "payload-format",
+            llvm::cl::desc("Select the registered payload written for "
+                           "--emit=qem, e.g., ZIP (default) or FLAT for an "
+                           "uncompressed container of page aligned members"),
+            llvm::cl::location(payloadFormat), llvm::cl::init("ZIP"),
+            llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<std::string> payloadDeltaBase_(
+        "payload-delta-base",
+        llvm::cl::desc("Write a delta payload which leaves out the files "
+                       "unchanged since the payload with the given manifest"),
+        llvm::cl::value_desc("manifest"),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    payloadDeltaBase_.setCallback([&](const std::string &manifestPath) {
+      if (manifestPath != "")
+        payloadDeltaBase = manifestPath;
+    });
+
+    static llvm::cl::opt<double> dtTimestep_(
+        "dt-timestep",
+        llvm::cl::desc("Duration of a scheduling sample with which the "
+                       "runtime of the program recorded in the payload "
+                       "manifest is estimated, 0 if unknown"),
+        llvm::cl::value_desc("seconds"), llvm::cl::init(0.),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    dtTimestep_.setCallback([&](const double &seconds) {
+      if (seconds > 0.)
+        dtTimestep = seconds;
+    });
+
     static llvm::cl::opt<bool, /*ExternalStorage=*/true> const includeSource(
         "include-source",
         llvm::cl::desc("Write the input source into the payload"),
@@ -322,6 +371,162 @@ struct QSSConfigCLOptions : public QSSConfig {
       if (cliMaxThreads > 0)
         maxThreads = cliMaxThreads;
     });
+
+    static llvm::cl::opt<std::string> compileCacheDir_(
+        "compile-cache-dir",
+        llvm::cl::desc("Directory of an on-disk cache of compiler outputs. "
+                       "Identical compilations are served from the cache."),
+        llvm::cl::value_desc("path"), llvm::cl::cat(getQSSCCLCategory()));
+
+    compileCacheDir_.setCallback([&](const std::string &dir) {
+      if (dir != "")
+        compileCacheDir = dir;
+    });
+
+    static llvm::cl::opt<unsigned int, /*ExternalStorage=*/true> const
+        compileCacheEntries_(
+            "compile-cache-entries",
+            llvm::cl::desc("Number of compiler outputs kept in the in-process "
+                           "compilation cache, 0 disables it"),
+            llvm::cl::location(compileCacheEntries), llvm::cl::init(0),
+            llvm::cl::cat(getQSSCCLCategory()));
+
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const
+        compileCacheFrontend_(
+            "compile-cache-frontend",
+            llvm::cl::desc("Also cache the output of the OpenQASM 3 frontend, "
+                           "such that compilations of a program that only "
+                           "differ in the initial values of its input "
+                           "parameters skip parsing"),
+            llvm::cl::location(compileCacheFrontend), llvm::cl::init(false),
+            llvm::cl::cat(getQSSCCLCategory()));
+
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const verifyStages_(
+        "verify-stages",
+        llvm::cl::desc("Verify the module fully only after the frontend, the "
+                       "pass pipeline and the target pass pipelines, and "
+                       "only check its structure after each pass. Overrides "
+                       "-verify-each"),
+        llvm::cl::location(verifyStagesFlag), llvm::cl::init(false),
+        llvm::cl::cat(getQSSCCLCategory()));
+
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const
+        reportPassMemory_(
+            "report-pass-memory",
+            llvm::cl::desc("Report the growth of the peak resident set size "
+                           "and of the heap attributed to each pass and "
+                           "target, most accurate with "
+                           "-mlir-disable-threading"),
+            llvm::cl::location(reportPassMemoryFlag), llvm::cl::init(false),
+            llvm::cl::cat(getQSSCCLCategory()));
+
+    static llvm::cl::opt<std::string> timingTraceFile_(
+        "timing-trace",
+        llvm::cl::desc("Write the compilation timers, with their threads and "
+                       "the target hierarchy, to a file in the Chrome trace "
+                       "event format. Replaces the -mlir-timing report"),
+        llvm::cl::value_desc("filename"), llvm::cl::cat(getQSSCCLCategory()));
+
+    timingTraceFile_.setCallback([&](const std::string &file) {
+      if (file != "")
+        timingTraceFile = file;
+    });
+
+    static llvm::cl::opt<unsigned int> compileDeadline_(
+        "compile-deadline",
+        llvm::cl::desc("Milliseconds after which optional work, e.g. "
+                       "optimizations, is skipped with a warning such that "
+                       "the compilation finishes on time, 0 for none"),
+        llvm::cl::value_desc("ms"), llvm::cl::init(0),
+        llvm::cl::cat(getQSSCCLCategory()));
+
+    compileDeadline_.setCallback([&](const unsigned int &milliseconds) {
+      if (milliseconds > 0)
+        compileDeadline = milliseconds;
+    });
+
+    static llvm::cl::opt<unsigned int> memoryBudget_(
+        "memory-budget",
+        llvm::cl::desc("Peak resident set size in MiB above which optional "
+                       "work is skipped with a warning, 0 for none"),
+        llvm::cl::value_desc("MiB"), llvm::cl::init(0),
+        llvm::cl::cat(getQSSCCLCategory()));
+
+    memoryBudget_.setCallback([&](const unsigned int &mebibytes) {
+      if (mebibytes > 0)
+        memoryBudget = mebibytes;
+    });
+
+    static llvm::cl::opt<unsigned int> diagnosticRepeatLimit_(
+        "diagnostic-repeat-limit",
+        llvm::cl::desc("Number of diagnostics with the same severity, "
+                       "category and message emitted per compilation, the "
+                       "others are summarized with sample locations, 0 for "
+                       "no limit"),
+        llvm::cl::value_desc("count"), llvm::cl::init(0),
+        llvm::cl::cat(getQSSCCLCategory()));
+
+    diagnosticRepeatLimit_.setCallback([&](const unsigned int &limit) {
+      if (limit > 0)
+        diagnosticRepeatLimit = limit;
+    });
+
+    static llvm::cl::opt<unsigned int> maxDiagnostics_(
+        "max-diagnostics",
+        llvm::cl::desc("Number of warnings and remarks emitted per "
+                       "compilation, the others are summarized, 0 for no "
+                       "limit"),
+        llvm::cl::value_desc("count"), llvm::cl::init(0),
+        llvm::cl::cat(getQSSCCLCategory()));
+
+    maxDiagnostics_.setCallback([&](const unsigned int &limit) {
+      if (limit > 0)
+        maxDiagnostics = limit;
+    });
+
+    static llvm::cl::opt<std::string> traceContext_(
+        "trace-context",
+        llvm::cl::desc("Trace context ID of the caller, attached to the "
+                       "timing trace and the compile report to correlate "
+                       "them with the caller's distributed tracing"),
+        llvm::cl::value_desc("id"), llvm::cl::cat(getQSSCCLCategory()));
+
+    traceContext_.setCallback([&](const std::string &id) {
+      if (id != "")
+        traceContext = id;
+    });
+
+    static llvm::cl::opt<ProfilerMarkers> profilerMarkers_(
+        "profiler-markers",
+        llvm::cl::desc("Annotate the compile phases, i.e. the targets, passes "
+                       "and code generation stages, as zones for a sampling "
+                       "profiler. Replaces the -mlir-timing report"),
+        llvm::cl::init(ProfilerMarkers::None),
+        llvm::cl::values(
+            clEnumValN(ProfilerMarkers::None, "none", "No markers (default)"),
+            clEnumValN(ProfilerMarkers::ITT, "itt",
+                       "Intel ITT tasks, e.g. for VTune")),
+        llvm::cl::cat(getQSSCCLCategory()));
+
+    profilerMarkers_.setCallback(
+        [&](const ProfilerMarkers &markers) { profilerMarkers = markers; });
+
+    static llvm::cl::opt<CompilePriority> compilePriority_(
+        "compile-priority",
+        llvm::cl::desc("Priority of the compilation for the thread pool "
+                       "shared by the compilations of the process"),
+        llvm::cl::init(CompilePriority::Normal),
+        llvm::cl::values(
+            clEnumValN(CompilePriority::Low, "low",
+                       "Multithreaded only while no other compilation is"),
+            clEnumValN(CompilePriority::Normal, "normal",
+                       "Multithreaded while the pool is not oversubscribed "
+                       "(default)"),
+            clEnumValN(CompilePriority::High, "high", "Always multithreaded")),
+        llvm::cl::cat(getQSSCCLCategory()));
+
+    compilePriority_.setCallback(
+        [&](const CompilePriority &priority) { compilePriority = priority; });
   }
 
   /// Pointer to static dialectPlugins variable in constructor, needed by
@@ -421,6 +626,12 @@ llvm::Error CLIConfigBuilder::populateConfig(QSSConfig &config) {
   config.showPayloadsFlag = clOptionsConfig->showPayloadsFlag;
   config.showConfigFlag = clOptionsConfig->showConfigFlag;
   config.emitPlaintextPayloadFlag = clOptionsConfig->emitPlaintextPayloadFlag;
+  config.payloadProfile = clOptionsConfig->payloadProfile;
+  config.payloadFormat = clOptionsConfig->payloadFormat;
+  if (clOptionsConfig->payloadDeltaBase.has_value())
+    config.payloadDeltaBase = clOptionsConfig->payloadDeltaBase;
+  if (clOptionsConfig->dtTimestep.has_value())
+    config.dtTimestep = clOptionsConfig->dtTimestep;
   config.includeSourceFlag = clOptionsConfig->includeSourceFlag;
   config.compileTargetIRFlag = clOptionsConfig->compileTargetIRFlag;
   config.bypassPayloadTargetCompilationFlag =
@@ -435,6 +646,33 @@ llvm::Error CLIConfigBuilder::populateConfig(QSSConfig &config) {
   if (clOptionsConfig->maxThreads.has_value())
     config.maxThreads = clOptionsConfig->maxThreads;
 
+  if (clOptionsConfig->compileCacheDir.has_value())
+    config.compileCacheDir = clOptionsConfig->compileCacheDir;
+  if (clOptionsConfig->compileCacheEntries > 0)
+    config.compileCacheEntries = clOptionsConfig->compileCacheEntries;
+  if (clOptionsConfig->compileCacheFrontend)
+    config.compileCacheFrontend = clOptionsConfig->compileCacheFrontend;
+  if (clOptionsConfig->verifyStagesFlag)
+    config.verifyStagesFlag = clOptionsConfig->verifyStagesFlag;
+  if (clOptionsConfig->reportPassMemoryFlag)
+    config.reportPassMemoryFlag = clOptionsConfig->reportPassMemoryFlag;
+  if (clOptionsConfig->timingTraceFile.has_value())
+    config.timingTraceFile = clOptionsConfig->timingTraceFile;
+  if (clOptionsConfig->compileDeadline.has_value())
+    config.compileDeadline = clOptionsConfig->compileDeadline;
+  if (clOptionsConfig->memoryBudget.has_value())
+    config.memoryBudget = clOptionsConfig->memoryBudget;
+  if (clOptionsConfig->diagnosticRepeatLimit.has_value())
+    config.diagnosticRepeatLimit = clOptionsConfig->diagnosticRepeatLimit;
+  if (clOptionsConfig->maxDiagnostics.has_value())
+    config.maxDiagnostics = clOptionsConfig->maxDiagnostics;
+  if (clOptionsConfig->traceContext.has_value())
+    config.traceContext = clOptionsConfig->traceContext;
+  if (clOptionsConfig->profilerMarkers != ProfilerMarkers::None)
+    config.profilerMarkers = clOptionsConfig->profilerMarkers;
+  if (clOptionsConfig->compilePriority != CompilePriority::Normal)
+    config.compilePriority = clOptionsConfig->compilePriority;
+
   // opt
   config.allowUnregisteredDialectsFlag =
       clOptionsConfig->allowUnregisteredDialectsFlag;
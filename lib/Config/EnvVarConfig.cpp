@@ -36,6 +36,15 @@ llvm::Error EnvVarConfigBuilder::populateConfig(QSSConfig &config) {
   if (auto err = populateMaxThreads_(config))
     return err;
 
+  if (auto err = populateCompileCacheDir_(config))
+    return err;
+
+  if (auto err = populateProfilerMarkers_(config))
+    return err;
+
+  if (auto err = populateCompilePriority_(config))
+    return err;
+
   return llvm::Error::success();
 }
 
@@ -66,6 +75,47 @@ llvm::Error EnvVarConfigBuilder::populateMaxThreads_(QSSConfig &config) {
   return llvm::Error::success();
 }
 
+llvm::Error EnvVarConfigBuilder::populateCompileCacheDir_(QSSConfig &config) {
+  if (const char *cacheDir = std::getenv("QSSC_COMPILE_CACHE_DIR"))
+    config.compileCacheDir = cacheDir;
+  return llvm::Error::success();
+}
+
+llvm::Error EnvVarConfigBuilder::populateProfilerMarkers_(QSSConfig &config) {
+  if (const char *markers = std::getenv("QSSC_PROFILER_MARKERS")) {
+    if (strcmp(markers, "none") == 0) {
+      config.setProfilerMarkers(ProfilerMarkers::None);
+    } else if (strcmp(markers, "itt") == 0) {
+      config.setProfilerMarkers(ProfilerMarkers::ITT);
+    } else {
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "QSSC_PROFILER_MARKERS unrecognized got (" +
+              llvm::StringRef(markers) + "), options are none or itt\n");
+    }
+  }
+  return llvm::Error::success();
+}
+
+llvm::Error EnvVarConfigBuilder::populateCompilePriority_(QSSConfig &config) {
+  if (const char *priority = std::getenv("QSSC_COMPILE_PRIORITY")) {
+    if (strcmp(priority, "low") == 0) {
+      config.setCompilePriority(CompilePriority::Low);
+    } else if (strcmp(priority, "normal") == 0) {
+      config.setCompilePriority(CompilePriority::Normal);
+    } else if (strcmp(priority, "high") == 0) {
+      config.setCompilePriority(CompilePriority::High);
+    } else {
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "QSSC_COMPILE_PRIORITY unrecognized got (" +
+              llvm::StringRef(priority) +
+              "), options are low, normal or high\n");
+    }
+  }
+  return llvm::Error::success();
+}
+
 llvm::Error EnvVarConfigBuilder::populateVerbosity_(QSSConfig &config) {
   if (const char *verbosity = std::getenv("QSSC_VERBOSITY")) {
     if (strcmp(verbosity, "ERROR") == 0) {
@@ -1,6 +1,6 @@
 //===- QSSConfig.cpp - Config info --------------------*- C++ -*-----------===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -23,14 +23,18 @@
 #include "mlir/Tools/Plugins/PassPlugin.h"
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <array>
 #include <filesystem>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -68,6 +72,18 @@ void qssc::config::QSSConfig::emit(llvm::raw_ostream &os) const {
   os << "showConfig: " << shouldShowConfig() << "\n";
   os << "payloadName: " << getPayloadName() << "\n";
   os << "emitPlaintextPayload: " << shouldEmitPlaintextPayload() << "\n";
+  os << "payloadProfile: " << to_string(getPayloadProfile()) << "\n";
+  os << "payloadFormat: " << getPayloadFormat() << "\n";
+  os << "payloadDeltaBase: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getPayloadDeltaBase().has_value() ? getPayloadDeltaBase().value()
+                                           : "None")
+     << "\n";
+  os << "dtTimestep: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getDtTimestep().has_value() ? std::to_string(getDtTimestep().value())
+                                     : "None")
+     << "\n";
   os << "includeSource: " << shouldIncludeSource() << "\n";
   os << "compileTargetIR: " << shouldCompileTargetIR() << "\n";
   os << "bypassPayloadTargetCompilation: "
@@ -77,6 +93,50 @@ void qssc::config::QSSConfig::emit(llvm::raw_ostream &os) const {
      << (getMaxThreads().has_value() ? std::to_string(getMaxThreads().value())
                                      : "None")
      << "\n";
+  os << "compileCacheDir: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getCompileCacheDir().has_value() ? getCompileCacheDir().value()
+                                          : "None")
+     << "\n";
+  os << "compileCacheEntries: " << getCompileCacheEntries() << "\n";
+  os << "compileCacheFrontend: " << getCompileCacheFrontend() << "\n";
+  os << "verifyStages: " << shouldVerifyStages() << "\n";
+  os << "reportPassMemory: " << shouldReportPassMemory() << "\n";
+  os << "timingTraceFile: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getTimingTraceFile().has_value() ? getTimingTraceFile().value()
+                                          : "None")
+     << "\n";
+  os << "compileDeadline: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getCompileDeadline().has_value()
+             ? std::to_string(getCompileDeadline().value())
+             : "None")
+     << "\n";
+  os << "memoryBudget: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getMemoryBudget().has_value()
+             ? std::to_string(getMemoryBudget().value())
+             : "None")
+     << "\n";
+  os << "diagnosticRepeatLimit: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getDiagnosticRepeatLimit().has_value()
+             ? std::to_string(getDiagnosticRepeatLimit().value())
+             : "None")
+     << "\n";
+  os << "maxDiagnostics: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getMaxDiagnostics().has_value()
+             ? std::to_string(getMaxDiagnostics().value())
+             : "None")
+     << "\n";
+  os << "traceContext: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getTraceContext().has_value() ? getTraceContext().value() : "None")
+     << "\n";
+  os << "profilerMarkers: " << to_string(getProfilerMarkers()) << "\n";
+  os << "compilePriority: " << to_string(getCompilePriority()) << "\n";
   os << "\n";
 
   // Mlir opt configuration
@@ -229,6 +289,38 @@ std::string qssc::config::to_string(const InputType &inputType) {
   return "none";
 }
 
+std::string qssc::config::to_string(const PayloadProfile &profile) {
+  switch (profile) {
+  case PayloadProfile::Production:
+    return "production";
+  case PayloadProfile::Debug:
+    return "debug";
+  }
+  return "debug";
+}
+
+std::string qssc::config::to_string(const ProfilerMarkers &markers) {
+  switch (markers) {
+  case ProfilerMarkers::ITT:
+    return "itt";
+  case ProfilerMarkers::None:
+    return "none";
+  }
+  return "none";
+}
+
+std::string qssc::config::to_string(const CompilePriority &priority) {
+  switch (priority) {
+  case CompilePriority::Low:
+    return "low";
+  case CompilePriority::Normal:
+    return "normal";
+  case CompilePriority::High:
+    return "high";
+  }
+  return "normal";
+}
+
 FileExtension
 qssc::config::inputTypeToFileExtension(const InputType &inputType) {
   switch (inputType) {
@@ -320,25 +412,88 @@ FileExtension qssc::config::getExtension(const llvm::StringRef inStr) {
   return FileExtension::None;
 }
 
-mlir::LogicalResult
-qssc::config::loadDialectPlugin(const std::string &pluginPath,
-                                mlir::DialectRegistry &registry) {
+namespace {
+/// Process lifetime registry of the loaded plugins. Every plugin is loaded and
+/// registered once, keyed by its real path, such that repeated compilations
+/// and contexts configured with the same plugins share the loaded libraries.
+/// Plugins which failed to load are not recorded and are retried.
+struct PluginRegistry {
+  std::mutex mutex;
+  llvm::StringMap<mlir::PassPlugin> passPlugins;
+  llvm::StringMap<mlir::DialectPlugin> dialectPlugins;
+  /// Dialects registered by all loaded dialect plugins
+  mlir::DialectRegistry dialects;
+};
+
+static llvm::ManagedStatic<PluginRegistry> pluginRegistry{};
+
+std::string getPluginKey(const std::string &pluginPath) {
+  llvm::SmallString<256> realPath;
+  if (llvm::sys::fs::real_path(pluginPath, realPath))
+    return pluginPath;
+  return std::string(realPath);
+}
+
+mlir::LogicalResult loadDialectPluginLocked(const std::string &pluginPath) {
+  auto key = getPluginKey(pluginPath);
+  if (pluginRegistry->dialectPlugins.count(key))
+    return mlir::success();
   auto plugin = mlir::DialectPlugin::load(pluginPath);
-  if (!plugin)
+  if (!plugin) {
+    llvm::errs() << llvm::toString(plugin.takeError()) << "\n";
     return mlir::failure();
-  ;
-  plugin.get().registerDialectRegistryCallbacks(registry);
+  }
+  plugin.get().registerDialectRegistryCallbacks(pluginRegistry->dialects);
+  pluginRegistry->dialectPlugins.try_emplace(key, std::move(plugin.get()));
   return mlir::success();
 }
 
-mlir::LogicalResult
-qssc::config::loadPassPlugin(const std::string &pluginPath) {
+mlir::LogicalResult loadPassPluginLocked(const std::string &pluginPath) {
+  auto key = getPluginKey(pluginPath);
+  if (pluginRegistry->passPlugins.count(key))
+    return mlir::success();
   auto plugin = mlir::PassPlugin::load(pluginPath);
-  if (!plugin)
+  if (!plugin) {
+    llvm::errs() << llvm::toString(plugin.takeError()) << "\n";
     return mlir::failure();
+  }
   plugin.get().registerPassRegistryCallbacks();
+  pluginRegistry->passPlugins.try_emplace(key, std::move(plugin.get()));
   return mlir::success();
 }
+} // anonymous namespace
+
+mlir::LogicalResult
+qssc::config::loadDialectPlugin(const std::string &pluginPath,
+                                mlir::DialectRegistry &registry) {
+  const std::lock_guard<std::mutex> lock(pluginRegistry->mutex);
+  if (mlir::failed(loadDialectPluginLocked(pluginPath)))
+    return mlir::failure();
+  pluginRegistry->dialects.appendTo(registry);
+  return mlir::success();
+}
+
+mlir::LogicalResult
+qssc::config::loadPassPlugin(const std::string &pluginPath) {
+  const std::lock_guard<std::mutex> lock(pluginRegistry->mutex);
+  return loadPassPluginLocked(pluginPath);
+}
+
+mlir::LogicalResult qssc::config::loadPlugins(const QSSConfig &config,
+                                              mlir::MLIRContext *context) {
+  const std::lock_guard<std::mutex> lock(pluginRegistry->mutex);
+  bool failed = false;
+  for (const auto &pluginPath : config.getPassPlugins())
+    failed |= mlir::failed(loadPassPluginLocked(pluginPath));
+  for (const auto &pluginPath : config.getDialectPlugins())
+    failed |= mlir::failed(loadDialectPluginLocked(pluginPath));
+
+  // The context skips registries which it already contains, hence contexts
+  // which are reused across compilations are only extended once
+  if (!config.getDialectPlugins().empty())
+    context->appendDialectRegistry(pluginRegistry->dialects);
+  return mlir::failure(failed);
+}
 
 llvm::Expected<qssc::config::QSSConfig>
 qssc::config::buildToolConfig(llvm::StringRef inputFilename,
@@ -1,6 +1,6 @@
 //===- OQ3ToStandard.cpp - OpenQASM 3 to Standard patterns ------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -22,17 +22,23 @@
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/ValueRange.h"
+#include "mlir/Interfaces/CallInterfaces.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
 
 #include <cassert>
 #include <cstdint>
 #include <sys/types.h>
+#include <utility>
 
 using namespace mlir;
 using namespace oq3;
@@ -77,6 +83,47 @@ struct CBitBinaryOpConversionPattern : public OQ3ToStandardConversion<OQ3Op> {
   }
 };
 
+namespace {
+// Ops scanned past a cbit_assign_bit for the assignments of its variable
+// that its store is fused with, bounding the cost of the scan
+constexpr unsigned maxAssignBitFusionDistance = 64;
+
+// Returns the CBitAssignBitOps which follow op in its block and assign bits
+// of the same register, such that one load and one store of the register
+// serve all of them. The scan stops at the first op which may otherwise read
+// or write the register.
+SmallVector<CBitAssignBitOp> getFusableAssignBitOps(CBitAssignBitOp op) {
+  SmallVector<CBitAssignBitOp> fusable;
+  auto const name = op.getVariableName();
+  unsigned distance = 0;
+  for (Operation *next = op->getNextNode();
+       next && distance < maxAssignBitFusionDistance;
+       next = next->getNextNode(), ++distance) {
+    if (auto assignBitOp = dyn_cast<CBitAssignBitOp>(next)) {
+      if (assignBitOp.getVariableName() != name)
+        continue;
+      if (assignBitOp.getCbitWidth() != op.getCbitWidth())
+        break;
+      fusable.push_back(assignBitOp);
+      continue;
+    }
+    if (auto loadOp = dyn_cast<VariableLoadOp>(next)) {
+      if (loadOp.getVariableName() == name)
+        break;
+      continue;
+    }
+    if (auto assignOp = dyn_cast<VariableAssignOp>(next)) {
+      if (assignOp.getVariableName() == name)
+        break;
+      continue;
+    }
+    if (next->getNumRegions() != 0 || isa<CallOpInterface>(next))
+      break;
+  }
+  return fusable;
+}
+} // anonymous namespace
+
 struct CBitAssignBitOpConversionPattern
     : public OQ3ToStandardConversion<CBitAssignBitOp> {
   using OQ3ToStandardConversion<CBitAssignBitOp>::OQ3ToStandardConversion;
@@ -105,12 +152,25 @@ struct CBitAssignBitOpConversionPattern
         loc, rewriter.getIntegerType(cbitWidth.getZExtValue()),
         op.getVariableName());
 
-    auto registerWithInsertedBit = rewriter.create<mlir::oq3::CBitInsertBitOp>(
-        loc, oldRegisterValue.getType(), oldRegisterValue,
-        adaptor.getAssignedBit(), adaptor.getIndexAttr());
+    mlir::Value registerWithInsertedBits =
+        rewriter.create<mlir::oq3::CBitInsertBitOp>(
+            loc, oldRegisterValue.getType(), oldRegisterValue,
+            adaptor.getAssignedBit(), adaptor.getIndexAttr());
+
+    // consecutive assignments of bits of the register, e.g. of measurement
+    // results, update the loaded register and share its store
+    for (CBitAssignBitOp fusedOp : getFusableAssignBitOps(op)) {
+      rewriter.setInsertionPoint(fusedOp);
+      registerWithInsertedBits = rewriter.create<mlir::oq3::CBitInsertBitOp>(
+          fusedOp.getLoc(), oldRegisterValue.getType(),
+          registerWithInsertedBits,
+          rewriter.getRemappedValue(fusedOp.getAssignedBit()),
+          fusedOp.getIndexAttr());
+      rewriter.eraseOp(fusedOp);
+    }
 
     rewriter.create<mlir::oq3::VariableAssignOp>(loc, op.getVariableNameAttr(),
-                                                 registerWithInsertedBit);
+                                                 registerWithInsertedBits);
     rewriter.replaceOp(op, mlir::ValueRange({}));
     return success();
   }
@@ -151,29 +211,64 @@ struct CBitInsertBitOpConversionPattern
     if (cbitWidth > 64)
       return failure();
 
-    uint64_t const mask = ~((1ull) << op.getIndex().getZExtValue());
+    // a chain of inserts into the same bitmap, each the only user of the
+    // previous one, is lowered as a whole: the inserted bits are cleared
+    // with a single mask, and the last insert of each bit wins
+    SmallVector<CBitInsertBitOp> chain = {op};
+    while (chain.back()->hasOneUse()) {
+      auto next = dyn_cast<CBitInsertBitOp>(*chain.back()->user_begin());
+      if (!next || next.getOperand() != chain.back().getResult())
+        break;
+      chain.push_back(next);
+    }
+
+    SmallVector<std::pair<APInt, mlir::Value>> insertedBits;
+    for (CBitInsertBitOp insertOp : chain) {
+      APInt index = insertOp.getIndex();
+      if (static_cast<uint>(cbitWidth) < index.getBitWidth())
+        index = index.trunc(cbitWidth);
+      mlir::Value const bit =
+          insertOp == op ? adaptor.getAssignedBit()
+                         : rewriter.getRemappedValue(insertOp.getAssignedBit());
+      auto *inserted = llvm::find_if(insertedBits, [&](const auto &entry) {
+        return entry.first == index;
+      });
+      if (inserted != insertedBits.end())
+        inserted->second = bit;
+      else
+        insertedBits.emplace_back(index, bit);
+    }
+
+    // all inserted bits are defined before the last insert
+    rewriter.setInsertionPoint(chain.back());
+    uint64_t mask = ~0ull;
+    for (const auto &entry : insertedBits)
+      mask &= ~((1ull) << entry.first.getZExtValue());
     auto maskOp =
         rewriter.create<mlir::arith::ConstantIntOp>(loc, mask, cbitWidth);
 
-    auto maskedBitmap = rewriter.create<mlir::LLVM::AndOp>(
+    mlir::Value bitmap = rewriter.create<mlir::LLVM::AndOp>(
         loc, maskOp.getType(), adaptor.getOperand(), maskOp);
 
-    mlir::Value extendedBit = rewriter.create<mlir::LLVM::ZExtOp>(
-        loc, maskOp.getType(), adaptor.getAssignedBit());
-
-    if (!op.getIndex().isNonPositive()) {
-      APInt truncated = op.getIndex();
-      if (static_cast<uint>(cbitWidth) < truncated.getBitWidth())
-        truncated = truncated.trunc(cbitWidth);
-      auto shiftAmount = rewriter.create<mlir::arith::ConstantOp>(
-          loc, extendedBit.getType(),
-          rewriter.getIntegerAttr(extendedBit.getType(), truncated));
-      extendedBit =
-          rewriter.create<mlir::LLVM::ShlOp>(loc, extendedBit, shiftAmount);
+    for (const auto &entry : insertedBits) {
+      mlir::Value extendedBit = rewriter.create<mlir::LLVM::ZExtOp>(
+          loc, maskOp.getType(), entry.second);
+
+      if (!entry.first.isNonPositive()) {
+        auto shiftAmount = rewriter.create<mlir::arith::ConstantOp>(
+            loc, extendedBit.getType(),
+            rewriter.getIntegerAttr(extendedBit.getType(), entry.first));
+        extendedBit =
+            rewriter.create<mlir::LLVM::ShlOp>(loc, extendedBit, shiftAmount);
+      }
+
+      bitmap = rewriter.create<mlir::LLVM::OrOp>(loc, maskOp.getType(),
+                                                 bitmap, extendedBit);
     }
 
-    rewriter.replaceOpWithNewOp<mlir::LLVM::OrOp>(op, maskOp.getType(),
-                                                  maskedBitmap, extendedBit);
+    rewriter.replaceOp(chain.back(), bitmap);
+    for (CBitInsertBitOp insertOp : llvm::drop_end(chain))
+      rewriter.eraseOp(insertOp);
     return success();
   }
 };
@@ -0,0 +1,187 @@
+//===- ConvertedSequenceCache.cpp - Cache of converted circuits -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements a process-wide cache of the pulse sequences the
+/// QUIRToPulsePass converts circuits to.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Conversion/QUIRToPulse/ConvertedSequenceCache.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MemoryBufferRef.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+std::string getEntryPath(llvm::StringRef directory, llvm::StringRef key) {
+  llvm::SmallString<256> path(directory);
+  llvm::sys::path::append(path, key + ".mlirbc");
+  return std::string(path);
+}
+
+OwningOpRef<SequenceOp> readSequence(llvm::StringRef bytecode,
+                                     MLIRContext *context) {
+  // a stale or truncated entry is treated as a miss
+  ScopedDiagnosticHandler const silenceHandler(
+      context, [](Diagnostic &) { return success(); });
+
+  // the sequence calls calibrations of the module it was converted in, hence
+  // it does not verify on its own
+  Block block;
+  ParserConfig const config(context, /*verifyAfterParse=*/false);
+  if (failed(readBytecodeFile(llvm::MemoryBufferRef(bytecode, "sequence"),
+                              &block, config)) ||
+      !llvm::hasSingleElement(block))
+    return nullptr;
+  auto sequence = dyn_cast<SequenceOp>(block.front());
+  if (!sequence)
+    return nullptr;
+  sequence->remove();
+  return sequence;
+}
+
+void writeEntry(llvm::StringRef directory, llvm::StringRef key,
+                llvm::StringRef bytecode) {
+  if (llvm::sys::fs::create_directories(directory))
+    return;
+
+  // write to a unique temporary file first such that concurrent readers
+  // never observe a partially written entry
+  llvm::SmallString<256> tmpModel(directory);
+  llvm::sys::path::append(tmpModel, key + "-%%%%%%%%.tmp");
+  int fd;
+  llvm::SmallString<256> tmpPath;
+  if (llvm::sys::fs::createUniqueFile(tmpModel, fd, tmpPath))
+    return;
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << bytecode;
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(tmpPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(tmpPath, getEntryPath(directory, key)))
+    llvm::sys::fs::remove(tmpPath);
+}
+} // anonymous namespace
+
+ConvertedSequenceCache &ConvertedSequenceCache::get() {
+  static ConvertedSequenceCache cache;
+  return cache;
+}
+
+OwningOpRef<SequenceOp>
+ConvertedSequenceCache::lookup(llvm::StringRef key, MLIRContext *context,
+                               llvm::StringRef directory) {
+  Bytecode bytecode;
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto search = entries.find(key);
+    if (search != entries.end())
+      bytecode = search->second;
+  }
+
+  bool fromDirectory = false;
+  if (!bytecode && !directory.empty()) {
+    auto file = llvm::MemoryBuffer::getFile(getEntryPath(directory, key),
+                                            /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+    if (file) {
+      bytecode =
+          std::make_shared<const std::string>((*file)->getBuffer().str());
+      fromDirectory = true;
+    }
+  }
+
+  OwningOpRef<SequenceOp> sequence;
+  if (bytecode)
+    sequence = readSequence(*bytecode, context);
+
+  std::lock_guard<std::mutex> const lock(mutex);
+  if (!sequence) {
+    statistics.misses++;
+    return nullptr;
+  }
+  statistics.hits++;
+  if (fromDirectory)
+    insert_(key, std::move(bytecode));
+  return sequence;
+}
+
+void ConvertedSequenceCache::store(llvm::StringRef key, SequenceOp sequence,
+                                   llvm::StringRef directory) {
+  std::string bytecode;
+  llvm::raw_string_ostream bytecodeStream(bytecode);
+  if (failed(writeBytecodeToFile(sequence, bytecodeStream)))
+    return;
+  bytecodeStream.flush();
+
+  if (!directory.empty())
+    writeEntry(directory, key, bytecode);
+
+  std::lock_guard<std::mutex> const lock(mutex);
+  insert_(key, std::make_shared<const std::string>(std::move(bytecode)));
+}
+
+void ConvertedSequenceCache::insert_(llvm::StringRef key, Bytecode bytecode) {
+  if (!entries.try_emplace(key, std::move(bytecode)).second)
+    return;
+  order.emplace_back(key);
+  while (order.size() > maxEntries) {
+    entries.erase(order.front());
+    order.pop_front();
+  }
+}
+
+void ConvertedSequenceCache::clear() {
+  std::lock_guard<std::mutex> const lock(mutex);
+  entries.clear();
+  order.clear();
+  statistics = {};
+}
+
+ConvertedSequenceCache::Statistics ConvertedSequenceCache::getStatistics() {
+  std::lock_guard<std::mutex> const lock(mutex);
+  return statistics;
+}
@@ -1,6 +1,6 @@
 //===- LoadPulseCals.cpp ----------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -19,12 +19,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "Conversion/QUIRToPulse/LoadPulseCals.h"
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
 
+#include "Dialect/Pulse/IR/PulseAttributes.h"
 #include "Dialect/Pulse/IR/PulseDialect.h"
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTraits.h"
 #include "Dialect/QUIR/Utils/Utils.h"
+#include "Utils/CloneUtils.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Attributes.h"
@@ -34,27 +38,26 @@
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/IRMapping.h"
-#include "mlir/IR/OwningOpRef.h"
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
-#include "mlir/Parser/Parser.h"
+#include "mlir/IR/Visitors.h"
 #include "mlir/Pass/Pass.h"
-#include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
-#include "llvm/Support/SMLoc.h"
-#include "llvm/Support/SourceMgr.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <sys/types.h>
 #include <utility>
@@ -73,6 +76,11 @@ void LoadPulseCalsPass::runOnOperation() {
       dyn_cast<mlir::func::FuncOp>(quir::getMainFunction(moduleOp));
   assert(mainFunc && "could not find the main func");
 
+  // pulse cals of a previous run refer to the modules replaced below
+  pulseCalsNameToSequenceMap.clear();
+  pulseCalsAddedToIR.clear();
+  mergedPulseCals.clear();
+
   // check for command line override of the path to default pulse cals
   if (defaultPulseCals.hasValue())
     DEFAULT_PULSE_CALS = defaultPulseCals.getValue();
@@ -85,10 +93,12 @@ void LoadPulseCalsPass::runOnOperation() {
       llvm::dbgs() << err;
       return signalPassFailure();
     }
-    // add sequence Ops to pulseCalsNameToSequenceMap
-    defaultPulseCalsModule->walk([&](mlir::pulse::SequenceOp sequenceOp) {
+    // add sequence Ops to pulseCalsNameToSequenceMap, without walking into
+    // their bodies
+    defaultPulseCalsModule.get().walk([&](mlir::pulse::SequenceOp sequenceOp) {
       auto sequenceName = sequenceOp.getSymName().str();
       pulseCalsNameToSequenceMap[sequenceName] = sequenceOp;
+      return WalkResult::skip();
     });
   } else
     LLVM_DEBUG(llvm::dbgs()
@@ -102,11 +112,14 @@ void LoadPulseCalsPass::runOnOperation() {
       llvm::dbgs() << err;
       return signalPassFailure();
     }
-    // add sequence Ops to pulseCalsNameToSequenceMap
-    additionalPulseCalsModule->walk([&](mlir::pulse::SequenceOp sequenceOp) {
-      auto sequenceName = sequenceOp.getSymName().str();
-      pulseCalsNameToSequenceMap[sequenceName] = sequenceOp;
-    });
+    // add sequence Ops to pulseCalsNameToSequenceMap, without walking into
+    // their bodies
+    additionalPulseCalsModule.get().walk(
+        [&](mlir::pulse::SequenceOp sequenceOp) {
+          auto sequenceName = sequenceOp.getSymName().str();
+          pulseCalsNameToSequenceMap[sequenceName] = sequenceOp;
+          return WalkResult::skip();
+        });
   } else
     LLVM_DEBUG(llvm::dbgs()
                << "additional pulse calibrations path is not specified.\n");
@@ -162,13 +175,13 @@ void LoadPulseCalsPass::loadPulseCals(CallGateOp callGateOp,
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
   std::string gateName = callGateOp.getCalleeAttr().getValue().str();
   std::string const gateMangledName = getMangledName(gateName, qubits);
-  assert(pulseCalsNameToSequenceMap.find(gateMangledName) !=
-             pulseCalsNameToSequenceMap.end() &&
-         "could not find any pulse calibration for call gate");
+  SequenceOp const sequenceOp = lookupPulseCal(callGateOp, gateMangledName);
+  if (!sequenceOp)
+    return;
 
   OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
   callGateOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
+  addPulseCalToModule(funcOp, sequenceOp);
 }
 
 void LoadPulseCalsPass::loadPulseCals(BuiltinCXOp CXOp,
@@ -181,13 +194,13 @@ void LoadPulseCalsPass::loadPulseCals(BuiltinCXOp CXOp,
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
   std::string gateName = "cx";
   std::string const gateMangledName = getMangledName(gateName, qubits);
-  assert(pulseCalsNameToSequenceMap.find(gateMangledName) !=
-             pulseCalsNameToSequenceMap.end() &&
-         "could not find any pulse calibration for the CX gate");
+  SequenceOp const sequenceOp = lookupPulseCal(CXOp, gateMangledName);
+  if (!sequenceOp)
+    return;
 
   OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
   CXOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
+  addPulseCalToModule(funcOp, sequenceOp);
 }
 
 void LoadPulseCalsPass::loadPulseCals(Builtin_UOp UOp,
@@ -199,13 +212,13 @@ void LoadPulseCalsPass::loadPulseCals(Builtin_UOp UOp,
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
   std::string gateName = "u3";
   std::string const gateMangledName = getMangledName(gateName, qubits);
-  assert(pulseCalsNameToSequenceMap.find(gateMangledName) !=
-             pulseCalsNameToSequenceMap.end() &&
-         "could not find any pulse calibration for the U gate");
+  SequenceOp const sequenceOp = lookupPulseCal(UOp, gateMangledName);
+  if (!sequenceOp)
+    return;
 
   OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
   UOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
+  addPulseCalToModule(funcOp, sequenceOp);
 }
 
 void LoadPulseCalsPass::loadPulseCals(MeasureOp measureOp,
@@ -223,29 +236,10 @@ void LoadPulseCalsPass::loadPulseCals(MeasureOp measureOp,
     gateName = "mid_circuit_measure";
   std::string const gateMangledName = getMangledName(gateName, qubits);
   measureOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  if (pulseCalsNameToSequenceMap.find(gateMangledName) !=
-      pulseCalsNameToSequenceMap.end()) {
-    // found a pulse calibration for the measurement gate
-    addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
-    return;
-  }
-  // did not find a pulse calibration for the gate
-  // check if there exists pulse calibrations for individual qubits, and if
-  // yes, merge them and add the merged pulse sequence to the module
-  std::vector<SequenceOp> sequenceOps;
-  for (const auto &qubit : qubits) {
-    std::string const individualGateMangledName =
-        getMangledName(gateName, qubit);
-    assert(pulseCalsNameToSequenceMap.find(individualGateMangledName) !=
-               pulseCalsNameToSequenceMap.end() &&
-           "could not find pulse calibrations for the measurement gate");
-    sequenceOps.push_back(
-        pulseCalsNameToSequenceMap[individualGateMangledName]);
-  }
-  SequenceOp const mergedPulseSequenceOp =
-      mergePulseSequenceOps(sequenceOps, gateMangledName);
-  pulseCalsNameToSequenceMap[gateMangledName] = mergedPulseSequenceOp;
-  addPulseCalToModule(funcOp, mergedPulseSequenceOp);
+  SequenceOp const sequenceOp =
+      getOrMergePulseCal(measureOp, gateName, gateMangledName, qubits);
+  if (sequenceOp)
+    addPulseCalToModule(funcOp, sequenceOp);
 }
 
 void LoadPulseCalsPass::loadPulseCals(mlir::quir::BarrierOp barrierOp,
@@ -260,31 +254,14 @@ void LoadPulseCalsPass::loadPulseCals(mlir::quir::BarrierOp barrierOp,
   std::string gateName = "barrier";
   std::string const gateMangledName = getMangledName(gateName, qubits);
   barrierOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  if (pulseCalsNameToSequenceMap.find(gateMangledName) !=
-      pulseCalsNameToSequenceMap.end()) {
-    // found a pulse calibration for the barrier gate
-    addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
-    return;
-  }
-  // did not find a pulse calibration for the gate
-  // check if there exists pulse calibrations for individual qubits, and if
-  // yes, merge them and add the merged pulse sequence to the module
-  std::vector<SequenceOp> sequenceOps;
-  for (const auto &qubit : qubits) {
-    std::string const individualGateMangledName =
-        getMangledName(gateName, qubit);
-    assert(pulseCalsNameToSequenceMap.find(individualGateMangledName) !=
-               pulseCalsNameToSequenceMap.end() &&
-           "could not find pulse calibrations for the barrier gate");
-    sequenceOps.push_back(
-        pulseCalsNameToSequenceMap[individualGateMangledName]);
-  }
-  SequenceOp const mergedPulseSequenceOp =
-      mergePulseSequenceOps(sequenceOps, gateMangledName);
-  pulseCalsNameToSequenceMap[gateMangledName] = mergedPulseSequenceOp;
-  mergedPulseSequenceOp->setAttr("pulse.duration",
-                                 builder.getI64IntegerAttr(0));
-  addPulseCalToModule(funcOp, mergedPulseSequenceOp);
+  SequenceOp const sequenceOp = getOrMergePulseCal(
+      barrierOp, gateName, gateMangledName, qubits,
+      [&](SequenceOp mergedSequenceOp) {
+        mergedSequenceOp->setAttr("pulse.duration",
+                                  builder.getI64IntegerAttr(0));
+      });
+  if (sequenceOp)
+    addPulseCalToModule(funcOp, sequenceOp);
 }
 
 void LoadPulseCalsPass::loadPulseCals(mlir::quir::DelayOp delayOp,
@@ -299,30 +276,13 @@ void LoadPulseCalsPass::loadPulseCals(mlir::quir::DelayOp delayOp,
   std::string gateName = "delay";
   std::string const gateMangledName = getMangledName(gateName, qubits);
   delayOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  if (pulseCalsNameToSequenceMap.find(gateMangledName) !=
-      pulseCalsNameToSequenceMap.end()) {
-    // found a pulse calibration for the delay gate
-    addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
-    return;
-  }
-  // did not find a pulse calibration for the gate
-  // check if there exists pulse calibrations for individual qubits, and if
-  // yes, merge them and add the merged pulse sequence to the module
-  std::vector<SequenceOp> sequenceOps;
-  for (const auto &qubit : qubits) {
-    std::string const individualGateMangledName =
-        getMangledName(gateName, qubit);
-    assert(pulseCalsNameToSequenceMap.find(individualGateMangledName) !=
-               pulseCalsNameToSequenceMap.end() &&
-           "could not find pulse calibrations for the delay gate");
-    sequenceOps.push_back(
-        pulseCalsNameToSequenceMap[individualGateMangledName]);
-  }
-  SequenceOp const mergedPulseSequenceOp =
-      mergePulseSequenceOps(sequenceOps, gateMangledName);
-  removeRedundantDelayArgs(mergedPulseSequenceOp, builder);
-  pulseCalsNameToSequenceMap[gateMangledName] = mergedPulseSequenceOp;
-  addPulseCalToModule(funcOp, mergedPulseSequenceOp);
+  SequenceOp const sequenceOp = getOrMergePulseCal(
+      delayOp, gateName, gateMangledName, qubits,
+      [&](SequenceOp mergedSequenceOp) {
+        removeRedundantDelayArgs(mergedSequenceOp, builder);
+      });
+  if (sequenceOp)
+    addPulseCalToModule(funcOp, sequenceOp);
 }
 
 void LoadPulseCalsPass::loadPulseCals(mlir::quir::ResetQubitOp resetOp,
@@ -337,39 +297,76 @@ void LoadPulseCalsPass::loadPulseCals(mlir::quir::ResetQubitOp resetOp,
   std::string gateName = "reset";
   std::string const gateMangledName = getMangledName(gateName, qubits);
   resetOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  if (pulseCalsNameToSequenceMap.find(gateMangledName) !=
-      pulseCalsNameToSequenceMap.end()) {
-    // found a pulse calibration for the gate
-    addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
-    return;
+  SequenceOp const sequenceOp =
+      getOrMergePulseCal(resetOp, gateName, gateMangledName, qubits);
+  if (sequenceOp)
+    addPulseCalToModule(funcOp, sequenceOp);
+}
+
+mlir::pulse::SequenceOp
+LoadPulseCalsPass::lookupPulseCal(mlir::Operation *op,
+                                  llvm::StringRef gateMangledName) {
+  auto [search, inserted] = pulseCalsNameToSequenceMap.try_emplace(
+      gateMangledName, mlir::pulse::SequenceOp{});
+  if (search->second)
+    return search->second;
+  // the miss is cached, such that it is reported once
+  if (inserted)
+    op->emitError() << "could not find any pulse calibration for "
+                    << gateMangledName;
+  signalPassFailure();
+  return nullptr;
+}
+
+mlir::pulse::SequenceOp LoadPulseCalsPass::getOrMergePulseCal(
+    mlir::Operation *op, std::string &gateName,
+    const std::string &gateMangledName, std::vector<uint32_t> &qubits,
+    llvm::function_ref<void(mlir::pulse::SequenceOp)> postMerge) {
+  auto search = pulseCalsNameToSequenceMap.find(gateMangledName);
+  if (search != pulseCalsNameToSequenceMap.end()) {
+    // found a pulse calibration for the gate, either given or merged earlier,
+    // or a failure to merge one which has been reported already
+    if (search->second && mergedPulseCals.contains(gateMangledName))
+      numReusedMergedPulseCals++;
+    if (!search->second)
+      signalPassFailure();
+    return search->second;
   }
   // did not find a pulse calibration for the gate
   // check if there exists pulse calibrations for individual qubits, and if
-  // yes, merge them and add the merged pulse sequence to the module
+  // yes, merge them. The merged pulse sequence is added to
+  // pulseCalsNameToSequenceMap such that it is built once per qubit tuple.
   std::vector<SequenceOp> sequenceOps;
   for (const auto &qubit : qubits) {
-    std::string const individualGateMangledName =
-        getMangledName(gateName, qubit);
-    assert(pulseCalsNameToSequenceMap.find(individualGateMangledName) !=
-               pulseCalsNameToSequenceMap.end() &&
-           "could not find pulse calibrations for the reset gate");
-    sequenceOps.push_back(
-        pulseCalsNameToSequenceMap[individualGateMangledName]);
+    auto sequenceOp = lookupPulseCal(op, getMangledName(gateName, qubit));
+    if (!sequenceOp) {
+      pulseCalsNameToSequenceMap[gateMangledName] = nullptr;
+      return nullptr;
+    }
+    sequenceOps.push_back(sequenceOp);
   }
   SequenceOp const mergedPulseSequenceOp =
       mergePulseSequenceOps(sequenceOps, gateMangledName);
   pulseCalsNameToSequenceMap[gateMangledName] = mergedPulseSequenceOp;
-  addPulseCalToModule(funcOp, mergedPulseSequenceOp);
+  if (!mergedPulseSequenceOp)
+    return nullptr;
+  if (postMerge)
+    postMerge(mergedPulseSequenceOp);
+  mergedPulseCals.insert(gateMangledName);
+  numMergedPulseCals++;
+  return mergedPulseSequenceOp;
 }
 
 void LoadPulseCalsPass::addPulseCalToModule(
     mlir::func::FuncOp funcOp, mlir::pulse::SequenceOp sequenceOp) {
+  if (failed(materializePulseCal(sequenceOp)))
+    return;
   if (pulseCalsAddedToIR.find(sequenceOp.getSymName().str()) ==
       pulseCalsAddedToIR.end()) {
-    OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
-    auto *clonedPulseCalOp = builder.clone(*sequenceOp);
-    auto clonedPulseCalSequenceOp = static_cast<SequenceOp>(clonedPulseCalOp);
-    clonedPulseCalSequenceOp->moveBefore(funcOp);
+    // the pulse cal is either merged by this pass or part of a pulse cals
+    // module, which is reloaded on the next run, hence it is moved rather
+    // than cloned. The pulse cals of the program are added to the IR already.
+    sequenceOp->moveBefore(funcOp);
     pulseCalsAddedToIR.insert(sequenceOp.getSymName().str());
   } else
     LLVM_DEBUG(llvm::dbgs() << "pulse cal " << sequenceOp.getSymName().str()
@@ -377,31 +374,39 @@ void LoadPulseCalsPass::addPulseCalToModule(
 }
 
 llvm::Error LoadPulseCalsPass::parsePulseCalsModuleOp(
-    std::string &pulseCalsPath,
-    mlir::OwningOpRef<mlir::ModuleOp> &owningOpRef) {
-  std::string errorMessage;
-  llvm::SourceMgr sourceMgr;
-  std::unique_ptr<llvm::MemoryBuffer> pulseCalsFile =
-      mlir::openInputFile(pulseCalsPath, &errorMessage);
-  if (!pulseCalsFile)
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Failed to open pulse calibrations file: " +
-                                       errorMessage);
-  sourceMgr.AddNewSourceBuffer(std::move(pulseCalsFile), llvm::SMLoc());
-  owningOpRef = mlir::parseSourceFile<mlir::ModuleOp>(sourceMgr, &getContext());
-  if (!owningOpRef)
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Failed to parse pulse calibrations file: " +
-                                       pulseCalsPath);
+    std::string &pulseCalsPath, PulseCalsCache::LazyModule &lazyModule) {
+  // calibration files are parsed once per process and reloaded when they
+  // change. Bytecode is loaded lazily, such that only the bodies of the
+  // sequences used by the program are read.
+  auto moduleOrError =
+      PulseCalsCache::get().load(pulseCalsPath, &getContext(), /*lazy=*/true);
+  if (!moduleOrError)
+    return moduleOrError.takeError();
+  lazyModule = std::move(*moduleOrError);
   return llvm::Error::success();
 }
 
+mlir::LogicalResult
+LoadPulseCalsPass::materializePulseCal(mlir::pulse::SequenceOp sequenceOp) {
+  if (succeeded(defaultPulseCalsModule.materialize(sequenceOp)) &&
+      succeeded(additionalPulseCalsModule.materialize(sequenceOp)))
+    return success();
+  sequenceOp->emitError() << "failed to read the pulse calibration "
+                          << sequenceOp.getSymName();
+  signalPassFailure();
+  return failure();
+}
+
 mlir::pulse::SequenceOp LoadPulseCalsPass::mergePulseSequenceOps(
     std::vector<mlir::pulse::SequenceOp> &sequenceOps,
     const std::string &mergedSequenceOpName) {
 
   assert(sequenceOps.size() && "sequence op vector is empty; nothing to merge");
 
+  for (auto sequenceOp : sequenceOps)
+    if (failed(materializePulseCal(sequenceOp)))
+      return nullptr;
+
   SequenceOp const firstSequenceOp = sequenceOps[0];
 
   OpBuilder builder(firstSequenceOp);
@@ -438,13 +443,15 @@ mlir::pulse::SequenceOp LoadPulseCalsPass::mergePulseSequenceOps(
     baseArgNum += sequenceOps[seqNum].getNumArguments();
   }
 
-  // clone the body of the original sequence ops
-  builder.setInsertionPointAfter(&mergedSequenceOp.back().back());
+  // clone the body of the original sequence ops, no listener observes the
+  // merged sequence op yet
+  Block *mergedBlock = &mergedSequenceOp.back();
   for (std::size_t seqNum = 1; seqNum < sequenceOps.size(); seqNum++) {
     for (auto &block : sequenceOps[seqNum].getBody().getBlocks())
-      for (auto &op : block.getOperations())
-        builder.clone(op, mapper);
+      qssc::utils::cloneOpsInto(block.begin(), block.end(), mergedBlock,
+                                mergedBlock->end(), mapper);
   }
+  builder.setInsertionPointToEnd(mergedBlock);
 
   // remove any existing return operations from new merged sequence op
   // collect their output types and values into vectors
@@ -457,8 +464,8 @@ mlir::pulse::SequenceOp LoadPulseCalsPass::mergePulseSequenceOps(
   });
 
   // create a return op in the merged sequence op with the merged output values
-  builder.create<pulse::ReturnOp>(mergedSequenceOp.back().back().getLoc(),
-                                  outputValues);
+  auto mergedReturnOp = builder.create<pulse::ReturnOp>(
+      mergedSequenceOp.back().back().getLoc(), outputValues);
 
   // change the input / output types for the merged sequence op
   auto opType = mergedSequenceOp.getFunctionType();
@@ -478,6 +485,28 @@ mlir::pulse::SequenceOp LoadPulseCalsPass::mergePulseSequenceOps(
       mergedSequenceOp->hasAttr("pulse.duration"))
     mergedSequenceOp->removeAttr("pulse.duration");
 
+  // the merge of precompiled sequences is precompiled as well: the merged
+  // sequences act on distinct mixed frames, whose timelines all start at 0,
+  // such that only the duration and the timepoint of the return change
+  if (mergedSequenceOp->hasAttr(getPrecompiledAttrName())) {
+    std::optional<uint64_t> mergedDuration = 0;
+    for (auto sequenceOp : sequenceOps) {
+      auto duration = sequenceOp->getAttrOfType<IntegerAttr>("pulse.duration");
+      if (!sequenceOp->hasAttr(getPrecompiledAttrName()) || !duration) {
+        mergedDuration = std::nullopt;
+        break;
+      }
+      mergedDuration = std::max<uint64_t>(*mergedDuration, duration.getInt());
+    }
+    if (mergedDuration) {
+      PulseOpSchedulingInterface::setDuration(mergedSequenceOp,
+                                              *mergedDuration);
+      PulseOpSchedulingInterface::setTimepoint(mergedReturnOp,
+                                               *mergedDuration);
+    } else
+      mergedSequenceOp->removeAttr(getPrecompiledAttrName());
+  }
+
   // check if ALL the sequence ops has args/argPorts attr, and if yes,
   // merge the attributes and add them to the merged sequence op
   std::vector<mlir::Attribute> pulseSequenceOpArgs;
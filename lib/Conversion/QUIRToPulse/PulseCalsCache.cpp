@@ -0,0 +1,262 @@
+//===- PulseCalsCache.cpp - Cache of parsed pulse calibrations --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements a process-wide cache of the pulse calibration and
+/// waveform container files loaded by the LoadPulseCalsPass and the
+/// QUIRToPulsePass.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MemoryBufferRef.h"
+#include "llvm/Support/SMLoc.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+// files modified less than this before they were last validated may be
+// modified again without a change of the modification time
+constexpr std::chrono::seconds modificationTimeGranularity{2};
+
+uint64_t hashBuffer(llvm::StringRef buffer) {
+  return llvm::xxh3_64bits(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size()));
+}
+
+// the cache keeps its own copy of the bytes, a file mapped into memory may
+// change underneath when it is rewritten in place
+std::shared_ptr<llvm::SourceMgr> createBuffer(llvm::StringRef bytes,
+                                              llvm::StringRef path) {
+  auto buffer = std::make_shared<llvm::SourceMgr>();
+  buffer->AddNewSourceBuffer(llvm::MemoryBuffer::getMemBufferCopy(bytes, path),
+                             llvm::SMLoc());
+  return buffer;
+}
+} // anonymous namespace
+
+PulseCalsCache::LazyModule &
+PulseCalsCache::LazyModule::operator=(LazyModule &&other) {
+  if (this != &other) {
+    finalize_();
+    module = std::move(other.module);
+    reader = std::move(other.reader);
+    config = std::move(other.config);
+    buffer = std::move(other.buffer);
+  }
+  return *this;
+}
+
+PulseCalsCache::LazyModule::~LazyModule() { finalize_(); }
+
+void PulseCalsCache::LazyModule::finalize_() {
+  // erase the operations which have not been materialized
+  if (reader && module)
+    (void)reader->finalize([](Operation *) { return false; });
+  reader.reset();
+}
+
+LogicalResult PulseCalsCache::LazyModule::materialize(Operation *op) {
+  if (!reader || !reader->isMaterializable(op))
+    return success();
+  return reader->materialize(op);
+}
+
+FailureOr<PulseCalsCache::LazyModule>
+PulseCalsCache::readModule_(std::shared_ptr<llvm::SourceMgr> buffer,
+                            MLIRContext *context, bool lazy) {
+  ScopedDiagnosticHandler const silenceHandler(
+      context, [](Diagnostic &) { return success(); });
+
+  LazyModule lazyModule;
+  llvm::MemoryBufferRef const bufferRef =
+      buffer->getMemoryBuffer(buffer->getMainFileID())->getMemBufferRef();
+  lazyModule.config = std::make_unique<ParserConfig>(context);
+  // passing the buffer as its owner lets resources reference the bytes
+  // instead of copying them
+  lazyModule.reader = std::make_unique<BytecodeReader>(
+      bufferRef, *lazyModule.config, lazy, buffer);
+  lazyModule.buffer = std::move(buffer);
+
+  Block block;
+  if (failed(lazyModule.reader->readTopLevel(
+          &block, [&](Operation *op) { return lazy && !isa<ModuleOp>(op); })))
+    return failure();
+  auto module = dyn_cast_or_null<ModuleOp>(
+      block.empty() ? nullptr : &block.front());
+  if (!module || !llvm::hasSingleElement(block))
+    return failure();
+  module->remove();
+  lazyModule.module = module;
+  if (!lazy)
+    lazyModule.reader.reset();
+  return std::move(lazyModule);
+}
+
+PulseCalsCache &PulseCalsCache::get() {
+  static PulseCalsCache cache;
+  return cache;
+}
+
+llvm::Expected<PulseCalsCache::LazyModule>
+PulseCalsCache::load(llvm::StringRef path, MLIRContext *context, bool lazy) {
+  llvm::sys::fs::file_status status;
+  bool const hasStatus = !llvm::sys::fs::status(path, status);
+
+  // serve unchanged files without reading them
+  std::shared_ptr<llvm::SourceMgr> bytecode;
+  if (hasStatus) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto search = entries.find(path);
+    if (search != entries.end()) {
+      const Entry &entry = search->second;
+      if (entry.modificationTime == status.getLastModificationTime() &&
+          entry.size == status.getSize() &&
+          entry.modificationTime + modificationTimeGranularity <
+              entry.validatedAt) {
+        bytecode = entry.bytecode;
+        statistics.hits++;
+      }
+    }
+  }
+  if (bytecode) {
+    auto moduleOrFailure = readModule_(bytecode, context, lazy);
+    if (succeeded(moduleOrFailure))
+      return std::move(*moduleOrFailure);
+  }
+
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> file =
+      mlir::openInputFile(path, &errorMessage);
+  if (!file)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to open pulse calibrations file: " +
+                                       errorMessage);
+  uint64_t const contentHash = hashBuffer(file->getBuffer());
+  llvm::sys::TimePoint<> const now = std::chrono::system_clock::now();
+
+  // serve files that were touched but not changed
+  bytecode.reset();
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto search = entries.find(path);
+    if (search != entries.end() &&
+        search->second.contentHash == contentHash) {
+      Entry &entry = search->second;
+      if (hasStatus) {
+        entry.modificationTime = status.getLastModificationTime();
+        entry.size = status.getSize();
+      }
+      entry.validatedAt = now;
+      bytecode = entry.bytecode;
+      statistics.hits++;
+    }
+  }
+  if (bytecode) {
+    auto moduleOrFailure = readModule_(bytecode, context, lazy);
+    if (succeeded(moduleOrFailure))
+      return std::move(*moduleOrFailure);
+  }
+
+  auto parseError = [&]() {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to parse pulse calibrations file: " +
+                                       path);
+  };
+
+  // bytecode files are cached as they are, textual files are parsed and
+  // converted
+  LazyModule lazyModule;
+  if (isBytecode(file->getMemBufferRef())) {
+    bytecode = createBuffer(file->getBuffer(), path);
+    auto moduleOrFailure = readModule_(bytecode, context, lazy);
+    if (failed(moduleOrFailure))
+      return parseError();
+    lazyModule = std::move(*moduleOrFailure);
+  } else {
+    llvm::SourceMgr sourceMgr;
+    sourceMgr.AddNewSourceBuffer(std::move(file), llvm::SMLoc());
+    lazyModule.module = mlir::parseSourceFile<ModuleOp>(sourceMgr, context);
+    if (!lazyModule.module)
+      return parseError();
+
+    std::string newBytecode;
+    llvm::raw_string_ostream bytecodeStream(newBytecode);
+    if (succeeded(writeBytecodeToFile(*lazyModule.module, bytecodeStream)))
+      bytecode = createBuffer(bytecodeStream.str(), path);
+  }
+
+  std::lock_guard<std::mutex> const lock(mutex);
+  statistics.misses++;
+  if (!bytecode) {
+    entries.erase(path);
+    return std::move(lazyModule);
+  }
+  Entry &entry = entries[path];
+  if (hasStatus) {
+    entry.modificationTime = status.getLastModificationTime();
+    entry.size = status.getSize();
+  }
+  entry.contentHash = contentHash;
+  entry.validatedAt = now;
+  entry.bytecode = std::move(bytecode);
+  return std::move(lazyModule);
+}
+
+void PulseCalsCache::clear() {
+  std::lock_guard<std::mutex> const lock(mutex);
+  entries.clear();
+  statistics = {};
+}
+
+PulseCalsCache::Statistics PulseCalsCache::getStatistics() {
+  std::lock_guard<std::mutex> const lock(mutex);
+  return statistics;
+}
+
@@ -1,6 +1,6 @@
 //===- QUIRToPulse.cpp - Convert QUIR to Pulse Dialect ----------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -20,11 +20,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "Conversion/QUIRToPulse/QUIRToPulse.h"
+#include "Conversion/QUIRToPulse/ConvertedSequenceCache.h"
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
+#include "Conversion/QUIRToPulse/WaveformLibrary.h"
 
 #include "Dialect/OQ3/IR/OQ3Ops.h"
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 #include "Dialect/Pulse/IR/PulseTypes.h"
+#include "Dialect/Pulse/Utils/Utils.h"
 #include "Dialect/QCS/IR/QCSOps.h"
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/IR/QUIREnums.h"
@@ -35,31 +39,39 @@
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/AsmState.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Location.h"
-#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/TypeRange.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
 #include "mlir/IR/ValueRange.h"
-#include "mlir/Parser/Parser.h"
-#include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
-#include "llvm/Support/SMLoc.h"
-#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <queue>
 #include <string>
@@ -74,6 +86,29 @@ using namespace mlir::quir;
 using namespace mlir::oq3;
 using namespace mlir::pulse;
 
+namespace {
+// the attribute recording the operands of a cached sequence
+constexpr llvm::StringLiteral cachedOperandsAttrName =
+    "quir_to_pulse.operands";
+
+// hash a length prefixed field such that adjacent fields can not alias
+void hashField(llvm::SHA256 &hasher, llvm::StringRef field) {
+  const uint64_t size = field.size();
+  hasher.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(&size), sizeof(size)));
+  hasher.update(field);
+}
+
+// print op on its own, with locations, such that equal ops hash equally
+// regardless of the module they are in
+void hashOp(llvm::SHA256 &hasher, Operation *op) {
+  std::string text;
+  llvm::raw_string_ostream textStream(text);
+  op->print(textStream, OpPrintingFlags().enableDebugInfo().useLocalScope());
+  hashField(hasher, textStream.str());
+}
+} // anonymous namespace
+
 void QUIRToPulsePass::runOnOperation() {
 
   // check for command line override of the path to waveform container
@@ -81,32 +116,71 @@ void QUIRToPulsePass::runOnOperation() {
     WAVEFORM_CONTAINER = waveformContainer.getValue();
 
   // parse the waveform container ops
-  if (!WAVEFORM_CONTAINER.empty())
-    parsePulseWaveformContainerOps(WAVEFORM_CONTAINER);
+  if (!WAVEFORM_CONTAINER.empty() &&
+      failed(parsePulseWaveformContainerOps(WAVEFORM_CONTAINER)))
+    return signalPassFailure();
 
   ModuleOp moduleOp = getOperation();
-  mlir::func::FuncOp mainFunc =
-      dyn_cast<mlir::func::FuncOp>(quir::getMainFunction(moduleOp));
-  assert(mainFunc && "could not find the main func");
-
-  mainFuncFirstOp = &mainFunc.getBody().front().front();
 
   // populate/cache the symbol map
   symbolCache = &getAnalysis<qssc::utils::SymbolCacheAnalysis>()
                      .addToCache<CircuitOp>()
                      .addToCache<SequenceOp>();
 
-  // convert all QUIR circuits to Pulse sequences
+  mlir::func::FuncOp mainFunc = symbolCache->getMainFunction();
+  assert(mainFunc && "could not find the main func");
+
+  mainFuncFirstOp = &mainFunc.getBody().front().front();
+
+  // the operations added to main by an earlier run are gone
+  classicalQUIROpToConvertedPulseOpMap.clear();
+  openedPorts.clear();
+  openedMixFrames.clear();
+  openedWfrs.clear();
+
+  calSequenceDigests.clear();
+  if (incremental)
+    digestCalSequences(moduleOp);
+
+  // collect the QUIR circuit calls, resolving their circuits through the
+  // symbol cache before it is shared between threads. Calls of the same
+  // circuit share one converted sequence, unless they pass different
+  // constant durations, which the sequence body depends on through the
+  // durations of its delays.
+  std::vector<ConvertedCircuit> circuits;
+  std::vector<std::pair<CallCircuitOp, size_t>> calls;
+  std::map<std::pair<Operation *, std::vector<uint64_t>>, size_t>
+      conversionIndices;
   moduleOp->walk([&](CallCircuitOp callCircOp) {
     if (isa<CircuitOp>(callCircOp->getParentOp()))
       return;
-    auto convertedPulseCallSequenceOp =
-        convertCircuitToSequence(callCircOp, mainFunc, moduleOp);
-    if (!callCircOp->use_empty())
-      callCircOp->replaceAllUsesWith(convertedPulseCallSequenceOp);
-    callCircOp->erase();
+    auto circuitOp = symbolCache->getOp<CircuitOp>(callCircOp);
+    auto [search, inserted] = conversionIndices.try_emplace(
+        {circuitOp.getOperation(), getConstantDurationOperands(callCircOp)},
+        circuits.size());
+    if (inserted) {
+      auto &circuit = circuits.emplace_back();
+      circuit.callCircuitOp = callCircOp;
+      circuit.circuitOp = circuitOp;
+      numConvertedCircuits++;
+    } else
+      numReusedSequences++;
+    calls.emplace_back(callCircOp, search->second);
   });
 
+  // converting a circuit only reads the module and builds a detached
+  // sequence, so the circuits are converted in parallel unless threading is
+  // disabled for the context
+  mlir::parallelForEach(&getContext(), circuits,
+                        [&](ConvertedCircuit &circuit) {
+                          convertCircuitToSequence(circuit);
+                        });
+
+  // add the sequences and the ports, mixframes and waveforms they use to the
+  // module in the order of the calls, which keeps the output deterministic
+  for (auto &[callCircOp, index] : calls)
+    materializeSequence(circuits[index], callCircOp, mainFunc);
+
   // erase circuit ops
   moduleOp->walk([&](CircuitOp circOp) { circOp->erase(); });
 
@@ -121,20 +195,27 @@ void QUIRToPulsePass::runOnOperation() {
   });
 }
 
-mlir::pulse::CallSequenceOp
-QUIRToPulsePass::convertCircuitToSequence(CallCircuitOp &callCircuitOp,
-                                          mlir::func::FuncOp &mainFunc,
-                                          ModuleOp &moduleOp) {
-  mlir::OpBuilder builder(mainFunc);
+void QUIRToPulsePass::convertCircuitToSequence(ConvertedCircuit &circuit) {
+  std::string cacheKey;
+  if (incremental) {
+    cacheKey = getCacheKey(circuit);
+    if (readCachedSequence(circuit, cacheKey)) {
+      numCachedSequences++;
+      return;
+    }
+  }
 
-  assert(symbolCache && "symbolCache not set");
-  auto circuitOp = symbolCache->getOp<CircuitOp>(callCircuitOp);
-  std::string const circName = circuitOp.getSymName().str();
-  LLVM_DEBUG(llvm::dbgs() << "\nConverting QUIR circuit " << circName << ":\n");
+  mlir::OpBuilder builder(&getContext());
+
+  auto callCircuitOp = circuit.callCircuitOp;
+  auto circuitOp = circuit.circuitOp;
   assert(callCircuitOp && "callCircuit op is null");
   assert(circuitOp && "circuit op is null");
+  std::string const circName = circuitOp.getSymName().str();
+  LLVM_DEBUG(llvm::dbgs() << "\nConverting QUIR circuit " << circName << ":\n");
 
-  // build an empty pulse sequence
+  // build an empty pulse sequence, without an insertion point it stays
+  // detached from the module until materializeSequence
   SmallVector<Value> arguments;
   auto argumentsValueRange = ValueRange(arguments.data(), arguments.size());
   mlir::FunctionType const funcType =
@@ -143,26 +224,20 @@ QUIRToPulsePass::convertCircuitToSequence(CallCircuitOp &callCircuitOp,
   llvm::SmallVector<mlir::Value> convertedPulseSequenceOpReturnValues;
   auto convertedPulseSequenceOp = builder.create<mlir::pulse::SequenceOp>(
       circuitOp.getLoc(), StringRef(circName + "_sequence"), funcType);
+  circuit.sequenceOp = convertedPulseSequenceOp;
   auto *entryBlock = convertedPulseSequenceOp.addEntryBlock();
   auto entryBuilder = builder.atBlockBegin(entryBlock);
 
-  // reset the circuit conversion helper data structures
-  convertedSequenceOpArgIndex = 0;
-  circuitArgToConvertedSequenceArgMap.clear();
-  convertedPulseSequenceOpArgs.clear();
-  operandNameToIndexMap.clear();
-
-  // convert quir circuit args if not already converted, and add the converted
-  // args to the the converted pulse sequence
+  // convert quir circuit args, and add the converted args to the
+  // converted pulse sequence
   LLVM_DEBUG(llvm::dbgs() << "Processing QUIR circuit args.\n");
-  processCircuitArgs(callCircuitOp, circuitOp, convertedPulseSequenceOp,
-                     mainFunc, entryBuilder);
+  processCircuitArgs(circuit, entryBuilder);
 
   assert(symbolCache && "symbolCache not set");
   circuitOp->walk([&](Operation *quirOp) {
     if (quirOp->hasAttr("pulse.calName")) {
-      std::string const pulseCalName =
-          quirOp->getAttrOfType<StringAttr>("pulse.calName").getValue().str();
+      llvm::StringRef const pulseCalName =
+          quirOp->getAttrOfType<StringAttr>("pulse.calName").getValue();
       SmallVector<Value> pulseCalSequenceArgs;
 
       auto pulseCalSequenceOp =
@@ -174,7 +249,7 @@ QUIRToPulsePass::convertCircuitToSequence(CallCircuitOp &callCircuitOp,
       LLVM_DEBUG(llvm::dbgs() << "QUIR op Pulse cal: ");
       LLVM_DEBUG(pulseCalSequenceOp->dump());
       processPulseCalArgs(quirOp, pulseCalSequenceOp, pulseCalSequenceArgs,
-                          convertedPulseSequenceOp, mainFunc, entryBuilder);
+                          circuit, entryBuilder);
 
       auto pulseCalCallSequenceOp =
           entryBuilder.create<mlir::pulse::CallSequenceOp>(
@@ -231,58 +306,237 @@ QUIRToPulsePass::convertCircuitToSequence(CallCircuitOp &callCircuitOp,
   entryBuilder.create<mlir::pulse::ReturnOp>(
       convertedPulseSequenceOp.back().back().getLoc(),
       mlir::ValueRange{convertedPulseSequenceOpReturnValues});
-  convertedPulseSequenceOp->moveBefore(mainFunc);
 
-  // create a call sequence op for the converted pulse sequence
+  if (incremental)
+    storeCachedSequence(circuit, cacheKey);
+}
+
+void QUIRToPulsePass::digestCalSequences(ModuleOp moduleOp) {
+  std::vector<SequenceOp> sequences;
+  for (auto sequenceOp : moduleOp.getOps<SequenceOp>())
+    sequences.push_back(sequenceOp);
+
+  std::vector<CalSequenceDigest> digests(sequences.size());
+  mlir::parallelFor(&getContext(), 0, sequences.size(), [&](size_t index) {
+    llvm::SHA256 hasher;
+    hashOp(hasher, sequences[index]);
+    digests[index].hash = llvm::toHex(hasher.final(), /*LowerCase=*/true);
+    sequences[index]->walk([&](CallSequenceOp callOp) {
+      digests[index].callees.push_back(callOp.getCalleeAttr().getAttr());
+    });
+  });
+
+  for (auto [sequenceOp, digest] : llvm::zip(sequences, digests))
+    calSequenceDigests[sequenceOp.getSymNameAttr()] = std::move(digest);
+}
+
+std::string QUIRToPulsePass::getCacheKey(ConvertedCircuit &circuit) {
+  llvm::SHA256 hasher;
+  hashField(hasher, "quir-to-pulse-sequence-v1");
+  hashField(hasher, fixedPointAngles ? "fixed-point-angles" : "f64-angles");
+  hashOp(hasher, circuit.circuitOp);
+  for (auto duration : getConstantDurationOperands(circuit.callCircuitOp))
+    hashField(hasher, std::to_string(duration));
+
+  // the pulse cals called by the circuit and, transitively, by the cals
+  llvm::SmallVector<mlir::StringAttr> calNames;
+  llvm::DenseSet<mlir::StringAttr> visited;
+  circuit.circuitOp->walk([&](Operation *quirOp) {
+    if (auto calName = quirOp->getAttrOfType<StringAttr>("pulse.calName"))
+      if (visited.insert(calName).second)
+        calNames.push_back(calName);
+  });
+  for (size_t index = 0; index < calNames.size(); ++index) {
+    auto search = calSequenceDigests.find(calNames[index]);
+    if (search == calSequenceDigests.end())
+      continue;
+    for (auto callee : search->second.callees)
+      if (visited.insert(callee).second)
+        calNames.push_back(callee);
+  }
+  llvm::sort(calNames, [](mlir::StringAttr a, mlir::StringAttr b) {
+    return a.getValue() < b.getValue();
+  });
+  for (auto calName : calNames) {
+    hashField(hasher, calName.getValue());
+    auto search = calSequenceDigests.find(calName);
+    hashField(hasher,
+              search == calSequenceDigests.end() ? "" : search->second.hash);
+  }
+
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+bool QUIRToPulsePass::readCachedSequence(ConvertedCircuit &circuit,
+                                         llvm::StringRef key) {
+  auto sequence = ConvertedSequenceCache::get().lookup(key, &getContext(),
+                                                       incrementalCacheDir);
+  if (!sequence)
+    return false;
+
+  auto operandsAttr =
+      sequence.get()->getAttrOfType<ArrayAttr>(cachedOperandsAttrName);
+  if (!operandsAttr ||
+      operandsAttr.size() != sequence.get().getNumArguments())
+    return false;
+  llvm::SmallVector<ConvertedCircuit::Operand> operands;
+  for (auto attr : operandsAttr) {
+    auto operandAttr = attr.dyn_cast<ArrayAttr>();
+    if (!operandAttr || operandAttr.size() != 4)
+      return false;
+    auto kind = operandAttr[0].dyn_cast<IntegerAttr>();
+    auto circuitArgIndex = operandAttr[1].dyn_cast<IntegerAttr>();
+    auto name = operandAttr[2].dyn_cast<StringAttr>();
+    auto portName = operandAttr[3].dyn_cast<StringAttr>();
+    if (!kind || !circuitArgIndex || !name || !portName ||
+        kind.getInt() < 0 ||
+        kind.getInt() > static_cast<int64_t>(
+                            ConvertedCircuit::Operand::Kind::Waveform))
+      return false;
+    operands.push_back(
+        {static_cast<ConvertedCircuit::Operand::Kind>(kind.getInt()),
+         static_cast<uint>(circuitArgIndex.getInt()),
+         name.empty() ? StringAttr() : name,
+         portName.empty() ? StringAttr() : portName});
+  }
+
+  sequence.get()->removeAttr(cachedOperandsAttrName);
+  circuit.sequenceOp = sequence.release();
+  circuit.operands = std::move(operands);
+  return true;
+}
+
+void QUIRToPulsePass::storeCachedSequence(ConvertedCircuit &circuit,
+                                          llvm::StringRef key) {
+  mlir::Builder builder(&getContext());
+  auto emptyName = builder.getStringAttr("");
+  llvm::SmallVector<Attribute> operandAttrs;
+  for (auto &operand : circuit.operands)
+    operandAttrs.push_back(builder.getArrayAttr(
+        {builder.getI32IntegerAttr(static_cast<int32_t>(operand.kind)),
+         builder.getI32IntegerAttr(operand.circuitArgIndex),
+         operand.name ? operand.name : emptyName,
+         operand.portName ? operand.portName : emptyName}));
+
+  // the operands are recorded on the sequence only while it is written
+  circuit.sequenceOp->setAttr(cachedOperandsAttrName,
+                              builder.getArrayAttr(operandAttrs));
+  ConvertedSequenceCache::get().store(key, circuit.sequenceOp,
+                                      incrementalCacheDir);
+  circuit.sequenceOp->removeAttr(cachedOperandsAttrName);
+}
+
+void QUIRToPulsePass::materializeSequence(ConvertedCircuit &circuit,
+                                          CallCircuitOp callCircuitOp,
+                                          mlir::func::FuncOp &mainFunc) {
+  mlir::OpBuilder builder(mainFunc);
+
+  // add the operands of the call to main, ports, mixframes and waveforms are
+  // shared between all sequences
+  SmallVector<Value> convertedPulseSequenceOpArgs;
+  for (auto &operand : circuit.operands) {
+    switch (operand.kind) {
+    case ConvertedCircuit::Operand::Kind::Angle: {
+      auto angle = callCircuitOp.getOperand(operand.circuitArgIndex);
+      convertedPulseSequenceOpArgs.push_back(convertAngle(
+          angle.getDefiningOp(), getPhaseType(angle.getType(), builder),
+          builder));
+      break;
+    }
+    case ConvertedCircuit::Operand::Kind::Duration: {
+      auto *durationOp =
+          callCircuitOp.getOperand(operand.circuitArgIndex).getDefiningOp();
+      convertedPulseSequenceOpArgs.push_back(
+          convertDurationToI64(callCircuitOp, durationOp,
+                               operand.circuitArgIndex, builder, mainFunc));
+      break;
+    }
+    case ConvertedCircuit::Operand::Kind::Port:
+      convertedPulseSequenceOpArgs.push_back(
+          addPortOpToIR(operand.name, mainFunc, builder));
+      break;
+    case ConvertedCircuit::Operand::Kind::MixFrame:
+      convertedPulseSequenceOpArgs.push_back(addMixFrameOpToIR(
+          operand.name, operand.portName, mainFunc, builder));
+      break;
+    case ConvertedCircuit::Operand::Kind::Waveform:
+      convertedPulseSequenceOpArgs.push_back(
+          addWfrOpToIR(operand.name, mainFunc, builder));
+      break;
+    }
+  }
+
+  // insert the converted pulse sequence before main on its first call
+  if (!circuit.sequenceOp->getBlock()) {
+    builder.setInsertionPoint(mainFunc);
+    builder.insert(circuit.sequenceOp);
+  }
+
+  // create a call sequence op for the converted pulse sequence, and replace
+  // the circuit call with it
+  builder.setInsertionPointAfter(callCircuitOp);
   auto convertedPulseCallSequenceOp =
       builder.create<mlir::pulse::CallSequenceOp>(callCircuitOp->getLoc(),
-                                                  convertedPulseSequenceOp,
+                                                  circuit.sequenceOp,
                                                   convertedPulseSequenceOpArgs);
-  convertedPulseCallSequenceOp->moveAfter(callCircuitOp);
+  if (!callCircuitOp->use_empty())
+    callCircuitOp->replaceAllUsesWith(convertedPulseCallSequenceOp);
+  callCircuitOp->erase();
+}
 
-  return convertedPulseCallSequenceOp;
+std::vector<uint64_t>
+QUIRToPulsePass::getConstantDurationOperands(CallCircuitOp callCircuitOp) {
+  std::vector<uint64_t> durations;
+  for (auto operand : callCircuitOp->getOperands()) {
+    if (!operand.getType().isa<mlir::quir::DurationType>())
+      continue;
+    auto constantOp = operand.getDefiningOp<mlir::quir::ConstantOp>();
+    if (!constantOp)
+      continue;
+    auto durOp = quir::getDuration(constantOp);
+    if (!durOp) {
+      llvm::consumeError(durOp.takeError());
+      continue;
+    }
+    durations.push_back(
+        static_cast<uint64_t>(durOp.get().getDuration().convertToDouble()));
+  }
+  return durations;
 }
 
-void QUIRToPulsePass::processCircuitArgs(
-    mlir::quir::CallCircuitOp &callCircuitOp, mlir::quir::CircuitOp &circuitOp,
-    SequenceOp &convertedPulseSequenceOp, mlir::func::FuncOp &mainFunc,
-    mlir::OpBuilder &builder) {
+void QUIRToPulsePass::processCircuitArgs(ConvertedCircuit &circuit,
+                                         mlir::OpBuilder &builder) {
+  auto circuitOp = circuit.circuitOp;
+  auto convertedPulseSequenceOp = circuit.sequenceOp;
   for (uint cnt = 0; cnt < circuitOp.getNumArguments(); cnt++) {
     auto arg = circuitOp.getArgument(cnt);
-    auto dictArg = circuitOp.getArgAttrDict(cnt);
     mlir::Type const argumentType = arg.getType();
     if (argumentType.isa<mlir::quir::AngleType>()) {
-      auto *angleOp = callCircuitOp.getOperand(cnt).getDefiningOp();
       LLVM_DEBUG(llvm::dbgs() << "angle argument ");
-      LLVM_DEBUG(angleOp->dump());
-      convertedPulseSequenceOp.getBody().addArgument(builder.getF64Type(),
-                                                     arg.getLoc());
-      circuitArgToConvertedSequenceArgMap[cnt] = convertedSequenceOpArgIndex;
-      auto convertedAngleToF64 = convertAngleToF64(angleOp, builder);
-      convertedSequenceOpArgIndex += 1;
-      convertedPulseSequenceOpArgs.push_back(convertedAngleToF64);
+      LLVM_DEBUG(circuit.callCircuitOp.getOperand(cnt).dump());
+      circuit.circuitArgToConvertedSequenceArgMap[cnt] =
+          convertedPulseSequenceOp.getNumArguments();
+      convertedPulseSequenceOp.getBody().addArgument(
+          getPhaseType(argumentType, builder), arg.getLoc());
+      circuit.operands.push_back(
+          {ConvertedCircuit::Operand::Kind::Angle, cnt, {}, {}});
     } else if (argumentType.isa<mlir::quir::DurationType>()) {
-      auto *durationOp = callCircuitOp.getOperand(cnt).getDefiningOp();
       LLVM_DEBUG(llvm::dbgs() << "duration argument ");
-      LLVM_DEBUG(durationOp->dump());
+      LLVM_DEBUG(circuit.callCircuitOp.getOperand(cnt).dump());
+      circuit.circuitArgToConvertedSequenceArgMap[cnt] =
+          convertedPulseSequenceOp.getNumArguments();
       convertedPulseSequenceOp.getBody().addArgument(builder.getI64Type(),
                                                      arg.getLoc());
-      circuitArgToConvertedSequenceArgMap[cnt] = convertedSequenceOpArgIndex;
-      auto convertedDurationToI64 = convertDurationToI64(
-          callCircuitOp, durationOp, cnt, builder, mainFunc);
-      convertedSequenceOpArgIndex += 1;
-      convertedPulseSequenceOpArgs.push_back(convertedDurationToI64);
-    } else if (argumentType.isa<mlir::quir::QubitType>()) {
-      auto *qubitOp = callCircuitOp.getOperand(cnt).getDefiningOp();
-    } else
+      circuit.operands.push_back(
+          {ConvertedCircuit::Operand::Kind::Duration, cnt, {}, {}});
+    } else if (!argumentType.isa<mlir::quir::QubitType>())
       llvm_unreachable("unkown circuit argument.");
   }
 }
 
 void QUIRToPulsePass::processPulseCalArgs(
     mlir::Operation *quirOp, SequenceOp &pulseCalSequenceOp,
-    SmallVector<Value> &pulseCalSequenceArgs,
-    SequenceOp &convertedPulseSequenceOp, mlir::func::FuncOp &mainFunc,
+    SmallVector<Value> &pulseCalSequenceArgs, ConvertedCircuit &circuit,
     mlir::OpBuilder &builder) {
 
   // get the classical operands of the quir op
@@ -305,47 +559,49 @@ void QUIRToPulsePass::processPulseCalArgs(
     mlir::Type const argumentType = argumentResult.value().getType();
     mlir::Value const argumentValue = argumentResult.value();
     if (argumentType.isa<WaveformType>()) {
-      std::string const wfrName =
-          argAttr[index].dyn_cast<StringAttr>().getValue().str();
-      LLVM_DEBUG(llvm::dbgs() << "waveform argument " << wfrName << "\n");
-      processWfrOpArg(wfrName, convertedPulseSequenceOp, pulseCalSequenceArgs,
-                      argumentValue, mainFunc, builder);
+      auto const wfrName = argAttr[index].cast<StringAttr>();
+      LLVM_DEBUG(llvm::dbgs() << "waveform argument " << wfrName.getValue()
+                              << "\n");
+      processNamedArg(ConvertedCircuit::Operand::Kind::Waveform, wfrName, {},
+                      builder.getType<mlir::pulse::WaveformType>(), circuit,
+                      pulseCalSequenceArgs, argumentValue);
     } else if (argumentType.isa<MixedFrameType>()) {
-      std::string const &mixFrameName =
-          argAttr[index].dyn_cast<StringAttr>().getValue().str();
-      std::string const &portName =
-          argPortsAttr[index].dyn_cast<StringAttr>().getValue().str();
-      LLVM_DEBUG(llvm::dbgs() << "mixframe argument " << mixFrameName << "\n");
-      processMixFrameOpArg(mixFrameName, portName, convertedPulseSequenceOp,
-                           pulseCalSequenceArgs, argumentValue, mainFunc,
-                           builder);
+      auto const mixFrameName = argAttr[index].cast<StringAttr>();
+      auto const portName = argPortsAttr[index].cast<StringAttr>();
+      LLVM_DEBUG(llvm::dbgs() << "mixframe argument "
+                              << mixFrameName.getValue() << "\n");
+      processNamedArg(ConvertedCircuit::Operand::Kind::MixFrame, mixFrameName,
+                      portName, builder.getType<mlir::pulse::MixedFrameType>(),
+                      circuit, pulseCalSequenceArgs, argumentValue);
     } else if (argumentType.isa<PortType>()) {
-      std::string const &portName =
-          argPortsAttr[index].dyn_cast<StringAttr>().getValue().str();
-      LLVM_DEBUG(llvm::dbgs() << "port argument " << portName << "\n");
-      processPortOpArg(portName, convertedPulseSequenceOp, pulseCalSequenceArgs,
-                       argumentValue, mainFunc, builder);
-    } else if (argumentType.isa<FloatType>()) {
-      assert(argAttr[index].dyn_cast<StringAttr>().getValue().str() ==
-                 "angle" &&
+      auto const portName = argPortsAttr[index].cast<StringAttr>();
+      LLVM_DEBUG(llvm::dbgs() << "port argument " << portName.getValue()
+                              << "\n");
+      processNamedArg(ConvertedCircuit::Operand::Kind::Port, portName, {},
+                      builder.getType<mlir::pulse::PortType>(), circuit,
+                      pulseCalSequenceArgs, argumentValue);
+    } else if (argumentType.isa<FloatType>() ||
+               (argumentType.isa<IntegerType>() &&
+                argAttr[index].cast<StringAttr>().getValue() == "angle")) {
+      // calibrations may take either f64 or fixed-point phases
+      assert(argAttr[index].cast<StringAttr>().getValue() == "angle" &&
              "unkown argument.");
       assert(angleOperands.size() && "no angle operand found.");
       auto nextAngle = angleOperands.front();
       LLVM_DEBUG(llvm::dbgs() << "angle argument ");
       LLVM_DEBUG(nextAngle.dump());
-      processAngleArg(nextAngle, convertedPulseSequenceOp, pulseCalSequenceArgs,
+      processAngleArg(nextAngle, argumentType, circuit, pulseCalSequenceArgs,
                       builder);
       angleOperands.pop();
     } else if (argumentType.isa<IntegerType>()) {
-      assert(argAttr[index].dyn_cast<StringAttr>().getValue().str() ==
-                 "duration" &&
+      assert(argAttr[index].cast<StringAttr>().getValue() == "duration" &&
              "unkown argument.");
       assert(durationOperands.size() && "no duration operand found.");
       auto nextDuration = durationOperands.front();
       LLVM_DEBUG(llvm::dbgs() << "duration argument ");
       LLVM_DEBUG(nextDuration.dump());
-      processDurationArg(nextDuration, convertedPulseSequenceOp,
-                         pulseCalSequenceArgs, builder);
+      processDurationArg(nextDuration, circuit, pulseCalSequenceArgs,
+                         builder);
       durationOperands.pop();
     } else
       llvm_unreachable("unkown argument type.");
@@ -376,177 +632,140 @@ void QUIRToPulsePass::getQUIROpClassicalOperands(
       llvm_unreachable("unkown operand.");
 }
 
-void QUIRToPulsePass::processMixFrameOpArg(
-    std::string const &mixFrameName, std::string const &portName,
-    SequenceOp &convertedPulseSequenceOp,
-    SmallVector<Value> &pulseCalSequenceArgs, Value argumentValue,
-    mlir::func::FuncOp &mainFunc, mlir::OpBuilder &builder) {
-  auto mixedFrameOp =
-      addMixFrameOpToIR(mixFrameName, portName, mainFunc, builder);
-  if (operandNameToIndexMap.find(mixFrameName) == operandNameToIndexMap.end()) {
-    operandNameToIndexMap[mixFrameName] = convertedSequenceOpArgIndex;
-    convertedPulseSequenceOpArgs.push_back(mixedFrameOp);
-    convertedPulseSequenceOp.getBody().addArgument(
-        builder.getType<mlir::pulse::MixedFrameType>(), argumentValue.getLoc());
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[convertedSequenceOpArgIndex]);
-    convertedSequenceOpArgIndex += 1;
-  } else {
-    uint const mixFrameOperandIndex = operandNameToIndexMap[mixFrameName];
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[mixFrameOperandIndex]);
-  }
-}
-
-void QUIRToPulsePass::processPortOpArg(std::string const &portName,
-                                       SequenceOp &convertedPulseSequenceOp,
-                                       SmallVector<Value> &pulseCalSequenceArgs,
-                                       Value argumentValue,
-                                       mlir::func::FuncOp &mainFunc,
-                                       mlir::OpBuilder &builder) {
-  auto portOp = addPortOpToIR(portName, mainFunc, builder);
-  if (operandNameToIndexMap.find(portName) == operandNameToIndexMap.end()) {
-    operandNameToIndexMap[portName] = convertedSequenceOpArgIndex;
-    convertedPulseSequenceOpArgs.push_back(portOp);
-    convertedPulseSequenceOp.getBody().addArgument(
-        builder.getType<mlir::pulse::PortType>(), argumentValue.getLoc());
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[convertedSequenceOpArgIndex]);
-    convertedSequenceOpArgIndex += 1;
-  } else {
-    uint const portOperandIndex = operandNameToIndexMap[portName];
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[portOperandIndex]);
-  }
-}
-
-void QUIRToPulsePass::processWfrOpArg(std::string const &wfrName,
-                                      SequenceOp &convertedPulseSequenceOp,
+void QUIRToPulsePass::processNamedArg(ConvertedCircuit::Operand::Kind kind,
+                                      mlir::StringAttr name,
+                                      mlir::StringAttr portName,
+                                      mlir::Type argumentType,
+                                      ConvertedCircuit &circuit,
                                       SmallVector<Value> &pulseCalSequenceArgs,
-                                      Value argumentValue,
-                                      mlir::func::FuncOp &mainFunc,
-                                      mlir::OpBuilder &builder) {
-  auto wfrOp = addWfrOpToIR(wfrName, mainFunc, builder);
-  if (operandNameToIndexMap.find(wfrName) == operandNameToIndexMap.end()) {
-    operandNameToIndexMap[wfrName] = convertedSequenceOpArgIndex;
-    convertedPulseSequenceOpArgs.push_back(wfrOp);
-    convertedPulseSequenceOp.getBody().addArgument(
-        builder.getType<mlir::pulse::WaveformType>(), argumentValue.getLoc());
+                                      Value argumentValue) {
+  auto convertedPulseSequenceOp = circuit.sequenceOp;
+  auto search = circuit.operandNameToIndexMap.find(name);
+  if (search == circuit.operandNameToIndexMap.end()) {
+    uint const operandIndex = convertedPulseSequenceOp.getNumArguments();
+    circuit.operandNameToIndexMap[name] = operandIndex;
+    circuit.operands.push_back({kind, 0, name, portName});
+    convertedPulseSequenceOp.getBody().addArgument(argumentType,
+                                                   argumentValue.getLoc());
     pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[convertedSequenceOpArgIndex]);
-    convertedSequenceOpArgIndex += 1;
-  } else {
-    uint const wfrOperandIndex = operandNameToIndexMap[wfrName];
+        convertedPulseSequenceOp.getArgument(operandIndex));
+  } else
     pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[wfrOperandIndex]);
-  }
+        convertedPulseSequenceOp.getArgument(search->second));
 }
 
 void QUIRToPulsePass::processAngleArg(Value nextAngleOperand,
-                                      SequenceOp &convertedPulseSequenceOp,
+                                      mlir::Type phaseType,
+                                      ConvertedCircuit &circuit,
                                       SmallVector<Value> &pulseCalSequenceArgs,
                                       mlir::OpBuilder &entryBuilder) {
   if (nextAngleOperand.isa<BlockArgument>()) {
     uint const circNum =
         nextAngleOperand.dyn_cast<BlockArgument>().getArgNumber();
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp
-            .getArguments()[circuitArgToConvertedSequenceArgMap[circNum]]);
+    auto sequenceArg = circuit.sequenceOp.getArgument(
+        circuit.circuitArgToConvertedSequenceArgMap[circNum]);
+    // rescale if the calibration takes another phase type than the circuit
+    pulseCalSequenceArgs.push_back(mlir::pulse::convertPhase(
+        entryBuilder, sequenceArg.getLoc(), sequenceArg, phaseType));
   } else {
     auto angleOp = nextAngleOperand.getDefiningOp<mlir::quir::ConstantOp>();
-    std::string const angleLocHash =
-        std::to_string(mlir::hash_value(angleOp->getLoc()));
-    if (classicalQUIROpLocToConvertedPulseOpMap.find(angleLocHash) ==
-        classicalQUIROpLocToConvertedPulseOpMap.end()) {
-      double const angleVal =
-          angleOp.getAngleValueFromConstant().convertToDouble();
-      auto f64Angle = entryBuilder.create<mlir::arith::ConstantOp>(
-          angleOp.getLoc(), entryBuilder.getFloatAttr(entryBuilder.getF64Type(),
-                                                      llvm::APFloat(angleVal)));
-      classicalQUIROpLocToConvertedPulseOpMap[angleLocHash] = f64Angle;
+    double const angleVal =
+        angleOp.getAngleValueFromConstant().convertToDouble();
+    auto [search, inserted] =
+        circuit.opToConstantMap.try_emplace(angleOp.getOperation());
+    if (inserted)
+      search->second = mlir::pulse::createPhaseConstant(
+          entryBuilder, angleOp.getLoc(), angleVal, phaseType);
+    // calibrations taking other phase types get constants of their own
+    if (search->second.getType() != phaseType) {
+      pulseCalSequenceArgs.push_back(mlir::pulse::createPhaseConstant(
+          entryBuilder, angleOp.getLoc(), angleVal, phaseType));
+      return;
     }
-    pulseCalSequenceArgs.push_back(
-        classicalQUIROpLocToConvertedPulseOpMap[angleLocHash]);
+    pulseCalSequenceArgs.push_back(search->second);
   }
 }
 
 void QUIRToPulsePass::processDurationArg(
-    Value nextDurationOperand, SequenceOp &convertedPulseSequenceOp,
+    Value nextDurationOperand, ConvertedCircuit &circuit,
     SmallVector<Value> &pulseCalSequenceArgs, mlir::OpBuilder &entryBuilder) {
   if (nextDurationOperand.isa<BlockArgument>()) {
     uint const circNum =
         nextDurationOperand.dyn_cast<BlockArgument>().getArgNumber();
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp
-            .getArguments()[circuitArgToConvertedSequenceArgMap[circNum]]);
+    pulseCalSequenceArgs.push_back(circuit.sequenceOp.getArgument(
+        circuit.circuitArgToConvertedSequenceArgMap[circNum]));
   } else {
     auto durationOp =
         nextDurationOperand.getDefiningOp<mlir::quir::ConstantOp>();
-    std::string const durLocHash =
-        std::to_string(mlir::hash_value(nextDurationOperand.getLoc()));
     auto durVal =
         quir::getDuration(durationOp).get().getDuration().convertToDouble();
     assert(durationOp.getType().dyn_cast<DurationType>().getUnits() ==
                TimeUnits::dt &&
            "this pass only accepts durations with dt unit");
 
-    if (classicalQUIROpLocToConvertedPulseOpMap.find(durLocHash) ==
-        classicalQUIROpLocToConvertedPulseOpMap.end()) {
+    auto [search, inserted] =
+        circuit.opToConstantMap.try_emplace(durationOp.getOperation());
+    if (inserted) {
       auto dur64 = entryBuilder.create<mlir::arith::ConstantOp>(
           durationOp.getLoc(),
           entryBuilder.getIntegerAttr(entryBuilder.getI64Type(),
                                       uint64_t(durVal)));
-      classicalQUIROpLocToConvertedPulseOpMap[durLocHash] = dur64;
+      search->second = dur64;
     }
-    pulseCalSequenceArgs.push_back(
-        classicalQUIROpLocToConvertedPulseOpMap[durLocHash]);
+    pulseCalSequenceArgs.push_back(search->second);
   }
 }
 
-mlir::Value QUIRToPulsePass::convertAngleToF64(Operation *angleOp,
-                                               mlir::OpBuilder &builder) {
+mlir::Type QUIRToPulsePass::getPhaseType(mlir::Type angleType,
+                                         mlir::OpBuilder &builder) {
+  if (!fixedPointAngles)
+    return builder.getF64Type();
+  auto width = angleType.cast<mlir::quir::AngleType>().getWidth();
+  return builder.getIntegerType(width.value_or(64));
+}
+
+mlir::Value QUIRToPulsePass::convertAngle(Operation *angleOp,
+                                          mlir::Type phaseType,
+                                          mlir::OpBuilder &builder) {
   assert(angleOp && "angle op is null");
-  std::string const angleLocHash =
-      std::to_string(mlir::hash_value(angleOp->getLoc()));
-  if (classicalQUIROpLocToConvertedPulseOpMap.find(angleLocHash) ==
-      classicalQUIROpLocToConvertedPulseOpMap.end()) {
+  auto [search, inserted] =
+      classicalQUIROpToConvertedPulseOpMap.try_emplace(angleOp);
+  if (inserted) {
     if (auto castOp = dyn_cast<quir::ConstantOp>(angleOp)) {
       double const angleVal =
           castOp.getAngleValueFromConstant().convertToDouble();
-      auto f64Angle = builder.create<mlir::arith::ConstantOp>(
-          castOp->getLoc(),
-          builder.getFloatAttr(builder.getF64Type(), llvm::APFloat(angleVal)));
-      f64Angle->moveAfter(castOp);
-      classicalQUIROpLocToConvertedPulseOpMap[angleLocHash] = f64Angle;
+      auto phase = mlir::pulse::createPhaseConstant(builder, castOp->getLoc(),
+                                                    angleVal, phaseType);
+      phase.getDefiningOp()->moveAfter(castOp);
+      search->second = phase;
     } else if (auto castOp = dyn_cast<qcs::ParameterLoadOp>(angleOp)) {
       auto angleCastedOp = builder.create<oq3::CastOp>(
-          castOp->getLoc(), builder.getF64Type(), castOp.getRes());
+          castOp->getLoc(), phaseType, castOp.getRes());
       angleCastedOp->moveAfter(castOp);
-      classicalQUIROpLocToConvertedPulseOpMap[angleLocHash] = angleCastedOp;
+      search->second = angleCastedOp;
     } else if (auto castOp = dyn_cast<oq3::CastOp>(angleOp)) {
       auto castOpArg = castOp.getArg();
       if (auto paramCastOp =
               dyn_cast<qcs::ParameterLoadOp>(castOpArg.getDefiningOp())) {
         auto angleCastedOp = builder.create<oq3::CastOp>(
-            paramCastOp->getLoc(), builder.getF64Type(), paramCastOp.getRes());
+            paramCastOp->getLoc(), phaseType, paramCastOp.getRes());
         angleCastedOp->moveAfter(paramCastOp);
-        classicalQUIROpLocToConvertedPulseOpMap[angleLocHash] = angleCastedOp;
+        search->second = angleCastedOp;
       } else
         llvm_unreachable("castOp arg unknown");
     } else
       llvm_unreachable("angleOp unknown");
   }
-  return classicalQUIROpLocToConvertedPulseOpMap[angleLocHash];
+  return search->second;
 }
 
 mlir::Value QUIRToPulsePass::convertDurationToI64(
     mlir::quir::CallCircuitOp &callCircuitOp, Operation *durationOp, uint &cnt,
     mlir::OpBuilder &builder, mlir::func::FuncOp &mainFunc) {
   assert(durationOp && "duration op is null");
-  std::string const durLocHash =
-      std::to_string(mlir::hash_value(durationOp->getLoc()));
-  if (classicalQUIROpLocToConvertedPulseOpMap.find(durLocHash) ==
-      classicalQUIROpLocToConvertedPulseOpMap.end()) {
+  auto [search, inserted] =
+      classicalQUIROpToConvertedPulseOpMap.try_emplace(durationOp);
+  if (inserted) {
     if (auto castOp = dyn_cast<quir::ConstantOp>(durationOp)) {
       auto durVal =
           quir::getDuration(castOp).get().getDuration().convertToDouble();
@@ -558,74 +777,146 @@ mlir::Value QUIRToPulsePass::convertDurationToI64(
           castOp->getLoc(),
           builder.getIntegerAttr(builder.getI64Type(), uint64_t(durVal)));
       I64Dur->moveAfter(castOp);
-      classicalQUIROpLocToConvertedPulseOpMap[durLocHash] = I64Dur;
+      search->second = I64Dur;
     } else
       llvm_unreachable("unkown duration op");
   }
-  return classicalQUIROpLocToConvertedPulseOpMap[durLocHash];
+  return search->second;
 }
 
 mlir::pulse::Port_CreateOp
-QUIRToPulsePass::addPortOpToIR(std::string const &portName,
+QUIRToPulsePass::addPortOpToIR(mlir::StringAttr portName,
                                mlir::func::FuncOp &mainFunc,
                                mlir::OpBuilder &builder) {
-  if (openedPorts.find(portName) == openedPorts.end()) {
+  auto [search, inserted] = openedPorts.try_emplace(portName);
+  if (inserted) {
     auto portOp =
         builder.create<Port_CreateOp>(mainFuncFirstOp->getLoc(), portName);
     portOp->moveBefore(mainFuncFirstOp);
-    openedPorts[portName] = portOp;
+    search->second = portOp;
   }
-  return openedPorts[portName];
+  return search->second;
 }
 
 mlir::pulse::MixFrameOp QUIRToPulsePass::addMixFrameOpToIR(
-    std::string const &mixFrameName, std::string const &portName,
+    mlir::StringAttr mixFrameName, mlir::StringAttr portName,
     mlir::func::FuncOp &mainFunc, mlir::OpBuilder &builder) {
-  if (openedMixFrames.find(mixFrameName) == openedMixFrames.end()) {
-    auto portOp = addPortOpToIR(portName, mainFunc, builder);
-    auto mixedFrameOp = builder.create<MixFrameOp>(
-        portOp->getLoc(), portOp, builder.getStringAttr(mixFrameName),
-        mlir::Value{}, mlir::Value{}, mlir::Value{});
-    mixedFrameOp->moveBefore(mainFuncFirstOp);
-    openedMixFrames[mixFrameName] = mixedFrameOp;
-  }
-  return openedMixFrames[mixFrameName];
+  auto search = openedMixFrames.find(mixFrameName);
+  if (search != openedMixFrames.end())
+    return search->second;
+  auto portOp = addPortOpToIR(portName, mainFunc, builder);
+  auto mixedFrameOp =
+      builder.create<MixFrameOp>(portOp->getLoc(), portOp, mixFrameName,
+                                 mlir::Value{}, mlir::Value{}, mlir::Value{});
+  mixedFrameOp->moveBefore(mainFuncFirstOp);
+  openedMixFrames[mixFrameName] = mixedFrameOp;
+  return mixedFrameOp;
 }
 
 mlir::pulse::Waveform_CreateOp
-QUIRToPulsePass::addWfrOpToIR(std::string const &wfrName,
+QUIRToPulsePass::addWfrOpToIR(mlir::StringAttr wfrName,
                               mlir::func::FuncOp &mainFunc,
                               mlir::OpBuilder &builder) {
-  if (openedWfrs.find(wfrName) == openedWfrs.end()) {
-    auto *clonedOp = builder.clone(*pulseNameToWaveformMap[wfrName]);
+  auto [search, inserted] = openedWfrs.try_emplace(wfrName);
+  if (inserted && waveformLibrary) {
+    auto wfrOp = createLibraryWfrOp(wfrName, builder);
+    wfrOp->moveBefore(mainFuncFirstOp);
+    search->second = wfrOp;
+  } else if (inserted) {
+    auto wfrSearch = pulseNameToWaveformMap.find(wfrName);
+    assert(wfrSearch != pulseNameToWaveformMap.end() &&
+           "could not find the waveform in the waveform container");
+    auto *clonedOp = builder.clone(*wfrSearch->second);
     auto wfrOp = dyn_cast<Waveform_CreateOp>(clonedOp);
     wfrOp->moveBefore(mainFuncFirstOp);
-    openedWfrs[wfrName] = wfrOp;
+    search->second = wfrOp;
+  }
+  return search->second;
+}
+
+mlir::pulse::Waveform_CreateOp
+QUIRToPulsePass::createLibraryWfrOp(mlir::StringAttr wfrName,
+                                    mlir::OpBuilder &builder) {
+  auto index = waveformLibrary->find(wfrName.getValue());
+  assert(index && "could not find the waveform in the waveform library");
+
+  auto *context = &getContext();
+  auto numSamples =
+      static_cast<int64_t>(waveformLibrary->getNumSamples(*index));
+  auto samplesType =
+      RankedTensorType::get({numSamples, 2}, Float64Type::get(context));
+  ElementsAttr samplesAttr;
+  if (auto samples = waveformLibrary->getSamples(*index)) {
+    // the samples are referenced in place, the resource keeps the mapped
+    // library alive until it is released, e.g. after the payload was written
+    AsmResourceBlob blob(
+        ArrayRef<char>(reinterpret_cast<const char *>(samples->data()),
+                       samples->size() * sizeof(double)),
+        alignof(double),
+        [buffer = waveformLibraryBuffer](void *, size_t, size_t) {},
+        /*dataIsMutable=*/false);
+    samplesAttr = DenseF64ResourceElementsAttr::get(
+        samplesType, wfrName.getValue(), std::move(blob));
+  } else {
+    llvm::SmallVector<double> samplesCopy;
+    waveformLibrary->getSamples(*index, samplesCopy);
+    samplesAttr =
+        DenseFPElementsAttr::get(samplesType, ArrayRef<double>(samplesCopy));
   }
-  return openedWfrs[wfrName];
+
+  auto wfrOp = builder.create<Waveform_CreateOp>(
+      mainFuncFirstOp->getLoc(), WaveformType::get(context), samplesAttr);
+  wfrOp->setAttr("pulse.waveformName", wfrName);
+  return wfrOp;
 }
 
-void QUIRToPulsePass::parsePulseWaveformContainerOps(
+LogicalResult QUIRToPulsePass::parsePulseWaveformContainerOps(
     std::string &waveformContainerPath) {
-  std::string errorMessage;
-  llvm::SourceMgr sourceMgr;
-  std::unique_ptr<llvm::MemoryBuffer> waveformContainerFile =
-      mlir::openInputFile(waveformContainerPath, &errorMessage);
-  sourceMgr.AddNewSourceBuffer(std::move(waveformContainerFile), llvm::SMLoc());
-
-  mlir::OwningOpRef<mlir::ModuleOp> waveformContainerFileModule =
-      mlir::parseSourceFile<mlir::ModuleOp>(sourceMgr, &getContext());
-  assert(waveformContainerFileModule and
-         "problem parsing waveform container file");
-
-  auto waveformContainerFileModuleRelease =
-      waveformContainerFileModule.release();
-  waveformContainerFileModuleRelease->walk([&](mlir::pulse::Waveform_CreateOp
-                                                   wfrOp) {
-    auto wfrName =
-        wfrOp->getAttrOfType<StringAttr>("pulse.waveformName").getValue().str();
+  waveformLibrary.reset();
+  waveformLibraryBuffer.reset();
+
+  // waveform libraries are mapped and only their index is read here, the
+  // samples of a waveform are read once it is used. The file must be
+  // replaced rather than rewritten in place while it is mapped.
+  auto bufferOrError = llvm::MemoryBuffer::getFile(
+      waveformContainerPath, /*IsText=*/false,
+      /*RequiresNullTerminator=*/false);
+  if (bufferOrError && WaveformLibraryView::isWaveformLibrary(
+                           (*bufferOrError)->getBuffer())) {
+    auto viewOrError =
+        WaveformLibraryView::create((*bufferOrError)->getBuffer());
+    if (!viewOrError) {
+      getOperation()->emitError()
+          << "problem reading waveform library file: "
+          << llvm::toString(viewOrError.takeError());
+      return failure();
+    }
+    waveformLibraryBuffer = std::move(*bufferOrError);
+    waveformLibrary = *viewOrError;
+    waveformContainerModule = PulseCalsCache::LazyModule();
+    pulseNameToWaveformMap.clear();
+    return success();
+  }
+
+  // waveform containers are parsed once per process and reloaded when they
+  // change
+  auto moduleOrError =
+      PulseCalsCache::get().load(waveformContainerPath, &getContext());
+  if (!moduleOrError) {
+    getOperation()->emitError()
+        << "problem parsing waveform container file: "
+        << llvm::toString(moduleOrError.takeError());
+    return failure();
+  }
+  waveformContainerModule = std::move(*moduleOrError);
+  pulseNameToWaveformMap.clear();
+
+  waveformContainerModule.get().walk([&](mlir::pulse::Waveform_CreateOp
+                                             wfrOp) {
+    auto wfrName = wfrOp->getAttrOfType<StringAttr>("pulse.waveformName");
     pulseNameToWaveformMap[wfrName] = wfrOp;
   });
+  return success();
 }
 
 llvm::StringRef QUIRToPulsePass::getArgument() const { return "quir-to-pulse"; }
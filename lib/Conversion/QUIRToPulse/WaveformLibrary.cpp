@@ -0,0 +1,476 @@
+//===- WaveformLibrary.cpp - Indexed waveform sample files ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements the waveform library format, a waveform container
+/// that is indexed without parsing, and the pass writing it.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Conversion/QUIRToPulse/WaveformLibrary.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/WaveformSampling.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/ADT/bit.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/SwapByteOrder.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+using WLV = WaveformLibraryView;
+
+// each sample is a pair of doubles
+constexpr uint64_t bytesPerSample = 2 * sizeof(double);
+// the number of segments preceding the segment table of a compact waveform
+constexpr uint64_t segmentCountSize = sizeof(WLV::ulittle64_t);
+
+template <typename T>
+void writeRecord(llvm::raw_ostream &os, const T &record) {
+  os.write(reinterpret_cast<const char *>(&record), sizeof(T));
+}
+
+uint64_t getCompactSize(uint64_t numSegments, uint64_t numSampled) {
+  return segmentCountSize + numSegments * sizeof(WLV::SegmentRecord) +
+         numSampled * bytesPerSample;
+}
+
+uint64_t getCompactSize(const CompactWaveform &compact) {
+  return getCompactSize(compact.segments.size(), compact.samples.size() / 2);
+}
+
+void writeSamples(llvm::raw_ostream &os, llvm::ArrayRef<double> samples) {
+  if (llvm::sys::IsLittleEndianHost) {
+    os.write(reinterpret_cast<const char *>(samples.data()),
+             samples.size() * sizeof(double));
+    return;
+  }
+  for (double const sample : samples)
+    llvm::support::endian::write(os, sample, llvm::support::little);
+}
+
+void readSamples(llvm::ArrayRef<char> bytes,
+                 llvm::SmallVectorImpl<double> &samples) {
+  samples.resize(bytes.size() / sizeof(double));
+  for (size_t i = 0, e = samples.size(); i < e; ++i)
+    samples[i] = llvm::support::endian::read<double, llvm::support::little,
+                                             llvm::support::unaligned>(
+        bytes.data() + i * sizeof(double));
+}
+
+// A waveform to write: its samples, unless only available compactly, and its
+// compact encoding if that is to be written
+struct LibraryWaveform {
+  llvm::StringRef name;
+  llvm::ArrayRef<double> samples;
+  const CompactWaveform *compact;
+};
+} // anonymous namespace
+
+bool WaveformLibraryView::isWaveformLibrary(llvm::StringRef buffer) {
+  return buffer.starts_with(llvm::StringRef(magic, sizeof(magic)));
+}
+
+llvm::Expected<WaveformLibraryView>
+WaveformLibraryView::create(llvm::StringRef buffer) {
+  auto invalid = [](const llvm::Twine &msg) {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Invalid waveform library: " + msg);
+  };
+
+  if (buffer.size() < sizeof(Header) || !isWaveformLibrary(buffer))
+    return invalid("missing header");
+
+  const auto *header = reinterpret_cast<const Header *>(buffer.data());
+  if (header->version != version && header->version != expandedVersion)
+    return invalid("unsupported version " +
+                   llvm::Twine(static_cast<uint32_t>(header->version)));
+
+  uint64_t const indexSize =
+      uint64_t{header->numWaveforms} * sizeof(WaveformRecord);
+  uint64_t const stringsEnd =
+      sizeof(Header) + indexSize + header->stringTableSize;
+  if (stringsEnd > buffer.size())
+    return invalid("index out of bounds");
+
+  WaveformLibraryView view;
+  view.buffer = buffer;
+  const char *data = buffer.data() + sizeof(Header);
+  view.waveforms = {reinterpret_cast<const WaveformRecord *>(data),
+                    header->numWaveforms};
+  data += indexSize;
+  view.stringTable = {data, header->stringTableSize};
+
+  // the segments of a compact waveform must add up to its samples, and its
+  // sampled segments must fit into the buffer
+  auto isValidCompact = [&](const WaveformRecord &record) {
+    uint64_t const available = buffer.size() - record.samplesOffset;
+    if (available < segmentCountSize)
+      return false;
+    uint64_t const numSegments = llvm::support::endian::read64le(
+        buffer.data() + record.samplesOffset);
+    if (numSegments > (available - segmentCountSize) / sizeof(SegmentRecord))
+      return false;
+    llvm::ArrayRef<SegmentRecord> const segments(
+        reinterpret_cast<const SegmentRecord *>(
+            buffer.data() + record.samplesOffset + segmentCountSize),
+        numSegments);
+    uint64_t numSamples = 0;
+    uint64_t numSampled = 0;
+    for (const SegmentRecord &segment : segments) {
+      if (segment.numSamples > record.numSamples - numSamples)
+        return false;
+      numSamples += segment.numSamples;
+      if (!segment.constant)
+        numSampled += segment.numSamples;
+    }
+    return numSamples == record.numSamples &&
+           numSampled <= (available - getCompactSize(numSegments, 0)) /
+                             bytesPerSample;
+  };
+
+  // every name must point into the terminated table, names must be ordered
+  // for the binary search, and the samples must follow the table
+  if (!view.stringTable.empty() && view.stringTable.back() != '\0')
+    return invalid("unterminated string table");
+  for (size_t i = 0, e = view.size(); i < e; ++i) {
+    const WaveformRecord &record = view.waveforms[i];
+    if (record.nameId >= view.stringTable.size())
+      return invalid("waveform name out of bounds");
+    if (i > 0 && !(view.getName(i - 1) < view.getName(i)))
+      return invalid("waveforms are not ordered by name at " +
+                     view.getName(i));
+    uint64_t const offset = record.samplesOffset;
+    bool const compact = record.flags & compactFlag;
+    if (offset < stringsEnd || offset % alignof(double) != 0 ||
+        offset > buffer.size() ||
+        (compact ? !isValidCompact(record)
+                 : uint64_t{record.numSamples} >
+                       (buffer.size() - offset) / bytesPerSample))
+      return invalid("samples of " + view.getName(i) + " out of bounds");
+  }
+  return view;
+}
+
+std::optional<size_t>
+WaveformLibraryView::find(llvm::StringRef name) const {
+  const auto *it = llvm::partition_point(
+      waveforms, [&](const WaveformRecord &record) {
+        return llvm::StringRef(stringTable.data() + record.nameId) < name;
+      });
+  auto const index = static_cast<size_t>(it - waveforms.begin());
+  if (index == size() || getName(index) != name)
+    return std::nullopt;
+  return index;
+}
+
+llvm::ArrayRef<WaveformLibraryView::SegmentRecord>
+WaveformLibraryView::getSegments_(size_t waveform) const {
+  const char *data = buffer.data() + waveforms[waveform].samplesOffset;
+  return {reinterpret_cast<const SegmentRecord *>(data + segmentCountSize),
+          static_cast<size_t>(llvm::support::endian::read64le(data))};
+}
+
+llvm::ArrayRef<char>
+WaveformLibraryView::getSampleBytes(size_t waveform) const {
+  const WaveformRecord &record = waveforms[waveform];
+  uint64_t size = record.numSamples * bytesPerSample;
+  if (isCompact(waveform)) {
+    auto segments = getSegments_(waveform);
+    uint64_t numSampled = 0;
+    for (const SegmentRecord &segment : segments)
+      if (!segment.constant)
+        numSampled += segment.numSamples;
+    size = getCompactSize(segments.size(), numSampled);
+  }
+  return {buffer.data() + record.samplesOffset, static_cast<size_t>(size)};
+}
+
+std::optional<llvm::ArrayRef<double>>
+WaveformLibraryView::getSamples(size_t waveform) const {
+  if (isCompact(waveform))
+    return std::nullopt;
+  llvm::ArrayRef<char> const bytes = getSampleBytes(waveform);
+  if (!llvm::sys::IsLittleEndianHost ||
+      reinterpret_cast<uintptr_t>(bytes.data()) % alignof(double) != 0)
+    return std::nullopt;
+  return llvm::ArrayRef<double>(reinterpret_cast<const double *>(bytes.data()),
+                                bytes.size() / sizeof(double));
+}
+
+void WaveformLibraryView::getSamples(
+    size_t waveform, llvm::SmallVectorImpl<double> &samples) const {
+  if (auto view = getSamples(waveform)) {
+    samples.assign(view->begin(), view->end());
+    return;
+  }
+  if (isCompact(waveform)) {
+    CompactWaveform compact;
+    getCompactWaveform(waveform, compact);
+    compact.expand(samples);
+    return;
+  }
+  readSamples(getSampleBytes(waveform), samples);
+}
+
+void WaveformLibraryView::getCompactWaveform(size_t waveform,
+                                             CompactWaveform &compact) const {
+  compact.clear();
+  if (!isCompact(waveform)) {
+    llvm::SmallVector<double> samples;
+    getSamples(waveform, samples);
+    compact.appendSamples(samples);
+    return;
+  }
+
+  auto segments = getSegments_(waveform);
+  llvm::ArrayRef<char> const sampledBytes =
+      getSampleBytes(waveform).drop_front(getCompactSize(segments.size(), 0));
+  llvm::SmallVector<double> sampled;
+  readSamples(sampledBytes, sampled);
+  llvm::ArrayRef<double> remaining = sampled;
+  for (const SegmentRecord &segment : segments) {
+    if (segment.constant) {
+      compact.appendConstant(
+          segment.numSamples,
+          {llvm::bit_cast<double>(uint64_t{segment.value[0]}),
+           llvm::bit_cast<double>(uint64_t{segment.value[1]})});
+      continue;
+    }
+    compact.appendSamples(remaining.take_front(2 * segment.numSamples));
+    remaining = remaining.drop_front(2 * segment.numSamples);
+  }
+}
+
+namespace {
+void writeLibrary(llvm::ArrayRef<LibraryWaveform> waveforms,
+                  llvm::raw_ostream &os) {
+  llvm::SmallVector<size_t> order(llvm::seq<size_t>(0, waveforms.size()));
+  llvm::sort(order, [&](size_t lhs, size_t rhs) {
+    return waveforms[lhs].name < waveforms[rhs].name;
+  });
+
+  std::string stringTable;
+  llvm::SmallVector<uint32_t> nameIds(waveforms.size());
+  for (size_t const i : order) {
+    nameIds[i] = static_cast<uint32_t>(stringTable.size());
+    stringTable.append(waveforms[i].name.data(), waveforms[i].name.size());
+    stringTable.push_back('\0');
+  }
+
+  bool const anyCompact =
+      llvm::any_of(waveforms, [](const LibraryWaveform &waveform) {
+        return waveform.compact != nullptr;
+      });
+  WLV::Header header;
+  std::memcpy(header.magic, WLV::magic, sizeof(header.magic));
+  header.version = anyCompact ? WLV::version : WLV::expandedVersion;
+  header.numWaveforms = static_cast<uint32_t>(waveforms.size());
+  header.stringTableSize = static_cast<uint32_t>(stringTable.size());
+  header.reserved = 0;
+  writeRecord(os, header);
+
+  uint64_t const stringsEnd = sizeof(WLV::Header) +
+                              waveforms.size() * sizeof(WLV::WaveformRecord) +
+                              stringTable.size();
+  uint64_t offset = llvm::alignTo(stringsEnd, alignof(double));
+  for (size_t const i : order) {
+    const LibraryWaveform &waveform = waveforms[i];
+    assert(waveform.samples.size() % 2 == 0 &&
+           "waveform samples must be pairs of real and imaginary parts");
+    WLV::WaveformRecord record;
+    record.nameId = nameIds[i];
+    record.flags = waveform.compact ? WLV::compactFlag : 0;
+    record.samplesOffset = offset;
+    if (waveform.compact) {
+      record.numSamples = waveform.compact->getNumSamples();
+      offset += getCompactSize(*waveform.compact);
+    } else {
+      record.numSamples = waveform.samples.size() / 2;
+      offset += waveform.samples.size() * sizeof(double);
+    }
+    writeRecord(os, record);
+  }
+  os << stringTable;
+  os.write_zeros(llvm::alignTo(stringsEnd, alignof(double)) - stringsEnd);
+
+  for (size_t const i : order) {
+    const CompactWaveform *compact = waveforms[i].compact;
+    if (!compact) {
+      writeSamples(os, waveforms[i].samples);
+      continue;
+    }
+    llvm::support::endian::write<uint64_t>(os, compact->segments.size(),
+                                           llvm::support::little);
+    for (const auto &segment : compact->segments) {
+      WLV::SegmentRecord record;
+      record.numSamples = segment.numSamples;
+      record.constant = segment.constant ? 1 : 0;
+      record.value[0] = llvm::bit_cast<uint64_t>(segment.value.real());
+      record.value[1] = llvm::bit_cast<uint64_t>(segment.value.imag());
+      writeRecord(os, record);
+    }
+    writeSamples(os, compact->samples);
+  }
+}
+} // anonymous namespace
+
+void mlir::pulse::writeWaveformLibrary(
+    llvm::ArrayRef<std::pair<llvm::StringRef, llvm::ArrayRef<double>>>
+        waveforms,
+    llvm::raw_ostream &os, WaveformEncoding encoding, int64_t minRunLength) {
+  llvm::SmallVector<LibraryWaveform> libraryWaveforms;
+  // compact waveforms are only stored where they are smaller
+  std::deque<CompactWaveform> compacts;
+  for (const auto &[name, samples] : waveforms) {
+    libraryWaveforms.push_back({name, samples, nullptr});
+    if (encoding != WaveformEncoding::Compact)
+      continue;
+    CompactWaveform &compact = compacts.emplace_back();
+    compactWaveformSamples(samples, minRunLength, compact);
+    if (getCompactSize(compact) < samples.size() * sizeof(double))
+      libraryWaveforms.back().compact = &compact;
+  }
+  writeLibrary(libraryWaveforms, os);
+}
+
+void mlir::pulse::writeCompactWaveformLibrary(
+    llvm::ArrayRef<std::pair<llvm::StringRef, const CompactWaveform *>>
+        waveforms,
+    llvm::raw_ostream &os) {
+  llvm::SmallVector<LibraryWaveform> libraryWaveforms;
+  for (const auto &[name, compact] : waveforms) {
+    bool const anyConstant =
+        llvm::any_of(compact->segments, [](const auto &segment) {
+          return segment.constant;
+        });
+    // without constant segments the samples are the expanded waveform
+    libraryWaveforms.push_back(
+        {name,
+         anyConstant ? llvm::ArrayRef<double>()
+                     : llvm::ArrayRef<double>(compact->samples),
+         anyConstant ? compact : nullptr});
+  }
+  writeLibrary(libraryWaveforms, os);
+}
+
+llvm::Error mlir::pulse::writeWaveformLibrary(mlir::Operation *op,
+                                              llvm::raw_ostream &os,
+                                              WaveformEncoding encoding,
+                                              int64_t minRunLength) {
+  // a later waveform of the same name replaces an earlier one, as when
+  // QUIRToPulsePass parses the containers
+  std::vector<std::pair<llvm::StringRef, llvm::ArrayRef<double>>> waveforms;
+  llvm::StringMap<size_t> indexByName;
+  // samples which are not stored as doubles in host layout
+  std::deque<llvm::SmallVector<double, 0>> copies;
+
+  auto result = op->walk([&](Waveform_CreateOp waveformOp) {
+    if (!isa<WaveformContainerOp>(waveformOp->getParentOp()))
+      return WalkResult::advance();
+    auto name = waveformOp->getAttrOfType<StringAttr>("pulse.waveformName");
+    if (!name) {
+      waveformOp->emitError() << "waveform in a waveform container has no "
+                                 "pulse.waveformName";
+      return WalkResult::interrupt();
+    }
+    llvm::ArrayRef<double> samples;
+    if (auto sampleData = waveformOp.getSampleData()) {
+      samples = *sampleData;
+    } else {
+      auto values = waveformOp.getSamples().tryGetValues<double>();
+      if (failed(values)) {
+        waveformOp->emitError() << "waveform samples must be f64";
+        return WalkResult::interrupt();
+      }
+      samples = copies.emplace_back(values->begin(), values->end());
+    }
+    auto [it, inserted] =
+        indexByName.try_emplace(name.getValue(), waveforms.size());
+    if (inserted)
+      waveforms.emplace_back(name.getValue(), samples);
+    else
+      waveforms[it->second].second = samples;
+    return WalkResult::advance();
+  });
+  if (result.wasInterrupted())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to collect the waveforms");
+
+  writeWaveformLibrary(waveforms, os, encoding, minRunLength);
+  return llvm::Error::success();
+}
+
+void WriteWaveformLibraryPass::runOnOperation() {
+  if (outputFile.empty()) {
+    getOperation()->emitError() << "no waveform library file specified";
+    return signalPassFailure();
+  }
+
+  std::string errorMessage;
+  auto output = mlir::openOutputFile(outputFile, &errorMessage);
+  if (!output) {
+    getOperation()->emitError()
+        << "failed to open the waveform library file: " << errorMessage;
+    return signalPassFailure();
+  }
+  auto encoding =
+      compact ? WaveformEncoding::Compact : WaveformEncoding::Expanded;
+  if (auto err = writeWaveformLibrary(getOperation(), output->os(), encoding,
+                                      minRunLength)) {
+    getOperation()->emitError() << llvm::toString(std::move(err));
+    return signalPassFailure();
+  }
+  output->keep();
+  markAllAnalysesPreserved();
+} // runOnOperation
+
+llvm::StringRef WriteWaveformLibraryPass::getArgument() const {
+  return "pulse-write-waveform-library";
+}
+
+llvm::StringRef WriteWaveformLibraryPass::getDescription() const {
+  return "Write the waveform containers of the module to an indexed waveform "
+         "library file";
+}
+
+llvm::StringRef WriteWaveformLibraryPass::getName() const {
+  return "Write Waveform Library Pass";
+}
@@ -1,6 +1,6 @@
 //===- SwitchOpLowering.cpp -------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -19,26 +19,102 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "Conversion/QUIRToStandard/SwitchOpLowering.h"
+
 #include "Dialect/QUIR/IR/QUIROps.h"
 
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
-#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/ValueRange.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <vector>
 
 namespace mlir::quir {
 
-// llvm.switch i32 %flag, label switchEnd [
-//     i32 caseVal_1 : label caseRegion_1
-//     i32 caseVal_2 : label caseRegion_2
+namespace {
+// the fewest cases, and the smallest percentage of the range of case values
+// taken by cases, for which a jump table pays off, as in LLVM's own switch
+// lowering
+constexpr size_t minJumpTableCases = 4;
+constexpr uint64_t minJumpTableDensity = 40;
+// the most cases of a sparse switch which are compared one after the other
+// rather than left to the binary search of the backend
+constexpr size_t maxCompareChainCases = 4;
+
+bool isDenseCaseSet(llvm::ArrayRef<int64_t> caseValues) {
+  if (caseValues.size() < minJumpTableCases)
+    return false;
+  auto [minIt, maxIt] =
+      std::minmax_element(caseValues.begin(), caseValues.end());
+  uint64_t const range = static_cast<uint64_t>(*maxIt - *minIt) + 1;
+  return caseValues.size() * 100 >= range * minJumpTableDensity;
+}
+
+// Whether to dispatch with a cf.switch, which the backend emits as a jump
+// table for dense case values, or with a chain of comparisons
+bool useSwitchDispatch(llvm::ArrayRef<int64_t> caseValues) {
+  return isDenseCaseSet(caseValues) ||
+         caseValues.size() > maxCompareChainCases;
+}
+
+// Branch to the first of caseBlocks whose case value equals flag, or to
+// defaultBlock, comparing the case values in turn
+void createCompareChain(PatternRewriter &rewriter, Location loc, Value flag,
+                        Block *condBlock, Block *defaultBlock,
+                        llvm::ArrayRef<int64_t> caseValues,
+                        llvm::ArrayRef<Block *> caseBlocks) {
+  Block *testBlock = condBlock;
+  for (size_t i = 0, e = caseValues.size(); i < e; ++i) {
+    Block *nextBlock =
+        i + 1 == e ? defaultBlock : rewriter.createBlock(defaultBlock);
+    rewriter.setInsertionPointToEnd(testBlock);
+    Value const caseValue =
+        rewriter.create<arith::ConstantIntOp>(loc, caseValues[i], 32);
+    Value const isCase = rewriter.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::eq, flag, caseValue);
+    rewriter.create<cf::CondBranchOp>(loc, isCase, caseBlocks[i], ValueRange(),
+                                      nextBlock, ValueRange());
+    testBlock = nextBlock;
+  }
+  if (caseValues.empty()) {
+    rewriter.setInsertionPointToEnd(condBlock);
+    rewriter.create<cf::BranchOp>(loc, defaultBlock);
+  }
+}
+} // anonymous namespace
+
+// Dense case values, or many sparse ones, are dispatched with
+//
+// cf.switch %flag : i32, [
+//     default: ^caseRegion_default,
+//     caseVal_1: ^caseRegion_1,
+//     caseVal_2: ^caseRegion_2
 //   ...
 // ]
+//
+// and a few sparse case values with a chain of comparisons
+//
+//     %is_1 = arith.cmpi eq, %flag, caseVal_1
+//     cf.cond_br %is_1, ^caseRegion_1, ^test_2
+// ^test_2:
+//     %is_2 = arith.cmpi eq, %flag, caseVal_2
+//     cf.cond_br %is_2, ^caseRegion_2, ^caseRegion_default
+//
+// followed in both cases by
+//
 // caseRegion_default:
 //     // gates
 //    cf.br switchEnd
@@ -104,12 +180,24 @@ SwitchOpLowering::matchAndRewrite(SwitchOp switchOp,
       rewriter.inlineRegionBefore(region, continueBlock);
     }
 
-  rewriter.setInsertionPointToEnd(condBlock);
-  rewriter.create<LLVM::SwitchOp>(
-      loc, /*flag=*/switchOp.getFlag(), /*defaultDestination=*/defaultBlock,
-      /*defaultOperands=*/ValueRange(),
-      /*caseValues=*/switchOp.getCaseValues(), /*caseDestinations=*/caseBlocks,
-      /*caseOperands=*/caseOperands);
+  SmallVector<int64_t> caseValues;
+  for (const APInt &caseValue : switchOp.getCaseValues().getValues<APInt>())
+    caseValues.push_back(caseValue.getSExtValue());
+  assert(caseValues.size() == caseBlocks.size() &&
+         "expected one case region per case value");
+
+  if (useSwitchDispatch(caseValues)) {
+    rewriter.setInsertionPointToEnd(condBlock);
+    rewriter.create<cf::SwitchOp>(
+        loc, /*flag=*/switchOp.getFlag(), /*defaultDestination=*/defaultBlock,
+        /*defaultOperands=*/ValueRange(),
+        /*caseValues=*/switchOp.getCaseValues(),
+        /*caseDestinations=*/caseBlocks,
+        /*caseOperands=*/caseOperands);
+  } else {
+    createCompareChain(rewriter, loc, switchOp.getFlag(), condBlock,
+                       defaultBlock, caseValues, caseBlocks);
+  }
 
   // Ok, we're done!
   rewriter.replaceOp(switchOp, continueBlock->getArguments());
@@ -122,4 +210,39 @@ void populateSwitchOpLoweringPatterns(RewritePatternSet &patterns) {
   patterns.add<SwitchOpLowering>(context);
 }
 
+void TestSwitchOpLoweringPass::runOnOperation() {
+  // A partial conversion rather than the greedy driver, which would hoist
+  // the constants of the case regions into the entry block
+  ConversionTarget target(getContext());
+  target.addIllegalOp<SwitchOp>();
+  target.markUnknownOpDynamicallyLegal([](Operation *) { return true; });
+
+  RewritePatternSet patterns(&getContext());
+  populateSwitchOpLoweringPatterns(patterns);
+  if (failed(
+          applyPartialConversion(getOperation(), target, std::move(patterns))))
+    signalPassFailure();
+}
+
+void TestSwitchOpLoweringPass::getDependentDialects(
+    DialectRegistry &registry) const {
+  registry.insert<arith::ArithDialect, cf::ControlFlowDialect>();
+}
+
+llvm::StringRef TestSwitchOpLoweringPass::getArgument() const {
+  return "test-switch-op-lowering";
+}
+
+llvm::StringRef TestSwitchOpLoweringPass::getDescription() const {
+  return "Test the lowering of quir.switch to the cf dialect.";
+}
+
+llvm::StringRef TestSwitchOpLoweringPass::getName() const {
+  return "Test Switch Op Lowering Pass";
+}
+
+void registerQUIRToStdTestPasses() {
+  PassRegistration<TestSwitchOpLoweringPass>();
+}
+
 }; // namespace mlir::quir
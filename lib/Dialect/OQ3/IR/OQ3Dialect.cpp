@@ -1,6 +1,6 @@
 //===- OQ3Dialect.cpp - OpenQASM 3 dialect ----------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -19,6 +19,11 @@
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/OQ3/IR/OQ3Types.h"
 
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/Transforms/InliningUtils.h"
 
 using namespace mlir;
@@ -65,3 +70,15 @@ void OQ3Dialect::initialize() {
 
   addInterfaces<OQ3InlinerInterface>();
 }
+
+/// Materialize the constants of folded ops: angles as QUIR constants and
+/// other values, e.g., comparison results, as arith constants
+Operation *OQ3Dialect::materializeConstant(OpBuilder &builder, Attribute value,
+                                           Type type, Location loc) {
+  if (auto angleAttr = value.dyn_cast<quir::AngleAttr>())
+    return builder.create<quir::ConstantOp>(loc, type, angleAttr);
+  if (auto typedAttr = value.dyn_cast<TypedAttr>();
+      typedAttr && arith::ConstantOp::isBuildableWith(typedAttr, type))
+    return builder.create<arith::ConstantOp>(loc, type, typedAttr);
+  return nullptr;
+}
@@ -1,6 +1,6 @@
 //===- OQ3Ops.cpp - OpenQASM 3 dialect ops ----------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -14,6 +14,7 @@
 
 #include "Dialect/OQ3/IR/OQ3Ops.h"
 
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 
 #include "mlir/IR/BuiltinAttributes.h"
@@ -25,6 +26,9 @@
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
@@ -200,6 +204,112 @@ UseArrayElementOp::verifySymbolUses(SymbolTableCollection &symbolTable) {
 // Binary / Unary Ops
 //===----------------------------------------------------------------------===//
 
+//===----------------------------------------------------------------------===//
+// Angle ops
+//===----------------------------------------------------------------------===//
+
+namespace {
+// angle wrapped into [0, 2*pi), in its own semantics
+llvm::APFloat wrapAngle(llvm::APFloat angle) {
+  llvm::APFloat twoPi(2 * llvm::numbers::pi);
+  bool losesInfo;
+  twoPi.convert(angle.getSemantics(), llvm::APFloat::rmNearestTiesToEven,
+                &losesInfo);
+  angle.mod(twoPi);
+  if (angle.isNegative())
+    angle.add(twoPi, llvm::APFloat::rmNearestTiesToEven);
+  // a tiny negative angle may round up to 2*pi, and -0 to 2*pi
+  if (angle.isZero() || angle.compare(twoPi) != llvm::APFloat::cmpLessThan)
+    return llvm::APFloat::getZero(angle.getSemantics());
+  return angle;
+}
+
+// Fold a binary angle op on the constant angles lhs and rhs by applying
+// apply to the value of lhs, in full precision, and wrapping the result
+template <typename ApplyFn>
+OpFoldResult foldAngleBinaryOp(Attribute lhs, Attribute rhs, Type resultType,
+                               ApplyFn apply) {
+  auto lhsAttr = lhs.dyn_cast_or_null<quir::AngleAttr>();
+  auto rhsAttr = rhs.dyn_cast_or_null<quir::AngleAttr>();
+  auto angleType = resultType.dyn_cast<quir::AngleType>();
+  if (!lhsAttr || !rhsAttr || !angleType)
+    return {};
+
+  llvm::APFloat value = lhsAttr.getValue();
+  llvm::APFloat rhsValue = rhsAttr.getValue();
+  bool losesInfo;
+  rhsValue.convert(value.getSemantics(), llvm::APFloat::rmNearestTiesToEven,
+                   &losesInfo);
+  auto const status = apply(value, rhsValue);
+  if ((status & (llvm::APFloat::opInvalidOp | llvm::APFloat::opDivByZero)) ||
+      !value.isFinite())
+    return {};
+  return quir::AngleAttr::get(resultType.getContext(), angleType,
+                              wrapAngle(value));
+}
+} // anonymous namespace
+
+OpFoldResult AngleAddOp::fold(FoldAdaptor adaptor) {
+  return foldAngleBinaryOp(
+      adaptor.getLhs(), adaptor.getRhs(), getType(),
+      [](llvm::APFloat &lhs, const llvm::APFloat &rhs) {
+        return lhs.add(rhs, llvm::APFloat::rmNearestTiesToEven);
+      });
+}
+
+OpFoldResult AngleSubOp::fold(FoldAdaptor adaptor) {
+  return foldAngleBinaryOp(
+      adaptor.getLhs(), adaptor.getRhs(), getType(),
+      [](llvm::APFloat &lhs, const llvm::APFloat &rhs) {
+        return lhs.subtract(rhs, llvm::APFloat::rmNearestTiesToEven);
+      });
+}
+
+OpFoldResult AngleMulOp::fold(FoldAdaptor adaptor) {
+  return foldAngleBinaryOp(
+      adaptor.getLhs(), adaptor.getRhs(), getType(),
+      [](llvm::APFloat &lhs, const llvm::APFloat &rhs) {
+        return lhs.multiply(rhs, llvm::APFloat::rmNearestTiesToEven);
+      });
+}
+
+OpFoldResult AngleDivOp::fold(FoldAdaptor adaptor) {
+  return foldAngleBinaryOp(
+      adaptor.getLhs(), adaptor.getRhs(), getType(),
+      [](llvm::APFloat &lhs, const llvm::APFloat &rhs) {
+        return lhs.divide(rhs, llvm::APFloat::rmNearestTiesToEven);
+      });
+}
+
+OpFoldResult AngleCmpOp::fold(FoldAdaptor adaptor) {
+  auto lhsAttr = adaptor.getLhs().dyn_cast_or_null<quir::AngleAttr>();
+  auto rhsAttr = adaptor.getRhs().dyn_cast_or_null<quir::AngleAttr>();
+  if (!lhsAttr || !rhsAttr)
+    return {};
+
+  // angles in [0, 2*pi) compare as unsigned values, whereas the order of
+  // the signed predicates depends on the lowering of the target
+  llvm::APFloat const lhs = wrapAngle(lhsAttr.getValue());
+  llvm::APFloat rhs = wrapAngle(rhsAttr.getValue());
+  bool losesInfo;
+  rhs.convert(lhs.getSemantics(), llvm::APFloat::rmNearestTiesToEven,
+              &losesInfo);
+  auto const cmp = lhs.compare(rhs);
+  bool const equal = cmp == llvm::APFloat::cmpEqual;
+  bool const less = cmp == llvm::APFloat::cmpLessThan;
+  auto result = llvm::StringSwitch<std::optional<bool>>(getPredicate())
+                    .Case("eq", equal)
+                    .Case("ne", !equal)
+                    .Case("ult", less)
+                    .Case("ule", less || equal)
+                    .Case("ugt", !less && !equal)
+                    .Case("uge", !less)
+                    .Default(std::nullopt);
+  if (!result)
+    return {};
+  return BoolAttr::get(getContext(), *result);
+}
+
 mlir::LogicalResult AngleCmpOp::verify() {
   std::vector predicates = {"eq",  "ne",  "slt", "sle", "sgt",
                             "sge", "ult", "ule", "ugt", "uge"};
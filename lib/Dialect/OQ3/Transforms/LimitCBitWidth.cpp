@@ -1,6 +1,6 @@
 //===- LimitCBitWidth.cpp - limit width of cbit registers -------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -12,6 +12,10 @@
 ///  registers. Registers that are larger than the limit are broken into
 ///  multiple registers of the maximum size.
 ///
+///  Bit accesses are remapped to the bit of the register holding it, such
+///  that each access remains a single op: a load of the wide register only
+///  becomes loads of the registers whose bits are extracted from it.
+///
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/OQ3/Transforms/LimitCBitWidth.h"
@@ -27,6 +31,7 @@
 
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
@@ -149,17 +154,20 @@ void LimitCBitWidthPass::processOp(
     VariableLoadOp variableLoadOp, uint numRegistersRequired,
     uint numRemainingBits,
     llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters) {
-  // load all of the registers
-  llvm::SmallVector<VariableLoadOp> newVariableLoads;
+  // load each register once, on the first extraction of one of its bits
+  llvm::SmallVector<VariableLoadOp> newVariableLoads(numRegistersRequired);
   OpBuilder builder(variableLoadOp);
-  for (uint regNum = 0; regNum < numRegistersRequired; regNum++) {
-    uint const bitWidth =
-        getNewRegisterWidth(regNum, numRegistersRequired, numRemainingBits);
-    newVariableLoads.push_back(builder.create<VariableLoadOp>(
-        variableLoadOp.getLoc(),
-        builder.getType<mlir::quir::CBitType>(bitWidth),
-        newRegisters[regNum].getSymName()));
-  }
+  auto getRegisterLoad = [&](uint64_t regNum) {
+    if (!newVariableLoads[regNum]) {
+      uint const bitWidth =
+          getNewRegisterWidth(regNum, numRegistersRequired, numRemainingBits);
+      newVariableLoads[regNum] = builder.create<VariableLoadOp>(
+          variableLoadOp.getLoc(),
+          builder.getType<mlir::quir::CBitType>(bitWidth),
+          newRegisters[regNum].getSymName());
+    }
+    return newVariableLoads[regNum];
+  };
 
   for (auto *loadUse : variableLoadOp->getUsers()) {
     auto extractBitOp = dyn_cast<CBitExtractBitOp>(loadUse);
@@ -168,7 +176,7 @@ void LimitCBitWidthPass::processOp(
       uint64_t remain;
       std::tie(reg, remain) = remapBit(extractBitOp.getIndex());
       auto newExtract = builder.create<CBitExtractBitOp>(
-          extractBitOp->getLoc(), builder.getI1Type(), newVariableLoads[reg],
+          extractBitOp->getLoc(), builder.getI1Type(), getRegisterLoad(reg),
           builder.getIndexAttr(remain));
       extractBitOp->replaceAllUsesWith(newExtract);
       eraseList_.push_back(extractBitOp);
@@ -216,8 +224,11 @@ void LimitCBitWidthPass::runOnOperation() {
       return;
 
     uint const orgWidth = cbitType.getWidth();
-    uint const numRegistersRequired = cbitType.getWidth() / MAX_CBIT_WIDTH + 1;
-    uint const numRemainingBits = cbitType.getWidth() % MAX_CBIT_WIDTH;
+    // the last register holds the remaining, at least one, bits
+    uint const numRegistersRequired =
+        llvm::divideCeil(cbitType.getWidth(), MAX_CBIT_WIDTH);
+    uint const numRemainingBits =
+        orgWidth - (numRegistersRequired - 1) * MAX_CBIT_WIDTH;
     llvm::SmallVector<mlir::oq3::DeclareVariableOp> newRegisters;
 
     addNewDeclareVariableOps(module, op, numRegistersRequired, numRemainingBits,
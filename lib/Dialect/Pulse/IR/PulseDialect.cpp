@@ -1,6 +1,6 @@
 //===- PulseDialect.cpp - Pulse dialect -------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -27,6 +27,17 @@
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/Pulse/IR/PulseTypes.h"
 
+#include "mlir/Bytecode/BytecodeImplementation.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Types.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/TypeSwitch.h"
+
+#include <cstdint>
+#include <optional>
+
 /// Tablegen Definitions
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/Pulse/IR/PulseDialect.cpp.inc"
@@ -41,8 +52,75 @@
 
 namespace mlir::pulse {
 
+//===----------------------------------------------------------------------===//
+// Bytecode
+//===----------------------------------------------------------------------===//
+
+namespace {
+// The codes identifying the Pulse types in bytecode. Codes must not be
+// reused or reordered, as bytecode outlives the compiler writing it.
+enum class TypeCode : uint64_t {
+  Capture = 0,
+  Frame = 1,
+  Kernel = 2,
+  Port = 3,
+  Waveform = 4,
+  MixedFrame = 5,
+};
+} // anonymous namespace
+
+/// Reads and writes the Pulse types as their codes rather than their
+/// textual form. The waveform samples are builtin dense elements attributes,
+/// which bytecode already encodes natively.
+struct PulseBytecodeInterface : public BytecodeDialectInterface {
+  using BytecodeDialectInterface::BytecodeDialectInterface;
+
+  Type readType(DialectBytecodeReader &reader) const final {
+    uint64_t code;
+    if (failed(reader.readVarInt(code)))
+      return {};
+    switch (static_cast<TypeCode>(code)) {
+    case TypeCode::Capture:
+      return CaptureType::get(getContext());
+    case TypeCode::Frame:
+      return FrameType::get(getContext());
+    case TypeCode::Kernel:
+      return KernelType::get(getContext());
+    case TypeCode::Port:
+      return PortType::get(getContext());
+    case TypeCode::Waveform:
+      return WaveformType::get(getContext());
+    case TypeCode::MixedFrame:
+      return MixedFrameType::get(getContext());
+    }
+    reader.emitError() << "unknown Pulse type code: " << code;
+    return {};
+  }
+
+  LogicalResult writeType(Type type,
+                          DialectBytecodeWriter &writer) const final {
+    auto code = llvm::TypeSwitch<Type, std::optional<TypeCode>>(type)
+                    .Case<CaptureType>([](auto) { return TypeCode::Capture; })
+                    .Case<FrameType>([](auto) { return TypeCode::Frame; })
+                    .Case<KernelType>([](auto) { return TypeCode::Kernel; })
+                    .Case<PortType>([](auto) { return TypeCode::Port; })
+                    .Case<WaveformType>([](auto) { return TypeCode::Waveform; })
+                    .Case<MixedFrameType>(
+                        [](auto) { return TypeCode::MixedFrame; })
+                    .Default([](Type) { return std::nullopt; });
+    if (!code)
+      return failure();
+    writer.writeVarInt(static_cast<uint64_t>(*code));
+    return success();
+  }
+};
+
 void pulse::PulseDialect::initialize() {
 
+  timepointAttrName = StringAttr::get(getContext(), "pulse.timepoint");
+  durationAttrName = StringAttr::get(getContext(), "pulse.duration");
+  setupLatencyAttrName = StringAttr::get(getContext(), "pulse.setupLatency");
+
   addTypes<
 #define GET_TYPEDEF_LIST
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
@@ -60,6 +138,8 @@ void pulse::PulseDialect::initialize() {
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/Pulse/IR/Pulse.cpp.inc"
       >();
+
+  addInterfaces<PulseBytecodeInterface>();
 }
 
 } // namespace mlir::pulse
@@ -1,6 +1,6 @@
 //===- PulseInterfaces.cpp - Pulse dialect interfaces ---------- *- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -19,11 +19,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseDialect.h"
 
-#include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Operation.h"
 
+#include "llvm/Support/Casting.h"
 #include "llvm/Support/Error.h"
 
 #include <cstdint>
@@ -41,36 +44,76 @@ using namespace mlir::pulse;
 // PulseOpSchedulingInterface
 //===----------------------------------------------------------------------===//
 
-std::optional<int64_t> interfaces_impl::getTimepoint(mlir::Operation *op) {
-  if (op->hasAttr("pulse.timepoint"))
-    return op->getAttrOfType<IntegerAttr>("pulse.timepoint").getInt();
+namespace {
+// the scheduling attribute names are interned by the pulse dialect; ops of
+// other dialects fall back to the context in case the pulse dialect is not
+// loaded
+PulseDialect *getPulseDialect(mlir::Operation *op) {
+  if (auto *dialect = llvm::dyn_cast_or_null<PulseDialect>(op->getDialect()))
+    return dialect;
+  return op->getContext()->getLoadedDialect<PulseDialect>();
+}
+
+mlir::StringAttr getSetupLatencyAttrName(mlir::Operation *op) {
+  if (auto *dialect = getPulseDialect(op))
+    return dialect->getSetupLatencyAttrName();
+  return mlir::StringAttr::get(op->getContext(), "pulse.setupLatency");
+}
+
+// MLIR does not have a setUI64IntegerAttr so duration and setup latency
+// are stored as I64IntegerAttr but should be treated as a uint64_t
+std::optional<int64_t> getI64Attr(mlir::Operation *op, mlir::StringAttr name) {
+  if (auto attr = op->getAttrOfType<mlir::IntegerAttr>(name))
+    return attr.getInt();
   return std::nullopt;
 }
 
+void setI64Attr(mlir::Operation *op, mlir::StringAttr name, int64_t value) {
+  // writing an attribute rebuilds the attribute dictionary of the op, skip it
+  // if the value does not change
+  auto attr = op->getAttrOfType<mlir::IntegerAttr>(name);
+  if (attr && attr.getType().isSignlessInteger(64) && attr.getInt() == value)
+    return;
+  auto i64Type = mlir::IntegerType::get(op->getContext(), 64);
+  op->setAttr(name, mlir::IntegerAttr::get(i64Type, value));
+}
+} // anonymous namespace
+
+mlir::StringAttr interfaces_impl::getTimepointAttrName(mlir::Operation *op) {
+  if (auto *dialect = getPulseDialect(op))
+    return dialect->getTimepointAttrName();
+  return mlir::StringAttr::get(op->getContext(), "pulse.timepoint");
+}
+
+mlir::StringAttr interfaces_impl::getDurationAttrName(mlir::Operation *op) {
+  if (auto *dialect = getPulseDialect(op))
+    return dialect->getDurationAttrName();
+  return mlir::StringAttr::get(op->getContext(), "pulse.duration");
+}
+
+std::optional<int64_t> interfaces_impl::getTimepoint(mlir::Operation *op) {
+  return getI64Attr(op, getTimepointAttrName(op));
+}
+
 void interfaces_impl::setTimepoint(mlir::Operation *op, int64_t timepoint) {
-  mlir::OpBuilder builder(op);
-  op->setAttr("pulse.timepoint", builder.getI64IntegerAttr(timepoint));
+  setI64Attr(op, getTimepointAttrName(op), timepoint);
 }
 
-// MLIR does does not have a setUI64IntegerAttr so duration and setup latency
-// are stored as I64IntegerAttr but should be treated as a uint64_t
 std::optional<uint64_t> interfaces_impl::getSetupLatency(Operation *op) {
-  if (op->hasAttr("pulse.setupLatency"))
-    return static_cast<uint64_t>(
-        op->getAttrOfType<IntegerAttr>("pulse.setupLatency").getInt());
+  if (auto setupLatency = getI64Attr(op, getSetupLatencyAttrName(op)))
+    return static_cast<uint64_t>(*setupLatency);
   return std::nullopt;
 }
 
 void interfaces_impl::setSetupLatency(Operation *op, uint64_t setupLatency) {
-  mlir::OpBuilder builder(op);
-  op->setAttr("pulse.setupLatency", builder.getI64IntegerAttr(setupLatency));
+  setI64Attr(op, getSetupLatencyAttrName(op),
+             static_cast<int64_t>(setupLatency));
 }
 
 llvm::Expected<uint64_t>
 interfaces_impl::getDuration(Operation *op, Operation *callSequenceOp) {
-  if (op->hasAttr("pulse.duration"))
-    return static_cast<uint64_t>(
-        op->getAttrOfType<IntegerAttr>("pulse.duration").getInt());
+  if (auto duration = getI64Attr(op, getDurationAttrName(op)))
+    return static_cast<uint64_t>(*duration);
   return llvm::createStringError(
       llvm::inconvertibleErrorCode(),
       "Operation does not have a pulse.duration attribute.");
@@ -85,6 +128,5 @@ llvm::Expected<mlir::ArrayAttr> interfaces_impl::getPorts(mlir::Operation *op) {
 }
 
 void interfaces_impl::setDuration(Operation *op, uint64_t duration) {
-  mlir::OpBuilder builder(op);
-  op->setAttr("pulse.duration", builder.getI64IntegerAttr(duration));
+  setI64Attr(op, getDurationAttrName(op), static_cast<int64_t>(duration));
 }
@@ -1,6 +1,6 @@
 //===- PulseOps.cpp - Pulse dialect ops -------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -38,9 +38,11 @@
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Error.h"
 
@@ -153,7 +155,7 @@ mlir::LogicalResult DelayOp::verify() {
 
 llvm::Expected<uint64_t>
 Waveform_CreateOp::getDuration(mlir::Operation *callSequenceOp = nullptr) {
-  auto shape = (*this).getSamples().getType().getShape();
+  auto shape = (*this).getSamples().getShapedType().getShape();
   if (shape[0] < 0)
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "duration must be >= 0.");
@@ -164,7 +166,10 @@ Waveform_CreateOp::getDuration(mlir::Operation *callSequenceOp = nullptr) {
 mlir::LogicalResult Waveform_CreateOp::verify() {
   // Check that samples has two dimensions: outer is the number of
   // samples, inner is complex numbers with two elements [real, imag]
-  auto attrType = getSamples().getType().cast<mlir::ShapedType>();
+  auto attrType = getSamples().getShapedType();
+  if (!attrType.getElementType().isF64())
+    return emitOpError() << ", which declares a sample waveform, must have "
+                            "f64 samples.";
   auto attrShape = attrType.getShape();
   if (attrShape.size() != 2) {
     return emitOpError() << ", which declares a sample waveform, must be "
@@ -184,6 +189,21 @@ mlir::LogicalResult Waveform_CreateOp::verify() {
   return mlir::success();
 }
 
+std::optional<llvm::ArrayRef<double>> Waveform_CreateOp::getSampleData() {
+  auto samples = getSamples();
+  if (auto denseSamples = samples.dyn_cast<DenseFPElementsAttr>()) {
+    if (denseSamples.isSplat())
+      return std::nullopt;
+    // the raw data of dense f64 elements are the doubles in host layout
+    ArrayRef<char> const rawData = denseSamples.getRawData();
+    return ArrayRef<double>(reinterpret_cast<const double *>(rawData.data()),
+                            denseSamples.getNumElements());
+  }
+  if (auto resourceSamples = samples.dyn_cast<DenseF64ResourceElementsAttr>())
+    return resourceSamples.tryGetAsArrayRef();
+  return std::nullopt;
+}
+
 //===----------------------------------------------------------------------===//
 //
 // end Waveform_CreateOp
@@ -234,7 +254,7 @@ auto CallSequenceOp::getCalleeType() -> FunctionType {
 LogicalResult
 CallSequenceOp::verifySymbolUses(SymbolTableCollection &symbolTable) {
 
-  auto sequenceAttr = (*this)->getAttrOfType<FlatSymbolRefAttr>("callee");
+  auto sequenceAttr = getCalleeAttr();
   if (!sequenceAttr)
     return emitOpError("Requires a 'callee' symbol reference attribute");
 
@@ -244,8 +264,12 @@ CallSequenceOp::verifySymbolUses(SymbolTableCollection &symbolTable) {
     return emitOpError() << "'" << sequenceAttr.getValue()
                          << "' does not reference a valid sequence";
 
-  // Verify the types match
+  // Verify the types match, comparing the uniqued types as a whole first
+  // such that only a mismatch is diagnosed type by type
   auto sequenceType = sequence.getFunctionType();
+  if (llvm::equal(getOperandTypes(), sequenceType.getInputs()) &&
+      llvm::equal(getResultTypes(), sequenceType.getResults()))
+    return success();
 
   if (sequenceType.getNumInputs() != getNumOperands())
     return emitOpError("incorrect number of operands for the callee sequence");
@@ -306,12 +330,12 @@ SequenceOp::getDuration(mlir::Operation *callSequenceOp = nullptr) {
   // the call sequence has duration attribute; e.g., for sequences that receives
   // delay arguments, duration of the sequence can vary depending on the
   // argument, so we look at the duration of call sequence as well
-  if ((*this)->hasAttr("pulse.duration"))
-    return static_cast<uint64_t>(
-        (*this)->getAttrOfType<IntegerAttr>("pulse.duration").getInt());
-  if (callSequenceOp->hasAttr("pulse.duration"))
-    return static_cast<uint64_t>(
-        callSequenceOp->getAttrOfType<IntegerAttr>("pulse.duration").getInt());
+  auto durationAttrName = interfaces_impl::getDurationAttrName(*this);
+  if (auto duration = (*this)->getAttrOfType<IntegerAttr>(durationAttrName))
+    return static_cast<uint64_t>(duration.getInt());
+  if (auto duration =
+          callSequenceOp->getAttrOfType<IntegerAttr>(durationAttrName))
+    return static_cast<uint64_t>(duration.getInt());
   return llvm::createStringError(
       llvm::inconvertibleErrorCode(),
       "Operation does not have a pulse.duration attribute.");
@@ -536,9 +560,9 @@ PlayOp::getDuration(mlir::Operation *callSequenceOp = nullptr) {
   // pulse.duration attribute
   auto callOp = dyn_cast_or_null<CallSequenceOp>(callSequenceOp);
   if (!callOp) {
-    if ((*this)->hasAttr("pulse.duration"))
-      return static_cast<uint64_t>(
-          (*this)->getAttrOfType<IntegerAttr>("pulse.duration").getInt());
+    if (auto duration = (*this)->getAttrOfType<IntegerAttr>(
+            interfaces_impl::getDurationAttrName(*this)))
+      return static_cast<uint64_t>(duration.getInt());
     return llvm::createStringError(
         llvm::inconvertibleErrorCode(),
         "Operation does not have a pulse.duration attribute, and no "
@@ -593,8 +617,13 @@ llvm::Expected<std::string> PlayOp::getWaveformHash(CallSequenceOp callOp) {
   }
 
   if (wfrOp && targetOp) {
-    auto targetHash = mlir::hash_value(targetOp->getLoc());
-    auto wfrHash = mlir::hash_value(wfrOp->getLoc());
+    // the identity does not depend on locations, which need not be unique
+    // or may be dropped: the mixed frame is identified by its uid
+    auto targetHash = llvm::hash_value(cast<MixFrameOp>(targetOp).getUid());
+    // the samples attribute is uniqued, identical waveforms created at
+    // different places hash the same
+    auto wfrHash =
+        mlir::hash_value(cast<Waveform_CreateOp>(wfrOp).getSamples());
     return std::to_string(targetHash) + "_" + std::to_string(wfrHash);
   }
 
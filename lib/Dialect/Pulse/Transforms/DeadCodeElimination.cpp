@@ -0,0 +1,280 @@
+//===- DeadCodeElimination.cpp - Remove dead pulse ops ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for removing frame updates of frames which
+///  are never played or captured on, unused sequence arguments and the pulse
+///  operations which are left without uses.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/DeadCodeElimination.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/IR/PulseTypes.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <vector>
+
+#define DEBUG_TYPE "PulseDeadCodeElimination"
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+
+bool isFrame(Value value) {
+  return value.getType().isa<FrameType, MixedFrameType>();
+}
+
+// Frame liveness of a module. The frame values which refer to the same frame,
+// i.e., the operands of pulse.call_sequence and the matching arguments of the
+// called pulse.sequence, are joined into one class. A class is live if any of
+// its values is played or captured on, or is used by an operation this
+// analysis does not know about.
+class FrameLiveness {
+public:
+  FrameLiveness(ModuleOp module,
+                const llvm::StringMap<SequenceOp> &sequences,
+                const llvm::StringMap<std::vector<CallSequenceOp>> &calls)
+      : sequences(sequences), calls(calls) {
+    module->walk([&](CallSequenceOp callOp) {
+      auto pos = sequences.find(callOp.getCallee());
+      if (pos == sequences.end())
+        return;
+      for (auto [operand, argument] :
+           llvm::zip(callOp.getOperands(), pos->second.getArguments()))
+        if (isFrame(operand))
+          unite(operand, argument);
+    });
+
+    module->walk([&](Operation *op) {
+      for (Value result : op->getResults())
+        if (isFrame(result))
+          markUses(result);
+      for (Region &region : op->getRegions())
+        for (Block &block : region)
+          for (BlockArgument argument : block.getArguments())
+            if (isFrame(argument))
+              markArgument(argument);
+    });
+  }
+
+  // the frame is played or captured on
+  bool isLive(Value frame) { return live.contains(find(frame)); }
+  // the frame is synchronized with other frames by a pulse.barrier
+  bool isSynchronized(Value frame) {
+    return synchronized.contains(find(frame));
+  }
+
+private:
+  const llvm::StringMap<SequenceOp> &sequences;
+  const llvm::StringMap<std::vector<CallSequenceOp>> &calls;
+
+  // union-find over the frame values
+  llvm::DenseMap<Value, Value> parent;
+  llvm::DenseSet<Value> live;
+  llvm::DenseSet<Value> synchronized;
+
+  Value find(Value value) {
+    auto pos = parent.find(value);
+    if (pos == parent.end() || pos->second == value)
+      return value;
+    Value const root = find(pos->second);
+    parent[value] = root;
+    return root;
+  }
+
+  void unite(Value a, Value b) {
+    Value const rootA = find(a);
+    Value const rootB = find(b);
+    if (rootA == rootB)
+      return;
+    parent[rootA] = rootB;
+    if (live.erase(rootA))
+      live.insert(rootB);
+    if (synchronized.erase(rootA))
+      synchronized.insert(rootB);
+  }
+
+  void markArgument(BlockArgument argument) {
+    // frames passed into a sequence without known callers, or into any other
+    // region, are considered observed by the caller
+    auto sequenceOp = dyn_cast<SequenceOp>(argument.getOwner()->getParentOp());
+    if (!sequenceOp || !calls.count(sequenceOp.getSymName()))
+      live.insert(find(argument));
+    markUses(argument);
+  }
+
+  void markUses(Value frame) {
+    for (Operation *user : frame.getUsers()) {
+      if (isa<SetFrequencyOp, ShiftFrequencyOp, SetPhaseOp, ShiftPhaseOp,
+              SetAmplitudeOp, DelayOp>(user))
+        continue;
+      if (isa<BarrierOp>(user)) {
+        synchronized.insert(find(frame));
+        continue;
+      }
+      if (auto callOp = dyn_cast<CallSequenceOp>(user))
+        if (sequences.count(callOp.getCallee()))
+          continue;
+      LLVM_DEBUG(llvm::dbgs() << "Frame observed by " << *user << "\n");
+      live.insert(find(frame));
+    }
+  }
+}; // class FrameLiveness
+
+// Erase the frame updates and delays on frames which are never observed.
+// Delays are kept on frames synchronized by a barrier as they shift the
+// other frames of the barrier.
+void eraseDeadFrameUpdates(ModuleOp module, FrameLiveness &liveness) {
+  llvm::SmallVector<Operation *> deadOps;
+  module->walk([&](Operation *op) {
+    Value target;
+    if (auto setFrequencyOp = dyn_cast<SetFrequencyOp>(op))
+      target = setFrequencyOp.getTarget();
+    else if (auto shiftFrequencyOp = dyn_cast<ShiftFrequencyOp>(op))
+      target = shiftFrequencyOp.getTarget();
+    else if (auto setPhaseOp = dyn_cast<SetPhaseOp>(op))
+      target = setPhaseOp.getTarget();
+    else if (auto shiftPhaseOp = dyn_cast<ShiftPhaseOp>(op))
+      target = shiftPhaseOp.getTarget();
+    else if (auto setAmplitudeOp = dyn_cast<SetAmplitudeOp>(op))
+      target = setAmplitudeOp.getTarget();
+    else if (auto delayOp = dyn_cast<DelayOp>(op)) {
+      if (!liveness.isSynchronized(delayOp.getTarget()))
+        target = delayOp.getTarget();
+    }
+    if (target && !liveness.isLive(target))
+      deadOps.push_back(op);
+  });
+  for (auto *op : deadOps)
+    op->erase();
+}
+
+// Remove the arguments of the called sequences which are unused, along with
+// the matching operands of all of their calls. Removing an operand may leave
+// an argument of the calling sequence unused, which is then revisited.
+void eraseUnusedArguments(
+    llvm::StringMap<SequenceOp> &sequences,
+    llvm::StringMap<std::vector<CallSequenceOp>> &calls) {
+  llvm::SetVector<Operation *> workList;
+  for (auto &entry : calls)
+    if (auto pos = sequences.find(entry.first()); pos != sequences.end())
+      workList.insert(pos->second);
+
+  while (!workList.empty()) {
+    auto sequenceOp = cast<SequenceOp>(workList.pop_back_val());
+    llvm::BitVector unusedArgs(sequenceOp.getNumArguments());
+    for (auto argument : sequenceOp.getArguments())
+      if (argument.use_empty())
+        unusedArgs.set(argument.getArgNumber());
+    if (unusedArgs.none())
+      continue;
+
+    LLVM_DEBUG(llvm::dbgs() << "Removing " << unusedArgs.count()
+                            << " arguments of " << sequenceOp.getSymName()
+                            << "\n");
+    sequenceOp.eraseArguments(unusedArgs);
+
+    for (auto callOp : calls[sequenceOp.getSymName()]) {
+      llvm::SmallVector<Value> erasedOperands;
+      for (auto index : unusedArgs.set_bits())
+        erasedOperands.push_back(callOp.getOperand(index));
+      callOp->eraseOperands(unusedArgs);
+
+      for (Value operand : erasedOperands) {
+        auto argument = operand.dyn_cast<BlockArgument>();
+        if (!argument || !argument.use_empty())
+          continue;
+        auto callerOp =
+            dyn_cast<SequenceOp>(argument.getOwner()->getParentOp());
+        if (callerOp && calls.count(callerOp.getSymName()))
+          workList.insert(callerOp);
+      }
+    }
+  }
+}
+
+// Erase the ports, frames, waveforms and other side effect free operations
+// which are left without uses. Users follow their definitions, hence visiting
+// the operations in reverse erases chains of dead operations at once. The
+// waveforms of a pulse.waveform_container are unused by design and are kept.
+void eraseDeadOps(ModuleOp module) {
+  llvm::SmallVector<Operation *> ops;
+  module->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    if (isa<WaveformContainerOp>(op))
+      return WalkResult::skip();
+    if (op->getNumResults() > 0 && op->getNumRegions() == 0)
+      ops.push_back(op);
+    return WalkResult::advance();
+  });
+  for (auto *op : llvm::reverse(ops))
+    if (isOpTriviallyDead(op))
+      op->erase();
+}
+
+} // end anonymous namespace
+
+void DeadCodeEliminationPass::runOnOperation() {
+  ModuleOp module = getOperation();
+
+  llvm::StringMap<SequenceOp> sequences;
+  llvm::StringMap<std::vector<CallSequenceOp>> calls;
+  module->walk([&](Operation *op) {
+    if (auto sequenceOp = dyn_cast<SequenceOp>(op))
+      sequences[sequenceOp.getSymName()] = sequenceOp;
+    else if (auto callOp = dyn_cast<CallSequenceOp>(op))
+      calls[callOp.getCallee()].push_back(callOp);
+  });
+
+  {
+    FrameLiveness liveness(module, sequences, calls);
+    eraseDeadFrameUpdates(module, liveness);
+  }
+  eraseUnusedArguments(sequences, calls);
+  eraseDeadOps(module);
+}
+
+llvm::StringRef DeadCodeEliminationPass::getArgument() const {
+  return "pulse-dce";
+}
+
+llvm::StringRef DeadCodeEliminationPass::getDescription() const {
+  return "Remove frame updates of unobserved frames, unused sequence "
+         "arguments and unused pulse operations";
+}
+
+llvm::StringRef DeadCodeEliminationPass::getName() const {
+  return "Pulse Dead Code Elimination Pass";
+}
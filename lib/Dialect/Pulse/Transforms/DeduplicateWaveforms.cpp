@@ -0,0 +1,179 @@
+//===- DeduplicateWaveforms.cpp - Intern waveforms by content ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for deduplicating pulse.create_waveform
+///  operations by the content of their samples.
+///
+///  Dense elements attributes are uniqued by the MLIR context, so waveforms
+///  with identical samples share the same samples attribute no matter where
+///  they were created. The pass:
+///   - replaces repeated pulse.create_waveform operations with identical
+///     samples in the same block by the first one,
+///   - interns one copy of each unique waveform in the module level
+///     pulse.waveform_container, creating it if needed,
+///   - labels every remaining pulse.create_waveform with the
+///     pulse.waveformName of its interned copy.
+///
+///  Interned waveforms keep an existing pulse.waveformName where possible and
+///  are otherwise named after a hash of their samples, which is stable across
+///  runs. The container has no uses, so this pass should run after the last
+///  pass that removes dead operations, e.g. right before payload generation.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/DeduplicateWaveforms.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/xxhash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+uint64_t hashBytes(const void *data, size_t size) {
+  return llvm::xxh3_64bits(
+      ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(data), size));
+}
+
+// unlike hash_value of the uniqued attribute, this hash only depends on the
+// samples, so that the generated names are reproducible
+uint64_t hashSamples(Waveform_CreateOp waveformOp) {
+  if (auto sampleData = waveformOp.getSampleData())
+    return hashBytes(sampleData->data(), sampleData->size() * sizeof(double));
+
+  auto samples = waveformOp.getSamples();
+  if (auto denseSamples = samples.dyn_cast<DenseElementsAttr>()) {
+    // splat attributes store a single element, also hash the number of
+    // samples
+    ArrayRef<char> const rawData = denseSamples.getRawData();
+    auto const numSamples = static_cast<uint64_t>(samples.getNumElements());
+    return hashBytes(rawData.data(), rawData.size()) ^
+           hashBytes(&numSamples, sizeof(numSamples));
+  }
+  // a resource whose data has been released
+  auto key = samples.cast<DenseResourceElementsAttr>().getRawHandle().getKey();
+  return hashBytes(key.data(), key.size());
+}
+} // anonymous namespace
+
+void DeduplicateWaveformsPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+  auto waveformNameAttrName =
+      StringAttr::get(&getContext(), "pulse.waveformName");
+
+  // the waveform table, keyed by the uniqued samples attribute
+  llvm::DenseMap<Attribute, StringAttr> internedNames;
+  llvm::StringSet<> usedNames;
+
+  WaveformContainerOp containerOp;
+  for (auto op : moduleOp.getOps<WaveformContainerOp>()) {
+    containerOp = op;
+    break;
+  }
+  if (containerOp) {
+    for (auto waveformOp :
+         containerOp.getBody().getOps<Waveform_CreateOp>()) {
+      auto name = waveformOp->getAttrOfType<StringAttr>(waveformNameAttrName);
+      internedNames.try_emplace(waveformOp.getSamples(), name);
+      usedNames.insert(name.getValue());
+    }
+  }
+
+  // replace repeated waveforms within a block, the first one dominates the
+  // others
+  SmallVector<Waveform_CreateOp> waveformOps;
+  llvm::DenseMap<std::pair<Block *, Attribute>, Waveform_CreateOp> firstOps;
+  SmallVector<Waveform_CreateOp> duplicateOps;
+  moduleOp->walk([&](Waveform_CreateOp waveformOp) {
+    if (containerOp && waveformOp->getParentOp() == containerOp)
+      return;
+    auto [it, inserted] = firstOps.try_emplace(
+        {waveformOp->getBlock(), waveformOp.getSamples()}, waveformOp);
+    if (inserted) {
+      waveformOps.push_back(waveformOp);
+      return;
+    }
+    waveformOp.getWfr().replaceAllUsesWith(it->second.getWfr());
+    duplicateOps.push_back(waveformOp);
+  });
+  for (auto waveformOp : duplicateOps)
+    waveformOp->erase();
+
+  if (waveformOps.empty())
+    return;
+
+  if (!containerOp) {
+    auto builder = OpBuilder::atBlockBegin(moduleOp.getBody());
+    containerOp = builder.create<WaveformContainerOp>(moduleOp.getLoc());
+  }
+  if (containerOp.getBody().empty())
+    containerOp.getBody().emplaceBlock();
+  auto builder = OpBuilder::atBlockEnd(&containerOp.getBody().front());
+
+  for (auto waveformOp : waveformOps) {
+    auto [it, inserted] =
+        internedNames.try_emplace(waveformOp.getSamples(), StringAttr());
+    if (inserted) {
+      std::string name;
+      auto existingName =
+          waveformOp->getAttrOfType<StringAttr>(waveformNameAttrName);
+      if (existingName && !usedNames.contains(existingName.getValue())) {
+        name = existingName.str();
+      } else {
+        std::string const baseName =
+            llvm::formatv("wfr_{0:x-16}", hashSamples(waveformOp));
+        name = baseName;
+        for (unsigned int suffix = 1; usedNames.contains(name); ++suffix)
+          name = baseName + "_" + std::to_string(suffix);
+      }
+      usedNames.insert(name);
+      it->second = StringAttr::get(&getContext(), name);
+
+      auto *internedOp = builder.clone(*waveformOp);
+      internedOp->setAttr(waveformNameAttrName, it->second);
+    }
+    waveformOp->setAttr(waveformNameAttrName, it->second);
+  }
+} // runOnOperation
+
+llvm::StringRef DeduplicateWaveformsPass::getArgument() const {
+  return "pulse-deduplicate-waveforms";
+}
+
+llvm::StringRef DeduplicateWaveformsPass::getDescription() const {
+  return "Intern waveforms with identical samples in a waveform container";
+}
+
+llvm::StringRef DeduplicateWaveformsPass::getName() const {
+  return "Deduplicate Waveforms Pass";
+}
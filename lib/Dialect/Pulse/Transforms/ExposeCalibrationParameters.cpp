@@ -0,0 +1,235 @@
+//===- ExposeCalibrationParameters.cpp - Patchable cal constants *- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for exposing the calibration constants of
+///  pulse sequences as input parameters.
+///
+///  The constant amplitudes of pulse.const_waveform, pulse.gaussian,
+///  pulse.gaussian_square and pulse.drag, and the constant frequencies of
+///  pulse.set_frequency, in the module level pulse sequences are replaced by
+///  qcs.parameter_load operations of new qcs.declare_parameter operations,
+///  whose initial values are the constants. Targets lower input parameters
+///  to patch points of the argument signature, such that a recalibrated
+///  amplitude or frequency is applied by binding arguments to the payload
+///  instead of recompiling the program.
+///
+///  The parameters of a sequence are named after the sequence, the kind of
+///  the constant and their position in the sequence, e.g. x_0.amp0.real,
+///  x_0.amp0.imag and x_0.freq0, which is stable across compilations of the
+///  same calibrations. Constants shared by several operations are exposed
+///  once. Parametric waveforms with exposed amplitudes are no longer sampled
+///  at compile time.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/ExposeCalibrationParameters.h"
+
+#include "Dialect/Pulse/IR/PulseDialect.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/QCS/IR/QCSDialect.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Complex/IR/Complex.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <iterator>
+#include <string>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+// exposes the constants of a single sequence
+class SequenceParameters {
+public:
+  SequenceParameters(SequenceOp sequenceOp, OpBuilder &declarationBuilder,
+                     SymbolTable &symbolTable)
+      : sequenceOp(sequenceOp), declarationBuilder(declarationBuilder),
+        symbolTable(symbolTable) {}
+
+  // replace the constant amplitude of a parametric waveform, the amplitude
+  // is the second operand of all of them
+  LogicalResult exposeAmplitude(Operation *waveformOp) {
+    Value const amp = waveformOp->getOperand(1);
+    if (!exposed.count(amp)) {
+      // stays nullptr if the operands of the amplitude are replaced instead
+      Value replacement;
+      std::string const name = "amp" + std::to_string(numAmplitudes);
+      if (auto createOp = amp.getDefiningOp<complex::CreateOp>()) {
+        // the real and imaginary parts are exposed on their own
+        Value const real = exposeFloat(createOp.getReal(), name + ".real");
+        Value const imag = exposeFloat(createOp.getImaginary(), name + ".imag");
+        if (failed(status))
+          return failure();
+        if (real)
+          createOp.getRealMutable().assign(real);
+        if (imag)
+          createOp.getImaginaryMutable().assign(imag);
+        if (real || imag)
+          numAmplitudes++;
+      } else if (auto constantOp = amp.getDefiningOp<complex::ConstantOp>()) {
+        auto parts = constantOp.getValue();
+        auto realAttr = parts[0].dyn_cast<FloatAttr>();
+        auto imagAttr = parts[1].dyn_cast<FloatAttr>();
+        if (realAttr && imagAttr && realAttr.getType().isF64() &&
+            imagAttr.getType().isF64()) {
+          OpBuilder builder(constantOp->getBlock(),
+                            std::next(constantOp->getIterator()));
+          Value const real = loadParameter(builder, constantOp->getLoc(),
+                                           name + ".real", realAttr);
+          Value const imag = loadParameter(builder, constantOp->getLoc(),
+                                           name + ".imag", imagAttr);
+          if (failed(status))
+            return failure();
+          replacement = builder.create<complex::CreateOp>(
+              constantOp->getLoc(), amp.getType(), real, imag);
+          replacedConstants.insert(constantOp);
+          numAmplitudes++;
+        }
+      }
+      exposed[amp] = replacement;
+    }
+    if (Value const replacement = exposed.lookup(amp))
+      waveformOp->setOperand(1, replacement);
+    return success();
+  }
+
+  LogicalResult exposeFrequency(SetFrequencyOp setFrequencyOp) {
+    Value const frequency = exposeFloat(
+        setFrequencyOp.getFrequency(), "freq" + std::to_string(numFrequencies));
+    if (failed(status))
+      return failure();
+    if (frequency) {
+      setFrequencyOp.getFrequencyMutable().assign(frequency);
+      numFrequencies++;
+    }
+    return success();
+  }
+
+  // erase the constants which were only used by exposed operations
+  void eraseUnusedConstants() {
+    for (Operation *constantOp : replacedConstants)
+      if (constantOp->use_empty())
+        constantOp->erase();
+  }
+
+private:
+  // returns a new parameter load replacing value, or nullptr if value is not
+  // an f64 constant. Every use gets a parameter of its own, even if constants
+  // with equal values were merged.
+  Value exposeFloat(Value value, const std::string &name) {
+    auto constantOp = value.getDefiningOp<arith::ConstantOp>();
+    if (!constantOp)
+      return nullptr;
+    auto valueAttr = constantOp.getValue().dyn_cast<FloatAttr>();
+    if (!valueAttr || !valueAttr.getType().isF64())
+      return nullptr;
+    OpBuilder builder(constantOp->getBlock(),
+                      std::next(constantOp->getIterator()));
+    replacedConstants.insert(constantOp);
+    return loadParameter(builder, constantOp->getLoc(), name, valueAttr);
+  }
+
+  Value loadParameter(OpBuilder &builder, Location loc,
+                      const std::string &name, FloatAttr value) {
+    std::string const parameterName =
+        (sequenceOp.getSymName() + "." + name).str();
+    if (symbolTable.lookup(parameterName)) {
+      sequenceOp->emitError()
+          << "the input parameter " << parameterName << " already exists";
+      status = failure();
+      return nullptr;
+    }
+    auto declareParameterOp =
+        declarationBuilder.create<qcs::DeclareParameterOp>(
+            loc, parameterName, TypeAttr::get(value.getType()), value);
+    symbolTable.insert(declareParameterOp);
+    return builder.create<qcs::ParameterLoadOp>(loc, value.getType(),
+                                                parameterName);
+  }
+
+  SequenceOp sequenceOp;
+  OpBuilder &declarationBuilder;
+  SymbolTable &symbolTable;
+  // the values replacing the amplitudes exposed so far, nullptr for
+  // amplitudes whose operands were replaced
+  llvm::DenseMap<Value, Value> exposed;
+  llvm::SmallSetVector<Operation *, 8> replacedConstants;
+  unsigned numAmplitudes{0};
+  unsigned numFrequencies{0};
+  LogicalResult status{success()};
+};
+} // anonymous namespace
+
+void ExposeCalibrationParametersPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+  SymbolTable symbolTable(moduleOp);
+
+  // declare the parameters in front of the module, in the order of the
+  // sequences
+  OpBuilder declarationBuilder(moduleOp.getBodyRegion());
+  declarationBuilder.setInsertionPointToStart(moduleOp.getBody());
+
+  llvm::SmallVector<SequenceOp> sequenceOps(moduleOp.getOps<SequenceOp>());
+  for (auto sequenceOp : sequenceOps) {
+    SequenceParameters parameters(sequenceOp, declarationBuilder,
+                                  symbolTable);
+    auto result = sequenceOp->walk([&](Operation *op) {
+      if (exposeAmplitudes &&
+          isa<ConstOp, GaussianOp, GaussianSquareOp, DragOp>(op)) {
+        if (failed(parameters.exposeAmplitude(op)))
+          return WalkResult::interrupt();
+      } else if (auto setFrequencyOp = dyn_cast<SetFrequencyOp>(op)) {
+        if (exposeFrequencies &&
+            failed(parameters.exposeFrequency(setFrequencyOp)))
+          return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      return signalPassFailure();
+    parameters.eraseUnusedConstants();
+  }
+} // runOnOperation
+
+void ExposeCalibrationParametersPass::getDependentDialects(
+    DialectRegistry &registry) const {
+  registry.insert<complex::ComplexDialect, qcs::QCSDialect, PulseDialect>();
+}
+
+llvm::StringRef ExposeCalibrationParametersPass::getArgument() const {
+  return "pulse-expose-calibration-parameters";
+}
+
+llvm::StringRef ExposeCalibrationParametersPass::getDescription() const {
+  return "Expose the amplitudes and frequencies of pulse sequences as input "
+         "parameters which can be updated after compilation";
+}
+
+llvm::StringRef ExposeCalibrationParametersPass::getName() const {
+  return "Expose Calibration Parameters Pass";
+}
@@ -0,0 +1,92 @@
+//===- ExternalizeWaveforms.cpp - Move samples to resources -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for moving the samples of large
+///  pulse.create_waveform operations from dense attributes into dialect
+///  resource blobs.
+///
+///  Dense attributes are uniqued by the context and live as long as it does,
+///  and print inline in the textual IR. Resource blobs print once at the end
+///  of the module, are referenced by handle, can be read without copying
+///  through Waveform_CreateOp::getSampleData, and can be released with
+///  releaseWaveformResources once the payload has been written. Waveforms
+///  interned in a pulse.waveform_container are moved as well, under their
+///  pulse.waveformName.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/ExternalizeWaveforms.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/Utils.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+void ExternalizeWaveformsPass::runOnOperation() {
+  int64_t const threshold = std::max<int64_t>(minSamples, 1);
+  // waveforms with identical samples share one blob
+  llvm::DenseMap<Attribute, ElementsAttr> resourceSamples;
+
+  getOperation()->walk([&](Waveform_CreateOp waveformOp) {
+    auto samples = waveformOp.getSamples().dyn_cast<DenseFPElementsAttr>();
+    if (!samples || samples.getNumElements() / 2 < threshold)
+      return;
+
+    auto &resource = resourceSamples[samples];
+    if (!resource) {
+      llvm::StringRef resourceName = "waveform";
+      if (auto name =
+              waveformOp->getAttrOfType<StringAttr>("pulse.waveformName"))
+        resourceName = name.getValue();
+
+      llvm::SmallVector<double> splatData;
+      llvm::ArrayRef<double> data;
+      if (auto sampleData = waveformOp.getSampleData()) {
+        data = *sampleData;
+      } else {
+        splatData.assign(samples.getValues<double>().begin(),
+                         samples.getValues<double>().end());
+        data = splatData;
+      }
+      resource = getWaveformSamplesAttr(&getContext(), data, threshold,
+                                        resourceName);
+    }
+    waveformOp.setSamplesAttr(resource);
+  });
+} // runOnOperation
+
+llvm::StringRef ExternalizeWaveformsPass::getArgument() const {
+  return "pulse-externalize-waveforms";
+}
+
+llvm::StringRef ExternalizeWaveformsPass::getDescription() const {
+  return "Move the samples of large waveforms into dialect resource blobs";
+}
+
+llvm::StringRef ExternalizeWaveformsPass::getName() const {
+  return "Externalize Waveforms Pass";
+}
@@ -0,0 +1,262 @@
+//===- FuseFrameUpdates.cpp - Fuse adjacent frame updates -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for fusing adjacent phase and frequency
+///  updates of a frame.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/FuseFrameUpdates.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/IR/PulseTypes.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <vector>
+
+#define DEBUG_TYPE "FuseFrameUpdates"
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+
+bool isFrame(Value value) {
+  return value.getType().isa<FrameType, MixedFrameType>();
+}
+
+// The phase and frequency updates all take the target frame as their first
+// operand and the new or offset value as their second operand
+constexpr unsigned targetIndex = 0;
+constexpr unsigned valueIndex = 1;
+
+// the latest phase and frequency update of a frame which is not yet followed
+// by an operation on the frame
+struct PendingUpdates {
+  Operation *phase = nullptr;
+  Operation *frequency = nullptr;
+};
+
+class FrameUpdateFuser {
+public:
+  explicit FrameUpdateFuser(bool mayAlias) : mayAlias(mayAlias) {}
+
+  void fuseBlock(Block &block) {
+    llvm::DenseMap<Value, PendingUpdates> pending;
+    for (Operation &op : llvm::make_early_inc_range(block)) {
+      if (isa<ShiftPhaseOp, SetPhaseOp, ShiftFrequencyOp, SetFrequencyOp>(op)) {
+        Value const target = op.getOperand(targetIndex);
+        // updates of frames which may be the same one do not commute, hence
+        // at most one frame has pending updates
+        if (mayAlias && !pending.count(target))
+          pending.clear();
+        auto &updates = pending[target];
+        if (isa<ShiftPhaseOp, SetPhaseOp>(op))
+          updates.phase = fuse(updates.phase, &op);
+        else
+          updates.frequency = fuse(updates.frequency, &op);
+        continue;
+      }
+
+      // the amplitude is independent of the phase and frequency
+      if (isa<SetAmplitudeOp>(op))
+        continue;
+
+      // the updates of a frame must precede the next operation on the frame
+      if (op.getNumRegions() > 0) {
+        pending.clear();
+        continue;
+      }
+      for (Value operand : op.getOperands()) {
+        if (!isFrame(operand))
+          continue;
+        if (mayAlias) {
+          pending.clear();
+          break;
+        }
+        pending.erase(operand);
+      }
+    }
+  }
+
+private:
+  bool mayAlias;
+
+  // Fuse the previous update of the same kind, if any, into the current one
+  // and return the fused update
+  Operation *fuse(Operation *previous, Operation *current) {
+    if (!previous)
+      return current;
+
+    LLVM_DEBUG(llvm::dbgs() << "Fusing " << *previous << " into " << *current
+                            << "\n");
+
+    // setting the phase or frequency overrides any previous update
+    if (isa<SetPhaseOp, SetFrequencyOp>(current)) {
+      eraseUpdate(previous);
+      return current;
+    }
+
+    // shifts accumulate onto the previous shift or set of the same type,
+    // fixed-point phases wrap around a full turn as integers
+    Value const previousValue = previous->getOperand(valueIndex);
+    Value const currentValue = current->getOperand(valueIndex);
+    if (previousValue.getType() != currentValue.getType())
+      return current;
+    OpBuilder builder(current);
+    Value const sum =
+        previousValue.getType().isa<IntegerType>()
+            ? builder.createOrFold<arith::AddIOp>(current->getLoc(),
+                                                  previousValue, currentValue)
+            : builder.createOrFold<arith::AddFOp>(current->getLoc(),
+                                                  previousValue, currentValue);
+    Operation *fused = current;
+    if (isa<SetPhaseOp, SetFrequencyOp>(previous)) {
+      OperationState state(current->getLoc(), previous->getName());
+      state.addOperands({current->getOperand(targetIndex), sum});
+      state.addAttributes(current->getAttrs());
+      fused = builder.create(state);
+      eraseUpdate(current);
+    } else {
+      Value const offset = current->getOperand(valueIndex);
+      current->setOperand(valueIndex, sum);
+      eraseIfDead(offset);
+    }
+    eraseUpdate(previous);
+    return fused;
+  }
+
+  static void eraseUpdate(Operation *update) {
+    Value const value = update->getOperand(valueIndex);
+    update->erase();
+    eraseIfDead(value);
+  }
+
+  static void eraseIfDead(Value value) {
+    if (auto *defOp = value.getDefiningOp(); defOp && isOpTriviallyDead(defOp))
+      defOp->erase();
+  }
+}; // class FrameUpdateFuser
+
+// Returns the sequences whose frame arguments may refer to the same frame,
+// which is the case if a call passes the same frame twice, passes several
+// frame arguments of such a sequence, or if the sequence has no known callers.
+llvm::DenseSet<Operation *>
+findAliasingSequences(llvm::ArrayRef<SequenceOp> sequenceOps,
+                      const llvm::StringMap<SequenceOp> &sequences,
+                      llvm::ArrayRef<CallSequenceOp> callOps) {
+  llvm::DenseSet<Operation *> called;
+  for (auto callOp : callOps)
+    if (auto pos = sequences.find(callOp.getCallee()); pos != sequences.end())
+      called.insert(pos->second);
+
+  llvm::DenseSet<Operation *> aliasing;
+  for (auto sequenceOp : sequenceOps)
+    if (!called.contains(sequenceOp) &&
+        llvm::count_if(sequenceOp.getArguments(), isFrame) > 1)
+      aliasing.insert(sequenceOp);
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto callOp : callOps) {
+      auto pos = sequences.find(callOp.getCallee());
+      if (pos == sequences.end() || aliasing.contains(pos->second))
+        continue;
+      auto callerOp = callOp->getParentOfType<SequenceOp>();
+      bool const inAliasing = callerOp && aliasing.contains(callerOp);
+      llvm::DenseSet<Value> frames;
+      unsigned numFrameArgs = 0;
+      bool aliases = false;
+      for (Value operand : callOp.getOperands()) {
+        if (!isFrame(operand))
+          continue;
+        aliases |= !frames.insert(operand).second;
+        numFrameArgs += operand.isa<BlockArgument>();
+      }
+      if (aliases || (inAliasing && numFrameArgs > 1)) {
+        aliasing.insert(pos->second);
+        changed = true;
+      }
+    }
+  }
+  return aliasing;
+}
+
+} // end anonymous namespace
+
+void FuseFrameUpdatesPass::runOnOperation() {
+  ModuleOp module = getOperation();
+
+  std::vector<SequenceOp> sequenceOps;
+  llvm::StringMap<SequenceOp> sequences;
+  std::vector<CallSequenceOp> callOps;
+  module->walk([&](Operation *op) {
+    if (auto sequenceOp = dyn_cast<SequenceOp>(op)) {
+      sequenceOps.push_back(sequenceOp);
+      sequences[sequenceOp.getSymName()] = sequenceOp;
+    } else if (auto callOp = dyn_cast<CallSequenceOp>(op)) {
+      callOps.push_back(callOp);
+    }
+  });
+
+  auto const aliasing =
+      findAliasingSequences(sequenceOps, sequences, callOps);
+
+  // sequences are isolated from above, hence they are fused independently
+  mlir::parallelForEach(&getContext(), sequenceOps, [&](SequenceOp sequenceOp) {
+    FrameUpdateFuser fuser(aliasing.contains(sequenceOp));
+    sequenceOp->walk([&](Block *block) { fuser.fuseBlock(*block); });
+  });
+}
+
+void FuseFrameUpdatesPass::getDependentDialects(
+    DialectRegistry &registry) const {
+  registry.insert<arith::ArithDialect>();
+}
+
+llvm::StringRef FuseFrameUpdatesPass::getArgument() const {
+  return "pulse-fuse-frame-updates";
+}
+
+llvm::StringRef FuseFrameUpdatesPass::getDescription() const {
+  return "Fuse the adjacent phase and frequency updates of each frame";
+}
+
+llvm::StringRef FuseFrameUpdatesPass::getName() const {
+  return "Fuse Frame Updates Pass";
+}
@@ -1,6 +1,6 @@
 //===- InlineRegion.cpp - Inlining all dialects -----------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -19,6 +19,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/Pulse/Transforms/InlineRegion.h"
+#include "Utils/SymbolCacheAnalysis.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -29,7 +30,9 @@
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/InliningUtils.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace mlir::pulse {
@@ -54,40 +57,92 @@ class DialectAgnosticInlinerInterface : public InlinerInterface {
   }
 };
 
-void InlineRegionPass::runOnOperation() {
-
-  auto module = getOperation();
+namespace {
 
-  for (auto function :
-       llvm::make_early_inc_range(module.getOps<mlir::func::FuncOp>())) {
+// Inlines the calls of all functions, inlining into the callees before their
+// callers so that every function body is only copied once it no longer
+// contains calls. Copying a body therefore costs its size after inlining
+// instead of growing with the depth of the call chain.
+class FunctionInliner {
+public:
+  FunctionInliner(MLIRContext *context,
+                  qssc::utils::SymbolCacheAnalysis &symbolCache)
+      : interface(context), symbolCache(symbolCache) {}
 
-    // Build the inliner interface.
-    DialectAgnosticInlinerInterface interface(&getContext());
+  void inlineCalls(func::FuncOp function) {
+    auto [it, inserted] = visited.try_emplace(function, false);
+    if (!inserted)
+      return;
 
     for (auto caller :
          llvm::make_early_inc_range(function.getOps<func::CallOp>())) {
-      auto callee = dyn_cast_or_null<mlir::func::FuncOp>(
-          module.lookupSymbol(caller.getCallee()));
-      if (!callee)
+      if (!symbolCache.contains(caller.getCallee()))
+        continue;
+      auto callee = symbolCache.getOp<func::FuncOp>(caller);
+      if (callee.isExternal())
+        continue;
+
+      // flatten the callee first, recursive calls are not inlined
+      inlineCalls(callee);
+      if (!visited.lookup(callee))
         continue;
 
+      // the mapping is reused for all calls to avoid allocating its maps for
+      // every inlined region
+      mapper.clear();
+      mapper.map(callee.getArguments(), caller.getArgOperands());
+
       // Inline the functional region operation, but only clone the internal
       // region if there is more than one use.
-      if (failed(inlineRegion(interface, &callee.getBody(), caller,
-                              caller.getArgOperands(), caller.getResults(),
+      if (failed(inlineRegion(interface, &callee.getBody(), caller, mapper,
+                              caller.getResults(), caller.getResultTypes(),
                               caller.getLoc(),
                               /*shouldCloneInlinedRegion=*/true)))
         continue;
 
       // If the inlining was successful then erase the call and callee if
       // possible.
+      symbolCache.eraseCall(caller);
       caller->dropAllDefinedValueUses();
       caller->dropAllReferences();
       caller.erase();
-      if (callee.use_empty())
-        callee.erase();
+      inlinedCallees.insert(callee);
+    }
+    visited[function] = true;
+  }
+
+  // erase the inlined callees which are not referenced anymore
+  void eraseUnusedCallees() {
+    for (auto callee : inlinedCallees) {
+      if (!callee.use_empty())
+        continue;
+      symbolCache.erase(callee);
+      callee.erase();
     }
   }
+
+private:
+  DialectAgnosticInlinerInterface interface;
+  qssc::utils::SymbolCacheAnalysis &symbolCache;
+  IRMapping mapper;
+  // functions which are being (false) or have been (true) inlined into
+  llvm::DenseMap<Operation *, bool> visited;
+  llvm::SetVector<func::FuncOp> inlinedCallees;
+};
+
+} // anonymous namespace
+
+void InlineRegionPass::runOnOperation() {
+
+  auto module = getOperation();
+
+  auto &symbolCache = getAnalysis<qssc::utils::SymbolCacheAnalysis>()
+                          .addToCache<mlir::func::FuncOp>();
+
+  FunctionInliner inliner(&getContext(), symbolCache);
+  for (auto function : module.getOps<mlir::func::FuncOp>())
+    inliner.inlineCalls(function);
+  inliner.eraseUnusedCallees();
 }
 
 llvm::StringRef InlineRegionPass::getArgument() const { return "pulse-inline"; }
@@ -23,59 +23,152 @@
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
 
 #include <cstdint>
+#include <iterator>
 #include <string>
-#include <unordered_map>
-#include <vector>
+#include <utility>
 
 using namespace mlir;
 using namespace mlir::pulse;
 
+namespace {
+
+using Durations = llvm::SmallVector<uint64_t>;
+
+// A sequence specialized for the waveform durations of its call sites
+struct SequenceVariant {
+  Durations durations;
+  std::string name;
+};
+
+// The first variant of a sequence is the sequence itself, the others are its
+// specializations, in the order of their first call sites
+struct SequenceVariants {
+  llvm::SmallVector<SequenceVariant, 1> variants;
+  // the next suffix to try for the name of a specialization
+  unsigned nextSuffix = 1;
+};
+
+Durations getOperandDurations(CallSequenceOp callSequenceOp,
+                              SequenceOp sequenceOp) {
+  // durations of the operands which are not waveforms remain 0
+  Durations durations(sequenceOp.getNumArguments(), 0);
+  for (const auto &operand :
+       llvm::enumerate(callSequenceOp->getOperands().take_front(
+           durations.size()))) {
+    auto *defOp = operand.value().getDefiningOp();
+    if (!defOp)
+      continue;
+    if (auto waveformOp = dyn_cast<Waveform_CreateOp>(defOp)) {
+      auto duration = waveformOp.getDuration(nullptr /*callSequenceOp*/);
+      if (duration)
+        durations[operand.index()] = *duration;
+      else
+        llvm::consumeError(duration.takeError());
+    }
+  }
+  return durations;
+}
+
+// pick a name for a specialization of sequenceOp which neither exists in
+// symbolTable yet nor was picked for another specialization
+std::string getVariantName(SymbolTable &symbolTable, SequenceOp sequenceOp,
+                           unsigned &nextSuffix) {
+  std::string name;
+  do {
+    name = (sequenceOp.getSymName() + "_" + Twine(nextSuffix++)).str();
+  } while (symbolTable.lookup(name));
+  return name;
+}
+
+void labelPlayOps(SequenceOp sequenceOp, const Durations &durations) {
+  sequenceOp->walk([&](PlayOp playOp) {
+    auto wfArg = playOp.getWfr().dyn_cast<BlockArgument>();
+    if (!wfArg || wfArg.getOwner()->getParentOp() != sequenceOp)
+      return;
+    mlir::pulse::PulseOpSchedulingInterface::setDuration(
+        playOp, durations[wfArg.getArgNumber()]);
+  });
+}
+
+} // anonymous namespace
+
 void LabelPlayOpDurationsPass::runOnOperation() {
 
   // all PlayOps are assumed to be inside of a pulse.sequence
-  // pass builds a mapping of sequence name , argument number to duration
-  // for all play operations using call_sequences
-  //
-  // pass then searches for all play operations and assigns the durations using
-  // the mapping
+  // pass collects the durations of the waveforms passed to each
+  // call_sequence, specializes the callees which are called with different
+  // durations and labels the play operations of each called sequence with
+  // the durations of its call sites
 
   Operation *module = getOperation();
+  SymbolTableCollection symbolTables;
 
-  std::unordered_map<std::string, std::vector<uint64_t>> argumentToDuration;
+  llvm::MapVector<Operation *, SequenceVariants> sequenceVariants;
+  llvm::SmallVector<std::pair<CallSequenceOp, unsigned>> callSites;
 
   module->walk([&](CallSequenceOp callSequenceOp) {
-    auto callee = callSequenceOp.getCallee().str();
-
-    for (const auto &operand : callSequenceOp->getOperands()) {
-
-      uint64_t duration = 0;
-      auto *defOp = operand.getDefiningOp();
-      if (defOp)
-        if (auto waveformOp = dyn_cast<Waveform_CreateOp>(defOp))
-          duration = waveformOp.getDuration(nullptr /*callSequenceOp*/).get();
+    auto sequenceOp = symbolTables.lookupNearestSymbolFrom<SequenceOp>(
+        callSequenceOp, callSequenceOp.getCalleeAttr());
+    if (!sequenceOp)
+      return;
 
-      argumentToDuration[callee].push_back(duration);
+    auto durations = getOperandDurations(callSequenceOp, sequenceOp);
+    auto &sequence = sequenceVariants[sequenceOp];
+    auto &variants = sequence.variants;
+    auto *it = llvm::find_if(variants, [&](const SequenceVariant &v) {
+      return v.durations == durations;
+    });
+    unsigned const variant = it - variants.begin();
+    if (it == variants.end()) {
+      auto &symbolTable =
+          symbolTables.getSymbolTable(sequenceOp->getParentOp());
+      std::string name =
+          variants.empty()
+              ? sequenceOp.getSymName().str()
+              : getVariantName(symbolTable, sequenceOp, sequence.nextSuffix);
+      variants.push_back({std::move(durations), std::move(name)});
     }
+    callSites.emplace_back(callSequenceOp, variant);
   });
 
-  module->walk([&](PlayOp playOp) {
-    auto sequenceOp = playOp->getParentOfType<mlir::pulse::SequenceOp>();
-    auto sequenceStr = sequenceOp.getSymName().str();
-    // sequenceStr may not be in argumentToDuration if the sequence is not
-    // actually called
-    auto searchSequence = argumentToDuration.find(sequenceStr);
-    if (searchSequence == argumentToDuration.end())
-      return;
-    auto wfArgNumber = playOp.getWfr().dyn_cast<BlockArgument>().getArgNumber();
-    auto duration = searchSequence->second[wfArgNumber];
-    mlir::pulse::PulseOpSchedulingInterface::setDuration(playOp, duration);
-  });
+  // redirect the call sites before cloning the sequences such that the
+  // specializations call the same sequences as the sequences they copy
+  for (auto &[callSequenceOp, variant] : callSites) {
+    if (variant == 0)
+      continue;
+    auto sequenceOp = symbolTables.lookupNearestSymbolFrom<SequenceOp>(
+        callSequenceOp, callSequenceOp.getCalleeAttr());
+    callSequenceOp.setCalleeAttr(FlatSymbolRefAttr::get(
+        &getContext(), sequenceVariants[sequenceOp].variants[variant].name));
+  }
+
+  for (auto &[op, sequence] : sequenceVariants) {
+    auto sequenceOp = cast<SequenceOp>(op);
+    auto &variants = sequence.variants;
+    auto &symbolTable = symbolTables.getSymbolTable(sequenceOp->getParentOp());
+    Block::iterator const insertPt = std::next(Block::iterator(op));
+    for (auto &variant : llvm::drop_begin(variants)) {
+      auto specializedOp = cast<SequenceOp>(sequenceOp->clone());
+      specializedOp.setSymName(variant.name);
+      symbolTable.insert(specializedOp, insertPt);
+      labelPlayOps(specializedOp, variant.durations);
+    }
+    labelPlayOps(sequenceOp, variants.front().durations);
+  }
 
 } // runOnOperation
 
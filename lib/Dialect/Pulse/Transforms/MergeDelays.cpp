@@ -1,6 +1,6 @@
 //===- MergeDelays.cpp - merges delays on the same target -------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -18,34 +18,78 @@
 ///  The current implementation defaults to ignoring the target, there
 ///  is an option (ignoreTarget) to override this.
 ///
+///  It also implements the pass for moving the delays at the start and the
+///  end of a sequence to its calls. A sequence starts once all of its frames
+///  are available and ends once all of them are done, such that the common
+///  delay of all of its frame arguments may be moved, but not the part of a
+///  longer delay on a single frame.
+///
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/Pulse/Transforms/MergeDelays.h"
 
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/IR/PulseTypes.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/AttrTypeSubElements.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <utility>
 
 using namespace mlir;
 using namespace mlir::pulse;
 
 namespace {
-// This pattern matches on two DelayOps that back to back and merges
-// into a single DelayOp with the sum of the durations
+// the duration of a delay if it is a constant
+std::optional<int64_t> getConstantDelay(DelayOp delayOp) {
+  if (auto constantOp =
+          delayOp.getDur().getDefiningOp<mlir::arith::ConstantIntOp>())
+    return constantOp.value();
+  return std::nullopt;
+}
+
+// whether op may act on target, such that delays on target are not merged
+// across op
+bool mayUseTarget(Operation *op, Value target) {
+  if (op->getNumRegions() != 0 || op->hasTrait<OpTrait::IsTerminator>())
+    return true;
+  // a barrier without frames synchronizes all of them
+  if (isa<BarrierOp>(op) && op->getNumOperands() == 0)
+    return true;
+  return llvm::is_contained(op->getOperands(), target);
+}
+
+// This pattern matches on two DelayOps on the same target and merges
+// them into a single DelayOp with the sum of the durations, provided no
+// op in between uses the target and the second is not scheduled at a
+// timepoint of its own
 // the ignoreTarget flag may be used to enforce target equality
-// when merging the delays
+// when merging the delays, only back to back delays are merged then
 struct DelayAndDelayPattern : public OpRewritePattern<DelayOp> {
-  explicit DelayAndDelayPattern(MLIRContext *ctx)
-      : OpRewritePattern<DelayOp>(ctx) {}
+  explicit DelayAndDelayPattern(MLIRContext *ctx,
+                                Pass::Statistic *numMerged = nullptr)
+      : OpRewritePattern<DelayOp>(ctx), numMerged(numMerged) {}
 
   LogicalResult matchAndRewrite(DelayOp delayOp,
                                 PatternRewriter &rewriter) const override {
@@ -53,64 +97,170 @@ struct DelayAndDelayPattern : public OpRewritePattern<DelayOp> {
     // TODO: determine how to pass ignoreTarget to the pass as an option
     bool const ignoreTarget = false;
 
-    // get next operation and test for Delay
-    Operation *nextOp = delayOp->getNextNode();
-    if (!nextOp)
+    auto firstDelay = getConstantDelay(delayOp);
+    if (!firstDelay)
       return failure();
 
-    auto nextDelayOp = dyn_cast<DelayOp>(nextOp);
-    if (!nextDelayOp)
-      return failure();
-
-    // found a delay and a delay
+    // find the next delay on the target
     // verify port | frame (second operand) is the same
     // this verification will be ignored if ignoreTarget is set to true
     auto firstDelayPortOrFrame = delayOp.getTarget();
-    auto secondDelayPortOrFrame = nextDelayOp.getTarget();
-
-    if (!ignoreTarget && (firstDelayPortOrFrame != secondDelayPortOrFrame))
+    DelayOp nextDelayOp;
+    for (Operation *nextOp = delayOp->getNextNode(); nextOp;
+         nextOp = nextOp->getNextNode()) {
+      nextDelayOp = dyn_cast<DelayOp>(nextOp);
+      if (nextDelayOp && (ignoreTarget || nextDelayOp.getTarget() ==
+                                              firstDelayPortOrFrame))
+        break;
+      nextDelayOp = nullptr;
+      if (ignoreTarget || mayUseTarget(nextOp, firstDelayPortOrFrame))
+        return failure();
+    }
+    if (!nextDelayOp)
       return failure();
 
-    // get delay times and sum as int 32
-    // TODO: check to see if int 32 is sufficient
-    auto firstDelay = delayOp.getDur();
-    auto secondDelay = nextDelayOp.getDur();
-
-    auto firstDelayOp =
-        dyn_cast<mlir::arith::ConstantIntOp>(firstDelay.getDefiningOp());
-    auto secondDelayOp =
-        dyn_cast<mlir::arith::ConstantIntOp>(secondDelay.getDefiningOp());
-
-    auto mergeDelayValue = firstDelayOp.value() + secondDelayOp.value();
+    // a scheduled delay may start later than the first one ends
+    auto secondDelay = getConstantDelay(nextDelayOp);
+    if (!secondDelay ||
+        nextDelayOp.getDur().getType() != delayOp.getDur().getType() ||
+        PulseOpSchedulingInterface::getTimepoint(nextDelayOp))
+      return failure();
 
+    // sum the delay times in the type of the first
     auto mergeConstant = rewriter.create<mlir::arith::ConstantIntOp>(
-        delayOp.getLoc(), mergeDelayValue, 32);
+        delayOp.getLoc(), *firstDelay + *secondDelay,
+        delayOp.getDur().getType());
 
     // set first DelayOp duration to summed constant
-    delayOp->setOperand(1, mergeConstant);
+    rewriter.updateRootInPlace(
+        delayOp, [&]() { delayOp.getDurMutable().assign(mergeConstant); });
 
     // erase following delay
-    rewriter.eraseOp(nextOp);
+    rewriter.eraseOp(nextDelayOp);
+    if (numMerged)
+      ++(*numMerged);
 
     return success();
 
   } // matchAndRewrite
-};  // struct DelayAndDelayPattern
-} // end anonymous namespace
-
-void MergeDelayPass::runOnOperation() {
 
-  Operation *operation = getOperation();
+  Pass::Statistic *numMerged;
+}; // struct DelayAndDelayPattern
 
-  RewritePatternSet patterns(&getContext());
-  patterns.add<DelayAndDelayPattern>(&getContext());
+LogicalResult mergeDelays(Operation *op,
+                          Pass::Statistic *numMerged = nullptr) {
+  RewritePatternSet patterns(op->getContext());
+  patterns.add<DelayAndDelayPattern>(op->getContext(), numMerged);
 
   mlir::GreedyRewriteConfig config;
   // Disable to improve performance
   config.enableRegionSimplification = false;
 
-  if (failed(
-          applyPatternsAndFoldGreedily(operation, std::move(patterns), config)))
+  return applyPatternsAndFoldGreedily(op, std::move(patterns), config);
+}
+
+// the frame arguments of a sequence
+SmallVector<BlockArgument> getFrameArguments(SequenceOp sequenceOp) {
+  SmallVector<BlockArgument> frames;
+  for (BlockArgument const arg : sequenceOp.getArguments())
+    if (arg.getType().isa<MixedFrameType, FrameType>())
+      frames.push_back(arg);
+  return frames;
+}
+
+// The constant delays which are the first (or last) op using each frame
+// argument, in the order of the frames. Empty unless all frames have one.
+SmallVector<DelayOp> getEdgeDelays(SequenceOp sequenceOp,
+                                   ArrayRef<BlockArgument> frames,
+                                   bool atEnd) {
+  Block &body = sequenceOp.getBody().front();
+  SmallVector<DelayOp> delays;
+  for (BlockArgument const frame : frames) {
+    // the users of a value are not ordered
+    Operation *edgeOp = nullptr;
+    for (Operation *user : frame.getUsers()) {
+      Operation *op = body.findAncestorOpInBlock(*user);
+      if (!edgeOp || (atEnd ? edgeOp->isBeforeInBlock(op)
+                            : op->isBeforeInBlock(edgeOp)))
+        edgeOp = op;
+    }
+    auto delayOp = dyn_cast_or_null<DelayOp>(edgeOp);
+    if (!delayOp || delayOp.getTarget() != frame ||
+        !getConstantDelay(delayOp))
+      return {};
+    // the common delay is moved as a single constant
+    if (!delays.empty() &&
+        delayOp.getDur().getType() != delays.front().getDur().getType())
+      return {};
+    delays.push_back(delayOp);
+  }
+  return delays;
+}
+
+// the delay common to all delays, 0 for none
+int64_t getCommonDelay(ArrayRef<DelayOp> delays) {
+  if (delays.empty())
+    return 0;
+  int64_t common = *getConstantDelay(delays.front());
+  for (DelayOp delayOp : delays.drop_front())
+    common = std::min(common, *getConstantDelay(delayOp));
+  return std::max<int64_t>(common, 0);
+}
+
+void shortenDelays(OpBuilder &builder, ArrayRef<DelayOp> delays,
+                   int64_t delay) {
+  for (DelayOp delayOp : delays) {
+    int64_t const remaining = *getConstantDelay(delayOp) - delay;
+    if (remaining == 0) {
+      delayOp->erase();
+      continue;
+    }
+    builder.setInsertionPoint(delayOp);
+    auto remainingConstant = builder.create<mlir::arith::ConstantIntOp>(
+        delayOp.getLoc(), remaining, delayOp.getDur().getType());
+    delayOp.getDurMutable().assign(remainingConstant);
+  }
+}
+
+void shortenLabeledDuration(Operation *op, int64_t delay) {
+  if (auto duration = op->getAttrOfType<IntegerAttr>(
+          interfaces_impl::getDurationAttrName(op)))
+    PulseOpSchedulingInterface::setDuration(
+        op, std::max<int64_t>(duration.getInt() - delay, 0));
+}
+
+// the timepoints of the scheduled ops of a sequence are relative to its
+// start, which moving its delays would shift
+bool isScheduled(SequenceOp sequenceOp) {
+  return sequenceOp.getBody()
+      .walk([](Operation *op) {
+        if (PulseOpSchedulingInterface::getTimepoint(op))
+          return WalkResult::interrupt();
+        return WalkResult::advance();
+      })
+      .wasInterrupted();
+}
+
+// whether the delays of the frame arguments may be moved to callOp, i.e.,
+// it passes distinct frame arguments of its caller, on which the delays of
+// the arguments add up and which delays may target
+bool canMoveDelaysTo(CallSequenceOp callOp, ArrayRef<BlockArgument> frames) {
+  llvm::SmallDenseSet<Value> passedFrames;
+  for (BlockArgument const frame : frames) {
+    Value const passedFrame = callOp.getOperand(frame.getArgNumber());
+    if (!passedFrame.isa<BlockArgument>() ||
+        !passedFrames.insert(passedFrame).second)
+      return false;
+  }
+  return true;
+}
+} // end anonymous namespace
+
+void MergeDelayPass::runOnOperation() {
+
+  Operation *operation = getOperation();
+
+  if (failed(mergeDelays(operation)))
     signalPassFailure();
 
 } // runOnOperation
@@ -124,3 +274,103 @@ llvm::StringRef MergeDelayPass::getDescription() const {
 }
 
 llvm::StringRef MergeDelayPass::getName() const { return "Merge Delay Pass"; }
+
+void FoldCallDelaysPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+
+  // merged first, such that each frame has a single delay at each end
+  if (failed(mergeDelays(moduleOp, &numMergedDelays)))
+    return signalPassFailure();
+
+  // the calls of each sequence, sequences with other uses are left as is
+  SmallVector<SequenceOp> sequenceOps;
+  llvm::StringMap<SmallVector<CallSequenceOp>> calls;
+  llvm::StringSet<> otherUses;
+  moduleOp->walk([&](Operation *op) {
+    if (auto sequenceOp = dyn_cast<SequenceOp>(op))
+      sequenceOps.push_back(sequenceOp);
+    if (auto callOp = dyn_cast<CallSequenceOp>(op)) {
+      calls[callOp.getCallee()].push_back(callOp);
+      return;
+    }
+    op->getAttrDictionary().walk([&](SymbolRefAttr symbolRef) {
+      otherUses.insert(symbolRef.getLeafReference().getValue());
+    });
+  });
+
+  OpBuilder builder(&getContext());
+  for (SequenceOp sequenceOp : sequenceOps) {
+    auto search = calls.find(sequenceOp.getSymName());
+    if (search == calls.end() || otherUses.contains(sequenceOp.getSymName()) ||
+        !sequenceOp.getBody().hasOneBlock() || isScheduled(sequenceOp))
+      continue;
+    auto &callOps = search->second;
+    auto frames = getFrameArguments(sequenceOp);
+    if (frames.empty())
+      continue;
+
+    // the start of scheduled calls is offset by the delay at the start
+    if (llvm::all_of(callOps, [](CallSequenceOp callOp) {
+          return PulseOpSchedulingInterface::getTimepoint(callOp).has_value();
+        })) {
+      auto delays = getEdgeDelays(sequenceOp, frames, /*atEnd=*/false);
+      int64_t const delay = getCommonDelay(delays);
+      if (delay == 0)
+        continue;
+      for (CallSequenceOp callOp : callOps) {
+        PulseOpSchedulingInterface::setTimepoint(
+            callOp, *PulseOpSchedulingInterface::getTimepoint(callOp) + delay);
+        shortenLabeledDuration(callOp, delay);
+      }
+      shortenDelays(builder, delays, delay);
+      shortenLabeledDuration(sequenceOp, delay);
+      numFoldedTimepoints += delays.size();
+      continue;
+    }
+
+    // moving the delays to several calls would duplicate them
+    if (callOps.size() != 1 ||
+        PulseOpSchedulingInterface::getTimepoint(callOps.front()) ||
+        !canMoveDelaysTo(callOps.front(), frames))
+      continue;
+    CallSequenceOp callOp = callOps.front();
+    for (bool const atEnd : {false, true}) {
+      auto delays = getEdgeDelays(sequenceOp, frames, atEnd);
+      int64_t const delay = getCommonDelay(delays);
+      if (delay == 0)
+        continue;
+      if (atEnd)
+        builder.setInsertionPointAfter(callOp);
+      else
+        builder.setInsertionPoint(callOp);
+      auto delayConstant = builder.create<mlir::arith::ConstantIntOp>(
+          callOp.getLoc(), delay, delays.front().getDur().getType());
+      for (BlockArgument const frame : frames)
+        builder.create<DelayOp>(callOp.getLoc(),
+                                callOp.getOperand(frame.getArgNumber()),
+                                delayConstant);
+      shortenDelays(builder, delays, delay);
+      shortenLabeledDuration(sequenceOp, delay);
+      shortenLabeledDuration(callOp, delay);
+      numHoistedDelays += delays.size();
+    }
+  }
+
+  // merge the moved delays with those around the calls
+  if (failed(mergeDelays(moduleOp, &numMergedDelays)))
+    signalPassFailure();
+} // FoldCallDelaysPass::runOnOperation
+
+llvm::StringRef FoldCallDelaysPass::getArgument() const {
+  return "pulse-fold-call-delays";
+}
+
+llvm::StringRef FoldCallDelaysPass::getDescription() const {
+  return "Move the delays common to all frames at the start and the end of "
+         "a sequence to its calls, merging them with the delays around the "
+         "calls or folding them into the timepoints of scheduled calls";
+}
+
+llvm::StringRef FoldCallDelaysPass::getName() const {
+  return "Fold Call Delays Pass";
+}
@@ -1,6 +1,6 @@
 //===- Passes.cpp - Pulse Passes --------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -22,12 +22,21 @@
 
 #include "Conversion/QUIRToPulse/LoadPulseCals.h"
 #include "Conversion/QUIRToPulse/QUIRToPulse.h"
+#include "Conversion/QUIRToPulse/WaveformLibrary.h"
 
 #include "Dialect/Pulse/Transforms/ClassicalOnlyDetection.h"
+#include "Dialect/Pulse/Transforms/DeadCodeElimination.h"
+#include "Dialect/Pulse/Transforms/DeduplicateWaveforms.h"
+#include "Dialect/Pulse/Transforms/ExposeCalibrationParameters.h"
+#include "Dialect/Pulse/Transforms/ExternalizeWaveforms.h"
+#include "Dialect/Pulse/Transforms/FuseFrameUpdates.h"
 #include "Dialect/Pulse/Transforms/LabelPlayOpDurations.h"
 #include "Dialect/Pulse/Transforms/MergeDelays.h"
 #include "Dialect/Pulse/Transforms/RemoveUnusedArguments.h"
+#include "Dialect/Pulse/Transforms/SampleWaveforms.h"
 #include "Dialect/Pulse/Transforms/SchedulePort.h"
+#include "Dialect/Pulse/Transforms/SequenceDurationAnalysis.h"
+#include "Dialect/Pulse/Transforms/TimelineReport.h"
 
 #include "Dialect/Pulse/Transforms/Scheduling.h"
 #include "mlir/Pass/PassManager.h"
@@ -42,10 +51,20 @@ void registerPulsePasses() {
   PassRegistration<LoadPulseCalsPass>();
   PassRegistration<QUIRToPulsePass>();
   PassRegistration<MergeDelayPass>();
+  PassRegistration<FoldCallDelaysPass>();
+  PassRegistration<FuseFrameUpdatesPass>();
   PassRegistration<RemoveUnusedArgumentsPass>();
   PassRegistration<SchedulePortPass>();
   PassRegistration<QuantumCircuitPulseSchedulingPass>();
   PassRegistration<ClassicalOnlyDetectionPass>();
+  PassRegistration<DeduplicateWaveformsPass>();
+  PassRegistration<DeadCodeEliminationPass>();
+  PassRegistration<SampleWaveformsPass>();
+  PassRegistration<ExternalizeWaveformsPass>();
+  PassRegistration<TimelineReportPass>();
+  PassRegistration<ExposeCalibrationParametersPass>();
+  PassRegistration<WriteWaveformLibraryPass>();
+  PassRegistration<TestSequenceDurationAnalysisPass>();
 }
 
 void registerPulsePassPipeline() {
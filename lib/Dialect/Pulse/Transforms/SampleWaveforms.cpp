@@ -0,0 +1,182 @@
+//===- SampleWaveforms.cpp - Sample parametric waveforms ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for replacing pulse.const_waveform,
+///  pulse.gaussian, pulse.gaussian_square and pulse.drag operations whose
+///  parameters are all constants by pulse.create_waveform operations, using
+///  the shared sampling functions of WaveformSampling.h. Parametric waveforms
+///  with any non-constant parameter are left unchanged.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/SampleWaveforms.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/IR/PulseTypes.h"
+#include "Dialect/Pulse/Utils/Utils.h"
+#include "Dialect/Pulse/Utils/WaveformSampling.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Complex/IR/Complex.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ErrorHandling.h"
+
+#include <complex>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+enum WaveformKind : unsigned int { CONST, GAUSSIAN, GAUSSIAN_SQUARE, DRAG };
+
+std::optional<int64_t> getConstantInt(Value value) {
+  if (auto constantOp = value.getDefiningOp<arith::ConstantIntOp>())
+    return constantOp.value();
+  return std::nullopt;
+}
+
+std::optional<double> getConstantFloat(Value value) {
+  if (auto constantOp = value.getDefiningOp<arith::ConstantFloatOp>())
+    return constantOp.value().convertToDouble();
+  return std::nullopt;
+}
+
+std::optional<std::complex<double>> getConstantComplex(Value value) {
+  if (auto createOp = value.getDefiningOp<complex::CreateOp>()) {
+    auto re = getConstantFloat(createOp.getReal());
+    auto im = getConstantFloat(createOp.getImaginary());
+    if (re && im)
+      return std::complex<double>(*re, *im);
+    return std::nullopt;
+  }
+  if (auto constantOp = value.getDefiningOp<complex::ConstantOp>()) {
+    auto parts = constantOp.getValue();
+    auto re = parts[0].cast<FloatAttr>().getValueAsDouble();
+    auto im = parts[1].cast<FloatAttr>().getValueAsDouble();
+    return std::complex<double>(re, im);
+  }
+  return std::nullopt;
+}
+
+// Returns the parameters of a waveform if all of them are constant and valid
+std::optional<SampleWaveformsPass::WaveformParameters>
+getConstantParameters(WaveformKind kind, Value durValue, Value ampValue,
+                      Value sigmaValue, std::optional<double> widthOrBeta) {
+  auto dur = getConstantInt(durValue);
+  auto amp = getConstantComplex(ampValue);
+  if (!dur || *dur <= 0 || !amp || !widthOrBeta)
+    return std::nullopt;
+  double sigma = 0.;
+  if (sigmaValue) {
+    auto sigmaInt = getConstantInt(sigmaValue);
+    if (!sigmaInt || *sigmaInt <= 0)
+      return std::nullopt;
+    sigma = static_cast<double>(*sigmaInt);
+  }
+  return std::make_tuple(static_cast<unsigned int>(kind), *dur, amp->real(),
+                         amp->imag(), sigma, *widthOrBeta);
+}
+} // anonymous namespace
+
+mlir::ElementsAttr
+SampleWaveformsPass::getSamples(const WaveformParameters &parameters) {
+  auto search = samplesCache.find(parameters);
+  if (search != samplesCache.end())
+    return search->second;
+
+  auto [kind, duration, ampRe, ampIm, sigma, widthOrBeta] = parameters;
+  std::complex<double> const amp(ampRe, ampIm);
+  llvm::SmallVector<double> samples;
+  switch (kind) {
+  case CONST:
+    sampleConstWaveform(duration, amp, samples);
+    break;
+  case GAUSSIAN:
+    sampleGaussian(duration, amp, sigma, samples);
+    break;
+  case GAUSSIAN_SQUARE:
+    sampleGaussianSquare(duration, amp, sigma, widthOrBeta, samples);
+    break;
+  case DRAG:
+    sampleDrag(duration, amp, sigma, widthOrBeta, samples);
+    break;
+  default:
+    llvm_unreachable("unknown waveform kind");
+  }
+
+  auto samplesAttr =
+      getWaveformSamplesAttr(&getContext(), samples, resourceMinSamples);
+  samplesCache[parameters] = samplesAttr;
+  return samplesAttr;
+}
+
+void SampleWaveformsPass::runOnOperation() {
+  samplesCache.clear();
+
+  getOperation()->walk([&](Operation *op) {
+    std::optional<WaveformParameters> parameters;
+    if (auto constOp = dyn_cast<ConstOp>(op)) {
+      parameters = getConstantParameters(CONST, constOp.getDur(),
+                                         constOp.getAmp(), nullptr, 0.);
+    } else if (auto gaussianOp = dyn_cast<GaussianOp>(op)) {
+      parameters = getConstantParameters(
+          GAUSSIAN, gaussianOp.getDur(), gaussianOp.getAmp(),
+          gaussianOp.getSigma(), 0.);
+    } else if (auto gaussianSquareOp = dyn_cast<GaussianSquareOp>(op)) {
+      std::optional<double> width;
+      if (auto widthInt = getConstantInt(gaussianSquareOp.getWidth()))
+        width = static_cast<double>(*widthInt);
+      parameters = getConstantParameters(
+          GAUSSIAN_SQUARE, gaussianSquareOp.getDur(),
+          gaussianSquareOp.getAmp(), gaussianSquareOp.getSigma(), width);
+    } else if (auto dragOp = dyn_cast<DragOp>(op)) {
+      parameters = getConstantParameters(
+          DRAG, dragOp.getDur(), dragOp.getAmp(), dragOp.getSigma(),
+          getConstantFloat(dragOp.getBeta()));
+    }
+    if (!parameters)
+      return;
+
+    OpBuilder builder(op);
+    auto waveformOp = builder.create<Waveform_CreateOp>(
+        op->getLoc(), WaveformType::get(&getContext()),
+        getSamples(*parameters));
+    op->getResult(0).replaceAllUsesWith(waveformOp.getWfr());
+    op->erase();
+  });
+} // runOnOperation
+
+llvm::StringRef SampleWaveformsPass::getArgument() const {
+  return "pulse-sample-waveforms";
+}
+
+llvm::StringRef SampleWaveformsPass::getDescription() const {
+  return "Replace parametric waveforms with constant parameters by their "
+         "samples";
+}
+
+llvm::StringRef SampleWaveformsPass::getName() const {
+  return "Sample Waveforms Pass";
+}
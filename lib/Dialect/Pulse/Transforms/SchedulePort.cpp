@@ -1,6 +1,6 @@
 //===- SchedulePort.cpp - Schedule Ops on single port -----------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,10 +24,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/Pulse/Transforms/SchedulePort.h"
+#include "Dialect/Pulse/IR/PulseAttributes.h"
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 #include "Dialect/Pulse/IR/PulseTraits.h"
 #include "Dialect/Pulse/IR/PulseTypes.h"
+#include "Dialect/Pulse/Transforms/SequenceDurationAnalysis.h"
 #include "Dialect/Pulse/Utils/Utils.h"
 #include "Utils/DebugIndent.h"
 #include "Utils/SymbolCacheAnalysis.h"
@@ -37,10 +39,14 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Region.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
@@ -73,11 +79,24 @@ uint64_t SchedulePortPass::processCall(CallSequenceOp &callSequenceOp,
   auto sequenceOp = symbolCache->getOp<SequenceOp>(callSequenceOp);
   assert(sequenceOp && "could not convert cached symbol to sequence");
 
-  uint64_t calleeDuration;
-  if (updateNestedSequences)
-    calleeDuration = updateSequence(sequenceOp);
-  else
-    calleeDuration = processSequence(sequenceOp);
+  // every sequence is processed (updated) once, repeated calls reuse the
+  // duration
+  auto &durations =
+      updateNestedSequences ? updatedDurations : scheduledDurations;
+  auto [it, inserted] = durations.try_emplace(sequenceOp, 0);
+  if (inserted) {
+    if (updateNestedSequences) {
+      it->second = updateSequence(sequenceOp);
+    } else {
+      auto durationOrFailure = processSequence(sequenceOp);
+      if (failed(durationOrFailure)) {
+        signalPassFailure();
+        return 0;
+      }
+      it->second = *durationOrFailure;
+    }
+  }
+  uint64_t const calleeDuration = it->second;
   PulseOpSchedulingInterface::setDuration(callSequenceOp, calleeDuration);
 
   INDENT_DEBUG("====  processCall - end  ====================\n");
@@ -86,20 +105,24 @@ uint64_t SchedulePortPass::processCall(CallSequenceOp &callSequenceOp,
   return calleeDuration;
 }
 
-uint64_t SchedulePortPass::processSequence(SequenceOp sequenceOp) {
-
-  mlir::OpBuilder builder(sequenceOp);
+FailureOr<uint64_t> SchedulePortPass::processSequence(SequenceOp sequenceOp) {
 
-  uint32_t numMixedFrames = 0;
-  auto mixedFrameSequences = buildMixedFrameMap(sequenceOp, numMixedFrames);
+  // sequences scheduled ahead of time keep their timepoints
+  if (sequenceOp->hasAttr(getPrecompiledAttrName()))
+    if (auto duration = sequenceOp->getAttrOfType<IntegerAttr>(
+            interfaces_impl::getDurationAttrName(sequenceOp)))
+      return static_cast<uint64_t>(duration.getInt());
 
   int64_t maxTime = 0;
+  SmallVector<DelayOp> delayOps;
 
-  addTimepoints(builder, mixedFrameSequences, maxTime);
+  if (failed(addTimepoints(sequenceOp, maxTime, delayOps)))
+    return failure();
 
   // remove all DelayOps - they are no longer required now that we have
   // timepoints
-  sequenceOp->walk([&](DelayOp op) { op->erase(); });
+  for (auto delayOp : delayOps)
+    delayOp->erase();
 
   // sort updated ops so that ops across mixed frame are in the correct
   // sequence with respect to timepoint on a single port.
@@ -139,14 +162,15 @@ uint64_t SchedulePortPass::updateSequence(SequenceOp sequenceOp) {
         } else if (auto castOp = dyn_cast<CallSequenceOp>(op)) {
           // a nested sequence should only have a duration if it has been
           // updated by this method already
-          if (!castOp->hasAttr("pulse.duration")) {
+          auto duration = castOp->getAttrOfType<IntegerAttr>(
+              interfaces_impl::getDurationAttrName(castOp));
+          if (!duration) {
             uint64_t const calleeDuration =
                 processCall(castOp, /*updateNested*/ true);
             PulseOpSchedulingInterface::setDuration(castOp, calleeDuration);
             updateDelta += calleeDuration;
           } else {
-            updateDelta +=
-                castOp->getAttrOfType<IntegerAttr>("pulse.duration").getInt();
+            updateDelta += duration.getInt();
           }
         }
       }
@@ -155,118 +179,161 @@ uint64_t SchedulePortPass::updateSequence(SequenceOp sequenceOp) {
   return returnTimepoint;
 }
 
-SchedulePortPass::mixedFrameMap_t
-SchedulePortPass::buildMixedFrameMap(SequenceOp &sequenceOp,
-                                     uint32_t &numMixedFrames) {
-
-  // build a map between mixed frame (as represented by the arg index)
-  // and a vector of operations on that mixed frame
-
-  // process sequence arguments to initialize map with empty vectors
-  mixedFrameMap_t mixedFrameSequences;
-  for (auto const &argumentResult :
-       llvm::enumerate(sequenceOp.getArguments())) {
-    auto index = argumentResult.index();
-    auto argumentType = argumentResult.value().getType();
-    if (argumentType.isa<MixedFrameType>()) {
-      numMixedFrames++;
-      mixedFrameSequences[index] = {};
-    }
-  }
+namespace {
+// get the mixed frame an operation with the HasTargetFrame trait acts on
+Value getTargetFrame(Operation &op) {
+  if (auto castOp = dyn_cast<DelayOp>(op))
+    return castOp.getTarget();
+  if (auto castOp = dyn_cast<PlayOp>(op))
+    return castOp.getTarget();
+  if (auto castOp = dyn_cast<CaptureOp>(op))
+    return castOp.getTarget();
+  if (auto castOp = dyn_cast<SetFrequencyOp>(op))
+    return castOp.getTarget();
+  if (auto castOp = dyn_cast<SetPhaseOp>(op))
+    return castOp.getTarget();
+  if (auto castOp = dyn_cast<ShiftFrequencyOp>(op))
+    return castOp.getTarget();
+  if (auto castOp = dyn_cast<ShiftPhaseOp>(op))
+    return castOp.getTarget();
+  if (auto castOp = dyn_cast<SetAmplitudeOp>(op))
+    return castOp.getTarget();
+  return {};
+}
+} // anonymous namespace
+
+LogicalResult
+SchedulePortPass::addTimepoints(SequenceOp sequenceOp, int64_t &maxTime,
+                                SmallVectorImpl<DelayOp> &delayOps) {
 
-  // build vectors of operations on each mixed frame and push onto the
-  // corresponding vector in the map
+  // add timepoint to operations on mixed frames where timepoints are
+  // calculated based on the duration of delayOps and playOps
   //
-  // currently only considering DelayOp and PlayOp
+  // Each mixed frame (as represented by the arg index) keeps its own
+  // timeline starting at 0. The operations are visited once in program
+  // order, which visits the operations of every mixed frame in their order
+  // on that frame.
+  //
+  // A call sequence is on the timelines of all mixed frames passed to it.
+  // These are visited in ascending arg index and the timepoint of the call
+  // is the latest one seen so far, such that frames with a higher arg index
+  // continue from at least the timepoint of frames with a lower arg index.
+  //
+  // currently only DelayOp and PlayOp advance the timeline
+  SmallVector<int64_t> frameTimepoints(sequenceOp.getNumArguments(), 0);
+  SmallVector<uint32_t, 4> callFrames;
+
+  auto advanceTo = [](int64_t &frameTimepoint, Operation *op) {
+    auto existingTimepoint = PulseOpSchedulingInterface::getTimepoint(op);
+    if (existingTimepoint.has_value() &&
+        existingTimepoint.value() > frameTimepoint)
+      frameTimepoint = existingTimepoint.value();
+    PulseOpSchedulingInterface::setTimepoint(op, frameTimepoint);
+  };
+
   for (Region &region : sequenceOp->getRegions()) {
     for (Block &block : region.getBlocks()) {
       for (Operation &op : block.getOperations()) {
         if (op.hasTrait<mlir::pulse::HasTargetFrame>()) {
-          Value target;
-          // get mixed_frames
-          if (auto castOp = dyn_cast<DelayOp>(op))
-            target = castOp.getTarget();
-          else if (auto castOp = dyn_cast<PlayOp>(op))
-            target = castOp.getTarget();
-          else if (auto castOp = dyn_cast<CaptureOp>(op))
-            target = castOp.getTarget();
-          else if (auto castOp = dyn_cast<SetFrequencyOp>(op))
-            target = castOp.getTarget();
-          else if (auto castOp = dyn_cast<SetPhaseOp>(op))
-            target = castOp.getTarget();
-          else if (auto castOp = dyn_cast<ShiftFrequencyOp>(op))
-            target = castOp.getTarget();
-          else if (auto castOp = dyn_cast<ShiftPhaseOp>(op))
-            target = castOp.getTarget();
-          else if (auto castOp = dyn_cast<SetAmplitudeOp>(op))
-            target = castOp.getTarget();
-
-          auto blockArg = target.cast<BlockArgument>();
-          auto index = blockArg.getArgNumber();
-
-          mixedFrameSequences[index].push_back(&op);
-        } else if (auto castOp = dyn_cast<CallSequenceOp>(op)) {
-          // add a call sequence to all mixedFrameSequences for
-          // mixedFrames passed to it
-          for (auto operand : castOp.getOperands()) {
-            auto operandType = operand.getType();
-            if (operandType.isa<MixedFrameType>()) {
-              auto blockArg = operand.cast<BlockArgument>();
-              auto index = blockArg.getArgNumber();
-              mixedFrameSequences[index].push_back(&op);
+          auto blockArg = getTargetFrame(op).cast<BlockArgument>();
+          int64_t &frameTimepoint = frameTimepoints[blockArg.getArgNumber()];
+          advanceTo(frameTimepoint, &op);
+
+          // update the timeline if DelayOp or PlayOp
+          if (auto delayOp = dyn_cast<DelayOp>(op)) {
+            llvm::Expected<uint64_t> durOrError =
+                PulseOpSchedulingInterface::getDuration<DelayOp>(delayOp);
+            if (auto err = durOrError.takeError()) {
+              delayOp.emitError() << toString(std::move(err));
+              return failure();
             }
+            frameTimepoint += durOrError.get();
+            delayOps.push_back(delayOp);
+          } else if (auto playOp = dyn_cast<PlayOp>(op)) {
+            llvm::Expected<uint64_t> durOrError =
+                SequenceDurationAnalysis::getPlayDuration(playOp);
+            if (auto err = durOrError.takeError()) {
+              playOp.emitError() << toString(std::move(err));
+              return failure();
+            }
+            frameTimepoint += durOrError.get();
           }
+        } else if (auto castOp = dyn_cast<CallSequenceOp>(op)) {
+          callFrames.clear();
+          for (auto operand : castOp.getOperands())
+            if (operand.getType().isa<MixedFrameType>())
+              callFrames.push_back(
+                  operand.cast<BlockArgument>().getArgNumber());
+          llvm::sort(callFrames);
+          for (uint32_t const index : callFrames)
+            advanceTo(frameTimepoints[index], &op);
         }
       }
     }
   }
-  return mixedFrameSequences;
-} // buildMixedFrameMap
-
-void SchedulePortPass::addTimepoints(mlir::OpBuilder &builder,
-                                     mixedFrameMap_t &mixedFrameSequences,
-                                     int64_t &maxTime) {
 
-  // add timepoint to operations in mixedFrameSequences where timepoints
-  // are calculated based on the duration of delayOps
-  //
-  // Timepoints start at 0 for each mixed frame vector and are calculated
-  // independently for each mixed frame.
-
-  for (const auto &index : mixedFrameSequences) {
-    int64_t currentTimepoint = 0;
-    for (auto *op : index.second) {
-      auto existingTimepoint = PulseOpSchedulingInterface::getTimepoint(op);
-      if (existingTimepoint.has_value())
-        if (existingTimepoint.value() > currentTimepoint)
-          currentTimepoint = existingTimepoint.value();
-
-      // set attribute on op with current timepoint
-      PulseOpSchedulingInterface::setTimepoint(op, currentTimepoint);
+  for (int64_t const frameTimepoint : frameTimepoints)
+    if (frameTimepoint > maxTime)
+      maxTime = frameTimepoint;
+  return success();
+} // addTimepoints
 
-      // update currentTimepoint if DelayOp or playOp
+namespace {
+// returns true if the timelines of sequenceOp do not depend on the operands
+// of its calls
+bool hasStaticSchedule(SequenceOp sequenceOp) {
+  auto isKnown = [](llvm::Expected<uint64_t> durOrError) {
+    if (durOrError)
+      return true;
+    llvm::consumeError(durOrError.takeError());
+    return false;
+  };
+
+  for (Block &block : sequenceOp.getBody()) {
+    for (Operation &op : block) {
+      if (isa<CallSequenceOp>(op))
+        return false;
       if (auto delayOp = dyn_cast<DelayOp>(op)) {
-        llvm::Expected<uint64_t> durOrError =
-            PulseOpSchedulingInterface::getDuration<DelayOp>(delayOp);
-        if (auto err = durOrError.takeError()) {
-          delayOp.emitError() << toString(std::move(err));
-          signalPassFailure();
-        }
-        currentTimepoint += durOrError.get();
+        if (!isKnown(PulseOpSchedulingInterface::getDuration<DelayOp>(delayOp)))
+          return false;
       } else if (auto playOp = dyn_cast<PlayOp>(op)) {
-        llvm::Expected<uint64_t> durOrError =
-            playOp.getDuration(nullptr /*callSequenceOp*/);
-        if (auto err = durOrError.takeError()) {
-          playOp.emitError() << toString(std::move(err));
-          signalPassFailure();
-        }
-        currentTimepoint += durOrError.get();
+        if (!isKnown(SequenceDurationAnalysis::getPlayDuration(playOp)))
+          return false;
       }
     }
-    if (currentTimepoint > maxTime)
-      maxTime = currentTimepoint;
   }
-} // addTimepoints
+  return true;
+}
+} // anonymous namespace
+
+void SchedulePortPass::precompileSequences(Operation *module) {
+
+  // schedule every sequence of the module, e.g. of a pulse calibration
+  // library, and record its duration. Programs using the sequences skip
+  // scheduling them again. Sequences which call other sequences, or whose
+  // durations depend on their arguments, are left to be scheduled for each
+  // call.
+  SmallVector<SequenceOp> sequenceOps;
+  module->walk([&](SequenceOp sequenceOp) {
+    if (!sequenceOp->hasAttr(getPrecompiledAttrName()) &&
+        hasStaticSchedule(sequenceOp))
+      sequenceOps.push_back(sequenceOp);
+  });
+
+  auto precompiledAttr = UnitAttr::get(&getContext());
+  auto result = failableParallelForEach(
+      &getContext(), sequenceOps, [&](SequenceOp sequenceOp) {
+        auto durationOrFailure = processSequence(sequenceOp);
+        if (failed(durationOrFailure))
+          return failure();
+        PulseOpSchedulingInterface::setDuration(sequenceOp,
+                                                *durationOrFailure);
+        sequenceOp->setAttr(getPrecompiledAttrName(), precompiledAttr);
+        return success();
+      });
+  if (failed(result))
+    signalPassFailure();
+} // precompileSequences
 
 void SchedulePortPass::runOnOperation() {
 
@@ -274,13 +341,52 @@ void SchedulePortPass::runOnOperation() {
 
   symbolCache = &getAnalysis<qssc::utils::SymbolCacheAnalysis>()
                      .addToCache<mlir::pulse::SequenceOp>();
+  scheduledDurations.clear();
+  updatedDurations.clear();
 
   INDENT_DEBUG("===== SchedulePortPass - start ==========\n");
 
-  // assign
+  if (precompile) {
+    precompileSequences(module);
+    INDENT_DEBUG("=====  SchedulePortPass - end ===========\n");
+    return;
+  }
+
+  // assign timepoints to the sequences called from outside of a sequence;
+  // each sequence is processed once no matter how often it is called
+  SmallVector<SequenceOp> sequenceOps;
+  DenseMap<Operation *, SmallVector<CallSequenceOp, 1>> callSequenceOps;
   module->walk([&](CallSequenceOp op) {
-    processCall(op, /*updateNestedSequences*/ false);
+    if (op->getParentOfType<SequenceOp>())
+      return;
+    auto sequenceOp = symbolCache->getOp<SequenceOp>(op);
+    auto &calls = callSequenceOps[sequenceOp];
+    if (calls.empty())
+      sequenceOps.push_back(sequenceOp);
+    calls.push_back(op);
   });
+
+  // processing a sequence only modifies its own body, so the distinct
+  // sequences are processed in parallel unless threading is disabled for the
+  // context
+  SmallVector<uint64_t> durations(sequenceOps.size(), 0);
+  auto result = failableParallelForEach(
+      &getContext(), llvm::seq<size_t>(0, sequenceOps.size()), [&](size_t i) {
+        auto durationOrFailure = processSequence(sequenceOps[i]);
+        if (failed(durationOrFailure))
+          return failure();
+        durations[i] = *durationOrFailure;
+        return success();
+      });
+  if (failed(result))
+    return signalPassFailure();
+
+  for (const auto &[sequenceOp, duration] : llvm::zip(sequenceOps, durations)) {
+    scheduledDurations[sequenceOp] = duration;
+    for (auto callSequenceOp : callSequenceOps[sequenceOp])
+      PulseOpSchedulingInterface::setDuration(callSequenceOp, duration);
+  }
+
   module->walk([&](CallSequenceOp op) {
     processCall(op, /*updateNestedSequences*/ true);
   });
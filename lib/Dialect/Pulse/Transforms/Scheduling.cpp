@@ -20,6 +20,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/Pulse/Transforms/Scheduling.h"
+#include "Dialect/Pulse/Transforms/SequenceDurationAnalysis.h"
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 #include "Dialect/Pulse/IR/PulseTypes.h"
@@ -28,21 +29,27 @@
 
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/Value.h"
 #include "mlir/IR/Visitors.h"
 #include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <memory>
+#include <queue>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 
 #define DEBUG_TYPE "SchedulingDebug"
@@ -57,6 +64,8 @@ void QuantumCircuitPulseSchedulingPass::runOnOperation() {
       SCHEDULING_METHOD = ALAP;
     else if (schedulingMethod.getValue() == "asap")
       SCHEDULING_METHOD = ASAP;
+    else if (schedulingMethod.getValue() == "list")
+      SCHEDULING_METHOD = LIST;
     else
       llvm_unreachable("scheduling method not supported currently");
   }
@@ -65,156 +74,382 @@ void QuantumCircuitPulseSchedulingPass::runOnOperation() {
   if (preMeasureBufferDelay.hasValue())
     PRE_MEASURE_BUFFER_DELAY = preMeasureBufferDelay.getValue();
 
+  // check for command line override of the measurement window limit
+  if (maxConcurrentCaptures.hasValue())
+    MAX_CONCURRENT_CAPTURES = maxConcurrentCaptures.getValue();
+
   ModuleOp const moduleOp = getOperation();
 
+  gateSequenceInfos.clear();
+
   // populate/cache the symbol map
   symbolCache = &getAnalysis<qssc::utils::SymbolCacheAnalysis>()
                      .invalidate()
                      .addToCache<SequenceOp>();
+  // the gate durations are computed from their bodies unless labeled
+  sequenceDurations = &getAnalysis<SequenceDurationAnalysis>();
 
-  // schedule all the quantum circuits which are root call sequence ops
+  // group the root call sequence ops, i.e., the quantum circuit calls, by
+  // quantum circuit so that each circuit is scheduled once
+  SmallVector<CircuitCalls> circuits;
+  llvm::DenseMap<Operation *, unsigned int> circuitIndices;
   moduleOp->walk([&](mlir::pulse::CallSequenceOp callSequenceOp) {
     // return if the call sequence op is not a root op
     if (isa<SequenceOp>(callSequenceOp->getParentOp()))
       return;
-    switch (SCHEDULING_METHOD) {
-    case ALAP:
-      scheduleAlap(callSequenceOp);
-      break;
-    default:
-      llvm_unreachable("scheduling method not supported currently");
+    auto circuitOp = symbolCache->getOp<SequenceOp>(callSequenceOp);
+    auto [it, inserted] =
+        circuitIndices.try_emplace(circuitOp, circuits.size());
+    if (inserted) {
+      cacheGateSequenceInfos(circuitOp);
+      circuits.push_back({circuitOp, {}});
     }
+    circuits[it->second].callSequenceOps.push_back(callSequenceOp);
   });
+
+  // distinct quantum circuits do not share any state, and scheduling only
+  // modifies the body of the circuit, so the circuits are scheduled in
+  // parallel unless threading is disabled for the context
+  auto result = failableParallelForEach(
+      &getContext(), circuits, [&](CircuitCalls &circuit) {
+        CircuitSchedulingState state;
+        auto scheduleOrFailure = scheduleCircuit(circuit.circuitOp, state);
+        if (failed(scheduleOrFailure))
+          return failure();
+        circuit.schedule = *scheduleOrFailure;
+        return success();
+      });
+  if (failed(result))
+    return signalPassFailure();
+
+  for (auto &circuit : circuits) {
+    for (auto callSequenceOp : circuit.callSequenceOps) {
+      PulseOpSchedulingInterface::setDuration(callSequenceOp,
+                                              circuit.schedule.duration);
+      PulseOpSchedulingInterface::setTimepoint(callSequenceOp,
+                                               circuit.schedule.timepoint);
+    }
+  }
 }
 
-void QuantumCircuitPulseSchedulingPass::scheduleAlap(
-    mlir::pulse::CallSequenceOp quantumCircuitCallSequenceOp) {
+mlir::FailureOr<QuantumCircuitPulseSchedulingPass::CircuitSchedule>
+QuantumCircuitPulseSchedulingPass::scheduleCircuit(
+    mlir::pulse::SequenceOp circuitOp, CircuitSchedulingState &state) {
+  LLVM_DEBUG(llvm::dbgs() << "\nscheduling " << circuitOp.getSymName() << "\n");
+  if (failed(collectGateCalls(circuitOp, state)))
+    return failure();
 
-  assert(symbolCache && "symbolCache not set");
-  auto quantumCircuitSequenceOp =
-      symbolCache->getOp<SequenceOp>(quantumCircuitCallSequenceOp);
-  std::string const sequenceName = quantumCircuitSequenceOp.getSymName().str();
-  LLVM_DEBUG(llvm::dbgs() << "\nscheduling " << sequenceName << "\n");
-
-  int totalDurationOfQuantumCircuitNegative = 0;
-  mixFrameToNextAvailabilityMap.clear();
-
-  // get the MLIR block of the quantum circuit
-  auto quantumCircuitSequenceOpBlock =
-      quantumCircuitSequenceOp.getBody().begin();
-  // go over the MLIR operation of the block in reverse order, and find
-  // CallSequenceOps, each of which corresponds to a quantum gate. for each
-  // CallSequenceOps, we add a timepoint based on the availability of involved
+  switch (SCHEDULING_METHOD) {
+  case ALAP:
+    return scheduleAlap(state);
+  case ASAP:
+    return scheduleAsap(state);
+  case LIST:
+    return scheduleList(circuitOp, state);
+  }
+  llvm_unreachable("scheduling method not supported currently");
+}
+
+QuantumCircuitPulseSchedulingPass::CircuitSchedule
+QuantumCircuitPulseSchedulingPass::scheduleAlap(
+    CircuitSchedulingState &state) {
+
+  int64_t totalDurationOfQuantumCircuitNegative = 0;
+
+  // go over the quantum gates of the circuit in reverse order; for each
+  // quantum gate, we add a timepoint based on the availability of involved
   // ports; timepoints are <=0 because we're walking in reverse order. Note this
   // pass assumes that the operations inside these CallSequenceOps are already
   // scheduled
-  for (auto opIt = quantumCircuitSequenceOpBlock->rbegin(),
-            opEnd = quantumCircuitSequenceOpBlock->rend();
-       opIt != opEnd; ++opIt) {
-    auto &op = *opIt;
-    if (auto quantumGateCallSequenceOp =
-            dyn_cast<mlir::pulse::CallSequenceOp>(op)) {
-      // find quantum gate SequenceOp
-      assert(symbolCache && "symbolCache not set");
-      auto quantumGateSequenceOp =
-          symbolCache->getOp<SequenceOp>(quantumGateCallSequenceOp);
-      const std::string quantumGateSequenceName =
-          quantumGateSequenceOp.getSymName().str();
-      LLVM_DEBUG(llvm::dbgs() << "\tprocessing inner sequence "
-                              << quantumGateSequenceName << "\n");
-
-      // find the block argument numbers of the mix frames
-      std::unordered_set<unsigned int> mixFramesBlockArgNums =
-          getMixFramesBlockArgNums(quantumGateCallSequenceOp);
-
-      // find duration of the quantum gate callSequenceOp
-      llvm::Expected<uint64_t> durOrError =
-          quantumGateSequenceOp.getDuration(quantumGateCallSequenceOp);
-      if (auto err = durOrError.takeError()) {
-        quantumGateSequenceOp.emitError() << toString(std::move(err));
-        signalPassFailure();
-      }
-      const uint64_t quantumGateCallSequenceOpDuration = durOrError.get();
-      LLVM_DEBUG(llvm::dbgs() << "\t\tduration "
-                              << quantumGateCallSequenceOpDuration << "\n");
-
-      // find next available time for all the mix frames
-      const int64_t nextAvailableTimeOfAllMixFrames =
-          getNextAvailableTimeOfMixFrames(mixFramesBlockArgNums);
-      LLVM_DEBUG(llvm::dbgs() << "\t\tnext availability is at "
-                              << nextAvailableTimeOfAllMixFrames << "\n");
-
-      // find the updated available time, i.e., when the current quantum gate
-      // will be scheduled
-      int64_t updatedAvailableTime =
-          nextAvailableTimeOfAllMixFrames - quantumGateCallSequenceOpDuration;
-      // set the timepoint of quantum gate
-      PulseOpSchedulingInterface::setTimepoint(quantumGateCallSequenceOp,
-                                               updatedAvailableTime);
-      LLVM_DEBUG(llvm::dbgs() << "\t\tcurrent gate scheduled at "
-                              << updatedAvailableTime << "\n");
-      // update the mix frame availability map
-      if (sequenceOpIncludeCapture(quantumGateSequenceOp))
-        updatedAvailableTime -= PRE_MEASURE_BUFFER_DELAY;
-      updateMixFrameAvailabilityMap(mixFramesBlockArgNums,
-                                    updatedAvailableTime);
-
-      // keep track of total duration of the quantum circuit
-      if (updatedAvailableTime < totalDurationOfQuantumCircuitNegative)
-        totalDurationOfQuantumCircuitNegative = updatedAvailableTime;
-    }
+  for (auto &gateCall : llvm::reverse(state.gateCalls)) {
+    auto quantumGateCallSequenceOp = gateCall.callSequenceOp;
+    const GateSequenceInfo &gateSequenceInfo = *gateCall.gateSequenceInfo;
+    const uint64_t quantumGateCallSequenceOpDuration = gateCall.duration;
+    LLVM_DEBUG(llvm::dbgs() << "\t\tduration "
+                            << quantumGateCallSequenceOpDuration << "\n");
+
+    // find next available time for all the mix frames
+    const int64_t nextAvailableTimeOfAllMixFrames =
+        getNextAvailableTimeOfMixFrames(quantumGateCallSequenceOp,
+                                        gateSequenceInfo, state);
+    LLVM_DEBUG(llvm::dbgs() << "\t\tnext availability is at "
+                            << nextAvailableTimeOfAllMixFrames << "\n");
+
+    // find the updated available time, i.e., when the current quantum gate
+    // will be scheduled
+    int64_t updatedAvailableTime =
+        nextAvailableTimeOfAllMixFrames -
+        static_cast<int64_t>(quantumGateCallSequenceOpDuration);
+    // set the timepoint of quantum gate
+    PulseOpSchedulingInterface::setTimepoint(quantumGateCallSequenceOp,
+                                             updatedAvailableTime);
+    LLVM_DEBUG(llvm::dbgs() << "\t\tcurrent gate scheduled at "
+                            << updatedAvailableTime << "\n");
+    // update the mix frame availability
+    if (gateSequenceInfo.includesCapture)
+      updatedAvailableTime -= PRE_MEASURE_BUFFER_DELAY;
+    updateMixFrameAvailability(quantumGateCallSequenceOp, gateSequenceInfo,
+                               updatedAvailableTime, state);
+
+    // keep track of total duration of the quantum circuit
+    if (updatedAvailableTime < totalDurationOfQuantumCircuitNegative)
+      totalDurationOfQuantumCircuitNegative = updatedAvailableTime;
   }
 
   // multiply by -1 so that quantum circuit duration becomes positive
-  const int totalDurationOfQuantumCircuit =
+  const int64_t totalDurationOfQuantumCircuit =
       -totalDurationOfQuantumCircuitNegative;
   LLVM_DEBUG(llvm::dbgs() << "\ttotal duration of quantum circuit "
                           << totalDurationOfQuantumCircuit << "\n");
 
-  // setting duration of the quantum call circuit
-  PulseOpSchedulingInterface::setDuration(quantumCircuitCallSequenceOp,
-                                          totalDurationOfQuantumCircuit);
-  // setting timepoint of the quantum call circuit; at this point, we can add
+  // the timepoint of the quantum call circuit; at this point, we can add
   // totalDurationOfQuantumCircuit to above <=0 timepoints, so that they become
   // >=0, however, that would require walking the IR again. Instead, we add a
   // postive timepoint to the parent op, i.e., quantum circuit call sequence op,
   // and later passes would need to add this value as an offset to determine the
   // effective timepoints
-  PulseOpSchedulingInterface::setTimepoint(quantumCircuitCallSequenceOp,
-                                           totalDurationOfQuantumCircuit);
+  return CircuitSchedule{totalDurationOfQuantumCircuit,
+                         totalDurationOfQuantumCircuit};
+}
+
+namespace {
+/// Returns the earliest time at or after startTime at which a measurement
+/// window of the given duration overlaps fewer than maxWindows of the
+/// already scheduled windows
+int64_t findCaptureWindow(ArrayRef<std::pair<int64_t, int64_t>> windows,
+                          int64_t startTime, int64_t duration,
+                          uint64_t maxWindows) {
+  // the number of overlapping windows can only drop at the end of a window
+  SmallVector<int64_t> candidates{startTime};
+  for (auto [begin, end] : windows)
+    if (end > startTime)
+      candidates.push_back(end);
+  llvm::sort(candidates);
+
+  for (int64_t const time : candidates) {
+    uint64_t const overlapping =
+        llvm::count_if(windows, [&](const std::pair<int64_t, int64_t> &w) {
+          return w.first < time + duration && time < w.second;
+        });
+    if (overlapping < maxWindows)
+      return time;
+  }
+  // nothing overlaps after the end of the last window
+  return candidates.back();
+}
+} // anonymous namespace
+
+void QuantumCircuitPulseSchedulingPass::cacheGateSequenceInfos(
+    mlir::pulse::SequenceOp circuitOp) {
+  assert(symbolCache && "symbolCache not set");
+  for (auto quantumGateCallSequenceOp :
+       circuitOp.getBody().front().getOps<mlir::pulse::CallSequenceOp>())
+    getGateSequenceInfo(
+        symbolCache->getOp<SequenceOp>(quantumGateCallSequenceOp));
+}
+
+mlir::LogicalResult QuantumCircuitPulseSchedulingPass::collectGateCalls(
+    mlir::pulse::SequenceOp circuitOp, CircuitSchedulingState &state) {
+  assert(symbolCache && "symbolCache not set");
+  assert(sequenceDurations && "sequenceDurations not set");
+  state.gateCalls.clear();
+  state.mixFrameNextAvailability.assign(circuitOp.getNumArguments(), 0);
+
+  for (auto quantumGateCallSequenceOp :
+       circuitOp.getBody().front().getOps<mlir::pulse::CallSequenceOp>()) {
+    // only read the caches here, they are populated by
+    // cacheGateSequenceInfos before scheduling
+    auto quantumGateSequenceOp = symbolCache->getOpByName<SequenceOp>(
+        quantumGateCallSequenceOp.getCallee());
+    auto infoIt = gateSequenceInfos.find(quantumGateSequenceOp);
+    assert(infoIt != gateSequenceInfos.end() &&
+           "gate sequence info not cached");
+
+    llvm::Expected<uint64_t> durOrError =
+        sequenceDurations->getDuration(quantumGateCallSequenceOp);
+    if (auto err = durOrError.takeError()) {
+      quantumGateSequenceOp.emitError() << toString(std::move(err));
+      return failure();
+    }
+    state.gateCalls.push_back({quantumGateCallSequenceOp,
+                               infoIt->second.get(), durOrError.get()});
+  }
+  return success();
+}
+
+QuantumCircuitPulseSchedulingPass::CircuitSchedule
+QuantumCircuitPulseSchedulingPass::scheduleAsap(
+    CircuitSchedulingState &state) {
+
+  // go over the quantum gates in program order and start each as soon as all
+  // of its mix frames are available; timepoints are >=0
+  int64_t totalDurationOfQuantumCircuit = 0;
+  for (auto &gateCall : state.gateCalls) {
+    int64_t startTime = getEarliestStartTimeOfMixFrames(
+        gateCall.callSequenceOp, *gateCall.gateSequenceInfo, state);
+    if (gateCall.gateSequenceInfo->includesCapture)
+      startTime += static_cast<int64_t>(PRE_MEASURE_BUFFER_DELAY);
+    PulseOpSchedulingInterface::setTimepoint(gateCall.callSequenceOp,
+                                             startTime);
+    LLVM_DEBUG(llvm::dbgs() << "\t\tgate scheduled at " << startTime << "\n");
+
+    int64_t const endTime = startTime + static_cast<int64_t>(gateCall.duration);
+    updateMixFrameAvailability(gateCall.callSequenceOp,
+                               *gateCall.gateSequenceInfo, endTime, state);
+    totalDurationOfQuantumCircuit =
+        std::max(totalDurationOfQuantumCircuit, endTime);
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "\ttotal duration of quantum circuit "
+                          << totalDurationOfQuantumCircuit << "\n");
+  // the timepoints are already >=0, so no offset is needed
+  return CircuitSchedule{totalDurationOfQuantumCircuit, 0};
+}
+
+QuantumCircuitPulseSchedulingPass::CircuitSchedule
+QuantumCircuitPulseSchedulingPass::scheduleList(
+    mlir::pulse::SequenceOp circuitOp, CircuitSchedulingState &state) {
+
+  auto &gateCalls = state.gateCalls;
+  auto const numGates = gateCalls.size();
+  auto occupiedDuration = [&](const GateCall &gateCall) {
+    int64_t duration = static_cast<int64_t>(gateCall.duration);
+    if (gateCall.gateSequenceInfo->includesCapture)
+      duration += static_cast<int64_t>(PRE_MEASURE_BUFFER_DELAY);
+    return duration;
+  };
+
+  // a gate depends on the previous gate using each of its mix frames
+  SmallVector<SmallVector<unsigned int, 4>> successors(numGates);
+  SmallVector<unsigned int> numPredecessors(numGates, 0);
+  SmallVector<int64_t> lastUsers(circuitOp.getNumArguments(), -1);
+  for (unsigned int gate = 0; gate < numGates; ++gate) {
+    auto &gateCall = gateCalls[gate];
+    for (auto operandNum : gateCall.gateSequenceInfo->mixFrameOperandNums) {
+      auto id = gateCall.callSequenceOp.getOperand(operandNum)
+                    .cast<BlockArgument>()
+                    .getArgNumber();
+      int64_t const lastUser = lastUsers[id];
+      if (lastUser >= 0 && (successors[lastUser].empty() ||
+                            successors[lastUser].back() != gate)) {
+        successors[lastUser].push_back(gate);
+        ++numPredecessors[gate];
+      }
+      lastUsers[id] = gate;
+    }
+  }
+
+  // gates on the longest remaining path to the end of the circuit go first
+  SmallVector<int64_t> priorities(numGates, 0);
+  for (unsigned int gate = numGates; gate-- > 0;) {
+    int64_t remaining = 0;
+    for (auto successor : successors[gate])
+      remaining = std::max(remaining, priorities[successor]);
+    priorities[gate] = remaining + occupiedDuration(gateCalls[gate]);
+  }
+
+  // ties are broken by program order
+  std::priority_queue<std::pair<int64_t, int64_t>> readyGates;
+  for (unsigned int gate = 0; gate < numGates; ++gate)
+    if (numPredecessors[gate] == 0)
+      readyGates.emplace(priorities[gate], -static_cast<int64_t>(gate));
+
+  SmallVector<int64_t> earliestStartTimes(numGates, 0);
+  SmallVector<std::pair<int64_t, int64_t>> captureWindows;
+  int64_t totalDurationOfQuantumCircuit = 0;
+  while (!readyGates.empty()) {
+    auto const gate = static_cast<unsigned int>(-readyGates.top().second);
+    readyGates.pop();
+    auto &gateCall = gateCalls[gate];
+    auto const duration = static_cast<int64_t>(gateCall.duration);
+
+    int64_t startTime = earliestStartTimes[gate];
+    if (gateCall.gateSequenceInfo->includesCapture) {
+      startTime += static_cast<int64_t>(PRE_MEASURE_BUFFER_DELAY);
+      if (MAX_CONCURRENT_CAPTURES)
+        startTime = findCaptureWindow(captureWindows, startTime, duration,
+                                      MAX_CONCURRENT_CAPTURES);
+      captureWindows.emplace_back(startTime, startTime + duration);
+    }
+    PulseOpSchedulingInterface::setTimepoint(gateCall.callSequenceOp,
+                                             startTime);
+    LLVM_DEBUG(llvm::dbgs() << "\t\tgate scheduled at " << startTime << "\n");
+
+    int64_t const endTime = startTime + duration;
+    totalDurationOfQuantumCircuit =
+        std::max(totalDurationOfQuantumCircuit, endTime);
+    for (auto successor : successors[gate]) {
+      earliestStartTimes[successor] =
+          std::max(earliestStartTimes[successor], endTime);
+      if (--numPredecessors[successor] == 0)
+        readyGates.emplace(priorities[successor],
+                           -static_cast<int64_t>(successor));
+    }
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "\ttotal duration of quantum circuit "
+                          << totalDurationOfQuantumCircuit << "\n");
+  // the timepoints are already >=0, so no offset is needed
+  return CircuitSchedule{totalDurationOfQuantumCircuit, 0};
+}
+
+const QuantumCircuitPulseSchedulingPass::GateSequenceInfo &
+QuantumCircuitPulseSchedulingPass::getGateSequenceInfo(
+    mlir::pulse::SequenceOp quantumGateSequenceOp) {
+  auto &entry = gateSequenceInfos[quantumGateSequenceOp];
+  if (entry)
+    return *entry;
+
+  entry = std::make_unique<GateSequenceInfo>();
+  GateSequenceInfo &info = *entry;
+  for (auto const &argumentResult :
+       llvm::enumerate(quantumGateSequenceOp.getArgumentTypes()))
+    if (argumentResult.value().isa<mlir::pulse::MixedFrameType>())
+      info.mixFrameOperandNums.push_back(argumentResult.index());
+  info.includesCapture = sequenceOpIncludeCapture(quantumGateSequenceOp);
+  return info;
 }
 
 int64_t QuantumCircuitPulseSchedulingPass::getNextAvailableTimeOfMixFrames(
-    std::unordered_set<unsigned int> &mixFramesBlockArgNums) {
+    mlir::pulse::CallSequenceOp quantumGateCallSequenceOp,
+    const GateSequenceInfo &gateSequenceInfo,
+    const CircuitSchedulingState &state) {
   int64_t nextAvailableTimeOfAllMixFrames = 0;
-  for (auto id : mixFramesBlockArgNums)
-    if (mixFrameToNextAvailabilityMap.find(id) !=
-            mixFrameToNextAvailabilityMap.end() &&
-        mixFrameToNextAvailabilityMap[id] < nextAvailableTimeOfAllMixFrames)
-      nextAvailableTimeOfAllMixFrames = mixFrameToNextAvailabilityMap[id];
+  for (auto operandNum : gateSequenceInfo.mixFrameOperandNums) {
+    auto id = quantumGateCallSequenceOp.getOperand(operandNum)
+                  .cast<BlockArgument>()
+                  .getArgNumber();
+    nextAvailableTimeOfAllMixFrames = std::min(
+        nextAvailableTimeOfAllMixFrames, state.mixFrameNextAvailability[id]);
+  }
   return nextAvailableTimeOfAllMixFrames;
 }
 
-std::unordered_set<unsigned int>
-QuantumCircuitPulseSchedulingPass::getMixFramesBlockArgNums(
-    mlir::pulse::CallSequenceOp quantumGateCallSequenceOp) {
-  std::unordered_set<unsigned int> mixFramesBlockArgNums;
-  for (auto const &argumentResult :
-       llvm::enumerate(quantumGateCallSequenceOp.getOperands())) {
-    auto argType = argumentResult.value().getType();
-    if (auto mixFrameType = argType.dyn_cast<mlir::pulse::MixedFrameType>()) {
-      mixFramesBlockArgNums.insert(
-          argumentResult.value().dyn_cast<BlockArgument>().getArgNumber());
-    }
+int64_t QuantumCircuitPulseSchedulingPass::getEarliestStartTimeOfMixFrames(
+    mlir::pulse::CallSequenceOp quantumGateCallSequenceOp,
+    const GateSequenceInfo &gateSequenceInfo,
+    const CircuitSchedulingState &state) {
+  int64_t earliestStartTime = 0;
+  for (auto operandNum : gateSequenceInfo.mixFrameOperandNums) {
+    auto id = quantumGateCallSequenceOp.getOperand(operandNum)
+                  .cast<BlockArgument>()
+                  .getArgNumber();
+    earliestStartTime =
+        std::max(earliestStartTime, state.mixFrameNextAvailability[id]);
   }
-  return mixFramesBlockArgNums;
+  return earliestStartTime;
 }
 
-void QuantumCircuitPulseSchedulingPass::updateMixFrameAvailabilityMap(
-    std::unordered_set<unsigned int> &mixFramesBlockArgNums,
-    int64_t updatedAvailableTime) {
-  for (auto id : mixFramesBlockArgNums)
-    mixFrameToNextAvailabilityMap[id] = updatedAvailableTime;
+void QuantumCircuitPulseSchedulingPass::updateMixFrameAvailability(
+    mlir::pulse::CallSequenceOp quantumGateCallSequenceOp,
+    const GateSequenceInfo &gateSequenceInfo, int64_t updatedAvailableTime,
+    CircuitSchedulingState &state) {
+  for (auto operandNum : gateSequenceInfo.mixFrameOperandNums) {
+    auto id = quantumGateCallSequenceOp.getOperand(operandNum)
+                  .cast<BlockArgument>()
+                  .getArgNumber();
+    state.mixFrameNextAvailability[id] = updatedAvailableTime;
+  }
 }
 
 bool QuantumCircuitPulseSchedulingPass::sequenceOpIncludeCapture(
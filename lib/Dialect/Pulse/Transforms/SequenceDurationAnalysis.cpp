@@ -0,0 +1,250 @@
+//===- SequenceDurationAnalysis.cpp - Sequence durations --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the analysis computing the durations of pulse
+///  sequences from their bodies.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/SequenceDurationAnalysis.h"
+
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/IR/PulseTypes.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+std::optional<uint64_t> getLabeledDuration(Operation *op) {
+  if (auto duration = op->getAttrOfType<IntegerAttr>(
+          interfaces_impl::getDurationAttrName(op)))
+    return static_cast<uint64_t>(duration.getInt());
+  return std::nullopt;
+}
+
+// the constant integer or the waveform duration of value, given the
+// arguments of the sequence defining it
+std::optional<int64_t>
+getValueDuration(Value value,
+                 const SequenceDurationAnalysis::ArgumentSignature &arguments) {
+  if (auto blockArg = value.dyn_cast<BlockArgument>()) {
+    if (blockArg.getArgNumber() < arguments.size())
+      return arguments[blockArg.getArgNumber()];
+    return std::nullopt;
+  }
+  if (auto constantOp = value.getDefiningOp<arith::ConstantIntOp>())
+    return constantOp.value();
+  if (auto waveformOp = value.getDefiningOp<Waveform_CreateOp>()) {
+    auto durOrError = waveformOp.getDuration(nullptr /*callSequenceOp*/);
+    if (durOrError)
+      return static_cast<int64_t>(*durOrError);
+    llvm::consumeError(durOrError.takeError());
+    return std::nullopt;
+  }
+  // parametric waveforms last their duration operand
+  if (auto constOp = value.getDefiningOp<ConstOp>())
+    return getValueDuration(constOp.getDur(), arguments);
+  if (auto gaussianOp = value.getDefiningOp<GaussianOp>())
+    return getValueDuration(gaussianOp.getDur(), arguments);
+  if (auto gaussianSquareOp = value.getDefiningOp<GaussianSquareOp>())
+    return getValueDuration(gaussianSquareOp.getDur(), arguments);
+  if (auto dragOp = value.getDefiningOp<DragOp>())
+    return getValueDuration(dragOp.getDur(), arguments);
+  return std::nullopt;
+}
+
+llvm::Error unknownDuration(Operation *op, const llvm::Twine &what) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Could not determine the duration of " +
+                                     op->getName().getStringRef() + ": " +
+                                     what);
+}
+} // anonymous namespace
+
+SequenceDurationAnalysis::SequenceDurationAnalysis(Operation *op) {
+  op->walk([&](SequenceOp sequenceOp) {
+    sequences.try_emplace(sequenceOp.getSymName(), sequenceOp);
+  });
+}
+
+llvm::Expected<uint64_t>
+SequenceDurationAnalysis::getDuration(CallSequenceOp callOp) {
+  auto sequenceOp = sequences.lookup(callOp.getCallee());
+  if (!sequenceOp)
+    return unknownDuration(callOp, "unknown sequence " + callOp.getCallee());
+  // the precedence of SequenceOp::getDuration
+  if (auto duration = getLabeledDuration(sequenceOp))
+    return *duration;
+  if (auto duration = getLabeledDuration(callOp))
+    return *duration;
+  return getDuration(sequenceOp, getSignature(callOp.getOperands()));
+}
+
+llvm::Expected<uint64_t>
+SequenceDurationAnalysis::getDuration(SequenceOp sequenceOp,
+                                      const ArgumentSignature &arguments) {
+  if (auto duration = getLabeledDuration(sequenceOp))
+    return *duration;
+
+  auto key = std::make_pair(sequenceOp.getOperation(), arguments);
+  {
+    const std::lock_guard<std::mutex> lock(durationsMutex);
+    auto it = durations.find(key);
+    if (it != durations.end())
+      return it->second;
+  }
+
+  // computed without holding the lock, which the nested calls take; two
+  // threads racing for a sequence compute the same duration
+  auto durOrError = computeDuration_(sequenceOp, arguments);
+  if (!durOrError)
+    return durOrError.takeError();
+  const std::lock_guard<std::mutex> lock(durationsMutex);
+  durations.try_emplace(std::move(key), *durOrError);
+  return *durOrError;
+}
+
+llvm::Expected<uint64_t>
+SequenceDurationAnalysis::getPlayDuration(PlayOp playOp,
+                                          const ArgumentSignature &arguments) {
+  if (auto duration = getLabeledDuration(playOp))
+    return *duration;
+  auto duration = getValueDuration(playOp.getWfr(), arguments);
+  if (!duration || *duration < 0)
+    return unknownDuration(playOp, "the waveform is not known");
+  return static_cast<uint64_t>(*duration);
+}
+
+SequenceDurationAnalysis::ArgumentSignature
+SequenceDurationAnalysis::getSignature(ValueRange operands,
+                                       const ArgumentSignature &arguments) {
+  ArgumentSignature signature;
+  signature.reserve(operands.size());
+  for (Value const operand : operands)
+    signature.push_back(getValueDuration(operand, arguments));
+  return signature;
+}
+
+llvm::Expected<uint64_t>
+SequenceDurationAnalysis::computeDuration_(SequenceOp sequenceOp,
+                                           const ArgumentSignature &arguments) {
+  // the next availability of each frame
+  llvm::DenseMap<Value, uint64_t> frameTimes;
+  uint64_t duration = 0;
+
+  // scheduled operations start at their timepoint at the earliest
+  auto startTime = [](uint64_t available, Operation *op) {
+    if (auto timepoint = PulseOpSchedulingInterface::getTimepoint(op))
+      return std::max<uint64_t>(available, std::max<int64_t>(*timepoint, 0));
+    return available;
+  };
+
+  for (Block &block : sequenceOp.getBody()) {
+    for (Operation &op : block) {
+      if (auto delayOp = dyn_cast<DelayOp>(op)) {
+        auto delay = getValueDuration(delayOp.getDur(), arguments);
+        if (!delay || *delay < 0)
+          return unknownDuration(delayOp, "the delay is not known");
+        uint64_t &frameTime = frameTimes[delayOp.getTarget()];
+        frameTime = startTime(frameTime, delayOp) + *delay;
+        duration = std::max(duration, frameTime);
+      } else if (auto playOp = dyn_cast<PlayOp>(op)) {
+        auto durOrError = getPlayDuration(playOp, arguments);
+        if (!durOrError)
+          return durOrError.takeError();
+        uint64_t &frameTime = frameTimes[playOp.getTarget()];
+        frameTime = startTime(frameTime, playOp) + *durOrError;
+        duration = std::max(duration, frameTime);
+      } else if (auto callOp = dyn_cast<CallSequenceOp>(op)) {
+        auto calleeOp = sequences.lookup(callOp.getCallee());
+        if (!calleeOp)
+          return unknownDuration(callOp,
+                                 "unknown sequence " + callOp.getCallee());
+        uint64_t callDuration = 0;
+        if (auto duration = getLabeledDuration(callOp)) {
+          callDuration = *duration;
+        } else {
+          auto durOrError = getDuration(
+              calleeOp, getSignature(callOp.getOperands(), arguments));
+          if (!durOrError)
+            return durOrError.takeError();
+          callDuration = *durOrError;
+        }
+
+        // the call starts once all of its frames are available
+        uint64_t callStart = startTime(0, callOp);
+        for (Value const operand : callOp.getOperands())
+          if (operand.getType().isa<MixedFrameType, FrameType>())
+            callStart = std::max(callStart, frameTimes[operand]);
+        uint64_t const callEnd = callStart + callDuration;
+        for (Value const operand : callOp.getOperands())
+          if (operand.getType().isa<MixedFrameType, FrameType>())
+            frameTimes[operand] = callEnd;
+        duration = std::max(duration, callEnd);
+      } else if (isa<ReturnOp>(op)) {
+        duration = startTime(duration, &op);
+      }
+    }
+  }
+  return duration;
+}
+
+void TestSequenceDurationAnalysisPass::runOnOperation() {
+  auto &analysis = getAnalysis<SequenceDurationAnalysis>();
+  getOperation()->walk([&](CallSequenceOp callOp) {
+    if (callOp->getParentOfType<SequenceOp>())
+      return;
+    auto durOrError = analysis.getDuration(callOp);
+    if (!durOrError) {
+      callOp.emitError() << llvm::toString(durOrError.takeError());
+      return;
+    }
+    callOp.emitRemark() << "duration " << *durOrError;
+  });
+  markAllAnalysesPreserved();
+}
+
+llvm::StringRef TestSequenceDurationAnalysisPass::getArgument() const {
+  return "test-sequence-duration-analysis";
+}
+
+llvm::StringRef TestSequenceDurationAnalysisPass::getDescription() const {
+  return "Remark the duration of each sequence call computed by the "
+         "sequence duration analysis.";
+}
+
+llvm::StringRef TestSequenceDurationAnalysisPass::getName() const {
+  return "Test Sequence Duration Analysis Pass";
+}
@@ -0,0 +1,460 @@
+//===- TimelineReport.cpp - Report pulse schedule occupancy -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for reporting the occupancy of ports and
+///  mixed frames in a scheduled pulse program.
+///
+///  The pass reads the pulse.timepoint and pulse.duration attributes set by
+///  the quantum-circuit-pulse-scheduling and pulse-schedule-port passes. It
+///  follows the calls from the functions of the module into the sequences,
+///  offsetting the timepoints of the operations in a sequence by the
+///  timepoint of the call, and maps the mixed frame arguments back to the
+///  pulse.mix_frame operations passed to them. Plays, and captures with a
+///  duration, occupy their mixed frame. A call to a sequence without
+///  scheduled operations occupies all mixed frames passed to it for its
+///  duration. Operations without a timepoint are ignored.
+///
+///  For every port and mixed frame the report lists the total span, the time
+///  occupied, the utilization and the idle gaps. The critical path is the
+///  chain of operations ending last, going backwards to the occupied interval
+///  ending closest before the start of the current one. All times are in
+///  samples.
+///
+///  The report is written as JSON or in the Chrome trace event format, with
+///  one process per port and one thread per mixed frame.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/TimelineReport.h"
+
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/IR/PulseTypes.h"
+#include "Utils/SymbolCacheAnalysis.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+
+// an operation occupying a mixed frame
+struct Interval {
+  int64_t start;
+  int64_t end;
+  unsigned frame;
+  llvm::StringRef label;
+};
+
+struct Frame {
+  std::string name;
+  unsigned port;
+};
+
+struct Port {
+  std::string name;
+  llvm::SmallVector<unsigned> frames;
+};
+
+class TimelineCollector {
+public:
+  explicit TimelineCollector(qssc::utils::SymbolCacheAnalysis &symbolCache)
+      : symbolCache(symbolCache) {}
+
+  void collectFunction(mlir::func::FuncOp functionOp) {
+    collect(functionOp.getBody(), /*base*/ 0, /*argFrames*/ {});
+  }
+
+  std::vector<Interval> intervals;
+  llvm::SmallVector<Frame> frames;
+  llvm::SmallVector<Port> ports;
+
+private:
+  using FrameId = std::optional<unsigned>;
+
+  void collect(Region &region, int64_t base, llvm::ArrayRef<FrameId> argFrames);
+  FrameId getFrame(Value value, llvm::ArrayRef<FrameId> argFrames,
+                   Region &region);
+  unsigned getPort(Value port);
+
+  void addInterval(FrameId frame, int64_t start, int64_t duration,
+                   llvm::StringRef label) {
+    if (frame && duration > 0)
+      intervals.push_back({start, start + duration, *frame, label});
+  }
+
+  qssc::utils::SymbolCacheAnalysis &symbolCache;
+  llvm::DenseMap<Value, unsigned> frameIds;
+  llvm::StringMap<unsigned> portIds;
+  // the sequences being collected, used to not follow recursive calls
+  llvm::SmallPtrSet<Operation *, 8> activeSequences;
+};
+
+unsigned TimelineCollector::getPort(Value port) {
+  std::string name = "<unknown>";
+  if (port)
+    if (auto portOp = dyn_cast_or_null<Port_CreateOp>(port.getDefiningOp()))
+      name = portOp.getUid().str();
+  auto [it, inserted] = portIds.try_emplace(name, ports.size());
+  if (inserted)
+    ports.push_back({name, {}});
+  return it->second;
+}
+
+TimelineCollector::FrameId
+TimelineCollector::getFrame(Value value, llvm::ArrayRef<FrameId> argFrames,
+                            Region &region) {
+  if (auto blockArg = value.dyn_cast<BlockArgument>())
+    if (blockArg.getOwner() == &region.front() &&
+        blockArg.getArgNumber() < argFrames.size())
+      return argFrames[blockArg.getArgNumber()];
+
+  auto search = frameIds.find(value);
+  if (search != frameIds.end())
+    return search->second;
+
+  std::string name;
+  unsigned port;
+  if (auto mixFrameOp = dyn_cast_or_null<MixFrameOp>(value.getDefiningOp())) {
+    name = mixFrameOp.getUid().str();
+    port = getPort(mixFrameOp.getPort());
+  } else {
+    name = "<unknown>." + std::to_string(frameIds.size());
+    port = getPort(Value());
+  }
+
+  unsigned const frame = frames.size();
+  frames.push_back({std::move(name), port});
+  ports[port].frames.push_back(frame);
+  frameIds[value] = frame;
+  return frame;
+}
+
+void TimelineCollector::collect(Region &region, int64_t base,
+                                llvm::ArrayRef<FrameId> argFrames) {
+  if (region.empty())
+    return;
+
+  auto frameOf = [&](Value value) -> FrameId {
+    if (!value.getType().isa<MixedFrameType, FrameType>())
+      return std::nullopt;
+    return getFrame(value, argFrames, region);
+  };
+
+  region.walk([&](Operation *op) {
+    auto timepoint = PulseOpSchedulingInterface::getTimepoint(op);
+    if (!timepoint.has_value())
+      return;
+    int64_t const start = base + timepoint.value();
+
+    if (auto playOp = dyn_cast<PlayOp>(op)) {
+      auto durOrError = playOp.getDuration(nullptr /*callSequenceOp*/);
+      if (!durOrError) {
+        llvm::consumeError(durOrError.takeError());
+        return;
+      }
+      addInterval(frameOf(playOp.getTarget()), start, durOrError.get(),
+                  op->getName().getStringRef());
+    } else if (auto captureOp = dyn_cast<CaptureOp>(op)) {
+      auto durOrError = PulseOpSchedulingInterface::getDuration(op, nullptr);
+      if (!durOrError) {
+        llvm::consumeError(durOrError.takeError());
+        return;
+      }
+      addInterval(frameOf(captureOp.getTarget()), start, durOrError.get(),
+                  op->getName().getStringRef());
+    } else if (auto callSequenceOp = dyn_cast<CallSequenceOp>(op)) {
+      auto sequenceOp = symbolCache.getOp<SequenceOp>(callSequenceOp);
+      if (!activeSequences.insert(sequenceOp).second)
+        return;
+
+      llvm::SmallVector<FrameId> calleeFrames;
+      for (auto operand : callSequenceOp.getOperands())
+        calleeFrames.push_back(frameOf(operand));
+
+      size_t const numIntervals = intervals.size();
+      collect(sequenceOp.getBody(), start, calleeFrames);
+      activeSequences.erase(sequenceOp);
+      if (intervals.size() != numIntervals)
+        return;
+
+      // the callee has not been scheduled by pulse-schedule-port, the call
+      // occupies all of its mixed frames
+      auto durOrError = PulseOpSchedulingInterface::getDuration(op, nullptr);
+      if (!durOrError) {
+        llvm::consumeError(durOrError.takeError());
+        return;
+      }
+      llvm::sort(calleeFrames);
+      calleeFrames.erase(std::unique(calleeFrames.begin(), calleeFrames.end()),
+                         calleeFrames.end());
+      for (auto frame : calleeFrames)
+        addInterval(frame, start, durOrError.get(), sequenceOp.getSymName());
+    }
+  });
+}
+
+// the occupancy of a set of intervals
+struct Occupancy {
+  int64_t start{0};
+  int64_t end{0};
+  int64_t busy{0};
+  // start and duration of the idle gaps between the intervals
+  llvm::SmallVector<std::pair<int64_t, int64_t>> gaps;
+
+  int64_t span() const { return end - start; }
+  double utilization() const {
+    return span() > 0 ? static_cast<double>(busy) / span() : 0.0;
+  }
+};
+
+Occupancy computeOccupancy(llvm::SmallVectorImpl<const Interval *> &sorted) {
+  Occupancy occupancy;
+  if (sorted.empty())
+    return occupancy;
+
+  llvm::sort(sorted, [](const Interval *a, const Interval *b) {
+    return a->start < b->start;
+  });
+  occupancy.start = sorted.front()->start;
+  int64_t mergedStart = sorted.front()->start;
+  int64_t mergedEnd = sorted.front()->end;
+  for (const auto *interval : llvm::drop_begin(sorted)) {
+    if (interval->start > mergedEnd) {
+      occupancy.busy += mergedEnd - mergedStart;
+      occupancy.gaps.emplace_back(mergedEnd, interval->start - mergedEnd);
+      mergedStart = interval->start;
+    }
+    mergedEnd = std::max(mergedEnd, interval->end);
+  }
+  occupancy.busy += mergedEnd - mergedStart;
+  occupancy.end = mergedEnd;
+  return occupancy;
+}
+
+std::vector<const Interval *>
+computeCriticalPath(const std::vector<Interval> &intervals) {
+  std::vector<const Interval *> byEnd;
+  byEnd.reserve(intervals.size());
+  for (const auto &interval : intervals)
+    byEnd.push_back(&interval);
+  // intervals with the same end are ordered by descending duration such that
+  // the longest one is picked
+  llvm::sort(byEnd, [](const Interval *a, const Interval *b) {
+    return a->end < b->end || (a->end == b->end && a->start > b->start);
+  });
+
+  std::vector<const Interval *> path;
+  auto current = byEnd.rbegin();
+  while (current != byEnd.rend()) {
+    path.push_back(*current);
+    int64_t const start = (*current)->start;
+    // the interval ending last at or before the start of the current one
+    auto next = std::upper_bound(
+        byEnd.begin(), byEnd.end(), start,
+        [](int64_t time, const Interval *interval) {
+          return time < interval->end;
+        });
+    if (next == byEnd.begin())
+      break;
+    current = std::make_reverse_iterator(next);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+void writeOccupancy(llvm::json::OStream &json, const Occupancy &occupancy) {
+  json.attribute("start", occupancy.start);
+  json.attribute("end", occupancy.end);
+  json.attribute("span", occupancy.span());
+  json.attribute("busy", occupancy.busy);
+  json.attribute("utilization", occupancy.utilization());
+  json.attributeArray("idleGaps", [&] {
+    for (const auto &[start, duration] : occupancy.gaps)
+      json.object([&] {
+        json.attribute("start", start);
+        json.attribute("duration", duration);
+      });
+  });
+}
+
+void writeReport(llvm::raw_ostream &os, const TimelineCollector &timeline) {
+  llvm::SmallVector<llvm::SmallVector<const Interval *>> frameIntervals(
+      timeline.frames.size());
+  llvm::SmallVector<const Interval *> allIntervals;
+  for (const auto &interval : timeline.intervals) {
+    frameIntervals[interval.frame].push_back(&interval);
+    allIntervals.push_back(&interval);
+  }
+  Occupancy const total = computeOccupancy(allIntervals);
+
+  llvm::json::OStream json(os, /*IndentSize*/ 2);
+  json.object([&] {
+    json.attribute("start", total.start);
+    json.attribute("end", total.end);
+    json.attribute("span", total.span());
+    json.attributeArray("ports", [&] {
+      for (const auto &port : timeline.ports) {
+        llvm::SmallVector<const Interval *> portIntervals;
+        for (unsigned const frame : port.frames)
+          portIntervals.append(frameIntervals[frame]);
+        json.object([&] {
+          json.attribute("name", port.name);
+          writeOccupancy(json, computeOccupancy(portIntervals));
+          json.attributeArray("mixedFrames", [&] {
+            for (unsigned const frame : port.frames)
+              json.object([&] {
+                json.attribute("name", timeline.frames[frame].name);
+                writeOccupancy(json, computeOccupancy(frameIntervals[frame]));
+              });
+          });
+        });
+      }
+    });
+
+    auto criticalPath = computeCriticalPath(timeline.intervals);
+    int64_t busy = 0;
+    for (const auto *interval : criticalPath)
+      busy += interval->end - interval->start;
+    json.attributeObject("criticalPath", [&] {
+      json.attribute("busy", busy);
+      json.attribute("idle", total.span() - busy);
+      json.attributeArray("operations", [&] {
+        for (const auto *interval : criticalPath)
+          json.object([&] {
+            json.attribute("name", interval->label);
+            json.attribute("mixedFrame",
+                           timeline.frames[interval->frame].name);
+            json.attribute("start", interval->start);
+            json.attribute("end", interval->end);
+          });
+      });
+    });
+  });
+  os << "\n";
+}
+
+void writeChromeTrace(llvm::raw_ostream &os,
+                      const TimelineCollector &timeline) {
+  int64_t start = std::numeric_limits<int64_t>::max();
+  for (const auto &interval : timeline.intervals)
+    start = std::min(start, interval.start);
+
+  llvm::json::OStream json(os, /*IndentSize*/ 2);
+  json.object([&] {
+    json.attributeArray("traceEvents", [&] {
+      for (const auto &port : llvm::enumerate(timeline.ports)) {
+        json.object([&] {
+          json.attribute("name", "process_name");
+          json.attribute("ph", "M");
+          json.attribute("pid", port.index());
+          json.attributeObject(
+              "args", [&] { json.attribute("name", port.value().name); });
+        });
+        for (unsigned const frame : port.value().frames)
+          json.object([&] {
+            json.attribute("name", "thread_name");
+            json.attribute("ph", "M");
+            json.attribute("pid", port.index());
+            json.attribute("tid", frame);
+            json.attributeObject("args", [&] {
+              json.attribute("name", timeline.frames[frame].name);
+            });
+          });
+      }
+      for (const auto &interval : timeline.intervals)
+        json.object([&] {
+          json.attribute("name", interval.label);
+          json.attribute("ph", "X");
+          json.attribute("ts", interval.start - start);
+          json.attribute("dur", interval.end - interval.start);
+          json.attribute("pid", timeline.frames[interval.frame].port);
+          json.attribute("tid", interval.frame);
+        });
+    });
+  });
+  os << "\n";
+}
+
+} // anonymous namespace
+
+void TimelineReportPass::runOnOperation() {
+  bool const chromeTrace = format == "chrome-trace";
+  if (!chromeTrace && format != "json") {
+    getOperation()->emitError()
+        << "unsupported timeline report format " << format;
+    return signalPassFailure();
+  }
+
+  auto &symbolCache = getAnalysis<qssc::utils::SymbolCacheAnalysis>()
+                          .addToCache<SequenceOp>();
+
+  TimelineCollector timeline(symbolCache);
+  for (auto functionOp : getOperation().getOps<mlir::func::FuncOp>())
+    timeline.collectFunction(functionOp);
+
+  std::string errorMessage;
+  auto output = mlir::openOutputFile(outputFile, &errorMessage);
+  if (!output) {
+    getOperation()->emitError() << errorMessage;
+    return signalPassFailure();
+  }
+  if (chromeTrace)
+    writeChromeTrace(output->os(), timeline);
+  else
+    writeReport(output->os(), timeline);
+  output->keep();
+
+  markAllAnalysesPreserved();
+}
+
+llvm::StringRef TimelineReportPass::getArgument() const {
+  return "pulse-timeline-report";
+}
+
+llvm::StringRef TimelineReportPass::getDescription() const {
+  return "Report the occupancy of ports and mixed frames of a scheduled "
+         "pulse program";
+}
+
+llvm::StringRef TimelineReportPass::getName() const {
+  return "Timeline Report Pass";
+}
@@ -0,0 +1,218 @@
+//===- RuntimeEstimate.cpp - Estimate the runtime of programs ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the estimation of the execution time of a scheduled
+///  program on the hardware.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Utils/RuntimeEstimate.h"
+
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/QCS/IR/QCSAttributes.h"
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Region.h"
+#include "mlir/Interfaces/LoopLikeInterface.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+llvm::Error cannotEstimate(Operation *op, const llvm::Twine &reason) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Cannot estimate the runtime of " +
+                                     op->getName().getStringRef() + ": " +
+                                     reason);
+}
+
+// Estimates the runtime of the body of a main function
+class RuntimeEstimator {
+public:
+  explicit RuntimeEstimator(std::optional<double> dtTimestep)
+      : dtTimestep(dtTimestep) {}
+
+  llvm::Expected<double> getBlockSeconds(Block &block) {
+    double seconds = 0.;
+    for (Operation &op : block) {
+      auto opSeconds = getOpSeconds(&op);
+      if (!opSeconds)
+        return opSeconds.takeError();
+      seconds += *opSeconds;
+    }
+    return seconds;
+  }
+
+  // the shots of the shot loop, if there is one
+  std::optional<uint64_t> numShots;
+  double shotSeconds = 0.;
+
+private:
+  llvm::Expected<double> getSampleSeconds(Operation *op, int64_t samples) {
+    if (!dtTimestep)
+      return cannotEstimate(op, "its duration is in samples of unknown dt");
+    return static_cast<double>(samples) * *dtTimestep;
+  }
+
+  llvm::Expected<double> getOpSeconds(Operation *op) {
+    // scheduled operations, e.g. the calls of circuits
+    if (auto duration = op->getAttrOfType<IntegerAttr>(
+            interfaces_impl::getDurationAttrName(op)))
+      return getSampleSeconds(op, duration.getInt());
+
+    if (auto delayOp = dyn_cast<quir::DelayOp>(op)) {
+      auto constantOp = delayOp.getTime().getDefiningOp<quir::ConstantOp>();
+      auto duration =
+          constantOp ? constantOp.getValue().dyn_cast<quir::DurationAttr>()
+                     : quir::DurationAttr();
+      if (!duration)
+        return cannotEstimate(op, "its duration is not constant");
+      if (duration.getType().cast<quir::DurationType>().getUnits() ==
+              quir::TimeUnits::dt &&
+          !dtTimestep)
+        return cannotEstimate(op, "its duration is in samples of unknown dt");
+      return duration.convertUnits(quir::TimeUnits::s, dtTimestep.value_or(1.));
+    }
+    if (auto delayOp = dyn_cast<DelayOp>(op)) {
+      auto samples = getConstantIntValue(delayOp.getDur());
+      if (!samples)
+        return cannotEstimate(op, "its duration is not constant");
+      return getSampleSeconds(op, *samples);
+    }
+
+    if (auto forOp = dyn_cast<scf::ForOp>(op))
+      return getLoopSeconds(forOp);
+    if (isa<LoopLikeOpInterface>(op))
+      return cannotEstimate(op, "its trip count is not known");
+
+    // the conditional branches are bounded by the longest of them
+    if (op->getNumRegions() > 0) {
+      double seconds = 0.;
+      for (Region &region : op->getRegions()) {
+        double regionSeconds = 0.;
+        for (Block &block : region) {
+          auto blockSeconds = getBlockSeconds(block);
+          if (!blockSeconds)
+            return blockSeconds.takeError();
+          regionSeconds += *blockSeconds;
+        }
+        seconds = std::max(seconds, regionSeconds);
+      }
+      return seconds;
+    }
+
+    if (isa<CallSequenceOp, PlayOp>(op) ||
+        llvm::any_of(op->getOperandTypes(),
+                     [](Type type) { return type.isa<quir::QubitType>(); }))
+      return cannotEstimate(op, "it is not scheduled");
+    // classical operations take no time on the scale of the pulses
+    return 0.;
+  }
+
+  llvm::Expected<double> getLoopSeconds(scf::ForOp forOp) {
+    auto bodySeconds = getBlockSeconds(*forOp.getBody());
+    if (!bodySeconds)
+      return bodySeconds.takeError();
+
+    // the shot loop within each batch runs the shots of all batches
+    if (forOp->hasAttr(qcs::getShotBatchLoopAttrName()))
+      return *bodySeconds;
+    if (forOp->hasAttr(qcs::getShotLoopAttrName())) {
+      auto shots = getNumShots(forOp);
+      if (!shots)
+        return cannotEstimate(forOp, "the number of shots is not known");
+      numShots = *shots;
+      shotSeconds = *bodySeconds;
+      return static_cast<double>(*shots) * shotSeconds;
+    }
+
+    auto tripCount = quir::getConstantTripCount(forOp);
+    if (!tripCount)
+      return cannotEstimate(forOp, "its trip count is not constant");
+    return static_cast<double>(*tripCount) * *bodySeconds;
+  }
+
+  // the number of shots given to the shot initialization, or the trip count
+  // of the shot loop
+  static std::optional<uint64_t> getNumShots(scf::ForOp shotLoop) {
+    std::optional<uint64_t> numShots;
+    shotLoop->walk([&](Operation *op) {
+      auto attr = op->getAttrOfType<IntegerAttr>(qcs::getNumShotsAttrName());
+      if (attr) {
+        numShots = attr.getInt();
+        return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    });
+    if (numShots)
+      return numShots;
+    return quir::getConstantTripCount(shotLoop);
+  }
+
+  std::optional<double> dtTimestep;
+};
+} // anonymous namespace
+
+llvm::Expected<RuntimeEstimate>
+mlir::pulse::estimateRuntime(Operation *moduleOp,
+                             std::optional<double> dtTimestep) {
+  llvm::SmallVector<func::FuncOp> mainFuncs;
+  moduleOp->walk([&](func::FuncOp funcOp) {
+    if (funcOp.getSymName() == "main")
+      mainFuncs.push_back(funcOp);
+  });
+  if (mainFuncs.empty())
+    return cannotEstimate(moduleOp, "it has no main function");
+
+  // the modules of the nodes of a target run in parallel
+  RuntimeEstimate estimate;
+  for (auto mainFunc : mainFuncs) {
+    RuntimeEstimator estimator(dtTimestep);
+    double jobSeconds = 0.;
+    for (Block &block : mainFunc.getBody()) {
+      auto blockSeconds = estimator.getBlockSeconds(block);
+      if (!blockSeconds)
+        return blockSeconds.takeError();
+      jobSeconds += *blockSeconds;
+    }
+    if (jobSeconds < estimate.jobSeconds)
+      continue;
+    // a program without a shot loop runs a single shot
+    estimate.numShots = estimator.numShots.value_or(1);
+    estimate.shotSeconds =
+        estimator.numShots ? estimator.shotSeconds : jobSeconds;
+    estimate.jobSeconds = jobSeconds;
+  }
+  return estimate;
+}
@@ -1,6 +1,6 @@
 //===- Utils.cpp - Pulse Utilities ------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,15 +23,24 @@
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 #include "Dialect/Pulse/IR/PulseTraits.h"
+#include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/AsmState.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
 #include "mlir/IR/Region.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/Support/MathExtras.h"
+
+#include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <optional>
+#include <utility>
 
 namespace mlir::pulse {
 
@@ -126,4 +135,98 @@ void sortOpsByTimepoint(SequenceOp &sequenceOp) {
   }
 }
 
+mlir::ElementsAttr getWaveformSamplesAttr(mlir::MLIRContext *context,
+                                          llvm::ArrayRef<double> samples,
+                                          int64_t minResourceSamples,
+                                          llvm::StringRef resourceName) {
+  auto numSamples = static_cast<int64_t>(samples.size() / 2);
+  auto samplesType =
+      RankedTensorType::get({numSamples, 2}, Float64Type::get(context));
+  if (minResourceSamples > 0 && numSamples >= minResourceSamples) {
+    auto blob = HeapAsmResourceBlob::allocateAndCopyInferAlign(
+        samples, /*dataIsMutable=*/false);
+    return DenseF64ResourceElementsAttr::get(samplesType, resourceName,
+                                             std::move(blob));
+  }
+  return DenseFPElementsAttr::get(samplesType, samples);
+}
+
+void releaseWaveformResources(mlir::Operation *op) {
+  op->walk([&](Waveform_CreateOp waveformOp) {
+    auto samples =
+        waveformOp.getSamples().dyn_cast<DenseResourceElementsAttr>();
+    if (!samples)
+      return;
+    if (auto *resource = samples.getRawHandle().getResource())
+      resource->setBlob(AsmResourceBlob());
+  });
+}
+
+mlir::Value createPhaseConstant(mlir::OpBuilder &builder, mlir::Location loc,
+                                double angle, mlir::Type phaseType) {
+  if (auto intType = phaseType.dyn_cast<IntegerType>()) {
+    auto const fixed =
+        quir::getFixedPointAngle(angle, intType.getIntOrFloatBitWidth());
+    return builder.create<arith::ConstantOp>(
+        loc, builder.getIntegerAttr(intType, fixed));
+  }
+  auto floatType = phaseType.cast<FloatType>();
+  return builder.create<arith::ConstantFloatOp>(loc, llvm::APFloat(angle),
+                                                floatType);
+}
+
+mlir::Value convertPhase(mlir::OpBuilder &builder, mlir::Location loc,
+                         mlir::Value phase, mlir::Type phaseType) {
+  auto fromType = phase.getType();
+  if (fromType == phaseType)
+    return phase;
+
+  auto fromInt = fromType.dyn_cast<IntegerType>();
+  auto toInt = phaseType.dyn_cast<IntegerType>();
+  if (fromInt && toInt) {
+    // rescale the fraction of a turn by shifting, dropping the low bits if
+    // narrowing
+    unsigned const fromWidth = fromInt.getWidth();
+    unsigned const toWidth = toInt.getWidth();
+    if (fromWidth < toWidth) {
+      Value const extended = builder.create<arith::ExtUIOp>(loc, toInt, phase);
+      auto shift = builder.create<arith::ConstantOp>(
+          loc, builder.getIntegerAttr(toInt, toWidth - fromWidth));
+      return builder.create<arith::ShLIOp>(loc, extended, shift);
+    }
+    auto shift = builder.create<arith::ConstantOp>(
+        loc, builder.getIntegerAttr(fromInt, fromWidth - toWidth));
+    Value const shifted = builder.create<arith::ShRUIOp>(loc, phase, shift);
+    return builder.create<arith::TruncIOp>(loc, toInt, shifted);
+  }
+
+  if (fromInt) {
+    // radians = k * 2pi / 2^N
+    auto floatType = phaseType.cast<FloatType>();
+    Value const turns = builder.create<arith::UIToFPOp>(loc, floatType, phase);
+    auto scale = builder.create<arith::ConstantFloatOp>(
+        loc,
+        llvm::APFloat(std::ldexp(2 * llvm::numbers::pi,
+                                 -static_cast<int>(fromInt.getWidth()))),
+        floatType);
+    return builder.create<arith::MulFOp>(loc, turns, scale);
+  }
+
+  // k = radians * 2^N / 2pi, converted through i64 such that negative angles
+  // wrap around a full turn once truncated
+  assert(toInt && "expect a float or a fixed-point phase");
+  auto floatType = fromType.cast<FloatType>();
+  auto scale = builder.create<arith::ConstantFloatOp>(
+      loc,
+      llvm::APFloat(std::ldexp(1.0, static_cast<int>(toInt.getWidth())) /
+                    (2 * llvm::numbers::pi)),
+      floatType);
+  Value const scaled = builder.create<arith::MulFOp>(loc, phase, scale);
+  Value const fixed =
+      builder.create<arith::FPToSIOp>(loc, builder.getI64Type(), scaled);
+  if (toInt.getWidth() == 64)
+    return fixed;
+  return builder.create<arith::TruncIOp>(loc, toInt, fixed);
+}
+
 } // end namespace mlir::pulse
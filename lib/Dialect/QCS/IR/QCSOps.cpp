@@ -1,6 +1,6 @@
 //===- QCSOps.cpp - Quantum Control System dialect ops ----------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -189,3 +189,16 @@ mlir::ParseResult ParallelEndOp::parse(mlir::OpAsmParser &parser,
 void ParallelEndOp::print(mlir::OpAsmPrinter &printer) {
   printer << getOperationName();
 }
+
+//===----------------------------------------------------------------------===//
+// ShotPostProcessEndOp
+//===----------------------------------------------------------------------===//
+
+mlir::ParseResult ShotPostProcessEndOp::parse(mlir::OpAsmParser &parser,
+                                              mlir::OperationState &result) {
+  return mlir::success();
+}
+
+void ShotPostProcessEndOp::print(mlir::OpAsmPrinter &printer) {
+  printer << getOperationName();
+}
@@ -1,6 +1,6 @@
 //===- ParameterInitialValueAnalysis.cpp - initial_value cache ---- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -9,7 +9,9 @@
 //===----------------------------------------------------------------------===//
 ///
 /// This file defines a MLIR Analysis for parameter inputs which
-/// caches the initial_value of the input parameter
+/// caches the initial_value of the input parameter. Each declared parameter
+/// is assigned a dense integer slot, such that parameter loads are resolved
+/// to their initial value by index rather than by name.
 ///
 /// Note: by default this analysis is always treated as valid unless
 /// the invalidate() method is called.
@@ -31,6 +33,8 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <optional>
+
 #define DEBUG_TYPE "ParameterInitialValueAnalysis"
 
 using namespace mlir::qcs;
@@ -84,6 +88,16 @@ ParameterInitialValueAnalysis::ParameterInitialValueAnalysis(
               initial_value = floatAttr.getValue().convertToDouble();
           }
           initial_values_[declareParameterOp.getSymName()] = initial_value;
+          // a redeclaration keeps the slot of the first declaration
+          auto [slot, inserted] = slots_.try_emplace(
+              declareParameterOp.getSymName(),
+              static_cast<ParameterSlot>(slotValues_.size()));
+          if (inserted) {
+            slotValues_.push_back(initial_value);
+            slotNames_.push_back(slot->first().str());
+          } else {
+            slotValues_[slot->second] = initial_value;
+          }
           foundParameters = true;
         }
     if (!foundParameters) {
@@ -105,6 +119,25 @@ ParameterInitialValueAnalysis::ParameterInitialValueAnalysis(
   }
 }
 
+std::optional<ParameterSlot>
+ParameterInitialValueAnalysis::getSlot(llvm::StringRef name) const {
+  auto search = slots_.find(name);
+  if (search == slots_.end())
+    return std::nullopt;
+  return search->second;
+}
+
+std::optional<ParameterSlot>
+ParameterInitialValueAnalysis::getSlot(ParameterLoadOp loadOp) {
+  auto search = loadSlots_.find(loadOp.getOperation());
+  if (search != loadSlots_.end())
+    return search->second;
+  auto slot = getSlot(loadOp.getParameterName());
+  if (slot)
+    loadSlots_[loadOp.getOperation()] = *slot;
+  return slot;
+}
+
 void ParameterInitialValueAnalysisPass::runOnOperation() {
   getAnalysis<ParameterInitialValueAnalysis>();
 } // ParameterInitialValueAnalysisPass::runOnOperation()
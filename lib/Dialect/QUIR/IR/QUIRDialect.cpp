@@ -1,6 +1,6 @@
 //===- QUIRDialect.cpp - QUIR dialect ---------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -29,6 +29,7 @@
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 
+#include "mlir/Bytecode/BytecodeImplementation.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Operation.h"
@@ -38,6 +39,10 @@
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/InliningUtils.h"
 
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/TypeSwitch.h"
+
+#include <cstdint>
 #include <optional>
 #include <type_traits>
 
@@ -101,6 +106,213 @@ struct QuirInlinerInterface : public DialectInlinerInterface {
   }
 };
 
+//===----------------------------------------------------------------------===//
+// Bytecode
+//===----------------------------------------------------------------------===//
+
+namespace {
+// The codes identifying the QUIR attributes and types in bytecode. Codes must
+// not be reused or reordered, as bytecode outlives the compiler writing it.
+enum class AttributeCode : uint64_t {
+  Angle = 0,
+  Duration = 1,
+  InputParameter = 2,
+  TimeUnits = 3,
+};
+
+enum class TypeCode : uint64_t {
+  Qubit = 0,
+  CBit = 1,
+  Angle = 2,
+  Duration = 3,
+  Stretch = 4,
+};
+
+// APFloats are written with their semantics, which are IEEE double when
+// parsed from text but need not be when built programmatically
+void writeAPFloat(const APFloat &value, DialectBytecodeWriter &writer) {
+  writer.writeVarInt(static_cast<uint64_t>(
+      APFloat::SemanticsToEnum(value.getSemantics())));
+  writer.writeAPFloatWithKnownSemantics(value);
+}
+
+FailureOr<APFloat> readAPFloat(DialectBytecodeReader &reader) {
+  uint64_t semantics;
+  if (failed(reader.readVarInt(semantics)))
+    return failure();
+  if (semantics > static_cast<uint64_t>(APFloat::S_MaxSemantics)) {
+    reader.emitError() << "invalid float semantics: " << semantics;
+    return failure();
+  }
+  return reader.readAPFloatWithKnownSemantics(APFloat::EnumToSemantics(
+      static_cast<APFloat::Semantics>(semantics)));
+}
+
+FailureOr<TimeUnits> readTimeUnits(DialectBytecodeReader &reader) {
+  uint64_t units;
+  if (failed(reader.readVarInt(units)))
+    return failure();
+  if (auto timeUnits = symbolizeTimeUnits(static_cast<uint32_t>(units)))
+    return *timeUnits;
+  reader.emitError() << "invalid time units: " << units;
+  return failure();
+}
+} // anonymous namespace
+
+/// Reads and writes the QUIR attributes and types natively rather than
+/// through their textual form, as the compile cache, the distributed
+/// compilation and the Python bindings exchange modules as bytecode.
+struct QuirBytecodeInterface : public BytecodeDialectInterface {
+  using BytecodeDialectInterface::BytecodeDialectInterface;
+
+  Attribute readAttribute(DialectBytecodeReader &reader) const final {
+    uint64_t code;
+    if (failed(reader.readVarInt(code)))
+      return {};
+    switch (static_cast<AttributeCode>(code)) {
+    case AttributeCode::Angle: {
+      AngleType type;
+      if (failed(reader.readType(type)))
+        return {};
+      auto value = readAPFloat(reader);
+      if (failed(value))
+        return {};
+      return AngleAttr::get(getContext(), type, *value);
+    }
+    case AttributeCode::Duration: {
+      DurationType type;
+      if (failed(reader.readType(type)))
+        return {};
+      auto duration = readAPFloat(reader);
+      if (failed(duration))
+        return {};
+      return DurationAttr::get(getContext(), type, *duration);
+    }
+    case AttributeCode::InputParameter: {
+      StringRef name;
+      if (failed(reader.readString(name)))
+        return {};
+      return InputParameterAttr::get(getContext(), name);
+    }
+    case AttributeCode::TimeUnits: {
+      auto units = readTimeUnits(reader);
+      if (failed(units))
+        return {};
+      return TimeUnitsAttr::get(getContext(), *units);
+    }
+    }
+    reader.emitError() << "unknown QUIR attribute code: " << code;
+    return {};
+  }
+
+  LogicalResult writeAttribute(Attribute attr,
+                               DialectBytecodeWriter &writer) const final {
+    return llvm::TypeSwitch<Attribute, LogicalResult>(attr)
+        .Case<AngleAttr>([&](AngleAttr angleAttr) {
+          writer.writeVarInt(static_cast<uint64_t>(AttributeCode::Angle));
+          writer.writeType(angleAttr.getType());
+          writeAPFloat(angleAttr.getValue(), writer);
+          return success();
+        })
+        .Case<DurationAttr>([&](DurationAttr durationAttr) {
+          writer.writeVarInt(static_cast<uint64_t>(AttributeCode::Duration));
+          writer.writeType(durationAttr.getType());
+          writeAPFloat(durationAttr.getDuration(), writer);
+          return success();
+        })
+        .Case<InputParameterAttr>([&](InputParameterAttr parameterAttr) {
+          writer.writeVarInt(
+              static_cast<uint64_t>(AttributeCode::InputParameter));
+          writer.writeOwnedString(parameterAttr.getName());
+          return success();
+        })
+        .Case<TimeUnitsAttr>([&](TimeUnitsAttr unitsAttr) {
+          writer.writeVarInt(static_cast<uint64_t>(AttributeCode::TimeUnits));
+          writer.writeVarInt(static_cast<uint64_t>(unitsAttr.getValue()));
+          return success();
+        })
+        .Default([](Attribute) { return failure(); });
+  }
+
+  Type readType(DialectBytecodeReader &reader) const final {
+    uint64_t code;
+    if (failed(reader.readVarInt(code)))
+      return {};
+    switch (static_cast<TypeCode>(code)) {
+    case TypeCode::Qubit: {
+      int64_t width;
+      if (failed(reader.readSignedVarInt(width)))
+        return {};
+      return QubitType::getChecked([&]() { return reader.emitError(); },
+                                   getContext(), static_cast<int>(width));
+    }
+    case TypeCode::CBit: {
+      uint64_t width;
+      if (failed(reader.readVarInt(width)))
+        return {};
+      return CBitType::get(getContext(), static_cast<unsigned>(width));
+    }
+    case TypeCode::Angle: {
+      // the width biased by one, zero for angles without a width
+      uint64_t width;
+      if (failed(reader.readVarInt(width)))
+        return {};
+      std::optional<int> angleWidth;
+      if (width != 0)
+        angleWidth = static_cast<int>(width - 1);
+      return AngleType::getChecked([&]() { return reader.emitError(); },
+                                   getContext(), angleWidth);
+    }
+    case TypeCode::Duration: {
+      auto units = readTimeUnits(reader);
+      if (failed(units))
+        return {};
+      return DurationType::get(getContext(), *units);
+    }
+    case TypeCode::Stretch:
+      return StretchType::get(getContext());
+    }
+    reader.emitError() << "unknown QUIR type code: " << code;
+    return {};
+  }
+
+  LogicalResult writeType(Type type,
+                          DialectBytecodeWriter &writer) const final {
+    return llvm::TypeSwitch<Type, LogicalResult>(type)
+        .Case<QubitType>([&](QubitType qubitType) {
+          writer.writeVarInt(static_cast<uint64_t>(TypeCode::Qubit));
+          writer.writeSignedVarInt(qubitType.getWidth());
+          return success();
+        })
+        .Case<CBitType>([&](CBitType cbitType) {
+          writer.writeVarInt(static_cast<uint64_t>(TypeCode::CBit));
+          writer.writeVarInt(cbitType.getWidth());
+          return success();
+        })
+        .Case<AngleType>([&](AngleType angleType) {
+          auto width = angleType.getWidth();
+          // leave the negative widths of unverified types to the text form
+          if (width.has_value() && width.value() < 0)
+            return failure();
+          writer.writeVarInt(static_cast<uint64_t>(TypeCode::Angle));
+          writer.writeVarInt(
+              width.has_value() ? static_cast<uint64_t>(width.value()) + 1
+                                : 0);
+          return success();
+        })
+        .Case<DurationType>([&](DurationType durationType) {
+          writer.writeVarInt(static_cast<uint64_t>(TypeCode::Duration));
+          writer.writeVarInt(static_cast<uint64_t>(durationType.getUnits()));
+          return success();
+        })
+        .Case<StretchType>([&](StretchType) {
+          writer.writeVarInt(static_cast<uint64_t>(TypeCode::Stretch));
+          return success();
+        })
+        .Default([](Type) { return failure(); });
+  }
+};
+
 void quir::QUIRDialect::initialize() {
 
   addTypes<
@@ -121,7 +333,7 @@ void quir::QUIRDialect::initialize() {
 #include "Dialect/QUIR/IR/QUIRAttributes.cpp.inc"
       >();
 
-  addInterfaces<QuirInlinerInterface>();
+  addInterfaces<QuirInlinerInterface, QuirBytecodeInterface>();
 }
 
 template <typename QUIRType>
@@ -20,15 +20,13 @@
 
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 
+#include "Dialect/QUIR/IR/QubitSet.h"
+
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/Visitors.h"
 #include "mlir/Support/LLVM.h"
 
-#include <algorithm>
-#include <cstdint>
-#include <iterator>
 #include <optional>
-#include <set>
 
 using namespace mlir::quir;
 
@@ -42,15 +40,14 @@ using namespace mlir::quir;
 // QubitOpInterface
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> interfaces_impl::getOperatedQubits(mlir::Operation *op,
-                                                      bool ignoreSelf) {
-  std::set<uint32_t> opQubits;
+QubitSet interfaces_impl::getOperatedQubits(mlir::Operation *op,
+                                            bool ignoreSelf) {
+  QubitSet opQubits;
   op->walk([&](mlir::Operation *walkOp) {
     if (ignoreSelf && walkOp == op)
       return WalkResult::advance();
     if (QubitOpInterface interface = dyn_cast<QubitOpInterface>(walkOp)) {
-      auto currOpQubits = interface.getOperatedQubits();
-      opQubits.insert(currOpQubits.begin(), currOpQubits.end());
+      opQubits |= interface.getOperatedQubits();
       // Avoid recursing again
       return WalkResult::skip();
     }
@@ -70,36 +67,23 @@ interfaces_impl::getNextQubitOp(mlir::Operation *op) {
   return std::nullopt;
 }
 
-std::set<uint32_t>
-interfaces_impl::getSharedQubits(std::set<uint32_t> &first,
-                                 std::set<uint32_t> &second) {
-
-  std::set<uint32_t> sharedQubits;
-  std::set_intersection(first.begin(), first.end(), second.begin(),
-                        second.end(),
-                        std::inserter(sharedQubits, sharedQubits.begin()));
-
-  return sharedQubits;
+QubitSet interfaces_impl::getSharedQubits(const QubitSet &first,
+                                          const QubitSet &second) {
+  return first & second;
 }
 
-std::set<uint32_t> interfaces_impl::getUnionQubits(std::set<uint32_t> &first,
-                                                   std::set<uint32_t> &second) {
-
-  std::set<uint32_t> unionQubits;
-  std::set_union(first.begin(), first.end(), second.begin(), second.end(),
-                 std::inserter(unionQubits, unionQubits.begin()));
-
-  return unionQubits;
+QubitSet interfaces_impl::getUnionQubits(const QubitSet &first,
+                                         const QubitSet &second) {
+  return first | second;
 }
 
-bool interfaces_impl::qubitSetsOverlap(std::set<uint32_t> &first,
-                                       std::set<uint32_t> &second) {
-  std::set<uint32_t> const sharedQubits = getSharedQubits(first, second);
-  return !sharedQubits.empty();
+bool interfaces_impl::qubitSetsOverlap(const QubitSet &first,
+                                       const QubitSet &second) {
+  return first.overlaps(second);
 }
 
-std::set<uint32_t> interfaces_impl::getSharedQubits(Operation *first,
-                                                    Operation *second) {
+QubitSet interfaces_impl::getSharedQubits(Operation *first,
+                                          Operation *second) {
   auto leftQubits = getOperatedQubits(first);
   auto rightQubits = getOperatedQubits(second);
 
@@ -107,14 +91,13 @@ std::set<uint32_t> interfaces_impl::getSharedQubits(Operation *first,
 }
 
 bool interfaces_impl::opsShareQubits(Operation *first, Operation *second) {
-  return !getSharedQubits(first, second).empty();
+  return getOperatedQubits(first).overlaps(getOperatedQubits(second));
 }
 
 // TODO: A DAG should be used for this sort of analysis.
-std::set<uint32_t>
-interfaces_impl::getQubitsBetweenOperations(mlir::Operation *first,
-                                            mlir::Operation *second) {
-  std::set<uint32_t> operatedQubits;
+QubitSet interfaces_impl::getQubitsBetweenOperations(mlir::Operation *first,
+                                                     mlir::Operation *second) {
+  QubitSet operatedQubits;
   // Don't use isBeforeInBlock if the op order is invalid as
   // this is O(n) in the worst case.
   if (first->getBlock()->isOpOrderValid() && !first->isBeforeInBlock(second))
@@ -125,8 +108,7 @@ interfaces_impl::getQubitsBetweenOperations(mlir::Operation *first,
     // Loop through qubits in block and find matching node.
     if (nextOp == second)
       return operatedQubits;
-    auto nextOpQubits = getOperatedQubits(nextOp);
-    operatedQubits.insert(nextOpQubits.begin(), nextOpQubits.end());
+    operatedQubits |= getOperatedQubits(nextOp);
     curOp = nextOp;
   }
   return {};
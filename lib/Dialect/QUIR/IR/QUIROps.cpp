@@ -1,6 +1,6 @@
 //===- QUIROps.cpp - QUIR dialect ops ---------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -21,6 +21,7 @@
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/IR/QUIRTraits.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -50,11 +51,9 @@
 #include <cassert>
 #include <cstdint>
 #include <optional>
-#include <set>
 #include <string>
 #include <sys/types.h>
 #include <utility>
-#include <vector>
 
 using namespace mlir;
 using namespace mlir::quir;
@@ -74,14 +73,11 @@ uint lookupQubitIdHandleError_(const Value &val) {
 } // anonymous namespace
 
 template <class Op>
-std::set<uint32_t> getQubitIds(Op &op) {
-  std::set<uint32_t> opQubits;
-  std::vector<Value> vals;
-  qubitCallOperands<Op>(op, vals);
-  for (auto qubit : vals) {
-    auto id = lookupQubitIdHandleError_(qubit);
-    opQubits.insert(id);
-  }
+QubitSet getQubitIds(Op &op) {
+  QubitSet opQubits;
+  for (auto qubit : op->getOperands())
+    if (qubit.getType().template isa<QubitType>())
+      opQubits.insert(lookupQubitIdHandleError_(qubit));
   return opQubits;
 } // getQubitIds
 
@@ -89,28 +85,24 @@ std::set<uint32_t> getQubitIds(Op &op) {
 // BuiltinCXOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> BuiltinCXOp::getOperatedQubits() {
-  std::set<uint32_t> opQubits;
-  opQubits.insert(lookupQubitIdHandleError_(getControl()));
-  opQubits.insert(lookupQubitIdHandleError_(getTarget()));
-  return opQubits;
+QubitSet BuiltinCXOp::getOperatedQubits() {
+  return {lookupQubitIdHandleError_(getControl()),
+          lookupQubitIdHandleError_(getTarget())};
 }
 
 //===----------------------------------------------------------------------===//
 // Builtin_UOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> Builtin_UOp::getOperatedQubits() {
-  std::set<uint32_t> opQubits;
-  opQubits.insert(lookupQubitIdHandleError_(getTarget()));
-  return opQubits;
+QubitSet Builtin_UOp::getOperatedQubits() {
+  return {lookupQubitIdHandleError_(getTarget())};
 }
 
 //===----------------------------------------------------------------------===//
 // CallGateOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> CallGateOp::getOperatedQubits() {
+QubitSet CallGateOp::getOperatedQubits() {
   return getQubitIds<CallGateOp>(*this);
 }
 
@@ -122,7 +114,7 @@ auto CallGateOp::getCalleeType() -> FunctionType {
 // MeasureOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> MeasureOp::getOperatedQubits() {
+QubitSet MeasureOp::getOperatedQubits() {
   return getQubitIds<MeasureOp>(*this);
 }
 
@@ -130,7 +122,7 @@ std::set<uint32_t> MeasureOp::getOperatedQubits() {
 // ResetOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> ResetQubitOp::getOperatedQubits() {
+QubitSet ResetQubitOp::getOperatedQubits() {
   return getQubitIds<ResetQubitOp>(*this);
 }
 
@@ -140,7 +132,7 @@ std::set<uint32_t> ResetQubitOp::getOperatedQubits() {
 // TODO: Move to `System` dialect once "lower qubits to channels/ports."
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> qcs::SynchronizeOp::getOperatedQubits() {
+QubitSet qcs::SynchronizeOp::getOperatedQubits() {
   return getQubitIds<qcs::SynchronizeOp>(*this);
 }
 
@@ -148,7 +140,7 @@ std::set<uint32_t> qcs::SynchronizeOp::getOperatedQubits() {
 // DelayOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> DelayOp::getOperatedQubits() {
+QubitSet DelayOp::getOperatedQubits() {
   return getQubitIds<DelayOp>(*this);
 }
 
@@ -158,7 +150,7 @@ std::set<uint32_t> DelayOp::getOperatedQubits() {
 // TODO: Move to `System` dialect once "lower qubits to channels/ports."
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> qcs::DelayCyclesOp::getOperatedQubits() {
+QubitSet qcs::DelayCyclesOp::getOperatedQubits() {
   return getQubitIds<qcs::DelayCyclesOp>(*this);
 }
 
@@ -166,7 +158,7 @@ std::set<uint32_t> qcs::DelayCyclesOp::getOperatedQubits() {
 // BarrierOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> BarrierOp::getOperatedQubits() {
+QubitSet BarrierOp::getOperatedQubits() {
   return getQubitIds<BarrierOp>(*this);
 }
 
@@ -272,7 +264,7 @@ auto CallCircuitOp::getCalleeType() -> FunctionType {
 LogicalResult
 CallCircuitOp::verifySymbolUses(SymbolTableCollection &symbolTable) {
 
-  auto circuitAttr = (*this)->getAttrOfType<FlatSymbolRefAttr>("callee");
+  auto circuitAttr = getCalleeAttr();
   if (!circuitAttr)
     return emitOpError("Requires a 'callee' symbol reference attribute");
 
@@ -282,8 +274,13 @@ CallCircuitOp::verifySymbolUses(SymbolTableCollection &symbolTable) {
     return emitOpError() << "'" << circuitAttr.getValue()
                          << "' does not reference a valid circuit";
 
-  // Verify the types match
+  // Verify the types match, comparing the uniqued types as a whole first
+  // such that only a mismatch is diagnosed type by type
   auto circuitType = circuit.getFunctionType();
+  if (llvm::equal(getOperandTypes(), circuitType.getInputs()) &&
+      llvm::equal(getResultTypes(), circuitType.getResults()))
+    return success();
+
   if (circuitType.getNumInputs() != getNumOperands())
     return emitOpError("incorrect number of operands for the callee circuit");
 
@@ -313,7 +310,7 @@ CallCircuitOp::verifySymbolUses(SymbolTableCollection &symbolTable) {
   return success();
 }
 
-std::set<uint32_t> CallCircuitOp::getOperatedQubits() {
+QubitSet CallCircuitOp::getOperatedQubits() {
   return getQubitIds<CallCircuitOp>(*this);
 }
 
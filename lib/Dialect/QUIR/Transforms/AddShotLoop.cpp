@@ -1,6 +1,6 @@
 //===- AddShotLoop.cpp - Add shot loop --------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -15,7 +15,8 @@
 //===----------------------------------------------------------------------===//
 //
 //  This file implements the pass for adding a for shot loop around the entire
-//  main function body
+//  main function body, optionally split into batches of shots and repeated
+//  for the points of a parameter sweep
 //
 //===----------------------------------------------------------------------===//
 
@@ -23,27 +24,76 @@
 
 #include "Dialect/QCS/IR/QCSAttributes.h"
 #include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/Location.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cstdint>
 #include <list>
 
 using namespace mlir;
 using namespace mlir::quir;
 using namespace mlir::qcs;
 
+namespace {
+// Store the measurement results of each shot of a batch in a buffer indexed
+// by the shot within the batch and the measurement within the shot, and
+// stream the buffer at the end of each batch. The buffer is allocated before
+// outerLoop and released before insertBefore.
+void addBatchReadout(scf::ForOp batchLoop, scf::ForOp shotLoop,
+                     Value numBatchShots, uint shotsPerBatch,
+                     Operation *outerLoop, Operation *insertBefore) {
+  SmallVector<Value> results;
+  shotLoop->walk([&](Operation *op) {
+    if (!isa<MeasureOp, CallCircuitOp>(op))
+      return;
+    for (auto result : op->getResults())
+      if (result.getType().isInteger(1))
+        results.push_back(result);
+  });
+
+  Location const loc = batchLoop.getLoc();
+  OpBuilder build(outerLoop);
+  auto bufferType = MemRefType::get(
+      {static_cast<int64_t>(shotsPerBatch),
+       static_cast<int64_t>(results.size())},
+      build.getI1Type());
+  auto buffer = build.create<memref::AllocOp>(loc, bufferType);
+
+  for (const auto &indexedResult : llvm::enumerate(results)) {
+    Value const result = indexedResult.value();
+    build.setInsertionPointAfterValue(result);
+    auto measurementIndex = build.create<arith::ConstantIndexOp>(
+        result.getLoc(), indexedResult.index());
+    build.create<memref::StoreOp>(
+        result.getLoc(), result, buffer,
+        ValueRange{shotLoop.getInductionVar(), measurementIndex});
+  }
+
+  build.setInsertionPoint(batchLoop.getBody()->getTerminator());
+  build.create<ShotBatchEndOp>(loc, buffer, numBatchShots);
+
+  build.setInsertionPoint(insertBefore);
+  build.create<memref::DeallocOp>(loc, buffer);
+}
+} // anonymous namespace
+
 // Entry point for the pass.
 void AddShotLoopPass::runOnOperation() {
   // This pass is only called on module Ops
@@ -68,8 +118,52 @@ void AddShotLoopPass::runOnOperation() {
       opLoc, build.getIndexType(), build.getIndexAttr(numShots));
   auto stepOp = build.create<mlir::arith::ConstantOp>(
       opLoc, build.getIndexType(), build.getIndexAttr(1));
-  auto forOp = build.create<scf::ForOp>(opLoc, startOp, endOp, stepOp);
+  // the ops to move into the main function, in order
+  SmallVector<Operation *> loopOps{startOp, endOp, stepOp};
+
+  // in sweep mode all of the shots run once per parameter point in an outer
+  // loop over the points, which the loops below are nested in. The parameter
+  // loads in the loop read the values of the current point from the
+  // parameter table of the payload.
+  scf::ForOp sweepLoop;
+  if (sweepPoints) {
+    auto numPointsOp = build.create<mlir::arith::ConstantOp>(
+        opLoc, build.getIndexType(), build.getIndexAttr(sweepPoints));
+    sweepLoop = build.create<scf::ForOp>(opLoc, startOp, numPointsOp, stepOp);
+    sweepLoop->setAttr(getSweepLoopAttrName(), build.getUnitAttr());
+    sweepLoop->setAttr(getNumSweepPointsAttrName(),
+                       build.getI32IntegerAttr(sweepPoints));
+    loopOps.append({numPointsOp, sweepLoop});
+    build.setInsertionPointToStart(sweepLoop.getBody());
+  }
+
+  // in batched mode the shot loop iterates over the shots of one batch of an
+  // outer loop over the batches, the last of which may be partial
+  scf::ForOp batchLoop;
+  Value numBatchShots;
+  if (shotsPerBatch) {
+    auto batchSizeOp = build.create<mlir::arith::ConstantOp>(
+        opLoc, build.getIndexType(), build.getIndexAttr(shotsPerBatch));
+    batchLoop = build.create<scf::ForOp>(opLoc, startOp, endOp, batchSizeOp);
+    batchLoop->setAttr(getShotBatchLoopAttrName(), build.getUnitAttr());
+    batchLoop->setAttr(getShotsPerBatchAttrName(),
+                       build.getI32IntegerAttr(shotsPerBatch));
+    if (!sweepLoop)
+      loopOps.append({batchSizeOp, batchLoop});
+
+    build.setInsertionPointToStart(batchLoop.getBody());
+    auto remainingShots = build.create<mlir::arith::SubIOp>(
+        opLoc, endOp, batchLoop.getInductionVar());
+    numBatchShots = build.create<mlir::arith::MinUIOp>(opLoc, remainingShots,
+                                                       batchSizeOp);
+  }
+
+  auto forOp = build.create<scf::ForOp>(
+      opLoc, startOp, numBatchShots ? numBatchShots : endOp.getResult(),
+      stepOp);
   forOp->setAttr(getShotLoopAttrName(), build.getUnitAttr());
+  if (!batchLoop && !sweepLoop)
+    loopOps.push_back(forOp);
 
   build.setInsertionPointToStart(&forOp.getRegion().front());
   auto shotInit = build.create<ShotInitOp>(opLoc);
@@ -101,10 +195,14 @@ void AddShotLoopPass::runOnOperation() {
     lastOp = &mainFunc.getBody().front().back();
   }
 
-  startOp->moveBefore(lastOp);
-  endOp->moveBefore(lastOp);
-  stepOp->moveBefore(lastOp);
-  forOp->moveBefore(lastOp);
+  for (auto *loopOp : loopOps)
+    loopOp->moveBefore(lastOp);
+
+  if (batchLoop)
+    addBatchReadout(batchLoop, forOp, numBatchShots, shotsPerBatch,
+                    sweepLoop ? sweepLoop.getOperation()
+                              : batchLoop.getOperation(),
+                    lastOp);
 } // runOnOperation
 
 llvm::StringRef AddShotLoopPass::getArgument() const { return "add-shot-loop"; }
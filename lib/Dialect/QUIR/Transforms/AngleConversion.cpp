@@ -1,6 +1,6 @@
 //===- AngleConversion.cpp - Convert CallGateOp Angles --------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,6 +24,7 @@
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 #include "Dialect/QUIR/Utils/Utils.h"
+#include "Utils/SymbolCacheAnalysis.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinTypes.h"
@@ -37,8 +38,6 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 
-#include <string>
-#include <unordered_map>
 #include <utility>
 
 using namespace mlir;
@@ -47,19 +46,17 @@ using namespace mlir::quir;
 namespace {
 
 struct AngleConversion : public OpRewritePattern<quir::CallGateOp> {
-  explicit AngleConversion(
-      MLIRContext *ctx,
-      std::unordered_map<std::string, mlir::func::FuncOp> &functionOps)
-      : OpRewritePattern<quir::CallGateOp>(ctx), functionOps_(functionOps) {}
+  explicit AngleConversion(MLIRContext *ctx,
+                           qssc::utils::SymbolCacheAnalysis &symbolCache)
+      : OpRewritePattern<quir::CallGateOp>(ctx), symbolCache_(symbolCache) {}
   LogicalResult matchAndRewrite(quir::CallGateOp callGateOp,
                                 PatternRewriter &rewriter) const override {
     // find the corresponding mlir::func::FuncOp
-    auto findOp =
-        functionOps_.find(callGateOp.getCalleeAttr().getValue().str());
-    if (findOp == functionOps_.end())
+    auto funcOp =
+        symbolCache_.lookup<mlir::func::FuncOp>(callGateOp.getCallee());
+    if (!funcOp)
       return failure();
 
-    mlir::func::FuncOp funcOp = findOp->second;
     FunctionType const fType = funcOp.getFunctionType();
 
     for (const auto &pair : llvm::enumerate(callGateOp.getArgOperands())) {
@@ -82,21 +79,18 @@ struct AngleConversion : public OpRewritePattern<quir::CallGateOp> {
   }
 
 private:
-  std::unordered_map<std::string, mlir::func::FuncOp> &functionOps_;
+  qssc::utils::SymbolCacheAnalysis &symbolCache_;
 }; // struct AngleConversion
 
 } // end anonymous namespace
 
 // Entry point for the pass.
 void QUIRAngleConversionPass::runOnOperation() {
-
-  auto *op = getOperation();
-  op->walk([&](mlir::func::FuncOp funcOp) {
-    functionOps[funcOp.getSymName().str()] = funcOp;
-  });
+  auto &symbolCache = getAnalysis<qssc::utils::SymbolCacheAnalysis>()
+                          .addToCache<mlir::func::FuncOp>();
 
   RewritePatternSet patterns(&getContext());
-  patterns.add<AngleConversion>(&getContext(), functionOps);
+  patterns.add<AngleConversion>(&getContext(), symbolCache);
 
   mlir::GreedyRewriteConfig config;
   // Disable to improve performance
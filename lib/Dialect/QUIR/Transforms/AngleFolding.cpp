@@ -0,0 +1,115 @@
+//===- AngleFolding.cpp - Fold constant angle arithmetic --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for evaluating the angle arithmetic which
+///  does not depend on runtime values at compile time.
+///
+///  The angle ops fold in full precision and wrap their results into
+///  [0, 2*pi), such that chains of them fold to a single constant without
+///  accumulating the rounding of the fixed point angle representation.
+///  Parameter loads are kept by default, as their values may be bound after
+///  compilation.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/AngleFolding.h"
+
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QCS/Utils/ParameterInitialValueAnalysis.h"
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <variant>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+// Replace the parameter loads by constants of the initial values of their
+// parameters, for the types the angle folding consumes
+void replaceParameterLoads(ModuleOp moduleOp,
+                           qcs::ParameterInitialValueAnalysis &analysis) {
+  llvm::SmallVector<qcs::ParameterLoadOp> loadOps;
+  moduleOp->walk([&](qcs::ParameterLoadOp loadOp) {
+    loadOps.push_back(loadOp);
+  });
+
+  OpBuilder builder(moduleOp.getContext());
+  for (auto loadOp : loadOps) {
+    auto slot = analysis.getSlot(loadOp);
+    if (!slot)
+      continue;
+    auto const *value = std::get_if<double>(&analysis.getValue(*slot));
+    if (!value)
+      continue;
+
+    builder.setInsertionPoint(loadOp);
+    Value constant;
+    Type const type = loadOp.getType();
+    if (auto angleType = type.dyn_cast<AngleType>())
+      constant = builder.create<quir::ConstantOp>(
+          loadOp->getLoc(), type,
+          AngleAttr::get(builder.getContext(), angleType,
+                         llvm::APFloat(*value)));
+    else if (auto floatType = type.dyn_cast<FloatType>())
+      constant = builder.create<arith::ConstantOp>(
+          loadOp->getLoc(), builder.getFloatAttr(floatType, *value));
+    else
+      continue;
+    loadOp->replaceAllUsesWith(ValueRange{constant});
+    loadOp->erase();
+  }
+}
+
+} // anonymous namespace
+
+void AngleFoldingPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+
+  if (foldParameters)
+    replaceParameterLoads(moduleOp,
+                          getAnalysis<qcs::ParameterInitialValueAnalysis>());
+
+  // the angle ops fold through their folders, no patterns are required
+  RewritePatternSet patterns(&getContext());
+  if (failed(applyPatternsAndFoldGreedily(moduleOp, std::move(patterns))))
+    return signalPassFailure();
+} // runOnOperation
+
+llvm::StringRef AngleFoldingPass::getArgument() const {
+  return "quir-fold-angles";
+}
+
+llvm::StringRef AngleFoldingPass::getDescription() const {
+  return "Evaluate the angle arithmetic on constant angles at compile time, "
+         "optionally with the initial values of the parameters";
+}
+
+llvm::StringRef AngleFoldingPass::getName() const {
+  return "Angle Folding Pass";
+}
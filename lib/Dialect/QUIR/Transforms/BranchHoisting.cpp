@@ -0,0 +1,169 @@
+//===- BranchHoisting.cpp - Hoist common ops out of branches ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements a utility moving operations that are common to all
+/// branches of a scf.if or quir.switch into the enclosing block.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/BranchHoisting.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Region.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <cstdint>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+enum class HoistDirection { Before, After };
+
+/// State shared by the hoisting of all branch ops under one root
+struct BranchHoister {
+  QubitDependencyAnalysis &deps;
+  llvm::function_ref<bool(Operation *)> canHoist;
+  IRRewriter &rewriter;
+
+  bool hoist(Operation *branchOp, HoistDirection direction);
+
+private:
+  bool isHoistable(Operation *op, Operation *branchOp,
+                   HoistDirection direction);
+  Operation *findEquivalent(Block &block, Operation *op, Operation *branchOp,
+                            HoistDirection direction);
+}; // struct BranchHoister
+
+bool BranchHoister::isHoistable(Operation *op, Operation *branchOp,
+                                HoistDirection direction) {
+  if (op->hasTrait<OpTrait::IsTerminator>() || !canHoist(op))
+    return false;
+
+  if (direction == HoistDirection::Before) {
+    // all operands must be available before the branch op
+    for (Value const operand : op->getOperands())
+      if (branchOp->isAncestor(operand.getParentRegion()->getParentOp()))
+        return false;
+  } else if (!op->use_empty()) {
+    return false;
+  }
+
+  // nothing else in the branch may act on its qubits before (after) it
+  for (uint32_t const qubit : deps.getOperatedQubits(op)) {
+    Operation *other = direction == HoistDirection::Before
+                           ? deps.getPrevQubitUser(op, qubit)
+                           : deps.getNextQubitUser(op, qubit);
+    if (other)
+      return false;
+  }
+  return true;
+}
+
+Operation *BranchHoister::findEquivalent(Block &block, Operation *op,
+                                         Operation *branchOp,
+                                         HoistDirection direction) {
+  for (Operation &other : block)
+    if (OperationEquivalence::isEquivalentTo(
+            op, &other, OperationEquivalence::exactValueMatch,
+            /*markEquivalent=*/nullptr,
+            OperationEquivalence::IgnoreLocations) &&
+        isHoistable(&other, branchOp, direction))
+      return &other;
+  return nullptr;
+}
+
+bool BranchHoister::hoist(Operation *branchOp, HoistDirection direction) {
+  auto regions = branchOp->getRegions();
+  // a missing else region executes nothing
+  if (regions.size() < 2 ||
+      llvm::any_of(regions, [](Region &region) { return region.empty(); }))
+    return false;
+
+  Block &first = regions.front().front();
+  bool changed = false;
+  SmallVector<Operation *> copies;
+
+  auto tryHoist = [&](Operation *candidate) {
+    if (!isHoistable(candidate, branchOp, direction))
+      return;
+
+    copies.clear();
+    for (Region &region : regions.drop_front()) {
+      Operation *copy =
+          findEquivalent(region.front(), candidate, branchOp, direction);
+      if (!copy)
+        return;
+      copies.push_back(copy);
+    }
+
+    if (direction == HoistDirection::Before)
+      deps.moveBefore(candidate, branchOp);
+    else
+      deps.moveAfter(candidate, branchOp);
+    for (Operation *copy : copies)
+      rewriter.replaceOp(copy, candidate->getResults());
+    changed = true;
+  };
+
+  // visit the operations in the order that keeps them in their original
+  // order once moved next to the branch op
+  if (direction == HoistDirection::Before)
+    for (Operation &candidate : llvm::make_early_inc_range(first))
+      tryHoist(&candidate);
+  else
+    for (Operation &candidate :
+         llvm::make_early_inc_range(llvm::reverse(first)))
+      tryHoist(&candidate);
+
+  return changed;
+}
+
+} // anonymous namespace
+
+bool mlir::quir::hoistCommonBranchOps(
+    Operation *op, QubitDependencyAnalysis &deps,
+    llvm::function_ref<bool(Operation *)> canHoist) {
+  // post-order such that operations hoisted out of nested branches can be
+  // hoisted further out of the enclosing ones
+  SmallVector<Operation *> branchOps;
+  op->walk([&](Operation *nestedOp) {
+    if (isa<scf::IfOp, SwitchOp>(nestedOp))
+      branchOps.push_back(nestedOp);
+  });
+
+  IRRewriter rewriter(op->getContext(), &deps);
+  BranchHoister hoister{deps, canHoist, rewriter};
+  bool changed = false;
+  for (Operation *branchOp : branchOps) {
+    changed |= hoister.hoist(branchOp, HoistDirection::Before);
+    changed |= hoister.hoist(branchOp, HoistDirection::After);
+  }
+  return changed;
+}
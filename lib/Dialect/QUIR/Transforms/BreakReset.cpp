@@ -1,6 +1,6 @@
 //===- BreakReset.cpp - Break apart reset ops -------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -28,10 +28,15 @@
 #include "Dialect/QUIR/Utils/Utils.h"
 #include "Utils/SymbolCacheAnalysis.h"
 
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Block.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/Location.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/TypeRange.h"
@@ -43,10 +48,14 @@
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -64,9 +73,11 @@ namespace {
 struct BreakResetsPattern : public OpRewritePattern<ResetQubitOp> {
 
   explicit BreakResetsPattern(MLIRContext *ctx, uint numIterations,
-                              uint delayCycles, BreakResetPass &thisPass)
+                              uint delayCycles, uint vectorizeMaxQubits,
+                              BreakResetPass &thisPass)
       : OpRewritePattern<ResetQubitOp>(ctx), numIterations_(numIterations),
-        delayCycles_(delayCycles), thisPass_(thisPass) {}
+        delayCycles_(delayCycles), vectorizeMaxQubits_(vectorizeMaxQubits),
+        thisPass_(thisPass) {}
 
   LogicalResult matchAndRewrite(ResetQubitOp resetOp,
                                 PatternRewriter &rewriter) const override {
@@ -108,6 +119,12 @@ struct BreakResetsPattern : public OpRewritePattern<ResetQubitOp> {
       if (thisPass_.insertQuantumGatesIntoCirc)
         thisPass_.measureList.push_back(measureOp);
 
+      size_t const numQubits = resetOp.getQubits().size();
+      if (numQubits > 1 && numQubits <= vectorizeMaxQubits_) {
+        createFlipSwitch(resetOp, measureOp, rewriter);
+        continue;
+      }
+
       size_t i = 0;
       for (auto qubit : resetOp.getQubits()) {
         auto ifOp = rewriter.create<scf::IfOp>(resetOp.getLoc(),
@@ -133,7 +150,61 @@ struct BreakResetsPattern : public OpRewritePattern<ResetQubitOp> {
 private:
   uint numIterations_;
   uint delayCycles_;
+  // resets of up to this many qubits are vectorized
+  uint vectorizeMaxQubits_;
   BreakResetPass &thisPass_;
+
+  // Flip the qubits measured in state 1 with a single quir.switch, whose
+  // flag packs the measured bits, the bit of the i-th qubit at position i
+  void createFlipSwitch(ResetQubitOp resetOp, MeasureOp measureOp,
+                        PatternRewriter &rewriter) const {
+    Location const loc = resetOp.getLoc();
+    IntegerType const i32Type = rewriter.getI32Type();
+
+    Value flag;
+    for (const auto &[index, bit] : llvm::enumerate(measureOp.getOuts())) {
+      Value shifted = rewriter.create<arith::ExtUIOp>(loc, i32Type, bit);
+      if (index == 0) {
+        flag = shifted;
+        continue;
+      }
+      Value const shift = rewriter.create<arith::ConstantIntOp>(
+          loc, static_cast<int64_t>(index), 32);
+      shifted = rewriter.create<arith::ShLIOp>(loc, shifted, shift);
+      flag = rewriter.create<arith::OrIOp>(loc, flag, shifted);
+    }
+
+    // a case for each nonzero outcome, the default case flips no qubit
+    size_t const numQubits = resetOp.getQubits().size();
+    SmallVector<uint32_t> caseValues;
+    for (uint32_t outcome = 1; outcome < (1u << numQubits); ++outcome)
+      caseValues.push_back(outcome);
+    auto caseValuesAttr = DenseIntElementsAttr::get(
+        VectorType::get(static_cast<int64_t>(caseValues.size()), i32Type),
+        caseValues);
+    auto switchOp = rewriter.create<SwitchOp>(
+        loc, /*resultTypes=*/TypeRange{}, flag, caseValuesAttr,
+        /*caseRegionsCount=*/caseValues.size());
+
+    auto savedInsertionPoint = rewriter.saveInsertionPoint();
+    rewriter.createBlock(&switchOp.getDefaultRegion());
+    rewriter.create<quir::YieldOp>(loc);
+    for (auto [caseRegion, outcome] :
+         llvm::zip(switchOp.getCaseRegions(), caseValues)) {
+      rewriter.createBlock(&caseRegion);
+      std::vector<Operation *> callGateOps;
+      for (const auto &[index, qubit] : llvm::enumerate(resetOp.getQubits())) {
+        if (!(outcome & (1u << index)))
+          continue;
+        callGateOps.push_back(rewriter.create<CallGateOp>(
+            loc, StringRef("x"), TypeRange{}, ValueRange{qubit}));
+      }
+      rewriter.create<quir::YieldOp>(loc);
+      if (thisPass_.insertQuantumGatesIntoCirc)
+        thisPass_.callGateGroupList.push_back(std::move(callGateOps));
+    }
+    rewriter.restoreInsertionPoint(savedInsertionPoint);
+  }
 }; // BreakResetsPattern
 } // anonymous namespace
 
@@ -152,21 +223,25 @@ void BreakResetPass::runOnOperation() {
   // Disable to improve performance
   config.enableRegionSimplification = false;
 
+  // the flag of the quir.switch holds one bit per qubit
+  uint const maxQubits =
+      vectorize ? std::min<uint>(vectorizeMaxQubits, 31) : 0;
   patterns.add<BreakResetsPattern>(&getContext(), numIterations, delayCycles,
-                                   *this);
+                                   maxQubits, *this);
 
   if (mlir::failed(applyPatternsAndFoldGreedily(getOperation(),
                                                 std::move(patterns), config)))
     signalPassFailure();
 
   if (insertQuantumGatesIntoCirc) {
-    mlir::ModuleOp moduleOp = getOperation();
-    assert(moduleOp && "cannot find module op");
-    mlir::func::FuncOp mainFunc =
-        dyn_cast<mlir::func::FuncOp>(quir::getMainFunction(moduleOp));
-    assert(mainFunc && "could not find the main func");
+    // number the circuits of each module from zero such that their names do
+    // not depend on earlier runs of the pass
+    circuitCounter = 0;
+    xCircuits.clear();
     symbolCache = &getAnalysis<qssc::utils::SymbolCacheAnalysis>()
                        .addToCache<CircuitOp>();
+    mlir::func::FuncOp mainFunc = symbolCache->getMainFunction();
+    assert(mainFunc && "could not find the main func");
 
     // insert measures and call gates into circuits -- when
     // insertCallGatesAndMeasuresIntoCircuit option is true
@@ -180,6 +255,10 @@ void BreakResetPass::runOnOperation() {
       insertCallGateInCircuit(mainFunc, callGateOp);
       callGateList.pop_front();
     }
+    while (!callGateGroupList.empty()) {
+      insertCallGatesInCircuit(mainFunc, callGateGroupList.front());
+      callGateGroupList.pop_front();
+    }
   }
 } // BreakResetPass::runOnOperation
 
@@ -201,6 +280,46 @@ void BreakResetPass::insertCallGateInCircuit(
   callGateOp->erase();
 }
 
+void BreakResetPass::getDependentDialects(
+    mlir::DialectRegistry &registry) const {
+  // the flag of a vectorized reset is packed with arith ops
+  registry.insert<mlir::arith::ArithDialect>();
+}
+
+void BreakResetPass::insertCallGatesInCircuit(
+    mlir::func::FuncOp &mainFunc, llvm::ArrayRef<Operation *> callGateOps) {
+  SmallVector<Value> qubits;
+  for (Operation *callGateOp : callGateOps)
+    qubits.push_back(callGateOp->getOperand(0));
+  Location const loc = callGateOps.front()->getLoc();
+
+  // the circuit flipping n qubits is built once and shared by all cases that
+  // flip n qubits
+  CircuitOp &circOp = xCircuits[qubits.size()];
+  if (!circOp) {
+    mlir::OpBuilder builder(mainFunc);
+    circOp = builder.create<CircuitOp>(
+        loc, getMangledName(),
+        builder.getFunctionType(/*inputs=*/TypeRange(ValueRange(qubits)),
+                                /*results=*/TypeRange{}));
+    Block *body = circOp.addEntryBlock();
+    OpBuilder circuitBuilder = OpBuilder::atBlockBegin(body);
+    for (Value const arg : circOp.getArguments())
+      circuitBuilder.create<CallGateOp>(loc, StringRef("x"), TypeRange{},
+                                        ValueRange{arg});
+    circuitBuilder.create<mlir::quir::ReturnOp>(loc, ValueRange{});
+
+    assert(symbolCache && "symbolCache not set");
+    symbolCache->addCallee(circOp);
+  }
+
+  mlir::OpBuilder builder(callGateOps.front());
+  builder.create<mlir::quir::CallCircuitOp>(loc, circOp.getSymName(),
+                                            TypeRange{}, qubits);
+  for (Operation *callGateOp : callGateOps)
+    callGateOp->erase();
+}
+
 void BreakResetPass::insertMeasureInCircuit(mlir::func::FuncOp &mainFunc,
                                             mlir::quir::MeasureOp measureOp) {
 
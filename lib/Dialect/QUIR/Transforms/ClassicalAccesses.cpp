@@ -0,0 +1,130 @@
+//===- ClassicalAccesses.cpp - Classical state accessed by ops --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements the collection of the classical state accessed by
+/// operations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/ClassicalAccesses.h"
+
+#include "Dialect/OQ3/IR/OQ3Ops.h"
+#include "Dialect/QCS/IR/QCSDialect.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Transforms/Passes.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+bool hasQubits(Operation *op) {
+  auto isQubit = [](Type type) { return type.isa<QubitType>(); };
+  return llvm::any_of(op->getOperandTypes(), isQubit) ||
+         llvm::any_of(op->getResultTypes(), isQubit);
+}
+} // anonymous namespace
+
+bool ClassicalAccesses::writesAny(
+    const llvm::DenseSet<const void *> &keys) const {
+  return llvm::any_of(writes,
+                      [&](const void *key) { return keys.contains(key); });
+}
+
+bool ClassicalAccesses::isIndependentOf(const ClassicalAccesses &other) const {
+  return !writesAny(other.reads) && !writesAny(other.writes) &&
+         !other.writesAny(reads);
+}
+
+void ClassicalAccesses::merge(const ClassicalAccesses &other) {
+  reads.insert(other.reads.begin(), other.reads.end());
+  writes.insert(other.writes.begin(), other.writes.end());
+}
+
+bool mlir::quir::isQuantumOrSystemOp(Operation *op) {
+  if (isa<qcs::ParameterLoadOp>(op))
+    return false;
+  if (auto classicalOnly = op->getAttrOfType<BoolAttr>("quir.classicalOnly"))
+    if (!classicalOnly.getValue())
+      return true;
+  return ClassicalOnlyDetectionPass::isQuantumOp(op) || isQuantumOp(op) ||
+         hasQubits(op) || isa<qcs::QCSDialect>(op->getDialect());
+}
+
+LogicalResult
+mlir::quir::collectClassicalAccesses(Operation *op, bool allowQuantum,
+                                     ClassicalAccesses &accesses) {
+  auto result = op->walk([&](Operation *nestedOp) -> WalkResult {
+    if (isQuantumOrSystemOp(nestedOp))
+      return allowQuantum ? WalkResult::advance() : WalkResult::interrupt();
+
+    if (auto loadOp = dyn_cast<oq3::VariableLoadOp>(nestedOp)) {
+      accesses.reads.insert(loadOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+    if (auto useOp = dyn_cast<oq3::UseArrayElementOp>(nestedOp)) {
+      accesses.reads.insert(useOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+    if (auto assignOp = dyn_cast<oq3::VariableAssignOp>(nestedOp)) {
+      accesses.writes.insert(
+          assignOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+    if (auto assignOp = dyn_cast<oq3::CBitAssignBitOp>(nestedOp)) {
+      accesses.writes.insert(
+          assignOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+    if (auto assignOp = dyn_cast<oq3::AssignArrayElementOp>(nestedOp)) {
+      accesses.writes.insert(
+          assignOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+
+    // the nested ops are visited by the walk
+    if (nestedOp->hasTrait<OpTrait::HasRecursiveMemoryEffects>())
+      return WalkResult::advance();
+
+    auto effectInterface = dyn_cast<MemoryEffectOpInterface>(nestedOp);
+    if (!effectInterface)
+      return WalkResult::interrupt();
+    SmallVector<MemoryEffects::EffectInstance> effects;
+    effectInterface.getEffects(effects);
+    for (auto &effect : effects) {
+      const void *key = effect.getValue()
+                            ? effect.getValue().getAsOpaquePointer()
+                            : effect.getResource();
+      if (isa<MemoryEffects::Read>(effect.getEffect()))
+        accesses.reads.insert(key);
+      else if (isa<MemoryEffects::Write>(effect.getEffect()))
+        accesses.writes.insert(key);
+      // allocations and frees are private to the ops allocating them
+    }
+    return WalkResult::advance();
+  });
+  return failure(result.wasInterrupted());
+}
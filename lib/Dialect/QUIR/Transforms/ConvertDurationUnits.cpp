@@ -29,13 +29,17 @@
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/FunctionInterfaces.h"
 #include "mlir/IR/Location.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Visitors.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
 #include <optional>
@@ -261,6 +265,56 @@ bool checkTypeNeedsConversion(mlir::Type type, TimeUnits targetConvertUnits) {
   return false;
 } // checkTypeNeedsConversion
 
+/// Convert the durations within moduleOperation without a dialect conversion
+/// if every value with a duration type that needs conversion is the result of
+/// a quir.constant and no block argument or function signature carries such a
+/// type. The constants are then rewritten in place and no other operation
+/// needs to change. Returns false if the general conversion is required.
+bool convertConstantDurationsInPlace(Operation *moduleOperation,
+                                     TimeUnits targetConvertUnits,
+                                     double dtTimestep) {
+  auto needsConversion = [&](Type type) {
+    return checkTypeNeedsConversion(type, targetConvertUnits);
+  };
+
+  SmallVector<quir::ConstantOp> constants;
+  auto result = moduleOperation->walk([&](Operation *op) -> WalkResult {
+    if (auto funcLikeOp = dyn_cast<FunctionOpInterface>(op))
+      if (llvm::any_of(funcLikeOp.getArgumentTypes(), needsConversion) ||
+          llvm::any_of(funcLikeOp.getResultTypes(), needsConversion))
+        return WalkResult::interrupt();
+
+    for (auto &region : op->getRegions())
+      for (auto &block : region)
+        if (llvm::any_of(block.getArgumentTypes(), needsConversion))
+          return WalkResult::interrupt();
+
+    if (llvm::none_of(op->getResultTypes(), needsConversion))
+      return WalkResult::advance();
+
+    auto constantOp = dyn_cast<quir::ConstantOp>(op);
+    if (!constantOp || !constantOp.getValue().isa<DurationAttr>())
+      return WalkResult::interrupt();
+    constants.push_back(constantOp);
+    return WalkResult::advance();
+  });
+  if (result.wasInterrupted())
+    return false;
+
+  // delay heavy programs repeat the same few durations
+  DenseMap<Attribute, DurationAttr> convertedDurations;
+  for (auto constantOp : constants) {
+    auto duration = constantOp.getValue().cast<DurationAttr>();
+    auto &newDuration = convertedDurations[duration];
+    if (!newDuration)
+      newDuration =
+          duration.getConvertedDurationAttr(targetConvertUnits, dtTimestep);
+    constantOp.setValueAttr(newDuration);
+    constantOp.getResult().setType(newDuration.getType());
+  }
+  return true;
+} // convertConstantDurationsInPlace
+
 } // anonymous namespace
 
 void ConvertDurationUnitsPass::runOnOperation() {
@@ -271,6 +325,12 @@ void ConvertDurationUnitsPass::runOnOperation() {
 
   double const dtConversion = getDtTimestep();
 
+  // Programs whose durations only flow from constants, including those
+  // already in the target units, do not need any type conversion
+  if (convertConstantDurationsInPlace(moduleOperation, targetConvertUnits,
+                                      dtConversion))
+    return;
+
   auto &context = getContext();
   ConversionTarget target(context);
 
@@ -0,0 +1,128 @@
+//===- DeduplicateCircuits.cpp - Merge identical circuits -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for merging structurally identical circuits
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/DeduplicateCircuits.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Debug.h"
+
+#include <cstddef>
+#include <unordered_map>
+
+#define DEBUG_TYPE "QUIRDeduplicateCircuits"
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+// The attributes of a circuit other than its name, these include the
+// function type and the argument attributes
+DictionaryAttr getAttrsWithoutName(CircuitOp circuitOp) {
+  NamedAttrList attrs(circuitOp->getAttrDictionary());
+  attrs.erase(SymbolTable::getSymbolAttrName());
+  return attrs.getDictionary(circuitOp->getContext());
+}
+
+llvm::hash_code hashCircuit(CircuitOp circuitOp, DictionaryAttr attrs) {
+  llvm::hash_code hash = llvm::hash_value(attrs.getAsOpaquePointer());
+  circuitOp.getBody().walk([&](Operation *op) {
+    hash = llvm::hash_combine(
+        hash, OperationEquivalence::computeHash(
+                  op, /*hashOperands=*/OperationEquivalence::ignoreHashValue,
+                  /*hashResults=*/OperationEquivalence::ignoreHashValue,
+                  OperationEquivalence::IgnoreLocations));
+  });
+  return hash;
+}
+
+bool isEquivalentCircuit(CircuitOp circuitOp, DictionaryAttr attrs,
+                         CircuitOp otherOp, DictionaryAttr otherAttrs) {
+  if (attrs != otherAttrs)
+    return false;
+  return OperationEquivalence::isRegionEquivalentTo(
+      &circuitOp.getBody(), &otherOp.getBody(),
+      OperationEquivalence::IgnoreLocations);
+}
+
+struct UniqueCircuit {
+  CircuitOp circuitOp;
+  DictionaryAttr attrs;
+};
+} // anonymous namespace
+
+void DeduplicateCircuitsPass::runOnOperation() {
+  Operation *moduleOperation = getOperation();
+
+  std::unordered_map<size_t, llvm::SmallVector<UniqueCircuit, 1>> buckets;
+  llvm::DenseMap<StringAttr, FlatSymbolRefAttr> replacements;
+  llvm::SmallVector<Operation *> eraseList;
+
+  moduleOperation->walk([&](CircuitOp circuitOp) {
+    DictionaryAttr const attrs = getAttrsWithoutName(circuitOp);
+    auto &bucket = buckets[hashCircuit(circuitOp, attrs)];
+    for (auto &unique : bucket) {
+      if (!isEquivalentCircuit(unique.circuitOp, unique.attrs, circuitOp,
+                               attrs))
+        continue;
+      LLVM_DEBUG(llvm::dbgs() << "Replacing circuit " << circuitOp.getSymName()
+                              << " with " << unique.circuitOp.getSymName()
+                              << "\n");
+      replacements[circuitOp.getSymNameAttr()] =
+          FlatSymbolRefAttr::get(unique.circuitOp.getSymNameAttr());
+      eraseList.push_back(circuitOp.getOperation());
+      return;
+    }
+    bucket.push_back({circuitOp, attrs});
+  });
+
+  if (replacements.empty())
+    return;
+
+  moduleOperation->walk([&](CallCircuitOp callCircuitOp) {
+    auto search = replacements.find(callCircuitOp.getCalleeAttr().getAttr());
+    if (search != replacements.end())
+      callCircuitOp.setCalleeAttr(search->second);
+  });
+
+  for (auto *op : eraseList)
+    op->erase();
+} // runOnOperation
+
+llvm::StringRef DeduplicateCircuitsPass::getArgument() const {
+  return "deduplicate-circuits";
+}
+llvm::StringRef DeduplicateCircuitsPass::getDescription() const {
+  return "Replace structurally identical circuits with a single circuit";
+}
+
+llvm::StringRef DeduplicateCircuitsPass::getName() const {
+  return "Deduplicate Circuits Pass";
+}
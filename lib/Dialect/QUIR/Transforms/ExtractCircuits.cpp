@@ -273,13 +273,13 @@ void ExtractCircuitsPass::runOnOperation() {
   if (!enableCircuits)
     return;
 
-  Operation *moduleOp = getOperation();
-
+  // number the circuits of each module from zero such that their names do
+  // not depend on earlier runs of the pass
+  circuitCount = 0;
   symbolCache =
       &getAnalysis<qssc::utils::SymbolCacheAnalysis>().addToCache<CircuitOp>();
 
-  mlir::func::FuncOp mainFunc =
-      dyn_cast<mlir::func::FuncOp>(quir::getMainFunction(moduleOp));
+  mlir::func::FuncOp mainFunc = symbolCache->getMainFunction();
   assert(mainFunc && "could not find the main func");
 
   auto const builder = OpBuilder(mainFunc);
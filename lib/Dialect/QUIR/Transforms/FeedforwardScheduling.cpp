@@ -0,0 +1,228 @@
+//===- FeedforwardScheduling.cpp - Shorten feedforward paths ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for moving the classical operations off the
+///  path from a measurement to the branch conditioned on its result.
+///
+///  The operations between the measurement and the branch are classified in
+///  two passes. Walking backward from the branch, an operation stays if it is
+///  quantum, defines a value used by a staying operation or accesses classical
+///  state that a staying operation accesses, such that all others may be
+///  moved after the branch. Walking forward from the measurement, a staying
+///  classical operation depends on the measurement if it uses a value defined
+///  by the measurement or a dependent operation, accesses classical state that
+///  a dependent operation accesses or is quantum itself, such that the others
+///  may be moved before the measurement.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/FeedforwardScheduling.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Transforms/ClassicalAccesses.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+bool isMeasurement(Operation *op) {
+  return isa<MeasureOp, CallCircuitOp>(op) && op->getNumResults() != 0;
+}
+
+// add the values used by op and its nested ops to values
+void addUsedValues(Operation *op, llvm::DenseSet<Value> &values) {
+  op->walk([&](Operation *nestedOp) {
+    values.insert(nestedOp->operand_begin(), nestedOp->operand_end());
+  });
+}
+
+bool usesAny(Operation *op, const llvm::DenseSet<Value> &values) {
+  auto result = op->walk([&](Operation *nestedOp) {
+    if (llvm::any_of(nestedOp->getOperands(),
+                     [&](Value operand) { return values.contains(operand); }))
+      return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
+bool definesAny(Operation *op, const llvm::DenseSet<Value> &values) {
+  return llvm::any_of(op->getResults(),
+                      [&](Value result) { return values.contains(result); });
+}
+
+/// An operation between the measurement and the branch
+struct PathOp {
+  Operation *op;
+  ClassicalAccesses accesses;
+  bool classical;
+  bool staying = false;
+};
+
+/// The feedforward path of a branch op conditioned on a measurement
+class FeedforwardPath {
+public:
+  explicit FeedforwardPath(Operation *branchOp) : branchOp(branchOp) {}
+
+  /// Find the latest measurement in the block of the branch whose results
+  /// the branch depends on, and collect the operations in between. Returns
+  /// false if there is none or the accesses of an operation in between
+  /// cannot be determined.
+  bool find() {
+    llvm::DenseSet<Value> neededValues;
+    addUsedValues(branchOp, neededValues);
+    ClassicalAccesses neededAccesses;
+    if (failed(collectClassicalAccesses(branchOp, /*allowQuantum=*/true,
+                                        neededAccesses)))
+      return false;
+    branchAccesses = neededAccesses;
+
+    for (Operation *op = branchOp->getPrevNode(); op; op = op->getPrevNode()) {
+      PathOp pathOp{op, {}, false};
+      if (failed(collectClassicalAccesses(op, /*allowQuantum=*/true,
+                                          pathOp.accesses)))
+        return false;
+      bool const needed = definesAny(op, neededValues) ||
+                          !pathOp.accesses.isIndependentOf(neededAccesses);
+      if (needed && isMeasurement(op)) {
+        measureOp = op;
+        std::reverse(pathOps.begin(), pathOps.end());
+        return true;
+      }
+      if (needed) {
+        addUsedValues(op, neededValues);
+        neededAccesses.merge(pathOp.accesses);
+      }
+      ClassicalAccesses classicalAccesses;
+      pathOp.classical = succeeded(collectClassicalAccesses(
+          op, /*allowQuantum=*/false, classicalAccesses));
+      pathOps.push_back(std::move(pathOp));
+    }
+    return false;
+  }
+
+  /// Move the operations off the path, returns the number of operations
+  /// moved and sets numRemaining to the number of classical operations left
+  /// between the measurement and the branch
+  uint64_t schedule(uint64_t &numRemaining) {
+    llvm::DenseSet<Value> stayingValues;
+    addUsedValues(branchOp, stayingValues);
+    ClassicalAccesses stayingAccesses = branchAccesses;
+    for (PathOp &pathOp : llvm::reverse(pathOps)) {
+      pathOp.staying = !pathOp.classical ||
+                       definesAny(pathOp.op, stayingValues) ||
+                       !pathOp.accesses.isIndependentOf(stayingAccesses);
+      if (pathOp.staying) {
+        addUsedValues(pathOp.op, stayingValues);
+        stayingAccesses.merge(pathOp.accesses);
+      }
+    }
+
+    llvm::DenseSet<Value> dependentValues(measureOp->result_begin(),
+                                          measureOp->result_end());
+    ClassicalAccesses dependentAccesses;
+    SmallVector<Operation *> earlyOps;
+    SmallVector<Operation *> lateOps;
+    numRemaining = 0;
+    for (PathOp &pathOp : pathOps) {
+      if (!pathOp.staying) {
+        lateOps.push_back(pathOp.op);
+        continue;
+      }
+      bool const dependent =
+          !pathOp.classical || usesAny(pathOp.op, dependentValues) ||
+          !pathOp.accesses.isIndependentOf(dependentAccesses);
+      if (!dependent) {
+        earlyOps.push_back(pathOp.op);
+        continue;
+      }
+      dependentValues.insert(pathOp.op->result_begin(),
+                             pathOp.op->result_end());
+      dependentAccesses.merge(pathOp.accesses);
+      if (pathOp.classical)
+        ++numRemaining;
+    }
+
+    for (Operation *op : earlyOps)
+      op->moveBefore(measureOp);
+    Operation *insertAfter = branchOp;
+    for (Operation *op : lateOps) {
+      op->moveAfter(insertAfter);
+      insertAfter = op;
+    }
+    return earlyOps.size() + lateOps.size();
+  }
+
+private:
+  Operation *branchOp;
+  Operation *measureOp = nullptr;
+  ClassicalAccesses branchAccesses;
+  // the operations between the measurement and the branch, in order
+  SmallVector<PathOp> pathOps;
+};
+
+} // anonymous namespace
+
+void FeedforwardSchedulingPass::runOnOperation() {
+  SmallVector<Operation *> branchOps;
+  getOperation()->walk([&](Operation *op) {
+    if (isa<scf::IfOp, SwitchOp>(op))
+      branchOps.push_back(op);
+  });
+
+  Builder builder(&getContext());
+  for (Operation *branchOp : branchOps) {
+    FeedforwardPath path(branchOp);
+    if (!path.find())
+      continue;
+    uint64_t numRemaining = 0;
+    numMovedOps += path.schedule(numRemaining);
+    numFeedforwardOps += numRemaining;
+    ++numBranches;
+    branchOp->setAttr("quir.feedforwardOps",
+                      builder.getI32IntegerAttr(numRemaining));
+  }
+} // FeedforwardSchedulingPass::runOnOperation
+
+llvm::StringRef FeedforwardSchedulingPass::getArgument() const {
+  return "quir-schedule-feedforward";
+}
+
+llvm::StringRef FeedforwardSchedulingPass::getDescription() const {
+  return "Move the classical operations which a branch conditioned on a "
+         "measurement does not depend on off the path from the measurement "
+         "to the branch, and report the classical operations left on it";
+}
+
+llvm::StringRef FeedforwardSchedulingPass::getName() const {
+  return "Feedforward Scheduling Pass";
+}
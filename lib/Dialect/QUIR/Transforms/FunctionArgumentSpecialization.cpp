@@ -1,6 +1,6 @@
 //===- FunctionArgumentSpecialization.cpp - Resolve funcs --------*- C++-*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,6 +24,7 @@
 
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/Utils/Utils.h"
+#include "Utils/SymbolCacheAnalysis.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Block.h"
@@ -41,12 +42,32 @@
 #include "llvm/Support/Debug.h"
 #include <deque>
 #include <string>
+#include <utility>
 
 #define DEBUG_TYPE "QUIRFunctionArgumentSpecialization"
 
 using namespace mlir;
 using namespace mlir::quir;
 
+namespace {
+bool isSpecializedCall(Operation *op) {
+  return isa<CallGateOp, CallDefCalGateOp, CallDefcalMeasureOp,
+             CallSubroutineOp>(op);
+}
+} // anonymous namespace
+
+void FunctionArgumentSpecializationPass::addCallsToWorkList(
+    mlir::func::FuncOp funcOp, std::deque<Operation *> &callWorkList) {
+  // the calls of a function are visited once, later calls to the function
+  // find them specialized already
+  if (!visitedFuncs.insert(funcOp.getOperation()).second)
+    return;
+  funcOp->walk([&](Operation *op) {
+    if (isSpecializedCall(op))
+      callWorkList.push_back(op);
+  });
+}
+
 template <class CallOpTy>
 void FunctionArgumentSpecializationPass::processCallOp(
     Operation *op, std::deque<Operation *> &callWorkList) {
@@ -55,15 +76,9 @@ void FunctionArgumentSpecializationPass::processCallOp(
     llvm::errs() << "Something really wrong in processCallOp<CalLOpTy>()!\n";
     return;
   }
-  // the following line is crazy but it works
-  Operation *moduleOp =
-      callOp->template getParentOfType<ModuleOp>().getOperation();
   // look for func def match
-  Operation *findOp = SymbolTable::lookupSymbolIn(moduleOp, callOp.getCallee());
-  if (findOp) {
-    mlir::func::FuncOp funcOp = dyn_cast<mlir::func::FuncOp>(findOp);
-    if (!funcOp)
-      return;
+  auto funcOp = symbolCache->lookup<mlir::func::FuncOp>(callOp.getCallee());
+  if (funcOp) {
     // check arguments for width match
     if (!funcOp.getCallableRegion()) {
       // no callable region found (just a prototype)
@@ -72,12 +87,7 @@ void FunctionArgumentSpecializationPass::processCallOp(
       FunctionType funcType = funcOp.getFunctionType();
       if (callType == funcType) {
         // add calls inside this func def to the work list
-        findOp->walk([&](Operation *op) {
-          if (dyn_cast<CallGateOp>(op) || dyn_cast<CallDefCalGateOp>(op) ||
-              dyn_cast<CallDefcalMeasureOp>(op) ||
-              dyn_cast<CallSubroutineOp>(op))
-            callWorkList.push_back(op);
-        });
+        addCallsToWorkList(funcOp, callWorkList);
       } else if (quirFunctionTypeMatch(callType, funcType)) {
         copyFuncAndSpecialize<CallOpTy>(funcOp, callOp, callWorkList);
       } else {
@@ -106,7 +116,20 @@ template <class CallOpTy>
 void FunctionArgumentSpecializationPass::copyFuncAndSpecialize(
     mlir::func::FuncOp inFunc, CallOpTy callOp,
     std::deque<Operation *> &callWorkList) {
-  OpBuilder b(inFunc);
+  auto setCallee = [&](mlir::func::FuncOp specializedFunc) {
+    callOp->setAttr("callee",
+                    FlatSymbolRefAttr::get(specializedFunc.getSymNameAttr()));
+    symbolCache->cacheCall(callOp, specializedFunc);
+  };
+
+  // Check if the function has been specialized for this signature already
+  std::pair<Operation *, Type> const key(inFunc.getOperation(),
+                                         callOp.getCalleeType());
+  auto search = specializations.find(key);
+  if (search != specializations.end()) {
+    setCallee(search->second);
+    return;
+  }
 
   std::string newName = SymbolRefAttr::get(inFunc).getLeafReference().str();
   for (auto callOperand : callOp.getOperands()) {
@@ -115,14 +138,14 @@ void FunctionArgumentSpecializationPass::copyFuncAndSpecialize(
     newName = ss.str();
   }
   // Check if the specialized function aleady exists
-  if (SymbolTable::lookupSymbolIn(inFunc->getParentOp(),
-                                  llvm::StringRef(newName))) {
+  if (auto existingFunc = symbolCache->lookup<mlir::func::FuncOp>(newName)) {
     // function found, nothing to do
-    callOp->setAttr("callee", FlatSymbolRefAttr::get(callOp.getContext(),
-                                                     llvm::StringRef(newName)));
+    specializations[key] = existingFunc;
+    setCallee(existingFunc);
     return;
   }
 
+  OpBuilder b(inFunc);
   mlir::func::FuncOp newFunc = cast<mlir::func::FuncOp>(b.clone(*inFunc));
   newFunc->moveBefore(inFunc);
   newFunc->setAttr(SymbolTable::getSymbolAttrName(),
@@ -135,17 +158,13 @@ void FunctionArgumentSpecializationPass::copyFuncAndSpecialize(
     ++callArgTypeIter;
   }
 
-  callOp->setAttr("callee", FlatSymbolRefAttr::get(callOp.getContext(),
-                                                   llvm::StringRef(newName)));
+  symbolCache->addCallee(newFunc);
+  specializations[key] = newFunc;
+  setCallee(newFunc);
 
   // search for all callOps within the cloned function and add them to the
   // work list
-  newFunc.getOperation()->walk([&](Operation *op) {
-    if (dyn_cast<CallGateOp>(op) || dyn_cast<CallDefCalGateOp>(op) ||
-        dyn_cast<CallDefcalMeasureOp>(op) || dyn_cast<CallSubroutineOp>(op)) {
-      callWorkList.push_back(op);
-    }
-  });
+  addCallsToWorkList(newFunc, callWorkList);
 } // copyFuncAndSpecialize
 
 // Entry point for the pass.
@@ -161,11 +180,12 @@ void FunctionArgumentSpecializationPass::runOnOperation() {
     return;
   }
 
-  mainFunc->walk([&](Operation *op) {
-    if (dyn_cast<CallGateOp>(op) || dyn_cast<CallDefCalGateOp>(op) ||
-        dyn_cast<CallDefcalMeasureOp>(op) || dyn_cast<CallSubroutineOp>(op))
-      callWorkList.push_back(op);
-  });
+  symbolCache = &getAnalysis<qssc::utils::SymbolCacheAnalysis>()
+                     .addToCache<mlir::func::FuncOp>();
+  specializations.clear();
+  visitedFuncs.clear();
+
+  addCallsToWorkList(cast<mlir::func::FuncOp>(mainFunc), callWorkList);
 
   while (!callWorkList.empty()) {
     Operation *op = callWorkList.front();
@@ -0,0 +1,255 @@
+//===- GateCancellation.cpp - Cancel and fuse gates -------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for cancelling inverse pairs of gates and
+///  fusing consecutive single qubit gates
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/GateCancellation.h"
+
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <optional>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+// the tolerance below which matrix elements are considered zero
+constexpr double tolerance = 1e-12;
+
+// a single qubit unitary, row major
+using Matrix = std::array<std::complex<double>, 4>;
+using UAngles = std::array<double, 3>;
+
+std::optional<UAngles> getConstantAngles(Builtin_UOp uOp) {
+  std::array<Value, 3> const operands{uOp.getTheta(), uOp.getPhi(),
+                                      uOp.getLambda()};
+  UAngles angles;
+  for (size_t index = 0; index < operands.size(); ++index) {
+    auto constantOp = operands[index].getDefiningOp<quir::ConstantOp>();
+    if (!constantOp || !constantOp.getValue().isa<AngleAttr>())
+      return std::nullopt;
+    angles[index] = constantOp.getAngleValueFromConstant().convertToDouble();
+  }
+  return angles;
+}
+
+// U(theta, phi, lambda) = Rz(phi) Ry(theta) Rz(lambda) up to a global phase
+Matrix getUMatrix(const UAngles &angles) {
+  auto [theta, phi, lambda] = angles;
+  double const c = std::cos(theta / 2);
+  double const s = std::sin(theta / 2);
+  return {c, -std::polar(s, lambda), std::polar(s, phi),
+          std::polar(c, phi + lambda)};
+}
+
+Matrix multiply(const Matrix &a, const Matrix &b) {
+  return {a[0] * b[0] + a[1] * b[2], a[0] * b[1] + a[1] * b[3],
+          a[2] * b[0] + a[3] * b[2], a[2] * b[1] + a[3] * b[3]};
+}
+
+double wrapAngle(double angle) {
+  return std::remainder(angle, 2 * llvm::numbers::pi);
+}
+
+// the angles of the U gate implementing m up to a global phase
+UAngles getUAngles(const Matrix &m) {
+  double const theta = 2 * std::atan2(std::abs(m[2]), std::abs(m[0]));
+  // only the sum (difference) of phi and lambda is defined for diagonal
+  // (anti-diagonal) unitaries
+  if (std::abs(m[2]) < tolerance)
+    return {theta, wrapAngle(std::arg(m[3]) - std::arg(m[0])), 0.};
+  if (std::abs(m[0]) < tolerance)
+    return {theta, wrapAngle(std::arg(m[2]) - std::arg(-m[1])), 0.};
+  double const phase = std::arg(m[0]);
+  return {theta, wrapAngle(std::arg(m[2]) - phase),
+          wrapAngle(std::arg(-m[1]) - phase)};
+}
+
+bool isIdentity(const Matrix &m) {
+  return std::abs(m[1]) < tolerance && std::abs(m[2]) < tolerance &&
+         std::abs(m[3] / m[0] - 1.) < tolerance;
+}
+
+// whether an operation between first and last may act on qubits without
+// reporting them through QubitOpInterface, e.g., a subroutine call, such
+// that it is missing from the qubit chains
+bool hasUntrackedQubitOps(Operation *first, Operation *last) {
+  for (Operation *op = first->getNextNode(); op && op != last;
+       op = op->getNextNode()) {
+    auto result = op->walk<WalkOrder::PreOrder>([](Operation *nestedOp) {
+      if (isa<QubitOpInterface>(nestedOp))
+        return WalkResult::skip();
+      if (llvm::any_of(nestedOp->getOperandTypes(),
+                       [](Type type) { return type.isa<QubitType>(); }))
+        return WalkResult::interrupt();
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      return true;
+  }
+  return false;
+}
+
+// This pattern erases a quir.builtin_CX and the next operation on its qubits
+// if that is a quir.builtin_CX on the same control and target
+struct CancelCXPattern : public OpRewritePattern<BuiltinCXOp> {
+  CancelCXPattern(MLIRContext *ctx, QubitDependencyAnalysis &deps,
+                  Pass::Statistic &numCancelledGates)
+      : OpRewritePattern<BuiltinCXOp>(ctx), deps(deps),
+        numCancelledGates(numCancelledGates) {}
+
+  LogicalResult matchAndRewrite(BuiltinCXOp cxOp,
+                                PatternRewriter &rewriter) const override {
+    auto control = lookupQubitId(cxOp.getControl());
+    auto target = lookupQubitId(cxOp.getTarget());
+    if (!control || !target)
+      return failure();
+
+    // the operations in between act on other qubits and commute with both
+    auto nextCXOp =
+        dyn_cast_or_null<BuiltinCXOp>(deps.getNextQubitUser(cxOp, *control));
+    if (!nextCXOp || deps.getNextQubitUser(cxOp, *target) != nextCXOp)
+      return failure();
+    if (lookupQubitId(nextCXOp.getControl()) != control ||
+        lookupQubitId(nextCXOp.getTarget()) != target ||
+        hasUntrackedQubitOps(cxOp, nextCXOp))
+      return failure();
+
+    rewriter.eraseOp(nextCXOp);
+    rewriter.eraseOp(cxOp);
+    numCancelledGates += 2;
+    return success();
+  } // matchAndRewrite
+
+private:
+  QubitDependencyAnalysis &deps;
+  Pass::Statistic &numCancelledGates;
+}; // struct CancelCXPattern
+
+// This pattern fuses a quir.builtin_U into the next operation on its qubit
+// if that is a quir.builtin_U as well and the angles of both are constant
+struct FuseUPattern : public OpRewritePattern<Builtin_UOp> {
+  FuseUPattern(MLIRContext *ctx, QubitDependencyAnalysis &deps,
+               Pass::Statistic &numCancelledGates,
+               Pass::Statistic &numFusedGates)
+      : OpRewritePattern<Builtin_UOp>(ctx), deps(deps),
+        numCancelledGates(numCancelledGates), numFusedGates(numFusedGates) {}
+
+  LogicalResult matchAndRewrite(Builtin_UOp uOp,
+                                PatternRewriter &rewriter) const override {
+    auto qubit = lookupQubitId(uOp.getTarget());
+    if (!qubit)
+      return failure();
+    auto nextUOp =
+        dyn_cast_or_null<Builtin_UOp>(deps.getNextQubitUser(uOp, *qubit));
+    if (!nextUOp || hasUntrackedQubitOps(uOp, nextUOp))
+      return failure();
+    auto angles = getConstantAngles(uOp);
+    auto nextAngles = getConstantAngles(nextUOp);
+    if (!angles || !nextAngles)
+      return failure();
+
+    Matrix const product =
+        multiply(getUMatrix(*nextAngles), getUMatrix(*angles));
+    if (isIdentity(product)) {
+      rewriter.eraseOp(nextUOp);
+      rewriter.eraseOp(uOp);
+      numCancelledGates += 2;
+      return success();
+    }
+
+    // the fused gate keeps the angle types of the next gate
+    rewriter.setInsertionPoint(nextUOp);
+    auto createAngle = [&](double value, Value like) -> Value {
+      auto angleType = like.getType().cast<AngleType>();
+      return rewriter.create<quir::ConstantOp>(
+          nextUOp.getLoc(), angleType,
+          AngleAttr::get(rewriter.getContext(), angleType,
+                         llvm::APFloat(value)));
+    };
+    auto [theta, phi, lambda] = getUAngles(product);
+    rewriter.replaceOpWithNewOp<Builtin_UOp>(
+        nextUOp, nextUOp.getTarget(), createAngle(theta, nextUOp.getTheta()),
+        createAngle(phi, nextUOp.getPhi()),
+        createAngle(lambda, nextUOp.getLambda()));
+    rewriter.eraseOp(uOp);
+    ++numFusedGates;
+    return success();
+  } // matchAndRewrite
+
+private:
+  QubitDependencyAnalysis &deps;
+  Pass::Statistic &numCancelledGates;
+  Pass::Statistic &numFusedGates;
+}; // struct FuseUPattern
+
+} // anonymous namespace
+
+void GateCancellationPass::runOnOperation() {
+  auto &deps = getAnalysis<QubitDependencyAnalysis>();
+
+  RewritePatternSet patterns(&getContext());
+  patterns.add<CancelCXPattern>(&getContext(), deps, numCancelledGates);
+  patterns.add<FuseUPattern>(&getContext(), deps, numCancelledGates,
+                             numFusedGates);
+
+  mlir::GreedyRewriteConfig config;
+  // Disable to improve performance
+  config.enableRegionSimplification = false;
+  config.listener = &deps;
+
+  if (failed(applyPatternsAndFoldGreedily(getOperation(), std::move(patterns),
+                                          config)))
+    signalPassFailure();
+} // runOnOperation
+
+llvm::StringRef GateCancellationPass::getArgument() const {
+  return "quir-cancel-gates";
+}
+
+llvm::StringRef GateCancellationPass::getDescription() const {
+  return "Cancel inverse pairs of CX gates and fuse consecutive U gates on "
+         "each qubit, commuting through the operations on other qubits";
+}
+
+llvm::StringRef GateCancellationPass::getName() const {
+  return "Gate Cancellation Pass";
+}
@@ -0,0 +1,267 @@
+//===- IRStatistics.cpp - Count the size of the IR --------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for counting the size of the IR at a point
+///  of the pipeline.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/IRStatistics.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+#include "Utils/CounterSink.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/BuiltinAttributeInterfaces.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/IR/FunctionInterfaces.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/Region.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+// the bytes of the data of the attribute, this is the size of the samples
+// of waveforms
+int64_t getElementsBytes(ElementsAttr attr) {
+  if (auto dense = dyn_cast<DenseElementsAttr>(attr))
+    return static_cast<int64_t>(dense.getRawData().size());
+  if (auto resource = dyn_cast<DenseResourceElementsAttr>(attr))
+    if (AsmResourceBlob *blob = resource.getRawHandle().getBlob())
+      return static_cast<int64_t>(blob->getData().size());
+  return 0;
+}
+
+int64_t saturatingAdd(int64_t lhs, int64_t rhs) {
+  int64_t result = 0;
+  if (llvm::AddOverflow(lhs, rhs, result))
+    return std::numeric_limits<int64_t>::max();
+  return result;
+}
+
+int64_t saturatingMul(int64_t lhs, int64_t rhs) {
+  int64_t result = 0;
+  if (llvm::MulOverflow(lhs, rhs, result))
+    return std::numeric_limits<int64_t>::max();
+  return result;
+}
+
+// the unrolled size of a function without its callees, and the subroutines
+// it calls with the number of calls once unrolled
+struct FunctionCounts {
+  int64_t ops = 0;
+  int64_t quantumOps = 0;
+  llvm::SmallVector<std::pair<llvm::StringRef, int64_t>> calls;
+
+  // the counts with the callees expanded, once computed
+  enum class State { Pending, Expanding, Expanded } state = State::Pending;
+  int64_t expandedOps = 0;
+  int64_t expandedQuantumOps = 0;
+  int64_t expandedCalls = 0;
+};
+
+class IRResourceCounter {
+public:
+  IRResourceCounter(IRResourceCounts &counts,
+                    llvm::MapVector<OperationName, int64_t> *opCounts)
+      : counts(counts), opCounts(opCounts) {}
+
+  void count(Operation *op) {
+    FunctionCounts topLevel;
+    count(op, /*multiplier=*/1, topLevel);
+
+    // the functions which are not called are the roots of the expansion
+    counts.unrolledOps = topLevel.ops;
+    counts.unrolledQuantumOps = topLevel.quantumOps;
+    for (auto &entry : functions) {
+      if (fanOut.count(entry.getKey()))
+        continue;
+      FunctionCounts &function = entry.getValue();
+      expand(function);
+      counts.unrolledOps =
+          saturatingAdd(counts.unrolledOps, function.expandedOps);
+      counts.unrolledQuantumOps =
+          saturatingAdd(counts.unrolledQuantumOps, function.expandedQuantumOps);
+      counts.unrolledSubroutineCalls =
+          saturatingAdd(counts.unrolledSubroutineCalls, function.expandedCalls);
+    }
+    for (const auto &entry : fanOut)
+      counts.maxSubroutineFanOut =
+          std::max(counts.maxSubroutineFanOut, entry.getValue());
+  }
+
+private:
+  void count(Operation *op, int64_t multiplier, FunctionCounts &function) {
+    ++counts.ops;
+    if (opCounts)
+      ++(*opCounts)[op->getName()];
+    counts.regions += op->getNumRegions();
+    for (Region &region : op->getRegions())
+      counts.blocks += static_cast<int64_t>(region.getBlocks().size());
+    if (isa<SymbolOpInterface>(op))
+      ++counts.symbols;
+    if (isa<DeclareQubitOp>(op))
+      ++counts.qubits;
+    op->getAttrDictionary().walk([&](ElementsAttr attr) {
+      if (elementsAttrs.insert(attr).second)
+        counts.elementsBytes += getElementsBytes(attr);
+    });
+
+    // the operations nested in a function are counted for the function
+    FunctionCounts *counted = &function;
+    if (isa<FunctionOpInterface>(op)) {
+      counted = &functions[SymbolTable::getSymbolName(op).getValue()];
+      multiplier = 1;
+    }
+    counted->ops = saturatingAdd(counted->ops, multiplier);
+    if (auto callOp = dyn_cast<CallSubroutineOp>(op)) {
+      counted->calls.emplace_back(callOp.getCallee(), multiplier);
+      int64_t &calls = fanOut[callOp.getCallee()];
+      calls = saturatingAdd(calls, multiplier);
+    } else if (llvm::any_of(op->getOperandTypes(),
+                            [](Type type) { return type.isa<QubitType>(); })) {
+      counted->quantumOps = saturatingAdd(counted->quantumOps, multiplier);
+    }
+
+    // the body of a loop is repeated for each of its iterations
+    if (auto forOp = dyn_cast<scf::ForOp>(op))
+      if (auto tripCount = getConstantTripCount(forOp))
+        multiplier = saturatingMul(
+            multiplier,
+            static_cast<int64_t>(std::min<uint64_t>(
+                *tripCount, std::numeric_limits<int64_t>::max())));
+    for (Region &region : op->getRegions())
+      for (Block &block : region)
+        for (Operation &nestedOp : block)
+          count(&nestedOp, multiplier, *counted);
+  }
+
+  void expand(FunctionCounts &function) {
+    if (function.state != FunctionCounts::State::Pending)
+      return;
+    function.state = FunctionCounts::State::Expanding;
+    function.expandedOps = function.ops;
+    function.expandedQuantumOps = function.quantumOps;
+    for (auto &[callee, calls] : function.calls) {
+      function.expandedCalls = saturatingAdd(function.expandedCalls, calls);
+      auto it = functions.find(callee);
+      // external and recursive callees are counted as calls only
+      if (it == functions.end() ||
+          it->second.state == FunctionCounts::State::Expanding)
+        continue;
+      expand(it->second);
+      function.expandedOps = saturatingAdd(
+          function.expandedOps, saturatingMul(calls, it->second.expandedOps));
+      function.expandedQuantumOps = saturatingAdd(
+          function.expandedQuantumOps,
+          saturatingMul(calls, it->second.expandedQuantumOps));
+      function.expandedCalls =
+          saturatingAdd(function.expandedCalls,
+                        saturatingMul(calls, it->second.expandedCalls));
+    }
+    function.state = FunctionCounts::State::Expanded;
+  }
+
+  IRResourceCounts &counts;
+  llvm::MapVector<OperationName, int64_t> *opCounts;
+  // attributes are uniqued, the data of one used many times is held once
+  llvm::DenseSet<Attribute> elementsAttrs;
+  // the functions by name, each counted once
+  llvm::StringMap<FunctionCounts> functions;
+  // the calls of each subroutine, counting loop iterations
+  llvm::StringMap<int64_t> fanOut;
+};
+} // anonymous namespace
+
+IRResourceCounts mlir::quir::countIRResources(
+    Operation *op, llvm::MapVector<OperationName, int64_t> *opCounts) {
+  IRResourceCounts counts;
+  IRResourceCounter(counts, opCounts).count(op);
+  return counts;
+}
+
+void IRStatisticsPass::runOnOperation() {
+  // in the order of the first op of each name, such that the output is
+  // deterministic
+  llvm::MapVector<OperationName, int64_t> opCounts;
+  IRResourceCounts const counts = countIRResources(getOperation(), &opCounts);
+
+  numOps += counts.ops;
+  numRegions += counts.regions;
+  numBlocks += counts.blocks;
+  numSymbols += counts.symbols;
+  numElementsBytes += counts.elementsBytes;
+  numQubits += counts.qubits;
+  numUnrolledOps += counts.unrolledOps;
+  numUnrolledQuantumOps += counts.unrolledQuantumOps;
+  numUnrolledSubroutineCalls += counts.unrolledSubroutineCalls;
+  maxSubroutineFanOut.updateMax(counts.maxSubroutineFanOut);
+
+  if (auto *sink = qssc::utils::getContextCounterSink(&getContext())) {
+    std::pair<llvm::StringRef, int64_t> const counters[] = {
+        {"ops", counts.ops},
+        {"regions", counts.regions},
+        {"blocks", counts.blocks},
+        {"symbols", counts.symbols},
+        {"elements-bytes", counts.elementsBytes},
+        {"qubits", counts.qubits},
+        {"unrolled-ops", counts.unrolledOps},
+        {"unrolled-quantum-ops", counts.unrolledQuantumOps},
+        {"unrolled-subroutine-calls", counts.unrolledSubroutineCalls},
+        {"max-subroutine-fan-out", counts.maxSubroutineFanOut}};
+    sink->recordCounters(label, counters);
+
+    llvm::SmallVector<std::pair<llvm::StringRef, int64_t>> opCounters;
+    for (const auto &[name, count] : opCounts)
+      opCounters.emplace_back(name.getStringRef(), count);
+    sink->recordCounters(label + " ops", opCounters);
+  }
+
+  markAllAnalysesPreserved();
+} // runOnOperation
+
+llvm::StringRef IRStatisticsPass::getArgument() const {
+  return "ir-statistics";
+}
+
+llvm::StringRef IRStatisticsPass::getDescription() const {
+  return "Count the operations, regions, blocks, symbols and elements "
+         "attribute bytes of the IR";
+}
+
+llvm::StringRef IRStatisticsPass::getName() const {
+  return "IR Statistics Pass";
+}
@@ -1,6 +1,6 @@
 //===- LoadElimination.cpp - Remove unnecessary loads -----------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -16,24 +16,171 @@
 ///
 ///  This file implements the pass for replacing unnecessary variable loads.
 ///
+///  Variables with a single assignment have the assigned value forwarded to
+///  all loads it dominates. All other loads are forwarded by a dataflow over
+///  the structured control flow of each function, which tracks the known
+///  value of every variable in a dense lattice indexed by variable: the
+///  states of the branches of an scf.if are merged at its end, while loops
+///  and other region ops lose the values of the variables they write.
+///
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/QUIR/Transforms/LoadElimination.h"
 
 #include "Dialect/OQ3/IR/OQ3Ops.h"
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
 
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Dominance.h"
+#include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/Region.h"
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/Visitors.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 
 #include <algorithm>
+#include <optional>
 
 namespace mlir::quir {
 
+namespace {
+
+// The known value of each tracked variable at a program point, indexed by
+// the dense ID of the variable. A null value is unknown.
+using VariableState = SmallVector<Value>;
+
+class StoreToLoadForwarding {
+public:
+  StoreToLoadForwarding(Operation *op, SmallVectorImpl<Operation *> &toErase)
+      : varUsesToErase(toErase) {
+    // input variables are patched at runtime through their single
+    // assignment, so only the other variables are tracked
+    op->walk([&](mlir::oq3::DeclareVariableOp decl) {
+      if (!decl.isInputVariable())
+        variableIds.try_emplace(decl.getSymName(), variableIds.size());
+    });
+  }
+
+  void forwardLoads(mlir::func::FuncOp funcOp) {
+    if (variableIds.empty())
+      return;
+    for (auto &block : funcOp.getBody()) {
+      VariableState state(variableIds.size());
+      processBlock(block, state);
+    }
+  }
+
+private:
+  std::optional<unsigned> getVariableId(Operation *op) const {
+    auto nameAttr = op->getAttrOfType<FlatSymbolRefAttr>("variable_name");
+    if (!nameAttr)
+      return std::nullopt;
+    auto it = variableIds.find(nameAttr.getValue());
+    if (it == variableIds.end())
+      return std::nullopt;
+    return it->second;
+  }
+
+  // whether op may assign the variables of other functions, i.e., any
+  // variable. Gates and circuits are purely quantum.
+  static bool mayAssignAnyVariable(Operation *op) {
+    return isa<CallOpInterface>(op) &&
+           !isa<mlir::quir::CallCircuitOp, mlir::quir::CallGateOp>(op);
+  }
+
+  // forget the values of the variables that op or its nested ops may assign
+  void killAssigned(Operation *op, VariableState &state) const {
+    op->walk([&](Operation *nestedOp) {
+      if (mayAssignAnyVariable(nestedOp)) {
+        std::fill(state.begin(), state.end(), Value());
+        return WalkResult::interrupt();
+      }
+      if (auto id = getVariableId(nestedOp);
+          id && !isa<mlir::oq3::VariableLoadOp>(nestedOp))
+        state[*id] = Value();
+      return WalkResult::advance();
+    });
+  }
+
+  void processBlock(Block &block, VariableState &state) {
+    for (auto &op : llvm::make_early_inc_range(block))
+      processOp(&op, state);
+  }
+
+  void processOp(Operation *op, VariableState &state) {
+    if (auto assignOp = dyn_cast<mlir::oq3::VariableAssignOp>(op)) {
+      if (auto id = getVariableId(op))
+        state[*id] = assignOp.getAssignedValue();
+      return;
+    }
+
+    if (auto loadOp = dyn_cast<mlir::oq3::VariableLoadOp>(op)) {
+      auto id = getVariableId(op);
+      if (!id)
+        return;
+      Value const known = state[*id];
+      if (known && known.getType() == loadOp.getType()) {
+        loadOp.replaceAllUsesWith(known);
+        varUsesToErase.push_back(loadOp);
+        return;
+      }
+      // later loads read the same value until the next assignment
+      state[*id] = loadOp.getResult();
+      return;
+    }
+
+    if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
+      VariableState thenState = state;
+      processBlock(ifOp.getThenRegion().front(), thenState);
+      if (!ifOp.getElseRegion().empty())
+        processBlock(ifOp.getElseRegion().front(), state);
+      // only the values known identically on both paths survive, which
+      // are all defined before the scf.if
+      for (auto [value, thenValue] : llvm::zip(state, thenState))
+        if (value != thenValue)
+          value = Value();
+      return;
+    }
+
+    if (mayAssignAnyVariable(op)) {
+      std::fill(state.begin(), state.end(), Value());
+      return;
+    }
+
+    if (op->getNumRegions() == 0) {
+      if (auto id = getVariableId(op))
+        state[*id] = Value();
+      return;
+    }
+
+    // Loops and other region ops may run their regions any number of times
+    // and in any order: each block starts from the values that no execution
+    // of the op changes.
+    killAssigned(op, state);
+    bool const isolated = op->hasTrait<OpTrait::IsIsolatedFromAbove>();
+    for (auto &region : op->getRegions()) {
+      for (auto &block : region) {
+        VariableState blockState =
+            isolated ? VariableState(state.size()) : state;
+        processBlock(block, blockState);
+      }
+    }
+  }
+
+  llvm::StringMap<unsigned> variableIds;
+  SmallVectorImpl<Operation *> &varUsesToErase;
+};
+
+} // anonymous namespace
+
 void LoadEliminationPass::runOnOperation() {
   // Eliminate simple cases where variables are assigned only once. That is,
   // they are effectively constants. (to be extended considerably as part of
@@ -114,6 +261,14 @@ void LoadEliminationPass::runOnOperation() {
     return WalkResult::advance();
   });
 
+  for (auto *op : varUsesToErase)
+    op->erase();
+  varUsesToErase.clear();
+
+  // Forward the remaining loads along the structured control flow
+  StoreToLoadForwarding forwarding(op, varUsesToErase);
+  op->walk([&](mlir::func::FuncOp funcOp) { forwarding.forwardLoads(funcOp); });
+
   for (auto *op : varUsesToErase)
     op->erase();
 }
@@ -124,7 +279,8 @@ llvm::StringRef LoadEliminationPass::getArgument() const {
 
 llvm::StringRef LoadEliminationPass::getDescription() const {
   return "Eliminate variable loads by forwarding the operands of assignments "
-         "to a variable to subsequent uses of the variable.";
+         "to a variable to subsequent uses of the variable, across structured "
+         "control flow.";
 }
 
 llvm::StringRef LoadEliminationPass::getName() const {
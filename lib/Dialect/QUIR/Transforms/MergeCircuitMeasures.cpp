@@ -24,6 +24,9 @@
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Transforms/BranchHoisting.h"
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 #include "Utils/SymbolCacheAnalysis.h"
 
@@ -45,11 +48,8 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
-#include <algorithm>
 #include <cassert>
 #include <cstdint>
-#include <iterator>
-#include <set>
 #include <string>
 #include <sys/types.h>
 #include <unordered_map>
@@ -319,7 +319,7 @@ struct CallCircuitAndCallCircuitTopologicalPattern
     auto firstCircuit = _symbolCache->getOp<CircuitOp>(callCircuitOp);
 
     MeasureOp firstMeasureOp;
-    std::set<uint32_t> currMeasureQubits;
+    QubitSet currMeasureQubits;
 
     auto *firstOp = &firstCircuit.getBody().front().front();
 
@@ -358,8 +358,7 @@ struct CallCircuitAndCallCircuitTopologicalPattern
       auto [nextMeasureOpt, additionalObservedQubits] =
           QubitOpInterface::getNextQubitOpOfTypeWithQubits<MeasureOp>(firstOp);
 
-      observedQubits.insert(additionalObservedQubits.begin(),
-                            additionalObservedQubits.end());
+      observedQubits |= additionalObservedQubits;
       if (!nextMeasureOpt.has_value())
         return failure();
       nextMeasureOp = nextMeasureOpt.value();
@@ -367,20 +366,14 @@ struct CallCircuitAndCallCircuitTopologicalPattern
 
     // If any qubit along path touches the same qubits we cannot merge the next
     // measurement.
-    currMeasureQubits.insert(observedQubits.begin(), observedQubits.end());
+    currMeasureQubits |= observedQubits;
 
     // found a measure and a measure, now make sure they aren't working on the
     // same qubit and that we can resolve them both
     auto nextMeasureQubits = nextMeasureOp.getOperatedQubits();
 
     // If there is an intersection we cannot merge
-    std::set<int> mergeMeasureIntersection;
-    std::set_intersection(currMeasureQubits.begin(), currMeasureQubits.end(),
-                          nextMeasureQubits.begin(), nextMeasureQubits.end(),
-                          std::inserter(mergeMeasureIntersection,
-                                        mergeMeasureIntersection.begin()));
-
-    if (!mergeMeasureIntersection.empty())
+    if (currMeasureQubits.overlaps(nextMeasureQubits))
       return failure();
 
     // good to merge
@@ -399,6 +392,11 @@ void MergeCircuitMeasuresTopologicalPass::runOnOperation() {
   auto &symbolCache =
       getAnalysis<qssc::utils::SymbolCacheAnalysis>().addToCache<CircuitOp>();
 
+  if (hoistFromBranches)
+    hoistCommonBranchOps(moduleOperation,
+                         getAnalysis<QubitDependencyAnalysis>(),
+                         [](Operation *op) { return isa<CallCircuitOp>(op); });
+
   RewritePatternSet patterns(&getContext());
   patterns.add<CallCircuitAndCallCircuitTopologicalPattern>(&getContext(),
                                                             symbolCache);
@@ -1,6 +1,6 @@
 //===- MergeCircuits.cpp - Merge call_circuit ops ---------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -25,7 +25,9 @@
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 #include "Dialect/QUIR/Utils/Utils.h"
+#include "Utils/CompileBudget.h"
 #include "Utils/SymbolCacheAnalysis.h"
 
 #include "mlir/IR/Attributes.h"
@@ -45,6 +47,7 @@
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/CommandLine.h"
@@ -52,7 +55,6 @@
 #include <algorithm>
 #include <cassert>
 #include <optional>
-#include <set>
 #include <string>
 #include <sys/types.h>
 #include <unordered_map>
@@ -68,7 +70,8 @@ llvm::cl::list<std::string>
 
 namespace {
 
-using MoveListVec = std::vector<Operation *>;
+// the ops moved by a single pattern application, which are few
+using MoveListVec = llvm::SmallVector<Operation *, 8>;
 bool moveUsers(Operation *curOp, MoveListVec &moveList) {
   moveList.push_back(curOp);
   for (auto *user : curOp->getUsers())
@@ -106,9 +109,9 @@ struct CircuitAndCircuitPattern : public OpRewritePattern<CallCircuitOp> {
       // check for overlap in qubits between the circuit and the
       // next quantum circuit which is not a CallCircuit
       // fail if there is overlap
-      std::set<uint> firstQubits =
+      QubitSet const firstQubits =
           QubitOpInterface::getOperatedQubits(callCircuitOp);
-      std::set<uint> secondQubits =
+      QubitSet const secondQubits =
           QubitOpInterface::getOperatedQubits(*secondOp);
 
       if (QubitOpInterface::qubitSetsOverlap(firstQubits, secondQubits))
@@ -195,8 +198,8 @@ std::optional<SecondOp> getNextOpAndCompareOverlap(FirstOp firstOp) {
     return std::nullopt;
 
   // Check for overlap between currQubits and what's operated on by nextOp
-  std::set<uint> firstQubits = QubitOpInterface::getOperatedQubits(firstOp);
-  std::set<uint> secondQubits =
+  QubitSet const firstQubits = QubitOpInterface::getOperatedQubits(firstOp);
+  QubitSet const secondQubits =
       QubitOpInterface::getOperatedQubits(secondOpByClass);
 
   if (QubitOpInterface::qubitSetsOverlap(firstQubits, secondQubits))
@@ -366,7 +369,7 @@ void mapBarrierOperands(
 }
 
 void mergePhysicalIdAttrs(CircuitOp newCircuitOp, CircuitOp nextCircuitOp,
-                          PatternRewriter &rewriter) {
+                          RewriterBase &rewriter) {
   // merge the physical ID attributes
   auto theseIdsAttr = newCircuitOp->getAttrOfType<ArrayAttr>(
       mlir::quir::getPhysicalIdsAttrName());
@@ -399,14 +402,25 @@ quir::ReturnOp getReturnOp(Operation *op) {
   return returnOp;
 }
 
-LogicalResult MergeCircuitsPass::mergeCallCircuits(
-    MLIRContext *context, PatternRewriter &rewriter,
-    CallCircuitOp callCircuitOp, CallCircuitOp nextCallCircuitOp,
-    qssc::utils::SymbolCacheAnalysis *symbolCache,
-    std::optional<llvm::SmallVector<Operation *>> barrierOps) {
-  auto circuitOp = symbolCache->getOp<CircuitOp>(callCircuitOp);
-  auto nextCircuitOp = symbolCache->getOp<CircuitOp>(nextCallCircuitOp);
-  rewriter.setInsertionPointAfter(nextCircuitOp);
+namespace {
+// Merge a run of call_circuits into a single call of a new circuit which
+// holds the bodies of all of their circuits in order. The barriers in
+// barrierOps[i] are moved into the new circuit in front of the body of the
+// circuit of calls[i].
+CallCircuitOp
+mergeCallCircuitRun(MLIRContext *context, RewriterBase &rewriter,
+                    ArrayRef<CallCircuitOp> calls,
+                    ArrayRef<llvm::SmallVector<Operation *>> barrierOps,
+                    qssc::utils::SymbolCacheAnalysis *symbolCache) {
+  assert(calls.size() > 1 && "a run requires at least two call_circuits");
+  assert(barrierOps.size() == calls.size() &&
+         "barrierOps requires an entry per call_circuit");
+
+  llvm::SmallVector<CircuitOp> circuitOps;
+  circuitOps.reserve(calls.size());
+  for (auto callOp : calls)
+    circuitOps.push_back(symbolCache->getOp<CircuitOp>(callOp));
+  rewriter.setInsertionPointAfter(circuitOps.back());
 
   llvm::SmallVector<Type> outputTypes;
   llvm::SmallVector<Value> outputValues;
@@ -415,52 +429,53 @@ LogicalResult MergeCircuitsPass::mergeCallCircuits(
   // collect their input values
   llvm::SmallVector<Value> callInputValues;
   std::unordered_map<Operation *, uint> inputValueIndices;
-  for (auto inputValueEnum : llvm::enumerate(callCircuitOp->getOperands())) {
+  for (auto inputValueEnum : llvm::enumerate(calls.front()->getOperands())) {
     auto *defOp = inputValueEnum.value().getDefiningOp();
     callInputValues.push_back(inputValueEnum.value());
     inputValueIndices[defOp] = inputValueEnum.index();
   }
 
   // merge circuit names
-  std::string const newName =
-      (circuitOp.getSymName() + "_" + nextCircuitOp.getSymName()).str();
+  std::string newName = circuitOps.front().getSymName().str();
+  for (auto circuitOp : llvm::drop_begin(circuitOps))
+    newName += ("_" + circuitOp.getSymName()).str();
 
   // create new circuit operation by cloning first circuit
-  CircuitOp newCircuitOp = cast<CircuitOp>(rewriter.clone(*circuitOp));
+  CircuitOp newCircuitOp = cast<CircuitOp>(rewriter.clone(*circuitOps.front()));
   newCircuitOp->setAttr(SymbolTable::getSymbolAttrName(),
-                        StringAttr::get(circuitOp->getContext(), newName));
+                        StringAttr::get(context, newName));
 
   // store original return operations for later use
-  quir::ReturnOp const nextReturnOp = getReturnOp(nextCircuitOp);
+  quir::ReturnOp const lastReturnOp = getReturnOp(circuitOps.back());
 
   IRMapping mapper;
 
-  // map original arguments for new circuit based on original circuit
-  // argument numbers
-  mapNextCircuitOperands(nextCallCircuitOp, nextCircuitOp, newCircuitOp,
-                         callInputValues, inputValueIndices, mapper);
+  for (size_t i = 1; i < calls.size(); ++i) {
+    // map original arguments for new circuit based on original circuit
+    // argument numbers
+    mapNextCircuitOperands(calls[i], circuitOps[i], newCircuitOp,
+                           callInputValues, inputValueIndices, mapper);
 
-  // find return op in new circuit
-  quir::ReturnOp const newReturnOp = getReturnOp(newCircuitOp);
-  rewriter.setInsertionPointAfter(newReturnOp);
+    rewriter.setInsertionPointToEnd(&newCircuitOp.back());
 
-  // clone any barrier ops and erase
-  if (barrierOps.has_value()) {
-    for (auto *barrierOp : barrierOps.value()) {
+    // clone any barrier ops and erase
+    for (auto *barrierOp : barrierOps[i]) {
       // add barrierOps to argument list for circuit and set physicalId
       // of attribute
       mapBarrierOperands(barrierOp, newCircuitOp, callInputValues,
                          inputValueIndices, mapper, context);
       // clone into circuit and remove from original location
       rewriter.clone(*barrierOp, mapper);
-      barrierOp->erase();
+      rewriter.eraseOp(barrierOp);
     }
-  }
 
-  // copy second circuit into the new circuit
-  for (auto &block : nextCircuitOp.getBody().getBlocks())
-    for (auto &op : block.getOperations())
-      rewriter.clone(op, mapper);
+    // copy next circuit into the new circuit
+    for (auto &block : circuitOps[i].getBody().getBlocks())
+      for (auto &op : block.getOperations())
+        rewriter.clone(op, mapper);
+
+    mergePhysicalIdAttrs(newCircuitOp, circuitOps[i], rewriter);
+  }
 
   // remove any existing return operations from new circuit
   // collect their output types and values into vectors
@@ -473,7 +488,7 @@ LogicalResult MergeCircuitsPass::mergeCallCircuits(
 
   // create a return op in the new circuit with the merged output values
   rewriter.setInsertionPointToEnd(&newCircuitOp.back());
-  rewriter.create<quir::ReturnOp>(nextReturnOp->getLoc(), outputValues);
+  rewriter.create<quir::ReturnOp>(lastReturnOp->getLoc(), outputValues);
 
   // change the input / output types for the quir.circuit
   auto opType = newCircuitOp.getFunctionType();
@@ -481,35 +496,159 @@ LogicalResult MergeCircuitsPass::mergeCallCircuits(
       /*inputs=*/opType.getInputs(),
       /*results=*/ArrayRef<Type>(outputTypes)));
 
-  mergePhysicalIdAttrs(newCircuitOp, nextCircuitOp, rewriter);
-
-  rewriter.setInsertionPointAfter(nextCallCircuitOp);
+  rewriter.setInsertionPointAfter(calls.back());
   auto newCallOp = rewriter.create<mlir::quir::CallCircuitOp>(
-      callCircuitOp->getLoc(), newName, TypeRange(outputTypes),
+      calls.front()->getLoc(), newName, TypeRange(outputTypes),
       ValueRange(callInputValues));
 
   // dice the output so we can specify which results to replace
-  auto iterSep = newCallOp.result_begin() + callCircuitOp.getNumResults();
-  rewriter.replaceOp(callCircuitOp,
-                     ResultRange(newCallOp.result_begin(), iterSep));
-  rewriter.replaceOp(nextCallCircuitOp,
-                     ResultRange(iterSep, newCallOp.result_end()));
+  auto resultBegin = newCallOp.result_begin();
+  for (auto callOp : calls) {
+    auto resultEnd = resultBegin + callOp.getNumResults();
+    rewriter.replaceOp(callOp, ResultRange(resultBegin, resultEnd));
+    resultBegin = resultEnd;
+  }
 
   // add new name to symbolMap
   // do not remove old in case the are multiple calls
-  // symbolCache->getSymbolMap()[newName] = newCircuitOp.getOperation()
   symbolCache->addCallee(newCircuitOp);
   symbolCache->cacheCall(newCallOp, newCircuitOp);
 
+  return newCallOp;
+}
+
+// A run of call_circuits in a block that can be merged into a single call
+struct CallCircuitRun {
+  llvm::SmallVector<CallCircuitOp> calls;
+  // the barriers between calls[i - 1] and calls[i]
+  llvm::SmallVector<llvm::SmallVector<Operation *>> barriers;
+  // classical operations between the calls that depend on their results and
+  // have to follow the merged call
+  llvm::SmallVector<Operation *> deferredOps;
+};
+
+// Collect the longest run starting at callCircuitOp. Barriers and classical
+// operations without regions in between the calls are stepped over, any
+// other quantum operation or control flow ends the run.
+CallCircuitRun collectCallCircuitRun(CallCircuitOp callCircuitOp) {
+  CallCircuitRun run;
+  run.calls.push_back(callCircuitOp);
+  run.barriers.emplace_back();
+
+  // the calls of the run and the operations depending on them
+  llvm::SmallPtrSet<Operation *, 8> dependentOps;
+  dependentOps.insert(callCircuitOp);
+  auto dependsOnRun = [&](Operation *op) {
+    return llvm::any_of(op->getOperands(), [&](Value operand) {
+      Operation *defOp = operand.getDefiningOp();
+      return defOp && dependentOps.contains(defOp);
+    });
+  };
+
+  llvm::SmallVector<Operation *> barriers;
+  llvm::SmallVector<Operation *> deferredOps;
+  for (Operation *op = callCircuitOp->getNextNode(); op;
+       op = op->getNextNode()) {
+    if (auto nextCallCircuitOp = dyn_cast<CallCircuitOp>(op)) {
+      if (dependsOnRun(op))
+        break;
+      run.calls.push_back(nextCallCircuitOp);
+      run.barriers.push_back(std::move(barriers));
+      barriers.clear();
+      run.deferredOps.append(deferredOps);
+      deferredOps.clear();
+      dependentOps.insert(op);
+      continue;
+    }
+
+    if (isa<BarrierOp>(op)) {
+      if (dependsOnRun(op))
+        break;
+      barriers.push_back(op);
+      continue;
+    }
+
+    if (isQuantumOp(op) || op->getNumRegions() != 0 ||
+        op->hasTrait<OpTrait::IsTerminator>())
+      break;
+
+    if (dependsOnRun(op)) {
+      dependentOps.insert(op);
+      deferredOps.push_back(op);
+    }
+  }
+
+  return run;
+}
+
+// Merge every run of call_circuits in each block of op with a single scan of
+// the block
+void sweepCallCircuits(Operation *op,
+                       qssc::utils::SymbolCacheAnalysis &symbolCache) {
+  llvm::SmallVector<Block *> blocks;
+  op->walk([&](Block *block) { blocks.push_back(block); });
+
+  IRRewriter rewriter(op->getContext());
+  for (Block *block : blocks) {
+    Operation *curOp = block->empty() ? nullptr : &block->front();
+    while (curOp) {
+      auto callCircuitOp = dyn_cast<CallCircuitOp>(curOp);
+      if (!callCircuitOp) {
+        curOp = curOp->getNextNode();
+        continue;
+      }
+
+      CallCircuitRun run = collectCallCircuitRun(callCircuitOp);
+      if (run.calls.size() < 2) {
+        curOp = curOp->getNextNode();
+        continue;
+      }
+
+      Operation *insertOp =
+          mergeCallCircuitRun(op->getContext(), rewriter, run.calls,
+                              run.barriers, &symbolCache);
+      for (auto *deferredOp : run.deferredOps) {
+        deferredOp->moveAfter(insertOp);
+        insertOp = deferredOp;
+      }
+      curOp = insertOp->getNextNode();
+    }
+  }
+}
+} // anonymous namespace
+
+LogicalResult MergeCircuitsPass::mergeCallCircuits(
+    MLIRContext *context, PatternRewriter &rewriter,
+    CallCircuitOp callCircuitOp, CallCircuitOp nextCallCircuitOp,
+    qssc::utils::SymbolCacheAnalysis *symbolCache,
+    std::optional<llvm::SmallVector<Operation *>> barrierOps) {
+  llvm::SmallVector<CallCircuitOp> const calls{callCircuitOp,
+                                               nextCallCircuitOp};
+  llvm::SmallVector<llvm::SmallVector<Operation *>> barriers(2);
+  if (barrierOps.has_value())
+    barriers[1] = std::move(barrierOps.value());
+
+  mergeCallCircuitRun(context, rewriter, calls, barriers, symbolCache);
   return success();
 }
 
 void MergeCircuitsPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
+  // Circuits left unmerged run the same operations with more call overhead
+  // and no scheduling across their boundaries, so only the output quality is
+  // lost by skipping the merge
+  if (qssc::utils::shouldSkipOverBudget(moduleOperation, getArgument())) {
+    markAllAnalysesPreserved();
+    return;
+  }
+
   auto &cache =
       getAnalysis<qssc::utils::SymbolCacheAnalysis>().addToCache<CircuitOp>();
 
+  if (sweep)
+    sweepCallCircuits(moduleOperation, cache);
+
   RewritePatternSet patterns(&getContext());
   patterns.add<CircuitAndCircuitPattern>(&getContext(), cache);
   patterns.add<BarrierAndCircuitPattern>(&getContext());
@@ -0,0 +1,190 @@
+//===- MergeDelays.cpp - Merge quir.delays on the same qubits ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for merging quir.delay ops on the same
+///  qubits
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/MergeDelays.h"
+
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+/// Returns the ids of the qubit operands of op, std::nullopt if one of them
+/// cannot be resolved
+std::optional<QubitSet> getQubitOperandIds(Operation *op) {
+  QubitSet qubits;
+  for (Value const operand : op->getOperands()) {
+    if (!operand.getType().isa<QubitType>())
+      continue;
+    auto id = lookupQubitId(operand);
+    if (!id.has_value())
+      return std::nullopt;
+    qubits.insert(id.value());
+  }
+  return qubits;
+}
+
+/// Returns the duration of a delay if it is a constant
+DurationAttr getConstantDuration(DelayOp delayOp) {
+  if (auto constantOp = delayOp.getTime().getDefiningOp<quir::ConstantOp>())
+    return constantOp.getValue().dyn_cast<DurationAttr>();
+  return nullptr;
+}
+
+/// Merges the delays of a single block. The qubits of the delays are
+/// std::nullopt for all qubits.
+class DelayMerger {
+public:
+  explicit DelayMerger(MLIRContext *context) : builder(context) {}
+
+  /// Returns the number of merged delays
+  uint64_t merge(Block &block);
+
+private:
+  using Qubits = std::optional<QubitSet>;
+
+  OpBuilder builder;
+  // the delays no op acted on the qubits of since
+  SmallVector<std::pair<DelayOp, Qubits>> openDelays;
+  SmallVector<Operation *> mergedOps;
+
+  void actOn(const QubitSet &qubits);
+  void actOnAll() { openDelays.clear(); }
+  void delay(DelayOp delayOp);
+}; // class DelayMerger
+
+void DelayMerger::actOn(const QubitSet &qubits) {
+  llvm::erase_if(openDelays, [&](const auto &entry) {
+    return !entry.second.has_value() || entry.second->overlaps(qubits);
+  });
+}
+
+void DelayMerger::delay(DelayOp delayOp) {
+  Qubits qubits;
+  if (!delayOp.getQubits().empty()) {
+    qubits = getQubitOperandIds(delayOp);
+    if (!qubits.has_value())
+      return actOnAll();
+  }
+
+  auto duration = getConstantDuration(delayOp);
+  if (duration) {
+    // merge into an earlier delay of the same qubits in the same units,
+    // which already acted on them
+    auto *open = llvm::find_if(openDelays, [&](const auto &entry) {
+      return entry.second == qubits &&
+             getConstantDuration(entry.first).getType() == duration.getType();
+    });
+    if (open != openDelays.end()) {
+      DelayOp earlier = open->first;
+      auto earlierDuration = getConstantDuration(earlier);
+      double const sum = earlierDuration.getDuration().convertToDouble() +
+                         duration.getDuration().convertToDouble();
+      builder.setInsertionPoint(earlier);
+      auto sumOp = builder.create<quir::ConstantOp>(
+          earlier.getLoc(),
+          DurationAttr::get(builder.getContext(), duration.getType(),
+                            llvm::APFloat(sum)));
+      earlier.getTimeMutable().assign(sumOp);
+      mergedOps.push_back(delayOp);
+      return;
+    }
+  }
+
+  if (qubits.has_value())
+    actOn(*qubits);
+  else
+    actOnAll();
+  // delays of a stretch or an argument end the delays before them
+  if (duration)
+    openDelays.emplace_back(delayOp, std::move(qubits));
+}
+
+uint64_t DelayMerger::merge(Block &block) {
+  for (Operation &op : block) {
+    if (auto delayOp = dyn_cast<DelayOp>(op)) {
+      delay(delayOp);
+    } else if (isa<DeclareQubitOp>(op) ||
+               (op.getNumRegions() == 0 && isMemoryEffectFree(&op))) {
+      // takes no time on the qubits
+    } else if (isa<QubitOpInterface>(op)) {
+      // ops without qubit operands, such as barriers, act on all qubits
+      auto qubits = getQubitOperandIds(&op);
+      if (qubits.has_value() && !qubits->empty())
+        actOn(*qubits);
+      else
+        actOnAll();
+    } else {
+      actOnAll();
+    }
+  }
+
+  for (Operation *op : mergedOps)
+    op->erase();
+  return mergedOps.size();
+}
+
+} // anonymous namespace
+
+void MergeDelaysPass::runOnOperation() {
+  // the ops erased from a block have no regions, hence the other blocks
+  // remain valid
+  SmallVector<Block *> blocks;
+  getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+
+  for (Block *block : blocks)
+    numMergedDelays += DelayMerger(&getContext()).merge(*block);
+} // MergeDelaysPass::runOnOperation
+
+llvm::StringRef MergeDelaysPass::getArgument() const {
+  return "quir-merge-delays";
+}
+
+llvm::StringRef MergeDelaysPass::getDescription() const {
+  return "Merge quir.delay ops of constant durations on the same qubits which "
+         "no op in between acts on, e.g. between quir.call_circuit ops.";
+}
+
+llvm::StringRef MergeDelaysPass::getName() const {
+  return "Merge Delays Pass";
+}
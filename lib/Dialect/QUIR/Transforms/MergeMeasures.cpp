@@ -23,6 +23,9 @@
 
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Transforms/BranchHoisting.h"
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/IR/PatternMatch.h"
@@ -36,9 +39,7 @@
 #include "llvm/ADT/StringRef.h"
 
 #include <algorithm>
-#include <iterator>
 #include <optional>
-#include <set>
 #include <sys/types.h>
 #include <unordered_set>
 #include <utility>
@@ -149,57 +150,56 @@ namespace {
 // classical non-control flow ops and merges them into one measure op
 struct MeasureAndMeasureTopologicalPattern
     : public OpRewritePattern<MeasureOp> {
-  explicit MeasureAndMeasureTopologicalPattern(MLIRContext *ctx)
-      : OpRewritePattern<MeasureOp>(ctx) {}
+  MeasureAndMeasureTopologicalPattern(MLIRContext *ctx,
+                                      QubitDependencyAnalysis &deps)
+      : OpRewritePattern<MeasureOp>(ctx), deps(deps) {}
 
   LogicalResult matchAndRewrite(MeasureOp measureOp,
                                 PatternRewriter &rewriter) const override {
-    // Accumulate qubits in measurement set
-    std::set<uint> currMeasureQubits = measureOp.getOperatedQubits();
-
-    // Find the next measurement operation accumulating qubits along the
-    // topological path if it exists
-    auto [nextMeasureOpt, observedQubits] =
-        QubitOpInterface::getNextQubitOpOfTypeWithQubits<MeasureOp>(measureOp);
-    if (!nextMeasureOpt.has_value())
-      return failure();
-
-    // If any qubit along path touches the same qubits we cannot merge the next
-    // measurement.
-    currMeasureQubits.insert(observedQubits.begin(), observedQubits.end());
-
-    // found a measure and a measure, now make sure they aren't working on the
-    // same qubit and that we can resolve them both
-    MeasureOp nextMeasureOp = nextMeasureOpt.value();
-    auto nextMeasureQubits = nextMeasureOp.getOperatedQubits();
-
-    // If there is an intersection we cannot merge
-    std::set<int> mergeMeasureIntersection;
-    std::set_intersection(currMeasureQubits.begin(), currMeasureQubits.end(),
-                          nextMeasureQubits.begin(), nextMeasureQubits.end(),
-                          std::inserter(mergeMeasureIntersection,
-                                        mergeMeasureIntersection.begin()));
-
-    if (!mergeMeasureIntersection.empty())
+    // Find the next measurement operation along the topological path if it
+    // exists
+    Operation *nextOp = deps.getNextQubitOp(measureOp);
+    while (nextOp && !isa<MeasureOp>(nextOp))
+      nextOp = deps.getNextQubitOp(nextOp);
+    if (!nextOp)
       return failure();
+    auto nextMeasureOp = cast<MeasureOp>(nextOp);
+
+    // If the measurement or any operation along the path touches one of the
+    // qubits of the next measurement we cannot merge. This is the case if
+    // the previous operation on the qubit is not before the measurement.
+    for (uint32_t const qubit : deps.getOperatedQubits(nextMeasureOp)) {
+      Operation *prevUser = deps.getPrevQubitUser(nextMeasureOp, qubit);
+      if (prevUser && !deps.isBeforeInBlock(prevUser, measureOp))
+        return failure();
+    }
 
     // good to merge
     mergeMeasurements(rewriter, measureOp, nextMeasureOp);
 
     return success();
   } // matchAndRewrite
-};  // struct MeasureAndMeasureTopologicalPattern
+
+private:
+  QubitDependencyAnalysis &deps;
+}; // struct MeasureAndMeasureTopologicalPattern
 } // end anonymous namespace
 
 void MergeMeasuresTopologicalPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
+  auto &deps = getAnalysis<QubitDependencyAnalysis>();
+
+  if (hoistFromBranches)
+    hoistCommonBranchOps(moduleOperation, deps,
+                         [](Operation *op) { return isa<MeasureOp>(op); });
 
   RewritePatternSet patterns(&getContext());
-  patterns.add<MeasureAndMeasureTopologicalPattern>(&getContext());
+  patterns.add<MeasureAndMeasureTopologicalPattern>(&getContext(), deps);
 
   mlir::GreedyRewriteConfig config;
   // Disable to improve performance
   config.enableRegionSimplification = false;
+  config.listener = &deps;
 
   if (failed(applyPatternsAndFoldGreedily(moduleOperation, std::move(patterns),
                                           config)))
@@ -23,6 +23,9 @@
 
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Transforms/BranchHoisting.h"
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/IR/PatternMatch.h"
@@ -34,9 +37,7 @@
 #include "llvm/ADT/StringRef.h"
 
 #include <algorithm>
-#include <iterator>
 #include <optional>
-#include <set>
 #include <sys/types.h>
 #include <unordered_set>
 #include <utility>
@@ -161,31 +162,20 @@ struct MergeResetsTopologicalPattern : public OpRewritePattern<ResetQubitOp> {
     // Form a forward set (all qubits used between here and the next
     // reset, including this operation) and a backward set (all qubits
     // used between here and the next reset, including the next)
-    std::set<uint> fwdQubits = curQubits;
-    fwdQubits.insert(observedQubits.begin(), observedQubits.end());
-    std::set<uint> backQubits = nextQubits;
-    backQubits.insert(observedQubits.begin(), observedQubits.end());
+    QubitSet const fwdQubits = curQubits | observedQubits;
+    QubitSet const backQubits = nextQubits | observedQubits;
 
     // If any qubit along path touches the same qubits we cannot merge in
     // that direction, so check for intersections
-    std::set<int> mergeFwdIntersection;
-    std::set_intersection(
-        fwdQubits.begin(), fwdQubits.end(), nextQubits.begin(),
-        nextQubits.end(),
-        std::inserter(mergeFwdIntersection, mergeFwdIntersection.begin()));
-
-    std::set<int> mergeBackIntersection;
-    std::set_intersection(
-        backQubits.begin(), backQubits.end(), curQubits.begin(),
-        curQubits.end(),
-        std::inserter(mergeBackIntersection, mergeBackIntersection.begin()));
-
-    if (!mergeFwdIntersection.empty() && !mergeBackIntersection.empty())
+    bool const mergeFwdOverlaps = fwdQubits.overlaps(nextQubits);
+    bool const mergeBackOverlaps = backQubits.overlaps(curQubits);
+
+    if (mergeFwdOverlaps && mergeBackOverlaps)
       // Can't merge in EITHER direction
       return failure();
 
     // good to merge one way or the other. Prefer hoisting the next reset.
-    if (mergeFwdIntersection.empty()) {
+    if (!mergeFwdOverlaps) {
       // Hoist the next reset into this one
       auto resetQubitOperands = resetOp.getQubitsMutable();
       for (auto qubit : nextResetOp.getQubits())
@@ -214,6 +204,11 @@ struct MergeResetsTopologicalPattern : public OpRewritePattern<ResetQubitOp> {
 } // anonymous namespace
 
 void MergeResetsTopologicalPass::runOnOperation() {
+  if (hoistFromBranches)
+    hoistCommonBranchOps(getOperation(),
+                         getAnalysis<QubitDependencyAnalysis>(),
+                         [](Operation *op) { return isa<ResetQubitOp>(op); });
+
   mlir::RewritePatternSet patterns(&getContext());
   mlir::GreedyRewriteConfig config;
 
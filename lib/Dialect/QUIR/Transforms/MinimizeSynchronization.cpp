@@ -0,0 +1,242 @@
+//===- MinimizeSynchronization.cpp - Remove redundant syncs -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for removing redundant qcs.synchronize ops
+///  and merging qcs.delay_cycles ops
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/MinimizeSynchronization.h"
+
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+/// Returns the ids of the qubit operands of op, std::nullopt if one of them
+/// cannot be resolved
+std::optional<QubitSet> getQubitOperandIds(Operation *op) {
+  QubitSet qubits;
+  for (Value const operand : op->getOperands()) {
+    if (!operand.getType().isa<QubitType>())
+      continue;
+    auto id = lookupQubitId(operand);
+    if (!id.has_value())
+      return std::nullopt;
+    qubits.insert(id.value());
+  }
+  return qubits;
+}
+
+/// Minimizes the synchronizations and delays of a single block. The qubits
+/// of the synchronizations and delays are std::nullopt for all qubits.
+class SyncMinimizer {
+public:
+  void minimize(Block &block);
+
+private:
+  using Qubits = std::optional<QubitSet>;
+
+  // the synchronization that each qubit was last synchronized by, nullptr if
+  // an op acted on it since, qubits without an entry were last synchronized
+  // by allSync
+  llvm::DenseMap<uint32_t, Operation *> syncOf;
+  Operation *allSync = nullptr;
+  // the kept synchronizations and delays no op acted on the qubits of since
+  SmallVector<std::pair<Operation *, Qubits>> pendingSyncs;
+  SmallVector<std::pair<qcs::DelayCyclesOp, Qubits>> openDelays;
+  SmallVector<Operation *> redundantOps;
+
+  Operation *lastSync(uint32_t qubit) const {
+    auto search = syncOf.find(qubit);
+    return search == syncOf.end() ? allSync : search->second;
+  }
+
+  void actOn(const QubitSet &qubits);
+  void actOnAll();
+  void synchronize(qcs::SynchronizeOp syncOp);
+  void delay(qcs::DelayCyclesOp delayOp);
+}; // class SyncMinimizer
+
+void SyncMinimizer::actOn(const QubitSet &qubits) {
+  for (uint32_t const qubit : qubits)
+    syncOf[qubit] = nullptr;
+  auto overlaps = [&](const auto &entry) {
+    return !entry.second.has_value() || entry.second->overlaps(qubits);
+  };
+  llvm::erase_if(pendingSyncs, overlaps);
+  llvm::erase_if(openDelays, overlaps);
+}
+
+void SyncMinimizer::actOnAll() {
+  syncOf.clear();
+  allSync = nullptr;
+  pendingSyncs.clear();
+  openDelays.clear();
+}
+
+void SyncMinimizer::synchronize(qcs::SynchronizeOp syncOp) {
+  Qubits qubits;
+  if (!syncOp.getQubits().empty()) {
+    qubits = getQubitOperandIds(syncOp);
+    if (!qubits.has_value())
+      return actOnAll();
+  }
+
+  // the qubits are still synchronized by an earlier synchronization
+  bool redundant;
+  if (!qubits.has_value()) {
+    redundant = allSync && syncOf.empty();
+  } else {
+    Operation *first = lastSync(*qubits->begin());
+    redundant = first && llvm::all_of(*qubits, [&](uint32_t qubit) {
+                  return lastSync(qubit) == first;
+                });
+  }
+  if (redundant) {
+    redundantOps.push_back(syncOp);
+    return;
+  }
+
+  // the earlier synchronizations of a subset of the qubits, which no op
+  // acted on since, are implied by this one
+  llvm::erase_if(pendingSyncs, [&](const auto &entry) {
+    const Qubits &earlier = entry.second;
+    bool const implied =
+        !qubits.has_value() ||
+        (earlier.has_value() && (*earlier & *qubits) == *earlier);
+    if (implied)
+      redundantOps.push_back(entry.first);
+    return implied;
+  });
+
+  // synchronizing the qubits separates the delays before from those after
+  if (!qubits.has_value()) {
+    syncOf.clear();
+    allSync = syncOp;
+    openDelays.clear();
+  } else {
+    for (uint32_t const qubit : *qubits)
+      syncOf[qubit] = syncOp;
+    llvm::erase_if(openDelays, [&](const auto &entry) {
+      return !entry.second.has_value() || entry.second->overlaps(*qubits);
+    });
+  }
+  pendingSyncs.emplace_back(syncOp, std::move(qubits));
+}
+
+void SyncMinimizer::delay(qcs::DelayCyclesOp delayOp) {
+  if (delayOp.getTime() == 0) {
+    redundantOps.push_back(delayOp);
+    return;
+  }
+
+  Qubits qubits;
+  if (!delayOp.getQubits().empty()) {
+    qubits = getQubitOperandIds(delayOp);
+    if (!qubits.has_value())
+      return actOnAll();
+  }
+
+  // merge into an earlier delay of the same qubits, which already acted on
+  // them
+  auto *open = llvm::find_if(
+      openDelays, [&](const auto &entry) { return entry.second == qubits; });
+  if (open != openDelays.end()) {
+    qcs::DelayCyclesOp earlier = open->first;
+    earlier.setTime(earlier.getTime() + delayOp.getTime());
+    redundantOps.push_back(delayOp);
+    return;
+  }
+
+  if (qubits.has_value())
+    actOn(*qubits);
+  else
+    actOnAll();
+  openDelays.emplace_back(delayOp, std::move(qubits));
+}
+
+void SyncMinimizer::minimize(Block &block) {
+  for (Operation &op : block) {
+    if (auto syncOp = dyn_cast<qcs::SynchronizeOp>(op)) {
+      synchronize(syncOp);
+    } else if (auto delayOp = dyn_cast<qcs::DelayCyclesOp>(op)) {
+      delay(delayOp);
+    } else if (isa<DeclareQubitOp>(op) ||
+               (op.getNumRegions() == 0 && isMemoryEffectFree(&op))) {
+      // takes no time on the qubits
+    } else if (isa<QubitOpInterface>(op)) {
+      // ops without qubit operands, such as barriers, act on all qubits
+      auto qubits = getQubitOperandIds(&op);
+      if (qubits.has_value() && !qubits->empty())
+        actOn(*qubits);
+      else
+        actOnAll();
+    } else {
+      actOnAll();
+    }
+  }
+
+  for (Operation *op : redundantOps)
+    op->erase();
+}
+
+} // anonymous namespace
+
+void MinimizeSynchronizationPass::runOnOperation() {
+  // the ops erased from a block have no regions, hence the other blocks
+  // remain valid
+  SmallVector<Block *> blocks;
+  getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+
+  for (Block *block : blocks)
+    SyncMinimizer().minimize(*block);
+} // MinimizeSynchronizationPass::runOnOperation
+
+llvm::StringRef MinimizeSynchronizationPass::getArgument() const {
+  return "minimize-synchronization";
+}
+
+llvm::StringRef MinimizeSynchronizationPass::getDescription() const {
+  return "Remove qcs.synchronize ops implied by other synchronizations and "
+         "merge qcs.delay_cycles ops on the same qubits.";
+}
+
+llvm::StringRef MinimizeSynchronizationPass::getName() const {
+  return "Minimize Synchronization Pass";
+}
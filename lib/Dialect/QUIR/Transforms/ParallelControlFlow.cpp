@@ -0,0 +1,242 @@
+//===- ParallelControlFlow.cpp - Group independent branches -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for grouping independent branch ops into a
+///  qcs.parallel_control_flow op
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/ParallelControlFlow.h"
+
+#include "Dialect/OQ3/IR/OQ3Ops.h"
+#include "Dialect/QCS/IR/QCSDialect.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <optional>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+/// The qubits and classical state a branch op acts on. Classical state is
+/// identified by variable symbols as well as by the values and resources of
+/// memory effects.
+struct BranchAccesses {
+  QubitSet qubits;
+  llvm::DenseSet<const void *> reads;
+  llvm::DenseSet<const void *> writes;
+
+  bool writesAny(const llvm::DenseSet<const void *> &keys) const {
+    return llvm::any_of(writes,
+                        [&](const void *key) { return keys.contains(key); });
+  }
+
+  bool isIndependentOf(const BranchAccesses &other) const {
+    return !qubits.overlaps(other.qubits) && !writesAny(other.reads) &&
+           !writesAny(other.writes) && !other.writesAny(reads);
+  }
+}; // struct BranchAccesses
+
+/// Collect the accesses of a branch op, returns std::nullopt if they cannot
+/// be determined
+std::optional<BranchAccesses> getBranchAccesses(Operation *branchOp) {
+  BranchAccesses accesses;
+
+  auto result = branchOp->walk([&](Operation *op) -> WalkResult {
+    bool hasQubits = false;
+    for (Value const operand : op->getOperands()) {
+      if (!operand.getType().isa<QubitType>())
+        continue;
+      auto id = lookupQubitId(operand);
+      if (!id.has_value())
+        return WalkResult::interrupt();
+      accesses.qubits.insert(id.value());
+      hasQubits = true;
+    }
+    // delays and barriers without operands act on all qubits
+    if (isa<DelayOp, BarrierOp>(op) && !hasQubits)
+      return WalkResult::interrupt();
+
+    if (auto loadOp = dyn_cast<oq3::VariableLoadOp>(op)) {
+      accesses.reads.insert(loadOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+    if (auto useOp = dyn_cast<oq3::UseArrayElementOp>(op)) {
+      accesses.reads.insert(useOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+    if (auto assignOp = dyn_cast<oq3::VariableAssignOp>(op)) {
+      accesses.writes.insert(
+          assignOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+    if (auto assignOp = dyn_cast<oq3::CBitAssignBitOp>(op)) {
+      accesses.writes.insert(
+          assignOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+    if (auto assignOp = dyn_cast<oq3::AssignArrayElementOp>(op)) {
+      accesses.writes.insert(
+          assignOp.getVariableNameAttr().getAsOpaquePointer());
+      return WalkResult::advance();
+    }
+
+    // the nested ops are visited by the walk
+    if (op->hasTrait<OpTrait::HasRecursiveMemoryEffects>())
+      return WalkResult::advance();
+
+    auto effectInterface = dyn_cast<MemoryEffectOpInterface>(op);
+    if (!effectInterface)
+      return WalkResult::interrupt();
+    SmallVector<MemoryEffects::EffectInstance> effects;
+    effectInterface.getEffects(effects);
+    for (auto &effect : effects) {
+      const void *key = effect.getValue()
+                            ? effect.getValue().getAsOpaquePointer()
+                            : effect.getResource();
+      if (isa<MemoryEffects::Read>(effect.getEffect()))
+        accesses.reads.insert(key);
+      else if (isa<MemoryEffects::Write>(effect.getEffect()))
+        accesses.writes.insert(key);
+      // allocations and frees, such as those of the quantum ops, do not
+      // order the branch ops
+    }
+    return WalkResult::advance();
+  });
+
+  if (result.wasInterrupted())
+    return std::nullopt;
+  return accesses;
+}
+
+bool isCandidate(Operation *op) {
+  return isa<scf::IfOp, SwitchOp>(op) && op->getNumResults() == 0;
+}
+
+/// Ops without side effects that may be moved before a group
+bool isMovable(Operation *op) {
+  return op->getNumRegions() == 0 && !op->hasTrait<OpTrait::IsTerminator>() &&
+         isMemoryEffectFree(op);
+}
+
+void wrapGroup(llvm::ArrayRef<Operation *> group,
+               llvm::ArrayRef<Operation *> movedOps) {
+  Operation *first = group.front();
+  for (Operation *op : movedOps)
+    op->moveBefore(first);
+
+  OpBuilder builder(first);
+  auto parallelOp = builder.create<qcs::ParallelControlFlowOp>(first->getLoc());
+  qcs::ParallelControlFlowOp::ensureTerminator(parallelOp.getRegion(),
+                                               builder, first->getLoc());
+  Operation *terminator = parallelOp.getRegion().front().getTerminator();
+  for (Operation *op : group)
+    op->moveBefore(terminator);
+}
+
+void groupBranches(Block &block) {
+  SmallVector<Operation *> group;
+  SmallVector<BranchAccesses> groupAccesses;
+  SmallVector<Operation *> movedOps;
+
+  auto flush = [&]() {
+    if (group.size() > 1)
+      wrapGroup(group, movedOps);
+    group.clear();
+    groupAccesses.clear();
+    movedOps.clear();
+  };
+
+  for (Operation &op : llvm::make_early_inc_range(block)) {
+    if (!isCandidate(&op)) {
+      if (group.empty())
+        continue;
+      if (isMovable(&op))
+        movedOps.push_back(&op);
+      else
+        flush();
+      continue;
+    }
+
+    auto accesses = getBranchAccesses(&op);
+    // purely classical branches are left to the controller
+    if (!accesses.has_value() || accesses->qubits.empty()) {
+      flush();
+      continue;
+    }
+    if (!llvm::all_of(groupAccesses, [&](const BranchAccesses &other) {
+          return accesses->isIndependentOf(other);
+        }))
+      flush();
+    group.push_back(&op);
+    groupAccesses.push_back(std::move(accesses.value()));
+  }
+  flush();
+}
+
+} // anonymous namespace
+
+void ParallelControlFlowPass::runOnOperation() {
+  // collect the blocks first, as grouping creates new ones
+  SmallVector<Block *> blocks;
+  getOperation()->walk([&](Block *block) {
+    if (!isa_and_nonnull<qcs::ParallelControlFlowOp>(block->getParentOp()))
+      blocks.push_back(block);
+  });
+
+  for (Block *block : blocks)
+    groupBranches(*block);
+} // ParallelControlFlowPass::runOnOperation
+
+void ParallelControlFlowPass::getDependentDialects(
+    DialectRegistry &registry) const {
+  registry.insert<qcs::QCSDialect>();
+}
+
+llvm::StringRef ParallelControlFlowPass::getArgument() const {
+  return "parallel-control-flow";
+}
+
+llvm::StringRef ParallelControlFlowPass::getDescription() const {
+  return "Group adjacent branch ops acting on disjoint qubits and classical "
+         "state into a qcs.parallel_control_flow op.";
+}
+
+llvm::StringRef ParallelControlFlowPass::getName() const {
+  return "Parallel Control Flow Pass";
+}
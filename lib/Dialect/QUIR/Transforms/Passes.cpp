@@ -23,19 +23,29 @@
 #include "Dialect/QUIR/Transforms/AngleConversion.h"
 #include "Dialect/QUIR/Transforms/BreakReset.h"
 #include "Dialect/QUIR/Transforms/ConvertDurationUnits.h"
+#include "Dialect/QUIR/Transforms/DeduplicateCircuits.h"
 #include "Dialect/QUIR/Transforms/ExtractCircuits.h"
+#include "Dialect/QUIR/Transforms/FeedforwardScheduling.h"
 #include "Dialect/QUIR/Transforms/FunctionArgumentSpecialization.h"
+#include "Dialect/QUIR/Transforms/GateCancellation.h"
+#include "Dialect/QUIR/Transforms/IRStatistics.h"
 #include "Dialect/QUIR/Transforms/LoadElimination.h"
 #include "Dialect/QUIR/Transforms/MergeCircuitMeasures.h"
 #include "Dialect/QUIR/Transforms/MergeCircuits.h"
+#include "Dialect/QUIR/Transforms/MergeDelays.h"
 #include "Dialect/QUIR/Transforms/MergeMeasures.h"
 #include "Dialect/QUIR/Transforms/MergeParallelResets.h"
+#include "Dialect/QUIR/Transforms/MinimizeSynchronization.h"
+#include "Dialect/QUIR/Transforms/ParallelControlFlow.h"
+#include "Dialect/QUIR/Transforms/PipelineShotLoop.h"
+#include "Dialect/QUIR/Transforms/QUIRCircuitAnalysis.h"
 #include "Dialect/QUIR/Transforms/QuantumDecoration.h"
 #include "Dialect/QUIR/Transforms/RemoveQubitOperands.h"
 #include "Dialect/QUIR/Transforms/RemoveUnusedCircuits.h"
 #include "Dialect/QUIR/Transforms/ReorderCircuits.h"
 #include "Dialect/QUIR/Transforms/ReorderMeasurements.h"
 #include "Dialect/QUIR/Transforms/SubroutineCloning.h"
+#include "Dialect/QUIR/Transforms/UnrollLoops.h"
 #include "Dialect/QUIR/Transforms/UnusedVariable.h"
 #include "Dialect/QUIR/Transforms/VariableElimination.h"
 #include "Dialect/QUIR/Utils/Utils.h"
@@ -56,6 +66,7 @@
 #include "mlir/Pass/PassRegistry.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -152,35 +163,62 @@ struct TestPrintNestingPass
 }; // end struct TestPrintNestingPass
 
 ///////////////// ClassicalOnlyDetectionPass functions /////////////////////
+// detects whether or not an operation is a quantum operation
+auto ClassicalOnlyDetectionPass::isQuantumOp(Operation *op) -> bool {
+  return isa<BuiltinCXOp, Builtin_UOp, CallDefCalGateOp, CallDefcalMeasureOp,
+             DelayOp, CallGateOp, MeasureOp, DeclareQubitOp, ResetQubitOp,
+             CallCircuitOp>(op);
+} // ClassicalOnlyDetectionPass::isQuantumOp
+
 // detects whether or not an operation contains quantum operations inside
 auto ClassicalOnlyDetectionPass::hasQuantumSubOps(Operation *inOp) -> bool {
-  bool retVal = true;
-  inOp->walk([&](Operation *op) {
-    if (dyn_cast<BuiltinCXOp>(op) || dyn_cast<Builtin_UOp>(op) ||
-        dyn_cast<CallDefCalGateOp>(op) || dyn_cast<CallDefcalMeasureOp>(op) ||
-        dyn_cast<DelayOp>(op) || dyn_cast<CallGateOp>(op) ||
-        dyn_cast<MeasureOp>(op) || dyn_cast<DeclareQubitOp>(op) ||
-        dyn_cast<ResetQubitOp>(op) || dyn_cast<CallCircuitOp>(op)) {
-      retVal = false;
-      return WalkResult::interrupt();
-    }
-    return WalkResult::advance();
+  auto result = inOp->walk([&](Operation *op) {
+    return isQuantumOp(op) ? WalkResult::interrupt() : WalkResult::advance();
   });
-  return retVal;
+  return !result.wasInterrupted();
 } // ClassicalOnlyDetectionPass::hasQuantumSubOps
 
+namespace {
+// the quantum operations nested within an operation
+struct QuantumContents {
+  // any quantum operation
+  bool quantum = false;
+  // qubit declarations or circuit calls, which make functions quantum
+  bool qubitsOrCircuits = false;
+};
+} // anonymous namespace
+
 // Entry point for the ClassicalOnlyDetectionPass pass
 void ClassicalOnlyDetectionPass::runOnOperation() {
   // This pass is only called on the top-level module Op
   Operation *moduleOperation = getOperation();
   OpBuilder b(moduleOperation);
 
+  // The walk is post-order, such that the contents of an operation are
+  // complete when it is visited: each operation adds its own contents to
+  // those of its parent, hence every operation is visited once.
+  llvm::DenseMap<Operation *, QuantumContents> nestedContents;
   moduleOperation->walk([&](Operation *op) {
-    if (dyn_cast<scf::IfOp>(op) || dyn_cast<scf::ForOp>(op) ||
-        dyn_cast<scf::WhileOp>(op) || dyn_cast<quir::SwitchOp>(op) ||
-        dyn_cast<quir::CircuitOp>(op))
+    QuantumContents contents;
+    auto nested = nestedContents.find(op);
+    if (nested != nestedContents.end()) {
+      contents = nested->second;
+      nestedContents.erase(nested);
+    }
+    if (isQuantumOp(op)) {
+      contents.quantum = true;
+      contents.qubitsOrCircuits |= isa<DeclareQubitOp, CallCircuitOp>(op);
+    }
+    if (contents.quantum && op != moduleOperation) {
+      auto &parentContents = nestedContents[op->getParentOp()];
+      parentContents.quantum = true;
+      parentContents.qubitsOrCircuits |= contents.qubitsOrCircuits;
+    }
+
+    if (isa<scf::IfOp, scf::ForOp, scf::WhileOp, quir::SwitchOp,
+            quir::CircuitOp>(op))
       op->setAttr(llvm::StringRef("quir.classicalOnly"),
-                  b.getBoolAttr(hasQuantumSubOps(op)));
+                  b.getBoolAttr(!contents.quantum));
     if (auto funcOp = dyn_cast<mlir::func::FuncOp>(op)) {
       // just check the arguments for qubitType values
       FunctionType const fType = funcOp.getFunctionType();
@@ -193,14 +231,15 @@ void ClassicalOnlyDetectionPass::runOnOperation() {
           break;
         }
       }
-      bool quantumDeclarations = false;
-      funcOp->walk([&](DeclareQubitOp op) { quantumDeclarations = true; });
-      funcOp->walk([&](CallCircuitOp op) { quantumDeclarations = true; });
+      bool const quantumDeclarations = contents.qubitsOrCircuits;
       op->setAttr(
           llvm::StringRef("quir.classicalOnly"),
           b.getBoolAttr(!quantumOperands && !quantumDeclarations && !isMain));
     } // if funcOp
   });
+
+  // only attributes are added, the operands of circuit calls are unchanged
+  markAnalysesPreserved<QUIRCircuitAnalysis>();
 } // ClassicalOnlyDetectionPass::runOnOperation
 
 llvm::StringRef ClassicalOnlyDetectionPass::getArgument() const {
@@ -267,14 +306,48 @@ struct DumpVariableDominanceInfoPass
   }
 };
 
-void quirPassPipelineBuilder(OpPassManager &pm) {
+void quirPassPipelineBuilder(OpPassManager &pm,
+                             const QUIRPipelineOptions &options) {
   pm.addPass(std::make_unique<LoadEliminationPass>());
+  if (options.cancelGates)
+    pm.addPass(std::make_unique<GateCancellationPass>());
   pm.addPass(std::make_unique<ClassicalOnlyDetectionPass>());
+  if (options.minimizeSynchronization)
+    pm.addPass(std::make_unique<MinimizeSynchronizationPass>());
 
   // TODO: Decide if we want to enable the inliner pass in this pipeline
   // pm.addPass(mlir::createInlinerPass());
 }
 
+void quirNestedPassPipelineBuilder(OpPassManager &pm,
+                                   const QUIRPipelineOptions &options) {
+  // These passes only change the operation they are run on
+  if (options.cancelGates)
+    pm.addPass(std::make_unique<GateCancellationPass>());
+  pm.addPass(std::make_unique<ClassicalOnlyDetectionPass>());
+  pm.addPass(std::make_unique<ReorderMeasurementsPass>());
+  pm.addPass(std::make_unique<MergeMeasuresTopologicalPass>());
+  if (options.minimizeSynchronization)
+    pm.addPass(std::make_unique<MinimizeSynchronizationPass>());
+}
+
+void quirParallelPassPipelineBuilder(OpPassManager &pm,
+                                     const QUIRPipelineOptions &options) {
+  // Load elimination follows variables across functions and has to run on
+  // the module
+  pm.addPass(std::make_unique<LoadEliminationPass>());
+  // BreakResetPass is not nested either: with quantum-gates-in-circuit it
+  // creates new circuits next to main and adds them to the module's symbol
+  // cache, which a pass nested on a function may not modify and which the
+  // threads running the nested passes would race on. Targets add it to their
+  // module level pipeline themselves.
+
+  // Nesting the remaining passes lets MLIR run them on the context's thread
+  // pool, one function or circuit at a time
+  quirNestedPassPipelineBuilder(pm.nest<mlir::func::FuncOp>(), options);
+  quirNestedPassPipelineBuilder(pm.nest<CircuitOp>(), options);
+}
+
 void registerQuirPasses() {
   //===----------------------------------------------------------------------===//
   // Transform Passes
@@ -289,20 +362,31 @@ void registerQuirPasses() {
   PassRegistration<quir::RemoveQubitOperandsPass>();
   PassRegistration<quir::RemoveUnusedCircuitsPass>();
   PassRegistration<quir::UnusedVariablePass>();
+  PassRegistration<quir::IRStatisticsPass>();
   PassRegistration<quir::AddShotLoopPass>();
+  PassRegistration<quir::ShotLoopInvariantCodeMotionPass>();
+  PassRegistration<quir::PipelineShotLoopPass>();
+  PassRegistration<quir::AngleFoldingPass>();
   PassRegistration<quir::QuantumDecorationPass>();
   PassRegistration<quir::ReorderMeasurementsPass>();
+  PassRegistration<quir::FeedforwardSchedulingPass>();
+  PassRegistration<quir::GateCancellationPass>();
   PassRegistration<quir::ReorderCircuitsPass>();
   PassRegistration<quir::MergeCircuitsPass>();
   PassRegistration<quir::ExtractCircuitsPass>();
+  PassRegistration<quir::DeduplicateCircuitsPass>();
   PassRegistration<quir::MergeCircuitMeasuresTopologicalPass>();
   PassRegistration<quir::MergeMeasuresLexographicalPass>();
   PassRegistration<quir::MergeMeasuresTopologicalPass>();
+  PassRegistration<quir::ParallelControlFlowPass>();
+  PassRegistration<quir::MinimizeSynchronizationPass>();
+  PassRegistration<quir::MergeDelaysPass>();
   PassRegistration<quir::QUIRAngleConversionPass>();
   PassRegistration<quir::LoadEliminationPass>();
   PassRegistration<quir::DumpVariableDominanceInfoPass>();
   PassRegistration<quir::VariableEliminationPass>();
   PassRegistration<quir::ConvertDurationUnitsPass>();
+  PassRegistration<quir::UnrollLoopsPass>();
 
   //===----------------------------------------------------------------------===//
   // Test Passes
@@ -311,8 +395,13 @@ void registerQuirPasses() {
 }
 
 void registerQuirPassPipeline() {
-  PassPipelineRegistration<> const pipeline(
+  PassPipelineRegistration<QUIRPipelineOptions> const pipeline(
       "quirOpt", "Enable QUIR-specific optimizations",
       quir::quirPassPipelineBuilder);
+  PassPipelineRegistration<QUIRPipelineOptions> const parallelPipeline(
+      "quirOpt-parallel",
+      "Enable QUIR-specific optimizations, running them on each function and "
+      "circuit in parallel",
+      quir::quirParallelPassPipelineBuilder);
 }
 } // end namespace mlir::quir
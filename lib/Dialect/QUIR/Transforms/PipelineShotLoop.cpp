@@ -0,0 +1,130 @@
+//===- PipelineShotLoop.cpp - Overlap shot post-processing ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for overlapping the classical handling of
+///  the results of a shot with the next shot.
+///
+///  The body of a shot loop is split into its head, which ends with the last
+///  operation that is not purely classical, and the post-processing after
+///  it. As the post-processing of shot i runs concurrently with the head of
+///  shot i+1, it must neither write classical state the head accesses nor
+///  read classical state the head writes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/PipelineShotLoop.h"
+
+#include "Dialect/QCS/IR/QCSAttributes.h"
+#include "Dialect/QCS/IR/QCSDialect.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/Transforms/ClassicalAccesses.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+/// Wrap the post-processing at the end of the body of shotLoop in a
+/// qcs.shot_post_process op, returns whether it was wrapped
+bool pipelineShotLoop(scf::ForOp shotLoop) {
+  // values carried across the shots order them
+  if (shotLoop.getNumRegionIterArgs() != 0)
+    return false;
+
+  Block *body = shotLoop.getBody();
+  Operation *terminator = body->getTerminator();
+
+  // the longest run of classical ops before the terminator
+  ClassicalAccesses postAccesses;
+  Operation *postBegin = terminator;
+  while (Operation *prevOp = postBegin->getPrevNode()) {
+    ClassicalAccesses opAccesses;
+    if (failed(collectClassicalAccesses(prevOp, /*allowQuantum=*/false,
+                                        opAccesses)))
+      break;
+    postAccesses.merge(opAccesses);
+    postBegin = prevOp;
+  }
+  // there is nothing to overlap with, or nothing to overlap
+  if (postBegin == terminator || postBegin == &body->front())
+    return false;
+
+  ClassicalAccesses headAccesses;
+  for (Operation &op :
+       llvm::make_range(body->begin(), postBegin->getIterator()))
+    if (failed(collectClassicalAccesses(&op, /*allowQuantum=*/true,
+                                        headAccesses)))
+      return false;
+  if (!postAccesses.isIndependentOf(headAccesses))
+    return false;
+
+  OpBuilder builder(terminator);
+  auto postProcessOp =
+      builder.create<qcs::ShotPostProcessOp>(postBegin->getLoc());
+  qcs::ShotPostProcessOp::ensureTerminator(postProcessOp.getRegion(), builder,
+                                           postBegin->getLoc());
+  Operation *postTerminator =
+      postProcessOp.getRegion().front().getTerminator();
+  for (Operation &op : llvm::make_early_inc_range(llvm::make_range(
+           postBegin->getIterator(), postProcessOp->getIterator())))
+    op.moveBefore(postTerminator);
+  return true;
+}
+
+} // anonymous namespace
+
+void PipelineShotLoopPass::runOnOperation() {
+  SmallVector<scf::ForOp> shotLoops;
+  getOperation()->walk([&](scf::ForOp forOp) {
+    if (forOp->hasAttr(qcs::getShotLoopAttrName()))
+      shotLoops.push_back(forOp);
+  });
+
+  for (auto shotLoop : shotLoops)
+    if (pipelineShotLoop(shotLoop))
+      ++numPipelinedLoops;
+} // PipelineShotLoopPass::runOnOperation
+
+void PipelineShotLoopPass::getDependentDialects(
+    DialectRegistry &registry) const {
+  registry.insert<qcs::QCSDialect>();
+}
+
+llvm::StringRef PipelineShotLoopPass::getArgument() const {
+  return "quir-pipeline-shot-loop";
+}
+
+llvm::StringRef PipelineShotLoopPass::getDescription() const {
+  return "Wrap the classical handling of the results at the end of each shot "
+         "in a qcs.shot_post_process op, which targets may overlap with the "
+         "next shot";
+}
+
+llvm::StringRef PipelineShotLoopPass::getName() const {
+  return "Pipeline Shot Loop Pass";
+}
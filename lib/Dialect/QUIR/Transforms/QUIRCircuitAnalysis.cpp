@@ -1,6 +1,6 @@
 //===- QUIRCircuitsAnalsysis.cpp - Cache values for circuits ----*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -35,9 +35,8 @@
 #include "llvm/Support/Error.h"
 
 #include <cassert>
-#include <map>
+#include <optional>
 #include <sys/types.h>
-#include <unordered_map>
 #include <utility>
 
 using namespace mlir;
@@ -49,6 +48,9 @@ parameterValToDouble(mlir::qcs::ParameterLoadOp defOp,
                      mlir::qcs::ParameterInitialValueAnalysis *nameAnalysis) {
   assert(nameAnalysis &&
          "A valid ParameterInitialValueAnalysis pointer is required");
+  if (auto slot = nameAnalysis->getSlot(defOp))
+    return std::get<double>(nameAnalysis->getValue(*slot));
+  // reports the undeclared parameter
   return std::get<double>(defOp.getInitialValue(nameAnalysis->getNames()));
 }
 
@@ -77,9 +79,8 @@ angleValToDouble(mlir::Value inVal,
           argNum, mlir::quir::getAngleAttrName());
       return argAttr.getValue().convertToDouble();
     }
-    auto parentModuleOp = circuitOp->getParentOfType<mlir::ModuleOp>();
     return std::get<QUIRCircuitAnalysisEntry::ANGLE>(
-        circuitAnalysis->getAnalysisMap()[parentModuleOp][circuitOp][argNum]);
+        circuitAnalysis->getCircuitOperands(circuitOp).lookup(argNum));
   }
 
   if (auto castOp = inVal.getDefiningOp<mlir::oq3::CastOp>()) {
@@ -114,8 +115,9 @@ double QUIRCircuitAnalysis::getAngleValue(
   return *valueOrError;
 }
 
-llvm::StringRef QUIRCircuitAnalysis::getParameterName(mlir::Value operand) {
-  llvm::StringRef parameterName = {};
+namespace {
+// the parameter load defining operand, directly or through a cast
+qcs::ParameterLoadOp getParameterLoad(mlir::Value operand) {
   qcs::ParameterLoadOp parameterLoad;
   parameterLoad = dyn_cast<qcs::ParameterLoadOp>(operand.getDefiningOp());
 
@@ -125,6 +127,13 @@ llvm::StringRef QUIRCircuitAnalysis::getParameterName(mlir::Value operand) {
       parameterLoad =
           dyn_cast<qcs::ParameterLoadOp>(castOp.getArg().getDefiningOp());
   }
+  return parameterLoad;
+}
+} // anonymous namespace
+
+llvm::StringRef QUIRCircuitAnalysis::getParameterName(mlir::Value operand) {
+  llvm::StringRef parameterName = {};
+  auto parameterLoad = getParameterLoad(operand);
 
   if (parameterLoad &&
       parameterLoad->hasAttr(mlir::quir::getInputParameterAttrName())) {
@@ -134,6 +143,13 @@ llvm::StringRef QUIRCircuitAnalysis::getParameterName(mlir::Value operand) {
   return parameterName;
 }
 
+std::optional<mlir::qcs::ParameterSlot>
+QUIRCircuitAnalysis::getParameterSlot(mlir::Value operand) {
+  if (auto parameterLoad = getParameterLoad(operand))
+    return nameAnalysis.getSlot(parameterLoad);
+  return std::nullopt;
+}
+
 quir::DurationAttr QUIRCircuitAnalysis::getDuration(mlir::Value operand) {
   quir::DurationAttr duration;
   auto constantOp = dyn_cast<quir::ConstantOp>(operand.getDefiningOp());
@@ -143,81 +159,124 @@ quir::DurationAttr QUIRCircuitAnalysis::getDuration(mlir::Value operand) {
   return duration;
 }
 
-QUIRCircuitAnalysis::QUIRCircuitAnalysis(mlir::Operation *moduleOp,
+mlir::qcs::ParameterInitialValueAnalysis &
+QUIRCircuitAnalysis::lookupNameAnalysis_(mlir::Operation *op,
                                          AnalysisManager &am) {
-
-  if (not invalid_)
-    return;
-
-  bool runGetAnalysis = true;
-
-  mlir::qcs::ParameterInitialValueAnalysis *nameAnalysis;
-  auto topLevelModuleOp = moduleOp->getParentOfType<ModuleOp>();
+  auto topLevelModuleOp = op->getParentOfType<ModuleOp>();
   if (topLevelModuleOp) {
     auto nameAnalysisOptional =
         am.getCachedParentAnalysis<mlir::qcs::ParameterInitialValueAnalysis>(
-            moduleOp->getParentOfType<ModuleOp>());
-    if (nameAnalysisOptional.has_value()) {
-      nameAnalysis = &nameAnalysisOptional.value().get();
-      runGetAnalysis = false;
-    }
+            topLevelModuleOp);
+    if (nameAnalysisOptional.has_value())
+      return nameAnalysisOptional.value().get();
   }
+  return am.getAnalysis<mlir::qcs::ParameterInitialValueAnalysis>();
+}
 
-  if (runGetAnalysis)
-    nameAnalysis = &am.getAnalysis<mlir::qcs::ParameterInitialValueAnalysis>();
-
-  std::unordered_map<mlir::Operation *, std::map<llvm::StringRef, Operation *>>
-      circuitOps;
+QUIRCircuitAnalysis::QUIRCircuitAnalysis(mlir::Operation *moduleOp,
+                                         AnalysisManager &am)
+    : nameAnalysis(lookupNameAnalysis_(moduleOp, am)), rootOp(moduleOp) {
 
-  moduleOp->walk([&](CircuitOp circuitOp) {
-    circuitOps[circuitOp->getParentOfType<ModuleOp>()][circuitOp.getSymName()] =
-        circuitOp.getOperation();
-  });
+  moduleOp->walk([&](CircuitOp circuitOp) { addCircuit_(circuitOp); });
 
   moduleOp->walk([&](CallCircuitOp callCircuitOp) {
-    auto search = circuitOps[callCircuitOp->getParentOfType<ModuleOp>()].find(
-        callCircuitOp.getCalleeAttr().getValue());
-
-    if (search ==
-        circuitOps[callCircuitOp->getParentOfType<ModuleOp>()].end()) {
+    auto *circuitOp = lookupCallee_(callCircuitOp);
+    if (!circuitOp) {
       callCircuitOp->emitOpError("Could not find circuit.");
       return;
     }
+    collectOperands_(callCircuitOp, circuitOp);
+  });
 
-    auto circuitOp = dyn_cast<CircuitOp>(search->second);
-    auto parentModuleOp = circuitOp->getParentOfType<ModuleOp>();
+  // circuits are only marked dirty by invalidateCircuit()
+  dirtyCircuits.clear();
+  invalid_ = false;
+}
+
+CircuitAnalysisMap &QUIRCircuitAnalysis::getAnalysisMap() {
+  refreshDirtyCircuits_();
+  return circuitOperands;
+}
+
+const CircuitOperandMap &
+QUIRCircuitAnalysis::getCircuitOperands(mlir::Operation *circuitOp) {
+  refreshDirtyCircuits_();
+  auto *parentModuleOp = circuitModules.lookup(circuitOp);
+  if (!parentModuleOp)
+    parentModuleOp = circuitOp->getParentOfType<ModuleOp>();
+  return circuitOperands[parentModuleOp][circuitOp];
+}
+
+void QUIRCircuitAnalysis::invalidateCircuit(mlir::Operation *circuitOp) {
+  if (circuitModules.count(circuitOp))
+    dirtyCircuits.insert(circuitOp);
+}
+
+void QUIRCircuitAnalysis::addCircuit_(mlir::Operation *circuitOp) {
+  auto *parentModuleOp = circuitOp->getParentOfType<ModuleOp>().getOperation();
+  auto symName = cast<CircuitOp>(circuitOp).getSymNameAttr();
+  circuitsByName[{parentModuleOp, symName}] = circuitOp;
+  circuitModules[circuitOp] = parentModuleOp;
+  dirtyCircuits.insert(circuitOp);
+}
+
+mlir::Operation *QUIRCircuitAnalysis::lookupCallee_(CallCircuitOp callOp) {
+  auto *parentModuleOp = callOp->getParentOfType<ModuleOp>().getOperation();
+  return circuitsByName.lookup(
+      {parentModuleOp, callOp.getCalleeAttr().getAttr()});
+}
+
+void QUIRCircuitAnalysis::collectOperands_(CallCircuitOp callCircuitOp,
+                                           mlir::Operation *circuitOp) {
+  auto &operands = circuitOperands[circuitModules.lookup(circuitOp)][circuitOp];
 
-    for (uint ii = 0; ii < callCircuitOp.getOperands().size(); ++ii) {
+  for (uint ii = 0; ii < callCircuitOp.getOperands().size(); ++ii) {
 
-      double value = 0;
-      llvm::StringRef parameterName = {};
-      quir::DurationAttr duration;
+    double value = 0;
+    llvm::StringRef parameterName = {};
+    quir::DurationAttr duration;
+    std::optional<mlir::qcs::ParameterSlot> parameterSlot;
 
-      auto operand = callCircuitOp.getOperands()[ii];
+    auto operand = callCircuitOp.getOperands()[ii];
 
-      // cache angle values and parameter names
-      if (auto angType = operand.getType().dyn_cast<quir::AngleType>()) {
+    // cache angle values and parameter names
+    if (auto angType = operand.getType().dyn_cast<quir::AngleType>()) {
 
-        value = getAngleValue(operand, nameAnalysis);
-        parameterName = getParameterName(operand);
-        circuitOperands[parentModuleOp][circuitOp][ii] = {value, parameterName,
-                                                          duration};
-      }
+      value = getAngleValue(operand, &nameAnalysis);
+      parameterName = getParameterName(operand);
+      parameterSlot = getParameterSlot(operand);
+      operands[ii] = {value, parameterName, duration, parameterSlot};
+    }
 
-      // cache durations
-      if (auto durType = operand.getType().dyn_cast<quir::DurationType>()) {
+    // cache durations
+    if (auto durType = operand.getType().dyn_cast<quir::DurationType>()) {
 
-        duration = getDuration(operand);
-        circuitOperands[parentModuleOp][circuitOp][ii] = {value, parameterName,
-                                                          duration};
-      }
+      duration = getDuration(operand);
+      operands[ii] = {value, parameterName, duration, parameterSlot};
     }
+  }
+}
+
+void QUIRCircuitAnalysis::refreshDirtyCircuits_() {
+  if (dirtyCircuits.empty())
+    return;
+
+  for (auto *circuitOp : dirtyCircuits)
+    circuitOperands[circuitModules.lookup(circuitOp)].erase(circuitOp);
+
+  // a single walk over the calls recomputes all dirty circuits, in the same
+  // order as the initial build such that the last call of a circuit wins
+  rootOp->walk([&](CallCircuitOp callCircuitOp) {
+    auto *circuitOp = lookupCallee_(callCircuitOp);
+    if (circuitOp && dirtyCircuits.contains(circuitOp))
+      collectOperands_(callCircuitOp, circuitOp);
   });
-  invalid_ = false;
+  dirtyCircuits.clear();
 }
 
 void QUIRCircuitAnalysisPass::runOnOperation() {
   mlir::Pass::getAnalysis<QUIRCircuitAnalysis>();
+  markAllAnalysesPreserved();
 } // ParameterInitialValueAnalysisPass::runOnOperation()
 
 llvm::StringRef QUIRCircuitAnalysisPass::getArgument() const {
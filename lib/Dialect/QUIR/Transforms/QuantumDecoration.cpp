@@ -1,6 +1,6 @@
 //===- QuantumDecoration.cpp - Add quantum attributes -----------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,34 +23,53 @@
 
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Transforms/QUIRCircuitAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
-#include <algorithm>
-#include <unordered_set>
+#include <cstdint>
 #include <vector>
 
 using namespace mlir;
 using namespace mlir::quir;
 
-namespace {
-int lookupOrMinus1(Value arg) {
-  auto id = lookupQubitId(arg);
-  if (id)
-    return static_cast<int>(*id);
-  return -1;
+void QuantumDecorationPass::QubitIds::insert(Value qubit) {
+  if (auto id = lookupQubitId(qubit))
+    ids.insert(*id);
+  else
+    hasUnknown = true;
+}
+
+QuantumDecorationPass::QubitIds &
+QuantumDecorationPass::QubitIds::operator|=(const QubitIds &other) {
+  ids |= other.ids;
+  hasUnknown |= other.hasUnknown;
+  return *this;
+}
+
+ArrayAttr QuantumDecorationPass::QubitIds::getAttr(Builder &builder) const {
+  // the ids of a set are already in ascending order
+  std::vector<int32_t> qubitVec;
+  qubitVec.reserve(ids.size() + (hasUnknown ? 1 : 0));
+  if (hasUnknown)
+    qubitVec.push_back(-1);
+  for (uint32_t const id : ids)
+    qubitVec.push_back(static_cast<int32_t>(id));
+  return builder.getI32ArrayAttr(qubitVec);
 }
-} // end anonymous namespace
 
 void QuantumDecorationPass::processOp(Operation *op,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   if (auto castOp = dyn_cast<BuiltinCXOp>(op))
     processOp(castOp, retSet);
   else if (auto castOp = dyn_cast<Builtin_UOp>(op))
@@ -74,98 +93,120 @@ void QuantumDecorationPass::processOp(Operation *op,
 } // processOp Operation *
 
 void QuantumDecorationPass::processOp(Builtin_UOp builtinUOp,
-                                      std::unordered_set<int> &retSet) {
-  retSet.emplace(lookupOrMinus1(builtinUOp.getTarget()));
+                                      QubitIds &retSet) {
+  retSet.insert(builtinUOp.getTarget());
 } // processOp Builtin_UOp
 
 void QuantumDecorationPass::processOp(BuiltinCXOp builtinCXOp,
-                                      std::unordered_set<int> &retSet) {
-  retSet.emplace(lookupOrMinus1(builtinCXOp.getControl()));
-  retSet.emplace(lookupOrMinus1(builtinCXOp.getTarget()));
+                                      QubitIds &retSet) {
+  retSet.insert(builtinCXOp.getControl());
+  retSet.insert(builtinCXOp.getTarget());
 } // processOp BuiltinCXOp
 
 void QuantumDecorationPass::processOp(MeasureOp measureOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   for (auto qubit : measureOp.getQubits())
-    retSet.emplace(lookupOrMinus1(qubit));
+    retSet.insert(qubit);
 } // processOp MeasureOp
 
 void QuantumDecorationPass::processOp(CallDefcalMeasureOp measureOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(measureOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    retSet.insert(val);
 } // processOp MeasureOp
 
 void QuantumDecorationPass::processOp(DelayOp delayOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   for (auto qubit_operand : delayOp.getQubits())
-    retSet.emplace(lookupOrMinus1(qubit_operand));
+    retSet.insert(qubit_operand);
 } // processOp MeasureOp
 
 void QuantumDecorationPass::processOp(ResetQubitOp resetOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   for (auto qubit : resetOp.getQubits())
-    retSet.emplace(lookupOrMinus1(qubit));
+    retSet.insert(qubit);
 } // processOp MeasureOp
 
 void QuantumDecorationPass::processOp(CallDefCalGateOp callOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(callOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    retSet.insert(val);
 } // processOp CallGateOp
 
 void QuantumDecorationPass::processOp(CallGateOp callOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(callOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    retSet.insert(val);
 } // processOp CallGateOp
 
 void QuantumDecorationPass::processOp(BarrierOp barrierOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(barrierOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    retSet.insert(val);
 } // processOp BarrierOp
 
 void QuantumDecorationPass::processOp(CallCircuitOp callOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitIds &retSet) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(callOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    retSet.insert(val);
 } // processOp CallGateOp
 
+void QuantumDecorationPass::decorate(Operation *op, QubitIds &retSet) {
+  processOp(op, retSet);
+  if (op->getNumRegions() == 0)
+    return;
+
+  // the qubits of nested ops are collected once, bottom up, and added to the
+  // qubits of each enclosing op
+  if (!isa<scf::IfOp, scf::ForOp, quir::SwitchOp, quir::CircuitOp>(op)) {
+    for (auto &region : op->getRegions())
+      for (auto &block : region)
+        for (auto &nestedOp : block)
+          decorate(&nestedOp, retSet);
+    return;
+  }
+
+  QubitIds involvedQubits;
+  for (auto &region : op->getRegions())
+    for (auto &block : region)
+      for (auto &nestedOp : block)
+        decorate(&nestedOp, involvedQubits);
+  Builder build(op->getContext());
+  op->setAttr(mlir::quir::getPhysicalIdsAttrName(),
+              involvedQubits.getAttr(build));
+  retSet |= involvedQubits;
+} // decorate
+
 void QuantumDecorationPass::runOnOperation() {
-  ModuleOp const moduleOp = getOperation();
-  OpBuilder build(moduleOp);
-
-  moduleOp->walk([&](Operation *op) {
-    if (dyn_cast<scf::IfOp>(op) || dyn_cast<scf::ForOp>(op) ||
-        dyn_cast<quir::SwitchOp>(op) || dyn_cast<quir::CircuitOp>(op)) {
-      std::unordered_set<int> involvedQubits;
-      op->walk([&](Operation *subOp) { processOp(subOp, involvedQubits); });
-      std::vector<int> qubitVec;
-      qubitVec.reserve(involvedQubits.size());
-      qubitVec.insert(qubitVec.begin(), involvedQubits.begin(),
-                      involvedQubits.end());
-      std::sort(qubitVec.begin(), qubitVec.end());
-      op->setAttr(mlir::quir::getPhysicalIdsAttrName(),
-                  build.getI32ArrayAttr(ArrayRef<int>(qubitVec)));
-    }
+  ModuleOp moduleOp = getOperation();
+
+  // the functions and circuits of the module are decorated independently, in
+  // parallel unless threading is disabled for the context
+  llvm::SmallVector<Operation *> topLevelOps;
+  for (auto &op : moduleOp.getBody()->getOperations())
+    topLevelOps.push_back(&op);
+  mlir::parallelForEach(&getContext(), topLevelOps, [&](Operation *op) {
+    QubitIds involvedQubits;
+    decorate(op, involvedQubits);
   });
 
+  // only attributes are added, the operands of circuit calls are unchanged
+  markAnalysesPreserved<QUIRCircuitAnalysis>();
 } // runOnOperation
 
 llvm::StringRef QuantumDecorationPass::getArgument() const {
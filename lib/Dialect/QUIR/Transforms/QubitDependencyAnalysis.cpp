@@ -0,0 +1,518 @@
+//===- QubitDependencyAnalysis.cpp - Per-qubit operation chains -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements an analysis that tracks, per block, which operations
+/// act on which qubits, for passes that reorder and merge quantum operations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
+
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Region.h"
+#include "mlir/Interfaces/ControlFlowInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+// Spacing of the labels assigned when a block is built. Operations moved or
+// inserted between two others get the label in the middle of the gap.
+constexpr uint64_t labelStride = uint64_t(1) << 32;
+
+bool isQubitOp(Operation *op, const QubitSet &qubits) {
+  return !qubits.empty() || isQuantumOp(op) ||
+         op->hasTrait<RegionBranchOpInterface::Trait>();
+}
+} // anonymous namespace
+
+struct QubitDependencyAnalysis::Node {
+  Operation *op;
+  QubitSet qubits;
+  // adjacent qubit operations in the block
+  Node *prev = nullptr;
+  Node *next = nullptr;
+  // previous and next qubit operation acting on each of the qubits
+  llvm::SmallDenseMap<uint32_t, std::pair<Node *, Node *>, 4> links;
+};
+
+struct QubitDependencyAnalysis::BlockInfo {
+  llvm::DenseMap<Operation *, uint64_t> labels;
+  llvm::DenseMap<Operation *, std::unique_ptr<Node>> nodes;
+};
+
+QubitDependencyAnalysis::QubitDependencyAnalysis(Operation *op) {}
+
+QubitDependencyAnalysis::~QubitDependencyAnalysis() = default;
+
+void QubitDependencyAnalysis::invalidate() {
+  blocks.clear();
+  dirtyOps.clear();
+}
+
+QubitDependencyAnalysis::BlockInfo *
+QubitDependencyAnalysis::lookupBlockInfo_(Block *block) {
+  if (!block)
+    return nullptr;
+  auto search = blocks.find(block);
+  return search == blocks.end() ? nullptr : search->second.get();
+}
+
+QubitDependencyAnalysis::BlockInfo &
+QubitDependencyAnalysis::getBlockInfo_(Block *block) {
+  if (auto *info = lookupBlockInfo_(block))
+    return *info;
+
+  auto info = std::make_unique<BlockInfo>();
+  llvm::DenseMap<uint32_t, Node *> lastUsers;
+  Node *lastNode = nullptr;
+  uint64_t label = 0;
+  for (Operation &op : *block) {
+    label += labelStride;
+    info->labels[&op] = label;
+
+    QubitSet qubits = QubitOpInterface::getOperatedQubits(&op);
+    if (!isQubitOp(&op, qubits))
+      continue;
+
+    auto node = std::make_unique<Node>();
+    node->op = &op;
+    node->qubits = std::move(qubits);
+    node->prev = lastNode;
+    if (lastNode)
+      lastNode->next = node.get();
+    for (uint32_t const qubit : node->qubits) {
+      Node *&lastUser = lastUsers[qubit];
+      node->links[qubit] = {lastUser, nullptr};
+      if (lastUser)
+        lastUser->links[qubit].second = node.get();
+      lastUser = node.get();
+    }
+    lastNode = node.get();
+    info->nodes[&op] = std::move(node);
+  }
+
+  auto &entry = blocks[block];
+  entry = std::move(info);
+  return *entry;
+}
+
+QubitDependencyAnalysis::BlockInfo &
+QubitDependencyAnalysis::getTrackedInfo_(Operation *op) {
+  refreshDirtyOps_();
+  Block *block = op->getBlock();
+  auto &info = getBlockInfo_(block);
+  if (info.labels.count(op))
+    return info;
+  // op was added without the analysis being notified
+  blocks.erase(block);
+  return getBlockInfo_(block);
+}
+
+QubitDependencyAnalysis::Node *
+QubitDependencyAnalysis::findNode_(BlockInfo &info, Operation *op) {
+  auto search = info.nodes.find(op);
+  return search == info.nodes.end() ? nullptr : search->second.get();
+}
+
+bool QubitDependencyAnalysis::isBeforeInBlock(Operation *op,
+                                              Operation *other) {
+  if (op->getBlock() != other->getBlock())
+    return op->isBeforeInBlock(other);
+
+  auto *info = &getTrackedInfo_(op);
+  if (!info->labels.count(other)) {
+    blocks.erase(op->getBlock());
+    info = &getBlockInfo_(op->getBlock());
+  }
+  return info->labels.lookup(op) < info->labels.lookup(other);
+}
+
+const QubitSet &QubitDependencyAnalysis::getOperatedQubits(Operation *op) {
+  auto &info = getTrackedInfo_(op);
+  if (Node *node = findNode_(info, op))
+    return node->qubits;
+  return noQubits;
+}
+
+Operation *QubitDependencyAnalysis::getNextQubitOp(Operation *op) {
+  auto &info = getTrackedInfo_(op);
+  if (Node *node = findNode_(info, op))
+    return node->next ? node->next->op : nullptr;
+  for (Operation *nextOp = op->getNextNode(); nextOp;
+       nextOp = nextOp->getNextNode())
+    if (Node *node = findNode_(info, nextOp))
+      return node->op;
+  return nullptr;
+}
+
+Operation *QubitDependencyAnalysis::getPrevQubitOp(Operation *op) {
+  auto &info = getTrackedInfo_(op);
+  if (Node *node = findNode_(info, op))
+    return node->prev ? node->prev->op : nullptr;
+  for (Operation *prevOp = op->getPrevNode(); prevOp;
+       prevOp = prevOp->getPrevNode())
+    if (Node *node = findNode_(info, prevOp))
+      return node->op;
+  return nullptr;
+}
+
+Operation *QubitDependencyAnalysis::getNextQubitUser(Operation *op,
+                                                     uint32_t qubit) {
+  auto &info = getTrackedInfo_(op);
+  if (Node *node = findNode_(info, op)) {
+    auto search = node->links.find(qubit);
+    if (search != node->links.end())
+      return search->second.second ? search->second.second->op : nullptr;
+  }
+  for (Operation *nextOp = getNextQubitOp(op); nextOp;
+       nextOp = getNextQubitOp(nextOp))
+    if (getOperatedQubits(nextOp).contains(qubit))
+      return nextOp;
+  return nullptr;
+}
+
+Operation *QubitDependencyAnalysis::getPrevQubitUser(Operation *op,
+                                                     uint32_t qubit) {
+  auto &info = getTrackedInfo_(op);
+  if (Node *node = findNode_(info, op)) {
+    auto search = node->links.find(qubit);
+    if (search != node->links.end())
+      return search->second.first ? search->second.first->op : nullptr;
+  }
+  for (Operation *prevOp = getPrevQubitOp(op); prevOp;
+       prevOp = getPrevQubitOp(prevOp))
+    if (getOperatedQubits(prevOp).contains(qubit))
+      return prevOp;
+  return nullptr;
+}
+
+void QubitDependencyAnalysis::moveBefore(Operation *op, Operation *existingOp) {
+  refreshDirtyOps_();
+  Block *oldBlock = op->getBlock();
+  if (existingOp->getBlock() != oldBlock)
+    markEnclosingOpsDirty_(op);
+  op->moveBefore(existingOp);
+  updateMovedOp_(op, oldBlock);
+}
+
+void QubitDependencyAnalysis::moveAfter(Operation *op, Operation *existingOp) {
+  refreshDirtyOps_();
+  Block *oldBlock = op->getBlock();
+  if (existingOp->getBlock() != oldBlock)
+    markEnclosingOpsDirty_(op);
+  op->moveAfter(existingOp);
+  updateMovedOp_(op, oldBlock);
+}
+
+void QubitDependencyAnalysis::updateMovedOp_(Operation *op, Block *oldBlock) {
+  Block *block = op->getBlock();
+  if (block != oldBlock) {
+    markEnclosingOpsDirty_(op);
+    blocks.erase(oldBlock);
+    blocks.erase(block);
+    return;
+  }
+
+  auto *info = lookupBlockInfo_(block);
+  if (!info)
+    return;
+  if (!info->labels.count(op) || !assignLabel_(*info, op)) {
+    blocks.erase(block);
+    return;
+  }
+
+  Node *node = findNode_(*info, op);
+  if (!node)
+    return;
+  unlinkNode_(node);
+  linkNode_(*info, node);
+
+  // The qubit chains stay valid unless op was moved past an operation
+  // sharing one of its qubits
+  for (auto &[qubit, link] : node->links) {
+    bool const stillAfterPrev =
+        !link.first || info->labels.lookup(link.first->op) <
+                           info->labels.lookup(node->op);
+    bool const stillBeforeNext =
+        !link.second || info->labels.lookup(node->op) <
+                            info->labels.lookup(link.second->op);
+    if (!stillAfterPrev || !stillBeforeNext) {
+      unlinkQubits_(node);
+      linkQubits_(node);
+      break;
+    }
+  }
+}
+
+bool QubitDependencyAnalysis::assignLabel_(BlockInfo &info, Operation *op) {
+  Operation *prevOp = op->getPrevNode();
+  Operation *nextOp = op->getNextNode();
+
+  uint64_t lo = 0;
+  if (prevOp) {
+    auto search = info.labels.find(prevOp);
+    if (search == info.labels.end())
+      return false;
+    lo = search->second + 1;
+  }
+  if (!nextOp) {
+    info.labels[op] = lo + labelStride;
+    return true;
+  }
+  auto search = info.labels.find(nextOp);
+  if (search == info.labels.end())
+    return false;
+  uint64_t const hi = search->second;
+  if (lo < hi) {
+    info.labels[op] = lo + (hi - lo) / 2;
+    return true;
+  }
+  // no room left between the neighbors, the label is reassigned below
+  info.labels[op] = lo;
+  return relabelAround_(info, op);
+}
+
+bool QubitDependencyAnalysis::relabelAround_(BlockInfo &info, Operation *op) {
+  // Grow a window of operations around op, doubling its width until the
+  // labels of its neighbors leave room to spread the window out evenly.
+  // A window reaching the end of the block can always be spread out.
+  Operation *first = op;
+  Operation *last = op;
+  uint64_t count = 1;
+  for (uint64_t width = 1;; width *= 2) {
+    for (uint64_t i = 0; i < width && first->getPrevNode(); ++i, ++count)
+      first = first->getPrevNode();
+    for (uint64_t i = 0; i < width && last->getNextNode(); ++i, ++count)
+      last = last->getNextNode();
+
+    uint64_t lo = 0;
+    if (Operation *before = first->getPrevNode()) {
+      auto search = info.labels.find(before);
+      if (search == info.labels.end())
+        return false;
+      lo = search->second;
+    }
+
+    uint64_t spacing = labelStride;
+    if (Operation *after = last->getNextNode()) {
+      auto search = info.labels.find(after);
+      if (search == info.labels.end())
+        return false;
+      if (search->second <= lo)
+        continue;
+      spacing = (search->second - lo) / (count + 1);
+      if (spacing <= width)
+        continue;
+    }
+
+    uint64_t label = lo;
+    for (Operation *cur = first;; cur = cur->getNextNode()) {
+      auto search = info.labels.find(cur);
+      if (search == info.labels.end())
+        return false;
+      label += spacing;
+      search->second = label;
+      if (cur == last)
+        return true;
+    }
+  }
+}
+
+void QubitDependencyAnalysis::linkNode_(BlockInfo &info, Node *node) {
+  // search for the closest qubit operation in either direction
+  Operation *backOp = node->op->getPrevNode();
+  Operation *fwdOp = node->op->getNextNode();
+  Node *prev = nullptr;
+  Node *next = nullptr;
+  while (backOp || fwdOp) {
+    if (fwdOp) {
+      if (Node *found = findNode_(info, fwdOp)) {
+        next = found;
+        prev = found->prev;
+        break;
+      }
+      fwdOp = fwdOp->getNextNode();
+    }
+    if (backOp) {
+      if (Node *found = findNode_(info, backOp)) {
+        prev = found;
+        next = found->next;
+        break;
+      }
+      backOp = backOp->getPrevNode();
+    }
+  }
+
+  node->prev = prev;
+  node->next = next;
+  if (prev)
+    prev->next = node;
+  if (next)
+    next->prev = node;
+}
+
+void QubitDependencyAnalysis::unlinkNode_(Node *node) {
+  if (node->prev)
+    node->prev->next = node->next;
+  if (node->next)
+    node->next->prev = node->prev;
+  node->prev = nullptr;
+  node->next = nullptr;
+}
+
+void QubitDependencyAnalysis::linkQubits_(Node *node) {
+  // Search in both directions for the closest operation acting on each of
+  // the qubits, and splice node into the chain of that qubit next to it
+  node->links.clear();
+  QubitSet remaining = node->qubits;
+  Node *back = node->prev;
+  Node *fwd = node->next;
+  while (!remaining.empty() && (back || fwd)) {
+    if (back) {
+      for (uint32_t const qubit : back->qubits & remaining) {
+        auto &backLink = back->links[qubit];
+        Node *next = backLink.second;
+        node->links[qubit] = {back, next};
+        backLink.second = node;
+        if (next)
+          next->links[qubit].first = node;
+        remaining.erase(qubit);
+      }
+      back = back->prev;
+    }
+    if (fwd) {
+      for (uint32_t const qubit : fwd->qubits & remaining) {
+        auto &fwdLink = fwd->links[qubit];
+        Node *prev = fwdLink.first;
+        node->links[qubit] = {prev, fwd};
+        fwdLink.first = node;
+        if (prev)
+          prev->links[qubit].second = node;
+        remaining.erase(qubit);
+      }
+      fwd = fwd->next;
+    }
+  }
+  for (uint32_t const qubit : remaining)
+    node->links[qubit] = {nullptr, nullptr};
+}
+
+void QubitDependencyAnalysis::unlinkQubits_(Node *node) {
+  for (auto &[qubit, link] : node->links) {
+    if (link.first)
+      link.first->links[qubit].second = link.second;
+    if (link.second)
+      link.second->links[qubit].first = link.first;
+  }
+  node->links.clear();
+}
+
+void QubitDependencyAnalysis::markEnclosingOpsDirty_(Operation *op) {
+  // The qubits of the operations enclosing op change with it
+  for (Operation *parentOp = op->getParentOp(); parentOp;
+       parentOp = parentOp->getParentOp())
+    if (lookupBlockInfo_(parentOp->getBlock()))
+      dirtyOps.insert(parentOp);
+}
+
+void QubitDependencyAnalysis::refreshDirtyOps_() {
+  if (dirtyOps.empty())
+    return;
+
+  llvm::SmallVector<Operation *> const ops(dirtyOps.begin(), dirtyOps.end());
+  dirtyOps.clear();
+  for (Operation *op : ops) {
+    auto *info = lookupBlockInfo_(op->getBlock());
+    if (!info)
+      continue;
+    QubitSet qubits = QubitOpInterface::getOperatedQubits(op);
+    Node *node = findNode_(*info, op);
+    if (!node) {
+      if (isQubitOp(op, qubits))
+        blocks.erase(op->getBlock());
+      continue;
+    }
+    if (qubits == node->qubits)
+      continue;
+    unlinkQubits_(node);
+    node->qubits = std::move(qubits);
+    linkQubits_(node);
+  }
+}
+
+void QubitDependencyAnalysis::notifyOperationInserted(Operation *op) {
+  markEnclosingOpsDirty_(op);
+
+  Block *block = op->getBlock();
+  auto *info = lookupBlockInfo_(block);
+  if (!info)
+    return;
+  if (info->labels.count(op)) {
+    // an operation moved through a rewriter
+    updateMovedOp_(op, block);
+    return;
+  }
+  if (!assignLabel_(*info, op)) {
+    blocks.erase(block);
+    return;
+  }
+
+  QubitSet qubits = QubitOpInterface::getOperatedQubits(op);
+  if (!isQubitOp(op, qubits))
+    return;
+  auto node = std::make_unique<Node>();
+  node->op = op;
+  node->qubits = std::move(qubits);
+  linkNode_(*info, node.get());
+  linkQubits_(node.get());
+  info->nodes[op] = std::move(node);
+}
+
+void QubitDependencyAnalysis::notifyOperationRemoved(Operation *op) {
+  // the blocks and operations nested in op are destroyed with it
+  op->walk([&](Operation *nestedOp) {
+    dirtyOps.erase(nestedOp);
+    for (Region &region : nestedOp->getRegions())
+      for (Block &block : region)
+        blocks.erase(&block);
+  });
+  markEnclosingOpsDirty_(op);
+
+  auto *info = lookupBlockInfo_(op->getBlock());
+  if (!info)
+    return;
+  if (Node *node = findNode_(*info, op)) {
+    unlinkQubits_(node);
+    unlinkNode_(node);
+    info->nodes.erase(op);
+  }
+  info->labels.erase(op);
+}
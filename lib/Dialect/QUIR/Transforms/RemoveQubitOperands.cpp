@@ -111,6 +111,10 @@ void RemoveQubitOperandsPass::processCallOp(Operation *op) {
       SymbolTable::lookupSymbolIn(moduleOperation, callOp.getCallee());
   auto funcOp = dyn_cast<mlir::func::FuncOp>(findOp);
 
+  // generic subroutines keep taking their qubits as arguments
+  if (funcOp && funcOp->hasAttr(getDynamicQubitsAttrName()))
+    return;
+
   if (!qIndicesBV.empty()) // some qubit args
     callOp->eraseOperands(qIndicesBV);
 
@@ -22,9 +22,10 @@
 
 #include "Dialect/QUIR/IR/QUIROps.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
-#include "llvm/ADT/StringSet.h"
 #include <mlir/IR/Operation.h>
 
 using namespace mlir;
@@ -33,19 +34,43 @@ using namespace mlir::quir;
 void RemoveUnusedCircuitsPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
-  llvm::StringSet<> calledCircuits;
+  // A single walk indexes the circuits, the number of calls to each circuit
+  // and the circuits called within each circuit
+  llvm::StringMap<CircuitOp> circuits;
+  llvm::StringMap<unsigned> numCalls;
+  llvm::DenseMap<Operation *, llvm::SmallVector<llvm::StringRef>> callees;
 
-  moduleOperation->walk([&](CallCircuitOp callCircuitOp) {
-    calledCircuits.insert(callCircuitOp.getCallee());
+  moduleOperation->walk([&](Operation *op) {
+    if (auto circuitOp = dyn_cast<CircuitOp>(op)) {
+      circuits[circuitOp.getSymName()] = circuitOp;
+      return;
+    }
+    auto callCircuitOp = dyn_cast<CallCircuitOp>(op);
+    if (!callCircuitOp)
+      return;
+    numCalls[callCircuitOp.getCallee()] += 1;
+    if (auto parentCircuitOp = op->getParentOfType<CircuitOp>())
+      callees[parentCircuitOp].push_back(callCircuitOp.getCallee());
   });
 
-  llvm::SmallVector<Operation *> eraseList;
+  // Removing a circuit drops its calls, which may leave further circuits
+  // unused. These are found through the index rather than by walking the
+  // module again.
+  llvm::SmallVector<CircuitOp> workList;
+  for (auto &circuit : circuits)
+    if (!numCalls.lookup(circuit.getKey()))
+      workList.push_back(circuit.getValue());
 
-  moduleOperation->walk([&](CircuitOp circuitOp) {
-    auto search = calledCircuits.find(circuitOp.getSymName());
-    if (search == calledCircuits.end())
-      eraseList.push_back(circuitOp.getOperation());
-  });
+  llvm::SmallVector<Operation *> eraseList;
+  while (!workList.empty()) {
+    CircuitOp const circuitOp = workList.pop_back_val();
+    eraseList.push_back(circuitOp.getOperation());
+    for (auto callee : callees.lookup(circuitOp.getOperation())) {
+      auto search = circuits.find(callee);
+      if (--numCalls[callee] == 0 && search != circuits.end())
+        workList.push_back(search->getValue());
+    }
+  }
 
   for (auto *op : eraseList)
     op->erase();
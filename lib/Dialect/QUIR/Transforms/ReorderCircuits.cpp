@@ -1,6 +1,6 @@
 //===- ReorderCircuits.cpp - Move call_circuits ops later -------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -20,24 +20,39 @@
 
 #include "Dialect/QUIR/Transforms/ReorderCircuits.h"
 
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 #include "Dialect/QUIR/Utils/Utils.h"
+#include "Utils/CompileBudget.h"
 
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
-#include <set>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
 #include <sys/types.h>
 #include <utility>
+#include <vector>
 
 #define DEBUG_TYPE "QUIRReorderMeasurements"
 
@@ -57,10 +72,10 @@ struct ReorderCircuitsAndNonCircuitPat
   LogicalResult matchAndRewrite(CallCircuitOp callCircuitOp,
                                 PatternRewriter &rewriter) const override {
 
-    // Accumulate qubits in measurement set
-    std::set<uint> const currQubits = callCircuitOp.getOperatedQubits();
     LLVM_DEBUG(llvm::dbgs() << "Matching on call_circuit for qubits:\t");
-    LLVM_DEBUG(for (const uint id : currQubits) llvm::dbgs() << id << " ");
+    LLVM_DEBUG(for (const uint id : callCircuitOp.getOperatedQubits()) {
+      llvm::dbgs() << id << " ";
+    });
     LLVM_DEBUG(llvm::dbgs() << "\n");
 
     auto nextAffineStoreOpp =
@@ -79,13 +94,215 @@ struct ReorderCircuitsAndNonCircuitPat
     return failure();
   } // matchAndRewrite
 };  // struct ReorderCircuitsAndNonCircuitPat
+
+enum class NodeKind { Classical, Memory, Quantum, Circuit };
+
+struct ScheduleNode {
+  Operation *op;
+  NodeKind kind;
+  QubitSet qubits;
+  llvm::SmallVector<unsigned> successors;
+  unsigned numPredecessors = 0;
+  // the number of quantum operations on the longest path from this node
+  unsigned criticalPath = 0;
+  // the latest run of adjacent call_circuits this node depends on, 0 if none
+  unsigned run = 0;
+};
+
+// the kind of the schedule node of op, none if op may not be reordered
+std::optional<NodeKind> classifyOp(Operation *op, QubitSet &qubits) {
+  if (op->getNumRegions() != 0 || op->hasTrait<OpTrait::IsTerminator>())
+    return std::nullopt;
+  if (isa<QubitOpInterface>(op) || isQuantumOp(op)) {
+    qubits = QubitOpInterface::getOperatedQubits(op);
+    // the operation may act on any qubit
+    if (qubits.empty())
+      return std::nullopt;
+    return isa<CallCircuitOp>(op) ? NodeKind::Circuit : NodeKind::Quantum;
+  }
+  if (isMemoryEffectFree(op))
+    return NodeKind::Classical;
+
+  // classical reads and writes are ordered among each other only, as the
+  // default mode moves affine stores across call_circuits
+  auto effectInterface = dyn_cast<MemoryEffectOpInterface>(op);
+  if (!effectInterface)
+    return std::nullopt;
+  llvm::SmallVector<MemoryEffects::EffectInstance> effects;
+  effectInterface.getEffects(effects);
+  if (llvm::all_of(effects, [](const MemoryEffects::EffectInstance &effect) {
+        return isa<MemoryEffects::Read, MemoryEffects::Write>(
+            effect.getEffect());
+      }))
+    return NodeKind::Memory;
+  return std::nullopt;
+}
+
+// List schedule the operations of a segment of a block, which are moved in
+// front of insertPoint in their new order. Ready call_circuits are emitted as
+// long as there are any, the ones with the longest critical path first, such
+// that MergeCircuitsPass finds them adjacent. Classical operations depending
+// on the current run of call_circuits are deferred until the run ends, as they
+// would keep the circuits of the run from being merged with the following
+// ones.
+void scheduleSegment(std::vector<ScheduleNode> &nodes, Block *block,
+                     Block::iterator insertPoint) {
+  if (llvm::count_if(nodes, [](const ScheduleNode &node) {
+        return node.kind == NodeKind::Circuit;
+      }) < 2)
+    return;
+
+  llvm::DenseMap<Operation *, unsigned> indices;
+  for (const auto &[index, node] : llvm::enumerate(nodes))
+    indices[node.op] = index;
+
+  auto addEdge = [&](unsigned from, unsigned to) {
+    nodes[from].successors.push_back(to);
+    nodes[to].numPredecessors += 1;
+  };
+  llvm::DenseMap<uint32_t, unsigned> lastQubitUsers;
+  std::optional<unsigned> lastMemoryOp;
+  for (unsigned index = 0; index < nodes.size(); ++index) {
+    ScheduleNode &node = nodes[index];
+    for (auto operand : node.op->getOperands()) {
+      auto search = indices.find(operand.getDefiningOp());
+      if (search != indices.end())
+        addEdge(search->second, index);
+    }
+    for (uint32_t const qubit : node.qubits) {
+      auto [search, inserted] = lastQubitUsers.try_emplace(qubit, index);
+      if (!inserted) {
+        addEdge(search->second, index);
+        search->second = index;
+      }
+    }
+    if (node.kind == NodeKind::Memory) {
+      if (lastMemoryOp)
+        addEdge(*lastMemoryOp, index);
+      lastMemoryOp = index;
+    }
+  }
+
+  // the original order is topological
+  for (unsigned index = nodes.size(); index-- > 0;) {
+    ScheduleNode &node = nodes[index];
+    unsigned longestPath = 0;
+    for (unsigned const successor : node.successors)
+      longestPath = std::max(longestPath, nodes[successor].criticalPath);
+    bool const isQuantum =
+        node.kind == NodeKind::Quantum || node.kind == NodeKind::Circuit;
+    node.criticalPath = longestPath + (isQuantum ? 1 : 0);
+  }
+
+  // quantum operations by longest critical path, then in the original order
+  auto lowerPriority = [&](unsigned a, unsigned b) {
+    if (nodes[a].criticalPath != nodes[b].criticalPath)
+      return nodes[a].criticalPath < nodes[b].criticalPath;
+    return a > b;
+  };
+  using QuantumQueue = std::priority_queue<unsigned, std::vector<unsigned>,
+                                           decltype(lowerPriority)>;
+  QuantumQueue readyCircuits(lowerPriority);
+  QuantumQueue readyQuantum(lowerPriority);
+  // classical operations in the original order
+  std::priority_queue<unsigned, std::vector<unsigned>, std::greater<>>
+      readyClassical;
+  std::vector<unsigned> deferredClassical;
+
+  auto makeReady = [&](unsigned index) {
+    switch (nodes[index].kind) {
+    case NodeKind::Classical:
+    case NodeKind::Memory:
+      readyClassical.push(index);
+      break;
+    case NodeKind::Quantum:
+      readyQuantum.push(index);
+      break;
+    case NodeKind::Circuit:
+      readyCircuits.push(index);
+      break;
+    }
+  };
+  for (unsigned index = 0; index < nodes.size(); ++index)
+    if (nodes[index].numPredecessors == 0)
+      makeReady(index);
+
+  unsigned currentRun = 1;
+  bool runOpen = false;
+  auto emit = [&](unsigned index) {
+    ScheduleNode &node = nodes[index];
+    if (node.kind == NodeKind::Circuit) {
+      node.run = currentRun;
+      runOpen = true;
+    }
+    node.op->moveBefore(block, insertPoint);
+    for (unsigned const successor : node.successors) {
+      nodes[successor].run = std::max(nodes[successor].run, node.run);
+      if (--nodes[successor].numPredecessors == 0)
+        makeReady(successor);
+    }
+  };
+  auto endRun = [&]() {
+    if (!runOpen)
+      return;
+    currentRun += 1;
+    runOpen = false;
+    for (unsigned const index : deferredClassical)
+      readyClassical.push(index);
+    deferredClassical.clear();
+  };
+
+  while (true) {
+    if (!readyClassical.empty()) {
+      unsigned const index = readyClassical.top();
+      readyClassical.pop();
+      if (runOpen && nodes[index].run == currentRun)
+        deferredClassical.push_back(index);
+      else
+        emit(index);
+    } else if (!readyCircuits.empty()) {
+      unsigned const index = readyCircuits.top();
+      readyCircuits.pop();
+      emit(index);
+    } else if (!deferredClassical.empty()) {
+      endRun();
+    } else if (!readyQuantum.empty()) {
+      unsigned const index = readyQuantum.top();
+      readyQuantum.pop();
+      endRun();
+      emit(index);
+    } else {
+      break;
+    }
+  }
+} // scheduleSegment
+
+// Schedule the segments of block between operations which may not be
+// reordered, such as control flow
+void scheduleBlock(Block &block) {
+  std::vector<ScheduleNode> segment;
+  for (Operation &op : llvm::make_early_inc_range(block)) {
+    QubitSet qubits;
+    if (auto kind = classifyOp(&op, qubits)) {
+      segment.push_back({&op, *kind, std::move(qubits)});
+      continue;
+    }
+    scheduleSegment(segment, &block, Block::iterator(&op));
+    segment.clear();
+  }
+  scheduleSegment(segment, &block, block.end());
+}
 } // anonymous namespace
 
 void ReorderCircuitsPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
-  RewritePatternSet patterns(&getContext());
-  patterns.add<ReorderCircuitsAndNonCircuitPat>(&getContext());
+  // Calls left in their place are still correct, only fewer of them end up
+  // adjacent for MergeCircuits to merge
+  if (qssc::utils::shouldSkipOverBudget(moduleOperation, getArgument())) {
+    markAllAnalysesPreserved();
+    return;
+  }
 
   mlir::func::FuncOp mainFunc =
       dyn_cast<mlir::func::FuncOp>(getMainFunction(moduleOperation));
@@ -96,6 +313,18 @@ void ReorderCircuitsPass::runOnOperation() {
     return;
   }
 
+  if (schedule) {
+    // each block is scheduled once, in O(n log n) of its number of operations
+    llvm::SmallVector<Block *> blocks;
+    mainFunc->walk([&](Block *block) { blocks.push_back(block); });
+    for (Block *block : blocks)
+      scheduleBlock(*block);
+    return;
+  }
+
+  RewritePatternSet patterns(&getContext());
+  patterns.add<ReorderCircuitsAndNonCircuitPat>(&getContext());
+
   // only run this pass on call_circuits within the main body of the program
   // there may be call_circuits within circuits that have not been properly
   // labeled with their qubit arguments
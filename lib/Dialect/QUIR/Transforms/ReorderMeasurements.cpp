@@ -1,6 +1,6 @@
 //===- ReorderMeasurements.cpp - Move measurement ops later -----*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,7 +24,10 @@
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTraits.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
+#include "Utils/CompileBudget.h"
 
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Visitors.h"
@@ -34,13 +37,11 @@
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 
-#include <iterator>
-#include <set>
 #include <sys/types.h>
 #include <utility>
-#include <vector>
 
 #define DEBUG_TYPE "QUIRReorderMeasurements"
 
@@ -49,29 +50,44 @@ using namespace mlir::quir;
 
 namespace {
 
-using MoveListVec = std::vector<Operation *>;
+// the ops moved by a single pattern application, which are few
+using MoveListVec = llvm::SmallVector<Operation *, 8>;
 
 bool mayMoveVariableLoadOp(MeasureOp measureOp,
                            oq3::VariableLoadOp variableLoadOp,
-                           MoveListVec &moveList);
+                           MoveListVec &moveList,
+                           QubitDependencyAnalysis &deps);
 bool mayMoveCastOp(MeasureOp measureOp, oq3::CastOp castOp,
-                   MoveListVec &moveList);
+                   MoveListVec &moveList, QubitDependencyAnalysis &deps);
+
+// Same as nextQuantumOrControlFlowOrNull, skipping over the operations that
+// do not act on qubits with the analysis
+Operation *nextQuantumOrControlFlowOrNull(Operation *op,
+                                          QubitDependencyAnalysis &deps) {
+  Operation *nextOp = deps.getNextQubitOp(op);
+  while (nextOp && !isQuantumOp(nextOp) &&
+         !nextOp->hasTrait<::mlir::RegionBranchOpInterface::Trait>())
+    nextOp = deps.getNextQubitOp(nextOp);
+  return nextOp;
+}
 
 bool mayMoveVariableLoadOp(MeasureOp measureOp,
                            oq3::VariableLoadOp variableLoadOp,
-                           MoveListVec &moveList) {
+                           MoveListVec &moveList,
+                           QubitDependencyAnalysis &deps) {
   // find corresponding variable assign
   // move variableLoad if the assign is before the measure
   bool moveVariableLoadOp = true;
   auto *currentBlock = variableLoadOp->getBlock();
   currentBlock->walk([&](oq3::VariableAssignOp assignOp) {
     if (assignOp.getVariableName() == variableLoadOp.getVariableName()) {
-      moveVariableLoadOp = assignOp->isBeforeInBlock(measureOp);
+      moveVariableLoadOp = deps.isBeforeInBlock(assignOp, measureOp);
       if (!moveVariableLoadOp) {
         auto assignCastOp =
             dyn_cast<oq3::CastOp>(assignOp.getAssignedValue().getDefiningOp());
         if (assignCastOp)
-          moveVariableLoadOp = mayMoveCastOp(measureOp, assignCastOp, moveList);
+          moveVariableLoadOp =
+              mayMoveCastOp(measureOp, assignCastOp, moveList, deps);
       }
       return WalkResult::interrupt();
     }
@@ -83,16 +99,17 @@ bool mayMoveVariableLoadOp(MeasureOp measureOp,
 }
 
 bool mayMoveCastOp(MeasureOp measureOp, oq3::CastOp castOp,
-                   MoveListVec &moveList) {
+                   MoveListVec &moveList, QubitDependencyAnalysis &deps) {
   bool moveCastOp = false;
   auto variableLoadOp =
       dyn_cast<oq3::VariableLoadOp>(castOp.getArg().getDefiningOp());
   if (variableLoadOp)
-    moveCastOp = mayMoveVariableLoadOp(measureOp, variableLoadOp, moveList);
+    moveCastOp =
+        mayMoveVariableLoadOp(measureOp, variableLoadOp, moveList, deps);
   auto castMeasureOp = dyn_cast<MeasureOp>(castOp.getArg().getDefiningOp());
   if (castMeasureOp)
     moveCastOp = ((castMeasureOp != measureOp) &&
-                  (castMeasureOp->isBeforeInBlock(measureOp) ||
+                  (deps.isBeforeInBlock(castMeasureOp, measureOp) ||
                    castMeasureOp->getBlock() != castOp->getBlock()));
 
   if (moveCastOp)
@@ -105,8 +122,9 @@ bool mayMoveCastOp(MeasureOp measureOp, oq3::CastOp castOp,
 // non-measure op to occur earlier lexicographically if that does not change
 // the topological ordering
 struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
-  explicit ReorderMeasureAndNonMeasurePat(MLIRContext *ctx)
-      : OpRewritePattern<MeasureOp>(ctx) {}
+  ReorderMeasureAndNonMeasurePat(MLIRContext *ctx,
+                                 QubitDependencyAnalysis &deps)
+      : OpRewritePattern<MeasureOp>(ctx), deps(deps) {}
 
   LogicalResult matchAndRewrite(MeasureOp measureOp,
                                 PatternRewriter &rewriter) const override {
@@ -116,27 +134,26 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
 
     do {
       // Accumulate qubits in measurement set
-      std::set<uint> currQubits = measureOp.getOperatedQubits();
+      QubitSet currQubits = deps.getOperatedQubits(measureOp);
       LLVM_DEBUG(llvm::dbgs() << "Matching on measurement for qubits:\t");
       LLVM_DEBUG(for (const uint id : currQubits) llvm::dbgs() << id << " ");
       LLVM_DEBUG(llvm::dbgs() << "\n");
 
-      auto nextOpt = nextQuantumOrControlFlowOrNull(measureOp);
-      if (!nextOpt.has_value())
+      Operation *nextOp = nextQuantumOrControlFlowOrNull(measureOp, deps);
+      if (!nextOp)
         break;
 
-      Operation *nextOp = nextOpt.value();
       // for control flow ops, continue, but add the operated qubits of the
       // control flow block to the currQubits set
       while (nextOp->hasTrait<::mlir::RegionBranchOpInterface::Trait>()) {
         addQubitIdsFromAttr(nextOp, currQubits);
 
         // now find the next next op
-        auto nextNextOpt = nextQuantumOrControlFlowOrNull(nextOp);
-        if (!nextNextOpt.has_value()) // only move non-control-flow ops
+        auto *nextNextOp = nextQuantumOrControlFlowOrNull(nextOp, deps);
+        if (!nextNextOp) // only move non-control-flow ops
           break;
 
-        nextOp = nextNextOpt.value();
+        nextOp = nextNextOp;
       }
 
       // don't reorder past the next measurement or reset or control flow
@@ -145,8 +162,7 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
         break;
 
       // Check for overlap between currQubits and what's operated on by nextOp
-      std::set<uint> nextQubits = QubitOpInterface::getOperatedQubits(nextOp);
-      if (QubitOpInterface::qubitSetsOverlap(currQubits, nextQubits))
+      if (deps.getOperatedQubits(nextOp).overlaps(currQubits))
         break;
 
       moveList.clear();
@@ -158,7 +174,7 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
       for (auto operand : nextOp->getOperands())
         if (Operation *defOp = operand.getDefiningOp())
           if (defOp->getBlock() == measBlock &&
-              measureOp->isBeforeInBlock(defOp)) {
+              deps.isBeforeInBlock(measureOp, defOp)) {
 
             bool moveOps = false;
 
@@ -166,18 +182,18 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
             // the measurement
             auto variableLoadOp = dyn_cast<oq3::VariableLoadOp>(defOp);
             if (variableLoadOp) {
-              moveOps =
-                  mayMoveVariableLoadOp(measureOp, variableLoadOp, moveList);
+              moveOps = mayMoveVariableLoadOp(measureOp, variableLoadOp,
+                                              moveList, deps);
             }
 
             auto castOp = dyn_cast<oq3::CastOp>(defOp);
             if (castOp)
-              moveOps = mayMoveCastOp(measureOp, castOp, moveList);
+              moveOps = mayMoveCastOp(measureOp, castOp, moveList, deps);
 
             if (moveOps) {
               Operation *mbOp = measureOp.getOperation();
               for (auto op = moveList.rbegin(); op != moveList.rend(); ++op) {
-                (*op)->moveBefore(mbOp);
+                deps.moveBefore(*op, mbOp);
                 mbOp = *op;
               }
               continue;
@@ -194,13 +210,13 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
       LLVM_DEBUG(nextOp->dump());
       LLVM_DEBUG(llvm::dbgs() << "on qubits:\t");
       LLVM_DEBUG(for (const uint id // this is ugly but clang-format insists
-                      : QubitOpInterface::getOperatedQubits(nextOp)) {
+                      : deps.getOperatedQubits(nextOp)) {
         llvm::dbgs() << id << " ";
       });
       LLVM_DEBUG(llvm::dbgs() << "\n\n");
 
       // good to move the nextOp before the measureOp
-      nextOp->moveBefore(measureOp);
+      deps.moveBefore(nextOp, measureOp);
       anyMove = true;
     } while (true);
 
@@ -209,18 +225,33 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
 
     return failure();
   } // matchAndRewrite
-};  // struct ReorderMeasureAndNonMeasurePat
+
+private:
+  QubitDependencyAnalysis &deps;
+}; // struct ReorderMeasureAndNonMeasurePat
 } // anonymous namespace
 
 void ReorderMeasurementsPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
+  // Measurements left in their place are still correct but are merged into
+  // fewer simultaneous measurements, which only lengthens the schedule
+  if (qssc::utils::shouldSkipOverBudget(moduleOperation, getArgument())) {
+    markAllAnalysesPreserved();
+    return;
+  }
+
+  // Operation::isBeforeInBlock renumbers the whole block after every move,
+  // the analysis keeps an order and the qubit chains up to date instead
+  auto &deps = getAnalysis<QubitDependencyAnalysis>();
+
   RewritePatternSet patterns(&getContext());
-  patterns.add<ReorderMeasureAndNonMeasurePat>(&getContext());
+  patterns.add<ReorderMeasureAndNonMeasurePat>(&getContext(), deps);
 
   mlir::GreedyRewriteConfig config;
   // Disable to improve performance
   config.enableRegionSimplification = false;
+  config.listener = &deps;
 
   if (failed(applyPatternsAndFoldGreedily(moduleOperation, std::move(patterns),
                                           config)))
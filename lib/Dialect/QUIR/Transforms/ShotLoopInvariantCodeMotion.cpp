@@ -0,0 +1,180 @@
+//===- ShotLoopInvariantCodeMotion.cpp - Hoist out of shots -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for hoisting the classical setup which does
+///  not depend on shot results out of the shot loop.
+///
+///  Besides side effect free ops, QUIR and QCS ops are hoisted according to
+///  their side effects: ops with NonInterferingNonDeadSideEffect do not touch
+///  memory, but are kept alive as they act once per shot, e.g., measurements,
+///  gates and messages, and are hence never hoisted. The exceptions are
+///  qubit declarations, which act on no state, and parameter loads, since
+///  parameters do not change during an execution. Variables are hoisted if
+///  they are assigned the same value at the start of every shot.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/ShotLoopInvariantCodeMotion.h"
+
+#include "Dialect/OQ3/IR/OQ3Ops.h"
+#include "Dialect/QCS/IR/QCSAttributes.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Region.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Transforms/LoopInvariantCodeMotionUtils.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+
+using namespace mlir;
+
+namespace {
+
+// the variable an op reads or writes, if any
+StringRef getVariableName(Operation *op) {
+  if (auto nameAttr = op->getAttrOfType<FlatSymbolRefAttr>("variable_name"))
+    return nameAttr.getValue();
+  return {};
+}
+
+bool isVariableRead(Operation *op) {
+  return isa<oq3::VariableLoadOp, oq3::UseArrayElementOp>(op);
+}
+
+// The classical setup of one shot loop. Shot loops are assumed to run at
+// least one shot, such that variable assignments may be hoisted.
+class ShotLoopHoisting {
+public:
+  ShotLoopHoisting(scf::ForOp loop, const llvm::StringSet<> &sharedVariables)
+      : loop(loop), sharedVariables(sharedVariables) {
+    loop->walk([&](Operation *op) {
+      auto name = getVariableName(op);
+      if (!name.empty() && !isVariableRead(op))
+        ++numWrites[name];
+    });
+  }
+
+  size_t run() {
+    return moveLoopInvariantCode(
+        &loop.getRegion(),
+        [&](Value value, Region *) {
+          return loop.isDefinedOutsideOfLoop(value);
+        },
+        [&](Operation *op, Region *) { return shouldHoist(op); },
+        [&](Operation *op, Region *) {
+          if (isa<oq3::VariableAssignOp>(op))
+            --numWrites[getVariableName(op)];
+          loop.moveOutOfLoop(op);
+        });
+  }
+
+private:
+  bool shouldHoist(Operation *op) {
+    if (op->getNumRegions() != 0 || op->hasTrait<OpTrait::IsTerminator>())
+      return false;
+    if (isMemoryEffectFree(op) && isSpeculatable(op))
+      return true;
+    if (isa<quir::DeclareQubitOp, qcs::ParameterLoadOp>(op))
+      return true;
+
+    auto name = getVariableName(op);
+    if (name.empty() || sharedVariables.contains(name))
+      return false;
+    // the value of a variable which is not written in the loop is the same
+    // in every shot
+    if (isVariableRead(op))
+      return numWrites.lookup(name) == 0;
+    if (auto assignOp = dyn_cast<oq3::VariableAssignOp>(op))
+      return isShotInitialization(assignOp);
+    return false;
+  }
+
+  // whether assignOp is the only write of its variable in the loop and
+  // precedes all of its reads, such that every shot observes the same value
+  bool isShotInitialization(oq3::VariableAssignOp assignOp) {
+    auto name = assignOp.getVariableName();
+    if (numWrites.lookup(name) != 1)
+      return false;
+    Block *body = loop.getBody();
+    auto result = loop->walk([&](Operation *op) {
+      if (op == assignOp.getOperation() || getVariableName(op) != name)
+        return WalkResult::advance();
+      Operation *ancestor = body->findAncestorOpInBlock(*op);
+      if (!ancestor || ancestor->isBeforeInBlock(assignOp))
+        return WalkResult::interrupt();
+      return WalkResult::advance();
+    });
+    return !result.wasInterrupted();
+  }
+
+  scf::ForOp loop;
+  const llvm::StringSet<> &sharedVariables;
+  llvm::StringMap<unsigned> numWrites;
+};
+
+} // anonymous namespace
+
+namespace mlir::quir {
+
+void ShotLoopInvariantCodeMotionPass::runOnOperation() {
+  // inner shot loops are visited before the batch loops around them, such
+  // that hoisted ops may be hoisted further
+  SmallVector<scf::ForOp> shotLoops;
+  getOperation()->walk([&](scf::ForOp forOp) {
+    if (forOp->hasAttr(qcs::getShotLoopAttrName()) ||
+        forOp->hasAttr(qcs::getShotBatchLoopAttrName()))
+      shotLoops.push_back(forOp);
+  });
+
+  for (auto forOp : shotLoops) {
+    // variables accessed in other functions may be changed by calls in the
+    // loop
+    llvm::StringSet<> sharedVariables;
+    auto parentFunc = forOp->getParentOfType<func::FuncOp>();
+    getOperation()->walk([&](Operation *op) {
+      auto name = getVariableName(op);
+      if (!name.empty() && op->getParentOfType<func::FuncOp>() != parentFunc)
+        sharedVariables.insert(name);
+    });
+    ShotLoopHoisting(forOp, sharedVariables).run();
+  }
+} // runOnOperation
+
+llvm::StringRef ShotLoopInvariantCodeMotionPass::getArgument() const {
+  return "quir-shot-loop-licm";
+}
+
+llvm::StringRef ShotLoopInvariantCodeMotionPass::getDescription() const {
+  return "Hoist the classical setup which does not depend on shot results, "
+         "such as parameter loads, angle arithmetic and variable "
+         "initializations, out of the shot loop";
+}
+
+llvm::StringRef ShotLoopInvariantCodeMotionPass::getName() const {
+  return "Shot Loop Invariant Code Motion Pass";
+}
+
+} // namespace mlir::quir
@@ -1,6 +1,6 @@
 //===- SubroutineCloning.cpp - Resolve subroutine calls ---------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -88,23 +88,32 @@ auto SubroutineCloningPass::lookupQubitId(const Value val) -> int {
 } // lookupQubitId
 
 template <class CallLikeOp>
-auto SubroutineCloningPass::getMangledName(Operation *op) -> std::string {
+auto SubroutineCloningPass::getQubitIds(Operation *op) -> std::vector<int> {
   auto callOp = dyn_cast<CallLikeOp>(op);
-  std::string mangledName = callOp.getCallee().str();
 
   std::vector<Value> qOperands;
   qubitCallOperands(callOp, qOperands);
 
+  std::vector<int> qubitIds;
+  qubitIds.reserve(qOperands.size());
   for (Value const qArg : qOperands) {
     int const qId = SubroutineCloningPass::lookupQubitId(qArg);
     if (qId < 0) {
       callOp->emitOpError() << "Unable to resolve qubit ID for call\n";
       callOp->print(llvm::errs());
     }
-
-    mangledName += "_q" + std::to_string(qId);
+    qubitIds.push_back(qId);
   }
 
+  return qubitIds;
+} // getQubitIds
+
+auto SubroutineCloningPass::getMangledName(llvm::StringRef callee,
+                                           llvm::ArrayRef<int> qubitIds)
+    -> std::string {
+  std::string mangledName = callee.str();
+  for (int const qId : qubitIds)
+    mangledName += "_q" + std::to_string(qId);
   return mangledName;
 } // getMangledName
 
@@ -112,60 +121,114 @@ template <class CallLikeOp, class FuncLikeOp>
 void SubroutineCloningPass::processCallOp(Operation *op,
                                           SymbolCache &symbolCache) {
   auto callOp = dyn_cast<CallLikeOp>(op);
-  OpBuilder build(moduleOperation->getRegion(0));
 
   auto *findOp = symbolCache.getOpByName<Operation *>(callOp.getCallee());
-  if (findOp) {
-    std::vector<Value> qOperands;
-    qubitCallOperands(callOp, qOperands);
-
-    // first get the mangled name
-    std::string const mangledName = getMangledName<CallLikeOp>(callOp);
-    callOp->setAttr("callee",
-                    FlatSymbolRefAttr::get(&getContext(), mangledName));
-
-    // does the mangled function already exist?
-    if (symbolCache.contains(mangledName))
-      return;
-
-    // clone the func def with the new name
-    FuncLikeOp newFunc = cast<FuncLikeOp>(build.clone(*findOp));
-    newFunc->moveBefore(findOp);
-    clonedFuncs.emplace(findOp);
-    newFunc->setAttr(SymbolTable::getSymbolAttrName(),
-                     StringAttr::get(&getContext(), mangledName));
-
-    // add qubit ID attributes to all the arguments
-    for (uint ii = 0; ii < callOp.getOperands().size(); ++ii) {
-      if (callOp.getOperands()[ii].getType().template isa<QubitType>()) {
-        int const qId =
-            lookupQubitId(callOp.getOperands()[ii]); // copy qubitId from call
-        newFunc.setArgAttrs(
-            ii, ArrayRef({NamedAttribute(
-                    StringAttr::get(&getContext(),
-                                    mlir::quir::getPhysicalIdAttrName()),
-                    build.getI32IntegerAttr(qId))}));
-      }
-    }
-
-    // add calls within the new func def to the callWorkList
-    newFunc->walk([&](CallLikeOp op) { callWorkList.push_back(op); });
-
-    symbolCache.addCallee(newFunc);
-
-  } else { // matching function not found
+  if (!findOp) { // matching function not found
     callOp->emitOpError() << "No matching function def found for "
                           << callOp.getCallee() << "\n";
     return signalPassFailure();
   }
 
+  std::vector<int> const qubitIds = getQubitIds<CallLikeOp>(callOp);
+
+  // has this binding of the callee been specialized already?
+  auto &specialization = specializations[{findOp, qubitIds}];
+  if (specialization) {
+    callOp->setAttr("callee", specialization);
+    ++numReusedClones;
+    return;
+  }
+
+  // first get the mangled name
+  std::string const mangledName = getMangledName(callOp.getCallee(), qubitIds);
+  specialization = FlatSymbolRefAttr::get(&getContext(), mangledName);
+  callOp->setAttr("callee", specialization);
+
+  // does the mangled function already exist? It is reused without charging
+  // the clone budget, which reserveClone only does for new clones.
+  if (symbolCache.contains(mangledName))
+    return;
+
+  // over budget, keep calling the def that takes the qubits as arguments
+  if (!reserveClone(findOp)) {
+    specialization = FlatSymbolRefAttr::get(
+        &getContext(), SymbolTable::getSymbolName(findOp).getValue());
+    callOp->setAttr("callee", specialization);
+    keepGeneric<CallLikeOp>(findOp, symbolCache);
+    return;
+  }
+
+  // clone the func def with the new name
+  OpBuilder build(moduleOperation->getRegion(0));
+  FuncLikeOp newFunc = cast<FuncLikeOp>(build.clone(*findOp));
+  newFunc->moveBefore(findOp);
+  clonedFuncs.emplace(findOp);
+  newFunc->setAttr(SymbolTable::getSymbolAttrName(),
+                   StringAttr::get(&getContext(), mangledName));
+  ++numClones;
+
+  // add qubit ID attributes to all the arguments
+  auto qubitId = qubitIds.begin();
+  for (uint ii = 0; ii < callOp.getOperands().size(); ++ii) {
+    if (callOp.getOperands()[ii].getType().template isa<QubitType>()) {
+      int const qId = *qubitId++; // copy qubitId from call
+      newFunc.setArgAttrs(
+          ii, ArrayRef({NamedAttribute(
+                  StringAttr::get(&getContext(),
+                                  mlir::quir::getPhysicalIdAttrName()),
+                  build.getI32IntegerAttr(qId))}));
+    }
+  }
+
+  // add calls within the new func def to the callWorkList
+  newFunc->walk([&](CallLikeOp op) { callWorkList.push_back(op); });
+
+  symbolCache.addCallee(newFunc);
 } // processCallOp
 
+auto SubroutineCloningPass::reserveClone(Operation *funcOp) -> bool {
+  auto &[numFuncClones, numFuncOps] = cloneCounts[funcOp];
+  if (numFuncOps == 0)
+    funcOp->walk([&](Operation *) { ++numFuncOps; });
+
+  if (maxClonesPerCallee && numFuncClones >= maxClonesPerCallee)
+    return false;
+  if (maxClonedOps && clonedOps + numFuncOps > maxClonedOps)
+    return false;
+
+  ++numFuncClones;
+  clonedOps += numFuncOps;
+  return true;
+} // reserveClone
+
+template <class CallLikeOp>
+void SubroutineCloningPass::keepGeneric(Operation *funcOp,
+                                        SymbolCache &symbolCache) {
+  if (!genericFuncs.insert(funcOp).second)
+    return;
+
+  funcOp->setAttr(getDynamicQubitsAttrName(), UnitAttr::get(&getContext()));
+  ++numGenericFuncs;
+
+  // the qubits of the calls in a generic def are only known at runtime
+  // either, so their callees have to stay generic as well
+  funcOp->walk([&](CallLikeOp callOp) {
+    if (auto *calleeOp =
+            symbolCache.getOpByName<Operation *>(callOp.getCallee()))
+      keepGeneric<CallLikeOp>(calleeOp, symbolCache);
+  });
+} // keepGeneric
+
 // Entry point for the pass.
 void SubroutineCloningPass::runOnOperation() {
   moduleOperation = getOperation();
-  Operation *mainFunc = getMainFunction(moduleOperation);
+  auto &symbolCache = getAnalysis<qssc::utils::SymbolCacheAnalysis>();
+  Operation *mainFunc = symbolCache.getMainFunction();
   callWorkList.clear();
+  specializations.clear();
+  cloneCounts.clear();
+  clonedOps = 0;
+  genericFuncs.clear();
 
   if (!mainFunc) {
     llvm::errs() << "No main function found, cannot clone subroutines!\n";
@@ -174,8 +237,6 @@ void SubroutineCloningPass::runOnOperation() {
 
   mainFunc->walk([&](CallSubroutineOp op) { callWorkList.push_back(op); });
 
-  auto &symbolCache = getAnalysis<qssc::utils::SymbolCacheAnalysis>();
-
   if (!callWorkList.empty())
     symbolCache.addToCache<mlir::func::FuncOp>();
 
@@ -198,9 +259,14 @@ void SubroutineCloningPass::runOnOperation() {
     processCallOp<CallCircuitOp, CircuitOp>(op, symbolCache);
   }
 
-  // All subroutine defs that have been cloned are no longer needed
+  // All subroutine defs that have been cloned are no longer needed, unless
+  // they are still called for qubits only known at runtime
   for (Operation *op : clonedFuncs)
-    op->erase();
+    if (!genericFuncs.count(op))
+      op->erase();
+  clonedFuncs.clear();
+  specializations.clear();
+  genericFuncs.clear();
 
 } // runOnOperation
 
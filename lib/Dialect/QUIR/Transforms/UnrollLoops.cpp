@@ -0,0 +1,91 @@
+//===- UnrollLoops.cpp - Budgeted unrolling of for loops --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for fully unrolling constant-bound for
+///  loops within an operation budget.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/UnrollLoops.h"
+
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/SCF/Utils/Utils.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Debug.h"
+
+#include <cstdint>
+
+#define DEBUG_TYPE "QUIRUnrollLoops"
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+// Returns the number of operations nested in the body of forOp, excluding
+// its terminator
+uint64_t getBodySize(scf::ForOp forOp) {
+  uint64_t size = 0;
+  forOp.getBody()->walk([&](Operation *) { ++size; });
+  return size - 1;
+}
+} // anonymous namespace
+
+///
+/// \brief Entry point for the pass.
+void UnrollLoopsPass::runOnOperation() {
+  // The post-order walk visits inner loops before their parents
+  llvm::SmallVector<scf::ForOp> forOps;
+  getOperation()->walk([&](scf::ForOp forOp) { forOps.push_back(forOp); });
+
+  for (auto forOp : forOps) {
+    auto tripCount = getConstantTripCount(forOp);
+    // leave empty loops to canonicalization
+    if (!tripCount || *tripCount < 2)
+      continue;
+
+    uint64_t const bodySize = getBodySize(forOp);
+    if (bodySize != 0 && *tripCount > maxUnrolledOps / bodySize) {
+      LLVM_DEBUG(llvm::dbgs() << "Keeping loop with " << *tripCount
+                              << " iterations of " << bodySize
+                              << " operations rolled\n");
+      continue;
+    }
+
+    if (failed(loopUnrollByFactor(forOp, *tripCount))) {
+      forOp->emitError() << "Failed to unroll loop";
+      return signalPassFailure();
+    }
+  }
+}
+
+llvm::StringRef UnrollLoopsPass::getArgument() const {
+  return "quir-unroll-loops";
+}
+llvm::StringRef UnrollLoopsPass::getDescription() const {
+  return "Fully unroll constant-bound scf.for loops which expand to no more "
+         "than max-unrolled-ops operations";
+}
+
+llvm::StringRef UnrollLoopsPass::getName() const {
+  return "Unroll Loops Pass";
+}
@@ -1,6 +1,6 @@
 //===- UnusedVariable.cpp - Remove unused variables -------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,74 +23,98 @@
 
 #include "Dialect/OQ3/IR/OQ3Ops.h"
 
-#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
-#include "mlir/Support/LogicalResult.h"
-#include "mlir/Transforms/DialectConversion.h"
-#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
-#include <utility>
-
 using namespace mlir;
 using namespace quir;
 using namespace oq3;
 
 namespace {
-/// This pattern matches on variable declarations that are not marked 'output'
-/// and are not followed by a use of the same variable, and removes them
-struct UnusedVariablePat : public OpRewritePattern<DeclareVariableOp> {
-  UnusedVariablePat(MLIRContext *context, mlir::SymbolUserMap &symbolUses)
-      : OpRewritePattern<DeclareVariableOp>(context, /*benefit=*/1),
-        symbolUses(symbolUses) {}
-  mlir::SymbolUserMap &symbolUses;
-  LogicalResult
-  matchAndRewrite(DeclareVariableOp declOp,
-                  mlir::PatternRewriter &rewriter) const override {
-    if (declOp.isOutputVariable())
-      return failure();
-
-    // iterate through uses
-    for (auto *useOp : symbolUses.getUsers(declOp)) {
-      if (auto useVariable = dyn_cast<VariableLoadOp>(useOp)) {
-        if (!useVariable || !useVariable.use_empty())
-          return failure();
+/// Removes the variable declarations that are not marked 'output' and whose
+/// loads are all unused, together with all references (loads and stores) to
+/// them. Erasing the stores of a variable may leave the loads of other
+/// variables unused; the number of used loads of every variable is indexed
+/// once, such that these are removed through a work list.
+class UnusedVariableEraser {
+public:
+  explicit UnusedVariableEraser(Operation *op)
+      : symbolUsers(symbolTable, op) {
+    op->walk([&](DeclareVariableOp declOp) {
+      unsigned &numUsedLoads = usedLoads[declOp];
+      for (auto *useOp : symbolUsers.getUsers(declOp)) {
+        auto loadOp = dyn_cast<VariableLoadOp>(useOp);
+        if (!loadOp || loadOp.use_empty())
+          continue;
+        numUsedLoads += 1;
+        loadDecls[loadOp] = declOp;
       }
+      if (numUsedLoads == 0 && !declOp.isOutputVariable())
+        workList.push_back(declOp);
+    });
+  }
+
+  void run() {
+    while (!workList.empty()) {
+      DeclareVariableOp const declOp = workList.pop_back_val();
+      // No uses found, so now we can erase all references (just stores) and
+      // the declaration
+      for (auto *useOp : symbolUsers.getUsers(declOp))
+        erase(useOp);
+      declOp->erase();
     }
+  }
 
-    // No uses found, so now we can erase all references (just stores) and the
-    // declaration
-    for (auto *useOp : symbolUses.getUsers(declOp))
-      rewriter.eraseOp(useOp);
-
-    rewriter.eraseOp(declOp);
-    return success();
-  } // matchAndRewrite
-
-}; // struct UnusedVariablePat
+private:
+  mlir::SymbolTableCollection symbolTable;
+  mlir::SymbolUserMap symbolUsers;
+  // the number of loads with uses of every variable
+  llvm::DenseMap<Operation *, unsigned> usedLoads;
+  llvm::DenseMap<Operation *, DeclareVariableOp> loadDecls;
+  llvm::SmallVector<DeclareVariableOp> workList;
+  // references erased before their variable, no operations are created
+  // while erasing such that their addresses are not reused
+  llvm::DenseSet<Operation *> erased;
+
+  void erase(Operation *op) {
+    if (!erased.insert(op).second)
+      return;
+    llvm::SmallVector<Operation *> operandDefs;
+    for (auto operand : op->getOperands())
+      if (auto *defOp = operand.getDefiningOp())
+        operandDefs.push_back(defOp);
+    op->erase();
+
+    // erase the computations feeding only the erased operation, their loads
+    // are not counted as used any longer
+    for (auto *defOp : operandDefs) {
+      if (erased.contains(defOp) || !defOp->use_empty())
+        continue;
+      auto search = loadDecls.find(defOp);
+      if (search != loadDecls.end()) {
+        DeclareVariableOp const declOp = search->second;
+        if (--usedLoads[declOp] == 0 && !declOp.isOutputVariable())
+          workList.push_back(declOp);
+        erase(defOp);
+      } else if (isOpTriviallyDead(defOp)) {
+        erase(defOp);
+      }
+    }
+  }
+}; // class UnusedVariableEraser
 } // anonymous namespace
 
 ///
 /// \brief Entry point for the pass.
 void UnusedVariablePass::runOnOperation() {
-  RewritePatternSet patterns(&getContext());
-  mlir::GreedyRewriteConfig config;
-  mlir::SymbolTableCollection symbolTable;
-  mlir::SymbolUserMap symbolUsers(symbolTable, getOperation());
-
-  // use cheaper top-down traversal (in this case, bottom-up would not behave
-  // any differently)
-  config.useTopDownTraversal = true;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
-
-  patterns.add<UnusedVariablePat>(&getContext(), symbolUsers);
-
-  if (failed(applyPatternsAndFoldGreedily(getOperation(), std::move(patterns),
-                                          config)))
-    signalPassFailure();
+  UnusedVariableEraser(getOperation()).run();
 }
 
 llvm::StringRef UnusedVariablePass::getArgument() const {
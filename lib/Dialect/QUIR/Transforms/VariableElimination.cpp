@@ -1,6 +1,6 @@
 //===- VariableElimination.cpp - Lower and eliminate variables --*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -34,6 +34,8 @@
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/IR/MLIRContext.h"
@@ -46,18 +48,16 @@
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
-#include <cassert>
+#include <cstdint>
 #include <optional>
 #include <utility>
 
-namespace mlir {
-void affineScalarReplaceCopy(mlir::func::FuncOp f, DominanceInfo &domInfo,
-                             PostDominanceInfo &postDomInfo);
-} // namespace mlir
-
 namespace mlir::quir {
 
 namespace {
@@ -85,18 +85,6 @@ public:
   }
 };
 
-struct MemrefGlobalToAllocaPattern
-    : public OpRewritePattern<mlir::memref::GetGlobalOp> {
-  MemrefGlobalToAllocaPattern(MLIRContext *context, mlir::Operation *toplevel)
-      : OpRewritePattern<mlir::memref::GetGlobalOp>(context, /* benefit*/ 1),
-        toplevel(toplevel) {}
-
-  LogicalResult matchAndRewrite(mlir::memref::GetGlobalOp,
-                                mlir::PatternRewriter &rewriter) const override;
-
-  mlir::Operation *toplevel;
-};
-
 /// Materialize OQ3 casts to !quir.angle into a new cast when the argument can
 /// be type-converted to integer.
 struct MaterializeIntToAngleCastPattern
@@ -217,56 +205,72 @@ mlir::LogicalResult convertQuirVariables(mlir::MLIRContext &context,
   return applyPartialConversion(top, target, std::move(patterns));
 }
 
-LogicalResult MemrefGlobalToAllocaPattern::matchAndRewrite(
-    mlir::memref::GetGlobalOp op, mlir::PatternRewriter &rewriter) const {
-
-  // Check that the global memref is only used by this GetGlobalOp
-  auto global =
-      mlir::SymbolTable::lookupNearestSymbolFrom<mlir::memref::GlobalOp>(
-          op, op.getNameAttr());
-
-  if (!global)
-    return failure();
-  if (!global.isPrivate())
-    return failure();
-
-  auto uses = global.getSymbolUses(toplevel);
-
-  if (!uses)
-    return failure();
-
-  for (auto &use : uses.value()) {
-    assert(use.getSymbolRef() == op.getNameAttr() && "found wrong symbol");
-    if (use.getUser() != op) // other reference to the global memref
-      return failure();
-  }
-
-  auto mrt = op.getResult().getType().dyn_cast<mlir::MemRefType>();
-
-  assert(mrt && "expect result of a GetGlobalOp to be of MemRefType");
-  if (!mrt)
-    return failure();
-
-  rewriter.replaceOpWithNewOp<mlir::memref::AllocaOp>(
-      op, mrt, global.getAlignmentAttr());
-  rewriter.eraseOp(global);
-  return success();
+bool isOnlyStoredTo(mlir::memref::AllocaOp alloca) {
+  return llvm::all_of(alloca->getUsers(), [&](Operation *user) {
+    auto storeOp = dyn_cast<mlir::affine::AffineStoreOp>(user);
+    return storeOp && storeOp.getValue() != alloca.getResult();
+  });
 }
 
-mlir::LogicalResult
-convertIsolatedMemrefGlobalToAlloca(mlir::MLIRContext &context,
-                                    mlir::Operation *top) {
-
-  RewritePatternSet patterns(&context);
-
-  patterns.add<MemrefGlobalToAllocaPattern>(&context, top);
-  mlir::GreedyRewriteConfig config;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
+/// Lower each private memref.global whose only use is a single
+/// memref.get_global to a memref.alloca in its place, and drop the allocas
+/// which are only stored to, i.e. the variables which are never read, in a
+/// single sweep over top. The references to all symbols are counted in one
+/// walk rather than walking top for the uses of each global, and the globals
+/// are looked up through cached symbol tables.
+/// Returns the number of globals lowered and sets numDropped to the number
+/// of allocas dropped.
+uint64_t lowerIsolatedGlobalsAndDropDeadAllocas(mlir::Operation *top,
+                                                uint64_t &numDropped) {
+  llvm::DenseMap<StringAttr, unsigned> numSymbolUses;
+  SmallVector<mlir::memref::GetGlobalOp> getGlobalOps;
+  SmallVector<mlir::memref::AllocaOp> allocas;
+  top->walk([&](Operation *op) {
+    // a reference to a symbol of the same name in another symbol table is
+    // counted too, which may prevent a lowering but never allows a wrong one
+    op->getAttrDictionary().walk([&](SymbolRefAttr symbolRef) {
+      ++numSymbolUses[symbolRef.getRootReference()];
+      for (FlatSymbolRefAttr const nested : symbolRef.getNestedReferences())
+        ++numSymbolUses[nested.getAttr()];
+    });
+    if (auto getGlobalOp = dyn_cast<mlir::memref::GetGlobalOp>(op))
+      getGlobalOps.push_back(getGlobalOp);
+    else if (auto alloca = dyn_cast<mlir::memref::AllocaOp>(op))
+      allocas.push_back(alloca);
+  });
 
-  config.useTopDownTraversal = true;
+  SymbolTableCollection symbolTables;
+  uint64_t numLowered = 0;
+  for (auto getGlobalOp : getGlobalOps) {
+    if (numSymbolUses.lookup(getGlobalOp.getNameAttr().getAttr()) != 1)
+      continue;
+    auto global = symbolTables.lookupNearestSymbolFrom<mlir::memref::GlobalOp>(
+        getGlobalOp, getGlobalOp.getNameAttr());
+    if (!global || !global.isPrivate())
+      continue;
+
+    OpBuilder builder(getGlobalOp);
+    auto alloca = builder.create<mlir::memref::AllocaOp>(
+        getGlobalOp.getLoc(),
+        getGlobalOp.getResult().getType().cast<mlir::MemRefType>(),
+        global.getAlignmentAttr());
+    getGlobalOp.getResult().replaceAllUsesWith(alloca.getResult());
+    getGlobalOp.erase();
+    symbolTables.getSymbolTable(global->getParentOp()).erase(global);
+    allocas.push_back(alloca);
+    ++numLowered;
+  }
 
-  return applyPatternsAndFoldGreedily(top, std::move(patterns), config);
+  numDropped = 0;
+  for (auto alloca : allocas) {
+    if (!isOnlyStoredTo(alloca))
+      continue;
+    for (Operation *user : llvm::make_early_inc_range(alloca->getUsers()))
+      user->erase();
+    alloca.erase();
+    ++numDropped;
+  }
+  return numLowered;
 }
 
 struct RemoveAllocaWithIsolatedStoresPattern
@@ -319,6 +323,179 @@ mlir::LogicalResult dropAllocaWithIsolatedStores(mlir::MLIRContext &context,
   return applyPatternsAndFoldGreedily(top, std::move(patterns), config);
 }
 
+// Promotes the scalar allocas of variables, which remain after
+// store-forwarding because they are accessed across scf.if and scf.for, to
+// SSA values. The value of the variable is threaded through the structured
+// control flow as an additional scf.if result or scf.for iteration argument,
+// like mem2reg does for a CFG.
+class AllocaPromotion {
+public:
+  explicit AllocaPromotion(mlir::memref::AllocaOp alloca) : alloca(alloca) {}
+
+  // Returns true if every access is a direct load or store of the alloca
+  // nested in scf.if and scf.for ops of its block
+  bool isPromotable();
+  void promote();
+
+private:
+  static bool isLoad(mlir::Operation *op) {
+    return isa<mlir::affine::AffineLoadOp>(op);
+  }
+  static bool isStore(mlir::Operation *op) {
+    return isa<mlir::affine::AffineStoreOp>(op);
+  }
+
+  Value promoteInBlock(mlir::Block &block, Value current);
+  Value promoteIf(mlir::scf::IfOp ifOp, Value current);
+  Value promoteFor(mlir::scf::ForOp forOp, Value current);
+
+  mlir::memref::AllocaOp alloca;
+  // the ops of the regions enclosing an access, and those enclosing a store
+  llvm::SmallPtrSet<mlir::Operation *, 8> enclosesAccess;
+  llvm::SmallPtrSet<mlir::Operation *, 8> enclosesStore;
+};
+
+bool AllocaPromotion::isPromotable() {
+  // the variable is uninitialized and starts out as zero, a refinement of that
+  auto memRefType = alloca.getType();
+  if (memRefType.getRank() != 0 ||
+      !memRefType.getElementType().isIntOrIndexOrFloat())
+    return false;
+
+  Block *block = alloca->getBlock();
+  if (!block->getParent()->hasOneBlock())
+    return false;
+
+  for (Operation *user : alloca->getUsers()) {
+    bool const store = isStore(user);
+    if (store) {
+      // storing the memref itself lets it escape
+      if (cast<mlir::affine::AffineStoreOp>(user).getValue() ==
+          alloca.getResult())
+        return false;
+    } else if (!isLoad(user)) {
+      return false;
+    }
+
+    for (Operation *parentOp = user; parentOp->getBlock() != block;) {
+      parentOp = parentOp->getParentOp();
+      if (!parentOp || !isa<mlir::scf::IfOp, mlir::scf::ForOp>(parentOp))
+        return false;
+      enclosesAccess.insert(parentOp);
+      if (store)
+        enclosesStore.insert(parentOp);
+    }
+  }
+  return true;
+}
+
+void AllocaPromotion::promote() {
+  OpBuilder builder(alloca);
+  builder.setInsertionPointAfter(alloca);
+  Type const elementType = alloca.getType().getElementType();
+  Value const initial = builder.create<mlir::arith::ConstantOp>(
+      alloca.getLoc(), elementType, builder.getZeroAttr(elementType));
+  promoteInBlock(*alloca->getBlock(), initial);
+}
+
+Value AllocaPromotion::promoteInBlock(mlir::Block &block, Value current) {
+  for (Operation &op : llvm::make_early_inc_range(block)) {
+    if (auto loadOp = dyn_cast<mlir::affine::AffineLoadOp>(op);
+        loadOp && loadOp.getMemRef() == alloca.getResult()) {
+      loadOp.getResult().replaceAllUsesWith(current);
+      op.erase();
+    } else if (auto storeOp = dyn_cast<mlir::affine::AffineStoreOp>(op);
+               storeOp && storeOp.getMemRef() == alloca.getResult()) {
+      current = storeOp.getValue();
+      op.erase();
+    } else if (!enclosesAccess.contains(&op)) {
+      continue;
+    } else if (auto ifOp = dyn_cast<mlir::scf::IfOp>(op)) {
+      current = promoteIf(ifOp, current);
+    } else if (auto forOp = dyn_cast<mlir::scf::ForOp>(op)) {
+      current = promoteFor(forOp, current);
+    }
+  }
+  return current;
+}
+
+Value AllocaPromotion::promoteIf(mlir::scf::IfOp ifOp, Value current) {
+  if (!enclosesStore.contains(ifOp)) {
+    for (Region &region : ifOp->getRegions())
+      if (!region.empty())
+        promoteInBlock(region.front(), current);
+    return current;
+  }
+
+  // the variable becomes an additional result of the scf.if
+  OpBuilder builder(ifOp);
+  SmallVector<Type> resultTypes(ifOp.getResultTypes());
+  resultTypes.push_back(current.getType());
+  auto newIfOp = builder.create<mlir::scf::IfOp>(
+      ifOp.getLoc(), resultTypes, ifOp.getCondition(), /*withElseRegion=*/true);
+  newIfOp.getThenRegion().takeBody(ifOp.getThenRegion());
+  if (ifOp.getElseRegion().empty()) {
+    auto elseBuilder = OpBuilder::atBlockEnd(&newIfOp.getElseRegion().front());
+    elseBuilder.create<mlir::scf::YieldOp>(ifOp.getLoc());
+  } else {
+    newIfOp.getElseRegion().takeBody(ifOp.getElseRegion());
+  }
+  newIfOp->setAttrs(ifOp->getAttrs());
+
+  for (Region &region : newIfOp->getRegions()) {
+    Block &block = region.front();
+    Value const value = promoteInBlock(block, current);
+    Operation *yield = block.getTerminator();
+    yield->insertOperands(yield->getNumOperands(), value);
+  }
+
+  ifOp->replaceAllUsesWith(newIfOp.getResults().drop_back());
+  ifOp.erase();
+  return newIfOp.getResults().back();
+}
+
+Value AllocaPromotion::promoteFor(mlir::scf::ForOp forOp, Value current) {
+  if (!enclosesStore.contains(forOp)) {
+    promoteInBlock(*forOp.getBody(), current);
+    return current;
+  }
+
+  // the variable becomes an additional iteration argument of the scf.for
+  OpBuilder builder(forOp);
+  SmallVector<Value> initArgs(forOp.getInitArgs());
+  initArgs.push_back(current);
+  auto newForOp = builder.create<mlir::scf::ForOp>(
+      forOp.getLoc(), forOp.getLowerBound(), forOp.getUpperBound(),
+      forOp.getStep(), initArgs);
+  newForOp->setAttrs(forOp->getAttrs());
+
+  Block *body = forOp.getBody();
+  Block *newBody = newForOp.getBody();
+  newBody->getOperations().splice(newBody->end(), body->getOperations());
+  for (auto [arg, newArg] :
+       llvm::zip(body->getArguments(), newBody->getArguments()))
+    arg.replaceAllUsesWith(newArg);
+
+  Value const value = promoteInBlock(*newBody, newBody->getArguments().back());
+  Operation *yield = newBody->getTerminator();
+  yield->insertOperands(yield->getNumOperands(), value);
+
+  forOp->replaceAllUsesWith(newForOp.getResults().drop_back());
+  forOp.erase();
+  return newForOp.getResults().back();
+}
+
+void promoteAllocas(mlir::Operation *top) {
+  SmallVector<mlir::memref::AllocaOp> allocas;
+  top->walk([&](mlir::memref::AllocaOp alloca) { allocas.push_back(alloca); });
+
+  for (mlir::memref::AllocaOp alloca : allocas) {
+    AllocaPromotion promotion(alloca);
+    if (promotion.isPromotable())
+      promotion.promote();
+  }
+}
+
 } // anonymous namespace
 
 void VariableEliminationPass::runOnOperation() {
@@ -327,9 +504,13 @@ void VariableEliminationPass::runOnOperation() {
                                   externalizeOutputVariables)))
     return signalPassFailure();
 
-  if (failed(convertIsolatedMemrefGlobalToAlloca(getContext(), getOperation())))
-    return signalPassFailure();
+  uint64_t numDropped = 0;
+  numGlobalsToAllocas +=
+      lowerIsolatedGlobalsAndDropDeadAllocas(getOperation(), numDropped);
+  numDroppedVariables += numDropped;
 
+  // computed once for all functions, after the sweep above, which only
+  // erases ops and so leaves the structure of the regions unchanged
   auto &domInfo = getAnalysis<DominanceInfo>();
   auto &postDomInfo = getAnalysis<PostDominanceInfo>();
 
@@ -342,6 +523,11 @@ void VariableEliminationPass::runOnOperation() {
   if (result.wasInterrupted())
     return signalPassFailure();
 
+  // the variables still accessed across structured control flow are promoted
+  // to values carried by the control flow ops
+  promoteAllocas(getOperation());
+
+  // folds the forwarded values and drops the variables left only stored to
   if (failed(dropAllocaWithIsolatedStores(getContext(), getOperation())))
     return signalPassFailure();
 }
@@ -1,6 +1,6 @@
 //===- Utils.cpp - QUIR Utilities -------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -26,6 +26,8 @@
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/FunctionInterfaces.h"
@@ -35,16 +37,18 @@
 #include "mlir/Interfaces/ControlFlowInterfaces.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/APInt.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <optional>
-#include <set>
 #include <string>
 #include <sys/types.h>
 #include <tuple>
@@ -141,17 +145,17 @@ void addQubitIdsFromAttr(Operation *operation, std::vector<uint> &theseIds) {
 } // addQubitIdsFromAttr
 
 // adds the qubit Ids on the physicalId or physicalIds attributes to theseIds
-void addQubitIdsFromAttr(Operation *operation, std::set<uint> &theseIds) {
+void addQubitIdsFromAttr(Operation *operation, QubitSet &theseIds) {
   auto thisIdAttr = operation->getAttrOfType<IntegerAttr>(
       mlir::quir::getPhysicalIdAttrName());
   auto theseIdsAttr =
       operation->getAttrOfType<ArrayAttr>(mlir::quir::getPhysicalIdsAttrName());
   if (thisIdAttr)
-    theseIds.emplace(thisIdAttr.getInt());
+    theseIds.insert(thisIdAttr.getInt());
   if (theseIdsAttr) {
     for (Attribute const valAttr : theseIdsAttr) {
       auto intAttr = valAttr.dyn_cast<IntegerAttr>();
-      theseIds.emplace(intAttr.getInt());
+      theseIds.insert(intAttr.getInt());
     }
   }
 } // addQubitIdsFromAttr
@@ -348,6 +352,18 @@ getDuration(mlir::quir::ConstantOp &duration) {
   return durAttr;
 }
 
+std::optional<uint64_t> getConstantTripCount(scf::ForOp forOp) {
+  auto lowerBound = getConstantIntValue(forOp.getLowerBound());
+  auto upperBound = getConstantIntValue(forOp.getUpperBound());
+  auto step = getConstantIntValue(forOp.getStep());
+  if (!lowerBound || !upperBound || !step || *step <= 0)
+    return std::nullopt;
+  if (*upperBound <= *lowerBound)
+    return 0;
+  return static_cast<uint64_t>((*upperBound - *lowerBound + *step - 1) /
+                               *step);
+}
+
 std::tuple<Value, MeasureOp> qubitFromMeasResult(MeasureOp measureOp,
                                                  Value result) {
   auto opRes = result.cast<OpResult>();
@@ -365,6 +381,20 @@ std::tuple<Value, MeasureOp> qubitFromMeasResult(CallCircuitOp callCircuitOp,
   return qubitFromMeasResult(circuitOp, result);
 }
 
+llvm::APInt getFixedPointAngle(double angle, unsigned width) {
+  assert(width > 0 && width <= 64 && "expect a fixed-point width of 1 to 64");
+  // reduce to a fraction of a turn in [0, 1) first, such that the scaled
+  // value fits into 64 bits for any angle
+  long double turns = static_cast<long double>(angle) /
+                      (2 * static_cast<long double>(llvm::numbers::pi));
+  turns -= std::floor(turns);
+  long double const scaled = std::nearbyint(std::ldexp(turns, width));
+  // a fraction rounding up to a full turn wraps around to zero
+  if (scaled >= std::ldexp(1.0L, width))
+    return {width, 0};
+  return {width, static_cast<uint64_t>(scaled)};
+}
+
 std::tuple<Value, MeasureOp> qubitFromMeasResult(CircuitOp circuitOp,
                                                  Value result) {
   auto opRes = result.cast<OpResult>();
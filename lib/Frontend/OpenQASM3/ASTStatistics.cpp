@@ -0,0 +1,110 @@
+//===- ASTStatistics.cpp ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the collection of per AST node kind statistics of the OpenQASM 3
+/// frontend
+///
+//===----------------------------------------------------------------------===//
+
+#include "Frontend/OpenQASM3/ASTStatistics.h"
+
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <qasm/AST/ASTBase.h>
+#include <qasm/AST/ASTTypeEnums.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace qssc::frontend::openqasm3;
+
+ASTStatistics::Scope::Scope(ASTStatistics *statistics,
+                            const QASM::ASTBase *node)
+    : statistics(statistics) {
+  if (!statistics)
+    return;
+
+  kind = node->GetASTType();
+  statistics->locations[{node->GetLineNo(), node->GetColNo()}] = kind;
+  parent = statistics->current;
+  statistics->current = this;
+  start = Clock::now();
+}
+
+ASTStatistics::Scope::~Scope() {
+  if (!statistics)
+    return;
+
+  auto const elapsed = Clock::now() - start;
+  auto &entry = statistics->entries[kind];
+  ++entry.count;
+  entry.time += elapsed - nestedTime;
+  if (parent)
+    parent->nestedTime += elapsed;
+  statistics->current = parent;
+}
+
+void ASTStatistics::countOperations(mlir::Operation *root, int lineOffset) {
+  root->walk([&](mlir::Operation *op) {
+    auto loc = op->getLoc().dyn_cast<mlir::FileLineColLoc>();
+    if (!loc) {
+      ++unattributedOperations;
+      return;
+    }
+    auto it = locations.find(
+        {static_cast<unsigned>(static_cast<int>(loc.getLine()) - lineOffset),
+         loc.getColumn()});
+    if (it == locations.end()) {
+      ++unattributedOperations;
+      return;
+    }
+    ++entries[it->second].operations;
+  });
+}
+
+void ASTStatistics::printJSON(llvm::raw_ostream &os) const {
+  std::vector<std::pair<QASM::ASTType, Entry>> sorted(entries.begin(),
+                                                      entries.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const auto &a, const auto &b) {
+                     return a.second.time > b.second.time;
+                   });
+
+  llvm::json::Array nodes;
+  for (const auto &[kind, entry] : sorted)
+    nodes.push_back(llvm::json::Object{
+        {"kind", std::string(QASM::PrintTypeEnum(kind))},
+        {"count", static_cast<int64_t>(entry.count)},
+        {"time_ns",
+         std::chrono::duration_cast<std::chrono::nanoseconds>(entry.time)
+             .count()},
+        {"operations", static_cast<int64_t>(entry.operations)}});
+
+  llvm::json::Object statistics{
+      {"nodes", std::move(nodes)},
+      {"unattributed_operations",
+       static_cast<int64_t>(unattributedOperations)}};
+  os << llvm::formatv("{0:2}", llvm::json::Value(std::move(statistics)))
+     << "\n";
+}
@@ -56,6 +56,8 @@
 
 #include "Frontend/OpenQASM3/BaseQASM3Visitor.h"
 
+#include "Frontend/OpenQASM3/ASTStatistics.h"
+
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -101,11 +103,16 @@ void BaseQASM3Visitor::setStatementList(ASTStatementList *list) {
   statementList = list;
 }
 
+void BaseQASM3Visitor::setStatistics(ASTStatistics *stats) {
+  statistics = stats;
+}
+
 void BaseQASM3Visitor::walkAST() { visit(statementList); }
 
 void BaseQASM3Visitor::visit(const ASTStatementList *list) {
   for (ASTStatement *i : *list) {
     if (auto *declNode = dynamic_cast<ASTDeclarationNode *>(i)) {
+      ASTStatistics::Scope const scope(statistics, declNode);
       visit(declNode);
     } else if (auto *statementNode = dynamic_cast<ASTStatementNode *>(i)) {
       visit(statementNode);
@@ -177,6 +184,7 @@ void BaseQASM3Visitor::visit(const ASTSymbolTableEntry *symTableEntry) {
 }
 
 void BaseQASM3Visitor::visit(const ASTStatementNode *node) {
+  ASTStatistics::Scope const scope(statistics, node);
   // evaluate statements by type
   switch (ASTType const astType = node->GetASTType()) {
   case ASTTypeOpenQASMStatement:
@@ -273,6 +281,7 @@ void BaseQASM3Visitor::visit(const ASTBinaryOpStatementNode *node) {
 void BaseQASM3Visitor::visit(const ASTOpenQASMStatementNode *node) {}
 
 void BaseQASM3Visitor::visit(const ASTExpressionNode *node) {
+  ASTStatistics::Scope const scope(statistics, node);
   switch (ASTType const astType = node->GetASTType()) {
   case ASTTypeIdentifier: {
     const ASTIdentifierNode *identifierNode = nullptr;
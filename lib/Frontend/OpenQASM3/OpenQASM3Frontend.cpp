@@ -21,14 +21,19 @@
 #include "Frontend/OpenQASM3/OpenQASM3Frontend.h"
 
 #include "API/errors.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/IR/QUIREnums.h"
+#include "Frontend/OpenQASM3/ASTStatistics.h"
 #include "Frontend/OpenQASM3/PrintQASM3Visitor.h"
 #include "Frontend/OpenQASM3/QUIRGenQASM3Visitor.h"
+#include "Utils/HashField.h"
 
 #include "mlir/Dialect/Complex/IR/Complex.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Location.h"
@@ -38,15 +43,28 @@
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <exception>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -60,7 +78,11 @@
 #include <stdexcept>
 #include <string>
 #include <sys/types.h>
+#include <system_error>
 #include <utility>
+#include <vector>
+
+using qssc::utils::hashField;
 
 namespace {
 
@@ -83,11 +105,52 @@ llvm::cl::list<std::string>
     includeDirs("I", llvm::cl::desc("Add <dir> to the include path"),
                 llvm::cl::value_desc("dir"), llvm::cl::cat(openqasm3Cat));
 
-mlir::MLIRContext *MLIRContext_;
-std::string sourceFile;
-
+llvm::cl::opt<unsigned> maxParserDiagnostics(
+    "qasm3-max-diagnostics",
+    llvm::cl::desc("Maximum number of parser diagnostics reported for an "
+                   "OpenQASM 3 source, default is 100"),
+    llvm::cl::value_desc("num"), llvm::cl::init(100),
+    llvm::cl::cat(openqasm3Cat));
+
+llvm::cl::opt<std::string> astStatisticsFile(
+    "qasm3-ast-statistics",
+    llvm::cl::desc("Write the time spent and the number of operations "
+                   "generated per kind of OpenQASM 3 AST node to <file> as "
+                   "JSON"),
+    llvm::cl::value_desc("file"), llvm::cl::init(""),
+    llvm::cl::cat(openqasm3Cat));
+
+// The qe-qasm preprocessor, statement builder and diagnostic emitter are
+// process-wide singletons. Every access to them must hold this lock.
 std::mutex qasmParserLock;
 
+// Include directories added to the qe-qasm preprocessor, which keeps the
+// directories it is given for the lifetime of the process. Each directory is
+// added once such that the include search path of a long-lived compiler does
+// not grow with every compile. Guarded by qasmParserLock.
+llvm::StringSet<> preprocessorIncludeDirs;
+
+// The session currently parsing on this thread. qe-qasm invokes its
+// diagnostic handler synchronously from within the parser so this is
+// sufficient to route the diagnostic back to the right MLIR context.
+thread_local qssc::frontend::openqasm3::ParserSession *activeSession = nullptr;
+
+/// RAII helper marking a session as active on the calling thread.
+class ActiveSessionGuard {
+public:
+  explicit ActiveSessionGuard(qssc::frontend::openqasm3::ParserSession *session)
+      : previous(activeSession) {
+    activeSession = session;
+  }
+  ~ActiveSessionGuard() { activeSession = previous; }
+
+  ActiveSessionGuard(const ActiveSessionGuard &) = delete;
+  ActiveSessionGuard &operator=(const ActiveSessionGuard &) = delete;
+
+private:
+  qssc::frontend::openqasm3::ParserSession *previous;
+};
+
 std::regex durationRe("^([0-9]*[.]?[0-9]+)([a-zA-Z]*)");
 
 llvm::Expected<std::pair<double, mlir::quir::TimeUnits>>
@@ -115,177 +178,426 @@ parseDurationStr(const std::string &durationStr) {
                                      unitStr);
 }
 
-} // anonymous namespace
-
 const static std::string stdinFileName = "<stdin>";
 
-llvm::Error qssc::frontend::openqasm3::parse(mlir::MLIRContext *context,
-                                             llvm::SourceMgr &sourceMgr,
-                                             bool emitRawAST,
-                                             bool emitPrettyAST, bool emitMLIR,
-                                             mlir::ModuleOp newModule,
-                                             mlir::TimingScope &timing) {
-
-  const llvm::MemoryBuffer *sourceBuffer =
-      sourceMgr.getMemoryBuffer(sourceMgr.getMainFileID());
-
-  mlir::TimingScope qasm3ParseTiming = timing.nest("parse-qasm3");
+/// Return whether the OpenQASM 3 source may include other files. qe-qasm only
+/// performs includes for sources which it reads through its preprocessor, any
+/// other source is parsed directly from the buffer that holds it.
+bool mayIncludeFiles(llvm::StringRef source) {
+  return source.contains("include");
+}
 
-  MLIRContext_ = context;
+/// Append the names of the files included by text to names. Include
+/// statements within comments are collected too, which only makes keys over
+/// the included files more conservative.
+void collectIncludes(llvm::StringRef text, std::vector<std::string> &names) {
+  constexpr llvm::StringLiteral keyword("include");
+  for (size_t pos = text.find(keyword); pos != llvm::StringRef::npos;
+       pos = text.find(keyword, pos + keyword.size())) {
+    llvm::StringRef rest = text.drop_front(pos + keyword.size()).ltrim();
+    if (!rest.consume_front("\""))
+      continue;
+    llvm::StringRef const name =
+        rest.take_until([](char c) { return c == '"' || c == '\n'; });
+    if (rest.drop_front(name.size()).startswith("\""))
+      names.push_back(name.str());
+  }
+}
 
-  // The QASM parser can only be called from a single thread.
-  std::lock_guard<std::mutex> const qasmParserLockGuard(qasmParserLock);
+/// Hash the contents of the file at path, or that it can not be read, and
+/// collect the files it includes.
+void hashIncludedFile(llvm::SHA256 &hasher, llvm::StringRef path,
+                      std::vector<std::string> &includes) {
+  hashField(hasher, path);
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    hashField(hasher, "<unreadable>");
+    return;
+  }
+  hashField(hasher, (*buffer)->getBuffer());
+  collectIncludes((*buffer)->getBuffer(), includes);
+}
 
-  for (const auto &dirStr : includeDirs)
-    QASM::QasmPreprocessor::Instance().AddIncludePath(dirStr);
+/// Thrown from the diagnostic handler to stop the parser after an error. The
+/// diagnostics themselves are already collected by the session.
+struct ParserAbort {};
+
+/// Forward a qe-qasm parser diagnostic to the session parsing on this thread.
+void emitParserDiagnostic(
+    const std::string &file, // NOLINT
+    QASM::ASTLocation qasmLoc, const std::string &msg,
+    QASM::QasmDiagnosticEmitter::DiagLevel qasmDiagLevel) {
+  mlir::DiagnosticSeverity diagLevel = mlir::DiagnosticSeverity::Error;
+
+  switch (qasmDiagLevel) {
+  case QASM::QasmDiagnosticEmitter::DiagLevel::Error:
+    diagLevel = mlir::DiagnosticSeverity::Error;
+    break;
+
+  case QASM::QasmDiagnosticEmitter::DiagLevel::ICE:
+    diagLevel = mlir::DiagnosticSeverity::Error;
+    break;
+
+  case QASM::QasmDiagnosticEmitter::DiagLevel::Warning:
+    diagLevel = mlir::DiagnosticSeverity::Warning;
+    break;
+
+  case QASM::QasmDiagnosticEmitter::DiagLevel::Info:
+    diagLevel = mlir::DiagnosticSeverity::Remark;
+    break;
+
+  case QASM::QasmDiagnosticEmitter::DiagLevel::Status:
+    diagLevel = mlir::DiagnosticSeverity::Remark;
+    break;
+  }
 
-  QASM::ASTParser parser;
-  auto root = std::unique_ptr<QASM::ASTRoot>(nullptr);
+  auto *session = activeSession;
+  if (!session || !session->getContext())
+    throw std::runtime_error(
+        "MLIR context was not set for parser diagnostic handling");
 
-  QASM::QasmDiagnosticEmitter::SetHandler(
-      [](const std::string &file, QASM::ASTLocation qasmLoc, // NOLINT
-         const std::string &msg,
-         QASM::QasmDiagnosticEmitter::DiagLevel qasmDiagLevel) {
-        mlir::DiagnosticSeverity diagLevel = mlir::DiagnosticSeverity::Error;
+  // qe-qasm has no means to cancel a parse other than unwinding out of its
+  // diagnostic handler
+  if (session->addParserDiagnostic(diagLevel, qasmLoc.LineNo, qasmLoc.ColNo,
+                                   msg))
+    throw ParserAbort();
+}
 
-        switch (qasmDiagLevel) {
-        case QASM::QasmDiagnosticEmitter::DiagLevel::Error:
-          diagLevel = mlir::DiagnosticSeverity::Error;
-          break;
+} // anonymous namespace
 
-        case QASM::QasmDiagnosticEmitter::DiagLevel::ICE:
-          diagLevel = mlir::DiagnosticSeverity::Error;
-          break;
+qssc::frontend::openqasm3::ParserSession *
+qssc::frontend::openqasm3::ParserSession::getActiveSession() {
+  return activeSession;
+}
 
-        case QASM::QasmDiagnosticEmitter::DiagLevel::Warning:
-          diagLevel = mlir::DiagnosticSeverity::Warning;
-          break;
+bool qssc::frontend::openqasm3::ParserSession::addParserDiagnostic(
+    mlir::DiagnosticSeverity severity, unsigned line, unsigned column,
+    llvm::StringRef message) {
+  // give up parsing after errors right away
+  // TODO: update to recent qss-qasm to support continuing
+  bool const abort = severity == mlir::DiagnosticSeverity::Error;
 
-        case QASM::QasmDiagnosticEmitter::DiagLevel::Info:
-          diagLevel = mlir::DiagnosticSeverity::Remark;
-          break;
+  if (parserDiagnostics.size() >= maxParserDiagnostics) {
+    ++droppedParserDiagnostics;
+    return abort;
+  }
 
-        case QASM::QasmDiagnosticEmitter::DiagLevel::Status:
-          diagLevel = mlir::DiagnosticSeverity::Remark;
-          break;
-        }
+  // Workaround for https://github.com/openqasm/qe-qasm/issues/35
+  // TODO: Remove once this bug is fixed
 
-        auto lineNo = qasmLoc.LineNo;
-        // Workaround for https://github.com/openqasm/qe-qasm/issues/35
-        // TODO: Remove once this bug is fixed
+  // Sources parsed from a buffer rather than through the preprocessor
+  if (parserLocationFix)
+    line++;
 
-        // Parser hardcoded name for direct input
-        if (sourceFile == stdinFileName)
-          lineNo++;
+  parserDiagnostics.push_back({severity, line, column, message.str()});
+  return abort;
+}
 
-        mlir::LocationAttr const sourceLocAttr = mlir::FileLineColLoc::get(
-            MLIRContext_, sourceFile, lineNo, qasmLoc.ColNo);
+void qssc::frontend::openqasm3::ParserSession::flushParserDiagnostics_() {
+  auto &diagEngine = context->getDiagEngine();
+  for (auto &diagnostic : parserDiagnostics) {
+    auto const sourceLoc = mlir::FileLineColLoc::get(
+        context, sourceFile, diagnostic.line, diagnostic.column);
+    auto inflightDiag = diagEngine.emit(sourceLoc, diagnostic.severity);
+
+    // Currently we only report QSSC diagnostics for errors
+    // as the parser emits too much noise at warning level.
+    // TODO: Remove warning noise and return all diagnostics.
+    if (diagnostic.severity == mlir::DiagnosticSeverity::Error)
+      qssc::encodeQSSCError(context, inflightDiag,
+                            qssc::ErrorCategory::OpenQASM3ParseFailure);
+    inflightDiag << diagnostic.message;
+    inflightDiag.report();
+  }
+  parserDiagnostics.clear();
+
+  if (droppedParserDiagnostics > 0)
+    diagEngine.emit(mlir::FileLineColLoc::get(context, sourceFile, 0, 0),
+                    mlir::DiagnosticSeverity::Remark)
+        << droppedParserDiagnostics
+        << " further parser diagnostics were dropped";
+  droppedParserDiagnostics = 0;
+}
 
-        auto sourceLoc = mlir::Location(sourceLocAttr);
+llvm::Error qssc::frontend::openqasm3::ParserSession::parse(
+    llvm::SourceMgr &sourceMgr, bool emitRawAST, bool emitPrettyAST,
+    bool emitMLIR, mlir::ModuleOp newModule, mlir::TimingScope &timing) {
 
-        // Capture source context for including it in error messages
-        if (!MLIRContext_)
-          throw std::runtime_error(
-              "MLIR context was not set for parser diagnostic handling");
+  const llvm::MemoryBuffer *sourceBuffer =
+      sourceMgr.getMemoryBuffer(sourceMgr.getMainFileID());
+  sourceFile = sourceBuffer->getBufferIdentifier().str();
 
-        auto &diagEngine = MLIRContext_->getDiagEngine();
-        auto inflightDiag = diagEngine.emit(sourceLoc, diagLevel);
+  // Work that does not touch the qe-qasm singletons is done before entering
+  // the serialized section.
+  std::optional<std::pair<double, mlir::quir::TimeUnits>> shotDelayParams;
+  if (emitMLIR) {
+    auto result = parseDurationStr(shotDelay);
+    if (auto err = result.takeError())
+      return err;
+    shotDelayParams = *result;
 
-        // Currently we only report QSSC diagnostics for errors
-        // as the parser emits too much noise at warning level.
-        // TODO: Remove warning noise and return all diagnostics.
-        if (diagLevel == mlir::DiagnosticSeverity::Error)
-          encodeQSSCError(MLIRContext_, inflightDiag,
-                          qssc::ErrorCategory::OpenQASM3ParseFailure);
-        inflightDiag << msg;
-        inflightDiag.report();
+    context->loadDialect<mlir::quir::QUIRDialect>();
+    context->loadDialect<mlir::complex::ComplexDialect>();
+    context->loadDialect<mlir::func::FuncDialect>();
+  }
 
-        if (qasmDiagLevel == QASM::QasmDiagnosticEmitter::DiagLevel::Error ||
-            qasmDiagLevel == QASM::QasmDiagnosticEmitter::DiagLevel::ICE) {
-          // give up parsing after errors right away
-          // TODO: update to recent qss-qasm to support continuing
-          throw std::runtime_error("Failure parsing");
-        }
-      });
+  mlir::TimingScope qasm3ParseTiming = timing.nest("parse-qasm3");
 
-  // Workaround for https://github.com/openqasm/qe-qasm/issues/35
-  // TODO: Remove once this bug is fixed
-  bool requiresParserLocationFix = false;
-
-  try {
-    sourceFile = sourceBuffer->getBufferIdentifier().str();
-
-    // Handle stdin differently as the qasm parser does not seem to perform
-    // includes on a raw string input. This limits includes to file inputs only
-    // at the current time.
-    if (!(sourceFile == "" || sourceFile == stdinFileName)) {
-      QASM::QasmPreprocessor::Instance().SetTranslationUnit(sourceFile);
-      root.reset(parser.ParseAST());
-    } else {
-      root.reset(parser.ParseAST(sourceBuffer->getBuffer().str()));
-      requiresParserLocationFix = true;
+  // The collected parser diagnostics are emitted once the parser lock has
+  // been released, no matter how the serialized section is left.
+  auto flushDiagnostics =
+      llvm::make_scope_exit([&]() { flushParserDiagnostics_(); });
+
+  {
+    // The QASM parser can only be called from a single thread.
+    std::lock_guard<std::mutex> const qasmParserLockGuard(qasmParserLock);
+    ActiveSessionGuard const activeSessionGuard(this);
+
+    for (const auto &dirStr : includeDirs)
+      if (preprocessorIncludeDirs.insert(dirStr).second)
+        QASM::QasmPreprocessor::Instance().AddIncludePath(dirStr);
+
+    QASM::ASTParser parser;
+    auto root = std::unique_ptr<QASM::ASTRoot>(nullptr);
+
+    QASM::QasmDiagnosticEmitter::SetHandler(emitParserDiagnostic);
+
+    // The qasm parser does not perform includes on a raw string input, so
+    // files which may include others are read again by its preprocessor.
+    // Everything else is parsed from the buffer the source manager already
+    // holds rather than opening and reading the file a second time.
+    llvm::StringRef const source = sourceBuffer->getBuffer();
+    bool const isFile = !(sourceFile == "" || sourceFile == stdinFileName);
+    parserLocationFix = !(isFile && mayIncludeFiles(source));
+
+    try {
+      if (parserLocationFix) {
+        root.reset(parser.ParseAST(source.str()));
+      } else {
+        QASM::QasmPreprocessor::Instance().SetTranslationUnit(sourceFile);
+        root.reset(parser.ParseAST());
+      }
+
+    } catch (ParserAbort &) {
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to parse OpenQASM 3 input");
+    } catch (std::exception &e) {
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          llvm::Twine{"Exception while parsing OpenQASM 3 input: "} + e.what());
     }
 
-  } catch (std::exception &e) {
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        llvm::Twine{"Exception while parsing OpenQASM 3 input: "} + e.what());
-  }
+    qasm3ParseTiming.stop();
 
-  qasm3ParseTiming.stop();
+    if (!root)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to parse OpenQASM 3 input");
 
-  if (!root)
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Failed to parse OpenQASM 3 input");
+    if (emitRawAST)
+      root->print();
 
-  if (emitRawAST)
-    root->print();
+    if (emitPrettyAST) {
+      auto *statementList = QASM::ASTStatementBuilder::Instance().List();
+      qssc::frontend::openqasm3::PrintQASM3Visitor visitor(std::cout);
 
-  if (emitPrettyAST) {
-    auto *statementList = QASM::ASTStatementBuilder::Instance().List();
-    qssc::frontend::openqasm3::PrintQASM3Visitor visitor(std::cout);
+      visitor.setStatementList(statementList);
+      visitor.walkAST();
+    }
 
-    visitor.setStatementList(statementList);
-    visitor.walkAST();
-  }
+    if (!emitMLIR)
+      return llvm::Error::success();
 
-  if (emitMLIR) {
     mlir::TimingScope qasm3ToMlirTiming = timing.nest("convert-qasm3-to-mlir");
 
-    MLIRContext_->loadDialect<mlir::quir::QUIRDialect>();
-    MLIRContext_->loadDialect<mlir::complex::ComplexDialect>();
-    MLIRContext_->loadDialect<mlir::func::FuncDialect>();
-
     mlir::OpBuilder const builder(newModule.getBodyRegion());
 
     QASM::ASTStatementList *statementList =
         QASM::ASTStatementBuilder::Instance().List();
 
     qssc::frontend::openqasm3::QUIRGenQASM3Visitor visitor(
-        builder, newModule, "", requiresParserLocationFix);
+        builder, newModule, "", parserLocationFix);
 
-    auto result = parseDurationStr(shotDelay);
-    if (auto err = result.takeError())
-      return err;
-
-    const auto [shotDelayValue, shotDelayUnits] = *result;
+    const auto [shotDelayValue, shotDelayUnits] = *shotDelayParams;
     visitor.initialize(numShots, shotDelayValue, shotDelayUnits);
     visitor.setStatementList(statementList);
     visitor.setInputFile(sourceFile);
 
+    std::optional<qssc::frontend::openqasm3::ASTStatistics> statistics;
+    if (!astStatisticsFile.empty())
+      visitor.setStatistics(&statistics.emplace());
+
     if (failed(visitor.walkAST()))
       return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                      "Failed to emit QUIR");
     // make sure to finish the in progress quir.circuit
     visitor.finishCircuit();
-    if (mlir::failed(mlir::verify(newModule))) {
-      newModule.dump();
+    qasm3ToMlirTiming.stop();
 
-      return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                     "Failed to verify generated QUIR");
+    if (statistics) {
+      statistics->countOperations(newModule, parserLocationFix ? 1 : 0);
+      std::error_code ec;
+      llvm::raw_fd_ostream statisticsStream(astStatisticsFile, ec);
+      if (ec)
+        return llvm::createStringError(
+            ec, llvm::Twine{"Failed to open OpenQASM 3 AST statistics file "} +
+                    astStatisticsFile + ": " + ec.message());
+      statistics->printJSON(statisticsStream);
     }
-    qasm3ToMlirTiming.stop();
   }
 
+  flushParserDiagnostics_();
+
+  // The generated module no longer references the AST so it may be verified
+  // concurrently with other sessions.
+  mlir::TimingScope verifyTiming = timing.nest("verify-qasm3-mlir");
+  if (mlir::failed(mlir::verify(newModule))) {
+    newModule.dump();
+
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to verify generated QUIR");
+  }
+  verifyTiming.stop();
+
   return llvm::Error::success();
+} // ParserSession::parse
+
+llvm::Error qssc::frontend::openqasm3::parse(mlir::MLIRContext *context,
+                                             llvm::SourceMgr &sourceMgr,
+                                             bool emitRawAST,
+                                             bool emitPrettyAST, bool emitMLIR,
+                                             mlir::ModuleOp newModule,
+                                             mlir::TimingScope &timing) {
+  ParserSession session(context, maxParserDiagnostics);
+  return session.parse(sourceMgr, emitRawAST, emitPrettyAST, emitMLIR,
+                       newModule, timing);
 } // parse
+
+namespace {
+// An input declaration with an initializer, e.g. `input angle theta = 0.5;`
+std::regex inputDeclarationRe(R"(\binput\b([^;=\n]*)=([^;\n]*);)");
+} // anonymous namespace
+
+std::optional<qssc::frontend::openqasm3::ParameterizedSource>
+qssc::frontend::openqasm3::parameterizeSource(llvm::StringRef source) {
+  if (mayIncludeFiles(source))
+    return std::nullopt;
+
+  ParameterizedSource parameterized;
+  auto const sourceStr = source.str();
+  auto last = sourceStr.cbegin();
+  for (std::sregex_iterator it(sourceStr.begin(), sourceStr.end(),
+                               inputDeclarationRe),
+       end;
+       it != end; ++it) {
+    const auto &match = *it;
+    double value;
+    // StringRef::getAsDouble returns true on failure
+    if (llvm::StringRef(match[2].first, match[2].length())
+            .trim()
+            .getAsDouble(value))
+      return std::nullopt;
+    parameterized.parameterValues.push_back(value);
+
+    parameterized.text.append(last, match[2].first);
+    parameterized.text.push_back(';');
+    last = match[0].second;
+  }
+  parameterized.text.append(last, sourceStr.cend());
+  return parameterized;
+}
+
+std::string qssc::frontend::openqasm3::getOptionsKey() {
+  std::string key = "num-shots=" + std::to_string(numShots) +
+                    ";shot-delay=" + shotDelay + ";";
+  for (const auto &dir : includeDirs)
+    key += "I=" + dir + ";";
+  return key + QUIRGenQASM3Visitor::getOptionsKey();
+}
+
+std::string
+qssc::frontend::openqasm3::getIncludesKey(llvm::StringRef source,
+                                          llvm::StringRef sourceFile) {
+  llvm::SHA256 hasher;
+  std::vector<std::string> includes;
+  collectIncludes(source, includes);
+
+  // The preprocessor may resolve an include to any file below the include
+  // directories, so all of them are hashed. Directory iteration order is
+  // unspecified.
+  for (const auto &dir : includeDirs) {
+    hashField(hasher, dir);
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (llvm::sys::fs::recursive_directory_iterator it(dir, ec), end;
+         it != end && !ec; it.increment(ec))
+      if (it->type() == llvm::sys::fs::file_type::regular_file)
+        files.push_back(it->path());
+    if (ec)
+      hashField(hasher, "<unlistable>");
+    std::sort(files.begin(), files.end());
+    for (const auto &file : files)
+      hashIncludedFile(hasher, file, includes);
+  }
+
+  // The remaining includes are resolved relative to the source
+  llvm::SmallString<128> sourceDir(sourceFile);
+  llvm::sys::path::remove_filename(sourceDir);
+  llvm::StringSet<> visited;
+  while (!includes.empty()) {
+    std::string const name = std::move(includes.back());
+    includes.pop_back();
+    if (!visited.insert(name).second)
+      continue;
+    llvm::SmallString<128> path(name);
+    if (llvm::sys::path::is_relative(name)) {
+      path = sourceDir;
+      llvm::sys::path::append(path, name);
+    }
+    hashIncludedFile(hasher, path, includes);
+  }
+
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::vector<double>
+qssc::frontend::openqasm3::getInputParameterValues(mlir::ModuleOp moduleOp) {
+  std::vector<double> values;
+  for (auto declareParameterOp :
+       moduleOp.getOps<mlir::qcs::DeclareParameterOp>()) {
+    double value = 0.0;
+    if (auto initialValue = declareParameterOp.getInitialValue()) {
+      if (auto angleAttr = initialValue->dyn_cast<mlir::quir::AngleAttr>())
+        value = angleAttr.getValue().convertToDouble();
+      else if (auto floatAttr = initialValue->dyn_cast<mlir::FloatAttr>())
+        value = floatAttr.getValue().convertToDouble();
+    }
+    values.push_back(value);
+  }
+  return values;
+}
+
+llvm::Error qssc::frontend::openqasm3::setInputParameterValues(
+    mlir::ModuleOp moduleOp, llvm::ArrayRef<double> values) {
+  auto declareParameterOps = moduleOp.getOps<mlir::qcs::DeclareParameterOp>();
+  if (static_cast<size_t>(std::distance(declareParameterOps.begin(),
+                                        declareParameterOps.end())) !=
+      values.size())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Number of input parameter values does not match the module");
+
+  for (auto [declareParameterOp, value] :
+       llvm::zip(declareParameterOps, values)) {
+    auto initialValue = declareParameterOp.getInitialValue();
+    if (!initialValue)
+      continue;
+    if (auto angleAttr = initialValue->dyn_cast<mlir::quir::AngleAttr>())
+      declareParameterOp.setInitialValueAttr(mlir::quir::AngleAttr::get(
+          angleAttr.getType(), llvm::APFloat(value)));
+    else if (auto floatAttr = initialValue->dyn_cast<mlir::FloatAttr>())
+      declareParameterOp.setInitialValueAttr(
+          mlir::FloatAttr::get(floatAttr.getType(), value));
+  }
+  return llvm::Error::success();
+}
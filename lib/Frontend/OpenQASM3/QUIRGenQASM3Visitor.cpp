@@ -146,9 +146,56 @@ llvm::cl::opt<bool> debugCircuits("debug-circuits",
                                   llvm::cl::desc("debug quir circuits"),
                                   llvm::cl::init(false));
 
+llvm::cl::opt<bool> lazyGateDeclarations(
+    "lazy-gate-declarations",
+    llvm::cl::desc("only generate gate declarations which are referenced by "
+                   "the program"),
+    llvm::cl::init(false));
+
+enum class LocationMode { Full, Line, None };
+
+llvm::cl::opt<LocationMode> locationMode(
+    "qasm3-locations",
+    llvm::cl::desc("the source locations attached to the generated "
+                   "operations; diagnostics of the frontend always report "
+                   "the full location"),
+    llvm::cl::values(
+        clEnumValN(LocationMode::Full, "full",
+                   "the line and column of each AST node (default)"),
+        clEnumValN(LocationMode::Line, "line",
+                   "one location per source line, shared by the operations "
+                   "generated for the statements on it"),
+        clEnumValN(LocationMode::None, "none",
+                   "unknown locations, for the smallest IR")),
+    llvm::cl::init(LocationMode::Full));
+
 } // anonymous namespace
 
+std::string QUIRGenQASM3Visitor::getOptionsKey() {
+  // debug-circuits does not change the module
+  return "enable-parameters=" + std::to_string(enableParameters) +
+         ";enable-circuits-from-qasm=" + std::to_string(enableCircuits) +
+         ";lazy-gate-declarations=" + std::to_string(lazyGateDeclarations) +
+         ";qasm3-locations=" +
+         std::to_string(static_cast<int>(locationMode.getValue()));
+}
+
 auto QUIRGenQASM3Visitor::getLocation(const ASTBase *node) -> Location {
+  // every distinct location is uniqued in the context for its lifetime and
+  // is duplicated into fused locations when operations are cloned or merged
+  switch (locationMode) {
+  case LocationMode::Full:
+    return getSourceLocation(node);
+  case LocationMode::Line:
+    return getSourceLocation(node, /*withColumn=*/false);
+  case LocationMode::None:
+    return builder.getUnknownLoc();
+  }
+  llvm_unreachable("unknown location mode");
+}
+
+auto QUIRGenQASM3Visitor::getSourceLocation(const ASTBase *node,
+                                            bool withColumn) -> Location {
 
   // Workaround for https://github.com/openqasm/qe-qasm/issues/35
   // TODO: Remove once this bug is fixed
@@ -157,7 +204,7 @@ auto QUIRGenQASM3Visitor::getLocation(const ASTBase *node) -> Location {
     lineNo++;
 
   return mlir::FileLineColLoc::get(builder.getContext(), fileName, lineNo,
-                                   node->GetColNo());
+                                   withColumn ? node->GetColNo() : 0);
 }
 
 auto QUIRGenQASM3Visitor::assign(Value &val, const std::string &valName)
@@ -338,9 +385,25 @@ void QUIRGenQASM3Visitor::setInputFile(std::string fName) {
 
 mlir::LogicalResult QUIRGenQASM3Visitor::walkAST() {
   BaseQASM3Visitor::walkAST();
+
+  // Generating a gate declaration may reference further gates, which are
+  // appended to the list while it is processed.
+  for (size_t idx = 0; idx < referencedGateDeclarations.size(); ++idx)
+    generateGateDeclaration(referencedGateDeclarations[idx]);
+  referencedGateDeclarations.clear();
+  deferredGateDeclarations.clear();
+
   return hasFailed ? mlir::failure() : mlir::success();
 }
 
+void QUIRGenQASM3Visitor::referenceGateDeclaration(llvm::StringRef name) {
+  auto deferred = deferredGateDeclarations.find(name);
+  if (deferred == deferredGateDeclarations.end())
+    return;
+  referencedGateDeclarations.push_back(deferred->second);
+  deferredGateDeclarations.erase(deferred);
+}
+
 mlir::InFlightDiagnostic
 QUIRGenQASM3Visitor::reportError(ASTBase const *location,
                                  mlir::DiagnosticSeverity severity,
@@ -354,7 +417,8 @@ QUIRGenQASM3Visitor::reportError(ASTBase const *location,
 
   // Create a MLIRQSSCDiagnostic such that the diagnostic will be properly
   // reported by the compilers diagnostic handling APIs.
-  auto inflightDiagnostic = engine.emit(getLocation(location), severity);
+  auto inflightDiagnostic =
+      engine.emit(getSourceLocation(location), severity);
   qssc::encodeQSSCError(context, inflightDiagnostic, qsscErrorCategory);
 
   return inflightDiagnostic;
@@ -724,6 +788,16 @@ void QUIRGenQASM3Visitor::visit(const ASTFunctionCallNode *node) {
 }
 
 void QUIRGenQASM3Visitor::visit(const ASTGateDeclarationNode *node) {
+  if (lazyGateDeclarations) {
+    // the declaration is generated after the walk once it is referenced
+    deferredGateDeclarations.try_emplace(node->GetGateNode()->GetName(), node);
+    return;
+  }
+  generateGateDeclaration(node);
+}
+
+void QUIRGenQASM3Visitor::generateGateDeclaration(
+    const ASTGateDeclarationNode *node) {
   switchCircuit(false, getLocation(node));
 
   const ASTGateNode *gateNode = node->GetGateNode();
@@ -868,6 +942,8 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTGateNode *node) {
 
   auto argsValueRange = ValueRange(args.data(), args.size());
 
+  if (lazyGateDeclarations)
+    referenceGateDeclaration(node->GetName());
   builder.create<CallGateOp>(getLocation(node), node->GetName(), TypeRange{},
                              argsValueRange);
   // no expression value
@@ -62,21 +62,25 @@ void QUIRVariableBuilder::generateVariableDeclaration(
          "require surrounding op with a symbol table (should be the Module)");
   auto surroundingModuleOp = mlir::dyn_cast<mlir::ModuleOp>(*symbolTableOp);
   assert(surroundingModuleOp && "assume symbol table residing in module");
-  builder.setInsertionPoint(&surroundingModuleOp.front());
+
+  // declarations are inserted after each other at the start of the module
+  auto *&last = lastDeclaration[surroundingModuleOp];
+  if (last)
+    builder.setInsertionPointAfter(last);
+  else
+    builder.setInsertionPoint(&surroundingModuleOp.front());
 
   auto declareOp = builder.create<mlir::oq3::DeclareVariableOp>(
       location, variableName, mlir::TypeAttr::get(type));
-
-  if (lastDeclaration.count(surroundingModuleOp))
-    declareOp->moveAfter(lastDeclaration[surroundingModuleOp]);
-
-  lastDeclaration[surroundingModuleOp] = declareOp; // save this to insert after
+  last = declareOp; // save this to insert after
 
   if (isInputVariable)
     declareOp.setInputAttr(builder.getUnitAttr());
   if (isOutputVariable)
     declareOp.setOutputAttr(builder.getUnitAttr());
-  variables.emplace(variableName.str(), type);
+  variables.try_emplace(
+      variableName, Variable{type, mlir::FlatSymbolRefAttr::get(
+                                       declareOp.getSymNameAttr())});
 }
 
 void QUIRVariableBuilder::generateParameterDeclaration(
@@ -145,12 +149,23 @@ void QUIRVariableBuilder::generateArrayVariableDeclaration(
     mlir::Location location, llvm::StringRef variableName,
     mlir::Type elementType, int64_t width) {
 
-  builder.create<mlir::oq3::DeclareArrayOp>(
-      location, builder.getStringAttr(variableName),
-      mlir::TypeAttr::get(elementType), builder.getIndexAttr(width));
-  variables.emplace(
-      variableName.str(),
-      mlir::RankedTensorType::get(mlir::ArrayRef<int64_t>{width}, elementType));
+  auto name = builder.getStringAttr(variableName);
+  builder.create<mlir::oq3::DeclareArrayOp>(location, name,
+                                            mlir::TypeAttr::get(elementType),
+                                            builder.getIndexAttr(width));
+  variables.try_emplace(
+      variableName,
+      Variable{mlir::RankedTensorType::get(mlir::ArrayRef<int64_t>{width},
+                                           elementType),
+               mlir::FlatSymbolRefAttr::get(name)});
+}
+
+mlir::FlatSymbolRefAttr
+QUIRVariableBuilder::getVariableSymbol(llvm::StringRef variableName) {
+  auto pos = variables.find(variableName);
+  if (pos != variables.end())
+    return pos->second.symbol;
+  return mlir::FlatSymbolRefAttr::get(builder.getContext(), variableName);
 }
 
 void QUIRVariableBuilder::generateVariableAssignment(
@@ -158,7 +173,7 @@ void QUIRVariableBuilder::generateVariableAssignment(
     mlir::Value assignedValue) {
 
   getClassicalBuilder().create<mlir::oq3::VariableAssignOp>(
-      location, variableName, assignedValue);
+      location, getVariableSymbol(variableName), assignedValue);
 }
 
 void QUIRVariableBuilder::generateArrayVariableElementAssignment(
@@ -166,8 +181,7 @@ void QUIRVariableBuilder::generateArrayVariableElementAssignment(
     mlir::Value assignedValue, size_t elementIndex) {
 
   builder.create<mlir::oq3::AssignArrayElementOp>(
-      location,
-      mlir::FlatSymbolRefAttr::get(builder.getStringAttr(variableName)),
+      location, getVariableSymbol(variableName),
       builder.getIndexAttr(elementIndex), assignedValue);
 }
 
@@ -188,9 +202,7 @@ void QUIRVariableBuilder::generateCBitSingleBitAssignment(
 
 #else
   getClassicalBuilder().create<mlir::oq3::CBitAssignBitOp>(
-      location,
-      mlir::SymbolRefAttr::get(
-          getClassicalBuilder().getStringAttr(variableName)),
+      location, getVariableSymbol(variableName),
       getClassicalBuilder().getIndexAttr(bitPosition),
       getClassicalBuilder().getIndexAttr(registerWidth), assignedValue);
 #endif
@@ -201,7 +213,7 @@ QUIRVariableBuilder::generateVariableUse(mlir::Location location,
                                          llvm::StringRef variableName,
                                          mlir::Type variableType) {
   return getClassicalBuilder().create<mlir::oq3::VariableLoadOp>(
-      location, variableType, variableName);
+      location, variableType, getVariableSymbol(variableName));
 }
 
 mlir::Value QUIRVariableBuilder::generateArrayVariableElementUse(
@@ -209,8 +221,7 @@ mlir::Value QUIRVariableBuilder::generateArrayVariableElementUse(
     mlir::Type elementType) {
 
   return builder.create<mlir::oq3::UseArrayElementOp>(
-      location, elementType,
-      mlir::SymbolRefAttr::get(builder.getStringAttr(variableName)),
+      location, elementType, getVariableSymbol(variableName),
       builder.getIndexAttr(elementIndex));
 }
 
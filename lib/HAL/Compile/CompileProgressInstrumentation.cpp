@@ -0,0 +1,41 @@
+//===- CompileProgressInstrumentation.cpp - Pass progress -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass instrumentation reporting the passes of a
+///  compilation to its progress callback.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/CompileProgressInstrumentation.h"
+
+#include "Utils/CompileControl.h"
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "llvm/ADT/StringRef.h"
+
+using namespace qssc::hal::compile;
+
+void CompileProgressInstrumentation::runBeforePass(mlir::Pass *pass,
+                                                   mlir::Operation *op) {
+  // adaptors running nested pipelines have no argument
+  llvm::StringRef const argument = pass->getArgument();
+  if (argument.empty() || !llvm::isa<mlir::ModuleOp>(op))
+    return;
+  auto *control = qssc::utils::getContextCompileControl(op->getContext());
+  if (control)
+    control->reportProgress(prefix + "pass " + argument.str());
+}
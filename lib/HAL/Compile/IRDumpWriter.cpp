@@ -0,0 +1,99 @@
+//===- IRDumpWriter.cpp - Background writer of IR dumps ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/IRDumpWriter.h"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+using namespace qssc::hal::compile;
+
+IRDumpWriter::~IRDumpWriter() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  dumpQueued.notify_one();
+  if (writerThread.joinable())
+    writerThread.join();
+}
+
+void IRDumpWriter::write(std::string contents, llvm::raw_ostream &out) {
+  enqueue_({std::move(contents), &out, std::string()});
+}
+
+void IRDumpWriter::write(std::string contents, std::string path) {
+  enqueue_({std::move(contents), nullptr, std::move(path)});
+}
+
+void IRDumpWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex);
+  dumpsWritten.wait(lock, [&]() { return dumps.empty() && !writing; });
+}
+
+void IRDumpWriter::enqueue_(Dump dump) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    dumps.push_back(std::move(dump));
+    if (!writerThread.joinable())
+      writerThread = std::thread([this]() { run_(); });
+  }
+  dumpQueued.notify_one();
+}
+
+void IRDumpWriter::run_() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    dumpQueued.wait(lock, [&]() { return !dumps.empty() || stopping; });
+    if (dumps.empty())
+      return;
+
+    Dump dump = std::move(dumps.front());
+    dumps.pop_front();
+    writing = true;
+    lock.unlock();
+
+    if (dump.out) {
+      *dump.out << dump.contents;
+      dump.out->flush();
+    } else {
+      std::error_code ec = llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(dump.path));
+      llvm::raw_fd_ostream file(dump.path, ec, llvm::sys::fs::OF_None);
+      if (!ec) {
+        file << dump.contents;
+        file.close();
+        ec = file.error();
+        file.clear_error();
+      }
+      if (ec)
+        llvm::errs() << "Unable to write IR dump " << dump.path << ": "
+                     << ec.message() << "\n";
+    }
+
+    lock.lock();
+    writing = false;
+    if (dumps.empty())
+      dumpsWritten.notify_all();
+  }
+}
@@ -0,0 +1,124 @@
+//===- PassMemoryInstrumentation.cpp ---------------------------*- C++ -*--===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass instrumentation attributing memory growth
+///  to passes and targets.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/PassMemoryInstrumentation.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Process.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <tuple>
+
+using namespace qssc::hal::compile;
+
+void PassMemoryReport::record(llvm::StringRef target, llvm::StringRef pass,
+                              int64_t peakRSSGrowth, int64_t heapGrowth,
+                              bool failed) {
+  std::lock_guard<std::mutex> const lock(mutex);
+  Entry &entry = entries[{target.str(), pass.str()}];
+  ++entry.runs;
+  entry.failures += failed;
+  entry.peakRSSGrowth += peakRSSGrowth;
+  entry.heapGrowth += heapGrowth;
+  entry.maxHeapGrowth = std::max(entry.maxHeapGrowth, heapGrowth);
+}
+
+void PassMemoryReport::print(llvm::raw_ostream &os) const {
+  std::lock_guard<std::mutex> const lock(mutex);
+  llvm::SmallVector<const std::pair<std::pair<std::string, std::string>,
+                                    Entry> *>
+      sorted;
+  for (const auto &entry : entries)
+    sorted.push_back(&entry);
+  llvm::stable_sort(sorted, [](const auto *lhs, const auto *rhs) {
+    return std::make_tuple(lhs->second.peakRSSGrowth,
+                           lhs->second.maxHeapGrowth) >
+           std::make_tuple(rhs->second.peakRSSGrowth,
+                           rhs->second.maxHeapGrowth);
+  });
+
+  auto kib = [](int64_t bytes) {
+    return llvm::format("%10lld", static_cast<long long>(bytes / 1024));
+  };
+  os << "===- Pass memory report -===\n"
+     << "  Peak RSS (KiB)  Heap (KiB)  Max heap (KiB)  Runs  Target / Pass\n";
+  for (const auto *entry : sorted) {
+    const auto &[target, pass] = entry->first;
+    os << "      " << kib(entry->second.peakRSSGrowth) << "  "
+       << kib(entry->second.heapGrowth) << "      "
+       << kib(entry->second.maxHeapGrowth) << "  "
+       << llvm::format("%4u", entry->second.runs) << "  "
+       << (target.empty() ? "<pipeline>" : target) << " / " << pass;
+    if (entry->second.failures)
+      os << " (" << entry->second.failures << " failed)";
+    os << "\n";
+  }
+}
+
+PassMemoryInstrumentation::Sample PassMemoryInstrumentation::sample() {
+  Sample sample{0, static_cast<int64_t>(llvm::sys::Process::GetMallocUsage())};
+  struct rusage usage {};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    sample.peakRSS = usage.ru_maxrss;
+#else
+    sample.peakRSS = static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+  }
+  return sample;
+}
+
+void PassMemoryInstrumentation::runBeforePass(mlir::Pass *pass,
+                                              mlir::Operation *op) {
+  auto const current = sample();
+  std::lock_guard<std::mutex> const lock(mutex);
+  before[{pass, op}] = current;
+}
+
+void PassMemoryInstrumentation::runAfterPass(mlir::Pass *pass,
+                                             mlir::Operation *op) {
+  recordRun(pass, op, /*failed=*/false);
+}
+
+void PassMemoryInstrumentation::runAfterPassFailed(mlir::Pass *pass,
+                                                   mlir::Operation *op) {
+  recordRun(pass, op, /*failed=*/true);
+}
+
+void PassMemoryInstrumentation::recordRun(mlir::Pass *pass,
+                                          mlir::Operation *op, bool failed) {
+  auto const current = sample();
+  Sample start{};
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto it = before.find({pass, op});
+    if (it == before.end())
+      return;
+    start = it->second;
+    before.erase(it);
+  }
+  report->record(target, pass->getName(), current.peakRSS - start.peakRSS,
+                 current.heap - start.heap, failed);
+}
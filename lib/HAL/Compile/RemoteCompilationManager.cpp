@@ -0,0 +1,265 @@
+//===- RemoteCompilationManager.cpp - Remote subtrees -----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the compilation manager offloading the compilation
+///  of target subtrees to workers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/RemoteCompilationManager.h"
+
+#include "HAL/Compile/ThreadedCompilationManager.h"
+#include "HAL/TargetSystem.h"
+#include "Payload/Payload.h"
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace qssc;
+using namespace qssc::hal::compile;
+
+namespace {
+
+llvm::Error serializeModule(mlir::ModuleOp moduleOp, std::string &bytecode) {
+  llvm::raw_string_ostream os(bytecode);
+  if (mlir::failed(mlir::writeBytecodeToFile(moduleOp, os)))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to serialize the module to "
+                                   "bytecode");
+  os.flush();
+  return llvm::Error::success();
+}
+
+llvm::Expected<mlir::OwningOpRef<mlir::ModuleOp>>
+deserializeModule(llvm::StringRef bytecode, mlir::MLIRContext *context) {
+  mlir::ParserConfig const config(context);
+  auto moduleOp = mlir::parseSourceString<mlir::ModuleOp>(bytecode, config);
+  if (!moduleOp)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to parse the module bytecode");
+  return std::move(moduleOp);
+}
+
+} // anonymous namespace
+
+std::vector<std::string> qssc::hal::compile::getTargetPath(Target &target) {
+  std::vector<std::string> path;
+  for (Target *current = &target; current; current = current->getParent())
+    path.push_back(current->getName().str());
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+llvm::Expected<Target *>
+qssc::hal::compile::lookupTargetPath(Target &root,
+                                     llvm::ArrayRef<std::string> path) {
+  auto notFound = [&]() {
+    std::string joined;
+    for (const auto &name : path)
+      joined += (joined.empty() ? "" : "/") + name;
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Could not find the target " + joined +
+                                       " in target system " +
+                                       root.getName().str());
+  };
+
+  if (path.empty() || path.front() != root.getName())
+    return notFound();
+
+  Target *current = &root;
+  for (const auto &name : path.drop_front()) {
+    auto children = current->getChildren();
+    auto it = std::find_if(
+        children.begin(), children.end(),
+        [&](Target *child) { return child->getName() == name; });
+    if (it == children.end())
+      return notFound();
+    current = *it;
+  }
+  return current;
+}
+
+RemoteCompilationWorker::RemoteCompilationWorker(
+    hal::TargetSystem &target, mlir::MLIRContext *context,
+    ThreadedCompilationManager::PMBuilder pmBuilder)
+    : target(target), context(context),
+      manager(target, context, std::move(pmBuilder)) {}
+
+llvm::Expected<RemoteCompileResult>
+RemoteCompilationWorker::compile(const RemoteCompileRequest &request,
+                                 qssc::payload::Payload &payload) {
+  const std::lock_guard<std::mutex> lock(mutex);
+
+  auto subtreeRoot = lookupTargetPath(target, request.targetPath);
+  if (auto err = subtreeRoot.takeError())
+    return std::move(err);
+
+  auto moduleOp = deserializeModule(request.moduleBytecode, context);
+  if (auto err = moduleOp.takeError())
+    return std::move(err);
+
+  payload.setProfile(request.payloadProfile);
+  auto compileErr = manager.compileSubtreePayload(
+      **subtreeRoot, **moduleOp, payload, request.doCompileMLIR);
+
+  RemoteCompileResult result;
+  result.diagnostics = manager.takeTargetDiagnostics();
+  if (compileErr)
+    return std::move(compileErr);
+
+  result.payloadFiles = payload.takeFiles();
+  if (request.returnLoweredModule)
+    if (auto err = serializeModule(**moduleOp, result.loweredModuleBytecode))
+      return std::move(err);
+  return std::move(result);
+}
+
+llvm::Expected<RemoteCompileResult>
+InProcessTargetExecutor::compileSubtree(const RemoteCompileRequest &request) {
+  ++numRequests;
+  auto payload = createPayload();
+  return worker.compile(request, *payload);
+}
+
+RemoteCompilationManager::RemoteCompilationManager(
+    qssc::hal::TargetSystem &target, mlir::MLIRContext *context,
+    PMBuilder pmBuilder, std::shared_ptr<RemoteTargetExecutor> executor,
+    unsigned offloadDepth)
+    : ThreadedCompilationManager(target, context, std::move(pmBuilder)),
+      executor(std::move(executor)), offloadDepth(offloadDepth) {}
+
+const std::string RemoteCompilationManager::getName() const {
+  return "RemoteCompilationManager";
+}
+
+unsigned RemoteCompilationManager::getDepth_(Target *target) {
+  unsigned depth = 0;
+  for (; target != &getTargetSystem(); target = target->getParent())
+    ++depth;
+  return depth;
+}
+
+llvm::Error
+RemoteCompilationManager::compilePayload(mlir::ModuleOp moduleOp,
+                                         qssc::payload::Payload &payload,
+                                         bool doCompileMLIR) {
+
+  auto compilePayloadTiming = getTimer("compile-payload");
+
+  auto &target = getTargetSystem();
+
+  // The targets above the offloaded ones are compiled locally
+  if (auto err = buildTargetPassManagers_(target, compilePayloadTiming))
+    return err;
+
+  auto threadedCompilePayloadTarget =
+      [&](hal::Target *target, mlir::ModuleOp targetModuleOp,
+          mlir::TimingScope &timing) -> llvm::Error {
+    if (getDepth_(target) == offloadDepth)
+      return offloadSubtree_(*target, targetModuleOp, payload, timing,
+                             doCompileMLIR);
+    return compilePayloadTarget_(*target, targetModuleOp, payload, timing,
+                                 doCompileMLIR);
+  };
+
+  auto postChildrenEmitToPayload =
+      [&](hal::Target *target, mlir::ModuleOp targetModuleOp,
+          mlir::TimingScope &timing) -> llvm::Error {
+    // The worker of an offloaded target emitted its post-children payload
+    if (getDepth_(target) == offloadDepth)
+      return llvm::Error::success();
+
+    auto emitToPayloadTiming = timing.nest("emit-to-payload-post-children");
+    target->enableTiming(emitToPayloadTiming);
+    if (auto err = target->emitToPayloadPostChildren(targetModuleOp, payload))
+      return err;
+    target->disableTiming();
+
+    return llvm::Error::success();
+  };
+
+  // The subtrees of offloaded targets are compiled by their workers
+  auto skipChildren = [&](hal::Target *target) {
+    return getDepth_(target) == offloadDepth;
+  };
+
+  auto targetsTiming = compilePayloadTiming.nest("compile-system");
+  return walkTargetModulesThreaded(&target, moduleOp, targetsTiming,
+                                   threadedCompilePayloadTarget,
+                                   postChildrenEmitToPayload, skipChildren);
+}
+
+llvm::Error RemoteCompilationManager::offloadSubtree_(
+    Target &target, mlir::ModuleOp targetModuleOp,
+    qssc::payload::Payload &payload, mlir::TimingScope &timing,
+    bool doCompileMLIR) {
+  RemoteCompileRequest request;
+  request.targetPath = getTargetPath(target);
+  request.doCompileMLIR = doCompileMLIR;
+  request.returnLoweredModule = returnLoweredModules;
+  request.payloadProfile = payload.getProfile();
+
+  auto serializeTiming = timing.nest("serialize-module");
+  if (auto err = serializeModule(targetModuleOp, request.moduleBytecode))
+    return err;
+  serializeTiming.stop();
+
+  auto remoteTiming = timing.nest("remote-compile");
+  auto result = executor->compileSubtree(request);
+  remoteTiming.stop();
+  if (auto err = result.takeError())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Remote compilation of target " + target.getName() +
+            " failed: " + llvm::toString(std::move(err)));
+
+  for (auto &diag : result->diagnostics)
+    target.addDiagnostic(diag);
+
+  auto mergeTiming = timing.nest("merge-payload");
+  for (auto &[fileName, contents] : result->payloadFiles)
+    payload.addFile(fileName, std::move(contents));
+
+  if (result->loweredModuleBytecode.empty())
+    return llvm::Error::success();
+
+  // Replace the local module with the lowered one in place, the module
+  // operation itself remains owned by the module of the parent target.
+  auto loweredModuleOp =
+      deserializeModule(result->loweredModuleBytecode, getContext());
+  if (auto err = loweredModuleOp.takeError())
+    return err;
+  targetModuleOp.getBodyRegion().takeBody((*loweredModuleOp)->getBodyRegion());
+  targetModuleOp->setAttrs((*loweredModuleOp)->getAttrDictionary());
+  return llvm::Error::success();
+}
@@ -1,6 +1,6 @@
 //===- TargetCompilationManager.cpp ----------------------------*- C++ -*--===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -33,6 +33,8 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <string>
+
 using namespace qssc::hal::compile;
 
 namespace {
@@ -57,6 +59,16 @@ struct TargetCompilationManagerOptions {
       "print-ir-after-target-compile-failure",
       llvm::cl::desc("Print IR after failure of applying target compilation"),
       llvm::cl::init(false)};
+  llvm::cl::opt<std::string> targetIRDumpDirectory{
+      "target-ir-dump-dir",
+      llvm::cl::desc("Write the target IR dumps to a file per target and "
+                     "stage in this directory rather than to stdout"),
+      llvm::cl::value_desc("directory"), llvm::cl::init("")};
+  llvm::cl::opt<bool> targetIRDumpBytecode{
+      "target-ir-dump-bytecode",
+      llvm::cl::desc("Write the target IR dumps of --target-ir-dump-dir as "
+                     "MLIR bytecode"),
+      llvm::cl::init(false)};
 };
 
 llvm::ManagedStatic<TargetCompilationManagerOptions> options;
@@ -78,6 +90,8 @@ mlir::LogicalResult qssc::hal::compile::applyTargetCompilationManagerCLOptions(
                              options->printAfterAllTargetPasses,
                              options->printBeforeAllTargetPayload,
                              options->printAfterTargetCompileFailure);
+  scheduler.enableIRDumpDirectory(options->targetIRDumpDirectory,
+                                  options->targetIRDumpBytecode);
 
   return mlir::success();
 }
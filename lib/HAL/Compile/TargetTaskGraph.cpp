@@ -0,0 +1,236 @@
+//===- TargetTaskGraph.cpp - Target tree dependency graph -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the dependency graph scheduler used to walk a target
+///  system tree in parallel.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/TargetTaskGraph.h"
+
+#include "HAL/TargetSystem.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#define DEBUG_TYPE "target-task-graph"
+
+using namespace qssc::hal::compile;
+
+struct TargetTaskGraph::Node {
+  Node(hal::Target *target, Node *parent, size_t order)
+      : target(target), parent(parent), order(order) {}
+
+  hal::Target *target;
+  Node *parent;
+  // Position of the target in a depth-first walk of the target tree
+  size_t order;
+  std::vector<Node *> children;
+
+  // State of the current run
+  mlir::ModuleOp moduleOp;
+  bool childrenSkipped = false;
+  mlir::TimingScope timing;
+  mlir::TimingScope childrenTiming;
+  std::atomic<size_t> pendingChildren = 0;
+  Clock::time_point start;
+  Clock::time_point preChildrenEnd;
+  Clock::time_point postChildrenStart;
+  Clock::time_point end;
+};
+
+TargetTaskGraph::TargetTaskGraph(mlir::MLIRContext *context,
+                                 hal::Target *root)
+    : context(context) {
+  rootNode = buildNodes_(root, nullptr);
+}
+
+TargetTaskGraph::~TargetTaskGraph() = default;
+
+TargetTaskGraph::Node *TargetTaskGraph::buildNodes_(hal::Target *target,
+                                                    Node *parent) {
+  auto *node =
+      nodes.emplace_back(std::make_unique<Node>(target, parent, nodes.size()))
+          .get();
+  for (auto *child : target->getChildren())
+    node->children.push_back(buildNodes_(child, node));
+  return node;
+}
+
+llvm::Error TargetTaskGraph::run(mlir::ModuleOp rootModuleOp,
+                                 mlir::TimingScope &timing,
+                                 const TaskFunction &preChildrenFunc,
+                                 const TaskFunction &postChildrenFunc) {
+  llvm::Error runErrors = llvm::Error::success();
+
+  rootTiming = &timing;
+  this->preChildrenFunc = &preChildrenFunc;
+  this->postChildrenFunc = &postChildrenFunc;
+  errors = &runErrors;
+  failed = false;
+  criticalPath.clear();
+  rootNode->moduleOp = rootModuleOp;
+
+  if (context->isMultithreadingEnabled()) {
+    // By utilizing the MLIR context's thread pool we automatically inherit
+    // the multiprocessing settings from the context.
+    // Diagnostics are buffered per target and reported in the order of the
+    // targets when the handler is destroyed after all tasks completed.
+    mlir::ParallelDiagnosticHandler handler(context);
+    diagnosticHandler = &handler;
+    llvm::ThreadPoolTaskGroup tasks(context->getThreadPool());
+    submit = [&](Node *node) {
+      tasks.async([this, node] { runPreChildren_(node); });
+    };
+    runPreChildren_(rootNode);
+    tasks.wait();
+    diagnosticHandler = nullptr;
+  } else {
+    submit = [&](Node *node) { runPreChildren_(node); };
+    runPreChildren_(rootNode);
+  }
+
+  submit = nullptr;
+  errors = nullptr;
+
+  if (!failed)
+    computeCriticalPath_();
+
+  return runErrors;
+}
+
+void TargetTaskGraph::runPreChildren_(Node *node) {
+  if (failed)
+    return;
+
+  setDiagnosticOrder_(node);
+  node->start = Clock::now();
+  node->timing = node->parent ? node->parent->childrenTiming.nest(
+                                    node->target->getName())
+                              : rootTiming->nest(node->target->getName());
+
+  if (auto err = (*preChildrenFunc)(node->target, node->moduleOp,
+                                    node->timing)) {
+    recordError_(std::move(err));
+    return;
+  }
+
+  node->childrenSkipped = skipChildrenFunc && skipChildrenFunc(node->target);
+  if (node->children.empty() || node->childrenSkipped) {
+    node->preChildrenEnd = Clock::now();
+    runPostChildren_(node);
+    return;
+  }
+
+  // Get child modules in a non-threaded fashion to preserve
+  // MLIR parallelization rules
+  for (auto *child : node->children) {
+    if (!node->moduleOp) {
+      child->moduleOp = nullptr;
+      continue;
+    }
+    auto childModuleOp = child->target->getModule(node->moduleOp);
+    if (auto err = childModuleOp.takeError()) {
+      recordError_(std::move(err));
+      return;
+    }
+    child->moduleOp = *childModuleOp;
+  }
+
+  node->childrenTiming = node->timing.nest("children");
+  node->pendingChildren = node->children.size();
+  node->preChildrenEnd = Clock::now();
+
+  for (auto *child : node->children)
+    submit(child);
+}
+
+void TargetTaskGraph::runPostChildren_(Node *node) {
+  if (failed)
+    return;
+
+  // The last child to complete runs its parent's task on its own thread
+  setDiagnosticOrder_(node);
+  node->postChildrenStart = Clock::now();
+  node->childrenTiming.stop();
+
+  if (auto err = (*postChildrenFunc)(node->target, node->moduleOp,
+                                     node->timing)) {
+    recordError_(std::move(err));
+    return;
+  }
+
+  node->timing.stop();
+  node->end = Clock::now();
+
+  // The last child to complete continues with its parent rather than
+  // blocking a thread on the parent's children.
+  if (node->parent && --node->parent->pendingChildren == 0)
+    runPostChildren_(node->parent);
+}
+
+void TargetTaskGraph::setDiagnosticOrder_(Node *node) {
+  if (diagnosticHandler)
+    diagnosticHandler->setOrderIDForThread(node->order);
+}
+
+void TargetTaskGraph::recordError_(llvm::Error err) {
+  failed = true;
+  const std::lock_guard<std::mutex> lock(errorMutex);
+  *errors = llvm::joinErrors(std::move(*errors), std::move(err));
+}
+
+void TargetTaskGraph::computeCriticalPath_() {
+  for (Node *node = rootNode; node;) {
+    auto duration = (node->preChildrenEnd - node->start) +
+                    (node->end - node->postChildrenStart);
+    criticalPath.push_back({node->target, duration});
+    if (node->childrenSkipped)
+      break;
+
+    // The child which completed last delayed its parent's post-children task.
+    auto last = std::max_element(
+        node->children.begin(), node->children.end(),
+        [](const Node *a, const Node *b) { return a->end < b->end; });
+    node = last == node->children.end() ? nullptr : *last;
+  }
+
+  LLVM_DEBUG({
+    llvm::dbgs() << "Target critical path:\n";
+    for (const auto &entry : criticalPath)
+      llvm::dbgs() << "  " << entry.target->getName() << ": "
+                   << std::chrono::duration<double, std::milli>(
+                          entry.duration)
+                          .count()
+                   << " ms\n";
+  });
+}
@@ -1,6 +1,6 @@
 //===- TargetCompilationManager.cpp ----------------------------*- C++ -*--===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -16,28 +16,39 @@
 
 #include "HAL/Compile/ThreadedCompilationManager.h"
 
+#include "HAL/Compile/IRDumpWriter.h"
+#include "HAL/Compile/CompileProgressInstrumentation.h"
+#include "HAL/Compile/PassMemoryInstrumentation.h"
 #include "HAL/Compile/TargetCompilationManager.h"
+#include "HAL/Compile/TargetTaskGraph.h"
+#include "HAL/TargetOperationPass.h"
 #include "HAL/TargetSystem.h"
 #include "Payload/Payload.h"
+#include "Utils/CompileBudget.h"
+#include "Utils/CompileControl.h"
 
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Operation.h"
-#include "mlir/IR/Threading.h"
+#include "mlir/IR/Verifier.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <string>
-#include <unordered_map>
 #include <utility>
 
 using namespace qssc;
@@ -56,101 +67,36 @@ const std::string ThreadedCompilationManager::getName() const {
 llvm::Error ThreadedCompilationManager::walkTargetModulesThreaded(
     Target *target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing,
     const WalkTargetModulesFunction &walkFunc,
-    const WalkTargetModulesFunction &postChildrenCallbackFunc) {
-
-  auto parentTiming = timing.nest(target->getName());
-
-  if (auto err = walkFunc(target, targetModuleOp, parentTiming))
-    return err;
-
-  // Get child modules in a non-threaded fashion to preserve
-  // MLIR parallelization rules
-  auto children = target->getChildren();
-
-  // Check if there are children to walk. If not exit early
-  if (children.size()) {
-
-    auto childrenTiming = parentTiming.nest("children");
-
-    std::unordered_map<Target *, mlir::ModuleOp> childrenModules;
-    for (auto *childTarget : children) {
-      auto childModuleOp = childTarget->getModule(targetModuleOp);
-      if (auto err = childModuleOp.takeError())
-        return err;
-      childrenModules[childTarget] = *childModuleOp;
-    }
-
-    auto parallelWalkFunc = [&](Target *childTarget) {
-      // Recurse on this target's children in a depth first fashion.
-
-      if (auto err = walkTargetModulesThreaded(
-              childTarget, childrenModules[childTarget], childrenTiming,
-              walkFunc, postChildrenCallbackFunc)) {
-        llvm::errs() << err << "\n";
-        return mlir::failure();
-      }
-
-      return mlir::success();
-    };
-
-    // By utilizing the MLIR parallelism methods, we automatically inherit the
-    // multiprocessing settings from the context.
-    if (mlir::failed(mlir::failableParallelForEach(getContext(), children,
-                                                   parallelWalkFunc)))
-      return llvm::createStringError(
-          llvm::inconvertibleErrorCode(),
-          "Problems encountered while walking children of target " +
-              target->getName());
-  }
-
-  if (auto err = postChildrenCallbackFunc(target, targetModuleOp, parentTiming))
-    return err;
-
-  return llvm::Error::success();
+    const WalkTargetModulesFunction &postChildrenCallbackFunc,
+    TargetTaskGraph::SkipChildrenFunction skipChildren) {
+  TargetTaskGraph graph(getContext(), target);
+  graph.setSkipChildrenFunction(std::move(skipChildren));
+  return graph.run(targetModuleOp, timing, walkFunc, postChildrenCallbackFunc);
 }
 
 llvm::Error ThreadedCompilationManager::walkTargetThreaded(
     Target *target, mlir::TimingScope &timing,
     const WalkTargetFunction &walkFunc) {
-
-  auto parentTiming = timing.nest(target->getName());
-  if (auto err = walkFunc(target, parentTiming))
-    return err;
-
-  auto children = target->getChildren();
-
-  // Check if there are children to walk. If not exit early
-  if (!children.size())
+  auto preChildrenFunc = [&](Target *target, mlir::ModuleOp /*moduleOp*/,
+                             mlir::TimingScope &timing) -> llvm::Error {
+    return walkFunc(target, timing);
+  };
+  auto postChildrenFunc = [](Target * /*target*/, mlir::ModuleOp /*moduleOp*/,
+                             mlir::TimingScope & /*timing*/) -> llvm::Error {
     return llvm::Error::success();
-
-  auto childrenTiming = parentTiming.nest("children");
-
-  auto parallelWalkFunc = [&](Target *childTarget) {
-    // Recurse on this target's children in a depth first fashion.
-
-    if (auto err = walkTargetThreaded(childTarget, childrenTiming, walkFunc)) {
-      llvm::errs() << err << "\n";
-      return mlir::failure();
-    }
-
-    return mlir::success();
   };
 
-  // By utilizing the MLIR parallelism methods, we automatically inherit the
-  // multiprocessing settings from the context.
-  if (mlir::failed(mlir::failableParallelForEach(getContext(), children,
-                                                 parallelWalkFunc)))
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        "Problems encountered while walking children of target " +
-            target->getName());
-
-  return llvm::Error::success();
+  TargetTaskGraph graph(getContext(), target);
+  return graph.run(/*rootModuleOp=*/nullptr, timing, preChildrenFunc,
+                   postChildrenFunc);
 }
 
 llvm::Error ThreadedCompilationManager::buildTargetPassManagers_(
     Target &target, mlir::TimingScope &timing) {
 
+  // The pass managers are not reused across compilations: target passes keep
+  // members such as counters and caches from one run to the next, which a
+  // PassManager has no means to reset.
   auto buildPMTiming = timing.nest("build-target-pass-managers");
 
   // Create dummy timing scope for pass manager building
@@ -169,6 +115,18 @@ llvm::Error ThreadedCompilationManager::buildTargetPassManagers_(
       return err;
     target->disableTiming();
 
+    // Hand the target to the target passes rather than having each of them
+    // look it up in the target registry
+    pm.addInstrumentation(
+        std::make_unique<hal::TargetInjectionInstrumentation>(target));
+
+    if (getPassMemoryReport())
+      pm.addInstrumentation(std::make_unique<PassMemoryInstrumentation>(
+          getPassMemoryReport(), target->getName().str()));
+
+    pm.addInstrumentation(std::make_unique<CompileProgressInstrumentation>(
+        (target->getName() + ": ").str()));
+
     registerPassManagerWithContext_(pm);
 
     return llvm::Error::success();
@@ -208,6 +166,9 @@ mlir::PassManager &
 ThreadedCompilationManager::createTargetPassManager_(Target *target) {
   // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
   std::unique_lock<std::shared_mutex> const lock(targetPassManagersMutex_);
+  // Discard any pass manager built for a previous compilation so that passes
+  // are not appended to an already populated pipeline.
+  targetPassManagers_.erase(target);
   return targetPassManagers_.emplace(target, getContext()).first->second;
 }
 
@@ -242,32 +203,60 @@ llvm::Error ThreadedCompilationManager::compileMLIR(mlir::ModuleOp moduleOp) {
   auto err = walkTargetModulesThreaded(&target, moduleOp, targetsTiming,
                                        threadedCompileMLIRTarget,
                                        postChildrenEmitToPayload);
+  irDumpWriter_.flush();
   return err;
 }
 
 llvm::Error ThreadedCompilationManager::compileMLIRTarget_(
     Target &target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing) {
+  // the remaining targets of a cancelled compilation are not started
+  auto *context = getContext();
+  if (auto err = qssc::utils::checkCompileCancelled(
+          context, ("the passes of target " + target.getName()).str()))
+    return err;
+  qssc::utils::reportCompileProgress(context,
+                                     (target.getName() + ": passes").str());
+
   if (getPrintBeforeAllTargetPasses())
-    printIR("IR dump before running passes for target " + target.getName(),
-            targetModuleOp, llvm::outs());
+    dumpIR(target, "before-passes",
+           "IR dump before running passes for target " + target.getName(),
+           targetModuleOp);
 
   auto targetPassesTiming = timing.nest("passes");
   mlir::PassManager &pm = getTargetPassManager_(&target);
   pm.enableTiming(targetPassesTiming);
 
   if (mlir::failed(pm.run(targetModuleOp))) {
+    // the target passes fail once the compilation is cancelled
+    if (auto err = qssc::utils::checkCompileCancelled(
+            context, ("the end of the passes of target " + target.getName())
+                         .str()))
+      return err;
     if (getPrintAfterTargetCompileFailure())
-      printIR("IR dump after failure emitting payload for target " +
-                  target.getName(),
-              targetModuleOp, llvm::outs());
+      dumpIR(target, "passes-failure",
+             "IR dump after failure emitting payload for target " +
+                 target.getName(),
+             targetModuleOp);
     return llvm::createStringError(
         llvm::inconvertibleErrorCode(),
         "Problems running the pass pipeline for target " + target.getName());
   }
 
+  // The verification is optional and skipped once the compile budget is
+  // exceeded
+  if (getVerifyTargetModules() &&
+      !qssc::utils::shouldSkipOverBudget(targetModuleOp,
+                                         "target module verification") &&
+      mlir::failed(mlir::verify(targetModuleOp)))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Verification failed after the pass "
+                                   "pipeline for target " +
+                                       target.getName());
+
   if (getPrintAfterAllTargetPasses())
-    printIR("IR dump after running passes for target " + target.getName(),
-            targetModuleOp, llvm::outs());
+    dumpIR(target, "after-passes",
+           "IR dump after running passes for target " + target.getName(),
+           targetModuleOp);
 
   return llvm::Error::success();
 }
@@ -276,14 +265,20 @@ llvm::Error
 ThreadedCompilationManager::compilePayload(mlir::ModuleOp moduleOp,
                                            qssc::payload::Payload &payload,
                                            bool doCompileMLIR) {
+  return compileSubtreePayload(getTargetSystem(), moduleOp, payload,
+                               doCompileMLIR);
+}
 
-  auto compilePayloadTiming = getTimer("compile-payload");
+llvm::Error ThreadedCompilationManager::compileSubtreePayload(
+    Target &subtreeRoot, mlir::ModuleOp subtreeModuleOp,
+    qssc::payload::Payload &payload, bool doCompileMLIR) {
 
-  auto &target = getTargetSystem();
+  auto compilePayloadTiming = getTimer("compile-payload");
 
   /// Build target pass managers prior to compilation
   /// to ensure thread safety
-  if (auto err = buildTargetPassManagers_(target, compilePayloadTiming))
+  if (auto err =
+          buildTargetPassManagers_(getTargetSystem(), compilePayloadTiming))
     return err;
 
   auto threadedCompilePayloadTarget =
@@ -308,9 +303,11 @@ ThreadedCompilationManager::compilePayload(mlir::ModuleOp moduleOp,
   };
 
   auto targetsTiming = compilePayloadTiming.nest("compile-system");
-  auto err = walkTargetModulesThreaded(&target, moduleOp, targetsTiming,
+  auto err = walkTargetModulesThreaded(&subtreeRoot, subtreeModuleOp,
+                                       targetsTiming,
                                        threadedCompilePayloadTarget,
                                        postChildrenEmitToPayload);
+  irDumpWriter_.flush();
   return err;
 }
 
@@ -323,17 +320,26 @@ llvm::Error ThreadedCompilationManager::compilePayloadTarget_(
     if (auto err = compileMLIRTarget_(target, targetModuleOp, timing))
       return err;
 
+  auto *context = getContext();
+  if (auto err = qssc::utils::checkCompileCancelled(
+          context, ("the payload of target " + target.getName()).str()))
+    return err;
+  qssc::utils::reportCompileProgress(context,
+                                     (target.getName() + ": payload").str());
+
   if (getPrintBeforeAllTargetPayload())
-    printIR("IR dump before emitting payload for target " + target.getName(),
-            targetModuleOp, llvm::outs());
+    dumpIR(target, "before-payload",
+           "IR dump before emitting payload for target " + target.getName(),
+           targetModuleOp);
 
   auto emitToPayloadTiming = timing.nest("emit-to-payload");
   target.enableTiming(emitToPayloadTiming);
   if (auto err = target.emitToPayload(targetModuleOp, payload)) {
     if (getPrintAfterTargetCompileFailure())
-      printIR("IR dump after failure emitting payload for target " +
-                  target.getName(),
-              targetModuleOp, llvm::outs());
+      dumpIR(target, "payload-failure",
+             "IR dump after failure emitting payload for target " +
+                 target.getName(),
+             targetModuleOp);
     return err;
   }
   target.disableTiming();
@@ -343,6 +349,43 @@ llvm::Error ThreadedCompilationManager::compilePayloadTarget_(
 
 void ThreadedCompilationManager::printIR(llvm::Twine msg, mlir::Operation *op,
                                          llvm::raw_ostream &out) {
+  // Print into a buffer first such that the lock is held for the write only
+  std::string buffer;
+  llvm::raw_string_ostream bufferStream(buffer);
+  TargetCompilationManager::printIR(msg, op, bufferStream);
+  bufferStream.flush();
+
   const std::lock_guard<std::mutex> lock(printIRMutex_);
-  TargetCompilationManager::printIR(msg, op, out);
+  out << buffer;
+}
+
+void ThreadedCompilationManager::dumpIR(Target &target, llvm::StringRef stage,
+                                        llvm::Twine msg, mlir::Operation *op) {
+  std::string dump;
+  llvm::raw_string_ostream dumpStream(dump);
+
+  const std::string &directory = getIRDumpDirectory();
+  if (directory.empty()) {
+    TargetCompilationManager::printIR(msg, op, dumpStream);
+    dumpStream.flush();
+    irDumpWriter_.write(std::move(dump), llvm::outs());
+    return;
+  }
+
+  const bool bytecode = getIRDumpBytecode();
+  if (!bytecode)
+    TargetCompilationManager::printIR(msg, op, dumpStream);
+  else if (mlir::failed(mlir::writeBytecodeToFile(op, dumpStream))) {
+    llvm::errs() << "Unable to write the bytecode of the " << msg << "\n";
+    return;
+  }
+  dumpStream.flush();
+
+  // target names may contain path separators, e.g., those of nested targets
+  std::string fileName = target.getName().str();
+  std::replace(fileName.begin(), fileName.end(), '/', '_');
+  fileName += ("." + stage + (bytecode ? ".mlirbc" : ".mlir")).str();
+  llvm::SmallString<128> path(directory);
+  llvm::sys::path::append(path, fileName);
+  irDumpWriter_.write(std::move(dump), std::string(path));
 }
@@ -1,6 +1,6 @@
 //===- PassRegistration.cpp -------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -34,6 +34,14 @@ llvm::Error hal::registerTargetPasses() {
   return err;
 }
 
+llvm::Error hal::registerTargetPasses(llvm::StringRef targetName) {
+  auto targetInfo =
+      registry::TargetSystemRegistry::lookupPluginInfo(targetName);
+  if (!targetInfo.has_value())
+    return llvm::Error::success();
+  return targetInfo.value()->registerTargetPasses();
+}
+
 llvm::Error hal::registerTargetPipelines() {
   llvm::Error err = llvm::Error::success();
   for (const auto &target :
@@ -43,3 +51,11 @@ llvm::Error hal::registerTargetPipelines() {
   }
   return err;
 }
+
+llvm::Error hal::registerTargetPipelines(llvm::StringRef targetName) {
+  auto targetInfo =
+      registry::TargetSystemRegistry::lookupPluginInfo(targetName);
+  if (!targetInfo.has_value())
+    return llvm::Error::success();
+  return targetInfo.value()->registerTargetPassPipelines();
+}
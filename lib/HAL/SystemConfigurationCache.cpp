@@ -0,0 +1,166 @@
+//===- SystemConfigurationCache.cpp - Config caches -------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the caches of parsed system configurations
+//
+//===----------------------------------------------------------------------===//
+
+#include "HAL/SystemConfigurationCache.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+using namespace qssc::hal;
+
+namespace {
+constexpr char snapshotMagic[8] = {'Q', 'S', 'S', 'C', 'S', 'N', 'A', 'P'};
+constexpr uint32_t snapshotVersion = 1;
+constexpr size_t snapshotHeaderSize = 40;
+
+llvm::Error invalidSnapshot(llvm::StringRef path, const llvm::Twine &what) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Invalid configuration snapshot " + path +
+                                     ": " + what);
+}
+} // anonymous namespace
+
+llvm::Expected<ConfigurationFile>
+qssc::hal::readConfigurationFile(llvm::StringRef configurationPath) {
+  auto buffer = llvm::MemoryBuffer::getFile(configurationPath);
+  if (auto ec = buffer.getError())
+    return llvm::createStringError(ec, "Problem opening file " +
+                                           configurationPath + ": " +
+                                           ec.message());
+  uint64_t const hash =
+      llvm::xxh3_64bits(llvm::arrayRefFromStringRef((*buffer)->getBuffer()));
+  return ConfigurationFile{std::move(*buffer), hash};
+}
+
+std::string qssc::hal::getConfigurationSnapshotPath(llvm::StringRef directory,
+                                                    llvm::StringRef kind,
+                                                    uint64_t hash) {
+  llvm::SmallString<128> path(directory);
+  std::string name;
+  llvm::raw_string_ostream(name)
+      << kind << "-" << llvm::format_hex_no_prefix(hash, 16) << ".snapshot";
+  llvm::sys::path::append(path, name);
+  return path.str().str();
+}
+
+llvm::Error qssc::hal::writeConfigurationSnapshot(llvm::StringRef path,
+                                                  llvm::StringRef kind,
+                                                  uint32_t formatVersion,
+                                                  uint64_t configHash,
+                                                  llvm::StringRef payload) {
+  auto directory = llvm::sys::path::parent_path(path);
+  if (!directory.empty())
+    if (auto ec = llvm::sys::fs::create_directories(directory))
+      return llvm::createStringError(ec, "Failed to create the directory " +
+                                             directory + ": " + ec.message());
+
+  // write to a temporary file next to the snapshot and rename it, which
+  // replaces the snapshot atomically
+  llvm::SmallString<128> tempPath;
+  int fd;
+  if (auto ec = llvm::sys::fs::createUniqueFile(path + ".tmp-%%%%%%%%", fd,
+                                                tempPath))
+    return llvm::createStringError(ec, "Failed to create " + path + ": " +
+                                           ec.message());
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    llvm::support::endian::Writer writer(os, llvm::support::little);
+    os.write(snapshotMagic, sizeof(snapshotMagic));
+    writer.write<uint32_t>(snapshotVersion);
+    writer.write<uint32_t>(static_cast<uint32_t>(kind.size()));
+    writer.write<uint32_t>(formatVersion);
+    writer.write<uint32_t>(0);
+    writer.write<uint64_t>(configHash);
+    writer.write<uint64_t>(payload.size());
+    os << kind << payload;
+    os.close();
+    if (os.has_error()) {
+      auto ec = os.error();
+      os.clear_error();
+      llvm::sys::fs::remove(tempPath);
+      return llvm::createStringError(ec, "Failed to write " + path + ": " +
+                                             ec.message());
+    }
+  }
+  if (auto ec = llvm::sys::fs::rename(tempPath, path)) {
+    llvm::sys::fs::remove(tempPath);
+    return llvm::createStringError(ec, "Failed to write " + path + ": " +
+                                           ec.message());
+  }
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::optional<ConfigurationSnapshot>>
+qssc::hal::readConfigurationSnapshot(llvm::StringRef path,
+                                     llvm::StringRef kind,
+                                     uint32_t formatVersion,
+                                     uint64_t configHash) {
+  using llvm::support::endian::read32le;
+  using llvm::support::endian::read64le;
+
+  // snapshots are never modified in place, hence they may be mapped
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false,
+                                            /*IsVolatile=*/false);
+  if (auto ec = buffer.getError()) {
+    if (ec == std::errc::no_such_file_or_directory)
+      return std::nullopt;
+    return llvm::createStringError(ec, "Failed to open " + path + ": " +
+                                           ec.message());
+  }
+
+  llvm::StringRef const data = (*buffer)->getBuffer();
+  if (data.size() < snapshotHeaderSize ||
+      !data.startswith(llvm::StringRef(snapshotMagic, sizeof(snapshotMagic))))
+    return invalidSnapshot(path, "missing header");
+  const char *header = data.data();
+  if (read32le(header + 8) != snapshotVersion)
+    return std::nullopt;
+  uint32_t const kindSize = read32le(header + 12);
+  uint64_t const payloadSize = read64le(header + 32);
+  if (kindSize > data.size() - snapshotHeaderSize ||
+      payloadSize != data.size() - snapshotHeaderSize - kindSize)
+    return invalidSnapshot(path, "truncated");
+  if (data.substr(snapshotHeaderSize, kindSize) != kind ||
+      read32le(header + 16) != formatVersion ||
+      read64le(header + 24) != configHash)
+    return std::nullopt;
+
+  llvm::StringRef const payload =
+      data.substr(snapshotHeaderSize + kindSize, payloadSize);
+  return ConfigurationSnapshot{std::move(*buffer), payload};
+}
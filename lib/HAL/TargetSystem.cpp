@@ -1,6 +1,6 @@
 //===- TargetSystem.cpp -----------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -47,6 +47,14 @@ void Target::enableTiming(mlir::TimingScope &timingScope) {
 
 void Target::disableTiming() { rootTimer.stop(); }
 
+void Target::resetRunState() {
+  disableTiming();
+  rootTimer = mlir::TimingScope();
+  diagnostics_.clear();
+  for (auto &child : getChildren_())
+    child->resetRunState();
+}
+
 mlir::TimingScope Target::getTimer(llvm::StringRef name) {
   return rootTimer.nest(name);
 }
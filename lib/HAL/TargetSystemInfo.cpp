@@ -1,6 +1,6 @@
 //===- TargetSystemInfo.cpp - System Target Info ----------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // Any modifications or derivative works of this code must retain this
 // copyright notice, and modified files need to carry a notice indicating
@@ -18,12 +18,22 @@
 
 #include "mlir/IR/MLIRContext.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA256.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <utility>
 
 // Inject static initialization headers from targets. We need to include them in
@@ -38,10 +48,51 @@ using namespace qssc::hal::registry;
 /// members.
 /// Details: https://en.cppreference.com/w/cpp/language/pimpl
 struct TargetSystemInfo::Impl {
+  /// Guards all of the members below, compilations in different contexts
+  /// may acquire and release targets concurrently.
+  mutable std::mutex mutex;
+
   llvm::DenseMap<mlir::MLIRContext *, std::unique_ptr<TargetSystem>>
       managedTargets{};
+
+  /// Pool keys of the targets acquired for a context
+  llvm::DenseMap<mlir::MLIRContext *, std::string> leaseKeys{};
+
+  /// Idle targets of the pool with their keys, most recently released first
+  std::list<std::pair<std::string, std::unique_ptr<TargetSystem>>>
+      idleTargets{};
+
+  /// Whether the passes and pass pipelines of the target were registered
+  mutable bool passesRegistered = false;
+  mutable bool pipelinesRegistered = false;
 };
 
+namespace {
+
+/// Maximum number of idle targets kept in the pool of a target type
+constexpr size_t maxIdleTargets = 8;
+
+/// Return the key the targets built from a configuration are pooled under,
+/// the path and the contents hash of the configuration file, or none if the
+/// configuration may not be pooled.
+std::optional<std::string>
+getPoolKey(std::optional<llvm::StringRef> configuration) {
+  if (!configuration.has_value())
+    return std::string();
+  // Directories and the configuration service ("-") may change without
+  // their path changing, only pool configuration files.
+  if (!llvm::sys::fs::is_regular_file(*configuration))
+    return std::nullopt;
+  auto buffer = llvm::MemoryBuffer::getFile(*configuration);
+  if (!buffer)
+    return std::nullopt;
+  auto const hash = llvm::SHA256::hash(
+      llvm::arrayRefFromStringRef((*buffer)->getBuffer()));
+  return (*configuration + ":" + llvm::toHex(hash, /*LowerCase=*/true)).str();
+}
+
+} // anonymous namespace
+
 TargetSystemInfo::TargetSystemInfo(
     llvm::StringRef name, llvm::StringRef description,
     PluginInfo::PluginFactoryFunction targetFactory,
@@ -58,12 +109,76 @@ llvm::Expected<qssc::hal::TargetSystem *> TargetSystemInfo::createTarget(
   auto target = PluginInfo::createPluginInstance(configuration);
   if (!target)
     return target.takeError();
-  impl->managedTargets[context] = std::move(target.get());
-  return impl->managedTargets[context].get();
+  const std::lock_guard<std::mutex> lock(impl->mutex);
+  impl->leaseKeys.erase(context);
+  auto &managed = impl->managedTargets[context];
+  managed = std::move(target.get());
+  return managed.get();
+}
+
+llvm::Expected<qssc::hal::TargetSystem *> TargetSystemInfo::acquireTarget(
+    mlir::MLIRContext *context,
+    std::optional<PluginInfo::PluginConfiguration> configuration) {
+  auto key = getPoolKey(configuration);
+  if (!key.has_value())
+    return createTarget(context, configuration);
+
+  {
+    const std::lock_guard<std::mutex> lock(impl->mutex);
+    auto idle = std::find_if(
+        impl->idleTargets.begin(), impl->idleTargets.end(),
+        [&](const auto &entry) { return entry.first == *key; });
+    if (idle != impl->idleTargets.end()) {
+      auto &managed = impl->managedTargets[context];
+      managed = std::move(idle->second);
+      impl->idleTargets.erase(idle);
+      impl->leaseKeys[context] = std::move(*key);
+      return managed.get();
+    }
+  }
+
+  // Build the target outside of the lock, this is the cost the pool avoids
+  auto target = PluginInfo::createPluginInstance(configuration);
+  if (!target)
+    return target.takeError();
+  const std::lock_guard<std::mutex> lock(impl->mutex);
+  auto &managed = impl->managedTargets[context];
+  managed = std::move(target.get());
+  impl->leaseKeys[context] = std::move(*key);
+  return managed.get();
+}
+
+void TargetSystemInfo::releaseTarget(mlir::MLIRContext *context) {
+  std::unique_ptr<TargetSystem> target;
+  std::string key;
+  {
+    const std::lock_guard<std::mutex> lock(impl->mutex);
+    auto lease = impl->leaseKeys.find(context);
+    if (lease == impl->leaseKeys.end())
+      return;
+    key = std::move(lease->second);
+    impl->leaseKeys.erase(lease);
+    auto managed = impl->managedTargets.find(context);
+    if (managed == impl->managedTargets.end())
+      return;
+    target = std::move(managed->second);
+    impl->managedTargets.erase(managed);
+  }
+
+  target->resetRunState();
+
+  std::unique_ptr<TargetSystem> evicted;
+  const std::lock_guard<std::mutex> lock(impl->mutex);
+  impl->idleTargets.emplace_front(std::move(key), std::move(target));
+  if (impl->idleTargets.size() > maxIdleTargets) {
+    evicted = std::move(impl->idleTargets.back().second);
+    impl->idleTargets.pop_back();
+  }
 }
 
 llvm::Expected<qssc::hal::TargetSystem *>
 TargetSystemInfo::getTarget(mlir::MLIRContext *context) const {
+  const std::lock_guard<std::mutex> lock(impl->mutex);
   auto it = impl->managedTargets.find(context);
   if (it != impl->managedTargets.end())
     return it->getSecond().get();
@@ -79,9 +194,17 @@ TargetSystemInfo::getTarget(mlir::MLIRContext *context) const {
 }
 
 llvm::Error TargetSystemInfo::registerTargetPasses() const {
+  const std::lock_guard<std::mutex> lock(impl->mutex);
+  if (impl->passesRegistered)
+    return llvm::Error::success();
+  impl->passesRegistered = true;
   return passRegistrar();
 }
 
 llvm::Error TargetSystemInfo::registerTargetPassPipelines() const {
+  const std::lock_guard<std::mutex> lock(impl->mutex);
+  if (impl->pipelinesRegistered)
+    return llvm::Error::success();
+  impl->pipelinesRegistered = true;
   return passPipelineRegistrar();
 }
@@ -0,0 +1,188 @@
+//===- FlatArchive.cpp - Flat payload container -----------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements writing and indexing flat payload containers
+///
+//===----------------------------------------------------------------------===//
+
+#include "Payload/FlatArchive.h"
+
+#include "Payload/PayloadCRC.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace qssc::payload;
+
+namespace {
+llvm::Error invalidArchive(const llvm::Twine &what) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Invalid flat payload: " + what);
+}
+} // end anonymous namespace
+
+llvm::Error
+qssc::payload::writeFlatArchive(llvm::raw_ostream &stream,
+                                llvm::ArrayRef<FlatArchiveInput> members,
+                                uint32_t alignment) {
+  assert(llvm::isPowerOf2_32(alignment) && "expect a power of two alignment");
+  assert(std::is_sorted(members.begin(), members.end(),
+                        [](const auto &a, const auto &b) {
+                          return a.name < b.name;
+                        }) &&
+         "expect members sorted by name");
+
+  // The layout is fully determined by the names and sizes of the members,
+  // hence the index precedes the data and the container is written at once
+  uint64_t namesSize = 0;
+  for (const auto &member : members)
+    namesSize += member.name.size();
+  if (namesSize > std::numeric_limits<uint32_t>::max())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Flat payload names exceed 4 GiB");
+  uint64_t const indexSize = members.size() * flatArchiveEntrySize + namesSize;
+
+  std::vector<uint64_t> dataOffsets(members.size());
+  uint64_t offset =
+      llvm::alignTo(flatArchiveHeaderSize + indexSize, alignment);
+  for (size_t index = 0; index < members.size(); ++index) {
+    dataOffsets[index] = offset;
+    offset = llvm::alignTo(offset + members[index].contents.size(), alignment);
+  }
+
+  std::vector<uint32_t> crcs(members.size());
+  llvm::parallelFor(0, members.size(), [&](size_t index) {
+    llvm::StringRef const contents = members[index].contents;
+    crcs[index] = parallelCRC32(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(contents.data()), contents.size()));
+  });
+
+  llvm::support::endian::Writer writer(stream, llvm::support::little);
+  stream.write(flatArchiveMagic, sizeof(flatArchiveMagic));
+  writer.write<uint32_t>(flatArchiveVersion);
+  writer.write<uint32_t>(alignment);
+  writer.write<uint64_t>(members.size());
+  writer.write<uint64_t>(indexSize);
+
+  uint32_t nameOffset = 0;
+  for (size_t index = 0; index < members.size(); ++index) {
+    const auto &member = members[index];
+    writer.write<uint64_t>(dataOffsets[index]);
+    writer.write<uint64_t>(member.contents.size());
+    writer.write<uint32_t>(nameOffset);
+    writer.write<uint32_t>(static_cast<uint32_t>(member.name.size()));
+    writer.write<uint32_t>(crcs[index]);
+    writer.write<uint32_t>(member.mode);
+    nameOffset += static_cast<uint32_t>(member.name.size());
+  }
+  for (const auto &member : members)
+    stream << member.name;
+
+  // pad each member to the alignment, such that the next one starts at a
+  // page boundary
+  uint64_t written = flatArchiveHeaderSize + indexSize;
+  for (size_t index = 0; index < members.size(); ++index) {
+    stream.write_zeros(dataOffsets[index] - written);
+    stream << members[index].contents;
+    written = dataOffsets[index] + members[index].contents.size();
+  }
+  stream.write_zeros(offset - written);
+
+  if (stream.has_error())
+    return llvm::createStringError(stream.error(),
+                                   "Unable to write flat payload");
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::vector<FlatArchiveMember>>
+qssc::payload::readFlatArchiveIndex(llvm::StringRef archive) {
+  using llvm::support::endian::read32le;
+  using llvm::support::endian::read64le;
+
+  if (archive.size() < flatArchiveHeaderSize ||
+      !archive.startswith(
+          llvm::StringRef(flatArchiveMagic, sizeof(flatArchiveMagic))))
+    return invalidArchive("missing header");
+  const char *header = archive.data();
+  uint32_t const version = read32le(header + 8);
+  if (version != flatArchiveVersion)
+    return invalidArchive("unsupported version " + llvm::Twine(version));
+  if (!llvm::isPowerOf2_32(read32le(header + 12)))
+    return invalidArchive("alignment is not a power of two");
+  uint64_t const numMembers = read64le(header + 16);
+  uint64_t const indexSize = read64le(header + 24);
+  if (indexSize > archive.size() - flatArchiveHeaderSize ||
+      numMembers > indexSize / flatArchiveEntrySize)
+    return invalidArchive("index exceeds the payload");
+
+  llvm::StringRef const names = archive.substr(
+      flatArchiveHeaderSize + numMembers * flatArchiveEntrySize,
+      indexSize - numMembers * flatArchiveEntrySize);
+
+  std::vector<FlatArchiveMember> index;
+  index.reserve(numMembers);
+  for (uint64_t i = 0; i < numMembers; ++i) {
+    uint64_t const entryOffset =
+        flatArchiveHeaderSize + i * flatArchiveEntrySize;
+    const char *entry = archive.data() + entryOffset;
+    FlatArchiveMember member;
+    member.dataOffset = read64le(entry);
+    member.size = read64le(entry + 8);
+    uint32_t const nameOffset = read32le(entry + 16);
+    uint32_t const nameSize = read32le(entry + 20);
+    member.crcOffset = entryOffset + flatArchiveEntryCRCOffset;
+    member.crc = read32le(entry + flatArchiveEntryCRCOffset);
+    member.mode = read32le(entry + 28);
+
+    if (static_cast<uint64_t>(nameOffset) + nameSize > names.size())
+      return invalidArchive("member name exceeds the index");
+    member.name = names.substr(nameOffset, nameSize);
+    if (member.dataOffset > archive.size() ||
+        member.size > archive.size() - member.dataOffset)
+      return invalidArchive("member " + member.name + " exceeds the payload");
+    if (!index.empty() && !(index.back().name < member.name))
+      return invalidArchive("members are not sorted by name");
+    index.push_back(member);
+  }
+  return index;
+}
+
+const FlatArchiveMember *
+qssc::payload::findFlatArchiveMember(llvm::ArrayRef<FlatArchiveMember> index,
+                                     llvm::StringRef name) {
+  const auto *pos = std::lower_bound(
+      index.begin(), index.end(), name,
+      [](const FlatArchiveMember &member, llvm::StringRef key) {
+        return member.name < key;
+      });
+  if (pos == index.end() || pos->name != name)
+    return nullptr;
+  return pos;
+}
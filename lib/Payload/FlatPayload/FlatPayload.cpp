@@ -0,0 +1,142 @@
+//===- FlatPayload.cpp ------------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the FlatPayload class
+///
+//===----------------------------------------------------------------------===//
+
+#include "FlatPayload.h"
+
+#include "Payload/FlatArchive.h"
+#include "Payload/Payload.h"
+
+#include "Arguments/Signature.h"
+#include "Payload/PayloadRegistry.h"
+#include <Config/QSSConfig.h>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_os_ostream.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+// NOLINTNEXTLINE(misc-include-cleaner)
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+
+using namespace qssc::payload;
+
+int qssc::payload::initFlatPayload() {
+  const char *name = "FLAT";
+  bool const registered = registry::PayloadRegistry::registerPlugin(
+      name, name,
+      "Payload that generates an uncompressed flat container of page aligned "
+      "members which can be mapped in place.",
+      [](std::optional<PayloadConfig> config)
+          -> llvm::Expected<std::unique_ptr<payload::Payload>> {
+        if (config.has_value())
+          return std::make_unique<FlatPayload>(config.value());
+        return std::make_unique<FlatPayload>();
+      });
+  return registered ? 0 : -1;
+}
+
+void FlatPayload::addFile(llvm::StringRef filename, llvm::StringRef str) {
+  storeFile(filename, str.str());
+}
+
+void FlatPayload::writePlain(llvm::raw_ostream &stream) {
+  std::vector<FileRef> const files = orderedFiles();
+  stream << "------------------------------------------\n";
+  stream << "Plaintext payload: " << prefix << "\n";
+  stream << "------------------------------------------\n";
+  stream << "Manifest:\n";
+  for (const auto &file : files)
+    stream << file.name << "\n";
+  stream << "------------------------------------------\n";
+  for (const auto &file : files) {
+    stream << "File: " << file.name << "\n";
+    llvm::StringRef const contents = file.contents;
+    stream << contents;
+    if (!contents.ends_with("\n"))
+      stream << "\n";
+    stream << "------------------------------------------\n";
+  }
+}
+
+void FlatPayload::writePlain(std::ostream &stream) {
+  llvm::raw_os_ostream llstream(stream);
+  writePlain(llstream);
+}
+
+namespace {
+uint32_t getFileMode(llvm::StringRef fName) {
+  // regular file, writable only by the user
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  uint32_t mode = S_IFREG | S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+
+  // if executable turn on S_IXUSR
+  if (llvm::sys::path::extension(fName) == ".sh")
+    // NOLINTNEXTLINE(misc-include-cleaner)
+    mode |= S_IXUSR; // turn on execute for user
+
+  return mode;
+}
+} // end anonymous namespace
+
+void FlatPayload::writeFlat(llvm::raw_ostream &stream) {
+  if (verbosity >= qssc::config::QSSVerbosity::Info)
+    llvm::outs() << "Writing flat payload to stream\n";
+  // first add the manifest
+  addManifest();
+
+  // The members are written straight from the payload's buffers, which are
+  // ordered by name as the index requires
+  std::vector<FlatArchiveInput> members;
+  for (const auto &file : orderedFiles()) {
+    members.push_back({file.name, file.contents, getFileMode(file.name)});
+    if (verbosity >= qssc::config::QSSVerbosity::Info)
+      llvm::outs() << "Adding file " << file.name << " to flat payload ("
+                   << members.back().contents.size() << " bytes)\n";
+  }
+
+  if (auto err = writeFlatArchive(stream, members)) {
+    llvm::errs() << "Problem writing flat payload: "
+                 << llvm::toString(std::move(err)) << "\n";
+    return;
+  }
+  stream.flush();
+}
+
+void FlatPayload::write(llvm::raw_ostream &stream) { writeFlat(stream); }
+
+void FlatPayload::write(std::ostream &stream) {
+  llvm::raw_os_ostream llstream(stream);
+  writeFlat(llstream);
+}
+
+void FlatPayload::writeArgumentSignature(qssc::arguments::Signature &&sig) {
+  // every member is page aligned and stored uncompressed, hence all of them
+  // can be patched in place
+  getFile("arguments_signature.bin")->assign(sig.serializeBinary());
+  getFile("arguments_signature.txt")->assign(sig.serialize());
+}
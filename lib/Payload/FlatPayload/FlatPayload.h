@@ -0,0 +1,64 @@
+//===- FlatPayload.h --------------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declares the FlatPayload class
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_FLATPAYLOAD_H
+#define PAYLOAD_FLATPAYLOAD_H
+
+#include "Payload/Payload.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <ostream>
+#include <utility>
+
+namespace qssc::payload {
+
+// Register the flat payload.
+int initFlatPayload();
+
+// A payload written as a flat container of uncompressed, page aligned
+// members, see FlatArchive.h, for pipelines which load payloads by mapping
+// them rather than extracting them.
+class FlatPayload : public Payload {
+public:
+  FlatPayload() = default;
+  FlatPayload(PayloadConfig config) : Payload(std::move(config)) {}
+  virtual ~FlatPayload() = default;
+
+  // write all files to the stream
+  virtual void write(llvm::raw_ostream &stream) override;
+  // write all files to the stream
+  virtual void write(std::ostream &stream) override;
+  // write all files in plaintext to the stream
+  virtual void writePlain(std::ostream &stream) override;
+  virtual void writePlain(llvm::raw_ostream &stream) override;
+  virtual void
+  writeArgumentSignature(qssc::arguments::Signature &&sig) override;
+
+  // write all files to a flat container and output it to the stream
+  void writeFlat(llvm::raw_ostream &stream);
+  using Payload::addFile;
+  void addFile(llvm::StringRef filename, llvm::StringRef str) override;
+}; // class FlatPayload
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_FLATPAYLOAD_H
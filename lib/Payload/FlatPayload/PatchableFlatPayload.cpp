@@ -0,0 +1,429 @@
+//===- PatchableFlatPayload.cpp - Patching flat payloads --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements patching the members of flat payloads with updated
+///  arguments
+///
+//===----------------------------------------------------------------------===//
+
+#include "Payload/PatchableFlatPayload.h"
+
+#include "Payload/FlatArchive.h"
+#include "Payload/PayloadCRC.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace qssc::payload {
+
+namespace {
+llvm::Error writeFile(llvm::StringRef path, llvm::ArrayRef<char> data) {
+  std::error_code ec;
+  llvm::raw_fd_ostream output(path, ec);
+  if (ec)
+    return llvm::createStringError(ec, "Unable to open " + path + ": " +
+                                           ec.message());
+  output.write(data.data(), data.size());
+  output.close();
+  if (output.has_error())
+    return llvm::createStringError(output.error(), "Unable to write " + path);
+  return llvm::Error::success();
+}
+} // anonymous namespace
+
+llvm::Error PatchableFlatPayload::ensureMapped() {
+  if (archive.data() != nullptr) // already mapped
+    return llvm::Error::success();
+
+  if (enableInMemory) {
+    // patch a copy, which holds the payload after writeBack
+    if (!inMemoryData)
+      inMemoryData = path;
+    archive = {inMemoryData->data(), inMemoryData->size()};
+  } else {
+    // The payload file is mapped shared such that members are patched in
+    // the file itself. If it is written to a separate output or can not be
+    // written, it is mapped copy-on-write such that patches remain private
+    // to the mapping.
+    int fd;
+    sharedMapping = outputPath.empty() &&
+                    !llvm::sys::fs::openFileForReadWrite(
+                        path, fd, llvm::sys::fs::CD_OpenExisting,
+                        llvm::sys::fs::OF_None);
+    if (!sharedMapping)
+      if (std::error_code ec = llvm::sys::fs::openFileForRead(path, fd))
+        return llvm::createStringError(ec, "Unable to open " + path + ": " +
+                                               ec.message());
+    auto file = llvm::sys::fs::convertFDToNativeFile(fd);
+
+    llvm::sys::fs::file_status status;
+    std::error_code ec = llvm::sys::fs::status(fd, status);
+    if (!ec && status.getSize() > 0)
+      mappedFile.emplace(file,
+                         sharedMapping
+                             ? llvm::sys::fs::mapped_file_region::readwrite
+                             : llvm::sys::fs::mapped_file_region::priv,
+                         status.getSize(), 0, ec);
+    llvm::sys::fs::closeFile(file);
+    if (ec || !mappedFile) {
+      mappedFile.reset();
+      return llvm::createStringError(
+          ec ? ec : std::make_error_code(std::errc::invalid_argument),
+          "Unable to map " + path);
+    }
+    archive = {mappedFile->data(), mappedFile->size()};
+  }
+
+  auto indexOrErr =
+      readFlatArchiveIndex(llvm::StringRef(archive.data(), archive.size()));
+  if (auto err = indexOrErr.takeError()) {
+    reset_();
+    return err;
+  }
+  index = std::move(*indexOrErr);
+  return llvm::Error::success();
+}
+
+void PatchableFlatPayload::reset_() {
+  files.clear();
+  index.clear();
+  archive = {};
+  // unmapping a shared mapping writes the changes to the payload file
+  mappedFile.reset();
+  sharedMapping = false;
+  patchedInPlace = false;
+}
+
+llvm::Expected<FlatArchiveMember *>
+PatchableFlatPayload::findMember_(llvm::StringRef path) {
+  if (auto err = ensureMapped())
+    return std::move(err);
+
+  const auto *member = findFlatArchiveMember(index, path);
+  if (member == nullptr)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Flat payload member " + path +
+                                       " not found");
+  return &index[member - index.data()];
+}
+
+llvm::Error PatchableFlatPayload::setOutputPath(llvm::StringRef output) {
+  if (archive.data() != nullptr)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "The output path must be set before the payload is read");
+  if (!enableInMemory && output == path)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "The output path is the input path");
+  outputPath = output.str();
+  return llvm::Error::success();
+}
+
+bool PatchableFlatPayload::commitBuffers_() {
+  bool requiresRewrite = false;
+  for (auto &[name, file] : files) {
+    if (!file.writeBack)
+      continue;
+    const auto *pos = findFlatArchiveMember(index, name);
+    assert(pos && "expect the buffers of members of the payload");
+    auto &member = index[pos - index.data()];
+    if (file.buf.size() != member.size) {
+      requiresRewrite = true;
+      continue;
+    }
+
+    std::copy(file.buf.begin(), file.buf.end(),
+              archive.begin() + member.dataOffset);
+    member.crc = parallelCRC32(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(file.buf.data()), file.buf.size()));
+    llvm::support::endian::write32le(archive.data() + member.crcOffset,
+                                     member.crc);
+    file.writeBack = false;
+    patchedInPlace = true;
+  }
+  return requiresRewrite;
+}
+
+void PatchableFlatPayload::collectMembers_(
+    std::vector<FlatArchiveInput> &members,
+    std::vector<const ContentBuffer *> *buffers) const {
+  // members read into buffers are written with their current contents, all
+  // others straight from the archive
+  members.reserve(index.size());
+  for (const auto &member : index) {
+    llvm::StringRef contents(archive.data() + member.dataOffset, member.size);
+    const ContentBuffer *buf = nullptr;
+    auto pos = files.find(member.name.str());
+    if (pos != files.end()) {
+      buf = &pos->second.buf;
+      contents = llvm::StringRef(buf->data(), buf->size());
+    }
+    members.push_back({member.name, contents, member.mode});
+    if (buffers)
+      buffers->push_back(buf);
+  }
+}
+
+llvm::Error PatchableFlatPayload::writeCopy_(llvm::raw_ostream &ostream) {
+  if (auto err = ensureMapped())
+    return err;
+
+  std::vector<FlatArchiveInput> members;
+  collectMembers_(members, nullptr);
+  if (auto err = writeFlatArchive(ostream, members))
+    return err;
+  ostream.flush();
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableFlatPayload::prepareCopies() {
+  if (auto err = ensureMapped())
+    return err;
+  copyMembers.clear();
+  copyBuffers.clear();
+  collectMembers_(copyMembers, &copyBuffers);
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableFlatPayload::writeReplacedCopy(
+    std::string *outputString,
+    llvm::ArrayRef<MemberReplacement> replacements) const {
+  if (outputString == nullptr) // no output buffer
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "outputString buffer is null");
+  if (copyMembers.size() != index.size())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Copies of the payload are not prepared");
+
+  // the names are shared, only the contents are replaced
+  std::vector<FlatArchiveInput> members(copyMembers);
+  for (const auto &replacement : replacements) {
+    const auto *pos = llvm::find(copyBuffers, replacement.member);
+    if (pos == copyBuffers.end())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Replaced member is not in the payload");
+    members[pos - copyBuffers.begin()].contents = replacement.contents;
+  }
+
+  llvm::raw_string_ostream ostream(*outputString);
+  if (auto err = writeFlatArchive(ostream, members))
+    return err;
+  ostream.flush();
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableFlatPayload::replaceInput_() {
+  llvm::SmallString<128> tempPath;
+  int fd;
+  if (std::error_code ec =
+          llvm::sys::fs::createUniqueFile(path + "-%%%%%%", fd, tempPath))
+    return llvm::createStringError(
+        ec, "Unable to create a temporary file for " + path + ": " +
+                ec.message());
+
+  auto writeTemp = [&]() -> llvm::Error {
+    llvm::raw_fd_ostream output(fd, /*shouldClose=*/true);
+    if (auto err = writeCopy_(output))
+      return err;
+    output.close();
+    if (output.has_error())
+      return llvm::createStringError(output.error(),
+                                     "Unable to write " + tempPath);
+    return llvm::Error::success();
+  };
+  if (auto err = writeTemp()) {
+    llvm::sys::fs::remove(tempPath);
+    return err;
+  }
+
+  if (auto perms = llvm::sys::fs::getPermissions(path))
+    llvm::sys::fs::setPermissions(tempPath, *perms);
+  if (std::error_code ec = llvm::sys::fs::rename(tempPath, path)) {
+    llvm::sys::fs::remove(tempPath);
+    return llvm::createStringError(ec, "Unable to replace " + path + ": " +
+                                           ec.message());
+  }
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableFlatPayload::writeBack() {
+  bool const requiresRewrite = archive.data() != nullptr && commitBuffers_();
+
+  auto write = [&]() -> llvm::Error {
+    if (!outputPath.empty()) {
+      if (requiresRewrite) {
+        std::error_code ec;
+        llvm::raw_fd_ostream output(outputPath, ec);
+        if (ec)
+          return llvm::createStringError(ec, "Unable to open " + outputPath +
+                                                 ": " + ec.message());
+        if (auto err = writeCopy_(output))
+          return err;
+        output.close();
+        if (output.has_error())
+          return llvm::createStringError(output.error(),
+                                         "Unable to write " + outputPath);
+        return llvm::Error::success();
+      }
+      // the private mapping or the copy holds the patched payload
+      if (archive.data() != nullptr)
+        return writeFile(outputPath, archive);
+      // nothing was read
+      if (enableInMemory)
+        return writeFile(outputPath, {path.data(), path.size()});
+      if (std::error_code ec = llvm::sys::fs::copy_file(path, outputPath))
+        return llvm::createStringError(ec, "Failed to copy " + path + " to " +
+                                               outputPath);
+      return llvm::Error::success();
+    }
+
+    if (enableInMemory) {
+      if (!requiresRewrite) // the copy was patched in place
+        return llvm::Error::success();
+      std::string rewritten;
+      llvm::raw_string_ostream ostream(rewritten);
+      if (auto err = writeCopy_(ostream))
+        return err;
+      inMemoryData = std::move(rewritten);
+      return llvm::Error::success();
+    }
+
+    // Changes to a shared mapping are written to the payload file when it is
+    // unmapped, otherwise the payload file is replaced
+    if (requiresRewrite || (patchedInPlace && !sharedMapping))
+      return replaceInput_();
+    return llvm::Error::success();
+  };
+
+  auto err = write();
+  reset_();
+  return err;
+}
+
+llvm::Error PatchableFlatPayload::writeString(std::string *outputString) {
+  if (outputString == nullptr) // no output buffer
+    return llvm::make_error<llvm::StringError>("outputString buffer is null",
+                                               llvm::inconvertibleErrorCode());
+
+  if (enableInMemory) {
+    outputString->append(inMemoryData ? *inMemoryData : path);
+    return llvm::Error::success();
+  }
+
+  // re-read file from disk
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (std::error_code ec = bufferOrErr.getError())
+    return llvm::createStringError(ec, "Unable to read " + path + ": " +
+                                           ec.message());
+  outputString->append((*bufferOrErr)->getBufferStart(),
+                       (*bufferOrErr)->getBufferSize());
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableFlatPayload::writeCopy(std::string *outputString) {
+  if (outputString == nullptr) // no output buffer
+    return llvm::make_error<llvm::StringError>("outputString buffer is null",
+                                               llvm::inconvertibleErrorCode());
+
+  if (auto err = ensureMapped())
+    return err;
+
+  if (files.empty()) {
+    // the archive itself is up to date
+    outputString->append(archive.data(), archive.size());
+    return llvm::Error::success();
+  }
+
+  llvm::raw_string_ostream ostream(*outputString);
+  return writeCopy_(ostream);
+}
+
+llvm::Expected<llvm::MutableArrayRef<char>>
+PatchableFlatPayload::mapMember(llvm::StringRef path) {
+  if (llvm::any_of(files, [](auto &item) { return item.second.writeBack; }))
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Payload members are already patched through readMember");
+
+  auto memberOrErr = findMember_(path);
+  if (auto err = memberOrErr.takeError())
+    return std::move(err);
+  auto *member = *memberOrErr;
+  return archive.slice(member->dataOffset, member->size);
+}
+
+llvm::Error
+PatchableFlatPayload::updateMappedMember(llvm::StringRef path, uint64_t offset,
+                                         llvm::ArrayRef<char> previous) {
+  auto memberOrErr = findMember_(path);
+  if (auto err = memberOrErr.takeError())
+    return err;
+  auto &member = **memberOrErr;
+  if (offset + previous.size() > member.size)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Patch exceeds flat payload member " +
+                                       path);
+
+  auto current = archive.slice(member.dataOffset + offset, previous.size());
+  member.crc = updateCRC32(
+      member.crc, member.size, offset,
+      llvm::ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t *>(previous.data()), previous.size()),
+      llvm::ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t *>(current.data()), current.size()));
+  llvm::support::endian::write32le(archive.data() + member.crcOffset,
+                                   member.crc);
+  patchedInPlace = true;
+  return llvm::Error::success();
+}
+
+llvm::Expected<PatchableFlatPayload::ContentBuffer &>
+PatchableFlatPayload::readMember(llvm::StringRef path, bool markForWriteBack) {
+  std::string const pathStr = path.str();
+  auto pos = files.find(pathStr);
+  if (pos != files.end())
+    return pos->second.buf;
+
+  auto memberOrErr = findMember_(path);
+  if (auto err = memberOrErr.takeError())
+    return std::move(err);
+  auto *member = *memberOrErr;
+
+  const char *data = archive.data() + member->dataOffset;
+  ContentBuffer fileBuf(data, data + member->size);
+  auto ins =
+      files.emplace(pathStr, TrackedFile{markForWriteBack, std::move(fileBuf)});
+  assert(ins.second && "expect insertion, i.e., had not been present before.");
+  return ins.first->second.buf;
+}
+
+} // namespace qssc::payload
@@ -0,0 +1,144 @@
+//===- ParameterTable.cpp - Parameter table of sweep payloads ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements writing and patching the parameter table of sweep
+///  payloads
+///
+//===----------------------------------------------------------------------===//
+
+#include "Payload/ParameterTable.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/ADT/bit.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+using namespace qssc::payload;
+
+namespace {
+llvm::Error invalidTable(const llvm::Twine &what) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Invalid parameter table: " + what);
+}
+
+size_t getValuesOffset(size_t namesSize) {
+  return llvm::alignTo(parameterTableHeaderSize + namesSize, sizeof(double));
+}
+} // end anonymous namespace
+
+std::string
+qssc::payload::createParameterTable(llvm::ArrayRef<llvm::StringRef> names,
+                                    llvm::ArrayRef<double> initialValues,
+                                    uint32_t numPoints) {
+  assert(names.size() == initialValues.size() &&
+         "expect an initial value per parameter");
+  size_t namesSize = 0;
+  for (auto name : names)
+    namesSize += name.size() + 1;
+  size_t const valuesOffset = getValuesOffset(namesSize);
+  size_t const rowSize = names.size() * sizeof(double);
+
+  std::string table(valuesOffset + numPoints * rowSize, '\0');
+  char *data = table.data();
+  std::memcpy(data, parameterTableMagic, sizeof(parameterTableMagic));
+  llvm::support::endian::write32le(data + 8, parameterTableVersion);
+  llvm::support::endian::write32le(data + 12, numPoints);
+  llvm::support::endian::write32le(data + 16, names.size());
+  llvm::support::endian::write32le(data + 20, namesSize);
+
+  char *nameData = data + parameterTableHeaderSize;
+  for (auto name : names) {
+    std::memcpy(nameData, name.data(), name.size());
+    nameData += name.size() + 1;
+  }
+
+  // every point starts at the initial values, the first row is copied
+  char *row = data + valuesOffset;
+  for (size_t parameter = 0; parameter < initialValues.size(); ++parameter)
+    llvm::support::endian::write64le(
+        row + parameter * sizeof(double),
+        llvm::bit_cast<uint64_t>(initialValues[parameter]));
+  for (uint32_t point = 1; point < numPoints; ++point)
+    std::memcpy(row + point * rowSize, row, rowSize);
+  return table;
+}
+
+llvm::Expected<ParameterTableView>
+ParameterTableView::create(llvm::MutableArrayRef<char> table) {
+  using llvm::support::endian::read32le;
+
+  if (table.size() < parameterTableHeaderSize ||
+      std::memcmp(table.data(), parameterTableMagic,
+                  sizeof(parameterTableMagic)) != 0)
+    return invalidTable("missing header");
+  if (read32le(table.data() + 8) != parameterTableVersion)
+    return invalidTable("unsupported version " +
+                        llvm::Twine(read32le(table.data() + 8)));
+
+  ParameterTableView view;
+  view.numPoints = read32le(table.data() + 12);
+  uint32_t const numParameters = read32le(table.data() + 16);
+  uint32_t const namesSize = read32le(table.data() + 20);
+  size_t const valuesOffset = getValuesOffset(namesSize);
+  if (valuesOffset + static_cast<uint64_t>(view.numPoints) * numParameters *
+                         sizeof(double) >
+      table.size())
+    return invalidTable("the values exceed the table");
+
+  llvm::StringRef names(table.data() + parameterTableHeaderSize, namesSize);
+  view.names.reserve(numParameters);
+  for (uint32_t parameter = 0; parameter < numParameters; ++parameter) {
+    size_t const end = names.find('\0');
+    if (end == llvm::StringRef::npos)
+      return invalidTable("the names exceed the table");
+    view.names.push_back(names.take_front(end));
+    names = names.drop_front(end + 1);
+  }
+  view.values = table.data() + valuesOffset;
+  return view;
+}
+
+std::optional<uint32_t>
+ParameterTableView::lookup(llvm::StringRef name) const {
+  for (uint32_t parameter = 0; parameter < names.size(); ++parameter)
+    if (names[parameter] == name)
+      return parameter;
+  return std::nullopt;
+}
+
+double ParameterTableView::getValue(uint32_t point, uint32_t parameter) const {
+  assert(point < numPoints && parameter < names.size());
+  return llvm::bit_cast<double>(llvm::support::endian::read64le(
+      values + (point * names.size() + parameter) * sizeof(double)));
+}
+
+void ParameterTableView::setValue(uint32_t point, uint32_t parameter,
+                                  double value) {
+  assert(point < numPoints && parameter < names.size());
+  llvm::support::endian::write64le(
+      values + (point * names.size() + parameter) * sizeof(double),
+      llvm::bit_cast<uint64_t>(value));
+}
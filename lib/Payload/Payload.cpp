@@ -1,6 +1,6 @@
 //===- Payload.cpp ----------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -20,10 +20,28 @@
 
 #include "Payload/Payload.h"
 
+#include "Config.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/SHA256.h"
+
 #include <algorithm>
-#include <filesystem>
+#include <cstddef>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <nlohmann/json.hpp>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Inject static initialization headers from payloads. We need to include them
@@ -32,28 +50,302 @@
 #include "Payloads.inc"
 
 using namespace qssc::payload;
-namespace fs = std::filesystem;
+
+void Payload::FileHandle::append(llvm::StringRef data) {
+  const std::lock_guard<std::mutex> lock(*mutex);
+  contents->append(data.data(), data.size());
+}
+
+void Payload::FileHandle::assign(std::string &&newContents) {
+  const std::lock_guard<std::mutex> lock(*mutex);
+  *contents = std::move(newContents);
+}
+
+void Payload::FileHandle::reserve(std::size_t size) {
+  const std::lock_guard<std::mutex> lock(*mutex);
+  contents->reserve(size);
+}
+
+void Payload::FileHandle::withContents(
+    llvm::function_ref<void(std::string &)> func) {
+  const std::lock_guard<std::mutex> lock(*mutex);
+  func(*contents);
+}
+
+auto Payload::insertEntry(FileShard &shard, llvm::StringRef key)
+    -> FileEntry & {
+  auto [it, inserted] = shard.files.try_emplace(key);
+  if (inserted)
+    shard.added.push_back(&*it);
+  // a removed file is revived in place as it is still ordered
+  it->second.removed = false;
+  return it->second;
+}
+
+auto Payload::getEntry(FileShard &shard, llvm::StringRef key) -> FileEntry & {
+  auto &entry = insertEntry(shard, key);
+  // the file may have been adopted as a buffer, which can not be modified in
+  // place
+  if (entry.buffer) {
+    entry.contents = entry.buffer->getBuffer().str();
+    entry.buffer.reset();
+  }
+  return entry;
+}
 
 auto Payload::getFile(const std::string &fName) -> std::string * {
-  const std::lock_guard<std::mutex> lock(_mtx);
   const std::string key = prefix + fName;
-  files.try_emplace(key);
-  return &files[key];
+  auto &shard = getShard(key);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  return &getEntry(shard, key).contents;
+}
+
+auto Payload::reserveFile(llvm::StringRef fName, std::size_t sizeHint)
+    -> FileHandle {
+  const std::string key = prefix + fName.str();
+  auto &shard = getShard(key);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  auto &entry = getEntry(shard, key);
+  entry.contents.reserve(sizeHint);
+  return {&entry.contents, &entry.mutex};
 }
 
 auto Payload::getFile(const char *fName) -> std::string * {
-  const std::lock_guard<std::mutex> lock(_mtx);
-  const std::string key = prefix + fName;
-  files.try_emplace(key);
-  return &files[key];
+  return getFile(std::string(fName));
+}
+
+void Payload::adoptFile(llvm::StringRef fName, std::string &&contents) {
+  storeFile(prefix + fName.str(), std::move(contents));
+}
+
+void Payload::adoptFile(llvm::StringRef fName,
+                        std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  storeFile(prefix + fName.str(), std::move(buffer));
+}
+
+void Payload::storeFile(llvm::StringRef key, std::string &&contents) {
+  auto &shard = getShard(key);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  auto &entry = insertEntry(shard, key);
+  entry.buffer.reset();
+  entry.contents = std::move(contents);
+}
+
+void Payload::storeFile(llvm::StringRef key,
+                        std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  auto &shard = getShard(key);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  auto &entry = insertEntry(shard, key);
+  entry.contents = std::string();
+  entry.buffer = std::move(buffer);
+}
+
+auto Payload::lockShards()
+    -> std::array<std::unique_lock<std::mutex>, numFileShards> {
+  std::array<std::unique_lock<std::mutex>, numFileShards> locks;
+  for (std::size_t index = 0; index < numFileShards; ++index)
+    locks[index] = std::unique_lock<std::mutex>(fileShards[index].mutex);
+  return locks;
+}
+
+void Payload::updateOrderedEntries() {
+  auto byName = [](const FileMapEntry *a, const FileMapEntry *b) {
+    return a->getKey() < b->getKey();
+  };
+
+  std::vector<FileMapEntry *> added;
+  for (auto &shard : fileShards) {
+    added.insert(added.end(), shard.added.begin(), shard.added.end());
+    shard.added.clear();
+  }
+
+  // tombstones are dropped from the ordering before their entries are erased
+  std::vector<FileMapEntry *> removed;
+  auto dropRemoved = [&](std::vector<FileMapEntry *> &entries) {
+    llvm::erase_if(entries, [&](FileMapEntry *entry) {
+      if (!entry->getValue().removed)
+        return false;
+      removed.push_back(entry);
+      return true;
+    });
+  };
+  if (numRemovedEntries) {
+    dropRemoved(orderedEntries);
+    numRemovedEntries = 0;
+  }
+  dropRemoved(added);
+
+  // only the files added since the last ordering are sorted, then merged
+  // into the ordered files. The names are unique across all shards.
+  llvm::parallelSort(added.begin(), added.end(), byName);
+  auto const numOrdered = static_cast<std::ptrdiff_t>(orderedEntries.size());
+  orderedEntries.insert(orderedEntries.end(), added.begin(), added.end());
+  std::inplace_merge(orderedEntries.begin(),
+                     orderedEntries.begin() + numOrdered,
+                     orderedEntries.end(), byName);
+
+  for (auto *entry : removed)
+    getShard(entry->getKey()).files.erase(entry->getKey());
 }
 
-auto Payload::orderedFileNames() -> std::vector<fs::path> {
-  const std::lock_guard<std::mutex> lock(_mtx);
-  std::vector<fs::path> ret;
-  ret.reserve(files.size());
-  for (auto &filePair : files)
-    ret.emplace_back(filePair.first);
-  std::sort(ret.begin(), ret.end());
+auto Payload::takeFiles() -> std::vector<std::pair<std::string, std::string>> {
+  const std::lock_guard<std::mutex> orderLock(orderMutex);
+  auto shardLocks = lockShards();
+  updateOrderedEntries();
+
+  std::vector<std::pair<std::string, std::string>> ret;
+  ret.reserve(orderedEntries.size());
+  for (auto *entry : orderedEntries) {
+    auto &file = entry->getValue();
+    ret.emplace_back(entry->getKey().str(),
+                     file.buffer ? file.buffer->getBuffer().str()
+                                 : std::move(file.contents));
+  }
+  orderedEntries.clear();
+  for (auto &shard : fileShards)
+    shard.files.clear();
+  return ret;
+}
+
+auto Payload::orderedFiles() -> std::vector<FileRef> {
+  const std::lock_guard<std::mutex> orderLock(orderMutex);
+  auto shardLocks = lockShards();
+  updateOrderedEntries();
+
+  std::vector<FileRef> ret;
+  ret.reserve(orderedEntries.size());
+  for (auto *entry : orderedEntries)
+    ret.push_back({entry->getKey(), entry->getValue().getContents()});
+  return ret;
+}
+
+auto Payload::getFileContents(llvm::StringRef fName) -> llvm::StringRef {
+  auto &shard = getShard(fName);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.files.find(fName);
+  if (it == shard.files.end() || it->second.removed)
+    return {};
+  return it->second.getContents();
+}
+
+void Payload::removeFile(llvm::StringRef fName) {
+  const std::lock_guard<std::mutex> orderLock(orderMutex);
+  auto &shard = getShard(fName);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.files.find(fName);
+  if (it == shard.files.end() || it->second.removed)
+    return;
+  it->second.removed = true;
+  it->second.contents = std::string();
+  it->second.buffer.reset();
+  ++numRemovedEntries;
+}
+
+auto Payload::computeFileHashes() -> FileHashes {
+  std::vector<FileRef> const files = orderedFiles();
+  std::vector<std::string> hashes(files.size());
+  llvm::parallelFor(0, files.size(), [&](size_t index) {
+    llvm::StringRef const contents = files[index].contents;
+    auto const hash = llvm::SHA256::hash(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(contents.data()), contents.size()));
+    hashes[index] = llvm::toHex(hash, /*LowerCase=*/true);
+  });
+
+  FileHashes ret;
+  for (size_t index = 0; index < files.size(); ++index)
+    ret.emplace_hint(ret.end(), files[index].name.str(),
+                     std::move(hashes[index]));
+  return ret;
+}
+
+auto Payload::parseManifestHashes(llvm::StringRef manifest)
+    -> llvm::Expected<FileHashes> {
+  auto json = nlohmann::json::parse(manifest.begin(), manifest.end(),
+                                    /*cb=*/nullptr, /*allow_exceptions=*/false);
+  if (json.is_discarded() || !json.is_object())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to parse the payload manifest");
+  auto files = json.find("files");
+  if (files == json.end() || !files->is_object())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "The payload manifest lists no file hashes");
+
+  FileHashes ret;
+  for (const auto &[name, file] : files->items()) {
+    auto hash = file.find("sha256");
+    if (hash == file.end() || !hash->is_string())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "The payload manifest lists no hash for " +
+                                         name);
+    ret.emplace(name, hash->get<std::string>());
+  }
   return ret;
 }
+
+void Payload::addManifest() {
+  FileHashes hashes = computeFileHashes();
+  // the manifest of a previous write is replaced
+  hashes.erase(manifestFileName);
+
+  nlohmann::json manifest;
+  manifest["version"] = QSSC_VERSION;
+  manifest["contents_path"] = prefix;
+  nlohmann::json files = nlohmann::json::object();
+  nlohmann::json unchanged = nlohmann::json::array();
+  for (const auto &[name, hash] : hashes) {
+    files[name] = {{"size", getFileContents(name).size()}, {"sha256", hash}};
+    if (!deltaBase)
+      continue;
+    auto base = deltaBase->find(name);
+    if (base != deltaBase->end() && base->second == hash) {
+      unchanged.push_back(name);
+      removeFile(name);
+    }
+  }
+  manifest["files"] = std::move(files);
+  if (deltaBase)
+    manifest["unchanged"] = std::move(unchanged);
+  if (runtimeEstimate)
+    manifest["runtime_estimate"] = {
+        {"num_shots", runtimeEstimate->numShots},
+        {"shot_seconds", runtimeEstimate->shotSeconds},
+        {"job_seconds", runtimeEstimate->jobSeconds}};
+  // the manifest is at the root of the payload, outside of the prefix
+  storeFile(manifestFileName, manifest.dump() + "\n");
+}
+
+llvm::Error PatchablePayload::writeCopy(std::string *outputString) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload does not support writing copies");
+}
+
+llvm::Error PatchablePayload::prepareCopies() {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload does not support writing copies");
+}
+
+llvm::Error PatchablePayload::writeReplacedCopy(
+    std::string *outputString,
+    llvm::ArrayRef<MemberReplacement> replacements) const {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload does not support writing copies");
+}
+
+llvm::Expected<llvm::MutableArrayRef<char>>
+PatchablePayload::mapMember(llvm::StringRef path) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload does not support patching in place");
+}
+
+llvm::Error
+PatchablePayload::updateMappedMember(llvm::StringRef path, uint64_t offset,
+                                     llvm::ArrayRef<char> previous) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload does not support patching in place");
+}
+
+llvm::Error PatchablePayload::setOutputPath(llvm::StringRef outputPath) {
+  return llvm::createStringError(
+      llvm::inconvertibleErrorCode(),
+      "Payload does not support writing to a separate output");
+}
@@ -0,0 +1,131 @@
+//===- PayloadCRC.cpp - CRC-32 of payload members ---------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the CRC-32 utilities shared by the payload
+///  containers
+///
+//===----------------------------------------------------------------------===//
+
+#include "Payload/PayloadCRC.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+// CRC-32 (reflected) polynomial
+constexpr uint32_t crcPolynomial = 0xedb88320;
+
+// multiply a and b modulo the CRC polynomial, see zlib's crc32_combine
+uint32_t multModP(uint32_t a, uint32_t b) {
+  uint32_t m = 1U << 31;
+  uint32_t p = 0;
+  for (;;) {
+    if (a & m) {
+      p ^= b;
+      if ((a & (m - 1)) == 0)
+        break;
+    }
+    m >>= 1;
+    b = b & 1 ? (b >> 1) ^ crcPolynomial : b >> 1;
+  }
+  return p;
+}
+
+// x^(2^n) modulo the CRC polynomial
+const std::array<uint32_t, 32> &getX2NTable() {
+  static const std::array<uint32_t, 32> table = [] {
+    std::array<uint32_t, 32> table;
+    uint32_t p = 1U << 30; // x^1
+    table[0] = p;
+    for (size_t n = 1; n < table.size(); ++n)
+      table[n] = p = multModP(p, p);
+    return table;
+  }();
+  return table;
+}
+
+// x^(n * 2^k) modulo the CRC polynomial
+uint32_t x2NModP(uint64_t n, unsigned k) {
+  auto const &table = getX2NTable();
+  uint32_t p = 1U << 31; // x^0
+  while (n) {
+    if (n & 1)
+      p = multModP(table[k & 31], p);
+    n >>= 1;
+    k++;
+  }
+  return p;
+}
+} // end anonymous namespace
+
+uint32_t qssc::payload::combineCRC32(uint32_t crcA, uint32_t crcB,
+                                     uint64_t sizeB) {
+  // Appending sizeB bytes multiplies the CRC of the first message by
+  // x^(8 * sizeB), see zlib's crc32_combine
+  return multModP(x2NModP(sizeB, 3), crcA) ^ crcB;
+}
+
+uint32_t qssc::payload::parallelCRC32(llvm::ArrayRef<uint8_t> data) {
+  // Chunks are large enough for the combination to be negligible
+  constexpr size_t chunkSize = 256 * 1024;
+  if (data.size() <= chunkSize)
+    return llvm::crc32(data);
+
+  size_t const numChunks = (data.size() + chunkSize - 1) / chunkSize;
+  std::vector<uint32_t> chunkCRCs(numChunks);
+  llvm::parallelFor(0, numChunks, [&](size_t chunk) {
+    chunkCRCs[chunk] = llvm::crc32(data.slice(
+        chunk * chunkSize,
+        std::min(chunkSize, data.size() - chunk * chunkSize)));
+  });
+
+  uint32_t crc = chunkCRCs.front();
+  for (size_t chunk = 1; chunk < numChunks; ++chunk)
+    crc = combineCRC32(
+        crc, chunkCRCs[chunk],
+        std::min(chunkSize, data.size() - chunk * chunkSize));
+  return crc;
+}
+
+uint32_t qssc::payload::updateCRC32(uint32_t crc, uint64_t size,
+                                    uint64_t offset,
+                                    llvm::ArrayRef<uint8_t> oldBytes,
+                                    llvm::ArrayRef<uint8_t> newBytes) {
+  assert(oldBytes.size() == newBytes.size() && "expect equal sized changes");
+  assert(offset + newBytes.size() <= size && "expect change within message");
+
+  // The CRC is affine in the message, hence the CRC of the changed message
+  // differs by the unconditioned CRC of the difference. Leading zero bytes of
+  // the (otherwise zero) difference do not contribute to its CRC, trailing
+  // zero bytes shift it, which is a multiplication by x^(8 * bytes).
+  llvm::SmallVector<uint8_t, 16> delta(newBytes.size());
+  for (size_t i = 0; i < delta.size(); ++i)
+    delta[i] = oldBytes[i] ^ newBytes[i];
+
+  // unconditioned CRC, i.e., initial value zero and no final inversion
+  uint32_t const deltaCRC = ~llvm::crc32(~0U, delta);
+  uint64_t const trailingBytes = size - offset - newBytes.size();
+  return crc ^ multModP(x2NModP(trailingBytes, 3), deltaCRC);
+}
@@ -1,6 +1,6 @@
 //===- PatchableZipPayload.cpp - file supporting parameters ------* C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -20,15 +20,24 @@
 //===----------------------------------------------------------------------===//
 
 #include "Payload/PatchableZipPayload.h"
+#include "Payload/PayloadCRC.h"
 
+#include "ZipStreamWriter.h"
 #include "ZipUtil.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
 #include <cerrno>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <memory>
@@ -40,8 +49,68 @@
 #include <zip.h>
 #include <zipconf.h>
 
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
 namespace qssc::payload {
 
+namespace {
+// Clone from to to such that both share their data, on filesystems which
+// support reflinks. Returns false if the file could not be cloned.
+bool cloneFile(const std::string &from, const std::string &to) {
+#if defined(__linux__) && defined(FICLONE)
+  int fromFD;
+  if (llvm::sys::fs::openFileForRead(from, fromFD))
+    return false;
+  int toFD;
+  if (llvm::sys::fs::openFileForWrite(to, toFD)) {
+    llvm::sys::Process::SafelyCloseFileDescriptor(fromFD);
+    return false;
+  }
+  bool const cloned = ::ioctl(toFD, FICLONE, fromFD) == 0;
+  llvm::sys::Process::SafelyCloseFileDescriptor(toFD);
+  llvm::sys::Process::SafelyCloseFileDescriptor(fromFD);
+  return cloned;
+#else
+  return false;
+#endif
+}
+
+llvm::Error writeFile(llvm::StringRef path, llvm::ArrayRef<char> data) {
+  std::error_code ec;
+  llvm::raw_fd_ostream output(path, ec);
+  if (ec)
+    return llvm::createStringError(ec, "Unable to open " + path + ": " +
+                                           ec.message());
+  output.write(data.data(), data.size());
+  output.close();
+  if (output.has_error())
+    return llvm::createStringError(output.error(), "Unable to write " + path);
+  return llvm::Error::success();
+}
+
+// write the ranges of data to the existing file path at the same offsets
+llvm::Error
+writeRanges(llvm::StringRef path, llvm::ArrayRef<char> data,
+            llvm::ArrayRef<std::pair<uint64_t, uint64_t>> ranges) {
+  std::error_code ec;
+  llvm::raw_fd_ostream output(path, ec, llvm::sys::fs::CD_OpenExisting);
+  if (ec)
+    return llvm::createStringError(ec, "Unable to open " + path + ": " +
+                                           ec.message());
+  for (auto const &[offset, size] : ranges) {
+    output.seek(offset);
+    output.write(data.data() + offset, size);
+  }
+  output.close();
+  if (output.has_error())
+    return llvm::createStringError(output.error(), "Unable to write " + path);
+  return llvm::Error::success();
+}
+} // anonymous namespace
+
 llvm::Expected<std::string> readFileFromZip(zip_t *zip, zip_stat_t &zs) {
   auto *zipFile = zip_fopen_index(zip, zs.index, 0);
 
@@ -113,19 +182,56 @@ llvm::Error PatchableZipPayload::ensureOpen() {
     }
     inMemoryZipSource = zs;
   } else {
-    zip = zip_open(path.c_str(), 0, &errorCode);
+    inMemoryZipSource = nullptr;
+    // Read the archive through a read-only mapping of the file rather than
+    // libzip's file I/O, such that members are paged in lazily without being
+    // buffered on the heap and concurrent binds of the same payload share the
+    // page cache. Files which can not be mapped are opened by path.
+    if (zip_source_t *zs = mapInput_(zipError)) {
+      zip = zip_open_from_source(zs, ZIP_RDONLY, &zipError);
+      if (zip == nullptr) {
+        zip_source_free(zs);
+        inputFile.reset();
+      }
+    }
     if (zip == nullptr) {
-      zip_error_set(&zipError, errorCode, errno);
-      retVal = extractLibZipError(
-          "Failure while opening circuit module (zip) file ", zipError);
+      zip = zip_open(path.c_str(), 0, &errorCode);
+      if (zip == nullptr) {
+        zip_error_set(&zipError, errorCode, errno);
+        retVal = extractLibZipError(
+            "Failure while opening circuit module (zip) file ", zipError);
+      }
     }
-    inMemoryZipSource = nullptr;
   }
 
   zip_error_fini(&zipError);
   return retVal;
 }
 
+zip_source_t *PatchableZipPayload::mapInput_(zip_error_t &zipError) {
+  int fd;
+  if (llvm::sys::fs::openFileForRead(path, fd))
+    return nullptr;
+  auto file = llvm::sys::fs::convertFDToNativeFile(fd);
+
+  llvm::sys::fs::file_status status;
+  std::error_code ec = llvm::sys::fs::status(fd, status);
+  if (!ec && status.getSize() > 0)
+    inputFile.emplace(file, llvm::sys::fs::mapped_file_region::readonly,
+                      status.getSize(), 0, ec);
+  llvm::sys::fs::closeFile(file);
+  if (ec || !inputFile) {
+    inputFile.reset();
+    return nullptr;
+  }
+
+  zip_source_t *zs = zip_source_buffer_create(
+      inputFile->const_data(), inputFile->size(), 0, &zipError);
+  if (zs == nullptr)
+    inputFile.reset();
+  return zs;
+}
+
 void PatchableZipPayload::discardChanges() {
   if (zip == nullptr)
     return;
@@ -144,22 +250,141 @@ llvm::Error PatchableZipPayload::addFileToZip(zip_t *zip,
   if (src == nullptr)
     return extractLibZipError("Creating zip source from data buffer", err);
 
-  if (int const idx =
-          zip_file_add(zip, path.c_str(), src, ZIP_FL_OVERWRITE) < 0) {
-    if (idx < 0) {
-      auto *archiveErr = zip_get_error(zip);
-      return extractLibZipError("Adding or replacing file to zip", *archiveErr);
-    }
-    zip_set_file_compression(zip, idx, ZIP_CM_STORE, 1);
+  zip_int64_t const idx =
+      zip_file_add(zip, path.c_str(), src, ZIP_FL_OVERWRITE);
+  if (idx < 0) {
+    zip_source_free(src);
+    auto *archiveErr = zip_get_error(zip);
+    return extractLibZipError("Adding or replacing file to zip", *archiveErr);
   }
+  auto const index = static_cast<zip_uint64_t>(idx);
+  zip_set_file_compression(zip, index, ZIP_CM_STORE, 1);
+  // libzip stamps new members with the wall clock otherwise
+  zip_file_set_mtime(zip, index, getZipMemberTime(), 0);
+
+  return llvm::Error::success();
+}
 
+llvm::Error PatchableZipPayload::setOutputPath(llvm::StringRef output) {
+  if (zip != nullptr || inPlaceArchive.data() != nullptr)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "The output path must be set before the payload is read");
+  if (!enableInMemory && output == path)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "The output path is the input path");
+  outputPath = output.str();
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableZipPayload::writeOutput_() {
+  if (patchedInPlace) {
+    // The archive was patched in a private mapping or a copy of the input.
+    // If the output can share the data of the input, only the patched bytes
+    // need to be written.
+    if (!enableInMemory && cloneFile(path, outputPath))
+      return writeRanges(outputPath, inPlaceArchive, patchedRanges);
+    return writeFile(outputPath, inPlaceArchive);
+  }
+
+  if (llvm::any_of(files, [](auto &item) { return item.second.writeBack; })) {
+    // stream the members of the input to the output, each written once
+    std::error_code ec;
+    llvm::raw_fd_ostream output(outputPath, ec);
+    if (ec)
+      return llvm::createStringError(ec, "Unable to open " + outputPath +
+                                             ": " + ec.message());
+    if (auto err = writeCopy_(output))
+      return err;
+    output.close();
+    if (output.has_error())
+      return llvm::createStringError(output.error(),
+                                     "Unable to write " + outputPath);
+    return llvm::Error::success();
+  }
+
+  // nothing was patched
+  if (enableInMemory)
+    return writeFile(outputPath, {path.data(), path.size()});
+  if (cloneFile(path, outputPath))
+    return llvm::Error::success();
+  if (std::error_code ec = llvm::sys::fs::copy_file(path, outputPath))
+    return llvm::createStringError(ec, "Failed to copy " + path + " to " +
+                                           outputPath);
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableZipPayload::replaceInput_() {
+  llvm::SmallString<128> tempPath;
+  int fd;
+  if (std::error_code ec =
+          llvm::sys::fs::createUniqueFile(path + "-%%%%%%", fd, tempPath))
+    return llvm::createStringError(
+        ec, "Unable to create a temporary file for " + path + ": " +
+                ec.message());
+
+  auto writeTemp = [&]() -> llvm::Error {
+    llvm::raw_fd_ostream output(fd, /*shouldClose=*/true);
+    if (auto err = writeCopy_(output))
+      return err;
+    output.close();
+    if (output.has_error())
+      return llvm::createStringError(output.error(),
+                                     "Unable to write " + tempPath);
+    return llvm::Error::success();
+  };
+  if (auto err = writeTemp()) {
+    llvm::sys::fs::remove(tempPath);
+    return err;
+  }
+
+  if (auto perms = llvm::sys::fs::getPermissions(path))
+    llvm::sys::fs::setPermissions(tempPath, *perms);
+  if (std::error_code ec = llvm::sys::fs::rename(tempPath, path)) {
+    llvm::sys::fs::remove(tempPath);
+    return llvm::createStringError(ec, "Unable to replace " + path + ": " +
+                                           ec.message());
+  }
   return llvm::Error::success();
 }
 
 llvm::Error PatchableZipPayload::writeBack() {
+  if (!outputPath.empty()) {
+    auto err = writeOutput_();
+    discardChanges();
+    inputFile.reset();
+    mappedFile.reset();
+    inPlaceArchive = {};
+    return err;
+  }
+
+  if (patchedInPlace) {
+    // the members were patched in the archive itself, the archive opened by
+    // libzip only served reading
+    discardChanges();
+    if (mappedFile) {
+      // unmapping the file writes the changes to disk
+      mappedFile.reset();
+      inPlaceArchive = {};
+    }
+    return llvm::Error::success();
+  }
+
   if (zip == nullptr) // no changes pending, thus no operation
     return llvm::Error::success();
 
+  if (inputFile) {
+    // The archive was opened read-only from the mapped payload. Write the
+    // patched payload to a temporary file which replaces the payload, as
+    // libzip would, while the mapping still holds the original contents.
+    bool const patched =
+        llvm::any_of(files, [](auto &item) { return item.second.writeBack; });
+    auto err = patched ? replaceInput_() : llvm::Error::success();
+    discardChanges();
+    inputFile.reset();
+    return err;
+  }
+
   zip_error_t err;
 
   zip_error_init(&err);
@@ -199,7 +424,10 @@ llvm::Error PatchableZipPayload::writeString(std::string *outputString) {
   llvm::raw_ostream *ostream = std::addressof(outStringStream.value());
   ;
 
-  if (inMemoryZipSource) {
+  if (patchedInPlace && enableInMemory) {
+    // the copy of the in memory payload was patched in place
+    ostream->write(inPlaceData.data(), inPlaceData.size());
+  } else if (inMemoryZipSource) {
     // read from in memory source
     zip_int64_t sz;
     char *outbuffer =
@@ -221,6 +449,252 @@ llvm::Error PatchableZipPayload::writeString(std::string *outputString) {
   return llvm::Error::success();
 }
 
+llvm::Error PatchableZipPayload::writeCopy(std::string *outputString) {
+  if (outputString == nullptr) // no output buffer
+    return llvm::make_error<llvm::StringError>("outputString buffer is null",
+                                               llvm::inconvertibleErrorCode());
+
+  if (patchedInPlace) {
+    // the archive itself is up to date
+    outputString->append(inPlaceArchive.data(), inPlaceArchive.size());
+    return llvm::Error::success();
+  }
+
+  llvm::raw_string_ostream ostream(*outputString);
+  return writeCopy_(ostream);
+}
+
+llvm::Error PatchableZipPayload::prepareCopies() {
+  if (patchedInPlace)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Payload members are already patched in place");
+  if (auto err = ensureOpen())
+    return err;
+
+  // read every member once, such that copies are written without libzip,
+  // which may not be used from several threads at once
+  copyMembers.clear();
+  copiesPrepared = false;
+  zip_int64_t const numEntries = zip_get_num_entries(zip, 0);
+  copyMembers.reserve(numEntries);
+  for (zip_int64_t idx = 0; idx < numEntries; ++idx) {
+    const char *name = zip_get_name(zip, idx, ZIP_FL_ENC_RAW);
+    if (name == nullptr) {
+      auto *err = zip_get_error(zip);
+      return extractLibZipError("Reading member name within zip", *err);
+    }
+
+    auto bufOrErr = readMember(name, /*markForWriteBack=*/false);
+    if (auto err = bufOrErr.takeError())
+      return err;
+    auto &buf = bufOrErr.get();
+
+    zip_uint8_t opsys;
+    zip_uint32_t attributes;
+    uint32_t mode = 0100644;
+    if (zip_file_get_external_attributes(zip, idx, 0, &opsys, &attributes) ==
+            0 &&
+        opsys == ZIP_OPSYS_UNIX)
+      mode = attributes >> 16;
+
+    uint32_t const crc = parallelCRC32(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(buf.data()), buf.size()));
+    copyMembers.push_back({name, &buf, mode, crc});
+  }
+  copiesPrepared = true;
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableZipPayload::writeReplacedCopy(
+    std::string *outputString,
+    llvm::ArrayRef<MemberReplacement> replacements) const {
+  if (outputString == nullptr) // no output buffer
+    return llvm::make_error<llvm::StringError>("outputString buffer is null",
+                                               llvm::inconvertibleErrorCode());
+  if (!copiesPrepared)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Copies of the payload are not prepared");
+
+  llvm::raw_string_ostream ostream(*outputString);
+  ZipStreamWriter writer(ostream);
+  for (const auto &member : copyMembers) {
+    const auto *pos =
+        llvm::find_if(replacements, [&](const MemberReplacement &replacement) {
+          return replacement.member == member.buf;
+        });
+    llvm::StringRef contents(member.buf->data(), member.buf->size());
+    std::optional<uint32_t> crc = member.crc;
+    if (pos != replacements.end()) {
+      contents = pos->contents;
+      crc = std::nullopt;
+    }
+    if (auto err = writer.addMember(member.name, contents, member.mode,
+                                    /*alignment=*/1, crc))
+      return err;
+  }
+
+  if (auto err = writer.finish())
+    return err;
+  ostream.flush();
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableZipPayload::writeCopy_(llvm::raw_ostream &ostream) {
+  if (auto err = ensureOpen())
+    return err;
+
+  // Members are read from the archive once and kept, such that repeated
+  // copies only pay for writing. Patched members are written with their
+  // current contents.
+  ZipStreamWriter writer(ostream);
+  zip_int64_t const numEntries = zip_get_num_entries(zip, 0);
+  for (zip_int64_t idx = 0; idx < numEntries; ++idx) {
+    const char *name = zip_get_name(zip, idx, ZIP_FL_ENC_RAW);
+    if (name == nullptr) {
+      auto *err = zip_get_error(zip);
+      return extractLibZipError("Reading member name within zip", *err);
+    }
+
+    auto bufOrErr = readMember(name, /*markForWriteBack=*/false);
+    if (auto err = bufOrErr.takeError())
+      return err;
+    auto &buf = bufOrErr.get();
+
+    zip_uint8_t opsys;
+    zip_uint32_t attributes;
+    uint32_t mode = 0100644;
+    if (zip_file_get_external_attributes(zip, idx, 0, &opsys, &attributes) ==
+            0 &&
+        opsys == ZIP_OPSYS_UNIX)
+      mode = attributes >> 16;
+
+    if (auto err = writer.addMember(
+            name, llvm::StringRef(buf.data(), buf.size()), mode))
+      return err;
+  }
+
+  if (auto err = writer.finish())
+    return err;
+  ostream.flush();
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableZipPayload::ensureMapped() {
+  if (inPlaceArchive.data() != nullptr) // already mapped
+    return llvm::Error::success();
+
+  if (enableInMemory) {
+    // patch a copy, the payload itself still backs the libzip archive
+    inPlaceData = path;
+    inPlaceArchive = {inPlaceData.data(), inPlaceData.size()};
+    return llvm::Error::success();
+  }
+
+  // If the payload is written to a separate output, the input is mapped
+  // copy-on-write such that patches remain private to the mapping
+  bool const patchInput = outputPath.empty();
+  int fd;
+  std::error_code openError =
+      patchInput ? llvm::sys::fs::openFileForReadWrite(
+                       path, fd, llvm::sys::fs::CD_OpenExisting,
+                       llvm::sys::fs::OF_None)
+                 : llvm::sys::fs::openFileForRead(path, fd);
+  if (openError)
+    return llvm::createStringError(openError,
+                                   "Unable to open " + path +
+                                       " for patching in place: " +
+                                       openError.message());
+  auto file = llvm::sys::fs::convertFDToNativeFile(fd);
+
+  llvm::sys::fs::file_status status;
+  std::error_code ec = llvm::sys::fs::status(fd, status);
+  if (!ec && status.getSize() > 0)
+    mappedFile.emplace(file,
+                       patchInput ? llvm::sys::fs::mapped_file_region::readwrite
+                                  : llvm::sys::fs::mapped_file_region::priv,
+                       status.getSize(), 0, ec);
+  llvm::sys::fs::closeFile(file);
+  if (ec || !mappedFile) {
+    mappedFile.reset();
+    return llvm::createStringError(
+        ec ? ec : std::make_error_code(std::errc::invalid_argument),
+        "Unable to map " + path + " for patching in place");
+  }
+
+  inPlaceArchive = {mappedFile->data(), mappedFile->size()};
+  return llvm::Error::success();
+}
+
+llvm::Expected<llvm::MutableArrayRef<char>>
+PatchableZipPayload::mapMember(llvm::StringRef path) {
+  for (auto &item : files)
+    if (item.second.writeBack)
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Payload members are already patched through libzip");
+
+  if (auto err = ensureMapped())
+    return std::move(err);
+
+  auto pos = mappedMembers.find(path.str());
+  if (pos == mappedMembers.end()) {
+    llvm::StringRef const archive(inPlaceArchive.data(),
+                                  inPlaceArchive.size());
+    auto memberOrErr = findStoredZipMember(archive, path);
+    if (!memberOrErr && enableInMemory && path.contains('/')) {
+      // in memory payload does not have leading directory so attempt to
+      // remove, see readMember
+      llvm::consumeError(memberOrErr.takeError());
+      memberOrErr = findStoredZipMember(archive, path.split('/').second);
+    }
+    if (auto err = memberOrErr.takeError())
+      return std::move(err);
+
+    auto &member = *memberOrErr;
+    pos = mappedMembers
+              .emplace(path.str(),
+                       MappedMember{member.dataOffset, member.size,
+                                    member.localCRCOffset,
+                                    member.centralCRCOffset, member.crc})
+              .first;
+  }
+
+  return inPlaceArchive.slice(pos->second.dataOffset, pos->second.size);
+}
+
+llvm::Error
+PatchableZipPayload::updateMappedMember(llvm::StringRef path, uint64_t offset,
+                                        llvm::ArrayRef<char> previous) {
+  auto pos = mappedMembers.find(path.str());
+  if (pos == mappedMembers.end())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Zip member " + path + " is not mapped");
+  auto &member = pos->second;
+  if (offset + previous.size() > member.size)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Patch exceeds zip member " + path);
+
+  auto current =
+      inPlaceArchive.slice(member.dataOffset + offset, previous.size());
+  member.crc = updateCRC32(
+      member.crc, member.size, offset,
+      llvm::ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t *>(previous.data()), previous.size()),
+      llvm::ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t *>(current.data()), current.size()));
+
+  llvm::support::endian::write32le(
+      inPlaceArchive.data() + member.localCRCOffset, member.crc);
+  llvm::support::endian::write32le(
+      inPlaceArchive.data() + member.centralCRCOffset, member.crc);
+  patchedRanges.push_back({member.dataOffset + offset, previous.size()});
+  patchedRanges.push_back({member.localCRCOffset, sizeof(uint32_t)});
+  patchedRanges.push_back({member.centralCRCOffset, sizeof(uint32_t)});
+  patchedInPlace = true;
+  return llvm::Error::success();
+}
+
 llvm::Expected<PatchableZipPayload::ContentBuffer &>
 PatchableZipPayload::readMember(llvm::StringRef path, bool markForWriteBack) {
 
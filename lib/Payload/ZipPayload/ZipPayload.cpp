@@ -21,33 +21,38 @@
 #include "ZipPayload.h"
 
 #include "Payload/Payload.h"
-#include "ZipUtil.h"
+#include "Payload/PayloadCRC.h"
+#include "ZipStreamWriter.h"
 
 #include "Arguments/Signature.h"
-#include "Config.h"
 #include "Payload/PayloadRegistry.h"
 #include <Config/QSSConfig.h>
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <cstdlib>
 #include <filesystem>
-#include <fstream>
 #include <memory>
 #include <mutex>
-#include <nlohmann/json.hpp>
-#include <nlohmann/json_fwd.hpp>
 #include <optional>
 #include <ostream>
+#include <set>
 #include <string>
 // NOLINTNEXTLINE(misc-include-cleaner)
 #include <sys/stat.h>
+#include <system_error>
+#include <utility>
 #include <vector>
-#include <zip.h>
-#include <zipconf.h>
 
 using namespace qssc::payload;
 namespace fs = std::filesystem;
@@ -65,51 +70,85 @@ int qssc::payload::init() {
   return registered ? 0 : -1;
 }
 
-// creates a manifest json file and adds it to the file map
-void ZipPayload::addManifest() {
-  std::lock_guard<std::mutex> const lock(_mtx);
-  std::string const manifest_fname = "manifest/manifest.json";
-  nlohmann::json manifest;
-  manifest["version"] = QSSC_VERSION;
-  manifest["contents_path"] = prefix;
-  files[manifest_fname] = manifest.dump() + "\n";
-}
-
 void ZipPayload::addFile(llvm::StringRef filename, llvm::StringRef str) {
-  std::lock_guard<std::mutex> const lock(_mtx);
-  files[filename.str()] = str;
+  storeFile(filename, str.str());
 }
 
+namespace {
+// the members are written concurrently by at most this many threads, which
+// wait on the file system rather than the processor
+constexpr unsigned maxPlainWriteThreads = 8;
+} // anonymous namespace
+
 void ZipPayload::writePlain(const std::string &dirName) {
-  std::lock_guard<std::mutex> const lock(_mtx);
-  for (const auto &filePair : files) {
-    fs::path fName(dirName);
-    fName /= filePair.first;
+  std::vector<FileRef> const files = orderedFiles();
+  std::vector<fs::path> paths;
+  paths.reserve(files.size());
+  std::set<fs::path> parents;
+  for (const auto &file : files) {
+    paths.emplace_back(fs::path(dirName) / file.name.str());
+    parents.insert(paths.back().parent_path());
+  }
+
+  // create each directory once rather than once for each of its members
+  for (const auto &parent : parents) {
+    std::error_code ec;
+    fs::create_directories(parent, ec);
+    if (ec)
+      llvm::errs() << "Unable to create output directory " << parent << ": "
+                   << ec.message() << "\n";
+  }
 
-    fs::create_directories(fName.parent_path());
-    std::ofstream fStream(fName, std::ofstream::out);
-    if (fStream.fail() || !fStream.good()) {
-      llvm::errs() << "Unable to open output file " << fName << "\n";
-      continue;
+  // report the failures in the order of the members once all are written
+  std::vector<std::string> errors(files.size());
+  auto writeFile = [&](size_t i) {
+    std::error_code ec;
+    llvm::raw_fd_ostream fStream(paths[i].string(), ec);
+    if (ec) {
+      errors[i] = "Unable to open output file " + paths[i].string() + ": " +
+                  ec.message();
+      return;
     }
-    fStream << filePair.second;
+    // the contents are already in memory and written in a single call
+    fStream.SetUnbuffered();
+    fStream << files[i].contents;
     fStream.close();
+    if (fStream.has_error()) {
+      errors[i] = "Unable to write output file " + paths[i].string() + ": " +
+                  fStream.error().message();
+      fStream.clear_error();
+    }
+  };
+
+  if (files.size() > 1) {
+    llvm::ThreadPool pool(llvm::hardware_concurrency(std::min(
+        static_cast<unsigned>(files.size()), maxPlainWriteThreads)));
+    for (size_t i = 0; i < files.size(); ++i)
+      pool.async(writeFile, i);
+    pool.wait();
+  } else if (!files.empty()) {
+    writeFile(0);
   }
+
+  for (const auto &error : errors)
+    if (!error.empty())
+      llvm::errs() << error << "\n";
 }
 
 void ZipPayload::writePlain(llvm::raw_ostream &stream) {
-  std::vector<fs::path> const orderedNames = orderedFileNames();
+  std::vector<FileRef> const files = orderedFiles();
   stream << "------------------------------------------\n";
   stream << "Plaintext payload: " << prefix << "\n";
   stream << "------------------------------------------\n";
   stream << "Manifest:\n";
-  for (auto &fName : orderedNames)
-    stream << fName << "\n";
+  for (const auto &file : files)
+    stream << file.name << "\n";
   stream << "------------------------------------------\n";
-  for (auto &fName : orderedNames) {
-    stream << "File: " << fName << "\n";
-    stream << files[fName];
-    if (*(files[fName].rbegin()) != '\n')
+  for (const auto &file : files) {
+    stream << "File: " << file.name << "\n";
+    llvm::StringRef const contents = file.contents;
+    stream << contents;
+    if (!contents.ends_with("\n"))
       stream << "\n";
     stream << "------------------------------------------\n";
   }
@@ -121,31 +160,17 @@ void ZipPayload::writePlain(std::ostream &stream) {
 }
 
 namespace {
-void setFilePermissions(zip_int64_t fileIndex, fs::path &fName,
-                        zip_t *new_archive) {
-  zip_uint8_t opsys;
-  zip_uint32_t attributes;
-  zip_file_get_external_attributes(new_archive, fileIndex, 0, &opsys,
-                                   &attributes);
-  if (opsys == ZIP_OPSYS_UNIX) {
-    zip_uint32_t mask = UINT32_MAX; // all 1s for negative mask
-    // NOLINTNEXTLINE(misc-include-cleaner)
-    mask ^= (S_IWGRP << 16); // turn off write for the group
-    // NOLINTNEXTLINE(misc-include-cleaner)
-    mask ^= (S_IWOTH << 16); // turn off write for others
-
-    // apply negative write mask
-    attributes &= mask;
+uint32_t getFileMode(llvm::StringRef fName) {
+  // regular file, writable only by the user
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  uint32_t mode = S_IFREG | S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
 
-    // if executable turn on S_IXUSR
-    if (fName.has_extension() && fName.extension() == ".sh")
-      // NOLINTNEXTLINE(misc-include-cleaner)
-      attributes |= (S_IXUSR << 16); // turn on execute for user
+  // if executable turn on S_IXUSR
+  if (llvm::sys::path::extension(fName) == ".sh")
+    // NOLINTNEXTLINE(misc-include-cleaner)
+    mode |= S_IXUSR; // turn on execute for user
 
-    // set new attributes
-    zip_file_set_external_attributes(new_archive, fileIndex, 0, opsys,
-                                     attributes);
-  }
+  return mode;
 }
 } // end anonymous namespace
 
@@ -155,94 +180,62 @@ void ZipPayload::writeZip(llvm::raw_ostream &stream) {
   // first add the manifest
   addManifest();
 
-  // zip archive stuff
-  zip_source_t *new_archive_src;
-  zip_source_t *file_src;
-  zip_t *new_archive;
-  zip_error_t error;
-
-  //===---- Initialize archive ----===//
-  zip_error_init(&error);
-
-  // open a zip source, buffer is allocated internally to libzip
-  new_archive_src = zip_source_buffer_create(nullptr, 0, 0, &error);
-  if (new_archive_src == nullptr) {
-    llvm::errs() << "Can't create zip source for new archive: "
-                 << zip_error_strerror(&error) << "\n";
-    zip_error_fini(&error);
+  // Members are written to the stream as they are added and straight from
+  // the payload's buffers, the archive is never held in memory. Its limits
+  // are checked beforehand such that a failure writes nothing rather than a
+  // zip without a central directory.
+  std::vector<FileRef> const files = orderedFiles();
+  std::vector<ZipStreamWriter::MemberLayout> layout;
+  layout.reserve(files.size());
+  for (const auto &file : files)
+    layout.push_back(
+        {file.name, file.contents.size(),
+         patchableMembers.count(file.name) ? patchableMemberAlignment
+                                           : static_cast<uint16_t>(1)});
+  if (auto err = ZipStreamWriter::checkLimits(layout)) {
+    llvm::errs() << "Problem writing zip archive: "
+                 << llvm::toString(std::move(err)) << "\n";
     return;
   }
-
-  // make sure the new source buffer stays around after closing the archive
-  zip_source_keep(new_archive_src);
-
-  // create and open an archive from the new archive source
-  new_archive = zip_open_from_source(new_archive_src, ZIP_TRUNCATE, &error);
-  if (new_archive == nullptr) {
-    llvm::errs() << "Can't create/open an archive from the new archive source: "
-                 << zip_error_strerror(&error) << "\n";
-    zip_source_free(new_archive_src);
-    zip_error_fini(&error);
-    return;
-  }
-  zip_error_fini(&error);
-
-  if (verbosity >= qssc::config::QSSVerbosity::Info)
-    llvm::outs() << "Zip buffer created, adding files to archive\n";
-  // archive is now allocated and created, need to fill it with files/data
-  std::vector<fs::path> orderedNames = orderedFileNames();
-  for (auto &fName : orderedNames) {
+  ZipStreamWriter writer(stream);
+
+  // The checksums are the only work per byte of the members, compute them
+  // for all members in parallel ahead of the sequential writes
+  std::vector<uint32_t> memberCRCs(files.size());
+  llvm::parallelFor(0, files.size(), [&](size_t index) {
+    llvm::StringRef const contents = files[index].contents;
+    memberCRCs[index] = parallelCRC32(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(contents.data()), contents.size()));
+  });
+
+  for (size_t index = 0; index < files.size(); ++index) {
+    llvm::StringRef const fName = files[index].name;
+    llvm::StringRef const contents = files[index].contents;
     if (verbosity >= qssc::config::QSSVerbosity::Info)
-      llvm::outs() << "Adding file " << fName << " to archive buffer ("
-                   << files[fName].size() << " bytes)\n";
+      llvm::outs() << "Adding file " << fName << " to archive ("
+                   << contents.size() << " bytes)\n";
 
-    //===---- Add file ----===//
-    // init the error object
-    zip_error_init(&error);
-
-    // first create a zip source from the file data
-    file_src = zip_source_buffer_create(files[fName].c_str(),
-                                        files[fName].size(), 0, &error);
-    if (file_src == nullptr) {
-      llvm::errs() << "Can't create zip source for " << fName << " : "
-                   << zip_error_strerror(&error) << "\n";
-      zip_error_fini(&error);
-      continue;
-    }
-    zip_error_fini(&error);
-
-    // now add it to the archive
-    zip_int64_t const fileIndex =
-        zip_file_add(new_archive, fName.c_str(), file_src, ZIP_FL_OVERWRITE);
-    if (fileIndex < 0) {
+    uint16_t const alignment =
+        patchableMembers.count(fName) ? patchableMemberAlignment : 1;
+    if (auto err = writer.addMember(fName, contents, getFileMode(fName),
+                                    alignment, memberCRCs[index])) {
       llvm::errs() << "Problem adding file " << fName
-                   << " to archive: " << zip_strerror(new_archive) << "\n";
-      continue;
+                   << " to archive: " << llvm::toString(std::move(err))
+                   << "\n";
+      return;
     }
-    zip_set_file_compression(new_archive, fileIndex, ZIP_CM_STORE, 1);
-
-    setFilePermissions(fileIndex, fName, new_archive);
   }
 
   //===---- Shutdown archive ----===//
-  // shutdown the archive, write central directory
-  if (zip_close(new_archive) < 0) {
+  // write central directory
+  if (auto err = writer.finish()) {
     llvm::errs() << "Problem closing new zip archive: "
-                 << zip_strerror(new_archive) << "\n";
+                 << llvm::toString(std::move(err)) << "\n";
     return;
   }
-
-  //===---- Reopen for copying ----===//
-  zip_int64_t sz;
-  char *outbuffer = read_zip_src_to_buffer(new_archive_src, sz);
   if (verbosity >= qssc::config::QSSVerbosity::Info)
-    llvm::outs() << "Zip buffer is of size " << sz << " bytes\n";
-  if (outbuffer) {
-    // output the new archive to the stream
-    stream.write(outbuffer, sz);
-    stream.flush();
-    free(outbuffer);
-  }
+    llvm::outs() << "Zip archive is of size " << writer.getOffset()
+                 << " bytes\n";
 }
 
 void ZipPayload::writeZip(std::ostream &stream) {
@@ -255,5 +248,19 @@ void ZipPayload::write(llvm::raw_ostream &stream) { writeZip(stream); }
 void ZipPayload::write(std::ostream &stream) { writeZip(stream); }
 
 void ZipPayload::writeArgumentSignature(qssc::arguments::Signature &&sig) {
+  {
+    std::lock_guard<std::mutex> const lock(_mtx);
+    for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
+      if (patchPoints.empty())
+        continue;
+      // binaries may be named with or without the payload's prefix
+      patchableMembers.insert(binaryName);
+      patchableMembers.insert(prefix + binaryName);
+    }
+  }
+
+  // the binary signature is read when binding, the text signature is kept for
+  // debugging
+  getFile("arguments_signature.bin")->assign(sig.serializeBinary());
   getFile("arguments_signature.txt")->assign(sig.serialize());
 }
@@ -1,6 +1,6 @@
 //===- ZipPayload.h ---------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,6 +23,11 @@
 
 #include "Payload/Payload.h"
 
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+
 namespace qssc::payload {
 
 // Register the zip payload.
@@ -49,13 +54,19 @@ public:
   // write all files to a zip archive and output it to the stream
   void writeZip(std::ostream &stream);
   void writeZip(llvm::raw_ostream &stream);
-  // write all files in plaintext to the dir named dirName
+  // write all files in plaintext to the dir named dirName, concurrently on a
+  // bounded number of threads
   void writePlain(const std::string &dirName = ".");
+  using Payload::addFile;
   void addFile(llvm::StringRef filename, llvm::StringRef str) override;
 
+  // alignment of the data of members with patch points, which are stored
+  // uncompressed such that they can be patched in place
+  static constexpr uint16_t patchableMemberAlignment = 8;
+
 private:
-  // creates a manifest json file
-  void addManifest();
+  // names of the members with patch points
+  std::set<std::string, std::less<>> patchableMembers;
 
 }; // class ZipPayload
 
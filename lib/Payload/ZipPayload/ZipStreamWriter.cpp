@@ -0,0 +1,239 @@
+//===- ZipStreamWriter.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the ZipStreamWriter class
+///
+//===----------------------------------------------------------------------===//
+
+#include "ZipStreamWriter.h"
+#include "ZipUtil.h"
+
+#include "Payload/PayloadCRC.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <optional>
+
+using namespace qssc::payload;
+
+namespace {
+// Zip record signatures
+constexpr uint32_t localFileHeaderSignature = 0x04034b50;
+constexpr uint32_t centralDirectorySignature = 0x02014b50;
+constexpr uint32_t endOfCentralDirectorySignature = 0x06054b50;
+
+// Version 2.0 of the specification, the minimum for stored members with
+// directory names. The upper byte of "version made by" declares that the
+// external attributes hold unix file modes.
+constexpr uint16_t zipVersion = 20;
+constexpr uint16_t zipVersionMadeBy = (3 << 8) | zipVersion;
+
+// Extra field padding the local header such that the member data is aligned,
+// as written by zipalign-like tools: the alignment followed by zero bytes
+constexpr uint16_t alignmentExtraFieldId = 0xa11e;
+constexpr uint16_t alignmentExtraFieldMinSize = 6;
+constexpr uint64_t localFileHeaderSize = 30;
+constexpr uint64_t centralDirectoryHeaderSize = 46;
+
+constexpr uint32_t zip32Limit = std::numeric_limits<uint32_t>::max();
+constexpr uint16_t zip32EntryLimit = std::numeric_limits<uint16_t>::max();
+
+llvm::Error zip64Required(llvm::StringRef what) {
+  return llvm::createStringError(
+      llvm::inconvertibleErrorCode(),
+      "Zip payload " + what + " exceeds the limits of zip archives without "
+                              "zip64 extensions");
+}
+
+// size of the extra field padding the local header of a member with a name
+// of nameSize at offset such that its data is aligned
+uint16_t getAlignmentExtraSize(uint64_t offset, size_t nameSize,
+                               uint16_t alignment) {
+  if (alignment <= 1)
+    return 0;
+  uint64_t const dataOffset = offset + localFileHeaderSize + nameSize;
+  if (dataOffset % alignment == 0)
+    return 0;
+  uint64_t const minDataOffset = dataOffset + alignmentExtraFieldMinSize;
+  return static_cast<uint16_t>(alignmentExtraFieldMinSize +
+                               (alignment - minDataOffset % alignment) %
+                                   alignment);
+}
+} // end anonymous namespace
+
+ZipStreamWriter::ZipStreamWriter(llvm::raw_ostream &stream) : stream(stream) {
+  // All members are stamped with a fixed time rather than the wall clock, in
+  // the MS-DOS format used by zip, such that the archive bytes only depend on
+  // its contents
+  std::time_t const memberTime = getZipMemberTime();
+  std::tm utc{};
+  gmtime_r(&memberTime, &utc);
+  dosTime = static_cast<uint16_t>((utc.tm_hour << 11) | (utc.tm_min << 5) |
+                                  (utc.tm_sec / 2));
+  dosDate = static_cast<uint16_t>(((utc.tm_year - 80) << 9) |
+                                  ((utc.tm_mon + 1) << 5) | utc.tm_mday);
+}
+
+void ZipStreamWriter::write16_(uint16_t value) {
+  llvm::support::endian::write<uint16_t>(stream, value, llvm::support::little);
+  offset += sizeof(value);
+}
+
+void ZipStreamWriter::write32_(uint32_t value) {
+  llvm::support::endian::write<uint32_t>(stream, value, llvm::support::little);
+  offset += sizeof(value);
+}
+
+void ZipStreamWriter::writeBytes_(llvm::StringRef bytes) {
+  stream.write(bytes.data(), bytes.size());
+  offset += bytes.size();
+}
+
+void ZipStreamWriter::writeZeros_(size_t count) {
+  stream.write_zeros(count);
+  offset += count;
+}
+
+llvm::Error ZipStreamWriter::addMember(llvm::StringRef name,
+                                       llvm::StringRef contents,
+                                       uint32_t mode, uint16_t alignment,
+                                       std::optional<uint32_t> crc) {
+  if (finished)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Zip archive is already finished");
+  if (contents.size() >= zip32Limit || offset >= zip32Limit)
+    return zip64Required("member " + name.str());
+  if (entries.size() >= zip32EntryLimit)
+    return zip64Required("member count");
+
+  // The member is stored, hence the checksum and size are known before its
+  // data is written and no data descriptor is needed
+  if (!crc)
+    crc = parallelCRC32(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(contents.data()), contents.size()));
+  auto const size = static_cast<uint32_t>(contents.size());
+  entries.push_back(
+      {name.str(), *crc, size, mode, static_cast<uint32_t>(offset)});
+
+  // pad the extra field such that the member data is aligned
+  uint16_t const extraSize =
+      getAlignmentExtraSize(offset, name.size(), alignment);
+
+  //===---- Local file header ----===//
+  write32_(localFileHeaderSignature);
+  write16_(zipVersion);
+  write16_(0); // general purpose flags
+  write16_(0); // compression method: stored
+  write16_(dosTime);
+  write16_(dosDate);
+  write32_(*crc);
+  write32_(size); // compressed size
+  write32_(size); // uncompressed size
+  write16_(static_cast<uint16_t>(name.size()));
+  write16_(extraSize);
+  writeBytes_(name);
+  if (extraSize > 0) {
+    write16_(alignmentExtraFieldId);
+    write16_(extraSize - 4); // size of the extra field data
+    write16_(alignment);
+    writeZeros_(extraSize - alignmentExtraFieldMinSize);
+  }
+
+  //===---- Member data ----===//
+  writeBytes_(contents);
+  return llvm::Error::success();
+}
+
+llvm::Error
+ZipStreamWriter::checkLimits(llvm::ArrayRef<MemberLayout> members) {
+  // mirrors the checks of addMember and finish on the offsets they would
+  // write at
+  uint64_t offset = 0;
+  for (size_t index = 0; index < members.size(); ++index) {
+    const auto &member = members[index];
+    if (member.size >= zip32Limit || offset >= zip32Limit)
+      return zip64Required("member " + member.name.str());
+    if (index >= zip32EntryLimit)
+      return zip64Required("member count");
+    offset += localFileHeaderSize + member.name.size() +
+              getAlignmentExtraSize(offset, member.name.size(),
+                                    member.alignment) +
+              member.size;
+  }
+
+  if (offset >= zip32Limit)
+    return zip64Required("size");
+  for (const auto &member : members)
+    offset += centralDirectoryHeaderSize + member.name.size();
+  if (offset >= zip32Limit)
+    return zip64Required("central directory");
+  return llvm::Error::success();
+}
+
+llvm::Error ZipStreamWriter::finish() {
+  if (finished)
+    return llvm::Error::success();
+  finished = true;
+
+  if (offset >= zip32Limit)
+    return zip64Required("size");
+
+  //===---- Central directory ----===//
+  uint64_t const centralDirectoryOffset = offset;
+  for (const auto &entry : entries) {
+    write32_(centralDirectorySignature);
+    write16_(zipVersionMadeBy);
+    write16_(zipVersion);
+    write16_(0); // general purpose flags
+    write16_(0); // compression method: stored
+    write16_(dosTime);
+    write16_(dosDate);
+    write32_(entry.crc);
+    write32_(entry.size); // compressed size
+    write32_(entry.size); // uncompressed size
+    write16_(static_cast<uint16_t>(entry.name.size()));
+    write16_(0); // extra field length
+    write16_(0); // file comment length
+    write16_(0); // disk number start
+    write16_(0); // internal file attributes
+    write32_(entry.mode << 16);
+    write32_(entry.localHeaderOffset);
+    writeBytes_(entry.name);
+  }
+  uint64_t const centralDirectorySize = offset - centralDirectoryOffset;
+  if (offset >= zip32Limit)
+    return zip64Required("central directory");
+
+  //===---- End of central directory ----===//
+  write32_(endOfCentralDirectorySignature);
+  write16_(0); // number of this disk
+  write16_(0); // disk with the central directory
+  write16_(static_cast<uint16_t>(entries.size()));
+  write16_(static_cast<uint16_t>(entries.size()));
+  write32_(static_cast<uint32_t>(centralDirectorySize));
+  write32_(static_cast<uint32_t>(centralDirectoryOffset));
+  write16_(0); // comment length
+
+  stream.flush();
+  return llvm::Error::success();
+}
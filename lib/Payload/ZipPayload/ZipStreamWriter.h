@@ -0,0 +1,92 @@
+//===- ZipStreamWriter.h ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declares a writer that streams a zip archive to an output stream
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_ZIPSTREAMWRITER_H
+#define PAYLOAD_ZIPSTREAMWRITER_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace qssc::payload {
+
+// Writes a zip archive of stored (uncompressed) members directly to an output
+// stream. Each member is written as soon as it is added, so that neither the
+// archive nor a copy of the member has to be held in memory. Only the central
+// directory entries are kept until finish() is called.
+class ZipStreamWriter {
+public:
+  explicit ZipStreamWriter(llvm::raw_ostream &stream);
+
+  // write the member name with the given contents and unix file mode. The
+  // data of the member starts at an offset that is a multiple of alignment.
+  // The CRC-32 of contents is computed unless it is passed as crc, e.g., when
+  // the CRCs of all members were computed in parallel beforehand.
+  llvm::Error addMember(llvm::StringRef name, llvm::StringRef contents,
+                        uint32_t mode = 0100644, uint16_t alignment = 1,
+                        std::optional<uint32_t> crc = std::nullopt);
+  // write the central directory, no members may be added afterwards
+  llvm::Error finish();
+
+  // a member as passed to addMember, without its contents
+  struct MemberLayout {
+    llvm::StringRef name;
+    uint64_t size;
+    uint16_t alignment = 1;
+  };
+  // check that the archive of members, added in order, is within the limits
+  // of zip archives without zip64 extensions, such that callers can fail
+  // before a truncated archive is written to the stream
+  static llvm::Error checkLimits(llvm::ArrayRef<MemberLayout> members);
+
+  // number of bytes written to the stream so far
+  uint64_t getOffset() const { return offset; }
+
+private:
+  struct CentralDirectoryEntry {
+    std::string name;
+    uint32_t crc;
+    uint32_t size;
+    uint32_t mode;
+    uint32_t localHeaderOffset;
+  };
+
+  void write16_(uint16_t value);
+  void write32_(uint32_t value);
+  void writeBytes_(llvm::StringRef bytes);
+  void writeZeros_(size_t count);
+
+  llvm::raw_ostream &stream;
+  uint64_t offset = 0;
+  uint16_t dosTime;
+  uint16_t dosDate;
+  bool finished = false;
+  std::vector<CentralDirectoryEntry> entries;
+}; // class ZipStreamWriter
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_ZIPSTREAMWRITER_H
@@ -20,13 +20,36 @@
 
 #include "ZipUtil.h"
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <ctime>
 #include <zip.h>
 #include <zipconf.h>
 
+std::time_t qssc::payload::getZipMemberTime() {
+  // 1980-01-01 00:00:00 UTC and 2107-12-31 23:59:58 UTC, the range of the
+  // MS-DOS times used by zip
+  constexpr std::time_t dosEpoch = 315532800;
+  constexpr std::time_t dosEnd = 4354819198;
+
+  uint64_t sourceDateEpoch = 0;
+  const char *env = std::getenv("SOURCE_DATE_EPOCH");
+  if (env == nullptr ||
+      llvm::StringRef(env).trim().getAsInteger(10, sourceDateEpoch))
+    return dosEpoch;
+  if (sourceDateEpoch >= static_cast<uint64_t>(dosEnd))
+    return dosEnd;
+  return std::max(static_cast<std::time_t>(sourceDateEpoch), dosEpoch);
+}
+
 char *qssc::payload::read_zip_src_to_buffer(zip_source_t *zip_src,
                                             zip_int64_t &sz) {
   //===---- Reopen for copying ----===//
@@ -54,3 +77,101 @@ char *qssc::payload::read_zip_src_to_buffer(zip_source_t *zip_src,
   zip_source_close(zip_src);
   return outbuffer;
 }
+
+namespace {
+// Zip record signatures and sizes
+constexpr uint32_t localFileHeaderSignature = 0x04034b50;
+constexpr uint32_t centralDirectorySignature = 0x02014b50;
+constexpr uint32_t endOfCentralDirectorySignature = 0x06054b50;
+constexpr size_t localFileHeaderSize = 30;
+constexpr size_t centralDirectoryHeaderSize = 46;
+constexpr size_t endOfCentralDirectorySize = 22;
+constexpr size_t maxCommentSize = 0xffff;
+// general purpose flag signalling a trailing data descriptor
+constexpr uint16_t dataDescriptorFlag = 1 << 3;
+
+uint16_t read16(llvm::StringRef archive, uint64_t offset) {
+  return llvm::support::endian::read16le(archive.data() + offset);
+}
+
+uint32_t read32(llvm::StringRef archive, uint64_t offset) {
+  return llvm::support::endian::read32le(archive.data() + offset);
+}
+
+llvm::Error invalidArchive(llvm::StringRef msg) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Invalid zip archive: " + msg);
+}
+} // end anonymous namespace
+
+llvm::Expected<qssc::payload::StoredZipMember>
+qssc::payload::findStoredZipMember(llvm::StringRef archive,
+                                   llvm::StringRef name) {
+  //===---- End of central directory ----===//
+  // the record is followed by a comment of up to 64k bytes
+  if (archive.size() < endOfCentralDirectorySize)
+    return invalidArchive("too small");
+  uint64_t eocd = archive.size() - endOfCentralDirectorySize;
+  uint64_t const eocdLimit =
+      eocd > maxCommentSize ? eocd - maxCommentSize : 0;
+  while (read32(archive, eocd) != endOfCentralDirectorySignature) {
+    if (eocd == eocdLimit)
+      return invalidArchive("missing end of central directory");
+    --eocd;
+  }
+
+  uint16_t const numEntries = read16(archive, eocd + 10);
+  uint64_t offset = read32(archive, eocd + 16);
+
+  //===---- Central directory ----===//
+  for (uint16_t entry = 0; entry < numEntries; ++entry) {
+    if (offset + centralDirectoryHeaderSize > eocd ||
+        read32(archive, offset) != centralDirectorySignature)
+      return invalidArchive("corrupt central directory");
+
+    uint16_t const flags = read16(archive, offset + 8);
+    uint16_t const method = read16(archive, offset + 10);
+    uint32_t const crc = read32(archive, offset + 16);
+    uint32_t const compressedSize = read32(archive, offset + 20);
+    uint32_t const size = read32(archive, offset + 24);
+    uint16_t const nameSize = read16(archive, offset + 28);
+    uint16_t const extraSize = read16(archive, offset + 30);
+    uint16_t const commentSize = read16(archive, offset + 32);
+    uint32_t const localHeaderOffset = read32(archive, offset + 42);
+    uint64_t const centralCRCOffset = offset + 16;
+
+    if (offset + centralDirectoryHeaderSize + nameSize > eocd)
+      return invalidArchive("corrupt central directory");
+    llvm::StringRef const entryName =
+        archive.substr(offset + centralDirectoryHeaderSize, nameSize);
+    offset += centralDirectoryHeaderSize + nameSize + extraSize + commentSize;
+
+    if (entryName != name)
+      continue;
+
+    if (method != 0 || compressedSize != size)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Zip member " + name +
+                                         " is not stored uncompressed");
+    if (flags & dataDescriptorFlag)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Zip member " + name +
+                                         " uses a data descriptor");
+
+    //===---- Local file header ----===//
+    if (localHeaderOffset + localFileHeaderSize > archive.size() ||
+        read32(archive, localHeaderOffset) != localFileHeaderSignature)
+      return invalidArchive("corrupt local header of " + name.str());
+    uint64_t const dataOffset = localHeaderOffset + localFileHeaderSize +
+                                read16(archive, localHeaderOffset + 26) +
+                                read16(archive, localHeaderOffset + 28);
+    if (dataOffset + size > archive.size())
+      return invalidArchive("truncated member " + name.str());
+
+    return StoredZipMember{dataOffset, size, localHeaderOffset + 14,
+                           centralCRCOffset, crc};
+  }
+
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Zip member " + name + " not found");
+}
@@ -1,6 +1,6 @@
 //===- ZipUtil.h ------------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -21,6 +21,11 @@
 #ifndef PAYLOAD_ZIPUTIL_H
 #define PAYLOAD_ZIPUTIL_H
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <ctime>
 #include <zip.h>
 
 namespace qssc::payload {
@@ -28,6 +33,27 @@ namespace qssc::payload {
 // read zip into buffer - buffer allocated in function
 char *read_zip_src_to_buffer(zip_source_t *zip_src, zip_int64_t &sz);
 
+// location of a stored (uncompressed) member within a zip archive
+struct StoredZipMember {
+  // offset of the member's data
+  uint64_t dataOffset;
+  uint64_t size;
+  // offsets of the member's CRC-32 in its local and central directory headers
+  uint64_t localCRCOffset;
+  uint64_t centralCRCOffset;
+  uint32_t crc;
+};
+
+// time the members of written archives are stamped with, such that payloads
+// are reproducible: SOURCE_DATE_EPOCH when it is set, otherwise 1980-01-01,
+// the earliest time zip archives can represent
+std::time_t getZipMemberTime();
+
+// locate the stored member name in the zip archive held by archive, fails if
+// the member does not exist or is compressed
+llvm::Expected<StoredZipMember> findStoredZipMember(llvm::StringRef archive,
+                                                    llvm::StringRef name);
+
 } // namespace qssc::payload
 
 #endif // PAYLOAD_ZIPUTIL_H
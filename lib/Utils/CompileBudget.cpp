@@ -0,0 +1,110 @@
+//===- CompileBudget.cpp - Compile time and memory budget -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the compile time and memory budget of a compilation.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Utils/CompileBudget.h"
+#include "Utils/CompileControl.h"
+
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/Operation.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/ManagedStatic.h"
+
+#include <sys/resource.h>
+
+using namespace qssc::utils;
+
+namespace {
+uint64_t getPeakRSSMiB() {
+  struct rusage usage {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return static_cast<uint64_t>(usage.ru_maxrss) >> 20;
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) >> 10;
+#endif
+}
+
+struct ContextCompileBudgets {
+  std::mutex mutex;
+  llvm::DenseMap<mlir::MLIRContext *, CompileBudget *> budgets;
+};
+
+llvm::ManagedStatic<ContextCompileBudgets> contextCompileBudgets;
+} // anonymous namespace
+
+CompileBudget::CompileBudget(std::optional<std::chrono::milliseconds> deadline,
+                             std::optional<uint64_t> memoryBudgetMiB)
+    : start(std::chrono::steady_clock::now()), deadline(deadline),
+      memoryBudgetMiB(memoryBudgetMiB) {}
+
+std::optional<std::string> CompileBudget::getExceededReason() const {
+  if (deadline.has_value()) {
+    auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    if (elapsed > *deadline)
+      return "compile deadline of " + std::to_string(deadline->count()) +
+             " ms exceeded after " + std::to_string(elapsed.count()) + " ms";
+  }
+  if (memoryBudgetMiB.has_value()) {
+    uint64_t const peakRSS = getPeakRSSMiB();
+    if (peakRSS > *memoryBudgetMiB)
+      return "memory budget of " + std::to_string(*memoryBudgetMiB) +
+             " MiB exceeded by a peak resident set size of " +
+             std::to_string(peakRSS) + " MiB";
+  }
+  return std::nullopt;
+}
+
+bool CompileBudget::shouldSkip(mlir::Operation *op, llvm::StringRef work) {
+  auto reason = getExceededReason();
+  if (!reason)
+    return false;
+
+  std::lock_guard<std::mutex> const lock(mutex);
+  if (skippedWork.insert(work).second)
+    op->emitWarning() << *reason << ", skipping " << work;
+  return true;
+}
+
+void qssc::utils::setContextCompileBudget(mlir::MLIRContext *context,
+                                          CompileBudget *budget) {
+  std::lock_guard<std::mutex> const lock(contextCompileBudgets->mutex);
+  if (budget)
+    contextCompileBudgets->budgets[context] = budget;
+  else
+    contextCompileBudgets->budgets.erase(context);
+}
+
+CompileBudget *
+qssc::utils::getContextCompileBudget(mlir::MLIRContext *context) {
+  std::lock_guard<std::mutex> const lock(contextCompileBudgets->mutex);
+  return contextCompileBudgets->budgets.lookup(context);
+}
+
+bool qssc::utils::shouldSkipOverBudget(mlir::Operation *op,
+                                       llvm::StringRef work) {
+  // the output of a cancelled compilation is discarded
+  if (isCompileCancelled(op->getContext()))
+    return true;
+  auto *budget = getContextCompileBudget(op->getContext());
+  return budget && budget->shouldSkip(op, work);
+}
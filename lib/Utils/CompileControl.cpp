@@ -0,0 +1,86 @@
+//===- CompileControl.cpp - Compile cancellation and progress ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Utils/CompileControl.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/ManagedStatic.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+using namespace qssc::utils;
+
+namespace {
+struct ContextCompileControls {
+  std::mutex mutex;
+  llvm::DenseMap<mlir::MLIRContext *, CompileControl *> controls;
+};
+
+llvm::ManagedStatic<ContextCompileControls> contextCompileControls;
+} // anonymous namespace
+
+CompileControl::CompileControl(std::shared_ptr<CancellationToken> token,
+                               ProgressCallback onProgress)
+    : token(std::move(token)), onProgress(std::move(onProgress)) {}
+
+llvm::Error CompileControl::checkCancelled(llvm::StringRef stage) const {
+  if (!isCancelled())
+    return llvm::Error::success();
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Compilation cancelled before " + stage);
+}
+
+void CompileControl::reportProgress(llvm::StringRef stage) {
+  if (!onProgress)
+    return;
+  std::lock_guard<std::mutex> const lock(progressMutex);
+  onProgress(stage);
+}
+
+void qssc::utils::setContextCompileControl(mlir::MLIRContext *context,
+                                           CompileControl *control) {
+  std::lock_guard<std::mutex> const lock(contextCompileControls->mutex);
+  if (control)
+    contextCompileControls->controls[context] = control;
+  else
+    contextCompileControls->controls.erase(context);
+}
+
+CompileControl *
+qssc::utils::getContextCompileControl(mlir::MLIRContext *context) {
+  std::lock_guard<std::mutex> const lock(contextCompileControls->mutex);
+  return contextCompileControls->controls.lookup(context);
+}
+
+bool qssc::utils::isCompileCancelled(mlir::MLIRContext *context) {
+  auto *control = getContextCompileControl(context);
+  return control && control->isCancelled();
+}
+
+llvm::Error qssc::utils::checkCompileCancelled(mlir::MLIRContext *context,
+                                               llvm::StringRef stage) {
+  if (auto *control = getContextCompileControl(context))
+    return control->checkCancelled(stage);
+  return llvm::Error::success();
+}
+
+void qssc::utils::reportCompileProgress(mlir::MLIRContext *context,
+                                        llvm::StringRef stage) {
+  if (auto *control = getContextCompileControl(context))
+    control->reportProgress(stage);
+}
@@ -0,0 +1,53 @@
+//===- CounterSink.cpp - Sink for compilation counters ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the registry of the counter sink of each
+///  MLIRContext.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Utils/CounterSink.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/ManagedStatic.h"
+
+#include <mutex>
+
+using namespace qssc::utils;
+
+namespace {
+// passes of several contexts may look up their sinks concurrently
+struct ContextCounterSinks {
+  std::mutex mutex;
+  llvm::DenseMap<mlir::MLIRContext *, CounterSink *> sinks;
+};
+
+llvm::ManagedStatic<ContextCounterSinks> contextCounterSinks;
+} // anonymous namespace
+
+void qssc::utils::setContextCounterSink(mlir::MLIRContext *context,
+                                        CounterSink *sink) {
+  std::lock_guard<std::mutex> const lock(contextCounterSinks->mutex);
+  if (sink)
+    contextCounterSinks->sinks[context] = sink;
+  else
+    contextCounterSinks->sinks.erase(context);
+}
+
+CounterSink *qssc::utils::getContextCounterSink(mlir::MLIRContext *context) {
+  std::lock_guard<std::mutex> const lock(contextCounterSinks->mutex);
+  return contextCounterSinks->sinks.lookup(context);
+}
@@ -1,4 +1,4 @@
-# (C) Copyright IBM 2023.
+# (C) Copyright IBM 2023, 2024.
 #
 # This code is part of Qiskit.
 #
@@ -13,13 +13,20 @@ from ._version import version as __version__  # noqa: F401
 from .py_qssc import __doc__  # noqa: F401
 
 from .compile import (  # noqa: F401
+    AsyncCompileServer,
+    BatchCompileResult,
+    compile_batch,
+    compile_bytes,
     compile_file,
     compile_file_async,
+    compile_module,
     compile_str,
     compile_str_async,
+    CompileServer,
     InputType,
     OutputType,
     CompileOptions,
+    CompileReport,
 )
 
 from .exceptions import (  # noqa: F401
@@ -34,6 +41,10 @@ from .py_qssc import (  # noqa: F401
 )
 
 from .link import (  # noqa: F401
+    ArgumentBinder,
+    link_batch,
+    link_batch_array,
     link_file,
+    Linker,
     LinkOptions,
 )
@@ -48,20 +48,64 @@ pass control to our backend function. We use multiprocessing's Pipe to
 pass input and output data to and from the compiling process. Process
 and Pipe take care of serializing python objects and passing them across
 process boundaries with pipes.
+
+
+Reusing compile processes
+-------------------------
+
+Starting a new process per compilation pays for interpreter start-up,
+loading of the compiler library and registration of dialects, passes and
+targets on every call. For workloads that compile many small programs the
+:class:`CompileServer` keeps a pool of warm compile processes alive instead.
+Each worker serves requests over the same pipe protocol used by the one-shot
+child process. A worker that dies (e.g., due to a crash while compiling
+malformed input) is restarted transparently, preserving crash isolation.
+
+The :class:`AsyncCompileServer` serves the same pool to asyncio code. It
+awaits the worker pipes through the event loop rather than in a thread per
+request, and so are the one-shot ``compile_*_async`` functions.
+
+
+Compiling in process
+--------------------
+
+With ``in_process`` the compilation runs in the calling process through
+``_compile_bytes_in_process``/``_compile_file_in_process``, which release
+the GIL while compiling and deliver the diagnostics once they hold it again.
+Python threads then compile concurrently without the cost of a process and
+of pickling, and the compilations with the same options share their parsed
+options and warm contexts. A crash of the compiler takes down the caller.
 """
 import asyncio
+import collections
+import copy
+import dataclasses
+import mmap
 import multiprocessing as mp
-from concurrent.futures import ThreadPoolExecutor
+import os
+import queue
+import threading
+import time
+from contextlib import contextmanager
 from dataclasses import dataclass, field
 from enum import Enum
 from importlib import resources as importlib_resources
-from multiprocessing import connection
+from multiprocessing import connection, reduction
 from os import environ as os_environ
 from pathlib import Path
-from typing import Any, Callable, List, Optional, Tuple, Union
+from typing import Any, Callable, Dict, List, Optional, Tuple, Union
 
 from . import exceptions
-from .py_qssc import _compile_bytes, _compile_file, Diagnostic
+from .py_qssc import (
+    _compile_batch,
+    _compile_bytes,
+    _compile_bytes_in_process,
+    _compile_file,
+    _compile_file_in_process,
+    Diagnostic,
+    ErrorCategory,
+    Severity,
+)
 
 # use the forkserver context to create a server process
 # for forking new compiler processes
@@ -125,6 +169,58 @@ class CompileOptions:
     This will result in an error.
     """
     extra_args: List[str] = field(default_factory=list)
+    """Optional file to write the compilation timers to as Chrome trace events.
+
+    Each event records the thread it ran on and the targets enclosing it, for
+    tools aggregating compile time breakdowns.
+    """
+    timing_trace_file: Union[Path, str, None] = None
+    """Optional time in seconds after which optional work is skipped.
+
+    Optimizations are skipped with a warning once the deadline passes, such that
+    the compilation finishes on time with a slightly worse output.
+    """
+    compile_deadline: Optional[float] = None
+    """Optional peak resident set size in MiB above which optional work is
+    skipped."""
+    memory_budget: Optional[int] = None
+    """Optional number of diagnostics with the same severity, category and message
+    delivered per compilation.
+
+    The repeats beyond it are summarized by a single diagnostic with their count
+    and sample locations.
+    """
+    diagnostic_repeat_limit: Optional[int] = None
+    """Optional number of warnings and remarks delivered per compilation, the others
+    are summarized by a single diagnostic. Errors are always delivered."""
+    max_diagnostics: Optional[int] = None
+    """Optional trace context ID of the caller, e.g. of a distributed trace.
+
+    It is attached to the timing trace and the compile report for correlation.
+    """
+    trace_context: Optional[str] = None
+    """Return a :class:`CompileReport` of the stage times and resource usage along
+    with the output, as an ``(output, report)`` tuple. Not supported by
+    :func:`compile_batch`.
+    """
+    return_report: bool = False
+    """Return the output as a read-only ``memoryview`` of the shared memory the
+    compile process wrote it to, rather than as ``bytes``.
+
+    This avoids copying large payloads out of the compiler and between the
+    processes. MLIR output is still returned as a string. Where shared memory
+    file descriptors are not available (``os.memfd_create``), the output is
+    transferred as before and returned as a ``memoryview`` of ``bytes``.
+    """
+    shared_output: bool = False
+    """Compile in the calling process rather than in a child process.
+
+    The compilation does not hold the GIL, such that threads of the caller compile
+    concurrently and share the warm state of the compiler, but a crash of the
+    compiler is not isolated from the caller. Not supported by :func:`compile_batch`
+    and the compile servers, which always compile in their processes.
+    """
+    in_process: bool = False
     """Optional callback for processing diagnostic messages from the compiler."""
     on_diagnostic: Optional[Callable[[Diagnostic], Any]] = None
 
@@ -148,21 +244,140 @@ class CompileOptions:
         if self.shot_delay:
             args.append(f"--shot-delay={self.shot_delay*1e6}us")
 
+        if self.timing_trace_file:
+            args.append(f"--timing-trace={stringify_path(self.timing_trace_file)}")
+
+        if self.compile_deadline:
+            deadline_ms = max(1, round(self.compile_deadline * 1e3))
+            args.append(f"--compile-deadline={deadline_ms}")
+
+        if self.memory_budget:
+            args.append(f"--memory-budget={self.memory_budget}")
+
+        if self.diagnostic_repeat_limit:
+            args.append(f"--diagnostic-repeat-limit={self.diagnostic_repeat_limit}")
+
+        if self.max_diagnostics:
+            args.append(f"--max-diagnostics={self.max_diagnostics}")
+
+        if self.trace_context:
+            args.append(f"--trace-context={self.trace_context}")
+
         args.extend(self.extra_args)
         return args
 
 
+@dataclass
+class CompileReport:
+    """Timing and resource report of a compilation or link.
+
+    Requested with ``return_report`` of :class:`CompileOptions` or :class:`LinkOptions`.
+    """
+
+    """The wall time in seconds of each stage, in the order the stages ran.
+
+    Compilations report ``queue_wait``, the time from the call until a compile
+    process started the compilation, and ``parse``, ``passes``, ``emit`` and
+    ``total``, the time compiling. The target compilation counts as ``passes``.
+    Links report ``bind`` and ``total``.
+    """
+    stages: Dict[str, float] = field(default_factory=dict)
+    """CPU time in seconds the compiling process spent on all its threads."""
+    user_cpu_seconds: float = 0.0
+    system_cpu_seconds: float = 0.0
+    """Peak resident set size of the compiling process in bytes.
+
+    Warm processes of a :class:`CompileServer` include earlier compilations.
+    """
+    peak_rss_bytes: int = 0
+    """The trace context ID of the options, if any."""
+    trace_context: Optional[str] = None
+
+    @classmethod
+    def _from_native(
+        cls, report: dict, queue_wait: Optional[float] = None, **kwargs
+    ) -> "CompileReport":
+        stages = {} if queue_wait is None else {"queue_wait": queue_wait}
+        stages.update(report["stages"])
+        fields = dict(report, stages=stages)
+        fields.update(kwargs)
+        return cls(**fields)
+
+
 @dataclass
 class _CompilerStatus:
     """Internal compiler result status dataclass."""
 
     success: bool
+    """Report of the compilation as returned by the bindings, if requested."""
+    report: Optional[dict] = None
+    """Wall clock time at which the compile process started the compilation."""
+    started: Optional[float] = None
+    """Whether the output follows as a shared memory file descriptor rather than bytes."""
+    shared_output: bool = False
+
+
+@dataclass
+class BatchCompileResult:
+    """Result of compiling a single input of :func:`compile_batch`."""
+
+    """Whether the input compiled without errors."""
+    success: bool
+    """The compiler output, decoded to a string for MLIR output."""
+    output: Union[bytes, str, None]
+    """Diagnostics emitted while compiling the input."""
+    diagnostics: List[Diagnostic] = field(default_factory=list)
+
+
+def _map_shared_output(fd: int) -> memoryview:
+    """Map the shared memory file descriptor fd read-only and close it."""
+    try:
+        size = os.fstat(fd).st_size
+        if size == 0:
+            # empty files cannot be mapped
+            return memoryview(b"")
+        # the mapping outlives the descriptor and is kept by the memoryview
+        return memoryview(mmap.mmap(fd, size, prot=mmap.PROT_READ))
+    finally:
+        os.close(fd)
+
+
+async def _wait_readable(fd: int) -> None:
+    """Wait until the file descriptor fd is readable without blocking the event loop."""
+    loop = asyncio.get_running_loop()
+    readable = loop.create_future()
+
+    def on_readable():
+        if not readable.done():
+            readable.set_result(None)
+
+    loop.add_reader(fd, on_readable)
+    try:
+        await readable
+    finally:
+        loop.remove_reader(fd)
 
 
 def stringify_path(p):
     return str(p) if isinstance(p, Path) else p
 
 
+@contextmanager
+def _resources_environment():
+    """Expose the compiler's static resources to the native backend.
+
+    The qss-compiler expects the path to static resources in the environment
+    variable QSSC_RESOURCES. In the python package, those resources are
+    bundled under the directory resources/. Since python's functions for
+    looking up resources only treat files as resources, use the generated
+    python source _version.py to look up the path to the python package.
+    """
+    with importlib_resources.path("qss_compiler", "_version.py") as version_py_path:
+        resources_path = version_py_path.parent / "resources"
+        os_environ["QSSC_RESOURCES"] = str(resources_path)
+        yield
+
+
 class _CompilationManager:
     """Manager class to call compiler bindings from unique python process.
 
@@ -173,51 +388,248 @@ class _CompilationManager:
     def __init__(self, compile_options: CompileOptions, return_diagnostics: bool):
         self.compile_options = compile_options
         self.return_diagnostics = return_diagnostics
+        # wall clock time at which the compilation was requested, the queue
+        # wait of the report runs from here until the compile process starts.
+        # The wall clock is shared by the processes, unlike the monotonic one.
+        self._submitted = time.time()
 
     def _compile_call(
+        self, args: List[str], on_diagnostic: Callable[[Diagnostic], Any], output_fd: int
+    ) -> Tuple[bool, bytes, Optional[dict]]:
+        """Implement for specific compilation pybind call.
+
+        The output is written to ``output_fd`` instead of returned if it is
+        not negative.
+        """
+        raise NotImplementedError("A subclass must provide an implementation")
+
+    def _compile_in_process_call(
         self, args: List[str], on_diagnostic: Callable[[Diagnostic], Any]
-    ) -> Tuple[bool, bytes]:
-        """Implement for specific compilation pybind call."""
+    ) -> Tuple[bool, bytes, Optional[dict]]:
+        """Implement for specific in-process compilation pybind call."""
         raise NotImplementedError("A subclass must provide an implementation")
 
+    def _compile_in_process(self) -> Union[bytes, str, None]:
+        """Compile in the calling process, see :attr:`CompileOptions.in_process`."""
+        options = self.compile_options
+        # when no callback was provided, collect diagnostics and return in case of error
+        diagnostics = []
+
+        def on_diagnostic(diag):
+            if options.on_diagnostic:
+                options.on_diagnostic(diag)
+            else:
+                diagnostics.append(diag)
+
+        started = time.time()
+        args = options.prepare_compiler_option_args()
+        with _resources_environment():
+            success, output, report = self._compile_in_process_call(args, on_diagnostic)
+
+        if report is not None:
+            report = CompileReport._from_native(report, max(0.0, started - self._submitted))
+        if options.output_file is not None or options.output_type is OutputType.NONE:
+            output = None
+        return self._finalize_output(success, output, diagnostics, report)
+
     def _compile_child_backend(
         self,
         on_diagnostic: Callable[[Diagnostic], Any],
-    ) -> Tuple[_CompilerStatus, Union[bytes, None]]:
+    ) -> Tuple[_CompilerStatus, Union[bytes, int, None]]:
+        """Compile and return the status and the output, if it is returned,
+        as bytes or as a shared memory file descriptor (see
+        :attr:`CompileOptions.shared_output`)."""
         # TODO: want a corresponding C++ interface to avoid overhead
 
+        started = time.time()
         options = self.compile_options
         args = options.prepare_compiler_option_args()
         output_as_return = False if options.output_file else True
+        output_returned = output_as_return and options.output_type is not OutputType.NONE
+
+        output_fd = -1
+        if output_returned and options.shared_output and hasattr(os, "memfd_create"):
+            output_fd = os.memfd_create("qss-compiler-output", os.MFD_CLOEXEC)
 
-        # The qss-compiler expects the path to static resources in the environment
-        # variable QSSC_RESOURCES. In the python package, those resources are
-        # bundled under the directory resources/. Since python's functions for
-        # looking up resources only treat files as resources, use the generated
-        # python source _version.py to look up the path to the python package.
-        with importlib_resources.path("qss_compiler", "_version.py") as version_py_path:
-            resources_path = version_py_path.parent / "resources"
-            os_environ["QSSC_RESOURCES"] = str(resources_path)
-            success, output = self._compile_call(args, on_diagnostic)
-
-        status = _CompilerStatus(success)
-        if output_as_return and options.output_type is not OutputType.NONE:
+        try:
+            with _resources_environment():
+                success, output, report = self._compile_call(args, on_diagnostic, output_fd)
+        except BaseException:
+            if output_fd >= 0:
+                os.close(output_fd)
+            raise
+
+        status = _CompilerStatus(success, report, started, shared_output=output_fd >= 0)
+        if output_fd >= 0:
+            return status, output_fd
+        if output_returned:
             return status, output
         else:
             return status, None
 
-    def _compile_child_runner(self, conn: connection.Connection) -> None:
-        conn.recv()
+    def _serve_request(self, conn: connection.Connection) -> None:
+        """Compile in the calling (child) process and send diagnostics, status
+        and output (if requested) over the pipe."""
 
         def on_diagnostic(diag):
             conn.send(diag)
 
         status, output = self._compile_child_backend(on_diagnostic)
         conn.send(status)
-        if output is not None:
+        if status.shared_output:
+            # pass the descriptor of the output, the caller maps it
+            try:
+                reduction.send_handle(conn, output, os.getppid())
+            finally:
+                os.close(output)
+        elif output is not None:
             conn.send_bytes(output)
 
+    def _compile_child_runner(self, conn: connection.Connection) -> None:
+        conn.recv()
+        self._serve_request(conn)
+
+    def _for_worker(self) -> "_CompilationManager":
+        """Return a copy of this manager that may be sent to a running worker.
+
+        Diagnostics are forwarded to the caller's callback by the parent
+        process, so the callback is not required (and might not be picklable)
+        in the worker.
+        """
+        request = copy.copy(self)
+        request.compile_options = dataclasses.replace(self.compile_options, on_diagnostic=None)
+        return request
+
+    def _receive_output(
+        self, conn: connection.Connection, kill_child: Callable[[], None]
+    ) -> Tuple[bool, Union[bytes, None], List[Diagnostic], Optional[CompileReport]]:
+        """Receive diagnostics, status, output and report (if requested) from
+        a compile process.
+
+        Args:
+            conn: Parent side of the pipe to the compile process.
+            kill_child: Terminates the compile process upon communication failure.
+        """
+        steps = self._receive_steps(conn, kill_child)
+        try:
+            while True:
+                next(steps)
+        except StopIteration as done:
+            return done.value
+
+    async def _receive_output_async(
+        self, conn: connection.Connection, kill_child: Callable[[], None]
+    ) -> Tuple[bool, Union[bytes, None], List[Diagnostic], Optional[CompileReport]]:
+        """Like :meth:`_receive_output`, but await each message of the compile
+        process through the event loop rather than blocking on the pipe."""
+        steps = self._receive_steps(conn, kill_child)
+        try:
+            while True:
+                next(steps)
+                if not conn.poll():
+                    await _wait_readable(conn.fileno())
+        except StopIteration as done:
+            return done.value
+
+    def _receive_steps(self, conn: connection.Connection, kill_child: Callable[[], None]):
+        """Generator implementing :meth:`_receive_output`, which yields before
+        each receive from conn such that the caller may wait for the message."""
+        success = False
+        shared_output = False
+        report = None
+        # when no callback was provided, collect diagnostics and return in case of error
+        diagnostics = []
+        try:
+            while True:
+                yield
+                received = conn.recv()
+
+                if isinstance(received, Diagnostic):
+                    if self.compile_options.on_diagnostic:
+                        self.compile_options.on_diagnostic(received)
+                    else:
+                        diagnostics.append(received)
+                elif isinstance(received, _CompilerStatus):
+                    success = received.success
+                    shared_output = received.shared_output
+                    if received.report is not None:
+                        report = CompileReport._from_native(
+                            received.report, max(0.0, received.started - self._submitted)
+                        )
+                    break
+                else:
+                    kill_child()
+                    raise exceptions.QSSCompilerCommunicationFailure(
+                        "The compile process delivered an unexpected object instead of status "
+                        "or diagnostic information. "
+                        "This points to inconsistencies in the Python "
+                        "interface code between the calling process and the compile process.",
+                        return_diagnostics=self.return_diagnostics,
+                    )
+
+            if (
+                self.compile_options.output_file is None
+                and self.compile_options.output_type is not OutputType.NONE
+            ):
+                # return compilation result via IPC instead of in a file.
+                yield
+                if shared_output:
+                    output = _map_shared_output(reduction.recv_handle(conn))
+                else:
+                    output = conn.recv_bytes()
+            else:
+                output = None
+        except EOFError:
+            # make sure that child process terminates
+            kill_child()
+            raise exceptions.QSSCompilerEOFFailure(
+                "Compile process exited before delivering output.",
+                diagnostics,
+                return_diagnostics=self.return_diagnostics,
+            )
+
+        return success, output, diagnostics, report
+
+    def _finalize_output(
+        self,
+        success: bool,
+        output: Union[bytes, None],
+        diagnostics: List[Diagnostic],
+        report: Optional[CompileReport] = None,
+    ) -> Union[bytes, str, None, Tuple[Union[bytes, str, None], CompileReport]]:
+        # Convert diagnostics to Python exceptions if necessary
+        exceptions.raise_diagnostics(diagnostics, return_diagnostics=self.return_diagnostics)
+
+        if not success:
+            raise exceptions.QSSCompilationFailure(
+                "Failure during compilation",
+                diagnostics,
+                return_diagnostics=self.return_diagnostics,
+            )
+
+        if self.compile_options.output_file is None:
+            # return compilation result
+            if self.compile_options.output_type == OutputType.MLIR:
+                output = str(output, "utf8")
+            elif self.compile_options.shared_output and isinstance(output, bytes):
+                output = memoryview(output)
+        if self.compile_options.return_report:
+            return output, report
+        return output
+
+    def _wrap_process_error(self, e: mp.ProcessError) -> exceptions.QSSCompilerError:
+        return exceptions.QSSCompilerError(
+            "It's likely that you've hit a bug in the QSS Compiler. Please "
+            "submit an issue to the team with relevant information "
+            "(https://github.com/Qiskit/qss-compiler/issues):\n"
+            f"{e}",
+            return_diagnostics=self.return_diagnostics,
+        )
+
     def compile(self) -> Union[bytes, str, None]:
+        if self.compile_options.in_process:
+            return self._compile_in_process()
+
         parent_side, child_side = mp_ctx.Pipe(duplex=True)
 
         try:
@@ -233,86 +645,103 @@ class _CompilationManager:
             # exits and closes its end of the pipe.
             child_side.close()
 
-            success = False
-            # when no callback was provided, collect diagnostics and return in case of error
-            diagnostics = []
-            try:
-                while True:
-                    received = parent_side.recv()
-
-                    if isinstance(received, Diagnostic):
-                        if self.compile_options.on_diagnostic:
-                            self.compile_options.on_diagnostic(received)
-                        else:
-                            diagnostics.append(received)
-                    elif isinstance(received, _CompilerStatus):
-                        success = received.success
-                        break
-                    else:
-                        childproc.kill()
-                        childproc.join()
-                        raise exceptions.QSSCompilerCommunicationFailure(
-                            "The compile process delivered an unexpected object instead of status "
-                            "or diagnostic information. "
-                            "This points to inconsistencies in the Python "
-                            "interface code between the calling process and the compile process.",
-                            return_diagnostics=self.return_diagnostics,
-                        )
-
-                if (
-                    self.compile_options.output_file is None
-                    and self.compile_options.output_type is not OutputType.NONE
-                ):
-                    # return compilation result via IPC instead of in a file.
-                    output = parent_side.recv_bytes()
-                else:
-                    output = None
-            except EOFError:
-                # make sure that child process terminates
+            def kill_child():
                 childproc.kill()
                 childproc.join()
-                raise exceptions.QSSCompilerEOFFailure(
-                    "Compile process exited before delivering output.",
-                    diagnostics,
-                    return_diagnostics=self.return_diagnostics,
-                )
+
+            success, output, diagnostics, report = self._receive_output(parent_side, kill_child)
 
             childproc.join()
-            if childproc.exitcode != 0:
-                raise exceptions.QSSCompilerNonZeroStatus(
-                    (
-                        "Compile process exited with non-zero status "
-                        + str(childproc.exitcode)
-                        + (" yet appears  still alive" if childproc.is_alive() else "")
-                    ),
-                    diagnostics,
-                    return_diagnostics=self.return_diagnostics,
-                )
+            self._check_exit_status(childproc, diagnostics)
+
+        except mp.ProcessError as e:
+            raise self._wrap_process_error(e)
 
-            # Convert diagnostics to Python exceptions if necessary
-            exceptions.raise_diagnostics(diagnostics, return_diagnostics=self.return_diagnostics)
+        return self._finalize_output(success, output, diagnostics, report)
 
-            if not success:
-                raise exceptions.QSSCompilationFailure(
-                    "Failure during compilation",
-                    diagnostics,
-                    return_diagnostics=self.return_diagnostics,
+    async def compile_async(self) -> Union[bytes, str, None]:
+        """Like :meth:`compile`, but await the compile process through the
+        event loop. Cancelling the call kills the compile process.
+
+        In process, the compilation runs on the default executor of the loop,
+        and a cancelled call does not stop it."""
+        if self.compile_options.in_process:
+            loop = asyncio.get_running_loop()
+            return await loop.run_in_executor(None, self._compile_in_process)
+
+        parent_side, child_side = mp_ctx.Pipe(duplex=True)
+
+        try:
+            childproc = mp_ctx.Process(target=self._compile_child_runner, args=(child_side,))
+            childproc.start()
+
+            parent_side.send(None)
+            # see compile
+            child_side.close()
+
+            def kill_child():
+                childproc.kill()
+                childproc.join()
+
+            try:
+                success, output, diagnostics, report = await self._receive_output_async(
+                    parent_side, kill_child
                 )
+                # the sentinel becomes readable once the process has exited
+                await _wait_readable(childproc.sentinel)
+            except asyncio.CancelledError:
+                kill_child()
+                raise
+
+            childproc.join()
+            self._check_exit_status(childproc, diagnostics)
 
         except mp.ProcessError as e:
-            raise exceptions.QSSCompilerError(
-                "It's likely that you've hit a bug in the QSS Compiler. Please "
-                "submit an issue to the team with relevant information "
-                "(https://github.com/Qiskit/qss-compiler/issues):\n"
-                f"{e}",
+            raise self._wrap_process_error(e)
+
+        return self._finalize_output(success, output, diagnostics, report)
+
+    def _check_exit_status(self, childproc: mp.Process, diagnostics: List[Diagnostic]) -> None:
+        if childproc.exitcode != 0:
+            raise exceptions.QSSCompilerNonZeroStatus(
+                (
+                    "Compile process exited with non-zero status "
+                    + str(childproc.exitcode)
+                    + (" yet appears  still alive" if childproc.is_alive() else "")
+                ),
+                diagnostics,
                 return_diagnostics=self.return_diagnostics,
             )
 
-        if self.compile_options.output_file is None:
-            # return compilation result
-            if self.compile_options.output_type == OutputType.MLIR:
-                return output.decode("utf8")
-            return output
+    def compile_with(self, worker: "_CompileWorker") -> Union[bytes, str, None]:
+        """Compile using a warm worker process of a :class:`CompileServer`."""
+        try:
+            worker.conn.send(self._for_worker())
+            success, output, diagnostics, report = self._receive_output(worker.conn, worker.kill)
+        except mp.ProcessError as e:
+            raise self._wrap_process_error(e)
+
+        return self._finalize_output(success, output, diagnostics, report)
+
+    async def compile_with_async(self, worker: "_CompileWorker") -> Union[bytes, str, None]:
+        """Compile using a warm worker process of an :class:`AsyncCompileServer`.
+
+        Cancelling the call kills the worker, which is still compiling the
+        request; the server restarts it before serving another request.
+        """
+        try:
+            worker.conn.send(self._for_worker())
+            try:
+                success, output, diagnostics, report = await self._receive_output_async(
+                    worker.conn, worker.kill
+                )
+            except asyncio.CancelledError:
+                worker.kill()
+                raise
+        except mp.ProcessError as e:
+            raise self._wrap_process_error(e)
+
+        return self._finalize_output(success, output, diagnostics, report)
 
 
 class _CompileFile(_CompilationManager):
@@ -321,13 +750,26 @@ class _CompileFile(_CompilationManager):
         self.input_file = stringify_path(input_file)
 
     def _compile_call(
-        self, args: List[str], on_diagnostic: Callable[[Diagnostic], Any]
-    ) -> Tuple[bool, bytes]:
+        self, args: List[str], on_diagnostic: Callable[[Diagnostic], Any], output_fd: int
+    ) -> Tuple[bool, bytes, Optional[dict]]:
         return _compile_file(
+            self.input_file,
+            stringify_path(self.compile_options.output_file),
+            output_fd,
+            args,
+            on_diagnostic,
+            self.compile_options.return_report,
+        )
+
+    def _compile_in_process_call(
+        self, args: List[str], on_diagnostic: Callable[[Diagnostic], Any]
+    ) -> Tuple[bool, bytes, Optional[dict]]:
+        return _compile_file_in_process(
             self.input_file,
             stringify_path(self.compile_options.output_file),
             args,
             on_diagnostic,
+            self.compile_options.return_report,
         )
 
 
@@ -339,18 +781,72 @@ class _CompileBytes(_CompilationManager):
         input: Union[str, bytes],
     ):
         super().__init__(compile_options, return_diagnostics)
-        self.input = input
+        # the bindings compile directly from the buffer of a bytes object
+        self.input = input.encode("utf8") if isinstance(input, str) else input
 
     def _compile_call(
-        self, args: List[str], on_diagnostic: Callable[[Diagnostic], Any]
-    ) -> Tuple[bool, bytes]:
+        self, args: List[str], on_diagnostic: Callable[[Diagnostic], Any], output_fd: int
+    ) -> Tuple[bool, bytes, Optional[dict]]:
         return _compile_bytes(
             self.input,
             stringify_path(self.compile_options.output_file),
+            output_fd,
             args,
             on_diagnostic,
+            self.compile_options.return_report,
         )
 
+    def _compile_in_process_call(
+        self, args: List[str], on_diagnostic: Callable[[Diagnostic], Any]
+    ) -> Tuple[bool, bytes, Optional[dict]]:
+        return _compile_bytes_in_process(
+            self.input,
+            stringify_path(self.compile_options.output_file),
+            args,
+            on_diagnostic,
+            self.compile_options.return_report,
+        )
+
+
+class _CompileModule(_CompilationManager):
+    """Compile a module built with the MLIR Python bindings in the calling
+    process, as the module lives in its context and cannot be sent to a
+    compile process without printing it."""
+
+    def __init__(self, compile_options: CompileOptions, return_diagnostics: bool, module):
+        super().__init__(compile_options, return_diagnostics)
+        self.module = module
+
+    def compile(self) -> Union[bytes, str, None]:
+        # imported lazily as it loads the MLIR Python bindings
+        from .mlir._mlir_libs._qeCompile import _compile_module
+
+        options = self.compile_options
+        if options.return_report:
+            raise ValueError("A report is not supported when compiling a module")
+
+        diagnostics = []
+
+        def on_diagnostic(severity: int, category: int, message: str):
+            diag = Diagnostic(Severity(severity), ErrorCategory(category), message)
+            if options.on_diagnostic:
+                options.on_diagnostic(diag)
+            else:
+                diagnostics.append(diag)
+
+        # the bindings add the tool name themselves
+        args = options.prepare_compiler_option_args()[1:]
+        with _resources_environment():
+            success, output = _compile_module(self.module, args, on_diagnostic)
+
+        if options.output_file is not None:
+            if success:
+                Path(stringify_path(options.output_file)).write_bytes(output)
+            output = None
+        elif options.output_type is OutputType.NONE:
+            output = None
+        return self._finalize_output(success, output, diagnostics)
+
 
 def _prepare_compile_options(
     compile_options: Optional[CompileOptions] = None, **kwargs
@@ -360,6 +856,420 @@ def _prepare_compile_options(
     return compile_options
 
 
+def _prepare_bytecode_options(
+    compile_options: Optional[CompileOptions] = None, **kwargs
+) -> CompileOptions:
+    if compile_options is None:
+        kwargs.setdefault("input_type", InputType.BYTECODE)
+        kwargs.setdefault("output_type", OutputType.BYTECODE)
+    return _prepare_compile_options(compile_options, **kwargs)
+
+
+class _CompileBatch(_CompilationManager):
+    def __init__(
+        self,
+        compile_options: CompileOptions,
+        return_diagnostics: bool,
+        inputs: List[Union[str, bytes]],
+    ):
+        super().__init__(compile_options, return_diagnostics)
+        self.inputs = [i.encode("utf8") if isinstance(i, str) else i for i in inputs]
+
+    def _serve_request(self, conn: connection.Connection) -> None:
+        args = self.compile_options.prepare_compiler_option_args()
+        with _resources_environment():
+            results = _compile_batch(self.inputs, args)
+        conn.send(results)
+
+    def _convert_results(self, received) -> List[BatchCompileResult]:
+        options = self.compile_options
+        results = []
+        for success, output, diagnostics in received:
+            if options.on_diagnostic:
+                for diag in diagnostics:
+                    options.on_diagnostic(diag)
+            if options.output_type is OutputType.NONE:
+                output = None
+            elif options.output_type == OutputType.MLIR:
+                output = output.decode("utf8")
+            results.append(BatchCompileResult(success, output, list(diagnostics)))
+        return results
+
+    def compile(self) -> List[BatchCompileResult]:
+        parent_side, child_side = mp_ctx.Pipe(duplex=True)
+
+        try:
+            childproc = mp_ctx.Process(target=self._compile_child_runner, args=(child_side,))
+            childproc.start()
+
+            parent_side.send(None)
+            # see _CompilationManager.compile
+            child_side.close()
+
+            try:
+                received = parent_side.recv()
+            except EOFError:
+                childproc.kill()
+                childproc.join()
+                raise exceptions.QSSCompilerEOFFailure(
+                    "Compile process exited before delivering output.",
+                    return_diagnostics=self.return_diagnostics,
+                )
+
+            childproc.join()
+            if not isinstance(received, list):
+                raise exceptions.QSSCompilerCommunicationFailure(
+                    "The compile process delivered an unexpected object instead of "
+                    "batch results.",
+                    return_diagnostics=self.return_diagnostics,
+                )
+        except mp.ProcessError as e:
+            raise self._wrap_process_error(e)
+
+        return self._convert_results(received)
+
+
+def _compile_worker_main(conn: connection.Connection) -> None:
+    """Entry point of a :class:`CompileServer` worker process.
+
+    Serves compile requests until the parent sends ``None`` or closes the pipe.
+    """
+    while True:
+        try:
+            request = conn.recv()
+        except EOFError:
+            return
+        if request is None:
+            return
+        request._serve_request(conn)
+
+
+class _CompileWorker:
+    """A warm compile process serving requests over a pipe."""
+
+    def __init__(self):
+        self._start()
+
+    def _start(self) -> None:
+        self.conn, child_side = mp_ctx.Pipe(duplex=True)
+        self.process = mp_ctx.Process(target=_compile_worker_main, args=(child_side,), daemon=True)
+        self.process.start()
+        # close the child's side in the parent so that receives are
+        # interrupted if the worker exits.
+        child_side.close()
+
+    def is_alive(self) -> bool:
+        return self.process.is_alive()
+
+    def kill(self) -> None:
+        self.process.kill()
+        self.process.join()
+        self.conn.close()
+
+    def restart(self) -> None:
+        if self.process.is_alive():
+            self.kill()
+        else:
+            self.process.join()
+            self.conn.close()
+        self._start()
+
+    def stop(self, timeout: Optional[float] = None) -> None:
+        if self.process.is_alive():
+            try:
+                self.conn.send(None)
+            except (BrokenPipeError, OSError):
+                pass
+            self.process.join(timeout)
+        if self.process.is_alive():
+            self.process.kill()
+            self.process.join()
+        self.conn.close()
+
+
+class CompileServer:
+    """Pool of warm, long-lived compile processes.
+
+    Compiling through a server avoids starting a new process for every
+    compilation. Workers keep the compiler library loaded along with its
+    registered dialects, passes and targets between requests. A worker
+    which dies while compiling is restarted before it is handed out again.
+
+    The server may be shared between threads; each request is served by one
+    idle worker and callers block until a worker becomes available. Asyncio
+    code should use :class:`AsyncCompileServer` instead.
+
+    Example::
+
+        with CompileServer(num_workers=4) as server:
+            payload = server.compile_str(program, target="mock", config_path=...)
+    """
+
+    def __init__(self, num_workers: int = 1):
+        if num_workers < 1:
+            raise ValueError("A compile server requires at least one worker.")
+        self._lock = threading.Lock()
+        self._closed = False
+        self._workers = [_CompileWorker() for _ in range(num_workers)]
+        self._idle = queue.Queue()
+        for worker in self._workers:
+            self._idle.put(worker)
+
+    @property
+    def num_workers(self) -> int:
+        return len(self._workers)
+
+    def _run(self, compilation_manager: _CompilationManager) -> Union[bytes, str, None]:
+        with self._lock:
+            if self._closed:
+                raise exceptions.QSSCompilerError(
+                    "The compile server has been closed.",
+                    return_diagnostics=compilation_manager.return_diagnostics,
+                )
+        worker = self._idle.get()
+        try:
+            if not worker.is_alive():
+                worker.restart()
+            return compilation_manager.compile_with(worker)
+        finally:
+            # restart dead workers eagerly so that the next request does not
+            # pay for the start-up.
+            if not worker.is_alive():
+                worker.restart()
+            self._idle.put(worker)
+
+    def compile_file(
+        self,
+        input_file: Union[Path, str],
+        return_diagnostics: bool = False,
+        compile_options: Optional[CompileOptions] = None,
+        **kwargs,
+    ) -> Union[bytes, str, None]:
+        """Compile a file using a worker of this server.
+
+        Accepts the same parameters as :func:`compile_file`.
+        """
+        compile_options = _prepare_compile_options(compile_options, **kwargs)
+        return self._run(_CompileFile(compile_options, return_diagnostics, input_file))
+
+    def compile_str(
+        self,
+        input: Union[str, bytes],
+        return_diagnostics: bool = False,
+        compile_options: Optional[CompileOptions] = None,
+        **kwargs,
+    ) -> Union[bytes, str, None]:
+        """Compile the given input program using a worker of this server.
+
+        Accepts the same parameters as :func:`compile_str`.
+        """
+        compile_options = _prepare_compile_options(compile_options, **kwargs)
+        return self._run(_CompileBytes(compile_options, return_diagnostics, input))
+
+    def compile_bytes(
+        self,
+        input: bytes,
+        return_diagnostics: bool = False,
+        compile_options: Optional[CompileOptions] = None,
+        **kwargs,
+    ) -> Union[bytes, str, None]:
+        """Compile MLIR bytecode using a worker of this server.
+
+        Accepts the same parameters as :func:`compile_bytes`.
+        """
+        compile_options = _prepare_bytecode_options(compile_options, **kwargs)
+        return self._run(_CompileBytes(compile_options, return_diagnostics, input))
+
+    async def compile_file_async(
+        self,
+        input_file: Union[Path, str],
+        return_diagnostics: bool = False,
+        compile_options: Optional[CompileOptions] = None,
+        **kwargs,
+    ) -> Union[bytes, str, None]:
+        """Async variant of :meth:`compile_file` which avoids blocking the event loop."""
+        compile_options = _prepare_compile_options(compile_options, **kwargs)
+        compilation_manager = _CompileFile(compile_options, return_diagnostics, input_file)
+        loop = asyncio.get_running_loop()
+        return await loop.run_in_executor(None, self._run, compilation_manager)
+
+    async def compile_str_async(
+        self,
+        input: Union[str, bytes],
+        return_diagnostics: bool = False,
+        compile_options: Optional[CompileOptions] = None,
+        **kwargs,
+    ) -> Union[bytes, str, None]:
+        """Async variant of :meth:`compile_str` which avoids blocking the event loop."""
+        compile_options = _prepare_compile_options(compile_options, **kwargs)
+        compilation_manager = _CompileBytes(compile_options, return_diagnostics, input)
+        loop = asyncio.get_running_loop()
+        return await loop.run_in_executor(None, self._run, compilation_manager)
+
+    def close(self, timeout: Optional[float] = None) -> None:
+        """Stop all workers. Outstanding requests are completed first."""
+        with self._lock:
+            if self._closed:
+                return
+            self._closed = True
+        for _ in self._workers:
+            self._idle.get().stop(timeout)
+
+    def __enter__(self) -> "CompileServer":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+
+class AsyncCompileServer:
+    """Pool of warm, long-lived compile processes for asyncio code.
+
+    Like :class:`CompileServer`, but requests are coroutines which await the
+    worker pipes through the event loop, so that many requests may be in
+    flight without a thread each. At most ``num_workers`` requests compile
+    concurrently, the others wait for an idle worker in the order they were
+    made. If ``max_pending`` is given and as many requests are already
+    waiting, further requests raise :class:`QSSCompileServerBusy` instead of
+    waiting, such that callers can apply backpressure. Cancelling a request
+    kills the worker compiling it, which is restarted for the next request.
+
+    The server must only be used from one event loop.
+
+    Example::
+
+        async with AsyncCompileServer(num_workers=4) as server:
+            payloads = await asyncio.gather(
+                *(server.compile_str(program, target="mock", config_path=...)
+                  for program in programs)
+            )
+    """
+
+    def __init__(self, num_workers: int = 1, max_pending: Optional[int] = None):
+        if num_workers < 1:
+            raise ValueError("A compile server requires at least one worker.")
+        if max_pending is not None and max_pending < 0:
+            raise ValueError("The number of pending requests may not be negative.")
+        self._max_pending = max_pending
+        self._closed = False
+        self._workers = [_CompileWorker() for _ in range(num_workers)]
+        self._idle = collections.deque(self._workers)
+        # futures of the requests waiting for a worker, in order of arrival
+        self._waiters = collections.deque()
+
+    @property
+    def num_workers(self) -> int:
+        return len(self._workers)
+
+    @property
+    def num_pending(self) -> int:
+        """Number of requests waiting for an idle worker."""
+        return sum(1 for waiter in self._waiters if not waiter.done())
+
+    async def _acquire(self, return_diagnostics: bool, limited: bool = True) -> _CompileWorker:
+        if self._idle:
+            return self._idle.popleft()
+        if limited and self._max_pending is not None and self.num_pending >= self._max_pending:
+            raise exceptions.QSSCompileServerBusy(
+                f"The compile server already has {self.num_pending} pending requests.",
+                return_diagnostics=return_diagnostics,
+            )
+        waiter = asyncio.get_running_loop().create_future()
+        self._waiters.append(waiter)
+        try:
+            return await waiter
+        except asyncio.CancelledError:
+            if waiter.done() and not waiter.cancelled():
+                # the worker was handed over as the request was cancelled
+                self._release(waiter.result())
+            elif waiter in self._waiters:
+                self._waiters.remove(waiter)
+            raise
+
+    def _release(self, worker: _CompileWorker) -> None:
+        while self._waiters:
+            waiter = self._waiters.popleft()
+            if not waiter.done():
+                waiter.set_result(worker)
+                return
+        self._idle.append(worker)
+
+    async def _run(self, compilation_manager: _CompilationManager) -> Union[bytes, str, None]:
+        if self._closed:
+            raise exceptions.QSSCompilerError(
+                "The compile server has been closed.",
+                return_diagnostics=compilation_manager.return_diagnostics,
+            )
+        worker = await self._acquire(compilation_manager.return_diagnostics)
+        try:
+            if not worker.is_alive():
+                worker.restart()
+            return await compilation_manager.compile_with_async(worker)
+        finally:
+            # restart dead or killed workers eagerly so that the next request
+            # does not pay for the start-up.
+            if not worker.is_alive():
+                worker.restart()
+            self._release(worker)
+
+    async def compile_file(
+        self,
+        input_file: Union[Path, str],
+        return_diagnostics: bool = False,
+        compile_options: Optional[CompileOptions] = None,
+        **kwargs,
+    ) -> Union[bytes, str, None]:
+        """Compile a file using a worker of this server.
+
+        Accepts the same parameters as :func:`compile_file`.
+        """
+        compile_options = _prepare_compile_options(compile_options, **kwargs)
+        return await self._run(_CompileFile(compile_options, return_diagnostics, input_file))
+
+    async def compile_str(
+        self,
+        input: Union[str, bytes],
+        return_diagnostics: bool = False,
+        compile_options: Optional[CompileOptions] = None,
+        **kwargs,
+    ) -> Union[bytes, str, None]:
+        """Compile the given input program using a worker of this server.
+
+        Accepts the same parameters as :func:`compile_str`.
+        """
+        compile_options = _prepare_compile_options(compile_options, **kwargs)
+        return await self._run(_CompileBytes(compile_options, return_diagnostics, input))
+
+    async def compile_bytes(
+        self,
+        input: bytes,
+        return_diagnostics: bool = False,
+        compile_options: Optional[CompileOptions] = None,
+        **kwargs,
+    ) -> Union[bytes, str, None]:
+        """Compile MLIR bytecode using a worker of this server.
+
+        Accepts the same parameters as :func:`compile_bytes`.
+        """
+        compile_options = _prepare_bytecode_options(compile_options, **kwargs)
+        return await self._run(_CompileBytes(compile_options, return_diagnostics, input))
+
+    async def close(self, timeout: Optional[float] = None) -> None:
+        """Stop all workers. Outstanding requests are completed first."""
+        if self._closed:
+            return
+        self._closed = True
+        for _ in self._workers:
+            worker = await self._acquire(return_diagnostics=False, limited=False)
+            worker.stop(timeout)
+
+    async def __aenter__(self) -> "AsyncCompileServer":
+        return self
+
+    async def __aexit__(self, *exc) -> None:
+        await self.close()
+
+
 def compile_file(
     input_file: Union[Path, str],
     return_diagnostics: bool = False,
@@ -381,12 +1291,44 @@ def compile_file(
 
     Returns: Produces output in a file (if parameter output_file is provided) or returns
         the compiler output as byte sequence or string, depending on the requested
-        output format.
+        output format. With ``return_report``, a tuple of the output and a
+        :class:`CompileReport`.
     """
     compile_options = _prepare_compile_options(compile_options, **kwargs)
     return _CompileFile(compile_options, return_diagnostics, input_file).compile()
 
 
+def compile_batch(
+    inputs: List[Union[str, bytes]],
+    return_diagnostics: bool = False,
+    compile_options: Optional[CompileOptions] = None,
+    **kwargs,
+) -> List[BatchCompileResult]:
+    """Compile many input programs sharing one compiler context and target.
+
+    All inputs are compiled with the same options. Building the target and
+    the target compilation pipelines is performed once for the whole batch
+    and inputs are parsed and optimized concurrently. This is significantly
+    faster than calling :func:`compile_str` for each input when compiling
+    many small programs.
+
+    Unlike :func:`compile_str` a failing input does not raise an exception;
+    its result is marked unsuccessful and carries the diagnostics of the
+    failure. ``output_file`` is ignored, the output of every input is returned.
+
+    Args:
+        inputs: inputs to compile as strings or bytes (e.q., OpenQASM3 programs).
+        return_diagnostics: diagnostics visibility flag for raised exceptions.
+        compile_options: Optional :class:`CompileOptions` dataclass.
+        kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
+            is provided directly.
+
+    Returns: One :class:`BatchCompileResult` per input, in order.
+    """
+    compile_options = _prepare_compile_options(compile_options, **kwargs)
+    return _CompileBatch(compile_options, return_diagnostics, inputs).compile()
+
+
 async def compile_file_async(
     input_file: Union[Path, str],
     return_diagnostics: bool = False,
@@ -407,14 +1349,12 @@ async def compile_file_async(
 
     Returns: Produces output in a file (if parameter output_file is provided) or returns
         the compiler output as byte sequence or string, depending on the requested
-        output format.
+        output format. With ``return_report``, a tuple of the output and a
+        :class:`CompileReport`.
 
     """
     compile_options = _prepare_compile_options(compile_options, **kwargs)
-    compilation_manager = _CompileFile(compile_options, return_diagnostics, input_file)
-    with ThreadPoolExecutor() as executor:
-        loop = asyncio.get_running_loop()
-        return await loop.run_in_executor(executor, compilation_manager.compile)
+    return await _CompileFile(compile_options, return_diagnostics, input_file).compile_async()
 
 
 def compile_str(
@@ -439,12 +1379,79 @@ def compile_str(
 
     Returns: Produces output in a file (if parameter output_file is provided) or returns
         the compiler output as byte sequence or string, depending on the requested
-        output format.
+        output format. With ``return_report``, a tuple of the output and a
+        :class:`CompileReport`.
     """
     compile_options = _prepare_compile_options(compile_options, **kwargs)
     return _CompileBytes(compile_options, return_diagnostics, input).compile()
 
 
+def compile_bytes(
+    input: bytes,
+    return_diagnostics: bool = False,
+    compile_options: Optional[CompileOptions] = None,
+    **kwargs,
+) -> Union[bytes, str, None]:
+    """Compile MLIR bytecode, e.g., the output of an earlier compilation with
+    ``output_type=OutputType.BYTECODE``.
+
+    Passing IR between compilations as bytecode rather than as textual MLIR
+    avoids printing and parsing it again. Unless given, the input and output
+    types default to :attr:`InputType.BYTECODE` and
+    :attr:`OutputType.BYTECODE` such that compilations can be chained.
+    Otherwise this function behaves like :func:`compile_str`.
+
+    Args:
+        input: MLIR bytecode to compile.
+        return_diagnostics: diagnostics visibility flag
+        compile_options: Optional :class:`CompileOptions` dataclass.
+        kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
+            is provided directly.
+
+    Returns: Produces output in a file (if parameter output_file is provided) or returns
+        the compiler output as byte sequence or string, depending on the requested
+        output format. With ``return_report``, a tuple of the output and a
+        :class:`CompileReport`.
+    """
+    compile_options = _prepare_bytecode_options(compile_options, **kwargs)
+    return _CompileBytes(compile_options, return_diagnostics, input).compile()
+
+
+def compile_module(
+    module,
+    return_diagnostics: bool = False,
+    compile_options: Optional[CompileOptions] = None,
+    **kwargs,
+) -> Union[bytes, str, None]:
+    """Compile a module built with the MLIR Python bindings of
+    :mod:`qss_compiler.mlir`, e.g., with the builders of the pulse dialect.
+
+    The module is handed to the compiler in memory rather than printed and
+    parsed again, which saves most of the time of compiling large generated
+    modules. It is compiled in place in the calling process, hence the module
+    holds the compiled IR afterwards. Unless given, the input type defaults
+    to :attr:`InputType.MLIR`; the output type must be MLIR or later.
+    Otherwise this function behaves like :func:`compile_str`, except that
+    ``return_report`` is not supported and including the source in the
+    payload fails as there is no source.
+
+    Args:
+        module: the ``qss_compiler.mlir.ir.Module`` to compile.
+        return_diagnostics: diagnostics visibility flag
+        compile_options: Optional :class:`CompileOptions` dataclass.
+        kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
+            is provided directly.
+
+    Returns: Produces output in a file (if parameter output_file is provided) or returns
+        the compiler output as byte sequence or string, depending on the requested
+        output format.
+    """
+    if compile_options is None:
+        kwargs.setdefault("input_type", InputType.MLIR)
+    compile_options = _prepare_compile_options(compile_options, **kwargs)
+    return _CompileModule(compile_options, return_diagnostics, module).compile()
+
+
 async def compile_str_async(
     input: Union[str, bytes],
     return_diagnostics: bool = False,
@@ -465,11 +1472,9 @@ async def compile_str_async(
 
     Returns: Produces output in a file (if parameter output_file is provided) or returns
         the compiler output as byte sequence or string, depending on the requested
-        output format.
+        output format. With ``return_report``, a tuple of the output and a
+        :class:`CompileReport`.
 
     """
     compile_options = _prepare_compile_options(compile_options, **kwargs)
-    compilation_manager = _CompileBytes(compile_options, return_diagnostics, input)
-    with ThreadPoolExecutor() as executor:
-        loop = asyncio.get_running_loop()
-        return await loop.run_in_executor(executor, compilation_manager.compile)
+    return await _CompileBytes(compile_options, return_diagnostics, input).compile_async()
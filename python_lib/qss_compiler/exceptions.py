@@ -68,6 +68,10 @@ class QSSCompilerNonZeroStatus(QSSCompilerError):
     """Raised when non-zero status is returned."""
 
 
+class QSSCompileServerBusy(QSSCompilerError):
+    """Raised when a compile server has reached its limit of pending requests."""
+
+
 class QSSCompilerSequenceTooLong(QSSCompilerError):
     """Raised when input sequence is too long."""
 
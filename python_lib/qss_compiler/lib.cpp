@@ -1,6 +1,6 @@
 //===- lib.cpp --------------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -55,26 +55,33 @@
 #include "errors.h"
 #include "lib_enums.h"
 
+#include "API/ContextPool.h"
 #include "API/api.h"
-#include "Dialect/RegisterDialects.h"
-#include "Dialect/RegisterPasses.h"
 
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <pybind11/cast.h>
+#include <pybind11/buffer_info.h>
 #include <pybind11/detail/common.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -101,33 +108,53 @@ std::vector<const char *> buildArgv(std::vector<std::string> &args) {
   return argv;
 }
 
-llvm::Expected<mlir::DialectRegistry> buildRegistry() {
-  // Register the standard passes with MLIR.
-  // Must precede the command line parsing.
-  if (auto err = qssc::dialect::registerPasses())
-    return std::move(err);
-
+llvm::Expected<mlir::DialectRegistry>
+buildRegistry(std::vector<const char *> &argv) {
   mlir::DialectRegistry registry;
-
-  // Add the following to include *all* QSS core dialects, or selectively
-  // include what you need like above. You only need to register dialects that
-  // will be *parsed* by the tool, not the one generated
-  qssc::dialect::registerDialects(registry);
+  if (auto err =
+          qssc::registerCommandLineTarget(argv.size(), argv.data(), registry))
+    return std::move(err);
   return std::move(registry);
 }
 
+/// Convert a report to a dict of the stage times, the resource usage and the
+/// trace context, or to None if there is none.
+py::object reportToPython(const std::optional<qssc::CompileReport> &report) {
+  if (!report)
+    return py::none();
+  py::dict stages;
+  for (const auto &[stage, seconds] : report->stages)
+    stages[py::str(stage)] = seconds;
+  py::dict result;
+  result["stages"] = stages;
+  result["user_cpu_seconds"] = report->userCPUSeconds;
+  result["system_cpu_seconds"] = report->systemCPUSeconds;
+  result["peak_rss_bytes"] = report->peakRSSBytes;
+  if (report->traceContext)
+    result["trace_context"] = *report->traceContext;
+  else
+    result["trace_context"] = py::none();
+  return std::move(result);
+}
+
 llvm::Error compile(llvm::raw_ostream &outputStream,
                     std::unique_ptr<llvm::MemoryBuffer> input,
                     std::vector<std::string> &args,
                     qssc::DiagnosticCallback onDiagnostic,
-                    llvm::StringRef outputPath = "-") {
+                    llvm::StringRef outputPath = "-",
+                    qssc::CompileReport *report = nullptr) {
 
   auto argv = buildArgv(args);
 
-  auto registry = buildRegistry();
+  auto registry = buildRegistry(argv);
   if (auto err = registry.takeError())
     return err;
 
+  // Compile processes may be reused for many compilations (see
+  // qss_compiler.CompileServer). Restore all options to their defaults so
+  // that values from a previous invocation do not leak into this one.
+  llvm::cl::ResetAllOptionOccurrences();
+
   /// TODO: We should not be performing argument parsing in the Python API.
   qssc::registerAndParseCLIOptions(argv.size(), argv.data(), "pyqssc\n",
                                    *registry);
@@ -148,78 +175,387 @@ llvm::Error compile(llvm::raw_ostream &outputStream,
   qssc::config::QSSConfig const config = configResult.get();
   buildConfigTiming.stop();
 
-  if (auto err = qssc::compileMain(outputStream, std::move(input), *registry,
-                                   config, std::move(onDiagnostic), timing))
+  if (auto err =
+          qssc::compileMain(outputStream, std::move(input), *registry, config,
+                            std::move(onDiagnostic), timing, report))
     return err;
 
   return llvm::Error::success();
 }
 
+/// Compile all inputs as a batch sharing one context and target.
+llvm::Expected<std::vector<qssc::BatchCompileResult>>
+compileBatch(const std::vector<std::string> &inputs,
+             std::vector<std::string> &args) {
+
+  auto argv = buildArgv(args);
+
+  auto registry = buildRegistry(argv);
+  if (auto err = registry.takeError())
+    return std::move(err);
+
+  // See compile
+  llvm::cl::ResetAllOptionOccurrences();
+
+  /// TODO: We should not be performing argument parsing in the Python API.
+  qssc::registerAndParseCLIOptions(argv.size(), argv.data(), "pyqssc\n",
+                                   *registry);
+
+  mlir::DefaultTimingManager tm;
+  mlir::applyDefaultTimingManagerCLOptions(tm);
+  mlir::TimingScope timing = tm.getRootScope();
+
+  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
+  auto configResult = qssc::config::buildToolConfig("-", "-");
+  if (auto err = configResult.takeError())
+    return std::move(err);
+  qssc::config::QSSConfig const config = configResult.get();
+  buildConfigTiming.stop();
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+  buffers.reserve(inputs.size());
+  // <stdin> is treated specially for diagnostic handling
+  // so assign buffer identifier.
+  for (const auto &input : inputs)
+    buffers.push_back(llvm::MemoryBuffer::getMemBuffer(input, "<stdin>"));
+
+  return qssc::compileBatch(std::move(buffers), *registry, config, timing);
+}
+
 py::tuple compileOptionalOutput(std::optional<std::string> outputFile,
+                                int outputFd,
                                 std::unique_ptr<llvm::MemoryBuffer> input,
                                 std::vector<std::string> &args,
-                                qssc::DiagnosticCallback onDiagnostic) {
+                                qssc::DiagnosticCallback onDiagnostic,
+                                bool withReport) {
   bool success = true;
+  std::optional<qssc::CompileReport> report;
+  if (withReport)
+    report.emplace();
+  qssc::CompileReport *reportPtr = report ? &*report : nullptr;
+
   if (outputFile.has_value()) {
     std::string errorMessage;
     auto output = mlir::openOutputFile(outputFile.value(), &errorMessage);
     if (!output) {
       llvm::errs() << "Failed to open output file: " << errorMessage;
-      return py::make_tuple(false, py::bytes(""));
+      return py::make_tuple(false, py::bytes(""), py::none());
     }
     if (auto err = compile(output->os(), std::move(input), args,
-                           std::move(onDiagnostic), outputFile.value()))
+                           std::move(onDiagnostic), outputFile.value(),
+                           reportPtr))
       success = false;
 
     if (success)
       output->keep();
 
-    return py::make_tuple(success, py::bytes(""));
+    return py::make_tuple(success, py::bytes(""), reportToPython(report));
+  }
+
+  if (outputFd >= 0) {
+    // Stream the output into the descriptor, e.g., of shared memory which the
+    // caller maps, rather than building it in memory and copying it to Python
+    // NOLINTNEXTLINE(misc-const-correctness)
+    llvm::raw_fd_ostream output(outputFd, /*shouldClose=*/false);
+    if (auto err = compile(output, std::move(input), args,
+                           std::move(onDiagnostic), "-", reportPtr))
+      success = false;
+    output.flush();
+    if (output.has_error()) {
+      llvm::errs() << "Failed to write output: " << output.error().message();
+      output.clear_error();
+      success = false;
+    }
+    return py::make_tuple(success, py::bytes(""), reportToPython(report));
   }
 
   std::string outputString;
   // NOLINTNEXTLINE(misc-const-correctness)
   llvm::raw_string_ostream output(outputString);
-  if (auto err =
-          compile(output, std::move(input), args, std::move(onDiagnostic)))
+  if (auto err = compile(output, std::move(input), args,
+                         std::move(onDiagnostic), "-", reportPtr))
     success = false;
 
-  return py::make_tuple(success, py::bytes(outputString));
+  return py::make_tuple(success, py::bytes(outputString),
+                        reportToPython(report));
+}
+
+/// The command line of the last in-process compilation and the contexts of
+/// the dialects registered for it, which the in-process compilations with the
+/// same command line share. As the options are global, another command line
+/// is parsed only once the compilations running with the last one are done.
+struct InProcessState {
+  std::shared_mutex mutex;
+  std::vector<std::string> args;
+  std::unique_ptr<qssc::ContextPool> pool;
+};
+
+llvm::ManagedStatic<InProcessState> inProcessState;
+
+/// Parse args unless they are the command line of the last in-process
+/// compilation, and return a lock on the state built from them which is
+/// shared with the other compilations using them.
+llvm::Expected<std::shared_lock<std::shared_mutex>>
+lockCommandLine(std::vector<std::string> &args) {
+  auto &state = *inProcessState;
+  std::shared_lock<std::shared_mutex> shared(state.mutex);
+  while (state.args != args) {
+    shared.unlock();
+    {
+      std::lock_guard<std::shared_mutex> const exclusive(state.mutex);
+      if (state.args != args) {
+        // a failure leaves the options half parsed, such that the next
+        // compilation parses its command line again
+        state.args.clear();
+        state.pool.reset();
+
+        auto argv = buildArgv(args);
+        auto registry = buildRegistry(argv);
+        if (auto err = registry.takeError())
+          return std::move(err);
+
+        // See compile
+        llvm::cl::ResetAllOptionOccurrences();
+        std::string parseErrors;
+        llvm::raw_string_ostream parseErrorStream(parseErrors);
+        if (!qssc::registerAndParseCLIOptions(argv.size(), argv.data(),
+                                              "pyqssc\n", *registry,
+                                              &parseErrorStream))
+          return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                         "Invalid compiler arguments: " +
+                                             parseErrorStream.str());
+
+        state.pool = std::make_unique<qssc::ContextPool>(*registry);
+        state.args = args;
+      }
+    }
+    shared.lock();
+  }
+  return std::move(shared);
+}
+
+/// The result of an in-process compilation, which is converted to Python
+/// once the GIL is held again.
+struct InProcessResult {
+  bool success = false;
+  std::string output;
+  std::optional<qssc::CompileReport> report;
+  std::vector<qssc::Diagnostic> diagnostics;
+};
+
+using InputOpener =
+    llvm::function_ref<llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>()>;
+
+/// Compile the input opened by openInput in the calling process, which must
+/// not hold the GIL. The output is written to outputFile if given and
+/// otherwise returned. The diagnostics are gathered rather than delivered.
+InProcessResult compileInProcess(InputOpener openInput,
+                                 const std::optional<std::string> &outputFile,
+                                 std::vector<std::string> &args,
+                                 bool withReport) {
+  InProcessResult result;
+  if (withReport)
+    result.report.emplace();
+  qssc::CompileReport *reportPtr = result.report ? &*result.report : nullptr;
+
+  // the target passes of the compilation may run on several threads
+  std::mutex diagnosticsMutex;
+  auto gatherDiagnostic = [&](const qssc::Diagnostic &diag) {
+    std::lock_guard<std::mutex> const lock(diagnosticsMutex);
+    result.diagnostics.push_back(diag);
+  };
+  auto fail = [&](llvm::Error err) {
+    gatherDiagnostic(qssc::Diagnostic(
+        qssc::Severity::Error, qssc::ErrorCategory::QSSCompilationFailure,
+        llvm::toString(std::move(err))));
+    return std::move(result);
+  };
+
+  auto lock = lockCommandLine(args);
+  if (!lock)
+    return fail(lock.takeError());
+  auto input = openInput();
+  if (!input)
+    return fail(input.takeError());
+
+  mlir::DefaultTimingManager tm;
+  mlir::applyDefaultTimingManagerCLOptions(tm);
+  mlir::TimingScope timing = tm.getRootScope();
+
+  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
+  llvm::StringRef inputPath = "-";
+  auto bufferIdentifier = (*input)->getBufferIdentifier();
+  if (bufferIdentifier != "<stdin>")
+    inputPath = bufferIdentifier;
+  auto config =
+      qssc::config::buildToolConfig(inputPath, outputFile.value_or("-"));
+  if (!config)
+    return fail(config.takeError());
+  buildConfigTiming.stop();
+
+  qssc::ContextPool &pool = *inProcessState->pool;
+  if (outputFile.has_value()) {
+    std::string errorMessage;
+    auto output = mlir::openOutputFile(outputFile.value(), &errorMessage);
+    if (!output)
+      return fail(llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                          "Failed to open output file: " +
+                                              errorMessage));
+    auto err = qssc::compileMain(output->os(), std::move(*input), pool,
+                                 *config, gatherDiagnostic, timing, reportPtr);
+    result.success = !err;
+    llvm::consumeError(std::move(err));
+    if (result.success)
+      output->keep();
+    return result;
+  }
+
+  llvm::raw_string_ostream output(result.output);
+  auto err = qssc::compileMain(output, std::move(*input), pool, *config,
+                               gatherDiagnostic, timing, reportPtr);
+  result.success = !err;
+  llvm::consumeError(std::move(err));
+  output.flush();
+  return result;
+}
+
+/// Compile without the GIL and deliver the diagnostics to onDiagnostic once
+/// it is held again. Returns a (success, output, report) tuple.
+py::tuple compileInProcessReleased(InputOpener openInput,
+                                   const std::optional<std::string> &outputFile,
+                                   std::vector<std::string> &args,
+                                   const qssc::DiagnosticCallback &onDiagnostic,
+                                   bool withReport) {
+  auto result = [&]() {
+    py::gil_scoped_release const release;
+    return compileInProcess(openInput, outputFile, args, withReport);
+  }();
+
+  for (const auto &diag : result.diagnostics)
+    onDiagnostic(diag);
+  return py::make_tuple(result.success, py::bytes(result.output),
+                        reportToPython(result.report));
 }
 
 } // anonymous namespace
 
-/// Call into the qss-compiler to compile input bytes
-py::tuple py_compile_bytes(const std::string &bytes,
+/// Call into the qss-compiler to compile input bytes. Returns a (success,
+/// output, report) tuple, with a report only if requested by withReport. The
+/// output is written to outputFile if given, else to the file descriptor
+/// outputFd if not negative, and else returned.
+py::tuple py_compile_bytes(const py::bytes &bytes,
                            const std::optional<std::string> &outputFile,
-                           std::vector<std::string> &args,
-                           qssc::DiagnosticCallback onDiagnostic) {
+                           int outputFd, std::vector<std::string> &args,
+                           qssc::DiagnosticCallback onDiagnostic,
+                           bool withReport) {
+
+  // Compile from the buffer of the bytes object rather than from a copy, the
+  // object is immutable and kept alive by the caller for the whole call
+  char *data;
+  ssize_t size;
+  if (PYBIND11_BYTES_AS_STRING_AND_SIZE(bytes.ptr(), &data, &size) != 0)
+    throw py::error_already_set();
 
   // Set up the input file.
   // <stdin> is treated specially for diagnostic handling
   // so assign buffer identifier.
-  std::unique_ptr<llvm::MemoryBuffer> input =
-      llvm::MemoryBuffer::getMemBuffer(bytes, "<stdin>");
+  std::unique_ptr<llvm::MemoryBuffer> input = llvm::MemoryBuffer::getMemBuffer(
+      llvm::StringRef(data, static_cast<size_t>(size)), "<stdin>");
 
-  return compileOptionalOutput(outputFile, std::move(input), args,
-                               std::move(onDiagnostic));
+  return compileOptionalOutput(outputFile, outputFd, std::move(input), args,
+                               std::move(onDiagnostic), withReport);
 }
 
-/// Call into the qss-compiler to compile input file
+/// Call into the qss-compiler to compile input file, see py_compile_bytes
 py::tuple py_compile_file(const std::string &inputFile,
                           const std::optional<std::string> &outputFile,
-                          std::vector<std::string> &args,
-                          qssc::DiagnosticCallback onDiagnostic) {
+                          int outputFd, std::vector<std::string> &args,
+                          qssc::DiagnosticCallback onDiagnostic,
+                          bool withReport) {
   // Set up the input file.
   std::string errorMessage;
   auto input = mlir::openInputFile(inputFile, &errorMessage);
   if (!input) {
     llvm::errs() << "Failed to open input file: " << errorMessage;
-    return py::make_tuple(false, py::bytes(""));
+    return py::make_tuple(false, py::bytes(""), py::none());
   }
 
-  return compileOptionalOutput(outputFile, std::move(input), args,
-                               std::move(onDiagnostic));
+  return compileOptionalOutput(outputFile, outputFd, std::move(input), args,
+                               std::move(onDiagnostic), withReport);
+}
+
+/// Compile input bytes in the calling process without holding the GIL, such
+/// that Python threads compile concurrently. The compilations with the same
+/// args share their parsed options and a pool of warm contexts. Returns a
+/// (success, output, report) tuple like py_compile_bytes.
+py::tuple py_compile_bytes_in_process(
+    const py::bytes &bytes, const std::optional<std::string> &outputFile,
+    std::vector<std::string> &args,
+    const qssc::DiagnosticCallback &onDiagnostic, bool withReport) {
+  // see py_compile_bytes, the bytes object is kept alive by the caller
+  char *data;
+  ssize_t size;
+  if (PYBIND11_BYTES_AS_STRING_AND_SIZE(bytes.ptr(), &data, &size) != 0)
+    throw py::error_already_set();
+  llvm::StringRef const input(data, static_cast<size_t>(size));
+
+  auto openInput = [input]() -> llvm::Expected<
+                                 std::unique_ptr<llvm::MemoryBuffer>> {
+    return llvm::MemoryBuffer::getMemBuffer(input, "<stdin>");
+  };
+  return compileInProcessReleased(openInput, outputFile, args, onDiagnostic,
+                                  withReport);
+}
+
+/// Compile input file in the calling process without holding the GIL, see
+/// py_compile_bytes_in_process
+py::tuple py_compile_file_in_process(
+    const std::string &inputFile, const std::optional<std::string> &outputFile,
+    std::vector<std::string> &args,
+    const qssc::DiagnosticCallback &onDiagnostic, bool withReport) {
+  auto openInput = [&inputFile]() -> llvm::Expected<
+                                      std::unique_ptr<llvm::MemoryBuffer>> {
+    std::string errorMessage;
+    auto input = mlir::openInputFile(inputFile, &errorMessage);
+    if (!input)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to open input file: " +
+                                         errorMessage);
+    return std::move(input);
+  };
+  return compileInProcessReleased(openInput, outputFile, args, onDiagnostic,
+                                  withReport);
+}
+
+/// Call into the qss-compiler to compile a batch of inputs sharing one context
+/// and target. Returns a list with a (success, output, diagnostics) tuple per
+/// input.
+py::list py_compile_batch(const std::vector<std::string> &inputs,
+                          std::vector<std::string> &args) {
+  py::list results;
+
+  auto batchResults = compileBatch(inputs, args);
+  if (auto err = batchResults.takeError()) {
+    // Setup of the shared state failed, report the error for every input.
+    auto message = llvm::toString(std::move(err));
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      py::list diagnostics;
+      diagnostics.append(qssc::Diagnostic(
+          qssc::Severity::Error, qssc::ErrorCategory::QSSCompilationFailure,
+          message));
+      results.append(py::make_tuple(false, py::bytes(""), diagnostics));
+    }
+    return results;
+  }
+
+  for (auto &result : *batchResults) {
+    py::list diagnostics;
+    for (auto &diag : result.diagnostics)
+      diagnostics.append(diag);
+    results.append(
+        py::make_tuple(result.success, py::bytes(result.output), diagnostics));
+  }
+  return results;
 }
 
 py::tuple py_link_file(const std::string &input, const bool enableInMemoryInput,
@@ -227,20 +563,171 @@ py::tuple py_link_file(const std::string &input, const bool enableInMemoryInput,
                        const std::string &configPath,
                        const std::unordered_map<std::string, double> &arguments,
                        bool treatWarningsAsErrors,
-                       qssc::DiagnosticCallback onDiagnostic) {
+                       qssc::DiagnosticCallback onDiagnostic,
+                       bool withReport) {
 
   std::string inMemoryOutput("");
+  std::optional<qssc::CompileReport> report;
+  if (withReport)
+    report.emplace();
 
   int const status = qssc::bindArguments(
       target, qssc::config::EmitAction::QEM, configPath, input, outputPath,
       arguments, treatWarningsAsErrors, enableInMemoryInput, &inMemoryOutput,
-      std::move(onDiagnostic));
+      std::move(onDiagnostic), report ? &*report : nullptr);
 
   bool const success = status == 0;
 #ifndef NDEBUG
   std::cerr << "Link " << (success ? "successful" : "failed") << '\n';
 #endif
-  return py::make_tuple(success, py::bytes(inMemoryOutput));
+  return py::make_tuple(success, py::bytes(inMemoryOutput),
+                        reportToPython(report));
+}
+
+py::tuple py_link_batch(
+    const std::string &input, const bool enableInMemoryInput,
+    const std::string &target, const std::string &configPath,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    bool treatWarningsAsErrors, qssc::DiagnosticCallback onDiagnostic) {
+
+  std::vector<std::string> outputs;
+
+  int const status = qssc::bindArgumentsBatch(
+      target, qssc::config::EmitAction::QEM, configPath, input, argumentSets,
+      treatWarningsAsErrors, enableInMemoryInput, &outputs,
+      std::move(onDiagnostic));
+
+  bool const success = status == 0;
+#ifndef NDEBUG
+  std::cerr << "Batch link " << (success ? "successful" : "failed") << '\n';
+#endif
+  py::list payloads;
+  if (success)
+    for (auto &output : outputs)
+      payloads.append(py::bytes(output));
+  return py::make_tuple(success, payloads);
+}
+
+py::tuple py_link_batch_array(const std::string &input,
+                              const bool enableInMemoryInput,
+                              const std::string &target,
+                              const std::string &configPath,
+                              const std::vector<std::string> &parameterNames,
+                              const py::buffer &values,
+                              bool treatWarningsAsErrors,
+                              qssc::DiagnosticCallback onDiagnostic) {
+
+  // bind straight from the memory of values, e.g., a numpy array, without
+  // converting it to dictionaries
+  py::buffer_info const info = values.request();
+  py::ssize_t const itemSize = sizeof(double);
+  if (info.format != py::format_descriptor<double>::format() ||
+      info.itemsize != itemSize)
+    throw py::type_error("argument values must be float64");
+  if (info.ndim == 2) {
+    if (static_cast<size_t>(info.shape[1]) != parameterNames.size())
+      throw py::value_error(
+          "argument values must have one column per parameter");
+    if (info.strides[1] != itemSize ||
+        info.strides[0] != info.shape[1] * info.strides[1])
+      throw py::value_error("argument values must be C contiguous");
+  } else if (info.ndim != 1 || info.strides[0] != itemSize) {
+    throw py::value_error("argument values must be a contiguous 1 or 2 "
+                          "dimensional array");
+  }
+
+  std::vector<std::string> outputs;
+
+  int const status = qssc::bindArgumentsBatch(
+      target, qssc::config::EmitAction::QEM, configPath, input, parameterNames,
+      llvm::ArrayRef<double>(static_cast<const double *>(info.ptr),
+                             static_cast<size_t>(info.size)),
+      treatWarningsAsErrors, enableInMemoryInput, &outputs,
+      std::move(onDiagnostic));
+
+  bool const success = status == 0;
+#ifndef NDEBUG
+  std::cerr << "Batch link " << (success ? "successful" : "failed") << '\n';
+#endif
+  py::list payloads;
+  if (success)
+    for (auto &output : outputs)
+      payloads.append(py::bytes(output));
+  return py::make_tuple(success, payloads);
+}
+
+py::tuple py_create_binder(const std::string &input,
+                           const bool enableInMemoryInput,
+                           const std::string &target,
+                           const std::string &configPath,
+                           bool treatWarningsAsErrors,
+                           qssc::DiagnosticCallback onDiagnostic) {
+
+  auto binder = qssc::ArgumentBinder::create(
+      target, qssc::config::EmitAction::QEM, configPath, input,
+      treatWarningsAsErrors, enableInMemoryInput, std::move(onDiagnostic));
+  if (auto err = binder.takeError()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return py::make_tuple(false, py::none());
+  }
+  return py::make_tuple(true, py::cast(std::move(*binder)));
+}
+
+py::tuple py_bind(qssc::ArgumentBinder &binder,
+                  const std::unordered_map<std::string, double> &arguments) {
+  std::string output;
+  if (auto err = binder.bind(arguments, &output)) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return py::make_tuple(false, py::bytes());
+  }
+  return py::make_tuple(true, py::bytes(output));
+}
+
+py::tuple py_create_linker(const std::string &input,
+                           const bool enableInMemoryInput,
+                           const std::string &target,
+                           const std::string &configPath,
+                           bool treatWarningsAsErrors,
+                           qssc::DiagnosticCallback onDiagnostic) {
+
+  auto linker = qssc::Linker::create(
+      target, qssc::config::EmitAction::QEM, configPath, input,
+      treatWarningsAsErrors, enableInMemoryInput, std::move(onDiagnostic));
+  if (auto err = linker.takeError()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return py::make_tuple(false, py::none());
+  }
+  return py::make_tuple(true, py::cast(std::move(*linker)));
+}
+
+/// Link every argument set without holding the GIL. The diagnostics are
+/// gathered and passed to onDiagnostic once the GIL is held again.
+py::tuple py_link_many(
+    qssc::Linker &linker,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    const qssc::DiagnosticCallback &onDiagnostic) {
+  std::vector<std::string> outputs;
+  std::vector<qssc::Diagnostic> diagnostics;
+  auto gatherDiagnostics = [&diagnostics](const qssc::Diagnostic &diag) {
+    diagnostics.push_back(diag);
+  };
+
+  auto err = [&]() {
+    py::gil_scoped_release const release;
+    return linker.linkMany(argumentSets, &outputs, gatherDiagnostics);
+  }();
+
+  for (const auto &diag : diagnostics)
+    onDiagnostic(diag);
+  if (err) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return py::make_tuple(false, py::list());
+  }
+
+  py::list payloads;
+  for (auto &output : outputs)
+    payloads.append(py::bytes(output));
+  return py::make_tuple(true, payloads);
 }
 
 // Pybind module
@@ -251,7 +738,32 @@ PYBIND11_MODULE(py_qssc, m) {
         "Call qss-compiler to compile input bytes");
   m.def("_compile_file", &py_compile_file,
         "Call qss-compiler to compile input file");
+  m.def("_compile_bytes_in_process", &py_compile_bytes_in_process,
+        "Compile input bytes in the calling process without the GIL");
+  m.def("_compile_file_in_process", &py_compile_file_in_process,
+        "Compile input file in the calling process without the GIL");
+  m.def("_compile_batch", &py_compile_batch,
+        "Call qss-compiler to compile a batch of inputs");
   m.def("_link_file", &py_link_file, "Call the linker tool");
+  m.def("_link_batch", &py_link_batch,
+        "Call the linker tool for several sets of arguments");
+  m.def("_link_batch_array", &py_link_batch_array,
+        "Call the linker tool for rows of an array of arguments");
+  m.def("_create_binder", &py_create_binder,
+        "Open a module for binding successive sets of arguments");
+  m.def("_create_linker", &py_create_linker,
+        "Open a module for linking many sets of arguments");
+
+  py::class_<qssc::ArgumentBinder>(m, "_ArgumentBinder")
+      .def("bind", &py_bind,
+           "Bind arguments, patching only the parameters that changed")
+      .def_property_readonly("num_patched",
+                             &qssc::ArgumentBinder::getNumPatched);
+
+  py::class_<qssc::Linker>(m, "_Linker")
+      .def("link_many", &py_link_many,
+           "Link every set of arguments, concurrently and without the GIL")
+      .def_property_readonly("num_binaries", &qssc::Linker::getNumBinaries);
 
   addErrorCategory(m);
   addSeverity(m);
@@ -62,6 +62,8 @@ void addSeverity(py::module &m) {
 
 void addDiagnostic(py::module &m) {
   py::class_<qssc::Diagnostic>(m, "Diagnostic")
+      .def(py::init<qssc::Severity, qssc::ErrorCategory, std::string>(),
+           py::arg("severity"), py::arg("category"), py::arg("message"))
       .def_readonly("severity", &qssc::Diagnostic::severity)
       .def_readonly("category", &qssc::Diagnostic::category)
       .def_readonly("message", &qssc::Diagnostic::message)
@@ -1,4 +1,4 @@
-# (C) Copyright IBM 2023.
+# (C) Copyright IBM 2023, 2024.
 #
 # This code is part of Qiskit.
 #
@@ -19,14 +19,21 @@ package.
 
 """
 
+import array
 from dataclasses import dataclass, field
-from importlib import resources as importlib_resources
-from os import environ as os_environ
-from typing import Mapping, Any, Optional, Callable, Union
+from typing import Mapping, Any, Optional, Callable, List, Sequence, Tuple, Union
 import warnings
 
-from .py_qssc import _link_file, Diagnostic, ErrorCategory
-from .compile import stringify_path
+from .py_qssc import (
+    _create_binder,
+    _create_linker,
+    _link_batch,
+    _link_batch_array,
+    _link_file,
+    Diagnostic,
+    ErrorCategory,
+)
+from .compile import _resources_environment, CompileReport, stringify_path
 
 from . import exceptions
 
@@ -51,6 +58,11 @@ class LinkOptions:
     """Target configuration path."""
     treat_warnings_as_errors: bool = True
     """Treat link warnings as errors"""
+    trace_context: Optional[str] = None
+    """Optional trace context ID of the caller, recorded in the link report."""
+    return_report: bool = False
+    """Return a :class:`CompileReport` of :func:`link_file` along with the
+    output, as an ``(output, report)`` tuple."""
     on_diagnostic: Optional[Callable[[Diagnostic], Any]] = None
     """Optional callback for processing diagnostic messages from the linker."""
 
@@ -61,10 +73,64 @@ def _prepare_link_options(link_options: Optional[LinkOptions] = None, **kwargs)
     return link_options
 
 
+def _normalize_arguments(arguments: Mapping[str, Any]) -> Mapping[str, Any]:
+    for key, value in arguments.items():
+        if not isinstance(value, float):
+            if isinstance(value, int):
+                arguments[key] = float(value)
+            else:
+                raise exceptions.QSSArgumentInputTypeError(
+                    f"Only int & double arguments are supported, not {type(value)}"
+                )
+    return arguments
+
+
+def _prepare_link_input(link_options: LinkOptions) -> Tuple[str, bool]:
+    input_file = stringify_path(link_options.input_file)
+
+    if link_options.input_file is not None and link_options.input_bytes is not None:
+        raise ValueError("only one of input_file or input_bytes should have a value")
+
+    enable_in_memory = link_options.input_bytes is not None
+    if enable_in_memory:
+        input_file = link_options.input_bytes
+    return input_file, enable_in_memory
+
+
+def _handle_link_diagnostics(success: bool, diagnostics: List[Diagnostic]):
+    if not success:
+        exception_mapping = {
+            ErrorCategory.QSSLinkerNotImplemented: exceptions.QSSLinkerNotImplemented,
+            ErrorCategory.QSSLinkSignatureWarning: exceptions.QSSLinkSignatureWarning,
+            ErrorCategory.QSSLinkSignatureError: exceptions.QSSLinkSignatureError,
+            ErrorCategory.QSSLinkAddressError: exceptions.QSSLinkAddressError,
+            ErrorCategory.QSSLinkSignatureNotFound: exceptions.QSSLinkSignatureNotFound,
+            ErrorCategory.QSSLinkArgumentNotFoundWarning: exceptions.QSSLinkArgumentNotFoundWarning,  # noqa
+            ErrorCategory.QSSLinkInvalidPatchTypeError: exceptions.QSSLinkInvalidPatchTypeError,
+        }
+
+        if diagnostics == [] or not isinstance(diagnostics[0], Diagnostic):
+            pass
+        elif diagnostics[0].category in exception_mapping.keys():
+            raise exception_mapping[diagnostics[0].category](diagnostics[0].message, diagnostics)
+        raise exceptions.QSSLinkingFailure("Unknown linking failure", diagnostics)
+    else:
+        warning_mapping = {
+            ErrorCategory.QSSLinkSignatureWarning: exceptions.QSSLinkSignatureWarning,
+            ErrorCategory.QSSLinkArgumentNotFoundWarning: exceptions.QSSLinkArgumentNotFoundWarning,  # noqa
+        }
+        if diagnostics == [] or not isinstance(diagnostics[0], Diagnostic):
+            pass
+        else:
+            for diagnostic in diagnostics:
+                if diagnostic.category in warning_mapping.keys():
+                    warnings.warn(diagnostic.message, warning_mapping[diagnostic.category])
+
+
 def link_file(
     link_options: Optional[LinkOptions] = None,
     **kwargs,
-) -> Optional[bytes]:
+) -> Union[bytes, None, Tuple[Optional[bytes], CompileReport]]:
     """Link a module and bind arguments to create a payload.
 
     Consume a circuit module in a file and binds the provided circuit
@@ -77,11 +143,11 @@ def link_file(
             with the target that created the module).
         arguments: Circuit arguments as name/value map.
 
-    Returns: Produces a payload in a file.
+    Returns: Produces a payload in a file. With ``return_report``, a tuple of
+        the output and a :class:`CompileReport`.
     """
     link_options = _prepare_link_options(link_options, **kwargs)
 
-    input_file = stringify_path(link_options.input_file)
     output_file = stringify_path(link_options.output_file)
     config_path = stringify_path(link_options.config_path)
 
@@ -93,21 +159,9 @@ def link_file(
     if link_options.on_diagnostic is None:
         link_options.on_diagnostic = on_diagnostic
 
-    for key, value in link_options.arguments.items():
-        if not isinstance(value, float):
-            if isinstance(value, int):
-                link_options.arguments[key] = float(value)
-            else:
-                raise exceptions.QSSArgumentInputTypeError(
-                    f"Only int & double arguments are supported, not {type(value)}"
-                )
-
-    if link_options.input_file is not None and link_options.input_bytes is not None:
-        raise ValueError("only one of input_file or input_bytes should have a value")
+    _normalize_arguments(link_options.arguments)
 
-    enable_in_memory = link_options.input_bytes is not None
-    if enable_in_memory:
-        input_file = link_options.input_bytes
+    input_file, enable_in_memory = _prepare_link_input(link_options)
 
     if output_file is None:
         output_file = ""
@@ -115,16 +169,8 @@ def link_file(
     # keep in mind that most of the infrastructure in the compile paths is for
     # taking care of the execution in a separate process. For the linker tool,
     # we aim at avoiding that right from the start!
-
-    # The qss-compiler expects the path to static resources in the environment
-    # variable QSSC_RESOURCES. In the python package, those resources are
-    # bundled under the directory resources/. Since python's functions for
-    # looking up resources only treat files as resources, use the generated
-    # python source _version.py to look up the path to the python package.
-    with importlib_resources.path("qss_compiler", "_version.py") as version_py_path:
-        resources_path = version_py_path.parent / "resources"
-        os_environ["QSSC_RESOURCES"] = str(resources_path)
-        success, output = _link_file(
+    with _resources_environment():
+        success, output, report = _link_file(
             input_file,
             enable_in_memory,
             output_file,
@@ -133,37 +179,244 @@ def link_file(
             link_options.arguments,
             link_options.treat_warnings_as_errors,
             link_options.on_diagnostic,
+            link_options.return_report,
         )
-        if not success:
-            exception_mapping = {
-                ErrorCategory.QSSLinkerNotImplemented: exceptions.QSSLinkerNotImplemented,
-                ErrorCategory.QSSLinkSignatureWarning: exceptions.QSSLinkSignatureWarning,
-                ErrorCategory.QSSLinkSignatureError: exceptions.QSSLinkSignatureError,
-                ErrorCategory.QSSLinkAddressError: exceptions.QSSLinkAddressError,
-                ErrorCategory.QSSLinkSignatureNotFound: exceptions.QSSLinkSignatureNotFound,
-                ErrorCategory.QSSLinkArgumentNotFoundWarning: exceptions.QSSLinkArgumentNotFoundWarning,  # noqa
-                ErrorCategory.QSSLinkInvalidPatchTypeError: exceptions.QSSLinkInvalidPatchTypeError,
-            }
-
-            if diagnostics == [] or not isinstance(diagnostics[0], Diagnostic):
-                pass
-            elif diagnostics[0].category in exception_mapping.keys():
-                raise exception_mapping[diagnostics[0].category](
-                    diagnostics[0].message, diagnostics
-                )
-            raise exceptions.QSSLinkingFailure("Unknown linking failure", diagnostics)
-        else:
-            warning_mapping = {
-                ErrorCategory.QSSLinkSignatureWarning: exceptions.QSSLinkSignatureWarning,
-                ErrorCategory.QSSLinkArgumentNotFoundWarning: exceptions.QSSLinkArgumentNotFoundWarning,  # noqa
-            }
-            if diagnostics == [] or not isinstance(diagnostics[0], Diagnostic):
-                pass
-            else:
-                for diagnostic in diagnostics:
-                    if diagnostic.category in warning_mapping.keys():
-                        warnings.warn(diagnostic.message, warning_mapping[diagnostic.category])
+        _handle_link_diagnostics(success, diagnostics)
 
         # return in-memory raw bytes if output file is not specified
-        if link_options.output_file is None:
+        if link_options.output_file is not None:
+            output = None
+        if link_options.return_report:
+            return output, CompileReport._from_native(
+                report, trace_context=link_options.trace_context
+            )
+        return output
+
+
+def link_batch(
+    argument_sets: Sequence[Mapping[str, Any]],
+    link_options: Optional[LinkOptions] = None,
+    **kwargs,
+) -> List[bytes]:
+    """Link a module once and bind several sets of arguments to it.
+
+    The module and its signature are loaded a single time and one payload is
+    produced per set of arguments, which is much faster than calling
+    link_file for each set.
+
+    Args:
+        argument_sets: Circuit arguments as name/value maps, one per payload.
+        input_file: Path to the circuit module to link.
+        input_bytes: The circuit module as raw bytes.
+        target: Compiler target to invoke for binding arguments (must match
+            with the target that created the module).
+
+    Returns: The payloads as raw bytes in the order of argument_sets. The
+        output_file and arguments options are ignored.
+    """
+    link_options = _prepare_link_options(link_options, **kwargs)
+
+    config_path = stringify_path(link_options.config_path)
+
+    diagnostics = []
+
+    def on_diagnostic(diag):
+        diagnostics.append(diag)
+
+    if link_options.on_diagnostic is None:
+        link_options.on_diagnostic = on_diagnostic
+
+    argument_sets = [_normalize_arguments(dict(arguments)) for arguments in argument_sets]
+
+    input_file, enable_in_memory = _prepare_link_input(link_options)
+
+    with _resources_environment():
+        success, outputs = _link_batch(
+            input_file,
+            enable_in_memory,
+            link_options.target,
+            config_path,
+            argument_sets,
+            link_options.treat_warnings_as_errors,
+            link_options.on_diagnostic,
+        )
+        _handle_link_diagnostics(success, diagnostics)
+        return list(outputs)
+
+
+def link_batch_array(
+    parameter_names: Sequence[str],
+    values: Any,
+    link_options: Optional[LinkOptions] = None,
+    **kwargs,
+) -> List[bytes]:
+    """Link a module once and bind each row of an array of arguments to it.
+
+    Like link_batch, but the arguments are taken directly from the memory of
+    values rather than from name/value maps, which avoids converting large
+    parameter sweeps to dictionaries.
+
+    Args:
+        parameter_names: The names of the parameters, one per column of values.
+        values: The argument values with one row per payload and one column
+            per parameter, preferably as a C contiguous float64 buffer such as
+            a numpy array of shape (num_payloads, len(parameter_names)). Other
+            sequences of rows are copied to such a buffer first.
+        input_file: Path to the circuit module to link.
+        input_bytes: The circuit module as raw bytes.
+        target: Compiler target to invoke for binding arguments (must match
+            with the target that created the module).
+
+    Returns: The payloads as raw bytes in the order of the rows of values. The
+        output_file and arguments options are ignored.
+    """
+    link_options = _prepare_link_options(link_options, **kwargs)
+
+    config_path = stringify_path(link_options.config_path)
+
+    try:
+        view = memoryview(values)
+    except TypeError:
+        view = None
+    if view is None or view.format != "d" or not view.c_contiguous:
+        values = array.array("d", (float(value) for row in values for value in row))
+
+    diagnostics = []
+
+    def on_diagnostic(diag):
+        diagnostics.append(diag)
+
+    if link_options.on_diagnostic is None:
+        link_options.on_diagnostic = on_diagnostic
+
+    input_file, enable_in_memory = _prepare_link_input(link_options)
+
+    with _resources_environment():
+        success, outputs = _link_batch_array(
+            input_file,
+            enable_in_memory,
+            link_options.target,
+            config_path,
+            list(parameter_names),
+            values,
+            link_options.treat_warnings_as_errors,
+            link_options.on_diagnostic,
+        )
+        _handle_link_diagnostics(success, diagnostics)
+        return list(outputs)
+
+
+class ArgumentBinder:
+    """Bind successive sets of arguments to a module which is kept open.
+
+    The module and its signature are loaded once and each call to bind only
+    patches the parameters whose values changed since the previous call,
+    e.g., in optimization loops where few of many parameters change per
+    iteration. Parameters not passed to bind keep their previous values.
+
+    Args:
+        input_file: Path to the circuit module to link.
+        input_bytes: The circuit module as raw bytes.
+        target: Compiler target to invoke for binding arguments (must match
+            with the target that created the module).
+    """
+
+    def __init__(self, link_options: Optional[LinkOptions] = None, **kwargs):
+        link_options = _prepare_link_options(link_options, **kwargs)
+
+        config_path = stringify_path(link_options.config_path)
+
+        self._diagnostics = []
+
+        def on_diagnostic(diag):
+            self._diagnostics.append(diag)
+
+        if link_options.on_diagnostic is None:
+            link_options.on_diagnostic = on_diagnostic
+
+        input_file, enable_in_memory = _prepare_link_input(link_options)
+
+        with _resources_environment():
+            success, self._binder = _create_binder(
+                input_file,
+                enable_in_memory,
+                link_options.target,
+                config_path,
+                link_options.treat_warnings_as_errors,
+                link_options.on_diagnostic,
+            )
+            _handle_link_diagnostics(success, self._diagnostics)
+
+    def bind(self, arguments: Mapping[str, Any]) -> bytes:
+        """Bind arguments and return the payload as raw bytes."""
+        arguments = _normalize_arguments(dict(arguments))
+
+        self._diagnostics.clear()
+        with _resources_environment():
+            success, output = self._binder.bind(arguments)
+            _handle_link_diagnostics(success, self._diagnostics)
             return output
+
+    @property
+    def num_patched(self) -> int:
+        """The number of patch points patched by the last call to bind."""
+        return self._binder.num_patched
+
+
+class Linker:
+    """Link many sets of arguments to a module which is kept open.
+
+    The module is opened and its signature parsed once, when the linker is
+    created. Each call to link_many binds its argument sets concurrently on
+    the compiler's thread pool, without holding the GIL, such that other
+    Python threads keep running meanwhile.
+
+    Args:
+        input_file: Path to the circuit module to link.
+        input_bytes: The circuit module as raw bytes.
+        target: Compiler target to invoke for binding arguments (must match
+            with the target that created the module).
+    """
+
+    def __init__(self, link_options: Optional[LinkOptions] = None, **kwargs):
+        link_options = _prepare_link_options(link_options, **kwargs)
+
+        config_path = stringify_path(link_options.config_path)
+
+        self._diagnostics = []
+
+        def on_diagnostic(diag):
+            self._diagnostics.append(diag)
+
+        if link_options.on_diagnostic is None:
+            link_options.on_diagnostic = on_diagnostic
+        self._on_diagnostic = link_options.on_diagnostic
+
+        input_file, enable_in_memory = _prepare_link_input(link_options)
+
+        with _resources_environment():
+            success, self._linker = _create_linker(
+                input_file,
+                enable_in_memory,
+                link_options.target,
+                config_path,
+                link_options.treat_warnings_as_errors,
+                link_options.on_diagnostic,
+            )
+            _handle_link_diagnostics(success, self._diagnostics)
+
+    def link_many(self, argument_sets: Sequence[Mapping[str, Any]]) -> List[bytes]:
+        """Bind each set of arguments and return the payloads as raw bytes, in
+        the order of argument_sets."""
+        argument_sets = [_normalize_arguments(dict(arguments)) for arguments in argument_sets]
+
+        self._diagnostics.clear()
+        with _resources_environment():
+            success, outputs = self._linker.link_many(argument_sets, self._on_diagnostic)
+            _handle_link_diagnostics(success, self._diagnostics)
+            return list(outputs)
+
+    @property
+    def num_binaries(self) -> int:
+        """The number of binaries patched per set of arguments."""
+        return self._linker.num_binaries
@@ -133,6 +133,24 @@ class SequenceOp:
         return
 
 
+def _as_samples_2d(samples):
+    """Return samples as an (n, 2) array of float64 real and imaginary parts.
+
+    numpy arrays are passed to DenseElementsAttr through the buffer protocol
+    without converting any element. Complex samples are reinterpreted as
+    pairs of floats and nested lists are converted by numpy in one step.
+    """
+    import numpy as np
+
+    array = np.asarray(samples)
+    if np.iscomplexobj(array):
+        array = np.ascontiguousarray(array, dtype=np.complex128)
+        return array.reshape(-1).view(np.float64).reshape(-1, 2)
+    return np.ascontiguousarray(array, dtype=np.float64)
+
+
 class Waveform_CreateOp:
     def __init__(self, samples_2d, *, loc=None, ip=None):
-        super().__init__(DenseElementsAttr.get(samples_2d), loc=loc, ip=ip)
+        if not isinstance(samples_2d, DenseElementsAttr):
+            samples_2d = DenseElementsAttr.get(_as_samples_2d(samples_2d))
+        super().__init__(samples_2d, loc=loc, ip=ip)
@@ -16,3 +16,58 @@
 
 from ._pulse_ops_gen import *  # noqa: F403, F401
 from .._mlir_libs._qeDialectsPulse import *  # noqa: F403, F401
+from .._mlir_libs._qeDialectsPulse import _insert_delay_ops, _insert_play_ops
+from ..ir import InsertionPoint
+
+
+def _insertion_args(ip):
+    """Locate the block of the insertion point ip for the bulk builders."""
+    if ip is None:
+        ip = InsertionPoint.current
+    block = ip.block
+    owner = block.owner.operation
+    for region_index, region in enumerate(owner.regions):
+        for block_index, candidate in enumerate(region.blocks):
+            if candidate == block:
+                ref = ip.ref_operation
+                insert_before = ref.operation if ref is not None else None
+                return owner, region_index, block_index, insert_before
+    raise ValueError("the insertion point is not in a block of its owner")
+
+
+def build_play_ops(
+    frames, waveforms, frame_indices, waveform_indices, *, timepoints=None, loc=None, ip=None
+):
+    """Insert a pulse.play op for every element of frame_indices in one call.
+
+    The i-th op plays waveforms[waveform_indices[i]] on frames[frame_indices[i]].
+    The indices and the optional timepoints, which set the pulse.timepoint of
+    each op, may be numpy arrays or sequences of integers. As no Python object
+    is created per op, the ops are not returned.
+    """
+    _insert_play_ops(
+        *_insertion_args(ip),
+        list(frames),
+        list(waveforms),
+        frame_indices,
+        waveform_indices,
+        timepoints=timepoints,
+        loc=loc,
+    )
+
+
+def build_delay_ops(frames, frame_indices, durations, *, timepoints=None, loc=None, ip=None):
+    """Insert a pulse.delay op for every element of frame_indices in one call.
+
+    The i-th op delays frames[frame_indices[i]] by durations[i]. A single i32
+    constant is created per distinct duration ahead of the delays. The arrays
+    are as for build_play_ops.
+    """
+    _insert_delay_ops(
+        *_insertion_args(ip),
+        list(frames),
+        frame_indices,
+        durations,
+        timepoints=timepoints,
+        loc=loc,
+    )
@@ -16,9 +16,9 @@
 
 # based on llvm-project/mlir/python/mlir/_mlir_libs/_mlir/dialects/pdl.pyi
 
-from typing import Optional
+from typing import Any, Optional, Sequence
 
-from ..ir import Type, Context
+from ..ir import Context, InsertionPoint, Location, Type, Value
 
 __all__ = [
     "CaptureType",
@@ -28,6 +28,8 @@ __all__ = [
     "PortGroupType",
     "WaveformType",
     "MixedFrameType",
+    "build_delay_ops",
+    "build_play_ops",
 ]
 
 class CaptureType(Type):
@@ -68,3 +70,23 @@ class MixedFrameType(Type):
     def isinstance(type: Type) -> bool: ...
     @staticmethod
     def get(context: Optional[Context] = None) -> MixedFrameType: ...
+
+def build_play_ops(
+    frames: Sequence[Value],
+    waveforms: Sequence[Value],
+    frame_indices: Any,
+    waveform_indices: Any,
+    *,
+    timepoints: Optional[Any] = None,
+    loc: Optional[Location] = None,
+    ip: Optional[InsertionPoint] = None,
+) -> None: ...
+def build_delay_ops(
+    frames: Sequence[Value],
+    frame_indices: Any,
+    durations: Any,
+    *,
+    timepoints: Optional[Any] = None,
+    loc: Optional[Location] = None,
+    ip: Optional[InsertionPoint] = None,
+) -> None: ...
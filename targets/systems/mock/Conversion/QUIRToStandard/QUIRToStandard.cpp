@@ -1,6 +1,6 @@
 //===- QUIRToStd.cpp - Convert QUIR to Std Dialect --------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -19,6 +19,7 @@
 //===----------------------------------------------------------------------===//
 #include "Conversion/QUIRToStandard/QUIRToStandard.h"
 
+#include "MockExecution.h"
 #include "MockTarget.h"
 #include "MockUtils.h"
 
@@ -33,6 +34,7 @@
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -41,16 +43,23 @@
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OperationSupport.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/TypeRange.h"
 #include "mlir/IR/ValueRange.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
 
@@ -93,15 +102,18 @@ struct ConstantOpConversionPat : public OpConversionPattern<quir::ConstantOp> {
       if (!angleWidth.has_value())
         return failure();
 
-      int64_t const multiplier = (int64_t)1 << (int64_t)angleWidth.value();
-      // shift the floating point value up by the desired precision
-      double const fVal = angleAttr.getValue().convertToDouble() * multiplier;
+      // encode the angle as a fraction of a full turn of the desired
+      // precision, the same fixed-point phase the pulse lowering uses, such
+      // that masking the results of angle arithmetic wraps around a turn
+      auto const fixed = quir::getFixedPointAngle(
+          angleAttr.getValue().convertToDouble(), angleWidth.value());
       IntegerType iType;
       if (angleWidth.value() > 31)
         iType = rewriter.getI64Type();
       else
         iType = rewriter.getI32Type();
-      IntegerAttr const iAttr = rewriter.getIntegerAttr(iType, (int64_t)fVal);
+      IntegerAttr const iAttr =
+          rewriter.getIntegerAttr(iType, fixed.zext(iType.getWidth()));
 
       auto arithConstOp = rewriter.create<mlir::arith::ConstantOp>(
           constOp->getLoc(), iType, iAttr);
@@ -161,59 +173,205 @@ struct CommOpConversionPat : public OpConversionPattern<CommOp> {
                   ConversionPatternRewriter &rewriter) const override {
     const auto numResults = commOp.getOperation()->getNumResults();
 
-    switch (numResults) {
-    case 0:
+    if (numResults == 0) {
       rewriter.eraseOp(commOp.getOperation());
       return success();
+    }
+
+    // replace each value received, several values may share one message
+    int64_t const iVal = 1;
+    IntegerType const i1Type = rewriter.getI1Type();
+    IntegerAttr const iAttr = rewriter.getIntegerAttr(i1Type, iVal);
+    SmallVector<Value> replacements;
+    replacements.reserve(numResults);
+    for (unsigned i = 0; i < numResults; ++i)
+      replacements.push_back(rewriter.create<mlir::arith::ConstantOp>(
+          commOp->getLoc(), i1Type, iAttr));
+    rewriter.replaceOp(commOp.getOperation(), replacements);
+    return success();
+  } // matchAndRewrite
+};  // struct CommOpConversionPat
+
+// Convert the comm op to calls of the runtime functions of MockExecution.h,
+// each value received to a call returning it. Falls back to
+// CommOpConversionPat for values which are not integers.
+template <class CommOp>
+struct RuntimeCommOpConversionPat : public OpConversionPattern<CommOp> {
 
-    case 1: {
-      // shift the floating point value up by the desired precision
-      int64_t const iVal = 1;
-      IntegerType const i1Type = rewriter.getI1Type();
+  explicit RuntimeCommOpConversionPat(
+      MLIRContext *ctx, TypeConverter &typeConverter,
+      const llvm::DenseMap<Operation *, int32_t> &commIds)
+      : OpConversionPattern<CommOp>(typeConverter, ctx, /*benefit=*/2),
+        commIds(commIds) {}
+
+  LogicalResult
+  matchAndRewrite(CommOp commOp, typename CommOp::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Operation *op = commOp.getOperation();
+    SmallVector<IntegerType> resultTypes;
+    for (Type const resultType : op->getResultTypes()) {
+      auto intType = this->getTypeConverter()
+                         ->convertType(resultType)
+                         .template dyn_cast_or_null<IntegerType>();
+      if (!intType)
+        return failure();
+      resultTypes.push_back(intType);
+    }
 
-      IntegerAttr const iAttr = rewriter.getIntegerAttr(i1Type, iVal);
-      auto constOp = rewriter.create<mlir::arith::ConstantOp>(commOp->getLoc(),
-                                                              i1Type, iAttr);
-      rewriter.replaceOp(commOp.getOperation(), {constOp.getODSResults(0)});
+    auto loc = op->getLoc();
+    Value const commId = rewriter.create<mlir::arith::ConstantIntOp>(
+        loc, commIds.lookup(op), /*width=*/32);
+    if (resultTypes.empty()) {
+      rewriter.create<mlir::func::CallOp>(loc, mockSendSymbol, TypeRange{},
+                                          ValueRange{commId});
+      rewriter.eraseOp(op);
       return success();
     }
 
-    default:
-      commOp.emitOpError()
-          << "Error: " << commOp.getOperation() << " with " << numResults
-          << " is not currently handled by the pattern CommOpConversionPat!\n";
-      return failure();
+    SmallVector<Value> replacements;
+    replacements.reserve(resultTypes.size());
+    for (IntegerType const intType : resultTypes) {
+      Value value = rewriter
+                        .create<mlir::func::CallOp>(loc, mockRecvSymbol,
+                                                    rewriter.getI64Type(),
+                                                    ValueRange{commId})
+                        .getResult(0);
+      if (intType.getWidth() < 64)
+        value = rewriter.create<mlir::arith::TruncIOp>(loc, intType, value);
+      else if (intType.getWidth() > 64)
+        value = rewriter.create<mlir::arith::ExtUIOp>(loc, intType, value);
+      replacements.push_back(value);
     }
+    rewriter.replaceOp(op, replacements);
+    return success();
   } // matchAndRewrite
-};  // struct CommOpConversionPat
 
-// Remaining operation conversion pattern
+private:
+  const llvm::DenseMap<Operation *, int32_t> &commIds;
+}; // struct RuntimeCommOpConversionPat
+
+// Convert the start of a shot to a call of the runtime function.
+struct RuntimeShotInitConversionPat
+    : public OpConversionPattern<qcs::ShotInitOp> {
+
+  explicit RuntimeShotInitConversionPat(MLIRContext *ctx,
+                                        TypeConverter &typeConverter)
+      : OpConversionPattern(typeConverter, ctx, /*benefit=*/2) {}
+
+  LogicalResult
+  matchAndRewrite(qcs::ShotInitOp shotInitOp, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.create<mlir::func::CallOp>(shotInitOp->getLoc(),
+                                        mockShotInitSymbol, TypeRange{});
+    rewriter.eraseOp(shotInitOp);
+    return success();
+  } // matchAndRewrite
+};  // struct RuntimeShotInitConversionPat
+
+// Declare the runtime functions of MockExecution.h in moduleOp and number
+// its comm ops in order, the receives and the sends separately.
+void declareRuntimeFunctions(ModuleOp moduleOp,
+                             llvm::DenseMap<Operation *, int32_t> &commIds) {
+  auto builder = OpBuilder::atBlockBegin(moduleOp.getBody());
+  auto declare = [&](llvm::StringRef name, FunctionType type) {
+    if (moduleOp.lookupSymbol(name))
+      return;
+    builder.create<mlir::func::FuncOp>(moduleOp->getLoc(), name, type)
+        .setPrivate();
+  };
+  declare(mockRecvSymbol,
+          builder.getFunctionType(builder.getI32Type(), builder.getI64Type()));
+  declare(mockSendSymbol,
+          builder.getFunctionType(builder.getI32Type(), TypeRange{}));
+  declare(mockShotInitSymbol, builder.getFunctionType(TypeRange{}, {}));
+
+  int32_t numRecvs = 0;
+  int32_t numSends = 0;
+  moduleOp->walk([&](Operation *op) {
+    if (isa<qcs::RecvOp>(op))
+      commIds[op] = numRecvs++;
+    else if (isa<qcs::SendOp, qcs::BroadcastOp>(op))
+      commIds[op] = numSends++;
+  });
+} // declareRuntimeFunctions
+
+// Inline the branch ops of a qcs.parallel_control_flow, which the mock
+// Controller runs one after the other.
+struct ParallelControlFlowConversionPat
+    : public OpConversionPattern<qcs::ParallelControlFlowOp> {
+
+  explicit ParallelControlFlowConversionPat(MLIRContext *ctx,
+                                            TypeConverter &typeConverter)
+      : OpConversionPattern(typeConverter, ctx, /*benefit=*/1) {}
+
+  LogicalResult
+  matchAndRewrite(qcs::ParallelControlFlowOp parallelOp, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Block &body = parallelOp.getRegion().front();
+    rewriter.eraseOp(body.getTerminator());
+    rewriter.inlineBlockBefore(&body, parallelOp);
+    rewriter.eraseOp(parallelOp);
+    return success();
+  } // matchAndRewrite
+};  // struct ParallelControlFlowConversionPat
+
+// Inline the post-processing of a shot, which the mock Controller runs
+// before the next shot.
+struct ShotPostProcessConversionPat
+    : public OpConversionPattern<qcs::ShotPostProcessOp> {
+
+  explicit ShotPostProcessConversionPat(MLIRContext *ctx,
+                                        TypeConverter &typeConverter)
+      : OpConversionPattern(typeConverter, ctx, /*benefit=*/1) {}
+
+  LogicalResult
+  matchAndRewrite(qcs::ShotPostProcessOp postProcessOp, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Block &body = postProcessOp.getRegion().front();
+    rewriter.eraseOp(body.getTerminator());
+    rewriter.inlineBlockBefore(&body, postProcessOp);
+    rewriter.eraseOp(postProcessOp);
+    return success();
+  } // matchAndRewrite
+};  // struct ShotPostProcessConversionPat
+
+// Erase the remaining operations of the QUIR, OQ3 and QCS dialects, which
+// are not supported by the mock target, and their users. The pattern is
+// rooted at a single op name, so that the conversion only tries it on the ops
+// of that name rather than trying a match-any pattern on every op.
 class RemainingOpConversionPat : public ConversionPattern {
 
 public:
-  RemainingOpConversionPat(MLIRContext *ctx, QuirTypeConverter &typeConverter)
-      : ConversionPattern(RewritePattern::MatchAnyOpTypeTag(), /*benefit=*/1,
-                          ctx) {}
+  RemainingOpConversionPat(llvm::StringRef rootName, MLIRContext *ctx)
+      : ConversionPattern(rootName, /*benefit=*/1, ctx) {}
 
   LogicalResult
   matchAndRewrite(Operation *op, ArrayRef<Value> operands,
                   ConversionPatternRewriter &rewriter) const override {
-    if (llvm::isa<oq3::OQ3Dialect>(op->getDialect()) ||
-        llvm::isa<quir::QUIRDialect>(op->getDialect()) ||
-        llvm::isa<qcs::QCSDialect>(op->getDialect())) {
-
-      for (auto *user : op->getUsers())
-        rewriter.eraseOp(user);
+    for (auto *user : op->getUsers())
+      rewriter.eraseOp(user);
 
-      rewriter.eraseOp(op);
-      return success();
-    }
-
-    // attribute type is not handled (for now)
-    return failure();
+    rewriter.eraseOp(op);
+    return success();
   } // matchAndRewrite
 };  // struct RemainingOpConversionPat
 
+// Add a RemainingOpConversionPat for each registered op of the QUIR, OQ3 and
+// QCS dialects which the target does not consider legal. They are added after
+// the specific patterns, which are tried first on the same op.
+void populateRemainingOpConversionPatterns(RewritePatternSet &patterns,
+                                           const ConversionTarget &target) {
+  MLIRContext *ctx = patterns.getContext();
+  for (RegisteredOperationName const name : ctx->getRegisteredOperations()) {
+    if (!llvm::isa<oq3::OQ3Dialect, quir::QUIRDialect, qcs::QCSDialect>(
+            name.getDialect()))
+      continue;
+    if (target.getOpAction(name) == ConversionTarget::LegalizationAction::Legal)
+      continue;
+    patterns.add<RemainingOpConversionPat>(name.getStringRef(), ctx);
+  }
+} // populateRemainingOpConversionPatterns
+
 void conversion::MockQUIRToStdPass::getDependentDialects(
     DialectRegistry &registry) const {
   registry.insert<LLVM::LLVMDialect, mlir::memref::MemRefDialect,
@@ -221,13 +379,17 @@ void conversion::MockQUIRToStdPass::getDependentDialects(
 }
 
 void MockQUIRToStdPass::runOnOperation(MockSystem &system) {
-  const ModuleOp moduleOp = getOperation();
+  ModuleOp moduleOp = getOperation();
 
   // First remove all arguments from synchronization ops
   moduleOp->walk([](qcs::SynchronizeOp synchOp) {
     synchOp.getQubitsMutable().assign(ValueRange({}));
   });
 
+  llvm::DenseMap<Operation *, int32_t> commIds;
+  if (withRuntimeStubs)
+    declareRuntimeFunctions(moduleOp, commIds);
+
   QuirTypeConverter typeConverter;
   auto *context = &getContext();
   ConversionTarget target(*context);
@@ -276,16 +438,25 @@ void MockQUIRToStdPass::runOnOperation(MockSystem &system) {
                ReturnConversionPat,
                CommOpConversionPat<qcs::RecvOp>,
                CommOpConversionPat<qcs::BroadcastOp>,
+               ParallelControlFlowConversionPat,
+               ShotPostProcessConversionPat,
                AngleBinOpConversionPat<oq3::AngleAddOp, mlir::arith::AddIOp>,
                AngleBinOpConversionPat<oq3::AngleSubOp, mlir::arith::SubIOp>,
                AngleBinOpConversionPat<oq3::AngleMulOp, mlir::arith::MulIOp>,
-               AngleBinOpConversionPat<oq3::AngleDivOp, mlir::arith::DivSIOp>,
-               RemainingOpConversionPat>(
+               AngleBinOpConversionPat<oq3::AngleDivOp, mlir::arith::DivSIOp>>(
       context, typeConverter);
   // clang-format on
+  if (withRuntimeStubs) {
+    patterns.add<RuntimeCommOpConversionPat<qcs::RecvOp>,
+                 RuntimeCommOpConversionPat<qcs::SendOp>,
+                 RuntimeCommOpConversionPat<qcs::BroadcastOp>>(
+        context, typeConverter, commIds);
+    patterns.add<RuntimeShotInitConversionPat>(context, typeConverter);
+  }
 
   quir::populateVariableToGlobalMemRefConversionPatterns(
       patterns, typeConverter, externalizeOutputVariables);
+  populateRemainingOpConversionPatterns(patterns, target);
 
   // With the target and rewrite patterns defined, we can now attempt the
   // conversion. The conversion will signal failure if any of our `illegal`
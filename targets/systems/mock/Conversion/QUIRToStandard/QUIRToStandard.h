@@ -1,6 +1,6 @@
 //===- QUIRToStd.h - Convert QUIR to Std Dialect ----------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -37,9 +37,15 @@ struct MockQUIRToStdPass
   void getDependentDialects(mlir::DialectRegistry &registry) const override;
 
   bool externalizeOutputVariables;
-
-  MockQUIRToStdPass(bool externalizeOutputVariables)
-      : PassWrapper(), externalizeOutputVariables(externalizeOutputVariables) {}
+  // lower the communication with the other nodes and the start of each shot
+  // to calls of the runtime functions of MockExecution.h rather than
+  // dropping them, such that the Controller code can be executed in process
+  bool withRuntimeStubs;
+
+  MockQUIRToStdPass(bool externalizeOutputVariables,
+                    bool withRuntimeStubs = false)
+      : PassWrapper(), externalizeOutputVariables(externalizeOutputVariables),
+        withRuntimeStubs(withRuntimeStubs) {}
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
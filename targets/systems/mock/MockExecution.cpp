@@ -0,0 +1,183 @@
+//===- MockExecution.cpp ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of the in-process execution of the Controller code for the
+// Mock Target
+//
+//===----------------------------------------------------------------------===//
+
+#include "MockExecution.h"
+
+#include "mlir/ExecutionEngine/ExecutionEngine.h"
+#include "mlir/ExecutionEngine/OptUtils.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/Mangling.h"
+#include "llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Support/TargetSelect.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <random>
+
+using namespace qssc::targets::systems::mock;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+uint64_t elapsedNs(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count();
+}
+
+// The state of one execution, which the runtime functions update. The time
+// spent in them is included in the shot times but not in the feedforward
+// paths, which start once a value is received.
+class MockRuntime {
+public:
+  MockRuntime(uint64_t seed, MockExecutionReport &report)
+      : generator(seed), report(report) {}
+
+  int64_t recv(int32_t recvId) {
+    // the simulated Acquire node
+    int64_t const value = outcome(generator) ? 1 : 0;
+    lastRecv.emplace(recvId, Clock::now());
+    return value;
+  }
+
+  void send(int32_t sendId) {
+    auto const now = Clock::now();
+    if (!lastRecv)
+      return;
+    report.feedforwardPaths[{lastRecv->first, sendId}].add(
+        elapsedNs(lastRecv->second, now));
+    lastRecv.reset();
+  }
+
+  void shotInit() {
+    auto const now = Clock::now();
+    finish(now);
+    shotStart = now;
+  }
+
+  void finish(Clock::time_point now) {
+    if (shotStart)
+      report.shots.add(elapsedNs(*shotStart, now));
+    shotStart.reset();
+    lastRecv.reset();
+  }
+
+private:
+  std::mt19937_64 generator;
+  std::bernoulli_distribution outcome;
+  MockExecutionReport &report;
+  std::optional<Clock::time_point> shotStart;
+  std::optional<std::pair<int32_t, Clock::time_point>> lastRecv;
+};
+
+// the runtime of the execution on this thread, set around the call of main
+thread_local MockRuntime *currentRuntime = nullptr;
+
+int64_t mockRecv(int32_t recvId) { return currentRuntime->recv(recvId); }
+
+void mockSend(int32_t sendId) { currentRuntime->send(sendId); }
+
+void mockShotInit() { currentRuntime->shotInit(); }
+} // anonymous namespace
+
+void MockExecutionReport::Times::add(uint64_t ns) {
+  minNs = count == 0 ? ns : std::min(minNs, ns);
+  maxNs = std::max(maxNs, ns);
+  totalNs += ns;
+  ++count;
+}
+
+void MockExecutionReport::print(llvm::raw_ostream &os) const {
+  os << "# main returned " << returnValue << " after " << totalNs << " ns\n";
+  os << "# path count total_ns min_ns mean_ns max_ns\n";
+  auto printTimes = [&](const Times &times) {
+    uint64_t const meanNs = times.count ? times.totalNs / times.count : 0;
+    os << " " << times.count << " " << times.totalNs << " " << times.minNs
+       << " " << meanNs << " " << times.maxNs << "\n";
+  };
+  os << "shot";
+  printTimes(shots);
+  for (const auto &[ids, times] : feedforwardPaths) {
+    os << "recv" << ids.first << "-send" << ids.second;
+    printTimes(times);
+  }
+}
+
+auto qssc::targets::systems::mock::executeControllerModule(
+    mlir::ModuleOp controllerModule, const MockExecutionOptions &options)
+    -> llvm::Expected<MockExecutionReport> {
+  static std::once_flag initNativeTarget;
+  std::call_once(initNativeTarget, [] {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  });
+
+  auto codeGenOptLevel =
+      llvm::CodeGenOpt::getLevel(static_cast<int>(options.codeGenOptLevel));
+  if (!codeGenOptLevel)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "LLVM optimization levels must be between 0 and 3");
+
+  // the code is optimized as for the payload, with the host as the target
+  auto transformer = mlir::makeOptimizingTransformer(
+      options.optLevel, options.sizeLevel, /*targetMachine=*/nullptr);
+  mlir::ExecutionEngineOptions engineOptions;
+  engineOptions.transformer = transformer;
+  engineOptions.jitCodeGenOptLevel = *codeGenOptLevel;
+  auto engine = mlir::ExecutionEngine::create(controllerModule, engineOptions);
+  if (!engine)
+    return engine.takeError();
+
+  (*engine)->registerSymbols([](llvm::orc::MangleAndInterner interner) {
+    llvm::orc::SymbolMap symbols;
+    auto addSymbol = [&](llvm::StringRef name, auto *function) {
+      symbols[interner(name)] = {llvm::orc::ExecutorAddr::fromPtr(function),
+                                 llvm::JITSymbolFlags::Exported};
+    };
+    addSymbol(mockRecvSymbol, &mockRecv);
+    addSymbol(mockSendSymbol, &mockSend);
+    addSymbol(mockShotInitSymbol, &mockShotInit);
+    return symbols;
+  });
+
+  // looked up first, such that the times exclude the compilation
+  auto mainFunction = (*engine)->lookupPacked("main");
+  if (!mainFunction)
+    return mainFunction.takeError();
+
+  MockExecutionReport report;
+  MockRuntime runtime(options.seed, report);
+  void *arguments[] = {&report.returnValue};
+  currentRuntime = &runtime;
+  auto const start = Clock::now();
+  (*mainFunction)(arguments);
+  auto const end = Clock::now();
+  runtime.finish(end);
+  currentRuntime = nullptr;
+  report.totalNs = elapsedNs(start, end);
+  return report;
+} // executeControllerModule
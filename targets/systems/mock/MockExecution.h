@@ -0,0 +1,88 @@
+//===- MockExecution.h - Execute mock controller code -----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// Declaration of the in-process execution of the Controller code through the
+// ORC JIT, for a hardware-free benchmark of the classical code generated for
+// the Mock Target. The communication with the other nodes is lowered to
+// calls of the runtime functions below, which simulate an Acquire node
+// returning random measurement outcomes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef HAL_MOCKEXECUTION_H
+#define HAL_MOCKEXECUTION_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <map>
+#include <utility>
+
+namespace mlir {
+class ModuleOp;
+} // end namespace mlir
+
+namespace qssc::targets::systems::mock {
+
+// int64_t(int32_t recvId): receive a value, a random measurement outcome
+constexpr llvm::StringLiteral mockRecvSymbol = "__qssc_mock_recv";
+// void(int32_t sendId): send or broadcast values
+constexpr llvm::StringLiteral mockSendSymbol = "__qssc_mock_send";
+// void(): start a shot
+constexpr llvm::StringLiteral mockShotInitSymbol = "__qssc_mock_shot_init";
+
+// The classical execution times of the Controller code, in nanoseconds
+struct MockExecutionReport {
+  struct Times {
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t minNs = 0;
+    uint64_t maxNs = 0;
+
+    void add(uint64_t ns);
+  };
+
+  int32_t returnValue = 0;
+  uint64_t totalNs = 0;
+  // from the start of each shot to the start of the next one or the end of
+  // the program
+  Times shots;
+  // from receiving a value to sending the next values, by the ids of the
+  // receive and of the send in the order of the Controller module
+  std::map<std::pair<int32_t, int32_t>, Times> feedforwardPaths;
+
+  void print(llvm::raw_ostream &os) const;
+};
+
+struct MockExecutionOptions {
+  unsigned optLevel = 0;
+  unsigned sizeLevel = 0;
+  unsigned codeGenOptLevel = 0;
+  // of the random measurement outcomes
+  uint64_t seed = 0;
+};
+
+// Run the main function of a Controller module in the LLVM dialect, which
+// was lowered with the runtime functions, and time it
+auto executeControllerModule(mlir::ModuleOp controllerModule,
+                             const MockExecutionOptions &options)
+    -> llvm::Expected<MockExecutionReport>;
+
+} // namespace qssc::targets::systems::mock
+
+#endif // HAL_MOCKEXECUTION_H
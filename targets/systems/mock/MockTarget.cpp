@@ -1,6 +1,6 @@
 //===- MockTarget.cpp ----------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -16,6 +16,8 @@
 
 #include "MockTarget.h"
 
+#include "API/CompileCache.h"
+#include "Config/QSSConfig.h"
 #include "Conversion/QUIRToLLVM/QUIRToLLVM.h"
 #include "Conversion/QUIRToStandard/QUIRToStandard.h"
 #include "Dialect/QUIR/Transforms/BreakReset.h"
@@ -24,46 +26,70 @@
 #include "Dialect/QUIR/Transforms/RemoveQubitOperands.h"
 #include "Dialect/QUIR/Transforms/SubroutineCloning.h"
 #include "HAL/SystemConfiguration.h"
+#include "HAL/SystemConfigurationCache.h"
 #include "HAL/TargetSystem.h"
 #include "HAL/TargetSystemRegistry.h"
+#include "MockExecution.h"
 #include "Payload/Payload.h"
+#include "QSSC.h"
+#include "Transforms/AcquisitionAggregation.h"
 #include "Transforms/QubitLocalization.h"
+#include "Utils/CompileBudget.h"
+#include "Utils/HashField.h"
 
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Dialect/LLVMIR/Transforms/LegalizeForExport.h"
 #include "mlir/ExecutionEngine/OptUtils.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Pass/PassRegistry.h"
-#include "mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h"
-#include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Export.h"
 #include "mlir/Transforms/Passes.h"
 
 #include "llvm/ADT/STLExtras.h"
-#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/BinaryByteStream.h"
+#include "llvm/Support/BinaryStreamReader.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Error.h"
-#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/SmallVectorMemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
-#include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/TargetParser/Host.h"
 #include "llvm/TargetParser/SubtargetFeature.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 
 #include <cstdint>
 #include <fstream>
-#include <ios>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <sys/types.h>
 #include <utility>
@@ -74,6 +100,7 @@ using namespace mlir::quir;
 
 using namespace qssc::hal;
 using namespace qssc::targets::systems::mock;
+using qssc::utils::hashField;
 
 namespace {
 // The space below at the front of the string causes this category to be printed
@@ -82,6 +109,35 @@ llvm::cl::OptionCategory
     mockCat(" QSS Compiler Options for the Mock target",
             "Options that control Mock-specific behavior of the Mock QSS "
             "Compiler target");
+
+llvm::cl::opt<std::string> mockConfigSnapshotDir(
+    "mock-config-snapshot-dir",
+    llvm::cl::desc("Directory of binary snapshots of parsed mock configs, "
+                   "which are written on the first parse of a config and "
+                   "mapped rather than parsed afterwards"),
+    llvm::cl::value_desc("directory"), llvm::cl::cat(mockCat));
+
+llvm::cl::opt<bool> mockExecuteController(
+    "mock-execute-controller",
+    llvm::cl::desc("Execute the Controller code in process through the JIT, "
+                   "with random measurement outcomes, and write its classical "
+                   "execution time per shot and per feedforward path to "
+                   "controller.exec in the payload"),
+    llvm::cl::init(false), llvm::cl::cat(mockCat));
+
+llvm::cl::opt<uint64_t> mockExecutionSeed(
+    "mock-execution-seed",
+    llvm::cl::desc("Seed of the random measurement outcomes of "
+                   "--mock-execute-controller"),
+    llvm::cl::init(0), llvm::cl::cat(mockCat));
+
+// bump when the payload of MockConfig::writeSnapshot changes
+constexpr uint32_t mockConfigSnapshotVersion = 1;
+
+qssc::hal::ConfigurationCache<MockConfig> &getMockConfigCache() {
+  static qssc::hal::ConfigurationCache<MockConfig> cache;
+  return cache;
+}
 } // anonymous namespace
 
 int qssc::targets::systems::mock::init() {
@@ -95,8 +151,10 @@ int qssc::targets::systems::mock::init() {
                   llvm::inconvertibleErrorCode(),
                   "Configuration file must be specified.\n");
 
-            auto config = std::make_unique<MockConfig>(*configurationPath);
-            return std::make_unique<MockSystem>(std::move(config));
+            auto config = MockConfig::load(*configurationPath);
+            if (!config)
+              return config.takeError();
+            return std::make_unique<MockSystem>(std::move(*config));
           });
   return registered ? 0 : -1;
 }
@@ -111,7 +169,10 @@ MockConfig::MockConfig(llvm::StringRef configurationPath)
     llvm::errs() << "Problem opening file " + configurationPath;
     return;
   }
+  parse(configStream);
+}
 
+void MockConfig::parse(std::istream &configStream) {
   // This is a terrible parsing design just to make things work for now
   std::string fieldName;
   configStream >> fieldName;
@@ -139,10 +200,39 @@ MockConfig::MockConfig(llvm::StringRef configurationPath)
         << fieldName << "\n";
   }
 
+  // Optional settings
+  while (configStream >> fieldName) {
+    if (fieldName == "llvm_opt_preset") {
+      std::string preset;
+      configStream >> preset;
+      if (failed(applyLLVMOptPreset(preset)))
+        llvm::errs() << "Problem parsing configStream, unknown "
+                        "llvm_opt_preset "
+                     << preset << "\n";
+    } else if (fieldName == "llvm_opt_level") {
+      configStream >> llvmOptLevel;
+    } else if (fieldName == "llvm_size_level") {
+      configStream >> llvmSizeLevel;
+    } else if (fieldName == "llvm_codegen_opt_level") {
+      configStream >> llvmCodeGenOptLevel;
+    } else if (fieldName == "llvm_codegen_partitions") {
+      configStream >> llvmCodeGenPartitions;
+    } else if (fieldName == "llvm_parallel_function_opt") {
+      configStream >> llvmParallelFunctionOpt;
+    } else {
+      llvm::errs() << "Problem parsing configStream, unknown field "
+                   << fieldName << "\n";
+      configStream >> fieldName;
+    }
+  }
+
   llvm::outs() << "Config:\nnum_qubits " << numQubits << "\nmultiplexing_ratio "
                << multiplexing_ratio << "\n";
 
-  // preprocessing of config data for use by passes
+  buildRoutingTables();
+} // MockConfig::parse
+
+void MockConfig::buildRoutingTables() {
   qubitDriveMap.resize(numQubits);
   qubitAcquireMap.resize(numQubits);
   uint nextId = 0, acquireId = 0;
@@ -150,13 +240,162 @@ MockConfig::MockConfig(llvm::StringRef configurationPath)
   for (uint physId = 0; physId < numQubits; ++physId) {
     if (physId % multiplexing_ratio == 0) {
       acquireId = nextId++;
-      qubitAcquireToPhysIdMap[acquireId] = std::vector<int>();
+      acquireNodes.push_back(acquireId);
+      nodeAcquireQubits.emplace_back();
     }
-    qubitAcquireToPhysIdMap[acquireId].push_back(physId);
+    nodeAcquireQubits[acquireId].push_back(physId);
     qubitAcquireMap[physId] = acquireId;
     qubitDriveMap[physId] = nextId++;
+    nodeAcquireQubits.emplace_back();
+  }
+} // MockConfig::buildRoutingTables
+
+llvm::Expected<std::unique_ptr<MockConfig>>
+MockConfig::load(llvm::StringRef configurationPath) {
+  auto file = qssc::hal::readConfigurationFile(configurationPath);
+  if (!file)
+    return file.takeError();
+
+  auto &cache = getMockConfigCache();
+  if (auto cached = cache.lookup(file->hash))
+    return std::make_unique<MockConfig>(*cached);
+
+  std::string snapshotPath;
+  if (!mockConfigSnapshotDir.empty()) {
+    snapshotPath = qssc::hal::getConfigurationSnapshotPath(
+        mockConfigSnapshotDir, "mock", file->hash);
+    auto snapshot = qssc::hal::readConfigurationSnapshot(
+        snapshotPath, "mock", mockConfigSnapshotVersion, file->hash);
+    if (!snapshot)
+      return snapshot.takeError();
+    if (snapshot->has_value()) {
+      auto config = readSnapshot((*snapshot)->payload);
+      if (!config)
+        return config.takeError();
+      cache.insert(file->hash, std::make_shared<MockConfig>(**config));
+      return config;
+    }
   }
-} // MockConfig
+
+  std::istringstream configStream(file->buffer->getBuffer().str());
+  std::unique_ptr<MockConfig> config(new MockConfig());
+  config->parse(configStream);
+
+  if (!snapshotPath.empty()) {
+    std::string payload;
+    llvm::raw_string_ostream payloadStream(payload);
+    config->writeSnapshot(payloadStream);
+    // without a snapshot the config is parsed again by the next process
+    if (auto err = qssc::hal::writeConfigurationSnapshot(
+            snapshotPath, "mock", mockConfigSnapshotVersion, file->hash,
+            payloadStream.str()))
+      llvm::errs() << "Problem writing the config snapshot: "
+                   << llvm::toString(std::move(err)) << "\n";
+  }
+  cache.insert(file->hash, std::make_shared<MockConfig>(*config));
+  return std::move(config);
+} // MockConfig::load
+
+void MockConfig::writeSnapshot(llvm::raw_ostream &os) const {
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+  for (uint const value :
+       {numQubits, multiplexing_ratio, controllerNodeId, llvmOptLevel,
+        llvmSizeLevel, llvmCodeGenOptLevel, llvmCodeGenPartitions,
+        static_cast<uint>(llvmParallelFunctionOpt)})
+    writer.write<uint32_t>(value);
+
+  // the routing tables are stored as built, such that loading the snapshot
+  // does not rebuild them
+  auto writeArray = [&](const auto &values) {
+    writer.write<uint32_t>(values.size());
+    for (auto value : values)
+      writer.write<uint32_t>(value);
+  };
+  writeArray(qubitDriveMap);
+  writeArray(qubitAcquireMap);
+  writeArray(acquireNodes);
+  writer.write<uint32_t>(nodeAcquireQubits.size());
+  for (const auto &qubits : nodeAcquireQubits)
+    writeArray(qubits);
+} // MockConfig::writeSnapshot
+
+llvm::Expected<std::unique_ptr<MockConfig>>
+MockConfig::readSnapshot(llvm::StringRef payload) {
+  llvm::BinaryByteStream stream(llvm::arrayRefFromStringRef(payload),
+                                llvm::support::little);
+  llvm::BinaryStreamReader reader(stream);
+  std::unique_ptr<MockConfig> config(new MockConfig());
+
+  uint32_t parallelFunctionOpt;
+  for (uint *value :
+       {&config->numQubits, &config->multiplexing_ratio,
+        &config->controllerNodeId, &config->llvmOptLevel,
+        &config->llvmSizeLevel, &config->llvmCodeGenOptLevel,
+        &config->llvmCodeGenPartitions, &parallelFunctionOpt})
+    if (auto err = reader.readInteger(*value))
+      return std::move(err);
+  config->llvmParallelFunctionOpt = parallelFunctionOpt != 0;
+
+  auto readArray = [&](auto &values) -> llvm::Error {
+    uint32_t size;
+    if (auto err = reader.readInteger(size))
+      return err;
+    // the elements are mapped into memory, each of 4 bytes
+    if (size > reader.bytesRemaining() / sizeof(uint32_t))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Truncated mock config snapshot");
+    llvm::FixedStreamArray<llvm::support::ulittle32_t> array;
+    if (auto err = reader.readArray(array, size))
+      return err;
+    values.assign(array.begin(), array.end());
+    return llvm::Error::success();
+  };
+  if (auto err = readArray(config->qubitDriveMap))
+    return std::move(err);
+  if (auto err = readArray(config->qubitAcquireMap))
+    return std::move(err);
+  if (auto err = readArray(config->acquireNodes))
+    return std::move(err);
+  uint32_t numNodes;
+  if (auto err = reader.readInteger(numNodes))
+    return std::move(err);
+  if (numNodes > reader.bytesRemaining() / sizeof(uint32_t))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Truncated mock config snapshot");
+  config->nodeAcquireQubits.resize(numNodes);
+  for (auto &qubits : config->nodeAcquireQubits)
+    if (auto err = readArray(qubits))
+      return std::move(err);
+
+  if (config->qubitDriveMap.size() != config->numQubits ||
+      config->qubitAcquireMap.size() != config->numQubits)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Inconsistent mock config snapshot");
+  return std::move(config);
+} // MockConfig::readSnapshot
+
+mlir::LogicalResult MockConfig::applyLLVMOptPreset(llvm::StringRef preset) {
+  // IR optimization, size optimization and code generation levels
+  struct Preset {
+    llvm::StringRef name;
+    uint optLevel;
+    uint sizeLevel;
+    uint codeGenOptLevel;
+  };
+  static constexpr Preset presets[] = {{"O0", 0, 0, 0},
+                                       {"O1", 1, 0, 1},
+                                       {"O2", 2, 0, 2},
+                                       {"O3", 3, 0, 3},
+                                       {"size", 2, 1, 2}};
+  const auto *it = llvm::find_if(
+      presets, [&](const Preset &entry) { return entry.name == preset; });
+  if (it == std::end(presets))
+    return mlir::failure();
+  llvmOptLevel = it->optLevel;
+  llvmSizeLevel = it->sizeLevel;
+  llvmCodeGenOptLevel = it->codeGenOptLevel;
+  return mlir::success();
+} // MockConfig::applyLLVMOptPreset
 
 MockSystem::MockSystem(std::unique_ptr<MockConfig> config)
     : TargetSystem("MockSystem", nullptr), mockConfig(std::move(config)) {
@@ -200,6 +439,7 @@ void mockPipelineBuilder(mlir::OpPassManager &pm) {
   pm.addPass(std::make_unique<mlir::quir::SubroutineCloningPass>());
   pm.addPass(std::make_unique<mlir::quir::RemoveQubitOperandsPass>());
   pm.addPass(std::make_unique<mlir::quir::ClassicalOnlyDetectionPass>());
+  pm.addPass(std::make_unique<mlir::quir::ParallelControlFlowPass>());
   pm.addPass(std::make_unique<MockQubitLocalizationPass>());
   OpPassManager &nestedModulePM = pm.nest<ModuleOp>();
   nestedModulePM.addPass(
@@ -232,7 +472,8 @@ llvm::Error MockSystem::emitToPayload(mlir::ModuleOp moduleOp,
 
 MockController::MockController(std::string name, MockSystem *parent,
                                const SystemConfiguration &config)
-    : TargetInstrument(std::move(name), parent) {} // MockController
+    : TargetInstrument(std::move(name), parent), system(parent) {
+} // MockController
 
 void MockController::registerTargetPasses() {
 } // MockController::registerTargetPasses
@@ -240,7 +481,29 @@ void MockController::registerTargetPasses() {
 void MockController::registerTargetPipelines() {
 } // MockController::registerTargetPipelines
 
+namespace {
+/// Clone the module it runs on into clone, from which the code executed by
+/// --mock-execute-controller is lowered separately.
+struct CloneModulePass
+    : public mlir::PassWrapper<CloneModulePass,
+                               mlir::OperationPass<mlir::ModuleOp>> {
+  explicit CloneModulePass(mlir::OwningOpRef<mlir::ModuleOp> &clone)
+      : clone(clone) {}
+
+  void runOnOperation() override {
+    clone = getOperation().clone();
+    markAllAnalysesPreserved();
+  }
+
+  mlir::OwningOpRef<mlir::ModuleOp> &clone;
+}; // struct CloneModulePass
+} // anonymous namespace
+
 llvm::Error MockController::addPasses(mlir::PassManager &pm) {
+  // The module executed is lowered with the runtime stubs, while the one
+  // emitted to controller.bin stays free of them
+  if (mockExecuteController)
+    pm.addPass(std::make_unique<CloneModulePass>(executionModule));
   pm.addPass(std::make_unique<conversion::MockQUIRToStdPass>(false));
   pm.addPass(mlir::createCanonicalizerPass());
   pm.addPass(mlir::LLVM::createLegalizeForExportPass());
@@ -251,47 +514,220 @@ llvm::Error MockController::addPasses(mlir::PassManager &pm) {
 llvm::Error MockController::emitToPayload(mlir::ModuleOp moduleOp,
                                           qssc::payload::Payload &payload) {
 
-  auto *mlirStr = payload.getFile(name + ".mlir");
-  llvm::raw_string_ostream mlirOStream(*mlirStr);
-  mlirOStream << moduleOp;
+  if (payload.shouldWriteDebugArtifacts()) {
+    auto *mlirStr = payload.getFile(name + ".mlir");
+    llvm::raw_string_ostream mlirOStream(*mlirStr);
+    mlirOStream << moduleOp;
+  }
 
   if (auto err = buildLLVMPayload(moduleOp, payload))
     return err;
 
+  if (executionModule)
+    if (auto err = executeLLVMPayload(payload))
+      return err;
+
   return llvm::Error::success();
 } // MockController::emitToPayload
 
+// Lower the clone of the Controller module taken by addPasses with the
+// runtime stubs and run it at the optimization levels of its payload
+llvm::Error
+MockController::executeLLVMPayload(qssc::payload::Payload &payload) {
+  auto timer = getTimer("execute-llvm-payload");
+  mlir::OwningOpRef<mlir::ModuleOp> const controllerModule =
+      std::move(executionModule);
+  auto &config = system->getConfig();
+
+  auto lowerTimer = timer.nest("lower-with-runtime-stubs");
+  mlir::PassManager pm(controllerModule->getContext());
+  pm.addPass(std::make_unique<conversion::MockQUIRToStdPass>(
+      false, /*withRuntimeStubs=*/true));
+  pm.addPass(mlir::createCanonicalizerPass());
+  pm.addPass(mlir::LLVM::createLegalizeForExportPass());
+  if (mlir::failed(pm.run(*controllerModule)))
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Failed to lower the Controller module with the runtime stubs");
+
+  // buildLLVMPayload has checked the optimization levels
+  auto machineOrErr = system->getTargetMachineCache().acquire(
+      llvm::sys::getDefaultTargetTriple(), "generic", "",
+      *llvm::CodeGenOpt::getLevel(
+          static_cast<int>(config.getLLVMCodeGenOptLevel())));
+  if (auto err = machineOrErr.takeError())
+    return err;
+  auto dataLayout = (*machineOrErr)->createDataLayout();
+  if (auto err =
+          quir::translateModuleToLLVMDialect(*controllerModule, dataLayout))
+    return err;
+  lowerTimer.stop();
+
+  MockExecutionOptions options;
+  options.optLevel = config.getLLVMOptLevel();
+  options.sizeLevel = config.getLLVMSizeLevel();
+  options.codeGenOptLevel = config.getLLVMCodeGenOptLevel();
+  options.seed = mockExecutionSeed;
+
+  auto report = executeControllerModule(*controllerModule, options);
+  if (!report)
+    return report.takeError();
+  std::string reportStr;
+  llvm::raw_string_ostream reportStream(reportStr);
+  report->print(reportStream);
+  payload.adoptFile("controller.exec", std::move(reportStream.str()));
+  return llvm::Error::success();
+} // MockController::executeLLVMPayload
+
+namespace {
+/// The new pass manager optimization level of an IR and size optimization
+/// level, the former above 0.
+llvm::OptimizationLevel getOptimizationLevel(uint optLevel, uint sizeLevel) {
+  if (sizeLevel == 1)
+    return llvm::OptimizationLevel::Os;
+  if (sizeLevel == 2)
+    return llvm::OptimizationLevel::Oz;
+  if (optLevel == 1)
+    return llvm::OptimizationLevel::O1;
+  if (optLevel == 2)
+    return llvm::OptimizationLevel::O2;
+  return llvm::OptimizationLevel::O3;
+}
+
+/// Run the function simplification pipeline of optLevel over each function
+/// of llvmModule. Inter-procedural optimizations are not run.
+void optimizeFunctions(llvm::TargetMachine &machine, llvm::Module &llvmModule,
+                       llvm::OptimizationLevel optLevel) {
+  llvm::LoopAnalysisManager loopAnalyses;
+  llvm::FunctionAnalysisManager functionAnalyses;
+  llvm::CGSCCAnalysisManager cgsccAnalyses;
+  llvm::ModuleAnalysisManager moduleAnalyses;
+
+  llvm::PassBuilder passBuilder(&machine);
+  passBuilder.registerModuleAnalyses(moduleAnalyses);
+  passBuilder.registerCGSCCAnalyses(cgsccAnalyses);
+  passBuilder.registerFunctionAnalyses(functionAnalyses);
+  passBuilder.registerLoopAnalyses(loopAnalyses);
+  passBuilder.crossRegisterProxies(loopAnalyses, functionAnalyses,
+                                   cgsccAnalyses, moduleAnalyses);
+
+  llvm::ModulePassManager modulePasses;
+  modulePasses.addPass(llvm::createModuleToFunctionPassAdaptor(
+      passBuilder.buildFunctionSimplificationPipeline(
+          optLevel, llvm::ThinOrFullLTOPhase::None)));
+  modulePasses.run(llvmModule, moduleAnalyses);
+}
+
+/// The object cache key of a controller module in the LLVM dialect: a digest
+/// of its bytecode without locations and of everything that determines the
+/// code generated for it, and whether its entry holds the LLVM IR.
+llvm::Expected<std::string>
+computeObjectCacheKey(mlir::ModuleOp controllerModule, const MockConfig &config,
+                      llvm::StringRef triple, llvm::StringRef cpu,
+                      llvm::StringRef features, bool withLLVMIR) {
+  // The locations name the source file, which does not change the object,
+  // such that the same program compiled from another file hits the cache
+  mlir::OwningOpRef<mlir::ModuleOp> keyModule = controllerModule.clone();
+  auto unknownLoc = mlir::UnknownLoc::get(controllerModule.getContext());
+  keyModule->walk([&](mlir::Operation *op) {
+    op->setLoc(unknownLoc);
+    for (auto &region : op->getRegions())
+      for (auto &block : region)
+        for (auto arg : block.getArguments())
+          arg.setLoc(unknownLoc);
+  });
+
+  std::string bytecode;
+  llvm::raw_string_ostream bytecodeOS(bytecode);
+  if (mlir::failed(mlir::writeBytecodeToFile(*keyModule, bytecodeOS)))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to emit controller bytecode");
+
+  llvm::SHA256 hasher;
+  hashField(hasher, qssc::getQSSCVersion());
+  hashField(hasher, "mock-controller-object");
+  hashField(hasher, bytecodeOS.str());
+  hashField(hasher, triple);
+  hashField(hasher, cpu);
+  hashField(hasher, features);
+  for (uint const level :
+       {config.getLLVMOptLevel(), config.getLLVMSizeLevel(),
+        config.getLLVMCodeGenOptLevel(), config.getLLVMCodeGenPartitions(),
+        static_cast<uint>(config.getLLVMParallelFunctionOpt()),
+        static_cast<uint>(withLLVMIR)})
+    hashField(hasher, std::to_string(level));
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+/// An object cache entry holds controller.bin and llvmModule.ll, the former
+/// prefixed by its size. The latter is empty for entries keyed without the
+/// LLVM IR.
+std::string encodeObjectCacheEntry(llvm::ArrayRef<char> object,
+                                   llvm::StringRef llvmIR) {
+  std::string entry;
+  llvm::raw_string_ostream entryOS(entry);
+  llvm::support::endian::write<uint64_t>(entryOS, object.size(),
+                                         llvm::support::little);
+  entryOS.write(object.data(), object.size());
+  entryOS << llvmIR;
+  return entryOS.str();
+}
+
+bool decodeObjectCacheEntry(llvm::StringRef entry, llvm::StringRef &object,
+                            llvm::StringRef &llvmIR) {
+  if (entry.size() < sizeof(uint64_t))
+    return false;
+  auto const objectSize =
+      llvm::support::endian::read<uint64_t, llvm::support::little,
+                                  llvm::support::unaligned>(entry.data());
+  entry = entry.drop_front(sizeof(uint64_t));
+  if (objectSize > entry.size())
+    return false;
+  object = entry.take_front(objectSize);
+  llvmIR = entry.drop_front(objectSize);
+  return true;
+}
+
+/// The compile cache configured for the context, if any.
+std::shared_ptr<qssc::cache::CompileCache>
+getObjectCache(mlir::MLIRContext *context) {
+  auto qssConfig = qssc::config::getContextConfig(context);
+  if (!qssConfig) {
+    llvm::consumeError(qssConfig.takeError());
+    return nullptr;
+  }
+  if (!qssConfig->shouldUseCompileCache())
+    return nullptr;
+  return qssc::cache::getCompileCache(*qssConfig);
+}
+} // anonymous namespace
+
 llvm::Error MockController::buildLLVMPayload(mlir::ModuleOp controllerModule,
                                              qssc::payload::Payload &payload) {
   auto timer = getTimer("build-llvm-payload");
 
-  // Register LLVM dialect and all infrastructure required for translation to
-  // LLVM IR
   auto initLLVMTimer = timer.nest("init-llvm");
-  auto *context = controllerModule.getContext();
-  mlir::registerBuiltinDialectTranslation(*context);
-  mlir::registerLLVMDialectTranslation(*context);
-
-  // Initialize native LLVM target
-  llvm::InitializeNativeTarget();
-  llvm::InitializeNativeTargetAsmParser();
-  llvm::InitializeNativeTargetAsmPrinter();
-  llvm::InitializeAllTargetMCs();
+  auto &config = system->getConfig();
+  auto codeGenOptLevel = llvm::CodeGenOpt::getLevel(
+      static_cast<int>(config.getLLVMCodeGenOptLevel()));
+  if (!codeGenOptLevel || config.getLLVMOptLevel() > 3)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "LLVM optimization levels must be between 0 and 3");
+  if (config.getLLVMSizeLevel() > 2)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "LLVM size optimization level must be between 0 and 2");
 
   // Setup the machine properties for the target architecture.
   std::string const targetTriple = llvm::sys::getDefaultTargetTriple();
-  std::string errorMessage;
-  const auto *target =
-      llvm::TargetRegistry::lookupTarget(targetTriple, errorMessage);
-  if (!target) {
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Unable to find target: " + errorMessage);
-  }
-
   std::string const cpu("generic");
   llvm::SubtargetFeatures const features;
-  std::unique_ptr<llvm::TargetMachine> machine(target->createTargetMachine(
-      targetTriple, cpu, features.getString(), {}, {}));
+  auto machineOrErr = system->getTargetMachineCache().acquire(
+      targetTriple, cpu, features.getString(), *codeGenOptLevel);
+  if (auto err = machineOrErr.takeError())
+    return err;
+  auto machine = std::move(*machineOrErr);
   auto dataLayout = machine->createDataLayout();
   initLLVMTimer.stop();
 
@@ -301,6 +737,34 @@ llvm::Error MockController::buildLLVMPayload(mlir::ModuleOp controllerModule,
     return err;
   mlirToLLVMDialectTimer.stop();
 
+  // Controller modules are often identical across compilations, e.g. of a
+  // parameter sweep, whose parameters are only bound to the payload. These
+  // are served from the compile cache without being translated, optimized or
+  // code generated.
+  std::shared_ptr<qssc::cache::CompileCache> const objectCache =
+      getObjectCache(controllerModule.getContext());
+  std::string objectCacheKey;
+  if (objectCache) {
+    auto objectCacheTimer = timer.nest("lookup-object-cache");
+    auto key = computeObjectCacheKey(
+        controllerModule, config, targetTriple, cpu, features.getString(),
+        payload.shouldWriteDebugArtifacts());
+    if (!key)
+      return key.takeError();
+    objectCacheKey = std::move(*key);
+
+    llvm::StringRef object;
+    llvm::StringRef llvmIR;
+    auto entry = objectCache->lookup(objectCacheKey);
+    // unreadable entries are treated as misses
+    if (entry && decodeObjectCacheEntry(*entry, object, llvmIR)) {
+      if (payload.shouldWriteDebugArtifacts())
+        payload.adoptFile("llvmModule.ll", llvmIR.str());
+      payload.adoptFile("controller.bin", object.str());
+      return llvm::Error::success();
+    }
+  }
+
   auto mlirToLLVMIRTimer = timer.nest("mlir-to-llvm-ir");
   // Build LLVM payload
   llvm::LLVMContext llvmContext;
@@ -316,88 +780,316 @@ llvm::Error MockController::buildLLVMPayload(mlir::ModuleOp controllerModule,
   llvmModule->setDataLayout(machine->createDataLayout());
   llvmModule->setTargetTriple(targetTriple);
 
+  // The optimization is skipped once the compile budget is exceeded, the
+  // unoptimized object is then not cached
+  bool const skipOptimization =
+      config.getLLVMOptLevel() > 0 &&
+      qssc::utils::shouldSkipOverBudget(controllerModule, "LLVM optimization");
+
+  // The partitions of the module are optimized by function in parallel right
+  // before their code generation, or else the whole module is optimized here
+  std::optional<llvm::OptimizationLevel> functionOptLevel;
+  if (!skipOptimization && config.getLLVMParallelFunctionOpt() &&
+      config.getLLVMCodeGenPartitions() > 1 && config.getLLVMOptLevel() > 0)
+    functionOptLevel = getOptimizationLevel(config.getLLVMOptLevel(),
+                                            config.getLLVMSizeLevel());
+
   /// Optionally run an optimization pipeline over the llvm module.
-  auto optPipeline = mlir::makeOptimizingTransformer(0, 0, nullptr);
-  if (auto err = optPipeline(llvmModule.get())) {
-    return llvm::joinErrors(
-        llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                "Failed to optimize LLVM IR"),
-        std::move(err));
+  if (!skipOptimization && !functionOptLevel) {
+    auto optPipeline = mlir::makeOptimizingTransformer(
+        config.getLLVMOptLevel(), config.getLLVMSizeLevel(), machine.get());
+    if (auto err = optPipeline(llvmModule.get())) {
+      return llvm::joinErrors(
+          llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                  "Failed to optimize LLVM IR"),
+          std::move(err));
+    }
   }
   llvmOptTimer.stop();
 
-  std::string *payloadStr = payload.getFile("llvmModule.ll");
-  llvm::raw_string_ostream llvmOStream(*payloadStr);
-  llvmOStream << *llvmModule;
+  std::string llvmIR;
+  if (payload.shouldWriteDebugArtifacts()) {
+    llvm::raw_string_ostream llvmOStream(llvmIR);
+    llvmOStream << *llvmModule;
+  }
 
   auto emitObjectFileTimer = timer.nest("build-object-file");
-  // generate machine code and emit object file
-  llvm::SmallString<128> objPath;
-  int objFd;
-  if (auto err = llvm::sys::fs::createTemporaryFile("controllerModule", "o",
-                                                    objFd, objPath)) {
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        "Failed to create temporary object file for controller module");
+  // generate machine code and emit the object file directly into memory
+  llvm::SmallVector<char, 0> objBuffer;
+  if (config.getLLVMCodeGenPartitions() > 1) {
+    if (auto err = emitPartitionedObjectFile(
+            controllerModule.getContext(), *llvmModule,
+            config.getLLVMCodeGenPartitions(), targetTriple, cpu,
+            features.getString(), *codeGenOptLevel, functionOptLevel,
+            objBuffer))
+      return err;
+  } else if (auto err = emitObjectFile(*machine, *llvmModule, objBuffer)) {
+    return err;
   }
-  auto obj = std::make_unique<llvm::ToolOutputFile>(objPath, objFd);
-  llvm::legacy::PassManager pass;
+  emitObjectFileTimer.stop();
 
-  if (machine->addPassesToEmitFile(pass, obj->os(), nullptr,
-                                   llvm::CodeGenFileType::CGFT_ObjectFile)) {
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        "Cannot emit object files with TargetMachine");
+  if (objectCache && !skipOptimization) {
+    auto storeObjectCacheTimer = timer.nest("store-object-cache");
+    if (auto err = objectCache->store(
+            objectCacheKey, encodeObjectCacheEntry(objBuffer, llvmIR)))
+      // Failing to populate the cache does not invalidate the compilation.
+      controllerModule.emitWarning()
+          << "Unable to store the controller object in the compile cache: "
+          << llvm::toString(std::move(err));
   }
-  pass.run(*llvmModule);
-  obj->os().flush();
-  emitObjectFileTimer.stop();
+
+  if (payload.shouldWriteDebugArtifacts())
+    payload.adoptFile("llvmModule.ll", std::move(llvmIR));
 
   auto emitBinaryTimer = timer.nest("emit-binary");
   // Note: an actual target will likely invoke a linker and pull in libraries to
   // generate a binary, and possibly do more postprocessing steps to create a
   // binary that can be executed on the controller
-  // include resulting file in payload
-  std::ifstream binary{objPath.c_str(), std::ios_base::binary};
+  // include resulting object in payload, handing over the buffer rather than
+  // copying it
+  payload.adoptFile("controller.bin",
+                    std::make_unique<llvm::SmallVectorMemoryBuffer>(
+                        std::move(objBuffer), "controller.bin",
+                        /*RequiresNullTerminator=*/false));
+  emitBinaryTimer.stop();
+
+  return llvm::Error::success();
 
-  if (!binary) {
+} // MockController::buildLLVMPayload
+
+llvm::Error
+MockController::emitObjectFile(llvm::TargetMachine &machine,
+                               llvm::Module &llvmModule,
+                               llvm::SmallVectorImpl<char> &objBuffer) {
+  llvm::raw_svector_ostream objOStream(objBuffer);
+  llvm::legacy::PassManager pass;
+
+  if (machine.addPassesToEmitFile(pass, objOStream, nullptr,
+                                  llvm::CodeGenFileType::CGFT_ObjectFile)) {
     return llvm::createStringError(
         llvm::inconvertibleErrorCode(),
-        "Failed top open generated controller object file" + objPath);
+        "Cannot emit object files with TargetMachine");
   }
+  pass.run(llvmModule);
 
-  /* read whole content of object file into buffer */
-  std::string binaryContents{
-      std::istreambuf_iterator<char>(binary),
-      /* eof representation */ std::istreambuf_iterator<char>()};
+  return llvm::Error::success();
+} // MockController::emitObjectFile
 
-  payload.getFile("controller.bin")->assign(std::move(binaryContents));
-  emitBinaryTimer.stop();
+namespace {
+/// Widths of the name and size fields of the member headers of ar archives
+constexpr size_t arNameFieldSize = 16;
+constexpr size_t arSizeFieldSize = 10;
+
+/// Append a member to an archive in the common ar format. The name field is
+/// written as given, e.g. "name/" or the "/offset" of a GNU long name. Symbol
+/// tables are not written as the mock controller binary is never linked.
+llvm::Error appendArchiveMember(llvm::SmallVectorImpl<char> &archive,
+                                llvm::StringRef nameField,
+                                llvm::ArrayRef<char> contents) {
+  std::string const sizeField = std::to_string(contents.size());
+  if (nameField.size() > arNameFieldSize || sizeField.size() > arSizeFieldSize)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Archive member " + nameField + " does not fit its header fields");
+
+  llvm::raw_svector_ostream os(archive);
+  // name, timestamp, owner, group, mode and size fields
+  os << llvm::left_justify(nameField, arNameFieldSize)
+     << llvm::left_justify("0", 12) << llvm::left_justify("0", 6)
+     << llvm::left_justify("0", 6) << llvm::left_justify("644", 8)
+     << llvm::left_justify(sizeField, arSizeFieldSize) << "`\n";
+  os.write(contents.data(), contents.size());
+  // Members are aligned to two bytes
+  if (contents.size() % 2)
+    os << "\n";
+  return llvm::Error::success();
+}
+} // anonymous namespace
+
+llvm::Error MockController::emitPartitionedObjectFile(
+    mlir::MLIRContext *context, llvm::Module &llvmModule, uint partitions,
+    llvm::StringRef targetTriple, llvm::StringRef cpu, llvm::StringRef features,
+    llvm::CodeGenOpt::Level optLevel,
+    std::optional<llvm::OptimizationLevel> functionOptLevel,
+    llvm::SmallVectorImpl<char> &objBuffer) {
+  // Split the module by function. The partitions are serialized to bitcode as
+  // an LLVMContext may not be used by several threads at once.
+  std::vector<llvm::SmallVector<char, 0>> partitionBitcode;
+  llvm::SplitModule(
+      llvmModule, partitions,
+      [&](std::unique_ptr<llvm::Module> partition) {
+        // Partitions without definitions produce empty objects.
+        if (llvm::all_of(partition->global_objects(),
+                         [](const llvm::GlobalObject &globalObject) {
+                           return globalObject.isDeclaration();
+                         }))
+          return;
+        llvm::raw_svector_ostream bitcodeOStream(
+            partitionBitcode.emplace_back());
+        llvm::WriteBitcodeToFile(*partition, bitcodeOStream);
+      },
+      /*PreserveLocals=*/false);
+
+  // Generate code for the partitions in parallel on the context's threadpool
+  std::vector<llvm::SmallVector<char, 0>> partitionObjects(
+      partitionBitcode.size());
+  std::mutex errorMutex;
+  llvm::Error errors = llvm::Error::success();
+  auto emitPartition = [&](size_t index) -> mlir::LogicalResult {
+    auto emit = [&]() -> llvm::Error {
+      llvm::LLVMContext partitionContext;
+      auto partition = llvm::parseBitcodeFile(
+          llvm::MemoryBufferRef(
+              llvm::StringRef(partitionBitcode[index].data(),
+                              partitionBitcode[index].size()),
+              "controller-partition"),
+          partitionContext);
+      if (auto err = partition.takeError())
+        return err;
+
+      auto machine = system->getTargetMachineCache().acquire(
+          targetTriple, cpu, features, optLevel);
+      if (auto err = machine.takeError())
+        return err;
+
+      if (functionOptLevel)
+        optimizeFunctions(**machine, **partition, *functionOptLevel);
+      return emitObjectFile(**machine, **partition, partitionObjects[index]);
+    };
+
+    if (auto err = emit()) {
+      const std::lock_guard<std::mutex> lock(errorMutex);
+      errors = llvm::joinErrors(std::move(errors), std::move(err));
+      return mlir::failure();
+    }
+    return mlir::success();
+  };
+  if (mlir::failed(mlir::failableParallelForEachN(
+          context, 0, partitionBitcode.size(), emitPartition)))
+    return errors;
+  llvm::consumeError(std::move(errors));
+
+  // Join the partitions into a single archive. The names which do not fit
+  // the name field of their header, from partition 100 on, are listed in a
+  // GNU long name table instead.
+  std::vector<std::string> nameFields;
+  std::string longNames;
+  for (size_t index = 0; index < partitionObjects.size(); ++index) {
+    std::string name = "controller." + std::to_string(index) + ".o/";
+    if (name.size() <= arNameFieldSize) {
+      nameFields.push_back(std::move(name));
+      continue;
+    }
+    nameFields.push_back("/" + std::to_string(longNames.size()));
+    longNames += name + "\n";
+  }
+
+  llvm::raw_svector_ostream(objBuffer) << "!<arch>\n";
+  if (!longNames.empty())
+    if (auto err = appendArchiveMember(
+            objBuffer, "//",
+            llvm::ArrayRef<char>(longNames.data(), longNames.size())))
+      return err;
+  for (size_t index = 0; index < partitionObjects.size(); ++index)
+    if (auto err = appendArchiveMember(objBuffer, nameFields[index],
+                                       partitionObjects[index]))
+      return err;
 
   return llvm::Error::success();
+} // MockController::emitPartitionedObjectFile
 
-} // MockController::buildLLVMPayload
+llvm::Expected<TargetMachineCache::Lease>
+TargetMachineCache::acquire(llvm::StringRef triple, llvm::StringRef cpu,
+                            llvm::StringRef features,
+                            llvm::CodeGenOpt::Level optLevel) {
+  // Initialize native LLVM target
+  static std::once_flag initializeNativeTarget;
+  std::call_once(initializeNativeTarget, [] {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmParser();
+    llvm::InitializeNativeTargetAsmPrinter();
+    llvm::InitializeAllTargetMCs();
+  });
+
+  std::string key = (triple + "\n" + cpu + "\n" + features + "\n" +
+                     llvm::Twine(static_cast<int>(optLevel)))
+                        .str();
+
+  auto release = [this, key](llvm::TargetMachine *machine) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    idleMachines[key].emplace_back(machine);
+  };
+
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto &idle = idleMachines[key];
+    if (!idle.empty()) {
+      auto *machine = idle.back().release();
+      idle.pop_back();
+      return Lease(machine, release);
+    }
+  }
+
+  std::string errorMessage;
+  const auto *target =
+      llvm::TargetRegistry::lookupTarget(triple.str(), errorMessage);
+  if (!target) {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to find target: " + errorMessage);
+  }
+
+  auto *machine =
+      target->createTargetMachine(triple.str(), cpu, features, {}, {},
+                                  /*CM=*/std::nullopt, optLevel);
+  if (!machine)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to create target machine for " +
+                                       triple);
+  return Lease(machine, release);
+} // TargetMachineCache::acquire
 
 MockAcquire::MockAcquire(std::string name, MockSystem *parent,
                          const SystemConfiguration &config, uint32_t nodeId)
     : TargetInstrument(std::move(name), parent), nodeId_(nodeId) {
 } // MockAcquire
 
-void MockAcquire::registerTargetPasses() {} // MockAcquire::registerTargetPasses
+void MockAcquire::registerTargetPasses() {
+  mlir::PassRegistration<MockAcquisitionAggregationPass>();
+} // MockAcquire::registerTargetPasses
 
 void MockAcquire::registerTargetPipelines() {
 } // MockAcquire::registerTargetPipelines
 
 llvm::Error MockAcquire::addPasses(mlir::PassManager &pm) {
+  pm.addPass(std::make_unique<MockAcquisitionAggregationPass>());
   return llvm::Error::success();
 } // MockAcquire::addPasses
 
 llvm::Error MockAcquire::emitToPayload(mlir::ModuleOp moduleOp,
                                        qssc::payload::Payload &payload) {
+  // one line per acquisition instruction, whose results are packed into a
+  // single buffer in the order of the kernels
+  auto acquisitions = collectAcquisitions(moduleOp);
+  if (!acquisitions.empty()) {
+    std::string acquisitionsStr;
+    llvm::raw_string_ostream acquisitionsOStream(acquisitionsStr);
+    acquisitionsOStream << "# acquisition start end kernels\n";
+    for (const auto &[idx, acquisition] : llvm::enumerate(acquisitions))
+      acquisitionsOStream << idx << " " << acquisition.start << " "
+                          << acquisition.end << " " << acquisition.numKernels
+                          << "\n";
+    acquisitionsOStream.flush();
+    payload.adoptFile(name + ".acquisitions", std::move(acquisitionsStr));
+  }
+
+  if (!payload.shouldWriteDebugArtifacts())
+    return llvm::Error::success();
+
   std::string mlirStr;
   llvm::raw_string_ostream mlirOStream(mlirStr);
   mlirOStream << moduleOp;
-  payload.getFile(name + ".mlir")->assign(mlirOStream.str());
+  mlirOStream.flush();
+  payload.adoptFile(name + ".mlir", std::move(mlirStr));
 
   return llvm::Error::success();
 } // MockAcquire::emitToPayload
@@ -418,10 +1110,14 @@ llvm::Error MockDrive::addPasses(mlir::PassManager &pm) {
 llvm::Error MockDrive::emitToPayload(mlir::ModuleOp moduleOp,
                                      qssc::payload::Payload &payload) {
 
+  if (!payload.shouldWriteDebugArtifacts())
+    return llvm::Error::success();
+
   std::string mlirStr;
   llvm::raw_string_ostream mlirOStream(mlirStr);
   mlirOStream << moduleOp;
-  payload.getFile(name + ".mlir")->assign(mlirOStream.str());
+  mlirOStream.flush();
+  payload.adoptFile(name + ".mlir", std::move(mlirStr));
 
   return llvm::Error::success();
 } // MockDrive::emitToPayload
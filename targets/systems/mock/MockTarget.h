@@ -1,6 +1,6 @@
 //===- MockTarget.h - Mock target info --------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,12 +23,28 @@
 #include "HAL/SystemConfiguration.h"
 #include "HAL/TargetSystem.h"
 
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
 
 #include <algorithm>
+#include <functional>
+#include <istream>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace qssc::targets::systems::mock {
 
@@ -38,35 +54,101 @@ int init();
 class MockConfig : public qssc::hal::SystemConfiguration {
 public:
   explicit MockConfig(llvm::StringRef configurationPath);
+
+  /// Load the config at configurationPath. Configs already parsed by this
+  /// process are copied and, given --mock-config-snapshot-dir, configs are
+  /// mapped from a binary snapshot written by an earlier parse, both keyed on
+  /// the hash of the config file.
+  static llvm::Expected<std::unique_ptr<MockConfig>>
+  load(llvm::StringRef configurationPath);
+
+  /// The payload of the binary snapshot of the config.
+  void writeSnapshot(llvm::raw_ostream &os) const;
+  static llvm::Expected<std::unique_ptr<MockConfig>>
+  readSnapshot(llvm::StringRef payload);
+
   uint getMultiplexingRatio() const { return multiplexing_ratio; }
+  // The routing tables are flat arrays indexed by physical qubit id or mock
+  // node id, built once from the config, so that localization looks up
+  // nodes without hashing.
   uint driveNode(uint qubitId) const { return qubitDriveMap[qubitId]; }
-  const std::vector<uint> &getDriveNodes() { return qubitDriveMap; }
+  const std::vector<uint> &getDriveNodes() const { return qubitDriveMap; }
   uint acquireNode(uint qubitId) const { return qubitAcquireMap[qubitId]; }
-  const std::vector<uint> getAcquireNodes() {
-    std::vector<uint> acquireNodes = qubitAcquireMap;
-    acquireNodes.erase(std::unique(acquireNodes.begin(), acquireNodes.end()),
-                       acquireNodes.end());
-    return acquireNodes;
-  }
-  const std::vector<int> &acquireQubits(uint nodeId) {
-    return qubitAcquireToPhysIdMap[nodeId];
+  const std::vector<uint> &getAcquireNodes() const { return acquireNodes; }
+  const std::vector<int> &acquireQubits(uint nodeId) const {
+    return nodeAcquireQubits[nodeId];
   }
+  /// Number of drive and acquire mocks. Their node ids are dense, in
+  /// [0, getNumNodes()).
+  uint getNumNodes() const { return nodeAcquireQubits.size(); }
   uint controllerNode() const { return controllerNodeId; }
-  const std::vector<int> &multiplexedQubits(uint qubitId) {
+  /// Optimization level of the LLVM IR pipeline of the controller.
+  uint getLLVMOptLevel() const { return llvmOptLevel; }
+  /// Size optimization level of the LLVM IR pipeline of the controller, 1 for
+  /// -Os and 2 for -Oz.
+  uint getLLVMSizeLevel() const { return llvmSizeLevel; }
+  /// Optimization level of LLVM code generation for the controller.
+  uint getLLVMCodeGenOptLevel() const { return llvmCodeGenOptLevel; }
+  /// Number of partitions the controller module is split into for parallel
+  /// code generation. With more than one partition controller.bin is an
+  /// archive of one object file per partition.
+  uint getLLVMCodeGenPartitions() const { return llvmCodeGenPartitions; }
+  /// Whether to optimize the partitions of the controller module in parallel
+  /// with the function simplification pipeline, right before their code
+  /// generation, rather than optimizing the whole module up front.
+  bool getLLVMParallelFunctionOpt() const { return llvmParallelFunctionOpt; }
+  const std::vector<int> &multiplexedQubits(uint qubitId) const {
     return acquireQubits(acquireNode(qubitId));
   }
 
 private:
+  MockConfig() = default;
+
+  void parse(std::istream &configStream);
+  // preprocessing of config data for use by passes
+  void buildRoutingTables();
+
+  // Set the LLVM optimization levels from one of the presets O0, O1, O2, O3
+  // and size
+  mlir::LogicalResult applyLLVMOptPreset(llvm::StringRef preset);
+
   uint controllerNodeId;
+  uint llvmOptLevel = 0;
+  uint llvmSizeLevel = 0;
+  uint llvmCodeGenOptLevel = 2;
+  uint llvmCodeGenPartitions = 1;
+  bool llvmParallelFunctionOpt = false;
   // The number of qubits attached to each acquire Mock
   uint multiplexing_ratio;
   std::vector<uint> qubitDriveMap;   // map from physId to drive NodeId
   std::vector<uint> qubitAcquireMap; // map from physId to acquire NodeId
-  // map from acquire NodeId to a list of physical Ids that
-  // this acquire node can capture from
-  std::unordered_map<uint, std::vector<int>> qubitAcquireToPhysIdMap;
+  std::vector<uint> acquireNodes;    // the acquire NodeIds in order
+  // map from NodeId to the list of physical Ids that this acquire node can
+  // capture from, empty for drive nodes
+  std::vector<std::vector<int>> nodeAcquireQubits;
 }; // class MockConfig
 
+/// @brief Thread-safe cache of initialized LLVM TargetMachines keyed on the
+/// triple, CPU, features and code generation optimization level. A
+/// TargetMachine is not safe for concurrent code generation, so machines are
+/// leased exclusively and returned to the cache for reuse once the lease is
+/// destroyed. The cache must outlive its leases.
+class TargetMachineCache {
+public:
+  using Lease = std::unique_ptr<llvm::TargetMachine,
+                                std::function<void(llvm::TargetMachine *)>>;
+
+  llvm::Expected<Lease> acquire(llvm::StringRef triple, llvm::StringRef cpu,
+                                llvm::StringRef features,
+                                llvm::CodeGenOpt::Level optLevel);
+
+private:
+  std::mutex mutex;
+  std::unordered_map<std::string,
+                     std::vector<std::unique_ptr<llvm::TargetMachine>>>
+      idleMachines;
+}; // class TargetMachineCache
+
 class MockSystem : public qssc::hal::TargetSystem {
 public:
   static constexpr auto name = "mock";
@@ -78,9 +160,14 @@ public:
   llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
                             payload::Payload &payload) override;
   auto getConfig() -> MockConfig & { return *mockConfig; }
+  /// TargetMachines shared by the instruments of this system.
+  auto getTargetMachineCache() -> TargetMachineCache & {
+    return targetMachineCache;
+  }
 
 private:
   std::unique_ptr<MockConfig> mockConfig;
+  TargetMachineCache targetMachineCache;
 }; // class MockSystem
 
 class MockController : public qssc::hal::TargetInstrument {
@@ -99,6 +186,24 @@ public:
 private:
   llvm::Error buildLLVMPayload(mlir::ModuleOp moduleOp,
                                payload::Payload &payload);
+  llvm::Error executeLLVMPayload(payload::Payload &payload);
+  llvm::Error emitObjectFile(llvm::TargetMachine &machine,
+                             llvm::Module &llvmModule,
+                             llvm::SmallVectorImpl<char> &objBuffer);
+  llvm::Error emitPartitionedObjectFile(mlir::MLIRContext *context,
+                                        llvm::Module &llvmModule,
+                                        uint partitions,
+                                        llvm::StringRef targetTriple,
+                                        llvm::StringRef cpu,
+                                        llvm::StringRef features,
+                                        llvm::CodeGenOpt::Level optLevel,
+                                        std::optional<llvm::OptimizationLevel>
+                                            functionOptLevel,
+                                        llvm::SmallVectorImpl<char> &objBuffer);
+
+  MockSystem *system;
+  // the Controller module before its lowering, when it is executed
+  mlir::OwningOpRef<mlir::ModuleOp> executionModule;
 }; // class MockController
 
 class MockAcquire : public qssc::hal::TargetInstrument {
@@ -0,0 +1,164 @@
+//===- AcquisitionAggregation.cpp - Aggregate captures ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the pass for aggregating the captures of an acquire
+//  mock which overlap in time into acquisitions
+//
+//===----------------------------------------------------------------------===//
+
+#include "AcquisitionAggregation.h"
+
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Error.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace mlir;
+using namespace qssc::targets::systems::mock;
+
+namespace {
+struct ScheduledCapture {
+  pulse::CaptureOp captureOp;
+  int64_t start;
+  int64_t end;
+};
+
+// the captures of block with a timepoint and a duration, in the order of
+// their start times and in program order among equal starts
+SmallVector<ScheduledCapture> getScheduledCaptures(Block &block) {
+  SmallVector<ScheduledCapture> captures;
+  for (auto captureOp : block.getOps<pulse::CaptureOp>()) {
+    auto timepoint =
+        pulse::PulseOpSchedulingInterface::getTimepoint(captureOp);
+    if (!timepoint.has_value())
+      continue;
+    auto durOrError = pulse::PulseOpSchedulingInterface::getDuration(
+        captureOp, nullptr /*callSequenceOp*/);
+    if (!durOrError) {
+      llvm::consumeError(durOrError.takeError());
+      continue;
+    }
+    captures.push_back({captureOp, *timepoint,
+                        *timepoint + static_cast<int64_t>(*durOrError)});
+  }
+  std::stable_sort(captures.begin(), captures.end(),
+                   [](const ScheduledCapture &a, const ScheduledCapture &b) {
+                     return a.start < b.start;
+                   });
+  return captures;
+}
+} // anonymous namespace
+
+void MockAcquisitionAggregationPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+  Builder builder(&getContext());
+  int64_t acquisitionIdx = 0;
+
+  // the captures of a sequence share its timeline, the sequences it calls
+  // have their own
+  moduleOp->walk([&](Block *block) {
+    auto captures = getScheduledCaptures(*block);
+    if (captures.empty())
+      return;
+
+    // sweep the captures by start time, a capture starting before the end
+    // of the current acquisition joins it
+    int64_t acquisitionEnd = captures.front().end;
+    int64_t resultIdx = 0;
+    ++numAcquisitions;
+    for (auto [i, capture] : llvm::enumerate(captures)) {
+      if (i != 0 && capture.start >= acquisitionEnd) {
+        ++acquisitionIdx;
+        ++numAcquisitions;
+        resultIdx = 0;
+      }
+      acquisitionEnd = std::max(acquisitionEnd, capture.end);
+      capture.captureOp->setAttr(getAcquisitionAttrName(),
+                                 builder.getI64IntegerAttr(acquisitionIdx));
+      capture.captureOp->setAttr(getResultIndexAttrName(),
+                                 builder.getI64IntegerAttr(resultIdx++));
+      ++numCaptures;
+    }
+    ++acquisitionIdx;
+  });
+} // MockAcquisitionAggregationPass::runOnOperation
+
+llvm::StringRef MockAcquisitionAggregationPass::getArgument() const {
+  return "mock-aggregate-acquisitions";
+}
+
+llvm::StringRef MockAcquisitionAggregationPass::getDescription() const {
+  return "Group the captures of an acquire mock which overlap in time into "
+         "acquisitions with a single packed result buffer";
+}
+
+llvm::StringRef MockAcquisitionAggregationPass::getName() const {
+  return "Mock Acquisition Aggregation Pass";
+}
+
+llvm::StringRef qssc::targets::systems::mock::getAcquisitionAttrName() {
+  return "mock.acquisition";
+}
+
+llvm::StringRef qssc::targets::systems::mock::getResultIndexAttrName() {
+  return "mock.result_index";
+}
+
+std::vector<MockAcquisition>
+qssc::targets::systems::mock::collectAcquisitions(ModuleOp moduleOp) {
+  std::vector<MockAcquisition> acquisitions;
+  moduleOp->walk([&](pulse::CaptureOp captureOp) {
+    auto acquisitionAttr =
+        captureOp->getAttrOfType<IntegerAttr>(getAcquisitionAttrName());
+    auto timepoint =
+        pulse::PulseOpSchedulingInterface::getTimepoint(captureOp);
+    if (!acquisitionAttr || !timepoint.has_value())
+      return;
+    auto durOrError = pulse::PulseOpSchedulingInterface::getDuration(
+        captureOp, nullptr /*callSequenceOp*/);
+    if (!durOrError) {
+      llvm::consumeError(durOrError.takeError());
+      return;
+    }
+
+    auto idx = static_cast<size_t>(acquisitionAttr.getInt());
+    if (idx >= acquisitions.size())
+      acquisitions.resize(idx + 1);
+    auto &acquisition = acquisitions[idx];
+    int64_t const end = *timepoint + static_cast<int64_t>(*durOrError);
+    if (acquisition.numKernels == 0) {
+      acquisition.start = *timepoint;
+      acquisition.end = end;
+    } else {
+      acquisition.start = std::min(acquisition.start, *timepoint);
+      acquisition.end = std::max(acquisition.end, end);
+    }
+    ++acquisition.numKernels;
+  });
+  return acquisitions;
+}
@@ -0,0 +1,78 @@
+//===- AcquisitionAggregation.h - Aggregate captures ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the pass for aggregating the captures of an acquire
+//  mock which overlap in time into acquisitions
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MOCK_ACQUISITION_AGGREGATION_H
+#define MOCK_ACQUISITION_AGGREGATION_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace qssc::targets::systems::mock {
+
+// An acquisition instruction of an acquire mock, which integrates the
+// captures overlapping in time with one kernel each and packs their results
+// into a single buffer
+struct MockAcquisition {
+  int64_t start = 0;
+  int64_t end = 0;
+  // the number of kernels and of results in the buffer
+  uint numKernels = 0;
+};
+
+// Group the scheduled captures in each block of an acquire module into
+// acquisitions of the captures overlapping in time, such that each one is
+// set up once and its results are collected with a single message. Each
+// capture is labeled with the index of its acquisition in the module and the
+// index of its result in the buffer of the acquisition, in the order of
+// their start times. Captures without a timepoint and a duration are left
+// unlabeled, as are the captures of nested sequences, whose timepoints are
+// relative to their calls.
+struct MockAcquisitionAggregationPass
+    : public mlir::PassWrapper<MockAcquisitionAggregationPass,
+                               mlir::OperationPass<mlir::ModuleOp>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numCaptures{this, "captures", "Number of captures aggregated"};
+  Statistic numAcquisitions{this, "acquisitions",
+                            "Number of acquisitions of the captures"};
+}; // struct MockAcquisitionAggregationPass
+
+// the name of the attribute holding the acquisition index of a capture
+llvm::StringRef getAcquisitionAttrName();
+// the name of the attribute holding the result index of a capture
+llvm::StringRef getResultIndexAttrName();
+
+// Collect the acquisitions of the captures labeled in moduleOp, indexed by
+// acquisition
+std::vector<MockAcquisition> collectAcquisitions(mlir::ModuleOp moduleOp);
+
+} // namespace qssc::targets::systems::mock
+
+#endif // MOCK_ACQUISITION_AGGREGATION_H
@@ -1,6 +1,6 @@
 //===- QubitLocalization.cpp - Create modules for qubit control -*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -39,25 +39,30 @@
 #include "mlir/IR/Location.h"
 #include "mlir/IR/Region.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/TypeRange.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
 #include "mlir/IR/ValueRange.h"
+#include "mlir/IR/Visitors.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LLVM.h"
+#include "mlir/Transforms/RegionUtils.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
-#include <deque>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <sys/types.h>
 #include <tuple>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -78,6 +83,13 @@ auto classicalOnlyCheck(Operation *op) -> bool {
                     << "Try running --classical-only-detection first!\n";
   return false;
 }
+
+/// Returns true if op has the classicalOnly attribute set to true, without
+/// reporting a missing attribute
+auto isClassicalOnly(Operation *op) -> bool {
+  auto classicalOnlyAttr = op->getAttrOfType<BoolAttr>("quir.classicalOnly");
+  return classicalOnlyAttr && classicalOnlyAttr.getValue();
+}
 } // end anonymous namespace
 
 // find a qubit ID from the attribute on its declaration
@@ -106,35 +118,227 @@ auto mock::MockQubitLocalizationPass::lookupQubitId(const Value &val) -> int {
   return -1;
 } // lookupQubitId
 
-/// Creates a broadcast op on Controller and recvOp on all other mocks
-/// also checks if a value *should* be broadcast
-void mock::MockQubitLocalizationPass::broadcastAndReceiveValue(
-    const Value &val, const Location &loc,
-    const std::unordered_set<uint> &toNodeIds) {
-  if (alreadyBroadcastValues.count(val) == 0) {
+/// Allocates the builder slot of a program block localized to nodeIds
+auto mock::MockQubitLocalizationPass::addSlot(MockIdSet nodeIds) -> MockSlot {
+  return {numSlots++, std::move(nodeIds)};
+} // addSlot
+
+/// Records an action of a mock, which builds its part of the op being
+/// localized with the builder of the current program block
+void mock::MockQubitLocalizationPass::addNodeAction(
+    uint nodeId,
+    std::function<void(MockNode &node, OpBuilder &builder)> action) {
+  uint const slot = currentSlot.id;
+  mockNodes[nodeId].actions.emplace_back(
+      [slot, action = std::move(action)](MockNode &node) {
+        auto search = node.builders.find(slot);
+        assert(search != node.builders.end() && "no builder for the slot");
+        action(node, *search->second);
+      });
+} // addNodeAction
+
+/// Clones op to a mock, its results are available there from atOp, by
+/// default op itself, onwards
+void mock::MockQubitLocalizationPass::cloneToNode(uint nodeId, Operation *op,
+                                                  Operation *atOp) {
+  addNodeAction(nodeId, [op](MockNode &node, OpBuilder &builder) {
+    builder.clone(*op, node.mapping);
+  });
+  for (Value const result : op->getResults())
+    markAvailable(nodeId, result, atOp ? atOp : op);
+} // cloneToNode
+
+void mock::MockQubitLocalizationPass::markAvailable(uint nodeId, Value val,
+                                                    Operation *atOp) {
+  mockNodes[nodeId].availableAt[val] = atOp;
+} // markAvailable
+
+/// Returns true if val is available on a mock at atOp, i.e. if it was made
+/// available before atOp in its block or before the op enclosing atOp
+auto mock::MockQubitLocalizationPass::isAvailable(uint nodeId, Value val,
+                                                  Operation *atOp) -> bool {
+  MockNode &node = mockNodes[nodeId];
+  auto search = node.availableAt.find(val);
+  if (search == node.availableAt.end())
+    return false;
+  Operation *fromOp = search->second;
+  Operation *ancestor = fromOp->getBlock()->findAncestorOpInBlock(*atOp);
+  return ancestor && !ancestor->isBeforeInBlock(fromOp);
+} // isAvailable
+
+/// Adds the ids of the mocks that user is localized to, and so that read
+/// its classical operands
+void mock::MockQubitLocalizationPass::addReaderNodeIds(Operation *user,
+                                                       MockIdSet &nodeIds) {
+  auto addQubitNodeIds = [&](bool withAcquireNodes) {
+    for (Value const operand : user->getOperands()) {
+      if (!operand.getType().isa<QubitType>())
+        continue;
+      int const qubitId = lookupQubitId(operand);
+      if (qubitId < 0)
+        continue;
+      nodeIds.insert(config->driveNode(qubitId));
+      if (withAcquireNodes)
+        nodeIds.insert(config->acquireNode(qubitId));
+    }
+  };
+
+  if (isa<Builtin_UOp, CallGateOp, CallDefCalGateOp>(user)) {
+    addQubitNodeIds(/*withAcquireNodes=*/false);
+  } else if (isa<CallDefcalMeasureOp>(user)) {
+    addQubitNodeIds(/*withAcquireNodes=*/true);
+  } else if (auto callOp = dyn_cast<CallSubroutineOp>(user)) {
+    Operation *funcOperation = SymbolTable::lookupSymbolIn(
+        controllerModule->getParentOp(), callOp.getCallee());
+    if (funcOperation && !isClassicalOnly(funcOperation))
+      nodeIds.insert(seenNodeIds);
+  } else if (isa<scf::IfOp, scf::ForOp>(user)) {
+    if (!isClassicalOnly(user))
+      nodeIds.insert(getEnclosingNodeIds(user));
+  } else if (isa<scf::YieldOp>(user)) {
+    if (!isClassicalOnly(user->getParentOp()))
+      nodeIds.insert(getEnclosingNodeIds(user));
+  } else if (isa<mlir::func::ReturnOp>(user)) {
+    // returns are cloned to the mocks unless the function is classical only
+    if (!isClassicalOnly(user->getParentOp()))
+      nodeIds.insert(seenNodeIds);
+  }
+} // addReaderNodeIds
+
+/// Returns the ids of the mocks that read val from fromOp onwards in its
+/// block, including the reads nested in the regions of the ops that follow
+auto mock::MockQubitLocalizationPass::getReaderNodeIds(Value val,
+                                                       Operation *fromOp)
+    -> MockIdSet {
+  MockIdSet nodeIds;
+  Block *block = fromOp->getBlock();
+  for (Operation *user : val.getUsers()) {
+    Operation *ancestor = block->findAncestorOpInBlock(*user);
+    if (!ancestor || ancestor->isBeforeInBlock(fromOp))
+      continue;
+    // classical only regions stay on the Controller
+    bool classicalOnly = false;
+    for (Operation *parentOp = user; parentOp != ancestor && !classicalOnly;) {
+      parentOp = parentOp->getParentOp();
+      classicalOnly = isClassicalOnly(parentOp);
+    }
+    if (!classicalOnly)
+      addReaderNodeIds(user, nodeIds);
+  }
+  return nodeIds;
+} // getReaderNodeIds
+
+/// Returns the mocks that an scf.if of a qcs.parallel_control_flow acts on,
+/// i.e. the drive and acquire mocks of its qubits, or std::nullopt if it may
+/// act on other mocks as well
+auto mock::MockQubitLocalizationPass::getBranchNodeIds(scf::IfOp ifOp)
+    -> std::optional<MockIdSet> {
+  MockIdSet nodeIds;
+  auto result = ifOp->walk([&](Operation *op) -> WalkResult {
+    // subroutines and qubit declarations are localized to every mock
+    if (isa<CallSubroutineOp, DeclareQubitOp>(op))
+      return WalkResult::interrupt();
+    bool hasQubits = false;
+    for (Value const operand : op->getOperands()) {
+      if (!operand.getType().isa<QubitType>())
+        continue;
+      int const qubitId = lookupQubitId(operand);
+      if (qubitId < 0)
+        return WalkResult::interrupt();
+      nodeIds.insert(config->driveNode(qubitId));
+      nodeIds.insert(config->acquireNode(qubitId));
+      hasQubits = true;
+    }
+    // delays and barriers without operands act on all qubits
+    if (isa<DelayOp, DelayCyclesOp, BarrierOp>(op) && !hasQubits)
+      return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  if (result.wasInterrupted() || nodeIds.empty())
+    return std::nullopt;
+  return nodeIds;
+} // getBranchNodeIds
+
+/// Returns the mocks of the innermost restricted scf.if that op is or is
+/// nested in, all mocks if there is none
+auto mock::MockQubitLocalizationPass::getEnclosingNodeIds(Operation *op)
+    -> const MockIdSet & {
+  for (; op; op = op->getParentOp()) {
+    auto search = branchNodeIds.find(op);
+    if (search != branchNodeIds.end())
+      return search->second;
+  }
+  return seenNodeIds;
+} // getEnclosingNodeIds
+
+/// Sends the values that op reads from Controller to the mocks which read
+/// them and do not have them yet. Each value goes to every mock that reads
+/// it later on in the block as well, and each mock receives the values in a
+/// single message. Constants are cloned to the mocks instead.
+void mock::MockQubitLocalizationPass::sendAndReceiveValues(Operation *op,
+                                                           ValueRange vals) {
+  // the values each mock receives, ordered by node id to emit the messages
+  // deterministically
+  std::map<uint, std::vector<Value>> nodeValues;
+  for (Value const val : vals) {
     Operation *parentOp = val.getDefiningOp();
-    if (parentOp) {
-      if (dyn_cast<mlir::arith::ConstantOp>(parentOp) ||
-          dyn_cast<quir::ConstantOp>(parentOp)) {
-        // Just clone this op to the mocks
-        for (uint const id : toNodeIds)
-          (*mockBuilders)[id]->clone(*parentOp, mockMapping[id]);
-      } else {
-        controllerBuilder->create<BroadcastOp>(
-            loc, controllerMapping.lookupOrNull(val));
-        for (uint const id : toNodeIds) {
-          auto recvOp = (*mockBuilders)[id]->create<RecvOp>(
-              loc, TypeRange(val.getType()),
-              controllerBuilder->getIndexArrayAttr(config->controllerNode()));
-          mockMapping[id].map(val, recvOp.getVals().front());
-        }
+    // no parentOp means it's a block argument, which must have already been
+    // sent for the call or mapped with its region
+    if (!parentOp || val.getType().isa<QubitType>())
+      continue;
+    for (uint const id : getReaderNodeIds(val, op)) {
+      if (!currentSlot.nodeIds.contains(id) || isAvailable(id, val, op))
+        continue;
+      if (isa<mlir::arith::ConstantOp, quir::ConstantOp>(parentOp)) {
+        // Just clone this op to the mock
+        cloneToNode(id, parentOp, op);
+        continue;
       }
-      alreadyBroadcastValues.insert(val);
+      std::vector<Value> &values = nodeValues[id];
+      if (!llvm::is_contained(values, val))
+        values.push_back(val);
     }
-    // else no parentOp means it's a block argument,
-    // must have already been sent for the call, do nothing
-  } // if alreadyBroadcastValues.count(val) == 0
-} // broadcastValue
+  }
+  if (nodeValues.empty())
+    return;
+
+  auto getControllerValues = [&](ArrayRef<Value> values) {
+    SmallVector<Value> controllerValues;
+    for (Value const val : values)
+      controllerValues.push_back(controllerMapping.lookupOrNull(val));
+    return controllerValues;
+  };
+
+  // broadcast the values if every mock receives the same ones, otherwise
+  // send one message to each mock
+  const std::vector<Value> &firstValues = nodeValues.begin()->second;
+  bool const broadcast =
+      nodeValues.size() == seenNodeIds.size() &&
+      llvm::all_of(nodeValues, [&](const auto &entry) {
+        return entry.second == firstValues;
+      });
+  Location const loc = op->getLoc();
+  if (broadcast)
+    controllerBuilder->create<BroadcastOp>(loc,
+                                           getControllerValues(firstValues));
+  for (const auto &entry : nodeValues) {
+    uint const id = entry.first;
+    const std::vector<Value> &values = entry.second;
+    if (!broadcast)
+      controllerBuilder->create<SendOp>(loc, getControllerValues(values),
+                                        controllerBuilder->getIndexAttr(id));
+    SmallVector<int64_t> fromIds(values.size(), config->controllerNode());
+    addNodeAction(id, [loc, values, fromIds = std::move(fromIds)](
+                          MockNode &node, OpBuilder &builder) {
+      auto recvOp = builder.create<RecvOp>(loc, TypeRange(ValueRange(values)),
+                                           builder.getIndexArrayAttr(fromIds));
+      for (auto [val, received] : llvm::zip(values, recvOp.getVals()))
+        node.mapping.map(val, received);
+    });
+    for (Value const val : values)
+      markAvailable(id, val, op);
+  }
+} // sendAndReceiveValues
 
 void mock::MockQubitLocalizationPass::cloneRegionWithoutOps(Region *from,
                                                             Region *dest,
@@ -212,11 +416,8 @@ void mock::MockQubitLocalizationPass::processOp(DeclareQubitOp &qubitOp) {
   llvm::outs() << "Localizing a " << op->getName() << "\n";
 
   // declare every qubit on each mock for multi-qubit gates purposes
-  for (auto nodeId : seenNodeIds) {
-    auto *clonedOp = (*mockBuilders)[nodeId]->clone(*op);
-    mockMapping[nodeId].map(qubitOp.getRes(),
-                            dyn_cast<DeclareQubitOp>(clonedOp).getRes());
-  }
+  for (auto nodeId : seenNodeIds)
+    cloneToNode(nodeId, op);
 } // processOp DeclareQubitOp
 
 void mock::MockQubitLocalizationPass::processOp(ResetQubitOp &resetOp) {
@@ -232,10 +433,8 @@ void mock::MockQubitLocalizationPass::processOp(ResetQubitOp &resetOp) {
     resetOp->emitOpError() << "Can't resolve qubit ID for resetOp\n";
     return signalPassFailure();
   }
-  (*mockBuilders)[config->driveNode(qubitId)]->clone(
-      *op, mockMapping[config->driveNode(qubitId)]);
-  (*mockBuilders)[config->acquireNode(qubitId)]->clone(
-      *op, mockMapping[config->acquireNode(qubitId)]);
+  cloneToNode(config->driveNode(qubitId), op);
+  cloneToNode(config->acquireNode(qubitId), op);
 } // processOp ResetQubitOp
 
 void mock::MockQubitLocalizationPass::processOp(mlir::func::FuncOp &funcOp) {
@@ -251,19 +450,16 @@ void mock::MockQubitLocalizationPass::processOp(Builtin_UOp &uOp) {
   llvm::outs() << "Localizing a " << op->getName() << "\n";
   int const qubitId = lookupQubitId(uOp.getTarget());
 
-  // broadcast all classical values from Controller to all Mockss
-  // recv all classical values on all Mockss
-  broadcastAndReceiveValue(uOp.getTheta(), op->getLoc(), seenNodeIds);
-  broadcastAndReceiveValue(uOp.getPhi(), op->getLoc(), seenNodeIds);
-  broadcastAndReceiveValue(uOp.getLambda(), op->getLoc(), seenNodeIds);
+  // send the classical values from Controller to the drive Mock
+  sendAndReceiveValues(op,
+                       {uOp.getTheta(), uOp.getPhi(), uOp.getLambda()});
 
   if (qubitId < 0) {
     uOp->emitOpError() << "Can't resolve qubit ID for uOp\n";
     return signalPassFailure();
   }
   // clone the gate call to the drive mock
-  (*mockBuilders)[config->driveNode(qubitId)]->clone(
-      *op, mockMapping[config->driveNode(qubitId)]);
+  cloneToNode(config->driveNode(qubitId), op);
 } // processOp Builtin_UOp
 
 void mock::MockQubitLocalizationPass::processOp(BuiltinCXOp &cxOp) {
@@ -277,10 +473,8 @@ void mock::MockQubitLocalizationPass::processOp(BuiltinCXOp &cxOp) {
     return signalPassFailure();
   }
   // clone the gate call to the drive mocks
-  (*mockBuilders)[config->driveNode(qubitId1)]->clone(
-      *op, mockMapping[config->driveNode(qubitId1)]);
-  (*mockBuilders)[config->driveNode(qubitId2)]->clone(
-      *op, mockMapping[config->driveNode(qubitId2)]);
+  cloneToNode(config->driveNode(qubitId1), op);
+  cloneToNode(config->driveNode(qubitId2), op);
 } // processOp BuiltinCXOp
 
 void mock::MockQubitLocalizationPass::processOp(MeasureOp &measureOp) {
@@ -289,29 +483,28 @@ void mock::MockQubitLocalizationPass::processOp(MeasureOp &measureOp) {
   // figure out which qubit this gate operates on
   int const qubitId = lookupQubitId(measureOp.getQubits().front());
   // clone the measure call to the drive and acquire mocks
-  (*mockBuilders)[config->driveNode(qubitId)]->clone(
-      *op, mockMapping[config->driveNode(qubitId)]);
-  Operation *clonedOp = (*mockBuilders)[config->acquireNode(qubitId)]->clone(
-      *op, mockMapping[config->acquireNode(qubitId)]);
-  auto clonedMeasureOp = dyn_cast<MeasureOp>(clonedOp);
+  cloneToNode(config->driveNode(qubitId), op);
+  cloneToNode(config->acquireNode(qubitId), op);
 
   // send the results from the acquire mock and recv on Controller
-  (*mockBuilders)[config->acquireNode(qubitId)]->create<SendOp>(
-      op->getLoc(), clonedMeasureOp.getOuts().front(),
-      controllerBuilder->getIndexAttr(config->controllerNode()));
+  Location const loc = op->getLoc();
+  Value const result = measureOp.getOuts().front();
+  uint const controllerNodeId = config->controllerNode();
+  addNodeAction(
+      config->acquireNode(qubitId),
+      [loc, result, controllerNodeId](MockNode &node, OpBuilder &builder) {
+        builder.create<SendOp>(loc, node.mapping.lookup(result),
+                               builder.getIndexAttr(controllerNodeId));
+      });
   auto recvOp = controllerBuilder->create<RecvOp>(
-      op->getLoc(), TypeRange(clonedMeasureOp.getOuts().front().getType()),
+      op->getLoc(), TypeRange(measureOp.getOuts().front().getType()),
       controllerBuilder->getIndexArrayAttr(qubitId));
   // map the result on Controller
   controllerMapping.map(measureOp.getOuts().front(), recvOp.getVals().front());
 } // processOp MeasureOp
 
 void mock::MockQubitLocalizationPass::processOp(
-    CallSubroutineOp &callOp,
-    std::deque<
-        std::tuple<Block *, OpBuilder *,
-                   std::unique_ptr<std::unordered_map<uint, OpBuilder *>>>>
-        &blockAndBuilderWorkList) {
+    CallSubroutineOp &callOp, BlockWorkList &blockAndBuilderWorkList) {
   Operation *op = callOp.getOperation();
   llvm::outs() << "Localizing a " << op->getName() << "\n";
 
@@ -330,17 +523,13 @@ void mock::MockQubitLocalizationPass::processOp(
   bool const onlyToController = classicalOnlyCheck(funcOperation);
 
   if (!onlyToController) {
-    // broadcast all classical values from Controller to all Mockss
+    // send all classical values from Controller to all Mockss
     // recv all classical values on all Mockss
-    for (auto arg : op->getOperands()) {
-      if (!arg.getType().dyn_cast<QubitType>()) {
-        broadcastAndReceiveValue(arg, op->getLoc(), seenNodeIds);
-      } // if not QubitType
-    }   // for operands
+    sendAndReceiveValues(op, op->getOperands());
 
     // Clone the subroutine call to all drive and acquire mocks
     for (uint const nodeId : seenNodeIds) {
-      (*mockBuilders)[nodeId]->clone(*op, mockMapping[nodeId]);
+      cloneToNode(nodeId, op);
     } // for nodeId in seenNodeIds
   }   // if !onlyToController
 
@@ -351,8 +540,12 @@ void mock::MockQubitLocalizationPass::processOp(
     llvm::outs() << callOp.getCallee() << " has already been cloned!\n";
     return;
   }
-  OpBuilder::InsertPoint savedPoint = controllerBuilder->saveInsertionPoint();
-  auto newBuilders = std::make_unique<std::unordered_map<uint, OpBuilder *>>();
+  OpBuilder::InsertPoint const savedPoint =
+      controllerBuilder->saveInsertionPoint();
+  MockIdSet newNodeIds;
+  if (!onlyToController)
+    newNodeIds = seenNodeIds;
+  MockSlot newSlot = addSlot(std::move(newNodeIds));
   controllerBuilder->setInsertionPointToStart(controllerModule.getBody());
   Operation *clonedFuncOperation =
       controllerBuilder->cloneWithoutRegions(*funcOperation, controllerMapping);
@@ -362,26 +555,25 @@ void mock::MockQubitLocalizationPass::processOp(
                           controllerMapping);
   }
   controllerBuilder->restoreInsertionPoint(savedPoint);
-  if (!onlyToController) {
-    for (uint const nodeId : seenNodeIds) {
-      savedPoint = (*mockBuilders)[nodeId]->saveInsertionPoint();
-      (*mockBuilders)[nodeId]->setInsertionPointToStart(
-          dyn_cast<ModuleOp>(mockModules[nodeId]).getBody());
+  for (uint const nodeId : newSlot.nodeIds) {
+    addNodeAction(nodeId, [this, funcOp, slot = newSlot.id](
+                              MockNode &node, OpBuilder &) mutable {
+      OpBuilder moduleBuilder =
+          OpBuilder::atBlockBegin(cast<ModuleOp>(node.module).getBody());
       Operation *clonedFuncOperation =
-          (*mockBuilders)[nodeId]->cloneWithoutRegions(*funcOperation,
-                                                       mockMapping[nodeId]);
+          moduleBuilder.cloneWithoutRegions(*funcOp, node.mapping);
       auto clonedFuncOp = dyn_cast<mlir::func::FuncOp>(clonedFuncOperation);
       if (funcOp.getCallableRegion()) {
         cloneRegionWithoutOps(&funcOp.getBody(), &clonedFuncOp.getBody(),
-                              mockMapping[nodeId]);
+                              node.mapping);
       }
-      newBuilders->emplace(nodeId, new OpBuilder(&clonedFuncOp.getBody()));
-      (*mockBuilders)[nodeId]->restoreInsertionPoint(savedPoint);
-    } // for nodeId in seenNodeIds
-  }   // if !onlyToController
-  blockAndBuilderWorkList.emplace_back(&funcOp.getBody().getBlocks().front(),
-                                       new OpBuilder(&clonedFuncOp.getBody()),
-                                       std::move(newBuilders));
+      node.builders[slot] =
+          std::make_unique<OpBuilder>(&clonedFuncOp.getBody());
+    });
+  } // for nodeId in newSlot.nodeIds
+  blockAndBuilderWorkList.emplace_back(
+      &funcOp.getBody().getBlocks().front(),
+      arena.create<OpBuilder>(&clonedFuncOp.getBody()), std::move(newSlot));
 } // processOp CallSubroutineOp
 
 void mock::MockQubitLocalizationPass::processOp(CallGateOp &callOp) {
@@ -407,16 +599,13 @@ void mock::MockQubitLocalizationPass::processOp(CallGateOp &callOp) {
     return signalPassFailure();
   }
 
-  // broadcast all classical values from Controller to all Mockss
-  // recv all classical values on all Mockss
-  for (Value const val : classicalVals) {
-    broadcastAndReceiveValue(val, op->getLoc(), seenNodeIds);
-  } // for val in classicalVals
+  // send the classical values from Controller to the drive Mockss
+  // recv the classical values on the drive Mockss
+  sendAndReceiveValues(op, classicalVals);
 
   // Clone the gate call to all relevant drive mocks
   for (uint const qubitId : qInd) {
-    (*mockBuilders)[config->driveNode(qubitId)]->clone(
-        *op, mockMapping[config->driveNode(qubitId)]);
+    cloneToNode(config->driveNode(qubitId), op);
   } // for qubitId in qInd
 } // processOp CallGateOp
 
@@ -444,8 +633,7 @@ void mock::MockQubitLocalizationPass::processOp(BarrierOp &barrierOp) {
 
   // Clone the gate call to all relevant drive
   for (uint const qubitId : qubits) {
-    (*mockBuilders)[config->driveNode(qubitId)]->clone(
-        *op, mockMapping[config->driveNode(qubitId)]);
+    cloneToNode(config->driveNode(qubitId), op);
   } // for qubitId in qInd
 
 } // processOp BarrierOp
@@ -473,15 +661,13 @@ void mock::MockQubitLocalizationPass::processOp(CallDefCalGateOp &callOp) {
     return signalPassFailure();
   }
 
-  // send all classical values from Controller to all Mockss
-  // recv all classical values on all drive Mockss
-  for (Value const val : classicalVals)
-    broadcastAndReceiveValue(val, op->getLoc(), seenNodeIds);
+  // send the classical values from Controller to the drive Mockss
+  // recv the classical values on the drive Mockss
+  sendAndReceiveValues(op, classicalVals);
 
   // Clone the gate call to all relevant drive mocks
   for (uint const qubitId : qInd) {
-    (*mockBuilders)[config->driveNode(qubitId)]->clone(
-        *op, mockMapping[config->driveNode(qubitId)]);
+    cloneToNode(config->driveNode(qubitId), op);
   } // for qubitId in qInd
 } // processOp CallDefCalGateOp
 
@@ -509,26 +695,28 @@ void mock::MockQubitLocalizationPass::processOp(CallDefcalMeasureOp &callOp) {
     return signalPassFailure();
   }
 
-  // send all classical values from Controller to all Mockss
-  // recv all classical values on all drive Mockss
-  for (Value const val : classicalVals)
-    broadcastAndReceiveValue(val, op->getLoc(), seenNodeIds);
+  // send the classical values from Controller to the drive and acquire
+  // Mockss, recv the classical values on the drive and acquire Mockss
+  sendAndReceiveValues(op, classicalVals);
 
+  Location const loc = op->getLoc();
+  Value const result = callOp.getRes();
+  uint const controllerNodeId = config->controllerNode();
   for (uint const qubitId : qInd) {
     // Clone the measure call to all drive and acquire mocks
-    (*mockBuilders)[config->driveNode(qubitId)]->clone(
-        *op, mockMapping[config->driveNode(qubitId)]);
-    Operation *acquireOperation =
-        (*mockBuilders)[config->acquireNode(qubitId)]->clone(
-            *op, mockMapping[config->acquireNode(qubitId)]);
-    auto acquireOp = dyn_cast<CallDefcalMeasureOp>(acquireOperation);
+    cloneToNode(config->driveNode(qubitId), op);
+    cloneToNode(config->acquireNode(qubitId), op);
 
     // Send the measured value back to Controller and receive it on Controller
-    (*mockBuilders)[config->acquireNode(qubitId)]->create<SendOp>(
-        op->getLoc(), acquireOp.getRes(),
-        controllerBuilder->getIndexAttr(config->controllerNode()));
+    addNodeAction(config->acquireNode(qubitId),
+                  [loc, result, controllerNodeId](MockNode &node,
+                                                  OpBuilder &builder) {
+                    builder.create<SendOp>(
+                        loc, node.mapping.lookup(result),
+                        builder.getIndexAttr(controllerNodeId));
+                  });
     auto recvOp = controllerBuilder->create<RecvOp>(
-        op->getLoc(), TypeRange(acquireOp.getRes().getType()),
+        op->getLoc(), TypeRange(result.getType()),
         controllerBuilder->getIndexArrayAttr(qubitId));
     controllerMapping.map(callOp.getRes(), recvOp.getVals().front());
   }
@@ -553,55 +741,47 @@ void mock::MockQubitLocalizationPass::processOp(DelayOpType &delayOp) {
       qInd.emplace_back((int)qId);
 
   // turn the vector of qubitIds into a set of node Ids
-  std::unordered_set<uint> involvedNodes;
+  MockIdSet involvedNodes;
   for (int const qubitId : qInd) {
-    involvedNodes.emplace(config->driveNode(qubitId));
-    involvedNodes.emplace(config->acquireNode(qubitId));
+    involvedNodes.insert(config->driveNode(qubitId));
+    involvedNodes.insert(config->acquireNode(qubitId));
   }
 
   if (auto dOp = dyn_cast<DelayOp>(op)) {
     auto *durationDeclare = dOp.getTime().getDefiningOp();
     for (uint const id : involvedNodes)
-      (*mockBuilders)[id]->clone(*durationDeclare, mockMapping[id]);
+      cloneToNode(id, durationDeclare, op);
   }
 
   if (delayOp.getQubits().empty())
     controllerBuilder->clone(*op, controllerMapping);
   // clone the delay op to the involved nodes
   for (uint const nodeId : involvedNodes)
-    (*mockBuilders)[nodeId]->clone(*op, mockMapping[nodeId]);
+    cloneToNode(nodeId, op);
 } // processOp DelayOp
 
 void mock::MockQubitLocalizationPass::processOp(
     mlir::func::ReturnOp &returnOp) {
   Operation *op = returnOp.getOperation();
+  sendAndReceiveValues(op, returnOp.getOperands());
   controllerBuilder->clone(*op, controllerMapping);
-  FlatSymbolRefAttr const symbolRef = SymbolRefAttr::get(op->getParentOp());
-  if (symbolRef && symbolRef.getLeafReference() == "main")
-    for (auto arg : returnOp.getOperands())
-      broadcastAndReceiveValue(arg, op->getLoc(), seenNodeIds);
   if (!classicalOnlyCheck(op->getParentOp()))
     for (uint const nodeId : seenNodeIds)
-      (*mockBuilders)[nodeId]->clone(*op, mockMapping[nodeId]);
+      cloneToNode(nodeId, op);
 } // processOp ReturnOp
 
 void mock::MockQubitLocalizationPass::processOp(scf::YieldOp &yieldOp) {
   Operation *op = yieldOp.getOperation();
-  for (auto arg : yieldOp.getResults())
-    broadcastAndReceiveValue(arg, op->getLoc(), seenNodeIds);
+  sendAndReceiveValues(op, yieldOp.getResults());
   // copy op to all nodes
   controllerBuilder->clone(*op, controllerMapping);
   if (!classicalOnlyCheck(op->getParentOp()))
-    for (auto nodeId : seenNodeIds)
-      (*mockBuilders)[nodeId]->clone(*op, mockMapping[nodeId]);
+    for (auto nodeId : currentSlot.nodeIds)
+      cloneToNode(nodeId, op);
 } // processOp YieldOp
 
 void mock::MockQubitLocalizationPass::processOp(
-    scf::IfOp &ifOp,
-    std::deque<
-        std::tuple<Block *, OpBuilder *,
-                   std::unique_ptr<std::unordered_map<uint, OpBuilder *>>>>
-        &blockAndBuilderWorkList) {
+    scf::IfOp &ifOp, BlockWorkList &blockAndBuilderWorkList) {
   Operation *op = ifOp.getOperation();
   llvm::outs() << "Localizing an " << op->getName()
                << " operation, recursing into subregions\n";
@@ -613,39 +793,48 @@ void mock::MockQubitLocalizationPass::processOp(
   }
 
   llvm::outs() << "Found a quantum ifOp!\n";
-  // first broadcast the condition value from Controller to Mockss
+  // the branches of a qcs.parallel_control_flow only go to the mocks of
+  // their qubits, any other if goes to the mocks of its block
+  auto search = branchNodeIds.find(op);
+  const MockIdSet &nodeIds =
+      search != branchNodeIds.end() ? search->second : currentSlot.nodeIds;
+
+  // first send the condition value from Controller to Mockss
   // then clone the if op everywhere but with empty blocks
-  auto newThenBuilders =
-      std::make_unique<std::unordered_map<uint, OpBuilder *>>();
-  auto newElseBuilders =
-      std::make_unique<std::unordered_map<uint, OpBuilder *>>();
+  MockSlot thenSlot = addSlot(nodeIds);
+  MockSlot elseSlot = addSlot(nodeIds);
 
   // check if the condition is the result of a single measurement
   auto measureOp = ifOp.getCondition().getDefiningOp<MeasureOp>();
   int savedQubitId = -1;
-  if (measureOp) { // remove the drive node from seenNodeIds temporarily
-    // only if it can be resolved
+  if (measureOp) { // only if it can be resolved
     savedQubitId = lookupQubitId(measureOp.getQubits().front());
-    if (savedQubitId >= 0) {
-      seenNodeIds.erase(config->driveNode(savedQubitId));
-
-      // receive the measurement result directly from the acquireNode
-      auto recvOp =
-          (*mockBuilders)[config->driveNode(savedQubitId)]->create<RecvOp>(
-              measureOp->getLoc(), TypeRange(ifOp.getCondition().getType()),
-              controllerBuilder->getIndexArrayAttr(
-                  config->acquireNode(savedQubitId)));
-      // map the result on the drive node
-      mockMapping[config->driveNode(savedQubitId)].map(
-          ifOp.getCondition(), recvOp.getVals().front());
+    if (savedQubitId >= 0 &&
+        nodeIds.contains(config->driveNode(savedQubitId))) {
+      // receive the measurement result directly from the acquireNode, the
+      // drive node then needs no message from Controller
+      uint const driveNodeId = config->driveNode(savedQubitId);
+      SmallVector<int64_t> const fromIds = {config->acquireNode(savedQubitId)};
+      Location const loc = measureOp->getLoc();
+      Value const condition = ifOp.getCondition();
+      addNodeAction(driveNodeId, [loc, condition, fromIds](
+                                     MockNode &node, OpBuilder &builder) {
+        auto recvOp =
+            builder.create<RecvOp>(loc, TypeRange(condition.getType()),
+                                   builder.getIndexArrayAttr(fromIds));
+        // map the result on the drive node
+        node.mapping.map(condition, recvOp.getVals().front());
+      });
+      markAvailable(driveNodeId, ifOp.getCondition(), op);
     }
   }
 
-  broadcastAndReceiveValue(ifOp.getCondition(), op->getLoc(), seenNodeIds);
-
-  // now restore the erased drive node id
-  if (measureOp && savedQubitId != -1)
-    seenNodeIds.emplace(config->driveNode(savedQubitId));
+  // send the condition and the values read in the regions before entering
+  // them, each to the Mockss which read it
+  llvm::SetVector<Value> liveInVals;
+  liveInVals.insert(ifOp.getCondition());
+  getUsedValuesDefinedAbove(op->getRegions(), liveInVals);
+  sendAndReceiveValues(op, liveInVals.getArrayRef());
 
   Operation *clonedOp =
       controllerBuilder->cloneWithoutRegions(*op, controllerMapping);
@@ -658,43 +847,45 @@ void mock::MockQubitLocalizationPass::processOp(
     cloneRegionWithoutOps(&ifOp.getElseRegion(), &clonedIfOp.getElseRegion(),
                           controllerMapping);
   }
-  for (uint const nodeId : seenNodeIds) {
-    Operation *clonedOp =
-        (*mockBuilders)[nodeId]->cloneWithoutRegions(*op, mockMapping[nodeId]);
-    auto clonedIfOp = dyn_cast<scf::IfOp>(clonedOp);
-    if (!ifOp.getThenRegion().empty()) {
-      cloneRegionWithoutOps(&ifOp.getThenRegion(), &clonedIfOp.getThenRegion(),
-                            mockMapping[nodeId]);
-      newThenBuilders->emplace(nodeId,
-                               new OpBuilder(clonedIfOp.getThenRegion()));
-    }
-    if (!ifOp.getElseRegion().empty()) {
-      cloneRegionWithoutOps(&ifOp.getElseRegion(), &clonedIfOp.getElseRegion(),
-                            mockMapping[nodeId]);
-      newElseBuilders->emplace(nodeId,
-                               new OpBuilder(clonedIfOp.getElseRegion()));
-    }
-  } // for nodeId : seenNodeIds
+  for (uint const nodeId : nodeIds) {
+    addNodeAction(nodeId, [this, ifOp, thenSlotId = thenSlot.id,
+                           elseSlotId = elseSlot.id](
+                              MockNode &node, OpBuilder &builder) mutable {
+      Operation *clonedOp =
+          builder.cloneWithoutRegions(*ifOp.getOperation(), node.mapping);
+      auto clonedIfOp = dyn_cast<scf::IfOp>(clonedOp);
+      if (!ifOp.getThenRegion().empty()) {
+        cloneRegionWithoutOps(&ifOp.getThenRegion(),
+                              &clonedIfOp.getThenRegion(), node.mapping);
+        node.builders[thenSlotId] =
+            std::make_unique<OpBuilder>(clonedIfOp.getThenRegion());
+      }
+      if (!ifOp.getElseRegion().empty()) {
+        cloneRegionWithoutOps(&ifOp.getElseRegion(),
+                              &clonedIfOp.getElseRegion(), node.mapping);
+        node.builders[elseSlotId] =
+            std::make_unique<OpBuilder>(clonedIfOp.getElseRegion());
+      }
+    });
+  } // for nodeId : nodeIds
   if (!ifOp.getThenRegion().empty()) {
     llvm::outs() << "Pushing onto blockAndBuilderWorkList! Then region\n";
     blockAndBuilderWorkList.emplace_back(
         &ifOp.getThenRegion().getBlocks().front(),
-        new OpBuilder(clonedIfOp.getThenRegion()), std::move(newThenBuilders));
+        arena.create<OpBuilder>(clonedIfOp.getThenRegion()),
+        std::move(thenSlot));
   }
   if (!ifOp.getElseRegion().empty()) {
     llvm::outs() << "Pushing onto blockAndBuilderWorkList! Else region\n";
     blockAndBuilderWorkList.emplace_back(
         &ifOp.getElseRegion().getBlocks().front(),
-        new OpBuilder(clonedIfOp.getElseRegion()), std::move(newElseBuilders));
+        arena.create<OpBuilder>(clonedIfOp.getElseRegion()),
+        std::move(elseSlot));
   }
 } // processOp scf::IfOp
 
 void mock::MockQubitLocalizationPass::processOp(
-    scf::ForOp &forOp,
-    std::deque<
-        std::tuple<Block *, OpBuilder *,
-                   std::unique_ptr<std::unordered_map<uint, OpBuilder *>>>>
-        &blockAndBuilderWorkList) {
+    scf::ForOp &forOp, BlockWorkList &blockAndBuilderWorkList) {
   Operation *op = forOp.getOperation();
 
   llvm::outs() << "Localizing an " << op->getName()
@@ -704,36 +895,114 @@ void mock::MockQubitLocalizationPass::processOp(
     controllerBuilder->clone(*op, controllerMapping);
   } else { // else some quantum ops
     llvm::outs() << "Found a quantum forOp!\n";
-    // first broadcast the lb, ub, step, and init args
-    // from Controller to Mockss then clone the for op everywhere
-    // but with empty blocks
-    auto newBuilders =
-        std::make_unique<std::unordered_map<uint, OpBuilder *>>();
-    broadcastAndReceiveValue(forOp.getLowerBound(), op->getLoc(), seenNodeIds);
-    broadcastAndReceiveValue(forOp.getUpperBound(), op->getLoc(), seenNodeIds);
-    broadcastAndReceiveValue(forOp.getStep(), op->getLoc(), seenNodeIds);
-    for (auto arg : forOp.getInitArgs())
-      broadcastAndReceiveValue(arg, op->getLoc(), seenNodeIds);
+    // first send the lb, ub, step, init args and the values read in the
+    // body from Controller to the Mockss which read them, then clone the for
+    // op everywhere but with empty blocks
+    MockSlot bodySlot = addSlot(currentSlot.nodeIds);
+    llvm::SetVector<Value> liveInVals;
+    liveInVals.insert(forOp.getLowerBound());
+    liveInVals.insert(forOp.getUpperBound());
+    liveInVals.insert(forOp.getStep());
+    liveInVals.insert(forOp.getInitArgs().begin(), forOp.getInitArgs().end());
+    getUsedValuesDefinedAbove(op->getRegions(), liveInVals);
+    sendAndReceiveValues(op, liveInVals.getArrayRef());
 
     Operation *clonedOp =
         controllerBuilder->cloneWithoutRegions(*op, controllerMapping);
     auto clonedForOp = dyn_cast<scf::ForOp>(clonedOp);
     cloneRegionWithoutOps(&forOp.getLoopBody(), &clonedForOp.getLoopBody(),
                           controllerMapping);
-    for (uint const nodeId : seenNodeIds) {
-      Operation *clonedOp = (*mockBuilders)[nodeId]->cloneWithoutRegions(
-          *op, mockMapping[nodeId]);
-      auto clonedFor = dyn_cast<scf::ForOp>(clonedOp);
-      cloneRegionWithoutOps(&forOp.getLoopBody(), &clonedFor.getLoopBody(),
-                            mockMapping[nodeId]);
-      newBuilders->emplace(nodeId, new OpBuilder(clonedFor.getLoopBody()));
-    } // for nodeId : seenNodeIds
+    for (uint const nodeId : bodySlot.nodeIds) {
+      addNodeAction(nodeId, [this, forOp, bodySlotId = bodySlot.id](
+                                MockNode &node, OpBuilder &builder) mutable {
+        Operation *clonedOp =
+            builder.cloneWithoutRegions(*forOp.getOperation(), node.mapping);
+        auto clonedFor = dyn_cast<scf::ForOp>(clonedOp);
+        cloneRegionWithoutOps(&forOp.getLoopBody(), &clonedFor.getLoopBody(),
+                              node.mapping);
+        node.builders[bodySlotId] =
+            std::make_unique<OpBuilder>(clonedFor.getLoopBody());
+      });
+    } // for nodeId : bodySlot.nodeIds
     blockAndBuilderWorkList.emplace_back(
         &forOp.getLoopBody().getBlocks().front(),
-        new OpBuilder(clonedForOp.getLoopBody()), std::move(newBuilders));
+        arena.create<OpBuilder>(clonedForOp.getLoopBody()),
+        std::move(bodySlot));
   } // else some quantum ops
 } // processOp scf::ForOp
 
+void mock::MockQubitLocalizationPass::processOp(
+    ParallelControlFlowOp &parallelOp,
+    BlockWorkList &blockAndBuilderWorkList) {
+  Operation *op = parallelOp.getOperation();
+  llvm::outs() << "Localizing a " << op->getName() << "\n";
+
+  // the branch ops run concurrently on Controller, where they are localized
+  // into a copy of the parallel op, while each mock only runs the branch ops
+  // it takes part in
+  Location const loc = op->getLoc();
+  auto clonedOp = controllerBuilder->create<ParallelControlFlowOp>(loc);
+  ParallelControlFlowOp::ensureTerminator(clonedOp.getRegion(),
+                                          *controllerBuilder, loc);
+  OpBuilder bodyBuilder(clonedOp.getRegion().front().getTerminator());
+  OpBuilder *blockBuilder = controllerBuilder;
+  controllerBuilder = &bodyBuilder;
+  for (Operation &bodyOp :
+       parallelOp.getRegion().front().without_terminator())
+    localizeOp(bodyOp, blockAndBuilderWorkList);
+  controllerBuilder = blockBuilder;
+} // processOp ParallelControlFlowOp
+
+/// Localizes an op of the program block being localized
+void mock::MockQubitLocalizationPass::localizeOp(
+    Operation &op, BlockWorkList &blockAndBuilderWorkList) {
+  if (auto qubitOp = dyn_cast<DeclareQubitOp>(op)) {
+    processOp(qubitOp);
+  } else if (auto resetOp = dyn_cast<ResetQubitOp>(op)) {
+    processOp(resetOp);
+  } else if (auto uOp = dyn_cast<Builtin_UOp>(op)) {
+    processOp(uOp);
+  } else if (auto cxOp = dyn_cast<BuiltinCXOp>(op)) {
+    processOp(cxOp);
+  } else if (auto measureOp = dyn_cast<MeasureOp>(op)) {
+    processOp(measureOp);
+  } else if (auto callOp = dyn_cast<CallSubroutineOp>(op)) {
+    processOp(callOp, blockAndBuilderWorkList);
+  } else if (auto callOp = dyn_cast<CallGateOp>(op)) {
+    processOp(callOp);
+  } else if (auto callOp = dyn_cast<BarrierOp>(op)) {
+    processOp(callOp);
+  } else if (auto callOp = dyn_cast<CallDefCalGateOp>(op)) {
+    processOp(callOp);
+  } else if (auto callOp = dyn_cast<CallDefcalMeasureOp>(op)) {
+    processOp(callOp);
+  } else if (auto delayOp = dyn_cast<DelayOp>(op)) {
+    processOp(delayOp);
+  } else if (auto delayOp = dyn_cast<DelayCyclesOp>(op)) {
+    processOp(delayOp);
+  } else if (auto returnOp = dyn_cast<mlir::func::ReturnOp>(op)) {
+    processOp(returnOp);
+  } else if (auto yieldOp = dyn_cast<scf::YieldOp>(op)) {
+    processOp(yieldOp);
+  } else if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
+    processOp(ifOp, blockAndBuilderWorkList);
+  } else if (auto forOp = dyn_cast<scf::ForOp>(op)) {
+    processOp(forOp, blockAndBuilderWorkList);
+  } else if (auto parallelOp = dyn_cast<ParallelControlFlowOp>(op)) {
+    processOp(parallelOp, blockAndBuilderWorkList);
+  } else if (dyn_cast<mlir::func::FuncOp>(op) || dyn_cast<ModuleOp>(op)) {
+    // do nothing
+  }      // moduleOp
+  else { // some classical op, should go to Controller
+    auto *clonedOp = controllerBuilder->clone(op, controllerMapping);
+    // now add mappping for all results from the original op to the
+    // clonedOp
+    for (uint index = 0; index < op.getNumResults(); ++index) {
+      controllerMapping.map(op.getResult(index), clonedOp->getResult(index));
+    }
+  } // some classical op
+} // localizeOp
+
 // Entry point for the pass.
 void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
   // This pass is only called on the top-level module Op
@@ -752,24 +1021,40 @@ void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
     return signalPassFailure();
   }
 
+  seenQubitIds = MockIdSet(config->getNumQubits());
+  driveNodeIds = acquireNodeIds = seenNodeIds =
+      MockIdSet(config->getNumNodes());
   mainFunc->walk([&](DeclareQubitOp qubitOp) {
     llvm::outs() << qubitOp.getOperation()->getName()
                  << " id: " << qubitOp.getId() << "\n";
+    // the routing tables of the config are indexed by qubit id
     if (!qubitOp.getId().has_value() ||
-        qubitOp.getId().value() > config->getNumQubits()) {
+        qubitOp.getId().value() >= config->getNumQubits()) {
       qubitOp->emitOpError()
-          << "Error! Found a qubit without an ID or with ID > "
+          << "Error! Found a qubit without an ID or with ID >= "
           << std::to_string(config->getNumQubits())
           << " (the number of qubits in the config)"
           << " during qubit localization!\n";
-      signalPassFailure();
+      return signalPassFailure();
     }
     uint const qId = qubitOp.getId().value();
-    seenQubitIds.emplace(qId);
-    driveNodeIds.emplace(config->driveNode(qId));
-    acquireNodeIds.emplace(config->acquireNode(qId));
-    seenNodeIds.emplace(config->driveNode(qId));
-    seenNodeIds.emplace(config->acquireNode(qId));
+    seenQubitIds.insert(qId);
+    driveNodeIds.insert(config->driveNode(qId));
+    acquireNodeIds.insert(config->acquireNode(qId));
+    seenNodeIds.insert(config->driveNode(qId));
+    seenNodeIds.insert(config->acquireNode(qId));
+  });
+
+  // restrict the branch ops of each qcs.parallel_control_flow to the mocks
+  // of their qubits
+  branchNodeIds.clear();
+  moduleOp->walk([&](ParallelControlFlowOp parallelOp) {
+    for (auto ifOp : parallelOp.getRegion().front().getOps<scf::IfOp>()) {
+      if (isClassicalOnly(ifOp))
+        continue;
+      if (auto nodeIds = getBranchNodeIds(ifOp))
+        branchNodeIds[ifOp] = std::move(nodeIds.value());
+    }
   });
 
   // Initialize the Controller Module
@@ -780,7 +1065,7 @@ void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
           .getOperation());
   mlir::func::FuncOp controllerMainOp =
       addMainFunction(controllerModule.getOperation(), mainFunc->getLoc());
-  controllerBuilder = new OpBuilder(controllerMainOp.getBody());
+  controllerBuilder = arena.create<OpBuilder>(controllerMainOp.getBody());
   controllerModule->setAttr(
       llvm::StringRef("quir.nodeId"),
       controllerBuilder->getUI32IntegerAttr(config->controllerNode()));
@@ -790,16 +1075,17 @@ void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
 
   // first work on creating the modules
   // We do this first so that we can detect all physical qubit declarations
-  auto newBuilders = std::make_unique<std::unordered_map<uint, OpBuilder *>>();
+  mockNodes.clear();
+  mockNodes.resize(config->getNumNodes());
+  numSlots = 0;
+  MockSlot mainSlot = addSlot(seenNodeIds);
 
   for (const auto &result : llvm::enumerate(config->getDriveNodes())) {
     uint const qubitIdx = result.index();
     uint const nodeId = result.value();
 
     // Only populate used nodes
-    bool isUnused = false;
-    if (seenNodeIds.find(nodeId) == seenNodeIds.end())
-      isUnused = true;
+    bool const isUnused = !seenNodeIds.contains(nodeId);
 
     llvm::outs() << "Creating module for drive Mocks " << qubitIdx << "\n";
     auto driveMod = b.create<ModuleOp>(
@@ -814,10 +1100,11 @@ void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
     driveMod.getOperation()->setAttr(
         llvm::StringRef("quir.physicalId"),
         controllerBuilder->getI32IntegerAttr(qubitIdx));
-    mockModules[nodeId] = driveMod.getOperation();
+    mockNodes[nodeId].module = driveMod.getOperation();
     mlir::func::FuncOp mockMainOp = addMainFunction(
         driveMod.getOperation(), mainFunc->getLoc(), /*addReturn=*/isUnused);
-    newBuilders->emplace(nodeId, new OpBuilder(mockMainOp.getBody()));
+    mockNodes[nodeId].builders[mainSlot.id] =
+        std::make_unique<OpBuilder>(mockMainOp.getBody());
   }
 
   for (const auto &result : llvm::enumerate(config->getAcquireNodes())) {
@@ -825,9 +1112,7 @@ void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
     uint const nodeId = result.value();
 
     // Only populate used nodes
-    bool isUnused = false;
-    if (seenNodeIds.find(nodeId) == seenNodeIds.end())
-      isUnused = true;
+    bool const isUnused = !seenNodeIds.contains(nodeId);
 
     llvm::outs() << "Creating module for acquire Mocks " << acquireIdx << "\n";
     auto acquireMod = b.create<ModuleOp>(
@@ -843,20 +1128,20 @@ void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
         llvm::StringRef("quir.physicalIds"),
         controllerBuilder->getI32ArrayAttr(
             ArrayRef<int>(config->acquireQubits(nodeId))));
-    mockModules[nodeId] = acquireMod.getOperation();
+    mockNodes[nodeId].module = acquireMod.getOperation();
     mlir::func::FuncOp mockMainOp = addMainFunction(
         acquireMod.getOperation(), mainFunc->getLoc(), /*addReturn=*/isUnused);
-    newBuilders->emplace(nodeId, new OpBuilder(mockMainOp.getBody()));
+    mockNodes[nodeId].builders[mainSlot.id] =
+        std::make_unique<OpBuilder>(mockMainOp.getBody());
   }
 
   // refill the worklist
-  std::deque<std::tuple<Block *, OpBuilder *,
-                        std::unique_ptr<std::unordered_map<uint, OpBuilder *>>>>
-      blockAndBuilderWorkList;
+  BlockWorkList blockAndBuilderWorkList(
+      arena.getAllocator<BlockWorkList::value_type>());
   for (Region &region : mainFunc->getRegions()) {
     for (Block &block : region.getBlocks()) {
       blockAndBuilderWorkList.emplace_back(&block, controllerBuilder,
-                                           std::move(newBuilders));
+                                           mainSlot);
     }
   }
 
@@ -864,64 +1149,27 @@ void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
     llvm::outs() << "Entering blockAndBuilderWorklist body!\n";
     Block *block = std::get<0>(blockAndBuilderWorkList.front());
     controllerBuilder = std::get<1>(blockAndBuilderWorkList.front());
-    mockBuilders = std::get<2>(blockAndBuilderWorkList.front()).release();
+    currentSlot = std::move(std::get<2>(blockAndBuilderWorkList.front()));
     blockAndBuilderWorkList.pop_front();
-    for (Operation &op : block->getOperations()) {
-      if (auto qubitOp = dyn_cast<DeclareQubitOp>(op)) {
-        processOp(qubitOp);
-      } else if (auto resetOp = dyn_cast<ResetQubitOp>(op)) {
-        processOp(resetOp);
-      } else if (auto uOp = dyn_cast<Builtin_UOp>(op)) {
-        processOp(uOp);
-      } else if (auto cxOp = dyn_cast<BuiltinCXOp>(op)) {
-        processOp(cxOp);
-      } else if (auto measureOp = dyn_cast<MeasureOp>(op)) {
-        processOp(measureOp);
-      } else if (auto callOp = dyn_cast<CallSubroutineOp>(op)) {
-        processOp(callOp, blockAndBuilderWorkList);
-      } else if (auto callOp = dyn_cast<CallGateOp>(op)) {
-        processOp(callOp);
-      } else if (auto callOp = dyn_cast<BarrierOp>(op)) {
-        processOp(callOp);
-      } else if (auto callOp = dyn_cast<CallDefCalGateOp>(op)) {
-        processOp(callOp);
-      } else if (auto callOp = dyn_cast<CallDefcalMeasureOp>(op)) {
-        processOp(callOp);
-      } else if (auto delayOp = dyn_cast<DelayOp>(op)) {
-        processOp(delayOp);
-      } else if (auto delayOp = dyn_cast<DelayCyclesOp>(op)) {
-        processOp(delayOp);
-      } else if (auto returnOp = dyn_cast<mlir::func::ReturnOp>(op)) {
-        processOp(returnOp);
-      } else if (auto yieldOp = dyn_cast<scf::YieldOp>(op)) {
-        processOp(yieldOp);
-      } else if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
-        processOp(ifOp, blockAndBuilderWorkList);
-      } else if (auto forOp = dyn_cast<scf::ForOp>(op)) {
-        processOp(forOp, blockAndBuilderWorkList);
-      } else if (dyn_cast<mlir::func::FuncOp>(op) || dyn_cast<ModuleOp>(op)) {
-        // do nothing
-      }      // moduleOp
-      else { // some classical op, should go to Controller
-        auto *clonedOp = controllerBuilder->clone(op, controllerMapping);
-        // now add mappping for all results from the original op to the
-        // clonedOp
-        for (uint index = 0; index < op.getNumResults(); ++index) {
-          controllerMapping.map(op.getResult(index),
-                                clonedOp->getResult(index));
-        }
-      } // some classical op
-    }   // for Operations
-
-    // delete the allocated opbuilders
-    // TODO: use smart pointers to manage lifetimes
-    delete controllerBuilder;
-    for (const auto &pair : *mockBuilders)
-      delete pair.second;
-    delete mockBuilders;
+    for (Operation &op : block->getOperations())
+      localizeOp(op, blockAndBuilderWorkList);
   } // while !blockAndBuilderWorklist.empty()
 
   cloneVariableDeclarations(topModuleOp);
+
+  // now build the mock modules in parallel, each mock only reads the program
+  // and writes to its own module
+  std::vector<MockNode *> nodes;
+  nodes.reserve(mockNodes.size());
+  for (MockNode &node : mockNodes)
+    nodes.push_back(&node);
+  mlir::parallelForEach(&getContext(), nodes, [](MockNode *node) {
+    for (const auto &action : node->actions)
+      action(*node);
+  });
+  mockNodes.clear();
+  controllerBuilder = nullptr;
+  arena.reset();
 } // runOnOperation()
 
 void mock::MockQubitLocalizationPass::cloneVariableDeclarations(
@@ -1,6 +1,6 @@
 //===- QubitLocalization.h - Modules for qubit control ----------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -24,6 +24,7 @@
 #include "MockTarget.h"
 
 #include "Dialect/OQ3/IR/OQ3Ops.h"
+#include "Dialect/QCS/IR/QCSOps.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "HAL/TargetOperationPass.h"
 
@@ -32,29 +33,87 @@
 #include "mlir/IR/IRMapping.h"
 #include "mlir/Pass/Pass.h"
 
-#include <deque>
-#include <unordered_map>
-#include <unordered_set>
+#include "Utils/PassArena.h"
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <tuple>
 #include <vector>
 
 namespace qssc::targets::systems::mock {
 
+// A set of mock node ids or physical qubit ids. The ids of the mock config
+// are small and dense, so the set is a bitset indexed by id, which grows as
+// ids are inserted and is iterated in ascending id order.
+class MockIdSet {
+public:
+  MockIdSet() = default;
+  // reserve the ids in [0, numIds)
+  explicit MockIdSet(uint numIds) : bits(numIds) {}
+
+  void insert(uint id) {
+    if (id >= bits.size())
+      bits.resize(id + 1);
+    bits.set(id);
+  }
+  void insert(const MockIdSet &other) { bits |= other.bits; }
+  bool contains(uint id) const { return id < bits.size() && bits.test(id); }
+  size_t size() const { return bits.count(); }
+  bool empty() const { return bits.none(); }
+
+  llvm::BitVector::const_set_bits_iterator begin() const {
+    return bits.set_bits_begin();
+  }
+  llvm::BitVector::const_set_bits_iterator end() const {
+    return bits.set_bits_end();
+  }
+
+private:
+  llvm::BitVector bits;
+};
+
 struct MockQubitLocalizationPass
     : public mlir::PassWrapper<MockQubitLocalizationPass,
                                qssc::hal::TargetOperationPass<MockSystem>> {
 
+  // Localization partitions the program serially, building the Controller
+  // module and recording the ops each mock takes part in as actions. The
+  // actions of the mocks are then replayed in parallel, each building the
+  // module of its mock from the unchanged program.
+  struct MockNode {
+    mlir::Operation *module = nullptr;
+    mlir::IRMapping mapping;
+    // the builders of the localized copies of the program blocks, by slot
+    llvm::DenseMap<uint, std::unique_ptr<mlir::OpBuilder>> builders;
+    std::vector<std::function<void(MockNode &)>> actions;
+    // the op of the program at which a value was made available on the mock
+    llvm::DenseMap<mlir::Value, mlir::Operation *> availableAt;
+  };
+
+  // the builder slot of the localized copies of a program block, and the
+  // mocks the block is localized to
+  struct MockSlot {
+    uint id = 0;
+    MockIdSet nodeIds;
+  };
+
+  // the work list and the builders of the Controller blocks are allocated
+  // in the arena, which is reset at the end of the run
+  using BlockWorkList = qssc::utils::ArenaDeque<
+      std::tuple<mlir::Block *, mlir::OpBuilder *, MockSlot>>;
+
   void processOp(mlir::quir::DeclareQubitOp &qubitOp);
   void processOp(mlir::quir::ResetQubitOp &resetOp);
   void processOp(mlir::func::FuncOp &funcOp);
   void processOp(mlir::quir::Builtin_UOp &uOp);
   void processOp(mlir::quir::BuiltinCXOp &cxOp);
   void processOp(mlir::quir::MeasureOp &measureOp);
-  void
-  processOp(mlir::quir::CallSubroutineOp &callOp,
-            std::deque<std::tuple<
-                mlir::Block *, mlir::OpBuilder *,
-                std::unique_ptr<std::unordered_map<uint, mlir::OpBuilder *>>>>
-                &blockAndBuilderWorkList);
+  void processOp(mlir::quir::CallSubroutineOp &callOp,
+                 BlockWorkList &blockAndBuilderWorkList);
   void processOp(mlir::quir::CallGateOp &callOp);
   void processOp(mlir::quir::BarrierOp &callOp);
   void processOp(mlir::quir::CallDefCalGateOp &callOp);
@@ -63,24 +122,31 @@ struct MockQubitLocalizationPass
   void processOp(DelayOpType &delayOp);
   void processOp(mlir::func::ReturnOp &returnOp);
   void processOp(mlir::scf::YieldOp &yieldOp);
-  void
-  processOp(mlir::scf::IfOp &ifOp,
-            std::deque<std::tuple<
-                mlir::Block *, mlir::OpBuilder *,
-                std::unique_ptr<std::unordered_map<uint, mlir::OpBuilder *>>>>
-                &blockAndBuilderWorkList);
-  void
-  processOp(mlir::scf::ForOp &forOp,
-            std::deque<std::tuple<
-                mlir::Block *, mlir::OpBuilder *,
-                std::unique_ptr<std::unordered_map<uint, mlir::OpBuilder *>>>>
-                &blockAndBuilderWorkList);
+  void processOp(mlir::scf::IfOp &ifOp,
+                 BlockWorkList &blockAndBuilderWorkList);
+  void processOp(mlir::scf::ForOp &forOp,
+                 BlockWorkList &blockAndBuilderWorkList);
+  void processOp(mlir::qcs::ParallelControlFlowOp &parallelOp,
+                 BlockWorkList &blockAndBuilderWorkList);
+  void localizeOp(mlir::Operation &op, BlockWorkList &blockAndBuilderWorkList);
 
   void runOnOperation(MockSystem &target) override;
   auto lookupQubitId(const mlir::Value &val) -> int;
-  void broadcastAndReceiveValue(const mlir::Value &val,
-                                const mlir::Location &loc,
-                                const std::unordered_set<uint> &toNodeIds);
+  void addReaderNodeIds(mlir::Operation *user, MockIdSet &nodeIds);
+  auto getReaderNodeIds(mlir::Value val, mlir::Operation *fromOp)
+      -> MockIdSet;
+  auto getBranchNodeIds(mlir::scf::IfOp ifOp) -> std::optional<MockIdSet>;
+  auto getEnclosingNodeIds(mlir::Operation *op) -> const MockIdSet &;
+  void sendAndReceiveValues(mlir::Operation *op, mlir::ValueRange vals);
+  auto addSlot(MockIdSet nodeIds) -> MockSlot;
+  void addNodeAction(
+      uint nodeId,
+      std::function<void(MockNode &node, mlir::OpBuilder &builder)> action);
+  void cloneToNode(uint nodeId, mlir::Operation *op,
+                   mlir::Operation *atOp = nullptr);
+  void markAvailable(uint nodeId, mlir::Value val, mlir::Operation *atOp);
+  auto isAvailable(uint nodeId, mlir::Value val, mlir::Operation *atOp)
+      -> bool;
   void cloneRegionWithoutOps(mlir::Region *from, mlir::Region *dest,
                              mlir::IRMapping &mapper);
   void cloneRegionWithoutOps(mlir::Region *from, mlir::Region *dest,
@@ -95,15 +161,18 @@ struct MockQubitLocalizationPass
   mlir::ModuleOp controllerModule;
   mlir::IRMapping controllerMapping;
   mlir::OpBuilder *controllerBuilder;
-  std::unordered_set<uint> seenNodeIds;
-  std::unordered_set<uint> seenQubitIds;
-  std::unordered_set<uint> acquireNodeIds;
-  std::unordered_set<uint> driveNodeIds;
-
-  mlir::DenseSet<mlir::Value> alreadyBroadcastValues;
-  std::unordered_map<uint, mlir::Operation *> mockModules;   // one per nodeId
-  std::unordered_map<uint, mlir::OpBuilder *> *mockBuilders; // one per nodeId
-  std::unordered_map<uint, mlir::IRMapping> mockMapping;     // one per nodeId
+  qssc::utils::PassArena arena;
+  MockIdSet seenNodeIds;
+  MockIdSet seenQubitIds;
+  MockIdSet acquireNodeIds;
+  MockIdSet driveNodeIds;
+
+  std::vector<MockNode> mockNodes; // indexed by nodeId
+  MockSlot currentSlot; // of the program block being localized
+  uint numSlots = 0;
+  // the mocks that each scf.if of a qcs.parallel_control_flow is localized
+  // to, any other scf.if is localized to the mocks of its block
+  llvm::DenseMap<mlir::Operation *, MockIdSet> branchNodeIds;
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
@@ -1,4 +1,4 @@
-# (C) Copyright IBM 2023.
+# (C) Copyright IBM 2023, 2024.
 #
 # This code is part of Qiskit.
 #
@@ -17,6 +17,7 @@ Unit tests for the compiler API using mock targets.
 import asyncio
 from datetime import datetime, timedelta
 import io
+import json
 import os
 import pytest
 
@@ -183,6 +184,29 @@ def test_compile_options(mock_config_file, example_qasm3_str):
     check_mlir_string(mlir)
 
 
+def test_compile_timing_trace(mock_config_file, example_qasm3_str, tmp_path):
+    """Test that the compilation timers are written as trace events."""
+    trace_file = tmp_path / "trace.json"
+
+    compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.QEM,
+        target="mock",
+        config_path=mock_config_file,
+        timing_trace_file=trace_file,
+        extra_args=compiler_extra_args,
+    )
+
+    with open(trace_file) as trace:
+        events = json.load(trace)["traceEvents"]
+    names = {event["name"] for event in events}
+    assert "load-qasm3" in names
+    assert "write-payload" in names
+    assert all(event["ph"] == "X" and "tid" in event for event in events)
+    assert any(event["args"]["targets"].startswith("MockSystem") for event in events)
+
+
 async def sleep_a_little():
     await asyncio.sleep(1)
     return datetime.now()
@@ -0,0 +1,37 @@
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-aggregate-acquisitions %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-aggregate-acquisitions --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The captures overlapping in time share an acquisition, also when they only
+// overlap through another capture of it, and their results are indexed in
+// the order of their starts. Captures which are not scheduled are left alone.
+
+pulse.sequence @measure(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.mixed_frame) -> (i1, i1, i1, i1, i1, i1) {
+  // CHECK: pulse.capture {mock.acquisition = 0 : i64, mock.result_index = 1 : i64, pulse.duration = 100 : i64, pulse.timepoint = 50 : i64}(%arg1)
+  %0 = pulse.capture {pulse.duration = 100 : i64, pulse.timepoint = 50 : i64}(%arg1) : (!pulse.mixed_frame) -> i1
+  // CHECK: pulse.capture {mock.acquisition = 0 : i64, mock.result_index = 0 : i64, pulse.duration = 100 : i64, pulse.timepoint = 0 : i64}(%arg0)
+  %1 = pulse.capture {pulse.duration = 100 : i64, pulse.timepoint = 0 : i64}(%arg0) : (!pulse.mixed_frame) -> i1
+  // CHECK: pulse.capture {mock.acquisition = 0 : i64, mock.result_index = 2 : i64, pulse.duration = 100 : i64, pulse.timepoint = 120 : i64}(%arg2)
+  %2 = pulse.capture {pulse.duration = 100 : i64, pulse.timepoint = 120 : i64}(%arg2) : (!pulse.mixed_frame) -> i1
+  // CHECK: pulse.capture {mock.acquisition = 1 : i64, mock.result_index = 0 : i64, pulse.duration = 100 : i64, pulse.timepoint = 220 : i64}(%arg0)
+  %3 = pulse.capture {pulse.duration = 100 : i64, pulse.timepoint = 220 : i64}(%arg0) : (!pulse.mixed_frame) -> i1
+  // CHECK: pulse.capture {mock.acquisition = 1 : i64, mock.result_index = 1 : i64, pulse.duration = 50 : i64, pulse.timepoint = 250 : i64}(%arg1)
+  %4 = pulse.capture {pulse.duration = 50 : i64, pulse.timepoint = 250 : i64}(%arg1) : (!pulse.mixed_frame) -> i1
+  // CHECK: pulse.capture(%arg2)
+  %5 = pulse.capture(%arg2) : (!pulse.mixed_frame) -> i1
+  pulse.return {pulse.timepoint = 320 : i64} %0, %1, %2, %3, %4, %5 : i1, i1, i1, i1, i1, i1
+}
+
+// STATS-DAG: (S) {{ *}}5 captures
+// STATS-DAG: (S) {{ *}}2 acquisitions
@@ -0,0 +1,51 @@
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-conversion %s | FileCheck %s
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Classical values are only sent to the mocks which read them, once, and
+// the values a mock receives at one point share a single message.
+
+func.func @main() -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %a = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  %b = quir.constant #quir.angle<0.2> : !quir.angle<20>
+  %theta = oq3.angle_add %a, %b : !quir.angle<20>
+  %phi = oq3.angle_sub %a, %b : !quir.angle<20>
+  quir.builtin_U %q0, %theta, %phi, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  quir.builtin_U %q0, %phi, %theta, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  %c = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  scf.if %c {
+    quir.builtin_U %q1, %theta, %a, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  }
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
+
+// CHECK: module @controller
+// CHECK: %[[THETA:.*]] = oq3.angle_add
+// CHECK: %[[PHI:.*]] = oq3.angle_sub
+// CHECK: qcs.send %[[THETA]], %[[PHI]] to 1 : !quir.angle<20>, !quir.angle<20>
+// CHECK-NOT: qcs.broadcast
+// CHECK: %[[COND:.*]] = qcs.recv {{.*}}: i1
+// CHECK: qcs.send %[[COND]], %[[THETA]] to 2 : i1, !quir.angle<20>
+// CHECK: scf.if %[[COND]]
+
+// CHECK: module @mock_drive_0
+// CHECK: qcs.recv {fromIds = [1000 : index, 1000 : index]} : !quir.angle<20>, !quir.angle<20>
+// CHECK-NOT: qcs.recv {fromIds = [1000
+// CHECK: module @mock_drive_1
+// CHECK: qcs.recv {fromIds = [1000 : index, 1000 : index]} : i1, !quir.angle<20>
+// CHECK: scf.if
+// CHECK: module @mock_acquire_0
+// CHECK-NOT: qcs.recv
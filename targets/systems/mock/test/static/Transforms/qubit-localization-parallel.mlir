@@ -0,0 +1,54 @@
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-conversion %s | FileCheck %s
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Independent branches run concurrently on Controller, each mock only takes
+// part in the branches on its qubits.
+
+func.func @main() -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %a = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  %c0 = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  %c1 = quir.measure(%q1) : (!quir.qubit<1>) -> i1
+  scf.if %c0 {
+    quir.builtin_U %q0, %a, %a, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  }
+  scf.if %c1 {
+    quir.builtin_U %q1, %a, %a, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  }
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
+
+// CHECK: module @controller
+// CHECK: %[[C0:.*]] = qcs.recv {{.*}}: i1
+// CHECK: %[[C1:.*]] = qcs.recv {{.*}}: i1
+// CHECK-NOT: qcs.send
+// CHECK: qcs.parallel_control_flow {
+// CHECK-NEXT: scf.if %[[C0]] {
+// CHECK: scf.if %[[C1]] {
+
+// CHECK: module @mock_drive_0
+// CHECK-NOT: qcs.parallel_control_flow
+// CHECK: scf.if
+// CHECK-NEXT: quir.builtin_U
+// CHECK-NOT: scf.if
+// CHECK: module @mock_drive_1
+// CHECK-NOT: qcs.parallel_control_flow
+// CHECK: scf.if
+// CHECK-NEXT: quir.builtin_U
+// CHECK-NOT: scf.if
+// CHECK: module @mock_acquire_0
+// CHECK: scf.if
+// CHECK: scf.if
@@ -0,0 +1,61 @@
+// RUN: echo "num_qubits 5" > %t.cfg && echo "acquire_multiplexing_ratio_to_1 2" >> %t.cfg && echo "controllerNodeId 1000" >> %t.cfg
+// RUN: qss-compiler -X=mlir --target mock --config %t.cfg --mock-conversion %s | FileCheck %s
+// RUN: echo "num_qubits 4" > %t.small.cfg && echo "acquire_multiplexing_ratio_to_1 2" >> %t.small.cfg && echo "controllerNodeId 1000" >> %t.small.cfg
+// RUN: not qss-compiler -X=mlir --target mock --config %t.small.cfg --mock-conversion %s 2>&1 | FileCheck %s --check-prefix RANGE
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The routing tables of the config map each of 5 qubits, multiplexed 2 to 1,
+// to its drive and acquire mocks: acquire 0 (q0, q1), acquire 3 (q2, q3) and
+// acquire 6 (q4), and the drives 1, 2, 4, 5 and 7. Messages to several mocks
+// are sent in the order of their node ids, whatever the program order, and
+// the last qubit id of the config is the last valid one.
+
+func.func @main() -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+  %q3 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+  %q4 = quir.declare_qubit {id = 4 : i32} : !quir.qubit<1>
+  %a = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  %c4 = quir.measure(%q4) : (!quir.qubit<1>) -> i1
+  scf.if %c4 {
+    quir.builtin_U %q3, %a, %a, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+    quir.builtin_U %q1, %a, %a, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+    quir.builtin_U %q0, %a, %a, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  }
+  %c2 = quir.measure(%q2) : (!quir.qubit<1>) -> i1
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
+
+// CHECK: module @controller
+// CHECK: %[[COND:.*]] = qcs.recv {fromIds = [4 : index]} : i1
+// CHECK: qcs.send %[[COND]] to 1 : i1
+// CHECK: qcs.send %[[COND]] to 2 : i1
+// CHECK: qcs.send %[[COND]] to 5 : i1
+// CHECK: scf.if %[[COND]]
+// CHECK: qcs.recv {fromIds = [2 : index]} : i1
+
+// CHECK: module @mock_drive_0 attributes {quir.nodeId = 1 : ui32, quir.nodeType = "drive", quir.physicalId = 0 : i32}
+// CHECK: module @mock_drive_1 attributes {quir.nodeId = 2 : ui32, quir.nodeType = "drive", quir.physicalId = 1 : i32}
+// CHECK: module @mock_drive_2 attributes {quir.nodeId = 4 : ui32, quir.nodeType = "drive", quir.physicalId = 2 : i32}
+// CHECK: module @mock_drive_3 attributes {quir.nodeId = 5 : ui32, quir.nodeType = "drive", quir.physicalId = 3 : i32}
+// CHECK: module @mock_drive_4 attributes {quir.nodeId = 7 : ui32, quir.nodeType = "drive", quir.physicalId = 4 : i32}
+// CHECK: module @mock_acquire_0 attributes {quir.nodeId = 0 : ui32, quir.nodeType = "acquire", quir.physicalIds = [0 : i32, 1 : i32]}
+// CHECK: module @mock_acquire_1 attributes {quir.nodeId = 3 : ui32, quir.nodeType = "acquire", quir.physicalIds = [2 : i32, 3 : i32]}
+// CHECK: quir.measure
+// CHECK: module @mock_acquire_2 attributes {quir.nodeId = 6 : ui32, quir.nodeType = "acquire", quir.physicalIds = [4 : i32]}
+// CHECK: quir.measure
+
+// RANGE: Error! Found a qubit without an ID or with ID >= 4
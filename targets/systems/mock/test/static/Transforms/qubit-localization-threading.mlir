@@ -0,0 +1,62 @@
+// RUN: echo "num_qubits 4" > %t.cfg && echo "acquire_multiplexing_ratio_to_1 2" >> %t.cfg && echo "controllerNodeId 1000" >> %t.cfg
+// RUN: qss-compiler -X=mlir --target mock --config %t.cfg --mock-conversion %s > %t.parallel.mlir
+// RUN: qss-compiler -X=mlir --target mock --config %t.cfg --mock-conversion --mlir-disable-threading %s > %t.serial.mlir
+// RUN: diff %t.serial.mlir %t.parallel.mlir
+// RUN: FileCheck %s --input-file %t.parallel.mlir
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The mock modules are built in parallel. The output must be identical to
+// building them one after the other, for a program of several subroutines
+// on several drive and acquire mocks.
+
+func.func @flip(%qArg : !quir.qubit<1>, %ang : !quir.angle<20>) {
+  quir.builtin_U %qArg, %ang, %ang, %ang : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  return
+}
+
+func.func @flip_if(%qq1 : !quir.qubit<1>, %qq2 : !quir.qubit<1>, %ang : !quir.angle<20>) {
+  %res = quir.measure(%qq1) : (!quir.qubit<1>) -> i1
+  scf.if %res {
+    quir.call_subroutine @flip(%qq2, %ang) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  }
+  return
+}
+
+func.func @main() -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+  %q3 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+  %a = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  %b = quir.constant #quir.angle<0.2> : !quir.angle<20>
+  %theta = oq3.angle_add %a, %b : !quir.angle<20>
+  quir.reset %q0 : !quir.qubit<1>
+  quir.call_subroutine @flip(%q1, %theta) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  quir.call_subroutine @flip_if(%q0, %q2, %a) : (!quir.qubit<1>, !quir.qubit<1>, !quir.angle<20>) -> ()
+  quir.call_subroutine @flip_if(%q2, %q3, %theta) : (!quir.qubit<1>, !quir.qubit<1>, !quir.angle<20>) -> ()
+  quir.call_subroutine @flip_if(%q3, %q0, %b) : (!quir.qubit<1>, !quir.qubit<1>, !quir.angle<20>) -> ()
+  quir.barrier %q0, %q1, %q2, %q3 : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+  %c0 = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  %c3 = quir.measure(%q3) : (!quir.qubit<1>) -> i1
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
+
+// CHECK: module @controller
+// CHECK: module @mock_drive_0
+// CHECK: module @mock_drive_1
+// CHECK: module @mock_drive_2
+// CHECK: module @mock_drive_3
+// CHECK: module @mock_acquire_0
+// CHECK: module @mock_acquire_1
@@ -0,0 +1,29 @@
+OPENQASM 3.0;
+// RUN: cp %TEST_CFG %t.cfg && echo "llvm_opt_preset O2" >> %t.cfg
+// RUN: qss-compiler %s --target mock --config %t.cfg --emit=qem --memory-budget=1 -o /dev/null 2>&1 | FileCheck %s
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The compilation still succeeds once the budget is exceeded, skipping the
+// optional work with a warning for each kind of work.
+
+qubit $0;
+qubit $1;
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+CX $0, $1;
+c0 = measure $1;
+
+// CHECK: warning: memory budget of 1 MiB exceeded by a peak resident set size of {{[0-9]+}} MiB, skipping LLVM optimization
+// CHECK-NOT: skipping LLVM optimization
@@ -0,0 +1,35 @@
+OPENQASM 3.0;
+// REQUIRES: perf
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits-from-qasm=false --timing-trace=%t -o /dev/null
+// RUN: %perf-check %s --input-file %t
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Bounds the compile time of a small program. The conversion and code
+// generation of the controller dominate the compilation, the MLIR passes of
+// the targets may only take a fraction of it.
+
+qubit $0;
+qubit $1;
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+CX $0, $1;
+c0 = measure $1;
+if (c0) {
+  U(0.0, 0.0, 3.14159265359) $0;
+}
+
+// PERF: time(build-qem) <= 2000 ms
+// PERF: time(load-qasm3) / time(build-qem) <= 0.5
+// PERF: time(*/compile-system/MockSystem/passes) / time(build-qem) <= 0.5
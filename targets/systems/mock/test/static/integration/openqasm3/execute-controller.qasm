@@ -0,0 +1,38 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits-from-qasm=false --mock-execute-controller --mock-execution-seed=7 | FileCheck %s --implicit-check-not __qssc_mock
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits-from-qasm=false | FileCheck %s --check-prefix DISABLED --implicit-check-not controller.exec
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: Manifest
+// CHECK-DAG: controller.bin
+// CHECK-DAG: controller.exec
+// CHECK: File: {{.*}}controller.exec
+// CHECK-NEXT: # main returned 0 after {{[0-9]+}} ns
+// CHECK-NEXT: # path count total_ns min_ns mean_ns max_ns
+// CHECK-NEXT: shot {{[0-9]+ [0-9]+ [0-9]+ [0-9]+ [0-9]+}}
+// The payload is emitted without the runtime stubs
+// CHECK: File: {{.*}}llvmModule.ll
+
+// DISABLED: Manifest
+// DISABLED: controller.bin
+qubit $0;
+qubit $1;
+
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+measure $0 -> c0;
+if (c0 == 1) {
+  U(3.14159265359, 0.0, 3.14159265359) $1;
+}
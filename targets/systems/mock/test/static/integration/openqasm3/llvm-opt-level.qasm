@@ -0,0 +1,31 @@
+OPENQASM 3.0;
+// RUN: cp %TEST_CFG %t.cfg && echo "llvm_opt_level 2" >> %t.cfg && echo "llvm_codegen_opt_level 0" >> %t.cfg
+// RUN: qss-compiler %s --target mock --config %t.cfg --emit=qem --plaintext-payload --enable-circuits-from-qasm=false | FileCheck %s
+// RUN: cp %TEST_CFG %t.invalid.cfg && echo "llvm_codegen_opt_level 4" >> %t.invalid.cfg
+// RUN: not qss-compiler %s --target mock --config %t.invalid.cfg --emit=qem --plaintext-payload --enable-circuits-from-qasm=false 2>&1 | FileCheck %s --check-prefix INVALID
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: Manifest
+// CHECK: MockController.mlir
+// CHECK: controller.bin
+// CHECK: llvmModule.ll
+
+// INVALID: LLVM optimization levels must be between 0 and 3
+qubit $0;
+qubit $1;
+
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+measure $0 -> c0;
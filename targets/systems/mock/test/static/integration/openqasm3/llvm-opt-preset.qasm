@@ -0,0 +1,42 @@
+OPENQASM 3.0;
+// RUN: cp %TEST_CFG %t.size.cfg && echo "llvm_opt_preset size" >> %t.size.cfg
+// RUN: qss-compiler %s --target mock --config %t.size.cfg --emit=qem --plaintext-payload --enable-circuits-from-qasm=false | FileCheck %s
+// RUN: cp %TEST_CFG %t.parallel.cfg && echo "llvm_opt_preset O2" >> %t.parallel.cfg && echo "llvm_codegen_partitions 4" >> %t.parallel.cfg && echo "llvm_parallel_function_opt 1" >> %t.parallel.cfg
+// RUN: qss-compiler %s --target mock --config %t.parallel.cfg --emit=qem --plaintext-payload --enable-circuits-from-qasm=false | FileCheck %s --check-prefix PARALLEL
+// RUN: cp %TEST_CFG %t.invalid.cfg && echo "llvm_opt_preset O4" >> %t.invalid.cfg
+// RUN: qss-compiler %s --target mock --config %t.invalid.cfg --emit=qem --plaintext-payload --enable-circuits-from-qasm=false 2>&1 | FileCheck %s --check-prefix INVALID
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: Manifest
+// CHECK: controller.bin
+// CHECK: llvmModule.ll
+
+// PARALLEL: Manifest
+// PARALLEL: controller.bin
+// PARALLEL: File: {{.*}}controller.bin
+// PARALLEL-NEXT: !<arch>
+
+// INVALID: unknown llvm_opt_preset O4
+qubit $0;
+qubit $1;
+
+gate cx control, target { }
+
+bit c0;
+bit c1;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+cx $0, $1;
+measure $0 -> c0;
+measure $1 -> c1;
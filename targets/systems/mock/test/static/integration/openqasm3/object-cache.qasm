@@ -0,0 +1,41 @@
+OPENQASM 3.0;
+// Populate the compile cache
+// RUN: rm -rf %t.cache %t.dir && mkdir -p %t.dir
+// RUN: cp %s %t.dir/first.qasm && cp %s %t.dir/second.qasm
+// RUN: qss-compiler -X=qasm %t.dir/first.qasm --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits-from-qasm=false --compile-cache-dir=%t.cache | FileCheck %s
+
+// The same program in a file of another name has controller modules at other
+// locations. With another trace context it misses the cache of compiler
+// outputs, but its controller object is taken from the cache
+// RUN: qss-compiler -X=qasm %t.dir/second.qasm --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits-from-qasm=false --compile-cache-dir=%t.cache --trace-context=second --mlir-timing --mlir-disable-threading 2>&1 >/dev/null | FileCheck %s --check-prefix HIT
+// RUN: qss-compiler -X=qasm %t.dir/second.qasm --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits-from-qasm=false --compile-cache-dir=%t.cache --trace-context=again | FileCheck %s
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: Manifest
+// CHECK: controller.bin
+// CHECK: llvmModule.ll
+
+// HIT: build-llvm-payload
+// HIT: translate-to-llvm-mlir-dialect
+// HIT: lookup-object-cache
+// HIT-NOT: mlir-to-llvm-ir
+// HIT-NOT: build-object-file
+// HIT: emit-to-payload-post-children
+qubit $0;
+qubit $1;
+
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+measure $0 -> c0;
@@ -0,0 +1,31 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits-from-qasm=false | FileCheck %s
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits-from-qasm=false --payload-profile=production | FileCheck %s --check-prefix PRODUCTION --implicit-check-not .mlir --implicit-check-not llvmModule.ll
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: Manifest
+// CHECK-DAG: MockController.mlir
+// CHECK-DAG: MockDrive_0.mlir
+// CHECK-DAG: MockAcquire_0.mlir
+// CHECK-DAG: llvmModule.ll
+// CHECK-DAG: controller.bin
+
+// PRODUCTION: Manifest
+// PRODUCTION: controller.bin
+qubit $0;
+
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+measure $0 -> c0;
@@ -0,0 +1,31 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits-from-qasm=false --canonicalize --report-pass-memory --mlir-disable-threading -o /dev/null 2>&1 | FileCheck %s
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The memory growth is reported for the command line passes and for the
+// passes of each target.
+
+qubit $0;
+qubit $1;
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+CX $0, $1;
+c0 = measure $1;
+
+// CHECK: ===- Pass memory report -===
+// CHECK-NEXT: Peak RSS (KiB)  Heap (KiB)  Max heap (KiB)  Runs  Target / Pass
+// CHECK-DAG: <pipeline> / Canonicalizer
+// CHECK-DAG: MockSystem / Mock Qubit Localization Pass
+// CHECK-DAG: MockController / Mock QUIR to Std Pass
@@ -0,0 +1,51 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits-from-qasm=false --timing-trace=%t -o /dev/null
+// RUN: FileCheck %s < %t
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits-from-qasm=false --timing-trace=%t.context --trace-context=job-42 -o /dev/null
+// RUN: FileCheck %s --check-prefix CONTEXT < %t.context
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The timers are written as trace events with their thread and the targets
+// enclosing them. A trace context ID is attached to the trace.
+
+qubit $0;
+qubit $1;
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+CX $0, $1;
+c0 = measure $1;
+
+// CHECK: "traceEvents": [
+// CHECK: "name": "load-qasm3",
+// CHECK-NEXT: "cat": "qssc",
+// CHECK-NEXT: "ph": "X",
+// CHECK-NEXT: "ts":
+// CHECK-NEXT: "dur":
+// CHECK-NEXT: "pid":
+// CHECK-NEXT: "tid":
+// CHECK-NEXT: "args": {
+// CHECK-NEXT: "path": "load-qasm3",
+// CHECK-NEXT: "targets": ""
+// CHECK: "name": "optimize-llvm",
+// CHECK: "path": "{{.*}}/MockController/{{.*}}optimize-llvm",
+// CHECK-NEXT: "targets": "MockSystem/MockController"
+// CHECK: "name": "write-payload",
+// CHECK: "name": "root",
+// CHECK: "displayTimeUnit": "ms"
+// CHECK-NOT: "otherData"
+
+// CONTEXT: "displayTimeUnit": "ms",
+// CONTEXT-NEXT: "otherData": {
+// CONTEXT-NEXT: "traceContext": "job-42"
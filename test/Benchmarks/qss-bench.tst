@@ -0,0 +1,63 @@
+// RUN: qss-bench --emit-programs --qubits=2 --gates=8 --measurements=2 --conditionals=2 --nesting=2 --parameters=2 | FileCheck %s --check-prefix QASM
+// RUN: qss-bench --emit-programs --input=mlir --qubits=2 --gates=8 --measurements=2 --conditionals=2 --nesting=2 --parameters=2 | qss-compiler -X=mlir - | FileCheck %s --check-prefix MLIR
+// RUN: qss-bench --input=qasm,mlir --qubits=2 --gates=8 --measurements=2 --conditionals=2 --nesting=2 --parameters=2 -o %t
+// RUN: FileCheck %s --check-prefix JSON < %t
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// QASM: OPENQASM 3.0;
+// QASM: input angle p0 = 0.1;
+// QASM: input angle p1 = 0.2;
+// QASM: gate g0(theta) q {
+// QASM-NEXT: U(theta, 0.0, 0.0) q;
+// QASM: gate g1(theta) q {
+// QASM-NEXT: g0(theta) q;
+// QASM: qubit $1;
+// QASM: bit m1;
+// QASM-NEXT: U(p0, 0.0, 0.0) $0;
+// QASM-NEXT: CX $1, $0;
+// QASM-NEXT: g1(p0) $1;
+// QASM-NEXT: m0 = measure $1;
+// QASM-NEXT: if (m0 == 1) {
+// QASM-NEXT: U(p0, 0.0, 0.0) $0;
+// QASM-NEXT: }
+// QASM-NEXT: U(0.5, 0.0, 0.5) $0;
+// QASM-NEXT: U(p0, 0.0, 0.0) $0;
+// QASM-NEXT: CX $1, $0;
+// QASM-NEXT: m1 = measure $1;
+// QASM-NOT: measure
+
+// MLIR: qcs.declare_parameter @p1 : !quir.angle<64>
+// MLIR: func.func @g1(
+// MLIR: quir.call_gate @g0(
+// MLIR: func.func @main() -> i32 {
+// MLIR: quir.builtin_CX
+// MLIR: quir.call_gate @g1(
+// MLIR: quir.measure
+// MLIR: scf.if
+
+// JSON: "input": "qasm",
+// JSON: "qubits": 2,
+// JSON: "gates": 8,
+// JSON: "layers": 4,
+// JSON: "times_ns": {
+// JSON-NEXT: "total":
+// JSON-NEXT: "frontend":
+// JSON-NEXT: "quir_pipeline":
+// JSON-NEXT: "localization":
+// JSON-NEXT: "pulse":
+// JSON-NEXT: "llvm":
+// JSON-NEXT: "payload":
+// JSON-NEXT: "other":
+// JSON: "peak_rss_kb":
+// JSON: "input": "mlir",
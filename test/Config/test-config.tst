@@ -1,6 +1,8 @@
 // RUN: qss-compiler --target Mock --config path/to/config --allow-unregistered-dialect=false \
-// RUN:          --add-target-passes=false --verbosity=info --max-threads=5 --show-config - | FileCheck %s --check-prefix CLI
+// RUN:          --add-target-passes=false --verbosity=info --max-threads=5 --compile-cache-dir=path/to/cache \
+// RUN:          --compile-cache-entries=8 --compile-cache-frontend --timing-trace=path/to/trace.json --compile-deadline=500 --trace-context=job-42 --profiler-markers=itt --compile-priority=high --payload-format=FLAT --payload-delta-base=path/to/manifest.json --show-config - | FileCheck %s --check-prefix CLI
 // RUN: QSSC_TARGET_NAME="MockEnv" QSSC_TARGET_CONFIG_PATH="path/to/config/Env" QSSC_VERBOSITY=DEBUG QSSC_MAX_THREADS=10 \
+// RUN:          QSSC_COMPILE_CACHE_DIR="path/to/cache/Env" QSSC_PROFILER_MARKERS=itt QSSC_COMPILE_PRIORITY=low \
 // RUN:          qss-compiler --allow-unregistered-dialect=false --add-target-passes=false --show-config - | FileCheck %s --check-prefix ENV
 // REQUIRES: !asserts
 
@@ -15,10 +17,24 @@
 // CLI: showConfig: 1
 // CLI: payloadName: -
 // CLI: emitPlaintextPayload: 0
+// CLI: payloadProfile: debug
+// CLI: payloadFormat: FLAT
+// CLI: payloadDeltaBase: path/to/manifest.json
 // CLI: includeSource: 0
 // CLI: compileTargetIR: 0
 // CLI: bypassPayloadTargetCompilation: 0
 // CLI: maxThreads: 5
+// CLI: compileCacheDir: path/to/cache
+// CLI: compileCacheEntries: 8
+// CLI: compileCacheFrontend: 1
+// CLI: verifyStages: 0
+// CLI: reportPassMemory: 0
+// CLI: timingTraceFile: path/to/trace.json
+// CLI: compileDeadline: 500
+// CLI: memoryBudget: None
+// CLI: traceContext: job-42
+// CLI: profilerMarkers: itt
+// CLI: compilePriority: high
 
 // CLI: allowUnregisteredDialects: 0
 // CLI: dumpPassPipeline: 0
@@ -38,4 +54,7 @@
 // ENV: verbosity: Debug
 // ENV: addTargetPasses: 0
 // ENV: maxThreads: 10
+// ENV: compileCacheDir: path/to/cache/Env
+// ENV: profilerMarkers: itt
+// ENV: compilePriority: low
 // ENV: allowUnregisteredDialects: 0
@@ -0,0 +1,56 @@
+// RUN: qss-compiler %s --quir-to-pulse=fixed-point-angles=true | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Angles are lowered to fixed-point phases of their width, and rescaled for
+// calibrations taking f64 phases.
+
+module {
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 3 : i32}, %arg1: !quir.angle<20>) attributes {quir.classicalOnly = false, quir.physicalIds = [3 : i32]} {
+    %angle = quir.constant #quir.angle<1.5707963267948966> : !quir.angle<20>
+    quir.call_gate @rz(%arg0, %arg1) {pulse.calName = "rz_3"} : (!quir.qubit<1>, !quir.angle<20>) -> ()
+    quir.call_gate @rz(%arg0, %angle) {pulse.calName = "rz_3"} : (!quir.qubit<1>, !quir.angle<20>) -> ()
+    quir.call_gate @rz(%arg0, %arg1) {pulse.calName = "rzf_3"} : (!quir.qubit<1>, !quir.angle<20>) -> ()
+    quir.return
+  }
+  pulse.sequence @rz_3(%arg0: i20, %arg1: !pulse.mixed_frame) -> i1
+  attributes {pulse.argPorts = ["", "q3-drive-port"], pulse.args = ["angle", "q3-drive-mixframe"]} {
+    pulse.shift_phase {pulse.timepoint = 0 : i64}(%arg1, %arg0) : (!pulse.mixed_frame, i20)
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+  pulse.sequence @rzf_3(%arg0: f64, %arg1: !pulse.mixed_frame) -> i1
+  attributes {pulse.argPorts = ["", "q3-drive-port"], pulse.args = ["angle", "q3-drive-mixframe"]} {
+    pulse.shift_phase {pulse.timepoint = 0 : i64}(%arg1, %arg0) : (!pulse.mixed_frame, f64)
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+  // CHECK: pulse.sequence @circuit_0_sequence(%arg0: i20, %arg1: !pulse.mixed_frame)
+  // CHECK: pulse.call_sequence @rz_3(%arg0, %arg1) : (i20, !pulse.mixed_frame) -> i1
+  // CHECK: %[[CST:.*]] = arith.constant 262144 : i20
+  // CHECK: pulse.call_sequence @rz_3(%[[CST]], %arg1) : (i20, !pulse.mixed_frame) -> i1
+  // CHECK: %[[TURNS:.*]] = arith.uitofp %arg0 : i20 to f64
+  // CHECK: %[[RADIANS:.*]] = arith.mulf %[[TURNS]], %{{.*}} : f64
+  // CHECK: pulse.call_sequence @rzf_3(%[[RADIANS]], %arg1) : (f64, !pulse.mixed_frame) -> i1
+
+  func.func @main() -> i32 attributes {quir.classicalOnly = false} {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+    %angle = quir.constant #quir.angle<0.78539816339744828> : !quir.angle<20>
+    // CHECK: %[[ANGLE:.*]] = arith.constant 131072 : i20
+    // CHECK: pulse.call_sequence @circuit_0_sequence(%[[ANGLE]], %{{.*}}) : (i20, !pulse.mixed_frame)
+    quir.call_circuit @circuit_0(%0, %angle) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+    return %c0_i32 : i32
+  }
+}
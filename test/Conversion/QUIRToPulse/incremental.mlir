@@ -0,0 +1,67 @@
+// RUN: rm -rf %t && mkdir %t && cp %s %t/input.mlir
+// RUN: qss-compiler %t/input.mlir --quir-to-pulse="incremental incremental-cache-dir=%t/cache" | FileCheck %s
+// RUN: qss-compiler %t/input.mlir --quir-to-pulse="incremental incremental-cache-dir=%t/cache" | FileCheck %s
+// RUN: qss-compiler %t/input.mlir --quir-to-pulse="incremental incremental-cache-dir=%t/cache" --mlir-pass-statistics --mlir-pass-statistics-display=list -o /dev/null 2>&1 | FileCheck %s --check-prefix=UNCHANGED
+// RUN: sed -e 's/0.25/0.75/' %s > %t/input.mlir
+// RUN: qss-compiler %t/input.mlir --quir-to-pulse="incremental incremental-cache-dir=%t/cache" --mlir-pass-statistics --mlir-pass-statistics-display=list -o /dev/null 2>&1 | FileCheck %s --check-prefix=EDITED
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Unchanged circuits reuse the sequences converted by an earlier compilation,
+// circuits calling an edited calibration are converted again.
+
+// UNCHANGED: (S) {{ *}}2 num-cached-sequences
+// EDITED: (S) {{ *}}1 num-cached-sequences
+
+module {
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 3 : i32}) attributes {quir.classicalOnly = false, quir.physicalIds = [3 : i32]} {
+    quir.call_gate @x(%arg0) {pulse.calName = "x_3"} : (!quir.qubit<1>) -> ()
+    quir.return
+  }
+  quir.circuit @circuit_1(%arg0: !quir.qubit<1> {quir.physicalId = 3 : i32}) attributes {quir.classicalOnly = false, quir.physicalIds = [3 : i32]} {
+    quir.call_gate @sx(%arg0) {pulse.calName = "sx_3"} : (!quir.qubit<1>) -> ()
+    quir.return
+  }
+  pulse.sequence @x_3(%arg0: !pulse.mixed_frame) attributes {pulse.argPorts = ["q3-drive-port"], pulse.args = ["q3-drive-mixframe"]} {
+    %x3_pulse = pulse.create_waveform {pulse.waveformName = "x3_pulse"} dense<[[0.0, 1.0], [0.0, 1.0], [1.0, 1.0], [0.0, 1.0]]> : tensor<4x2xf64> -> !pulse.waveform
+    pulse.play {pulse.duration = 4 : i64, pulse.timepoint = 0 : i64}(%arg0, %x3_pulse) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.return
+  }
+  pulse.sequence @sx_3(%arg0: !pulse.mixed_frame) attributes {pulse.argPorts = ["q3-drive-port"], pulse.args = ["q3-drive-mixframe"]} {
+    pulse.call_sequence @sx_3_play(%arg0) : (!pulse.mixed_frame) -> ()
+    pulse.return
+  }
+  // the edit changes a callee of the calibration called by circuit_1
+  pulse.sequence @sx_3_play(%arg0: !pulse.mixed_frame) attributes {pulse.argPorts = ["q3-drive-port"], pulse.args = ["q3-drive-mixframe"]} {
+    %sx3_pulse = pulse.create_waveform {pulse.waveformName = "sx3_pulse"} dense<[[0.0, 0.25], [0.0, 0.25], [0.25, 0.25], [0.0, 0.25]]> : tensor<4x2xf64> -> !pulse.waveform
+    pulse.play {pulse.duration = 4 : i64, pulse.timepoint = 0 : i64}(%arg0, %sx3_pulse) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.return
+  }
+  // CHECK: pulse.sequence @circuit_0_sequence(%arg0: !pulse.mixed_frame) {
+  // CHECK-NEXT: pulse.call_sequence @x_3(%arg0) : (!pulse.mixed_frame) -> ()
+  // CHECK: pulse.sequence @circuit_1_sequence(%arg0: !pulse.mixed_frame) {
+  // CHECK-NEXT: pulse.call_sequence @sx_3(%arg0) : (!pulse.mixed_frame) -> ()
+
+  func.func @main() -> i32 attributes {quir.classicalOnly = false} {
+    // CHECK: %0 = "pulse.create_port"() {uid = "q3-drive-port"} : () -> !pulse.port
+    // CHECK: %1 = "pulse.mix_frame"(%0) {uid = "q3-drive-mixframe"} : (!pulse.port) -> !pulse.mixed_frame
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+    quir.call_circuit @circuit_0(%0) : (!quir.qubit<1>) -> ()
+    // CHECK: pulse.call_sequence @circuit_0_sequence(%1) : (!pulse.mixed_frame) -> ()
+    quir.call_circuit @circuit_1(%0) : (!quir.qubit<1>) -> ()
+    // CHECK: pulse.call_sequence @circuit_1_sequence(%1) : (!pulse.mixed_frame) -> ()
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,46 @@
+// RUN: qss-opt %s --load-pulse-cals -verify-diagnostics
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// A missing pulse calibration, of a gate or of a qubit of a merged one, is
+// reported at the first operation which needs it, and only once however
+// many times the circuit is called.
+
+module {
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1>, %arg1: !quir.qubit<1>) -> (i1, i1) {
+    // expected-error@+1 {{could not find any pulse calibration for x_0}}
+    quir.call_gate @x(%arg0) : (!quir.qubit<1>) -> ()
+    // measure_0_1 is merged from the pulse cals of each qubit
+    // expected-error@+1 {{could not find any pulse calibration for measure_1}}
+    %0:2 = quir.measure(%arg0, %arg1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+    quir.return %0#0, %0#1 : i1, i1
+  }
+  pulse.sequence @measure_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1
+  attributes {pulse.argPorts = ["q0-readout-port", "q0-capture-port"],
+  pulse.args = ["q0-readout-mixframe", "q0-capture-mixframe"]} {
+    %q0_readout = pulse.create_waveform {pulse.waveformName = "q0_readout_pulse"} dense<[[0.0, 1.0], [0.0, 1.0], [1.0, 1.0], [0.0, 1.0]]> : tensor<4x2xf64> -> !pulse.waveform
+    pulse.play {pulse.duration = 4 : i64, pulse.timepoint = 0 : i64}(%arg0, %q0_readout) : (!pulse.mixed_frame, !pulse.waveform)
+    %0 = pulse.capture {pulse.duration = 16 : i64, pulse.timepoint = 4 : i64}(%arg1) : (!pulse.mixed_frame) -> i1
+    pulse.return %0 : i1
+  }
+
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %2:2 = quir.call_circuit @circuit_0(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+    %3:2 = quir.call_circuit @circuit_0(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,102 @@
+// RUN: qss-compiler %s --quir-to-pulse > %t.parallel.mlir
+// RUN: qss-compiler %s --quir-to-pulse --mlir-disable-threading > %t.serial.mlir
+// RUN: diff %t.serial.mlir %t.parallel.mlir
+// RUN: FileCheck %s --input-file %t.parallel.mlir
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The circuits of a program are converted in parallel. The output must be
+// identical to the serial conversion: the ports, mixed frames and sequences
+// are created in the order of the circuit calls.
+
+module {
+  quir.circuit @circuit_a(%arg0: !quir.qubit<1> {quir.physicalId = 1 : i32}) attributes {quir.classicalOnly = false, quir.physicalIds = [1 : i32]} {
+    quir.call_gate @x(%arg0) {pulse.calName = "x_1"} : (!quir.qubit<1>) -> ()
+    quir.return
+  }
+  quir.circuit @circuit_b(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.angle<64>) attributes {quir.classicalOnly = false, quir.physicalIds = [0 : i32]} {
+    quir.call_gate @rz(%arg0, %arg1) {pulse.calName = "rz_0"} : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    quir.call_gate @x(%arg0) {pulse.calName = "x_0"} : (!quir.qubit<1>) -> ()
+    quir.return
+  }
+  quir.circuit @circuit_c(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}) -> i1 attributes {quir.classicalOnly = false, quir.physicalIds = [0 : i32]} {
+    %0 = quir.measure(%arg0) {pulse.calName = "measure_0"} : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  quir.circuit @circuit_d(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.qubit<1> {quir.physicalId = 1 : i32}) attributes {quir.classicalOnly = false, quir.physicalIds = [0 : i32, 1 : i32]} {
+    quir.call_gate @x(%arg1) {pulse.calName = "x_1"} : (!quir.qubit<1>) -> ()
+    quir.call_gate @x(%arg0) {pulse.calName = "x_0"} : (!quir.qubit<1>) -> ()
+    quir.return
+  }
+  pulse.sequence @x_0(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["q0-drive-port"], pulse.args = ["q0-drive-mixframe"]} {
+    %x0_pulse = pulse.create_waveform {pulse.waveformName = "x0_pulse"} dense<[[0.0, 1.0], [0.0, 1.0], [1.0, 1.0], [0.0, 1.0]]> : tensor<4x2xf64> -> !pulse.waveform
+    pulse.play {pulse.duration = 4 : i64, pulse.timepoint = 0 : i64}(%arg0, %x0_pulse) : (!pulse.mixed_frame, !pulse.waveform)
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+  pulse.sequence @x_1(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["q1-drive-port"], pulse.args = ["q1-drive-mixframe"]} {
+    %x1_pulse = pulse.create_waveform {pulse.waveformName = "x1_pulse"} dense<[[0.0, 1.0], [1.0, 1.0], [1.0, 1.0], [0.0, 1.0]]> : tensor<4x2xf64> -> !pulse.waveform
+    pulse.play {pulse.duration = 4 : i64, pulse.timepoint = 0 : i64}(%arg0, %x1_pulse) : (!pulse.mixed_frame, !pulse.waveform)
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+  pulse.sequence @rz_0(%arg0: f64, %arg1: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["", "q0-drive-port"], pulse.args = ["angle", "q0-drive-mixframe"]} {
+    pulse.shift_phase {pulse.timepoint = 0 : i64}(%arg1, %arg0) : (!pulse.mixed_frame, f64)
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+  pulse.sequence @measure_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1
+  attributes {pulse.argPorts = ["q0-readout-port", "q0-capture-port"],
+  pulse.args = ["q0-readout-mixframe", "q0-capture-mixframe"]} {
+    %q0_readout = pulse.create_waveform {pulse.waveformName = "q0_readout_pulse"} dense<[[0.0, 1.0], [0.0, 1.0], [1.0, 1.0], [0.0, 1.0]]> : tensor<4x2xf64> -> !pulse.waveform
+    pulse.play {pulse.duration = 4 : i64, pulse.timepoint = 0 : i64}(%arg0, %q0_readout) : (!pulse.mixed_frame, !pulse.waveform)
+    %0 = pulse.capture {pulse.duration = 16 : i64, pulse.timepoint = 4 : i64}(%arg1) : (!pulse.mixed_frame) -> i1
+    pulse.return %0 : i1
+  }
+
+  // CHECK: pulse.sequence @circuit_a_sequence(
+  // CHECK: pulse.sequence @circuit_b_sequence(
+  // CHECK: pulse.sequence @circuit_c_sequence(
+  // CHECK: pulse.sequence @circuit_d_sequence(
+
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 attributes {quir.classicalOnly = false} {
+    // CHECK: %[[Q1_DRIVE:.*]] = "pulse.create_port"() {uid = "q1-drive-port"}
+    // CHECK: %[[Q1_FRAME:.*]] = "pulse.mix_frame"(%[[Q1_DRIVE]]) {uid = "q1-drive-mixframe"}
+    // CHECK: %[[Q0_DRIVE:.*]] = "pulse.create_port"() {uid = "q0-drive-port"}
+    // CHECK: %[[Q0_FRAME:.*]] = "pulse.mix_frame"(%[[Q0_DRIVE]]) {uid = "q0-drive-mixframe"}
+    // CHECK: "pulse.create_port"() {uid = "q0-readout-port"}
+    // CHECK: "pulse.mix_frame"(%{{.*}}) {uid = "q0-readout-mixframe"}
+    // CHECK: "pulse.create_port"() {uid = "q0-capture-port"}
+    // CHECK: "pulse.mix_frame"(%{{.*}}) {uid = "q0-capture-mixframe"}
+    // CHECK-NOT: pulse.create_port
+    // CHECK-NOT: pulse.mix_frame
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %theta = quir.constant #quir.angle<5.000000e-01> : !quir.angle<64>
+    %phi = quir.constant #quir.angle<2.500000e-01> : !quir.angle<64>
+    // CHECK: pulse.call_sequence @circuit_a_sequence(%[[Q1_FRAME]])
+    quir.call_circuit @circuit_a(%1) : (!quir.qubit<1>) -> ()
+    // CHECK: pulse.call_sequence @circuit_b_sequence{{(_[0-9]+)?}}(%{{.*}}, %[[Q0_FRAME]])
+    quir.call_circuit @circuit_b(%0, %theta) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    // CHECK: pulse.call_sequence @circuit_c_sequence(
+    %2 = quir.call_circuit @circuit_c(%0) : (!quir.qubit<1>) -> i1
+    // CHECK: pulse.call_sequence @circuit_b_sequence{{(_[0-9]+)?}}(%{{.*}}, %[[Q0_FRAME]])
+    quir.call_circuit @circuit_b(%0, %phi) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    // CHECK: pulse.call_sequence @circuit_d_sequence(
+    quir.call_circuit @circuit_d(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    return %c0_i32 : i32
+  }
+}
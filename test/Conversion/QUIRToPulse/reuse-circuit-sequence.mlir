@@ -0,0 +1,58 @@
+// RUN: qss-compiler %s --quir-to-pulse | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Calls of the same circuit share a single converted pulse sequence.
+
+module {
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 3 : i32}) -> i1 attributes {quir.classicalOnly = false, quir.physicalIds = [3 : i32]} {
+    quir.call_gate @x(%arg0) {pulse.calName = "x_3"} : (!quir.qubit<1>) -> ()
+    %0 = quir.measure(%arg0) {pulse.calName = "measure_3"} : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  pulse.sequence @x_3(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["q3-drive-port"], pulse.args = ["q3-drive-mixframe"]} {
+    %x3_pulse = pulse.create_waveform {pulse.waveformName = "x3_pulse"} dense<[[0.0, 1.0], [0.0, 1.0], [1.0, 1.0], [0.0, 1.0]]> : tensor<4x2xf64> -> !pulse.waveform
+    pulse.play {pulse.duration = 4 : i64, pulse.timepoint = 0 : i64}(%arg0, %x3_pulse) : (!pulse.mixed_frame, !pulse.waveform)
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+  pulse.sequence @measure_3(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1
+  attributes {pulse.argPorts = ["q3-readout-port", "q3-capture-port"],
+  pulse.args = ["q3-readout-mixframe", "q3-capture-mixframe"]} {
+    %q3_readout = pulse.create_waveform {pulse.waveformName = "q3_readout_pulse"} dense<[[0.0, 1.0], [0.0, 1.0], [1.0, 1.0], [0.0, 1.0]]> : tensor<4x2xf64> -> !pulse.waveform
+    pulse.play {pulse.duration = 4 : i64, pulse.timepoint = 0 : i64}(%arg0, %q3_readout) : (!pulse.mixed_frame, !pulse.waveform)
+    %0 = pulse.capture {pulse.duration = 16 : i64, pulse.timepoint = 4 : i64}(%arg1) : (!pulse.mixed_frame) -> i1
+    pulse.return %0 : i1
+  }
+  // CHECK: pulse.sequence @circuit_0_sequence(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.mixed_frame) -> (i1, i1) {
+  // CHECK-NOT: pulse.sequence @circuit_0_sequence
+
+  func.func @main() -> i32 attributes {quir.classicalOnly = false} {
+    // CHECK: %0 = "pulse.create_port"() {uid = "q3-drive-port"} : () -> !pulse.port
+    // CHECK: %1 = "pulse.mix_frame"(%0) {uid = "q3-drive-mixframe"} : (!pulse.port) -> !pulse.mixed_frame
+    // CHECK: %2 = "pulse.create_port"() {uid = "q3-readout-port"} : () -> !pulse.port
+    // CHECK: %3 = "pulse.mix_frame"(%2) {uid = "q3-readout-mixframe"} : (!pulse.port) -> !pulse.mixed_frame
+    // CHECK: %4 = "pulse.create_port"() {uid = "q3-capture-port"} : () -> !pulse.port
+    // CHECK: %5 = "pulse.mix_frame"(%4) {uid = "q3-capture-mixframe"} : (!pulse.port) -> !pulse.mixed_frame
+    // CHECK-NOT: pulse.create_port
+    // CHECK-NOT: pulse.mix_frame
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+    %1 = quir.call_circuit @circuit_0(%0) : (!quir.qubit<1>) -> i1
+    // CHECK: %6:2 = pulse.call_sequence @circuit_0_sequence(%1, %3, %5) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame) -> (i1, i1)
+    %2 = quir.call_circuit @circuit_0(%0) : (!quir.qubit<1>) -> i1
+    // CHECK: %7:2 = pulse.call_sequence @circuit_0_sequence(%1, %3, %5) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame) -> (i1, i1)
+    return %c0_i32 : i32
+  }
+}
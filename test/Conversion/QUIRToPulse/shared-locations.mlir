@@ -0,0 +1,84 @@
+// RUN: qss-compiler %s --quir-to-pulse | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The angles of a U gate written on one line share the location emitted by
+// --qasm3-locations=line, or carry no location with --qasm3-locations=none.
+// Each of them must still be converted to a constant of its own.
+
+#line = loc("u.qasm":3:0)
+
+module {
+  quir.circuit @circuit_line(%arg0: !quir.qubit<1> {quir.physicalId = 3 : i32}, %arg1: !quir.angle<64>, %arg2: !quir.angle<64>, %arg3: !quir.angle<64>) attributes {quir.classicalOnly = false, quir.physicalIds = [3 : i32]} {
+    %theta = quir.constant #quir.angle<2.500000e-01> : !quir.angle<64> loc(#line)
+    %phi = quir.constant #quir.angle<5.000000e-01> : !quir.angle<64> loc(#line)
+    %lambda = quir.constant #quir.angle<7.500000e-01> : !quir.angle<64> loc(#line)
+    quir.builtin_U {pulse.calName = "u_3"} %arg0, %theta, %phi, %lambda : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64> loc(#line)
+    quir.builtin_U {pulse.calName = "u_3"} %arg0, %arg1, %arg2, %arg3 : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64> loc(#line)
+    quir.return loc(#line)
+  } loc(#line)
+  quir.circuit @circuit_none(%arg0: !quir.qubit<1> {quir.physicalId = 3 : i32}, %arg1: !quir.angle<64>, %arg2: !quir.angle<64>, %arg3: !quir.angle<64>) attributes {quir.classicalOnly = false, quir.physicalIds = [3 : i32]} {
+    %theta = quir.constant #quir.angle<1.250000e-01> : !quir.angle<64> loc(unknown)
+    %phi = quir.constant #quir.angle<3.750000e-01> : !quir.angle<64> loc(unknown)
+    %lambda = quir.constant #quir.angle<6.250000e-01> : !quir.angle<64> loc(unknown)
+    quir.builtin_U {pulse.calName = "u_3"} %arg0, %theta, %phi, %lambda : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64> loc(unknown)
+    quir.builtin_U {pulse.calName = "u_3"} %arg0, %arg1, %arg2, %arg3 : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64> loc(unknown)
+    quir.return loc(unknown)
+  } loc(unknown)
+  pulse.sequence @u_3(%arg0: f64, %arg1: f64, %arg2: f64, %arg3: !pulse.mixed_frame) -> i1
+  attributes {pulse.argPorts = ["", "", "", "q3-drive-port"], pulse.args = ["angle", "angle", "angle", "q3-drive-mixframe"]} {
+    pulse.shift_phase {pulse.timepoint = 0 : i64}(%arg3, %arg0) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase {pulse.timepoint = 0 : i64}(%arg3, %arg1) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase {pulse.timepoint = 0 : i64}(%arg3, %arg2) : (!pulse.mixed_frame, f64)
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+
+  // CHECK-LABEL: pulse.sequence @circuit_line_sequence(%arg0: f64, %arg1: f64, %arg2: f64, %arg3: !pulse.mixed_frame)
+  // CHECK-DAG: %[[THETA:.*]] = arith.constant 2.500000e-01 : f64
+  // CHECK-DAG: %[[PHI:.*]] = arith.constant 5.000000e-01 : f64
+  // CHECK-DAG: %[[LAMBDA:.*]] = arith.constant 7.500000e-01 : f64
+  // CHECK: pulse.call_sequence @u_3(%[[THETA]], %[[PHI]], %[[LAMBDA]], %arg3)
+  // CHECK: pulse.call_sequence @u_3(%arg0, %arg1, %arg2, %arg3)
+
+  // CHECK-LABEL: pulse.sequence @circuit_none_sequence(%arg0: f64, %arg1: f64, %arg2: f64, %arg3: !pulse.mixed_frame)
+  // CHECK-DAG: %[[THETA:.*]] = arith.constant 1.250000e-01 : f64
+  // CHECK-DAG: %[[PHI:.*]] = arith.constant 3.750000e-01 : f64
+  // CHECK-DAG: %[[LAMBDA:.*]] = arith.constant 6.250000e-01 : f64
+  // CHECK: pulse.call_sequence @u_3(%[[THETA]], %[[PHI]], %[[LAMBDA]], %arg3)
+  // CHECK: pulse.call_sequence @u_3(%arg0, %arg1, %arg2, %arg3)
+
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 attributes {quir.classicalOnly = false} {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+    // CHECK-DAG: %[[LINE_THETA:.*]] = arith.constant 1.250000e+00 : f64
+    // CHECK-DAG: %[[LINE_PHI:.*]] = arith.constant 1.500000e+00 : f64
+    // CHECK-DAG: %[[LINE_LAMBDA:.*]] = arith.constant 1.750000e+00 : f64
+    %theta = quir.constant #quir.angle<1.250000e+00> : !quir.angle<64> loc(#line)
+    %phi = quir.constant #quir.angle<1.500000e+00> : !quir.angle<64> loc(#line)
+    %lambda = quir.constant #quir.angle<1.750000e+00> : !quir.angle<64> loc(#line)
+    // CHECK: pulse.call_sequence @circuit_line_sequence(%[[LINE_THETA]], %[[LINE_PHI]], %[[LINE_LAMBDA]], %{{.*}})
+    quir.call_circuit @circuit_line(%0, %theta, %phi, %lambda) : (!quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>) -> () loc(#line)
+    // CHECK-DAG: %[[NONE_THETA:.*]] = arith.constant 2.250000e+00 : f64
+    // CHECK-DAG: %[[NONE_PHI:.*]] = arith.constant 2.500000e+00 : f64
+    // CHECK-DAG: %[[NONE_LAMBDA:.*]] = arith.constant 2.750000e+00 : f64
+    %theta_none = quir.constant #quir.angle<2.250000e+00> : !quir.angle<64> loc(unknown)
+    %phi_none = quir.constant #quir.angle<2.500000e+00> : !quir.angle<64> loc(unknown)
+    %lambda_none = quir.constant #quir.angle<2.750000e+00> : !quir.angle<64> loc(unknown)
+    // CHECK: pulse.call_sequence @circuit_none_sequence(%[[NONE_THETA]], %[[NONE_PHI]], %[[NONE_LAMBDA]], %{{.*}})
+    quir.call_circuit @circuit_none(%0, %theta_none, %phi_none, %lambda_none) : (!quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>) -> () loc(unknown)
+    return %c0_i32 : i32
+  }
+}
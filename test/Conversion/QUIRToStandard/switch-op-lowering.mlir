@@ -0,0 +1,150 @@
+// RUN: qss-opt --test-switch-op-lowering %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that a quir.switch with dense or many case values lowers
+// to a cf.switch, and one with a few sparse case values to a chain of
+// comparisons, each routing the remaining values to the default region.
+
+// CHECK-LABEL: func.func @dense(
+// CHECK-NOT: arith.cmpi
+// CHECK: cf.switch %arg0 : i32, [
+// CHECK-NEXT: default: ^[[DEFAULT:bb[0-9]+]],
+// CHECK-NEXT: 0: ^[[CASE0:bb[0-9]+]],
+// CHECK-NEXT: 1: ^[[CASE1:bb[0-9]+]],
+// CHECK-NEXT: 2: ^[[CASE2:bb[0-9]+]],
+// CHECK-NEXT: 3: ^[[CASE3:bb[0-9]+]]
+// CHECK-NEXT: ]
+// CHECK: ^[[DEFAULT]]:
+// CHECK-NEXT: %{{.*}} = arith.constant 99 : i32
+// CHECK-NEXT: cf.br ^[[END:bb[0-9]+]](
+// CHECK: ^[[CASE0]]:
+// CHECK-NEXT: %{{.*}} = arith.constant 10 : i32
+// CHECK: ^[[CASE3]]:
+// CHECK-NEXT: %{{.*}} = arith.constant 13 : i32
+// CHECK-NEXT: cf.br ^[[END]](
+// CHECK: ^[[END]](%[[Y:[0-9]+]]: i32):
+// CHECK-NEXT: return %[[Y]] : i32
+func.func @dense(%flag: i32) -> i32 {
+  %y = quir.switch %flag -> (i32) {
+    %def = arith.constant 99 : i32
+    quir.yield %def : i32
+  } [
+    0: {
+      %y_0 = arith.constant 10 : i32
+      quir.yield %y_0 : i32
+    }
+    1: {
+      %y_1 = arith.constant 11 : i32
+      quir.yield %y_1 : i32
+    }
+    2: {
+      %y_2 = arith.constant 12 : i32
+      quir.yield %y_2 : i32
+    }
+    3: {
+      %y_3 = arith.constant 13 : i32
+      quir.yield %y_3 : i32
+    }
+  ]
+  return %y : i32
+}
+
+// CHECK-LABEL: func.func @sparse(
+// CHECK-NOT: cf.switch
+// CHECK: %[[C8:.*]] = arith.constant 8 : i32
+// CHECK-NEXT: %[[IS8:.*]] = arith.cmpi eq, %arg0, %[[C8]] : i32
+// CHECK-NEXT: cf.cond_br %[[IS8]], ^[[CASE8:bb[0-9]+]], ^[[TEST64:bb[0-9]+]]
+// CHECK: ^[[TEST64]]:
+// CHECK-NEXT: %[[C64:.*]] = arith.constant 64 : i32
+// CHECK-NEXT: %[[IS64:.*]] = arith.cmpi eq, %arg0, %[[C64]] : i32
+// CHECK-NEXT: cf.cond_br %[[IS64]], ^[[CASE64:bb[0-9]+]], ^[[TEST512:bb[0-9]+]]
+// CHECK: ^[[TEST512]]:
+// CHECK-NEXT: %[[C512:.*]] = arith.constant 512 : i32
+// CHECK-NEXT: %[[IS512:.*]] = arith.cmpi eq, %arg0, %[[C512]] : i32
+// CHECK-NEXT: cf.cond_br %[[IS512]], ^[[CASE512:bb[0-9]+]], ^[[DEFAULT:bb[0-9]+]]
+// CHECK: ^[[DEFAULT]]:
+// CHECK-NEXT: %{{.*}} = arith.constant 99 : i32
+// CHECK-NEXT: cf.br ^[[END:bb[0-9]+]](
+// CHECK: ^[[CASE8]]:
+// CHECK-NEXT: %{{.*}} = arith.constant 10 : i32
+// CHECK: ^[[CASE64]]:
+// CHECK-NEXT: %{{.*}} = arith.constant 11 : i32
+// CHECK: ^[[CASE512]]:
+// CHECK-NEXT: %{{.*}} = arith.constant 12 : i32
+// CHECK-NEXT: cf.br ^[[END]](
+// CHECK: ^[[END]](%[[Y:[0-9]+]]: i32):
+// CHECK-NEXT: return %[[Y]] : i32
+func.func @sparse(%flag: i32) -> i32 {
+  %y = quir.switch %flag -> (i32) {
+    %def = arith.constant 99 : i32
+    quir.yield %def : i32
+  } [
+    8: {
+      %y_8 = arith.constant 10 : i32
+      quir.yield %y_8 : i32
+    }
+    64: {
+      %y_64 = arith.constant 11 : i32
+      quir.yield %y_64 : i32
+    }
+    512: {
+      %y_512 = arith.constant 12 : i32
+      quir.yield %y_512 : i32
+    }
+  ]
+  return %y : i32
+}
+
+// Too many sparse case values for a chain of comparisons
+// CHECK-LABEL: func.func @many_sparse(
+// CHECK-NOT: arith.cmpi
+// CHECK: cf.switch %arg0 : i32, [
+// CHECK-NEXT: default: ^[[DEFAULT:bb[0-9]+]],
+// CHECK-NEXT: 1: ^{{bb[0-9]+}},
+// CHECK-NEXT: 10: ^{{bb[0-9]+}},
+// CHECK-NEXT: 100: ^{{bb[0-9]+}},
+// CHECK-NEXT: 1000: ^{{bb[0-9]+}},
+// CHECK-NEXT: 10000: ^{{bb[0-9]+}}
+// CHECK-NEXT: ]
+// CHECK: ^[[DEFAULT]]:
+// CHECK-NEXT: %{{.*}} = arith.constant 99 : i32
+func.func @many_sparse(%flag: i32) -> i32 {
+  %y = quir.switch %flag -> (i32) {
+    %def = arith.constant 99 : i32
+    quir.yield %def : i32
+  } [
+    1: {
+      %y_1 = arith.constant 10 : i32
+      quir.yield %y_1 : i32
+    }
+    10: {
+      %y_10 = arith.constant 11 : i32
+      quir.yield %y_10 : i32
+    }
+    100: {
+      %y_100 = arith.constant 12 : i32
+      quir.yield %y_100 : i32
+    }
+    1000: {
+      %y_1000 = arith.constant 13 : i32
+      quir.yield %y_1000 : i32
+    }
+    10000: {
+      %y_10000 = arith.constant 14 : i32
+      quir.yield %y_10000 : i32
+    }
+  ]
+  return %y : i32
+}
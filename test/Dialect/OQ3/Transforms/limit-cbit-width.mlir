@@ -29,6 +29,13 @@ module {
   // CHECK: oq3.declare_variable @assignment1_0 : !quir.cbit<32>
   // CHECK: oq3.declare_variable @assignment1_1 : !quir.cbit<4>
 
+  // test splitting a multiple of the maximum width
+  oq3.declare_variable @exact : !quir.cbit<64>
+  // CHECK-NOT: oq3.declare_variable @exact : !quir.cbit<64>
+  // CHECK: oq3.declare_variable @exact_0 : !quir.cbit<32>
+  // CHECK: oq3.declare_variable @exact_1 : !quir.cbit<32>
+  // CHECK-NOT: oq3.declare_variable @exact_2
+
   // test initialization into original narrow array - no change
   %0 = "oq3.cast"(%c0_i4) : (i4) -> !quir.cbit<4>
   oq3.variable_assign @meas : !quir.cbit<4> = %0
@@ -96,12 +103,13 @@ module {
     %15 = oq3.cbit_extractbit(%14 : !quir.cbit<36>) [0] : i1
     oq3.cbit_assign_bit @assignment1<36> [35] : i1 = %15
   }
-  // CHECK: {{%.*}} = oq3.variable_load @assignment1_0 : !quir.cbit<32>
-  // CHECK: {{%.*}} = oq3.variable_load @assignment1_1 : !quir.cbit<4>
-  // CHECK: [[COND:%.*]] = oq3.cbit_extractbit(%15 : !quir.cbit<4>) [3] : i1
+  // only the registers holding extracted bits are loaded
+  // CHECK-NOT: oq3.variable_load @assignment1_0
+  // CHECK: [[LOAD:%.*]] = oq3.variable_load @assignment1_1 : !quir.cbit<4>
+  // CHECK: [[COND:%.*]] = oq3.cbit_extractbit([[LOAD]] : !quir.cbit<4>) [3] : i1
   // CHECK: scf.if [[COND]] {
   // CHECK: [[LOADLOWER:%.*]] = oq3.variable_load @assignment1_0 : !quir.cbit<32>
-  // CHECK: [[LOADUPPER:%.*]] = oq3.variable_load @assignment1_1 : !quir.cbit<4>
+  // CHECK-NOT: oq3.variable_load @assignment1_1
   // CHECK: [[EXTRACTLOWER:%.*]] = oq3.cbit_extractbit([[LOADLOWER]] : !quir.cbit<32>) [0] : i1
   // CHECK: oq3.cbit_assign_bit @assignment1_1<4> [3] : i1 = [[EXTRACTLOWER]]
 
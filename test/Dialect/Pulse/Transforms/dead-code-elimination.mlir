@@ -0,0 +1,83 @@
+// RUN: qss-compiler -X=mlir --pulse-dce %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that frame updates of frames which are never played on
+// are removed along with the sequence arguments, ports, frames and waveforms
+// which are left unused.
+
+// CHECK-LABEL: func.func @main
+func.func @main() -> i32 {
+    // CHECK: %[[P0:.*]] = "pulse.create_port"() {uid = "p0"}
+    // CHECK-NOT: "pulse.create_port"() {uid = "p1"}
+    // CHECK: %[[MF0:.*]] = "pulse.mix_frame"(%[[P0]]) {uid = "mf0-p0"}
+    // CHECK-NOT: "pulse.mix_frame"
+    %0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %1 = "pulse.create_port"() {uid = "p1"} : () -> !pulse.port
+    %2 = "pulse.mix_frame"(%0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %3 = "pulse.mix_frame"(%1) {uid = "mf0-p1"} : (!pulse.port) -> !pulse.mixed_frame
+    %4 = "pulse.mix_frame"(%1) {uid = "mf1-p1"} : (!pulse.port) -> !pulse.mixed_frame
+
+    // CHECK: pulse.call_sequence @seq_0(%[[MF0]]) : (!pulse.mixed_frame) -> i1
+    %5 = pulse.call_sequence @seq_0(%2, %3, %4) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame) -> i1
+
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+}
+
+// CHECK: pulse.sequence @seq_0(%arg0: !pulse.mixed_frame) -> i1
+pulse.sequence @seq_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.mixed_frame) -> i1 {
+    %c0_i1 = arith.constant 0 : i1
+    %c16_i32 = arith.constant 16 : i32
+    %cst = arith.constant 1.57 : f64
+    %amp = complex.constant [0.5, 0.0] : complex<f64>
+    // CHECK-NOT: pulse.const_waveform
+    %wfr_unused = pulse.const_waveform(%c16_i32, %amp) : (i32, complex<f64>) -> !pulse.waveform
+    // CHECK: %[[WFR:.*]] = pulse.const_waveform
+    %wfr = pulse.const_waveform(%c16_i32, %amp) : (i32, complex<f64>) -> !pulse.waveform
+
+    // CHECK: pulse.shift_phase(%arg0, %{{.*}}) : (!pulse.mixed_frame, f64)
+    // CHECK-NOT: pulse.shift_phase
+    // CHECK-NOT: pulse.set_frequency
+    // CHECK-NOT: pulse.delay
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase(%arg1, %cst) : (!pulse.mixed_frame, f64)
+    pulse.set_frequency(%arg1, %cst) : (!pulse.mixed_frame, f64)
+    pulse.delay(%arg1, %c16_i32) : (!pulse.mixed_frame, i32)
+
+    // the frame is only played on by the nested sequence
+    // CHECK: pulse.call_sequence @seq_1(%arg0, %[[WFR]])
+    // CHECK-NOT: pulse.call_sequence @seq_1
+    pulse.call_sequence @seq_1(%arg0, %wfr, %arg2) : (!pulse.mixed_frame, !pulse.waveform, !pulse.mixed_frame) -> ()
+    pulse.return %c0_i1 : i1
+}
+
+// CHECK: pulse.sequence @seq_1(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform)
+pulse.sequence @seq_1(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform, %arg2: !pulse.mixed_frame) {
+    %cst = arith.constant 0.5 : f64
+    // CHECK-NOT: pulse.set_phase
+    pulse.set_phase(%arg2, %cst) : (!pulse.mixed_frame, f64)
+    // CHECK: pulse.play(%arg0, %arg1)
+    pulse.play(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.return
+}
+
+// Frame updates of sequences without callers are kept
+// CHECK-LABEL: pulse.sequence @entry
+pulse.sequence @entry(%arg0: !pulse.mixed_frame) {
+    %cst = arith.constant 0.5 : f64
+    // CHECK: pulse.shift_phase(%arg0, %{{.*}})
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.return
+}
@@ -0,0 +1,54 @@
+// RUN: qss-compiler -X=mlir --pulse-deduplicate-waveforms %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that waveforms with identical samples are interned once
+// in the waveform container and labeled with the name of the interned copy.
+
+// CHECK: pulse.waveform_container {
+// CHECK-NEXT: pulse.create_waveform {pulse.waveformName = "X90"} dense<{{\[\[}}0.000000e+00, 5.000000e-01], [5.000000e-01, 5.000000e-01]]>
+// CHECK-NEXT: pulse.create_waveform {pulse.waveformName = "[[DRAG:wfr_[0-9a-f]{16}]]"} dense<{{\[\[}}1.000000e-01, 2.000000e-01], [3.000000e-01, 4.000000e-01]]>
+// CHECK-NEXT: }
+pulse.waveform_container {
+  %0 = pulse.create_waveform {pulse.waveformName = "X90"} dense<[[0.0, 0.5], [0.5, 0.5]]> : tensor<2x2xf64> -> !pulse.waveform
+}
+
+// CHECK-LABEL: pulse.sequence @drag_q0
+pulse.sequence @drag_q0(%arg0: !pulse.mixed_frame) {
+  // CHECK: %[[WFR:.*]] = pulse.create_waveform {pulse.waveformName = "[[DRAG]]"}
+  // CHECK-NOT: pulse.create_waveform
+  // CHECK: pulse.play(%arg0, %[[WFR]])
+  // CHECK: pulse.play(%arg0, %[[WFR]])
+  %0 = pulse.create_waveform dense<[[0.1, 0.2], [0.3, 0.4]]> : tensor<2x2xf64> -> !pulse.waveform
+  pulse.play(%arg0, %0) : (!pulse.mixed_frame, !pulse.waveform)
+  %1 = pulse.create_waveform dense<[[0.1, 0.2], [0.3, 0.4]]> : tensor<2x2xf64> -> !pulse.waveform
+  pulse.play(%arg0, %1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// CHECK-LABEL: pulse.sequence @drag_q1
+pulse.sequence @drag_q1(%arg0: !pulse.mixed_frame) {
+  // CHECK: pulse.create_waveform {pulse.waveformName = "[[DRAG]]"}
+  %0 = pulse.create_waveform dense<[[0.1, 0.2], [0.3, 0.4]]> : tensor<2x2xf64> -> !pulse.waveform
+  pulse.play(%arg0, %0) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// CHECK-LABEL: pulse.sequence @x90_q0
+pulse.sequence @x90_q0(%arg0: !pulse.mixed_frame) {
+  // CHECK: pulse.create_waveform {pulse.waveformName = "X90"}
+  %0 = pulse.create_waveform dense<[[0.0, 0.5], [0.5, 0.5]]> : tensor<2x2xf64> -> !pulse.waveform
+  pulse.play(%arg0, %0) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
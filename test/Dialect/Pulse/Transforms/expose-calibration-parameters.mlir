@@ -0,0 +1,64 @@
+// RUN: qss-compiler -X=mlir --pulse-expose-calibration-parameters %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-expose-calibration-parameters=frequencies=false %s | FileCheck %s --check-prefix=AMPS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Test that the constant amplitudes and frequencies of the pulse sequences
+// are exposed as input parameters.
+
+module {
+  // CHECK: qcs.declare_parameter @x_0.amp0.real : f64 = 5.000000e-01 : f64
+  // CHECK: qcs.declare_parameter @x_0.amp0.imag : f64 = 0.000000e+00 : f64
+  // CHECK: qcs.declare_parameter @x_0.freq0 : f64 = 5.000000e+09 : f64
+  // CHECK: qcs.declare_parameter @measure_0.amp0.real : f64 = 2.500000e-01 : f64
+  // CHECK: qcs.declare_parameter @measure_0.amp0.imag : f64 = 1.000000e-01 : f64
+  // AMPS-NOT: qcs.declare_parameter @x_0.freq0
+  pulse.sequence @x_0(%arg0: !pulse.mixed_frame) {
+    %c160_i32 = arith.constant 160 : i32
+    %c40_i32 = arith.constant 40 : i32
+    %cst = arith.constant 5.000000e-01 : f64
+    %cst_0 = arith.constant 0.000000e+00 : f64
+    %beta = arith.constant 1.000000e-01 : f64
+    %freq = arith.constant 5.000000e+09 : f64
+    // CHECK-DAG: %[[REAL:.*]] = qcs.parameter_load @x_0.amp0.real : f64
+    // CHECK-DAG: %[[IMAG:.*]] = qcs.parameter_load @x_0.amp0.imag : f64
+    // CHECK-DAG: %[[FREQ:.*]] = qcs.parameter_load @x_0.freq0 : f64
+    // CHECK: %[[AMP:.*]] = complex.create %[[REAL]], %[[IMAG]] : complex<f64>
+    %amp = complex.create %cst, %cst_0 : complex<f64>
+    // the beta of the drag stays a constant
+    // CHECK: pulse.drag(%{{.*}}, %[[AMP]], %{{.*}}, %{{.*}})
+    %wfr = pulse.drag(%c160_i32, %amp, %c40_i32, %beta) : (i32, complex<f64>, i32, f64) -> !pulse.waveform
+    // CHECK: pulse.set_frequency(%arg0, %[[FREQ]])
+    // AMPS: pulse.set_frequency(%arg0, %{{.*}}) : (!pulse.mixed_frame, f64)
+    pulse.set_frequency(%arg0, %freq) : (!pulse.mixed_frame, f64)
+    pulse.play(%arg0, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.return
+  }
+  pulse.sequence @measure_0(%arg0: !pulse.mixed_frame) {
+    %c1000_i32 = arith.constant 1000 : i32
+    %c64_i32 = arith.constant 64 : i32
+    // CHECK-NOT: complex.constant
+    %amp = complex.constant [2.500000e-01, 1.000000e-01] : complex<f64>
+    // CHECK: %[[REAL:.*]] = qcs.parameter_load @measure_0.amp0.real : f64
+    // CHECK: %[[IMAG:.*]] = qcs.parameter_load @measure_0.amp0.imag : f64
+    // CHECK: %[[AMP:.*]] = complex.create %[[REAL]], %[[IMAG]] : complex<f64>
+    // CHECK: pulse.gaussian(%{{.*}}, %[[AMP]], %{{.*}})
+    // CHECK: pulse.gaussian(%{{.*}}, %[[AMP]], %{{.*}})
+    %wfr = pulse.gaussian(%c1000_i32, %amp, %c64_i32) : (i32, complex<f64>, i32) -> !pulse.waveform
+    %wfr_0 = pulse.gaussian(%c1000_i32, %amp, %c64_i32) : (i32, complex<f64>, i32) -> !pulse.waveform
+    pulse.play(%arg0, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.play(%arg0, %wfr_0) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.return
+  }
+}
@@ -0,0 +1,40 @@
+// RUN: qss-compiler -X=mlir --pulse-externalize-waveforms='min-samples=3' %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that the samples of waveforms with at least min-samples
+// samples are moved to resource blobs, shared by identical waveforms.
+
+// CHECK-LABEL: pulse.sequence @externalize
+pulse.sequence @externalize(%arg0: !pulse.mixed_frame) {
+  // CHECK: pulse.create_waveform dense<{{\[\[}}0.000000e+00, 5.000000e-01], [5.000000e-01, 5.000000e-01]]> : tensor<2x2xf64>
+  %0 = pulse.create_waveform dense<[[0.0, 0.5], [0.5, 0.5]]> : tensor<2x2xf64> -> !pulse.waveform
+  // CHECK: pulse.create_waveform {pulse.waveformName = "drag"} dense_resource<[[DRAG:drag[^>]*]]> : tensor<3x2xf64>
+  %1 = pulse.create_waveform {pulse.waveformName = "drag"} dense<[[0.1, 0.2], [0.3, 0.4], [0.5, 0.6]]> : tensor<3x2xf64> -> !pulse.waveform
+  // CHECK: pulse.create_waveform dense_resource<[[DRAG]]> : tensor<3x2xf64>
+  %2 = pulse.create_waveform dense<[[0.1, 0.2], [0.3, 0.4], [0.5, 0.6]]> : tensor<3x2xf64> -> !pulse.waveform
+  // CHECK: pulse.create_waveform dense_resource<[[SPLAT:waveform[^>]*]]> : tensor<4x2xf64>
+  %3 = pulse.create_waveform dense<1.0> : tensor<4x2xf64> -> !pulse.waveform
+  pulse.play(%arg0, %0) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %3) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// CHECK: {-#
+// CHECK: dialect_resources: {
+// CHECK: builtin: {
+// CHECK-DAG: [[DRAG]]: "0x08
+// CHECK-DAG: [[SPLAT]]: "0x08
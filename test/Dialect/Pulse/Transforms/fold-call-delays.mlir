@@ -0,0 +1,114 @@
+// RUN: qss-compiler -X=mlir --pulse-fold-call-delays %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-fold-call-delays --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS-DAG: (S) {{ *}}4 hoisted-delays
+// STATS-DAG: (S) {{ *}}1 folded-timepoints
+// STATS-DAG: (S) {{ *}}2 merged-delays
+
+// the common delay at the end of both frames is moved after the call
+// CHECK-LABEL: pulse.sequence @trailing
+// CHECK: %[[C10:.*]] = arith.constant 10 : i32
+// CHECK: pulse.play(%arg0, %arg2)
+// CHECK-NEXT: pulse.delay(%arg1, %[[C10]])
+// CHECK-NEXT: pulse.return
+pulse.sequence @trailing(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.waveform) {
+  %c10_i32 = arith.constant 10 : i32
+  %c20_i32 = arith.constant 20 : i32
+  pulse.play(%arg0, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.delay(%arg0, %c10_i32) : (!pulse.mixed_frame, i32)
+  pulse.delay(%arg1, %c20_i32) : (!pulse.mixed_frame, i32)
+  pulse.return
+}
+
+// the common delay at the start of both frames is moved before the call
+// CHECK-LABEL: pulse.sequence @leading
+// CHECK-NOT: pulse.delay
+// CHECK: pulse.return
+pulse.sequence @leading(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.waveform) {
+  %c5_i32 = arith.constant 5 : i32
+  pulse.delay(%arg0, %c5_i32) : (!pulse.mixed_frame, i32)
+  pulse.delay(%arg1, %c5_i32) : (!pulse.mixed_frame, i32)
+  pulse.play(%arg0, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg1, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// the delay at the start of a gate called at timepoints is folded into them
+// CHECK-LABEL: pulse.sequence @gate
+// CHECK-SAME: attributes {pulse.duration = 30 : i64}
+// CHECK-NOT: pulse.delay
+// CHECK: pulse.return
+pulse.sequence @gate(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) attributes {pulse.duration = 50 : i64} {
+  %c20_i32 = arith.constant 20 : i32
+  pulse.delay(%arg0, %c20_i32) : (!pulse.mixed_frame, i32)
+  pulse.play {pulse.duration = 30 : i64}(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// CHECK-LABEL: pulse.sequence @circuit
+// CHECK: pulse.call_sequence @gate(%arg0, %arg1) {pulse.duration = 30 : i64, pulse.timepoint = 20 : i64}
+// CHECK-NEXT: pulse.call_sequence @gate(%arg0, %arg1) {pulse.duration = 30 : i64, pulse.timepoint = 70 : i64}
+pulse.sequence @circuit(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) {
+  pulse.call_sequence @gate(%arg0, %arg1) {pulse.duration = 50 : i64, pulse.timepoint = 0 : i64} : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.call_sequence @gate(%arg0, %arg1) {pulse.duration = 50 : i64, pulse.timepoint = 50 : i64} : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.return
+}
+
+// a sequence called more than once keeps its delays
+// CHECK-LABEL: pulse.sequence @shared
+// CHECK: pulse.delay(%arg0
+pulse.sequence @shared(%arg0: !pulse.mixed_frame) {
+  %c5_i32 = arith.constant 5 : i32
+  pulse.delay(%arg0, %c5_i32) : (!pulse.mixed_frame, i32)
+  pulse.return
+}
+
+// the delays after the first call and before the second one are merged
+// CHECK-LABEL: pulse.sequence @program
+// CHECK-DAG: %[[C3:.*]] = arith.constant 3 : i32
+// CHECK-DAG: %[[C15:.*]] = arith.constant 15 : i32
+// CHECK: pulse.delay(%arg0, %[[C3]])
+// CHECK-NEXT: pulse.delay(%arg1, %[[C3]])
+// CHECK-NEXT: pulse.call_sequence @trailing(%arg0, %arg1, %arg2) :
+// CHECK-NEXT: pulse.delay(%arg0, %[[C15]])
+// CHECK-NEXT: pulse.delay(%arg1, %[[C15]])
+// CHECK-NEXT: pulse.call_sequence @leading(%arg0, %arg1, %arg2) :
+// CHECK-NEXT: pulse.call_sequence @shared(%arg0)
+// CHECK-NEXT: pulse.call_sequence @shared(%arg0)
+pulse.sequence @program(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.waveform) {
+  %c3_i32 = arith.constant 3 : i32
+  pulse.delay(%arg0, %c3_i32) : (!pulse.mixed_frame, i32)
+  pulse.delay(%arg1, %c3_i32) : (!pulse.mixed_frame, i32)
+  pulse.call_sequence @trailing(%arg0, %arg1, %arg2) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.call_sequence @leading(%arg0, %arg1, %arg2) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.call_sequence @shared(%arg0) : (!pulse.mixed_frame) -> ()
+  pulse.call_sequence @shared(%arg0) : (!pulse.mixed_frame) -> ()
+  pulse.call_sequence @circuit(%arg0, %arg2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.return
+}
+
+// the delays at the start of @program are not moved to a call with frames
+// which are not arguments
+// CHECK-LABEL: func.func @main
+// CHECK-NOT: pulse.delay
+func.func @main() {
+  %0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+  %1 = "pulse.mix_frame"(%0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+  %2 = "pulse.mix_frame"(%0) {uid = "mf1-p0"} : (!pulse.port) -> !pulse.mixed_frame
+  %3 = pulse.create_waveform dense<[[0.0, 1.0]]> : tensor<1x2xf64> -> !pulse.waveform
+  pulse.call_sequence @program(%1, %2, %3) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.waveform) -> ()
+  return
+}
@@ -0,0 +1,97 @@
+// RUN: qss-compiler -X=mlir --pulse-fuse-frame-updates %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that adjacent phase and frequency updates of a frame are
+// fused and that phase shifts commute with operations on other frames.
+
+func.func @main() {
+    %0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %1 = "pulse.mix_frame"(%0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %2 = "pulse.mix_frame"(%0) {uid = "mf1-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %cst = arith.constant 0.5 : f64
+    pulse.call_sequence @seq_0(%1, %2, %cst) : (!pulse.mixed_frame, !pulse.mixed_frame, f64) -> ()
+    pulse.call_sequence @seq_1(%1, %1) : (!pulse.mixed_frame, !pulse.mixed_frame) -> ()
+    pulse.call_sequence @seq_2(%1) : (!pulse.mixed_frame) -> ()
+    return
+}
+
+// CHECK-LABEL: pulse.sequence @seq_0
+pulse.sequence @seq_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: f64) {
+    %c16_i32 = arith.constant 16 : i32
+    %cst = arith.constant 0.25 : f64
+    %amp = complex.constant [0.5, 0.0] : complex<f64>
+    %wfr = pulse.const_waveform(%c16_i32, %amp) : (i32, complex<f64>) -> !pulse.waveform
+
+    // CHECK: pulse.play(%arg1, %{{.*}})
+    // CHECK: %[[CST:.*]] = arith.constant 7.500000e-01 : f64
+    // CHECK-NEXT: pulse.shift_phase(%arg0, %[[CST]])
+    // CHECK-NEXT: pulse.play(%arg0, %{{.*}})
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.play(%arg1, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.play(%arg0, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+
+    // a set overrides the previous updates and absorbs the following shifts
+    // CHECK-NOT: pulse.shift_phase
+    // CHECK: %[[SUM:.*]] = arith.addf %arg2, %{{.*}} : f64
+    // CHECK-NEXT: pulse.set_phase(%arg0, %[[SUM]])
+    // CHECK-NEXT: pulse.set_frequency(%arg0, %{{.*}})
+    // CHECK-NEXT: pulse.play(%arg0, %{{.*}})
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.set_phase(%arg0, %arg2) : (!pulse.mixed_frame, f64)
+    pulse.shift_frequency(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.set_frequency(%arg0, %arg2) : (!pulse.mixed_frame, f64)
+    pulse.play(%arg0, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+
+    // frequency updates do not move past a delay on the frame
+    // CHECK: pulse.shift_frequency(%arg0, %{{.*}})
+    // CHECK-NEXT: pulse.delay(%arg0, %{{.*}})
+    // CHECK-NEXT: pulse.shift_frequency(%arg0, %{{.*}})
+    pulse.shift_frequency(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.delay(%arg0, %c16_i32) : (!pulse.mixed_frame, i32)
+    pulse.shift_frequency(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.return
+}
+
+// The frames of seq_1 are the same frame, hence the updates are kept
+// CHECK-LABEL: pulse.sequence @seq_1
+pulse.sequence @seq_1(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) {
+    %cst = arith.constant 0.25 : f64
+    // CHECK: pulse.shift_phase(%arg0, %{{.*}})
+    // CHECK-NEXT: pulse.set_phase(%arg1, %{{.*}})
+    // CHECK-NEXT: pulse.shift_phase(%arg0, %{{.*}})
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.set_phase(%arg1, %cst) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.return
+}
+
+// Fixed-point phases are added as integers and wrap around a full turn
+// CHECK-LABEL: pulse.sequence @seq_2
+pulse.sequence @seq_2(%arg0: !pulse.mixed_frame) {
+    %c3_4 = arith.constant 786432 : i20
+    %c1_2 = arith.constant 524288 : i20
+    %cst = arith.constant 0.25 : f64
+    // CHECK: %[[SUM:.*]] = arith.constant 262144 : i20
+    // CHECK: pulse.shift_phase(%arg0, %[[SUM]]) : (!pulse.mixed_frame, i20)
+    // CHECK-NEXT: pulse.shift_phase(%arg0, %{{.*}}) : (!pulse.mixed_frame, f64)
+    // CHECK-NEXT: pulse.return
+    pulse.shift_phase(%arg0, %c3_4) : (!pulse.mixed_frame, i20)
+    pulse.shift_phase(%arg0, %c1_2) : (!pulse.mixed_frame, i20)
+    pulse.shift_phase(%arg0, %cst) : (!pulse.mixed_frame, f64)
+    pulse.return
+}
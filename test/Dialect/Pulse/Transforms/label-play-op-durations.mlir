@@ -0,0 +1,62 @@
+// RUN: qss-compiler -X=mlir --pulse-label-play-op-duration %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that play operations are labeled with the durations of
+// the waveforms passed to their sequence, and that sequences called with
+// waveforms of different durations are specialized per duration.
+
+func.func @main() -> i32 {
+  %0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+  %1 = "pulse.mix_frame"(%0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+  %2 = pulse.create_waveform dense<[[0.0, 1.0], [0.0, 1.0], [0.0, 1.0]]> : tensor<3x2xf64> -> !pulse.waveform
+  %3 = pulse.create_waveform dense<[[0.0, 1.0], [0.0, 1.0], [0.0, 1.0], [0.0, 1.0], [0.0, 1.0]]> : tensor<5x2xf64> -> !pulse.waveform
+  %4 = pulse.create_waveform dense<[[0.0, 1.0], [0.0, 1.0], [0.0, 1.0]]> : tensor<3x2xf64> -> !pulse.waveform
+  // CHECK: pulse.call_sequence @play(%{{.*}}, %{{.*}})
+  // CHECK: pulse.call_sequence @play_1(%{{.*}}, %{{.*}})
+  // CHECK: pulse.call_sequence @play(%{{.*}}, %{{.*}})
+  // CHECK: pulse.call_sequence @play_twice(%{{.*}}, %{{.*}})
+  pulse.call_sequence @play(%1, %2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.call_sequence @play(%1, %3) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.call_sequence @play(%1, %4) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.call_sequence @play_twice(%1, %2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  %c0_i32 = arith.constant 0 : i32
+  return %c0_i32 : i32
+}
+
+// CHECK-LABEL: pulse.sequence @play(
+// CHECK: pulse.play {pulse.duration = 3 : i64}
+// CHECK-LABEL: pulse.sequence @play_1(
+// CHECK: pulse.play {pulse.duration = 5 : i64}
+pulse.sequence @play(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) {
+  pulse.play(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// CHECK-LABEL: pulse.sequence @play_twice(
+// CHECK: pulse.play {pulse.duration = 3 : i64}
+// CHECK: pulse.play {pulse.duration = 3 : i64}
+// CHECK-NOT: pulse.sequence @play_twice_1
+pulse.sequence @play_twice(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) {
+  pulse.play(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// CHECK-LABEL: pulse.sequence @uncalled(
+// CHECK-NOT: pulse.duration
+pulse.sequence @uncalled(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) {
+  pulse.play(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
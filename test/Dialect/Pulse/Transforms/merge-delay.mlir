@@ -3,7 +3,7 @@
 //
 // This code is part of Qiskit.
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is licensed under the Apache License, Version 2.0 with LLVM
 // Exceptions. You may obtain a copy of this license in the LICENSE.txt
@@ -29,24 +29,17 @@ func.func @main() -> i32 {
 }
 
 pulse.sequence @seq_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1 {
-    // CHECK: %c18_i32 = arith.constant 18 : i32
-    // CHECK: %c36_i32 = arith.constant 36 : i32
-    // CHECK: %c6_i32 = arith.constant 6 : i32
+    // CHECK-DAG: %c30_i32 = arith.constant 30 : i32
+    // CHECK-DAG: %c72_i32 = arith.constant 72 : i32
     // CHECK-NOT: %c12_i32 = arith.constant 12 : i32
     %c6_i32 = arith.constant 6 : i32
     %c12_i32 = arith.constant 12 : i32
     %c18_i32 = arith.constant 18 : i32
 
-    // CHECK-NOT: pulse.delay(%arg0, %c6_i32) : (!pulse.mixed_frame, i32)
-    // CHECK-NOT: pulse.delay(%arg0, %c12_i32) : (!pulse.mixed_frame, i32)
-    // CHECK-NOT: pulse.delay(%arg1, %c18_i32) : (!pulse.mixed_frame, i32)
-    // CHECK-NOT: pulse.delay(%arg1, %c18_i32) : (!pulse.mixed_frame, i32)
-    // CHECK: pulse.delay(%arg0, %c18_i32) : (!pulse.mixed_frame, i32)
-    // CHECK: pulse.delay(%arg1, %c36_i32) : (!pulse.mixed_frame, i32)
-    // CHECK: pulse.delay(%arg0, %c6_i32) : (!pulse.mixed_frame, i32)
-    // CHECK: pulse.delay(%arg1, %c18_i32) : (!pulse.mixed_frame, i32)
-    // CHECK: pulse.delay(%arg0, %c6_i32) : (!pulse.mixed_frame, i32)
-    // CHECK: pulse.delay(%arg1, %c18_i32) : (!pulse.mixed_frame, i32)
+    // the delays on a frame are merged across the delays on other frames
+    // CHECK: pulse.delay(%arg0, %c30_i32) : (!pulse.mixed_frame, i32)
+    // CHECK-NEXT: pulse.delay(%arg1, %c72_i32) : (!pulse.mixed_frame, i32)
+    // CHECK-NEXT: pulse.return
     pulse.delay(%arg0, %c6_i32) : (!pulse.mixed_frame, i32)
     pulse.delay(%arg0, %c12_i32) : (!pulse.mixed_frame, i32)
 
@@ -61,3 +54,30 @@ pulse.sequence @seq_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i
     %c0_i1 = arith.constant 0 : i1
     pulse.return %c0_i1 : i1
 }
+
+// CHECK-LABEL: pulse.sequence @seq_1
+pulse.sequence @seq_1(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.waveform, %arg3: i32) {
+    // CHECK-DAG: %[[C4:.*]] = arith.constant 4 : i32
+    // CHECK-DAG: %[[C8:.*]] = arith.constant 8 : i32
+    %c4_i32 = arith.constant 4 : i32
+
+    // the delays are not merged across an op on the frame, nor with a
+    // scheduled delay or a delay of unknown duration
+    // CHECK: pulse.delay(%arg0, %[[C8]])
+    // CHECK-NEXT: pulse.play(%arg1, %arg2)
+    // CHECK-NEXT: pulse.play(%arg0, %arg2)
+    // CHECK-NEXT: pulse.delay(%arg0, %[[C4]])
+    // CHECK-NEXT: pulse.delay {pulse.timepoint = 100 : i64}(%arg0, %[[C4]])
+    // CHECK-NEXT: pulse.delay(%arg1, %arg3)
+    // CHECK-NEXT: pulse.delay(%arg1, %[[C4]])
+    // CHECK-NEXT: pulse.return
+    pulse.delay(%arg0, %c4_i32) : (!pulse.mixed_frame, i32)
+    pulse.play(%arg1, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.delay(%arg0, %c4_i32) : (!pulse.mixed_frame, i32)
+    pulse.play(%arg0, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.delay(%arg0, %c4_i32) : (!pulse.mixed_frame, i32)
+    pulse.delay {pulse.timepoint = 100 : i64} (%arg0, %c4_i32) : (!pulse.mixed_frame, i32)
+    pulse.delay(%arg1, %arg3) : (!pulse.mixed_frame, i32)
+    pulse.delay(%arg1, %c4_i32) : (!pulse.mixed_frame, i32)
+    pulse.return
+}
@@ -0,0 +1,69 @@
+// RUN: qss-compiler -X=mlir --quantum-circuit-pulse-scheduling='scheduling-method=alap' %s | FileCheck %s --check-prefix ALAP
+// RUN: qss-compiler -X=mlir --quantum-circuit-pulse-scheduling='scheduling-method=asap' %s | FileCheck %s --check-prefix ASAP
+// RUN: qss-compiler -X=mlir --quantum-circuit-pulse-scheduling='scheduling-method=list max-concurrent-captures=1' %s | FileCheck %s --check-prefix LIST
+// RUN: qss-compiler -X=mlir --mlir-disable-threading --quantum-circuit-pulse-scheduling='scheduling-method=alap' %s | FileCheck %s --check-prefix ALAP
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies the scheduling methods of quantum circuits at pulse
+// level. The list scheduler only allows one measurement window at a time.
+// A circuit is scheduled once and the result is set on all of its calls.
+
+pulse.sequence @x(%arg0: !pulse.mixed_frame) attributes {pulse.duration = 100 : i64} {
+  pulse.return
+}
+
+pulse.sequence @measure(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.duration = 500 : i64} {
+  %0 = pulse.capture(%arg0) : (!pulse.mixed_frame) -> i1
+  pulse.return %0 : i1
+}
+
+pulse.sequence @circuit(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.mixed_frame) -> (i1, i1) {
+  // ALAP: pulse.call_sequence @x(%arg0) {pulse.timepoint = -600 : i64}
+  // ASAP: pulse.call_sequence @x(%arg0) {pulse.timepoint = 0 : i64}
+  // LIST: pulse.call_sequence @x(%arg0) {pulse.timepoint = 0 : i64}
+  pulse.call_sequence @x(%arg0) : (!pulse.mixed_frame) -> ()
+  // ALAP: pulse.call_sequence @measure(%arg0) {pulse.timepoint = -500 : i64}
+  // ASAP: pulse.call_sequence @measure(%arg0) {pulse.timepoint = 100 : i64}
+  // LIST: pulse.call_sequence @measure(%arg0) {pulse.timepoint = 100 : i64}
+  %0 = pulse.call_sequence @measure(%arg0) : (!pulse.mixed_frame) -> i1
+  // ALAP: pulse.call_sequence @measure(%arg1) {pulse.timepoint = -500 : i64}
+  // ASAP: pulse.call_sequence @measure(%arg1) {pulse.timepoint = 0 : i64}
+  // LIST: pulse.call_sequence @measure(%arg1) {pulse.timepoint = 600 : i64}
+  %1 = pulse.call_sequence @measure(%arg1) : (!pulse.mixed_frame) -> i1
+  // ALAP: pulse.call_sequence @x(%arg2) {pulse.timepoint = -100 : i64}
+  // ASAP: pulse.call_sequence @x(%arg2) {pulse.timepoint = 0 : i64}
+  // LIST: pulse.call_sequence @x(%arg2) {pulse.timepoint = 0 : i64}
+  pulse.call_sequence @x(%arg2) : (!pulse.mixed_frame) -> ()
+  pulse.return %0, %1 : i1, i1
+}
+
+func.func @main() -> i32 {
+  %0 = "pulse.create_port"() {uid = "d0"} : () -> !pulse.port
+  %1 = "pulse.create_port"() {uid = "m0"} : () -> !pulse.port
+  %2 = "pulse.create_port"() {uid = "m1"} : () -> !pulse.port
+  %3 = "pulse.mix_frame"(%1) {uid = "mf0-m0"} : (!pulse.port) -> !pulse.mixed_frame
+  %4 = "pulse.mix_frame"(%2) {uid = "mf0-m1"} : (!pulse.port) -> !pulse.mixed_frame
+  %5 = "pulse.mix_frame"(%0) {uid = "mf0-d0"} : (!pulse.port) -> !pulse.mixed_frame
+  // ALAP: pulse.call_sequence @circuit(%{{.*}}, %{{.*}}, %{{.*}}) {pulse.duration = 600 : i64, pulse.timepoint = 600 : i64}
+  // ASAP: pulse.call_sequence @circuit(%{{.*}}, %{{.*}}, %{{.*}}) {pulse.duration = 600 : i64, pulse.timepoint = 0 : i64}
+  // LIST: pulse.call_sequence @circuit(%{{.*}}, %{{.*}}, %{{.*}}) {pulse.duration = 1100 : i64, pulse.timepoint = 0 : i64}
+  %6:2 = pulse.call_sequence @circuit(%3, %4, %5) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame) -> (i1, i1)
+  // ALAP: pulse.call_sequence @circuit(%{{.*}}, %{{.*}}, %{{.*}}) {pulse.duration = 600 : i64, pulse.timepoint = 600 : i64}
+  // ASAP: pulse.call_sequence @circuit(%{{.*}}, %{{.*}}, %{{.*}}) {pulse.duration = 600 : i64, pulse.timepoint = 0 : i64}
+  // LIST: pulse.call_sequence @circuit(%{{.*}}, %{{.*}}, %{{.*}}) {pulse.duration = 1100 : i64, pulse.timepoint = 0 : i64}
+  %7:2 = pulse.call_sequence @circuit(%3, %4, %5) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame) -> (i1, i1)
+  %c0_i32 = arith.constant 0 : i32
+  return %c0_i32 : i32
+}
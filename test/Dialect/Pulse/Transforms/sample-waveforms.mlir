@@ -0,0 +1,67 @@
+// RUN: qss-compiler -X=mlir --pulse-sample-waveforms %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that parametric waveforms with constant parameters are
+// replaced by their samples, and that the ones with non-constant parameters
+// are kept.
+
+// CHECK-LABEL: pulse.sequence @constant_parameters
+pulse.sequence @constant_parameters(%arg0: !pulse.mixed_frame) {
+  %c3_i32 = arith.constant 3 : i32
+  %c4_i32 = arith.constant 4 : i32
+  %c2_i32 = arith.constant 2 : i32
+  %c1_i32 = arith.constant 1 : i32
+  %cst = arith.constant 5.000000e-01 : f64
+  %cst_0 = arith.constant 2.500000e-01 : f64
+  %beta = arith.constant 1.000000e-01 : f64
+  %amp = complex.create %cst, %cst_0 : complex<f64>
+  // CHECK-NOT: pulse.const_waveform
+  // CHECK-NOT: pulse.gaussian
+  // CHECK-NOT: pulse.drag
+  // CHECK: %[[CONST:.*]] = pulse.create_waveform dense<{{\[\[}}5.000000e-01, 2.500000e-01], [5.000000e-01, 2.500000e-01], [5.000000e-01, 2.500000e-01]]> : tensor<3x2xf64> -> !pulse.waveform
+  %0 = pulse.const_waveform(%c3_i32, %amp) : (i32, complex<f64>) -> !pulse.waveform
+  // CHECK: %[[GAUSSIAN:.*]] = pulse.create_waveform dense<{{.*}}> : tensor<4x2xf64> -> !pulse.waveform
+  %1 = pulse.gaussian(%c4_i32, %amp, %c2_i32) : (i32, complex<f64>, i32) -> !pulse.waveform
+  // CHECK: %[[SQUARE:.*]] = pulse.create_waveform dense<{{.*}}> : tensor<4x2xf64> -> !pulse.waveform
+  %2 = pulse.gaussian_square(%c4_i32, %amp, %c1_i32, %c2_i32) : (i32, complex<f64>, i32, i32) -> !pulse.waveform
+  // CHECK: %[[DRAG0:.*]] = pulse.create_waveform dense<[[DRAG:.*]]> : tensor<4x2xf64> -> !pulse.waveform
+  %3 = pulse.drag(%c4_i32, %amp, %c2_i32, %beta) : (i32, complex<f64>, i32, f64) -> !pulse.waveform
+  // CHECK: %[[DRAG1:.*]] = pulse.create_waveform dense<[[DRAG]]> : tensor<4x2xf64> -> !pulse.waveform
+  %4 = pulse.drag(%c4_i32, %amp, %c2_i32, %beta) : (i32, complex<f64>, i32, f64) -> !pulse.waveform
+  // CHECK: pulse.play(%arg0, %[[CONST]])
+  // CHECK: pulse.play(%arg0, %[[GAUSSIAN]])
+  // CHECK: pulse.play(%arg0, %[[SQUARE]])
+  // CHECK: pulse.play(%arg0, %[[DRAG0]])
+  // CHECK: pulse.play(%arg0, %[[DRAG1]])
+  pulse.play(%arg0, %0) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %3) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %4) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// CHECK-LABEL: pulse.sequence @argument_parameters
+pulse.sequence @argument_parameters(%arg0: !pulse.mixed_frame, %arg1: f64) {
+  %c4_i32 = arith.constant 4 : i32
+  %c2_i32 = arith.constant 2 : i32
+  %cst = arith.constant 5.000000e-01 : f64
+  %amp = complex.create %cst, %cst : complex<f64>
+  // CHECK: pulse.drag
+  // CHECK-NOT: pulse.create_waveform
+  %0 = pulse.drag(%c4_i32, %amp, %c2_i32, %arg1) : (i32, complex<f64>, i32, f64) -> !pulse.waveform
+  pulse.play(%arg0, %0) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
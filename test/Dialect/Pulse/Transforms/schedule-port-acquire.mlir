@@ -3,7 +3,7 @@
 //
 // This code is part of Qiskit.
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is licensed under the Apache License, Version 2.0 with LLVM
 // Exceptions. You may obtain a copy of this license in the LICENSE.txt
@@ -80,6 +80,10 @@ module @acquire_0 attributes {quir.nodeId = 7 : i32, quir.nodeType = "acquire",
     // CHECK: {{.*}} = pulse.call_sequence @seq_0(%1, %2, %4, %6, %8) {pulse.duration = 18096 : i64}
     %17:2 = pulse.call_sequence @seq_1(%4, %6, %9, %12, %15) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame) -> (i1,i1)
     // CHECK: {{.*}}:2 = pulse.call_sequence @seq_1(%1, %2, %4, %6, %8) {pulse.duration = 39192 : i64}
+    // a sequence called repeatedly is only scheduled once, the timepoints of
+    // the nested calls above are not shifted again
+    %18:2 = pulse.call_sequence @seq_1(%4, %6, %9, %12, %15) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame) -> (i1,i1)
+    // CHECK: {{.*}}:2 = pulse.call_sequence @seq_1(%1, %2, %4, %6, %8) {pulse.duration = 39192 : i64}
     return %c0_i32 : i32
   }
 }
@@ -0,0 +1,54 @@
+// RUN: qss-compiler -X=mlir --pulse-schedule-port=precompile=true %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-schedule-port=precompile=true %s | qss-compiler -X=mlir --pulse-schedule-port | FileCheck %s --check-prefix=PROGRAM
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Test that precompiling a pulse calibration library schedules the sequences
+// with static durations once, and that programs calling them keep the
+// precompiled schedule.
+
+module {
+  // CHECK: pulse.sequence @x_0(%[[ARG0:[A-Za-z0-9]+]]: !pulse.waveform, %[[ARG1:[A-Za-z0-9]+]]: !pulse.mixed_frame)
+  // CHECK-SAME: attributes {pulse.duration = 15 : i64, pulse.precompiled}
+  pulse.sequence @x_0(%arg0: !pulse.waveform, %arg1: !pulse.mixed_frame) {
+    %c2_i32 = arith.constant 2 : i32
+    %c10_i32 = arith.constant 10 : i32
+    pulse.delay(%arg1, %c2_i32) : (!pulse.mixed_frame, i32)
+    pulse.play {pulse.duration = 3 : i64}(%arg1, %arg0) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.delay(%arg1, %c10_i32) : (!pulse.mixed_frame, i32)
+    // CHECK-NOT: pulse.delay
+    // CHECK: pulse.play {pulse.duration = 3 : i64, pulse.timepoint = 2 : i64}(%[[ARG1]], %[[ARG0]])
+    // CHECK: pulse.return {pulse.timepoint = 15 : i64}
+    pulse.return
+  }
+  // the duration of the delay is only known for a call
+  // CHECK: pulse.sequence @delay_0(%[[ARG0:[A-Za-z0-9]+]]: !pulse.mixed_frame, %[[ARG1:[A-Za-z0-9]+]]: i32)
+  // CHECK-NOT: pulse.precompiled
+  pulse.sequence @delay_0(%arg0: !pulse.mixed_frame, %arg1: i32) {
+    // CHECK: pulse.delay(%[[ARG0]], %[[ARG1]])
+    pulse.delay(%arg0, %arg1) : (!pulse.mixed_frame, i32)
+    // CHECK: pulse.return
+    // CHECK-NOT: pulse.timepoint
+    pulse.return
+  }
+  func.func @main() -> i32 attributes {quir.classicalOnly = false} {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %1 = "pulse.mix_frame"(%0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %2 = pulse.create_waveform dense<[[0.0, 1.0], [0.0, 1.0], [0.0, 1.0]]> : tensor<3x2xf64> -> !pulse.waveform
+    // PROGRAM: pulse.call_sequence @x_0({{.*}}) {pulse.duration = 15 : i64}
+    pulse.call_sequence @x_0(%2, %1) : (!pulse.waveform, !pulse.mixed_frame) -> ()
+    return %c0_i32 : i32
+  }
+}
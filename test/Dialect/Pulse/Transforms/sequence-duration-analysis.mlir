@@ -0,0 +1,90 @@
+// RUN: qss-opt %s --test-sequence-duration-analysis -verify-diagnostics
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies the durations of sequences computed from their bodies:
+// each frame keeps its own timeline, nested calls start once all of their
+// frames are available and labeled durations take precedence.
+
+pulse.sequence @play(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) {
+  pulse.play(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+pulse.sequence @play_both(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.waveform) {
+  pulse.play(%arg0, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg1, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+// 3 + 3 on the first frame in parallel to 5 on the second one
+pulse.sequence @per_frame(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.waveform, %arg3: !pulse.waveform) {
+  pulse.play(%arg0, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg0, %arg2) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play(%arg1, %arg3) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+pulse.sequence @delay(%arg0: !pulse.mixed_frame, %arg1: i32) {
+  pulse.delay(%arg0, %arg1) : (!pulse.mixed_frame, i32)
+  pulse.return
+}
+
+// @play_both starts once the second frame is available at 10 and lasts 3
+pulse.sequence @nested(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame, %arg2: !pulse.waveform) {
+  %c10_i32 = arith.constant 10 : i32
+  pulse.call_sequence @play(%arg0, %arg2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.call_sequence @delay(%arg1, %c10_i32) : (!pulse.mixed_frame, i32) -> ()
+  pulse.call_sequence @play_both(%arg0, %arg1, %arg2) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.return
+}
+
+pulse.sequence @labeled(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) attributes {pulse.duration = 100 : i64} {
+  pulse.play(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return
+}
+
+pulse.sequence @calls_labeled(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) {
+  pulse.call_sequence @labeled(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.call_sequence @play(%arg0, %arg1) {pulse.duration = 20 : i64} : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  pulse.return
+}
+
+func.func @main() -> i32 {
+  %0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+  %1 = "pulse.create_port"() {uid = "p1"} : () -> !pulse.port
+  %2 = "pulse.mix_frame"(%0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+  %3 = "pulse.mix_frame"(%1) {uid = "mf0-p1"} : (!pulse.port) -> !pulse.mixed_frame
+  %4 = pulse.create_waveform dense<[[0.0, 1.0], [0.0, 1.0], [0.0, 1.0]]> : tensor<3x2xf64> -> !pulse.waveform
+  %5 = pulse.create_waveform dense<[[0.0, 1.0], [0.0, 1.0], [0.0, 1.0], [0.0, 1.0], [0.0, 1.0]]> : tensor<5x2xf64> -> !pulse.waveform
+  %c7_i32 = arith.constant 7 : i32
+  // expected-remark@+1 {{duration 5}}
+  pulse.call_sequence @play(%2, %5) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  // expected-remark@+1 {{duration 6}}
+  pulse.call_sequence @per_frame(%2, %3, %4, %5) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.waveform, !pulse.waveform) -> ()
+  // expected-remark@+1 {{duration 7}}
+  pulse.call_sequence @delay(%2, %c7_i32) : (!pulse.mixed_frame, i32) -> ()
+  // expected-remark@+1 {{duration 13}}
+  pulse.call_sequence @nested(%2, %3, %4) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.waveform) -> ()
+  // expected-remark@+1 {{duration 15}}
+  pulse.call_sequence @nested(%2, %3, %5) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.waveform) -> ()
+  // expected-remark@+1 {{duration 100}}
+  pulse.call_sequence @labeled(%2, %4) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  // expected-remark@+1 {{duration 120}}
+  pulse.call_sequence @calls_labeled(%2, %4) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+  // expected-remark@+1 {{duration 50}}
+  pulse.call_sequence @per_frame(%2, %3, %4, %5) {pulse.duration = 50 : i64} : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.waveform, !pulse.waveform) -> ()
+  %c0_i32 = arith.constant 0 : i32
+  return %c0_i32 : i32
+}
@@ -0,0 +1,130 @@
+// RUN: qss-compiler -X=mlir --pulse-timeline-report %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-timeline-report='format=chrome-trace' %s | FileCheck %s --check-prefix TRACE
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies the occupancy report of a scheduled pulse program. The
+// timepoints in a sequence are offset by the timepoint of its call and the
+// mixed frame arguments are reported under the pulse.mix_frame passed.
+
+pulse.sequence @seq_0(%arg0: !pulse.waveform, %arg1: !pulse.mixed_frame, %arg2: !pulse.mixed_frame) attributes {pulse.duration = 300 : i64} {
+  pulse.play {pulse.duration = 100 : i64, pulse.timepoint = 0 : i64}(%arg1, %arg0) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play {pulse.duration = 50 : i64, pulse.timepoint = 100 : i64}(%arg2, %arg0) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.play {pulse.duration = 100 : i64, pulse.timepoint = 200 : i64}(%arg1, %arg0) : (!pulse.mixed_frame, !pulse.waveform)
+  pulse.return {pulse.timepoint = 300 : i64}
+}
+
+pulse.sequence @measure(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.duration = 200 : i64} {
+  %0 = pulse.capture {pulse.duration = 200 : i64, pulse.timepoint = 0 : i64}(%arg0) : (!pulse.mixed_frame) -> i1
+  pulse.return {pulse.timepoint = 200 : i64} %0 : i1
+}
+
+func.func @main() -> i32 {
+  %0 = "pulse.create_port"() {uid = "d0"} : () -> !pulse.port
+  %1 = "pulse.create_port"() {uid = "m0"} : () -> !pulse.port
+  %2 = "pulse.mix_frame"(%0) {uid = "mf0-d0"} : (!pulse.port) -> !pulse.mixed_frame
+  %3 = "pulse.mix_frame"(%0) {uid = "mf1-d0"} : (!pulse.port) -> !pulse.mixed_frame
+  %4 = "pulse.mix_frame"(%1) {uid = "mf0-m0"} : (!pulse.port) -> !pulse.mixed_frame
+  %5 = pulse.create_waveform dense<[[0.0, 1.0]]> : tensor<1x2xf64> -> !pulse.waveform
+  pulse.call_sequence @seq_0(%5, %2, %3) {pulse.duration = 300 : i64, pulse.timepoint = 0 : i64} : (!pulse.waveform, !pulse.mixed_frame, !pulse.mixed_frame) -> ()
+  %6 = pulse.call_sequence @measure(%4) {pulse.duration = 200 : i64, pulse.timepoint = 300 : i64} : (!pulse.mixed_frame) -> i1
+  pulse.call_sequence @seq_0(%5, %2, %3) {pulse.duration = 300 : i64, pulse.timepoint = 600 : i64} : (!pulse.waveform, !pulse.mixed_frame, !pulse.mixed_frame) -> ()
+  %c0_i32 = arith.constant 0 : i32
+  return %c0_i32 : i32
+}
+
+// CHECK: "start": 0,
+// CHECK-NEXT: "end": 900,
+// CHECK-NEXT: "span": 900,
+// CHECK-NEXT: "ports": [
+// CHECK: "name": "d0",
+// CHECK-NEXT: "start": 0,
+// CHECK-NEXT: "end": 900,
+// CHECK-NEXT: "span": 900,
+// CHECK-NEXT: "busy": 500,
+// CHECK-NEXT: "utilization": 0.5555
+// CHECK: "name": "mf0-d0",
+// CHECK-NEXT: "start": 0,
+// CHECK-NEXT: "end": 900,
+// CHECK-NEXT: "span": 900,
+// CHECK-NEXT: "busy": 400,
+// CHECK: "idleGaps": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "start": 100,
+// CHECK-NEXT: "duration": 100
+// CHECK: "start": 300,
+// CHECK-NEXT: "duration": 300
+// CHECK: "start": 700,
+// CHECK-NEXT: "duration": 100
+// CHECK: "name": "mf1-d0",
+// CHECK-NEXT: "start": 100,
+// CHECK-NEXT: "end": 750,
+// CHECK-NEXT: "span": 650,
+// CHECK-NEXT: "busy": 100,
+// CHECK: "name": "m0",
+// CHECK-NEXT: "start": 300,
+// CHECK-NEXT: "end": 500,
+// CHECK-NEXT: "span": 200,
+// CHECK-NEXT: "busy": 200,
+// CHECK-NEXT: "utilization": 1,
+// CHECK-NEXT: "idleGaps": [],
+// CHECK: "criticalPath": {
+// CHECK-NEXT: "busy": 700,
+// CHECK-NEXT: "idle": 200,
+// CHECK-NEXT: "operations": [
+// CHECK: "name": "pulse.play",
+// CHECK-NEXT: "mixedFrame": "mf0-d0",
+// CHECK-NEXT: "start": 0,
+// CHECK-NEXT: "end": 100
+// CHECK: "mixedFrame": "mf1-d0",
+// CHECK-NEXT: "start": 100,
+// CHECK: "mixedFrame": "mf0-d0",
+// CHECK-NEXT: "start": 200,
+// CHECK: "name": "pulse.capture",
+// CHECK-NEXT: "mixedFrame": "mf0-m0",
+// CHECK-NEXT: "start": 300,
+// CHECK-NEXT: "end": 500
+// CHECK: "mixedFrame": "mf0-d0",
+// CHECK-NEXT: "start": 600,
+// CHECK: "mixedFrame": "mf1-d0",
+// CHECK-NEXT: "start": 700,
+// CHECK: "mixedFrame": "mf0-d0",
+// CHECK-NEXT: "start": 800,
+// CHECK-NEXT: "end": 900
+// CHECK: func.func @main()
+
+// TRACE: "traceEvents": [
+// TRACE: "name": "process_name",
+// TRACE-NEXT: "ph": "M",
+// TRACE-NEXT: "pid": 0,
+// TRACE-NEXT: "args": {
+// TRACE-NEXT: "name": "d0"
+// TRACE: "name": "thread_name",
+// TRACE-NEXT: "ph": "M",
+// TRACE-NEXT: "pid": 0,
+// TRACE-NEXT: "tid": 0,
+// TRACE-NEXT: "args": {
+// TRACE-NEXT: "name": "mf0-d0"
+// TRACE: "name": "pulse.play",
+// TRACE-NEXT: "ph": "X",
+// TRACE-NEXT: "ts": 0,
+// TRACE-NEXT: "dur": 100,
+// TRACE-NEXT: "pid": 0,
+// TRACE-NEXT: "tid": 0
+// TRACE: "name": "pulse.capture",
+// TRACE-NEXT: "ph": "X",
+// TRACE-NEXT: "ts": 300,
+// TRACE-NEXT: "dur": 200,
+// TRACE-NEXT: "pid": 1,
+// TRACE-NEXT: "tid": 2
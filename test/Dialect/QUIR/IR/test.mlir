@@ -3,7 +3,7 @@
 //
 // This code is part of Qiskit.
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is licensed under the Apache License, Version 2.0 with LLVM
 // Exceptions. You may obtain a copy of this license in the LICENSE.txt
@@ -121,6 +121,10 @@ module {
         %mResult:2 = qcs.recv {fromIds = [1 : index, 2 : index]} : i1, i1
         // CHECK: qcs.broadcast %{{.*}} : i1
         qcs.broadcast %val : i1
+        // CHECK: qcs.send %{{.*}}, %{{.*}} to 1 : i1, i1
+        qcs.send %val, %val to 1 : i1, i1
+        // CHECK: qcs.broadcast %{{.*}}, %{{.*}} : i1, i1
+        qcs.broadcast %val, %val : i1, i1
         %ub = arith.constant 10 : index
         // CHECK: quir.call_subroutine @subroutine1(%{{.*}}, %{{.*}}, %{{.*}}) : (!quir.qubit<1>, !quir.angle<20>, index) -> ()
         quir.call_subroutine @subroutine1(%qa1, %ang, %ub) : (!quir.qubit<1>, !quir.angle<20>, index) -> ()
@@ -0,0 +1,46 @@
+// RUN: qss-compiler -X=mlir --add-shot-loop="num-shots=250 shots-per-batch=100" %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// In batched mode the shots run in an outer loop over batches, storing the
+// measurement results of each shot in a buffer which is streamed at the end
+// of each batch.
+
+func.func @main() {
+  qcs.init
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %res:2 = quir.measure(%q0, %q1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+  qcs.finalize
+  return
+}
+
+// CHECK: %[[C0:.*]] = arith.constant 0 : index
+// CHECK: %[[END:.*]] = arith.constant 250 : index
+// CHECK: %[[C1:.*]] = arith.constant 1 : index
+// CHECK: %[[BATCH:.*]] = arith.constant 100 : index
+// CHECK: %[[BUFFER:.*]] = memref.alloc() : memref<100x2xi1>
+// CHECK: scf.for %[[IV:.*]] = %[[C0]] to %[[END]] step %[[BATCH]] {
+// CHECK:   %[[REMAINING:.*]] = arith.subi %[[END]], %[[IV]] : index
+// CHECK:   %[[NUM:.*]] = arith.minui %[[REMAINING]], %[[BATCH]] : index
+// CHECK:   scf.for %[[SHOT:.*]] = %[[C0]] to %[[NUM]] step %[[C1]] {
+// CHECK:     qcs.shot_init {qcs.num_shots = 250 : i32}
+// CHECK:     %[[RES:.*]]:2 = quir.measure
+// CHECK-DAG: memref.store %[[RES]]#0, %[[BUFFER]][%[[SHOT]], %{{.*}}] : memref<100x2xi1>
+// CHECK-DAG: memref.store %[[RES]]#1, %[[BUFFER]][%[[SHOT]], %{{.*}}] : memref<100x2xi1>
+// CHECK:   } {qcs.shot_loop}
+// CHECK:   qcs.shot_batch_end %[[BUFFER]], %[[NUM]] : memref<100x2xi1>
+// CHECK: } {qcs.shot_batch_loop, qcs.shots_per_batch = 100 : i32}
+// CHECK: memref.dealloc %[[BUFFER]] : memref<100x2xi1>
+// CHECK: qcs.finalize
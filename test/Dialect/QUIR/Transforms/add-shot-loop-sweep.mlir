@@ -0,0 +1,54 @@
+// RUN: qss-compiler -X=mlir --add-shot-loop="num-shots=250 sweep-points=8" %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --add-shot-loop="num-shots=250 shots-per-batch=100 sweep-points=8" %s | FileCheck %s --check-prefix=BATCH
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// In sweep mode all of the shots run once per parameter point in an outer
+// loop over the points, in which the parameters are loaded.
+
+qcs.declare_parameter @theta : !quir.angle<64> = #quir.angle<1.5> : !quir.angle<64>
+
+func.func @main() {
+  qcs.init
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %theta = qcs.parameter_load @theta : !quir.angle<64>
+  %res = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  qcs.finalize
+  return
+}
+
+// CHECK: %[[C0:.*]] = arith.constant 0 : index
+// CHECK: %[[END:.*]] = arith.constant 250 : index
+// CHECK: %[[C1:.*]] = arith.constant 1 : index
+// CHECK: %[[POINTS:.*]] = arith.constant 8 : index
+// CHECK: scf.for %{{.*}} = %[[C0]] to %[[POINTS]] step %[[C1]] {
+// CHECK:   scf.for %{{.*}} = %[[C0]] to %[[END]] step %[[C1]] {
+// CHECK:     qcs.shot_init {qcs.num_shots = 250 : i32}
+// CHECK:     qcs.parameter_load @theta
+// CHECK:     quir.measure
+// CHECK:   } {qcs.shot_loop}
+// CHECK: } {qcs.num_sweep_points = 8 : i32, qcs.sweep_loop}
+// CHECK: qcs.finalize
+
+// The batch readout buffer is shared by the points of the sweep.
+// BATCH: %[[BUFFER:.*]] = memref.alloc() : memref<100x1xi1>
+// BATCH: scf.for
+// BATCH:   scf.for
+// BATCH:     scf.for
+// BATCH:     } {qcs.shot_loop}
+// BATCH:     qcs.shot_batch_end %[[BUFFER]]
+// BATCH:   } {qcs.shot_batch_loop, qcs.shots_per_batch = 100 : i32}
+// BATCH: } {qcs.num_sweep_points = 8 : i32, qcs.sweep_loop}
+// BATCH: memref.dealloc %[[BUFFER]] : memref<100x1xi1>
+// BATCH: qcs.finalize
@@ -0,0 +1,51 @@
+// RUN: qss-compiler -X=mlir --quir-arg-specialization %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Calls sharing a signature share a single specialization, also when the
+// callee is reached through several specialized callers.
+
+// CHECK: func.func @"phase_!quir.angle<20>_!quir.qubit<1>"(%arg0: !quir.angle<20>, %arg1: !quir.qubit<1>)
+// CHECK-NOT: func.func @"phase_!quir.angle<20>_!quir.qubit<1>"
+// CHECK: func.func @phase(%arg0: !quir.angle, %arg1: !quir.qubit<1>)
+func.func @phase(%phi : !quir.angle, %q : !quir.qubit<1>) {
+  return
+}
+
+// CHECK: func.func @"left_!quir.qubit<1>_!quir.angle<20>"(%arg0: !quir.qubit<1>, %arg1: !quir.angle<20>)
+// CHECK: quir.call_gate @"phase_!quir.angle<20>_!quir.qubit<1>"(%arg1, %arg0) : (!quir.angle<20>, !quir.qubit<1>) -> ()
+func.func @left(%q : !quir.qubit<1>, %phi : !quir.angle) {
+  quir.call_gate @phase(%phi, %q) : (!quir.angle, !quir.qubit<1>) -> ()
+  return
+}
+
+// CHECK: func.func @"right_!quir.qubit<1>_!quir.angle<20>"(%arg0: !quir.qubit<1>, %arg1: !quir.angle<20>)
+// CHECK: quir.call_gate @"phase_!quir.angle<20>_!quir.qubit<1>"(%arg1, %arg0) : (!quir.angle<20>, !quir.qubit<1>) -> ()
+func.func @right(%q : !quir.qubit<1>, %phi : !quir.angle) {
+  quir.call_gate @phase(%phi, %q) : (!quir.angle, !quir.qubit<1>) -> ()
+  return
+}
+
+func.func @main () -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %ang = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  // CHECK-COUNT-2: quir.call_subroutine @"left_!quir.qubit<1>_!quir.angle<20>"
+  quir.call_subroutine @left(%q0, %ang) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  quir.call_subroutine @left(%q0, %ang) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  // CHECK-COUNT-2: quir.call_subroutine @"right_!quir.qubit<1>_!quir.angle<20>"
+  quir.call_subroutine @right(%q0, %ang) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  quir.call_subroutine @right(%q0, %ang) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
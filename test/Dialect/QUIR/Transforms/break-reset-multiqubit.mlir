@@ -1,10 +1,12 @@
 // RUN: qss-compiler -X=mlir --break-reset %s | FileCheck %s
 // RUN: qss-compiler -X=mlir --break-reset='numIterations=2 delayCycles=500' %s | FileCheck %s --check-prefix DELAYITER
+// RUN: qss-compiler -X=mlir --break-reset='vectorize=true' %s | FileCheck %s --check-prefix VECTOR
+// RUN: qss-compiler -X=mlir --break-reset='vectorize=true vectorize-max-qubits=2' %s | FileCheck %s --check-prefix CHECK
 
 //
 // This code is part of Qiskit.
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is licensed under the Apache License, Version 2.0 with LLVM
 // Exceptions. You may obtain a copy of this license in the LICENSE.txt
@@ -18,6 +20,9 @@ func.func @main() {
 // CHECK: [[QUBIT0:%.*]] = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
 // CHECK: [[QUBIT1:%.*]] = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
 // CHECK: [[QUBIT2:%.*]] = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+// VECTOR: [[QUBIT0:%.*]] = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+// VECTOR: [[QUBIT1:%.*]] = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+// VECTOR: [[QUBIT2:%.*]] = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
 // DELAYITER: [[DURATION:%.*]] = quir.constant #quir.duration<5.000000e+02> : !quir.duration<dt>
 // DELAYITER: [[QUBIT0:%.*]] = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
 // DELAYITER: [[QUBIT1:%.*]] = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
@@ -29,6 +34,7 @@ func.func @main() {
 
 // CHECK-NOT: quir.reset
 // DELAYITER-NOT: quir.reset
+// VECTOR-NOT: quir.reset
   quir.reset %1, %2, %3 : !quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>
 
 // CHECK: [[MEASUREMENT:%.*]]:3 = quir.measure(%0, %1, %2) {quir.noReportRuntime} : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> (i1, i1, i1)
@@ -51,6 +57,29 @@ func.func @main() {
 // DELAYITER: quir.measure
 // DELAYITER-COUNT-3: scf.if
 
+// VECTOR: [[MEASUREMENT:%.*]]:3 = quir.measure(%0, %1, %2) {quir.noReportRuntime}
+// VECTOR: [[BIT0:%.*]] = arith.extui [[MEASUREMENT]]#0 : i1 to i32
+// VECTOR: [[EXT1:%.*]] = arith.extui [[MEASUREMENT]]#1 : i1 to i32
+// VECTOR: [[SHL1:%.*]] = arith.shli [[EXT1]], %{{.*}} : i32
+// VECTOR: [[OR1:%.*]] = arith.ori [[BIT0]], [[SHL1]] : i32
+// VECTOR: [[EXT2:%.*]] = arith.extui [[MEASUREMENT]]#2 : i1 to i32
+// VECTOR: [[SHL2:%.*]] = arith.shli [[EXT2]], %{{.*}} : i32
+// VECTOR: [[FLAG:%.*]] = arith.ori [[OR1]], [[SHL2]] : i32
+// VECTOR: quir.switch [[FLAG]] {
+// VECTOR-NOT: quir.call_gate
+// VECTOR: 1 : {
+// VECTOR-NEXT:   quir.call_gate @x([[QUBIT0]]) : (!quir.qubit<1>) -> ()
+// VECTOR-NEXT: }
+// VECTOR: 5 : {
+// VECTOR-NEXT:   quir.call_gate @x([[QUBIT0]]) : (!quir.qubit<1>) -> ()
+// VECTOR-NEXT:   quir.call_gate @x([[QUBIT2]]) : (!quir.qubit<1>) -> ()
+// VECTOR-NEXT: }
+// VECTOR: 7 : {
+// VECTOR-NEXT:   quir.call_gate @x([[QUBIT0]]) : (!quir.qubit<1>) -> ()
+// VECTOR-NEXT:   quir.call_gate @x([[QUBIT1]]) : (!quir.qubit<1>) -> ()
+// VECTOR-NEXT:   quir.call_gate @x([[QUBIT2]]) : (!quir.qubit<1>) -> ()
+// VECTOR-NEXT: }]
+
   return
 }
 
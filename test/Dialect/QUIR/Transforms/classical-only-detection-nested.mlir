@@ -0,0 +1,119 @@
+// RUN: qss-compiler -X=mlir --classical-only-detection %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The quantum operations nested at any depth of control flow, circuits and
+// functions make each of their enclosing operations quantum, and only
+// those. A function is quantum if it takes qubits, is main, or declares
+// qubits or calls circuits at any depth.
+
+// CHECK-LABEL: quir.circuit @classical_circuit
+// CHECK-SAME: attributes {quir.classicalOnly = true}
+quir.circuit @classical_circuit() -> i32 {
+  %c2_i32 = arith.constant 2 : i32
+  quir.return %c2_i32 : i32
+}
+
+// CHECK-LABEL: quir.circuit @quantum_circuit
+// CHECK-SAME: attributes {quir.classicalOnly = false}
+quir.circuit @quantum_circuit(%arg0: !quir.qubit<1>) -> i1 {
+  %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+  quir.return %0 : i1
+}
+
+// CHECK-LABEL: quir.circuit @nested_circuit
+// CHECK-SAME: attributes {quir.classicalOnly = false}
+quir.circuit @nested_circuit(%arg0: !quir.qubit<1>) -> i1 {
+  %0 = quir.call_circuit @quantum_circuit(%arg0) : (!quir.qubit<1>) -> i1
+  quir.return %0 : i1
+}
+
+// CHECK-LABEL: func.func @classical
+// CHECK-SAME: attributes {quir.classicalOnly = true}
+func.func @classical(%arg0: index, %arg1: i1) -> i32 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c0_i32 = arith.constant 0 : i32
+  %0 = scf.for %iv = %c0 to %arg0 step %c1 iter_args(%sum = %c0_i32) -> (i32) {
+    %1 = scf.if %arg1 -> (i32) {
+      %2 = arith.addi %sum, %sum : i32
+      scf.yield %2 : i32
+    } else {
+      scf.yield %sum : i32
+    }
+    // CHECK: } {quir.classicalOnly = true}
+    scf.yield %1 : i32
+  }
+  // CHECK: } {quir.classicalOnly = true}
+  return %0 : i32
+}
+
+// CHECK-LABEL: func.func @calls_circuit
+// CHECK-SAME: attributes {quir.classicalOnly = false}
+func.func @calls_circuit(%arg0: index, %arg1: i1) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  scf.for %iv = %c0 to %arg0 step %c1 {
+    scf.if %arg1 {
+      %0 = quir.call_circuit @classical_circuit() : () -> i32
+    }
+    // CHECK: } {quir.classicalOnly = false}
+  }
+  // CHECK: } {quir.classicalOnly = false}
+  return
+}
+
+// CHECK-LABEL: func.func @deep_gate
+// CHECK-SAME: attributes {quir.classicalOnly = false}
+func.func @deep_gate(%arg0: !quir.qubit<1>, %arg1: i1, %arg2: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %a = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  scf.for %iv = %c0 to %arg2 step %c1 {
+    scf.if %arg1 {
+      %0 = arith.addi %iv, %iv : index
+    }
+    // CHECK: } {quir.classicalOnly = true}
+    scf.if %arg1 {
+      scf.for %jv = %c0 to %arg2 step %c1 {
+        quir.builtin_U %arg0, %a, %a, %a : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+      }
+      // CHECK: } {quir.classicalOnly = false}
+    }
+    // CHECK: } {quir.classicalOnly = false}
+  }
+  // CHECK: } {quir.classicalOnly = false}
+  return
+}
+
+// CHECK-LABEL: func.func @main
+// CHECK-SAME: attributes {quir.classicalOnly = false}
+func.func @main() -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %c0 = arith.constant 0 : index
+  %c4 = arith.constant 4 : index
+  %true = arith.constant true
+  %c0_i32 = arith.constant 0 : i32
+  %0 = quir.call_circuit @quantum_circuit(%q0) : (!quir.qubit<1>) -> i1
+  scf.if %0 {
+    %1 = quir.call_circuit @nested_circuit(%q0) : (!quir.qubit<1>) -> i1
+  }
+  // CHECK: } {quir.classicalOnly = false}
+  scf.if %0 {
+    %1 = func.call @classical(%c4, %true) : (index, i1) -> i32
+  }
+  // CHECK: } {quir.classicalOnly = true}
+  func.call @calls_circuit(%c4, %0) : (index, i1) -> ()
+  return %c0_i32 : i32
+}
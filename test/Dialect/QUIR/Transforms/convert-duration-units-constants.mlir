@@ -0,0 +1,46 @@
+// RUN: qss-compiler -X=mlir --convert-quir-duration-units='units=ms' %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --convert-quir-duration-units='units=s' %s | FileCheck %s --check-prefix=S
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that durations which only flow from constants are
+// converted in place, including within nested regions, and that durations
+// already in the target units are left untouched.
+
+// CHECK-LABEL: func.func @constant_durations
+// S-LABEL: func.func @constant_durations
+func.func @constant_durations(%cond : i1) {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+
+    %duration_s = quir.constant #quir.duration<2.5> : !quir.duration<s>
+    // CHECK: [[duration_s:%.*]] = quir.constant #quir.duration<2.500000e+03> : !quir.duration<ms>
+    // S: [[duration_s:%.*]] = quir.constant #quir.duration<2.500000e+00> : !quir.duration<s>
+    %duration_s_repeat = quir.constant #quir.duration<2.5> : !quir.duration<s>
+    // CHECK: [[duration_s_repeat:%.*]] = quir.constant #quir.duration<2.500000e+03> : !quir.duration<ms>
+    %duration_ms = quir.constant #quir.duration<4.0> : !quir.duration<ms>
+    // CHECK: [[duration_ms:%.*]] = quir.constant #quir.duration<4.000000e+00> : !quir.duration<ms>
+    // S: [[duration_ms:%.*]] = quir.constant #quir.duration<4.000000e-03> : !quir.duration<s>
+
+    quir.delay %duration_s, (%q0) : !quir.duration<s>, (!quir.qubit<1>) -> ()
+    // CHECK: quir.delay [[duration_s]], ({{.*}}) : !quir.duration<ms>, (!quir.qubit<1>) -> ()
+    // S: quir.delay [[duration_s]], ({{.*}}) : !quir.duration<s>, (!quir.qubit<1>) -> ()
+    scf.if %cond {
+        quir.delay %duration_s_repeat, (%q0) : !quir.duration<s>, (!quir.qubit<1>) -> ()
+        // CHECK: quir.delay [[duration_s_repeat]], ({{.*}}) : !quir.duration<ms>, (!quir.qubit<1>) -> ()
+        quir.delay %duration_ms, (%q0) : !quir.duration<ms>, (!quir.qubit<1>) -> ()
+        // CHECK: quir.delay [[duration_ms]], ({{.*}}) : !quir.duration<ms>, (!quir.qubit<1>) -> ()
+        // S: quir.delay [[duration_ms]], ({{.*}}) : !quir.duration<s>, (!quir.qubit<1>) -> ()
+    }
+    return
+}
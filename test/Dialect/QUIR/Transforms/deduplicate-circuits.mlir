@@ -0,0 +1,59 @@
+// RUN: qss-compiler -X=mlir --deduplicate-circuits %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+module {
+  // CHECK: quir.circuit @circuit_0(
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.angle<64>) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    quir.call_gate @rz(%arg0, %arg1) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // CHECK-NOT: quir.circuit @circuit_1(
+  quir.circuit @circuit_1(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.angle<64>) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    quir.call_gate @rz(%arg0, %arg1) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // a different qubit is not a duplicate
+  // CHECK: quir.circuit @circuit_2(
+  quir.circuit @circuit_2(%arg0: !quir.qubit<1> {quir.physicalId = 1 : i32}, %arg1: !quir.angle<64>) -> i1 attributes {quir.physicalIds = [1 : i32]} {
+    quir.call_gate @rz(%arg0, %arg1) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // neither is a different gate
+  // CHECK: quir.circuit @circuit_3(
+  quir.circuit @circuit_3(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.angle<64>) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    quir.call_gate @rx(%arg0, %arg1) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %a0 = quir.constant #quir.angle<0.1> : !quir.angle<64>
+    %a1 = quir.constant #quir.angle<0.2> : !quir.angle<64>
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    // CHECK: quir.call_circuit @circuit_0(%0, {{.*}})
+    %2 = quir.call_circuit @circuit_0(%0, %a0) : (!quir.qubit<1>, !quir.angle<64>) -> i1
+    // CHECK: quir.call_circuit @circuit_0(%0, {{.*}})
+    %3 = quir.call_circuit @circuit_1(%0, %a1) : (!quir.qubit<1>, !quir.angle<64>) -> i1
+    // CHECK: quir.call_circuit @circuit_2(%1, {{.*}})
+    %4 = quir.call_circuit @circuit_2(%1, %a1) : (!quir.qubit<1>, !quir.angle<64>) -> i1
+    // CHECK: quir.call_circuit @circuit_3(%0, {{.*}})
+    %5 = quir.call_circuit @circuit_3(%0, %a1) : (!quir.qubit<1>, !quir.angle<64>) -> i1
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,77 @@
+// RUN: qss-compiler -X=mlir --quir-schedule-feedforward %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-schedule-feedforward --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The classical ops which a branch on a measurement does not depend on are
+// moved after the branch, and the ones it depends on that do not depend on
+// the measurement are moved before the measurement.
+
+// STATS-DAG: (S) {{ *}}1 feedforward-branches
+// STATS-DAG: (S) {{ *}}2 feedforward-ops
+// STATS-DAG: (S) {{ *}}5 moved-ops
+
+oq3.declare_variable @count : i32
+oq3.declare_variable @c : i1
+
+func.func private @record(i32) -> ()
+
+// CHECK-LABEL: func.func @conditional
+func.func @conditional() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %a = quir.constant #quir.angle<0.0> : !quir.angle<64>
+  // CHECK: %[[B:.*]] = quir.constant #quir.angle<2.000000e-01>
+  // CHECK-NEXT: %[[RES:.*]] = quir.measure(%{{.*}})
+  // CHECK-NEXT: oq3.variable_assign @c : i1 = %[[RES]]
+  // CHECK-NEXT: %[[C:.*]] = oq3.variable_load @c : i1
+  // CHECK-NEXT: scf.if %[[C]] {
+  // CHECK-NEXT: quir.builtin_U %{{.*}}, %[[B]]
+  // CHECK-NEXT: } {quir.feedforwardOps = 2 : i32}
+  // CHECK-NEXT: oq3.variable_load @count
+  // CHECK-NEXT: arith.constant 1 : i32
+  // CHECK-NEXT: arith.addi
+  // CHECK-NEXT: oq3.variable_assign @count
+  %res = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  %count = oq3.variable_load @count : i32
+  %one = arith.constant 1 : i32
+  %next = arith.addi %count, %one : i32
+  oq3.variable_assign @count : i32 = %next
+  oq3.variable_assign @c : i1 = %res
+  %b = quir.constant #quir.angle<0.2> : !quir.angle<64>
+  %c = oq3.variable_load @c : i1
+  scf.if %c {
+    quir.builtin_U %q1, %b, %a, %a : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @unknown_effects
+func.func @unknown_effects() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %a = quir.constant #quir.angle<0.0> : !quir.angle<64>
+  %zero = arith.constant 0 : i32
+  // CHECK: quir.measure
+  // CHECK-NEXT: func.call @record
+  // CHECK-NEXT: arith.addi
+  // CHECK-NEXT: scf.if
+  // CHECK-NOT: quir.feedforwardOps
+  %res = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  func.call @record(%zero) : (i32) -> ()
+  %sum = arith.addi %zero, %zero : i32
+  scf.if %res {
+    quir.builtin_U %q0, %a, %a, %a : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+  }
+  return
+}
@@ -0,0 +1,64 @@
+// RUN: qss-compiler -X=mlir --quir-fold-angles %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-fold-angles=parameters=true %s | FileCheck %s --check-prefix=PARAMS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Angle arithmetic on constants is evaluated at compile time and wrapped
+// into [0, 2*pi), parameters only with their initial values on request.
+
+qcs.declare_parameter @theta : !quir.angle<20> = #quir.angle<0.5> : !quir.angle<20>
+
+// CHECK-LABEL: func.func @constants
+func.func @constants() -> (!quir.angle<20>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>) {
+  %a = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  %b = quir.constant #quir.angle<0.2> : !quir.angle<20>
+  %c = quir.constant #quir.angle<3.0> : !quir.angle<20>
+  %zero = quir.constant #quir.angle<0.0> : !quir.angle<20>
+  // CHECK-DAG: %[[SUM:.*]] = quir.constant #quir.angle<3.000000e-01> : !quir.angle<20>
+  %sum = oq3.angle_add %a, %b : !quir.angle<20>
+  // CHECK-DAG: %[[DIFF:.*]] = quir.constant #quir.angle<6.183185e+00> : !quir.angle<20>
+  %diff = oq3.angle_sub %a, %b : !quir.angle<20>
+  // CHECK-DAG: %[[PROD:.*]] = quir.constant #quir.angle<2.716815e+00> : !quir.angle<20>
+  %prod = oq3.angle_mul %c, %c : !quir.angle<20>
+  // CHECK: %[[QUOT:.*]] = oq3.angle_div
+  %quot = oq3.angle_div %a, %zero : !quir.angle<20>
+  // CHECK: return %[[SUM]], %[[DIFF]], %[[PROD]], %[[QUOT]]
+  return %sum, %diff, %prod, %quot : !quir.angle<20>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+}
+
+// CHECK-LABEL: func.func @compare
+func.func @compare() -> (i1, i1) {
+  %a = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  %b = quir.constant #quir.angle<0.2> : !quir.angle<20>
+  // CHECK: %[[ULT:.*]] = arith.constant true
+  %ult = oq3.angle_cmp {predicate = "ult"} %a, %b : !quir.angle<20> -> i1
+  // the order of signed angles is left to the target
+  // CHECK: %[[SLT:.*]] = oq3.angle_cmp {predicate = "slt"}
+  %slt = oq3.angle_cmp {predicate = "slt"} %a, %b : !quir.angle<20> -> i1
+  // CHECK: return %[[ULT]], %[[SLT]]
+  return %ult, %slt : i1, i1
+}
+
+// CHECK-LABEL: func.func @parameters
+// PARAMS-LABEL: func.func @parameters
+func.func @parameters() -> !quir.angle<20> {
+  %a = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  // CHECK: %[[THETA:.*]] = qcs.parameter_load @theta
+  // CHECK: oq3.angle_add %[[THETA]]
+  // PARAMS-NOT: qcs.parameter_load
+  // PARAMS: quir.constant #quir.angle<6.000000e-01> : !quir.angle<20>
+  %theta = qcs.parameter_load @theta : !quir.angle<20>
+  %sum = oq3.angle_add %theta, %a : !quir.angle<20>
+  return %sum : !quir.angle<20>
+}
@@ -0,0 +1,100 @@
+// RUN: qss-compiler -X=mlir --quir-cancel-gates %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-cancel-gates --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS-DAG: (S) {{ *}}4 cancelled-gates
+// STATS-DAG: (S) {{ *}}1 fused-gates
+
+func.func private @sub(!quir.qubit<1>) -> ()
+
+// CHECK-LABEL: func.func @cancel_cx
+func.func @cancel_cx() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+  %a = quir.constant #quir.angle<1.0> : !quir.angle<64>
+  // CHECK-NOT: quir.builtin_CX
+  // CHECK: quir.builtin_U
+  // CHECK-NOT: quir.builtin_CX
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  // the gate on a disjoint qubit commutes with the CX
+  quir.builtin_U %q2, %a, %a, %a : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  return
+}
+
+// CHECK-LABEL: func.func @keep_swapped_cx
+func.func @keep_swapped_cx() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  // CHECK: quir.builtin_CX %{{.*}}, %{{.*}}
+  // CHECK: quir.builtin_CX %{{.*}}, %{{.*}}
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  quir.builtin_CX %q1, %q0 : !quir.qubit<1>, !quir.qubit<1>
+  return
+}
+
+// CHECK-LABEL: func.func @cancel_inverse_u
+func.func @cancel_inverse_u() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %zero = quir.constant #quir.angle<0.0> : !quir.angle<64>
+  %half_pi = quir.constant #quir.angle<1.5707963267948966> : !quir.angle<64>
+  %pi = quir.constant #quir.angle<3.1415926535897931> : !quir.angle<64>
+  // CHECK-NOT: quir.builtin_U
+  // CHECK: return
+  quir.builtin_U %q0, %half_pi, %zero, %pi : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+  quir.builtin_U %q0, %half_pi, %zero, %pi : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+  return
+}
+
+// CHECK-LABEL: func.func @fuse_u
+func.func @fuse_u() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %zero = quir.constant #quir.angle<0.0> : !quir.angle<64>
+  %half_pi = quir.constant #quir.angle<1.5707963267948966> : !quir.angle<64>
+  // CHECK-DAG: %[[THETA:.*]] = quir.constant #quir.angle<3.141593e+00> : !quir.angle<64>
+  // CHECK-DAG: %[[ZERO:.*]] = quir.constant #quir.angle<0.000000e+00> : !quir.angle<64>
+  // CHECK: quir.builtin_U %{{.*}}, %[[THETA]], %[[ZERO]], %[[ZERO]]
+  // CHECK-NOT: quir.builtin_U
+  quir.builtin_U %q0, %half_pi, %zero, %zero : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+  quir.builtin_U %q0, %half_pi, %zero, %zero : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+  return
+}
+
+// CHECK-LABEL: func.func @keep_around_call
+func.func @keep_around_call() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  // CHECK: quir.builtin_CX
+  // CHECK: quir.call_subroutine @sub
+  // CHECK: quir.builtin_CX
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  quir.call_subroutine @sub(%q0) : (!quir.qubit<1>) -> ()
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  return
+}
+
+// CHECK-LABEL: func.func @keep_around_measure
+func.func @keep_around_measure() -> i1 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  // CHECK: quir.builtin_CX
+  // CHECK: quir.measure
+  // CHECK: quir.builtin_CX
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  %r = quir.measure(%q1) : (!quir.qubit<1>) -> i1
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  return %r : i1
+}
@@ -0,0 +1,42 @@
+// RUN: qss-compiler -X=mlir --pass-pipeline='builtin.module(ir-statistics)' --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that the size of the IR with the constant-bound loops
+// unrolled and the subroutines cloned is counted
+
+func.func @sub(%q0 : !quir.qubit<1>) {
+  quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @main() -> i32 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c10 = arith.constant 10 : index
+  %c0_i32 = arith.constant 0 : i32
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  scf.for %i = %c0 to %c10 step %c1 {
+    quir.call_subroutine @sub(%q0) : (!quir.qubit<1>) -> ()
+  }
+  return %c0_i32 : i32
+}
+
+// CHECK: IR Statistics Pass
+// CHECK-DAG: (S) {{ *}}14 num-ops
+// CHECK-DAG: (S) {{ *}}1 num-qubits
+// CHECK-DAG: (S) {{ *}}59 unrolled-ops
+// CHECK-DAG: (S) {{ *}}10 unrolled-quantum-ops
+// CHECK-DAG: (S) {{ *}}10 unrolled-subroutine-calls
+// CHECK-DAG: (S) {{ *}}10 max-subroutine-fan-out
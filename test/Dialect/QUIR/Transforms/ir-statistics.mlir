@@ -0,0 +1,81 @@
+// RUN: qss-compiler -X=mlir --pass-pipeline='builtin.module(ir-statistics{label=input},subroutine-cloning,ir-statistics{label=cloned})' --timing-trace=%t %s -o /dev/null
+// RUN: FileCheck %s < %t
+// RUN: qss-compiler -X=mlir --pass-pipeline='builtin.module(ir-statistics{label=input},subroutine-cloning,ir-statistics{label=cloned})' --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that the size of the IR before and after subroutine
+// cloning is recorded in the timing trace and as pass statistics, and that
+// the size after cloning is estimated from the input
+
+func.func @sub1(%q0 : !quir.qubit<1>) {
+  quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @sub2(%q0 : !quir.qubit<1>) {
+  quir.call_subroutine @sub1(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @main() -> i32 {
+  %c0_i32 = arith.constant 0 : i32
+  %samples = arith.constant dense<[1.0, 2.0]> : tensor<2xf64>
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  quir.call_subroutine @sub2(%q0) : (!quir.qubit<1>) -> ()
+  quir.call_subroutine @sub2(%q1) : (!quir.qubit<1>) -> ()
+  return %c0_i32 : i32
+}
+
+// CHECK: "name": "input",
+// CHECK-NEXT: "cat": "counters",
+// CHECK-NEXT: "ph": "C",
+// CHECK-NEXT: "ts":
+// CHECK-NEXT: "pid":
+// CHECK-NEXT: "tid":
+// CHECK-NEXT: "args": {
+// CHECK-NEXT: "ops": 15,
+// CHECK-NEXT: "regions": 4,
+// CHECK-NEXT: "blocks": 4,
+// CHECK-NEXT: "symbols": 4,
+// CHECK-NEXT: "elements-bytes": 16,
+// CHECK-NEXT: "qubits": 2,
+// CHECK-NEXT: "unrolled-ops": 21,
+// CHECK-NEXT: "unrolled-quantum-ops": 2,
+// CHECK-NEXT: "unrolled-subroutine-calls": 4,
+// CHECK-NEXT: "max-subroutine-fan-out": 2
+// CHECK: "name": "input ops",
+// CHECK: "args": {
+// CHECK-NEXT: "builtin.module": 1,
+// CHECK-NEXT: "func.func": 3,
+// CHECK-NEXT: "quir.call_gate": 1,
+// CHECK-NEXT: "func.return": 3,
+// CHECK-NEXT: "quir.call_subroutine": 3,
+// CHECK-NEXT: "arith.constant": 2,
+// CHECK-NEXT: "quir.declare_qubit": 2
+// CHECK: "name": "cloned",
+// CHECK: "args": {
+// CHECK-NEXT: "ops": 21,
+// CHECK-NEXT: "regions": 6,
+// CHECK-NEXT: "blocks": 6,
+// CHECK-NEXT: "symbols": 6,
+// CHECK-NEXT: "elements-bytes": 16
+// CHECK: "name": "cloned ops",
+// CHECK: "func.func": 5,
+
+// STATS: IR Statistics Pass
+// STATS-DAG: (S) {{ *}}36 num-ops
+// STATS-DAG: (S) {{ *}}10 num-symbols
+// STATS-DAG: (S) {{ *}}32 elements-bytes
@@ -0,0 +1,96 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-loads %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Loads of variables with several assignments are forwarded along the
+// structured control flow.
+
+oq3.declare_variable @a : i32
+oq3.declare_variable @b : i32
+oq3.declare_variable @c : i32
+
+func.func @subroutine() {
+  %c0_i32 = arith.constant 0 : i32
+  oq3.variable_assign @a : i32 = %c0_i32
+  return
+}
+
+// CHECK-LABEL: func.func @main
+func.func @main(%cond : i1) -> i32 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c10 = arith.constant 10 : index
+  // CHECK: [[C1:%.*]] = arith.constant 1 : i32
+  // CHECK: [[C2:%.*]] = arith.constant 2 : i32
+  %c1_i32 = arith.constant 1 : i32
+  %c2_i32 = arith.constant 2 : i32
+  oq3.variable_assign @a : i32 = %c1_i32
+  oq3.variable_assign @b : i32 = %c1_i32
+  oq3.variable_assign @c : i32 = %c1_i32
+
+  // c is only reassigned in one of the branches
+  // CHECK: scf.if
+  scf.if %cond {
+    // CHECK: oq3.variable_assign @b : i32 = [[C1]]
+    %a0 = oq3.variable_load @a : i32
+    oq3.variable_assign @b : i32 = %a0
+    oq3.variable_assign @c : i32 = %c2_i32
+  } else {
+    oq3.variable_assign @b : i32 = %c1_i32
+  }
+
+  // the values of a and b are the same on both paths, and c is loaded once
+  // CHECK-NOT: oq3.variable_load @a
+  // CHECK-NOT: oq3.variable_load @b
+  // CHECK: [[C:%.*]] = oq3.variable_load @c : i32
+  // CHECK-NOT: oq3.variable_load @c
+  // CHECK: [[SUM:%.*]] = arith.addi [[C1]], [[C]]
+  // CHECK: arith.addi [[C]], [[C1]]
+  %a1 = oq3.variable_load @a : i32
+  %b1 = oq3.variable_load @b : i32
+  %cv1 = oq3.variable_load @c : i32
+  %cv2 = oq3.variable_load @c : i32
+  %sum0 = arith.addi %b1, %cv1 : i32
+  %sum1 = arith.addi %cv2, %a1 : i32
+  oq3.variable_assign @a : i32 = %sum0
+
+  // the loop body reassigns b and c, so only a keeps its value in the loop
+  // CHECK: scf.for
+  scf.for %i = %c0 to %c10 step %c1 {
+    // CHECK: [[B:%.*]] = oq3.variable_load @b : i32
+    // CHECK-NOT: oq3.variable_load @a
+    // CHECK: [[SUM2:%.*]] = arith.addi [[B]], [[SUM]] : i32
+    // CHECK: oq3.variable_assign @b : i32 = [[SUM2]]
+    // CHECK-NOT: oq3.variable_load @b
+    // CHECK: oq3.variable_assign @c : i32 = [[SUM2]]
+    %b2 = oq3.variable_load @b : i32
+    %a2 = oq3.variable_load @a : i32
+    %sum2 = arith.addi %b2, %a2 : i32
+    oq3.variable_assign @b : i32 = %sum2
+    %b3 = oq3.variable_load @b : i32
+    oq3.variable_assign @c : i32 = %b3
+  }
+
+  // CHECK: oq3.variable_load @b
+  %b4 = oq3.variable_load @b : i32
+  oq3.variable_assign @c : i32 = %b4
+
+  // subroutines may assign any variable
+  // CHECK: quir.call_subroutine @subroutine
+  // CHECK: [[A2:%.*]] = oq3.variable_load @a
+  // CHECK: return [[A2]]
+  quir.call_subroutine @subroutine() : () -> ()
+  %a3 = oq3.variable_load @a : i32
+  return %a3 : i32
+}
@@ -0,0 +1,88 @@
+// RUN: qss-compiler -X=mlir --merge-measures-topological=hoist-from-branches=true %s | FileCheck %s --check-prefix MEAS
+// RUN: qss-compiler -X=mlir --merge-resets-topological=hoist-from-branches=true %s | FileCheck %s --check-prefix RESET
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that measures and resets common to the start or end of
+// all branches are hoisted into the enclosing block and merged there.
+
+func.func private @x(%q : !quir.qubit<1>)
+
+// MEAS-LABEL: func.func @hoist_measures_before_if
+func.func @hoist_measures_before_if(%cond : i1, %c : memref<1xi1>, %ind : index) {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+  // MEAS: %{{.*}}:2 = quir.measure(%{{.*}}, %{{.*}}) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+  // MEAS: scf.if
+  // MEAS-NOT: quir.measure
+  // MEAS: quir.call_gate @x
+  // MEAS: } else {
+  // MEAS-NOT: quir.measure
+  // MEAS: return
+  %res0 = quir.measure(%q0) : (!quir.qubit<1>) -> (i1)
+  scf.if %cond {
+    quir.call_gate @x(%q2) : (!quir.qubit<1>) -> ()
+    %res1 = quir.measure(%q1) : (!quir.qubit<1>) -> (i1)
+    memref.store %res1, %c[%ind] : memref<1xi1>
+  } else {
+    %res2 = quir.measure(%q1) : (!quir.qubit<1>) -> (i1)
+    memref.store %res2, %c[%ind] : memref<1xi1>
+  }
+  return
+}
+
+// MEAS-LABEL: func.func @keep_dependent_measures
+func.func @keep_dependent_measures(%cond : i1) {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  // MEAS: %{{.*}} = quir.measure(%{{.*}}) : (!quir.qubit<1>) -> i1
+  // MEAS: scf.if
+  // MEAS: quir.call_gate @x
+  // MEAS: quir.measure
+  // MEAS: } else {
+  // MEAS: quir.measure
+  %res0 = quir.measure(%q0) : (!quir.qubit<1>) -> (i1)
+  scf.if %cond {
+    quir.call_gate @x(%q1) : (!quir.qubit<1>) -> ()
+    %res1 = quir.measure(%q1) : (!quir.qubit<1>) -> (i1)
+  } else {
+    %res2 = quir.measure(%q1) : (!quir.qubit<1>) -> (i1)
+  }
+  return
+}
+
+// RESET-LABEL: func.func @sink_resets_after_switch
+func.func @sink_resets_after_switch(%flag : i32) {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  // RESET: quir.switch
+  // RESET-NOT: quir.reset
+  // RESET: ]
+  // RESET-NEXT: quir.reset %{{.*}}, %{{.*}} : !quir.qubit<1>, !quir.qubit<1>
+  quir.switch %flag {
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    quir.reset %q1 : !quir.qubit<1>
+  } [
+    0: {
+      quir.reset %q1 : !quir.qubit<1>
+    }
+    1: {
+      quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+      quir.reset %q1 : !quir.qubit<1>
+    }
+  ]
+  quir.reset %q0 : !quir.qubit<1>
+  return
+}
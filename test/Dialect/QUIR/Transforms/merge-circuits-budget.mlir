@@ -0,0 +1,40 @@
+// RUN: qss-compiler -X=mlir --merge-circuits --memory-budget=1 %s 2>&1 | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that circuits are not merged once the memory budget is
+// exceeded, which no compilation fits in 1 MiB.
+
+module {
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1>) -> i1 {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0: i1
+  }
+  quir.circuit @circuit_1(%arg0: !quir.qubit<1>) -> i1 {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0: i1
+  }
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %2 = quir.call_circuit @circuit_0(%0) : (!quir.qubit<1>) -> i1
+    %3 = quir.call_circuit @circuit_1(%1) : (!quir.qubit<1>) -> i1
+    return %c0_i32 : i32
+  }
+}
+
+// CHECK: warning: memory budget of 1 MiB exceeded by a peak resident set size of {{[0-9]+}} MiB, skipping merge-circuits
+// CHECK: quir.call_circuit @circuit_0(%{{.*}})
+// CHECK-NEXT: quir.call_circuit @circuit_1(%{{.*}})
@@ -0,0 +1,59 @@
+// RUN: qss-compiler -X=mlir --merge-circuits=sweep=true %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that a run of call_circuits is merged into one circuit
+// without the intermediate pairwise merges
+
+module {
+  oq3.declare_variable @c : !quir.cbit<3>
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  quir.circuit @circuit_1(%arg0: !quir.qubit<1> {quir.physicalId = 1 : i32}) -> i1 attributes {quir.physicalIds = [1 : i32]} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  quir.circuit @circuit_2(%arg0: !quir.qubit<1> {quir.physicalId = 2 : i32}) -> i1 attributes {quir.physicalIds = [2 : i32]} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // CHECK-NOT: quir.circuit @circuit_0_circuit_1(
+  // CHECK: quir.circuit @circuit_0_circuit_1_circuit_2(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.qubit<1> {quir.physicalId = 1 : i32}, %arg2: !quir.qubit<1> {quir.physicalId = 2 : i32}) -> (i1, i1, i1) attributes {quir.physicalIds = [0 : i32, 1 : i32, 2 : i32]} {
+  // CHECK-NEXT: %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+  // CHECK-NEXT: quir.barrier %arg2 : (!quir.qubit<1>) -> ()
+  // CHECK-NEXT: %1 = quir.measure(%arg1) : (!quir.qubit<1>) -> i1
+  // CHECK-NEXT: %2 = quir.measure(%arg2) : (!quir.qubit<1>) -> i1
+  // CHECK-NEXT: quir.return %0, %1, %2 : i1, i1, i1
+  // CHECK-NEXT: }
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+    %3 = quir.call_circuit @circuit_0(%0) : (!quir.qubit<1>) -> i1
+    oq3.cbit_assign_bit @c<3> [0] : i1 = %3
+    quir.barrier %2 : (!quir.qubit<1>) -> ()
+    %4 = quir.call_circuit @circuit_1(%1) : (!quir.qubit<1>) -> i1
+    oq3.cbit_assign_bit @c<3> [1] : i1 = %4
+    %5 = quir.call_circuit @circuit_2(%2) : (!quir.qubit<1>) -> i1
+    oq3.cbit_assign_bit @c<3> [2] : i1 = %5
+    // CHECK: %[[MEAS:.*]]:3 = quir.call_circuit @circuit_0_circuit_1_circuit_2(%0, %1, %2) : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> (i1, i1, i1)
+    // CHECK-NEXT: oq3.cbit_assign_bit @c<3> [0] : i1 = %[[MEAS]]#0
+    // CHECK-NEXT: oq3.cbit_assign_bit @c<3> [1] : i1 = %[[MEAS]]#1
+    // CHECK-NEXT: oq3.cbit_assign_bit @c<3> [2] : i1 = %[[MEAS]]#2
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,66 @@
+// RUN: qss-compiler -X=mlir --quir-merge-delays %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-merge-delays --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS: (S) {{ *}}3 merged-delays
+
+quir.circuit @circuit_0(%arg0: !quir.qubit<1>) {
+  quir.return
+}
+
+// CHECK-LABEL: func.func @main
+func.func @main() {
+  // CHECK: %[[Q0:.*]] = quir.declare_qubit {id = 0 : i32}
+  // CHECK: %[[Q1:.*]] = quir.declare_qubit {id = 1 : i32}
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %dur10 = quir.constant #quir.duration<10.0> : !quir.duration<dt>
+  %dur20 = quir.constant #quir.duration<20.0> : !quir.duration<dt>
+  %dur5 = quir.constant #quir.duration<5.0> : !quir.duration<ns>
+
+  // the delays of a qubit are merged across the circuits of other qubits
+  // CHECK: %[[D30:.*]] = quir.constant #quir.duration<3.000000e+01> : !quir.duration<dt>
+  // CHECK-NEXT: quir.delay %[[D30]], (%[[Q0]])
+  // CHECK-NEXT: quir.call_circuit @circuit_0(%[[Q1]])
+  // CHECK-NEXT: quir.call_circuit @circuit_0(%[[Q0]])
+  quir.delay %dur10, (%q0) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+  quir.call_circuit @circuit_0(%q1) : (!quir.qubit<1>) -> ()
+  quir.delay %dur20, (%q0) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+  quir.call_circuit @circuit_0(%q0) : (!quir.qubit<1>) -> ()
+
+  // but not across a circuit of the qubit, nor with delays in other units
+  // CHECK-NEXT: %[[D20:.*]] = quir.constant #quir.duration<2.000000e+01> : !quir.duration<dt>
+  // CHECK-NEXT: quir.delay %[[D20]], (%[[Q0]])
+  // CHECK-NEXT: quir.delay %{{.*}}, (%[[Q0]]) : !quir.duration<ns>
+  // CHECK-NEXT: quir.call_circuit @circuit_0(%[[Q0]])
+  // CHECK-NEXT: quir.delay %{{.*}}, (%[[Q0]]) : !quir.duration<dt>
+  quir.delay %dur10, (%q0) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+  quir.delay %dur10, (%q0) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+  quir.delay %dur5, (%q0) : !quir.duration<ns>, (!quir.qubit<1>) -> ()
+  quir.call_circuit @circuit_0(%q0) : (!quir.qubit<1>) -> ()
+  quir.delay %dur10, (%q0) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+
+  // delays of all qubits are merged unless an op acts on a qubit in between
+  // CHECK-NEXT: %[[D40:.*]] = quir.constant #quir.duration<4.000000e+01> : !quir.duration<dt>
+  // CHECK-NEXT: quir.delay %[[D40]], () : !quir.duration<dt>, () -> ()
+  // CHECK-NEXT: quir.call_circuit @circuit_0(%[[Q1]])
+  // CHECK-NEXT: quir.delay %{{.*}}, () : !quir.duration<dt>, () -> ()
+  // CHECK-NEXT: return
+  quir.delay %dur20, () : !quir.duration<dt>, () -> ()
+  quir.delay %dur20, () : !quir.duration<dt>, () -> ()
+  quir.call_circuit @circuit_0(%q1) : (!quir.qubit<1>) -> ()
+  quir.delay %dur20, () : !quir.duration<dt>, () -> ()
+  return
+}
@@ -0,0 +1,73 @@
+// RUN: qss-compiler -X=mlir --minimize-synchronization %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK-LABEL: func.func @main
+func.func @main() {
+  // CHECK: %[[Q0:.*]] = quir.declare_qubit {id = 0 : i32}
+  // CHECK: %[[Q1:.*]] = quir.declare_qubit {id = 1 : i32}
+  // CHECK: %[[Q2:.*]] = quir.declare_qubit {id = 2 : i32}
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+
+  // the first synchronization is implied by the second one, which implies
+  // the third one
+  // CHECK-NEXT: qcs.synchronize %[[Q0]], %[[Q1]] :
+  // CHECK-NEXT: quir.reset %[[Q0]]
+  qcs.synchronize %q0 : (!quir.qubit<1>) -> ()
+  qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+  qcs.synchronize %q1 : (!quir.qubit<1>) -> ()
+  quir.reset %q0 : !quir.qubit<1>
+
+  // the delays of a qubit are merged across ops on other qubits, but not
+  // across a synchronization of the qubit
+  // CHECK-NEXT: qcs.synchronize %[[Q0]], %[[Q1]] :
+  // CHECK-NEXT: qcs.delay_cycles(%[[Q2]]) {time = 30 : i64}
+  // CHECK-NEXT: quir.reset %[[Q0]]
+  // CHECK-NEXT: qcs.synchronize %[[Q2]] :
+  // CHECK-NEXT: qcs.delay_cycles(%[[Q2]]) {time = 5 : i64}
+  qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+  qcs.delay_cycles(%q2) {time = 10 : i64} : (!quir.qubit<1>) -> ()
+  quir.reset %q0 : !quir.qubit<1>
+  qcs.delay_cycles(%q2) {time = 20 : i64} : (!quir.qubit<1>) -> ()
+  qcs.delay_cycles(%q0) {time = 0 : i64} : (!quir.qubit<1>) -> ()
+  qcs.synchronize %q2 : (!quir.qubit<1>) -> ()
+  qcs.delay_cycles(%q2) {time = 5 : i64} : (!quir.qubit<1>) -> ()
+
+  // a synchronization of all qubits implies the later ones
+  // CHECK-NEXT: qcs.synchronize : () -> ()
+  // CHECK-NEXT: return
+  qcs.synchronize : () -> ()
+  qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+  qcs.synchronize : () -> ()
+  return
+}
+
+// CHECK-LABEL: func.func @regions
+func.func @regions(%c : i1) {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  // CHECK: qcs.synchronize
+  // CHECK-NEXT: scf.if
+  // CHECK-NEXT: qcs.synchronize
+  // CHECK-NEXT: }
+  // CHECK-NEXT: qcs.synchronize
+  qcs.synchronize %q0 : (!quir.qubit<1>) -> ()
+  scf.if %c {
+    qcs.synchronize %q0 : (!quir.qubit<1>) -> ()
+    qcs.synchronize %q0 : (!quir.qubit<1>) -> ()
+  }
+  qcs.synchronize %q0 : (!quir.qubit<1>) -> ()
+  return
+}
@@ -0,0 +1,99 @@
+// RUN: qss-compiler -X=mlir --parallel-control-flow %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Adjacent branch ops acting on disjoint qubits and classical state are
+// grouped into a qcs.parallel_control_flow, side effect free ops between them
+// are moved before the group.
+
+oq3.declare_variable @a : i1
+oq3.declare_variable @b : i1
+
+func.func @sub(%q : !quir.qubit<1>) {
+  quir.reset %q : !quir.qubit<1>
+  return
+}
+
+// CHECK-LABEL: func.func @main
+func.func @main() -> i32 {
+  // CHECK: %[[Q0:.*]] = quir.declare_qubit {id = 0 : i32}
+  // CHECK: %[[Q1:.*]] = quir.declare_qubit {id = 1 : i32}
+  // CHECK: %[[Q2:.*]] = quir.declare_qubit {id = 2 : i32}
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+  // CHECK: %[[C0:.*]] = quir.measure(%[[Q0]])
+  // CHECK: %[[C1:.*]] = quir.measure(%[[Q1]])
+  %c0 = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  %c1 = quir.measure(%q1) : (!quir.qubit<1>) -> i1
+
+  // CHECK: %[[TRUE:.*]] = arith.constant true
+  // CHECK-NEXT: qcs.parallel_control_flow {
+  // CHECK-NEXT: scf.if %[[C0]] {
+  // CHECK-NEXT: quir.reset %[[Q0]]
+  // CHECK-NEXT: oq3.variable_assign @a : i1 = %[[C0]]
+  // CHECK-NEXT: }
+  // CHECK-NEXT: scf.if %[[C1]] {
+  // CHECK-NEXT: quir.reset %[[Q1]]
+  // CHECK-NEXT: oq3.variable_assign @b : i1 = %[[TRUE]]
+  // CHECK-NEXT: }
+  // CHECK-NEXT: }
+  scf.if %c0 {
+    quir.reset %q0 : !quir.qubit<1>
+    oq3.variable_assign @a : i1 = %c0
+  }
+  %true = arith.constant true
+  scf.if %c1 {
+    quir.reset %q1 : !quir.qubit<1>
+    oq3.variable_assign @b : i1 = %true
+  }
+
+  // the first if shares its qubit with the group above, the second one
+  // writes the variable that the first one reads
+  // CHECK-NOT: qcs.parallel_control_flow
+  // CHECK: scf.if %[[C0]] {
+  // CHECK-NEXT: quir.reset %[[Q0]]
+  // CHECK-NEXT: oq3.variable_load @a
+  // CHECK-NOT: qcs.parallel_control_flow
+  // CHECK: scf.if %[[C1]] {
+  // CHECK-NEXT: quir.reset %[[Q1]]
+  // CHECK-NEXT: oq3.variable_assign @a
+  scf.if %c0 {
+    quir.reset %q0 : !quir.qubit<1>
+    %a = oq3.variable_load @a : i1
+    oq3.variable_assign @b : i1 = %a
+  }
+  scf.if %c1 {
+    quir.reset %q1 : !quir.qubit<1>
+    oq3.variable_assign @a : i1 = %c1
+  }
+
+  // the accesses of a subroutine call are unknown
+  // CHECK-NOT: qcs.parallel_control_flow
+  // CHECK: scf.if %[[C0]] {
+  // CHECK-NEXT: quir.call_subroutine @sub(%[[Q2]])
+  // CHECK-NOT: qcs.parallel_control_flow
+  // CHECK: scf.if %[[C1]] {
+  // CHECK-NEXT: quir.reset %[[Q1]]
+  // CHECK-NOT: qcs.parallel_control_flow
+  scf.if %c0 {
+    quir.call_subroutine @sub(%q2) : (!quir.qubit<1>) -> ()
+  }
+  scf.if %c1 {
+    quir.reset %q1 : !quir.qubit<1>
+  }
+
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
@@ -0,0 +1,91 @@
+// RUN: qss-compiler -X=mlir --quir-pipeline-shot-loop %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-pipeline-shot-loop --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The classical handling of the results at the end of a shot is wrapped in a
+// qcs.shot_post_process op if the next shot does not depend on it.
+
+// STATS: (S) {{ *}}1 pipelined-shot-loops
+
+oq3.declare_variable @count : i32
+oq3.declare_variable @flip : i1
+
+func.func private @record(i1) -> ()
+
+// CHECK-LABEL: func.func @pipelined
+func.func @pipelined(%results : memref<1000xi1>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c1000 = arith.constant 1000 : index
+  // CHECK: scf.for %[[SHOT:.*]] =
+  scf.for %arg0 = %c0 to %c1000 step %c1 {
+    // CHECK-NEXT: qcs.shot_init
+    // CHECK-NEXT: quir.declare_qubit
+    // CHECK-NEXT: %[[RES:.*]] = quir.measure
+    // CHECK-NEXT: qcs.shot_post_process {
+    // CHECK-NEXT: memref.store %[[RES]], %{{.*}}[%[[SHOT]]]
+    // CHECK-NEXT: oq3.variable_load @count
+    // CHECK-NEXT: arith.constant
+    // CHECK-NEXT: arith.addi
+    // CHECK-NEXT: oq3.variable_assign @count
+    // CHECK-NEXT: }
+    // CHECK-NEXT: } {qcs.shot_loop}
+    qcs.shot_init {qcs.num_shots = 1000 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %res = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+    memref.store %res, %results[%arg0] : memref<1000xi1>
+    %count = oq3.variable_load @count : i32
+    %one = arith.constant 1 : i32
+    %next = arith.addi %count, %one : i32
+    oq3.variable_assign @count : i32 = %next
+  } {qcs.shot_loop}
+  return
+}
+
+// CHECK-LABEL: func.func @head_reads_result
+func.func @head_reads_result() {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c1000 = arith.constant 1000 : index
+  // CHECK-NOT: qcs.shot_post_process
+  scf.for %arg0 = %c0 to %c1000 step %c1 {
+    qcs.shot_init {qcs.num_shots = 1000 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    // the next shot depends on the result of the previous one
+    %flip = oq3.variable_load @flip : i1
+    scf.if %flip {
+      %a = quir.constant #quir.angle<3.1415926535897931> : !quir.angle<64>
+      quir.builtin_U %q0, %a, %a, %a : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+    }
+    %res = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+    oq3.variable_assign @flip : i1 = %res
+  } {qcs.shot_loop}
+  return
+}
+
+// CHECK-LABEL: func.func @unknown_effects
+func.func @unknown_effects() {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c1000 = arith.constant 1000 : index
+  // CHECK-NOT: qcs.shot_post_process
+  scf.for %arg0 = %c0 to %c1000 step %c1 {
+    qcs.shot_init {qcs.num_shots = 1000 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %res = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+    func.call @record(%res) : (i1) -> ()
+  } {qcs.shot_loop}
+  return
+}
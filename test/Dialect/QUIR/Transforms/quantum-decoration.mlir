@@ -3,7 +3,7 @@
 //
 // This code is part of Qiskit.
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is licensed under the Apache License, Version 2.0 with LLVM
 // Exceptions. You may obtain a copy of this license in the LICENSE.txt
@@ -46,3 +46,38 @@ func.func @t1 (%cond : i1) -> () {
   }
   return
 }
+
+// The qubits of nested regions are added to the enclosing ones, qubits whose
+// id is not known are decorated as -1
+func.func @t2 (%cond : i1, %qarg : !quir.qubit<1>) -> () {
+  %q0 = quir.declare_qubit {id = 0: i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1: i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2: i32} : !quir.qubit<1>
+  %lb = arith.constant 0 : index
+  %ub = arith.constant 4 : index
+  %step = arith.constant 1 : index
+  scf.for %iv = %lb to %ub step %step {
+    quir.call_gate @x(%q2) : (!quir.qubit<1>) -> ()
+    scf.if %cond {
+      quir.call_gate @x(%q1) : (!quir.qubit<1>) -> ()
+      scf.if %cond {
+        quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+        // CHECK: {quir.physicalIds = [0 : i32]}
+      }
+      // CHECK: {quir.physicalIds = [0 : i32, 1 : i32]}
+    }
+    // CHECK: {quir.physicalIds = [0 : i32, 1 : i32, 2 : i32]}
+  }
+  scf.if %cond {
+    quir.call_gate @x(%qarg) : (!quir.qubit<1>) -> ()
+    quir.call_gate @x(%q1) : (!quir.qubit<1>) -> ()
+    // CHECK: {quir.physicalIds = [-1 : i32, 1 : i32]}
+  }
+  return
+}
+
+// CHECK: quir.circuit @circuit_0({{.*}}) attributes {quir.physicalIds = [3 : i32]}
+quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 3 : i32}) {
+  quir.call_gate @x(%arg0) : (!quir.qubit<1>) -> ()
+  quir.return
+}
@@ -0,0 +1,45 @@
+// RUN: qss-compiler -X=mlir --quirOpt %s | FileCheck %s --check-prefix=DEFAULT
+// RUN: qss-compiler -X=mlir --quirOpt-parallel %s | FileCheck %s --check-prefix=DEFAULT
+// RUN: qss-compiler -X=mlir --quirOpt=cancel-gates=true %s | FileCheck %s --check-prefix=CANCEL
+// RUN: qss-compiler -X=mlir --quirOpt-parallel=cancel-gates=true %s | FileCheck %s --check-prefix=CANCEL
+// RUN: qss-compiler -X=mlir --quirOpt=minimize-synchronization=true %s | FileCheck %s --check-prefix=SYNC
+// RUN: qss-compiler -X=mlir --quirOpt-parallel=minimize-synchronization=true %s | FileCheck %s --check-prefix=SYNC
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that the optimizations not run by the QUIR pipelines by
+// default are enabled through their options
+
+module {
+  // DEFAULT-LABEL: func.func @main
+  // CANCEL-LABEL: func.func @main
+  // SYNC-LABEL: func.func @main
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    // DEFAULT: quir.builtin_CX
+    // DEFAULT: quir.builtin_CX
+    // CANCEL-NOT: quir.builtin_CX
+    quir.builtin_CX %0, %1 : !quir.qubit<1>, !quir.qubit<1>
+    quir.builtin_CX %0, %1 : !quir.qubit<1>, !quir.qubit<1>
+    // DEFAULT: qcs.synchronize
+    // DEFAULT: qcs.synchronize
+    // SYNC: qcs.synchronize
+    // SYNC-NOT: qcs.synchronize
+    qcs.synchronize %0, %1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    qcs.synchronize %0 : (!quir.qubit<1>) -> ()
+    return %c0_i32 : i32
+  }
+}
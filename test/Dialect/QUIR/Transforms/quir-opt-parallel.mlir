@@ -0,0 +1,44 @@
+// RUN: qss-compiler -X=mlir --quirOpt-parallel %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that the nested QUIR passes run on circuits and functions
+
+module {
+  // CHECK: quir.circuit @circuit_0
+  // CHECK-SAME: quir.classicalOnly = false
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.qubit<1> {quir.physicalId = 1 : i32}) -> (i1, i1) attributes {quir.physicalIds = [0 : i32, 1 : i32]} {
+    // CHECK: %0:2 = quir.measure(%arg0, %arg1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    %1 = quir.measure(%arg1) : (!quir.qubit<1>) -> i1
+    quir.return %0, %1 : i1, i1
+  }
+  // CHECK: func.func @classical
+  // CHECK-SAME: quir.classicalOnly = true
+  func.func @classical(%arg0: i32) -> i32 {
+    return %arg0 : i32
+  }
+  // CHECK: func.func @main
+  // CHECK-SAME: quir.classicalOnly = false
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    // CHECK: quir.measure(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+    %2 = quir.measure(%0) : (!quir.qubit<1>) -> i1
+    %3 = quir.measure(%1) : (!quir.qubit<1>) -> i1
+    %4:2 = quir.call_circuit @circuit_0(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+    return %c0_i32 : i32
+  }
+}
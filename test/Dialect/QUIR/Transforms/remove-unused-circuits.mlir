@@ -22,6 +22,7 @@ module {
   // CHECK: quir.circuit @circuit_1(%arg0: !quir.qubit<1>) -> i1 {
   quir.circuit @circuit_1(%arg0: !quir.qubit<1> ) -> i1 {
     %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    %1 = quir.call_circuit @circuit_6(%arg0) : (!quir.qubit<1>) -> (i1)
     quir.return %0 : i1
   }
   // CHECK-NOT: quir.circuit @circuit_2(%arg0: !quir.qubit<1> ) -> i1 {
@@ -34,6 +35,23 @@ module {
     %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
     quir.return %0 : i1
   }
+  // circuit_5 is only called by the unused circuit_4
+  // CHECK-NOT: quir.circuit @circuit_4
+  quir.circuit @circuit_4(%arg0: !quir.qubit<1> ) -> i1 {
+    %0 = quir.call_circuit @circuit_5(%arg0) : (!quir.qubit<1>) -> (i1)
+    quir.return %0 : i1
+  }
+  // CHECK-NOT: quir.circuit @circuit_5
+  quir.circuit @circuit_5(%arg0: !quir.qubit<1> ) -> i1 {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // circuit_6 is called by the used circuit_1
+  // CHECK: quir.circuit @circuit_6
+  quir.circuit @circuit_6(%arg0: !quir.qubit<1> ) -> i1 {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
   func.func @main() -> i32  {
     %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
     %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
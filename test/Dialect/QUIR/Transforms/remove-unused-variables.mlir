@@ -3,7 +3,7 @@
 //
 // This code is part of Qiskit.
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is licensed under the Apache License, Version 2.0 with LLVM
 // Exceptions. You may obtain a copy of this license in the LICENSE.txt
@@ -17,10 +17,14 @@
 // UNUSED: oq3.declare_variable {output} @isOutput : !quir.cbit<1>
 // UNUSED-NOT: oq3.declare_variable @storeOnly : !quir.cbit<1>
 // UNUSED-NOT: oq3.declare_variable @notUsed : !quir.cbit<1>
+// UNUSED-NOT: oq3.declare_variable @chainSource : !quir.cbit<1>
+// UNUSED-NOT: oq3.declare_variable @chainSink : !quir.cbit<1>
 oq3.declare_variable @isUsed : !quir.cbit<1>
 oq3.declare_variable {output} @isOutput : !quir.cbit<1>
 oq3.declare_variable @storeOnly : !quir.cbit<1>
 oq3.declare_variable @notUsed : !quir.cbit<1>
+oq3.declare_variable @chainSource : !quir.cbit<1>
+oq3.declare_variable @chainSink : !quir.cbit<1>
 // UNUSED: func.func @variableTests
 func.func @variableTests(%ref : memref<1xi1>, %ind : index) {
     %false = arith.constant false
@@ -43,5 +47,15 @@ func.func @variableTests(%ref : memref<1xi1>, %ind : index) {
     // UNUSED-NOT: oq3.variable_load @notUsed : !quir.cbit<1>
     %notUsed = oq3.variable_load @notUsed : !quir.cbit<1>
 
+    // chainSource is only loaded to be assigned to chainSink, which has no
+    // uses, such that both are removed
+    // UNUSED-NOT: oq3.variable_assign @chainSource
+    // UNUSED-NOT: oq3.variable_load @chainSource
+    // UNUSED-NOT: oq3.variable_assign @chainSink
+    oq3.variable_assign @chainSource : !quir.cbit<1> = %false_cbit
+    %source = oq3.variable_load @chainSource : !quir.cbit<1>
+    %notSource = oq3.cbit_not %source : !quir.cbit<1>
+    oq3.variable_assign @chainSink : !quir.cbit<1> = %notSource
+
     return
 }
@@ -0,0 +1,53 @@
+// RUN: qss-compiler -X=mlir --enable-circuits=true --reorder-circuits='schedule=true' %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+module {
+  memref.global @a : memref<i1> = dense<false>
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1>) -> i1 {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0: i1
+  }
+  // CHECK-LABEL: func.func @main
+  func.func @main() -> i32 {
+    %false = arith.constant false
+    %0 = memref.get_global @a : memref<i1>
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+    // The independent circuits are grouped, the store of the result of the
+    // first one and the barrier on another qubit follow the group
+    // CHECK: [[M0:%.*]] = quir.call_circuit @circuit_0(%1) : (!quir.qubit<1>) -> i1
+    // CHECK-NEXT: {{.*}} = quir.call_circuit @circuit_0(%3) : (!quir.qubit<1>) -> i1
+    // CHECK-NEXT: {{.*}} = quir.call_circuit @circuit_0(%1) : (!quir.qubit<1>) -> i1
+    // CHECK-NEXT: affine.store [[M0]], %0[] : memref<i1>
+    // CHECK-NEXT: quir.barrier %2 : (!quir.qubit<1>) -> ()
+    %1 = quir.call_circuit @circuit_0(%q0) : (!quir.qubit<1>) -> i1
+    quir.barrier %q1 : (!quir.qubit<1>) -> ()
+    %2 = quir.call_circuit @circuit_0(%q2) : (!quir.qubit<1>) -> i1
+    affine.store %1, %0[] : memref<i1>
+    %3 = quir.call_circuit @circuit_0(%q0) : (!quir.qubit<1>) -> i1
+    // CHECK: scf.if
+    scf.if %3 {
+      // CHECK-NEXT: affine.store %false, %0[] : memref<i1>
+      // CHECK-NEXT: quir.call_circuit @circuit_0(%1)
+      // CHECK-NEXT: quir.call_circuit @circuit_0(%3)
+      %4 = quir.call_circuit @circuit_0(%q0) : (!quir.qubit<1>) -> i1
+      affine.store %false, %0[] : memref<i1>
+      %5 = quir.call_circuit @circuit_0(%q2) : (!quir.qubit<1>) -> i1
+    }
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,62 @@
+// RUN: qss-compiler -X=mlir --quir-shot-loop-licm %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The classical setup of a shot is hoisted out of the shot loop, while the
+// ops acting once per shot and those depending on shot results stay.
+
+qcs.declare_parameter @theta : !quir.angle<64> = #quir.angle<0.5> : !quir.angle<64>
+oq3.declare_variable @init : i32
+oq3.declare_variable @counter : i32
+
+func.func @main() {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c1000 = arith.constant 1000 : index
+  // CHECK: quir.declare_qubit
+  // CHECK: qcs.parameter_load @theta
+  // CHECK: quir.constant
+  // CHECK: oq3.angle_add
+  // CHECK: arith.constant 7 : i32
+  // CHECK: oq3.variable_assign @init
+  // CHECK: oq3.variable_load @init
+  // CHECK: scf.for
+  scf.for %arg0 = %c0 to %c1000 step %c1 {
+    // CHECK-NEXT: qcs.shot_init
+    qcs.shot_init {qcs.num_shots = 1000 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %theta = qcs.parameter_load @theta : !quir.angle<64>
+    %a = quir.constant #quir.angle<0.1> : !quir.angle<64>
+    %sum = oq3.angle_add %theta, %a : !quir.angle<64>
+    %c7 = arith.constant 7 : i32
+    oq3.variable_assign @init : i32 = %c7
+    %init = oq3.variable_load @init : i32
+    // CHECK-NEXT: oq3.variable_load @counter
+    // CHECK-NEXT: arith.addi
+    // CHECK-NEXT: oq3.variable_assign @counter
+    %counter = oq3.variable_load @counter : i32
+    %next = arith.addi %counter, %init : i32
+    oq3.variable_assign @counter : i32 = %next
+    // CHECK-NEXT: quir.builtin_U
+    // CHECK-NEXT: quir.measure
+    // CHECK-NEXT: scf.if
+    quir.builtin_U %q0, %sum, %a, %a : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+    %res = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+    scf.if %res {
+      %b = quir.constant #quir.angle<0.2> : !quir.angle<64>
+      quir.builtin_U %q0, %b, %a, %a : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+    }
+  } {qcs.shot_loop}
+  return
+}
@@ -0,0 +1,50 @@
+// RUN: qss-compiler -X=mlir --pass-pipeline='builtin.module(ir-statistics{label=input},subroutine-cloning,ir-statistics{label=cloned})' --timing-trace=%t %s -o /dev/null
+// RUN: %perf-check %s --input-file %t
+// RUN: qss-compiler -X=mlir --pass-pipeline='builtin.module(subroutine-cloning,ir-statistics)' --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | %perf-check %s --check-prefix=STATS
+// RUN: not %perf-check %s --input-file %t --check-prefix=FAIL 2>&1 | FileCheck %s --check-prefix=ERROR
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test bounds the growth of the IR through subroutine cloning, which
+// clones each subroutine once per distinct set of qubit arguments
+
+func.func @sub1(%q0 : !quir.qubit<1>) {
+  quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @sub2(%q0 : !quir.qubit<1>) {
+  quir.call_subroutine @sub1(%q0) : (!quir.qubit<1>) -> ()
+  quir.call_subroutine @sub1(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @main() -> i32 {
+  %c0_i32 = arith.constant 0 : i32
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  quir.call_subroutine @sub2(%q0) : (!quir.qubit<1>) -> ()
+  quir.call_subroutine @sub2(%q0) : (!quir.qubit<1>) -> ()
+  quir.call_subroutine @sub2(%q1) : (!quir.qubit<1>) -> ()
+  return %c0_i32 : i32
+}
+
+// PERF: counter(cloned ops:func.func) <= 5
+// PERF: counter(cloned:ops) / counter(input:ops) <= 2
+// PERF: counter(cloned:symbols) >= 5
+
+// STATS: stat(IR Statistics Pass:num-symbols) <= 6
+
+// FAIL: counter(cloned ops:func.func) < 3
+// ERROR: subroutine-cloning-bounds.mlir:[[#@LINE-1]]: error: 'counter(cloned ops:func.func) < 3' does not hold, the value is 5
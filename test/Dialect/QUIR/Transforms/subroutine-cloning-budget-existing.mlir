@@ -0,0 +1,44 @@
+// RUN: qss-compiler -X=mlir --subroutine-cloning=max-clones-per-callee=1 %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that calls resolved to an existing specialization do not
+// count against the clone budget, such that the budget remains for a clone.
+
+func.func @sub_q0(%q0 : !quir.qubit<1> {quir.physicalId = 0 : i32}) {
+  quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @sub(%q0 : !quir.qubit<1>) {
+  quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @main() -> i32 {
+  %c0_i32 = arith.constant 0 : i32
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  quir.call_subroutine @sub(%q0) : (!quir.qubit<1>) -> ()
+  quir.call_subroutine @sub(%q1) : (!quir.qubit<1>) -> ()
+  return %c0_i32 : i32
+}
+
+// CHECK-NOT: quir.dynamicQubits
+// CHECK: func.func @sub_q0(
+// CHECK: func.func @sub_q1(%arg0: !quir.qubit<1> {quir.physicalId = 1 : i32}) {
+// CHECK-NOT: func.func @sub(
+// CHECK: func.func @main() -> i32 {
+// CHECK: quir.call_subroutine @sub_q0(%0)
+// CHECK: quir.call_subroutine @sub_q1(%1)
@@ -0,0 +1,48 @@
+// RUN: qss-compiler -X=mlir --subroutine-cloning=max-clones-per-callee=1 %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that calls exceeding the clone budget keep calling the
+// generic subroutine, along with the subroutines it calls
+
+func.func @sub1(%q0 : !quir.qubit<1>) {
+  quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @sub2(%q0 : !quir.qubit<1>) {
+  quir.call_subroutine @sub1(%q0) : (!quir.qubit<1>) -> ()
+  return
+}
+
+func.func @main() -> i32 {
+  %c0_i32 = arith.constant 0 : i32
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  quir.call_subroutine @sub2(%q0) : (!quir.qubit<1>) -> ()
+  quir.call_subroutine @sub2(%q1) : (!quir.qubit<1>) -> ()
+  quir.call_subroutine @sub2(%q0) : (!quir.qubit<1>) -> ()
+  return %c0_i32 : i32
+}
+
+// CHECK: func.func @sub1_q0(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}) {
+// CHECK: func.func @sub1(%arg0: !quir.qubit<1>) attributes {quir.dynamicQubits} {
+// CHECK: func.func @sub2_q0(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}) {
+// CHECK-NEXT: quir.call_subroutine @sub1_q0(%arg0)
+// CHECK: func.func @sub2(%arg0: !quir.qubit<1>) attributes {quir.dynamicQubits} {
+// CHECK-NEXT: quir.call_subroutine @sub1(%arg0)
+// CHECK: func.func @main() -> i32 {
+// CHECK: quir.call_subroutine @sub2_q0(%0)
+// CHECK: quir.call_subroutine @sub2(%1)
+// CHECK: quir.call_subroutine @sub2_q0(%0)
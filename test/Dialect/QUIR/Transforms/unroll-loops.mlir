@@ -0,0 +1,37 @@
+// RUN: qss-compiler -X=mlir --quir-unroll-loops %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-unroll-loops='max-unrolled-ops=2' %s | FileCheck %s --check-prefix=BUDGET
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+func.func @main() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %lb = arith.constant 0 : index
+  %ub = arith.constant 3 : index
+  %big = arith.constant 100000 : index
+  %step = arith.constant 1 : index
+  // CHECK-NOT: scf.for %{{.*}} = %{{.*}} to %c3
+  // CHECK: quir.call_gate @x
+  // CHECK-NEXT: quir.call_gate @x
+  // CHECK-NEXT: quir.call_gate @x
+  // BUDGET: scf.for %{{.*}} = %{{.*}} to %c3
+  scf.for %iv = %lb to %ub step %step {
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+  }
+  // CHECK: scf.for %{{.*}} = %{{.*}} to %c100000
+  // BUDGET: scf.for %{{.*}} = %{{.*}} to %c100000
+  scf.for %iv = %lb to %big step %step {
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+  }
+  return
+}
@@ -0,0 +1,49 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-variables %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-eliminate-variables --mlir-pass-statistics --mlir-pass-statistics-display=list %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+//
+// This test verifies that the variables only used in one function are lowered
+// to allocas and that those which are never read are dropped right away.
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: module
+// CHECK-NOT: @unread
+// CHECK-NOT: @read
+// CHECK: memref.global "private" @shared
+// CHECK-NOT: @unread
+// CHECK-NOT: @read
+module {
+  oq3.declare_variable @unread : i32
+  oq3.declare_variable @read : i32
+  oq3.declare_variable @shared : i32
+  func.func @other() {
+    %c2_i32 = arith.constant 2 : i32
+    oq3.variable_assign @shared : i32 = %c2_i32
+    return
+  }
+  // CHECK: func.func @main
+  func.func @main() -> i32 {
+    %c1_i32 = arith.constant 1 : i32
+    %c3_i32 = arith.constant 3 : i32
+    oq3.variable_assign @unread : i32 = %c1_i32
+    oq3.variable_assign @read : i32 = %c3_i32
+    oq3.variable_assign @shared : i32 = %c1_i32
+    %0 = oq3.variable_load @read : i32
+    // CHECK: return %c3_i32
+    return %0 : i32
+  }
+}
+
+// STATS-DAG: (S) {{ *}}2 globals-to-allocas
+// STATS-DAG: (S) {{ *}}1 dropped-variables
@@ -0,0 +1,78 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-variables %s --canonicalize | FileCheck %s --implicit-check-not '!quir.cbit' --implicit-check-not variable --implicit-check-not alloc --implicit-check-not store
+//
+// This test verifies that consecutive assignments of bits of a register, which
+// share one load and one store of the register, keep the assigned values and
+// their order.
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: module
+module {
+  oq3.declare_variable @b : !quir.cbit<3>
+  func.func @x(%arg0: !quir.qubit<1>) {
+    return
+  }
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %c0_i3 = arith.constant 0 : i3
+    qcs.init
+    qcs.shot_init {qcs.num_shots = 1 : i32}
+
+    // CHECK: [[QUBIT0:%.*]] = quir.declare_qubit {id = 0
+    // CHECK: [[QUBIT1:%.*]] = quir.declare_qubit {id = 1
+    // CHECK: [[QUBIT2:%.*]] = quir.declare_qubit {id = 2
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+
+    %3 = "oq3.cast"(%c0_i3) : (i3) -> !quir.cbit<3>
+    oq3.variable_assign @b : !quir.cbit<3> = %3
+
+    // CHECK: [[MEASURE0:%.*]] = quir.measure([[QUBIT0]])
+    // CHECK: [[MEASURE1:%.*]] = quir.measure([[QUBIT1]])
+    // CHECK: [[MEASURE2:%.*]] = quir.measure([[QUBIT2]])
+    %4 = quir.measure(%0) : (!quir.qubit<1>) -> i1
+    oq3.cbit_assign_bit @b<3> [0] : i1 = %4
+    %5 = quir.measure(%1) : (!quir.qubit<1>) -> i1
+    oq3.cbit_assign_bit @b<3> [1] : i1 = %5
+    %6 = quir.measure(%2) : (!quir.qubit<1>) -> i1
+    // the later assignment of a bit wins
+    oq3.cbit_assign_bit @b<3> [2] : i1 = %4
+    oq3.cbit_assign_bit @b<3> [2] : i1 = %6
+
+    %7 = oq3.variable_load @b : !quir.cbit<3>
+    %8 = oq3.cbit_extractbit(%7 : !quir.cbit<3>) [2] : i1
+
+    // the load above ends the fused assignments
+    oq3.cbit_assign_bit @b<3> [0] : i1 = %8
+
+    %9 = oq3.variable_load @b : !quir.cbit<3>
+    %10 = oq3.cbit_extractbit(%9 : !quir.cbit<3>) [0] : i1
+
+    // CHECK: scf.if [[MEASURE2]]
+    scf.if %10 {
+      quir.call_gate @x(%0) : (!quir.qubit<1>) -> ()
+    }
+
+    %11 = oq3.variable_load @b : !quir.cbit<3>
+    %12 = oq3.cbit_extractbit(%11 : !quir.cbit<3>) [1] : i1
+
+    // CHECK: scf.if [[MEASURE1]]
+    scf.if %12 {
+      quir.call_gate @x(%1) : (!quir.qubit<1>) -> ()
+    }
+    qcs.finalize
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,52 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-variables %s --canonicalize | FileCheck %s --implicit-check-not variable --implicit-check-not alloc --implicit-check-not store --implicit-check-not load
+//
+// This test verifies that variables which are accessed across scf.for and
+// scf.if are promoted to values carried by the control flow ops.
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: module
+module {
+  oq3.declare_variable @count : i32
+  func.func @main(%cond: i1) -> i32 {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+    %c1_i32 = arith.constant 1 : i32
+    %c3_i32 = arith.constant 3 : i32
+    %c5_i32 = arith.constant 5 : i32
+
+    // CHECK-DAG: [[C3:%.*]] = arith.constant 3 : i32
+    // CHECK-DAG: [[C5:%.*]] = arith.constant 5 : i32
+    oq3.variable_assign @count : i32 = %c3_i32
+
+    // CHECK: [[LOOP:%.*]] = scf.for {{.*}} iter_args([[ACC:%.*]] = [[C3]]) -> (i32)
+    // CHECK: [[NEXT:%.*]] = arith.addi [[ACC]]
+    // CHECK: scf.yield [[NEXT]] : i32
+    scf.for %i = %c0 to %c4 step %c1 {
+      %v = oq3.variable_load @count : i32
+      %n = arith.addi %v, %c1_i32 : i32
+      oq3.variable_assign @count : i32 = %n
+    }
+
+    // CHECK: [[IF:%.*]] = arith.select %arg0, [[C5]], [[LOOP]] : i32
+    scf.if %cond {
+      oq3.variable_assign @count : i32 = %c5_i32
+    }
+
+    // CHECK: return [[IF]] : i32
+    %r = oq3.variable_load @count : i32
+    return %r : i32
+  }
+}
@@ -0,0 +1,30 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -X=qasm --emit=mlir %s --qasm3-ast-statistics=%t.json -o %t.mlir && FileCheck %s --input-file=%t.json
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: "nodes": [
+// CHECK-DAG: "kind": "ASTTypeQubitContainer"
+// CHECK-DAG: "kind": "ASTTypeForStatement"
+// CHECK-DAG: "kind": "ASTTypeMeasure"
+// CHECK-DAG: "operations":
+// CHECK-DAG: "time_ns":
+// CHECK: "unattributed_operations":
+qubit $0;
+bit b;
+
+for i in [0 : 4] {
+  U(1.57079632679, 0.0, 3.14159265359) $0;
+}
+b = measure $0;
@@ -0,0 +1,32 @@
+OPENQASM 3.0;
+// Populate the frontend cache, compiling from stdin such that the program
+// with other input values shares the buffer identifier
+// RUN: rm -rf %t.cache %t.miss.json %t.hit.json
+// RUN: cat %s | qss-compiler -X=qasm --emit=mlir --enable-parameters --compile-cache-dir=%t.cache --compile-cache-frontend --qasm3-ast-statistics=%t.miss.json - | FileCheck %s
+// RUN: test -e %t.miss.json
+
+// Changing an input value only misses the cache of compiler outputs, the
+// program is not parsed again
+// RUN: sed -e 's/theta = 0.5/theta = 0.25/' %s | qss-compiler -X=qasm --emit=mlir --enable-parameters --compile-cache-dir=%t.cache --compile-cache-frontend --qasm3-ast-statistics=%t.hit.json - | FileCheck %s --check-prefix HIT
+// RUN: test ! -e %t.hit.json
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: qcs.declare_parameter @{{.*}} : !quir.angle<64> = #quir.angle<5.000000e-01> : !quir.angle<64>
+// HIT: qcs.declare_parameter @{{.*}} : !quir.angle<64> = #quir.angle<2.500000e-01> : !quir.angle<64>
+input angle theta = 0.5;
+
+qubit $0;
+gate rz(phi) q { }
+rz(theta) $0;
@@ -0,0 +1,51 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -X=qasm --emit=mlir %s --enable-circuits-from-qasm=false | FileCheck %s
+// RUN: qss-compiler -X=qasm --emit=mlir %s --enable-circuits-from-qasm=false --mlir-disable-threading | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Top-level gate declarations are generated in source order on the thread
+// walking the AST, whether or not the context is multithreaded, as the AST
+// and its symbol tables may not be visited concurrently.
+// CHECK: func.func @g0(
+// CHECK: quir.builtin_U
+// CHECK: func.func @g1(
+// CHECK: quir.call_gate @g0
+// CHECK: func.func @g2(
+// CHECK: quir.call_gate @g1
+// CHECK: quir.call_gate @g0
+// CHECK: func.func @g3(
+// CHECK: quir.call_gate @g2
+// CHECK: func.func @main() -> i32 {
+// CHECK: quir.call_gate @g3
+gate g0 (theta) q {
+    U(0.0, 0.0, theta) q;
+}
+
+gate g1 (theta) q {
+    g0(theta) q;
+}
+
+gate g2 (theta) qa, qb {
+    g1(theta) qa;
+    g0(theta) qb;
+}
+
+gate g3 (theta) qa, qb {
+    g2(theta) qb, qa;
+}
+
+qubit $0;
+qubit $1;
+g3(0.5) $0, $1;
@@ -0,0 +1,39 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -X=qasm --emit=mlir %s --enable-circuits-from-qasm=false --lazy-gate-declarations | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Only gates referenced by the program, directly or through other gates, are
+// generated, in the order in which they are first referenced.
+// CHECK-NOT: func.func @unused
+// CHECK: func.func @outer
+// CHECK: quir.call_gate @inner
+// CHECK: func.func @inner
+// CHECK-NOT: func.func @unused
+// CHECK: func.func @main() -> i32 {
+// CHECK: quir.call_gate @outer
+gate inner q {
+    U(0.0, 0.0, 0.1) q;
+}
+
+gate unused q {
+    inner q;
+}
+
+gate outer q {
+    inner q;
+}
+
+qubit $0;
+outer $0;
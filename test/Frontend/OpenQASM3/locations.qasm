@@ -0,0 +1,32 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -X=qasm --emit=mlir --mlir-print-debuginfo %s | FileCheck %s --check-prefix FULL
+// RUN: qss-compiler -X=qasm --emit=mlir --mlir-print-debuginfo --qasm3-locations=line %s | FileCheck %s --check-prefix LINE
+// RUN: qss-compiler -X=qasm --emit=mlir --mlir-print-debuginfo --qasm3-locations=none %s | FileCheck %s --check-prefix NONE
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// the operations generated for a statement carry its line and column, its
+// line only, or no location at all
+
+// FULL: loc("{{.*}}locations.qasm":{{[0-9]+}}:{{[1-9][0-9]*}})
+// LINE-NOT: locations.qasm":{{[0-9]+}}:{{[1-9]}}
+// LINE: loc("{{.*}}locations.qasm":{{[1-9][0-9]*}}:0)
+// LINE-NOT: locations.qasm":{{[0-9]+}}:{{[1-9]}}
+// NONE-NOT: locations.qasm":{{[1-9]}}
+// NONE: loc(unknown)
+// NONE-NOT: locations.qasm":{{[1-9]}}
+qubit $0;
+bit c0;
+h $0;
+c0 = measure $0;
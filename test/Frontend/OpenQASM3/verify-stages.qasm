@@ -0,0 +1,29 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -X=qasm --emit=mlir --verify-stages --canonicalize %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Verifying only the compilation stages leaves valid programs unchanged.
+
+qubit $0;
+bit c;
+h $0;
+c = measure $0;
+if (c) {
+  x $0;
+}
+
+// CHECK: func.func @main
+// CHECK: quir.measure
+// CHECK: scf.if
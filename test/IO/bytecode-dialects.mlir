@@ -0,0 +1,20 @@
+// The QUIR and Pulse attributes and types are written natively rather than
+// in their textual form
+// RUN: qss-compiler %s --emit=bytecode -o %t.bc
+// RUN: not grep -a -e "angle<" -e "duration<" -e "mixed_frame" %t.bc
+// RUN: qss-compiler %t.bc -X=bytecode --emit=mlir | FileCheck %s
+
+// CHECK: func.func @main(%{{.*}}: !quir.qubit<1>, %{{.*}}: !quir.cbit<4>, %{{.*}}: !quir.angle, %{{.*}}: !quir.stretch)
+// CHECK-SAME: #quir.inputParameter<{{.*}}theta
+func.func @main(%q: !quir.qubit<1>, %c: !quir.cbit<4>, %a: !quir.angle, %s: !quir.stretch) attributes {quir.parameter = #quir.inputParameter<"theta">} {
+  // CHECK: quir.constant #quir.angle<1.000000e-01> : !quir.angle<20>
+  %theta = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  // CHECK: quir.constant #quir.duration<1.000000e+01> : !quir.duration<ns>
+  %duration = quir.constant #quir.duration<10.0> : !quir.duration<ns>
+  return
+}
+
+// CHECK: func.func @pulse(%{{.*}}: !pulse.capture, %{{.*}}: !pulse.frame, %{{.*}}: !pulse.kernel, %{{.*}}: !pulse.port, %{{.*}}: !pulse.waveform, %{{.*}}: !pulse.mixed_frame)
+func.func @pulse(%capture: !pulse.capture, %frame: !pulse.frame, %kernel: !pulse.kernel, %port: !pulse.port, %waveform: !pulse.waveform, %mixed_frame: !pulse.mixed_frame) {
+  return
+}
@@ -0,0 +1,34 @@
+// Bytecode inputs are read lazily, the private functions which are never
+// referenced are not materialized
+// RUN: qss-compiler %s --emit=bytecode -o %t.bc
+// RUN: qss-compiler %t.bc -X=bytecode --emit=mlir | FileCheck %s
+
+// CHECK: module {
+// CHECK: func.func @main()
+func.func @main() {
+  // CHECK: call @used()
+  call @used() : () -> ()
+  return
+}
+
+// CHECK: func.func private @used()
+func.func private @used() {
+  // CHECK: call @used_indirectly()
+  call @used_indirectly() : () -> ()
+  return
+}
+
+// CHECK: func.func private @used_indirectly()
+func.func private @used_indirectly() {
+  return
+}
+
+// CHECK: func.func @public_unused()
+func.func @public_unused() {
+  return
+}
+
+// CHECK-NOT: @unused
+func.func private @unused() {
+  return
+}
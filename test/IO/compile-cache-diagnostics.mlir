@@ -0,0 +1,46 @@
+// RUN: rm -rf %t.cache
+// RUN: qss-compiler -X=mlir --merge-circuits --memory-budget=1 %s --compile-cache-dir=%t.cache 2>&1 | FileCheck %s
+
+// Edit the cached diagnostics to check that they are replayed on a hit
+// RUN: for entry in %t.cache/*.bin; do sed -i 's/memory budget of/cached budget of/' $entry; done
+// RUN: qss-compiler -X=mlir --merge-circuits --memory-budget=1 %s --compile-cache-dir=%t.cache 2>&1 | FileCheck %s --check-prefix HIT
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that the diagnostics of a cached compilation are stored
+// with its output and replayed when it is served from the compile cache.
+
+module {
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1>) -> i1 {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0: i1
+  }
+  quir.circuit @circuit_1(%arg0: !quir.qubit<1>) -> i1 {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0: i1
+  }
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %2 = quir.call_circuit @circuit_0(%0) : (!quir.qubit<1>) -> i1
+    %3 = quir.call_circuit @circuit_1(%1) : (!quir.qubit<1>) -> i1
+    return %c0_i32 : i32
+  }
+}
+
+// CHECK: warning: memory budget of 1 MiB exceeded
+// HIT: warning: cached budget of 1 MiB exceeded
+// CHECK: quir.call_circuit @circuit_0
+// HIT: quir.call_circuit @circuit_0
@@ -0,0 +1,35 @@
+OPENQASM 3.0;
+// RUN: rm -rf %t.cache %t.inc && mkdir %t.inc
+// RUN: echo 'gate g q { U(0, 0, 1.5) q; }' > %t.inc/compile-cache.inc
+// RUN: qss-compiler -I=%t.inc %s --emit=mlir --compile-cache-dir=%t.cache | FileCheck %s --check-prefix FIRST
+
+// Editing an included file misses the cache
+// RUN: echo 'gate g q { U(0, 0, 2.5) q; }' > %t.inc/compile-cache.inc
+// RUN: qss-compiler -I=%t.inc %s --emit=mlir --compile-cache-dir=%t.cache | FileCheck %s --check-prefix EDITED
+
+// So does adding a file to an include directory, which may shadow others
+// RUN: echo '// unused' > %t.inc/other.inc
+// RUN: qss-compiler -I=%t.inc %s --emit=mlir --compile-cache-dir=%t.cache | FileCheck %s --check-prefix EDITED
+// RUN: ls %t.cache | count 2
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test checks that the compile cache is keyed on the contents of the
+// included files and of the include directories.
+
+// FIRST: #quir.angle<1.500000e+00>
+// EDITED: #quir.angle<2.500000e+00>
+include "compile-cache.inc";
+qubit $0;
+g $0;
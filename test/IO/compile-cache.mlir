@@ -0,0 +1,24 @@
+// Populate the on-disk compile cache
+// RUN: rm -rf %t.cache
+// RUN: qss-compiler %s --emit=mlir --compile-cache-dir=%t.cache | FileCheck %s
+// RUN: ls %t.cache | FileCheck %s --check-prefix ENTRY
+
+// Edit the cached output to check that a repeated compilation is served
+// from the cache.
+// RUN: for entry in %t.cache/*.bin; do sed -i 's/@dummy/@cache/' $entry; done
+// RUN: qss-compiler %s --emit=mlir --compile-cache-dir=%t.cache | FileCheck %s --check-prefix HIT
+// RUN: QSSC_COMPILE_CACHE_DIR=%t.cache qss-compiler %s --emit=mlir | FileCheck %s --check-prefix HIT
+
+// A different configuration misses the cache
+// RUN: qss-compiler %s --emit=bytecode --compile-cache-dir=%t.cache | qss-compiler -X=bytecode --emit=mlir - | FileCheck %s
+// RUN: qss-compiler %s --emit=mlir --canonicalize --compile-cache-dir=%t.cache | FileCheck %s
+
+// ENTRY: {{[0-9a-f]+}}.bin
+// HIT: func.func @cache() {
+
+// CHECK: module {
+func.func @dummy() {
+// CHECK: func.func @dummy() {
+    return
+    // CHECK: return
+}
@@ -0,0 +1,47 @@
+// Run a pass pipeline over the inputs of a directory
+// RUN: rm -rf %t && mkdir -p %t/inputs
+// RUN: cp %s %t/inputs/first.mlir
+// RUN: cp %s %t/inputs/second.mlir
+// RUN: qss-opt --batch-inputs=%t/inputs --canonicalize --batch-statistics=%t/statistics.csv --batch-timing -o %t/outputs 2>&1 | FileCheck %s --check-prefix TIMING
+// RUN: FileCheck %s --input-file %t/outputs/first.mlir
+// RUN: FileCheck %s --input-file %t/outputs/second.mlir
+// RUN: FileCheck %s --check-prefix STATS --input-file %t/statistics.csv
+
+// A failing input does not stop the batch, and outputs which are not listed
+// are not written without an output directory
+// RUN: echo "%t/missing.mlir" > %t/failing
+// RUN: echo "%t/inputs/first.mlir %t/after-failure.mlir" >> %t/failing
+// RUN: echo "%t/inputs/second.mlir" >> %t/failing
+// RUN: not qss-opt --batch-inputs=%t/failing --canonicalize --batch-threads=2 2>&1 | FileCheck %s --check-prefix FAIL
+// RUN: FileCheck %s --input-file %t/after-failure.mlir
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// TIMING: Batch pass timings over 2 inputs
+// TIMING: Canonicalizer
+
+// STATS: input,status,seconds,operations
+// STATS-NEXT: {{.*}}first.mlir,ok,{{[0-9.]+}},3
+// STATS-NEXT: {{.*}}second.mlir,ok,{{[0-9.]+}},3
+
+// FAIL: missing.mlir: {{.*}}
+// FAIL: Error: 1 of 3 inputs failed
+
+// CHECK: func.func @dummy() {
+// CHECK-NEXT: return
+// CHECK-NOT: arith.constant
+func.func @dummy() {
+    %c0 = arith.constant 0 : i32
+    return
+}
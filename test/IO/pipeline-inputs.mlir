@@ -0,0 +1,31 @@
+// Compile the inputs of a directory as a pipeline
+// RUN: rm -rf %t && mkdir -p %t/inputs
+// RUN: cp %s %t/inputs/first.mlir
+// RUN: cp %s %t/inputs/second.mlir
+// RUN: qss-compiler --pipeline-inputs=%t/inputs --emit=mlir -o %t/outputs
+// RUN: FileCheck %s --input-file %t/outputs/first.mlir
+// RUN: FileCheck %s --input-file %t/outputs/second.mlir
+
+// A manifest lists the inputs and optionally their outputs
+// RUN: echo "# inputs and outputs" > %t/manifest
+// RUN: echo "%t/inputs/first.mlir %t/listed.mlir" >> %t/manifest
+// RUN: echo "%t/inputs/second.mlir" >> %t/manifest
+// RUN: qss-compiler --pipeline-inputs=%t/manifest --emit=mlir -o %t/unlisted
+// RUN: FileCheck %s --input-file %t/listed.mlir
+// RUN: FileCheck %s --input-file %t/unlisted/second.mlir
+
+// A failing input does not stop the pipeline
+// RUN: echo "%t/missing.mlir %t/missing-output.mlir" > %t/failing
+// RUN: echo "%t/inputs/first.mlir %t/after-failure.mlir" >> %t/failing
+// RUN: not qss-compiler --pipeline-inputs=%t/failing --emit=mlir 2>&1 | FileCheck %s --check-prefix FAIL
+// RUN: FileCheck %s --input-file %t/after-failure.mlir
+
+// FAIL: Error: {{.*}}missing.mlir: Failed to open input file
+// FAIL: Error: 1 of 2 inputs failed to compile
+
+// CHECK: module {
+func.func @dummy() {
+// CHECK: func.func @dummy() {
+    return
+    // CHECK: return
+}
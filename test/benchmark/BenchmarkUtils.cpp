@@ -0,0 +1,50 @@
+//===- BenchmarkUtils.cpp - Shared microbenchmark setup ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements the setup shared by the microbenchmarks.
+///
+//===----------------------------------------------------------------------===//
+
+#include "BenchmarkUtils.h"
+
+#include "Dialect/RegisterDialects.h"
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Parser/Parser.h"
+
+#include "llvm/Support/ErrorHandling.h"
+
+#include <memory>
+
+mlir::MLIRContext &qssc::bench::getContext() {
+  static std::unique_ptr<mlir::MLIRContext> const context = [] {
+    mlir::DialectRegistry registry;
+    qssc::dialect::registerDialects(registry);
+    auto context = std::make_unique<mlir::MLIRContext>(
+        registry, mlir::MLIRContext::Threading::DISABLED);
+    context->loadAllAvailableDialects();
+    return context;
+  }();
+  return *context;
+}
+
+mlir::OwningOpRef<mlir::ModuleOp>
+qssc::bench::parseModule(llvm::StringRef source, mlir::MLIRContext &context) {
+  auto module = mlir::parseSourceString<mlir::ModuleOp>(source, &context);
+  if (!module)
+    llvm::report_fatal_error("Unable to parse the synthetic module");
+  return module;
+}
@@ -0,0 +1,43 @@
+//===- BenchmarkUtils.h - Shared microbenchmark setup -----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file declares the setup shared by the microbenchmarks.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSSC_BENCHMARK_UTILS_H
+#define QSSC_BENCHMARK_UTILS_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace qssc::bench {
+
+/// The context shared by the benchmarks, with the dialects of the compiler
+/// loaded and without multithreading, which would only add noise to the
+/// single threaded utilities measured.
+mlir::MLIRContext &getContext();
+
+/// Parse a synthetic module, which is a fatal error if it fails.
+mlir::OwningOpRef<mlir::ModuleOp> parseModule(llvm::StringRef source,
+                                              mlir::MLIRContext &context);
+
+} // namespace qssc::bench
+
+#endif // QSSC_BENCHMARK_UTILS_H
@@ -0,0 +1,151 @@
+//===- PayloadBenchmarks.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements microbenchmarks of the argument signature formats
+/// and of writing ZIP payloads.
+///
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include "Arguments/Signature.h"
+#include "Config/QSSConfig.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace {
+
+using qssc::arguments::Signature;
+
+// A signature of n patch points spread over 8 binaries, with one parameter
+// per patch point
+Signature makeSignature(int64_t numPatchPoints) {
+  Signature sig;
+  for (int64_t i = 0; i < numPatchPoints; ++i)
+    sig.addParameterPatchPoint("p" + std::to_string(i), "double",
+                               "exp/controller" + std::to_string(i % 8) +
+                                   ".bin",
+                               8 * (i / 8), static_cast<uint32_t>(i));
+  return sig;
+}
+
+void BM_SignatureSerialize(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  Signature const sig = makeSignature(n);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sig.serialize());
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_SignatureSerialize)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15)
+    ->Complexity();
+
+void BM_SignatureSerializeBinary(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  Signature const sig = makeSignature(n);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sig.serializeBinary());
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_SignatureSerializeBinary)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15)
+    ->Complexity();
+
+// Deserialize the text format for a binary argument of 0, the binary
+// format otherwise
+void BM_SignatureDeserialize(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  Signature const sig = makeSignature(n);
+  std::string const buffer =
+      state.range(1) ? sig.serializeBinary() : sig.serialize();
+  for (auto _ : state) {
+    auto deserialized = Signature::deserialize(buffer, std::nullopt);
+    if (!deserialized)
+      llvm::report_fatal_error(
+          llvm::StringRef(toString(deserialized.takeError())));
+    benchmark::DoNotOptimize(deserialized->isEmpty());
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(buffer.size()));
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_SignatureDeserialize)
+    ->ArgNames({"patch_points", "binary"})
+    ->ArgsProduct({benchmark::CreateRange(8, 1 << 15, 8), {0, 1}})
+    ->Complexity();
+
+// Write a ZIP payload of a number of members of a size each, and the
+// argument signature patching the start of each member
+void BM_ZipPayloadWrite(benchmark::State &state) {
+  int64_t const numMembers = state.range(0);
+  int64_t const memberSize = state.range(1);
+
+  auto payloadInfo =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  if (!payloadInfo.has_value()) {
+    state.SkipWithError("The ZIP payload is not available");
+    return;
+  }
+
+  for (auto _ : state) {
+    // payloads are written once, set up a new one for each iteration
+    state.PauseTiming();
+    auto payloadOrErr = payloadInfo.value()->createPluginInstance(
+        qssc::payload::PayloadConfig{"exp", "exp",
+                                     qssc::config::QSSVerbosity::Error});
+    if (!payloadOrErr)
+      llvm::report_fatal_error(
+          llvm::StringRef(toString(payloadOrErr.takeError())));
+    std::unique_ptr<qssc::payload::Payload> payload =
+        std::move(payloadOrErr.get());
+    Signature sig;
+    for (int64_t member = 0; member < numMembers; ++member) {
+      std::string const name = "controller" + std::to_string(member) + ".bin";
+      payload->getFile(name)->assign(memberSize, '\x5a');
+      sig.addParameterPatchPoint("p" + std::to_string(member), "double",
+                                 "exp/" + name, 0);
+    }
+    payload->writeArgumentSignature(std::move(sig));
+    std::string buffer;
+    buffer.reserve(numMembers * memberSize * 2);
+    llvm::raw_string_ostream os(buffer);
+    state.ResumeTiming();
+
+    payload->write(os);
+    os.flush();
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(state.iterations() * numMembers * memberSize);
+}
+BENCHMARK(BM_ZipPayloadWrite)
+    ->ArgNames({"members", "member_size"})
+    ->ArgsProduct({{1, 8, 64}, {1 << 10, 1 << 16, 1 << 20}})
+    ->Unit(benchmark::kMillisecond);
+
+} // anonymous namespace
@@ -0,0 +1,131 @@
+//===- PulseBenchmarks.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements microbenchmarks of the Pulse utilities on the hot
+/// paths of scheduling and waveform deduplication.
+///
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include "BenchmarkUtils.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OwningOpRef.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace {
+
+using mlir::pulse::CallSequenceOp;
+using mlir::pulse::PlayOp;
+using mlir::pulse::SequenceOp;
+
+template <typename T>
+T checked(llvm::Expected<T> value) {
+  if (!value)
+    llvm::report_fatal_error(llvm::StringRef(toString(value.takeError())));
+  return std::move(*value);
+}
+
+// The durations of n sequences, per sequence
+void BM_SequenceGetDuration(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  std::string source;
+  llvm::raw_string_ostream os(source);
+  for (int64_t i = 0; i < n; ++i)
+    os << "pulse.sequence @seq_" << i
+       << "() attributes {pulse.duration = " << 100 + i << " : i64} {\n"
+       << "  pulse.return\n"
+       << "}\n";
+  os << "func.func @main() -> i32 {\n";
+  for (int64_t i = 0; i < n; ++i)
+    os << "  pulse.call_sequence @seq_" << i << "() : () -> ()\n";
+  os << "  %ret = arith.constant 0 : i32\n"
+     << "  return %ret : i32\n"
+     << "}\n";
+
+  auto &context = qssc::bench::getContext();
+  auto module = qssc::bench::parseModule(os.str(), context);
+  llvm::SmallVector<std::pair<SequenceOp, CallSequenceOp>> sequences;
+  module->walk([&](CallSequenceOp callOp) {
+    sequences.emplace_back(
+        module->lookupSymbol<SequenceOp>(callOp.getCallee()), callOp);
+  });
+
+  for (auto _ : state)
+    for (auto [sequenceOp, callOp] : sequences)
+      benchmark::DoNotOptimize(checked(sequenceOp.getDuration(callOp)));
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_SequenceGetDuration)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 12)
+    ->Complexity();
+
+// The waveform hashes of n plays of sequence arguments, per play
+void BM_PlayOpGetWaveformHash(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  std::string source;
+  llvm::raw_string_ostream os(source);
+  os << "pulse.sequence @seq_0(%arg0: !pulse.waveform, "
+        "%arg1: !pulse.mixed_frame) {\n";
+  for (int64_t i = 0; i < n; ++i)
+    os << "  pulse.play(%arg1, %arg0) : (!pulse.mixed_frame, "
+          "!pulse.waveform)\n";
+  os << "  pulse.return\n"
+     << "}\n"
+     << "func.func @main() -> i32 {\n"
+     << "  %0 = \"pulse.create_port\"() {uid = \"d0\"} : () -> !pulse.port\n"
+     << "  %1 = \"pulse.mix_frame\"(%0) {uid = \"mf0-d0\"} : (!pulse.port) "
+        "-> !pulse.mixed_frame\n"
+     << "  %2 = pulse.create_waveform dense<[[0.0, 1.0], [1.0, 0.0]]> : "
+        "tensor<2x2xf64> -> !pulse.waveform\n"
+     << "  pulse.call_sequence @seq_0(%2, %1) : (!pulse.waveform, "
+        "!pulse.mixed_frame) -> ()\n"
+     << "  %ret = arith.constant 0 : i32\n"
+     << "  return %ret : i32\n"
+     << "}\n";
+
+  auto &context = qssc::bench::getContext();
+  auto module = qssc::bench::parseModule(os.str(), context);
+  CallSequenceOp callOp;
+  module->walk([&](CallSequenceOp op) { callOp = op; });
+  llvm::SmallVector<PlayOp> plays;
+  module->walk([&](PlayOp playOp) { plays.push_back(playOp); });
+
+  for (auto _ : state)
+    for (PlayOp playOp : plays)
+      benchmark::DoNotOptimize(checked(playOp.getWaveformHash(callOp)));
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_PlayOpGetWaveformHash)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 12)
+    ->Complexity();
+
+} // anonymous namespace
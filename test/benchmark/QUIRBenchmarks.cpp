@@ -0,0 +1,175 @@
+//===- QUIRBenchmarks.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements microbenchmarks of the QUIR utilities on the hot
+/// paths of the passes: finding the next quantum operation, collecting and
+/// intersecting the qubits operated on and looking up callees.
+///
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include "BenchmarkUtils.h"
+
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+#include "Utils/SymbolCacheAnalysis.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <string>
+
+namespace {
+
+using mlir::quir::CallCircuitOp;
+using mlir::quir::CircuitOp;
+using mlir::quir::QubitSet;
+
+// A main function declaring numQubits qubits
+void beginMain(llvm::raw_ostream &os, int64_t numQubits) {
+  os << "func.func @main() -> i32 {\n";
+  for (int64_t qubit = 0; qubit < numQubits; ++qubit)
+    os << "  %q" << qubit << " = quir.declare_qubit {id = " << qubit
+       << " : i32} : !quir.qubit<1>\n";
+}
+
+void endMain(llvm::raw_ostream &os) {
+  os << "  %ret = arith.constant 0 : i32\n"
+     << "  return %ret : i32\n"
+     << "}\n";
+}
+
+// The next quantum operation is found after skipping n classical ones
+void BM_NextQuantumOpOrNull(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  std::string source;
+  llvm::raw_string_ostream os(source);
+  beginMain(os, 1);
+  os << "  quir.reset %q0 : !quir.qubit<1>\n";
+  for (int64_t i = 0; i < n; ++i)
+    os << "  %c" << i << " = arith.constant " << i << " : i32\n";
+  os << "  quir.reset %q0 : !quir.qubit<1>\n";
+  endMain(os);
+
+  auto &context = qssc::bench::getContext();
+  auto module = qssc::bench::parseModule(os.str(), context);
+  mlir::quir::ResetQubitOp first;
+  module->walk([&](mlir::quir::ResetQubitOp resetOp) {
+    if (!first)
+      first = resetOp;
+  });
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(mlir::quir::nextQuantumOpOrNull(first));
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_NextQuantumOpOrNull)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15)
+    ->Complexity();
+
+// The qubits of n resets of distinct qubits nested in a conditional
+void BM_GetOperatedQubits(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  std::string source;
+  llvm::raw_string_ostream os(source);
+  beginMain(os, n);
+  os << "  %cond = arith.constant true\n"
+     << "  scf.if %cond {\n";
+  for (int64_t qubit = 0; qubit < n; ++qubit)
+    os << "    quir.reset %q" << qubit << " : !quir.qubit<1>\n";
+  os << "  }\n";
+  endMain(os);
+
+  auto &context = qssc::bench::getContext();
+  auto module = qssc::bench::parseModule(os.str(), context);
+  mlir::scf::IfOp ifOp;
+  module->walk([&](mlir::scf::IfOp op) { ifOp = op; });
+
+  for (auto _ : state) {
+    QubitSet const qubits =
+        mlir::quir::QubitOpInterface::getOperatedQubits(ifOp);
+    benchmark::DoNotOptimize(qubits.size());
+  }
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_GetOperatedQubits)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 12)
+    ->Complexity();
+
+// Disjoint sets of n qubits each, interleaved such that every id is compared
+void BM_QubitSetsOverlap(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  QubitSet even;
+  QubitSet odd;
+  for (int64_t i = 0; i < n; ++i) {
+    even.insert(static_cast<uint32_t>(2 * i));
+    odd.insert(static_cast<uint32_t>(2 * i + 1));
+  }
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        mlir::quir::QubitOpInterface::qubitSetsOverlap(even, odd));
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_QubitSetsOverlap)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15)
+    ->Complexity();
+
+// Lookups of the callees of n calls of n circuits, per call
+void BM_SymbolCacheGetOp(benchmark::State &state) {
+  int64_t const n = state.range(0);
+  std::string source;
+  llvm::raw_string_ostream os(source);
+  for (int64_t i = 0; i < n; ++i)
+    os << "quir.circuit @circuit_" << i << "() {\n"
+       << "  quir.return\n"
+       << "}\n";
+  beginMain(os, 0);
+  for (int64_t i = 0; i < n; ++i)
+    os << "  quir.call_circuit @circuit_" << i << "() : () -> ()\n";
+  endMain(os);
+
+  auto &context = qssc::bench::getContext();
+  auto module = qssc::bench::parseModule(os.str(), context);
+  llvm::SmallVector<CallCircuitOp> calls;
+  module->walk([&](CallCircuitOp callOp) { calls.push_back(callOp); });
+  qssc::utils::SymbolCacheAnalysis cache(module->getOperation());
+  cache.addToCache<CircuitOp>();
+
+  for (auto _ : state)
+    for (CallCircuitOp callOp : calls)
+      benchmark::DoNotOptimize(cache.getOp<CircuitOp>(callOp));
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_SymbolCacheGetOp)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 12)
+    ->Complexity();
+
+} // anonymous namespace
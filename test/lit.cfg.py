@@ -1,4 +1,4 @@
-# (C) Copyright IBM 2023.
+# (C) Copyright IBM 2023, 2024.
 #
 # This code is part of Qiskit.
 #
@@ -42,7 +42,7 @@ llvm_config.use_default_substitutions()
 # excludes: A list of directories to exclude from the testsuite. The 'Inputs'
 # subdirectories contain auxiliary inputs for various tests in their parent
 # directories.
-config.excludes = ["Inputs", "Examples", "CMakeLists.txt", "README.txt", "LICENSE.txt"]
+config.excludes = ["Inputs", "Examples", "utils", "CMakeLists.txt", "README.txt", "LICENSE.txt"]
 
 # TODO pull from "virtual env" *activate.py?" "buildenv.py?"
 config.environment["QSSC_RESOURCES"] = os.path.join(config.qss_compiler_obj_root, "resources")
@@ -56,6 +56,24 @@ llvm_config.with_environment("PATH", config.llvm_tools_dir, append_path=True)
 tools = os.listdir(config.qss_compiler_tools_dir)
 llvm_config.add_tool_substitutions(tools, [config.qss_compiler_tools_dir])
 
+# Performance regression tests bound op counts, pass statistics and compile
+# times with perf-check.py. Tests bounding times depend on the machine and
+# declare "REQUIRES: perf", they are only run with -Dperf=1, which the
+# QSSC_ENABLE_PERF_TESTS CMake option passes. Their bounds on times are scaled
+# by -Dperf_time_scale=<factor>.
+if lit.util.pythonize_bool(lit_config.params.get("perf", False)):
+    config.available_features.add("perf")
+config.substitutions.append(
+    (
+        "%perf-check",
+        "{} {} --time-scale={}".format(
+            config.python_executable,
+            os.path.join(config.qss_compiler_src_root, "test", "utils", "perf-check.py"),
+            lit_config.params.get("perf_time_scale", "1"),
+        ),
+    )
+)
+
 llvm_config.feature_config(
     [("--assertion-mode", {"ON": "asserts"}), ("--build-mode", {"[Dd][Ee][Bb][Uu][Gg]": "debug"})]
 )
@@ -13,11 +13,20 @@
 """
 Unit tests for the compiler API.
 """
+import asyncio
+from concurrent.futures import ThreadPoolExecutor
+
 import pytest
 import qss_compiler
 from qss_compiler import (
+    AsyncCompileServer,
+    compile_batch,
+    compile_bytes,
     compile_file,
     compile_str,
+    compile_str_async,
+    CompileReport,
+    CompileServer,
     ErrorCategory,
     InputType,
     OutputType,
@@ -96,6 +105,33 @@ def test_compile_roundtrip_bytecode(example_mlir_str):
     assert mlir2 == mlir1
 
 
+def test_compile_bytes_chains_bytecode(example_qasm3_str):
+    """Test that bytecode output can be compiled again without passing
+    through textual MLIR"""
+
+    bytecode = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.BYTECODE,
+    )
+    assert isinstance(bytecode, bytes)
+
+    expected = compile_str(
+        bytecode,
+        input_type=InputType.BYTECODE,
+        output_type=OutputType.MLIR,
+    )
+    check_mlir_string(expected)
+
+    # input and output default to bytecode
+    assert compile_bytes(bytecode, output_type=OutputType.MLIR) == expected
+    assert isinstance(compile_bytes(bytecode), bytes)
+
+    with CompileServer() as server:
+        mlir = server.compile_bytes(bytecode, output_type=OutputType.MLIR)
+    assert mlir == expected
+
+
 def test_compile_str_to_mlir(example_qasm3_str):
     """Test that we can compile a string input via the interface
     compile_str to an MLIR output"""
@@ -109,6 +145,66 @@ def test_compile_str_to_mlir(example_qasm3_str):
     check_mlir_string(mlir)
 
 
+def test_compile_report(example_qasm3_str):
+    """Test that a report of the stages is returned along with the output."""
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+
+    mlir, report = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+        trace_context="job-42",
+        return_report=True,
+    )
+    assert mlir == expected
+    assert isinstance(report, CompileReport)
+    assert list(report.stages) == ["queue_wait", "parse", "passes", "emit", "total"]
+    assert all(seconds >= 0.0 for seconds in report.stages.values())
+    assert report.stages["parse"] <= report.stages["total"]
+    assert report.peak_rss_bytes > 0
+    assert report.trace_context == "job-42"
+
+    with CompileServer(num_workers=1) as server:
+        mlir, report = server.compile_str(
+            example_qasm3_str,
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+            return_report=True,
+        )
+    assert mlir == expected
+    assert report.stages["queue_wait"] >= 0.0
+    assert report.trace_context is None
+
+
+def test_compile_shared_output(example_qasm3_str):
+    """Test that output returned through shared memory matches the bytes."""
+    expected = compile_str(example_qasm3_str, input_type=InputType.QASM3)
+
+    payload = compile_str(example_qasm3_str, input_type=InputType.QASM3, shared_output=True)
+    assert isinstance(payload, memoryview)
+    assert payload.readonly
+    assert payload == expected
+
+    with CompileServer(num_workers=1) as server:
+        for _ in range(2):
+            payload = server.compile_str(
+                example_qasm3_str, input_type=InputType.QASM3, shared_output=True
+            )
+            assert payload == expected
+
+    mlir = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+        shared_output=True,
+    )
+    check_mlir_string(mlir)
+
+
 def test_empty_str():
     """Test that we can compile an empty string."""
 
@@ -286,3 +382,235 @@ def test_failure_no_hang():
             output_file=None,
             extra_args=["bad_arg"],
         )
+
+
+def test_compile_server_reuses_workers(example_qasm3_str, example_qasm3_tmpfile):
+    """Test that a compile server produces the same output as one-shot
+    compilation across repeated requests."""
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+
+    with CompileServer(num_workers=1) as server:
+        for _ in range(3):
+            mlir = server.compile_str(
+                example_qasm3_str,
+                input_type=InputType.QASM3,
+                output_type=OutputType.MLIR,
+            )
+            assert mlir == expected
+
+        mlir = server.compile_file(
+            example_qasm3_tmpfile,
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+        )
+        check_mlir_string(mlir)
+
+
+def test_compile_server_restarts_dead_worker(example_qasm3_str):
+    """Test that a worker which exits while compiling is replaced and the
+    server remains usable."""
+    with CompileServer(num_workers=1) as server:
+        with pytest.raises(exceptions.QSSCompilerEOFFailure):
+            server.compile_str(
+                "",
+                input_type=InputType.QASM3,
+                output_type=OutputType.MLIR,
+                extra_args=["bad_arg"],
+            )
+
+        mlir = server.compile_str(
+            example_qasm3_str,
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+        )
+        check_mlir_string(mlir)
+
+
+def test_compile_server_reports_diagnostics(example_invalid_qasm3_str):
+    """Test that diagnostics are delivered to the caller from a worker."""
+    with CompileServer(num_workers=1) as server:
+        with pytest.raises(exceptions.OpenQASM3ParseFailure) as compfail:
+            server.compile_str(
+                example_invalid_qasm3_str,
+                return_diagnostics=True,
+                input_type=InputType.QASM3,
+                output_type=OutputType.MLIR,
+            )
+
+    assert any(
+        diag.category == ErrorCategory.OpenQASM3ParseFailure
+        for diag in compfail.value.diagnostics
+    )
+
+
+def test_compile_str_async(example_qasm3_str):
+    """Test that the one-shot async compile matches the blocking one."""
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+
+    async def compile_concurrently():
+        return await asyncio.gather(
+            *(
+                compile_str_async(
+                    example_qasm3_str,
+                    input_type=InputType.QASM3,
+                    output_type=OutputType.MLIR,
+                )
+                for _ in range(2)
+            )
+        )
+
+    assert asyncio.run(compile_concurrently()) == [expected, expected]
+
+
+def test_compile_in_process(example_qasm3_str, example_qasm3_tmpfile, example_invalid_qasm3_str):
+    """Test that threads compiling in process match the compile processes and
+    that their diagnostics are delivered."""
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+
+    def compile_in_process(_):
+        return compile_str(
+            example_qasm3_str,
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+            in_process=True,
+        )
+
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        assert list(executor.map(compile_in_process, range(8))) == [expected] * 8
+
+    mlir = compile_file(
+        example_qasm3_tmpfile,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+        in_process=True,
+    )
+    check_mlir_string(mlir)
+
+    diagnostics = []
+    with pytest.raises(exceptions.QSSCompilationFailure):
+        compile_str(
+            example_invalid_qasm3_str,
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+            in_process=True,
+            on_diagnostic=diagnostics.append,
+        )
+    assert any(diag.category == ErrorCategory.OpenQASM3ParseFailure for diag in diagnostics)
+
+    # an invalid argument fails the compilation rather than the interpreter
+    with pytest.raises(exceptions.QSSCompilerError):
+        compile_str(
+            example_qasm3_str,
+            input_type=InputType.QASM3,
+            in_process=True,
+            extra_args=["--no-such-option"],
+        )
+
+    assert asyncio.run(
+        compile_str_async(
+            example_qasm3_str,
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+            in_process=True,
+        )
+    ) == expected
+
+
+def test_async_compile_server(example_qasm3_str, example_invalid_qasm3_str):
+    """Test that an async compile server serves more concurrent requests than
+    it has workers and isolates failing requests."""
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+
+    async def compile_concurrently():
+        async with AsyncCompileServer(num_workers=2) as server:
+            return await asyncio.gather(
+                *(
+                    server.compile_str(
+                        program,
+                        input_type=InputType.QASM3,
+                        output_type=OutputType.MLIR,
+                    )
+                    for program in [example_qasm3_str] * 2
+                    + [example_invalid_qasm3_str]
+                    + [example_qasm3_str] * 2
+                ),
+                return_exceptions=True,
+            )
+
+    results = asyncio.run(compile_concurrently())
+    assert results[:2] == [expected, expected]
+    assert isinstance(results[2], exceptions.OpenQASM3ParseFailure)
+    assert results[3:] == [expected, expected]
+
+
+def test_async_compile_server_backpressure_and_cancel(example_qasm3_str):
+    """Test that requests beyond the pending limit are refused and that a
+    cancelled request leaves the server usable."""
+
+    async def compile_with_limit():
+        async with AsyncCompileServer(num_workers=1, max_pending=1) as server:
+
+            def request():
+                return server.compile_str(
+                    example_qasm3_str,
+                    input_type=InputType.QASM3,
+                    output_type=OutputType.MLIR,
+                )
+
+            running = asyncio.ensure_future(request())
+            await asyncio.sleep(0)
+            pending = asyncio.ensure_future(request())
+            await asyncio.sleep(0)
+            assert server.num_pending == 1
+            with pytest.raises(exceptions.QSSCompileServerBusy):
+                await request()
+
+            running.cancel()
+            with pytest.raises(asyncio.CancelledError):
+                await running
+            return await pending
+
+    check_mlir_string(asyncio.run(compile_with_limit()))
+
+
+def test_compile_batch(example_qasm3_str, example_invalid_qasm3_str):
+    """Test that a batch returns one result per input matching one-shot
+    compilation and isolates failing inputs."""
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+
+    results = compile_batch(
+        [example_qasm3_str, example_invalid_qasm3_str, example_qasm3_str],
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+
+    assert len(results) == 3
+    assert results[0].success
+    assert results[0].output == expected
+    assert results[2].success
+    assert results[2].output == expected
+
+    assert not results[1].success
+    assert any(
+        diag.category == ErrorCategory.OpenQASM3ParseFailure for diag in results[1].diagnostics
+    )
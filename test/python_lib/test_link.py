@@ -1,4 +1,4 @@
-# (C) Copyright IBM 2023.
+# (C) Copyright IBM 2023, 2024.
 #
 # This code is part of Qiskit.
 #
@@ -15,7 +15,7 @@ Unit tests for the linker API.
 """
 import pytest
 
-from qss_compiler import link_file
+from qss_compiler import ArgumentBinder, link_batch, link_batch_array, link_file, Linker
 from qss_compiler.exceptions import QSSLinkerNotImplemented
 
 
@@ -34,3 +34,56 @@ def test_linker_not_implemented(tmp_path):
         )
 
     assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+def test_link_batch_not_implemented(tmp_path):
+    qem_file = tmp_path / "test.txt"
+    with open(qem_file, "w") as f:
+        f.write("dummy")
+
+    with pytest.raises(QSSLinkerNotImplemented) as error:
+        link_batch(
+            [{"a": 0.0}, {"a": 1}],
+            input_file=qem_file,
+            target="Mock",
+        )
+
+    assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+def test_link_batch_array_not_implemented(tmp_path):
+    qem_file = tmp_path / "test.txt"
+    with open(qem_file, "w") as f:
+        f.write("dummy")
+
+    with pytest.raises(QSSLinkerNotImplemented) as error:
+        link_batch_array(
+            ["a", "b"],
+            [[0.0, 1.0], [2, 3]],
+            input_file=qem_file,
+            target="Mock",
+        )
+
+    assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+def test_argument_binder_not_implemented(tmp_path):
+    qem_file = tmp_path / "test.txt"
+    with open(qem_file, "w") as f:
+        f.write("dummy")
+
+    with pytest.raises(QSSLinkerNotImplemented) as error:
+        ArgumentBinder(input_file=qem_file, target="Mock")
+
+    assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+def test_linker_object_not_implemented(tmp_path):
+    qem_file = tmp_path / "test.txt"
+    with open(qem_file, "w") as f:
+        f.write("dummy")
+
+    with pytest.raises(QSSLinkerNotImplemented) as error:
+        Linker(input_file=qem_file, target="Mock")
+
+    assert str(error.value.message) == "Unable to load bind arguments implementation for target."
@@ -59,3 +59,66 @@ def test_create_sequenceop():
             qcs.SystemFinalizeOp
 
     check_mlir_string(str(module))
+
+
+def test_build_pulse_ops_in_bulk():
+    import numpy as np
+
+    with Context() as ctx, Location.unknown():
+        pulse.pulse.register_dialect()
+        module = Module.create()
+        mf = pulse.MixedFrameType.get(ctx)
+
+        with InsertionPoint(module.body):
+            seq = pulse.SequenceOp("test_seq", [mf, mf], [])
+            seq.add_entry_block()
+
+        with InsertionPoint(seq.entry_block):
+            mf0, mf1 = seq.arguments
+            samples = np.array([0.0 + 0.5j, 0.5 + 0.5j, 0.5 + 0.0j])
+            waveform = pulse.Waveform_CreateOp(samples)
+            pulse.build_play_ops(
+                [mf0, mf1],
+                [waveform],
+                np.array([0, 1, 0]),
+                np.zeros(3, dtype=np.int64),
+                timepoints=np.array([0, 0, 3]),
+            )
+            pulse.build_delay_ops([mf0, mf1], [1, 1], [3, 3])
+            pulse.ReturnOp([])
+
+        with pytest.raises(IndexError):
+            with InsertionPoint(seq.entry_block):
+                pulse.build_play_ops([mf0], [waveform], [1], [0])
+
+    module_str = str(module)
+    assert "[0.000000e+00, 5.000000e-01]" in module_str
+    assert module_str.count("pulse.play") == 3
+    assert "pulse.timepoint = 3 : i64" in module_str
+    assert module_str.count("pulse.delay") == 2
+    assert module_str.count("arith.constant 3 : i32") == 1
+
+
+def test_compile_module_in_memory():
+    from qss_compiler import compile_module, OutputType
+
+    with Context() as ctx, Location.unknown():
+        pulse.pulse.register_dialect()
+        module = Module.create()
+        mf = pulse.MixedFrameType.get(ctx)
+
+        with InsertionPoint(module.body):
+            seq = pulse.SequenceOp("test_seq", [mf], [])
+            seq.add_entry_block()
+        with InsertionPoint(seq.entry_block):
+            pulse.build_delay_ops(list(seq.arguments), [0], [4])
+            pulse.ReturnOp([])
+
+        mlir = compile_module(module, output_type=OutputType.MLIR)
+        bytecode = compile_module(module, output_type=OutputType.BYTECODE)
+
+    assert isinstance(mlir, str)
+    assert "pulse.sequence @test_seq" in mlir
+    assert "pulse.delay" in mlir
+    assert isinstance(bytecode, bytes)
+    assert bytecode.startswith(b"ML\xefR")
@@ -0,0 +1,104 @@
+//===- CompileSingleFlightTest.cpp ------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the single-flight layer deduplicating
+/// concurrent compilations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/CompileSingleFlight.h"
+#include "API/errors.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using qssc::cache::CompileOutcome;
+using qssc::cache::CompileSingleFlight;
+
+TEST(CompileSingleFlight, DeduplicatesConcurrentCompilations) {
+  CompileSingleFlight singleFlight;
+  std::atomic<int> numCompiles = 0;
+
+  // stands in for the compile cache populated by the compilation
+  std::mutex cacheMutex;
+  std::optional<std::string> cached;
+  auto recheck = [&]() -> std::optional<CompileOutcome> {
+    const std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!cached)
+      return std::nullopt;
+    CompileOutcome outcome;
+    outcome.output = *cached;
+    return outcome;
+  };
+  auto compile = [&]() {
+    ++numCompiles;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CompileOutcome outcome;
+    outcome.output = "payload";
+    outcome.diagnostics.emplace_back(qssc::Severity::Warning,
+                                     qssc::ErrorCategory::UncategorizedError,
+                                     "shared warning");
+    const std::lock_guard<std::mutex> lock(cacheMutex);
+    cached = outcome.output;
+    return outcome;
+  };
+
+  std::vector<CompileOutcome> outcomes(8);
+  std::vector<std::thread> threads;
+  for (auto &outcome : outcomes)
+    threads.emplace_back([&] {
+      outcome = singleFlight.run("key", std::nullopt, recheck, compile);
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(numCompiles, 1);
+  for (const auto &outcome : outcomes) {
+    EXPECT_FALSE(outcome.error.has_value());
+    EXPECT_EQ(outcome.output, "payload");
+  }
+  EXPECT_EQ(singleFlight.getNumInFlight(), 0u);
+}
+
+TEST(CompileSingleFlight, SharesFailuresPerKey) {
+  CompileSingleFlight singleFlight;
+  int numCompiles = 0;
+  auto recheck = []() -> std::optional<CompileOutcome> { return std::nullopt; };
+  auto fail = [&]() {
+    ++numCompiles;
+    CompileOutcome outcome;
+    outcome.error = "compilation failed";
+    return outcome;
+  };
+
+  auto first = singleFlight.run("first", std::nullopt, recheck, fail);
+  auto second = singleFlight.run("second", std::nullopt, recheck, fail);
+  EXPECT_EQ(first.error, "compilation failed");
+  EXPECT_EQ(second.error, "compilation failed");
+  // keys which are not in flight at once compile independently
+  EXPECT_EQ(numCompiles, 2);
+}
+
+} // anonymous namespace
@@ -0,0 +1,77 @@
+//===- ContextPoolTest.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the pool of warmed-up contexts.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/ContextPool.h"
+#include "Dialect/QUIR/IR/QUIRDialect.h"
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+
+namespace {
+
+using qssc::ContextPool;
+
+TEST(ContextPool, ReusesWarmContexts) {
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::quir::QUIRDialect>();
+  ContextPool pool(registry);
+
+  mlir::MLIRContext *first = nullptr;
+  {
+    auto lease = pool.acquire();
+    first = &lease.getContext();
+    EXPECT_NE(first->getLoadedDialect<mlir::quir::QUIRDialect>(), nullptr);
+    // leaving the context single threaded does not leak into later leases
+    first->disableMultithreading();
+  }
+  {
+    auto lease = pool.acquire();
+    EXPECT_EQ(&lease.getContext(), first);
+    EXPECT_TRUE(lease.getContext().isMultithreadingEnabled());
+
+    // contexts leased concurrently are distinct
+    auto other = pool.acquire();
+    EXPECT_NE(&other.getContext(), first);
+  }
+
+  auto const statistics = pool.getStatistics();
+  EXPECT_EQ(statistics.created, 2u);
+  EXPECT_EQ(statistics.reused, 1u);
+  EXPECT_EQ(statistics.recycled, 0u);
+}
+
+TEST(ContextPool, RecyclesExhaustedContexts) {
+  mlir::DialectRegistry registry;
+  ContextPool::Options options;
+  options.maxUses = 2;
+  ContextPool pool(registry, options);
+
+  for (unsigned i = 0; i < 4; ++i)
+    pool.acquire();
+
+  auto const statistics = pool.getStatistics();
+  EXPECT_EQ(statistics.created, 2u);
+  EXPECT_EQ(statistics.reused, 2u);
+  EXPECT_EQ(statistics.recycled, 2u);
+}
+
+} // anonymous namespace
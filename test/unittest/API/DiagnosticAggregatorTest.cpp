@@ -0,0 +1,158 @@
+//===- DiagnosticAggregatorTest.cpp -----------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the aggregation of repeated
+/// diagnostics and the cap on the diagnostics of a compilation.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/errors.h"
+
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/Support/SourceMgr.h"
+
+#include <optional>
+#include <string>
+
+namespace {
+
+using qssc::DiagList;
+using qssc::DiagnosticAggregator;
+using qssc::ErrorCategory;
+using qssc::Severity;
+
+qssc::DiagnosticCallback collectInto(DiagList &diagnostics) {
+  return [&diagnostics](const qssc::Diagnostic &diag) {
+    diagnostics.push_back(diag);
+  };
+}
+
+TEST(DiagnosticAggregator, DeliversAllWithoutLimits) {
+  DiagList diagnostics;
+  DiagnosticAggregator aggregator(collectInto(diagnostics), std::nullopt,
+                                  std::nullopt);
+  EXPECT_FALSE(aggregator.isLimited());
+
+  for (int i = 0; i < 5; ++i)
+    aggregator.emit({Severity::Warning, ErrorCategory::QSSCompilerError,
+                     "repeated warning"});
+  aggregator.flush();
+  EXPECT_EQ(diagnostics.size(), 5u);
+}
+
+TEST(DiagnosticAggregator, SummarizesRepeats) {
+  DiagList diagnostics;
+  DiagnosticAggregator aggregator(collectInto(diagnostics), 2, std::nullopt);
+
+  for (int i = 0; i < 5; ++i)
+    aggregator.emit({Severity::Warning, ErrorCategory::QSSCompilerError,
+                     "repeated warning"});
+  aggregator.emit(
+      {Severity::Warning, ErrorCategory::QSSCompilerError, "other warning"});
+  // the same message in another category is another template
+  aggregator.emit(
+      {Severity::Warning, ErrorCategory::UncategorizedError, "other warning"});
+  EXPECT_EQ(diagnostics.size(), 4u);
+
+  aggregator.flush();
+  ASSERT_EQ(diagnostics.size(), 5u);
+  auto const &summary = diagnostics.back();
+  EXPECT_EQ(summary.severity, Severity::Warning);
+  EXPECT_EQ(summary.category, ErrorCategory::QSSCompilerError);
+  EXPECT_EQ(summary.message,
+            "\"repeated warning\" occurred 3 more times\n");
+
+  // the summarized repeats are not summarized again
+  aggregator.flush();
+  EXPECT_EQ(diagnostics.size(), 5u);
+}
+
+TEST(DiagnosticAggregator, RecordsSampleLocations) {
+  DiagList diagnostics;
+  DiagnosticAggregator aggregator(collectInto(diagnostics), 1, std::nullopt);
+
+  int numLocations = 0;
+  for (int i = 0; i < 6; ++i) {
+    bool const admitted = aggregator.admit(
+        Severity::Warning, ErrorCategory::QSSCompilerError, "template", [&]() {
+          ++numLocations;
+          return "line " + std::to_string(i);
+        });
+    EXPECT_EQ(admitted, i == 0);
+  }
+  // only the locations of the samples are computed
+  EXPECT_EQ(numLocations, 3);
+
+  aggregator.flush();
+  ASSERT_EQ(diagnostics.size(), 1u);
+  EXPECT_EQ(diagnostics.front().message,
+            "\"template\" occurred 5 more times, e.g. at line 1, line 2, "
+            "line 3\n");
+}
+
+TEST(DiagnosticAggregator, CapsNonErrors) {
+  DiagList diagnostics;
+  DiagnosticAggregator aggregator(collectInto(diagnostics), std::nullopt, 2);
+
+  aggregator.emit({Severity::Info, ErrorCategory::QSSCompilerError, "a"});
+  aggregator.emit({Severity::Info, ErrorCategory::QSSCompilerError, "b"});
+  aggregator.emit({Severity::Warning, ErrorCategory::QSSCompilerError, "c"});
+  aggregator.emit({Severity::Info, ErrorCategory::QSSCompilerError, "d"});
+  aggregator.emit(
+      {Severity::Error, ErrorCategory::QSSCompilationFailure, "failure"});
+  ASSERT_EQ(diagnostics.size(), 3u);
+  EXPECT_EQ(diagnostics.back().message, "failure");
+
+  aggregator.flush();
+  ASSERT_EQ(diagnostics.size(), 4u);
+  EXPECT_EQ(diagnostics.back().severity, Severity::Warning);
+  EXPECT_EQ(diagnostics.back().message,
+            "2 more diagnostics were suppressed after 3 were emitted\n");
+}
+
+TEST(DiagnosticAggregator, AggregatesMLIRDiagnostics) {
+  mlir::MLIRContext context;
+  llvm::SourceMgr sourceMgr;
+  DiagList diagnostics;
+  DiagnosticAggregator aggregator(collectInto(diagnostics), 2, std::nullopt);
+  qssc::OptDiagnosticCallback diagnosticCb = aggregator.getCallback();
+  qssc::QSSCMLIRDiagnosticHandler const handler(sourceMgr, &context,
+                                                diagnosticCb, &aggregator);
+
+  // the repeats differ in their location only
+  for (unsigned line = 1; line <= 4; ++line)
+    mlir::emitError(mlir::FileLineColLoc::get(&context, "input.mlir", line, 1),
+                    "unsupported gate");
+  ASSERT_EQ(diagnostics.size(), 2u);
+  EXPECT_EQ(diagnostics.front().category,
+            ErrorCategory::QSSCompilationFailure);
+
+  aggregator.flush();
+  ASSERT_EQ(diagnostics.size(), 3u);
+  auto const &summary = diagnostics.back();
+  EXPECT_EQ(summary.severity, Severity::Error);
+  EXPECT_NE(summary.message.find("\"unsupported gate\" occurred 2 more "
+                                 "times, e.g. at "),
+            std::string::npos);
+  EXPECT_NE(summary.message.find("input.mlir"), std::string::npos);
+}
+
+} // anonymous namespace
@@ -0,0 +1,84 @@
+//===- LoweredModuleTest.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the compilation split into the
+/// lowering of a module and the emission of its payload.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+#include "Config/QSSConfig.h"
+#include "Dialect/RegisterDialects.h"
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace {
+
+using qssc::config::EmitAction;
+using qssc::config::InputType;
+
+TEST(LoweredModule, LowersToBytecode) {
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  mlir::DefaultTimingManager tm;
+  mlir::TimingScope timing = tm.getRootScope();
+
+  qssc::config::QSSConfig config;
+  config.setInputType(InputType::MLIR).setEmitAction(EmitAction::QEM);
+
+  std::string lowered;
+  llvm::raw_string_ostream loweredOS(lowered);
+  auto err = qssc::compileLoweredModule(
+      loweredOS,
+      llvm::MemoryBuffer::getMemBuffer("func.func @main() {\n  return\n}\n",
+                                       "input.mlir"),
+      registry, config, std::nullopt, timing);
+  ASSERT_FALSE(static_cast<bool>(err)) << llvm::toString(std::move(err));
+  loweredOS.flush();
+  EXPECT_TRUE(mlir::isBytecode(llvm::MemoryBufferRef(lowered, "lowered")));
+
+  // only payloads are emitted from a lowered module
+  config.setEmitAction(EmitAction::MLIR);
+  std::string output;
+  llvm::raw_string_ostream outputOS(output);
+  err = qssc::emitPayloadFromLoweredModule(
+      outputOS, llvm::MemoryBuffer::getMemBufferCopy(lowered, "lowered.bc"),
+      registry, config, std::nullopt, timing);
+  EXPECT_TRUE(static_cast<bool>(err));
+  llvm::consumeError(std::move(err));
+
+  // and only from bytecode
+  config.setEmitAction(EmitAction::QEM);
+  err = qssc::emitPayloadFromLoweredModule(
+      outputOS, llvm::MemoryBuffer::getMemBuffer("module {}", "lowered.mlir"),
+      registry, config, std::nullopt, timing);
+  EXPECT_TRUE(static_cast<bool>(err));
+  llvm::consumeError(std::move(err));
+}
+
+} // anonymous namespace
@@ -0,0 +1,104 @@
+//===- MultiTargetCompileTest.cpp -------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for compiling one input for several
+/// target configurations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+#include "Config/QSSConfig.h"
+#include "Dialect/RegisterDialects.h"
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MemoryBufferRef.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using qssc::config::EmitAction;
+using qssc::config::InputType;
+
+TEST(MultiTargetCompile, ForksAfterFrontend) {
+  // As a user, I want to compile a program for several target configurations
+  // without parsing it for each of them.
+
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  mlir::DefaultTimingManager tm;
+  mlir::TimingScope timing = tm.getRootScope();
+
+  qssc::config::QSSConfig config;
+  config.setInputType(InputType::MLIR);
+
+  std::vector<qssc::config::QSSConfig> targetConfigs(2);
+  targetConfigs[0].setEmitAction(EmitAction::MLIR);
+  targetConfigs[1].setEmitAction(EmitAction::Bytecode);
+
+  auto results = qssc::compileForTargets(
+      llvm::MemoryBuffer::getMemBuffer("func.func @main() {\n  return\n}\n",
+                                       "input.mlir"),
+      registry, config, targetConfigs, std::nullopt, timing);
+  ASSERT_TRUE(static_cast<bool>(results))
+      << llvm::toString(results.takeError());
+  ASSERT_EQ(results->size(), 2u);
+
+  EXPECT_TRUE((*results)[0].success);
+  EXPECT_NE((*results)[0].output.find("func.func @main()"), std::string::npos);
+  EXPECT_TRUE((*results)[1].success);
+  EXPECT_TRUE(mlir::isBytecode(
+      llvm::MemoryBufferRef((*results)[1].output, "output.bc")));
+}
+
+TEST(MultiTargetCompile, ReportsFrontendFailure) {
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  mlir::DefaultTimingManager tm;
+  mlir::TimingScope timing = tm.getRootScope();
+
+  qssc::config::QSSConfig config;
+  config.setInputType(InputType::MLIR);
+  std::vector<qssc::config::QSSConfig> targetConfigs(1);
+  targetConfigs[0].setEmitAction(EmitAction::MLIR);
+
+  auto results = qssc::compileForTargets(
+      llvm::MemoryBuffer::getMemBuffer("func.func @main() {", "input.mlir"),
+      registry, config, targetConfigs, std::nullopt, timing);
+  EXPECT_FALSE(static_cast<bool>(results));
+  llvm::consumeError(results.takeError());
+
+  // targets must emit a module or payload
+  targetConfigs[0].setEmitAction(EmitAction::AST);
+  results = qssc::compileForTargets(
+      llvm::MemoryBuffer::getMemBuffer("func.func @main() {\n  return\n}\n",
+                                       "input.mlir"),
+      registry, config, targetConfigs, std::nullopt, timing);
+  EXPECT_FALSE(static_cast<bool>(results));
+  llvm::consumeError(results.takeError());
+}
+
+} // anonymous namespace
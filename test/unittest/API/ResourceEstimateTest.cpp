@@ -0,0 +1,114 @@
+//===- ResourceEstimateTest.cpp ---------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the estimation of the resources of a
+/// compilation.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+#include "Config/QSSConfig.h"
+#include "Dialect/RegisterDialects.h"
+
+#include "mlir/IR/DialectRegistry.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace {
+
+using qssc::config::EmitAction;
+using qssc::config::InputType;
+
+std::string getLoopInput(int iterations) {
+  return "func.func @sub(%q0 : !quir.qubit<1>) {\n"
+         "  quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()\n"
+         "  return\n"
+         "}\n"
+         "func.func @main() -> i32 {\n"
+         "  %c0 = arith.constant 0 : index\n"
+         "  %c1 = arith.constant 1 : index\n"
+         "  %cn = arith.constant " +
+         std::to_string(iterations) +
+         " : index\n"
+         "  %c0_i32 = arith.constant 0 : i32\n"
+         "  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>\n"
+         "  scf.for %i = %c0 to %cn step %c1 {\n"
+         "    quir.call_subroutine @sub(%q0) : (!quir.qubit<1>) -> ()\n"
+         "  }\n"
+         "  return %c0_i32 : i32\n"
+         "}\n";
+}
+
+TEST(ResourceEstimate, CountsUnrolledModule) {
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  qssc::config::QSSConfig config;
+  config.setInputType(InputType::MLIR).setEmitAction(EmitAction::QEM);
+
+  auto small = qssc::estimateCompileResources(
+      llvm::MemoryBuffer::getMemBufferCopy(getLoopInput(10), "small.mlir"),
+      registry, config, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(small)) << llvm::toString(small.takeError());
+  EXPECT_EQ(small->ops, 14);
+  EXPECT_EQ(small->qubits, 1);
+  EXPECT_EQ(small->unrolledOps, 59);
+  EXPECT_EQ(small->unrolledQuantumOps, 10);
+  EXPECT_EQ(small->unrolledSubroutineCalls, 10);
+  EXPECT_EQ(small->maxSubroutineFanOut, 10);
+
+  // the estimates grow with the trip count, the module does not
+  auto large = qssc::estimateCompileResources(
+      llvm::MemoryBuffer::getMemBufferCopy(getLoopInput(10000), "large.mlir"),
+      registry, config, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(large)) << llvm::toString(large.takeError());
+  EXPECT_EQ(large->ops, small->ops);
+  EXPECT_EQ(large->unrolledQuantumOps, 10000);
+  EXPECT_GT(large->compileSeconds, small->compileSeconds);
+  EXPECT_GT(large->peakMemoryBytes, small->peakMemoryBytes);
+  EXPECT_GT(large->payloadBytes, small->payloadBytes);
+
+  // the costs are the caller's
+  qssc::CompileResourceModel model;
+  model.payloadBytesPerQuantumOp = 0;
+  auto unitCost = qssc::estimateCompileResources(
+      llvm::MemoryBuffer::getMemBufferCopy(getLoopInput(10), "small.mlir"),
+      registry, config, std::nullopt, model);
+  ASSERT_TRUE(static_cast<bool>(unitCost))
+      << llvm::toString(unitCost.takeError());
+  EXPECT_EQ(unitCost->payloadBytes, model.basePayloadBytes);
+}
+
+TEST(ResourceEstimate, FailsOnInvalidInput) {
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  qssc::config::QSSConfig config;
+  config.setInputType(InputType::MLIR);
+
+  auto estimate = qssc::estimateCompileResources(
+      llvm::MemoryBuffer::getMemBuffer("func.func @main(", "invalid.mlir"),
+      registry, config, std::nullopt);
+  EXPECT_FALSE(static_cast<bool>(estimate));
+  llvm::consumeError(estimate.takeError());
+}
+
+} // anonymous namespace
@@ -0,0 +1,74 @@
+//===- SharedThreadPoolTest.cpp ---------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the thread pool shared by the
+/// compilations of the process.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/SharedThreadPool.h"
+#include "Config/QSSConfig.h"
+
+#include "mlir/IR/MLIRContext.h"
+
+#include <optional>
+
+namespace {
+
+using qssc::ScopedSharedThreadPool;
+using qssc::config::CompilePriority;
+
+TEST(SharedThreadPool, SharesOnePoolByPriority) {
+  mlir::MLIRContext first;
+  mlir::MLIRContext second;
+  mlir::MLIRContext third;
+
+  {
+    ScopedSharedThreadPool const normal(first, std::nullopt);
+    ASSERT_TRUE(normal.isGranted());
+    EXPECT_TRUE(first.isMultithreadingEnabled());
+    EXPECT_EQ(&first.getThreadPool(),
+              &qssc::getSharedThreadPool(std::nullopt));
+
+    // low priority compilations only run multithreaded on an idle pool
+    ScopedSharedThreadPool const low(second, std::nullopt,
+                                     CompilePriority::Low);
+    EXPECT_FALSE(low.isGranted());
+    EXPECT_FALSE(second.isMultithreadingEnabled());
+
+    ScopedSharedThreadPool const high(third, std::nullopt,
+                                      CompilePriority::High);
+    EXPECT_TRUE(high.isGranted());
+    EXPECT_EQ(&third.getThreadPool(), &first.getThreadPool());
+  }
+
+  mlir::MLIRContext fourth;
+  ScopedSharedThreadPool const low(fourth, std::nullopt,
+                                   CompilePriority::Low);
+  EXPECT_TRUE(low.isGranted());
+}
+
+TEST(SharedThreadPool, LeavesSingleThreadedContexts) {
+  mlir::MLIRContext context(mlir::MLIRContext::Threading::DISABLED);
+  ScopedSharedThreadPool const pool(context, std::nullopt,
+                                    CompilePriority::High);
+  EXPECT_FALSE(pool.isGranted());
+  EXPECT_FALSE(context.isMultithreadingEnabled());
+}
+
+} // anonymous namespace
@@ -0,0 +1,361 @@
+//===- ArgumentsTest.cpp ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the argument sources.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/Signature.h"
+#include "Payload/PatchableZipPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using qssc::arguments::ArgumentKind;
+using qssc::arguments::ArgumentLayout;
+using qssc::arguments::ColumnarArgumentSource;
+using qssc::arguments::PatchPoint;
+
+// Patches the arguments as doubles into a binary
+class DoubleBindArguments
+    : public qssc::arguments::BindArgumentsImplementation {
+public:
+  explicit DoubleBindArguments(std::vector<char> *data) : data(data) {}
+
+  llvm::Error patch(PatchPoint const &patchPoint,
+                    qssc::arguments::ArgumentSource const &arguments) override {
+    auto value = std::get<std::optional<double>>(
+        arguments.getArgumentValue(patchPoint.expression()));
+    if (!value)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "missing argument");
+    std::memcpy(data->data() + patchPoint.offset(), &*value, sizeof(double));
+    return llvm::Error::success();
+  }
+
+  llvm::Error
+  parseParamMapIntoSignature(llvm::StringRef, llvm::StringRef,
+                             qssc::arguments::Signature &) override {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "not supported");
+  }
+
+  qssc::payload::PatchablePayload *getPayload(llvm::StringRef input,
+                                              bool enableInMemory) override {
+    return new qssc::payload::PatchableZipPayload(input, enableInMemory);
+  }
+
+  llvm::Expected<qssc::arguments::Signature>
+  parseSignature(qssc::payload::PatchablePayload *payload) override {
+    if (static_cast<qssc::payload::PatchableZipPayload *>(payload)
+            ->getBackingZip() == nullptr)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "unable to open payload");
+    auto member = payload->readMember("exp/arguments_signature.bin", false);
+    if (auto err = member.takeError())
+      return std::move(err);
+    return qssc::arguments::Signature::deserialize(
+        llvm::StringRef(member->data(), member->size()), std::nullopt);
+  }
+
+  size_t getPatchSize(PatchPoint const &) const override {
+    return sizeof(double);
+  }
+
+private:
+  std::vector<char> *data;
+};
+
+class DoubleBindArgumentsFactory
+    : public qssc::arguments::BindArgumentsImplementationFactory {
+public:
+  qssc::arguments::BindArgumentsImplementation *
+  create(qssc::OptDiagnosticCallback) override {
+    return new DoubleBindArguments(nullptr);
+  }
+  qssc::arguments::BindArgumentsImplementation *
+  create(std::vector<char> &buf, qssc::OptDiagnosticCallback) override {
+    return new DoubleBindArguments(&buf);
+  }
+  qssc::arguments::BindArgumentsImplementation *
+  create(std::string &, qssc::OptDiagnosticCallback) override {
+    return nullptr;
+  }
+};
+
+class MapArgumentSource : public qssc::arguments::ArgumentSource {
+public:
+  qssc::arguments::ArgumentType
+  getArgumentValue(llvm::StringRef name) const override {
+    auto pos = values.find(name.str());
+    if (pos == values.end())
+      return std::nullopt;
+    return pos->second;
+  }
+
+  std::unordered_map<std::string, double> values;
+};
+
+TEST(ArgumentLayout, AssignsSlotsPerKind) {
+  ArgumentLayout layout;
+  auto theta = layout.addParameter("theta");
+  auto count = layout.addParameter("count", ArgumentKind::Int);
+  auto phi = layout.addParameter("phi");
+
+  EXPECT_EQ(theta.kind, ArgumentKind::Double);
+  EXPECT_EQ(theta.index, 0u);
+  EXPECT_EQ(phi.index, 1u);
+  EXPECT_EQ(count.kind, ArgumentKind::Int);
+  EXPECT_EQ(count.index, 0u);
+
+  // adding a parameter again keeps its slot
+  EXPECT_EQ(layout.addParameter("theta").index, 0u);
+  EXPECT_EQ(layout.getNumParameters(), 3u);
+  EXPECT_EQ(layout.getNumSlots(ArgumentKind::Double), 2u);
+  EXPECT_FALSE(layout.lookup("missing").has_value());
+}
+
+TEST(ColumnarArgumentSource, Values) {
+  ArgumentLayout layout;
+  layout.addParameter("theta");
+  layout.addParameter("count", ArgumentKind::Int);
+  layout.addParameter("quarter", ArgumentKind::Angle);
+
+  std::vector<double> doubles{0.5};
+  std::vector<int64_t> ints{-3};
+  std::vector<uint64_t> angles{uint64_t{1} << 62};
+
+  auto source = ColumnarArgumentSource::create(layout, doubles, ints, angles);
+  ASSERT_TRUE(static_cast<bool>(source));
+  EXPECT_EQ(source->getColumns(), &*source);
+
+  auto getDouble = [&](llvm::StringRef name) {
+    return std::get<std::optional<double>>(source->getArgumentValue(name));
+  };
+  EXPECT_EQ(*getDouble("theta"), 0.5);
+  EXPECT_EQ(*getDouble("count"), -3.0);
+  EXPECT_DOUBLE_EQ(*getDouble("quarter"), llvm::numbers::pi / 2);
+  EXPECT_FALSE(getDouble("missing").has_value());
+
+  // columns are referenced, not copied
+  doubles[0] = 1.5;
+  EXPECT_EQ(source->getDouble(0), 1.5);
+}
+
+TEST(ColumnarArgumentSource, ColumnSizeMismatch) {
+  ArgumentLayout layout;
+  layout.addParameter("theta");
+
+  auto source = ColumnarArgumentSource::create(layout, {});
+  EXPECT_FALSE(static_cast<bool>(source));
+  llvm::consumeError(source.takeError());
+}
+
+TEST(ColumnarArgumentSource, ResolveSlots) {
+  ArgumentLayout layout;
+  layout.addParameter("theta");
+  layout.addParameter("phi");
+
+  std::vector<PatchPoint> const patchPoints{
+      {"phi", "double", 0}, {"other", "double", 8}, {"theta", "double", 16}};
+  auto slots = qssc::arguments::resolveArgumentSlots(patchPoints, layout);
+  ASSERT_EQ(slots.size(), 3u);
+  ASSERT_TRUE(slots[0].has_value());
+  EXPECT_EQ(slots[0]->index, 1u);
+  EXPECT_FALSE(slots[1].has_value());
+  ASSERT_TRUE(slots[2].has_value());
+  EXPECT_EQ(slots[2]->index, 0u);
+}
+
+TEST(ColumnarArgumentSource, ResolveParameterSlots) {
+  ArgumentLayout layout;
+  layout.addParameter("theta");
+  layout.addParameter("phi");
+
+  // patch points of the same parameter slot resolve to the same argument
+  std::vector<PatchPoint> const patchPoints{{"phi", "double", 0, 3},
+                                            {"theta", "double", 8, 7},
+                                            {"phi", "double", 16, 3},
+                                            {"other", "double", 24, 5}};
+  auto slots = qssc::arguments::resolveArgumentSlots(patchPoints, layout);
+  ASSERT_EQ(slots.size(), 4u);
+  ASSERT_TRUE(slots[0].has_value());
+  EXPECT_EQ(slots[0]->index, 1u);
+  ASSERT_TRUE(slots[1].has_value());
+  EXPECT_EQ(slots[1]->index, 0u);
+  ASSERT_TRUE(slots[2].has_value());
+  EXPECT_EQ(slots[2]->index, 1u);
+  EXPECT_FALSE(slots[3].has_value());
+}
+
+std::string createPatchableArchive() {
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  if (!payloadInfoOpt.has_value())
+    return "";
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  if (!payloadOrErr) {
+    llvm::consumeError(payloadOrErr.takeError());
+    return "";
+  }
+  auto &payload = *payloadOrErr.get();
+
+  payload.getFile("controller.bin")->assign(std::string(32, '\0'));
+  payload.getFile("other.bin")->assign("unpatched");
+  qssc::arguments::Signature sig;
+  sig.addParameterPatchPoint("theta", "double", "exp/controller.bin", 0);
+  sig.addParameterPatchPoint("phi", "double", "exp/controller.bin", 8);
+  payload.writeArgumentSignature(std::move(sig));
+
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+  return archive;
+}
+
+TEST(BatchBinder, BindsArgumentSetsConcurrently) {
+  // As a user, I want to link many sets of arguments to a module which is
+  // opened once.
+
+  std::string const archive = createPatchableArchive();
+  ASSERT_FALSE(archive.empty());
+
+  DoubleBindArgumentsFactory factory;
+  auto binder = qssc::arguments::BatchBinder::create(
+      archive, /*enableInMemoryInput=*/true, /*treatWarningsAsErrors=*/true,
+      factory, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(binder));
+  EXPECT_EQ((*binder)->getNumBinaries(), 1u);
+
+  constexpr size_t numSets = 16;
+  std::vector<MapArgumentSource> sources(numSets);
+  std::vector<const qssc::arguments::ArgumentSource *> sourcePtrs;
+  for (size_t i = 0; i < numSets; ++i) {
+    sources[i].values = {{"theta", static_cast<double>(i)},
+                         {"phi", static_cast<double>(2 * i)}};
+    sourcePtrs.push_back(&sources[i]);
+  }
+
+  llvm::ThreadPool threadPool(llvm::hardware_concurrency(4));
+  std::vector<std::string> outputs;
+  ASSERT_FALSE(static_cast<bool>(
+      (*binder)->bind(sourcePtrs, outputs, std::nullopt, &threadPool)));
+  ASSERT_EQ(outputs.size(), numSets);
+
+  for (size_t i = 0; i < numSets; ++i) {
+    qssc::payload::PatchableZipPayload zip(outputs[i],
+                                           /*enableInMemory=*/true);
+    ASSERT_NE(zip.getBackingZip(), nullptr);
+    auto controller = zip.readMember("exp/controller.bin", false);
+    ASSERT_TRUE(static_cast<bool>(controller));
+    double values[2];
+    std::memcpy(values, controller->data(), sizeof(values));
+    EXPECT_EQ(values[0], static_cast<double>(i));
+    EXPECT_EQ(values[1], static_cast<double>(2 * i));
+    auto other = zip.readMember("exp/other.bin", false);
+    ASSERT_TRUE(static_cast<bool>(other));
+    EXPECT_EQ(std::string(other->begin(), other->end()), "unpatched");
+  }
+
+  // a missing argument fails its argument set only, the outputs of the others
+  // are still written
+  sources[3].values.erase("phi");
+  auto err = (*binder)->bind(sourcePtrs, outputs, std::nullopt, &threadPool);
+  EXPECT_TRUE(static_cast<bool>(err));
+  llvm::consumeError(std::move(err));
+  EXPECT_FALSE(outputs[4].empty());
+}
+
+TEST(IncrementalBinder, PatchesChangedArguments) {
+  // As a user, I want successive binds to only patch the arguments that
+  // changed since the previous bind.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  payload.getFile("controller.bin")->assign(std::string(32, '\0'));
+  qssc::arguments::Signature sig;
+  sig.addParameterPatchPoint("theta", "double", "exp/controller.bin", 0);
+  sig.addParameterPatchPoint("phi", "double", "exp/controller.bin", 8);
+  sig.addParameterPatchPoint("theta", "double", "exp/controller.bin", 16);
+  payload.writeArgumentSignature(std::move(sig));
+
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+
+  DoubleBindArgumentsFactory factory;
+  auto binder = qssc::arguments::IncrementalBinder::create(
+      archive, /*enableInMemoryInput=*/true, /*treatWarningsAsErrors=*/true,
+      factory, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(binder));
+
+  MapArgumentSource arguments;
+  arguments.values = {{"theta", 0.5}, {"phi", 1.5}};
+  std::string output;
+  ASSERT_FALSE(static_cast<bool>((*binder)->bind(arguments, &output)));
+  EXPECT_EQ((*binder)->getNumPatched(), 3u);
+
+  arguments.values["phi"] = 2.5;
+  std::vector<qssc::arguments::IncrementalBinder::PatchedRange> changes;
+  ASSERT_FALSE(
+      static_cast<bool>((*binder)->bind(arguments, &output, &changes)));
+  EXPECT_EQ((*binder)->getNumPatched(), 1u);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].binary, "exp/controller.bin");
+  EXPECT_EQ(changes[0].offset, 8u);
+
+  qssc::payload::PatchableZipPayload zip(output, /*enableInMemory=*/true);
+  ASSERT_NE(zip.getBackingZip(), nullptr);
+  auto controller = zip.readMember("exp/controller.bin", false);
+  ASSERT_TRUE(static_cast<bool>(controller));
+  double values[3];
+  std::memcpy(values, controller->data(), sizeof(values));
+  EXPECT_EQ(values[0], 0.5);
+  EXPECT_EQ(values[1], 2.5);
+  EXPECT_EQ(values[2], 0.5);
+}
+
+} // anonymous namespace
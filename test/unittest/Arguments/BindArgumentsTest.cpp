@@ -0,0 +1,204 @@
+//===- BindArgumentsTest.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for binding arguments to the binaries of
+/// a payload concurrently.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/Signature.h"
+#include "Payload/PatchableZipPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstring>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using qssc::arguments::PatchPoint;
+
+// Patches the arguments as doubles into a binary
+class DoublePatcher : public qssc::arguments::BindArgumentsImplementation {
+public:
+  explicit DoublePatcher(std::vector<char> *data) : data(data) {}
+
+  llvm::Error patch(PatchPoint const &patchPoint,
+                    qssc::arguments::ArgumentSource const &arguments) override {
+    auto value = std::get<std::optional<double>>(
+        arguments.getArgumentValue(patchPoint.expression()));
+    if (!value)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "missing argument " +
+                                         patchPoint.expression());
+    std::memcpy(data->data() + patchPoint.offset(), &*value, sizeof(double));
+    return llvm::Error::success();
+  }
+
+  llvm::Error
+  parseParamMapIntoSignature(llvm::StringRef, llvm::StringRef,
+                             qssc::arguments::Signature &) override {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "not supported");
+  }
+
+  qssc::payload::PatchablePayload *getPayload(llvm::StringRef input,
+                                              bool enableInMemory) override {
+    return new qssc::payload::PatchableZipPayload(input, enableInMemory);
+  }
+
+  llvm::Expected<qssc::arguments::Signature>
+  parseSignature(qssc::payload::PatchablePayload *payload) override {
+    if (static_cast<qssc::payload::PatchableZipPayload *>(payload)
+            ->getBackingZip() == nullptr)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "unable to open payload");
+    auto member = payload->readMember("exp/arguments_signature.bin", false);
+    if (auto err = member.takeError())
+      return std::move(err);
+    return qssc::arguments::Signature::deserialize(
+        llvm::StringRef(member->data(), member->size()), std::nullopt);
+  }
+
+private:
+  std::vector<char> *data;
+};
+
+class DoublePatcherFactory
+    : public qssc::arguments::BindArgumentsImplementationFactory {
+public:
+  qssc::arguments::BindArgumentsImplementation *
+  create(qssc::OptDiagnosticCallback) override {
+    return new DoublePatcher(nullptr);
+  }
+  qssc::arguments::BindArgumentsImplementation *
+  create(std::vector<char> &buf, qssc::OptDiagnosticCallback) override {
+    return new DoublePatcher(&buf);
+  }
+  qssc::arguments::BindArgumentsImplementation *
+  create(std::string &, qssc::OptDiagnosticCallback) override {
+    return nullptr;
+  }
+};
+
+class MapArgumentSource : public qssc::arguments::ArgumentSource {
+public:
+  qssc::arguments::ArgumentType
+  getArgumentValue(llvm::StringRef name) const override {
+    auto pos = values.find(name.str());
+    if (pos == values.end())
+      return std::nullopt;
+    return pos->second;
+  }
+
+  std::unordered_map<std::string, double> values;
+};
+
+// a payload of numBinaries binaries, the i-th patched with argument "p<i>"
+std::string createPayload(unsigned numBinaries) {
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  EXPECT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  EXPECT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  qssc::arguments::Signature sig;
+  for (unsigned i = 0; i < numBinaries; ++i) {
+    std::string const name = "binary" + std::to_string(i) + ".bin";
+    payload.getFile(name)->assign(std::string(16, '\0'));
+    sig.addParameterPatchPoint("p" + std::to_string(i), "double",
+                               "exp/" + name, 8);
+  }
+  payload.writeArgumentSignature(std::move(sig));
+
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+  return archive;
+}
+
+TEST(BindArguments, PatchesBinariesConcurrently) {
+  // As a user, I want the binaries of a payload to be patched in parallel.
+
+  constexpr unsigned numBinaries = 8;
+  std::string const archive = createPayload(numBinaries);
+
+  MapArgumentSource arguments;
+  for (unsigned i = 0; i < numBinaries; ++i)
+    arguments.values["p" + std::to_string(i)] = 0.5 + i;
+
+  llvm::ThreadPool threadPool(llvm::hardware_concurrency(4));
+  DoublePatcherFactory factory;
+  std::vector<std::string> outputs;
+  ASSERT_FALSE(static_cast<bool>(qssc::arguments::bindArgumentsBatch(
+      archive, /*enableInMemoryInput=*/true, {&arguments},
+      /*treatWarningsAsErrors=*/true, outputs, factory, std::nullopt,
+      &threadPool)));
+  ASSERT_EQ(outputs.size(), 1u);
+
+  qssc::payload::PatchableZipPayload zip(outputs[0], /*enableInMemory=*/true);
+  ASSERT_NE(zip.getBackingZip(), nullptr);
+  for (unsigned i = 0; i < numBinaries; ++i) {
+    auto binary =
+        zip.readMember("exp/binary" + std::to_string(i) + ".bin", false);
+    ASSERT_TRUE(static_cast<bool>(binary));
+    double value = 0;
+    std::memcpy(&value, binary->data() + 8, sizeof(double));
+    EXPECT_EQ(value, 0.5 + i);
+  }
+}
+
+TEST(BindArguments, ReportsFailureOfOneConcurrentBinary) {
+  // As a user, I want the failure to patch one of the binaries patched in
+  // parallel to be reported rather than lost.
+
+  constexpr unsigned numBinaries = 8;
+  std::string const archive = createPayload(numBinaries);
+
+  MapArgumentSource arguments;
+  for (unsigned i = 0; i < numBinaries; ++i)
+    if (i != 5)
+      arguments.values["p" + std::to_string(i)] = 0.5 + i;
+
+  llvm::ThreadPool threadPool(llvm::hardware_concurrency(4));
+  DoublePatcherFactory factory;
+  std::vector<std::string> outputs;
+  auto err = qssc::arguments::bindArgumentsBatch(
+      archive, /*enableInMemoryInput=*/true, {&arguments},
+      /*treatWarningsAsErrors=*/true, outputs, factory, std::nullopt,
+      &threadPool);
+  ASSERT_TRUE(static_cast<bool>(err));
+  EXPECT_EQ(llvm::toString(std::move(err)), "missing argument p5");
+}
+
+} // anonymous namespace
@@ -0,0 +1,173 @@
+//===- SignatureTest.cpp ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the argument Signature.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Signature.h"
+
+#include "llvm/Support/Error.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace {
+
+using qssc::arguments::Signature;
+using qssc::arguments::SignatureView;
+
+Signature makeSignature() {
+  Signature sig;
+  sig.addParameterPatchPoint("theta", "double", "controller0.bin", 16, 0);
+  sig.addParameterPatchPoint("phi", "double", "controller0.bin", 32, 1);
+  sig.addParameterPatchPoint("theta", "double", "controller1.bin", 8, 0);
+  sig.addParameterPatchPoint("theta + phi", "double", "controller1.bin", 24);
+  return sig;
+}
+
+void expectEqual(const Signature &expected, const Signature &actual) {
+  ASSERT_EQ(expected.patchPointsByBinary.size(),
+            actual.patchPointsByBinary.size());
+  for (auto const &[binaryName, patchPoints] : expected.patchPointsByBinary) {
+    auto it = actual.patchPointsByBinary.find(binaryName);
+    ASSERT_NE(it, actual.patchPointsByBinary.end());
+    ASSERT_EQ(patchPoints.size(), it->second.size());
+    for (size_t i = 0; i < patchPoints.size(); ++i) {
+      EXPECT_EQ(patchPoints[i].expression(), it->second[i].expression());
+      EXPECT_EQ(patchPoints[i].patchType(), it->second[i].patchType());
+      EXPECT_EQ(patchPoints[i].offset(), it->second[i].offset());
+      EXPECT_EQ(patchPoints[i].parameterSlot(),
+                it->second[i].parameterSlot());
+    }
+  }
+}
+
+TEST(Signature, TextRoundTrip) {
+  auto sig = makeSignature();
+  auto text = sig.serialize();
+  EXPECT_FALSE(SignatureView::isBinarySignature(text));
+
+  auto deserialized = Signature::deserialize(text, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(deserialized));
+  expectEqual(sig, *deserialized);
+}
+
+TEST(Signature, TextVersion1) {
+  // signatures without parameter slots remain readable
+  auto deserialized = Signature::deserialize("circuit_signature\n"
+                                             "version 1\n"
+                                             "num_binaries: 1\n"
+                                             "binary: controller0.bin\n"
+                                             "num_patchpoints: 1\n"
+                                             "double 16 theta + phi\n",
+                                             std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(deserialized));
+  auto const &patchPoints =
+      deserialized->patchPointsByBinary.at("controller0.bin");
+  ASSERT_EQ(patchPoints.size(), 1u);
+  EXPECT_EQ(patchPoints[0].expression(), "theta + phi");
+  EXPECT_EQ(patchPoints[0].offset(), 16u);
+  EXPECT_FALSE(patchPoints[0].parameterSlot().has_value());
+}
+
+TEST(Signature, BinaryRoundTrip) {
+  auto sig = makeSignature();
+  auto binary = sig.serializeBinary();
+  EXPECT_TRUE(SignatureView::isBinarySignature(binary));
+
+  auto deserialized = Signature::deserialize(binary, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(deserialized));
+  expectEqual(sig, *deserialized);
+}
+
+TEST(Signature, BinaryView) {
+  // As a target developer, I want to read the patch points of a binary
+  // signature in place without deserializing it.
+  auto binary = makeSignature().serializeBinary();
+
+  auto view = SignatureView::create(binary, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(view));
+  ASSERT_EQ(view->getNumBinaries(), 2u);
+  EXPECT_EQ(view->getNumPatchPoints(), 4u);
+  EXPECT_EQ(view->getBinaryName(0), "controller0.bin");
+  EXPECT_EQ(view->getBinaryName(1), "controller1.bin");
+
+  auto patchPoints = view->getPatchPoints(0);
+  ASSERT_EQ(patchPoints.size(), 2u);
+  auto phi = view->getPatchPoint(patchPoints[1]);
+  EXPECT_EQ(phi.expression(), "phi");
+  EXPECT_EQ(phi.patchType(), "double");
+  EXPECT_EQ(phi.offset(), 32u);
+  EXPECT_EQ(phi.parameterSlot(), 1u);
+
+  // strings are stored once
+  EXPECT_EQ(patchPoints[0].expressionId,
+            view->getPatchPoints(1)[0].expressionId);
+  EXPECT_FALSE(
+      view->getPatchPoint(view->getPatchPoints(1)[1]).parameterSlot());
+}
+
+TEST(Signature, InternsStrings) {
+  auto sig = makeSignature();
+  auto controller0 = sig.patchPointsByBinary.find("controller0.bin");
+  auto controller1 = sig.patchPointsByBinary.find("controller1.bin");
+  ASSERT_NE(controller0, sig.patchPointsByBinary.end());
+  ASSERT_NE(controller1, sig.patchPointsByBinary.end());
+
+  // both theta patch points refer to the same string
+  EXPECT_EQ(controller0->second[0].expression().data(),
+            controller1->second[0].expression().data());
+  EXPECT_EQ(controller0->second[0].patchType().data(),
+            controller0->second[1].patchType().data());
+}
+
+TEST(Signature, MovePreservesPatchPoints) {
+  auto expected = makeSignature();
+  auto source = makeSignature();
+  Signature moved(std::move(source));
+  expectEqual(expected, moved);
+
+  Signature assigned;
+  assigned = std::move(moved);
+  expectEqual(expected, assigned);
+
+  // the moved-from signatures are empty and remain usable
+  // NOLINTBEGIN(bugprone-use-after-move)
+  EXPECT_TRUE(source.isEmpty());
+  EXPECT_TRUE(moved.isEmpty());
+  moved.addParameterPatchPoint("phi", "double", "controller2.bin", 8);
+  auto controller2 = moved.patchPointsByBinary.find("controller2.bin");
+  ASSERT_NE(controller2, moved.patchPointsByBinary.end());
+  ASSERT_EQ(controller2->second.size(), 1u);
+  EXPECT_EQ(controller2->second[0].expression(), "phi");
+  // NOLINTEND(bugprone-use-after-move)
+  expectEqual(expected, assigned);
+}
+
+TEST(Signature, TruncatedBinaryView) {
+  auto binary = makeSignature().serializeBinary();
+  binary.pop_back();
+
+  auto view = SignatureView::create(binary, std::nullopt);
+  EXPECT_FALSE(static_cast<bool>(view));
+  llvm::consumeError(view.takeError());
+}
+
+} // anonymous namespace
@@ -0,0 +1,172 @@
+//===- PulseCalsCacheTest.cpp -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the pulse calibrations cache.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
+#include "Dialect/Pulse/IR/PulseDialect.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+class PulseCalsCacheTest : public ::testing::Test {
+protected:
+  mlir::MLIRContext ctx;
+  llvm::SmallString<128> path;
+
+  PulseCalsCacheTest() {
+    mlir::DialectRegistry registry;
+    registry.insert<mlir::pulse::PulseDialect>();
+    ctx.appendDialectRegistry(registry);
+    ctx.loadAllAvailableDialects();
+    mlir::pulse::PulseCalsCache::get().clear();
+  }
+
+  void SetUp() override {
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("cals", "mlir", path));
+  }
+
+  void TearDown() override { llvm::sys::fs::remove(path); }
+
+  static std::string getCals(llvm::StringRef sequenceName) {
+    return ("pulse.sequence @" + sequenceName +
+            "(%arg0: !pulse.mixed_frame) {\n  pulse.return\n}\n")
+        .str();
+  }
+
+  void writeCals(llvm::StringRef sequenceName) {
+    std::error_code ec;
+    llvm::raw_fd_ostream cals(path, ec);
+    ASSERT_FALSE(ec);
+    cals << getCals(sequenceName);
+  }
+
+  void writeBytecodeCals(llvm::StringRef sequenceName) {
+    mlir::OwningOpRef<mlir::ModuleOp> module =
+        mlir::parseSourceString<mlir::ModuleOp>(getCals(sequenceName), &ctx);
+    ASSERT_TRUE(static_cast<bool>(module));
+    std::error_code ec;
+    llvm::raw_fd_ostream cals(path, ec);
+    ASSERT_FALSE(ec);
+    ASSERT_TRUE(mlir::succeeded(mlir::writeBytecodeToFile(*module, cals)));
+  }
+
+  std::vector<std::string> loadSequenceNames() {
+    std::vector<std::string> names;
+    auto moduleOrError = mlir::pulse::PulseCalsCache::get().load(path, &ctx);
+    EXPECT_TRUE(static_cast<bool>(moduleOrError));
+    if (!moduleOrError) {
+      llvm::consumeError(moduleOrError.takeError());
+      return names;
+    }
+    for (auto sequenceOp :
+         moduleOrError->get().getOps<mlir::pulse::SequenceOp>())
+      names.push_back(sequenceOp.getSymName().str());
+    return names;
+  }
+};
+
+TEST_F(PulseCalsCacheTest, ReusesParsedCalibrations) {
+  writeCals("x0");
+
+  EXPECT_EQ(loadSequenceNames(), std::vector<std::string>{"x0"});
+  EXPECT_EQ(loadSequenceNames(), std::vector<std::string>{"x0"});
+
+  auto statistics = mlir::pulse::PulseCalsCache::get().getStatistics();
+  EXPECT_EQ(statistics.misses, 1u);
+  EXPECT_EQ(statistics.hits, 1u);
+}
+
+TEST_F(PulseCalsCacheTest, ReturnsIndependentModules) {
+  writeCals("x0");
+
+  {
+    auto moduleOrError = mlir::pulse::PulseCalsCache::get().load(path, &ctx);
+    ASSERT_TRUE(static_cast<bool>(moduleOrError));
+    for (auto sequenceOp : llvm::make_early_inc_range(
+             moduleOrError->get().getOps<mlir::pulse::SequenceOp>()))
+      sequenceOp->erase();
+  }
+
+  EXPECT_EQ(loadSequenceNames(), std::vector<std::string>{"x0"});
+}
+
+TEST_F(PulseCalsCacheTest, ReloadsChangedCalibrations) {
+  writeCals("x0");
+  EXPECT_EQ(loadSequenceNames(), std::vector<std::string>{"x0"});
+
+  // the same size and, possibly, the same modification time
+  writeCals("x1");
+  EXPECT_EQ(loadSequenceNames(), std::vector<std::string>{"x1"});
+
+  auto statistics = mlir::pulse::PulseCalsCache::get().getStatistics();
+  EXPECT_EQ(statistics.misses, 2u);
+  EXPECT_EQ(statistics.hits, 0u);
+}
+
+TEST_F(PulseCalsCacheTest, LoadsBytecodeLazily) {
+  writeBytecodeCals("x0");
+
+  auto moduleOrError =
+      mlir::pulse::PulseCalsCache::get().load(path, &ctx, /*lazy=*/true);
+  ASSERT_TRUE(static_cast<bool>(moduleOrError));
+  auto sequenceOps = moduleOrError->get().getOps<mlir::pulse::SequenceOp>();
+  ASSERT_FALSE(sequenceOps.empty());
+  auto sequenceOp = *sequenceOps.begin();
+  EXPECT_EQ(sequenceOp.getSymName(), "x0");
+  EXPECT_TRUE(sequenceOp.getBody().empty());
+
+  ASSERT_TRUE(mlir::succeeded(moduleOrError->materialize(sequenceOp)));
+  EXPECT_FALSE(sequenceOp.getBody().empty());
+  // materializing again is a no-op
+  EXPECT_TRUE(mlir::succeeded(moduleOrError->materialize(sequenceOp)));
+
+  EXPECT_EQ(loadSequenceNames(), std::vector<std::string>{"x0"});
+}
+
+TEST_F(PulseCalsCacheTest, ReportsMissingFiles) {
+  llvm::sys::fs::remove(path);
+
+  auto moduleOrError = mlir::pulse::PulseCalsCache::get().load(path, &ctx);
+  ASSERT_FALSE(static_cast<bool>(moduleOrError));
+  EXPECT_NE(llvm::toString(moduleOrError.takeError())
+                .find("Failed to open pulse calibrations file"),
+            std::string::npos);
+}
+
+} // anonymous namespace
@@ -0,0 +1,205 @@
+//===- WaveformLibraryTest.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the waveform library format.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Conversion/QUIRToPulse/WaveformLibrary.h"
+#include "Dialect/Pulse/IR/PulseDialect.h"
+#include "Dialect/Pulse/Utils/WaveformSampling.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <complex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using mlir::pulse::WaveformLibraryView;
+
+std::vector<double> getSamples(const WaveformLibraryView &view,
+                               llvm::StringRef name) {
+  auto index = view.find(name);
+  EXPECT_TRUE(index.has_value());
+  if (!index)
+    return {};
+  llvm::SmallVector<double> samples;
+  view.getSamples(*index, samples);
+  return {samples.begin(), samples.end()};
+}
+
+TEST(WaveformLibraryTest, RoundTripsWaveforms) {
+  std::vector<double> const x90 = {0.0, 0.5, 0.5, 0.5};
+  std::vector<double> const drag = {0.1, 0.2, 0.3, 0.4, 0.5, 0.6};
+  std::vector<std::pair<llvm::StringRef, llvm::ArrayRef<double>>> const
+      waveforms = {{"x90", x90}, {"drag", drag}, {"empty", {}}};
+
+  std::string buffer;
+  llvm::raw_string_ostream os(buffer);
+  mlir::pulse::writeWaveformLibrary(waveforms, os);
+  os.flush();
+
+  ASSERT_TRUE(WaveformLibraryView::isWaveformLibrary(buffer));
+  auto viewOrError = WaveformLibraryView::create(buffer);
+  ASSERT_TRUE(static_cast<bool>(viewOrError))
+      << llvm::toString(viewOrError.takeError());
+
+  EXPECT_EQ(viewOrError->size(), 3u);
+  EXPECT_EQ(getSamples(*viewOrError, "x90"), x90);
+  EXPECT_EQ(getSamples(*viewOrError, "drag"), drag);
+  EXPECT_EQ(getSamples(*viewOrError, "empty"), std::vector<double>{});
+  EXPECT_FALSE(viewOrError->find("y90").has_value());
+
+  auto index = viewOrError->find("drag");
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(viewOrError->getName(*index), "drag");
+  EXPECT_EQ(viewOrError->getNumSamples(*index), 3u);
+  EXPECT_EQ(viewOrError->getSampleBytes(*index).size(),
+            drag.size() * sizeof(double));
+}
+
+TEST(WaveformLibraryTest, WritesWaveformContainers) {
+  mlir::MLIRContext ctx;
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::pulse::PulseDialect>();
+  ctx.appendDialectRegistry(registry);
+  ctx.loadAllAvailableDialects();
+
+  mlir::OwningOpRef<mlir::ModuleOp> module =
+      mlir::parseSourceString<mlir::ModuleOp>(
+          "pulse.waveform_container {\n"
+          "  %0 = pulse.create_waveform {pulse.waveformName = \"x90\"} "
+          "dense<[[0.0, 0.5], [0.5, 0.5]]> : tensor<2x2xf64> -> "
+          "!pulse.waveform\n"
+          "  %1 = pulse.create_waveform {pulse.waveformName = \"x\"} "
+          "dense<[[1.0, 0.0]]> : tensor<1x2xf64> -> !pulse.waveform\n"
+          "}\n",
+          &ctx);
+  ASSERT_TRUE(static_cast<bool>(module));
+
+  std::string buffer;
+  llvm::raw_string_ostream os(buffer);
+  ASSERT_FALSE(static_cast<bool>(
+      mlir::pulse::writeWaveformLibrary(module->getOperation(), os)));
+  os.flush();
+
+  auto viewOrError = WaveformLibraryView::create(buffer);
+  ASSERT_TRUE(static_cast<bool>(viewOrError))
+      << llvm::toString(viewOrError.takeError());
+  EXPECT_EQ(viewOrError->size(), 2u);
+  EXPECT_EQ(getSamples(*viewOrError, "x90"),
+            (std::vector<double>{0.0, 0.5, 0.5, 0.5}));
+  EXPECT_EQ(getSamples(*viewOrError, "x"), (std::vector<double>{1.0, 0.0}));
+}
+
+TEST(WaveformLibraryTest, CompactsConstantRegions) {
+  // As a target developer, I want flat tops stored as a single sample, such
+  // that long pulses do not inflate the payload.
+  std::complex<double> const amp(0.25, -0.5);
+  llvm::SmallVector<double> samples;
+  mlir::pulse::sampleGaussianSquare(1000, amp, 16., 800., samples);
+
+  mlir::pulse::CompactWaveform compact;
+  mlir::pulse::compactGaussianSquare(1000, amp, 16., 800., compact);
+  ASSERT_EQ(compact.segments.size(), 3u);
+  EXPECT_TRUE(compact.segments[1].constant);
+  EXPECT_EQ(compact.segments[1].value, amp);
+  EXPECT_EQ(compact.getNumSamples(), 1000);
+  llvm::SmallVector<double> expanded;
+  compact.expand(expanded);
+  EXPECT_EQ(expanded, samples);
+
+  mlir::pulse::CompactWaveform runLengthEncoded;
+  mlir::pulse::compactWaveformSamples(samples, 8, runLengthEncoded);
+  EXPECT_EQ(runLengthEncoded.getNumSamples(), 1000);
+  EXPECT_LT(runLengthEncoded.samples.size(), samples.size());
+  runLengthEncoded.expand(expanded);
+  EXPECT_EQ(expanded, samples);
+
+  std::vector<double> const drag = {0.0, 0.5, 0.5, 0.5};
+  std::string expandedBuffer;
+  llvm::raw_string_ostream expandedOs(expandedBuffer);
+  mlir::pulse::writeWaveformLibrary({{"gs", samples}, {"drag", drag}},
+                                    expandedOs);
+  expandedOs.flush();
+  std::string buffer;
+  llvm::raw_string_ostream os(buffer);
+  mlir::pulse::writeWaveformLibrary({{"gs", samples}, {"drag", drag}}, os,
+                                    mlir::pulse::WaveformEncoding::Compact);
+  os.flush();
+  EXPECT_LT(buffer.size(), expandedBuffer.size() / 4);
+
+  auto viewOrError = WaveformLibraryView::create(buffer);
+  ASSERT_TRUE(static_cast<bool>(viewOrError))
+      << llvm::toString(viewOrError.takeError());
+  auto index = viewOrError->find("gs");
+  ASSERT_TRUE(index.has_value());
+  EXPECT_TRUE(viewOrError->isCompact(*index));
+  EXPECT_EQ(viewOrError->getNumSamples(*index), 1000u);
+  EXPECT_FALSE(viewOrError->getSamples(*index).has_value());
+  EXPECT_EQ(getSamples(*viewOrError, "gs"),
+            std::vector<double>(samples.begin(), samples.end()));
+  // waveforms without long runs are stored expanded
+  index = viewOrError->find("drag");
+  ASSERT_TRUE(index.has_value());
+  EXPECT_FALSE(viewOrError->isCompact(*index));
+  EXPECT_EQ(getSamples(*viewOrError, "drag"), drag);
+
+  // the sampled segments of the last waveform exceeding the buffer must be
+  // caught
+  auto truncated =
+      WaveformLibraryView::create(llvm::StringRef(buffer).drop_back(8));
+  ASSERT_FALSE(static_cast<bool>(truncated));
+  llvm::consumeError(truncated.takeError());
+}
+
+TEST(WaveformLibraryTest, RejectsInvalidLibraries) {
+  EXPECT_FALSE(WaveformLibraryView::isWaveformLibrary("pulse.sequence"));
+
+  std::vector<double> const x90 = {0.0, 0.5, 0.5, 0.5};
+  std::string buffer;
+  llvm::raw_string_ostream os(buffer);
+  mlir::pulse::writeWaveformLibrary({{"x90", x90}}, os);
+  os.flush();
+
+  // truncating the samples must be caught when the view is created
+  auto viewOrError =
+      WaveformLibraryView::create(llvm::StringRef(buffer).drop_back(1));
+  ASSERT_FALSE(static_cast<bool>(viewOrError));
+  llvm::consumeError(viewOrError.takeError());
+
+  viewOrError = WaveformLibraryView::create(
+      llvm::StringRef(buffer).take_front(sizeof(WaveformLibraryView::Header)));
+  ASSERT_FALSE(static_cast<bool>(viewOrError));
+  llvm::consumeError(viewOrError.takeError());
+}
+
+} // anonymous namespace
@@ -0,0 +1,124 @@
+//===- QUIRCircuitAnalysisTest.cpp ------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for invalidating the QUIR circuit
+/// analysis.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/QCS/IR/QCSDialect.h"
+#include "Dialect/QUIR/IR/QUIRDialect.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Transforms/QUIRCircuitAnalysis.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/AnalysisManager.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <tuple>
+
+namespace {
+
+using mlir::quir::CallCircuitOp;
+using mlir::quir::CircuitOp;
+using mlir::quir::ConstantOp;
+using mlir::quir::QUIRCircuitAnalysis;
+
+constexpr llvm::StringRef circuits = R"(
+  quir.circuit @circuit_0(%arg0: !quir.angle<64>) {
+    quir.return
+  }
+  func.func @main() {
+    %0 = quir.constant #quir.angle<5.000000e-01> : !quir.angle<64>
+    %1 = quir.constant #quir.angle<1.500000e+00> : !quir.angle<64>
+    quir.call_circuit @circuit_0(%0) : (!quir.angle<64>) -> ()
+    return
+  }
+)";
+
+class QUIRCircuitAnalysisTest : public ::testing::Test {
+protected:
+  mlir::MLIRContext ctx;
+  mlir::OwningOpRef<mlir::ModuleOp> module;
+  CallCircuitOp call;
+  llvm::SmallVector<ConstantOp> constants;
+
+  QUIRCircuitAnalysisTest() {
+    mlir::DialectRegistry registry;
+    registry.insert<mlir::quir::QUIRDialect, mlir::qcs::QCSDialect,
+                    mlir::func::FuncDialect>();
+    ctx.appendDialectRegistry(registry);
+    ctx.loadAllAvailableDialects();
+
+    module = mlir::parseSourceString<mlir::ModuleOp>(circuits, &ctx);
+    module->walk([&](CallCircuitOp callOp) { call = callOp; });
+    module->walk(
+        [&](ConstantOp constantOp) { constants.push_back(constantOp); });
+  }
+
+  double getAngle(QUIRCircuitAnalysis &analysis) {
+    auto circuitOp = module->lookupSymbol<CircuitOp>("circuit_0");
+    return std::get<mlir::quir::QUIRCircuitAnalysisEntry::ANGLE>(
+        analysis.getCircuitOperands(circuitOp).lookup(0));
+  }
+};
+
+TEST_F(QUIRCircuitAnalysisTest, InvalidatedUnlessPreserved) {
+  ASSERT_TRUE(static_cast<bool>(module));
+  mlir::ModuleAnalysisManager mam(module->getOperation(),
+                                  /*passInstrumentor=*/nullptr);
+  mlir::AnalysisManager am = mam;
+
+  EXPECT_EQ(getAngle(am.getAnalysis<QUIRCircuitAnalysis>()), 0.5);
+
+  // a pass preserving the analysis keeps the cached entries
+  call->setOperand(0, constants[1]);
+  mlir::AnalysisManager::PreservedAnalyses preserved;
+  preserved.preserve<QUIRCircuitAnalysis>();
+  am.invalidate(preserved);
+  ASSERT_TRUE(am.getCachedAnalysis<QUIRCircuitAnalysis>().has_value());
+  EXPECT_EQ(getAngle(am.getAnalysis<QUIRCircuitAnalysis>()), 0.5);
+
+  // any other pass invalidates it
+  am.invalidate(mlir::AnalysisManager::PreservedAnalyses());
+  EXPECT_FALSE(am.getCachedAnalysis<QUIRCircuitAnalysis>().has_value());
+  EXPECT_EQ(getAngle(am.getAnalysis<QUIRCircuitAnalysis>()), 1.5);
+}
+
+TEST_F(QUIRCircuitAnalysisTest, RecomputesInvalidatedCircuits) {
+  ASSERT_TRUE(static_cast<bool>(module));
+  mlir::ModuleAnalysisManager mam(module->getOperation(),
+                                  /*passInstrumentor=*/nullptr);
+  mlir::AnalysisManager am = mam;
+
+  auto &analysis = am.getAnalysis<QUIRCircuitAnalysis>();
+  EXPECT_EQ(getAngle(analysis), 0.5);
+
+  call->setOperand(0, constants[1]);
+  analysis.invalidateCircuit(module->lookupSymbol<CircuitOp>("circuit_0"));
+  EXPECT_EQ(getAngle(analysis), 1.5);
+}
+
+} // anonymous namespace
@@ -0,0 +1,130 @@
+//===- RuntimeEstimateTest.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the runtime estimate of scheduled
+/// programs.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/Pulse/IR/PulseDialect.h"
+#include "Dialect/Pulse/Utils/RuntimeEstimate.h"
+#include "Dialect/QCS/IR/QCSDialect.h"
+#include "Dialect/QUIR/IR/QUIRDialect.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <optional>
+
+namespace {
+
+constexpr llvm::StringRef scheduledProgram = R"(
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1>) {
+    quir.return
+  }
+  func.func @main() -> i32 {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c1000 = arith.constant 1000 : index
+    scf.for %arg0 = %c0 to %c1000 step %c1 {
+      %0 = quir.constant #quir.duration<1.0> : !quir.duration<ms>
+      quir.delay %0, () : !quir.duration<ms>, () -> ()
+      qcs.shot_init {qcs.num_shots = 1000 : i32}
+      %1 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+      %c2 = arith.constant 2 : index
+      scf.for %arg1 = %c0 to %c2 step %c1 {
+        quir.call_circuit @circuit_0(%1) {pulse.duration = 250 : i64} : (!quir.qubit<1>) -> ()
+      }
+    } {qcs.shot_loop}
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+)";
+
+constexpr llvm::StringRef unscheduledProgram = R"(
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1>) {
+    quir.return
+  }
+  func.func @main() -> i32 {
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    quir.call_circuit @circuit_0(%0) : (!quir.qubit<1>) -> ()
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+)";
+
+class RuntimeEstimateTest : public ::testing::Test {
+protected:
+  mlir::MLIRContext ctx;
+
+  RuntimeEstimateTest() {
+    mlir::DialectRegistry registry;
+    registry.insert<mlir::arith::ArithDialect, mlir::func::FuncDialect,
+                    mlir::pulse::PulseDialect, mlir::qcs::QCSDialect,
+                    mlir::quir::QUIRDialect, mlir::scf::SCFDialect>();
+    ctx.appendDialectRegistry(registry);
+    ctx.loadAllAvailableDialects();
+  }
+
+  mlir::OwningOpRef<mlir::ModuleOp> parse(llvm::StringRef source) {
+    return mlir::parseSourceString<mlir::ModuleOp>(source, &ctx);
+  }
+};
+
+TEST_F(RuntimeEstimateTest, EstimatesShotLoop) {
+  auto module = parse(scheduledProgram);
+  ASSERT_TRUE(static_cast<bool>(module));
+
+  auto estimate = mlir::pulse::estimateRuntime(*module, /*dtTimestep=*/1e-9);
+  ASSERT_TRUE(static_cast<bool>(estimate))
+      << llvm::toString(estimate.takeError());
+  // the shot delay and two scheduled calls of 250 samples each
+  EXPECT_EQ(estimate->numShots, 1000u);
+  EXPECT_DOUBLE_EQ(estimate->shotSeconds, 1e-3 + 500e-9);
+  EXPECT_DOUBLE_EQ(estimate->jobSeconds, 1000 * (1e-3 + 500e-9));
+}
+
+TEST_F(RuntimeEstimateTest, RequiresTimestep) {
+  auto module = parse(scheduledProgram);
+  ASSERT_TRUE(static_cast<bool>(module));
+
+  auto estimate = mlir::pulse::estimateRuntime(*module, std::nullopt);
+  EXPECT_FALSE(static_cast<bool>(estimate));
+  llvm::consumeError(estimate.takeError());
+}
+
+TEST_F(RuntimeEstimateTest, RequiresSchedule) {
+  auto module = parse(unscheduledProgram);
+  ASSERT_TRUE(static_cast<bool>(module));
+
+  auto estimate = mlir::pulse::estimateRuntime(*module, /*dtTimestep=*/1e-9);
+  EXPECT_FALSE(static_cast<bool>(estimate));
+  llvm::consumeError(estimate.takeError());
+}
+
+} // anonymous namespace
@@ -0,0 +1,93 @@
+//===- IRDumpWriterTest.cpp -------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the IRDumpWriter.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/Compile/IRDumpWriter.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace qssc::hal::compile;
+
+TEST(IRDumpWriter, WritesStreamDumpsInOrder) {
+  std::string output;
+  llvm::raw_string_ostream outputStream(output);
+  IRDumpWriter writer;
+
+  // each thread queues its dumps in order, the threads interleave
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; ++thread)
+    threads.emplace_back([&, thread]() {
+      for (int dump = 0; dump < 8; ++dump)
+        writer.write(
+            std::to_string(thread) + ":" + std::to_string(dump) + "\n",
+            outputStream);
+    });
+  for (auto &thread : threads)
+    thread.join();
+  writer.flush();
+
+  std::vector<int> nextDump(4, 0);
+  llvm::StringRef remaining(output);
+  size_t numDumps = 0;
+  while (!remaining.empty()) {
+    auto [line, rest] = remaining.split('\n');
+    remaining = rest;
+    auto [thread, dump] = line.split(':');
+    int const threadIndex = std::stoi(thread.str());
+    EXPECT_EQ(std::stoi(dump.str()), nextDump[threadIndex]++);
+    ++numDumps;
+  }
+  EXPECT_EQ(numDumps, 32u);
+}
+
+TEST(IRDumpWriter, WritesFileDumps) {
+  llvm::SmallString<128> directory;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("ir-dumps", directory));
+  llvm::SmallString<128> path(directory);
+  llvm::sys::path::append(path, "nested", "target.after-passes.mlir");
+
+  {
+    IRDumpWriter writer;
+    writer.write("first", std::string(path));
+    writer.write("module {}", std::string(path));
+    // the destructor writes the queued dumps
+  }
+
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  ASSERT_TRUE(static_cast<bool>(buffer));
+  EXPECT_EQ((*buffer)->getBuffer(), "module {}");
+
+  llvm::sys::fs::remove_directories(directory);
+}
+
+} // anonymous namespace
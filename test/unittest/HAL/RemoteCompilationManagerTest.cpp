@@ -0,0 +1,174 @@
+//===- RemoteCompilationManagerTest.cpp -------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the RemoteCompilationManager.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/Compile/RemoteCompilationManager.h"
+#include "HAL/TargetSystem.h"
+#include "Payload/Payload.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace qssc::hal::compile;
+
+class TestPayload : public qssc::payload::Payload {
+public:
+  TestPayload()
+      : Payload(qssc::payload::PayloadConfig{
+            "exp", "exp", qssc::config::QSSVerbosity::Error}) {}
+
+  void write(llvm::raw_ostream &stream) override {}
+  void write(std::ostream &stream) override {}
+  void writePlain(std::ostream &stream) override {}
+  void writePlain(llvm::raw_ostream &stream) override {}
+  void addFile(llvm::StringRef filename, llvm::StringRef str) override {
+    storeFile(filename, str.str());
+  }
+};
+
+class TestInstrument : public qssc::hal::TargetInstrument {
+public:
+  TestInstrument(std::string name, Target *parent, uint32_t nodeId)
+      : TargetInstrument(std::move(name), parent), nodeId(nodeId) {}
+
+  llvm::StringRef getNodeType() override { return "test"; }
+  uint32_t getNodeId() override { return nodeId; }
+  llvm::Error addPasses(mlir::PassManager &pm) override {
+    return llvm::Error::success();
+  }
+  llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
+                            qssc::payload::Payload &payload) override {
+    payload.getFile(name + ".txt")->assign(name);
+    moduleOp->setAttr("test.compiled",
+                      mlir::UnitAttr::get(moduleOp.getContext()));
+    return llvm::Error::success();
+  }
+
+private:
+  uint32_t nodeId;
+};
+
+class TestSystem : public qssc::hal::TargetSystem {
+public:
+  TestSystem() : TargetSystem("test-system", nullptr) {
+    addChild(std::make_unique<TestInstrument>("inst0", this, 0));
+    addChild(std::make_unique<TestInstrument>("inst1", this, 1));
+  }
+
+  llvm::Error addPasses(mlir::PassManager &pm) override {
+    return llvm::Error::success();
+  }
+  llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
+                            qssc::payload::Payload &payload) override {
+    payload.getFile("system.txt")->assign(name);
+    return llvm::Error::success();
+  }
+  // record the child modules compiled when the children completed
+  llvm::Error
+  emitToPayloadPostChildren(mlir::ModuleOp moduleOp,
+                            qssc::payload::Payload &payload) override {
+    size_t numCompiled = 0;
+    for (auto childModuleOp : moduleOp.getBody()->getOps<mlir::ModuleOp>())
+      if (childModuleOp->hasAttr("test.compiled"))
+        ++numCompiled;
+    payload.getFile("children.txt")->assign(std::to_string(numCompiled));
+    return llvm::Error::success();
+  }
+};
+
+const char *testModule =
+    "module {\n"
+    "  module @inst0 attributes {quir.nodeType = \"test\", "
+    "quir.nodeId = 0 : ui32} {}\n"
+    "  module @inst1 attributes {quir.nodeType = \"test\", "
+    "quir.nodeId = 1 : ui32} {}\n"
+    "}\n";
+
+llvm::Error buildPassManager(mlir::PassManager &pm) {
+  return llvm::Error::success();
+}
+
+TEST(RemoteCompilationManager, MergesWorkerPayloads) {
+  // As a compiler developer, I want to compile the subtrees of a target
+  // system on workers and obtain the same payload as a local compilation.
+
+  TestSystem workerSystem;
+  mlir::MLIRContext workerContext;
+  RemoteCompilationWorker worker(workerSystem, &workerContext,
+                                 buildPassManager);
+  auto executor = std::make_shared<InProcessTargetExecutor>(
+      worker, [] { return std::make_unique<TestPayload>(); });
+
+  TestSystem system;
+  mlir::MLIRContext context;
+  mlir::OwningOpRef<mlir::ModuleOp> module =
+      mlir::parseSourceString<mlir::ModuleOp>(testModule, &context);
+  ASSERT_TRUE(static_cast<bool>(module));
+
+  RemoteCompilationManager manager(system, &context, buildPassManager,
+                                   executor);
+  TestPayload payload;
+  auto err = manager.compilePayload(*module, payload);
+  ASSERT_FALSE(static_cast<bool>(err)) << llvm::toString(std::move(err));
+
+  EXPECT_EQ(executor->getNumRequests(), 2u);
+  std::vector<std::pair<std::string, std::string>> const expected = {
+      {"exp/children.txt", "2"},
+      {"exp/inst0.txt", "inst0"},
+      {"exp/inst1.txt", "inst1"},
+      {"exp/system.txt", "test-system"}};
+  EXPECT_EQ(payload.takeFiles(), expected);
+}
+
+TEST(RemoteCompilationManager, RejectsUnknownTargets) {
+  TestSystem workerSystem;
+  mlir::MLIRContext workerContext;
+  RemoteCompilationWorker worker(workerSystem, &workerContext,
+                                 buildPassManager);
+
+  RemoteCompileRequest request;
+  request.targetPath = {"test-system", "inst2"};
+  TestPayload payload;
+  auto result = worker.compile(request, payload);
+  ASSERT_FALSE(static_cast<bool>(result));
+  EXPECT_NE(llvm::toString(result.takeError()).find("test-system/inst2"),
+            std::string::npos);
+}
+
+} // anonymous namespace
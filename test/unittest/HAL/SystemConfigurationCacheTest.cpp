@@ -0,0 +1,116 @@
+//===- SystemConfigurationCacheTest.cpp -------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the system configuration caches.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/SystemConfigurationCache.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <string>
+#include <system_error>
+#include <tuple>
+
+namespace {
+
+TEST(SystemConfigurationCache, SnapshotRoundTrip) {
+  // As a compiler developer, I want to map a parsed configuration from a
+  // snapshot instead of parsing its configuration file again.
+
+  llvm::SmallString<128> directory;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("config-snapshots", directory));
+
+  llvm::SmallString<128> configPath(directory);
+  llvm::sys::path::append(configPath, "target.cfg");
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(configPath, ec);
+    ASSERT_FALSE(ec) << ec.message();
+    os << "num_qubits 4\n";
+  }
+  auto file = qssc::hal::readConfigurationFile(configPath);
+  ASSERT_TRUE(static_cast<bool>(file)) << llvm::toString(file.takeError());
+
+  std::string const path =
+      qssc::hal::getConfigurationSnapshotPath(directory, "test", file->hash);
+  auto missing =
+      qssc::hal::readConfigurationSnapshot(path, "test", 1, file->hash);
+  ASSERT_TRUE(static_cast<bool>(missing));
+  EXPECT_FALSE(missing->has_value());
+
+  ASSERT_FALSE(static_cast<bool>(qssc::hal::writeConfigurationSnapshot(
+      path, "test", 1, file->hash, "payload")));
+  auto snapshot =
+      qssc::hal::readConfigurationSnapshot(path, "test", 1, file->hash);
+  ASSERT_TRUE(static_cast<bool>(snapshot));
+  ASSERT_TRUE(snapshot->has_value());
+  EXPECT_EQ((*snapshot)->payload, "payload");
+
+  // snapshots of another kind, format or configuration are stale
+  for (auto [kind, version, hash] :
+       {std::make_tuple("other", 1u, file->hash),
+        std::make_tuple("test", 2u, file->hash),
+        std::make_tuple("test", 1u, file->hash + 1)}) {
+    auto stale =
+        qssc::hal::readConfigurationSnapshot(path, kind, version, hash);
+    ASSERT_TRUE(static_cast<bool>(stale));
+    EXPECT_FALSE(stale->has_value());
+  }
+
+  // a truncated snapshot is an error
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(path, ec);
+    ASSERT_FALSE(ec) << ec.message();
+    os << "QSSCSNAP";
+  }
+  auto truncated =
+      qssc::hal::readConfigurationSnapshot(path, "test", 1, file->hash);
+  EXPECT_FALSE(static_cast<bool>(truncated));
+  llvm::consumeError(truncated.takeError());
+
+  llvm::sys::fs::remove_directories(directory);
+}
+
+TEST(SystemConfigurationCache, CacheParsedConfigurations) {
+  qssc::hal::ConfigurationCache<std::string> cache;
+  EXPECT_EQ(cache.lookup(1), nullptr);
+
+  auto config = std::make_shared<const std::string>("config");
+  cache.insert(1, config);
+  EXPECT_EQ(cache.lookup(1), config);
+  // the first configuration inserted for a hash is kept
+  cache.insert(1, std::make_shared<const std::string>("other"));
+  EXPECT_EQ(cache.lookup(1), config);
+  EXPECT_EQ(cache.lookup(2), nullptr);
+
+  cache.clear();
+  EXPECT_EQ(cache.lookup(1), nullptr);
+}
+
+} // anonymous namespace
@@ -1,6 +1,6 @@
 //===- TargetSystemRegistryTest.cpp -----------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -23,6 +23,17 @@
 
 #include "HAL/TargetSystemRegistry.h"
 
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <optional>
+#include <system_error>
+
 namespace {
 
 TEST(TargetSystemRegistry, LookupMockTarget) {
@@ -45,4 +56,60 @@ TEST(TargetSystemRegistry, LookupMockTarget) {
   }
 }
 
+void writeMockConfig(llvm::StringRef path, unsigned numQubits) {
+  std::error_code ec;
+  llvm::raw_fd_ostream os(path, ec);
+  ASSERT_FALSE(ec) << ec.message();
+  os << "num_qubits " << numQubits << "\n"
+     << "acquire_multiplexing_ratio_to_1 5\n"
+     << "controllerNodeId 1000\n";
+}
+
+TEST(TargetSystemRegistry, PoolMockTargets) {
+  // As a compiler developer, I want compilations with the same target
+  // configuration to reuse a prepared target with a clean run state.
+
+  auto targetInfoOpt =
+      qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo("mock");
+  ASSERT_TRUE(targetInfoOpt.has_value());
+  auto *targetInfo = targetInfoOpt.value();
+
+  llvm::SmallString<128> configPath;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("mock-pool", "cfg", configPath));
+  writeMockConfig(configPath, 2);
+  std::optional<llvm::StringRef> const config(configPath.str());
+
+  mlir::MLIRContext firstContext;
+  auto first = targetInfo->acquireTarget(&firstContext, config);
+  ASSERT_TRUE(static_cast<bool>(first)) << llvm::toString(first.takeError());
+  (*first)->addDiagnostic(qssc::Severity::Info,
+                          qssc::ErrorCategory::UncategorizedError, "run");
+  targetInfo->releaseTarget(&firstContext);
+
+  // the released target no longer serves its context
+  auto released = targetInfo->getTarget(&firstContext);
+  if (released)
+    EXPECT_NE(*released, *first);
+  else
+    llvm::consumeError(released.takeError());
+
+  mlir::MLIRContext secondContext;
+  auto second = targetInfo->acquireTarget(&secondContext, config);
+  ASSERT_TRUE(static_cast<bool>(second)) << llvm::toString(second.takeError());
+  EXPECT_EQ(*second, *first);
+  EXPECT_TRUE((*second)->takeDiagnostics().empty());
+  targetInfo->releaseTarget(&secondContext);
+
+  // changing the configuration contents must build a new target
+  writeMockConfig(configPath, 3);
+  mlir::MLIRContext thirdContext;
+  auto third = targetInfo->acquireTarget(&thirdContext, config);
+  ASSERT_TRUE(static_cast<bool>(third)) << llvm::toString(third.takeError());
+  EXPECT_NE(*third, *first);
+  targetInfo->releaseTarget(&thirdContext);
+
+  llvm::sys::fs::remove(configPath);
+}
+
 } // anonymous namespace
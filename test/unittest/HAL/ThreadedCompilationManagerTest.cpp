@@ -0,0 +1,145 @@
+//===- ThreadedCompilationManagerTest.cpp -----------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the ThreadedCompilationManager.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/Compile/ThreadedCompilationManager.h"
+#include "HAL/TargetSystem.h"
+#include "Payload/Payload.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/TypeID.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace {
+
+using namespace qssc::hal::compile;
+
+// Tags the module with the number of times this pass instance ran
+struct CountRunsPass
+    : public mlir::PassWrapper<CountRunsPass,
+                               mlir::OperationPass<mlir::ModuleOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(CountRunsPass)
+
+  void runOnOperation() override {
+    ++numRuns;
+    auto moduleOp = getOperation();
+    moduleOp->setAttr("test.runs",
+                      mlir::IntegerAttr::get(
+                          mlir::IntegerType::get(moduleOp.getContext(), 64),
+                          numRuns));
+  }
+
+  int64_t numRuns = 0;
+};
+
+class TestInstrument : public qssc::hal::TargetInstrument {
+public:
+  TestInstrument(std::string name, Target *parent, uint32_t nodeId)
+      : TargetInstrument(std::move(name), parent), nodeId(nodeId) {}
+
+  llvm::StringRef getNodeType() override { return "test"; }
+  uint32_t getNodeId() override { return nodeId; }
+  llvm::Error addPasses(mlir::PassManager &pm) override {
+    pm.addPass(std::make_unique<CountRunsPass>());
+    return llvm::Error::success();
+  }
+  llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
+                            qssc::payload::Payload &payload) override {
+    return llvm::Error::success();
+  }
+
+private:
+  uint32_t nodeId;
+};
+
+class TestSystem : public qssc::hal::TargetSystem {
+public:
+  TestSystem() : TargetSystem("test-system", nullptr) {
+    addChild(std::make_unique<TestInstrument>("inst0", this, 0));
+    addChild(std::make_unique<TestInstrument>("inst1", this, 1));
+  }
+
+  llvm::Error addPasses(mlir::PassManager &pm) override {
+    return llvm::Error::success();
+  }
+  llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
+                            qssc::payload::Payload &payload) override {
+    return llvm::Error::success();
+  }
+};
+
+const char *testModule =
+    "module {\n"
+    "  module @inst0 attributes {quir.nodeType = \"test\", "
+    "quir.nodeId = 0 : ui32} {}\n"
+    "  module @inst1 attributes {quir.nodeType = \"test\", "
+    "quir.nodeId = 1 : ui32} {}\n"
+    "}\n";
+
+llvm::Error buildPassManager(mlir::PassManager &pm) {
+  return llvm::Error::success();
+}
+
+std::string compile(ThreadedCompilationManager &manager,
+                    mlir::MLIRContext &context) {
+  mlir::OwningOpRef<mlir::ModuleOp> module =
+      mlir::parseSourceString<mlir::ModuleOp>(testModule, &context);
+  EXPECT_TRUE(static_cast<bool>(module));
+
+  auto err = manager.compileMLIR(*module);
+  EXPECT_FALSE(static_cast<bool>(err)) << llvm::toString(std::move(err));
+
+  std::string output;
+  llvm::raw_string_ostream outputStream(output);
+  module->print(outputStream);
+  return outputStream.str();
+}
+
+TEST(ThreadedCompilationManager, RepeatedCompilationsAreIdentical) {
+  // As a compiler developer, I want the state of the target passes of one
+  // compilation not to leak into the next compilation of the same manager.
+
+  TestSystem system;
+  mlir::MLIRContext context;
+  ThreadedCompilationManager manager(system, &context, buildPassManager);
+
+  auto first = compile(manager, context);
+  auto second = compile(manager, context);
+  EXPECT_NE(first.find("test.runs = 1"), std::string::npos);
+  EXPECT_EQ(first, second);
+}
+
+} // anonymous namespace
@@ -0,0 +1,210 @@
+//===- FlatPayloadTest.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the flat payload.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Payload/FlatArchive.h"
+#include "Payload/PatchableFlatPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::unique_ptr<qssc::payload::Payload> createFlatPayload() {
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("FLAT");
+  if (!payloadInfoOpt.has_value())
+    return nullptr;
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  if (!payloadOrErr) {
+    llvm::consumeError(payloadOrErr.takeError());
+    return nullptr;
+  }
+  return std::move(payloadOrErr.get());
+}
+
+std::string writePayload(qssc::payload::Payload &payload) {
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+  return archive;
+}
+
+uint32_t crc(llvm::StringRef data) {
+  return llvm::crc32(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+}
+
+TEST(FlatPayload, WritePageAlignedMembers) {
+  // As a runtime developer, I want to map the payload and use its members in
+  // place without extracting them.
+
+  auto payload = createFlatPayload();
+  ASSERT_NE(payload, nullptr);
+  payload->getFile("controller.bin")->assign(std::string(5000, 'c'));
+  payload->getFile("a.txt")->assign("a\n");
+
+  std::string const archive = writePayload(*payload);
+  auto indexOrErr = qssc::payload::readFlatArchiveIndex(archive);
+  ASSERT_TRUE(static_cast<bool>(indexOrErr))
+      << llvm::toString(indexOrErr.takeError());
+  auto &index = *indexOrErr;
+
+  std::vector<std::string> names;
+  for (const auto &member : index) {
+    names.push_back(member.name.str());
+    EXPECT_EQ(member.dataOffset % qssc::payload::flatArchiveAlignment, 0u);
+    EXPECT_EQ(member.crc,
+              crc(llvm::StringRef(archive).substr(member.dataOffset,
+                                                  member.size)));
+  }
+  std::vector<std::string> const expected = {
+      "exp/a.txt", "exp/controller.bin", "manifest/manifest.json"};
+  EXPECT_EQ(names, expected);
+
+  const auto *controller =
+      qssc::payload::findFlatArchiveMember(index, "exp/controller.bin");
+  ASSERT_NE(controller, nullptr);
+  EXPECT_EQ(archive.substr(controller->dataOffset, controller->size),
+            std::string(5000, 'c'));
+  EXPECT_EQ(qssc::payload::findFlatArchiveMember(index, "exp/b.txt"),
+            nullptr);
+
+  auto truncated = qssc::payload::readFlatArchiveIndex(
+      llvm::StringRef(archive).take_front(40));
+  EXPECT_FALSE(static_cast<bool>(truncated));
+  llvm::consumeError(truncated.takeError());
+}
+
+TEST(FlatPayload, ListRuntimeEstimateInManifest) {
+  // As a scheduler developer, I want to read the expected runtime of a job
+  // from its payload without executing it.
+
+  auto payload = createFlatPayload();
+  ASSERT_NE(payload, nullptr);
+  payload->setRuntimeEstimate(
+      qssc::payload::Payload::RuntimeEstimate{1000, 1e-3, 1.0});
+
+  std::string const archive = writePayload(*payload);
+  auto indexOrErr = qssc::payload::readFlatArchiveIndex(archive);
+  ASSERT_TRUE(static_cast<bool>(indexOrErr));
+  const auto *manifest = qssc::payload::findFlatArchiveMember(
+      *indexOrErr, qssc::payload::Payload::manifestFileName);
+  ASSERT_NE(manifest, nullptr);
+  llvm::StringRef const contents =
+      llvm::StringRef(archive).substr(manifest->dataOffset, manifest->size);
+  EXPECT_TRUE(contents.contains("\"runtime_estimate\""));
+  EXPECT_TRUE(contents.contains("\"num_shots\":1000"));
+}
+
+TEST(FlatPayload, PatchInPlace) {
+  // As a user, I want to bind arguments to a flat payload by patching its
+  // members in place.
+
+  auto payload = createFlatPayload();
+  ASSERT_NE(payload, nullptr);
+  payload->getFile("controller.bin")->assign(std::string(64, '\0'));
+  std::string const archive = writePayload(*payload);
+
+  std::string patchedArchive;
+  {
+    qssc::payload::PatchableFlatPayload flat(archive, /*enableInMemory=*/true);
+    auto member = flat.mapMember("exp/controller.bin");
+    ASSERT_TRUE(static_cast<bool>(member));
+    ASSERT_EQ(member->size(), 64u);
+
+    std::vector<char> const previous(member->begin() + 16,
+                                     member->begin() + 24);
+    double const theta = 0.5;
+    std::memcpy(member->data() + 16, &theta, sizeof(theta));
+    ASSERT_FALSE(static_cast<bool>(
+        flat.updateMappedMember("exp/controller.bin", 16, previous)));
+
+    ASSERT_FALSE(static_cast<bool>(flat.writeBack()));
+    ASSERT_FALSE(static_cast<bool>(flat.writeString(&patchedArchive)));
+  }
+  ASSERT_EQ(patchedArchive.size(), archive.size());
+
+  auto indexOrErr = qssc::payload::readFlatArchiveIndex(patchedArchive);
+  ASSERT_TRUE(static_cast<bool>(indexOrErr));
+  const auto *controller =
+      qssc::payload::findFlatArchiveMember(*indexOrErr, "exp/controller.bin");
+  ASSERT_NE(controller, nullptr);
+  llvm::StringRef const contents =
+      llvm::StringRef(patchedArchive)
+          .substr(controller->dataOffset, controller->size);
+  EXPECT_EQ(controller->crc, crc(contents));
+  double patchedTheta;
+  std::memcpy(&patchedTheta, contents.data() + 16, sizeof(patchedTheta));
+  EXPECT_EQ(patchedTheta, 0.5);
+}
+
+TEST(FlatPayload, RewriteResizedMembers) {
+  auto payload = createFlatPayload();
+  ASSERT_NE(payload, nullptr);
+  payload->getFile("a.txt")->assign("a");
+  payload->getFile("b.txt")->assign("b");
+  std::string const archive = writePayload(*payload);
+
+  std::string patchedArchive;
+  {
+    qssc::payload::PatchableFlatPayload flat(archive, /*enableInMemory=*/true);
+    auto a = flat.readMember("exp/a.txt");
+    ASSERT_TRUE(static_cast<bool>(a));
+    a->assign(10000, 'a');
+    auto b = flat.readMember("exp/b.txt");
+    ASSERT_TRUE(static_cast<bool>(b));
+    (*b)[0] = 'B';
+
+    ASSERT_FALSE(static_cast<bool>(flat.writeBack()));
+    ASSERT_FALSE(static_cast<bool>(flat.writeString(&patchedArchive)));
+  }
+
+  qssc::payload::PatchableFlatPayload flat(patchedArchive,
+                                           /*enableInMemory=*/true);
+  auto a = flat.readMember("exp/a.txt", false);
+  ASSERT_TRUE(static_cast<bool>(a));
+  EXPECT_EQ(std::string(a->begin(), a->end()), std::string(10000, 'a'));
+  auto b = flat.readMember("exp/b.txt", false);
+  ASSERT_TRUE(static_cast<bool>(b));
+  EXPECT_EQ(std::string(b->begin(), b->end()), "B");
+  auto c = flat.readMember("exp/c.txt", false);
+  EXPECT_FALSE(static_cast<bool>(c));
+  llvm::consumeError(c.takeError());
+}
+
+} // anonymous namespace
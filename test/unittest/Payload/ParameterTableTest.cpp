@@ -0,0 +1,95 @@
+//===- ParameterTableTest.cpp -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the parameter table of sweep payloads.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Payload/ParameterTable.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using qssc::payload::ParameterTableView;
+
+llvm::Expected<ParameterTableView> view(std::string &table) {
+  return ParameterTableView::create(
+      llvm::MutableArrayRef<char>(table.data(), table.size()));
+}
+
+TEST(ParameterTable, StartsAtInitialValues) {
+  std::vector<llvm::StringRef> const names = {"theta", "amp"};
+  std::string table =
+      qssc::payload::createParameterTable(names, {1.5, 0.25}, 3);
+  EXPECT_EQ(table.size() % sizeof(double), 0u);
+
+  auto viewOrErr = view(table);
+  ASSERT_TRUE(static_cast<bool>(viewOrErr))
+      << llvm::toString(viewOrErr.takeError());
+  auto &parameters = *viewOrErr;
+  EXPECT_EQ(parameters.getNumPoints(), 3u);
+  ASSERT_EQ(parameters.getNumParameters(), 2u);
+  EXPECT_EQ(parameters.getParameterName(0), "theta");
+  EXPECT_EQ(parameters.getParameterName(1), "amp");
+  EXPECT_EQ(parameters.lookup("amp"), 1u);
+  EXPECT_EQ(parameters.lookup("phi"), std::nullopt);
+  for (uint32_t point = 0; point < 3; ++point) {
+    EXPECT_EQ(parameters.getValue(point, 0), 1.5);
+    EXPECT_EQ(parameters.getValue(point, 1), 0.25);
+  }
+}
+
+TEST(ParameterTable, PatchPointsInPlace) {
+  // As a user, I want to set the parameters of each point of a sweep in the
+  // compiled payload without recompiling it.
+
+  std::vector<llvm::StringRef> const names = {"theta"};
+  std::string table = qssc::payload::createParameterTable(names, {0.}, 4);
+  {
+    auto viewOrErr = view(table);
+    ASSERT_TRUE(static_cast<bool>(viewOrErr));
+    for (uint32_t point = 0; point < 4; ++point)
+      viewOrErr->setValue(point, 0, 0.5 * point);
+  }
+
+  auto viewOrErr = view(table);
+  ASSERT_TRUE(static_cast<bool>(viewOrErr));
+  for (uint32_t point = 0; point < 4; ++point)
+    EXPECT_EQ(viewOrErr->getValue(point, 0), 0.5 * point);
+}
+
+TEST(ParameterTable, RejectTruncatedTable) {
+  std::vector<llvm::StringRef> const names = {"theta"};
+  std::string table = qssc::payload::createParameterTable(names, {0.}, 4);
+  table.resize(table.size() - sizeof(double));
+
+  auto viewOrErr = view(table);
+  EXPECT_FALSE(static_cast<bool>(viewOrErr));
+  llvm::consumeError(viewOrErr.takeError());
+}
+
+} // anonymous namespace
@@ -0,0 +1,616 @@
+//===- ZipPayloadTest.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the zip payload.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Signature.h"
+#include "Payload/PatchableZipPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(ZipPayload, WriteAdoptedFiles) {
+  // As a target developer, I want to hand over large buffers to the payload
+  // without copying them and read them back from the written archive.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  std::string const contents(1 << 20, 'x');
+  payload.getFile("copied.txt")->assign("copied\n");
+  payload.adoptFile("moved.bin", std::string(contents));
+  payload.adoptFile("buffer.bin",
+                    llvm::MemoryBuffer::getMemBufferCopy("buffer", "buffer"));
+
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+
+  qssc::payload::PatchableZipPayload zip(archive, /*enableInMemory=*/true);
+  ASSERT_NE(zip.getBackingZip(), nullptr);
+
+  auto copied = zip.readMember("exp/copied.txt", false);
+  ASSERT_TRUE(static_cast<bool>(copied));
+  EXPECT_EQ(std::string(copied->begin(), copied->end()), "copied\n");
+
+  auto moved = zip.readMember("exp/moved.bin", false);
+  ASSERT_TRUE(static_cast<bool>(moved));
+  EXPECT_EQ(std::string(moved->begin(), moved->end()), contents);
+
+  auto buffer = zip.readMember("exp/buffer.bin", false);
+  ASSERT_TRUE(static_cast<bool>(buffer));
+  EXPECT_EQ(std::string(buffer->begin(), buffer->end()), "buffer");
+
+  auto manifest = zip.readMember("manifest/manifest.json", false);
+  ASSERT_TRUE(static_cast<bool>(manifest));
+  EXPECT_FALSE(manifest->empty());
+}
+
+TEST(ZipPayload, AdoptFilesUnderPrefix) {
+  // As a target developer, I want adopted files to be laid out under the
+  // prefix of the payload like the files I get from it.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"contents", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+  ASSERT_EQ(payload.getPrefix(), "contents/");
+
+  payload.getFile("got.txt")->assign("got");
+  payload.adoptFile("moved.txt", std::string("moved"));
+  payload.adoptFile("buffer.txt",
+                    llvm::MemoryBuffer::getMemBufferCopy("buffer", "buffer"));
+  // an adopted file replaces the file of the same name
+  payload.adoptFile("got.txt", std::string("replaced"));
+  // added files are named in full
+  payload.addFile("other/added.txt", std::string("added"));
+
+  auto files = payload.takeFiles();
+  ASSERT_EQ(files.size(), 4u);
+  EXPECT_EQ(files[0].first, "contents/buffer.txt");
+  EXPECT_EQ(files[0].second, "buffer");
+  EXPECT_EQ(files[1].first, "contents/got.txt");
+  EXPECT_EQ(files[1].second, "replaced");
+  EXPECT_EQ(files[2].first, "contents/moved.txt");
+  EXPECT_EQ(files[2].second, "moved");
+  EXPECT_EQ(files[3].first, "other/added.txt");
+  EXPECT_EQ(files[3].second, "added");
+}
+
+TEST(ZipPayload, ManifestOutsidePrefix) {
+  // As a user, I want the manifest of a prefixed payload at the root of the
+  // archive, and the manifest of a previous write not listed in it.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"contents", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  payload.adoptFile("a.txt", std::string("a"));
+
+  std::string archive;
+  for (int write = 0; write < 2; ++write) {
+    archive.clear();
+    llvm::raw_string_ostream archiveStream(archive);
+    payload.write(archiveStream);
+    archiveStream.flush();
+  }
+
+  qssc::payload::PatchableZipPayload zip(archive, /*enableInMemory=*/true);
+  ASSERT_NE(zip.getBackingZip(), nullptr);
+  auto prefixed = zip.readMember("contents/manifest/manifest.json", false);
+  EXPECT_FALSE(static_cast<bool>(prefixed));
+  llvm::consumeError(prefixed.takeError());
+
+  auto manifest = zip.readMember("manifest/manifest.json", false);
+  ASSERT_TRUE(static_cast<bool>(manifest));
+  auto hashes = qssc::payload::Payload::parseManifestHashes(
+      llvm::StringRef(manifest->data(), manifest->size()));
+  ASSERT_TRUE(static_cast<bool>(hashes));
+  ASSERT_EQ(hashes->size(), 1u);
+  EXPECT_EQ(hashes->begin()->first, "contents/a.txt");
+}
+
+TEST(ZipPayload, NothingWrittenBeyondZipLimits) {
+  // As a user, I want a payload exceeding the limits of zip archives to
+  // write nothing rather than a truncated archive.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  // with the manifest, one more member than zip archives without zip64
+  // extensions can hold
+  for (unsigned i = 0; i < 0xffff; ++i)
+    payload.adoptFile(std::to_string(i) + ".txt", std::string("x"));
+
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+  EXPECT_TRUE(archive.empty());
+}
+
+TEST(ZipPayload, WriteThroughFileHandles) {
+  // As a target developer, I want to write payload members from several
+  // worker threads at once and move finished members into the payload.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  constexpr int numThreads = 4;
+  constexpr int numAppends = 100;
+  auto shared = payload.reserveFile("shared.txt", numThreads * numAppends);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < numThreads; ++thread)
+    threads.emplace_back([&payload, &shared, thread] {
+      auto own = payload.reserveFile(
+          "thread_" + std::to_string(thread) + ".txt", numAppends);
+      for (int i = 0; i < numAppends; ++i) {
+        shared.append("x");
+        own.append("y");
+      }
+    });
+  for (auto &thread : threads)
+    thread.join();
+  payload.addFile("exp/moved.txt", std::string("moved"));
+
+  auto files = payload.takeFiles();
+  ASSERT_EQ(files.size(), static_cast<size_t>(numThreads + 2));
+  EXPECT_EQ(files[0].first, "exp/moved.txt");
+  EXPECT_EQ(files[0].second, "moved");
+  EXPECT_EQ(files[1].first, "exp/shared.txt");
+  EXPECT_EQ(files[1].second, std::string(numThreads * numAppends, 'x'));
+  for (int thread = 0; thread < numThreads; ++thread)
+    EXPECT_EQ(files[thread + 2].second, std::string(numAppends, 'y'));
+}
+
+TEST(ZipPayload, OrderFilesIncrementally) {
+  // As a target developer, I want files added between writes of the payload
+  // to be ordered with the files written before.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  auto writePlain = [&payload] {
+    std::string plain;
+    llvm::raw_string_ostream plainStream(plain);
+    payload.writePlain(plainStream);
+    plainStream.flush();
+    return plain;
+  };
+
+  payload.getFile("c.txt")->assign("c");
+  payload.getFile("a.txt")->assign("a");
+  std::string const first = writePlain();
+  EXPECT_LT(first.find("File: exp/a.txt\na\n"),
+            first.find("File: exp/c.txt\nc\n"));
+
+  payload.getFile("b.txt")->assign("b");
+  payload.addFile("exp/a.txt",
+                  llvm::MemoryBuffer::getMemBufferCopy("adopted"));
+  std::string const second = writePlain();
+  auto const a = second.find("File: exp/a.txt\nadopted\n");
+  auto const b = second.find("File: exp/b.txt\nb\n");
+  auto const c = second.find("File: exp/c.txt\nc\n");
+  ASSERT_NE(a, std::string::npos);
+  EXPECT_LT(a, b);
+  EXPECT_LT(b, c);
+  EXPECT_NE(c, std::string::npos);
+
+  auto files = payload.takeFiles();
+  ASSERT_EQ(files.size(), 3u);
+  EXPECT_EQ(files[0].first, "exp/a.txt");
+  EXPECT_EQ(files[0].second, "adopted");
+  EXPECT_EQ(files[1].first, "exp/b.txt");
+  EXPECT_EQ(files[2].first, "exp/c.txt");
+  EXPECT_TRUE(payload.takeFiles().empty());
+}
+
+TEST(ZipPayload, WriteLargeMembers) {
+  // As a user, I want the checksums of members spanning many chunks to be
+  // valid, such that the archive can be extracted by any zip tool.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  // a size which is not a multiple of the chunk size
+  std::string contents((3 << 20) + 12345, '\0');
+  uint32_t state = 1;
+  for (auto &c : contents) {
+    state = state * 1103515245 + 12345;
+    c = static_cast<char>(state >> 24);
+  }
+  payload.adoptFile("large.bin", std::string(contents));
+  payload.getFile("small.txt")->assign("small\n");
+
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+
+  // the CRC-32 is at offset 14 of the local header, followed by the name at
+  // offset 30
+  const std::string name = "exp/large.bin";
+  size_t header = 0;
+  while ((header = archive.find("PK\3\4", header)) != std::string::npos &&
+         archive.compare(header + 30, name.size(), name) != 0)
+    ++header;
+  ASSERT_NE(header, std::string::npos);
+  uint32_t const crc = llvm::support::endian::read32le(&archive[header + 14]);
+  EXPECT_EQ(crc, llvm::crc32(llvm::ArrayRef<uint8_t>(
+                     reinterpret_cast<const uint8_t *>(contents.data()),
+                     contents.size())));
+
+  qssc::payload::PatchableZipPayload zip(archive, /*enableInMemory=*/true);
+  ASSERT_NE(zip.getBackingZip(), nullptr);
+
+  auto large = zip.readMember("exp/large.bin", false);
+  ASSERT_TRUE(static_cast<bool>(large));
+  EXPECT_EQ(std::string(large->begin(), large->end()), contents);
+
+  auto small = zip.readMember("exp/small.txt", false);
+  ASSERT_TRUE(static_cast<bool>(small));
+  EXPECT_EQ(std::string(small->begin(), small->end()), "small\n");
+}
+
+TEST(ZipPayload, WriteDeltaPayload) {
+  // As a user, I want to upload only the members of a payload which changed
+  // since the previous payload.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+  auto writePayload = [&](llvm::StringRef controller,
+                          const qssc::payload::Payload::FileHashes *base) {
+    auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+        qssc::payload::PayloadConfig{"exp", "exp",
+                                     qssc::config::QSSVerbosity::Error});
+    EXPECT_TRUE(static_cast<bool>(payloadOrErr));
+    auto &payload = *payloadOrErr.get();
+    payload.getFile("controller.bin")->assign(controller.str());
+    payload.getFile("drive_0.bin")->assign("drive");
+    if (base)
+      payload.setDeltaBase(*base);
+
+    std::string archive;
+    llvm::raw_string_ostream archiveStream(archive);
+    payload.write(archiveStream);
+    archiveStream.flush();
+    return archive;
+  };
+  auto readManifest = [](qssc::payload::PatchableZipPayload &zip) {
+    auto manifest = zip.readMember("manifest/manifest.json", false);
+    EXPECT_TRUE(static_cast<bool>(manifest));
+    return std::string(manifest->begin(), manifest->end());
+  };
+
+  std::string const previous = writePayload("controller", nullptr);
+  qssc::payload::PatchableZipPayload previousZip(previous,
+                                                 /*enableInMemory=*/true);
+  ASSERT_NE(previousZip.getBackingZip(), nullptr);
+  auto baseOrErr = qssc::payload::Payload::parseManifestHashes(
+      readManifest(previousZip));
+  ASSERT_TRUE(static_cast<bool>(baseOrErr))
+      << llvm::toString(baseOrErr.takeError());
+  ASSERT_EQ(baseOrErr->size(), 2u);
+  EXPECT_EQ(baseOrErr->at("exp/drive_0.bin").size(), 64u);
+
+  std::string const delta = writePayload("recompiled", &*baseOrErr);
+  qssc::payload::PatchableZipPayload deltaZip(delta, /*enableInMemory=*/true);
+  ASSERT_NE(deltaZip.getBackingZip(), nullptr);
+
+  auto controller = deltaZip.readMember("exp/controller.bin", false);
+  ASSERT_TRUE(static_cast<bool>(controller));
+  EXPECT_EQ(std::string(controller->begin(), controller->end()), "recompiled");
+  auto drive = deltaZip.readMember("exp/drive_0.bin", false);
+  EXPECT_FALSE(static_cast<bool>(drive));
+  llvm::consumeError(drive.takeError());
+
+  // the manifest of the delta lists all members, such that the next delta
+  // can be taken against it
+  std::string const manifest = readManifest(deltaZip);
+  EXPECT_NE(manifest.find("\"unchanged\":[\"exp/drive_0.bin\"]"),
+            std::string::npos);
+  auto deltaHashes = qssc::payload::Payload::parseManifestHashes(manifest);
+  ASSERT_TRUE(static_cast<bool>(deltaHashes));
+  EXPECT_EQ(deltaHashes->size(), 2u);
+  EXPECT_EQ(deltaHashes->at("exp/drive_0.bin"),
+            baseOrErr->at("exp/drive_0.bin"));
+  EXPECT_NE(deltaHashes->at("exp/controller.bin"),
+            baseOrErr->at("exp/controller.bin"));
+}
+
+TEST(ZipPayload, WriteReproducibly) {
+  // As a user, I want payloads of the same contents to be byte-identical
+  // regardless of the order their files were added in, such that they can
+  // be cached and deduplicated.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto writePayload = [&](const std::vector<std::string> &names) {
+    auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+        qssc::payload::PayloadConfig{"exp", "exp",
+                                     qssc::config::QSSVerbosity::Error});
+    EXPECT_TRUE(static_cast<bool>(payloadOrErr));
+    if (!payloadOrErr) {
+      llvm::consumeError(payloadOrErr.takeError());
+      return std::string();
+    }
+    auto &payload = *payloadOrErr.get();
+    for (const auto &name : names)
+      payload.getFile(name)->assign(name + " contents\n");
+
+    std::string archive;
+    llvm::raw_string_ostream archiveStream(archive);
+    payload.write(archiveStream);
+    archiveStream.flush();
+    return archive;
+  };
+
+  std::string const archive =
+      writePayload({"controller.bin", "drive_0.bin", "acquire_0.bin"});
+  ASSERT_FALSE(archive.empty());
+  EXPECT_EQ(archive,
+            writePayload({"acquire_0.bin", "controller.bin", "drive_0.bin"}));
+}
+
+TEST(ZipPayload, PatchInPlace) {
+  // As a target developer, I want members with patch points to be patchable
+  // in place without rewriting the payload.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  payload.getFile("a.txt")->assign("unaligned");
+  payload.getFile("controller.bin")->assign(std::string(64, '\0'));
+  qssc::arguments::Signature sig;
+  sig.addParameterPatchPoint("theta", "double", "exp/controller.bin", 16);
+  payload.writeArgumentSignature(std::move(sig));
+
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+
+  std::string patchedArchive;
+  {
+    qssc::payload::PatchableZipPayload zip(archive, /*enableInMemory=*/true);
+    ASSERT_NE(zip.getBackingZip(), nullptr);
+
+    auto member = zip.mapMember("exp/controller.bin");
+    ASSERT_TRUE(static_cast<bool>(member));
+    ASSERT_EQ(member->size(), 64u);
+
+    std::vector<char> const previous(member->begin() + 16,
+                                     member->begin() + 24);
+    double const theta = 0.5;
+    std::memcpy(member->data() + 16, &theta, sizeof(theta));
+    ASSERT_FALSE(static_cast<bool>(
+        zip.updateMappedMember("exp/controller.bin", 16, previous)));
+
+    ASSERT_FALSE(static_cast<bool>(zip.writeBack()));
+    ASSERT_FALSE(static_cast<bool>(zip.writeString(&patchedArchive)));
+  }
+  ASSERT_EQ(patchedArchive.size(), archive.size());
+
+  // reading the member verifies its checksum
+  qssc::payload::PatchableZipPayload zip(patchedArchive,
+                                         /*enableInMemory=*/true);
+  ASSERT_NE(zip.getBackingZip(), nullptr);
+  auto controller = zip.readMember("exp/controller.bin", false);
+  ASSERT_TRUE(static_cast<bool>(controller));
+  double patchedTheta;
+  std::memcpy(&patchedTheta, controller->data() + 16, sizeof(patchedTheta));
+  EXPECT_EQ(patchedTheta, 0.5);
+}
+
+TEST(ZipPayload, PatchToOutputPath) {
+  // As a user, I want a payload linked from a module on disk to be written
+  // to its output without modifying the module.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  payload.getFile("controller.bin")->assign(std::string(64, '\0'));
+  qssc::arguments::Signature sig;
+  sig.addParameterPatchPoint("theta", "double", "exp/controller.bin", 16);
+  payload.writeArgumentSignature(std::move(sig));
+
+  llvm::SmallString<128> inputPath;
+  llvm::SmallString<128> outputPath;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("module", "qem", inputPath));
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("payload", "qem", outputPath));
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream input(inputPath, ec);
+    ASSERT_FALSE(ec);
+    payload.write(input);
+  }
+
+  {
+    qssc::payload::PatchableZipPayload zip(inputPath.str(),
+                                           /*enableInMemory=*/false);
+    ASSERT_FALSE(static_cast<bool>(zip.setOutputPath(outputPath)));
+
+    auto member = zip.mapMember("exp/controller.bin");
+    ASSERT_TRUE(static_cast<bool>(member));
+    std::vector<char> const previous(member->begin() + 16,
+                                     member->begin() + 24);
+    double const theta = 0.5;
+    std::memcpy(member->data() + 16, &theta, sizeof(theta));
+    ASSERT_FALSE(static_cast<bool>(
+        zip.updateMappedMember("exp/controller.bin", 16, previous)));
+    ASSERT_FALSE(static_cast<bool>(zip.writeBack()));
+  }
+
+  auto readController = [](llvm::StringRef path) {
+    qssc::payload::PatchableZipPayload zip(path, /*enableInMemory=*/false);
+    EXPECT_NE(zip.getBackingZip(), nullptr);
+    auto controller = zip.readMember("exp/controller.bin", false);
+    EXPECT_TRUE(static_cast<bool>(controller));
+    double theta = -1;
+    if (controller)
+      std::memcpy(&theta, controller->data() + 16, sizeof(theta));
+    else
+      llvm::consumeError(controller.takeError());
+    return theta;
+  };
+  EXPECT_EQ(readController(inputPath), 0.0);
+  EXPECT_EQ(readController(outputPath), 0.5);
+
+  llvm::sys::fs::remove(inputPath);
+  llvm::sys::fs::remove(outputPath);
+}
+
+TEST(ZipPayload, WriteBackMappedInput) {
+  // As a user, I want a module on disk which is read through a mapping to be
+  // updated with the members patched through libzip.
+
+  auto payloadInfoOpt =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfoOpt.has_value());
+
+  auto payloadOrErr = payloadInfoOpt.value()->createPluginInstance(
+      qssc::payload::PayloadConfig{"exp", "exp",
+                                   qssc::config::QSSVerbosity::Error});
+  ASSERT_TRUE(static_cast<bool>(payloadOrErr));
+  auto &payload = *payloadOrErr.get();
+
+  payload.getFile("a.txt")->assign("unchanged");
+  payload.getFile("controller.bin")->assign(std::string(64, '\0'));
+
+  llvm::SmallString<128> inputPath;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("module", "qem", inputPath));
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream input(inputPath, ec);
+    ASSERT_FALSE(ec);
+    payload.write(input);
+  }
+
+  {
+    qssc::payload::PatchableZipPayload zip(inputPath.str(),
+                                           /*enableInMemory=*/false);
+    ASSERT_NE(zip.getBackingZip(), nullptr);
+    auto controller = zip.readMember("exp/controller.bin");
+    ASSERT_TRUE(static_cast<bool>(controller));
+    double const theta = 0.5;
+    std::memcpy(controller->data() + 16, &theta, sizeof(theta));
+    ASSERT_FALSE(static_cast<bool>(zip.writeBack()));
+  }
+
+  qssc::payload::PatchableZipPayload zip(inputPath.str(),
+                                         /*enableInMemory=*/false);
+  ASSERT_NE(zip.getBackingZip(), nullptr);
+  auto controller = zip.readMember("exp/controller.bin", false);
+  ASSERT_TRUE(static_cast<bool>(controller));
+  double patchedTheta;
+  std::memcpy(&patchedTheta, controller->data() + 16, sizeof(patchedTheta));
+  EXPECT_EQ(patchedTheta, 0.5);
+
+  auto unchanged = zip.readMember("exp/a.txt", false);
+  ASSERT_TRUE(static_cast<bool>(unchanged));
+  EXPECT_EQ(std::string(unchanged->begin(), unchanged->end()), "unchanged");
+
+  llvm::sys::fs::remove(inputPath);
+}
+
+} // anonymous namespace
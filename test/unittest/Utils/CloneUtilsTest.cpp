@@ -0,0 +1,105 @@
+//===- CloneUtilsTest.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the bulk cloning utilities.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Utils/CloneUtils.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/ValueRange.h"
+#include "mlir/IR/Verifier.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace {
+
+constexpr llvm::StringRef functions = R"(
+  func.func @add(%a: i32, %b: i32) -> i32 {
+    %sum = arith.addi %a, %b : i32
+    %double = arith.addi %sum, %sum : i32
+    return %double : i32
+  }
+  func.func @main() -> (i32, i32) {
+    %one = arith.constant 1 : i32
+    %two = arith.constant 2 : i32
+    return %one, %two : i32, i32
+  }
+)";
+
+TEST(CloneUtils, CloneBlockRepeatedly) {
+  mlir::MLIRContext ctx;
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::arith::ArithDialect, mlir::func::FuncDialect>();
+  ctx.appendDialectRegistry(registry);
+  ctx.loadAllAvailableDialects();
+
+  auto module = mlir::parseSourceString<mlir::ModuleOp>(functions, &ctx);
+  ASSERT_TRUE(static_cast<bool>(module));
+  auto addFunc = module->lookupSymbol<mlir::func::FuncOp>("add");
+  auto mainFunc = module->lookupSymbol<mlir::func::FuncOp>("main");
+  mlir::Block &body = mainFunc.getBody().front();
+  mlir::Operation *mainReturn = body.getTerminator();
+  mlir::Value const one = mainReturn->getOperand(0);
+  mlir::Value const two = mainReturn->getOperand(1);
+
+  // add(1, 2) and add(2, 2)
+  llvm::SmallVector<mlir::Value> operands = {one, two, two, two};
+  llvm::SmallVector<mlir::ValueRange> operandLists = {
+      mlir::ValueRange(operands).take_front(2),
+      mlir::ValueRange(operands).drop_front(2)};
+  llvm::SmallVector<mlir::Value> results;
+  qssc::utils::cloneBlockRepeatedly(addFunc.getBody().front(), operandLists,
+                                    &body, mainReturn->getIterator(),
+                                    &results);
+  mainReturn->setOperands(results);
+
+  // two constants, two additions per copy and the return
+  EXPECT_EQ(body.getOperations().size(), 7u);
+  ASSERT_EQ(results.size(), 2u);
+  auto firstDouble = results[0].getDefiningOp<mlir::arith::AddIOp>();
+  ASSERT_TRUE(firstDouble);
+  auto firstSum = firstDouble.getLhs().getDefiningOp<mlir::arith::AddIOp>();
+  ASSERT_TRUE(firstSum);
+  EXPECT_EQ(firstSum.getLhs(), one);
+  EXPECT_EQ(firstSum.getRhs(), two);
+  auto secondDouble = results[1].getDefiningOp<mlir::arith::AddIOp>();
+  ASSERT_TRUE(secondDouble);
+  auto secondSum = secondDouble.getLhs().getDefiningOp<mlir::arith::AddIOp>();
+  ASSERT_TRUE(secondSum);
+  EXPECT_EQ(secondSum.getLhs(), two);
+  EXPECT_EQ(secondSum.getRhs(), two);
+  EXPECT_TRUE(firstSum->isBeforeInBlock(secondSum));
+
+  // the source is unchanged
+  EXPECT_EQ(addFunc.getBody().front().getOperations().size(), 3u);
+  EXPECT_TRUE(mlir::succeeded(mlir::verify(*module)));
+}
+
+} // anonymous namespace
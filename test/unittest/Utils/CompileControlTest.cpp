@@ -0,0 +1,84 @@
+//===- CompileControlTest.cpp -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the cancellation and the progress
+/// reporting of compilations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Utils/CompileControl.h"
+
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace qssc::utils;
+
+TEST(CompileControl, ChecksCancellation) {
+  auto token = std::make_shared<CancellationToken>();
+  CompileControl const control(token, nullptr);
+  EXPECT_FALSE(control.isCancelled());
+  EXPECT_FALSE(static_cast<bool>(control.checkCancelled("parse")));
+
+  token->cancel();
+  EXPECT_TRUE(control.isCancelled());
+  auto err = control.checkCancelled("parse");
+  ASSERT_TRUE(static_cast<bool>(err));
+  EXPECT_EQ(llvm::toString(std::move(err)),
+            "Compilation cancelled before parse");
+}
+
+TEST(CompileControl, RegistersPerContext) {
+  mlir::MLIRContext context;
+  mlir::MLIRContext otherContext;
+  auto token = std::make_shared<CancellationToken>();
+  std::vector<std::string> stages;
+  CompileControl control(
+      token, [&](llvm::StringRef stage) { stages.push_back(stage.str()); });
+
+  // contexts without a control are never cancelled
+  EXPECT_FALSE(isCompileCancelled(&context));
+  EXPECT_FALSE(static_cast<bool>(checkCompileCancelled(&context, "emit")));
+  reportCompileProgress(&context, "emit");
+  EXPECT_TRUE(stages.empty());
+
+  setContextCompileControl(&context, &control);
+  EXPECT_EQ(getContextCompileControl(&context), &control);
+  EXPECT_EQ(getContextCompileControl(&otherContext), nullptr);
+  reportCompileProgress(&context, "parse");
+  reportCompileProgress(&otherContext, "parse");
+  EXPECT_EQ(stages, std::vector<std::string>{"parse"});
+
+  token->cancel();
+  EXPECT_TRUE(isCompileCancelled(&context));
+  EXPECT_FALSE(isCompileCancelled(&otherContext));
+  llvm::consumeError(checkCompileCancelled(&context, "emit"));
+
+  setContextCompileControl(&context, nullptr);
+  EXPECT_EQ(getContextCompileControl(&context), nullptr);
+  EXPECT_FALSE(isCompileCancelled(&context));
+}
+
+} // anonymous namespace
@@ -0,0 +1,72 @@
+//===- ConcurrentListTest.cpp -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the lock-free concurrent list.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Utils/ConcurrentList.h"
+
+#include <cstddef>
+#include <list>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using qssc::utils::ConcurrentList;
+
+TEST(ConcurrentList, TakesInPushOrder) {
+  ConcurrentList<int> list;
+  EXPECT_TRUE(list.empty());
+  list.push(1);
+  list.emplace(2);
+  list.push(3);
+  EXPECT_FALSE(list.empty());
+
+  EXPECT_EQ(list.take(), (std::list<int>{1, 2, 3}));
+  EXPECT_TRUE(list.empty());
+  EXPECT_TRUE(list.take().empty());
+}
+
+TEST(ConcurrentList, PushesFromManyThreads) {
+  constexpr int numThreads = 8;
+  constexpr int numPushes = 1000;
+
+  ConcurrentList<std::pair<int, int>> list;
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads);
+  for (int thread = 0; thread < numThreads; ++thread)
+    threads.emplace_back([&list, thread] {
+      for (int i = 0; i < numPushes; ++i)
+        list.emplace(thread, i);
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  // every element is taken once and the elements of each thread remain in
+  // the order the thread pushed them
+  std::vector<int> next(numThreads, 0);
+  auto taken = list.take();
+  EXPECT_EQ(taken.size(), static_cast<size_t>(numThreads * numPushes));
+  for (const auto &[thread, i] : taken)
+    EXPECT_EQ(i, next[thread]++);
+}
+
+} // anonymous namespace
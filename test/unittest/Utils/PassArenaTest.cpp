@@ -0,0 +1,92 @@
+//===- PassArenaTest.cpp ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the pass arena.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Utils/PassArena.h"
+
+#include <vector>
+
+namespace {
+
+using qssc::utils::ArenaDeque;
+using qssc::utils::PassArena;
+
+struct Tracked {
+  Tracked(std::vector<int> &destroyed, int id)
+      : destroyed(destroyed), id(id) {}
+  ~Tracked() { destroyed.push_back(id); }
+
+  std::vector<int> &destroyed;
+  int id;
+};
+
+TEST(PassArena, ResetDestroysInReverseOrder) {
+  std::vector<int> destroyed;
+  PassArena arena;
+  auto *first = arena.create<Tracked>(destroyed, 1);
+  auto *second = arena.create<Tracked>(destroyed, 2);
+  EXPECT_EQ(first->id, 1);
+  EXPECT_EQ(second->id, 2);
+  EXPECT_GT(arena.getBytesAllocated(), 0u);
+
+  arena.reset();
+  EXPECT_EQ(destroyed, (std::vector<int>{2, 1}));
+  EXPECT_EQ(arena.getBytesAllocated(), 0u);
+
+  // the arena is reusable after a reset
+  arena.create<Tracked>(destroyed, 3);
+  arena.reset();
+  EXPECT_EQ(destroyed, (std::vector<int>{2, 1, 3}));
+}
+
+TEST(PassArena, DestroysOnDestruction) {
+  std::vector<int> destroyed;
+  {
+    PassArena arena;
+    arena.create<Tracked>(destroyed, 1);
+  }
+  EXPECT_EQ(destroyed, (std::vector<int>{1}));
+}
+
+TEST(PassArena, CopyIsEmpty) {
+  std::vector<int> destroyed;
+  PassArena arena;
+  arena.create<Tracked>(destroyed, 1);
+  PassArena const copy(arena);
+  EXPECT_EQ(copy.getBytesAllocated(), 0u);
+}
+
+TEST(PassArena, BacksContainers) {
+  PassArena arena;
+  ArenaDeque<int> queue(arena.getAllocator<int>());
+  for (int i = 0; i < 1000; ++i)
+    queue.push_back(i);
+  EXPECT_GT(arena.getBytesAllocated(), 1000 * sizeof(int));
+
+  int expected = 0;
+  while (!queue.empty()) {
+    EXPECT_EQ(queue.front(), expected++);
+    queue.pop_front();
+  }
+  EXPECT_EQ(expected, 1000);
+}
+
+} // anonymous namespace
@@ -0,0 +1,127 @@
+//===- SymbolCacheAnalysisTest.cpp ------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements test cases for the symbol cache analysis.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/QUIR/IR/QUIRDialect.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Utils/SymbolCacheAnalysis.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Parser/Parser.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace {
+
+using mlir::quir::CallCircuitOp;
+using mlir::quir::CircuitOp;
+
+constexpr llvm::StringRef circuits = R"(
+  quir.circuit @circuit_0() {
+    quir.return
+  }
+  quir.circuit @circuit_1() {
+    quir.return
+  }
+  func.func @main() {
+    quir.call_circuit @circuit_0() : () -> ()
+    quir.call_circuit @circuit_1() : () -> ()
+    return
+  }
+)";
+
+class SymbolCacheAnalysisTest : public ::testing::Test {
+protected:
+  mlir::MLIRContext ctx;
+  mlir::OwningOpRef<mlir::ModuleOp> module;
+  llvm::SmallVector<CallCircuitOp> calls;
+
+  SymbolCacheAnalysisTest() {
+    mlir::DialectRegistry registry;
+    registry.insert<mlir::quir::QUIRDialect, mlir::func::FuncDialect>();
+    ctx.appendDialectRegistry(registry);
+    ctx.loadAllAvailableDialects();
+
+    module = mlir::parseSourceString<mlir::ModuleOp>(circuits, &ctx);
+    module->walk([&](CallCircuitOp callOp) { calls.push_back(callOp); });
+  }
+
+  CircuitOp getCircuit(llvm::StringRef name) {
+    return module->lookupSymbol<CircuitOp>(name);
+  }
+};
+
+TEST_F(SymbolCacheAnalysisTest, CachesCallees) {
+  ASSERT_TRUE(static_cast<bool>(module));
+  qssc::utils::SymbolCacheAnalysis cache(module->getOperation());
+  cache.addToCache<CircuitOp>().cacheCallMap<CallCircuitOp>();
+
+  EXPECT_TRUE(cache.contains("circuit_0"));
+  EXPECT_TRUE(cache.contains("circuit_1"));
+  EXPECT_FALSE(cache.contains("main"));
+  EXPECT_EQ(cache.getOpByCall<CircuitOp>(calls[0]), getCircuit("circuit_0"));
+  EXPECT_EQ(cache.getOpByCall<CircuitOp>(calls[1]), getCircuit("circuit_1"));
+}
+
+TEST_F(SymbolCacheAnalysisTest, UpdatesOnlyCallsOfReplacedCallee) {
+  ASSERT_TRUE(static_cast<bool>(module));
+  qssc::utils::SymbolCacheAnalysis cache(module->getOperation());
+  cache.addToCache<CircuitOp>().cacheCallMap<CallCircuitOp>();
+
+  // replace circuit_0 by a clone of circuit_1, which the call to circuit_0
+  // resolves to from now on, while the call to circuit_1 keeps its callee
+  mlir::OpBuilder builder(&ctx);
+  builder.setInsertionPointToEnd(module->getBody());
+  auto replacement =
+      llvm::cast<CircuitOp>(builder.clone(*getCircuit("circuit_1")));
+  cache.addCallee("circuit_0", replacement.getOperation());
+
+  EXPECT_EQ(cache.getOpByCall<CircuitOp>(calls[0]), replacement);
+  EXPECT_EQ(cache.getOpByCall<CircuitOp>(calls[1]), getCircuit("circuit_1"));
+}
+
+TEST_F(SymbolCacheAnalysisTest, ListensToRewriter) {
+  ASSERT_TRUE(static_cast<bool>(module));
+  qssc::utils::SymbolCacheAnalysis cache(module->getOperation());
+  cache.addToCache<CircuitOp>().cacheCallMap<CallCircuitOp>();
+  mlir::IRRewriter rewriter(&ctx, &cache);
+
+  // inserted callees are added to the cache
+  rewriter.setInsertionPointToEnd(module->getBody());
+  auto created = rewriter.create<CircuitOp>(
+      rewriter.getUnknownLoc(), "circuit_2", rewriter.getFunctionType({}, {}));
+  EXPECT_TRUE(cache.contains("circuit_2"));
+  EXPECT_EQ(cache.getOpByName<CircuitOp>("circuit_2"), created);
+
+  // erased calls and callees are dropped
+  rewriter.eraseOp(calls[1]);
+  rewriter.eraseOp(getCircuit("circuit_1"));
+  EXPECT_FALSE(cache.contains("circuit_1"));
+  EXPECT_EQ(cache.getOpByCall<CircuitOp>(calls[0]), getCircuit("circuit_0"));
+}
+
+} // anonymous namespace
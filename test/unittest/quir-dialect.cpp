@@ -18,6 +18,8 @@
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTraits.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Transforms/QubitDependencyAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/IR/Builders.h"
@@ -31,6 +33,9 @@
 
 #include "gtest/gtest.h"
 
+#include <cstdint>
+#include <vector>
+
 namespace {
 
 class QUIRDialect : public ::testing::Test {
@@ -105,4 +110,83 @@ TEST_F(QUIRDialect, MeasureSideEffects) {
   EXPECT_FALSE(mlir::isOpTriviallyDead(measureOp.getOperation()));
 }
 
+TEST_F(QUIRDialect, QubitDependencyAnalysis) {
+
+  builder.setInsertionPointToEnd(rootModule.getBody());
+  std::vector<mlir::Value> qubits;
+  for (int32_t id = 0; id < 3; ++id)
+    qubits.push_back(builder
+                         .create<mlir::quir::DeclareQubitOp>(
+                             unkownLoc,
+                             builder.getType<mlir::quir::QubitType>(1),
+                             builder.getIntegerAttr(builder.getI32Type(), id))
+                         .getRes());
+
+  mlir::Operation *first = builder.create<mlir::quir::BarrierOp>(
+      unkownLoc, mlir::ValueRange{qubits[0]});
+  mlir::Operation *second = builder.create<mlir::quir::BarrierOp>(
+      unkownLoc, mlir::ValueRange{qubits[1]});
+  mlir::Operation *third = builder.create<mlir::quir::BarrierOp>(
+      unkownLoc, mlir::ValueRange{qubits[0], qubits[2]});
+
+  mlir::quir::QubitDependencyAnalysis deps(rootModule);
+
+  EXPECT_EQ(deps.getOperatedQubits(third), (mlir::quir::QubitSet{0, 2}));
+  EXPECT_EQ(deps.getNextQubitOp(first), second);
+  EXPECT_EQ(deps.getNextQubitUser(first, 0), third);
+  EXPECT_EQ(deps.getPrevQubitUser(third, 2), nullptr);
+
+  // moving past an operation on other qubits keeps the chains
+  deps.moveBefore(second, first);
+  EXPECT_TRUE(deps.isBeforeInBlock(second, first));
+  EXPECT_EQ(deps.getPrevQubitOp(first), second);
+  EXPECT_EQ(deps.getNextQubitUser(first, 0), third);
+
+  // moving past an operation on the same qubit reorders its chain
+  deps.moveAfter(first, third);
+  EXPECT_TRUE(deps.isBeforeInBlock(third, first));
+  EXPECT_EQ(deps.getPrevQubitUser(third, 0), nullptr);
+  EXPECT_EQ(deps.getNextQubitUser(third, 0), first);
+
+  deps.notifyOperationRemoved(third);
+  third->erase();
+  EXPECT_EQ(deps.getPrevQubitUser(first, 0), nullptr);
+  EXPECT_EQ(deps.getNextQubitOp(second), first);
+}
+
+TEST(QubitSet, InsertAndIterate) {
+  mlir::quir::QubitSet qubits{300, 3, 64, 0, 3};
+
+  EXPECT_EQ(qubits.size(), 4u);
+  EXPECT_TRUE(qubits.contains(64));
+  EXPECT_FALSE(qubits.contains(65));
+  EXPECT_FALSE(qubits.contains(1000));
+
+  std::vector<uint32_t> const ids(qubits.begin(), qubits.end());
+  EXPECT_EQ(ids, (std::vector<uint32_t>{0, 3, 64, 300}));
+
+  qubits.erase(300);
+  qubits.erase(0);
+  EXPECT_EQ(qubits, (mlir::quir::QubitSet{3, 64}));
+
+  qubits.clear();
+  EXPECT_TRUE(qubits.empty());
+  EXPECT_EQ(qubits.begin(), qubits.end());
+}
+
+TEST(QubitSet, Overlap) {
+  mlir::quir::QubitSet const low{1, 126};
+  mlir::quir::QubitSet const high{127, 200};
+
+  EXPECT_FALSE(low.overlaps(high));
+  EXPECT_FALSE(high.overlaps(low));
+  EXPECT_FALSE(low.overlaps({}));
+
+  auto const both = low | high;
+  EXPECT_EQ(both.size(), 4u);
+  EXPECT_TRUE(both.overlaps(high));
+  EXPECT_EQ(both & high, high);
+  EXPECT_TRUE((low & high).empty());
+}
+
 } // namespace
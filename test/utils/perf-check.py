@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+# ===- perf-check.py -----------------------------------------*- Python -*-===//
+#
+# (C) Copyright IBM 2024.
+#
+# This code is part of Qiskit.
+#
+# This code is licensed under the Apache License, Version 2.0 with LLVM
+# Exceptions. You may obtain a copy of this license in the LICENSE.txt
+# file in the root directory of this source tree.
+#
+# Any modifications or derivative works of this code must retain this
+# copyright notice, and modified files need to carry a notice indicating
+# that they have been altered from the originals.
+#
+# ===----------------------------------------------------------------------===//
+"""
+Check upper and lower bounds on the measurements of a compilation.
+
+Like FileCheck, the checks are read from the check file given as argument and
+the input from --input-file or stdin. The input is a timing trace written
+with --timing-trace, or the pass statistics printed with
+--mlir-pass-statistics --mlir-pass-statistics-display=list. Each check line
+holds a bound on a value or on the ratio of two values:
+
+    // PERF: counter(input:ops) <= 20
+    // PERF: counter(input ops:quir.call_gate) == 1
+    // PERF: stat(IR Statistics Pass:num-ops) < 40
+    // PERF: time(build-qem/*) <= 500 ms
+    // PERF: time(*/Canonicalizer) / time(build-qem) <= 0.25
+    // PERF: time(build-qem) / counter(input:ops) <= 2 ms
+
+counter(event:name) sums the counter name of the counter events event,
+stat(pass:name) sums the statistic name of the passes pass, and
+time(path) sums the durations of the timers whose path matches the glob
+path, in milliseconds. Bounds on times are scaled by --time-scale, such that
+slower machines may loosen them without editing the tests.
+"""
+
+import argparse
+import fnmatch
+import json
+import operator
+import re
+import sys
+
+COMPARISONS = {
+    "<=": operator.le,
+    "<": operator.lt,
+    ">=": operator.ge,
+    ">": operator.gt,
+    "==": operator.eq,
+}
+
+VALUE = r"(counter|stat|time)\(([^()]*)\)"
+CHECK = re.compile(
+    rf"^\s*{VALUE}(?:\s*/\s*{VALUE})?\s*(<=|<|>=|>|==)\s*"
+    r"([-+]?[0-9]*\.?[0-9]+(?:[eE][-+]?[0-9]+)?)\s*(ms)?\s*$"
+)
+
+
+class CheckError(Exception):
+    pass
+
+
+class Measurements:
+    def __init__(self, text):
+        self.counters = {}
+        self.stats = {}
+        self.timers = []
+        try:
+            trace = json.loads(text)
+        except ValueError:
+            self._parse_statistics(text)
+        else:
+            self._parse_trace(trace)
+
+    def _parse_trace(self, trace):
+        for event in trace.get("traceEvents", []):
+            args = event.get("args", {})
+            if event.get("ph") == "C":
+                for name, value in args.items():
+                    key = (event["name"], name)
+                    self.counters[key] = self.counters.get(key, 0) + value
+            elif event.get("ph") == "X" and event.get("cat") != "root":
+                # trace events are in microseconds
+                self.timers.append((args.get("path", event["name"]), event["dur"] / 1000.0))
+
+    def _parse_statistics(self, text):
+        # statistics are listed below the name of their pass as
+        #   (S) <value> <name> - <description>
+        statistic = re.compile(r"^\s*\(S\)\s*([0-9]+)\s+(\S+)")
+        current_pass = None
+        for line in text.splitlines():
+            match = statistic.match(line)
+            if match:
+                if current_pass is not None:
+                    key = (current_pass, match.group(2))
+                    self.stats[key] = self.stats.get(key, 0) + int(match.group(1))
+            elif line.strip() and not line.strip().startswith("="):
+                current_pass = line.strip()
+
+    def value(self, kind, argument):
+        if kind == "time":
+            matches = [dur for path, dur in self.timers if fnmatch.fnmatchcase(path, argument)]
+            if not matches:
+                raise CheckError(f"no timer matches time({argument})")
+            return sum(matches)
+
+        event, sep, name = argument.rpartition(":")
+        if not sep or not event or not name:
+            raise CheckError(f"expected {kind}(<name>:<counter>), found {kind}({argument})")
+        values = self.counters if kind == "counter" else self.stats
+        key = (event.strip(), name.strip())
+        if key not in values:
+            raise CheckError(f"no value recorded for {kind}({argument})")
+        return values[key]
+
+
+def parse_checks(check_file, prefixes):
+    directive = re.compile(r"(?:^|[^\w-])(" + "|".join(map(re.escape, prefixes)) + r"):(.*)$")
+    checks = []
+    with open(check_file) as f:
+        for lineno, line in enumerate(f, start=1):
+            match = directive.search(line)
+            if match:
+                checks.append((lineno, match.group(2).strip()))
+    return checks
+
+
+def run_check(measurements, expression, time_scale):
+    match = CHECK.match(expression)
+    if not match:
+        raise CheckError(f"invalid check '{expression}'")
+    kind, argument, divisor_kind, divisor_argument, comparison, bound, unit = match.groups()
+
+    value = measurements.value(kind, argument)
+    times = int(kind == "time")
+    if divisor_kind is not None:
+        divisor = measurements.value(divisor_kind, divisor_argument)
+        if divisor == 0:
+            raise CheckError(f"division by zero in '{expression}'")
+        value /= divisor
+        times -= int(divisor_kind == "time")
+    if unit is not None and times != 1:
+        raise CheckError(f"'{expression}' is not a time but has a unit")
+
+    scaled_bound = float(bound) * time_scale**times
+    if not COMPARISONS[comparison](value, scaled_bound):
+        raise CheckError(f"'{expression}' does not hold, the value is {value:g}")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument("check_file", help="file holding the checks")
+    parser.add_argument("--input-file", default="-", help="timing trace or pass statistics")
+    parser.add_argument("--check-prefix", action="append", dest="prefixes")
+    parser.add_argument("--check-prefixes", type=lambda s: s.split(","))
+    parser.add_argument(
+        "--time-scale", type=float, default=1.0, help="factor bounds on times are scaled by"
+    )
+    args = parser.parse_args()
+
+    prefixes = (args.prefixes or []) + (args.check_prefixes or [])
+    if not prefixes:
+        prefixes = ["PERF"]
+
+    checks = parse_checks(args.check_file, prefixes)
+    if not checks:
+        print(
+            f"error: no check strings found with prefix {', '.join(p + ':' for p in prefixes)}",
+            file=sys.stderr,
+        )
+        return 2
+
+    if args.input_file == "-":
+        measurements = Measurements(sys.stdin.read())
+    else:
+        with open(args.input_file) as f:
+            measurements = Measurements(f.read())
+
+    failed = False
+    for lineno, expression in checks:
+        try:
+            run_check(measurements, expression, args.time_scale)
+        except CheckError as e:
+            print(f"{args.check_file}:{lineno}: error: {e}", file=sys.stderr)
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
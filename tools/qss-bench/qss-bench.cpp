@@ -0,0 +1,661 @@
+//===- qss-bench.cpp --------------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements an end-to-end benchmark of the compiler. It generates
+// synthetic OpenQASM 3 and QUIR programs scaled along the number of qubits,
+// gates, circuit layers, measurements, conditionals, nested gate definitions
+// and input parameters, compiles each of them to a payload through
+// qssc::compileMain and reports the time spent per compilation stage and the
+// peak resident set size as JSON.
+//
+//===----------------------------------------------------------------------===//
+
+#include "API/api.h"
+#include "Config/QSSConfig.h"
+#include "Dialect/RegisterDialects.h"
+#include "Dialect/RegisterPasses.h"
+#include "HAL/Compile/TargetCompilationManager.h"
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+llvm::cl::OptionCategory benchCategory("qss-bench options");
+
+llvm::cl::opt<std::string>
+    targetName("target", llvm::cl::desc("Target to compile for"),
+               llvm::cl::init("mock"), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<std::string> configPath(
+    "config",
+    llvm::cl::desc("Path to the target configuration, by default a mock "
+                   "configuration with as many qubits as the program"),
+    llvm::cl::value_desc("filename"), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<std::string>
+    pipeline("pass-pipeline",
+             llvm::cl::desc("Pass pipeline to run before the target passes"),
+             llvm::cl::init("quirOpt"), llvm::cl::cat(benchCategory));
+
+llvm::cl::list<std::string>
+    inputTypes("input",
+               llvm::cl::desc("Kinds of programs to generate, qasm or mlir"),
+               llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned>
+    qubitCounts("qubits", llvm::cl::desc("Numbers of qubits"),
+                llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned>
+    gateCounts("gates", llvm::cl::desc("Numbers of gates"),
+               llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned> depths(
+    "depth",
+    llvm::cl::desc("Numbers of layers the gates are spread over, 0 for one "
+                   "gate per qubit and layer"),
+    llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned>
+    measurementCounts("measurements",
+                      llvm::cl::desc("Numbers of measurements"),
+                      llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned> conditionalCounts(
+    "conditionals",
+    llvm::cl::desc("Numbers of gates conditioned on measurements"),
+    llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned>
+    nestingDepths("nesting",
+                  llvm::cl::desc("Depths of nested gate definitions"),
+                  llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned>
+    parameterCounts("parameters",
+                    llvm::cl::desc("Numbers of input angle parameters, "
+                                   "declared as parameters with "
+                                   "--enable-parameters"),
+                    llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<unsigned>
+    repetitions("repetitions",
+                llvm::cl::desc("Number of compilations per configuration"),
+                llvm::cl::init(1), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<bool> emitPrograms(
+    "emit-programs",
+    llvm::cl::desc("Print the generated programs instead of compiling them"),
+    llvm::cl::init(false), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<std::string>
+    outputFilename("o", llvm::cl::desc("Output filename for JSON results"),
+                   llvm::cl::value_desc("filename"), llvm::cl::init("-"),
+                   llvm::cl::cat(benchCategory));
+
+using Clock = std::chrono::steady_clock;
+
+int64_t toNanoseconds(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+      .count();
+}
+
+// The peak resident set size of the process so far, which only grows, so
+// configurations are best run in increasing size or one per process
+int64_t getPeakRSSKilobytes() {
+  struct rusage usage {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+// The compilation stages reported, in output order. The stage of a timer is
+// that of the innermost timer enclosing it, itself included, whose name
+// contains one of the patterns of the stage, such that passes are attributed
+// to their stage wherever they run.
+struct StageRule {
+  llvm::StringRef stage;
+  llvm::SmallVector<llvm::StringRef, 4> patterns;
+};
+
+const StageRule stageRules[] = {
+    {"frontend", {"load-qasm3", "parse-mlir"}},
+    {"quir_pipeline", {"command-line-passes"}},
+    {"localization", {"Localization"}},
+    {"pulse", {"Pulse"}},
+    {"llvm", {"llvm", "LLVM", "build-object-file", "emit-binary"}},
+    {"payload", {"write-payload", "emit-to-payload"}},
+};
+
+constexpr llvm::StringLiteral otherStage = "other";
+
+// A timing manager which records every timer with its parent, such that the
+// time spent outside of the nested timers can be attributed to a stage.
+// Timers may be nested and stopped from several threads.
+class StageTimingManager : public mlir::TimingManager {
+public:
+  StageTimingManager() { timers.emplace_back(); }
+
+  // The time spent per stage by the timers of the last root scope
+  llvm::StringMap<Clock::duration> getStageTimes() const;
+  Clock::duration getTotalTime() const { return timers.front().duration; }
+
+protected:
+  std::optional<void *> rootTimer() override { return &timers.front(); }
+
+  void startTimer(void *handle) override {
+    static_cast<TimerInfo *>(handle)->start = Clock::now();
+  }
+
+  void stopTimer(void *handle) override {
+    auto *timer = static_cast<TimerInfo *>(handle);
+    auto const duration = Clock::now() - timer->start;
+    std::lock_guard<std::mutex> const lock(mutex);
+    timer->duration += duration;
+    if (timer->parent)
+      timer->parent->childDuration += duration;
+  }
+
+  void *nestTimer(void *handle, const void *id,
+                  llvm::function_ref<std::string()> nameBuilder) override {
+    std::lock_guard<std::mutex> const lock(mutex);
+    TimerInfo &timer = timers.emplace_back();
+    timer.name = nameBuilder();
+    timer.parent = static_cast<TimerInfo *>(handle);
+    return &timer;
+  }
+
+  void hideTimer(void *handle) override {}
+
+private:
+  struct TimerInfo {
+    std::string name;
+    TimerInfo *parent = nullptr;
+    Clock::time_point start;
+    Clock::duration duration{};
+    Clock::duration childDuration{};
+  };
+
+  static llvm::StringRef getStage(const TimerInfo *timer);
+
+  // a deque such that the handles remain valid
+  std::deque<TimerInfo> timers;
+  std::mutex mutex;
+};
+
+llvm::StringRef StageTimingManager::getStage(const TimerInfo *timer) {
+  for (; timer; timer = timer->parent)
+    for (const StageRule &rule : stageRules)
+      if (llvm::any_of(rule.patterns, [&](llvm::StringRef pattern) {
+            return llvm::StringRef(timer->name).contains(pattern);
+          }))
+        return rule.stage;
+  return otherStage;
+}
+
+llvm::StringMap<Clock::duration> StageTimingManager::getStageTimes() const {
+  llvm::StringMap<Clock::duration> times;
+  for (const StageRule &rule : stageRules)
+    times[rule.stage] = {};
+  times[otherStage] = {};
+  for (const TimerInfo &timer : timers) {
+    // nested timers which ran in parallel may exceed their parent
+    auto const exclusive = std::max(timer.duration - timer.childDuration,
+                                    Clock::duration::zero());
+    times[getStage(&timer)] += exclusive;
+  }
+  return times;
+}
+
+// The axes of a synthetic program
+struct ProgramShape {
+  qssc::config::InputType inputType;
+  unsigned qubits;
+  unsigned gates;
+  unsigned depth;
+  unsigned measurements;
+  unsigned conditionals;
+  unsigned nesting;
+  unsigned parameters;
+
+  unsigned getLayers() const {
+    return depth ? depth : (gates + qubits - 1) / qubits;
+  }
+  // the number of conditionals following measurement i
+  unsigned getConditionals(unsigned i) const {
+    return conditionals / measurements + (i < conditionals % measurements);
+  }
+  // the number of measurements after the first gates
+  unsigned getMeasurementsAfter(uint64_t gates) const {
+    return static_cast<unsigned>(gates * (measurements + 1) / this->gates);
+  }
+};
+
+// Generate an OpenQASM 3 program of the shape. The gates are spread evenly
+// over the layers, each layer starting on the next qubit, and cycle through
+// U gates with a parameter, CX gates, the outermost nested gate and U gates
+// with a constant. The measurements are spread evenly over the gates and
+// each is followed by its conditionals.
+std::string makeQASM(const ProgramShape &shape) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  os << "OPENQASM 3.0;\n";
+  for (unsigned i = 0; i < shape.parameters; ++i)
+    os << "input angle p" << i << " = 0." << i + 1 << ";\n";
+  for (unsigned level = 0; level < shape.nesting; ++level) {
+    os << "gate g" << level << "(theta) q {\n";
+    if (level == 0)
+      os << "  U(theta, 0.0, 0.0) q;\n";
+    else
+      os << "  g" << level - 1 << "(theta) q;\n";
+    os << "}\n";
+  }
+  for (unsigned qubit = 0; qubit < shape.qubits; ++qubit)
+    os << "qubit $" << qubit << ";\n";
+  for (unsigned i = 0; i < shape.measurements; ++i)
+    os << "bit m" << i << ";\n";
+
+  auto angle = [&](unsigned gate) -> std::string {
+    if (shape.parameters == 0)
+      return "0.5";
+    return "p" + std::to_string(gate % shape.parameters);
+  };
+
+  unsigned const layers = shape.getLayers();
+  unsigned measured = 0;
+  for (unsigned gate = 0; gate < shape.gates; ++gate) {
+    unsigned const layer = gate * layers / shape.gates;
+    unsigned const qubit = (gate + layer) % shape.qubits;
+    unsigned const next = (qubit + 1) % shape.qubits;
+    switch (gate % 4) {
+    case 1:
+      if (shape.qubits > 1) {
+        os << "CX $" << qubit << ", $" << next << ";\n";
+        break;
+      }
+      [[fallthrough]];
+    case 2:
+      if (shape.nesting > 0) {
+        os << "g" << shape.nesting - 1 << "(" << angle(gate) << ") $"
+           << qubit << ";\n";
+        break;
+      }
+      [[fallthrough]];
+    case 0:
+      os << "U(" << angle(gate) << ", 0.0, 0.0) $" << qubit << ";\n";
+      break;
+    default:
+      os << "U(0.5, 0.0, 0.5) $" << qubit << ";\n";
+    }
+
+    for (unsigned const end = shape.getMeasurementsAfter(gate + 1);
+         measured < end && measured < shape.measurements; ++measured) {
+      os << "m" << measured << " = measure $" << qubit << ";\n";
+      for (unsigned i = 0, e = shape.getConditionals(measured); i < e; ++i)
+        os << "if (m" << measured << " == 1) {\n"
+           << "  U(" << angle(i) << ", 0.0, 0.0) $"
+           << (qubit + i + 1) % shape.qubits << ";\n"
+           << "}\n";
+    }
+  }
+  os.flush();
+  return program;
+}
+
+// Generate the QUIR program of the shape, equivalent to the OpenQASM 3
+// program without circuits
+std::string makeQUIR(const ProgramShape &shape) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  llvm::StringLiteral const angleType = "!quir.angle<64>";
+  llvm::StringLiteral const qubitType = "!quir.qubit<1>";
+  llvm::StringLiteral const uTypes =
+      "!quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>";
+  llvm::StringLiteral const gateType =
+      "(!quir.qubit<1>, !quir.angle<64>) -> ()";
+
+  os << "module {\n";
+  for (unsigned i = 0; i < shape.parameters; ++i)
+    os << "  qcs.declare_parameter @p" << i << " : " << angleType
+       << " = #quir.angle<0." << i + 1 << "> : " << angleType << "\n";
+  for (unsigned level = 0; level < shape.nesting; ++level) {
+    os << "  func.func @g" << level << "(%q: " << qubitType
+       << ", %theta: " << angleType << ") {\n";
+    if (level == 0)
+      os << "    %zero = quir.constant #quir.angle<0.0> : " << angleType
+         << "\n"
+         << "    quir.builtin_U %q, %theta, %zero, %zero : " << uTypes
+         << "\n";
+    else
+      os << "    quir.call_gate @g" << level - 1 << "(%q, %theta) : "
+         << gateType << "\n";
+    os << "    return\n"
+       << "  }\n";
+  }
+
+  os << "  func.func @main() -> i32 {\n"
+     << "    %zero = quir.constant #quir.angle<0.0> : " << angleType << "\n"
+     << "    %half = quir.constant #quir.angle<0.5> : " << angleType << "\n";
+  for (unsigned i = 0; i < shape.parameters; ++i)
+    os << "    %p" << i << " = qcs.parameter_load @p" << i << " : "
+       << angleType << "\n";
+  for (unsigned qubit = 0; qubit < shape.qubits; ++qubit)
+    os << "    %q" << qubit << " = quir.declare_qubit {id = " << qubit
+       << " : i32} : " << qubitType << "\n";
+
+  auto angle = [&](unsigned gate) -> std::string {
+    if (shape.parameters == 0)
+      return "%half";
+    return "%p" + std::to_string(gate % shape.parameters);
+  };
+
+  unsigned const layers = shape.getLayers();
+  unsigned measured = 0;
+  for (unsigned gate = 0; gate < shape.gates; ++gate) {
+    unsigned const layer = gate * layers / shape.gates;
+    unsigned const qubit = (gate + layer) % shape.qubits;
+    unsigned const next = (qubit + 1) % shape.qubits;
+    switch (gate % 4) {
+    case 1:
+      if (shape.qubits > 1) {
+        os << "    quir.builtin_CX %q" << qubit << ", %q" << next << " : "
+           << qubitType << ", " << qubitType << "\n";
+        break;
+      }
+      [[fallthrough]];
+    case 2:
+      if (shape.nesting > 0) {
+        os << "    quir.call_gate @g" << shape.nesting - 1 << "(%q" << qubit
+           << ", " << angle(gate) << ") : " << gateType << "\n";
+        break;
+      }
+      [[fallthrough]];
+    case 0:
+      os << "    quir.builtin_U %q" << qubit << ", " << angle(gate)
+         << ", %zero, %zero : " << uTypes << "\n";
+      break;
+    default:
+      os << "    quir.builtin_U %q" << qubit << ", %half, %zero, %half : "
+         << uTypes << "\n";
+    }
+
+    for (unsigned const end = shape.getMeasurementsAfter(gate + 1);
+         measured < end && measured < shape.measurements; ++measured) {
+      os << "    %m" << measured << " = quir.measure(%q" << qubit << ") : ("
+         << qubitType << ") -> i1\n";
+      for (unsigned i = 0, e = shape.getConditionals(measured); i < e; ++i)
+        os << "    scf.if %m" << measured << " {\n"
+           << "      quir.builtin_U %q" << (qubit + i + 1) % shape.qubits
+           << ", " << angle(i) << ", %zero, %zero : " << uTypes << "\n"
+           << "    }\n";
+    }
+  }
+  os << "    %ret = arith.constant 0 : i32\n"
+     << "    return %ret : i32\n"
+     << "  }\n"
+     << "}\n";
+  os.flush();
+  return program;
+}
+
+llvm::Error validateShape(const ProgramShape &shape) {
+  if (shape.qubits == 0 || shape.gates == 0)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Programs need at least one qubit and "
+                                   "one gate");
+  if (shape.conditionals && !shape.measurements)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Conditionals require measurements");
+  return llvm::Error::success();
+}
+
+// Write a mock configuration with the qubits of the shape to a temporary
+// file, whose path is returned
+llvm::Expected<std::string> writeMockConfig(const ProgramShape &shape) {
+  llvm::SmallString<128> path;
+  int fd = -1;
+  if (auto ec = llvm::sys::fs::createTemporaryFile("qss-bench", "cfg", fd,
+                                                   path))
+    return llvm::createStringError(ec, "Unable to create the mock "
+                                       "configuration");
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  // the controller node id must not clash with the ids of the drive and
+  // acquire nodes
+  os << "num_qubits " << shape.qubits << "\n"
+     << "acquire_multiplexing_ratio_to_1 5\n"
+     << "controllerNodeId " << 2 * shape.qubits + 1000 << "\n";
+  return path.str().str();
+}
+
+llvm::Error runShape(const ProgramShape &shape,
+                     mlir::DialectRegistry &registry,
+                     llvm::json::OStream &json) {
+  if (auto err = validateShape(shape))
+    return err;
+
+  bool const isQASM = shape.inputType == qssc::config::InputType::QASM;
+  std::string const source = isQASM ? makeQASM(shape) : makeQUIR(shape);
+
+  std::optional<llvm::FileRemover> configRemover;
+  std::string targetConfigPath = configPath;
+  if (targetConfigPath.empty()) {
+    if (targetName != "mock")
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "A configuration is required for "
+                                     "target " +
+                                         targetName);
+    auto pathOrError = writeMockConfig(shape);
+    if (!pathOrError)
+      return pathOrError.takeError();
+    targetConfigPath = *pathOrError;
+    configRemover.emplace(targetConfigPath);
+  }
+
+  qssc::config::QSSConfig config;
+  config.setTargetName(targetName)
+      .setTargetConfigPath(targetConfigPath)
+      .setInputType(shape.inputType)
+      .setEmitAction(qssc::config::EmitAction::QEM);
+  config.setPassPipelineSetupFn([](mlir::PassManager &pm) {
+    return mlir::parsePassPipeline(pipeline, pm, llvm::errs());
+  });
+
+  for (unsigned repetition = 0; repetition < repetitions; ++repetition) {
+    StageTimingManager timingManager;
+    std::string payload;
+    llvm::raw_string_ostream payloadStream(payload);
+    {
+      mlir::TimingScope timing = timingManager.getRootScope();
+      if (auto err = qssc::compileMain(
+              payloadStream,
+              llvm::MemoryBuffer::getMemBuffer(source, "qss-bench"),
+              registry, config, std::nullopt, timing))
+        return err;
+    }
+    payloadStream.flush();
+    auto const stageTimes = timingManager.getStageTimes();
+
+    json.object([&] {
+      json.attribute("input", isQASM ? "qasm" : "mlir");
+      json.attribute("qubits", static_cast<int64_t>(shape.qubits));
+      json.attribute("gates", static_cast<int64_t>(shape.gates));
+      json.attribute("layers", static_cast<int64_t>(shape.getLayers()));
+      json.attribute("measurements",
+                     static_cast<int64_t>(shape.measurements));
+      json.attribute("conditionals",
+                     static_cast<int64_t>(shape.conditionals));
+      json.attribute("nesting", static_cast<int64_t>(shape.nesting));
+      json.attribute("parameters", static_cast<int64_t>(shape.parameters));
+      json.attribute("repetition", static_cast<int64_t>(repetition));
+      json.attribute("source_bytes", static_cast<int64_t>(source.size()));
+      json.attribute("payload_bytes", static_cast<int64_t>(payload.size()));
+      json.attributeObject("times_ns", [&] {
+        json.attribute("total", toNanoseconds(timingManager.getTotalTime()));
+        for (const StageRule &rule : stageRules)
+          json.attribute(rule.stage,
+                         toNanoseconds(stageTimes.lookup(rule.stage)));
+        json.attribute(otherStage,
+                       toNanoseconds(stageTimes.lookup(otherStage)));
+      });
+      json.attribute("peak_rss_kb", getPeakRSSKilobytes());
+    });
+  }
+  return llvm::Error::success();
+}
+
+template <typename T>
+std::vector<T> valuesOr(const llvm::cl::list<T> &list,
+                        std::vector<T> defaults) {
+  if (list.empty())
+    return defaults;
+  return {list.begin(), list.end()};
+}
+
+llvm::Expected<std::vector<ProgramShape>> getShapes() {
+  std::vector<qssc::config::InputType> types;
+  for (const auto &type : valuesOr<std::string>(inputTypes, {"qasm"})) {
+    if (type == "qasm")
+      types.push_back(qssc::config::InputType::QASM);
+    else if (type == "mlir")
+      types.push_back(qssc::config::InputType::MLIR);
+    else
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Unknown input " + type);
+  }
+
+  // every combination of the values of the axes
+  std::vector<ProgramShape> shapes;
+  for (auto const type : types)
+    for (unsigned const qubits : valuesOr<unsigned>(qubitCounts, {5, 100}))
+      for (unsigned const gates : valuesOr<unsigned>(gateCounts, {1000}))
+        for (unsigned const depth : valuesOr<unsigned>(depths, {0}))
+          for (unsigned const measurements :
+               valuesOr<unsigned>(measurementCounts, {10}))
+            for (unsigned const conditionals :
+                 valuesOr<unsigned>(conditionalCounts, {10}))
+              for (unsigned const nesting :
+                   valuesOr<unsigned>(nestingDepths, {2}))
+                for (unsigned const parameters :
+                     valuesOr<unsigned>(parameterCounts, {4}))
+                  shapes.push_back({type, qubits, gates, depth, measurements,
+                                    conditionals, nesting, parameters});
+  return shapes;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM const initLLVM(argc, argv);
+
+  // Register the passes and the options the compilation applies before the
+  // command line parsing
+  if (auto err = qssc::dialect::registerPasses()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return EXIT_FAILURE;
+  }
+  mlir::registerPassManagerCLOptions();
+  qssc::hal::compile::registerTargetCompilationManagerCLOptions();
+  llvm::cl::HideUnrelatedOptions(benchCategory);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "End-to-end benchmark of the compiler\n");
+
+  auto shapes = getShapes();
+  if (auto err = shapes.takeError()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return EXIT_FAILURE;
+  }
+
+  std::error_code ec;
+  llvm::ToolOutputFile output(outputFilename, ec, llvm::sys::fs::OF_Text);
+  if (ec) {
+    llvm::errs() << "Unable to open " << outputFilename << ": "
+                 << ec.message() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  if (emitPrograms) {
+    for (const ProgramShape &shape : *shapes) {
+      if (auto err = validateShape(shape)) {
+        llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+        return EXIT_FAILURE;
+      }
+      output.os() << (shape.inputType == qssc::config::InputType::QASM
+                          ? makeQASM(shape)
+                          : makeQUIR(shape));
+    }
+    output.keep();
+    return EXIT_SUCCESS;
+  }
+
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+
+  llvm::Error result = llvm::Error::success();
+  {
+    llvm::json::OStream json(output.os(), 2);
+    json.array([&] {
+      for (const ProgramShape &shape : *shapes) {
+        if (result)
+          return;
+        result = runShape(shape, registry, json);
+      }
+    });
+  }
+  output.os() << "\n";
+
+  if (result) {
+    llvm::logAllUnhandledErrors(std::move(result), llvm::errs(), "Error: ");
+    return EXIT_FAILURE;
+  }
+  output.keep();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,450 @@
+//===- qss-bind-bench.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a benchmark of binding arguments to payloads. It binds
+// synthetic zip payloads through qssc::arguments::bindArguments with a
+// synthetic target and reports the time spent parsing the signature, reading
+// members, patching and writing back the payload as JSON, such that
+// regressions of the link step can be attributed to the payload, the
+// signature or the target.
+//
+//===----------------------------------------------------------------------===//
+
+#include "API/errors.h"
+#include "Arguments/Arguments.h"
+#include "Arguments/Signature.h"
+#include "Config/QSSConfig.h"
+#include "Payload/PatchableZipPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace qssc;
+
+namespace {
+
+llvm::cl::OptionCategory benchCategory("qss-bind-bench options");
+
+llvm::cl::list<uint64_t>
+    binarySizes("binary-size",
+                llvm::cl::desc("Sizes of each binary in bytes to benchmark"),
+                llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned>
+    binaryCounts("binaries",
+                 llvm::cl::desc("Numbers of binaries per payload to benchmark"),
+                 llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned> patchPointCounts(
+    "patch-points",
+    llvm::cl::desc("Numbers of patch points per binary to benchmark"),
+    llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<unsigned>
+    repetitions("repetitions",
+                llvm::cl::desc("Number of binds per configuration"),
+                llvm::cl::init(5), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<bool> inMemory(
+    "in-memory",
+    llvm::cl::desc("Bind payloads held in memory rather than payload files"),
+    llvm::cl::init(false), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<bool>
+    inPlace("in-place",
+            llvm::cl::desc("Let the synthetic target patch members in place"),
+            llvm::cl::init(true), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<std::string>
+    outputFilename("o", llvm::cl::desc("Output filename for JSON results"),
+                   llvm::cl::value_desc("filename"), llvm::cl::init("-"),
+                   llvm::cl::cat(benchCategory));
+
+using Clock = std::chrono::steady_clock;
+
+// Time spent in each phase of a bind. Binaries may be patched concurrently,
+// hence the times are accumulated atomically.
+struct PhaseTimes {
+  std::atomic<int64_t> signatureParse{0};
+  std::atomic<int64_t> memberRead{0};
+  std::atomic<int64_t> patch{0};
+  std::atomic<int64_t> writeBack{0};
+};
+
+// Adds the time from its construction to its destruction to a phase
+class ScopedPhase {
+public:
+  explicit ScopedPhase(std::atomic<int64_t> &phase)
+      : phase(phase), start(Clock::now()) {}
+  ~ScopedPhase() {
+    phase += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 Clock::now() - start)
+                 .count();
+  }
+
+private:
+  std::atomic<int64_t> &phase;
+  Clock::time_point start;
+};
+
+// Times the payload operations of a zip payload
+class TimedPayload : public payload::PatchablePayload {
+public:
+  TimedPayload(PhaseTimes &times, llvm::StringRef input, bool enableInMemory)
+      : times(times), zip(input, enableInMemory) {}
+
+  llvm::Expected<ContentBuffer &>
+  readMember(llvm::StringRef path, bool markForWriteBack = true) override {
+    ScopedPhase const timer(times.memberRead);
+    return zip.readMember(path, markForWriteBack);
+  }
+  llvm::Expected<llvm::MutableArrayRef<char>>
+  mapMember(llvm::StringRef path) override {
+    ScopedPhase const timer(times.memberRead);
+    return zip.mapMember(path);
+  }
+  llvm::Error updateMappedMember(llvm::StringRef path, uint64_t offset,
+                                 llvm::ArrayRef<char> previous) override {
+    ScopedPhase const timer(times.patch);
+    return zip.updateMappedMember(path, offset, previous);
+  }
+  llvm::Error writeBack() override {
+    ScopedPhase const timer(times.writeBack);
+    return zip.writeBack();
+  }
+  llvm::Error writeString(std::string *outputString) override {
+    ScopedPhase const timer(times.writeBack);
+    return zip.writeString(outputString);
+  }
+  llvm::Error writeCopy(std::string *outputString) override {
+    ScopedPhase const timer(times.writeBack);
+    return zip.writeCopy(outputString);
+  }
+  llvm::Error setOutputPath(llvm::StringRef outputPath) override {
+    return zip.setOutputPath(outputPath);
+  }
+
+  payload::PatchableZipPayload &getZip() { return zip; }
+
+private:
+  PhaseTimes &times;
+  payload::PatchableZipPayload zip;
+};
+
+// Patches every argument as a double at the offset of its patch point
+class BenchBindArguments : public arguments::BindArgumentsImplementation {
+public:
+  BenchBindArguments(PhaseTimes &times, llvm::MutableArrayRef<char> data)
+      : times(times), data(data) {}
+
+  llvm::Error patch(arguments::PatchPoint const &patchPoint,
+                    arguments::ArgumentSource const &arguments) override {
+    ScopedPhase const timer(times.patch);
+    auto value = std::get<std::optional<double>>(
+        arguments.getArgumentValue(patchPoint.expression()));
+    if (!value)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Missing argument " +
+                                         patchPoint.expression());
+    if (patchPoint.offset() + sizeof(double) > data.size())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Patch point out of bounds");
+    std::memcpy(data.data() + patchPoint.offset(), &*value, sizeof(double));
+    return llvm::Error::success();
+  }
+
+  llvm::Error
+  parseParamMapIntoSignature(llvm::StringRef paramMapContents,
+                             llvm::StringRef paramMapFileName,
+                             arguments::Signature &sig) override {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Parameter maps are not supported");
+  }
+
+  payload::PatchablePayload *getPayload(llvm::StringRef payloadOutputPath,
+                                        bool enableInMemory) override {
+    return new TimedPayload(times, payloadOutputPath, enableInMemory);
+  }
+
+  llvm::Expected<arguments::Signature>
+  parseSignature(payload::PatchablePayload *payload) override {
+    ScopedPhase const timer(times.signatureParse);
+    auto &zip = static_cast<TimedPayload *>(payload)->getZip();
+    if (zip.getBackingZip() == nullptr)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Unable to open payload");
+    auto signature = zip.readMember("exp/arguments_signature.bin", false);
+    if (auto err = signature.takeError())
+      return std::move(err);
+    return arguments::Signature::deserialize(
+        llvm::StringRef(signature->data(), signature->size()), std::nullopt,
+        treatWarningsAsErrors_);
+  }
+
+  size_t getPatchSize(arguments::PatchPoint const &patchPoint) const override {
+    return sizeof(double);
+  }
+
+private:
+  PhaseTimes &times;
+  llvm::MutableArrayRef<char> data;
+};
+
+class BenchBindArgumentsFactory
+    : public arguments::BindArgumentsImplementationFactory {
+public:
+  BenchBindArgumentsFactory(PhaseTimes &times, bool patchInPlace)
+      : times(times), patchInPlace(patchInPlace) {}
+
+  arguments::BindArgumentsImplementation *
+  create(OptDiagnosticCallback onDiagnostic) override {
+    return new BenchBindArguments(times, {});
+  }
+  arguments::BindArgumentsImplementation *
+  create(std::vector<char> &buf, OptDiagnosticCallback onDiagnostic) override {
+    return new BenchBindArguments(times, buf);
+  }
+  arguments::BindArgumentsImplementation *
+  create(std::string &str, OptDiagnosticCallback onDiagnostic) override {
+    return new BenchBindArguments(times, {str.data(), str.size()});
+  }
+  arguments::BindArgumentsImplementation *
+  create(llvm::MutableArrayRef<char> data,
+         OptDiagnosticCallback onDiagnostic) override {
+    if (!patchInPlace)
+      return nullptr;
+    return new BenchBindArguments(times, data);
+  }
+
+private:
+  PhaseTimes &times;
+  bool patchInPlace;
+};
+
+class MapArgumentSource : public arguments::ArgumentSource {
+public:
+  arguments::ArgumentType
+  getArgumentValue(llvm::StringRef name) const override {
+    auto pos = values.find(name.str());
+    if (pos == values.end())
+      return std::nullopt;
+    return pos->second;
+  }
+
+  std::unordered_map<std::string, double> values;
+};
+
+struct Config {
+  uint64_t binarySize;
+  unsigned numBinaries;
+  unsigned numPatchPoints;
+};
+
+std::string getParameterName(unsigned patchPoint) {
+  return "theta" + std::to_string(patchPoint);
+}
+
+// Build a zip payload of numBinaries binaries of binarySize bytes, each with
+// numPatchPoints patch points spread evenly over the binary
+llvm::Expected<std::string> makePayload(const Config &config) {
+  uint64_t const stride =
+      config.numPatchPoints
+          ? config.binarySize / config.numPatchPoints / sizeof(double) *
+                sizeof(double)
+          : 0;
+  if (config.numPatchPoints && stride == 0)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Binaries are too small for %u patch points",
+                                   config.numPatchPoints);
+
+  auto payloadInfo =
+      payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  if (!payloadInfo.has_value())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "The ZIP payload is not available");
+  auto payloadOrErr = payloadInfo.value()->createPluginInstance(
+      payload::PayloadConfig{"exp", "exp", config::QSSVerbosity::Error});
+  if (auto err = payloadOrErr.takeError())
+    return std::move(err);
+  auto &payload = *payloadOrErr.get();
+
+  arguments::Signature sig;
+  for (unsigned binary = 0; binary < config.numBinaries; ++binary) {
+    std::string const name = "controller" + std::to_string(binary) + ".bin";
+    payload.getFile(name)->assign(config.binarySize, '\0');
+
+    std::string const memberName = "exp/" + name;
+    sig.reservePatchPoints(memberName, config.numPatchPoints);
+    for (unsigned patchPoint = 0; patchPoint < config.numPatchPoints;
+         ++patchPoint)
+      sig.addParameterPatchPoint(getParameterName(patchPoint), "double",
+                                 memberName, patchPoint * stride, patchPoint);
+  }
+  payload.writeArgumentSignature(std::move(sig));
+
+  std::string archive;
+  llvm::raw_string_ostream archiveStream(archive);
+  payload.write(archiveStream);
+  archiveStream.flush();
+  return archive;
+}
+
+int64_t toNanoseconds(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+      .count();
+}
+
+llvm::Error runConfig(const Config &config, llvm::json::OStream &json) {
+  auto archive = makePayload(config);
+  if (auto err = archive.takeError())
+    return err;
+
+  MapArgumentSource arguments;
+  for (unsigned patchPoint = 0; patchPoint < config.numPatchPoints;
+       ++patchPoint)
+    arguments.values[getParameterName(patchPoint)] = patchPoint * 0.5;
+
+  llvm::SmallString<128> inputPath;
+  llvm::SmallString<128> outputPath;
+  if (!inMemory) {
+    if (auto ec = llvm::sys::fs::createTemporaryFile("qss-bind-bench", "qem",
+                                                     inputPath))
+      return llvm::createStringError(ec, "Unable to create input file");
+    if (auto ec = llvm::sys::fs::createTemporaryFile("qss-bind-bench", "qem",
+                                                     outputPath))
+      return llvm::createStringError(ec, "Unable to create output file");
+
+    std::error_code ec;
+    llvm::raw_fd_ostream input(inputPath, ec);
+    if (ec)
+      return llvm::createStringError(ec, "Unable to write input file");
+    input << *archive;
+  }
+
+  llvm::Error result = llvm::Error::success();
+  for (unsigned repetition = 0; repetition < repetitions; ++repetition) {
+    PhaseTimes times;
+    BenchBindArgumentsFactory factory(times, inPlace);
+    std::string inMemoryOutput;
+
+    auto const start = Clock::now();
+    auto err = arguments::bindArguments(
+        inMemory ? llvm::StringRef(*archive) : llvm::StringRef(inputPath),
+        inMemory ? llvm::StringRef() : llvm::StringRef(outputPath), arguments,
+        /*treatWarningsAsErrors=*/false, /*enableInMemoryInput=*/inMemory,
+        &inMemoryOutput, factory, std::nullopt);
+    auto const total = Clock::now() - start;
+    if (err) {
+      result = std::move(err);
+      break;
+    }
+
+    json.object([&] {
+      json.attribute("binary_size", static_cast<int64_t>(config.binarySize));
+      json.attribute("num_binaries", static_cast<int64_t>(config.numBinaries));
+      json.attribute("num_patch_points",
+                     static_cast<int64_t>(config.numPatchPoints));
+      json.attribute("payload_size", static_cast<int64_t>(archive->size()));
+      json.attribute("in_memory", inMemory.getValue());
+      json.attribute("in_place", inPlace.getValue());
+      json.attribute("repetition", static_cast<int64_t>(repetition));
+      json.attributeObject("times_ns", [&] {
+        json.attribute("total", toNanoseconds(total));
+        json.attribute("signature_parse", times.signatureParse.load());
+        json.attribute("member_read", times.memberRead.load());
+        json.attribute("patch", times.patch.load());
+        json.attribute("write_back", times.writeBack.load());
+      });
+    });
+  }
+
+  if (!inMemory) {
+    llvm::sys::fs::remove(inputPath);
+    llvm::sys::fs::remove(outputPath);
+  }
+  return result;
+}
+
+template <typename T>
+std::vector<T> getValues(const llvm::cl::list<T> &list, T defaultValue) {
+  if (list.empty())
+    return {defaultValue};
+  return {list.begin(), list.end()};
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM const initLLVM(argc, argv);
+  llvm::cl::HideUnrelatedOptions(benchCategory);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "Benchmark of binding arguments to payloads\n");
+
+  std::error_code ec;
+  llvm::ToolOutputFile output(outputFilename, ec, llvm::sys::fs::OF_Text);
+  if (ec) {
+    llvm::errs() << "Unable to open " << outputFilename << ": "
+                 << ec.message() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  llvm::Error result = llvm::Error::success();
+  {
+    llvm::json::OStream json(output.os(), 2);
+    json.array([&] {
+      for (auto binarySize : getValues<uint64_t>(binarySizes, 1 << 20))
+        for (auto numBinaries : getValues<unsigned>(binaryCounts, 1))
+          for (auto numPatchPoints :
+               getValues<unsigned>(patchPointCounts, 100)) {
+            if (result)
+              return;
+            result = runConfig({binarySize, numBinaries, numPatchPoints}, json);
+          }
+    });
+  }
+  output.os() << "\n";
+
+  if (result) {
+    llvm::logAllUnhandledErrors(std::move(result), llvm::errs(), "Error: ");
+    return EXIT_FAILURE;
+  }
+  output.keep();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,233 @@
+//===- qss-conversion-bench.cpp ---------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a benchmark of the dialect conversion of a target. It
+// runs a pass pipeline, by default the mock target's QUIR to std conversion,
+// on synthetic controller modules of increasing size and reports the time
+// spent per op count as JSON, such that the conversion can be checked to
+// scale linearly with the number of ops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/RegisterDialects.h"
+#include "Dialect/RegisterPasses.h"
+#include "HAL/TargetSystemRegistry.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/InitAllExtensions.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+llvm::cl::OptionCategory benchCategory("qss-conversion-bench options");
+
+llvm::cl::opt<std::string>
+    targetName("target", llvm::cl::desc("Target whose conversion to run"),
+               llvm::cl::init("mock"), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<std::string>
+    configPath("config", llvm::cl::desc("Path to the target configuration"),
+               llvm::cl::value_desc("filename"), llvm::cl::Required,
+               llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<std::string>
+    pipeline("pass-pipeline",
+             llvm::cl::desc("Pass pipeline to run on the synthetic modules"),
+             llvm::cl::init("mock-quir-to-std"), llvm::cl::cat(benchCategory));
+
+llvm::cl::list<unsigned>
+    blockCounts("blocks",
+                llvm::cl::desc("Numbers of synthetic blocks of ops per module "
+                               "to benchmark"),
+                llvm::cl::CommaSeparated, llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<unsigned>
+    repetitions("repetitions",
+                llvm::cl::desc("Number of conversions per configuration"),
+                llvm::cl::init(5), llvm::cl::cat(benchCategory));
+
+llvm::cl::opt<std::string>
+    outputFilename("o", llvm::cl::desc("Output filename for JSON results"),
+                   llvm::cl::value_desc("filename"), llvm::cl::init("-"),
+                   llvm::cl::cat(benchCategory));
+
+using Clock = std::chrono::steady_clock;
+
+// Build a controller module of numBlocks blocks of the ops qubit
+// localization leaves to the Controller: received measurements, broadcasts,
+// classical arithmetic and conditionals
+std::string makeModule(unsigned numBlocks) {
+  std::string module;
+  llvm::raw_string_ostream os(module);
+  os << "module @controller attributes {quir.nodeId = 1000 : ui32, "
+        "quir.nodeType = \"controller\"} {\n"
+     << "  func.func @main() -> i32 attributes {quir.classicalOnly = false} "
+        "{\n";
+  for (unsigned block = 0; block < numBlocks; ++block) {
+    std::string const id = std::to_string(block);
+    os << "    %r" << id << " = qcs.recv {fromIds = [0 : index]} : i1\n"
+       << "    qcs.broadcast %r" << id << " : i1\n"
+       << "    %c" << id << " = arith.constant " << id << " : i32\n"
+       << "    %s" << id << " = arith.addi %c" << id << ", %c" << id
+       << " : i32\n"
+       << "    scf.if %r" << id << " {\n"
+       << "    } {quir.classicalOnly = false}\n";
+  }
+  os << "    %zero = arith.constant 0 : i32\n"
+     << "    return %zero : i32\n"
+     << "  }\n"
+     << "}\n";
+  os.flush();
+  return module;
+}
+
+int64_t toNanoseconds(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+      .count();
+}
+
+llvm::Error runConfig(mlir::MLIRContext &context, unsigned numBlocks,
+                      llvm::json::OStream &json) {
+  std::string const source = makeModule(numBlocks);
+
+  for (unsigned repetition = 0; repetition < repetitions; ++repetition) {
+    // parse the module anew for each repetition, it is converted in place
+    mlir::OwningOpRef<mlir::ModuleOp> module =
+        mlir::parseSourceString<mlir::ModuleOp>(source, &context);
+    if (!module)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Unable to parse the synthetic module");
+    int64_t numOps = 0;
+    module->walk([&](mlir::Operation *) { ++numOps; });
+
+    mlir::PassManager pm(&context);
+    std::string errorMessage;
+    llvm::raw_string_ostream errorStream(errorMessage);
+    if (mlir::failed(mlir::parsePassPipeline(pipeline, pm, errorStream)))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Unable to parse the pass pipeline: " +
+                                         errorStream.str());
+
+    auto const start = Clock::now();
+    auto const result = pm.run(*module);
+    auto const total = Clock::now() - start;
+    if (mlir::failed(result))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "The pass pipeline failed");
+
+    json.object([&] {
+      json.attribute("pass_pipeline", pipeline.getValue());
+      json.attribute("num_blocks", static_cast<int64_t>(numBlocks));
+      json.attribute("num_ops", numOps);
+      json.attribute("repetition", static_cast<int64_t>(repetition));
+      json.attributeObject("times_ns", [&] {
+        json.attribute("total", toNanoseconds(total));
+        json.attribute("per_op", numOps ? toNanoseconds(total) / numOps : 0);
+      });
+    });
+  }
+  return llvm::Error::success();
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM const initLLVM(argc, argv);
+
+  // Register the passes before the command line parsing
+  if (auto err = qssc::dialect::registerPasses()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return EXIT_FAILURE;
+  }
+  llvm::cl::HideUnrelatedOptions(benchCategory);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "Benchmark of the dialect conversion of a target\n");
+
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  mlir::registerAllExtensions(registry);
+  mlir::MLIRContext context(registry);
+  context.loadAllAvailableDialects();
+
+  auto targetInfo =
+      qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(targetName);
+  if (!targetInfo) {
+    llvm::errs() << "Error: Target " << targetName << " is not registered.\n";
+    return EXIT_FAILURE;
+  }
+  auto created = targetInfo.value()->createTarget(
+      &context, std::optional<llvm::StringRef>(configPath.getValue()));
+  if (auto err = created.takeError()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return EXIT_FAILURE;
+  }
+
+  std::error_code ec;
+  llvm::ToolOutputFile output(outputFilename, ec, llvm::sys::fs::OF_Text);
+  if (ec) {
+    llvm::errs() << "Unable to open " << outputFilename << ": "
+                 << ec.message() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<unsigned> counts(blockCounts.begin(), blockCounts.end());
+  if (counts.empty())
+    counts = {1000, 10000, 100000};
+
+  llvm::Error result = llvm::Error::success();
+  {
+    llvm::json::OStream json(output.os(), 2);
+    json.array([&] {
+      for (unsigned const numBlocks : counts) {
+        if (result)
+          return;
+        result = runConfig(context, numBlocks, json);
+      }
+    });
+  }
+  output.os() << "\n";
+
+  if (result) {
+    llvm::logAllUnhandledErrors(std::move(result), llvm::errs(), "Error: ");
+    return EXIT_FAILURE;
+  }
+  output.keep();
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,6 @@
 //===- qss-opt.cpp ----------------------------------------------*- C++ -*-===//
 //
-// (C) Copyright IBM 2023.
+// (C) Copyright IBM 2023, 2024.
 //
 // This code is part of Qiskit.
 //
@@ -16,10 +16,13 @@
 //
 // This file implements an mlir-opt clone with the qss dialects and passes
 // registered. It is mainly for diagnostic verification (testing) but can
-// also be used for benchmarking and other types of testing.
+// also be used for benchmarking and other types of testing. With
+// --batch-inputs it runs the pass pipeline over many inputs in parallel, e.g.
+// for regression triage over a corpus of programs.
 //
 //===----------------------------------------------------------------------===//
 
+#include "API/api.h"
 #include "Config/CLIConfig.h"
 #include "Config/QSSConfig.h"
 #include "Dialect/RegisterDialects.h"
@@ -27,33 +30,52 @@
 #include "HAL/TargetSystemRegistry.h"
 #include "Payload/PayloadRegistry.h"
 
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Debug/Counter.h"
 #include "mlir/IR/AsmState.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
 #include "mlir/InitAllExtensions.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassInstrumentation.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/Timing.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <stdio.h> // NOLINT: fileno is not in cstdio as suggested
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 using namespace qssc;
 using namespace qssc::hal;
@@ -61,6 +83,39 @@ using namespace qssc::hal;
 static const std::string toolName = "qss-opt";
 
 namespace {
+/// The options of the batch mode, which runs the pass pipeline over many
+/// inputs.
+struct BatchOptions {
+  llvm::cl::opt<std::string> inputs{
+      "batch-inputs",
+      llvm::cl::desc("Run the pass pipeline over the inputs listed in a "
+                     "manifest file, one '<input> [<output>]' per line, or "
+                     "the inputs in a directory, in parallel. Outputs which "
+                     "are not listed are written to the directory given by "
+                     "-o, if any"),
+      llvm::cl::value_desc("manifest or directory")};
+  llvm::cl::opt<std::string> statistics{
+      "batch-statistics",
+      llvm::cl::desc("Write the status, run time and number of operations of "
+                     "each input of the batch to a CSV file"),
+      llvm::cl::value_desc("filename")};
+  llvm::cl::opt<bool> timing{
+      "batch-timing",
+      llvm::cl::desc("Report the pass timings of the batch summed over all "
+                     "inputs"),
+      llvm::cl::init(false)};
+  llvm::cl::opt<unsigned> threads{
+      "batch-threads",
+      llvm::cl::desc("The number of threads of the batch, 0 for the hardware "
+                     "concurrency"),
+      llvm::cl::init(0)};
+};
+
+BatchOptions &getBatchOptions() {
+  static BatchOptions options;
+  return options;
+}
+
 std::pair<std::string, std::string>
 registerAndParseCLIOptions(int argc, char **argv, llvm::StringRef toolName,
                            mlir::DialectRegistry &registry) {
@@ -79,6 +134,7 @@ registerAndParseCLIOptions(int argc, char **argv, llvm::StringRef toolName,
   mlir::registerPassManagerCLOptions();
   mlir::registerDefaultTimingManagerCLOptions();
   mlir::tracing::DebugCounter::registerCLOptions();
+  getBatchOptions();
 
   // Build the list of dialects as a header for the --help message.
   std::string helpHeader = (toolName + "\n").str();
@@ -142,6 +198,182 @@ llvm::Error buildTarget_(qssc::config::QSSConfig &config) {
   }
   return llvm::Error::success();
 }
+
+/// Pass timings summed over the inputs of a batch.
+class BatchPassTimings {
+public:
+  void add(llvm::StringRef pass, double seconds) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto &total = totals[pass];
+    total.runs++;
+    total.seconds += seconds;
+  }
+
+  void print(llvm::raw_ostream &os, size_t numInputs) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    std::vector<std::pair<llvm::StringRef, Total>> sorted;
+    double sum = 0;
+    for (const auto &entry : totals) {
+      sorted.emplace_back(entry.getKey(), entry.getValue());
+      sum += entry.getValue().seconds;
+    }
+    llvm::sort(sorted, [](const auto &a, const auto &b) {
+      return a.second.seconds > b.second.seconds;
+    });
+
+    os << "===" << std::string(73, '-') << "===\n"
+       << "  Batch pass timings over " << numInputs << " inputs\n"
+       << "===" << std::string(73, '-') << "===\n"
+       << "  Summed over all inputs and threads: "
+       << llvm::format("%.4f", sum) << " seconds\n\n"
+       << "  ----Seconds----  ------Runs------  ----Name----\n";
+    for (const auto &[name, total] : sorted)
+      os << llvm::format("  %8.4f (%5.1f%%)  %16llu", total.seconds,
+                         sum > 0 ? 100 * total.seconds / sum : 0.0,
+                         static_cast<unsigned long long>(total.runs))
+         << "  " << name << "\n";
+  }
+
+private:
+  struct Total {
+    uint64_t runs = 0;
+    double seconds = 0;
+  };
+
+  std::mutex mutex;
+  llvm::StringMap<Total> totals;
+};
+
+/// Adds the run times of the passes of a pass manager to the batch timings.
+/// Passes on nested operations run concurrently, hence the start times are
+/// tracked per pass and operation.
+class BatchTimingInstrumentation : public mlir::PassInstrumentation {
+public:
+  explicit BatchTimingInstrumentation(BatchPassTimings &timings)
+      : timings(timings) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override {
+    if (isAdaptor(pass))
+      return;
+    std::lock_guard<std::mutex> const lock(mutex);
+    startTimes[{pass, op}] = Clock::now();
+  }
+
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override {
+    stop(pass, op);
+  }
+
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override {
+    stop(pass, op);
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // the adaptors running nested pass managers would count the time of their
+  // passes twice
+  static bool isAdaptor(mlir::Pass *pass) {
+    return pass->getName() == "mlir::detail::OpToOpPassAdaptor";
+  }
+
+  void stop(mlir::Pass *pass, mlir::Operation *op) {
+    if (isAdaptor(pass))
+      return;
+    Clock::time_point start;
+    {
+      std::lock_guard<std::mutex> const lock(mutex);
+      auto pos = startTimes.find({pass, op});
+      if (pos == startTimes.end())
+        return;
+      start = pos->second;
+      startTimes.erase(pos);
+    }
+    timings.add(pass->getName(),
+                std::chrono::duration<double>(Clock::now() - start).count());
+  }
+
+  BatchPassTimings &timings;
+  std::mutex mutex;
+  llvm::DenseMap<std::pair<mlir::Pass *, mlir::Operation *>, Clock::time_point>
+      startTimes;
+};
+
+struct BatchInputResult {
+  bool success = false;
+  double seconds = 0;
+  uint64_t numOperations = 0;
+  std::string diagnostics;
+};
+
+BatchInputResult runBatchInput(const qssc::PipelineCompileJob &job,
+                               mlir::DialectRegistry &registry,
+                               const qssc::config::QSSConfig &config,
+                               llvm::ThreadPool &threadPool,
+                               BatchPassTimings *timings) {
+  BatchInputResult result;
+  llvm::raw_string_ostream diagOS(result.diagnostics);
+  auto const start = std::chrono::steady_clock::now();
+
+  auto run = [&]() -> bool {
+    std::string errorMessage;
+    auto file = mlir::openInputFile(job.inputFilename, &errorMessage);
+    if (!file) {
+      diagOS << job.inputFilename << ": " << errorMessage << "\n";
+      return false;
+    }
+
+    // Every input gets a context of its own, such that its storage is
+    // released once it is done, while the passes of all the inputs share the
+    // thread pool of the batch for their nested parallelism.
+    mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+    context.setThreadPool(threadPool);
+    context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+
+    llvm::SourceMgr sourceMgr;
+    sourceMgr.AddNewSourceBuffer(std::move(file), llvm::SMLoc());
+    mlir::SourceMgrDiagnosticHandler const diagHandler(sourceMgr, &context,
+                                                       diagOS);
+
+    mlir::ParserConfig const parserConfig(&context);
+    mlir::OwningOpRef<mlir::ModuleOp> moduleOp =
+        mlir::parseSourceFile<mlir::ModuleOp>(sourceMgr, parserConfig);
+    if (!moduleOp)
+      return false;
+
+    mlir::PassManager pm(&context, mlir::ModuleOp::getOperationName());
+    pm.enableVerifier(config.shouldVerifyPasses());
+    if (timings)
+      pm.addInstrumentation(
+          std::make_unique<BatchTimingInstrumentation>(*timings));
+    if (mlir::failed(config.setupPassPipeline(pm)) ||
+        mlir::failed(pm.run(*moduleOp)))
+      return false;
+
+    moduleOp->walk([&](mlir::Operation *) { result.numOperations++; });
+
+    if (job.outputFilename.empty())
+      return true;
+    auto output = mlir::openOutputFile(job.outputFilename, &errorMessage);
+    if (!output) {
+      diagOS << job.outputFilename << ": " << errorMessage << "\n";
+      return false;
+    }
+    if (config.shouldEmitBytecode()) {
+      if (mlir::failed(mlir::writeBytecodeToFile(*moduleOp, output->os())))
+        return false;
+    } else
+      moduleOp->print(output->os());
+    output->keep();
+    return true;
+  };
+
+  result.success = run();
+  result.seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  diagOS.flush();
+  return result;
+}
 } // anonymous namespace
 
 mlir::LogicalResult QSSCOptMain(int argc, char **argv,
@@ -188,6 +420,93 @@ mlir::LogicalResult QSSCOptMain(int argc, char **argv,
   return mlir::success();
 }
 
+mlir::LogicalResult QSSCOptBatchMain(int argc, char **argv,
+                                     llvm::StringRef outputDirectory,
+                                     mlir::DialectRegistry &registry,
+                                     qssc::config::QSSConfig &config) {
+
+  llvm::InitLLVM const y(argc, argv);
+  auto &options = getBatchOptions();
+
+  if (auto err = buildTarget_(config)) {
+    llvm::errs() << err;
+    return mlir::failure();
+  }
+
+  auto jobs = qssc::readPipelineJobs(options.inputs);
+  if (auto err = jobs.takeError()) {
+    llvm::errs() << err << "\n";
+    return mlir::failure();
+  }
+
+  // Outputs which are not listed are named after their input in the output
+  // directory, or not written without one
+  if (outputDirectory != "-") {
+    if (auto ec = llvm::sys::fs::create_directories(outputDirectory)) {
+      llvm::errs() << "Failed to create the output directory "
+                   << outputDirectory << ": " << ec.message() << "\n";
+      return mlir::failure();
+    }
+    for (auto &job : *jobs) {
+      if (!job.outputFilename.empty())
+        continue;
+      llvm::SmallString<128> outputPath(outputDirectory);
+      llvm::sys::path::append(outputPath,
+                              llvm::sys::path::stem(job.inputFilename) +
+                                  (config.shouldEmitBytecode() ? ".mlirbc"
+                                                               : ".mlir"));
+      job.outputFilename = outputPath.str().str();
+    }
+  }
+
+  BatchPassTimings timings;
+  std::vector<BatchInputResult> results(jobs->size());
+  {
+    llvm::ThreadPool threadPool(llvm::hardware_concurrency(options.threads));
+    llvm::ThreadPoolTaskGroup tasks(threadPool);
+    for (size_t idx = 0; idx < jobs->size(); ++idx)
+      tasks.async([&, idx] {
+        results[idx] =
+            runBatchInput((*jobs)[idx], registry, config, threadPool,
+                          options.timing ? &timings : nullptr);
+      });
+    tasks.wait();
+  }
+
+  size_t numFailed = 0;
+  for (const auto &result : results) {
+    llvm::errs() << result.diagnostics;
+    if (!result.success)
+      numFailed++;
+  }
+
+  if (!options.statistics.empty()) {
+    std::string errorMessage;
+    auto statistics = mlir::openOutputFile(options.statistics, &errorMessage);
+    if (!statistics) {
+      llvm::errs() << errorMessage << "\n";
+      return mlir::failure();
+    }
+    statistics->os() << "input,status,seconds,operations\n";
+    for (size_t idx = 0; idx < jobs->size(); ++idx)
+      statistics->os() << (*jobs)[idx].inputFilename << ","
+                       << (results[idx].success ? "ok" : "failed") << ","
+                       << llvm::format("%.6f", results[idx].seconds) << ","
+                       << results[idx].numOperations << "\n";
+    statistics->keep();
+  }
+
+  if (options.timing)
+    timings.print(llvm::errs(), jobs->size());
+
+  if (numFailed) {
+    llvm::errs() << "Error: " << numFailed << " of " << jobs->size()
+                 << " inputs failed\n";
+    return mlir::failure();
+  }
+  return mlir::success();
+}
+
 mlir::LogicalResult QSSCOptMain(int argc, char **argv,
                                 mlir::DialectRegistry &registry) {
 
@@ -204,6 +523,9 @@ mlir::LogicalResult QSSCOptMain(int argc, char **argv,
   }
   qssc::config::QSSConfig config = configResult.get();
 
+  if (!getBatchOptions().inputs.empty())
+    return QSSCOptBatchMain(argc, argv, outputFilename, registry, config);
+
   return QSSCOptMain(argc, argv, inputFilename, outputFilename, registry,
                      config);
 }